@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <gbdk/platform.h>
 #include <gbdk/font.h>
@@ -12,6 +13,10 @@ BCD bcd3 = MAKE_BCD(11111111);
 uint8_t len = 0;
 unsigned char buf[10];
 
+// A 12 digit score, least significant byte first like BCD
+uint8_t score[6], score_shadow[6];
+const uint8_t points[6] = { 0x25, 0x01 };
+
 void main(void) {
     font_init();
     font_set(font_load(font_spect));
@@ -33,4 +38,12 @@ void main(void) {
 
     len = bcd2text(&bcd, 0x10, buf);
     set_bkg_tiles(5, 8, len, 1, buf);
+
+    // Count up, only the changed digits are written each frame
+    memset(score_shadow, BCD_SHADOW_INVALID, sizeof(score_shadow));
+    while (TRUE) {
+        bcd_add_n(score, points, sizeof(score));
+        bcd2vram_xy(4, 10, score, sizeof(score), 0x10, score_shadow);
+        vsync();
+    }
 }
\ No newline at end of file
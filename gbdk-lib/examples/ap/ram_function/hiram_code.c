@@ -0,0 +1,9 @@
+// All code in this file goes into the _CODE_HRAM area: it is stored
+// in ROM and copied to HIRAM at startup (0xFFA0 by default)
+#pragma codeseg CODE_HRAM
+
+#include "ram_code.h"
+
+void inc_hiram(void) {
+    counter++;
+}
@@ -0,0 +1,9 @@
+// All code in this file goes into the _CODE_RAM area: it is stored
+// in ROM and copied to WRAM at startup, where it is linked to run
+#pragma codeseg CODE_RAM
+
+#include "ram_code.h"
+
+void inc_ram(void) {
+    counter++;
+}
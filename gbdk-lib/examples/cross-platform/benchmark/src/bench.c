@@ -0,0 +1,89 @@
+#include <gbdk/platform.h>
+#include <stdint.h>
+
+#include "bench.h"
+
+#if defined(NINTENDO)
+
+// TIMA counts at 16384 Hz, every 256 CPU cycles, and its overflow
+// interrupt extends it to 24 bits. The interrupt only runs once every
+// 65536 cycles, so it adds very little to the measured time.
+static volatile uint16_t bench_overflows;
+
+static void bench_tim_isr(void) {
+    bench_overflows++;
+}
+
+void bench_init(void) {
+    CRITICAL {
+        add_TIM(bench_tim_isr);
+    }
+    TMA_REG = 0;
+    TAC_REG = TACF_START | TACF_16KHZ;
+    set_interrupts(IE_REG | TIM_IFLAG);
+}
+
+void bench_start(void) {
+    CRITICAL {
+        TIMA_REG = 0;
+        IF_REG &= ~TIM_IFLAG;
+        bench_overflows = 0;
+    }
+}
+
+uint32_t bench_stop(void) {
+    uint16_t hi;
+    uint8_t lo;
+
+    CRITICAL {
+        lo = TIMA_REG;
+        hi = bench_overflows;
+        // Overflowed after interrupts were turned off
+        if ((IF_REG & TIM_IFLAG) && (lo < 0x80)) hi++;
+    }
+    return (((uint32_t)hi << 8) | lo) << 8;
+}
+
+#elif defined(SEGA)
+
+#define LINES_PER_FRAME 262u
+#define CYCLES_PER_LINE 228u
+#define VBLANK_LINE     192u
+
+static uint32_t bench_start_line;
+
+// Returns the number of lines since sys_time was 0.
+//
+// VCOUNTER runs 0x00 - 0xDA and then jumps back to 0xD5 - 0xFF on NTSC,
+// so 0xD5 - 0xDA are seen twice. During those 6 lines of the vertical
+// blank the result may be 6 lines short. sys_time is incremented by the
+// VBlank interrupt at line 192, so lines are counted from there.
+static uint32_t bench_line(void) {
+    uint16_t frames, v;
+
+    do {
+        frames = sys_time;
+        v = VCOUNTER;
+    } while (frames != sys_time);
+
+    if (v >= VBLANK_LINE) {
+        if (v > 0xDAu) v += 6;  // Second pass, 0xDB and up are lines 225 - 261
+        v -= VBLANK_LINE;
+    } else {
+        v += LINES_PER_FRAME - VBLANK_LINE;
+    }
+    return ((uint32_t)frames * LINES_PER_FRAME) + v;
+}
+
+void bench_init(void) {
+}
+
+void bench_start(void) {
+    bench_start_line = bench_line();
+}
+
+uint32_t bench_stop(void) {
+    return (bench_line() - bench_start_line) * CYCLES_PER_LINE;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <stdint.h>
+
+// Sets up the hardware used for timing, call once at startup
+void bench_init(void);
+
+// Starts a measurement
+void bench_start(void);
+
+// Returns the CPU clock cycles since bench_start()
+//
+// Game Boy: TIMA at 16384 Hz, 256 cycle resolution
+// SMS/GG:   VCOUNTER and sys_time, 228 cycle (one line) resolution, NTSC only
+uint32_t bench_stop(void);
+
+#endif
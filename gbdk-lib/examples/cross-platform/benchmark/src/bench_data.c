@@ -0,0 +1,65 @@
+// Test data for the benchmarks
+//
+// bench_tiles is 16 tiles of 2bpp tile data. bench_tiles_gb and
+// bench_tiles_rle are the same data compressed with:
+//   gbcompress --cout bench_tiles.bin
+//   gbcompress --cout --alg=rle bench_tiles.bin
+
+#include <stdint.h>
+
+#include "bench_data.h"
+
+const uint8_t bench_tiles[BENCH_TILES_SIZE] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x11, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00,
+    0x22, 0x20, 0xFF, 0x20, 0xFF, 0x20, 0xFF, 0x20, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x22, 0x00,
+    0x33, 0x30, 0xFF, 0x30, 0xFF, 0x30, 0xFF, 0x30, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x3A, 0x00,
+    0x44, 0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x00,
+    0x55, 0x50, 0x00, 0x50, 0x00, 0x50, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5C, 0x00,
+    0x66, 0x60, 0xFF, 0x60, 0xFF, 0x60, 0xFF, 0x60, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x66, 0x00,
+    0x77, 0x70, 0xFF, 0x70, 0xFF, 0x70, 0xFF, 0x70, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x7E, 0x00,
+    0x88, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x88, 0x00,
+    0x99, 0x90, 0x00, 0x90, 0x00, 0x90, 0x00, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA0, 0x00,
+    0xAA, 0xA0, 0xFF, 0xA0, 0xFF, 0xA0, 0xFF, 0xA0, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xAA, 0x00,
+    0xBB, 0xB0, 0xFF, 0xB0, 0xFF, 0xB0, 0xFF, 0xB0, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xC2, 0x00,
+    0xCC, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xCC, 0x00,
+    0xDD, 0xD0, 0x00, 0xD0, 0x00, 0xD0, 0x00, 0xD0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE4, 0x00,
+    0xEE, 0xE0, 0xFF, 0xE0, 0xFF, 0xE0, 0xFF, 0xE0, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xEE, 0x00,
+    0xFF, 0xF0, 0xFF, 0xF0, 0xFF, 0xF0, 0xFF, 0xF0, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x06, 0x00
+};
+
+const uint8_t bench_tiles_gb[] = {
+    0x0F, 0x00, 0xC0, 0x11, 0x43, 0x10, 0x00, 0x84, 0xE7, 0xFF, 0xC2, 0x18, 0x00, 0x22, 0x43, 0x20,
+    0xFF, 0xC7, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x22, 0x00, 0x33, 0x43, 0x30, 0xFF, 0x84, 0xF0, 0xFF,
+    0xC2, 0x3A, 0x00, 0x44, 0x43, 0x40, 0x00, 0x84, 0xB7, 0xFF, 0xC2, 0x44, 0x00, 0x55, 0x43, 0x50,
+    0x00, 0x84, 0xA7, 0xFF, 0xC2, 0x5C, 0x00, 0x66, 0x43, 0x60, 0xFF, 0x84, 0xC0, 0xFF, 0xC2, 0x66,
+    0x00, 0x77, 0x43, 0x70, 0xFF, 0x84, 0xB0, 0xFF, 0xC2, 0x7E, 0x00, 0x88, 0x43, 0x80, 0x00, 0x84,
+    0x77, 0xFF, 0xC2, 0x88, 0x00, 0x99, 0x43, 0x90, 0x00, 0x84, 0x67, 0xFF, 0xC2, 0xA0, 0x00, 0xAA,
+    0x43, 0xA0, 0xFF, 0x84, 0x80, 0xFF, 0xC2, 0xAA, 0x00, 0xBB, 0x43, 0xB0, 0xFF, 0x84, 0x70, 0xFF,
+    0xC2, 0xC2, 0x00, 0xCC, 0x43, 0xC0, 0x00, 0x84, 0x37, 0xFF, 0xC2, 0xCC, 0x00, 0xDD, 0x43, 0xD0,
+    0x00, 0x84, 0x27, 0xFF, 0xC2, 0xE4, 0x00, 0xEE, 0x43, 0xE0, 0xFF, 0x84, 0x40, 0xFF, 0xC1, 0xEE,
+    0x00, 0x43, 0xFF, 0xF0, 0x85, 0x30, 0xFF, 0xC1, 0x06, 0x00, 0x00
+};
+
+const uint8_t bench_tiles_rle[] = {
+    0xF0, 0x00, 0x08, 0x11, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0xFA, 0x00, 0x2A, 0x18, 0x00,
+    0x22, 0x20, 0xFF, 0x20, 0xFF, 0x20, 0xFF, 0x20, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x22, 0x00,
+    0x33, 0x30, 0xFF, 0x30, 0xFF, 0x30, 0xFF, 0x30, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x3A, 0x00,
+    0x44, 0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 0x40, 0xFA, 0x00, 0x0A, 0x44, 0x00, 0x55, 0x50, 0x00,
+    0x50, 0x00, 0x50, 0x00, 0x50, 0xFA, 0x00, 0x2A, 0x5C, 0x00, 0x66, 0x60, 0xFF, 0x60, 0xFF, 0x60,
+    0xFF, 0x60, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x66, 0x00, 0x77, 0x70, 0xFF, 0x70, 0xFF, 0x70,
+    0xFF, 0x70, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x7E, 0x00, 0x88, 0x80, 0x00, 0x80, 0x00, 0x80,
+    0x00, 0x80, 0xFA, 0x00, 0x0A, 0x88, 0x00, 0x99, 0x90, 0x00, 0x90, 0x00, 0x90, 0x00, 0x90, 0xFA,
+    0x00, 0x2A, 0xA0, 0x00, 0xAA, 0xA0, 0xFF, 0xA0, 0xFF, 0xA0, 0xFF, 0xA0, 0xFF, 0x00, 0xFF, 0x00,
+    0xFF, 0x00, 0xAA, 0x00, 0xBB, 0xB0, 0xFF, 0xB0, 0xFF, 0xB0, 0xFF, 0xB0, 0xFF, 0x00, 0xFF, 0x00,
+    0xFF, 0x00, 0xC2, 0x00, 0xCC, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0xFA, 0x00, 0x0A, 0xCC,
+    0x00, 0xDD, 0xD0, 0x00, 0xD0, 0x00, 0xD0, 0x00, 0xD0, 0xFA, 0x00, 0x22, 0xE4, 0x00, 0xEE, 0xE0,
+    0xFF, 0xE0, 0xFF, 0xE0, 0xFF, 0xE0, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xEE, 0x00, 0xFF, 0xF0,
+    0xFF, 0xF0, 0xFF, 0xF0, 0xFF, 0xF0, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x06, 0x00, 0x00
+};
+
+const metasprite_t bench_metasprite[] = {
+    METASPR_ITEM(-8, -8, 0, 0), METASPR_ITEM(0, 8, 1, 0),
+    METASPR_ITEM(8, -8, 2, 0), METASPR_ITEM(0, 8, 3, 0),
+    METASPR_TERM
+};
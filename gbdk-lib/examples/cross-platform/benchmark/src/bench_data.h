@@ -0,0 +1,16 @@
+#ifndef _BENCH_DATA_H
+#define _BENCH_DATA_H
+
+#include <gbdk/platform.h>
+#include <gbdk/metasprites.h>
+#include <stdint.h>
+
+#define BENCH_TILES_SIZE 256
+
+extern const uint8_t bench_tiles[BENCH_TILES_SIZE];
+extern const uint8_t bench_tiles_gb[];
+extern const uint8_t bench_tiles_rle[];
+
+extern const metasprite_t bench_metasprite[];
+
+#endif
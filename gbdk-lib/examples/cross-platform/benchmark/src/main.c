@@ -0,0 +1,181 @@
+// Cross-platform benchmark
+//
+// Times library routines with a hardware timer and reports the average
+// CPU clock cycles per call through the emulator debug message window,
+// one line per routine:
+//
+//   BENCH,<name>,<cycles>
+//
+// The lines can be saved from the emulator (for example Emulicious or
+// BGB) to compare two builds of the library.
+//
+// The display is turned off while measuring, so VRAM access does not
+// have to wait for the PPU and the results do not depend on timing.
+
+#include <gbdk/platform.h>
+#include <gbdk/emu_debug.h>
+#include <gbdk/gbdecompress.h>
+#include <gbdk/rledecompress.h>
+#include <gbdk/fastdiv.h>
+#include <gbdk/textfmt.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <rand.h>
+#if defined(NINTENDO)
+#include <gb/cgb.h>
+#include <gb/vram_queue.h>
+#endif
+
+#include "bench.h"
+#include "bench_data.h"
+
+// Calls per measurement, the result is the average
+#define BENCH_REPS 16
+
+#define SORT_COUNT 32
+
+static uint8_t buf[512];
+static uint8_t sort_buf[SORT_COUNT];
+static uint8_t sort_src[SORT_COUNT];
+
+// Operands are volatile so the compiler can not fold the arithmetic
+static volatile uint16_t op16_a = 51234u, op16_b = 321u;
+static volatile uint8_t op8_a = 201u, op8_b = 7u;
+static volatile uint32_t op32_a = 3141592653u, op32_b = 2718281u, op32_c = 1000u;
+static volatile int32_t ops32_a = -1234567890, ops32_b = 12345;
+static volatile uint16_t bench_result;
+static volatile uint32_t bench_result32;
+
+static int cmp_u8(const void * a, const void * b) REENTRANT {
+    return (int)*(const uint8_t *)a - (int)*(const uint8_t *)b;
+}
+
+static void b_empty(void) { }
+static void b_set_bkg_data(void) { set_bkg_data(0, BENCH_TILES_SIZE / 16, bench_tiles); }
+static void b_set_bkg_submap(void) { set_bkg_submap(0, 0, 20, 18, buf, 32); }
+static void b_move_metasprite(void) { move_metasprite_ex(bench_metasprite, 0, 0, 0, 64, 64); }
+static void b_move_metasprite_flipx(void) { move_metasprite_flipx(bench_metasprite, 0, 0, 0, 64, 64); }
+static void b_move_metasprite_flipy(void) { move_metasprite_flipy(bench_metasprite, 0, 0, 0, 64, 64); }
+static void b_gb_decompress(void) { gb_decompress(bench_tiles_gb, buf); }
+static void b_rle_decompress(void) {
+    rle_init((void *)bench_tiles_rle);
+    rle_decompress(buf, BENCH_TILES_SIZE / 2);
+    rle_decompress(buf + (BENCH_TILES_SIZE / 2), BENCH_TILES_SIZE / 2);
+}
+static void b_memcpy_16(void) { memcpy(buf, bench_tiles, 16); }
+static void b_memcpy_256(void) { memcpy(buf, bench_tiles, 256); }
+static void b_qsort(void) {  // Includes copying the unsorted data
+    memcpy(sort_buf, sort_src, SORT_COUNT);
+    qsort(sort_buf, SORT_COUNT, 1, cmp_u8);
+}
+static void b_rand(void) { bench_result = rand(); }
+static void b_xrand(void) { bench_result = xrand(); }
+static void b_rand_fill_256(void) { rand_fill(buf, 256); }
+static void b_mul_u8(void) { bench_result = (uint8_t)(op8_a * op8_b); }
+static void b_mul_u16(void) { bench_result = op16_a * op16_b; }
+static void b_div_u16(void) { bench_result = op16_a / op16_b; }
+static void b_mod_u16(void) { bench_result = op16_a % op16_b; }
+static void b_mul_u32(void) { bench_result32 = op32_a * op32_b; }
+static void b_mul_u32_small(void) { bench_result32 = op32_c * op8_b; }
+static void b_div_u32(void) { bench_result32 = op32_a / op32_b; }
+static void b_div_u32_small(void) { bench_result32 = op32_a / op32_c; }
+static void b_mod_u32(void) { bench_result32 = op32_a % op32_c; }
+static void b_div_s32(void) { bench_result32 = ops32_a / ops32_b; }
+static void b_div_op_u8(void) { bench_result = (uint8_t)op8_a / (uint8_t)op8_b; }
+static void b_div_u8(void) { bench_result = div_u8(op8_a, op8_b); }
+static void b_div_u8_const(void) { bench_result = DIV_U8_CONST(op8_a, 7); }
+#if defined(NINTENDO)
+// The sm83 fast paths, with the display off (the queue writes directly then)
+static void b_hdma_set_bkg_data(void) { hdma_set_bkg_data(0, BENCH_TILES_SIZE / 16, bench_tiles); }
+static void b_vram_blast(void) { vram_blast((uint8_t *)0x8000u, bench_tiles, BENCH_TILES_SIZE); }
+static void b_vram_queue_write(void) { vram_queue_write((uint8_t *)0x8000u, bench_tiles, BENCH_TILES_SIZE); }
+#endif
+
+typedef struct bench_t {
+    const char * name;
+    void (*fn)(void);
+} bench_t;
+
+static const bench_t benches[] = {
+    { "set_bkg_data_16",        b_set_bkg_data },
+    { "set_bkg_submap_20x18",   b_set_bkg_submap },
+    { "move_metasprite_ex",     b_move_metasprite },
+    { "move_metasprite_flipx",  b_move_metasprite_flipx },
+    { "move_metasprite_flipy",  b_move_metasprite_flipy },
+    { "gb_decompress_256",      b_gb_decompress },
+    { "rle_decompress_256",     b_rle_decompress },
+    { "memcpy_16",              b_memcpy_16 },
+    { "memcpy_256",             b_memcpy_256 },
+    { "qsort_32",               b_qsort },
+    { "rand",                   b_rand },
+    { "xrand",                  b_xrand },
+    { "rand_fill_256",          b_rand_fill_256 },
+    { "mul_u8",                 b_mul_u8 },
+    { "mul_u16",                b_mul_u16 },
+    { "div_u16",                b_div_u16 },
+    { "mod_u16",                b_mod_u16 },
+    { "mul_u32",                b_mul_u32 },
+    { "mul_u32_small",          b_mul_u32_small },
+    { "div_u32",                b_div_u32 },
+    { "div_u32_small",          b_div_u32_small },
+    { "mod_u32",                b_mod_u32 },
+    { "div_s32",                b_div_s32 },
+    { "div_op_u8",              b_div_op_u8 },
+    { "div_u8",                 b_div_u8 },
+    { "div_u8_const",           b_div_u8_const },
+#if defined(NINTENDO)
+    { "hdma_set_bkg_data_16",   b_hdma_set_bkg_data },
+    { "vram_blast_256",         b_vram_blast },
+    { "vram_queue_write_256",   b_vram_queue_write },
+#endif
+};
+
+// Returns the cycles for BENCH_REPS calls of fn
+static uint32_t bench_time(void (*fn)(void)) {
+    uint8_t i;
+
+    bench_start();
+    for (i = 0; i != BENCH_REPS; i++) fn();
+    return bench_stop();
+}
+
+// EMU_printf() has no 32 bit format, so split the value into decimal parts
+static void bench_report(const char * name, uint32_t cycles) {
+    uint8_t digits[10];
+    uint16_t hi = (uint16_t)(cycles / 10000u);
+    uint8_t len = 0;
+
+    if (hi) len = fmt_u16(hi, '0', digits);
+    if (len) {
+        fmt_u16_zero((uint16_t)(cycles % 10000u), 4, '0', digits + len);
+    } else {
+        fmt_u16((uint16_t)cycles, '0', digits);
+    }
+    EMU_printf("BENCH,%s,%s", name, (const char *)digits);
+}
+
+void main(void) {
+    uint8_t i;
+    uint32_t overhead, cycles;
+
+    for (i = 0; i != SORT_COUNT; i++) sort_src[i] = (uint8_t)(i * 97u);
+    memset(buf, 0, sizeof(buf));
+    initrand(0x1234);
+
+    DISPLAY_OFF;
+    bench_init();
+
+    // Loop and call overhead, subtracted from every result
+    overhead = bench_time(b_empty);
+    EMU_printf("BENCH,start,%u", BENCH_REPS);
+
+    for (i = 0; i != (sizeof(benches) / sizeof(benches[0])); i++) {
+        cycles = bench_time(benches[i].fn);
+        cycles = (cycles > overhead) ? (cycles - overhead) : 0;
+        bench_report(benches[i].name, cycles / BENCH_REPS);
+    }
+
+    EMU_printf("BENCH,done,0");
+    DISPLAY_ON;
+}
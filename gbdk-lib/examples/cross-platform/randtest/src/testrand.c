@@ -1,7 +1,7 @@
 /*
-    fonts.c
-    Simple example of how to use multiple fonts on the GB
-    Michael Hope, 1999.
+    testrand.c
+    Prints random numbers of the generators in rand.h, and how many
+    CPU cycles each takes per random byte
 */
 
 #include <stdio.h>
@@ -11,16 +11,70 @@
 
 #include <gbdk/console.h>
 
+// CPU clock cycles per frame, for turning frames into cycles
+#if defined(__TARGET_sms) || defined(__TARGET_gg)
+#define CYCLES_PER_FRAME 59736u     // 228 cycles * 262 lines, NTSC
+#elif defined(__TARGET_nes)
+#define CYCLES_PER_FRAME 29781u     // NTSC
+#else
+#define CYCLES_PER_FRAME 70224u
+#endif
+
+// Random bytes per measurement: 64 fills of the buffer
+#define TIMING_BYTES (64u * sizeof(buf))
+
+uint8_t buf[256];
+volatile uint8_t sink;
+
+// Waits for the start of a frame, so a measurement starts with a whole one
+uint16_t timing_start(void) {
+    vsync();
+    return sys_time;
+}
+
+// Prints the elapsed frames as cycles per random byte. The resolution
+// is one frame, and the loops and interrupt handlers count as well.
+void timing_report(const char * name, uint16_t start) {
+    uint16_t frames = sys_time - start;
+    printf("%s %u\n", name, (uint16_t)(((uint32_t)frames * CYCLES_PER_FRAME) / TIMING_BYTES));
+}
+
+void timing(void) {
+    uint16_t start, i;
+    uint8_t j;
+
+    puts("cycles per byte:");
+
+    start = timing_start();
+    for (i = 0; i != TIMING_BYTES; i++) sink = (uint8_t)rand();
+    timing_report("rand     ", start);
+
+    start = timing_start();
+    for (i = 0; i != TIMING_BYTES; i++) sink = arand();
+    timing_report("arand    ", start);
+
+    start = timing_start();
+    for (i = 0; i != TIMING_BYTES; i++) sink = xrand();
+    timing_report("xrand    ", start);
+
+    start = timing_start();
+    for (j = 0; j != 64; j++) rand_fill(buf, sizeof(buf));
+    timing_report("rand_fill", start);
+}
+
 void main(void)
 {
+    initarand(0x1234);
+    timing();
+
     while(TRUE) {
         puts("press A...");
         waitpad(J_A);
         initarand(sys_time);
-        for (uint8_t i = 0; i != 16; i++) 
+        initxrand(sys_time);
+        for (uint8_t i = 0; i != 8; i++)
             printf("rand=%hx arand=%hx\n", (uint8_t)rand(), (uint8_t)arand());
+        for (uint8_t i = 0; i != 8; i++)
+            printf("xrand=%hx range(6)=%hu\n", xrand(), rand_range(6));
     }
 }
-
-    
-    
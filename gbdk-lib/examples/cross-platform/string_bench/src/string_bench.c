@@ -0,0 +1,99 @@
+/*
+    string_bench.c
+    Measures the cost per byte of the string and memory routines
+
+    Each routine is called in a loop for BENCH_FRAMES frames, and the
+    time of an empty loop is subtracted. The results are in CPU clock
+    cycles per byte (T-states on the Game Boy, divide by 4 for M-cycles),
+    rounded down, for NTSC timing where it matters.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <gbdk/platform.h>
+#include <gbdk/textfmt.h>
+
+#if defined(__TARGET_gb) || defined(__TARGET_ap) || defined(__TARGET_duck)
+  #define CYCLES_PER_FRAME 70224UL
+#elif defined(__TARGET_sms) || defined(__TARGET_gg)
+  #define CYCLES_PER_FRAME 59736UL
+#elif defined(__TARGET_nes)
+  #define CYCLES_PER_FRAME 29781UL
+#endif
+
+#define BENCH_FRAMES 16
+#define MAX_SIZE     256
+
+enum { BENCH_NONE, BENCH_MEMSET, BENCH_MEMCPY, BENCH_MEMMOVE, BENCH_MEMCMP, BENCH_STRLEN, BENCH_COUNT };
+
+static const char * const bench_names[BENCH_COUNT] = { "", "set", "cpy", "mov", "cmp", "len" };
+static const uint16_t bench_sizes[] = { 4, 16, 64, MAX_SIZE };
+
+static uint8_t buf_a[MAX_SIZE + 1], buf_b[MAX_SIZE + 1];
+static volatile int bench_result;  // Keeps results from being optimized away
+
+static void bench_call(uint8_t bench, uint16_t size)
+{
+    switch (bench) {
+        case BENCH_MEMSET:  memset(buf_a, 'x', size); break;
+        case BENCH_MEMCPY:  memcpy(buf_b, buf_a, size); break;
+        case BENCH_MEMMOVE: memmove(buf_a + 1, buf_a, size); break;  // Overlapping, copies backwards
+        case BENCH_MEMCMP:  bench_result = memcmp(buf_a, buf_b, size); break;  // Equal, compares all bytes
+        case BENCH_STRLEN:  bench_result = strlen((const char *)buf_a); break;
+    }
+}
+
+// printf() does not support a field width, so pad to 4 characters here
+static void print_col(uint16_t n)
+{
+    uint8_t digits[6];
+    uint8_t len = fmt_u16(n, '0', digits);
+
+    while (len++ < 4) putchar(' ');
+    printf("%s", (const char *)digits);
+}
+
+// Returns the number of calls which fit in BENCH_FRAMES frames
+static uint16_t bench_count(uint8_t bench, uint16_t size)
+{
+    uint16_t calls = 0, start;
+
+    // Set up buffers which are all size bytes long, and equal
+    memset(buf_a, 'x', size);
+    buf_a[size] = 0;
+    memcpy(buf_b, buf_a, size + 1);
+
+    vsync();
+    start = sys_time;
+    while ((uint16_t)(sys_time - start) < BENCH_FRAMES) {
+        bench_call(bench, size);
+        calls++;
+    }
+    return calls;
+}
+
+void main(void)
+{
+    uint8_t bench, i;
+    uint16_t size;
+    uint32_t loop_cycles, call_cycles;
+
+    printf("cycles per byte\n\n   ");
+    for (i = 0; i != 4; i++) print_col(bench_sizes[i]);
+    printf("\n");
+
+    for (bench = BENCH_MEMSET; bench != BENCH_COUNT; bench++) {
+        printf("%s", bench_names[bench]);
+        for (i = 0; i != 4; i++) {
+            size = bench_sizes[i];
+            loop_cycles = (BENCH_FRAMES * CYCLES_PER_FRAME) / bench_count(BENCH_NONE, size);
+            call_cycles = (BENCH_FRAMES * CYCLES_PER_FRAME) / bench_count(bench, size);
+            call_cycles = (call_cycles > loop_cycles) ? (call_cycles - loop_cycles) : 0;
+            print_col((uint16_t)(call_cycles / size));
+        }
+        printf("\n");
+    }
+    printf("\ndone\n");
+}
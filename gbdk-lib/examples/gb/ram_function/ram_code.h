@@ -0,0 +1,13 @@
+#ifndef RAM_CODE_H
+#define RAM_CODE_H
+
+#include <stdint.h>
+
+extern uint16_t counter;
+
+// in the _CODE_RAM area, runs from WRAM
+void inc_ram(void);
+// in the _CODE_HRAM area, runs from HIRAM
+void inc_hiram(void);
+
+#endif
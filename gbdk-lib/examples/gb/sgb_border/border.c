@@ -1,5 +1,6 @@
 #include <gb/gb.h>
 #include <stdint.h>
+#include <gb/sgb.h>
 #include "sgb_border.h"
 
 #include "border_data.h"
@@ -25,9 +26,16 @@ void main(void) {
     // For SGB on PAL SNES this delay is required on startup, otherwise borders don't show up
     for (uint8_t i = 4; i != 0; i--) vsync();
 
-    // The display must be ON before calling set_sgb_border()
+    // SGB packets are sent from the VBlank handler
+    CRITICAL {
+        add_VBL(sgb_queue_isr);
+    }
     DISPLAY_ON;
-    set_sgb_border(border_data_tiles, sizeof(border_data_tiles), border_data_map, sizeof(border_data_map), border_data_palettes, sizeof(border_data_palettes));
+#if border_data_CHR_TRN_COUNT > 1
+    set_sgb_border(border_data_chr_trn_0, sizeof(border_data_chr_trn_0), border_data_chr_trn_1, sizeof(border_data_chr_trn_1), border_data_pct_trn, sizeof(border_data_pct_trn));
+#else
+    set_sgb_border(border_data_chr_trn_0, sizeof(border_data_chr_trn_0), NULL, 0, border_data_pct_trn, sizeof(border_data_pct_trn));
+#endif
     while(1) {
         vsync();
     }
@@ -11,61 +11,37 @@
 #define SGB_SCR_FREEZE 1
 #define SGB_SCR_UNFREEZE 0
 
-#define SGB_TRANSFER(A,B) map_buf[0]=(A),map_buf[1]=(B),sgb_transfer(map_buf) 
-
-// The display must be turned on before calling this function
-// (with @ref DISPLAY_ON).
-void set_sgb_border(unsigned char * tiledata, size_t tiledata_size,
-                    unsigned char * tilemap, size_t tilemap_size,
-                    unsigned char * palette, size_t palette_size) {
+// The SGB queue handler must be installed with add_VBL(sgb_queue_isr)
+void set_sgb_border(const uint8_t * chr_trn_0, size_t chr_trn_0_size,
+                    const uint8_t * chr_trn_1, size_t chr_trn_1_size,
+                    const uint8_t * pct_trn, size_t pct_trn_size) {
     if (sgb_check()) {
-        unsigned char map_buf[20];
-        memset(map_buf, 0, sizeof(map_buf));
-
-        SGB_TRANSFER((SGB_MASK_EN << 3) | 1, SGB_SCR_FREEZE); 
+        unsigned char packet[16];
+        memset(packet, 0, sizeof(packet));
 
-        BGP_REG = OBP0_REG = OBP1_REG = 0xE4U;
-        SCX_REG = SCY_REG = 0U;
+        packet[0] = (SGB_MASK_EN << 3) | 1, packet[1] = SGB_SCR_FREEZE;
+        sgb_queue_transfer(packet);
 
         uint8_t tmp_lcdc = LCDC_REG;
 
-        HIDE_SPRITES, HIDE_WIN, SHOW_BKG;
-        DISPLAY_ON;
-        // prepare tilemap for SGB_BORDER_CHR_TRN (should display all 256 tiles)
-        uint8_t i = 0U;
-        for (uint8_t y = 0; y != 14U; ++y) {
-            uint8_t * dout = map_buf;
-            for (uint8_t x = 0U; x != 20U; ++x) {
-                *dout++ = i++;
-            }
-            set_bkg_tiles(0, y, 20, 1, map_buf);
-        }
-        memset(map_buf, 0, sizeof(map_buf));
-
-        // transfer tile data
-        uint8_t ntiles = (tiledata_size > 256 * 32) ? 0 : tiledata_size >> 5;
-        if ((!ntiles) || (ntiles > 128U)) { 
-            set_bkg_data(0, 0, tiledata); 
-            SGB_TRANSFER((SGB_CHR_TRN << 3) | 1, SGB_CHR_BLOCK0);
-            if (ntiles) ntiles -= 128U; 
-            tiledata += (128 * 32);
-            set_bkg_data(0, ntiles << 1, tiledata); 
-            SGB_TRANSFER((SGB_CHR_TRN << 3) | 1, SGB_CHR_BLOCK1);
-        } else { 
-            set_bkg_data(0, ntiles << 1, tiledata); 
-            SGB_TRANSFER((SGB_CHR_TRN << 3) | 1, SGB_CHR_BLOCK0);
+        // transfer tile data, png2asset -sgb_border splits it into the CHR_TRN blocks
+        packet[0] = (SGB_CHR_TRN << 3) | 1, packet[1] = SGB_CHR_BLOCK0;
+        sgb_vram_transfer(packet, chr_trn_0, chr_trn_0_size);
+        if (chr_trn_1_size) {
+            packet[1] = SGB_CHR_BLOCK1;
+            sgb_vram_transfer(packet, chr_trn_1, chr_trn_1_size);
         }
 
         // transfer map and palettes
-        set_bkg_data(0, (uint8_t)(tilemap_size >> 4), tilemap);
-        set_bkg_data(128, (uint8_t)(palette_size >> 4), palette);
-        SGB_TRANSFER((SGB_PCT_TRN << 3) | 1, 0);
+        packet[0] = (SGB_PCT_TRN << 3) | 1, packet[1] = 0;
+        sgb_vram_transfer(packet, pct_trn, pct_trn_size);
 
         LCDC_REG = tmp_lcdc;
 
         // clear SCREEN
         fill_bkg_rect(0, 0, 20, 18, 0);
-        
-        SGB_TRANSFER((SGB_MASK_EN << 3) | 1, SGB_SCR_UNFREEZE); 
+
+        packet[0] = (SGB_MASK_EN << 3) | 1, packet[1] = SGB_SCR_UNFREEZE;
+        sgb_queue_transfer(packet);
     }
 }
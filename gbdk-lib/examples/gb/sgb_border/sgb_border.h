@@ -8,8 +8,11 @@
 
 /** sets SGB border
 
-    The display must be turned on before calling this function
-    (with @ref DISPLAY_ON).
+    Takes the data exported by png2asset `-sgb_border`, pass
+    NULL and 0 for __chr_trn_1__ when there is only one block.
+
+    The VBlank handler @ref sgb_queue_isr() must be installed
+    before calling this function (with @ref add_VBL()).
 
     When using the SGB with a PAL SNES, a delay should be added
     just after program startup such as:
@@ -20,8 +23,8 @@
     for (uint8_t i = 4; i != 0; i--) vsync();
     \endcode
 */
-void set_sgb_border(unsigned char * tiledata, size_t tiledata_size,
-                    unsigned char * tilemap, size_t tilemap_size,
-                    unsigned char * palette, size_t palette_size);
+void set_sgb_border(const uint8_t * chr_trn_0, size_t chr_trn_0_size,
+                    const uint8_t * chr_trn_1, size_t chr_trn_1_size,
+                    const uint8_t * pct_trn, size_t pct_trn_size);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+/** @file gb/asset_loader.h
+
+    Loading packed maps a little every frame
+
+    @ref load_packaged_map() loads everything at once, so level
+    changes usually blank the screen while it runs. The asset loader
+    takes a list (manifest) of packed maps in ROM banks, each one
+    written by @ref utility_png2asset "png2asset" `-map -bin_packed`,
+    and loads them in slices of @ref asset_loader_budget bytes from
+    the main loop instead. Tiles and maps drawn on the background go
+    through the deferred VRAM queue (see gb/vram_queue.h), gbcompress
+    sections are decompressed with @ref gb_decompress_step(), so the
+    game keeps running while the next level loads:
+    \code{.c}
+    INCBIN_EXTERN(level2_tiles_packed)   // png2asset -tile_origin 128 ...
+    INCBIN_EXTERN(level2_packed)
+
+    uint8_t level2_map[LEVEL2_W * LEVEL2_H * 2];
+
+    const asset_entry_t level2_assets[] = {
+        { level2_tiles_packed, BANK(level2_tiles_packed), 0, NULL },
+        { level2_packed, BANK(level2_packed), ASSET_LOADER_PALETTES, level2_map }
+    };
+
+    void show_progress(uint16_t done, uint16_t total) {
+        ...
+    }
+
+    CRITICAL {
+        add_VBL(vram_queue_isr);
+    }
+    ...
+    // The level ends in a few seconds: start loading the next one
+    asset_loader_start(level2_assets, 2, show_progress);
+    ...
+    // Once each frame
+    asset_loader_step();
+    ...
+    // At the end of the level, finish whatever is left
+    asset_loader_wait();
+    \endcode
+
+    Loading while a level is shown only makes sense into memory it
+    does not use: a map buffer in RAM (see @ref load_packaged_map()),
+    tiles above the ones in use (png2asset `-tile_origin`) or the
+    tiles of VRAM bank 1 on the CGB. Palettes change the colors on
+    screen, so they are only written with @ref ASSET_LOADER_PALETTES.
+
+    The same sections as with @ref load_packaged_map() are loaded,
+    with the same limits. In addition tiles compressed with gbcompress
+    must not cross from tile 127 to 128 while the background uses the
+    tiles at $8800-$97FF (LCDCF_BG8800), since the decompressor
+    writes them in one run.
+
+    RLE sections use the single state of @ref rle_decompress(), so
+    the game must not decompress RLE data itself while the loader
+    works on one.
+
+    Only one manifest is loaded at a time.
+*/
+
+#ifndef __ASSET_LOADER_H_INCLUDE
+#define __ASSET_LOADER_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/packed_map.h>
+
+/** Flag of @ref asset_entry_t: write the palettes of the packed map (CGB only)
+ */
+#define ASSET_LOADER_PALETTES 0x01
+
+/** A packed map of a manifest
+ */
+typedef struct asset_entry_t {
+    const uint8_t * data;   /**< Packed map written by png2asset `-bin_packed` */
+    uint8_t bank;           /**< ROM bank of __data__ */
+    uint8_t flags;          /**< Zero or @ref ASSET_LOADER_PALETTES */
+    uint8_t * map_buf;      /**< Buffer for the map and attributes, or NULL to draw the map at 0, 0 */
+} asset_entry_t;
+
+/** Progress callback of @ref asset_loader_start()
+
+    @param done   Number of bytes loaded so far
+    @param total  Number of bytes of the whole manifest
+
+    Sizes are counted decompressed.
+*/
+typedef void (*asset_progress_t)(uint16_t done, uint16_t total);
+
+/** Maximum number of bytes loaded by each call of @ref asset_loader_step()
+
+    Defaults to 128 bytes, the default @ref vram_queue_budget, so the
+    VRAM queue is emptied each VBlank as fast as the loader fills it.
+    Raise it while the screen is blanked.
+ */
+extern uint16_t asset_loader_budget;
+
+/** Starts loading a manifest
+
+    @param entries   Table of __count__ packed maps, which must stay unchanged while loading
+    @param count     Number of entries
+    @param progress  Called after each @ref asset_loader_step(), or NULL
+
+    The header and sections of each entry are checked before anything
+    is loaded. Nothing is loaded until @ref asset_loader_step() is called.
+    Stops any manifest still loading.
+
+    @return PACKED_MAP_OK, PACKED_MAP_ERR_FORMAT or PACKED_MAP_ERR_BUF
+*/
+uint8_t asset_loader_start(const asset_entry_t * entries, uint8_t count, asset_progress_t progress);
+
+/** Loads up to @ref asset_loader_budget bytes of the manifest, call it once per frame
+
+    The ROM bank of each entry is switched in while loading it,
+    then the bank which was switched in before is restored.
+
+    @return TRUE while there is more to load
+*/
+uint8_t asset_loader_step(void);
+
+/** Returns TRUE while a manifest is loading
+*/
+uint8_t asset_loader_busy(void);
+
+/** Loads what is left of the manifest, one step per frame, and waits until
+    the VRAM queue has written all of it
+*/
+void asset_loader_wait(void);
+
+/** Stops loading, sections already loaded stay as they are
+*/
+void asset_loader_stop(void);
+
+#endif
@@ -58,4 +58,73 @@ void bcd_sub(BCD * sour, const BCD * value) OLDCALL;
 */
 uint8_t bcd2text(const BCD * bcd, uint8_t tile_offset, uint8_t * buffer) OLDCALL;
 
+/** Value to fill the shadow of @ref bcd2vram() with, so that all digits get drawn */
+#define BCD_SHADOW_INVALID 0xFFu
+
+/** Adds two BCD numbers of __len__ bytes: __sour__ += __value__
+    @param sour   BCD value to add to (and where the result is stored)
+    @param value  BCD value to add to __sour__
+    @param len    Length of both values in bytes, 2 digits per byte
+
+    Variable length BCD values are stored like @ref BCD: least
+    significant byte first. A @ref BCD is one of 4 bytes, so longer
+    ones can hold scores of up to 16 digits in 8 bytes.
+*/
+void bcd_add_n(uint8_t * sour, const uint8_t * value, uint8_t len) OLDCALL;
+
+/** Subtracts two BCD numbers of __len__ bytes: __sour__ -= __value__
+    @param sour   BCD value to subtract from (and where the result is stored)
+    @param value  BCD value to subtract from __sour__
+    @param len    Length of both values in bytes, 2 digits per byte
+*/
+void bcd_sub_n(uint8_t * sour, const uint8_t * value, uint8_t len) OLDCALL;
+
+/** Converts a BCD number of __len__ bytes into an asciiz (null terminated) string
+    @param bcd          BCD value to convert
+    @param len          Length of __bcd__ in bytes, 2 digits per byte
+    @param tile_offset  Per-character offset value to add, see @ref bcd2text()
+    @param buffer       Buffer of __len__ * 2 + 1 bytes to store the result in
+
+    Returns: Length in characters (__len__ * 2)
+*/
+uint8_t bcd2text_n(const uint8_t * bcd, uint8_t len, uint8_t tile_offset, uint8_t * buffer) OLDCALL;
+
+/** Draws the digits of a BCD number which changed since the last call
+    straight into a tile map
+    @param addr         Tile map address of the first (most significant) digit,
+                        for example from @ref get_win_xy_addr()
+    @param bcd          BCD value to draw
+    @param len          Length of __bcd__ in bytes, 2 digits per byte
+    @param tile_offset  Index of the font tile '0'
+    @param shadow       Buffer of __len__ bytes with the value drawn last,
+                        updated by the call
+
+    Only the digits which differ from __shadow__ are written to VRAM,
+    so for a score which changes a few digits at a time it costs a
+    few writes per frame instead of a set_bkg_tiles() of all digits.
+    Fill __shadow__ with @ref BCD_SHADOW_INVALID to draw all digits,
+    for example after the tile map was cleared.
+    \code{.c}
+    uint8_t score[4], score_shadow[4];
+    ...
+    memset(score_shadow, BCD_SHADOW_INVALID, sizeof(score_shadow));
+    ...
+    bcd_add_n(score, points, sizeof(score));
+    bcd2vram_xy(12, 0, score, sizeof(score), 0x10, score_shadow);  // Font tile '0' at 0x10
+    \endcode
+
+    The digits must fit in the row of the tile map.
+*/
+void bcd2vram(uint8_t * addr, const uint8_t * bcd, uint8_t len, uint8_t tile_offset, uint8_t * shadow);
+
+/** Same as @ref bcd2vram() for the background tile map at __x__, __y__
+    @param x            X coordinate of the first digit in tiles
+    @param y            Y coordinate in tiles
+    @param bcd          BCD value to draw
+    @param len          Length of __bcd__ in bytes, 2 digits per byte
+    @param tile_offset  Index of the font tile '0'
+    @param shadow       Buffer of __len__ bytes with the value drawn last
+*/
+void bcd2vram_xy(uint8_t x, uint8_t y, const uint8_t * bcd, uint8_t len, uint8_t tile_offset, uint8_t * shadow);
+
 #endif
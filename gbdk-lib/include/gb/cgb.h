@@ -155,6 +155,8 @@ void set_sprite_palette_entry(uint8_t palette, uint8_t entry, uint16_t rgb_data)
 
     \li You can check to see if @ref _cpu == @ref CGB_TYPE before using this function.
 
+    A running timer keeps its rate, see @ref cpu_fast().
+
     @see cpu_fast()
  */
 void cpu_slow(void);
@@ -169,7 +171,14 @@ void cpu_slow(void);
     \li Interrupts are temporarily disabled and then re-enabled during this call.
     \li You can check to see if @ref _cpu == @ref CGB_TYPE before using this function.
 
-    @see cpu_slow(), _cpu
+    Library timing follows the speed: @ref delay() waits the same time in both
+    modes, and if the timer is running (@ref TACF_START set in @ref TAC_REG)
+    TMA_REG and TAC_REG get changed so that the timer interrupt keeps its rate.
+    The timer should be started after switching speed, or with the values for
+    the speed it is started in. Timer periods which can't be doubled or halved
+    exactly are rounded. The serial clock of a link cable master is doubled.
+
+    @see cpu_slow(), _cpu, PERF_CPU_FAST_AVAILABLE()
 */
 void cpu_fast(void);
 
@@ -187,4 +196,102 @@ void set_default_palette(void);
  */
 void cgb_compatibility(void);
 
+/** Sets VRAM Tile Pattern data for the Background / Window using CGB General Purpose DMA
+
+    @param first_tile  Index of the first Tile to write
+    @param nb_tiles    Number of Tiles to write
+    @param data        Pointer to source Tile Pattern data
+
+    Same arguments and tile addressing (including the $8800 - $97FF wrap) as
+    @ref set_bkg_data(), but the copy is done by the CGB DMA hardware in 16 byte blocks
+    instead of by the CPU. The CPU is halted until the transfer is done.
+
+    The DMA does not wait for VRAM to become accessible. Only call this while the
+    LCD is off or in VBlank with enough time left for the transfer (each tile takes
+    about 8 microseconds, in single speed mode).
+
+    \li __data__ must be 16 byte aligned and located in ROM or WRAM (not VRAM or OAM)
+    \li On DMG, or if __data__ is not 16 byte aligned, this falls back to @ref set_bkg_data()
+    \li @ref VBK_REG determines which bank of tile patterns is written to
+
+    @see hdma_set_bkg_data_hblank(), hdma_set_sprite_data()
+*/
+void hdma_set_bkg_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
+
+/** Sets VRAM Tile Pattern data for Sprites using CGB General Purpose DMA
+
+    @param first_tile  Index of the first Tile to write
+    @param nb_tiles    Number of Tiles to write
+    @param data        Pointer to source Tile Pattern data
+
+    Sprite version of @ref hdma_set_bkg_data(), same requirements apply.
+    Falls back to @ref set_sprite_data() on DMG.
+
+    @see hdma_set_sprite_data_hblank()
+*/
+void hdma_set_sprite_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
+
+/** Queues a Background / Window Tile Pattern upload using CGB HBlank DMA
+
+    @param first_tile  Index of the first Tile to write
+    @param nb_tiles    Number of Tiles to write
+    @param data        Pointer to source Tile Pattern data
+
+    The DMA hardware copies one 16 byte block (one tile) during each HBlank,
+    so VRAM can be written safely while the LCD is on and the function returns
+    before the copy is done. Use @ref hdma_wait() before changing __data__,
+    @ref VBK_REG, or starting another DMA.
+
+    \li Up to 128 tiles are queued at once. Larger uploads, or ones which cross the
+         $9800 wrap point, wait for each previous part to finish before queuing the next
+    \li If the LCD is off this uses General Purpose DMA instead
+    \li __data__ must be 16 byte aligned and located in ROM or WRAM (not VRAM or OAM)
+    \li On DMG, or if __data__ is not 16 byte aligned, this falls back to @ref set_bkg_data()
+    \li If __data__ is in a switchable ROM or WRAM bank, that bank must stay selected until the transfer is done
+
+    @see hdma_set_bkg_data(), hdma_wait()
+*/
+void hdma_set_bkg_data_hblank(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
+
+/** Queues a Sprite Tile Pattern upload using CGB HBlank DMA
+
+    @param first_tile  Index of the first Tile to write
+    @param nb_tiles    Number of Tiles to write
+    @param data        Pointer to source Tile Pattern data
+
+    Sprite version of @ref hdma_set_bkg_data_hblank(), same requirements apply.
+    Falls back to @ref set_sprite_data() on DMG.
+*/
+void hdma_set_sprite_data_hblank(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
+
+/** Waits until a transfer started by @ref hdma_set_bkg_data_hblank() or
+    @ref hdma_set_sprite_data_hblank() has finished.
+
+    Returns immediately on DMG or when no transfer is in progress.
+*/
+void hdma_wait(void) PRESERVES_REGS(b, c, d, e, h, l);
+
+/** Sets Background / Window Tile Pattern data in both CGB VRAM banks
+
+    @param first_tile      Index of the first tile to write, in both banks
+    @param nb_tiles        Number of tiles to write to VRAM bank 0 (up to 256)
+    @param data            Pointer to the tile data for bank 0
+    @param nb_tiles_bank1  Number of tiles to write to VRAM bank 1 (up to 256, or 0)
+    @param data_bank1      Pointer to the tile data for bank 1
+
+    Loads maps which png2asset converted with `-use_map_attributes`
+    and more tiles than fit in bank 0: the extra ones are exported as
+    `_tiles_bank1` and the map attributes of the tiles using them
+    select VRAM bank 1 (bit 3).
+    \code{.c}
+    set_bkg_data_cgb(0, bigmap_TILE_COUNT, bigmap_tiles, bigmap_TILE_COUNT_BANK1, bigmap_tiles_bank1);
+    \endcode
+
+    @ref VBK_REG is left at @ref VBK_BANK_0. On DMG only the tiles
+    for bank 0 are written.
+
+    @see set_bkg_data()
+*/
+void set_bkg_data_cgb(uint8_t first_tile, uint16_t nb_tiles, const uint8_t *data, uint16_t nb_tiles_bank1, const uint8_t *data_bank1);
+
 #endif /* _CGB_H */
@@ -11,10 +11,47 @@
     \endcode
 
     Also see the `crash` example project included with gbdk.
+
+    \section crash_breadcrumbs Breadcrumbs
+
+    The register dump shows where the program stopped, but often not
+    how it got there. When `GBDK_CRASH_BREADCRUMBS` is defined (for
+    example with `-DGBDK_CRASH_BREADCRUMBS` on the lcc command line)
+    @ref CRASH_ZONE() records a zone id in a ring of the last
+    @ref CRASH_ZONE_COUNT ids in HRAM, which costs a call and a few
+    `ldh` instructions. The profiling zones record ids too:
+    \li @ref EMU_PROFILE_ZONE_BEGIN() the low byte of its line number
+    \li @ref PERF_ISR_BEGIN() 0xF0 + its slot
+
+    After @ref crash_breadcrumbs_init() the crash screen shows the ids,
+    newest first, in the line under the header (` Z:`), and in its
+    last line the VBlanks counted as dropped (` DROP:`) and the stack
+    high water mark from @ref stack_high_water() (` STK:`).
+    \code{.c}
+    #include <gb/crash_handler.h>
+    #include <gbdk/perf.h>
+
+    void main(void) {
+        crash_breadcrumbs_init(&perf.dropped);  // NULL without GBDK_PERF
+        while (TRUE) {
+            CRASH_ZONE(0x01);
+            update_actors();
+            CRASH_ZONE(0x02);
+            draw_actors();
+            vsync();
+        }
+    }
+    \endcode
+
+    Without `GBDK_CRASH_BREADCRUMBS` the macros produce no code, so
+    they can be left in release builds.
 */
 #ifndef __CRASH_HANDLER_INCLUDE
 #define __CRASH_HANDLER_INCLUDE
 
+#include <types.h>
+#include <stdint.h>
+
 /** Display the crash dump screen.
 
     See the intro for this file for more details.
@@ -22,4 +59,29 @@
 void __HandleCrash(void);
 static void * __CRASH_HANDLER_INIT = &__HandleCrash;
 
+/** Number of zone ids kept for the crash screen */
+#define CRASH_ZONE_COUNT 6
+
+/** Clears the breadcrumbs and shows them on the crash screen
+
+    @param dropped  Counter shown as ` DROP:`, usually `&perf.dropped`
+                    from gbdk/perf.h, or NULL
+
+    Also links in the stack paint of @ref stack_high_water().
+*/
+void crash_breadcrumbs_init(const uint16_t * dropped);
+
+/** Records __id__ as the latest breadcrumb, see @ref CRASH_ZONE() */
+void crash_zone(uint8_t id);
+
+/** Records __ID__ as the latest breadcrumb if `GBDK_CRASH_BREADCRUMBS` is defined
+
+    @param ID  Zone id, 0x00 - 0xEF (0xF0 - 0xF3 are used by @ref PERF_ISR_BEGIN())
+*/
+#if defined(GBDK_CRASH_BREADCRUMBS)
+#define CRASH_ZONE(ID) crash_zone(ID)
+#else
+#define CRASH_ZONE(ID)
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,130 @@
+/** @file gb/dmg_palette.h
+
+    DMG palette animations played from VBlank
+
+    The DMG counterpart of gbdk/palette_fade.h: a table of steps, each
+    one a value for @ref BGP_REG, @ref OBP0_REG and @ref OBP1_REG, is
+    played by @ref dmg_palette_vbl() one step every few frames. On the
+    frames between steps the handler only counts down, so fades,
+    flashes and water cycling cost the main loop nothing:
+    \code{.c}
+    // Water: cycle the three lighter shades
+    const dmg_palette_step_t water[] = {
+        { DMG_PALETTE(DMG_WHITE, DMG_LITE_GRAY, DMG_DARK_GRAY, DMG_BLACK), 0xE4, 0xE4 },
+        { DMG_PALETTE(DMG_LITE_GRAY, DMG_DARK_GRAY, DMG_WHITE, DMG_BLACK), 0xE4, 0xE4 },
+        { DMG_PALETTE(DMG_DARK_GRAY, DMG_WHITE, DMG_LITE_GRAY, DMG_BLACK), 0xE4, 0xE4 }
+    };
+    dmg_palette_step_t fade[3];
+    ...
+    CRITICAL {
+        add_VBL(dmg_palette_vbl);
+    }
+    dmg_palette_play(water, 3, 8, DMG_PALETTE_BGP | DMG_PALETTE_LOOP);
+    ...
+    dmg_palette_fade_start(fade, &level_colors, &all_white, 3, 4, DMG_PALETTE_ALL);
+    dmg_palette_wait();
+    \endcode
+
+    With @ref DMG_PALETTE_LINES the BGP value of each step goes to the
+    entries of a scanline_fx table set with @ref dmg_palette_lines()
+    instead (see gb/scanline_fx.h), so only a band of lines is
+    animated, for example the water at the bottom of the screen.
+    Add @ref dmg_palette_vbl() before @ref scanline_fx_vbl_isr() so
+    the new value is used in the same frame.
+
+    On the CGB only the DMG compatible mode uses these registers,
+    use gbdk/palette_fade.h there.
+
+    Supported on GB/AP/Duck.
+*/
+
+#ifndef __DMG_PALETTE_H_INCLUDE
+#define __DMG_PALETTE_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gb/scanline_fx.h>
+
+/** Maximum number of steps of @ref dmg_palette_fade_start() */
+#define DMG_PALETTE_FADE_STEPS_MAX 16
+
+/** Flag: start again with the first step after the last one */
+#define DMG_PALETTE_LOOP  0x01
+/** Flag: write the bgp value of each step to @ref BGP_REG */
+#define DMG_PALETTE_BGP   0x02
+/** Flag: write the obp0 value of each step to @ref OBP0_REG */
+#define DMG_PALETTE_OBP0  0x04
+/** Flag: write the obp1 value of each step to @ref OBP1_REG */
+#define DMG_PALETTE_OBP1  0x08
+/** Flag: write the bgp value of each step to the entries set with @ref dmg_palette_lines() */
+#define DMG_PALETTE_LINES 0x10
+/** Flags for all three registers */
+#define DMG_PALETTE_ALL   (DMG_PALETTE_BGP | DMG_PALETTE_OBP0 | DMG_PALETTE_OBP1)
+
+/** One step of an animation */
+typedef struct dmg_palette_step_t {
+    uint8_t bgp;    /**< Value for @ref BGP_REG, see @ref DMG_PALETTE() */
+    uint8_t obp0;   /**< Value for @ref OBP0_REG */
+    uint8_t obp1;   /**< Value for @ref OBP1_REG */
+} dmg_palette_step_t;
+
+/** Starts playing a table of steps
+
+    @param steps   Table of __count__ steps
+    @param count   Number of steps, at least 1
+    @param frames  Number of frames each step is shown
+    @param flags   Registers to write (@ref DMG_PALETTE_BGP, @ref DMG_PALETTE_OBP0,
+                   @ref DMG_PALETTE_OBP1, @ref DMG_PALETTE_LINES), optionally
+                   with @ref DMG_PALETTE_LOOP
+
+    The first step is written by the next call of @ref dmg_palette_vbl().
+    Stops any animation still running.
+*/
+void dmg_palette_play(const dmg_palette_step_t * steps, uint8_t count, uint8_t frames, uint8_t flags);
+
+/** Starts a fade between two sets of palettes
+
+    @param table   Buffer for __count__ steps in RAM
+    @param from    Palettes shown now
+    @param to      Palettes shown at the end of the fade
+    @param count   Number of steps, 1 to @ref DMG_PALETTE_FADE_STEPS_MAX.
+                   The last step shows __to__.
+    @param frames  Number of frames each step is shown
+    @param flags   Registers to write, as for @ref dmg_palette_play()
+
+    Each of the four colors of each palette moves from its shade in
+    __from__ to its shade in __to__. With 3 steps a fade from
+    black to white passes through each shade once, more steps
+    make it slower with the same shades.
+*/
+void dmg_palette_fade_start(dmg_palette_step_t * table, const dmg_palette_step_t * from, const dmg_palette_step_t * to,
+                            uint8_t count, uint8_t frames, uint8_t flags);
+
+/** Sets the scanline_fx entries which @ref DMG_PALETTE_LINES writes
+
+    @param entries  First entry of the band of lines, in the table shown
+    @param count    Number of entries
+
+    The entries of both tables have to be set again after switching
+    between double buffered tables.
+*/
+void dmg_palette_lines(scanline_fx_entry_t * entries, uint8_t count);
+
+/** Stops the animation, the palettes shown stay as they are
+*/
+void dmg_palette_stop(void);
+
+/** Returns TRUE while an animation is running
+*/
+uint8_t dmg_palette_busy(void);
+
+/** Waits until the animation has finished, must not be called
+    while an animation with @ref DMG_PALETTE_LOOP is running
+*/
+void dmg_palette_wait(void);
+
+/** VBlank handler which writes the steps, install it with add_VBL()
+*/
+void dmg_palette_vbl(void);
+
+#endif
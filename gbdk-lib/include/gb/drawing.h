@@ -155,4 +155,39 @@ void gotogxy(uint8_t x, uint8_t y) OLDCALL;
 */
 void color(uint8_t forecolor, uint8_t backcolor, uint8_t mode) OLDCALL;
 
+/** Size in bytes of the framebuffer for @ref apa_framebuffer_set() */
+#define APA_FRAMEBUFFER_SIZE 5760
+
+/** Makes the drawing functions draw into a framebuffer in RAM instead of VRAM
+
+    @param fb  Buffer of @ref APA_FRAMEBUFFER_SIZE bytes, 16 byte aligned,
+               in WRAM or cartridge RAM. NULL draws to VRAM again.
+
+    The drawing functions (@ref plot(), @ref line(), @ref box(),
+    @ref circle(), @ref wrtchr(), etc) then never wait for VRAM to
+    become accessible, and mark the tiles they change dirty.
+    @ref apa_framebuffer_flush() copies the dirty tiles to VRAM,
+    call it once per frame.
+
+    The current picture is copied from VRAM into __fb__ first, and a
+    framebuffer set before is flushed.
+
+    On DMG the tiles are copied with the deferred VRAM queue, so
+    @ref vram_queue_isr() has to be installed with @ref add_VBL()
+    (see gb/vram_queue.h). On CGB they are copied with HBlank DMA,
+    one tile per scanline, so __fb__ must not be in a switchable
+    WRAM bank which gets switched while a flush is in progress.
+
+    @see apa_framebuffer_flush()
+*/
+void apa_framebuffer_set(uint8_t * fb);
+
+/** Copies the tiles of the framebuffer changed since the last flush to VRAM
+
+    Does nothing when no framebuffer is set with @ref apa_framebuffer_set().
+    The copy continues after this returns, during the next VBlanks
+    (DMG) or scanlines (CGB).
+*/
+void apa_framebuffer_flush(void);
+
 #endif /* __DRAWING_H */
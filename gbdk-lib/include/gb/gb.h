@@ -257,10 +257,50 @@ void add_VBL(int_handler h);
     make sure that the time it takes to execute is less
     than the duration of a scanline.
 
-    @see add_VBL, nowait_int_handler, ISR_VECTOR()
+    @see add_VBL, nowait_int_handler, set_LCD_fast(), ISR_VECTOR()
 */
 void add_LCD(int_handler h);
 
+/** Sets a handler that the LCD interrupt jumps to directly
+
+    @param h  The handler, or NULL to ignore LCD interrupts
+
+    For LCD effects that need to start as early as possible
+    after the interrupt, such as raster splits that change
+    registers near the start of a line. The handler is reached
+    through a jump at the vector and one in RAM, without the
+    GBDK ISR dispatcher, so it __must__ be declared with the
+    @ref INTERRUPT attribute (or be assembly that saves the
+    registers it uses and ends with RETI). It also returns
+    without waiting for @ref STAT_REG like @ref nowait_int_handler.
+
+    Cycles (T-states) from the LCD vector to the first
+    instruction of the handler:
+    \li @ref ISR_VECTOR(): 16
+    \li set_LCD_fast(): 32
+    \li add_LCD(): about 160, plus about 180 to return
+        including at least one @ref STAT_REG check
+
+    Unlike with ISR_VECTOR() the handler can be changed at run
+    time, the LCD interrupt is masked while it is switched.
+
+    Can not be used together with add_LCD() or in the same program
+    as `stdio.h`, since they all install code at the LCD vector.
+
+    Example:
+    \code{.c}
+    void scanline_isr(void) INTERRUPT {
+        SCX_REG++;
+    }
+    ...
+    set_LCD_fast(scanline_isr);
+    set_interrupts(VBL_IFLAG | LCD_IFLAG);
+    \endcode
+
+    @see add_LCD, ISR_VECTOR()
+*/
+void set_LCD_fast(int_handler h);
+
 /** Adds a timer interrupt handler.
 
     Can not be used together with @ref add_low_priority_TIM
@@ -360,6 +400,37 @@ void nowait_int_handler(void);
 */
 void wait_int_handler(void);
 
+/** Interrupt handler which saves the ROM bank for the handlers after it
+
+    Add it to a chain before handlers which switch ROM banks, such
+    as a music driver reading its data from a banked song. The
+    handlers added after it in the same chain can then use
+    @ref SWITCH_ROM() freely: once they have all run, @ref _current_bank
+    and the MBC are set back to the bank which the interrupted code
+    had switched in, so neither side has to save and restore it or
+    disable interrupts around its own bank switches.
+
+    Handlers added before it, and other chains, are not affected and
+    cost nothing extra.
+
+    Example:
+    \code{.c}
+    CRITICAL {
+        add_VBL(isr_save_bank);
+        add_VBL(music_isr);      // Switches to the bank of the song
+    }
+    \endcode
+
+    @ref nowait_int_handler and @ref wait_int_handler may still be
+    added after it to end the chain. Only @ref SWITCH_ROM() (MBC1, MBC5
+    up to bank 255, MegaDuck) is restored, not @ref SWITCH_ROM_MBC5_8M()
+    or RAM banks. Handlers installed with @ref ISR_VECTOR() do not go
+    through the chains and have to save the bank themselves.
+
+    @see add_VBL, add_LCD, add_TIM, add_SIO, add_JOY, SWITCH_ROM_ATOMIC()
+*/
+void isr_save_bank(void);
+
 /** Cancel pending interrupts
  */
 inline uint8_t cancel_pending_interrupts(void) {
@@ -538,6 +609,19 @@ __endasm; \
 */
 #define SWITCH_ROM(b) (_current_bank = (b), rROMB0 = (b))
 
+/** Makes default platform MBC switch the active ROM bank with interrupts disabled
+    @param b   ROM bank to switch to (max 255)
+
+    @ref SWITCH_ROM() sets @ref _current_bank before the MBC, which
+    is enough for handlers called after @ref isr_save_bank. This
+    variant keeps an interrupt from coming in between the two at all,
+    for handlers which read @ref _current_bank and expect it to be the
+    bank which is switched in, then restores the interrupt state.
+
+    @see SWITCH_ROM, isr_save_bank
+*/
+#define SWITCH_ROM_ATOMIC(b) do { CRITICAL { SWITCH_ROM(b); } } while(0)
+
 #define SWITCH_RAM(b) (rRAMB = (b))
 
 #define ENABLE_RAM (rRAMG = 0x0A)
@@ -628,7 +712,7 @@ __endasm; \
 
 /** Delays the given number of milliseconds.
     Uses no timers or interrupts, and can be called with
-    interrupts disabled
+    interrupts disabled. Takes CGB double speed mode into account.
  */
 void delay(uint16_t d) PRESERVES_REGS(h, l);
 
@@ -667,6 +751,61 @@ uint8_t waitpad(uint8_t mask) PRESERVES_REGS(b, c, h, l);
 */
 void waitpadup(void) PRESERVES_REGS(a, b, c, d, e, h, l);
 
+/** Reads the joypad once for @ref joypad_current(), @ref joypad_pressed()
+    and the other joypad state accessors.
+
+    Call it once per frame, for example from the VBlank handler:
+    \code{.c}
+    CRITICAL {
+        add_VBL(joypad_update);
+    }
+    ...
+    if (joypad_pressed() & J_A) jump();
+    if (joypad_current() & J_LEFT) walk_left();
+    \endcode
+
+    The state is kept in HRAM, so the accessors are single reads
+    instead of reading the joypad port each time.
+
+    @see joypad_update_debounce()
+*/
+void joypad_update(void) PRESERVES_REGS(b, c, h, l);
+
+/** Same as @ref joypad_update(), but a button only changes state
+    once it reads the same twice in a row. That masks contact
+    bounce, at the cost of a frame of delay for each change.
+*/
+void joypad_update_debounce(void) PRESERVES_REGS(b, c, h, l);
+
+__REG _joypad_cur;
+__REG _joypad_prev;
+__REG _joypad_pressed;
+__REG _joypad_released;
+
+/** Returns the buttons down at the last @ref joypad_update(), an OR of J_*
+*/
+inline uint8_t joypad_current(void) {
+    return _joypad_cur;
+}
+
+/** Returns the buttons down at the @ref joypad_update() before the last one
+*/
+inline uint8_t joypad_previous(void) {
+    return _joypad_prev;
+}
+
+/** Returns the buttons which went down at the last @ref joypad_update()
+*/
+inline uint8_t joypad_pressed(void) {
+    return _joypad_pressed;
+}
+
+/** Returns the buttons which went up at the last @ref joypad_update()
+*/
+inline uint8_t joypad_released(void) {
+    return _joypad_released;
+}
+
 /** Multiplayer joypad structure.
 
     Must be initialized with @ref joypad_init() first then it
@@ -701,6 +840,28 @@ uint8_t joypad_init(uint8_t npads, joypads_t * joypads) OLDCALL;
 */
 void joypad_ex(joypads_t * joypads) PRESERVES_REGS(b, c);
 
+/** State of all avaliable joypads for @ref joypad_ex_update()
+*/
+typedef struct {
+    joypads_t pads;         /**< Buttons down, initialize with joypad_init(npads, &state.pads) */
+    uint8_t previous[4];    /**< Buttons down at the update before */
+    uint8_t pressed[4];     /**< Buttons which went down at the last update */
+    uint8_t released[4];    /**< Buttons which went up at the last update */
+} joypads_state_t;
+
+/** Polls all avaliable joypads like @ref joypad_ex() and works out
+    which buttons went down and up since the last call
+
+    @param state  State to update, __state->pads__ must be initialized
+                  with @ref joypad_init() first
+
+    Call it once per frame. The previous state should start out zeroed,
+    for example by declaring __state__ as a global.
+
+    @see joypad_update()
+*/
+void joypad_ex_update(joypads_state_t * state);
+
 
 
 /** Enables unmasked interrupts
@@ -952,6 +1113,25 @@ inline void set_1bpp_colors(uint8_t fgcolor, uint8_t bgcolor) {
 void set_bkg_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
 #define set_bkg_2bpp_data set_bkg_data
 
+/** Sets VRAM Tile Pattern data for the Background / Window without waiting for VRAM access
+
+    @param first_tile  Index of the first tile to write
+    @param nb_tiles    Number of tiles to write
+    @param data        Pointer to (2 bpp) source tile data
+
+    Same as @ref set_bkg_data(), but does not check STAT before each write,
+    which makes it several times faster.
+
+    Only use this while the LCD is off or during VBlank with enough time
+    left for the copy (each tile takes about 20 microseconds in single
+    speed mode), otherwise the writes may be lost.
+
+    @note @ref set_bkg_data() already skips the STAT checks if the LCD is off.
+
+    @see set_bkg_data, set_sprite_data_nowait, vmemcpy_nowait
+*/
+void set_bkg_data_nowait(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
+
 /** Sets VRAM Tile Pattern data for the Background / Window using 1bpp source data
 
     @param first_tile  Index of the first Tile to write
@@ -1208,6 +1388,30 @@ inline void set_bkg_based_submap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, con
 }
 
 
+/** Sets a rectangular area of the Background Tile Map using a sub-region
+    from a source tile map up to 65535 tiles wide.
+
+    @param x      X Start position in both the Source Tile Map and hardware Background Map tile coordinates. Range 0 - 65535
+    @param y      Y Start position in both the Source Tile Map and hardware Background Map tile coordinates. Range 0 - 65535
+    @param w      Width of area to set in tiles. Range 1 - 255
+    @param h      Height of area to set in tiles. Range 1 - 255
+    @param map    Pointer to source tile map data
+    @param map_w  Width of source tile map in tiles. Range 1 - 65535
+
+    This is identical to @ref set_bkg_submap() except for the 16 bit
+    __x__, __y__ and __map_w__, so a whole column or screen of a wide
+    map can be written with one call instead of one
+    @ref set_bkg_tiles() call per row. The hardware Background Map
+    location is `x & 0x1F`, `y & 0x1F` as well.
+
+    As with @ref set_bkg_submap(), _submap_tile_offset is added to each
+    tile and on CGB @ref VBK_REG selects tiles or attributes.
+
+    @see set_bkg_submap for more details
+*/
+void set_bkg_submap16(uint16_t x, uint16_t y, uint8_t w, uint8_t h, const uint8_t *map, uint16_t map_w) OLDCALL;
+
+
 /** Sets a rectangular area of the Background Tile Map Attributes using a sub-region
     from a source tile attribute map. Useful for scrolling implementations of maps
     larger than 32 x 32 tiles.
@@ -1260,6 +1464,30 @@ inline void set_bkg_submap_attributes(uint8_t x, uint8_t y, uint8_t w, uint8_t h
     VBK_REG = VBK_TILES;
 }
 
+/** Sets a rectangular area of the Background Tile Map and its CGB attributes from wider source maps
+
+    @param x           X Start position in Background Map tile coordinates. Range 0 - 31
+    @param y           Y Start position in Background Map tile coordinates. Range 0 - 31
+    @param w           Width of area to set in tiles. Range 1 - 255
+    @param h           Height of area to set in tiles. Range 1 - 255
+    @param map         Pointer to source tile map data
+    @param attributes  Pointer to source attribute map data, same size and layout as __map__
+    @param map_w       Width of source tile map and attribute map in tiles. Range 1 - 255
+
+    Same as calling @ref set_bkg_submap() followed by
+    @ref set_bkg_submap_attributes(), but both maps are written
+    one row after the other, so a scrolling update shows each new
+    row with its attributes and the address and wrap around
+    calculation is only done once.
+
+    On CGB __attributes__ is written to VRAM bank 1, on other
+    models only __map__ is written and __attributes__ is ignored.
+    Returns with @ref VBK_REG set to @ref VBK_TILES.
+
+    @see set_bkg_submap, set_bkg_submap_attributes
+*/
+void set_bkg_submap_with_attributes(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *map, const uint8_t *attributes, uint8_t map_w) OLDCALL;
+
 
 /** Copies a rectangular region of Background Tile Map entries into a buffer.
 
@@ -1365,6 +1593,13 @@ uint8_t * get_win_xy_addr(uint8_t x, uint8_t y) OLDCALL PRESERVES_REGS(b, c);
 */
 void set_win_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
 
+/** Sets VRAM Tile Pattern data for the Window without waiting for VRAM access
+
+    This is the same as @ref set_bkg_data_nowait, since the Window Layer and
+    Background Layer share the same Tile pattern data.
+*/
+void set_win_data_nowait(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
+
 
 /** Sets VRAM Tile Pattern data for the Window / Background using 1bpp source data
 
@@ -1540,6 +1775,24 @@ inline void set_win_based_submap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, con
 }
 
 
+/** Sets a rectangular area of the Window Tile Map using a sub-region
+    from a source tile map up to 65535 tiles wide.
+
+    @param x      X Start position in both the Source Tile Map and hardware Window Map tile coordinates. Range 0 - 65535
+    @param y      Y Start position in both the Source Tile Map and hardware Window Map tile coordinates. Range 0 - 65535
+    @param w      Width of area to set in tiles. Range 1 - 255
+    @param h      Height of area to set in tiles. Range 1 - 255
+    @param map    Pointer to source tile map data
+    @param map_w  Width of source tile map in tiles. Range 1 - 65535
+
+    This is identical to @ref set_win_submap() except for the 16 bit
+    __x__, __y__ and __map_w__.
+
+    @see set_win_submap, set_bkg_submap16
+**/
+void set_win_submap16(uint16_t x, uint16_t y, uint8_t w, uint8_t h, const uint8_t *map, uint16_t map_w) OLDCALL;
+
+
 /** Copies a rectangular region of Window Tile Map entries into a buffer.
 
     @param x      X Start position in Window Map tile coordinates. Range 0 - 31
@@ -1636,6 +1889,17 @@ inline void scroll_win(int8_t x, int8_t y) {
     \li VBK_REG = @ref VBK_BANK_1 indicates the second
 */
 void set_sprite_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
+
+/** Sets VRAM Tile Pattern data for Sprites without waiting for VRAM access
+
+    @param first_tile  Index of the first tile to write
+    @param nb_tiles    Number of tiles to write
+    @param data        Pointer to (2 bpp) source tile data
+
+    Same as @ref set_sprite_data(), but does not check STAT before each write.
+    The same restrictions as for @ref set_bkg_data_nowait() apply.
+*/
+void set_sprite_data_nowait(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) OLDCALL PRESERVES_REGS(b, c);
 #define set_sprite_2bpp_data set_sprite_data
 
 /** Sets VRAM Tile Pattern data for Sprites using 1bpp source data
@@ -1731,6 +1995,53 @@ inline void SET_SHADOW_OAM_ADDRESS(void * address) {
     _shadow_OAM_base = (uint8_t)((uint16_t)address >> 8);
 }
 
+/** Enables double buffering of the shadow OAM
+
+    @param buffer Second shadow OAM, a 256-byte aligned array of at
+                  least MAX_HARDWARE_SPRITES * 4 bytes in WRAM
+
+    The sprites currently in @ref shadow_OAM are copied into __buffer__,
+    and the metasprite functions and @ref hide_sprites_range() then render
+    into __buffer__ (through `__render_shadow_OAM`) while the VBlank handler
+    keeps transferring @ref shadow_OAM. @ref oam_double_buffer_swap() shows
+    the new frame and flips the two buffers, so sprite updates no longer
+    need to be finished before VBlank to avoid tearing.
+
+    @note @ref set_sprite_tile(), @ref move_sprite() and the other single
+    sprite functions always write @ref shadow_OAM, use the metasprite
+    functions or write through `__render_shadow_OAM` instead.
+
+    Calling it again without oam_double_buffer_disable() is not supported.
+
+    @see oam_double_buffer_swap, oam_double_buffer_disable, SET_SHADOW_OAM_ADDRESS
+*/
+void oam_double_buffer_enable(void * buffer);
+
+/** Shows the shadow OAM which has just been rendered from the next VBlank on,
+    and makes the other one the render buffer
+
+    This is a single byte write, the VBlank handler either transfers the
+    old or the new buffer but never one which is half way through an update.
+    Call it once all the sprites for a frame are in place, there is no need
+    to wait for VBlank before or after. It also enables the OAM transfer if
+    it was disabled with @ref DISABLE_VBL_TRANSFER.
+
+    The new render buffer holds the frame before last, so every sprite has
+    to be drawn or hidden again each frame.
+
+    @see oam_double_buffer_enable
+*/
+void oam_double_buffer_swap(void);
+
+/** Disables double buffering of the shadow OAM
+
+    The sprites which are on screen are copied back to @ref shadow_OAM,
+    which is then used for rendering and transfer again.
+
+    @see oam_double_buffer_enable
+*/
+void oam_double_buffer_disable(void);
+
 /** Sets sprite number __nb__in the OAM to display tile number __tile__.
 
     @param nb    Sprite number, range 0 - 39
@@ -1852,6 +2163,55 @@ inline void hide_sprite(uint8_t nb) {
     shadow_OAM[nb].y = 0;
 }
 
+/** Moves __count__ sprites starting with sprite number __first__
+
+    @param first  First sprite number
+    @param count  Number of sprites
+    @param xy     The X and Y position of each sprite, one byte each
+
+    Same as calling @ref move_sprite() for each sprite, but the
+    shadow OAM address is only worked out once. Like the metasprite
+    functions it writes the shadow OAM which is being rendered (see
+    @ref oam_double_buffer_enable()).
+
+    @see shadow_oam_write_block, SPRITE_PTR_DECLARE
+*/
+void move_sprites(uint8_t first, uint8_t count, const uint8_t * xy);
+
+/** Copies __count__ whole OAM entries into the shadow OAM, starting with sprite number __first__
+
+    @param first  First sprite number
+    @param count  Number of sprites
+    @param src    Entries to copy
+
+    Like @ref move_sprites() it writes the shadow OAM which is being rendered.
+*/
+void shadow_oam_write_block(uint8_t first, uint8_t count, const OAM_item_t * src);
+
+/** Declares __p__ as a pointer to the shadow OAM entry of sprite __nb__
+
+    For loops which update a run of sprites: the pointer can stay in
+    registers and is moved on with @ref SPRITE_PTR_NEXT(), instead of
+    working out the address of each sprite from its number.
+    \code{.c}
+    SPRITE_PTR_DECLARE(spr, FIRST_BULLET);
+    for (uint8_t i = 0; i < bullet_count; i++) {
+        SPRITE_PTR_MOVE(spr, bullet_x[i], bullet_y[i]);
+        SPRITE_PTR_NEXT(spr);
+    }
+    \endcode
+    Like @ref move_sprite() these write @ref shadow_OAM.
+*/
+#define SPRITE_PTR_DECLARE(p, nb) OAM_item_t * p = (OAM_item_t *)&shadow_OAM[(nb)]
+/** Moves the sprite at __p__ to __x__, __y__, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_MOVE(p, x_, y_) ((p)->y = (y_), (p)->x = (x_))
+/** Sets the tile of the sprite at __p__, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_SET_TILE(p, t) ((p)->tile = (t))
+/** Sets the properties of the sprite at __p__, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_SET_PROP(p, a) ((p)->prop = (a))
+/** Moves __p__ on to the next sprite, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_NEXT(p) ((p)++)
+
 
 
 /** Copies arbitrary data to an address in VRAM
@@ -1908,6 +2268,88 @@ void get_data(uint8_t *data, uint8_t *vram_addr, uint16_t len);
 */
 void vmemcpy(uint8_t *dest, uint8_t *sour, uint16_t len);
 
+/** Copies arbitrary data from or to VRAM without waiting for VRAM access
+
+    @param dest      Pointer to destination buffer (may be in VRAM)
+    @param sour      Pointer to source buffer (may be in VRAM)
+    @param len       Number of bytes to copy
+
+    Same as @ref vmemcpy(), but does not check STAT before each byte and
+    copies 16 bytes per loop.
+
+    Only use this while the LCD is off or during VBlank with enough time
+    left for the copy, otherwise the data may be lost.
+
+    @note @ref vmemcpy(), @ref set_data() and @ref get_data() already skip
+          the STAT checks if the LCD is off.
+
+    @see set_bkg_data_nowait
+*/
+void vmemcpy_nowait(uint8_t *dest, const uint8_t *sour, uint16_t len);
+
+/** Copies data to VRAM with an unrolled copy loop in HRAM, for bulk uploads during VBlank
+
+    @param dst  Destination pointer (in VRAM)
+    @param src  Source pointer
+    @param n    Number of bytes to copy, 0 to 4096
+
+    The copy loop is 16 times `LD A,(HL+) / LD (DE),A / INC DE` and
+    gets written into the `_CODE_HRAM` area (54 bytes) at startup.
+    @ref vram_blast() enters it at the right offset for __n__, so there
+    is no per byte counting: the copy takes 24 cycles per byte plus 16
+    per 16 bytes. Like @ref vmemcpy_nowait() STAT is not checked.
+
+    Started right after @ref vsync() with the default VBlank handler, at
+    least 128 bytes (8 tiles) get to VRAM before the end of VBlank, 256
+    bytes (16 tiles) in CGB double speed mode. A longer VBlank handler
+    (see @ref add_VBL()) lowers that.
+
+    @see vmemcpy_nowait, set_bkg_data_nowait
+*/
+void vram_blast(uint8_t * dst, const uint8_t * src, uint16_t n);
+
+/** Copies data from a ROM bank, continuing into the following banks
+
+    @param dst       Pointer to destination buffer, in RAM (or VRAM with the LCD off)
+    @param src       Pointer to source data, `0x4000 - 0x7FFF` for banked data
+    @param src_bank  ROM bank of __src__, for example `BANK(asset)`
+    @param n         Number of bytes to copy
+
+    Switches to __src_bank__ for the copy and restores the previously
+    active bank before returning, so it can be called from banked code.
+    Source data which runs past the end of its bank (`0x7FFF`) continues
+    at the start of the next bank (`0x4000`), one memcpy() per bank.
+
+    The bank is switched with @ref SWITCH_ROM(), which sets
+    @ref _current_bank first, so interrupt handlers which switch banks
+    and restore it afterwards are safe.
+
+    @see banked_set_bkg_data, gb_decompress_banked
+*/
+void banked_memcpy(void * dst, const void * src, uint8_t src_bank, uint16_t n);
+
+/** Sets VRAM Tile Pattern data for the Background / Window from a ROM bank
+
+    @param first_tile  Index of the first tile to write
+    @param nb_tiles    Number of tiles to write
+    @param data        Pointer to (2 bpp) source tile data, `0x4000 - 0x7FFF` for banked data
+    @param bank        ROM bank of __data__
+
+    Same as @ref set_bkg_data(), but switches to __bank__ for the copy and
+    restores the previously active bank, like @ref banked_memcpy(). Tile
+    data which runs past the end of its bank continues in the next one; a
+    tile which is split across the two is copied through a RAM buffer.
+
+    @see banked_set_sprite_data
+*/
+void banked_set_bkg_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t * data, uint8_t bank);
+
+/** Sets VRAM Tile Pattern data for Sprites from a ROM bank
+
+    Same as @ref banked_set_bkg_data(), for @ref set_sprite_data().
+*/
+void banked_set_sprite_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t * data, uint8_t bank);
+
 
 
 /** Sets a rectangular region of Tile Map entries at a given VRAM Address
@@ -3,6 +3,14 @@
     GB-Compress decompressor
     Compatible with the compression used in GBTD
     @see utility_gbcompress "gbcompress"
+
+    Data compressed with the `--blocks=<size>` argument of gbcompress
+    is a series of separate streams, one per __size__ bytes, and the
+    index has the offset of each. A single block is decompressed with:
+    \code{.c}
+    // gbcompress --blocks=4096 --cout --varname=level level.bin level.c
+    gb_decompress(level + level_index[block], buf);
+    \endcode
 */
 
 #ifndef __GBDECOMPRESS_H_INCLUDE
@@ -25,6 +33,27 @@
  */
 uint16_t gb_decompress(const uint8_t * sour, uint8_t * dest);
 
+/** gb-decompress data from sour in ROM bank __bank__ into dest
+
+    @param sour   Pointer to source gb-compressed data
+    @param dest   Pointer to destination buffer/address
+    @param bank   ROM bank of the source data
+
+    Same as @ref gb_decompress(), but switches to __bank__ while
+    reading the source data and restores the previously active
+    bank before returning, so it can be called from banked code.
+
+    Compressed data which runs past the end of its bank ($7FFF)
+    continues at the start of the next bank ($4000), so data
+    larger than 16K can be decompressed with one call.
+
+    __sour__ must be in ROM and __dest__ must not be in the
+    switchable ROM bank region.
+
+    @see gb_decompress, rle_decompress_banked
+ */
+uint16_t gb_decompress_banked(const uint8_t * sour, uint8_t * dest, uint8_t bank);
+
 
 /** gb-decompress background tiles into VRAM
 
@@ -0,0 +1,140 @@
+/** @file gb/hud.h
+
+    Status bars on the window layer
+
+    A HUD drawn on the background has to be redrawn whenever the
+    playfield scrolls under it. On the window layer it stays where
+    it is, and only the cells which change have to be written.
+
+    The window can only start at a line and then runs to the bottom
+    of the screen, so @ref hud_split_set() switches it on and off
+    with the WX values of a scanline_fx table (see gb/scanline_fx.h):
+    WX = 7 shows it, WX = 167 hides it. The window only moves on to
+    its next row on lines where it is shown, so several regions (a
+    bar at the top and one at the bottom) show the rows of the
+    window one after another: the first region shows the window
+    rows from 0 on, the second one the rows after those, and so on.
+    \code{.c}
+    const hud_region_t bars[] = {
+        { 0,   2 },    // Window rows 0 - 1 at the top
+        { 136, 1 }     // Window row 2 at the bottom
+    };
+    scanline_fx_entry_t hud_table[HUD_SPLIT_TABLE_SIZE(2)];
+    const scanline_fx_entry_t playfield = {0, 0, 0, 0, DMG_PALETTE(DMG_WHITE, DMG_LITE_GRAY, DMG_DARK_GRAY, DMG_BLACK), SCANLINE_FX_NO_COLOR, 0};
+    uint8_t hud_cells[3 * HUD_WIDTH];
+    ...
+    hud_init(hud_cells, 3, ' ');
+    hud_split_set(hud_table, &playfield, bars, 2);
+    SHOW_WIN;
+    while (1) {
+        vsync();
+        hud_split_scroll(hud_table, camera_x, camera_y);
+        hud_set_tiles(14, 0, 5, 1, score_text);  // Only the changed cells are uploaded
+        hud_flush();
+        ...
+    }
+    \endcode
+
+    The scanline_fx handlers have to be installed as described in
+    gb/scanline_fx.h. A bar at the bottom of the screen alone needs
+    no split, only @ref WY_REG set to its first line, but the cell
+    functions work the same for it.
+
+    The cells are kept in a RAM copy: @ref hud_set_tile() and
+    @ref hud_set_tiles() mark a cell dirty only if its tile differs
+    from the copy, @ref hud_flush() writes each run of dirty cells
+    of a row with one @ref set_win_tiles() call. CGB attributes are
+    not tracked, set them once with @ref VBK_REG = @ref VBK_ATTRIBUTES.
+*/
+
+#ifndef __HUD_H_INCLUDE
+#define __HUD_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gb/scanline_fx.h>
+
+/** Width of the HUD in cells, the width of the screen */
+#define HUD_WIDTH 20
+
+/** Maximum number of window rows used by the HUD */
+#define HUD_MAX_ROWS 18
+
+/** WX value which shows the window at the left edge of the screen */
+#define HUD_WX_SHOW 7
+
+/** WX value which hides the window */
+#define HUD_WX_HIDE 167
+
+/** Number of entries @ref hud_split_set() needs in its table for __count__ regions */
+#define HUD_SPLIT_TABLE_SIZE(count) (((count) * 2) + 2)
+
+/** A band of screen lines which shows the next rows of the window */
+typedef struct hud_region_t {
+    uint8_t line;   /**< First screen line of the region */
+    uint8_t rows;   /**< Height in window rows (8 lines each) */
+} hud_region_t;
+
+/** Sets up the RAM copy of the HUD and clears the HUD
+
+    @param cells  Buffer of rows * @ref HUD_WIDTH bytes for the RAM copy
+    @param rows   Number of window rows used by the HUD, up to @ref HUD_MAX_ROWS
+    @param tile   Tile the cells are cleared to
+
+    The window rows are cleared with the display on, nothing is dirty afterwards.
+*/
+void hud_init(uint8_t * cells, uint8_t rows, uint8_t tile);
+
+/** Builds a scanline_fx table which shows the window in __regions__ and hides it elsewhere
+
+    @param table    Table of @ref HUD_SPLIT_TABLE_SIZE (count) entries
+    @param base     SCX, SCY, BGP and CGB color values of all entries (its line and wx are not used)
+    @param regions  Regions ordered by line, not overlapping
+    @param count    Number of regions, at least 1
+
+    Sets @ref WY_REG to the first line of the first region and passes
+    the table to @ref scanline_fx_set_table(). Regions which follow
+    each other without a gap share an entry, the lines of all entries
+    must be at least two apart (see gb/scanline_fx.h).
+*/
+void hud_split_set(scanline_fx_entry_t * table, const scanline_fx_entry_t * base, const hud_region_t * regions, uint8_t count);
+
+/** Sets the background scroll of all entries in a table built by @ref hud_split_set()
+
+    @param table  Table built by @ref hud_split_set()
+    @param scx    Value for @ref SCX_REG
+    @param scy    Value for @ref SCY_REG
+
+    Every entry writes the scroll registers, so the playfield
+    scroll is set here instead of with @ref move_bkg().
+*/
+void hud_split_scroll(scanline_fx_entry_t * table, uint8_t scx, uint8_t scy);
+
+/** Sets the tile of a HUD cell, marking it dirty if it changed
+
+    @param x     Column (0 - 19)
+    @param y     Window row (0 - rows - 1)
+    @param tile  Tile index
+*/
+void hud_set_tile(uint8_t x, uint8_t y, uint8_t tile);
+
+/** Sets the tiles of a rectangle of HUD cells, marking the ones which changed dirty
+
+    @param x      Left column
+    @param y      Top window row
+    @param w      Width in cells
+    @param h      Height in cells
+    @param tiles  w * h tile indices, row by row
+*/
+void hud_set_tiles(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * tiles);
+
+/** Writes the dirty HUD cells to the window tile map
+
+    Each run of dirty cells in a row is written with one
+    @ref set_win_tiles() call, which waits for VRAM access, so it
+    may be called at any time. Call it right after @ref vsync() to
+    have most of the writes done in VBlank.
+*/
+void hud_flush(void);
+
+#endif
@@ -47,6 +47,9 @@ typedef struct isr_vector_t {
     ISR_VECTOR(VECTOR_TIMER, TimerISR)
     \endcode
 
+    For the LCD STAT vector @ref set_LCD_fast() costs one more jump
+    than this but allows changing the handler at run time.
+
     @see ISR_NESTED_VECTOR, set_interrupts
 */
 #define ISR_VECTOR(ADDR, FUNC) \
@@ -113,6 +113,7 @@ static uint8_t __move_metasprite_flipxy(uint8_t id, uint16_t yx);
 static uint8_t __move_metasprite_vflip(uint8_t id, uint16_t yx);
 static uint8_t __move_metasprite_hflip(uint8_t id, uint16_t yx);
 static uint8_t __move_metasprite_hvflip(uint8_t id, uint16_t yx);
+static uint8_t __copy_oam_frame(uint8_t id, uint16_t yx);
 static void __hide_metasprite(uint8_t id);
 
 /**
@@ -284,6 +285,30 @@ inline uint8_t move_metasprite_hvflip(const metasprite_t * metasprite, uint8_t b
     return __move_metasprite_hvflip(base_sprite, ((y - ((LCDC_REG & LCDCF_OBJ16) ? 16u : 8u)) << 8) | (uint8_t)(x - 8));
 }
 
+/** Copies a precomputed OAM frame to the absolute position x and y
+
+    @param frame        Pointer to an OAM frame exported by png2asset with `-oam_frames` (`<name>_oam_frames[n]`)
+    @param base_sprite  Number of the first hardware sprite to be used by the frame
+    @param x            Absolute x coordinate of the frame pivot
+    @param y            Absolute y coordinate of the frame pivot
+
+    An OAM frame holds the number of sprites followed by the y, x, tile
+    and props bytes of each hardware sprite relative to the pivot. Only
+    the position gets added, so this is cheaper than move_metasprite_ex()
+    for large frames which are always drawn the same way, such as bosses
+    and HUD overlays. There is no base tile or base prop: the tiles have
+    to be loaded at the png2asset `-tile_origin`.
+
+    Sets:
+    \li __current_metasprite = frame;
+
+    @return Number of hardware sprites used to draw this frame
+ */
+inline uint8_t copy_oam_frame(const uint8_t * frame, uint8_t base_sprite, uint8_t x, uint8_t y) {
+    __current_metasprite = frame;
+    return __copy_oam_frame(base_sprite, (y << 8) | (uint8_t)x);
+}
+
 /** Hides a metasprite from the screen
 
     @param metasprite    Pointer to first struct of the desired metasprite frame
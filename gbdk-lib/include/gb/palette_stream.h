@@ -0,0 +1,108 @@
+/** @file gb/palette_stream.h
+
+    HBlank CGB palette streaming
+
+    Shows more than the 8 background (or sprite) palettes per
+    frame, by writing colors to the palette RAM in the HBlanks
+    between lines. Works like gb/scanline_fx.h: the game fills a
+    table of @ref palette_stream_entry_t and the LY compare
+    interrupt streams one entry after another, writing up to
+    @ref PALETTE_STREAM_COLORS_MAX colors in each HBlank of the
+    entry.
+
+    Install the handlers once during startup (the LCD handler
+    is reached with @ref set_LCD_fast(), so it can not be combined
+    with gb/scanline_fx.h, @ref add_LCD() or `stdio.h`):
+    \code{.c}
+    CRITICAL {
+        STAT_REG = STATF_LYC;
+        add_VBL(palette_stream_vbl_isr);
+        set_LCD_fast(palette_stream_lcd_isr);
+    }
+    set_interrupts(VBL_IFLAG | LCD_IFLAG);
+    \endcode
+
+    Then pass a table to @ref palette_stream_set_table(), for example
+    new colors for background palettes 0 to 7 every 16 lines, written
+    a palette (4 colors) per HBlank over the 8 lines above each band:
+    \code{.c}
+    palette_stream_entry_t bands[9];
+    ...
+    for (uint8_t i = 0; i != 8; i++) {
+        bands[i] = (palette_stream_entry_t){(i * 16) + 8, BCPSF_AUTOINC, 4, 8, band_palettes[i]};
+    }
+    bands[8].line = PALETTE_STREAM_END;
+    palette_stream_set_table(bands);
+    \endcode
+
+    Tables are switched at the next VBlank, the same way as with
+    @ref scanline_fx_set_table().
+
+    The handler stays in the interrupt for all the HBlanks of an entry,
+    so the main loop doesn't run during those lines.
+*/
+
+#ifndef __PALETTE_STREAM_H_INCLUDE
+#define __PALETTE_STREAM_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gb/cgb.h>
+
+/** Line of the entry which ends a table
+ */
+#define PALETTE_STREAM_END        0xFF
+
+/** Flag for palette_stream_entry_t::bcps: write sprite palettes (@ref OCPS_REG) instead of background palettes
+ */
+#define PALETTE_STREAM_OBJ        0x40
+
+/** Colors which fit in an HBlank at normal speed (8 in CGB double speed mode)
+
+    The palette RAM is accessible during HBlank and the OAM search of the
+    next line. With many sprites on a line HBlank gets shorter, use fewer
+    colors per HBlank on lines with more than a few sprites.
+ */
+#define PALETTE_STREAM_COLORS_MAX 4
+
+/** Colors written in the HBlanks before __line__ and the lines after it
+
+    Lines must be increasing. An entry must end before the line
+    before the next entry: line + lines < next line.
+    An entry for line 0 must be first, its first colors are
+    written during VBlank.
+ */
+typedef struct palette_stream_entry_t {
+    uint8_t line;   /**< Line shown with the first colors, @ref PALETTE_STREAM_END ends the table */
+    uint8_t bcps;   /**< Value for @ref BCPS_REG, the first palette color, with @ref BCPSF_AUTOINC set and optionally @ref PALETTE_STREAM_OBJ */
+    uint8_t colors; /**< Colors written in each HBlank, 1 to @ref PALETTE_STREAM_COLORS_MAX */
+    uint8_t lines;  /**< Number of HBlanks, 1 or more */
+    const palette_color_t * data; /**< __colors__ * __lines__ colors */
+} palette_stream_entry_t;
+
+/** Streams __table__ starting with the next frame
+
+    @param table  Table ending with an entry for line @ref PALETTE_STREAM_END, or NULL to stop
+
+    The table and its colors are not copied and are used again
+    every frame until another table is set.
+
+    @see palette_stream_vbl_isr(), palette_stream_lcd_isr()
+*/
+void palette_stream_set_table(const palette_stream_entry_t * table);
+
+/** VBlank handler which restarts the table every frame
+
+    Install with @ref add_VBL().
+*/
+void palette_stream_vbl_isr(void);
+
+/** LCD handler which streams the table entries
+
+    Install with @ref set_LCD_fast() and leave only @ref STATF_LYC
+    set in @ref STAT_REG, @ref LYC_REG gets set to the line before
+    each entry.
+*/
+void palette_stream_lcd_isr(void);
+
+#endif
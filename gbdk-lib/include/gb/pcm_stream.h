@@ -0,0 +1,105 @@
+/** @file gb/pcm_stream.h
+
+    4 bit PCM sample streaming on sound channel 3
+
+    Samples are converted from WAV files with @ref utility_wav2asset "wav2asset",
+    which splits them into chunks that can be placed in any ROM bank
+    and writes a @ref pcm_sample_t describing them:
+    \code{.sh}
+    wav2asset voice.wav -c res/voice.c
+    \endcode
+
+    The player is a timer interrupt handler which reloads the
+    channel 3 wave RAM with the next 32 samples on every timer
+    overflow. Install it once during startup, after turning
+    on sound:
+    \code{.c}
+    NR52_REG = AUDENA_ON;
+    NR51_REG = 0xFF;
+    NR50_REG = AUDVOL_VOL_LEFT(7) | AUDVOL_VOL_RIGHT(7);
+    CRITICAL {
+        add_low_priority_TIM(pcm_stream_isr);
+    }
+    set_interrupts(VBL_IFLAG | TIM_IFLAG);
+    \endcode
+
+    Then start samples at any time:
+    \code{.c}
+    #include "res/voice.h"
+    ...
+    pcm_stream_play(&voice);
+    \endcode
+
+    While a sample plays the player owns channel 3 and the
+    timer (@ref TMA_REG, @ref TIMA_REG and @ref TAC_REG), which it
+    sets to the rate of the sample.
+
+    The sample data is read by the interrupt handler, which
+    switches ROM banks as needed. The @ref pcm_sample_t itself
+    and its list of chunks must be in non-banked ROM or in RAM.
+*/
+
+#ifndef __PCM_STREAM_H_INCLUDE
+#define __PCM_STREAM_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Samples per frame, the amount copied to wave RAM on each timer interrupt
+ */
+#define PCM_STREAM_FRAME_SAMPLES 32
+
+/** Bytes per frame, two 4 bit samples per byte with the first one in the upper bits
+ */
+#define PCM_STREAM_FRAME_SIZE    16
+
+/** Timer period in 16384 Hz ticks of a sample rate (Hz), the rate played is 524288 / period
+ */
+#define PCM_STREAM_PERIOD(RATE)  ((uint8_t)((524288UL + ((RATE) / 2)) / (RATE)))
+
+/** Part of a sample in a single ROM bank
+ */
+typedef struct pcm_chunk_t {
+    uint8_t bank;          /**< ROM bank of the data */
+    const uint8_t * data;  /**< Start of the data, packed 4 bit samples */
+    uint16_t frames;       /**< Length in frames of @ref PCM_STREAM_FRAME_SIZE bytes, 0 ends the list */
+} pcm_chunk_t;
+
+/** A sample made of one or more chunks
+ */
+typedef struct pcm_sample_t {
+    uint8_t period;              /**< Timer period, see @ref PCM_STREAM_PERIOD(), 0 for 256 */
+    const pcm_chunk_t * chunks;  /**< Chunks in order, ending with one of 0 frames */
+} pcm_sample_t;
+
+/** Non-zero while a sample is playing, cleared when it has finished
+ */
+extern volatile uint8_t pcm_stream_playing;
+
+/** Starts playing __sample__, stopping any sample which is playing
+
+    @param sample  Sample to play
+
+    Sets the timer to the rate of the sample, the first frame
+    starts on the next timer overflow. In CGB double speed mode
+    the timer period is doubled, so the lowest rate is 4096 Hz.
+
+    Must not be called from interrupt handlers.
+
+    @see pcm_stream_stop(), pcm_stream_isr()
+*/
+void pcm_stream_play(const pcm_sample_t * sample);
+
+/** Stops the sample which is playing and turns off channel 3
+*/
+void pcm_stream_stop(void);
+
+/** Timer interrupt handler of the player
+
+    Install with @ref add_low_priority_TIM(): the next frame is
+    fetched from ROM with interrupts enabled, only the reload of
+    wave RAM runs with them disabled.
+*/
+void pcm_stream_isr(void);
+
+#endif
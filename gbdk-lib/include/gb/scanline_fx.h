@@ -0,0 +1,112 @@
+/** @file gb/scanline_fx.h
+
+    Table driven scanline effects
+
+    Per line scrolling, window and palette effects without writing
+    an LCD interrupt handler: the game fills a table of
+    @ref scanline_fx_entry_t register values and the LY compare
+    interrupt applies one entry after another, each in the HBlank
+    before its line. Lines without an entry keep the values of
+    the entry before them.
+
+    Install the handlers once during startup (the LCD handler
+    is reached with @ref set_LCD_fast(), so it can not be combined
+    with @ref add_LCD() or `stdio.h`):
+    \code{.c}
+    CRITICAL {
+        STAT_REG = STATF_LYC;
+        add_VBL(scanline_fx_vbl_isr);
+        set_LCD_fast(scanline_fx_lcd_isr);
+    }
+    set_interrupts(VBL_IFLAG | LCD_IFLAG);
+    \endcode
+
+    Then fill a table and pass it to @ref scanline_fx_set_table(),
+    for example a screen which wobbles every other line below line 40:
+    \code{.c}
+    scanline_fx_entry_t wobble[((144 - 40) / 2) + 2];
+    ...
+    wobble[0] = (scanline_fx_entry_t){0, 0, 0, 167, DMG_PALETTE(DMG_WHITE, DMG_LITE_GRAY, DMG_DARK_GRAY, DMG_BLACK), SCANLINE_FX_NO_COLOR, 0};
+    for (uint8_t i = 0; i != (144 - 40) / 2; i++) {
+        wobble[i + 1] = wobble[0];
+        wobble[i + 1].line = 40 + (i * 2);
+        wobble[i + 1].scx = sine_tbl[(uint8_t)(i + frame) & 0x0F];
+    }
+    wobble[((144 - 40) / 2) + 1].line = SCANLINE_FX_END;
+    scanline_fx_set_table(wobble);
+    \endcode
+
+    Tables are switched at the next VBlank, so with two tables
+    the one which is not shown can be changed while the other
+    one is: after scanline_fx_set_table() and @ref vsync() the
+    previous table isn't used anymore.
+
+    Each entry takes about 460 CPU cycles in the LCD interrupt
+    (a line lasts 456) plus the wait for HBlank, so entries have
+    to be at least two lines apart, or one line in CGB double
+    speed mode. The main loop gets less time the more lines
+    have entries.
+*/
+
+#ifndef __SCANLINE_FX_H_INCLUDE
+#define __SCANLINE_FX_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Line of the entry which ends a table
+ */
+#define SCANLINE_FX_END      0xFF
+
+/** BCPS value of entries which don't change a CGB palette color
+ */
+#define SCANLINE_FX_NO_COLOR 0x40
+
+/** Register values for the lines starting at __line__
+
+    Lines must be increasing and at least two apart (see above),
+    an entry for line 0 must be first and is written during VBlank.
+
+    If __bcps__ is not @ref SCANLINE_FX_NO_COLOR, __color__ is
+    written to @ref BCPD_REG after __bcps__ gets written to
+    @ref BCPS_REG, which needs @ref BCPSF_AUTOINC set to write both
+    bytes of the color (CGB only).
+ */
+typedef struct scanline_fx_entry_t {
+    uint8_t line;   /**< First line of the entry, @ref SCANLINE_FX_END ends the table */
+    uint8_t scx;    /**< Value for @ref SCX_REG */
+    uint8_t scy;    /**< Value for @ref SCY_REG */
+    uint8_t wx;     /**< Value for @ref WX_REG */
+    uint8_t bgp;    /**< Value for @ref BGP_REG */
+    uint8_t bcps;   /**< Value for @ref BCPS_REG or @ref SCANLINE_FX_NO_COLOR */
+    uint16_t color; /**< CGB color for @ref BCPD_REG, see @ref RGB() */
+} scanline_fx_entry_t;
+
+/** Shows __table__ starting with the next frame
+
+    @param table  Table ending with an entry for line @ref SCANLINE_FX_END, or NULL to stop the effect
+
+    The table is not copied and is used again every frame
+    until another table is set. The game may change it while
+    it's used, the changes are shown as soon as the LCD gets
+    to their lines.
+
+    @see scanline_fx_vbl_isr(), scanline_fx_lcd_isr()
+*/
+void scanline_fx_set_table(const scanline_fx_entry_t * table);
+
+/** VBlank handler which restarts the table every frame
+
+    Install with @ref add_VBL().
+*/
+void scanline_fx_vbl_isr(void);
+
+/** LCD handler which applies the table entries
+
+    Install with @ref set_LCD_fast() and leave only @ref STATF_LYC
+    set in @ref STAT_REG, @ref LYC_REG gets set to the line before
+    each entry.
+*/
+void scanline_fx_lcd_isr(void);
+
+#endif
@@ -0,0 +1,108 @@
+/** @file gb/serial_link.h
+
+    Interrupt driven packet transport over the link cable
+
+    Unlike @ref send_byte() and @ref receive_byte() the transfers
+    run in the background: packets are queued in a send buffer,
+    the serial interrupt handler exchanges one byte with the other
+    console per interrupt, and received packets wait in a receive
+    buffer until the game reads them. Each packet carries its length
+    and a CRC8, damaged packets are dropped.
+
+    One console is the master, which clocks the transfers, the
+    other one is the slave. Install the handler once during startup:
+    \code{.c}
+    CRITICAL {
+        add_SIO(serial_link_isr);
+        add_SIO(nowait_int_handler);
+    }
+    set_interrupts(VBL_IFLAG | SIO_IFLAG);
+    serial_link_init(is_player_one ? SERIAL_LINK_MASTER : SERIAL_LINK_SLAVE);
+    \endcode
+
+    Then exchange inputs every frame:
+    \code{.c}
+    uint8_t packet[SERIAL_LINK_PACKET_MAX];
+    ...
+    serial_link_send(&local_input, sizeof(local_input));
+    while (serial_link_receive(packet)) {
+        ...
+    }
+    \endcode
+
+    The master only clocks while one of the consoles has a packet
+    to send. It notices packets of the slave when it calls
+    @ref serial_link_send() or @ref serial_link_receive(), so a
+    master which sends nothing should still call
+    serial_link_receive() every frame.
+
+    Between two bytes the slave only has the time of the master's
+    interrupt handler to get ready for the next one, so interrupts
+    must not be disabled for long on the slave while packets are
+    exchanged, especially with @ref SERIAL_LINK_MASTER_FAST.
+    Packets damaged this way are counted in @ref serial_link_dropped.
+
+    Can not be combined with @ref send_byte() and @ref receive_byte().
+*/
+
+#ifndef __SERIAL_LINK_H_INCLUDE
+#define __SERIAL_LINK_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gb/hardware.h>
+
+/** Link is stopped */
+#define SERIAL_LINK_OFF          0
+/** Slave, the other console clocks the transfers */
+#define SERIAL_LINK_SLAVE        (SIOF_XFER_START | SIOF_CLOCK_EXT)
+/** Master at 8192 Hz, about 1KB/s (twice that in CGB double speed mode) */
+#define SERIAL_LINK_MASTER       (SIOF_XFER_START | SIOF_CLOCK_INT)
+/** Master at 262144 Hz, **CGB ONLY**, about 32KB/s (twice that in CGB double speed mode) */
+#define SERIAL_LINK_MASTER_FAST  (SIOF_XFER_START | SIOF_CLOCK_INT | SIOF_SPEED_32X)
+
+/** Size of the send and receive buffers, one byte of each stays unused */
+#define SERIAL_LINK_BUF_SIZE     128
+/** Largest payload of a packet */
+#define SERIAL_LINK_PACKET_MAX   32
+/** Bytes a packet takes in the send buffer besides its payload (start, length and CRC) */
+#define SERIAL_LINK_PACKET_OVERHEAD 3
+
+/** Number of received packets dropped because of a bad CRC or a full receive buffer
+ */
+extern volatile uint8_t serial_link_dropped;
+
+/** Starts or stops the link, emptying both buffers
+
+    @param mode  @ref SERIAL_LINK_MASTER, @ref SERIAL_LINK_MASTER_FAST,
+                 @ref SERIAL_LINK_SLAVE or @ref SERIAL_LINK_OFF
+
+    @see serial_link_isr()
+*/
+void serial_link_init(uint8_t mode);
+
+/** Queues a packet to send
+
+    @param data  Payload of the packet
+    @param len   Length of the payload, 1 to @ref SERIAL_LINK_PACKET_MAX
+
+    @return TRUE if the packet was queued, FALSE if __len__ is out of range
+            or the send buffer doesn't have room for it
+*/
+uint8_t serial_link_send(const void * data, uint8_t len);
+
+/** Takes the next received packet out of the receive buffer
+
+    @param data  Buffer for the payload, @ref SERIAL_LINK_PACKET_MAX bytes
+
+    @return Length of the payload, 0 when no complete packet was received
+*/
+uint8_t serial_link_receive(void * data);
+
+/** Serial interrupt handler of the link
+
+    Install with @ref add_SIO().
+*/
+void serial_link_isr(void);
+
+#endif
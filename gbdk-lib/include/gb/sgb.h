@@ -67,4 +67,68 @@ uint8_t sgb_check(void) OLDCALL PRESERVES_REGS(b, c);
 */
 void sgb_transfer(uint8_t * packet) OLDCALL PRESERVES_REGS(b, c);
 
+/** Number of packets the SGB queue holds */
+#define SGB_QUEUE_SIZE  8
+
+/** Default of @ref sgb_queue_delay, the same wait as in @ref sgb_transfer() */
+#define SGB_QUEUE_DELAY 4
+
+/** Frames to skip after each packet sent by @ref sgb_queue_isr()
+ */
+extern uint8_t sgb_queue_delay;
+
+/** Queues a SGB command to be sent by @ref sgb_queue_isr()
+
+    @param packet  Pointer to the packets of the command
+
+    Like @ref sgb_transfer() the number of 16 byte packets is
+    taken from the low 3 bits of the first byte. The packets are
+    copied, so __packet__ may be changed after this returns.
+
+    @return TRUE if the command was queued, FALSE if there is
+            not enough room in the queue
+
+    @see sgb_queue_wait()
+*/
+uint8_t sgb_queue_transfer(const uint8_t * packet);
+
+/** VBlank handler which sends the queued SGB packets
+
+    Install with @ref add_VBL(). It sends at most one packet
+    per frame and then skips @ref sgb_queue_delay frames, which
+    is the wait @ref sgb_transfer() spends in a busy loop.
+
+    Sending a packet takes about 3000 cycles, so add it after
+    the other VBlank handlers. A @ref joypad() call interrupted
+    by it may return no buttons pressed.
+*/
+void sgb_queue_isr(void);
+
+/** Waits until all queued SGB packets have been sent and the
+    delay after the last one has passed
+*/
+void sgb_queue_wait(void);
+
+/** Sends a SGB command which transfers 4KB of data through the screen
+
+    @param packet  Pointer to the packet of the command, such as
+                   @ref SGB_CHR_TRN, @ref SGB_PCT_TRN, @ref SGB_PAL_TRN,
+                   @ref SGB_ATTR_TRN, @ref SGB_SOU_TRN or @ref SGB_DATA_TRN
+    @param data    Data to transfer
+    @param size    Size of __data__, a multiple of 16 up to 4096
+
+    The data is copied to tiles 0 to 255 at 0x8000 with the display
+    turned off, then the tiles are shown on the background at 0x9800
+    while the command is sent through the queue. Returns once the
+    SGB has read the screen. @ref sgb_queue_isr() must be installed.
+    Tiles after __size__ are not changed, so the rest of the 4KB can
+    be set with @ref set_sprite_data_nowait() before the call while
+    the display is off.
+
+    LCDC, BGP, SCX and SCY are restored afterwards, the tiles and the
+    first 13 rows of the background map at 0x9800 are not. Send
+    @ref SGB_MASK_EN first to hide the transfer.
+*/
+void sgb_vram_transfer(const uint8_t * packet, const uint8_t * data, uint16_t size);
+
 #endif /* _SGB_H */
@@ -0,0 +1,118 @@
+/** @file gb/sram.h
+
+    Cartridge SRAM bulk copies and crash safe saves
+
+    SRAM is addressed linearly: address 0 is the start of RAM bank 0
+    at 0xA000, address 0x2000 is the start of bank 1, and so on
+    (see @ref SRAM_ADDR_BANKED()). @ref sram_read() and
+    @ref sram_write() copy across bank boundaries with @ref memcpy(),
+    and enable SRAM only while copying.
+
+    @ref save_write() and @ref save_read() keep a save in two slots
+    with a sequence number and a CRC, so that a save which was
+    interrupted by a power loss leaves the previous one intact:
+    \code{.c}
+    SRAM_SIZE_DECLARE(SAVE_SLOTS_SIZE(sizeof(game_save_t)));
+
+    game_save_t game;
+    ...
+    if (!save_read(0, &game, sizeof(game))) new_game(&game);
+    ...
+    save_write(0, &game, sizeof(game));
+    \endcode
+
+    @ref SRAM_SIZE_DECLARE() lets makebin warn when the cartridge
+    header (`-Wm-ya<N>`) has less RAM than the program uses.
+*/
+
+#ifndef __SRAM_H_INCLUDE
+#define __SRAM_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Size of an SRAM bank */
+#define SRAM_BANK_SIZE 0x2000u
+
+/** Linear SRAM address of __ofs__ (0 to 0x1FFF) in RAM bank __bank__ */
+#define SRAM_ADDR_BANKED(bank, ofs) (((uint32_t)(bank) << 13) | (ofs))
+
+/** Declares the SRAM used by the program, in bytes
+
+    Once in one source file. Puts a small tagged record into ROM
+    which makebin checks against its RAM bank count (`-ya`).
+*/
+#define SRAM_SIZE_DECLARE(bytes) const uint8_t __sram_size_record[12] = { \
+    'G', 'B', 'D', 'K', 'S', 'R', 'A', 'M', \
+    (uint8_t)(bytes), (uint8_t)((uint32_t)(bytes) >> 8), (uint8_t)((uint32_t)(bytes) >> 16), (uint8_t)((uint32_t)(bytes) >> 24) }
+
+/** Copies __len__ bytes from SRAM to __dst__
+
+    @param dst  Destination in WRAM (or VRAM with the LCD off)
+    @param src  Linear SRAM address
+    @param len  Bytes to copy
+
+    Leaves SRAM disabled and the last bank copied from selected.
+*/
+void sram_read(void * dst, uint32_t src, uint16_t len);
+
+/** Copies __len__ bytes from __src__ to SRAM
+
+    @param dst  Linear SRAM address
+    @param src  Source, not in 0xA000 - 0xBFFF
+    @param len  Bytes to copy
+
+    Leaves SRAM disabled and the last bank copied to selected.
+*/
+void sram_write(uint32_t dst, const void * src, uint16_t len);
+
+/** CRC-16/CCITT (polynomial 0x1021, starting with 0xFFFF) of __len__ bytes of SRAM
+
+    @param src  Linear SRAM address
+    @param len  Bytes to check
+*/
+uint16_t sram_crc16(uint32_t src, uint16_t len);
+
+/** Header of each slot of @ref save_write()
+ */
+typedef struct save_header_t {
+    uint16_t magic;     /**< @ref SAVE_MAGIC */
+    uint16_t size;      /**< Bytes of save data after the header */
+    uint8_t seq;        /**< Increased with every save, the newer valid slot is read */
+    uint8_t reserved;
+    uint16_t crc;       /**< CRC-16 of size, seq and the data */
+} save_header_t;
+
+/** Value of save_header_t::magic */
+#define SAVE_MAGIC 0x5347u
+
+/** SRAM used by one slot of __size__ bytes of save data */
+#define SAVE_SLOT_SIZE(size) (sizeof(save_header_t) + (size))
+/** SRAM used by @ref save_write() for __size__ bytes of save data */
+#define SAVE_SLOTS_SIZE(size) (2 * SAVE_SLOT_SIZE(size))
+
+/** Writes a save to the older of two slots
+
+    @param slots  Linear SRAM address of the first slot, the second one follows it
+    @param data   Save data
+    @param size   Bytes of save data
+
+    The data is written first and the header with the CRC after
+    it, then the slot is read back and checked. Until that is done
+    @ref save_read() returns the previous save.
+
+    @return TRUE, or FALSE if the slot didn't read back correctly
+*/
+uint8_t save_write(uint32_t slots, const void * data, uint16_t size);
+
+/** Reads the newest valid save of two slots
+
+    @param slots  Linear SRAM address of the first slot, as for @ref save_write()
+    @param data   Buffer for the save data
+    @param size   Bytes of save data, must be the same as when written
+
+    @return TRUE, or FALSE if neither slot holds a valid save (__data__ is unchanged)
+*/
+uint8_t save_read(uint32_t slots, void * data, uint16_t size);
+
+#endif
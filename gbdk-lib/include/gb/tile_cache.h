@@ -0,0 +1,118 @@
+/** @file gb/tile_cache.h
+
+    VRAM residency cache for streamed background tiles
+
+    For maps with more unique tiles than fit in VRAM: a range of
+    background tiles is used as cache slots for a larger tileset
+    in ROM. @ref tile_cache_request() returns the background tile
+    a tileset tile is loaded into, loading it through the deferred
+    VRAM queue (see gb/vram_queue.h) if it isn't resident yet.
+    \code{.c}
+    #include "res/world.h"   // png2asset -map -tile_usage 20 18
+
+    uint8_t world_lookup[world_TILE_COUNT];
+    tile_cache_slot_t world_slots[192];
+    tile_cache_t world_cache;
+    ...
+    CRITICAL {
+        add_VBL(vram_queue_isr);
+    }
+    tile_cache_init(&world_cache, world_tiles, BANK(world), world_TILE_COUNT, world_lookup, 0, world_slots, 192);
+    ...
+    // Draw a map cell
+    tile = tile_cache_request(&world_cache, world_map_ids[(y * world_WIDTH / 8) + x]);
+    vram_queue_write(get_bkg_xy_addr(x & 31, y & 31), &tile, 1);
+    \endcode
+
+    Slots are replaced with the clock (second chance) algorithm:
+    a requested slot is marked used, and a slot is only replaced
+    once the clock hand passed it without it having been requested
+    again since. Request the tiles of the shown area again as it
+    gets redrawn (or with @ref tile_cache_prefetch() and the
+    png2asset `-tile_usage` lists), so they count as used, and
+    keep the number of different tiles on screen well below the
+    number of slots.
+
+    On CGB only VRAM bank 0 is used.
+*/
+
+#ifndef __TILE_CACHE_H_INCLUDE
+#define __TILE_CACHE_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Entry of the lookup table for tileset tiles that are not loaded */
+#define TILE_CACHE_NONE 0xFFu
+/** Tileset tile of a free slot */
+#define TILE_CACHE_FREE 0xFFFFu
+
+/** A cache slot
+ */
+typedef struct tile_cache_slot_t {
+    uint16_t tile;          /**< Tileset tile loaded into the slot, or @ref TILE_CACHE_FREE */
+    uint8_t used;           /**< Set when requested, cleared when the clock hand passes */
+} tile_cache_slot_t;
+
+/** State of a tile cache
+ */
+typedef struct tile_cache_t {
+    const uint8_t * tiles;          /**< Tileset, 16 bytes per tile */
+    uint8_t bank;                   /**< ROM bank of the tileset */
+    uint8_t first_tile;             /**< Background tile of the first slot */
+    uint8_t slot_count;             /**< Number of slots */
+    uint8_t hand;                   /**< Next slot the clock hand looks at */
+    uint8_t * lookup;               /**< For each tileset tile its slot, or @ref TILE_CACHE_NONE */
+    tile_cache_slot_t * slots;      /**< The slots */
+    uint16_t tile_count;            /**< Number of tiles in the tileset */
+    uint16_t loads;                 /**< Number of tiles loaded, for tuning the number of slots */
+} tile_cache_t;
+
+/** Initializes a tile cache with all slots free
+
+    @param cache       Cache to initialize
+    @param tiles       Tileset, 16 bytes per tile
+    @param bank        ROM bank of __tiles__
+    @param tile_count  Number of tiles in the tileset
+    @param lookup      Buffer of __tile_count__ bytes
+    @param first_tile  Background tile of the first slot
+    @param slots       Buffer of __slot_count__ slots
+    @param slot_count  Number of slots, 1 to 255. The slots are background
+                       tiles __first_tile__ onwards, which must not be used
+                       for anything else.
+*/
+void tile_cache_init(tile_cache_t * cache, const uint8_t * tiles, uint8_t bank, uint16_t tile_count,
+                     uint8_t * lookup, uint8_t first_tile, tile_cache_slot_t * slots, uint8_t slot_count);
+
+/** Empties a tile cache, for example when loading another map
+
+    @param cache  Cache to empty
+*/
+void tile_cache_reset(tile_cache_t * cache);
+
+/** Returns the background tile __tile__ of the tileset is loaded into
+
+    @param cache  Cache to use
+    @param tile   Tile of the tileset
+
+    If the tile isn't resident it replaces the tile of a slot which
+    wasn't used recently, and its data is queued with
+    @ref vram_queue_write(). The data reaches VRAM during the
+    following VBlanks, before any tile map writes queued after this.
+
+    The background tile index is for the tile data addressing
+    selected in @ref LCDC_REG, like @ref set_bkg_data().
+
+    @return The background tile
+*/
+uint8_t tile_cache_request(tile_cache_t * cache, uint16_t tile);
+
+/** Requests a list of tiles, for example the tiles used by a map region
+
+    @param cache  Cache to use
+    @param list   Tiles of the tileset
+    @param count  Number of tiles in __list__
+*/
+void tile_cache_prefetch(tile_cache_t * cache, const uint16_t * list, uint16_t count);
+
+#endif
@@ -0,0 +1,125 @@
+/** @file gb/vram_queue.h
+
+    Deferred VRAM writes
+
+    Instead of waiting for VRAM to become accessible on every
+    write (as @ref set_bkg_tiles(), @ref set_vram_byte(), etc do),
+    writes are queued in a 256 byte ring buffer and copied to VRAM
+    during VBlank by @ref vram_queue_isr(). This lets the main loop
+    run without waiting on the LCD.
+
+    Install the handler once during startup:
+    \code{.c}
+    CRITICAL {
+        add_VBL(vram_queue_isr);
+    }
+    \endcode
+
+    Then queue writes at any time, for example a row of map tiles:
+    \code{.c}
+    vram_queue_write(get_bkg_xy_addr(0, y), row_tiles, 20);
+    \endcode
+
+    Writes are copied in the order they were queued. Each
+    VBlank copies at most @ref vram_queue_budget bytes, anything
+    left over is copied during the following VBlanks.
+
+    @note The queue functions must not be called from interrupt
+    handlers, and must not be called with interrupts disabled
+    while the LCD is on (they may wait for the VBlank handler to
+    make room in the queue).
+*/
+
+#ifndef __VRAM_QUEUE_H_INCLUDE
+#define __VRAM_QUEUE_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Writes longer than this are split into several queue entries (stripes)
+ */
+#define VRAM_QUEUE_STRIPE_MAX 32
+
+/** Flag for @ref vram_queue_write_ex(): write to VRAM bank 1 (CGB tile map attributes or tiles)
+ */
+#define VRAM_QUEUE_BANK1      0x80
+
+/** Flag for @ref vram_queue_write_ex(): write down a tile map column,
+    the address advances by 32 bytes after each byte instead of 1
+ */
+#define VRAM_QUEUE_COLUMN     0x40
+
+/** Maximum number of bytes copied to VRAM by each call of @ref vram_queue_isr()
+
+    Defaults to 128 bytes, which with other VBlank work (such as
+    the shadow OAM transfer) fits comfortably in a single VBlank.
+    Each stripe also counts as 8 bytes to account for its setup time.
+
+    Each byte of a @ref VRAM_QUEUE_COLUMN stripe counts twice.
+
+    Lower it if other VBlank handlers need more time, or raise it
+    for faster transfers (for example in CGB double speed mode).
+    At least one stripe is always copied per VBlank.
+ */
+extern uint8_t vram_queue_budget;
+
+/** Queues a write of __len__ bytes from __src__ to VRAM address __dst__
+
+    @param dst   Destination address in VRAM
+    @param src   Pointer to source data
+    @param len   Number of bytes to write
+
+    The data is copied into the queue, so __src__ can be
+    reused as soon as this returns.
+
+    Waits for room in the queue if it is full.
+
+    If the LCD is off, anything still in the queue is written
+    and then the data is written to VRAM directly.
+
+    On CGB the data is always written to VRAM bank 0,
+    use @ref vram_queue_write_ex() with @ref VRAM_QUEUE_BANK1
+    for bank 1.
+
+    @see vram_queue_write_ex(), vram_queue_flush(), vram_queue_isr()
+*/
+void vram_queue_write(uint8_t * dst, const uint8_t * src, uint16_t len);
+
+/** Queues a write of __len__ bytes from __src__ to VRAM address __dst__
+
+    @param dst   Destination address in VRAM
+    @param src   Pointer to source data
+    @param len   Number of bytes to write
+    @param flags Zero or more of @ref VRAM_QUEUE_BANK1, @ref VRAM_QUEUE_COLUMN
+
+    Same as @ref vram_queue_write(), except for the __flags__.
+
+    With @ref VRAM_QUEUE_COLUMN the bytes are written down a column of
+    the tile map starting at __dst__. The column does not wrap around
+    the bottom of the tile map, so split writes which would cross it.
+
+    \code{.c}
+    vram_queue_write_ex(get_bkg_xy_addr(x, 0), column_tiles, 18, VRAM_QUEUE_COLUMN);
+    vram_queue_write_ex(get_bkg_xy_addr(x, 0), column_attrs, 18, VRAM_QUEUE_COLUMN | VRAM_QUEUE_BANK1);
+    \endcode
+*/
+void vram_queue_write_ex(uint8_t * dst, const uint8_t * src, uint16_t len, uint8_t flags);
+
+/** Waits until everything in the queue has been written to VRAM
+
+    If the LCD is off the queue is written directly.
+*/
+void vram_queue_flush(void);
+
+/** VBlank handler which copies queued writes to VRAM
+
+    Install it with @ref add_VBL(). It does not check STAT, so
+    it must only run from the VBlank interrupt.
+
+    The VRAM bank selected by @ref VBK_REG is preserved.
+
+    @see vram_queue_budget
+*/
+void vram_queue_isr(void) NONBANKED;
+
+#endif
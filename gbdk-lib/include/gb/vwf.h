@@ -0,0 +1,122 @@
+/** @file gb/vwf.h
+
+    Variable width font text
+
+    Draws proportional text into a range of background tiles. The
+    glyphs are 1bpp 8 x 8 cells with a width each, exported by
+    png2asset `-vwf_font`. Glyphs are shifted and ORed into a two
+    tile buffer in WRAM, and each tile is queued through the deferred
+    VRAM queue (see gb/vram_queue.h) once the text moved past it.
+    \code{.c}
+    #include "res/dialogue_font.h"   // png2asset -vwf_font 32
+
+    const vwf_font_t dialogue = {
+        dialogue_font_vwf_glyphs, dialogue_font_vwf_widths,
+        dialogue_font_VWF_FIRST, dialogue_font_VWF_COUNT, BANK(dialogue_font)
+    };
+    vwf_t text;
+    ...
+    CRITICAL {
+        add_VBL(vram_queue_isr);
+    }
+    vwf_init(&text, &dialogue, 128, 72);
+    vwf_set_pos(&text, 1, 14);
+    // Typewriter, one character per frame
+    while (*str) {
+        vwf_putc(&text, *str++);
+        vwf_flush(&text);
+        vsync();
+    }
+    \endcode
+
+    Every 8 pixels of text use the next tile of the range, after
+    the last one it starts again at the first one. The tiles are
+    drawn with @ref vwf_set_colors(), the background color included.
+*/
+
+#ifndef __VWF_H_INCLUDE
+#define __VWF_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** A font exported by png2asset `-vwf_font`
+ */
+typedef struct vwf_font_t {
+    const uint8_t * glyphs;     /**< 8 bytes per glyph, the leftmost pixel in bit 7 */
+    const uint8_t * widths;     /**< Width of each glyph in pixels, 1 to 8 */
+    uint8_t first;              /**< Character of the first glyph */
+    uint8_t count;              /**< Number of glyphs */
+    uint8_t bank;               /**< ROM bank of __glyphs__ and __widths__ */
+} vwf_font_t;
+
+/** State of a text being drawn
+ */
+typedef struct vwf_t {
+    const vwf_font_t * font;    /**< Current font */
+    uint8_t buf[16];            /**< 1bpp rows of the current tile and of the one after it */
+    uint8_t first_tile;         /**< First background tile of the range */
+    uint8_t tile_count;         /**< Number of tiles of the range */
+    uint8_t tile;               /**< Tile of the range the current tile is drawn into */
+    uint8_t bit;                /**< Pixel column of the current tile drawn next */
+    uint8_t x, y;               /**< Tile map position of the current tile */
+    uint8_t fg, bg;             /**< Colors, 0 - 3 */
+    uint8_t dirty;              /**< Set when the current tile changed since it was queued */
+} vwf_t;
+
+/** Initializes a text
+
+    @param vwf         Text to initialize
+    @param font        Font to draw with
+    @param first_tile  First background tile to draw into
+    @param tile_count  Number of background tiles to draw into, at least 2
+
+    Colors default to 3 on 0, the position to 0, 0.
+*/
+void vwf_init(vwf_t * vwf, const vwf_font_t * font, uint8_t first_tile, uint8_t tile_count);
+
+/** Sets the colors of the text
+
+    @param vwf  Text to change
+    @param fg   Color of the glyph pixels, 0 - 3
+    @param bg   Color of the other pixels, 0 - 3
+
+    Applies to tiles queued from then on.
+*/
+void vwf_set_colors(vwf_t * vwf, uint8_t fg, uint8_t bg);
+
+/** Starts drawing at another position of the tile map
+
+    @param vwf  Text to change
+    @param x    X position in the tile map, in tiles
+    @param y    Y position in the tile map, in tiles
+
+    The text drawn so far is queued first with @ref vwf_flush().
+*/
+void vwf_set_pos(vwf_t * vwf, uint8_t x, uint8_t y);
+
+/** Draws a character
+
+    @param vwf  Text to draw into
+    @param c    Character, those without a glyph in the font are skipped
+
+    Tiles the text has passed are queued with @ref vram_queue_write()
+    together with their tile map entry. The tile the text ends in is
+    only queued by @ref vwf_flush() or once the text passes it.
+*/
+void vwf_putc(vwf_t * vwf, char c);
+
+/** Draws a string, see @ref vwf_putc()
+
+    @param vwf  Text to draw into
+    @param str  String to draw
+*/
+void vwf_print(vwf_t * vwf, const char * str);
+
+/** Queues the tile the text ends in, if it changed
+
+    @param vwf  Text to flush
+*/
+void vwf_flush(vwf_t * vwf);
+
+#endif
@@ -0,0 +1,109 @@
+/** @file gb/wram_bank.h
+
+    CGB switchable WRAM banks
+
+    The CGB has 8 banks of 4K WRAM. Bank 0 is always at 0xC000, and
+    1 of the banks 1 to 7 is selected at 0xD000 - 0xDFFF with
+    @ref SVBK_REG. GBDK only uses the default bank 1, so banks
+    @ref WRAM_BANK_FIRST to @ref WRAM_BANK_LAST (24K) are free for
+    large tables and buffers.
+
+    @ref wram_alloc() hands out blocks of those banks as a
+    @ref wram_ptr_t (bank and address):
+    \code{.c}
+    wram_ptr_t buf;
+
+    if (wram_alloc(4096, &buf)) {
+        uint8_t save = CURRENT_WRAM_BANK;
+        SWITCH_WRAM(buf.bank);
+        gb_decompress(level_data, buf.ptr);
+        ...
+        SWITCH_WRAM(save);
+    }
+    \endcode
+
+    @note While another bank is selected everything in 0xD000 - 0xDFFF
+    of bank 1 can't be used. By default that is where the stack is
+    (from 0xE000 down), so move it into bank 0 when linking, for
+    example with `-Wl-g.STACK=0xD000`, and keep variables (_DATA, _BSS
+    and the heap) below the stack. Interrupt handlers which switch
+    the bank must set it back before returning.
+
+    Only for the CGB (and the Analogue Pocket), check that
+    @ref _cpu == @ref CGB_TYPE before using these. On the DMG and
+    the Mega Duck @ref wram_alloc() always returns FALSE.
+*/
+
+#ifndef __WRAM_BANK_H_INCLUDE
+#define __WRAM_BANK_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gb/hardware.h>
+
+/** First WRAM bank used by @ref wram_alloc() */
+#define WRAM_BANK_FIRST 2
+/** Last WRAM bank used by @ref wram_alloc() */
+#define WRAM_BANK_LAST  7
+/** Size of a WRAM bank */
+#define WRAM_BANK_SIZE  0x1000u
+/** Address the selected WRAM bank is at */
+#define WRAM_BANK_ADDR  0xD000u
+
+/** Selects WRAM bank __b__ (1 to 7, 0 selects 1) at 0xD000
+ */
+#define SWITCH_WRAM(b) (SVBK_REG = (b))
+
+/** The WRAM bank selected at 0xD000, to set back with @ref SWITCH_WRAM()
+ */
+#define CURRENT_WRAM_BANK (SVBK_REG & 0x07u)
+
+/** A block in a WRAM bank
+ */
+typedef struct wram_ptr_t {
+    uint8_t bank;   /**< WRAM bank to select with @ref SWITCH_WRAM() */
+    uint8_t * ptr;  /**< Address of the block, in 0xD000 - 0xDFFF */
+} wram_ptr_t;
+
+/** Allocates a block in the first WRAM bank with enough room
+
+    @param size  Size of the block, 1 to @ref WRAM_BANK_SIZE bytes
+    @param p     Set to the bank and address of the block
+
+    Blocks can't be freed one by one, see @ref wram_reset().
+
+    @return TRUE, or FALSE if no bank has room (or not on a CGB)
+*/
+uint8_t wram_alloc(uint16_t size, wram_ptr_t * p);
+
+/** Frees all blocks, for example when loading another level
+*/
+void wram_reset(void);
+
+/** Returns the bytes still free in WRAM bank __bank__
+
+    @param bank  @ref WRAM_BANK_FIRST to @ref WRAM_BANK_LAST
+*/
+uint16_t wram_free_bytes(uint8_t bank);
+
+/** Copies __len__ bytes from a WRAM bank block to __dst__
+
+    @param dst   Destination, not in 0xD000 - 0xDFFF
+    @param src   Block to copy from
+    @param len   Bytes to copy
+
+    The selected WRAM bank is set back afterwards.
+*/
+void wram_memcpy_from(void * dst, const wram_ptr_t * src, uint16_t len);
+
+/** Copies __len__ bytes from __src__ to a WRAM bank block
+
+    @param dst   Block to copy to
+    @param src   Source, not in 0xD000 - 0xDFFF
+    @param len   Bytes to copy
+
+    The selected WRAM bank is set back afterwards.
+*/
+void wram_memcpy_to(const wram_ptr_t * dst, const void * src, uint16_t len);
+
+#endif
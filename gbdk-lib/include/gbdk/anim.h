@@ -0,0 +1,141 @@
+/** @file gbdk/anim.h
+
+    Sprite animation with per frame tile changes
+
+    png2asset with `-anim_diffs` gives each tile of a sprite sheet a
+    VRAM slot which is shared by all frames. Tiles which are already in
+    a slot from the previous frame stay there, so moving on to the next
+    frame only has to load the tiles which changed, instead of all tiles
+    of the frame. The exported metasprites use the slot numbers as their
+    tile indices.
+
+    \code{.c}
+    // Reserve player_ANIM_TILE_COUNT sprite tiles starting at PLAYER_TILES
+    anim_apply_frame(player_anim_init, PLAYER_TILES);
+    ...
+    // Each time the animation moves on to the next frame
+    if (++frame == PLAYER_FRAMES) frame = 0;
+    anim_apply_frame(player_anim_frames[frame], PLAYER_TILES);
+    move_metasprite_ex(player_metasprites[frame], PLAYER_TILES, 0, 0, x, y);
+    \endcode
+
+    `<name>_anim_frames[n]` holds the changes from frame n - 1 to frame n,
+    and the first frame the changes from the last one so animations can
+    loop. `<name>_anim_init` loads all tiles of the first frame. Other
+    frame orders need those for the frames they are played from.
+
+    \section anim_seqs Animation sequences
+
+    png2asset with `-anim_seq <file>` also exports the sequences of a
+    text file, one per line: a name, `loop` or `once`, then the frames
+    as `<frame>[:<ticks>][@<event>]`:
+    \code{.unparsed}
+    ; name   mode  frames
+    walk     loop  0:6 1:6 2:6 3:6
+    attack   once  4:3 5:3 6:8@1     ; event 1 when the blow lands
+    \endcode
+    They are exported as `<name>_anim_seqs[]`, indexed by the
+    `<name>_ANIM_<SEQUENCE>` defines. An @ref animator_t plays one of
+    them, and @ref anim_tick_all() advances a whole array of animators
+    by one tick in a single loop (in assembly on GB/AP/Duck). After it,
+    `changed` tells which animators show another frame and `event`
+    which ones entered a frame with an event:
+    \code{.c}
+    animator_t actors_anim[ACTOR_COUNT];
+    ...
+    anim_play(&actors_anim[0], &hero_anim_seqs[hero_ANIM_WALK]);
+    ...
+    anim_tick_all(actors_anim, ACTOR_COUNT);
+    for (i = 0; i != ACTOR_COUNT; i++) {
+        if (actors_anim[i].event == 1) hit_check(i);
+    }
+    if (actors_anim[0].changed) anim_apply_frame(hero_anim_frames[actors_anim[0].frame], HERO_TILES);
+    \endcode
+    The metasprite of each actor is then `<name>_metasprites[anim.frame]`,
+    for the sprite batch of gbdk/metasprite_batch.h or move_metasprite_ex().
+    Loading only the changed tiles with @ref anim_apply_frame() works
+    for sequences which play the frames in sheet order, as the changes
+    are made from frame n - 1 to frame n.
+*/
+
+#ifndef __ANIM_H_INCLUDE
+#define __ANIM_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Loads the sprite tiles which change for an animation frame
+
+    @param frame      Frame changes exported by png2asset with `-anim_diffs`
+                      (`<name>_anim_frames[n]` or `<name>_anim_init`)
+    @param base_tile  First sprite tile of the animation slots,
+                      `<name>_ANIM_TILE_COUNT` tiles are used from there on
+
+    Each run of consecutive changed slots is a single @ref set_sprite_data() call.
+
+    @see set_sprite_data
+*/
+void anim_apply_frame(const uint8_t * frame, uint8_t base_tile);
+
+/** Flag of @ref anim_seq_t: start again with the first frame after the last one */
+#define ANIM_LOOP 0x01
+/** Flag of @ref animator_t: a sequence without @ref ANIM_LOOP has reached its last frame */
+#define ANIM_DONE 0x80
+
+/** Maximum number of frames of a sequence */
+#define ANIM_SEQ_FRAMES_MAX 85
+
+/** One frame of an animation sequence */
+typedef struct anim_frame_t {
+    uint8_t frame;  /**< Frame of the sprite sheet (metasprite index) */
+    uint8_t ticks;  /**< Ticks it is shown, 0 holds it until the next @ref anim_play() */
+    uint8_t event;  /**< Reported in @ref animator_t.event when the frame is entered, 0 for none */
+} anim_frame_t;
+
+/** An animation sequence, as exported by png2asset `-anim_seq` */
+typedef struct anim_seq_t {
+    const anim_frame_t * frames;    /**< Frames of the sequence */
+    uint8_t count;                  /**< Number of frames, 1 to @ref ANIM_SEQ_FRAMES_MAX */
+    uint8_t flags;                  /**< 0 or @ref ANIM_LOOP */
+} anim_seq_t;
+
+/** State of one animation, advanced by @ref anim_tick_all()
+
+    The layout is fixed, the assembly of @ref anim_tick_all() depends on it.
+*/
+typedef struct animator_t {
+    uint8_t timer;                  /**< Ticks left on the current frame, 0 when stopped */
+    uint8_t index;                  /**< Current frame of the sequence */
+    uint8_t count;                  /**< Frames of the sequence */
+    uint8_t flags;                  /**< @ref ANIM_LOOP, and @ref ANIM_DONE once a sequence without it has ended */
+    const anim_frame_t * frames;    /**< Frames of the sequence */
+    uint8_t frame;                  /**< Sprite sheet frame shown */
+    uint8_t event;                  /**< Event of the frame entered by the last tick, 0 for none */
+    uint8_t changed;                /**< TRUE if the last tick (or @ref anim_play()) changed __frame__ */
+} animator_t;
+
+/** Starts playing a sequence from its first frame
+
+    @param anim  Animator
+    @param seq   Sequence, for example `&hero_anim_seqs[hero_ANIM_WALK]`
+
+    Sets __frame__, __event__ and __changed__ for the first frame.
+*/
+void anim_play(animator_t * anim, const anim_seq_t * seq);
+
+/** Advances animators by one tick
+
+    @param anims  Array of animators
+    @param count  Number of animators
+
+    Clears __event__ and __changed__ of each animator, then moves the
+    ones whose frame time is over to their next frame, setting them
+    again for those. A sequence without @ref ANIM_LOOP stops on its
+    last frame and gets @ref ANIM_DONE.
+*/
+void anim_tick_all(animator_t * anims, uint8_t count);
+
+/** TRUE once a sequence without @ref ANIM_LOOP has ended */
+#define ANIM_IS_DONE(anim) ((anim)->flags & ANIM_DONE)
+
+#endif
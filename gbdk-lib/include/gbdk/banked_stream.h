@@ -0,0 +1,100 @@
+/** @file gbdk/banked_stream.h
+
+    Reading data which is split across ROM banks
+
+    An auto-banked (`#pragma bank 255`) .c file with a single const
+    array larger than a bank can be split across banks by
+    @ref bankpack with `-split=<file>` (passed through lcc as
+    `-Wb-split=<file>`). The array is cut into segments of up to a
+    bank each, which are placed like any other auto-banked data, and
+    a table of them named `<array>_segments` is written to `<file>`,
+    which lcc links with the rest:
+    \code{.sh}
+    lcc -autobank -Wb-split=build/segments.o -o game.gb main.c res/intro_pcm.c
+    \endcode
+
+    A @ref banked_stream_t then reads through the segments in order,
+    switching banks as needed:
+    \code{.c}
+    #include <gbdk/banked_stream.h>
+
+    BANKED_SEGMENTS(intro_pcm);
+
+    banked_stream_t s;
+    uint8_t buf[32];
+
+    banked_stream_open(&s, intro_pcm_segments);
+    while (banked_stream_read(&s, buf, sizeof(buf)) == sizeof(buf)) {
+        play(buf);
+        vsync();
+    }
+    \endcode
+
+    The first segment keeps the name of the array, so `BANK(intro_pcm)`
+    and `intro_pcm` are its bank and start. Indexing the array past the
+    first segment does not work, only the stream sees the rest.
+
+    The table is in non-banked ROM. Each segment is 16K except the
+    last, and an array can be split as long as it holds only data:
+    no pointers, and no other symbols in the same file.
+
+    Available for GB/AP/Duck and SMS/GG.
+*/
+
+#ifndef __BANKED_STREAM_H_INCLUDE
+#define __BANKED_STREAM_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** One segment of a split array, written by bankpack
+ */
+typedef struct banked_segment_t {
+    uint8_t bank;                       /**< ROM bank of the segment */
+    const uint8_t * data;               /**< Start of the segment */
+    uint16_t size;                      /**< Bytes in the segment, 0 for the entry which ends the table */
+} banked_segment_t;
+
+/** Declares the segment table `name_segments` of the split array __name__
+ */
+#define BANKED_SEGMENTS(name) extern const banked_segment_t name ## _segments[]
+
+/** Position in a split array
+ */
+typedef struct banked_stream_t {
+    const banked_segment_t * segment;   /**< Segment being read, the end of the table once all are read */
+    const uint8_t * ptr;                /**< Next byte in __segment__ */
+    uint16_t left;                      /**< Bytes left in __segment__ */
+} banked_stream_t;
+
+/** Starts reading at the beginning of a split array
+
+    @param s         Stream
+    @param segments  Segment table, `name_segments`
+ */
+void banked_stream_open(banked_stream_t * s, const banked_segment_t * segments);
+
+/** Copies the next __len__ bytes of the array to __dst__
+
+    The bank of each segment is switched in while copying from it,
+    then the bank which was switched in before is restored.
+
+    @param s    Stream
+    @param dst  Where to copy to, in RAM
+    @param len  Most bytes to copy
+    @return     Bytes copied, less than __len__ once the end of the array is reached
+ */
+uint16_t banked_stream_read(banked_stream_t * s, void * dst, uint16_t len);
+
+/** Moves to byte __offset__ from the start of the array
+
+    Counts through the segments from the start, so it costs one step
+    per 16K. Past the end of the array the stream is at its end.
+
+    @param s         Stream
+    @param segments  Segment table, `name_segments`
+    @param offset    Bytes from the start of the array
+ */
+void banked_stream_seek(banked_stream_t * s, const banked_segment_t * segments, uint32_t offset);
+
+#endif
@@ -0,0 +1,134 @@
+/** @file gbdk/collide.h
+
+    Rectangle collision with a uniform grid broadphase
+
+    Checking every entity against every other one takes n * (n - 1) / 2
+    rectangle tests per frame. Instead, the entities are sorted into a
+    grid of 8 x 8 cells of 32 x 32 pixels over the 256 x 256 coordinate
+    space each frame, and only entities in the same cell are tested,
+    so the cost grows with the number of entities rather than with its
+    square.
+
+    The rectangles use 8 bit coordinates, for example screen or
+    camera relative ones. For a metasprite converted by png2asset
+    with `-pw` / `-ph`, the collision rectangle around the pivot is
+    `x - name_PIVOT_W / 2`, `y - name_PIVOT_H / 2`,
+    `name_PIVOT_W`, `name_PIVOT_H`.
+    \code{.c}
+    collide_rect_t rects[MAX_ENTITIES];
+    collide_entry_t entries[MAX_ENTITIES * 2];
+    collide_grid_t grid;
+
+    void on_hit(uint8_t a, uint8_t b) {
+        ...
+    }
+
+    collide_init(&grid, entries, MAX_ENTITIES * 2);
+    while (1) {
+        for (i = 0; i != entity_count; i++) {
+            rects[i].x = entities[i].x - (player_PIVOT_W / 2);
+            ...
+        }
+        collide_build(&grid, rects, entity_count);
+        collide_pairs(&grid, on_hit);
+        vsync();
+    }
+    \endcode
+
+    A rectangle is added to every cell it touches, so one of up to
+    32 x 32 pixels takes 1 to 4 entries.
+*/
+
+#ifndef __COLLIDE_H_INCLUDE
+#define __COLLIDE_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Grid cells per row and column */
+#define COLLIDE_GRID_SIZE 8
+/** Size of a grid cell in pixels */
+#define COLLIDE_CELL_SIZE 32
+/** Number of grid cells */
+#define COLLIDE_CELLS (COLLIDE_GRID_SIZE * COLLIDE_GRID_SIZE)
+/** End of a cell list */
+#define COLLIDE_NONE 0xFFu
+
+/** A collision rectangle
+
+    __x__ + __w__ and __y__ + __h__ must not go beyond 256, clip
+    rectangles at the edge of the coordinate space. A rectangle with
+    a width or height of 0 never collides.
+ */
+typedef struct collide_rect_t {
+    uint8_t x;      /**< Left edge */
+    uint8_t y;      /**< Top edge */
+    uint8_t w;      /**< Width in pixels */
+    uint8_t h;      /**< Height in pixels */
+} collide_rect_t;
+
+/** Entry of a cell list */
+typedef struct collide_entry_t {
+    uint8_t id;     /**< Index of the rectangle */
+    uint8_t next;   /**< Next entry of the cell, or @ref COLLIDE_NONE */
+} collide_entry_t;
+
+/** State of a collision grid
+ */
+typedef struct collide_grid_t {
+    const collide_rect_t * rects;       /**< Rectangles of the last @ref collide_build() */
+    collide_entry_t * entries;          /**< Entries of the cell lists */
+    uint8_t entry_count;                /**< Number of entries in __entries__ */
+    uint8_t used;                       /**< Number of entries used */
+    uint8_t head[COLLIDE_CELLS];        /**< First entry of each cell, or @ref COLLIDE_NONE */
+} collide_grid_t;
+
+/** Called for every pair of overlapping rectangles, with __a__ < __b__ */
+typedef void (*collide_pair_fn)(uint8_t a, uint8_t b);
+
+/** Called for every rectangle which overlaps the one given to @ref collide_query() */
+typedef void (*collide_hit_fn)(uint8_t id);
+
+/** Sets up an empty collision grid
+
+    @param grid         Grid to set up
+    @param entries      Buffer of __entry_count__ entries
+    @param entry_count  Number of entries, 1 to 254. Each rectangle
+                        takes one for each cell it touches.
+ */
+void collide_init(collide_grid_t * grid, collide_entry_t * entries, uint8_t entry_count);
+
+/** Sorts __count__ rectangles into the grid, replacing the ones before
+
+    @param grid   Grid to fill
+    @param rects  Rectangles, their index is the id passed to the callbacks.
+                  They must stay unchanged until the grid is built again.
+    @param count  Number of rectangles, up to 254
+
+    @return Number of rectangles which fit into the entries. When it is
+            below __count__, the rest are left out.
+ */
+uint8_t collide_build(collide_grid_t * grid, const collide_rect_t * rects, uint8_t count);
+
+/** Calls __fn__ once for every pair of overlapping rectangles in the grid
+
+    @param grid  Grid filled by @ref collide_build()
+    @param fn    Callback for each pair
+ */
+void collide_pairs(collide_grid_t * grid, collide_pair_fn fn);
+
+/** Calls __fn__ once for every rectangle in the grid which overlaps __rect__
+
+    @param grid  Grid filled by @ref collide_build()
+    @param rect  Rectangle to test, for example an attack
+    @param fn    Callback for each rectangle
+ */
+void collide_query(collide_grid_t * grid, const collide_rect_t * rect, collide_hit_fn fn);
+
+/** Returns non zero if the rectangles __a__ and __b__ overlap
+
+    Both need a width and height above 0.
+ */
+uint8_t collide_overlap(const collide_rect_t * a, const collide_rect_t * b);
+
+#endif
@@ -42,4 +42,43 @@ void setchar(char c) OLDCALL;
 void cls(void);
 
 
+#if defined(__TARGET_gb) || defined(__TARGET_ap) || defined(__TARGET_duck)
+
+/** Width and height of the console in characters */
+#define CONSOLE_WIDTH  20
+#define CONSOLE_HEIGHT 18
+
+/** Size in bytes of the buffer for @ref console_buffer_set() */
+#define CONSOLE_BUFFER_SIZE ((CONSOLE_WIDTH + 1) * CONSOLE_HEIGHT)
+
+/** Makes the console (putchar(), printf(), setchar(), cls()) write
+    to a shadow text buffer in RAM instead of the tile map
+
+    @param buf  Buffer of @ref CONSOLE_BUFFER_SIZE bytes, or NULL to
+                write to the tile map again
+
+    Writing a character then never waits for VRAM, and scrolling
+    only clears one row of the buffer instead of moving the whole
+    tile map. @ref console_flush() writes the changed rows to the
+    tile map and scrolls it with @ref SCY_REG, call it once per frame.
+
+    The text on screen is copied into __buf__ first. With NULL
+    the text is written back to an unscrolled tile map and
+    @ref SCY_REG is reset to 0.
+
+    Don't change @ref SCY_REG while the buffer is in use.
+
+    @see console_flush()
+*/
+void console_buffer_set(uint8_t * buf);
+
+/** Writes the rows of the shadow text buffer changed since
+    the last flush to the tile map and updates @ref SCY_REG
+
+    Does nothing when no buffer is set with @ref console_buffer_set().
+*/
+void console_flush(void);
+
+#endif
+
 #endif /* _CONSOLE_H */
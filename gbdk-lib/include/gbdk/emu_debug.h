@@ -74,6 +74,22 @@ llbl: \
 .ENDM \
 name ^/message_text/, ^/message_suffix/ \
 __endasm
+
+#define EMU_MESSAGE_WRAP(message_prefix, message_text, message_suffix) EMU_MESSAGE4(EMU_MACRONAME(__LINE__), message_prefix, message_text, message_suffix)
+#define EMU_MESSAGE4(name, message_prefix, message_text, message_suffix) \
+__asm \
+.MACRO name msg_p, msg_t, msg_s, ?llbl\
+  ld d, d \
+  jr llbl \
+  .dw 0x6464 \
+  .dw 0x0000 \
+  .ascii msg_p \
+  .ascii msg_t \
+  .ascii msg_s \
+llbl: \
+.ENDM \
+name ^/message_prefix/, ^/message_text/, ^/message_suffix/ \
+__endasm
 /// \endcond DOXYGEN_DO_NOT_DOCUMENT
 
 /** Macro to __Start__ a profiling block for the emulator (BGB, Emulicious, etc)
@@ -121,6 +137,61 @@ __endasm
 #define BGB_PROFILE_END(MSG) EMU_PROFILE_END(MSG)
 #endif
 
+/** Macros to mark the __Start__ and __End__ of a named profiling zone
+
+    @param NAME  Quoted zone name, without commas
+
+    Each macro prints the emulator's total clock count in a
+    machine readable line of the debug message window:
+    \code{.c}
+    PROFZONE,B,<name>,<clocks>
+    PROFZONE,E,<name>,<clocks>
+    \endcode
+
+    Unlike @ref EMU_PROFILE_BEGIN() and @ref EMU_PROFILE_END() the zones
+    may be nested, and the same zone may be entered many times (for example
+    once per frame). Save the debug messages to a file and run
+    `gbdk-support/emu_profile/emu_profile.py` to get the count, min, mean,
+    max and a histogram of the time spent in each zone.
+
+    The zones are only compiled in if `EMU_PROFILE_ZONES` is defined,
+    for example with `-DEMU_PROFILE_ZONES` on the lcc command line.
+    Otherwise they produce no code at all, so they can be left in
+    release builds.
+    \code{.c}
+    while (TRUE) {
+        EMU_PROFILE_ZONE_BEGIN("frame");
+        update_actors();
+        EMU_PROFILE_ZONE_BEGIN("draw");
+        draw_actors();
+        EMU_PROFILE_ZONE_END("draw");
+        EMU_PROFILE_ZONE_END("frame");
+        vsync();
+    }
+    \endcode
+
+    The results are in the same emulator clock units as @ref EMU_PROFILE_END().
+    Each zone also includes the few clocks used by one debug message.
+
+    On the Game Boy with `GBDK_CRASH_BREADCRUMBS` defined each
+    @ref EMU_PROFILE_ZONE_BEGIN() also records the low byte of its
+    line number as a breadcrumb for the crash handler, with or
+    without `EMU_PROFILE_ZONES` (see gb/crash_handler.h).
+ */
+#if defined(GBDK_CRASH_BREADCRUMBS) && (defined(__TARGET_gb) || defined(__TARGET_ap))
+#include <gb/crash_handler.h>
+#define EMU_PROFILE_ZONE_CRUMB() CRASH_ZONE((uint8_t)__LINE__)
+#else
+#define EMU_PROFILE_ZONE_CRUMB()
+#endif
+#if defined(EMU_PROFILE_ZONES)
+#define EMU_PROFILE_ZONE_BEGIN(NAME) EMU_PROFILE_ZONE_CRUMB(); EMU_MESSAGE_WRAP("PROFZONE,B,", NAME, ",%TOTALCLKS%");
+#define EMU_PROFILE_ZONE_END(NAME) EMU_MESSAGE_WRAP("PROFZONE,E,", NAME, ",%TOTALCLKS%");
+#else
+#define EMU_PROFILE_ZONE_BEGIN(NAME) EMU_PROFILE_ZONE_CRUMB()
+#define EMU_PROFILE_ZONE_END(NAME)
+#endif
+
 #define EMU_TEXT(MSG) EMU_MESSAGE(MSG)
 #define BGB_TEXT(MSG) EMU_TEXT(MSG)
 
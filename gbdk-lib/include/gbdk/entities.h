@@ -0,0 +1,107 @@
+/** @file gbdk/entities.h
+
+    Structure of arrays entity table
+
+    With an array of entity structs, `entities[i].x` has to multiply
+    __i__ by the size of the struct, which is a call to the multiply
+    routine or a series of shifts and adds on every access. Keeping
+    each field in its own array, indexed by an 8 bit entity id,
+    turns every access into a single add of the id to the address of
+    the array, and a loop over one field touches only that field.
+
+    An @ref entity_table_t only hands out the ids: the fields are
+    plain arrays declared with @ref ENTITY_FIELD().
+    \code{.c}
+    #define MAX_ENTITIES 32
+
+    ENTITY_FIELD(uint8_t, ent_x, MAX_ENTITIES);
+    ENTITY_FIELD(uint8_t, ent_y, MAX_ENTITIES);
+    ENTITY_FIELD(int8_t, ent_dx, MAX_ENTITIES);
+
+    uint8_t ent_live[MAX_ENTITIES], ent_slot[MAX_ENTITIES];
+    entity_table_t ents;
+
+    entity_init(&ents, ent_live, ent_slot, MAX_ENTITIES);
+    uint8_t id = entity_alloc(&ents);
+    ent_x[id] = 80;
+    ...
+    uint8_t i;
+    ENTITY_FOREACH(&ents, i) {
+        ent_x[i] += ent_dx[i];
+        if (ent_x[i] > 160) entity_free(&ents, i);
+    }
+    \endcode
+
+    The ids of the live entities are kept together at the start of
+    the __live__ array and the free ones after them, so allocating,
+    freeing and the loop over the live entities don't search.
+*/
+
+#ifndef __ENTITIES_H_INCLUDE
+#define __ENTITIES_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Returned by @ref entity_alloc() when the table is full */
+#define ENTITY_NONE 0xFFu
+
+/** Declares the array of one field, for entity ids 0 to __capacity__ - 1 */
+#define ENTITY_FIELD(type, name, capacity) type name[(capacity)]
+
+/** Declares an array of one field defined in another file */
+#define ENTITY_FIELD_EXTERN(type, name, capacity) extern type name[(capacity)]
+
+/** Runs the following statement with __id__ set to each live entity of __table__
+
+    The entities are visited from the newest position to the oldest,
+    so the one being visited can be freed with @ref entity_free()
+    inside the loop. Entities allocated inside the loop are not
+    visited until the next one.
+ */
+#define ENTITY_FOREACH(table, id) \
+    for (uint8_t __ent_pos = (table)->count; (__ent_pos--) && (((id) = (table)->live[__ent_pos]), 1); )
+
+/** State of an entity table
+ */
+typedef struct entity_table_t {
+    uint8_t * live;         /**< Ids of the live entities, then of the free ones */
+    uint8_t * slot;         /**< Position of each id in __live__ */
+    uint8_t capacity;       /**< Number of ids */
+    uint8_t count;          /**< Number of live entities */
+} entity_table_t;
+
+/** Sets up an entity table with all ids free
+
+    @param table     Table to set up
+    @param live      Buffer of __capacity__ bytes
+    @param slot      Buffer of __capacity__ bytes
+    @param capacity  Number of entities, 1 to 255
+ */
+void entity_init(entity_table_t * table, uint8_t * live, uint8_t * slot, uint8_t capacity);
+
+/** Returns a free entity id, or @ref ENTITY_NONE if all are live
+
+    @param table  Table to allocate from
+
+    The fields of the entity keep whatever they held before.
+ */
+uint8_t entity_alloc(entity_table_t * table);
+
+/** Frees a live entity id
+
+    @param table  Table it was allocated from
+    @param id     Live id returned by @ref entity_alloc(). Freeing an id
+                  twice corrupts the table.
+ */
+void entity_free(entity_table_t * table, uint8_t id);
+
+/** Returns the number of live entities
+
+    @param table  Table
+ */
+inline uint8_t entity_count(const entity_table_t * table) {
+    return table->count;
+}
+
+#endif
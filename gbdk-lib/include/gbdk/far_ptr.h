@@ -64,6 +64,36 @@
 */
 #define FAR_CALL(ptr, typ, ...) (__call_banked_ptr=ptr,((typ)(&__call__banked))(__VA_ARGS__))
 
+#if defined(__PORT_sm83)
+/** Macro to call a function at far pointer __ptr__, passing the far pointer on the stack
+    @param ptr    Far pointer of a function to call (type @ref FAR_PTR)
+    @param typ    Type of the function with an extra @ref FAR_PTR first parameter
+    @param ...    VA Args list of parameters for the function
+
+    Unlike @ref FAR_CALL() this doesn't go through the global @ref __call_banked_ptr,
+    so it is reentrant and may be used in interrupt handlers as well. A call into the
+    bank which is already active doesn't switch banks and returns straight to the
+    caller, which makes it cheaper for dispatch tables of functions which are mostly
+    in the same bank. For example:
+    \code{.c}
+    // Functions in some bank
+    void walk(entity_t * e) __banked;
+    void jump(entity_t * e) __banked;
+
+    ...
+    // The same type as the functions, with the far pointer in front
+    typedef void (*behaviour_fast_t)(FAR_PTR, entity_t *) __banked;
+
+    FAR_CALL_FAST(behaviours[e->state], behaviour_fast_t, e);
+    \endcode
+
+    Only available on the sm83 port (GB/AP/Duck).
+
+    @returns Value returned by the function (if present)
+*/
+#define FAR_CALL_FAST(ptr, typ, ...) (((typ)(&__call__banked_fast))(ptr, ##__VA_ARGS__))
+#endif
+
 /** Type for storing a FAR_PTR
 */
 typedef uint32_t FAR_PTR;
@@ -87,13 +117,24 @@ extern volatile void * __call_banked_addr;
 extern volatile uint8_t __call_banked_bank;
 
 void __call__banked(void);
+#if defined(__PORT_sm83)
+void __call__banked_fast(void);
+#endif
 
 /** Obtain a far pointer at runtime
     @param ofs    Memory address within the given Segment (Bank)
     @param seg    Segment (Bank) number
 
+    Inlined where the compiler can, which avoids the call and lets constant
+    pieces fold. The library keeps the function for the other uses.
+
     @returns A far pointer (type @ref FAR_PTR)
 */
-uint32_t to_far_ptr(void* ofs, uint16_t seg);
+inline uint32_t to_far_ptr(void* ofs, uint16_t seg) {
+    union __far_ptr p;
+    p.segofs.ofs = ofs;
+    p.segofs.seg = seg;
+    return p.ptr;
+}
 
 #endif
\ No newline at end of file
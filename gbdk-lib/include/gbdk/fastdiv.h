@@ -0,0 +1,92 @@
+/** @file gbdk/fastdiv.h
+
+    Fast unsigned 8 bit division
+
+    The `/` and `%` operators on `uint8_t` call the compiler's generic
+    division routine, which is a 16 bit shift and subtract loop on all
+    platforms. @ref div_u8(), @ref mod_u8() and @ref div_mod_u8() only
+    do the 8 steps an 8 bit division needs (unrolled on the Game Boy
+    and SMS/GG), and @ref div_mod_u8() returns the quotient and the
+    remainder from a single division.
+
+    For a divisor which is known at compile time, @ref DIV_U8_CONST()
+    and @ref MOD_U8_CONST() replace the division with multiplies by
+    the reciprocal of the divisor and shifts.
+
+    Nothing changes for code which keeps using `/` and `%`: these
+    functions are only linked in when they are called.
+*/
+
+#ifndef __FASTDIV_H_INCLUDE
+#define __FASTDIV_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Returns __a__ / __b__
+
+    @param a  Dividend
+    @param b  Divisor. If it is 0 the result is 255.
+ */
+uint8_t div_u8(uint8_t a, uint8_t b);
+
+/** Returns __a__ % __b__
+
+    @param a  Dividend
+    @param b  Divisor. If it is 0 the result is __a__.
+ */
+uint8_t mod_u8(uint8_t a, uint8_t b);
+
+/** Returns both __a__ / __b__ and __a__ % __b__
+
+    @param a  Dividend
+    @param b  Divisor
+
+    The quotient is in the low byte of the result, see @ref DIV_MOD_QUOT(),
+    and the remainder is in the high byte, see @ref DIV_MOD_REM().
+    \code{.c}
+    uint16_t qr = div_mod_u8(x, 10);
+    tens = DIV_MOD_QUOT(qr);
+    ones = DIV_MOD_REM(qr);
+    \endcode
+ */
+uint16_t div_mod_u8(uint8_t a, uint8_t b);
+
+/** Quotient from the result of @ref div_mod_u8() */
+#define DIV_MOD_QUOT(qr) ((uint8_t)(qr))
+
+/** Remainder from the result of @ref div_mod_u8() */
+#define DIV_MOD_REM(qr) ((uint8_t)((qr) >> 8))
+
+/** Reciprocal of __d__ used by @ref DIV_U8_CONST(): 65536 / __d__, rounded up
+
+    Exact quotients for all 8 bit dividends and divisors from 2 to 255.
+ */
+#define FASTDIV_RECIP_U8(d) ((uint16_t)((0x10000UL + (d) - 1) / (d)))
+
+/** Returns __x__ / __d__ for a constant __d__ from 1 to 255, without a division
+
+    @param x  Dividend, a uint8_t. It is evaluated twice.
+    @param d  Divisor, a constant expression
+
+    Computes (__x__ * @ref FASTDIV_RECIP_U8(__d__)) >> 16 as two 8 x 8 bit
+    multiplies, so no 32 bit arithmetic is needed. The result is exact.
+    \code{.c}
+    digit  = DIV_U8_CONST(score, 10);   // Same as score / 10
+    column = DIV_U8_CONST(pixel_x, 24); // Same as pixel_x / 24
+    \endcode
+ */
+#define DIV_U8_CONST(x, d) (((d) == 1) ? (uint8_t)(x) : \
+    (uint8_t)(((uint16_t)(uint8_t)(x) * (uint8_t)(FASTDIV_RECIP_U8(d) >> 8) + \
+               (((uint16_t)(uint8_t)(x) * (uint8_t)FASTDIV_RECIP_U8(d)) >> 8)) >> 8))
+
+/** Returns __x__ % __d__ for a constant __d__ from 1 to 255, without a division
+
+    @param x  Dividend, a uint8_t. It is evaluated three times.
+    @param d  Divisor, a constant expression
+
+    @see DIV_U8_CONST
+ */
+#define MOD_U8_CONST(x, d) ((uint8_t)((uint8_t)(x) - (uint8_t)(DIV_U8_CONST(x, d) * (uint8_t)(d))))
+
+#endif
@@ -0,0 +1,118 @@
+/** @file gbdk/fixed.h
+
+    Signed fixed point math
+
+    @ref fixed8_8 holds a signed value with 8 integer and 8 fraction
+    bits (-128.0 to 127.996), @ref fixed16_16 one with 16 integer and
+    16 fraction bits. Addition and subtraction are plain integer
+    operations. Multiplication, division and square roots are done
+    with the functions below, which are built from 8 x 8 bit multiplies
+    and never call the 32 bit multiply or divide routines.
+
+    Angles are stored in a uint8_t, with 256 steps for a full circle:
+    0 points along +X, 64 along +Y, 128 along -X and 192 along -Y.
+    \code{.c}
+    fixed8_8 speed = FIXED8_8(1.5);
+    uint8_t dir = fixed_atan2(target_y - y, target_x - x);
+
+    x += fixed8_8_mul(fixed_cos(dir), speed);
+    y += fixed8_8_mul(fixed_sin(dir), speed);
+    \endcode
+
+    This is unrelated to the @ref fixed union in types.h, which gives
+    byte access to an unsigned 8.8 value.
+*/
+
+#ifndef __FIXED_H_INCLUDE
+#define __FIXED_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Signed 8.8 fixed point value */
+typedef int16_t fixed8_8;
+
+/** Signed 16.16 fixed point value */
+typedef int32_t fixed16_16;
+
+/** Converts a constant __n__ (may have a fraction) to @ref fixed8_8 */
+#define FIXED8_8(n) ((fixed8_8)((n) * 256))
+/** Integer part of the @ref fixed8_8 __f__, rounded down */
+#define FIXED8_8_INT(f) ((int8_t)((f) >> 8))
+/** Fraction part of the @ref fixed8_8 __f__, in 1/256 units */
+#define FIXED8_8_FRAC(f) ((uint8_t)(f))
+
+/** Converts a constant __n__ (may have a fraction) to @ref fixed16_16 */
+#define FIXED16_16(n) ((fixed16_16)((n) * 65536.0))
+/** Integer part of the @ref fixed16_16 __f__, rounded down */
+#define FIXED16_16_INT(f) ((int16_t)((f) >> 16))
+/** Fraction part of the @ref fixed16_16 __f__, in 1/65536 units */
+#define FIXED16_16_FRAC(f) ((uint16_t)(f))
+
+/** Converts the @ref fixed8_8 __f__ to @ref fixed16_16 */
+#define FIXED8_8_TO_16_16(f) ((fixed16_16)(f) << 8)
+/** Converts the @ref fixed16_16 __f__ to @ref fixed8_8, the result is undefined if it does not fit */
+#define FIXED16_16_TO_8_8(f) ((fixed8_8)((f) >> 8))
+
+/** Converts a constant angle in degrees to the 256 steps per circle used by @ref fixed_sin() */
+#define FIXED_ANGLE(deg) ((uint8_t)((deg) * 256L / 360))
+
+/** Returns __a__ * __b__
+
+    The result is rounded towards zero, and is undefined if it does not fit.
+ */
+fixed8_8 fixed8_8_mul(fixed8_8 a, fixed8_8 b);
+
+/** Returns __a__ / __b__
+
+    The result is rounded towards zero. Dividing by 0, or a result which
+    does not fit, returns the largest value with the sign of the result.
+ */
+fixed8_8 fixed8_8_div(fixed8_8 a, fixed8_8 b);
+
+/** Returns the square root of __x__
+
+    Negative values return 0.
+ */
+fixed8_8 fixed8_8_sqrt(fixed8_8 x);
+
+/** Returns __a__ * __b__
+
+    The result is rounded towards zero, and is undefined if it does not fit.
+ */
+fixed16_16 fixed16_16_mul(fixed16_16 a, fixed16_16 b);
+
+/** Returns __a__ / __b__
+
+    The result is rounded towards zero, and is undefined if it does not fit.
+    Dividing by 0 returns the largest value with the sign of __a__.
+ */
+fixed16_16 fixed16_16_div(fixed16_16 a, fixed16_16 b);
+
+/** Returns the sine of __angle__ as a @ref fixed8_8 from -1.0 to 1.0
+
+    @param angle  Angle, 256 steps per circle
+
+    Read from a 64 entry table.
+ */
+fixed8_8 fixed_sin(uint8_t angle);
+
+/** Returns the cosine of __angle__ as a @ref fixed8_8 from -1.0 to 1.0
+
+    @param angle  Angle, 256 steps per circle
+ */
+inline fixed8_8 fixed_cos(uint8_t angle) {
+    return fixed_sin(angle + 64u);
+}
+
+/** Returns the angle of the vector __x__, __y__
+
+    @param y  Y component, any scale (integer or fixed point)
+    @param x  X component, in the same scale as __y__
+
+    @return Angle, 256 steps per circle, less than one step from the exact angle.
+    0 if both __x__ and __y__ are 0.
+ */
+uint8_t fixed_atan2(int16_t y, int16_t x);
+
+#endif
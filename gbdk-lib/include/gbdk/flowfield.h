@@ -0,0 +1,136 @@
+/** @file gbdk/flowfield.h
+
+    Flow field pathfinding over a packed collision map
+
+    Instead of each enemy searching for its own path, one breadth first
+    search spreads out from the target (usually the player) over the
+    collision map exported by png2asset `-collision_map` (see
+    gbdk/tile_flags.h). It leaves in every reachable tile the direction
+    of the next tile on a shortest path to the target, so any number of
+    enemies follow it with one lookup each.
+    \code{.c}
+    #include "level.h"
+
+    #define MAP_W (level_WIDTH / 8)
+    #define MAP_H (level_HEIGHT / 8)
+    #define FIELD_SHIFT 5   // level is 32 tiles wide or less
+    uint8_t field[MAP_H << FIELD_SHIFT];
+    uint16_t queue[MAP_W * MAP_H];
+    flowfield_t ff;
+
+    flowfield_init(&ff, field, queue, level_collision, level_COLLISION_ROW_SHIFT, level_COLLISION_BITS,
+                   MAP_W, MAP_H, FIELD_SHIFT);
+    while (1) {
+        if (flowfield_step(&ff, 64)) {
+            // Done: start over from where the player is now
+            flowfield_start(&ff, player_x >> 3, player_y >> 3);
+        }
+        for (each enemy) {
+            switch (flowfield_dir(&ff, enemy_x >> 3, enemy_y >> 3)) {
+                case FLOW_UP: enemy_y--; break;
+                ...
+            }
+        }
+        vsync();
+    }
+    \endcode
+
+    __Time slicing__
+
+    @ref flowfield_step() visits at most __budget__ tiles per call, so
+    the search of a large map is spread over several frames with a
+    bounded cost in each. The tiles reached so far keep their new
+    directions, those not reached yet read as @ref FLOW_NONE until the
+    search gets to them: enemies only stop for a few frames. To keep
+    following the previous field until the new one is complete, use
+    two field buffers and swap them when a search ends.
+
+    __Memory__
+
+    The field is one byte per tile, with rows of `1 << shift` bytes so
+    that finding a tile only takes shifts. The queue is a 16 bit entry
+    per reachable tile, at most `width * height` entries. Both go in
+    RAM; the collision map can be in ROM, but if it is banked its bank
+    must be switched in while @ref flowfield_step() runs.
+*/
+
+#ifndef __FLOWFIELD_H_INCLUDE
+#define __FLOWFIELD_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** @name Directions of the field
+    @{
+ */
+#define FLOW_NONE   0   /**< Solid, not reached yet, or no path to the target */
+#define FLOW_UP     1   /**< Next tile is above */
+#define FLOW_DOWN   2   /**< Next tile is below */
+#define FLOW_LEFT   3   /**< Next tile is to the left */
+#define FLOW_RIGHT  4   /**< Next tile is to the right */
+#define FLOW_TARGET 5   /**< The target of the search */
+/** @} */
+
+/** State of a flow field and of its search
+ */
+typedef struct flowfield_t {
+    uint8_t * field;        /**< Direction of each tile, `height << shift` bytes */
+    uint16_t * queue;       /**< Tiles to visit, `width * height` entries, each row << 8 | column */
+    const uint8_t * map;    /**< Packed collision map, `name_collision` */
+    uint8_t map_shift;      /**< `name_COLLISION_ROW_SHIFT` */
+    uint8_t map_bits;       /**< `name_COLLISION_BITS`, 1 or 2 */
+    uint8_t width;          /**< Width of the map in tiles, 1 to 255 */
+    uint8_t height;         /**< Height of the map in tiles, 1 to 255 */
+    uint8_t shift;          /**< Bytes per row of __field__, as a shift */
+    uint16_t head;          /**< Next queue entry to visit */
+    uint16_t tail;          /**< Next free queue entry */
+} flowfield_t;
+
+/** Sets up a flow field, with no search running and every tile @ref FLOW_NONE
+
+    @param ff         Flow field to set up
+    @param field      Buffer of `height << shift` bytes
+    @param queue      Buffer of `width * height` entries
+    @param map        Packed collision map, a tile is solid if its value is not 0
+    @param map_shift  `name_COLLISION_ROW_SHIFT`
+    @param map_bits   `name_COLLISION_BITS`, 1 or 2
+    @param width      Width of the map in tiles, 1 to 255
+    @param height     Height of the map in tiles, 1 to 255
+    @param shift      Bytes per row of __field__ as a shift, `1 << shift` must be at least __width__
+ */
+void flowfield_init(flowfield_t * ff, uint8_t * field, uint16_t * queue, const uint8_t * map, uint8_t map_shift,
+                    uint8_t map_bits, uint8_t width, uint8_t height, uint8_t shift);
+
+/** Clears the field and starts a new search towards tile __x__, __y__
+
+    Clearing writes the whole field buffer once. An earlier search that
+    was not finished is dropped.
+
+    @param ff  Flow field
+    @param x   Column of the target tile
+    @param y   Row of the target tile
+ */
+void flowfield_start(flowfield_t * ff, uint8_t x, uint8_t y);
+
+/** Continues the search, visiting at most __budget__ tiles
+
+    Each tile visited sets the direction of its open neighbours which
+    were not reached yet.
+
+    @param ff      Flow field
+    @param budget  Most tiles to visit in this call
+    @return        Non zero once the search is finished (also when none was started)
+ */
+uint8_t flowfield_step(flowfield_t * ff, uint16_t budget);
+
+/** Returns the direction to follow from tile __x__, __y__, one of the FLOW_ values
+
+    @param ff  Flow field
+    @param x   Column of the tile, below the width of the map
+    @param y   Row of the tile, below the height of the map
+ */
+inline uint8_t flowfield_dir(const flowfield_t * ff, uint8_t x, uint8_t y) {
+    return ff->field[((uint16_t)y << ff->shift) + x];
+}
+
+#endif
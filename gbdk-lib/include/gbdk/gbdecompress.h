@@ -9,4 +9,63 @@
   #error Unrecognized port
 #endif
 
+#include <types.h>
+#include <stdint.h>
+
+/** Resumable gb-decompress state, see @ref gb_decompress_begin()
+
+    The fields are internal to the decompressor, the only one
+    meant to be read is __dest__ (the next output address).
+ */
+typedef struct gb_decompress_ctx_t {
+    const uint8_t * sour;   /**< Next compressed byte */
+    uint8_t * dest;         /**< Next output address */
+    const uint8_t * ref;    /**< Read address for the current string repeat */
+    uint8_t cmd;            /**< Type of the current command */
+    uint8_t count;          /**< Bytes left to write for the current command */
+    uint8_t data[2];        /**< Byte or word for the current RLE command */
+    uint8_t flags;          /**< Internal flags */
+} gb_decompress_ctx_t;
+
+/** Starts a resumable gb-decompress of sour into dest
+
+    @param ctx    Pointer to decompressor state to initialize
+    @param sour   Pointer to source gb-compressed data
+    @param dest   Pointer to destination buffer/address
+
+    No data is decompressed until @ref gb_decompress_step() is called,
+    which allows decompressing large data a small part at a time
+    (for example every frame) instead of all at once with
+    @ref gb_decompress().
+
+    The source data and everything already decompressed must stay
+    unchanged (and their banks mapped) while decompressing, since later
+    data can repeat earlier output.
+
+    GB/AP/Duck only: __dest__ may be in VRAM, in that case writes wait for
+    VRAM to be accessible so the LCD can stay on. Unlike
+    @ref gb_decompress_bkg_data() there is no wrap from $97FF to $8800.
+
+    SMS/GG only: __dest__ must be in RAM.
+
+    @see gb_decompress_step, gb_decompress_done
+ */
+void gb_decompress_begin(gb_decompress_ctx_t * ctx, const uint8_t * sour, uint8_t * dest);
+
+/** Continues a resumable gb-decompress started with @ref gb_decompress_begin()
+
+    @param ctx     Pointer to decompressor state
+    @param budget  Maximum number of bytes to write during this call
+    @return        Returns `0` if decompression is complete, `1` if there is more data to decompress
+
+    @see gb_decompress_begin, gb_decompress_done
+ */
+uint8_t gb_decompress_step(gb_decompress_ctx_t * ctx, uint16_t budget);
+
+/** Returns non-zero once the decompression in __ctx__ is complete
+
+    @param ctx    Pointer to decompressor state
+ */
+uint8_t gb_decompress_done(const gb_decompress_ctx_t * ctx);
+
 #endif
\ No newline at end of file
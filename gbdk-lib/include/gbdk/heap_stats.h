@@ -0,0 +1,79 @@
+/** @file gbdk/heap_stats.h
+
+    Statistics of the malloc() heap
+
+    The statistics come from an instrumented build of malloc(),
+    free() and realloc() in heap_stats.lib, which replaces the
+    default ones when it is linked:
+    \code{.sh}
+    lcc ... -Wl-lheap_stats.lib -o game.gb game.c
+    \endcode
+    Without it, calling @ref heap_stats() fails to link, and the
+    default allocator has no overhead. It can't be used together with
+    the size class heap of heap_bins.lib.
+
+    \code{.c}
+    #include <gbdk/heap_stats.h>
+
+    heap_stats_t stats;
+
+    heap_stats(&stats);
+    if (stats.largest_free < 256) {
+        // fragmented: the memory is there, but not in one piece
+    }
+    heap_stats_print();     // to the emulator debug message window
+    \endcode
+
+    __used__ and __peak__ count whole blocks, the 2 byte header of
+    each allocation included. __free_blocks__, __free_total__ and
+    __largest_free__ walk the free list when @ref heap_stats() is
+    called. A free list that keeps growing while __free_total__ stays
+    the same is fragmentation; a high __walk_max__ or __walk_avg__
+    shows malloc() calls that spend long searching it, which a
+    fixed block pool (gbdk/pool.h) avoids.
+*/
+
+#ifndef __HEAP_STATS_H_INCLUDE
+#define __HEAP_STATS_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Heap statistics filled in by @ref heap_stats()
+ */
+typedef struct heap_stats_t {
+    uint16_t used;          /**< Bytes in allocated blocks */
+    uint16_t peak;          /**< Most bytes that were allocated at once */
+    uint16_t free_blocks;   /**< Number of blocks in the free list */
+    uint16_t free_total;    /**< Bytes in the free list */
+    uint16_t largest_free;  /**< Largest size that malloc() can return now */
+    uint32_t mallocs;       /**< Calls of malloc(), also through calloc() and realloc() */
+    uint16_t failures;      /**< Calls of malloc() which returned NULL */
+    uint16_t walk_avg;      /**< Free blocks looked at per call of malloc(), rounded to the nearest */
+    uint16_t walk_max;      /**< Most free blocks looked at by one call of malloc() */
+} heap_stats_t;
+
+/** Fills in the heap statistics, needs heap_stats.lib
+
+    @param stats  Statistics to fill in
+ */
+void heap_stats(heap_stats_t * stats);
+
+/** Resets __peak__ to the bytes used now, and the malloc() call and walk counts to 0
+ */
+void heap_stats_reset(void);
+
+#if defined(__TARGET_gb) || defined(__TARGET_ap) || defined(__TARGET_sms) || defined(__TARGET_gg)
+#include <gbdk/emu_debug.h>
+
+/** Writes the heap statistics to the emulator debug message window with EMU_printf()
+ */
+inline void heap_stats_print(void) {
+    heap_stats_t s;
+    heap_stats(&s);
+    EMU_printf("heap: used %u peak %u, free %u in %u blocks, largest %u, walk avg %u max %u, failed %u",
+               s.used, s.peak, s.free_total, s.free_blocks, s.largest_free, s.walk_avg, s.walk_max, s.failures);
+}
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+/** @file gbdk/loop.h
+
+    Fixed rate game loop with frame skipping
+
+    @ref loop_run() calls the game logic at a fixed rate counted in
+    VBlanks with @ref sys_time, so the game keeps its speed when some
+    frames take too long. When it falls behind, the render function is
+    skipped and the update function runs again right away to catch up:
+    \code{.c}
+    #include <gbdk/platform.h>
+    #include <gbdk/loop.h>
+
+    void update(void) {
+        move_enemies();
+        if (player_dead) loop_exit();
+    }
+
+    void render(void) {
+        move_sprites();
+        scroll_bkg(dx, 0);
+    }
+
+    void main(void) {
+        ...
+        loop_run(update, render);
+        game_over();
+    }
+    \endcode
+
+    When nothing is late, each step waits for the VBlank with
+    @ref vsync(), calls the render function while still in VBlank,
+    then the update function. Render then draws the state of the
+    update before it, as with a hand written `vsync(); draw(); update();`
+    loop.
+
+    At most @ref LOOP_MAX_SKIP renders are skipped in a row. If the
+    loop is still behind after that, the time it can't catch up is
+    dropped (the game slows down) and counted in
+    @ref loop_stats_t.lag, so a frame which takes much too long does
+    not lead to a burst of updates.
+*/
+
+#ifndef __LOOP_H_INCLUDE
+#define __LOOP_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Most renders @ref loop_run() skips in a row to catch up */
+#define LOOP_MAX_SKIP 4
+
+/** Update or render function called by @ref loop_run() */
+typedef void (*loop_fn)(void);
+
+/** Counters of the current or last @ref loop_run(), cleared when it starts
+ */
+typedef struct loop_stats_t {
+    uint16_t updates;       /**< Calls to the update function */
+    uint16_t renders;       /**< Calls to the render function */
+    uint16_t skipped;       /**< Renders skipped to catch up */
+    uint16_t lag;           /**< VBlanks dropped because the loop could not catch up */
+} loop_stats_t;
+
+/** Counters of @ref loop_run() */
+extern loop_stats_t loop_stats;
+
+/** Sets how many VBlanks apart @ref loop_run() calls the update function
+
+    @param vblanks  1 (the default) for every frame, 2 for every other frame...
+
+    Can be changed while the loop runs, from the next update on.
+ */
+void loop_set_rate(uint8_t vblanks);
+
+/** Runs __update__ at the rate of @ref loop_set_rate() and __render__
+    once per update, or less when behind, until @ref loop_exit() is called
+
+    @param update  Game logic, called at a fixed rate
+    @param render  Drawing, called right after the VBlank, may be NULL
+ */
+void loop_run(loop_fn update, loop_fn render);
+
+/** Makes @ref loop_run() return once the current update or render returns */
+void loop_exit(void);
+
+#endif
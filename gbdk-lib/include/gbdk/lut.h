@@ -0,0 +1,62 @@
+/** @file gbdk/lut.h
+
+    Lookups in page aligned tables
+
+    A table which starts on a 256 byte page can be read with an
+    8 bit index without any address math: the high byte of the
+    address is that of the table and the index is the low byte.
+    @ref utility_lut2asset "lut2asset" writes such tables of sine,
+    cosine, arctangent, square root and reciprocal values when the
+    output is a `.s` file:
+    \code{.c}
+    // lut2asset sin -s8 -c res/sine.s
+    #include "res/sine.h"
+
+    x = center_x + (sine_GET(angle) >> 2);
+    y = center_y + (sine_GET(angle + 64u) >> 2);    // Cosine
+    \endcode
+
+    16 bit tables are split into a page of low bytes followed by a
+    page of high bytes, so both are read with the same index.
+
+    On sm83 and z80 the macros build the address from the high
+    byte of the table and the index, which SDCC turns into loading
+    the high byte as a constant and the index as the low byte. In
+    assembly the same lookup is:
+    \code{.asm}
+    ld   h, #>_sine
+    ld   l, a
+    ld   a, (hl)
+    \endcode
+    On mos6502 they index the table as an array, `lda _sine,y`,
+    which takes no extra cycle for crossing a page since the whole
+    table is on one page.
+
+    The table must start on a page boundary (`.bndry 0x100` in
+    assembly, as lut2asset writes it), the macros don't check it.
+*/
+
+#ifndef __LUT_H_INCLUDE
+#define __LUT_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+#if defined(__PORT_sm83) || defined(__PORT_z80)
+/** Reads the uint8_t at __index__ of the page aligned table __table__ */
+#define LUT_PAGE_U8(table, index) (*(const uint8_t *)(((uint16_t)(table) & 0xFF00u) | (uint8_t)(index)))
+#else
+#define LUT_PAGE_U8(table, index) (((const uint8_t *)(table))[(uint8_t)(index)])
+#endif
+
+/** Reads the int8_t at __index__ of the page aligned table __table__ */
+#define LUT_PAGE_S8(table, index) ((int8_t)LUT_PAGE_U8(table, index))
+
+/** Reads the uint16_t at __index__ of the page aligned table __table__, low bytes on its first page and high bytes on the next */
+#define LUT_PAGE_U16(table, index) \
+    ((uint16_t)LUT_PAGE_U8(table, index) | ((uint16_t)LUT_PAGE_U8((const uint8_t *)(table) + 0x100u, index) << 8))
+
+/** Reads the int16_t at __index__ of the page aligned table __table__, low bytes on its first page and high bytes on the next */
+#define LUT_PAGE_S16(table, index) ((int16_t)LUT_PAGE_U16(table, index))
+
+#endif
@@ -0,0 +1,45 @@
+/** @file gbdk/lz4decompress.h
+
+    Decompressor for LZ4 style compressed data
+
+    Decompresses data which has been compressed with
+    @ref utility_gbcompress "gbcompress" using the `--alg=lz4` argument.
+
+    The format is byte aligned with literal and match runs of any
+    length, so it usually decompresses faster than @ref gb_decompress()
+    at a similar or better compression ratio (on SMS/GG the runs are
+    copied with `ldir`). `gbcompress -v --alg=lz4` shows the size of
+    both formats and the estimated GB decompression time of each.
+
+    With `--blocks=<size>` each __size__ bytes are compressed as a
+    separate stream, so `lz4_decompress(data + data_index[n], dest)`
+    decompresses only block __n__.
+*/
+
+#ifndef __LZ4DECOMPRESS_H_INCLUDE
+#define __LZ4DECOMPRESS_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** lz4-decompress data from sour into dest
+
+    @param sour   Pointer to source lz4 compressed data
+    @param dest   Pointer to destination buffer/address
+
+    @return       Return value is number of bytes decompressed
+
+    Will decompress __all__ of it's data to destination without
+    stopping until the end of compressed data is reached. It is
+    not possible to set a limit, so ensure the destination buffer
+    has sufficient space to avoid an overflow.
+
+    Matches are read back from the already decompressed data,
+    so __dest__ must be readable: RAM, or on GB/AP/Duck VRAM
+    with the display off.
+
+    @see gb_decompress, rle_decompress
+ */
+uint16_t lz4_decompress(const uint8_t * sour, uint8_t * dest);
+
+#endif
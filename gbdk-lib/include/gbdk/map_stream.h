@@ -0,0 +1,118 @@
+/** @file gbdk/map_stream.h
+
+    Scrolling of large background maps
+
+    A @ref map_stream_t keeps track of the camera position on a map
+    which is larger than the hardware tile map, and only draws the
+    column or row of tiles which is about to scroll into view. This
+    makes 8-way scrolling cost a small fixed amount of time per frame
+    no matter how large the map is.
+
+    \code{.c}
+    map_stream_t stream;
+
+    map_stream_init(&stream, bigmap_map, bigmap_map_attributes, BANK(bigmap), bigmap_mapWidth, bigmap_mapHeight);
+    map_stream_set_camera(&stream, 0, 0);
+    SHOW_BKG;
+    DISPLAY_ON;
+    while (1) {
+        map_stream_move(&stream, dx, dy);
+        wait_vbl_done();
+        move_bkg(stream.scroll_x, stream.scroll_y);
+    }
+    \endcode
+
+    The map is stored as one tile index per byte, row by row.
+    The attribute map is optional (pass NULL), and has the same
+    layout as the map except on the NES, where it has one byte per
+    2x2 tile attribute block.
+
+    On the Game Boy new tiles are written through the deferred VRAM
+    queue (see @ref gb/vram_queue.h), so its handler must be installed
+    with add_VBL(vram_queue_isr). Attributes are written on the CGB only.
+    On the SMS/GG tiles are written directly, on the NES they go
+    through the existing VRAM transfer buffer.
+
+    On the NES the hardware tile map is no larger than the screen,
+    so the column and row at the edges of the screen may show the
+    wrong tiles or attributes while scrolling (as with hand written
+    scrolling, see the large_map example).
+
+    Supported on GB/AP/Duck, SMS/GG and NES.
+*/
+
+#ifndef __MAP_STREAM_H_INCLUDE
+#define __MAP_STREAM_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** State of a scrolling map
+
+    Only __scroll_x__ and __scroll_y__ are meant to be read
+    directly, the other fields are maintained by the library.
+ */
+typedef struct map_stream_t {
+    const uint8_t * map;        /**< Tile indices, map_w * map_h bytes */
+    const uint8_t * attributes; /**< Tile attributes or NULL */
+    uint8_t bank;               /**< ROM bank of the map and attributes, 0 if not banked */
+    uint16_t map_w;             /**< Width of the map in tiles */
+    uint16_t map_h;             /**< Height of the map in tiles */
+    uint16_t tile_x;            /**< Map column at the left edge of the screen */
+    uint16_t tile_y;            /**< Map row at the top edge of the screen */
+    uint8_t fine_x;             /**< Pixel offset (0-7) within tile_x */
+    uint8_t fine_y;             /**< Pixel offset (0-7) within tile_y */
+    uint8_t buf_y;              /**< tile_y wrapped to the hardware tile map height */
+    uint8_t scroll_x;           /**< Value to pass to move_bkg() for X */
+    uint8_t scroll_y;           /**< Value to pass to move_bkg() for Y */
+} map_stream_t;
+
+/** Initializes a scrolling map
+
+    @param stream      Map state to initialize
+    @param map         Pointer to the tile indices of the map
+    @param attributes  Pointer to the tile attributes of the map, or NULL
+    @param bank        ROM bank with __map__ and __attributes__, or 0 if they are not banked
+    @param map_w       Width of the map in tiles (up to 65535)
+    @param map_h       Height of the map in tiles (up to 65535)
+
+    The map must be at least as large as the screen. If it is
+    banked, __map__ and __attributes__ must be in the same bank,
+    so their total size is limited by the size of the bank.
+
+    Nothing is drawn until @ref map_stream_set_camera() is called.
+ */
+void map_stream_init(map_stream_t * stream, const uint8_t * map, const uint8_t * attributes, uint8_t bank, uint16_t map_w, uint16_t map_h);
+
+/** Moves the camera to a tile position and redraws the whole screen
+
+    @param stream  Map state
+    @param tile_x  Map column to show at the left edge of the screen
+    @param tile_y  Map row to show at the top edge of the screen
+
+    The position is clamped so the camera stays within the map.
+
+    Redrawing the whole screen takes a while, so this is best done
+    with the display off (on the Game Boy the drawing otherwise takes
+    several frames to go through the VRAM queue).
+ */
+void map_stream_set_camera(map_stream_t * stream, uint16_t tile_x, uint16_t tile_y);
+
+/** Scrolls the camera and draws the tiles scrolled into view
+
+    @param stream  Map state
+    @param dx      Pixels to scroll right (negative for left)
+    @param dy      Pixels to scroll down (negative for up)
+
+    The camera stops at the edges of the map.
+
+    Afterwards apply the new position with
+    `move_bkg(stream.scroll_x, stream.scroll_y)`, preferably
+    right after the next VBlank when the new tiles have been written.
+
+    Scrolling by up to 8 pixels per axis draws at most one column
+    and one row.
+ */
+void map_stream_move(map_stream_t * stream, int8_t dx, int8_t dy);
+
+#endif
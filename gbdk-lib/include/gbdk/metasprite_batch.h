@@ -0,0 +1,82 @@
+/** @file gbdk/metasprite_batch.h
+
+    Frame level metasprite batching
+
+    Instead of drawing each metasprite with its own hardware
+    sprite range, all metasprites for a frame are submitted
+    to the batch and then written to shadow OAM together:
+    \code{.c}
+    metasprite_batch_begin(0);
+    metasprite_batch_add(player_frame, PLAYER_TILE, 0, player_x, player_y, 255, METASPRITE_BATCH_FLIP_NONE);
+    for (i = 0; i < enemy_count; i++) {
+        metasprite_batch_add(enemy_frame[i], ENEMY_TILE, 0, enemy_x[i], enemy_y[i], 10, enemy_flip[i]);
+    }
+    metasprite_batch_end(METASPRITE_BATCH_ROTATE);
+    \endcode
+
+    Metasprites are drawn in order of priority (highest first).
+    A metasprite which doesn't fit in the remaining hardware sprites
+    is skipped entirely instead of being drawn partially, and all
+    hardware sprites left unused are hidden.
+
+    With @ref METASPRITE_BATCH_ROTATE the metasprites within each
+    priority level are drawn in a different order each frame, so when
+    there are more sprites than fit, different ones are dropped each
+    frame (flicker) instead of the same ones always being missing.
+
+    Supported on GB/AP/Duck and SMS/GG.
+*/
+
+#ifndef __METASPRITE_BATCH_H_INCLUDE
+#define __METASPRITE_BATCH_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/metasprites.h>
+
+/** Maximum number of metasprites per batch */
+#define METASPRITE_BATCH_MAX       32
+
+#define METASPRITE_BATCH_FLIP_NONE METASPRITE_FLIP_NONE /**< Draw with @ref move_metasprite_ex() */
+#define METASPRITE_BATCH_FLIP_X    METASPRITE_FLIP_X    /**< Draw with @ref move_metasprite_flipx() */
+#define METASPRITE_BATCH_FLIP_Y    METASPRITE_FLIP_Y    /**< Draw with @ref move_metasprite_flipy() */
+#define METASPRITE_BATCH_FLIP_XY   METASPRITE_FLIP_XY   /**< Draw with @ref move_metasprite_flipxy() */
+
+/** Flag for @ref metasprite_batch_end(): rotate the drawing order within each priority level every frame */
+#define METASPRITE_BATCH_ROTATE    0x01
+
+/** Starts a new batch of metasprites
+
+    @param first_sprite  First hardware sprite used by the batch,
+                         sprites below it can be managed separately
+ */
+void metasprite_batch_begin(uint8_t first_sprite);
+
+/** Adds a metasprite to the current batch
+
+    @param metasprite   Pointer to the first struct of the metasprite (for the desired frame)
+    @param base_tile    Number of the first tile where the metasprite's tiles start
+    @param base_prop    Base sprite property flags (can be used to set palette, etc)
+    @param x            Absolute x coordinate of the sprite
+    @param y            Absolute y coordinate of the sprite
+    @param priority     Drawing priority, higher priorities are drawn first
+    @param flip         One of @ref METASPRITE_BATCH_FLIP_NONE, @ref METASPRITE_BATCH_FLIP_X, @ref METASPRITE_BATCH_FLIP_Y, @ref METASPRITE_BATCH_FLIP_XY
+
+    The metasprite data must stay valid (and its bank mapped)
+    until @ref metasprite_batch_end() is called.
+
+    @return `1` if the metasprite was added, `0` if the batch is full
+ */
+uint8_t metasprite_batch_add(const metasprite_t * metasprite, uint8_t base_tile, uint8_t base_prop, uint8_t x, uint8_t y, uint8_t priority, uint8_t flip);
+
+/** Writes all metasprites in the current batch to shadow OAM
+
+    @param flags  0 or @ref METASPRITE_BATCH_ROTATE
+
+    Hides all hardware sprites after the last one used.
+
+    @return Number of hardware sprites used by the batch
+ */
+uint8_t metasprite_batch_end(uint8_t flags);
+
+#endif
@@ -0,0 +1,93 @@
+/** @file gbdk/metasprite_clip.h
+
+    Metasprites at world coordinates, culled against a camera
+
+    @ref move_metasprite_ex() takes 8 bit screen coordinates, so a
+    metasprite partly or fully off screen wraps around to the opposite
+    edge unless the game checks its position first. @ref move_metasprite_clip()
+    takes 16 bit world coordinates and the camera set with
+    @ref metasprite_clip_camera() instead:
+    \code{.c}
+    metasprite_clip_camera(camera_x, camera_y);
+    next = 0;
+    for (i = 0; i < enemy_count; i++) {
+        next += move_metasprite_clip(enemy_metasprites[enemy_frame[i]], &enemy_metasprite_bounds[enemy_frame[i]],
+                                     ENEMY_TILE, 0, next, enemy_x[i], enemy_y[i]);
+    }
+    hide_sprites_range(next, MAX_HARDWARE_SPRITES);
+    \endcode
+
+    The bounds of each frame are exported by png2asset with
+    `-metasprite_bounds` (`<name>_metasprite_bounds[]`). With them a
+    metasprite which is fully off screen costs a few compares and uses
+    no hardware sprites, and one which is fully on screen is drawn by
+    @ref move_metasprite_ex() as usual. Only metasprites crossing an
+    edge of the screen have their sprites checked one by one: the ones
+    off screen, or which would need a wrapped coordinate to show, are
+    left out and the rest use consecutive hardware sprites.
+
+    There is no flipped version, the frames pre-flipped by png2asset
+    `-metasprite_flips` are drawn the same way. Their box is the mirrored
+    box of the unflipped frame: flipped on X the left edge is
+    -(left + width), flipped on Y the top edge is -(top + height).
+
+    Supported on GB/AP/Duck, SMS/GG and NES.
+*/
+
+#ifndef __METASPRITE_CLIP_H_INCLUDE
+#define __METASPRITE_CLIP_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <gbdk/metasprites.h>
+
+/** Number of visible sprites @ref move_metasprite_clip() collects before
+    drawing them, larger metasprites are drawn in several parts
+*/
+#define METASPRITE_CLIP_BUFFER 16
+
+/** Box around the hardware sprites of a metasprite frame, in pixels
+    relative to its pivot, see png2asset `-metasprite_bounds`
+*/
+typedef struct metasprite_bounds_t {
+    int8_t left;        /**< Left edge of the leftmost sprite */
+    int8_t top;         /**< Top edge of the topmost sprite */
+    uint8_t width;      /**< Width of the box, 0 for a frame without sprites */
+    uint8_t height;     /**< Height of the box, including the height of 8x16 sprites */
+} metasprite_bounds_t;
+
+/** World X coordinate of the left edge of the screen, see @ref metasprite_clip_camera() */
+extern int16_t metasprite_clip_camera_x;
+/** World Y coordinate of the top edge of the screen, see @ref metasprite_clip_camera() */
+extern int16_t metasprite_clip_camera_y;
+
+/** Sets the camera for @ref move_metasprite_clip()
+
+    @param x  World X coordinate shown at the left edge of the screen
+    @param y  World Y coordinate shown at the top edge of the screen
+*/
+void metasprite_clip_camera(int16_t x, int16_t y);
+
+/** Moves a metasprite to a position in the world, leaving out what is off screen
+
+    @param metasprite   Pointer to the first struct of the metasprite (for the desired frame)
+    @param bounds       Bounds of the frame (png2asset `-metasprite_bounds`),
+                        NULL to check every sprite
+    @param base_tile    Number of the first tile where the metasprite's tiles start
+    @param base_prop    Base sprite property flags (can be used to set palette, etc)
+    @param base_sprite  Number of the first hardware sprite to be used by the metasprite
+    @param x            World x coordinate of the metasprite pivot
+    @param y            World y coordinate of the metasprite pivot
+
+    The screen position is __x__ and __y__ minus the camera set with
+    @ref metasprite_clip_camera(). The hardware sprites which are left
+    out are not hidden, the caller hides the unused ones as with
+    @ref move_metasprite_ex().
+
+    @return Number of hardware sprites used, 0 if the metasprite is off screen
+ */
+uint8_t move_metasprite_clip(const metasprite_t * metasprite, const metasprite_bounds_t * bounds,
+                             uint8_t base_tile, uint8_t base_prop, uint8_t base_sprite, int16_t x, int16_t y);
+
+#endif
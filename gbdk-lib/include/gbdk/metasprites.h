@@ -13,4 +13,28 @@
   #error Unrecognized port
 #endif
 
+#define METASPRITE_FLIP_NONE 0x00 /**< Unflipped, see @ref metasprite_flipped() */
+#define METASPRITE_FLIP_X    0x01 /**< Flipped on the X axis, see @ref metasprite_flipped() */
+#define METASPRITE_FLIP_Y    0x02 /**< Flipped on the Y axis, see @ref metasprite_flipped() */
+#define METASPRITE_FLIP_XY   (METASPRITE_FLIP_X | METASPRITE_FLIP_Y) /**< Flipped on both axes, see @ref metasprite_flipped() */
+
+/** Selects a pre-flipped metasprite frame exported by png2asset with `-metasprite_flips`
+
+    @param flips  The `<name>_metasprites_flips` table exported by png2asset
+    @param frame  Metasprite frame number
+    @param flip   One of @ref METASPRITE_FLIP_NONE, @ref METASPRITE_FLIP_X, @ref METASPRITE_FLIP_Y, @ref METASPRITE_FLIP_XY
+
+    Drawing the selected frame with move_metasprite_ex() gives the same result
+    as drawing the unflipped frame with move_metasprite_flipx(),
+    move_metasprite_flipy() or move_metasprite_flipxy(), without the cost
+    of flipping each sprite at runtime (and the flipped frames also work on
+    consoles without hardware sprite flipping of the flipped axis, as long as
+    their tiles are flipped too).
+
+    \code{.c}
+    move_metasprite_ex(metasprite_flipped(player_metasprites_flips, frame, METASPRITE_FLIP_X), 0, 0, 0, x, y);
+    \endcode
+ */
+#define metasprite_flipped(flips, frame, flip) ((flips)[(flip)][(frame)])
+
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+/** @file gbdk/metatiles.h
+
+    Drawing maps made of metatiles
+
+    A metatile is a block of 2x2 or 4x4 tiles. Maps exported by
+    png2asset with `-metatiles <size>` store one byte per metatile
+    (`<name>_metatile_map`), which is expanded into tiles using the
+    table of metatiles (`<name>_metatiles`, optionally with
+    `<name>_metatile_attributes`). This makes the map data 4x
+    (2x2) or 16x (4x4) smaller than a map of tiles.
+
+    \code{.c}
+    set_bkg_submap_metatiles(0, 0, 11, 10, bigmap_metatile_map, bigmap_METATILE_MAP_WIDTH,
+                             bigmap_metatiles, bigmap_metatile_attributes, bigmap_METATILE_SIZE);
+    \endcode
+
+    Each metatile in the table is stored as its tile indices
+    row by row (4 bytes for 2x2, 16 bytes for 4x4). The attribute
+    table has the same layout.
+
+    Attributes are written on the CGB and SMS/GG. They are ignored
+    on the NES, where attributes are set per 2x2 tile block instead
+    (png2asset keeps exporting `<name>_map_attributes` for those,
+    use @ref set_bkg_submap_attributes()).
+*/
+
+#ifndef __METATILES_H_INCLUDE
+#define __METATILES_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+#define METATILE_2X2 2 /**< Metatiles of 2x2 tiles, see @ref set_bkg_metatiles() */
+#define METATILE_4X4 4 /**< Metatiles of 4x4 tiles, see @ref set_bkg_metatiles() */
+
+/** Sets a rectangular area of the Background Tile Map using metatiles
+
+    @param x          X Start position in Background Map metatile coordinates
+    @param y          Y Start position in Background Map metatile coordinates
+    @param w          Width of area to set in metatiles
+    @param h          Height of area to set in metatiles
+    @param map        Pointer to source metatile map data, one byte per metatile
+    @param metatiles  Pointer to the tile indices of the metatiles
+    @param attributes Pointer to the tile attributes of the metatiles, or NULL
+    @param size       Metatile size: @ref METATILE_2X2 or @ref METATILE_4X4
+
+    Entries are copied from __map__ to the Background Tile Map starting at
+    tile __x__ * __size__, __y__ * __size__, writing across for __w__ metatiles
+    and down for __h__ metatiles. Writes wrap around the edges of the
+    hardware tile map, the same way as @ref set_bkg_tiles().
+
+    @see set_bkg_submap_metatiles, set_bkg_tiles
+*/
+void set_bkg_metatiles(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * map, const uint8_t * metatiles, const uint8_t * attributes, uint8_t size);
+
+/** Sets a rectangular area of the Background Tile Map using a sub-region
+    from a source metatile map
+
+    @param x          X Start position in both the source map and Background Map, in metatiles
+    @param y          Y Start position in both the source map and Background Map, in metatiles
+    @param w          Width of area to set in metatiles
+    @param h          Height of area to set in metatiles
+    @param map        Pointer to source metatile map data, one byte per metatile
+    @param map_w      Width of source map in metatiles
+    @param metatiles  Pointer to the tile indices of the metatiles
+    @param attributes Pointer to the tile attributes of the metatiles, or NULL
+    @param size       Metatile size: @ref METATILE_2X2 or @ref METATILE_4X4
+
+    Same as @ref set_bkg_metatiles(), except the metatiles are taken from
+    __x__, __y__ of a map which is __map_w__ metatiles wide, as with
+    @ref set_bkg_submap().
+
+    @see set_bkg_metatiles, set_bkg_submap
+*/
+void set_bkg_submap_metatiles(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * map, uint8_t map_w, const uint8_t * metatiles, const uint8_t * attributes, uint8_t size);
+
+#endif
@@ -0,0 +1,163 @@
+/** @file gbdk/music.h
+
+    Tracker style music and sound effect driver
+
+    Songs are written as MML (music macro language) text and
+    converted with @ref utility_mml2asset "mml2asset":
+    \code{.sh}
+    mml2asset theme.mml -c res/theme.c
+    \endcode
+    An effect is a converted file which uses a single channel, its
+    stream is `name_ch0` to `name_ch3` for channels A to D.
+
+    The driver is advanced once per frame by @ref music_update().
+    On the Game Boy and SMS/GG it can run from the VBlank interrupt:
+    \code{.c}
+    #include "res/theme.h"
+
+    // Game Boy only: turn on sound first
+    NR52_REG = AUDENA_ON;
+    NR51_REG = 0xFF;
+    NR50_REG = AUDVOL_VOL_LEFT(7) | AUDVOL_VOL_RIGHT(7);
+
+    CRITICAL {
+        add_VBL(music_update);
+    }
+    music_play(&theme, BANK(theme));
+    \endcode
+    On the NES, call @ref music_update() after each vsync().
+
+    There are 4 channels, which the converter writes as one byte
+    stream each:
+    | Channel          | Game Boy     | SMS/GG PSG   | NES          |
+    | ---------------- | ------------ | ------------ | ------------ |
+    | @ref MUSIC_CH_PULSE1 | 1, square with sweep | tone 0 | pulse 1 |
+    | @ref MUSIC_CH_PULSE2 | 2, square    | tone 1       | pulse 2      |
+    | @ref MUSIC_CH_WAVE   | 3, wave (triangle) | tone 2 | triangle     |
+    | @ref MUSIC_CH_NOISE  | 4, noise     | noise        | noise        |
+
+    The stream format is the same on all platforms, so one
+    converted song plays on each of them. The duty of a square wave
+    is only used on the Game Boy and NES, and the triangle of the
+    NES has no volume, it is only on or off.
+
+    __Cost per frame__
+
+    Each channel reads at most @ref MUSIC_MAX_COMMANDS commands per
+    frame, which bounds the time spent in @ref music_update(). The
+    registers are written only when their value changes: during a
+    held note nothing is written at all. When a note starts, a
+    channel writes at most 4 registers on the Game Boy and the NES
+    and 3 port bytes on the SMS/GG, so a frame where all channels
+    start notes writes at most 16 registers.
+
+    __Sound effects__
+
+    @ref music_sfx_play() plays a single channel stream on top of
+    the music:
+    \code{.c}
+    #include "res/jump.h"
+    ...
+    music_sfx_play(jump_ch0, BANK(jump), MUSIC_CH_PULSE1);
+    \endcode
+    The music keeps running silently on that channel
+    and is heard again once the effect ends.
+
+    __Banks__
+
+    A song or effect can be in any ROM bank, the driver switches to
+    it while reading it and back to the bank that was selected
+    before. As with any banked data read from an interrupt handler,
+    the bank must not be switched without updating CURRENT_BANK.
+
+    On the Game Boy, @ref pcm_stream_play() and the driver both use
+    channel 3: don't play a sample while the song uses it.
+*/
+
+#ifndef __MUSIC_H_INCLUDE
+#define __MUSIC_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Number of channels */
+#define MUSIC_CHANNELS 4
+
+#define MUSIC_CH_PULSE1 0   /**< First square wave channel */
+#define MUSIC_CH_PULSE2 1   /**< Second square wave channel */
+#define MUSIC_CH_WAVE   2   /**< Wave channel: triangle on GB and NES, third tone on SMS/GG */
+#define MUSIC_CH_NOISE  3   /**< Noise channel */
+
+/** Most commands a channel reads in one frame
+
+    A stream which has more commands in a row without a note or rest
+    carries on with them in the next frame.
+ */
+#define MUSIC_MAX_COMMANDS 8
+
+/** @name Stream commands
+    A channel stream is a list of commands, most with one or two
+    parameter bytes.
+    @{
+ */
+/** Notes 0 to 71 (C3 to B8), followed by the length in frames (1 - 255)
+
+    On the noise channel the note is the noise setting instead: bits
+    0 - 2 are the pitch (0 highest) and bit 3 selects the short,
+    tonal noise.
+ */
+#define MUSIC_NOTE_COUNT  72
+/** Silence, followed by the length in frames (1 - 255) */
+#define MUSIC_CMD_REST    0x80
+/** Sets the volume, followed by the volume (0 - 15) */
+#define MUSIC_CMD_VOLUME  0x81
+/** Sets the duty of a square wave, followed by the duty (0: 12.5%, 1: 25%, 2: 50%, 3: 75%) */
+#define MUSIC_CMD_DUTY    0x82
+/** Continues at an offset from the start of the stream, followed by the offset (16 bit, low byte first) */
+#define MUSIC_CMD_LOOP    0x83
+/** Keeps the current note or rest going, followed by the length in frames (1 - 255) */
+#define MUSIC_CMD_WAIT    0x84
+/** Ends the stream, the channel goes silent */
+#define MUSIC_CMD_END     0xFF
+/** @} */
+
+/** A song: one stream per channel
+ */
+typedef struct music_song_t {
+    const uint8_t * channels[MUSIC_CHANNELS];   /**< Stream of each channel, or NULL if it is not used */
+} music_song_t;
+
+/** Starts playing a song from the beginning, replacing the one playing
+
+    @param song  Song, as converted by mml2asset
+    @param bank  ROM bank of the song and its streams, 0 if they are not banked
+ */
+void music_play(const music_song_t * song, uint8_t bank);
+
+/** Stops the song, the channels which don't play a sound effect go silent
+ */
+void music_stop(void);
+
+/** Plays a sound effect on one channel, replacing the one playing on it
+
+    @param stream   Channel stream of the effect
+    @param bank     ROM bank of the stream, 0 if it is not banked
+    @param channel  Channel to play it on, @ref MUSIC_CH_PULSE1 to @ref MUSIC_CH_NOISE
+ */
+void music_sfx_play(const uint8_t * stream, uint8_t bank, uint8_t channel);
+
+/** Returns non zero while a song plays
+
+    A song plays until all of its streams have ended, one which
+    loops plays until @ref music_stop().
+ */
+uint8_t music_playing(void);
+
+/** Advances the music and sound effects by one frame
+
+    Call it once per frame, for example with add_VBL() on the Game Boy
+    and SMS/GG, or after vsync() on the NES.
+ */
+void music_update(void);
+
+#endif
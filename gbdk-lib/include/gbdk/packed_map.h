@@ -0,0 +1,115 @@
+/** @file gbdk/packed_map.h
+
+    Loading of maps packaged by png2asset
+
+    @ref utility_png2asset "png2asset" `-map -bin_packed` writes the
+    tiles, map, CGB attributes and CGB palettes of an image into one
+    `<name>_packed.bin` file. A header at the start has the size of the
+    map, the number of tiles and palettes, the ROM bank given with `-b`
+    and the offset, size and compression (none, gbcompress or RLE, see
+    `-bin_compress`) of each section. @ref load_packaged_map() loads
+    all of them with one call:
+    \code{.c}
+    // png2asset level.png -map -use_map_attributes -bin_packed -bin_compress rle -c res/level.c
+    INCBIN(level_packed, "res/level_packed.bin")
+    INCBIN_EXTERN(level_packed)
+
+    load_packaged_map(level_packed, NULL);
+    SHOW_BKG;
+    \endcode
+
+    Without a map buffer the map is drawn at the top left of the
+    background, so it has to fit into the hardware tile map, and must
+    not be stored column by column (png2asset `-transposed`) or with
+    gbcompress. Larger maps are decompressed into a buffer in RAM
+    instead, for example for @ref map_stream_init():
+    \code{.c}
+    uint8_t level_map[LEVEL_W * LEVEL_H * 2]; // Map, followed by the attributes
+
+    load_packaged_map(level_packed, level_map);
+    map_stream_init(&stream, level_map, level_map + (LEVEL_W * LEVEL_H), 0, LEVEL_W, LEVEL_H);
+    \endcode
+
+    Sections are uploaded with the display on, tiles at the tile
+    origin of the map (png2asset `-tile_origin`). Data in another ROM
+    bank must be switched in by the caller.
+
+    Supported on GB/AP/Duck and SMS/GG. On the SMS/GG tiles can't be
+    compressed with gbcompress, since VRAM is not memory mapped, and
+    png2asset writes no palettes (their format depends on the console).
+*/
+
+#ifndef __PACKED_MAP_H_INCLUDE
+#define __PACKED_MAP_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+#define PACKED_MAP_MAGIC_0 'P'
+#define PACKED_MAP_MAGIC_1 'M'
+#define PACKED_MAP_VERSION 1
+
+/** Flags of @ref packed_map_header_t */
+#define PACKED_MAP_TRANSPOSED   0x01 /**< Map and attributes are stored column by column */
+#define PACKED_MAP_INTERLEAVED  0x02 /**< Each map entry is a tile and its attributes (SMS/GG) */
+
+/** Section types of @ref packed_map_section_t */
+#define PACKED_MAP_SECTION_TILES       1 /**< Tiles in VRAM bank 0 */
+#define PACKED_MAP_SECTION_TILES_BANK1 2 /**< Tiles in CGB VRAM bank 1 */
+#define PACKED_MAP_SECTION_MAP         3 /**< Tile indices */
+#define PACKED_MAP_SECTION_ATTRIBUTES  4 /**< CGB tile attributes */
+#define PACKED_MAP_SECTION_PALETTES    5 /**< CGB palettes, 4 colors each */
+
+/** Compression of @ref packed_map_section_t */
+#define PACKED_MAP_NONE 0 /**< Not compressed */
+#define PACKED_MAP_GB   1 /**< gbcompress, see @ref gb_decompress() */
+#define PACKED_MAP_RLE  2 /**< gbcompress `--alg=rle`, see @ref rle_decompress() */
+
+/** Return values of @ref load_packaged_map() */
+#define PACKED_MAP_OK         0 /**< All sections were loaded */
+#define PACKED_MAP_ERR_FORMAT 1 /**< Not a packed map, or a section this platform can't load */
+#define PACKED_MAP_ERR_BUF    2 /**< The map has to be loaded into a map buffer */
+
+/** A section of a packed map, the header is followed by packed_map_header_t.section_count of them */
+typedef struct packed_map_section_t {
+    uint8_t type;         /**< One of the PACKED_MAP_SECTION_ values */
+    uint8_t compression;  /**< PACKED_MAP_NONE, PACKED_MAP_GB or PACKED_MAP_RLE */
+    uint16_t offset;      /**< Offset of the data from the start of the header */
+    uint16_t size;        /**< Size of the data once decompressed */
+} packed_map_section_t;
+
+/** Header at the start of a packed map (all values are little endian) */
+typedef struct packed_map_header_t {
+    uint8_t magic[2];       /**< PACKED_MAP_MAGIC_0, PACKED_MAP_MAGIC_1 */
+    uint8_t version;        /**< PACKED_MAP_VERSION */
+    uint8_t flags;          /**< PACKED_MAP_TRANSPOSED, PACKED_MAP_INTERLEAVED */
+    uint16_t map_w;         /**< Width of the map in tiles */
+    uint16_t map_h;         /**< Height of the map in tiles */
+    uint16_t tile_count;    /**< Number of tiles in both VRAM banks */
+    uint8_t first_tile;     /**< Index of the first tile in VRAM */
+    uint8_t palette_count;  /**< Number of palettes */
+    uint8_t bank;           /**< ROM bank given to png2asset with `-b`, 0 if none */
+    uint8_t section_count;  /**< Number of sections after the header */
+    uint16_t reserved;      /**< Always 0 */
+} packed_map_header_t;
+
+/** Loads the sections of a packed map into VRAM, and the map into RAM if requested
+
+    @param data     Pointer to a packed map written by png2asset `-bin_packed`
+    @param map_buf  Buffer for the map and the attributes after it, or NULL
+                    to draw the map on the background at 0, 0
+
+    With a map buffer, the map section (map_w * map_h bytes, or twice that
+    if PACKED_MAP_INTERLEAVED) is decompressed into __map_buf__ followed by
+    the attribute section (map_w * map_h bytes), and nothing is drawn.
+
+    The tiles of VRAM bank 1 and palettes are only loaded on the CGB.
+    Without a map buffer, attributes are only drawn on the CGB.
+
+    All sections are checked before anything is loaded.
+
+    @return PACKED_MAP_OK, PACKED_MAP_ERR_FORMAT or PACKED_MAP_ERR_BUF
+ */
+uint8_t load_packaged_map(const uint8_t * data, uint8_t * map_buf);
+
+#endif
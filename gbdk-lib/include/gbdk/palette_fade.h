@@ -0,0 +1,115 @@
+/** @file gbdk/palette_fade.h
+
+    Palette fades and animations uploaded from VBlank
+
+    @ref palette_fade_start() precomputes every step of a fade into a
+    table in RAM, along with the range of colors each step changes.
+    @ref palette_fade_vbl() then uploads only that range once every
+    few frames, so a fade costs the main loop nothing after it is
+    started:
+    \code{.c}
+    palette_color_t fade_table[16 * 8];
+    ...
+    CRITICAL {
+        add_VBL(palette_fade_vbl);
+    }
+    palette_fade_start(fade_table, level_palette, black_palette, 0, 16, 8, 4);
+    palette_fade_wait();
+    \endcode
+
+    @ref palette_fade_play() plays a table of palettes made in
+    advance, for example color cycling with @ref PALETTE_FADE_LOOP.
+
+    Colors are numbered across the whole palette memory, with the
+    sprite colors after the background colors (see
+    @ref PALETTE_FADE_COLORS_MAX).
+
+    On NES there is no add_VBL(): call @ref palette_fade_vbl() once
+    per frame after vsync(), it writes the palette shadow which the
+    NMI handler uploads.
+
+    Supported on GB/AP (CGB), SMS/GG and NES.
+*/
+
+#ifndef __PALETTE_FADE_H_INCLUDE
+#define __PALETTE_FADE_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/platform.h>
+
+#if defined(__TARGET_gb) || defined(__TARGET_ap)
+/** Number of colors, background colors 0 - 31 followed by sprite colors 32 - 63 */
+#define PALETTE_FADE_COLORS_MAX 64
+#else
+/** Number of colors, background colors 0 - 15 followed by sprite colors 16 - 31 */
+#define PALETTE_FADE_COLORS_MAX 32
+#endif
+
+/** Maximum number of steps of a fade */
+#define PALETTE_FADE_STEPS_MAX  32
+
+/** Flag for @ref palette_fade_play(): start again with the first step after the last one */
+#define PALETTE_FADE_LOOP       0x01
+
+/** Starts a fade between two palettes
+
+    @param table   Buffer for the steps, __count__ * __steps__ colors in RAM
+    @param from    __count__ colors shown now
+    @param to      __count__ colors shown at the end of the fade
+    @param first   First color to fade, see @ref PALETTE_FADE_COLORS_MAX
+    @param count   Number of colors to fade
+    @param steps   Number of steps, 1 to @ref PALETTE_FADE_STEPS_MAX.
+                   The last step shows __to__.
+    @param frames  Number of frames each step is shown
+
+    The red, green and blue components are interpolated separately.
+    On NES the brightness is interpolated, and the hue changes halfway
+    (or right away when fading from black).
+
+    Stops any fade or animation still running.
+*/
+void palette_fade_start(palette_color_t * table, const palette_color_t * from, const palette_color_t * to,
+                        uint8_t first, uint8_t count, uint8_t steps, uint8_t frames);
+
+/** Starts playing a table of palettes
+
+    @param table   __steps__ rows of __count__ colors
+    @param first   First color to write, see @ref PALETTE_FADE_COLORS_MAX
+    @param count   Number of colors in each row
+    @param steps   Number of rows, 1 to @ref PALETTE_FADE_STEPS_MAX
+    @param frames  Number of frames each row is shown
+    @param flags   0 or @ref PALETTE_FADE_LOOP
+
+    The first row is written whole, the following ones only in the
+    range that differs from the row before.
+
+    Stops any fade or animation still running.
+*/
+void palette_fade_play(const palette_color_t * table, uint8_t first, uint8_t count,
+                       uint8_t steps, uint8_t frames, uint8_t flags);
+
+/** Stops the fade or animation, the colors shown stay as they are
+*/
+void palette_fade_stop(void);
+
+/** Returns TRUE while a fade or animation is running
+*/
+uint8_t palette_fade_busy(void);
+
+/** Waits until the fade has finished, must not be called while
+    an animation with @ref PALETTE_FADE_LOOP is running
+
+    On NES it calls @ref palette_fade_vbl() after each vsync() itself.
+*/
+void palette_fade_wait(void);
+
+/** VBlank handler which uploads the steps
+
+    Install it with add_VBL() (on NES, call it after each vsync()).
+    On SMS/GG it waits for the next frame while the interrupted code
+    is writing to the VDP (see `_shadow_OAM_OFF`).
+*/
+void palette_fade_vbl(void);
+
+#endif
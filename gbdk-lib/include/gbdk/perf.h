@@ -0,0 +1,157 @@
+/** @file gbdk/perf.h
+
+    Frame time counters for finding dropped frames
+
+    When `GBDK_PERF` is defined before including this header (for example
+    with `-DGBDK_PERF` on the lcc command line) @ref vsync() and
+    @ref wait_vbl_done() are replaced by @ref perf_vsync(), which updates
+    @ref perf before and after waiting:
+    \li how many frames the main loop has run, and how many VBlanks it missed
+    \li the scanline @ref vsync() was entered on, which shows how much of the
+        frame was still free
+    \li the scanline it returned on, which shows how long the VBlank
+        interrupt handlers took
+
+    Without `GBDK_PERF` nothing changes and the counters are not linked in.
+    \code{.c}
+    #include <gbdk/platform.h>
+    #include <gbdk/emu_debug.h>
+    #include <gbdk/perf.h>
+
+    while (TRUE) {
+        update();
+        vsync();
+        if ((sys_time & 0xFF) == 0) PERF_EMU_PRINTF();
+    }
+    \endcode
+
+    On the Game Boy the time spent in other interrupt handlers can be
+    counted with @ref PERF_ISR_BEGIN() and @ref PERF_ISR_END().
+
+    @ref PERF_CPU_FAST_AVAILABLE() tells whether a CPU heavy scene can
+    switch to CGB double speed with @ref cpu_fast(). The library keeps
+    its timing in double speed: @ref delay() still waits milliseconds,
+    a running timer interrupt (TMA_REG, TAC_REG) keeps its rate across
+    @ref cpu_fast() and @ref cpu_slow(), @ref sys_time and the sound
+    hardware are not affected. Only the serial clock of a link cable
+    master runs twice as fast.
+    \code{.c}
+    if (PERF_CPU_FAST_AVAILABLE()) cpu_fast();
+    ...
+    if (PERF_CPU_SPEED() == 1) skip_effects();
+    \endcode
+
+    Supported on the Game Boy, Analogue Pocket, Mega Duck, SMS and Game Gear.
+*/
+
+#ifndef __PERF_H_INCLUDE
+#define __PERF_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/platform.h>
+
+#if defined(NINTENDO)
+/** Scanline on which the VBlank interrupt occurs */
+#define PERF_VBLANK_LINE 144u
+#define PERF_LINE() (LY_REG)
+#elif defined(SEGA)
+#define PERF_VBLANK_LINE 192u
+#define PERF_LINE() (VCOUNTER)
+#else
+  #error Unrecognized port
+#endif
+
+#if defined(NINTENDO)
+/** Nonzero when @ref cpu_fast() can double the CPU speed (CGB) */
+#define PERF_CPU_FAST_AVAILABLE() (_cpu == CGB_TYPE)
+/** CPU speed compared to the normal speed of the system: 2 in CGB double speed mode, otherwise 1 */
+#define PERF_CPU_SPEED() (((_cpu == CGB_TYPE) && (KEY1_REG & KEY1F_DBLSPEED)) ? 2u : 1u)
+#else
+#define PERF_CPU_FAST_AVAILABLE() (0)
+#define PERF_CPU_SPEED() (1u)
+#endif
+
+/** Number of counters for @ref PERF_ISR_BEGIN() */
+#define PERF_ISR_SLOTS 4
+
+/** Counters updated by @ref perf_vsync()
+ */
+typedef struct perf_counters_t {
+    uint16_t frames;            /**< Calls to perf_vsync() */
+    uint16_t dropped;           /**< VBlanks which passed before perf_vsync() was called */
+    uint8_t vsync_line;         /**< Scanline of the last perf_vsync() call */
+    uint8_t vsync_line_max;     /**< Highest scanline of a perf_vsync() call which did not drop a frame */
+    uint8_t vbl_lines;          /**< Scanlines from the start of the last VBlank to the return of perf_vsync() */
+    uint8_t vbl_lines_max;      /**< Highest value of vbl_lines */
+#if defined(NINTENDO)
+    uint16_t isr_ticks[PERF_ISR_SLOTS]; /**< Time in each PERF_ISR_BEGIN() slot, in 256 cycle DIV_REG ticks */
+#endif
+} perf_counters_t;
+
+/** Performance counters, see @ref perf_reset() */
+extern perf_counters_t perf;
+
+/** Clears the counters in @ref perf and starts counting dropped frames from now
+ */
+void perf_reset(void);
+
+/** Updates @ref perf and waits for the next VBlank like @ref vsync()
+
+    A frame counts as dropped for each VBlank which occurred since the
+    previous call returned.
+ */
+void perf_vsync(void);
+
+/** Prints the counters from @ref perf in one machine readable line
+    with @ref EMU_printf(), gbdk/emu_debug.h must be included:
+
+    `PERF,<frames>,<dropped>,<vsync_line>,<vsync_line_max>,<vbl_lines>,<vbl_lines_max>`
+ */
+#define PERF_EMU_PRINTF() EMU_printf("PERF,%u,%u,%hu,%hu,%hu,%hu", perf.frames, perf.dropped, \
+    (uint8_t)perf.vsync_line, (uint8_t)perf.vsync_line_max, (uint8_t)perf.vbl_lines, (uint8_t)perf.vbl_lines_max)
+
+#if defined(NINTENDO)
+/** Starts timing an interrupt handler, at the beginning of the handler
+
+    @param SLOT  Counter to add the time to, 0 to @ref PERF_ISR_SLOTS - 1
+    \code{.c}
+    void lcd_isr(void) {
+        PERF_ISR_BEGIN(0);
+        ...
+        PERF_ISR_END(0);
+    }
+    \endcode
+
+    DIV_REG only counts every 256 cycles, but since handlers start at
+    random points of its count the total over many calls is accurate.
+    Does nothing unless `GBDK_PERF` is defined. With `GBDK_CRASH_BREADCRUMBS`
+    defined it also records 0xF0 + SLOT as a breadcrumb for the crash
+    handler (see gb/crash_handler.h).
+ */
+#if defined(GBDK_CRASH_BREADCRUMBS)
+#include <gb/crash_handler.h>
+#define PERF_ISR_CRUMB(SLOT) CRASH_ZONE(0xF0u | (SLOT))
+#else
+#define PERF_ISR_CRUMB(SLOT)
+#endif
+#if defined(GBDK_PERF)
+#define PERF_ISR_BEGIN(SLOT) uint8_t __perf_isr_start = DIV_REG; PERF_ISR_CRUMB(SLOT)
+#else
+#define PERF_ISR_BEGIN(SLOT) PERF_ISR_CRUMB(SLOT)
+#endif
+
+/** Adds the time since @ref PERF_ISR_BEGIN() to perf.isr_ticks[SLOT] */
+#if defined(GBDK_PERF)
+#define PERF_ISR_END(SLOT) (perf.isr_ticks[SLOT] += (uint8_t)(DIV_REG - __perf_isr_start))
+#else
+#define PERF_ISR_END(SLOT)
+#endif
+#endif
+
+#if defined(GBDK_PERF)
+#define vsync perf_vsync
+#define wait_vbl_done perf_vsync
+#endif
+
+#endif
@@ -0,0 +1,161 @@
+/** @file gbdk/pool.h
+
+    Fixed size block (pool) and arena allocators
+
+    These are faster alternatives to malloc() and free() for
+    objects which are created and destroyed often, such as the
+    entities of a game.
+
+    A pool hands out blocks of a single size. Free blocks are kept
+    in a list stored inside the blocks themselves, so both
+    @ref pool_alloc() and @ref pool_free() take a fixed, small amount
+    of time and the pool can't fragment.
+    \code{.c}
+    typedef struct { uint8_t x, y, type; } entity_t;
+
+    uint8_t entity_buf[POOL_BUFFER_SIZE(sizeof(entity_t), 16)];
+    pool_t entities;
+
+    pool_init(&entities, entity_buf, sizeof(entity_t), 16);
+    entity_t * e = pool_alloc(&entities);
+    ...
+    pool_free(&entities, e);
+    \endcode
+
+    An arena hands out memory of any size by moving a pointer
+    forward, and it is all released at once with @ref arena_reset(),
+    for example at the start of every frame.
+    \code{.c}
+    uint8_t frame_buf[256];
+    arena_t frame;
+
+    arena_init(&frame, frame_buf, sizeof(frame_buf));
+    while (1) {
+        arena_reset(&frame);
+        uint8_t * list = arena_alloc(&frame, count);
+        ...
+    }
+    \endcode
+
+    The buffers can be anywhere in RAM, including a switchable CGB
+    WRAM bank (0xD000 - 0xDFFF), as long as that bank is selected
+    whenever the pool or arena is used. The @ref pool_t and
+    @ref arena_t themselves should be in memory that is always
+    mapped.
+*/
+
+#ifndef __POOL_H_INCLUDE
+#define __POOL_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Size of the buffer needed by @ref pool_init() for __count__ blocks of __block_size__ bytes
+
+    Blocks are at least 2 bytes, so they can hold a pointer while free.
+ */
+#define POOL_BUFFER_SIZE(block_size, count) ((((block_size) < 2) ? 2 : (block_size)) * (count))
+
+/** State of a pool of fixed size blocks
+ */
+typedef struct pool_t {
+    void * free;            /**< First free block, NULL if there are none */
+    uint16_t block_size;    /**< Size of each block in bytes */
+    uint16_t used;          /**< Number of allocated blocks */
+} pool_t;
+
+/** Initializes a pool
+
+    @param pool        Pool to initialize
+    @param buf         Buffer for the blocks, at least @ref POOL_BUFFER_SIZE(block_size, count) bytes
+    @param block_size  Size of each block in bytes
+    @param count       Number of blocks
+
+    All blocks start out free.
+ */
+void pool_init(pool_t * pool, void * buf, uint16_t block_size, uint16_t count);
+
+/** Allocates a block from a pool
+
+    @param pool  Pool to allocate from
+
+    @return Pointer to the block, or NULL if all blocks are in use.
+    The contents of the block are not cleared.
+ */
+void * pool_alloc(pool_t * pool);
+
+/** Returns a block to its pool
+
+    @param pool   Pool the block was allocated from
+    @param block  Block returned by @ref pool_alloc(), or NULL (which is ignored)
+ */
+void pool_free(pool_t * pool, void * block);
+
+/** Returns the number of blocks allocated from a pool
+
+    @param pool  Pool
+ */
+inline uint16_t pool_used(const pool_t * pool) {
+    return pool->used;
+}
+
+/** State of an arena allocator
+ */
+typedef struct arena_t {
+    uint8_t * start;        /**< Start of the buffer */
+    uint8_t * ptr;          /**< Next free byte */
+    uint8_t * end;          /**< End of the buffer */
+} arena_t;
+
+/** Initializes an arena
+
+    @param arena  Arena to initialize
+    @param buf    Buffer to allocate from
+    @param size   Size of the buffer in bytes
+ */
+void arena_init(arena_t * arena, void * buf, uint16_t size);
+
+/** Allocates memory from an arena
+
+    @param arena  Arena to allocate from
+    @param size   Number of bytes to allocate
+
+    @return Pointer to the memory, or NULL if there is not enough left.
+    The memory is not cleared.
+ */
+void * arena_alloc(arena_t * arena, uint16_t size);
+
+/** Releases everything allocated from an arena
+
+    @param arena  Arena to reset
+ */
+inline void arena_reset(arena_t * arena) {
+    arena->ptr = arena->start;
+}
+
+/** Returns the current position of an arena, for @ref arena_release()
+
+    @param arena  Arena
+ */
+inline void * arena_mark(const arena_t * arena) {
+    return arena->ptr;
+}
+
+/** Releases everything allocated from an arena after __mark__
+
+    @param arena  Arena
+    @param mark   Position returned by @ref arena_mark()
+ */
+inline void arena_release(arena_t * arena, void * mark) {
+    arena->ptr = (uint8_t *)mark;
+}
+
+/** Returns the number of bytes left in an arena
+
+    @param arena  Arena
+ */
+inline uint16_t arena_available(const arena_t * arena) {
+    return (uint16_t)(arena->end - arena->ptr);
+}
+
+#endif
@@ -4,6 +4,17 @@
 
     Decompresses data which has been compressed with
     @ref utility_gbcompress "gbcompress" using the `--alg=rle` argument.
+
+    To start decompressing at a given map row or column instead of
+    the start, compress it with `--rle-index=<size>` (where __size__
+    is the number of bytes in a row or column). Each record then
+    starts on its own control byte and gbcompress writes the offsets
+    of them, which @ref rle_seek accepts:
+    \code{.c}
+    // gbcompress --alg=rle --rle-index=18 --cout --varname=map map.bin map.c
+    rle_seek(map, map_index[column]);
+    rle_decompress(data, 18);
+    \endcode
 */
 
 #ifndef __RLEDECOMPRESS_H_INCLUDE
@@ -38,6 +49,50 @@ uint8_t rle_init(void * data);
     @see rle_init
  */
 uint8_t rle_decompress(void * dest, uint8_t len);
+
+#if !defined(__TARGET_nes)
+/** Initialize the RLE decompressor with RLE data at address __data__ in ROM bank __bank__
+
+    @param data   Pointer to start of RLE compressed data
+    @param bank   ROM bank of the RLE compressed data
+
+    Use @ref rle_decompress_banked instead of @ref rle_decompress
+    to decompress the data.
+
+    @see rle_decompress_banked
+ */
+uint8_t rle_init_banked(void * data, uint8_t bank);
+
+/** Decompress banked RLE compressed data into __dest__ for length __len__ bytes
+
+    @param dest   Pointer to destination buffer/address
+    @param len    Number of bytes to decompress
+    @return       Returns `0` if compression is complete, `1` if there is more data to decompress
+
+    Same as @ref rle_decompress(), but switches to the bank passed to
+    @ref rle_init_banked while reading the compressed data, and
+    restores the previously active bank before returning.
+
+    Compressed data which runs past the end of its bank ($7FFF)
+    continues at the start of the next bank ($4000).
+
+    @see rle_init_banked
+ */
+uint8_t rle_decompress_banked(void * dest, uint8_t len);
+
+/** Initialize the banked RLE decompressor at __offset__ bytes into RLE data in ROM bank __bank__
+
+    @param data   Pointer to start of RLE compressed data
+    @param bank   ROM bank of the RLE compressed data
+    @param offset Offset of a record from the `--rle-index` of gbcompress
+
+    Offsets past the end of __bank__ ($7FFF) continue in the following
+    banks, the same way @ref rle_decompress_banked reads the data.
+
+    @see rle_seek, rle_init_banked
+ */
+uint8_t rle_seek_banked(void * data, uint8_t bank, uint16_t offset);
+#endif
 #elif defined(__TARGET_sms) || defined(__TARGET_gg)
 uint8_t rle_init(void * data) Z88DK_FASTCALL;
 uint8_t rle_decompress(void * dest, uint8_t len) Z88DK_CALLEE;
@@ -45,4 +100,19 @@ uint8_t rle_decompress(void * dest, uint8_t len) Z88DK_CALLEE;
   #error Unrecognized port
 #endif
 
+/** Initialize the RLE decompressor at __offset__ bytes into RLE data at address __data__
+
+    @param data   Pointer to start of RLE compressed data
+    @param offset Offset of a record from the `--rle-index` of gbcompress
+
+    The offset must be the start of a record written with the
+    `--rle-index` argument of @ref utility_gbcompress "gbcompress",
+    other data only starts on a control byte at offset 0.
+
+    @see rle_init, rle_decompress
+ */
+inline uint8_t rle_seek(void * data, uint16_t offset) {
+    return rle_init((uint8_t *)data + offset);
+}
+
 #endif
\ No newline at end of file
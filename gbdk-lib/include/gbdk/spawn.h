@@ -0,0 +1,120 @@
+/** @file gbdk/spawn.h
+
+    Spawning level objects as the camera scrolls over them
+
+    `png2asset ... -map -spawn_map <png>` reads an indexed png with a
+    pixel for each map tile: palette index 0 is empty, any other index
+    is the type of an object placed on that tile. The objects are
+    exported sorted by X then Y as `name_spawns[]`, with
+    `name_spawn_buckets[]` holding the first object of each column of
+    @ref SPAWN_BUCKET_TILES tiles and `name_spawn_list` pointing to
+    both.
+
+    A @ref spawn_window_t keeps a cursor on each side of the columns
+    around the camera. @ref spawn_window_update() only moves them
+    over the objects which came into view since the last call, so
+    each frame costs the number of new objects, not the length of the
+    whole list.
+    \code{.c}
+    #include "level.h"
+
+    spawn_window_t spawns;
+
+    void on_spawn(const spawn_t * s, uint16_t id) {
+        if (!killed(id)) actor_create(s->type, s->x << 3, s->y << 3);
+    }
+
+    spawn_window_init(&spawns, &level_spawn_list, BANK(level), DEVICE_SCREEN_PX_WIDTH + 16, on_spawn);
+    spawn_window_set(&spawns, camera_x);
+    while (1) {
+        ...
+        spawn_window_update(&spawns, camera_x);
+        vsync();
+    }
+    \endcode
+
+    Only the X position is windowed, every object in a column which
+    comes into view is spawned whatever its Y. An object is spawned
+    again when it leaves the window and comes back into it, the __id__
+    passed to the callback (its position in `name_spawns[]`) lets the
+    game remember the ones which were already defeated.
+*/
+
+#ifndef __SPAWN_H_INCLUDE
+#define __SPAWN_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Width of a bucket of `name_spawn_buckets[]` in tiles, as a shift */
+#define SPAWN_BUCKET_SHIFT 4
+/** Width of a bucket of `name_spawn_buckets[]` in tiles */
+#define SPAWN_BUCKET_TILES (1 << SPAWN_BUCKET_SHIFT)
+
+/** An object placed on the map, as exported by png2asset
+ */
+typedef struct spawn_t {
+    uint16_t x;             /**< Column of the tile */
+    uint8_t y;              /**< Row of the tile */
+    uint8_t type;           /**< Palette index in the spawn map, 1 to 255 */
+} spawn_t;
+
+/** Objects of a map, as exported by png2asset
+ */
+typedef struct spawn_list_t {
+    const spawn_t * spawns;     /**< Objects, sorted by X then Y */
+    const uint16_t * buckets;   /**< First object of each bucket, then __count__ */
+    uint16_t count;             /**< Number of objects */
+    uint16_t bucket_count;      /**< Number of buckets */
+} spawn_list_t;
+
+/** Called for each object which comes into the window
+
+    @param s   Copy of the object, only valid during the call
+    @param id  Position of the object in `name_spawns[]`
+ */
+typedef void (*spawn_fn)(const spawn_t * s, uint16_t id);
+
+/** State of a spawn window
+ */
+typedef struct spawn_window_t {
+    spawn_list_t list;          /**< Copy of the objects of the map */
+    uint8_t bank;               /**< ROM bank of the list, 0 if it is not banked */
+    uint8_t width;              /**< Width of the window in tiles */
+    uint16_t first;             /**< First object in the window */
+    uint16_t next;              /**< First object right of the window */
+    spawn_fn spawn;             /**< Called for each object coming into the window */
+} spawn_window_t;
+
+/** Sets up a spawn window, empty until @ref spawn_window_set() is called
+
+    @param w       Window to set up
+    @param list    `&name_spawn_list`
+    @param bank    `BANK(name)`, the bank of the map data, 0 if it is not banked
+    @param width   Width of the window in pixels from the camera X, the screen width plus a margin (up to 2040)
+    @param spawn   Called for each object coming into the window
+ */
+void spawn_window_init(spawn_window_t * w, const spawn_list_t * list, uint8_t bank, uint16_t width, spawn_fn spawn);
+
+/** Moves the window to __cam_x__ and spawns every object in it
+
+    The cursors are placed with `name_spawn_buckets[]`, so this only
+    reads the objects of one bucket and those in the window. Use it at
+    the start of a level and after the camera jumps.
+
+    @param w      Window
+    @param cam_x  X position of the camera in pixels
+ */
+void spawn_window_set(spawn_window_t * w, uint16_t cam_x);
+
+/** Moves the window to __cam_x__ and spawns the objects which came into it
+
+    Works for movement in either direction. Objects which the window
+    passed over entirely are skipped without being spawned.
+
+    @param w      Window
+    @param cam_x  X position of the camera in pixels
+ */
+void spawn_window_update(spawn_window_t * w, uint16_t cam_x);
+
+#endif
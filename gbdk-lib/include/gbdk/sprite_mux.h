@@ -0,0 +1,62 @@
+/** @file gbdk/sprite_mux.h
+
+    Scanline aware sprite multiplexing
+
+    The VDP only shows a limited number of sprites on each line
+    (@ref SPRITE_MUX_LINE_LIMIT), sprites later in the SAT vanish
+    on lines with more. @ref sprite_mux_commit() orders the
+    hardware sprites drawn for a frame so that those vanishing
+    change every frame (flicker) instead of always being the same:
+    \code{.c}
+    n = metasprite_batch_end(0);
+    sprite_mux_commit(n);
+    vsync();
+    \endcode
+
+    Sprites are binned into bands of @ref SPRITE_MUX_BIN_LINES lines.
+    Sprites which only cover bands with no more sprites than fit
+    on a line keep their order at the start of the SAT and never
+    flicker. The others follow in an order rotated every frame.
+
+    The number of sprites is set with @ref SET_SHADOW_OAM_COUNT(), so that
+    the VBlank copy only uploads the sprites in use followed by the
+    terminator, in a single run of the unrolled `outi` block.
+
+    Supported on SMS/GG and MSX.
+*/
+
+#ifndef __SPRITE_MUX_H_INCLUDE
+#define __SPRITE_MUX_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/platform.h>
+
+#if defined(__TARGET_msxdos)
+/** Number of sprites the VDP shows on a line */
+#define SPRITE_MUX_LINE_LIMIT 4
+#else
+#define SPRITE_MUX_LINE_LIMIT 8
+#endif
+
+/** Height of the bands sprites are binned into, in lines */
+#define SPRITE_MUX_BIN_LINES  8
+
+/** Orders the hardware sprites of a frame for the sprites per line limit
+
+    @param count  Number of hardware sprites in use, sprites 0 to __count__ - 1
+                  of the shadow OAM being rendered (see `__render_shadow_OAM`)
+
+    Crowding is judged per band rather than per line, so a band can count
+    as crowded with sprites that don't share any line. The sprite heights come
+    from the sprite size (and on MSX magnification) set in the VDP.
+
+    Call it after drawing the sprites of the frame and before the VBlank
+    they are shown in. With double buffering, call it right before
+    @ref oam_double_buffer_swap().
+
+    @return The number of sprites which flicker this frame
+ */
+uint8_t sprite_mux_commit(uint8_t count);
+
+#endif
@@ -0,0 +1,62 @@
+/** @file gbdk/stack.h
+
+    Measuring how deep the stack gets
+
+    The stack starts at `.STACK` (0xE000 on GB/AP/Duck, 0xDFF0 on
+    SMS/GG, set with `-Wl-g.STACK=<address>`) and grows down towards
+    the RAM areas (_DATA, _BSS, the heap...). Nothing stops it when it
+    reaches them, it silently overwrites variables.
+
+    Calling @ref stack_high_water() anywhere in a program links in a
+    startup step which fills the free RAM between the end of the RAM
+    areas and the stack with @ref STACK_PAINT before `main()` runs.
+    Bytes written by the stack no longer hold it, so the lowest one
+    which changed gives the most stack used so far:
+    \code{.c}
+    #include <gbdk/stack.h>
+    #include <gbdk/emu_debug.h>
+
+    void main(void) {
+        while (1) {
+            ...
+            if (joypad() & J_SELECT)
+                EMU_printf("stack %u of %u bytes", stack_high_water(), stack_size());
+            vsync();
+        }
+    }
+    \endcode
+
+    This is a measurement: it only counts the paths which actually ran,
+    including the interrupts which happened to come in at the deepest
+    point. @ref utility_stackcheck "stackcheck" gives the worst case
+    over all paths from the compiler output instead.
+
+    A byte of the stack which happens to be written with the value of
+    @ref STACK_PAINT itself is not seen, which can make the result a
+    little low. Stacks of tasks (see gbdk/task.h) are not measured.
+
+    Available for GB/AP/Duck and SMS/GG.
+*/
+
+#ifndef __STACK_H_INCLUDE
+#define __STACK_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Value the free RAM below the stack is filled with at startup */
+#define STACK_PAINT 0xA5
+
+/** Returns the most bytes of stack used since startup
+
+    Scans up from the end of the RAM areas to the first byte which is
+    not @ref STACK_PAINT, so it takes longer the less stack was used.
+ */
+uint16_t stack_high_water(void);
+
+/** Returns the bytes between the end of the RAM areas and `.STACK`,
+    the room the stack has to grow into
+ */
+uint16_t stack_size(void);
+
+#endif
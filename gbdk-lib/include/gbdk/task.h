@@ -0,0 +1,127 @@
+/** @file gbdk/task.h
+
+    Cooperative tasks for spreading long work over several frames
+
+    Each task is a function with its own small stack which gives up
+    the CPU with @ref task_yield(), for example after every row of a
+    decompression or every node of a path search. The main loop runs
+    the tasks in the time left in each frame with @ref task_run():
+    \code{.c}
+    #include <gbdk/platform.h>
+    #include <gbdk/task.h>
+
+    task_t path_task;
+    uint8_t path_stack[128];
+
+    void find_path(void) {
+        while (!path_done()) {
+            path_step();
+            task_yield();
+        }
+    }
+    ...
+    task_add(&path_task, find_path, path_stack, sizeof(path_stack));
+    while (TRUE) {
+        vsync();
+        update_game();
+        task_run(100);   // Until about 100 lines after vsync() returned
+    }
+    \endcode
+
+    Tasks run in the order they were added, @ref task_run() continues
+    with the task after the last one it ran. A task only loses the
+    CPU when it yields, so the time between yields is what limits how
+    closely the budget is kept.
+
+    The stack of a task must be large enough for the function
+    calls it makes and for the interrupt handlers which may run while
+    it does (the GBDK VBlank handler needs about 20 bytes), see
+    @ref TASK_STACK_MIN. The ROM bank selected by the task is kept
+    while other tasks and the main loop run.
+
+    Supported on the Game Boy, Analogue Pocket, Mega Duck, SMS and Game Gear.
+*/
+
+#ifndef __TASK_H_INCLUDE
+#define __TASK_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/platform.h>
+
+#if defined(NINTENDO)
+/** Number of scanlines in a frame, including VBlank */
+#define TASK_FRAME_LINES 154u
+#define TASK_LINE() (LY_REG)
+#elif defined(SEGA)
+#define TASK_FRAME_LINES 256u
+#define TASK_LINE() (VCOUNTER)
+#else
+  #error Unrecognized port
+#endif
+
+/** Smallest useful task stack, in bytes
+ */
+#define TASK_STACK_MIN 48
+
+/** State of a task which has returned or was removed */
+#define TASK_DONE  0
+/** State of a task which is waiting to run */
+#define TASK_READY 1
+
+/** Task function, it runs until it returns
+ */
+typedef void (*task_func_t)(void);
+
+/** A task, the fields are managed by the scheduler
+ */
+typedef struct task_t {
+    void * sp;              /**< Saved stack pointer while the task isn't running */
+    task_func_t func;       /**< Function of the task */
+    struct task_t * next;   /**< Next task in the list */
+    uint8_t state;          /**< @ref TASK_READY or @ref TASK_DONE */
+} task_t;
+
+/** Adds a task which starts running __func__ on the next @ref task_run()
+
+    @param task        Task to set up, must stay valid until the task is done
+    @param func        Function of the task, in non-banked ROM or the current bank
+    @param stack       Memory for the stack of the task
+    @param stack_size  Size of __stack__, at least @ref TASK_STACK_MIN
+
+    The task starts with the ROM bank which is selected now.
+*/
+void task_add(task_t * task, task_func_t func, uint8_t * stack, uint16_t stack_size);
+
+/** Removes __task__ before it is done
+
+    @param task  Task to remove, must not be the one which is running
+
+    The task doesn't run again, its state becomes @ref TASK_DONE.
+*/
+void task_remove(task_t * task);
+
+/** Gives up the CPU until the task is run again by @ref task_run()
+
+    Must only be called from a task.
+*/
+void task_yield(void);
+
+/** Runs tasks until __lines__ scanlines have passed since it was called
+
+    @param lines  Time budget in scanlines, up to a frame
+
+    Runs the tasks one after another, each up to its next @ref task_yield(),
+    and stops when the budget is used up, when a VBlank interrupt happens
+    or when there are no tasks left. Call it from the main loop, not from
+    a task or an interrupt handler.
+
+    @return The number of tasks which are not done yet
+*/
+uint8_t task_run(uint8_t lines);
+
+/** The running task, NULL outside of tasks
+ */
+extern task_t * task_current;
+
+#endif
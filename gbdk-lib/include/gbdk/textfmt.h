@@ -0,0 +1,147 @@
+/** @file gbdk/textfmt.h
+
+    Fast number formatting and line buffered text output
+
+    @ref printf() and @ref sprintf() parse a format string at run time
+    and send each character through @ref putchar(), which updates the
+    console cursor and writes VRAM one tile at a time. That is too slow
+    for a HUD which changes every frame.
+
+    The fmt_ functions convert a number straight into a buffer of tile
+    indices, without any division, in the same way as @ref bcd2text():
+    __tile_offset__ is added to each digit, so it can be the tile of
+    the font's '0' to use the buffer with @ref set_bkg_tiles(), or
+    '0' to get a regular ASCII string.
+
+    A @ref text_line_t collects text and numbers for one row of the
+    background and writes them with a single @ref set_bkg_tiles() call.
+    \code{.c}
+    text_line_t hud;
+
+    text_line_init(&hud, 1, 0, font_offset);
+    ...
+    text_line_puts(&hud, "SCORE ");
+    text_line_u16(&hud, score);
+    text_line_fill(&hud, ' ', 12);  // Clear what is left of a longer value
+    text_line_flush(&hud);
+    \endcode
+*/
+
+#ifndef __TEXTFMT_H_INCLUDE
+#define __TEXTFMT_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Writes __n__ as decimal digits, without leading zeros
+
+    @param n            Number to convert
+    @param tile_offset  Added to each digit value (0 - 9)
+    @param buffer       Buffer for the digits, at least 4 bytes
+
+    The digits are followed by a 0 terminator.
+
+    @return Number of digits written (1 - 3)
+ */
+uint8_t fmt_u8(uint8_t n, uint8_t tile_offset, uint8_t * buffer);
+
+/** Writes __n__ as decimal digits, without leading zeros
+
+    @param n            Number to convert
+    @param tile_offset  Added to each digit value (0 - 9)
+    @param buffer       Buffer for the digits, at least 6 bytes
+
+    The digits are followed by a 0 terminator.
+
+    @return Number of digits written (1 - 5)
+ */
+uint8_t fmt_u16(uint16_t n, uint8_t tile_offset, uint8_t * buffer);
+
+/** Writes the lowest __width__ decimal digits of __n__, with leading zeros
+
+    @param n            Number to convert
+    @param width        Number of digits to write (1 - 5)
+    @param tile_offset  Added to each digit value (0 - 9)
+    @param buffer       Buffer for the digits, at least __width__ + 1 bytes
+
+    Useful for counters which always take the same space on screen.
+    The digits are followed by a 0 terminator.
+
+    @return __width__
+ */
+uint8_t fmt_u16_zero(uint16_t n, uint8_t width, uint8_t tile_offset, uint8_t * buffer);
+
+/** Writes __n__ as decimal digits right aligned in __width__ tiles
+
+    @param n            Number to convert
+    @param width        Number of tiles to write (1 - 5)
+    @param fill_tile    Tile written in front of the digits
+    @param tile_offset  Added to each digit value (0 - 9)
+    @param buffer       Buffer for the digits, at least __width__ + 1 bytes
+
+    Like @ref fmt_u16_zero(), but with __fill_tile__ (for example a
+    blank tile) instead of the leading zeros, so a value which gets
+    shorter doesn't leave old digits behind on screen. The digits are
+    followed by a 0 terminator.
+
+    @return __width__
+ */
+uint8_t fmt_u16_pad(uint16_t n, uint8_t width, uint8_t fill_tile, uint8_t tile_offset, uint8_t * buffer);
+
+/** Writes the lowest __width__ hex digits of __n__, with leading zeros
+
+    @param n            Number to convert
+    @param width        Number of digits to write (1 - 4)
+    @param tile_offset  Added to each digit value (0 - 15)
+    @param buffer       Buffer for the digits, at least __width__ + 1 bytes
+
+    The tiles for A - F must follow the tile for 9. As a special case,
+    a __tile_offset__ of '0' writes 'A' - 'F' to give an ASCII string.
+    The digits are followed by a 0 terminator.
+
+    @return __width__
+ */
+uint8_t fmt_hex(uint16_t n, uint8_t width, uint8_t tile_offset, uint8_t * buffer);
+
+/** Maximum length of a @ref text_line_t, the width of the hardware tile map */
+#define TEXT_LINE_MAX 32
+
+/** A line of text which is written to the background in one go
+ */
+typedef struct text_line_t {
+    uint8_t x;                      /**< X position on the background in tiles */
+    uint8_t y;                      /**< Y position on the background in tiles */
+    uint8_t tile_offset;            /**< Added to each character to get its tile */
+    uint8_t len;                    /**< Number of tiles in __buf__ */
+    uint8_t buf[TEXT_LINE_MAX + 1]; /**< Tiles, with room for a terminator */
+} text_line_t;
+
+/** Sets up an empty line
+
+    @param line         Line to set up
+    @param x            X position on the background in tiles
+    @param y            Y position on the background in tiles
+    @param tile_offset  Added to each character to get its tile, for example
+                        the tile of ' ' in the font minus ' '
+ */
+void text_line_init(text_line_t * line, uint8_t x, uint8_t y, uint8_t tile_offset);
+
+/** Appends the characters of __s__
+
+    Characters which do not fit in @ref TEXT_LINE_MAX are dropped.
+ */
+void text_line_puts(text_line_t * line, const char * s);
+
+/** Appends __n__ in decimal, without leading zeros */
+void text_line_u16(text_line_t * line, uint16_t n);
+
+/** Appends the character __c__ until the line is __width__ characters long */
+void text_line_fill(text_line_t * line, char c, uint8_t width);
+
+/** Writes the line to the background with @ref set_bkg_tiles() and empties it
+
+    The next text is written from the start of the same position again.
+ */
+void text_line_flush(text_line_t * line);
+
+#endif
@@ -0,0 +1,86 @@
+/** @file gbdk/textpack.h
+
+    Compressed strings read one character at a time
+
+    Scripts are converted with @ref utility_text2asset "text2asset",
+    one string per line. Substrings which repeat are replaced by
+    dictionary entries, and with `-huffman` the result is Huffman
+    coded as well:
+    \code{.sh}
+    text2asset script.txt -huffman -c res/script.c
+    \endcode
+
+    Nothing is decompressed to RAM: a @ref textpack_reader_t
+    yields the characters of a string one by one, so it can feed a
+    typewriter loop directly.
+    \code{.c}
+    #include "res/script.h"
+
+    textpack_reader_t r;
+    char c;
+
+    textpack_open(&r, &script, script_INTRO);
+    while ((c = textpack_getc(&r))) {
+        vwf_putc(&text, c);     // or putchar(c)
+        vwf_flush(&text);
+        vsync();
+    }
+    \endcode
+
+    The strings are split into chunks of up to 16K, each of which
+    can be in any ROM bank. The @ref textpack_t, its index, the
+    dictionary and the Huffman tree must be in non-banked ROM.
+*/
+
+#ifndef __TEXTPACK_H_INCLUDE
+#define __TEXTPACK_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Start of a string
+ */
+typedef struct textpack_ref_t {
+    const uint8_t * data;           /**< First byte of the string */
+    uint8_t bank;                   /**< ROM bank of __data__ */
+} textpack_ref_t;
+
+/** A set of compressed strings, written by text2asset
+ */
+typedef struct textpack_t {
+    const textpack_ref_t * index;   /**< Start of each string */
+    const uint8_t * dict;           /**< Dictionary entries, one after the other */
+    const uint16_t * dict_offsets;  /**< Start of each entry in __dict__, then the end of the last one */
+    const uint16_t * tree;          /**< Huffman tree, NULL if the strings are not Huffman coded */
+    uint16_t count;                 /**< Number of strings */
+    uint8_t first_token;            /**< Lowest byte value which stands for a dictionary entry */
+} textpack_t;
+
+/** State of the string being read
+ */
+typedef struct textpack_reader_t {
+    const textpack_t * pack;        /**< Strings */
+    const uint8_t * ptr;            /**< Next byte of the string, NULL at its end */
+    uint8_t bank;                   /**< ROM bank of __ptr__ */
+    uint8_t bits;                   /**< Huffman bits not used yet, from the top down */
+    uint8_t bit_count;              /**< Number of bits in __bits__ */
+    const uint8_t * expand;         /**< Rest of the dictionary entry being read */
+    uint8_t expand_left;            /**< Characters left in __expand__ */
+} textpack_reader_t;
+
+/** Starts reading a string
+
+    @param r     Reader
+    @param pack  Strings
+    @param id    Number of the string, from 0 to __pack__->count - 1
+ */
+void textpack_open(textpack_reader_t * r, const textpack_t * pack, uint16_t id);
+
+/** Returns the next character of the string, or 0 at its end
+
+    Each call decodes at most one symbol of the string. The ROM bank
+    of the string is switched in while reading it, then switched back.
+ */
+char textpack_getc(textpack_reader_t * r);
+
+#endif
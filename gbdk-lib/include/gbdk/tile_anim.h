@@ -0,0 +1,117 @@
+/** @file gbdk/tile_anim.h
+
+    Animated background tiles
+
+    Water, lava or conveyor belts are animated by writing new tile
+    data over a few background tiles every few frames, the map stays
+    the same. A table of @ref tile_anim_t, one per group of animated
+    tiles, is stepped once per frame by @ref tile_anim_update(), which
+    writes the frames which are due through the deferred VRAM queue
+    (GB/AP/Duck and SMS/GG, see gb/vram_queue.h and sms/vram_queue.h)
+    or the VRAM transfer buffer (NES). At most @ref tile_anim_budget
+    bytes are written per frame, so many animations can run at once
+    and the VBlank time they take stays bounded: frames which don't
+    fit are written during the following frames, starting with them.
+
+    The frames of an animation are consecutive tiles in ROM, one frame
+    after the other. png2asset writes them that way from an image with
+    the frames stacked from top to bottom, each frame as wide as the image:
+    \code{.c}
+    // png2asset water.png -map -keep_duplicate_tiles -noflip -tiles_only -b 255 -c res/water.c
+    // water.png: 16 x 64 pixels, 4 frames of 2 x 2 tiles
+    #include "res/water.h"
+    #include "res/lava.h"
+
+    tile_anim_t level_anims[] = {
+        TILE_ANIM(water_tiles, BANK(water), WATER_TILE, 4, 4, 8),   // 4 tiles, 4 frames, 8 frames each
+        TILE_ANIM(lava_tiles, BANK(lava), LAVA_TILE, 2, 6, 12)
+    };
+
+    CRITICAL {
+        add_VBL(vram_queue_isr);
+    }
+    ...
+    while (TRUE) {
+        ...
+        tile_anim_update(level_anims, 2);
+        vsync();
+    }
+    \endcode
+
+    The first frame of each animation is written by the first call of
+    @ref tile_anim_update(). The table has to be in RAM, since it also
+    keeps the state of each animation.
+
+    On the CGB only VRAM bank 0 is written. On the NES the tiles need
+    CHR RAM.
+
+    Supported on GB/AP/Duck, SMS/GG and NES.
+*/
+
+#ifndef __TILE_ANIM_H_INCLUDE
+#define __TILE_ANIM_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Default of @ref tile_anim_budget: 4 tiles per frame
+ */
+#if defined(__TARGET_sms) || defined(__TARGET_gg)
+#define TILE_ANIM_BUDGET 128
+#else
+#define TILE_ANIM_BUDGET 64
+#endif
+
+/** Flag of @ref tile_anim_t: the next frame is due but not written yet
+ */
+#define TILE_ANIM_PENDING 0x01
+
+/** An animation of a group of consecutive background tiles
+ */
+typedef struct tile_anim_t {
+    const uint8_t * tiles;  /**< Tile data of all frames, one frame after the other */
+    uint8_t bank;           /**< ROM bank of __tiles__ */
+    uint16_t first_tile;    /**< First background tile the frames are written to */
+    uint8_t tile_count;     /**< Number of tiles of each frame */
+    uint8_t frame_count;    /**< Number of frames */
+    uint8_t ticks;          /**< Number of frames each frame is shown, 0 to pause the animation */
+    uint8_t timer;          /**< Frames until the next frame is due */
+    uint8_t frame;          /**< Next frame to write */
+    uint8_t flags;          /**< Zero or @ref TILE_ANIM_PENDING */
+} tile_anim_t;
+
+/** Initializer of a @ref tile_anim_t, which writes its first frame on the next @ref tile_anim_update()
+ */
+#define TILE_ANIM(tiles, bank, first_tile, tile_count, frame_count, ticks) \
+    { (tiles), (bank), (first_tile), (tile_count), (frame_count), (ticks), 0, 0, 0 }
+
+/** Maximum number of bytes of tile data written by each call of @ref tile_anim_update()
+
+    Defaults to @ref TILE_ANIM_BUDGET. A frame larger than the budget
+    is still written when it is the first one written by a call.
+ */
+extern uint16_t tile_anim_budget;
+
+/** Steps a table of animations by one frame and writes the frames which are due
+
+    @param anims  Table of animations
+    @param count  Number of animations
+
+    Call it once per frame. Frames which are due but don't fit into
+    @ref tile_anim_budget (or on the NES into the VRAM transfer buffer)
+    stay pending, and the next call writes them first. If an animation
+    is still pending when its next frame is due, that frame is skipped.
+
+    The ROM bank of each animation is switched in while its tiles are
+    queued, then the bank which was switched in before is restored.
+*/
+void tile_anim_update(tile_anim_t * anims, uint8_t count);
+
+/** Restarts an animation at __frame__, which is written by the next @ref tile_anim_update()
+
+    @param anim   Animation
+    @param frame  Frame to show, less than the frame count
+*/
+void tile_anim_set_frame(tile_anim_t * anim, uint8_t frame);
+
+#endif
@@ -0,0 +1,64 @@
+/** @file gbdk/tile_flags.h
+
+    Lookup of per tile collision flags exported by png2asset
+
+    `png2asset ... -map -collision_map <png> <bits>` exports a flag
+    value for each map tile, packed 1 or 2 bits per tile into
+    `name_collision[]`. Each map row uses a power of two number of
+    bytes, `1 << name_COLLISION_ROW_SHIFT`, so finding the byte of a
+    tile takes only shifts, no multiply by the map width.
+
+    A 1 bit map is enough for solid / not solid; 2 bits give 4 values,
+    for example empty, solid, platform and hazard.
+    \code{.c}
+    #include "level.h"
+
+    if (TILE_FLAGS_AT(level, player_x, player_y + 16)) {
+        // standing on something
+    }
+    \endcode
+
+    The coordinates are in pixels from the top left of the map and are
+    not checked against its size. Maps can be up to 256 tiles wide.
+*/
+
+#ifndef __TILE_FLAGS_H_INCLUDE
+#define __TILE_FLAGS_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Returns the flag (0 or 1) of the tile at pixel __x__, __y__ of a 1 bit collision map
+
+    @param map        Packed map, `name_collision`
+    @param row_shift  `name_COLLISION_ROW_SHIFT`
+    @param x          X position in pixels
+    @param y          Y position in pixels
+ */
+inline uint8_t tile_flags1_at(const uint8_t * map, uint8_t row_shift, uint16_t x, uint16_t y) {
+    uint8_t tx = (uint8_t)(x >> 3);
+    return (map[((y >> 3) << row_shift) + (tx >> 3)] >> (tx & 7)) & 1;
+}
+
+/** Returns the flags (0 to 3) of the tile at pixel __x__, __y__ of a 2 bit collision map
+
+    @param map        Packed map, `name_collision`
+    @param row_shift  `name_COLLISION_ROW_SHIFT`
+    @param x          X position in pixels
+    @param y          Y position in pixels
+ */
+inline uint8_t tile_flags2_at(const uint8_t * map, uint8_t row_shift, uint16_t x, uint16_t y) {
+    uint8_t tx = (uint8_t)(x >> 3);
+    return (map[((y >> 3) << row_shift) + (tx >> 2)] >> ((tx & 3) << 1)) & 3;
+}
+
+/** Returns the flags of the tile at pixel __x__, __y__ of the collision map exported by png2asset as __name__
+
+    Picks @ref tile_flags1_at() or @ref tile_flags2_at() from `name_COLLISION_BITS`.
+ */
+#define TILE_FLAGS_AT(name, x, y) \
+    ((name ## _COLLISION_BITS == 1) ? \
+        tile_flags1_at(name ## _collision, name ## _COLLISION_ROW_SHIFT, (x), (y)) : \
+        tile_flags2_at(name ## _collision, name ## _COLLISION_ROW_SHIFT, (x), (y)))
+
+#endif
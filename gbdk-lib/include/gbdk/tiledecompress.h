@@ -0,0 +1,87 @@
+/** @file gbdk/tiledecompress.h
+
+    Decompressor for 2bpp tile data
+
+    Decompresses tile data which has been compressed with
+    @ref utility_gbcompress "gbcompress" using the `--alg=tile` argument.
+
+    Each row of a tile is stored with a 2 bit mode: both bitplanes,
+    one byte when the planes are the same or the high plane is zero,
+    or nothing when the row repeats the row before. Tiles which
+    appeared earlier are stored as a 2 byte reference to the
+    compressed data of the first one. For tilesets this is usually
+    smaller than @ref rle_decompress() data, and `gbcompress -v --alg=tile`
+    shows the size next to the rle and gb formats.
+
+    References point into the compressed data, so only the row
+    before in the same tile is read back from the output and
+    the GB/AP/Duck VRAM functions work with the display on.
+*/
+
+#ifndef __TILEDECOMPRESS_H_INCLUDE
+#define __TILEDECOMPRESS_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** tile-decompress data from sour into dest
+
+    @param sour   Pointer to source tile compressed data
+    @param dest   Pointer to destination buffer/address
+
+    @return       Return value is number of bytes decompressed
+
+    Will decompress __all__ of it's data to destination without
+    stopping until the end of compressed data is reached. It is
+    not possible to set a limit, so ensure the destination buffer
+    has sufficient space to avoid an overflow.
+
+    __dest__ must be readable (RAM, or on GB/AP/Duck VRAM
+    with the display off), since repeated rows are read back.
+
+    @see tile_decompress_bkg_data, gb_decompress, rle_decompress
+ */
+uint16_t tile_decompress(const uint8_t * sour, uint8_t * dest);
+
+#if defined(__TARGET_gb) || defined(__TARGET_ap) || defined(__TARGET_duck)
+
+/** tile-decompress background tiles into VRAM
+
+    @param first_tile  Index of the first tile to write
+    @param sour        Pointer to (tile compressed 2 bpp) source Tile Pattern data.
+
+    Note: This function avoids writes during modes 2 & 3
+
+    Like @ref set_bkg_data() the tiles wrap from $97FF to $8800
+    when the background uses the $8800 tile data area.
+
+    @see tile_decompress_win_data, tile_decompress_sprite_data
+*/
+void tile_decompress_bkg_data(uint8_t first_tile, const uint8_t * sour);
+
+/** tile-decompress window tiles into VRAM
+
+    @param first_tile  Index of the first tile to write
+    @param sour        Pointer to (tile compressed 2 bpp) source Tile Pattern data.
+
+    This is the same as @ref tile_decompress_bkg_data, since the Window Layer and
+    Background Layer share the same Tile pattern data.
+
+    @see tile_decompress_bkg_data, tile_decompress_sprite_data
+*/
+void tile_decompress_win_data(uint8_t first_tile, const uint8_t * sour);
+
+/** tile-decompress sprite tiles into VRAM
+
+    @param first_tile  Index of the first tile to write
+    @param sour        Pointer to (tile compressed 2 bpp) source Tile Pattern data.
+
+    Note: This function avoids writes during modes 2 & 3
+
+    @see tile_decompress_bkg_data, tile_decompress_win_data
+*/
+void tile_decompress_sprite_data(uint8_t first_tile, const uint8_t * sour);
+
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+/** @file gbdk/timer.h
+
+    Timestamps finer than a frame
+
+    @ref sys_time only counts frames. @ref timer_now_cycles() adds the
+    position of the display in the current frame to it, which gives a
+    timestamp in CPU cycles for timing code which runs for less than a
+    frame, or timeouts which need more precision:
+    \code{.c}
+    #include <gbdk/platform.h>
+    #include <gbdk/emu_debug.h>
+    #include <gbdk/timer.h>
+
+    uint32_t start = timer_now_cycles();
+    update_enemies();
+    EMU_printf("enemies %lu cycles", timer_now_cycles() - start);
+    \endcode
+
+    The position is read from the scanline counter, so the timestamp
+    moves in steps of a scanline, about 110us (456 cycles on the
+    Game Boy, 228 on the SMS/GG). It only runs while the display and
+    the VBlank interrupt are on, as @ref sys_time does.
+
+    It goes back to 0 when @ref sys_time wraps around, every ~18 minutes,
+    so the difference of two timestamps is right as long as that did
+    not happen in between.
+
+    \li GB/AP/Duck: counted in normal speed cycles, which stay at
+        @ref TIMER_CYCLES_PER_SECOND in CGB double speed mode too.
+    \li SMS/GG: the scanline counter repeats values during VBlank, so
+        the timestamp stays at the start of the frame until the next
+        active line.
+    \li NES: the position in the frame can't be read, the timestamp
+        moves a frame at a time.
+*/
+
+#ifndef __TIMER_H_INCLUDE
+#define __TIMER_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+#include <gbdk/platform.h>
+
+#if defined(NINTENDO)
+/** CPU cycles per second counted by @ref timer_now_cycles() */
+#define TIMER_CYCLES_PER_SECOND 4194304u
+#elif defined(SEGA)
+#define TIMER_CYCLES_PER_SECOND ((_SYSTEM == SYSTEM_PAL) ? 3546895u : 3579545u)
+#elif defined(NINTENDO_ENTERTAINMENT_SYSTEM)
+#define TIMER_CYCLES_PER_SECOND 1789773u
+#else
+  #error Unrecognized port
+#endif
+
+/** Returns the CPU cycles since startup, in steps of a scanline
+
+    Never returns less than an earlier call, until @ref sys_time
+    wraps around. Can be called from interrupt handlers.
+ */
+uint32_t timer_now_cycles(void);
+
+#endif
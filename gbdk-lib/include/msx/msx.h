@@ -239,6 +239,10 @@ inline void display_off(void) {
 	display_off();
 
 /** Copies data from shadow OAM to OAM
+
+    Only the first @ref _shadow_OAM_count sprites are copied, see
+    @ref SET_SHADOW_OAM_COUNT(). The copy is faster while the display
+    is off.
  */
 void refresh_OAM(void);
 
@@ -307,6 +311,111 @@ void refresh_OAM(void);
 */
 extern volatile uint16_t sys_time;
 
+/** Time it took the MSX-DOS startup code to load the overlay banks,
+    in VBL periods (BIOS JIFFY ticks). 0 if there are no overlays.
+
+    For example, to see it in an emulator debug log:
+    \code{.c}
+    EMU_printf("overlays loaded in %u ticks", overlay_load_time);
+    \endcode
+
+    @see EMU_printf
+*/
+extern uint16_t overlay_load_time;
+
+/** Buffering modes of @ref msxdos_stdout_mode() and @ref msxdos_stdin_mode()
+ */
+#define MSXDOS_UNBUFFERED     0 /**< One BDOS call per character */
+#define MSXDOS_LINE_BUFFERED  1 /**< Output is printed at the end of each line, input is read a line at a time */
+#define MSXDOS_FULLY_BUFFERED 2 /**< Output is printed when the buffer is full (stdout only) */
+
+/** Sets how putchar() (and so printf() and puts()) print to the console
+
+    @param mode   @ref MSXDOS_UNBUFFERED, @ref MSXDOS_LINE_BUFFERED (the default)
+                  or @ref MSXDOS_FULLY_BUFFERED
+
+    Buffered text is printed with one BDOS string output call per
+    128 bytes or line, instead of one call per character. It is
+    also printed by @ref msxdos_stdout_flush(), before console
+    input is read and when the program exits.
+
+    The buffer is printed before the mode is changed.
+*/
+void msxdos_stdout_mode(uint8_t mode) Z88DK_FASTCALL;
+
+/** Prints the text which is waiting in the stdout buffer
+
+    Needed before text is printed without putchar(), or to show
+    a line which is not finished yet with @ref MSXDOS_LINE_BUFFERED.
+*/
+void msxdos_stdout_flush(void);
+
+/** Sets how getchar() reads from the console
+
+    @param mode   @ref MSXDOS_UNBUFFERED (the default) or @ref MSXDOS_LINE_BUFFERED
+
+    With @ref MSXDOS_UNBUFFERED getchar() returns each key as it is
+    pressed, without echo. With @ref MSXDOS_LINE_BUFFERED a line of
+    up to 63 characters is read with one BDOS call, with echo and
+    line editing, and getchar() returns its characters followed by
+    '\n'. gets() always reads a whole line this way.
+
+    Any rest of the last line is dropped.
+*/
+void msxdos_stdin_mode(uint8_t mode) Z88DK_FASTCALL;
+
+/** Size of the buffer of @ref msxdos_file_t, one disk sector
+ */
+#define MSXDOS_FILE_BUF_SIZE 512
+
+/** A file opened for reading with @ref msxdos_fopen()
+
+    Files are read through the FCB functions of the BDOS, which
+    work with MSX-DOS 1 and 2, a sector at a time.
+ */
+typedef struct msxdos_file_t {
+    uint8_t fcb[37];                    /**< File control block */
+    uint16_t pos;                       /**< Next byte in __buf__ */
+    uint16_t len;                       /**< Number of bytes in __buf__ */
+    uint8_t buf[MSXDOS_FILE_BUF_SIZE];  /**< Data read from the file */
+} msxdos_file_t;
+
+/** Opens a file for reading
+
+    @param f      File to open
+    @param name   Name of the file, in 8.3 format with an optional drive, for example "A:LEVEL1.DAT"
+
+    @return 0 on success, otherwise the file was not found
+*/
+uint8_t msxdos_fopen(msxdos_file_t * f, const char * name) Z88DK_CALLEE;
+
+/** Reads up to __size__ bytes from a file
+
+    @param f      File opened with @ref msxdos_fopen()
+    @param dst    Destination buffer
+    @param size   Number of bytes to read
+
+    Reads of @ref MSXDOS_FILE_BUF_SIZE bytes or more, once the buffer
+    is used up, go straight into __dst__ with a single BDOS call.
+
+    @return Number of bytes read, less than __size__ at the end of the file
+*/
+uint16_t msxdos_fread(msxdos_file_t * f, void * dst, uint16_t size) Z88DK_CALLEE;
+
+/** Reads one byte from a file
+
+    @param f      File opened with @ref msxdos_fopen()
+
+    @return The byte, or -1 at the end of the file
+*/
+int16_t msxdos_fgetc(msxdos_file_t * f) Z88DK_CALLEE;
+
+/** Closes a file opened with @ref msxdos_fopen()
+
+    @param f      File to close
+*/
+void msxdos_fclose(msxdos_file_t * f) Z88DK_CALLEE;
+
 /** Tracks current active ROM bank in frame 1
 */
 extern volatile uint8_t _current_bank;
@@ -558,6 +667,26 @@ inline void set_win_submap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uin
     set_tile_submap_compat(x, y, w, h, map_w, map);
 }
 
+/** Sets a rectangular area of the Background Tile Map using a sub-region
+    from a source tile map up to 65535 tiles wide.
+
+    Same as @ref set_bkg_submap() with 16 bit __x__, __y__ and __map_w__.
+    On this platform it writes the area with one @ref set_bkg_submap()
+    call per row.
+*/
+inline void set_bkg_submap16(uint16_t x, uint16_t y, uint8_t w, uint8_t h, const uint8_t *map, uint16_t map_w) {
+    const uint8_t * row = map + (y * map_w) + x;
+    uint8_t hx = x & (DEVICE_SCREEN_BUFFER_WIDTH - 1), hy = y % DEVICE_SCREEN_BUFFER_HEIGHT;
+    for (; h; h--, row += map_w) {
+        /* With a map width of 1 set_bkg_submap() reads from row - hx - hy + hy + hx */
+        set_bkg_submap(hx, hy, w, 1, row - hx - hy, 1);
+        if (++hy == DEVICE_SCREEN_BUFFER_HEIGHT) hy = 0;
+    }
+}
+inline void set_win_submap16(uint16_t x, uint16_t y, uint8_t w, uint8_t h, const uint8_t *map, uint16_t map_w) {
+    set_bkg_submap16(x, y, w, h, map, map_w);
+}
+
 extern uint8_t _submap_tile_offset;
 inline void set_bkg_based_submap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *map, uint8_t map_w, uint8_t base_tile) {
     _submap_tile_offset = base_tile;
@@ -649,6 +778,30 @@ inline void SET_SHADOW_OAM_ADDRESS(void * address) {
     _shadow_OAM_base = (uint8_t)((uint16_t)address >> 8);
 }
 
+/** Number of sprites copied from shadow OAM to OAM, @ref MAX_HARDWARE_SPRITES by default
+*/
+extern volatile uint8_t _shadow_OAM_count;
+
+/** Sets the number of sprites in use, which are copied from shadow OAM to OAM
+
+    @param count Number of sprites, 0 to @ref MAX_HARDWARE_SPRITES
+
+    With a __count__ below @ref MAX_HARDWARE_SPRITES the VBlank copy and
+    @ref refresh_OAM() only write the sprites in use and a terminator,
+    which ends the sprite list for the VDP. That makes the
+    copy shorter and the sprites from __count__ onwards don't have to
+    be hidden, for example:
+    \code{.c}
+    SET_SHADOW_OAM_COUNT(move_metasprite_ex(player_metasprite, 0, 0, 0, x, y));
+    \endcode
+
+    The Y coordinate 0xD0 ends the sprite list as well, so it can't be used
+    for the sprites in use.
+*/
+inline void SET_SHADOW_OAM_COUNT(uint8_t count) {
+    _shadow_OAM_count = count;
+}
+
 /** Sets sprite number __nb__in the OAM to display tile number __tile__.
 
     @param nb    Sprite number, range 0 - 39
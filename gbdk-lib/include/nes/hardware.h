@@ -38,6 +38,29 @@ __REG(0x2006) PPUADDR;
 __REG(0x2007) PPUDATA;
 __REG(0x4014) OAMDMA;
 
+__REG(0x4000) APU_PULSE1_CTRL;
+__REG(0x4001) APU_PULSE1_SWEEP;
+__REG(0x4002) APU_PULSE1_LO;
+__REG(0x4003) APU_PULSE1_HI;
+__REG(0x4004) APU_PULSE2_CTRL;
+__REG(0x4005) APU_PULSE2_SWEEP;
+__REG(0x4006) APU_PULSE2_LO;
+__REG(0x4007) APU_PULSE2_HI;
+__REG(0x4008) APU_TRI_CTRL;
+__REG(0x400A) APU_TRI_LO;
+__REG(0x400B) APU_TRI_HI;
+__REG(0x400C) APU_NOISE_CTRL;
+__REG(0x400E) APU_NOISE_PERIOD;
+__REG(0x400F) APU_NOISE_LENGTH;
+__REG(0x4015) APU_STATUS;
+#define APU_LENGTH_HALT     0b00100000
+#define APU_CONST_VOLUME    0b00010000
+#define APU_LENGTH_LOAD     0b00001000
+#define APU_SWEEP_OFF       0b00001000
+#define APU_TRI_ON          0b11111111
+#define APU_TRI_OFF         0b10000000
+#define APU_STATUS_ALL      0b00001111
+
 #define DEVICE_SCREEN_X_OFFSET 0
 #define DEVICE_SCREEN_Y_OFFSET 0
 #define DEVICE_SCREEN_WIDTH 32
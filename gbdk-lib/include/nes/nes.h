@@ -244,6 +244,37 @@ __endasm; \
 */
 #define SWITCH_ROM SWITCH_ROM_UNROM
 
+/** Maps an 8K PRG bank into the $A000 - $BFFF window (MMC3 only, `lcc -mapper=mmc3`)
+    @param bank_8k   8K ROM bank to switch to. The 16K bank N is made of 8K banks 2N and 2N+1
+
+    With MMC3 the 16K bank at $8000 is mapped as two 8K windows, this
+    swaps only the upper one, for example to page data while code runs
+    from $8000. The next bank switch or banked call restores both windows.
+*/
+void switch_prg_a000(uint8_t bank_8k);
+
+/** Maps a 4K CHR-ROM bank as the background tiles (MMC1 and MMC3 only, `lcc -mapper=mmc1` or `-mapper=mmc3`)
+    @param bank   4K CHR bank (256 tiles) to map at PPU $0000
+
+    For ROMs with CHR-ROM instead of CHR-RAM (makebin `-c`, see
+    png2asset `-chr_rom`): the whole tileset changes with a mapper
+    register write instead of an upload with @ref set_bkg_data(),
+    which doesn't work with CHR-ROM. At power up bank 0 is the
+    background and bank 1 the sprite pattern table.
+
+    Up to 32 banks with MMC1, up to 64 banks with MMC3.
+
+    @see set_sprite_chr_bank
+*/
+void set_bkg_chr_bank(uint8_t bank);
+
+/** Maps a 4K CHR-ROM bank as the sprite tiles (MMC1 and MMC3 only, `lcc -mapper=mmc1` or `-mapper=mmc3`)
+    @param bank   4K CHR bank (256 tiles) to map at PPU $1000
+
+    @see set_bkg_chr_bank
+*/
+void set_sprite_chr_bank(uint8_t bank);
+
 /** No-op at the moment. Placeholder for future mappers / test compatibility.
     @param b   SRAM bank to switch to
 
@@ -368,6 +399,111 @@ void vsync(void);
 */
 void wait_vbl_done(void);
 
+/** Time the VBlank handler takes for a stripe of __n__ bytes in the VRAM transfer buffer,
+    in units of 8 CPU cycles, see @ref get_vram_transfer_budget()
+*/
+#define VRAM_STRIPE_COST(n) (6u + (n))
+
+/** Time the VBlank handler takes for a fill of __n__ bytes (up to 32) with the same value,
+    as written by @ref fill_bkg_rect() and @ref vmemset(), in units of 8 CPU cycles
+*/
+#define VRAM_FILL_COST(n) (9u + (((n) + 1u) >> 1))
+
+/** Returns roughly how much more can be written to VRAM before the next VBlank
+
+    While the display is on, VRAM writes are queued in a transfer buffer
+    which the VBlank handler copies to VRAM. The result is in units of
+    8 CPU cycles of VBlank time (see @ref VRAM_STRIPE_COST() and
+    @ref VRAM_FILL_COST()), and is also limited by the space left in the
+    buffer. Writes which do not fit wait for the next VBlank, so this can
+    be used to defer a column update to the next frame instead.
+    \code{.c}
+    if (get_vram_transfer_budget() >= VRAM_STRIPE_COST(30)) stream_column();
+    \endcode
+*/
+uint8_t get_vram_transfer_budget(void);
+
+/** Number of lag frames so far, counted while @ref lag_frame_detect_enable() is in effect
+
+    Wraps around after 255.
+*/
+extern volatile uint8_t lag_frames;
+
+/** Skips the VRAM updates in the VBlank handler on lag frames
+
+    A lag frame is one where the main loop did not call @ref vsync()
+    before the VBlank, and may be half way through changing the
+    transfer buffer, palettes or scroll. On those, the VBlank handler
+    only does the OAM DMA and the NMI tasks without VBlank time (see
+    @ref nmi_task_add()), and counts the frame in @ref lag_frames.
+    The PPU keeps the scroll and VRAM of the last complete frame, and
+    everything is written with the next VBlank after vsync().
+
+    Writes which wait for room in the transfer buffer also mark the
+    frame as complete, so they don't wait forever.
+
+    Sprites are still transferred on lag frames, use
+    @ref oam_double_buffer_enable() to avoid showing sprites which
+    are only partly moved.
+
+    Code which does not call vsync() each frame must not enable it,
+    its VRAM writes would only show once the buffer is full.
+
+    @see lag_frame_detect_disable
+*/
+void lag_frame_detect_enable(void);
+
+/** Stops the detection of lag frames, every VBlank does all updates again (the default)
+
+    @see lag_frame_detect_enable
+*/
+void lag_frame_detect_disable(void);
+
+/** Most tasks which can be added with @ref nmi_task_add() */
+#define NMI_TASK_MAX 4
+
+/** Routine called from the VBlank handler, see @ref nmi_task_add() */
+typedef void (*nmi_task_t)(void);
+
+/** Adds a routine to the VBlank handler
+
+    @param task       Routine to call each frame
+    @param cycles_x8  VBlank time it takes at most, in units of 8 CPU cycles,
+                      or 0 to call it after VBlank
+
+    Tasks with a VBlank time run right after the transfer buffer is
+    copied, while rendering is still off, and can write to the PPU.
+    Their time is taken off the transfer buffer, which has 170 units
+    per frame (see @ref get_vram_transfer_budget()), so the VBlank
+    handler still finishes in time. They are skipped on lag frames
+    and while the display is off.
+
+    Tasks without a VBlank time run at the end of the handler on every
+    frame, lag frames included, and must not access the PPU. This
+    suits a sound driver which has to keep its pace.
+
+    Tasks run in the order they were added, with A, X and Y already
+    saved. They interrupt the main code at any point, so they must be
+    written in assembly and must not use the zero page temporaries of
+    the compiler or the overlay for function parameters. The 4 bytes
+    at `.nmi_zp_scratch` are reserved for them instead.
+
+    Adding a task with a VBlank time waits for the next VBlank.
+
+    @return 1 if the task was added, 0 if @ref NMI_TASK_MAX tasks are
+            already added or the transfer buffer would be left with too
+            little time for its longest stripe (39 units)
+
+    @see nmi_task_remove
+*/
+uint8_t nmi_task_add(nmi_task_t task, uint8_t cycles_x8);
+
+/** Removes a routine added with @ref nmi_task_add(), and gives its VBlank time back to the transfer buffer
+
+    While the tasks are changed, they are skipped if a VBlank happens.
+*/
+void nmi_task_remove(nmi_task_t task);
+
 /** Turns the display off.
 
     Waits until the VBL interrupt before turning the display off.
@@ -689,6 +825,23 @@ inline void set_bkg_based_tiles(uint8_t x, uint8_t y, uint8_t w, uint8_t h, cons
 void set_bkg_submap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *map, uint8_t map_w) OLDCALL;
 #define set_tile_submap set_bkg_submap
 
+/** Sets a rectangular area of the Background Tile Map using a sub-region
+    from a source tile map up to 65535 tiles wide.
+
+    Same as @ref set_bkg_submap() with 16 bit __x__, __y__ and __map_w__.
+    On this platform it writes the area with one @ref set_bkg_submap()
+    call per row.
+*/
+inline void set_bkg_submap16(uint16_t x, uint16_t y, uint8_t w, uint8_t h, const uint8_t *map, uint16_t map_w) {
+    const uint8_t * row = map + (y * map_w) + x;
+    uint8_t hx = x & (DEVICE_SCREEN_BUFFER_WIDTH - 1), hy = y % DEVICE_SCREEN_BUFFER_HEIGHT;
+    for (; h; h--, row += map_w) {
+        /* With a map width of 1 set_bkg_submap() reads from row - hx - hy + hy + hx */
+        set_bkg_submap(hx, hy, w, 1, row - hx - hy, 1);
+        if (++hy == DEVICE_SCREEN_BUFFER_HEIGHT) hy = 0;
+    }
+}
+
 
 extern uint8_t _submap_tile_offset;
 
@@ -864,6 +1017,43 @@ inline void SET_SHADOW_OAM_ADDRESS(void * address) {
     _shadow_OAM_base = (uint8_t)((uint16_t)address >> 8);
 }
 
+/** Enables double buffering of the shadow OAM
+
+    @param buffer Second shadow OAM, a 256-byte aligned array of 256 bytes in RAM
+
+    All sprite and metasprite functions keep writing @ref shadow_OAM.
+    @ref oam_double_buffer_swap() copies it into __buffer__ and the NMI
+    handler then transfers __buffer__ to the PPU, so the next frame can be
+    drawn into @ref shadow_OAM while the last one is on screen. Sprite
+    updates no longer need to be finished before VBlank to avoid tearing.
+    The sprites currently in @ref shadow_OAM are shown from the next frame on.
+
+    Calling it again without oam_double_buffer_disable() is not supported.
+
+    @see oam_double_buffer_swap, oam_double_buffer_disable, SET_SHADOW_OAM_ADDRESS
+*/
+void oam_double_buffer_enable(void * buffer);
+
+/** Copies @ref shadow_OAM into the double buffer, which the NMI handler
+    transfers to the PPU from then on
+
+    The OAM DMA is skipped while copying, the PPU then keeps showing the
+    sprites of the last frame. The copy takes about 4000 CPU cycles. Does
+    nothing if double buffering is not enabled.
+
+    @see oam_double_buffer_enable
+*/
+void oam_double_buffer_swap(void);
+
+/** Disables double buffering of the shadow OAM
+
+    The sprites which are on screen are copied back to @ref shadow_OAM,
+    which is then used for rendering and transfer again.
+
+    @see oam_double_buffer_enable
+*/
+void oam_double_buffer_disable(void);
+
 /** Sets sprite number __nb__in the OAM to display tile number __tile__.
 
     @param nb    Sprite number, range 0 - 63
@@ -977,6 +1167,54 @@ inline void hide_sprite(uint8_t nb) {
     shadow_OAM[nb].y = 240;
 }
 
+/** Moves __count__ sprites starting with sprite number __first__
+
+    @param first  First sprite number
+    @param count  Number of sprites
+    @param xy     The X and Y position of each sprite, one byte each
+
+    Same as calling @ref move_sprite() for each sprite, but the
+    shadow OAM address is only worked out once. Like the other sprite
+    functions it writes @ref shadow_OAM.
+
+    @see shadow_oam_write_block, SPRITE_PTR_DECLARE
+*/
+void move_sprites(uint8_t first, uint8_t count, const uint8_t * xy);
+
+/** Copies __count__ whole OAM entries into the shadow OAM, starting with sprite number __first__
+
+    @param first  First sprite number
+    @param count  Number of sprites
+    @param src    Entries to copy
+
+    Like @ref move_sprites() it writes @ref shadow_OAM.
+*/
+void shadow_oam_write_block(uint8_t first, uint8_t count, const OAM_item_t * src);
+
+/** Declares __p__ as a pointer to the shadow OAM entry of sprite __nb__
+
+    For loops which update a run of sprites: the pointer can stay in
+    registers and is moved on with @ref SPRITE_PTR_NEXT(), instead of
+    working out the address of each sprite from its number.
+    \code{.c}
+    SPRITE_PTR_DECLARE(spr, FIRST_BULLET);
+    for (uint8_t i = 0; i < bullet_count; i++) {
+        SPRITE_PTR_MOVE(spr, bullet_x[i], bullet_y[i]);
+        SPRITE_PTR_NEXT(spr);
+    }
+    \endcode
+    Like @ref move_sprite() these write @ref shadow_OAM.
+*/
+#define SPRITE_PTR_DECLARE(p, nb) OAM_item_t * p = (OAM_item_t *)&shadow_OAM[(nb)]
+/** Moves the sprite at __p__ to __x__, __y__, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_MOVE(p, x_, y_) ((p)->y = (y_), (p)->x = (x_))
+/** Sets the tile of the sprite at __p__, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_SET_TILE(p, t) ((p)->tile = (t))
+/** Sets the properties of the sprite at __p__, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_SET_PROP(p, a) ((p)->prop = (a))
+/** Moves __p__ on to the next sprite, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_NEXT(p) ((p)++)
+
 
 
 /** Copies arbitrary data to an address in VRAM
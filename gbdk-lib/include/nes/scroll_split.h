@@ -0,0 +1,115 @@
+/** @file nes/scroll_split.h
+
+    Scroll changes in the middle of the frame (NES)
+
+    A status bar which stays in place over a scrolling playfield
+    needs a different scroll position below a given line. The scroll
+    set with @ref move_bkg() is used from the top of the screen,
+    the functions here change it further down in one of two ways.
+
+    __Sprite 0 hit__ (any mapper): sprite 0 is placed over an opaque
+    background pixel at the line of the split, and the scroll changes
+    once the PPU reports the hit. @ref sprite0_split_wait() waits for
+    it, @ref sprite0_split_poll() only checks for it, so the game can
+    run short pieces of logic until it returns 1:
+    \code{.c}
+    move_bkg(0, 0);                 // HUD in the top 24 lines
+    sprite0_split_set(camera_x, 24); // Playfield below it
+    vsync();
+    while (!sprite0_split_poll()) {
+        update_next_enemy();
+    }
+    \endcode
+    The split happens at the first poll after the hit, so it lands up
+    to one piece of work late. Sprite 0 and the background have to be
+    shown for the hit to happen, otherwise sprite0_split_wait() never
+    returns. The rest of the line with the hit may already show the
+    new scroll.
+
+    __MMC3 scanline IRQ__ (`lcc -mapper=mmc3`): a table of lines and
+    scroll positions is applied by an interrupt handler, so the CPU
+    is free for the whole frame:
+    \code{.c}
+    scroll_split_t hud_split[] = {
+        { 24, 0, 24 },              // Playfield below the HUD
+        { SCROLL_SPLIT_END, 0, 0 }
+    };
+    mmc3_split_set_table(hud_split);
+    while (1) {
+        vsync();
+        hud_split[0].x = camera_x;
+    }
+    \endcode
+
+    The scroll is written with the `$2006` / `$2005` / `$2005` / `$2006`
+    sequence, so X and Y both change. Y is the row of the background
+    which is shown at the line of the split, not the row at the top
+    of the screen.
+
+    The two ways are not meant to be used in the same frame.
+*/
+
+#ifndef __SCROLL_SPLIT_H_INCLUDE
+#define __SCROLL_SPLIT_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Sets the scroll which @ref sprite0_split_wait() and @ref sprite0_split_poll() switch to
+
+    @param x   X scroll below the split
+    @param y   Background row shown at the line of the split (0 - 239)
+ */
+void sprite0_split_set(uint8_t x, uint8_t y);
+
+/** Waits for the sprite 0 hit, then switches to the scroll of @ref sprite0_split_set()
+
+    If the hit of the current frame already happened, this
+    waits for the one of the next frame.
+ */
+void sprite0_split_wait(void);
+
+/** Switches to the scroll of @ref sprite0_split_set() if sprite 0 was hit in this frame
+
+    @return 1 once the scroll was switched in this frame, 0 until then
+
+    Has to be called at least once between the end of VBlank
+    and the line of the split, otherwise the split is skipped
+    in that frame.
+ */
+uint8_t sprite0_split_poll(void);
+
+/** Line of the entry which ends a split table
+ */
+#define SCROLL_SPLIT_END 0xFF
+
+/** Scroll for the lines starting at __line__
+
+    Lines must be increasing, from 1 up to 239, and at
+    least 2 lines apart.
+ */
+typedef struct scroll_split_t {
+    uint8_t line;   /**< First line with this scroll, @ref SCROLL_SPLIT_END ends the table */
+    uint8_t x;      /**< X scroll */
+    uint8_t y;      /**< Background row shown at __line__ (0 - 239) */
+} scroll_split_t;
+
+/** Applies the scroll splits of __table__ from the next frame on (MMC3 only, `lcc -mapper=mmc3`)
+
+    @param table   Splits ending with @ref SCROLL_SPLIT_END, or NULL for no splits
+
+    The table is read during the frame, so it must be in RAM or in
+    the fixed bank and can be changed while it is shown (a change of
+    the line of an entry takes effect in the next frame).
+
+    The first call installs the IRQ handler and the NMI hook which
+    restarts the MMC3 scanline counter each frame, it waits for the
+    next VBlank to do so. The APU frame counter IRQ is switched off
+    and IRQs are enabled.
+
+    The background has to use the pattern table at $0000 and sprites
+    the one at $1000 (the default), which clocks the MMC3 counter.
+ */
+void mmc3_split_set_table(const scroll_split_t * table);
+
+#endif
@@ -80,4 +80,63 @@ void initarand(uint16_t seed) Z88DK_FASTCALL;
  */
 uint8_t arand(void) OLDCALL;
 
+/** Initializes the xorshift random number generator
+
+    @param seed    The value for initializing the generator. 0 is
+                   replaced with 1, since the state must not be 0.
+
+    Without a call the generator starts from a fixed seed.
+
+    @see initrand() for suggestions about seed values, xrand()
+*/
+void initxrand(uint16_t seed);
+
+/** The state of the xorshift generator, can be saved and restored
+    like @ref __rand_seed (but must not be set to 0)
+*/
+extern uint16_t __xrand_seed;
+
+/** Returns a random byte (8 bit) value from the xorshift generator
+
+    The generator does X ^= X << 7, X ^= X >> 9, X ^= X << 8 on a
+    16 bit state. It goes through all 65535 non zero states before
+    repeating, and its low bits are as random as the high ones,
+    unlike those of @ref rand(). It takes fewer cycles than @ref rand().
+
+    @see initxrand(), xrandw(), rand_fill(), rand_range()
+*/
+uint8_t xrand(void);
+
+/** Returns a random word (16 bit) value from the xorshift generator
+
+    @see xrand()
+*/
+uint16_t xrandw(void);
+
+/** Fills a buffer with random bytes from the xorshift generator
+
+    @param buf     Buffer to fill
+    @param n       Number of bytes
+
+    Uses both bytes of each step of the generator and keeps its
+    state in registers, so it is much faster per byte than calling
+    @ref xrand() in a loop.
+
+    @see xrand()
+*/
+void rand_fill(uint8_t * buf, uint16_t n);
+
+/** Returns a random number from 0 to __n__ - 1, from the xorshift
+    generator
+
+    @param n       Number of possible values, 0 for 256
+
+    Every value is equally likely: draws are masked to the bits
+    needed for __n__ - 1, and redrawn when they are __n__ or more,
+    which happens less than half of the time. No division is used.
+
+    @see xrand()
+*/
+uint8_t rand_range(uint8_t n);
+
 #endif
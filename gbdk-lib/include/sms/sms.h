@@ -90,6 +90,48 @@
 void WRITE_VDP_CMD(uint16_t cmd) Z88DK_FASTCALL PRESERVES_REGS(b, c, d, e, iyh, iyl);
 void WRITE_VDP_DATA(uint16_t data) Z88DK_FASTCALL PRESERVES_REGS(b, c, d, e, iyh, iyl);
 
+/** VDP registers changed with @ref VDP_REG_SET() which @ref vdp_regs_commit() has not written yet, bit n for register n
+*/
+extern volatile uint16_t vdp_regs_dirty;
+
+/** Changes VDP register __REG__ (VDP_R0 - VDP_R10, see hardware.h) in its shadow only
+
+    The register is written by the next @ref vdp_regs_commit(), and
+    only if the value differs from the one in the shadow. Several
+    changes in a row cost one write. Unlike the functions which write
+    registers at once, it does not disable interrupts.
+    \code{.c}
+    VDP_REG_SET(VDP_RSCX, -camera_x);
+    VDP_REG_SET(VDP_RSCY, camera_y);
+    VDP_REG_SET(VDP_R1, shadow_VDP_R1 | R1_SPR_8X16);
+    \endcode
+*/
+#define VDP_REG_SET(REG, v) \
+    do { \
+        uint8_t __vdp_reg_v = (v); \
+        if (shadow_##REG != __vdp_reg_v) { \
+            shadow_##REG = __vdp_reg_v; \
+            vdp_regs_dirty |= (uint16_t)(1u << ((REG) & 0x0Fu)); \
+        } \
+    } while(0)
+
+/** Writes the VDP registers changed with @ref VDP_REG_SET()
+
+    Meant to be called from a VBlank or line interrupt handler, so
+    all changes of a frame or a raster effect take effect at the
+    same line:
+    \code{.c}
+    add_VBL(vdp_regs_commit);
+    \endcode
+    It can also be called from the main code, with interrupts disabled
+    during the writes.
+
+    Does nothing while the interrupted code is writing to the VDP
+    (see @ref _shadow_OAM_OFF), the registers are written by the
+    next call then.
+*/
+void vdp_regs_commit(void) PRESERVES_REGS(iyh, iyl);
+
 /** Set the current screen mode - one of M_* modes
 
     Normally used by internal functions only.
@@ -243,6 +285,10 @@ inline void display_off(void) {
 	display_off();
 
 /** Copies data from shadow OAM to OAM
+
+    Only the first @ref _shadow_OAM_count sprites are copied, see
+    @ref SET_SHADOW_OAM_COUNT(). The copy is faster while the display
+    is off or during VBlank.
  */
 void refresh_OAM(void);
 
@@ -374,6 +420,25 @@ __endasm; \
 
 #define SWITCH_ROM2(b) MAP_FRAME2=(b)
 
+/** Switches the ROM bank in slot 1 (0x4000 - 0x7FFF), where banked code (`_CODE_n` areas) runs
+    @param b   ROM bank to switch to
+*/
+#define SWITCH_ROM_SLOT1(b) SWITCH_ROM1(b)
+
+/** Switches the ROM bank in slot 2 (0x8000 - 0xBFFF), where banked data (`_LIT_n` areas) is read
+    @param b   ROM bank to switch to
+
+    bankpack never places `_CODE_n` and `_LIT_n` areas in the same bank, so
+    banked code in slot 1 can read assets of another bank through slot 2.
+
+    @see vmemcpy_banked()
+*/
+#define SWITCH_ROM_SLOT2(b) SWITCH_ROM2(b)
+
+/** Tracks current active ROM bank in slot 2
+*/
+#define CURRENT_BANK_SLOT2 MAP_FRAME2
+
 /** Switches RAM bank
     @param b   SRAM bank to switch to
 */
@@ -532,6 +597,23 @@ inline void set_sprite_4bpp_data(uint16_t start, uint16_t ntiles, const void *sr
     set_native_tile_data((uint8_t)(start) + 0x100u, ntiles, src);
 }
 
+/** Loads native 4bpp tiles into VRAM at full VDP speed
+
+    @param start     Index of the first tile (sprite tiles start at 256)
+    @param ntiles    Number of tiles
+    @param src       Pointer to the 4bpp tile data, 32 bytes per tile
+
+    Same as set_native_tile_data(), but the data is written with
+    an unrolled `outi` block which is faster than the VDP accepts
+    while it draws the screen, so only use it during VBlank or with
+    the display off (@ref DISPLAY_OFF).
+
+    Tiles converted with png2asset `-expand_4bpp` are loaded with
+    this or set_native_tile_data() instead of the 2bpp to 4bpp
+    conversion of @ref set_bkg_data().
+*/
+void set_native_tile_data_fast(uint16_t start, uint16_t ntiles, const void *src) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
+
 #define COMPAT_PALETTE(C0,C1,C2,C3) (((uint16_t)(C3) << 12) | ((uint16_t)(C2) << 8) | ((uint16_t)(C1) << 4) | (uint16_t)(C0))
 extern uint16_t _current_2bpp_palette;
 inline void set_2bpp_palette(uint16_t palette) {
@@ -575,6 +657,22 @@ inline void set_sprite_1bpp_data(uint16_t start, uint16_t ntiles, const void *sr
 void set_data(uint16_t dst, const void *src, uint16_t size) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
 void vmemcpy(uint16_t dst, const void *src, uint16_t size) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
 
+/** Copies data from a ROM bank to an address in VRAM
+
+    @param dst       destination VRAM Address
+    @param src       Pointer to source buffer, in slot 2 (0x8000 - 0xBFFF)
+    @param size      Number of bytes to copy
+    @param bank      ROM bank of __src__, for example `BANK(asset)` for data in a `_LIT_n` area
+
+    Like @ref vmemcpy(), except that __bank__ is switched into slot 2 for the
+    copy and the previous bank of slot 2 is restored after it. Banked code in
+    slot 1 can stream large assets from other banks this way, without copying
+    them through a RAM buffer first.
+
+    @see SWITCH_ROM_SLOT2
+*/
+void vmemcpy_banked(uint16_t dst, const void *src, uint16_t size, uint8_t bank) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
+
 void set_tile_map(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *tiles) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
 void set_tile_map_compat(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *tiles) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
 #define set_bkg_tiles set_tile_map_compat
@@ -608,6 +706,26 @@ inline void set_win_submap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uin
     set_tile_submap_compat(x, y, w, h, map_w, map);
 }
 
+/** Sets a rectangular area of the Background Tile Map using a sub-region
+    from a source tile map up to 65535 tiles wide.
+
+    Same as @ref set_bkg_submap() with 16 bit __x__, __y__ and __map_w__.
+    On this platform it writes the area with one @ref set_bkg_submap()
+    call per row.
+*/
+inline void set_bkg_submap16(uint16_t x, uint16_t y, uint8_t w, uint8_t h, const uint8_t *map, uint16_t map_w) {
+    const uint8_t * row = map + (y * map_w) + x;
+    uint8_t hx = x & (DEVICE_SCREEN_BUFFER_WIDTH - 1), hy = y % DEVICE_SCREEN_BUFFER_HEIGHT;
+    for (; h; h--, row += map_w) {
+        /* With a map width of 1 set_bkg_submap() reads from row - hx - hy + hy + hx */
+        set_bkg_submap(hx, hy, w, 1, row - hx - hy, 1);
+        if (++hy == DEVICE_SCREEN_BUFFER_HEIGHT) hy = 0;
+    }
+}
+inline void set_win_submap16(uint16_t x, uint16_t y, uint8_t w, uint8_t h, const uint8_t *map, uint16_t map_w) {
+    set_bkg_submap16(x, y, w, h, map, map_w);
+}
+
 extern uint8_t _submap_tile_offset;
 inline void set_bkg_based_submap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *map, uint8_t map_w, uint8_t base_tile) {
     _submap_tile_offset = base_tile;
@@ -627,6 +745,15 @@ inline void set_bkg_submap_attributes(uint8_t x, uint8_t y, uint8_t w, uint8_t h
     VBK_REG = VBK_TILES;
 }
 
+/** Fills a rectangle of the tile map with the map entry __tile__ (tile and attributes)
+
+    While the display is off, the VDP is written at full speed.
+    A rectangle as wide as the tile map (32) fills whole rows, which
+    are written without setting the VDP address for each row, the
+    fastest way to clear the screen or a large region.
+
+    @ref fill_bkg_rect() only writes the tile and keeps the attributes.
+*/
 void fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint16_t tile) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
 void fill_rect_compat(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint16_t tile) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
 #define fill_bkg_rect fill_rect_compat
@@ -694,6 +821,79 @@ inline void SET_SHADOW_OAM_ADDRESS(void * address) {
     _shadow_OAM_base = (uint8_t)((uint16_t)address >> 8);
 }
 
+/** Number of sprites copied from shadow OAM to OAM, @ref MAX_HARDWARE_SPRITES by default
+*/
+extern volatile uint8_t _shadow_OAM_count;
+
+/** Sets the number of sprites in use, which are copied from shadow OAM to OAM
+
+    @param count Number of sprites, 0 to @ref MAX_HARDWARE_SPRITES
+
+    With a __count__ below @ref MAX_HARDWARE_SPRITES the VBlank copy and
+    @ref refresh_OAM() only write the Y coordinates of the sprites in use and a
+    terminator, then their X coordinates and tiles,
+    which ends the sprite list for the VDP. That makes the
+    copy shorter and the sprites from __count__ onwards don't have to
+    be hidden, for example:
+    \code{.c}
+    SET_SHADOW_OAM_COUNT(move_metasprite_ex(player_metasprite, 0, 0, 0, x, y));
+    \endcode
+
+    The Y coordinate 0xD0 ends the sprite list as well, so it can't be used
+    for the sprites in use. With double buffering set the count together with
+    @ref oam_double_buffer_swap(), for the buffer that gets shown.
+*/
+inline void SET_SHADOW_OAM_COUNT(uint8_t count) {
+    _shadow_OAM_count = count;
+}
+
+/** Enables double buffering of the shadow OAM
+
+    @param buffer Second shadow OAM, a 256-byte aligned array of at
+                  least 192 bytes in RAM
+
+    The sprites currently in @ref shadow_OAM are copied into __buffer__,
+    and the metasprite functions and @ref hide_sprites_range() then render
+    into __buffer__ (through `__render_shadow_OAM`) while the VBlank handler
+    keeps transferring @ref shadow_OAM. @ref oam_double_buffer_swap() shows
+    the new frame and flips the two buffers, so sprite updates no longer
+    need to be finished before VBlank to avoid tearing.
+
+    @note @ref set_sprite_tile(), @ref move_sprite() and the other single
+    sprite functions always write @ref shadow_OAM, use the metasprite
+    functions or write through `__render_shadow_OAM` instead.
+
+    Calling it again without oam_double_buffer_disable() is not supported.
+
+    @see oam_double_buffer_swap, oam_double_buffer_disable, SET_SHADOW_OAM_ADDRESS
+*/
+void oam_double_buffer_enable(void * buffer);
+
+/** Shows the shadow OAM which has just been rendered from the next VBlank on,
+    and makes the other one the render buffer
+
+    This is a single byte write, the VBlank handler either transfers the
+    old or the new buffer but never one which is half way through an update.
+    Call it once all the sprites for a frame are in place, there is no need
+    to wait for VBlank before or after. It also enables the OAM transfer if
+    it was disabled with @ref DISABLE_VBL_TRANSFER.
+
+    The new render buffer holds the frame before last, so every sprite has
+    to be drawn or hidden again each frame.
+
+    @see oam_double_buffer_enable
+*/
+void oam_double_buffer_swap(void);
+
+/** Disables double buffering of the shadow OAM
+
+    The sprites which are on screen are copied back to @ref shadow_OAM,
+    which is then used for rendering and transfer again.
+
+    @see oam_double_buffer_enable
+*/
+void oam_double_buffer_disable(void);
+
 /** Sets sprite number __nb__in the OAM to display tile number __tile__.
 
     @param nb    Sprite number, range 0 - 39
@@ -777,6 +977,66 @@ inline void hide_sprite(uint8_t nb) {
     shadow_OAM[nb] = 0xC0;
 }
 
+/** A sprite for @ref shadow_oam_write_block()
+ */
+typedef struct OAM_item_t {
+    uint8_t y;      /**< Y position */
+    uint8_t x;      /**< X position */
+    uint8_t tile;   /**< Tile */
+} OAM_item_t;
+
+/** Moves __count__ sprites starting with sprite number __first__
+
+    @param first  First sprite number
+    @param count  Number of sprites
+    @param xy     The X and Y position of each sprite, one byte each
+
+    Same as calling @ref move_sprite() for each sprite, but the
+    shadow OAM address is only worked out once. Like the metasprite
+    functions it writes the shadow OAM which is being rendered (see
+    @ref oam_double_buffer_enable()).
+
+    @see shadow_oam_write_block, SPRITE_PTR_DECLARE
+*/
+void move_sprites(uint8_t first, uint8_t count, const uint8_t * xy) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
+
+/** Sets the position and tile of __count__ sprites, starting with sprite number __first__
+
+    @param first  First sprite number
+    @param count  Number of sprites
+    @param src    Position and tile of each sprite
+
+    Like @ref move_sprites() it writes the shadow OAM which is being rendered.
+*/
+void shadow_oam_write_block(uint8_t first, uint8_t count, const OAM_item_t * src) Z88DK_CALLEE PRESERVES_REGS(iyh, iyl);
+
+/** Declares __p__ as a pointer to the shadow OAM entries of sprite __nb__
+
+    For loops which update a run of sprites: the pointers (one into
+    the Y table and one into the X and tile table) can stay in
+    registers and are moved on with @ref SPRITE_PTR_NEXT(), instead of
+    working out the addresses of each sprite from its number.
+    \code{.c}
+    SPRITE_PTR_DECLARE(spr, FIRST_BULLET);
+    for (uint8_t i = 0; i < bullet_count; i++) {
+        SPRITE_PTR_MOVE(spr, bullet_x[i], bullet_y[i]);
+        SPRITE_PTR_NEXT(spr);
+    }
+    \endcode
+    Like @ref move_sprite() these write @ref shadow_OAM.
+*/
+#define SPRITE_PTR_DECLARE(p, nb) \
+    uint8_t * p##_y = (uint8_t *)&shadow_OAM[(nb)]; \
+    uint8_t * p##_xt = (uint8_t *)&shadow_OAM[0x40 + ((nb) << 1)]
+/** Moves the sprite at __p__ to __x__, __y__, see @ref SPRITE_PTR_DECLARE() (__y__ is evaluated twice) */
+#define SPRITE_PTR_MOVE(p, x_, y_) (*(p##_y) = ((y_) < VDP_SAT_TERM) ? (y_) : 0xC0, *(p##_xt) = (x_))
+/** Sets the tile of the sprite at __p__, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_SET_TILE(p, t) ((p##_xt)[1] = (t))
+/** Does nothing, there are no sprite properties on the SMS/GG */
+#define SPRITE_PTR_SET_PROP(p, a)
+/** Moves __p__ on to the next sprite, see @ref SPRITE_PTR_DECLARE() */
+#define SPRITE_PTR_NEXT(p) (p##_y++, p##_xt += 2)
+
 /**
  * Set byte in vram at given memory location
  *
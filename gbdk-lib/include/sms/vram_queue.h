@@ -0,0 +1,103 @@
+/** @file sms/vram_queue.h
+
+    Deferred VRAM writes
+
+    Instead of writing to the VDP right away at the timing safe
+    speed (as @ref set_tile_map(), @ref set_data(), etc do, each
+    of them switching the VBlank shadow OAM copy off and on),
+    writes are queued in a 256 byte ring buffer and written to
+    VRAM during VBlank by @ref vram_queue_isr() with the unrolled
+    `outi` block. This suits GUIs updating many small areas of the
+    tile map each frame.
+
+    Install the handler once during startup:
+    \code{.c}
+    CRITICAL {
+        add_VBL(vram_queue_isr);
+    }
+    \endcode
+
+    Then queue writes at any time, for example a window of tiles:
+    \code{.c}
+    vram_queue_set_tile_map(2, 20, 10, 3, menu_tiles);
+    \endcode
+
+    Writes are copied in the order they were queued. Each
+    VBlank copies at most @ref vram_queue_budget bytes, anything
+    left over is copied during the following VBlanks.
+
+    @note The queue functions must not be called from interrupt
+    handlers, and must not be called with interrupts disabled
+    (they may wait for the VBlank handler to make room in the queue).
+*/
+
+#ifndef __VRAM_QUEUE_H_INCLUDE
+#define __VRAM_QUEUE_H_INCLUDE
+
+#include <types.h>
+#include <stdint.h>
+
+/** Writes longer than this are split into several queue entries (stripes)
+ */
+#define VRAM_QUEUE_STRIPE_MAX 64
+
+/** Default of @ref vram_queue_budget
+ */
+#define VRAM_QUEUE_BUDGET     192
+
+/** Maximum number of bytes copied to VRAM by each call of @ref vram_queue_isr()
+
+    Defaults to @ref VRAM_QUEUE_BUDGET bytes, which with the shadow OAM
+    copy fits in a single NTSC VBlank. Each stripe also counts as 8
+    bytes to account for its setup time.
+
+    Lower it if other VBlank handlers need more time, or raise it
+    for faster transfers (for example on PAL systems).
+    At least one stripe is always copied per VBlank.
+ */
+extern uint8_t vram_queue_budget;
+
+/** Queues a write of __len__ bytes from __src__ to VRAM address __dst__
+
+    @param dst   Destination address in VRAM, for example from @ref get_bkg_xy_addr()
+    @param src   Pointer to source data
+    @param len   Number of bytes to write
+
+    The data is copied into the queue, so __src__ can be
+    reused as soon as this returns.
+
+    Waits for room in the queue if it is full.
+
+    @see vram_queue_set_tile_map(), vram_queue_flush(), vram_queue_isr()
+*/
+void vram_queue_write(uint8_t * dst, const uint8_t * src, uint16_t len);
+
+/** Queues a write of a rectangle of tile map entries, like @ref set_tile_map()
+
+    @param x      X start position in the tile map, in tiles
+    @param y      Y start position in the tile map, in tiles
+    @param w      Width of the area, 1 to 32
+    @param h      Height of the area
+    @param tiles  Tile map entries, 2 bytes each, __w__ * __h__ of them
+
+    Wraps around the edges of the tile map the same way
+    @ref set_tile_map() does. Each row and each part of a row on
+    either side of the right edge is a stripe.
+*/
+void vram_queue_set_tile_map(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * tiles);
+
+/** Waits until everything in the queue has been written to VRAM
+*/
+void vram_queue_flush(void);
+
+/** VBlank handler which copies queued writes to VRAM
+
+    Install it with @ref add_VBL(). It does nothing while the
+    interrupted code is writing to the VDP (see @ref _shadow_OAM_OFF),
+    the queue is copied during the next VBlank then.
+
+    @see vram_queue_budget
+*/
+void vram_queue_isr(void);
+
+#endif
@@ -5,6 +5,7 @@
 #define STDLIB_INCLUDE
 
 #include <types.h>
+#include <stdint.h>
 
 #if !defined(__SDCC_mcs51) && !defined(__SDCC_ds390) && !defined(__SDCC_ds400) && !defined(__SDCC_hc08) && !defined(__SDCC_s08) && !defined(__SDCC_mos6502) && !defined(__SDCC_mos65c02) && !defined(__SDCC_pic14) && !defined(__SDCC_pic16) && !defined(__SDCC_pdk13) && !defined(__SDCC_pdk14) && !defined(__SDCC_pdk15)
 #define __reentrant
@@ -143,6 +144,53 @@ extern void free (void * ptr);
 */
 extern void *bsearch(const void *key, const void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *) __reentrant);
 
+/** Value returned by @ref bsearch_u8() when the key is not found */
+#define BSEARCH_U8_NONE  0xFFu
+/** Value returned by @ref bsearch_u16() when the key is not found */
+#define BSEARCH_U16_NONE 0xFFFFu
+
+/** Search a table of up to 255 unsigned 8 bit keys in Eytzinger order
+    @param key   Key to search for
+    @param keys  Keys, as written by @ref utility_table2asset "table2asset"
+    @param n     Number of keys
+
+    The keys are compared directly instead of through a compare function.
+    They are not sorted, but stored like a binary tree by levels: the
+    children of the key at index i are at 2 * i + 1 and 2 * i + 2, with
+    the smaller keys on the left. table2asset writes a sorted list of
+    keys in this order, and values which go with them in the same order:
+    \code{.c}
+    // table2asset items.txt -c res/items.c
+    uint8_t i = bsearch_u8(item_id, items_keys, items_COUNT);
+    if (i != BSEARCH_U8_NONE)
+        use_item(items_values[i]);
+    \endcode
+
+    @return Index of __key__ in __keys__, or @ref BSEARCH_U8_NONE if it is not there
+
+    @see bsearch_u16
+*/
+#if defined(__PORT_z80)
+extern uint8_t bsearch_u8(uint8_t key, const uint8_t *keys, uint8_t n) Z88DK_CALLEE;
+#else
+extern uint8_t bsearch_u8(uint8_t key, const uint8_t *keys, uint8_t n);
+#endif
+
+/** Search a table of up to 32767 unsigned 16 bit keys in Eytzinger order
+    @param key   Key to search for
+    @param keys  Keys, as written by @ref utility_table2asset "table2asset"
+    @param n     Number of keys
+
+    Same as @ref bsearch_u8() for 16 bit keys, such as dialogue ids.
+
+    @return Index of __key__ in __keys__, or @ref BSEARCH_U16_NONE if it is not there
+*/
+#if defined(__PORT_z80)
+extern uint16_t bsearch_u16(uint16_t key, const uint16_t *keys, uint16_t n) Z88DK_CALLEE;
+#else
+extern uint16_t bsearch_u16(uint16_t key, const uint16_t *keys, uint16_t n);
+#endif
+
 
 /** Sort an array of __nmemb__ items
     @param base     Pointer to first object in the array to sort
@@ -152,4 +200,78 @@ extern void *bsearch(const void *key, const void *base, size_t nmemb, size_t siz
 */
 extern void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *) __reentrant);
 
+/** Sort an array of __nmemb__ items, faster for larger arrays
+    @param base     Pointer to first object in the array to sort
+    @param nmemb    Number of elements in the array
+    @param size     Size in bytes of each element in the array
+    @param compar   Function used to compare and sort two elements of the array
+
+    Same as @ref qsort(), but uses a Shell sort and swaps elements
+    16 bits at a time when __size__ is even. It is larger than
+    @ref qsort(), which is a plain insertion sort and is usually
+    faster only for a handful of elements.
+
+    Like @ref qsort() it is not stable: elements which compare equal
+    may end up in any order.
+*/
+extern void qsort_fast(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *) __reentrant);
+
+/** Sort an array of __nmemb__ items by an unsigned 8 bit key
+    @param base        Pointer to first object in the array to sort
+    @param nmemb       Number of elements in the array
+    @param size        Size in bytes of each element in the array
+    @param key_offset  Offset in bytes of the key within each element
+
+    Sorts the elements in ascending order of the uint8_t at
+    __key_offset__, without calling a compare function.
+    For example, to sort sprites by their Y position:
+    \code{.c}
+    qsort_u8_key(objects, count, sizeof(object_t), offsetof(object_t, y));
+    \endcode
+
+    @see qsort_fast, qsort_u16_key
+*/
+extern void qsort_u8_key(void *base, size_t nmemb, size_t size, size_t key_offset);
+
+/** Sort an array of __nmemb__ items by an unsigned 16 bit key
+    @param base        Pointer to first object in the array to sort
+    @param nmemb       Number of elements in the array
+    @param size        Size in bytes of each element in the array
+    @param key_offset  Offset in bytes of the key within each element
+
+    Same as @ref qsort_u8_key() for a uint16_t key.
+*/
+extern void qsort_u16_key(void *base, size_t nmemb, size_t size, size_t key_offset);
+
+/** Sort up to 255 unsigned 8 bit keys with a counting sort
+    @param order   Array of __n__ bytes which receives the sorted indices
+    @param keys    Pointer to the first key
+    @param n       Number of keys
+    @param stride  Distance in bytes from one key to the next (1 for a plain array)
+
+    Writes the indices 0 .. __n__ - 1 of the keys to __order__ in
+    ascending order of their key. The sort is stable: indices with
+    equal keys stay in their original order. The keys themselves
+    are not moved.
+
+    It takes two passes over the keys and two over a 256 entry count
+    table, instead of the n * n steps of an insertion sort, so it is the
+    fastest way to order sprites by depth every frame. For example,
+    with the Y coordinate of the OAM entries as the key:
+    \code{.c}
+    uint8_t order[40];
+    sort_u8_order(order, (const uint8_t *)&shadow_OAM[0].y, 40, sizeof(OAM_item_t));
+    \endcode
+
+    The count table is a static 256 byte buffer, so the function is
+    not reentrant.
+
+    @see qsort_u8_key
+*/
+#if defined(__PORT_z80)
+extern void sort_u8_order(uint8_t *order, const uint8_t *keys, uint8_t n, uint8_t stride) Z88DK_CALLEE;
+#else
+extern void sort_u8_order(uint8_t *order, const uint8_t *keys, uint8_t n, uint8_t stride);
+#endif
+
 #endif
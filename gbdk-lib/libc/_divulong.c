@@ -39,7 +39,19 @@
 #  endif
 #endif
 
-#if defined _DIVULONG_ASM_SMALL
+#if defined(__SDCC_sm83) || defined(__SDCC_z80)
+
+/* The sm83 and z80 divide is in libc/asm/<port>/divlong.s */
+void _divulong_ptr(unsigned long *x, unsigned long *y);
+
+unsigned long
+_divulong (unsigned long a, unsigned long b)
+{
+  _divulong_ptr(&a, &b);
+  return a;
+}
+
+#elif defined _DIVULONG_ASM_SMALL
 
 static void
 _divlong_dummy (void) _naked
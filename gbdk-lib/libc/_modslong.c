@@ -26,6 +26,18 @@
    might be covered by the GNU General Public License.
 -------------------------------------------------------------------------*/
 
+#if defined(__SDCC_sm83) || defined(__SDCC_z80)
+
+/* The sm83 and z80 divide is in libc/asm/<port>/divlong.s */
+void _divslong_ptr(long *x, long *y);
+
+long _modslong (long a, long b) {
+    _divslong_ptr(&a, &b);
+    return b;
+}
+
+#else
+
 unsigned long _modulong (unsigned long a, unsigned long b);
 
 long _modslong (long a, long b) {
@@ -33,3 +45,5 @@ long _modslong (long a, long b) {
     r = _modulong((a < 0 ? -a : a), (b < 0 ? -b : b));
     return ( (a < 0) ^ (b < 0)) ? -r : r;
 }
+
+#endif
@@ -27,6 +27,19 @@
    might be covered by the GNU General Public License.
 -------------------------------------------------------------------------*/
 
+#if defined(__SDCC_sm83) || defined(__SDCC_z80)
+
+/* The sm83 and z80 divide is in libc/asm/<port>/divlong.s */
+void _divulong_ptr(unsigned long *x, unsigned long *y);
+
+unsigned long _modulong (unsigned long a, unsigned long b)
+{
+  _divulong_ptr(&a, &b);
+  return b;
+}
+
+#else
+
 #define MSB_SET(x) ((x >> (8*sizeof(x)-1)) & 1)
 
 unsigned long _modulong (unsigned long a, unsigned long b)
@@ -53,3 +66,5 @@ unsigned long _modulong (unsigned long a, unsigned long b)
 
   return a;
 }
+
+#endif
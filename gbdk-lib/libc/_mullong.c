@@ -28,6 +28,19 @@
 -------------------------------------------------------------------------*/
 
 
+#if defined(__SDCC_sm83) || defined(__SDCC_z80)
+
+/* The sm83 and z80 multiply is in libc/asm/<port>/mullong.s */
+void _mullong_ptr(long *a, const long *b);
+
+long _mullong (long a, long b)
+{
+  _mullong_ptr(&a, &b);
+  return a;
+}
+
+#else
+
 struct some_struct {
 	short a ;
 	char b;
@@ -89,3 +102,5 @@ long _mullong (long a, long b)
 
   return a + b;
 }
+
+#endif
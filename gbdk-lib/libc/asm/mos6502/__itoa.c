@@ -39,10 +39,35 @@
  radix  ->  Base of value (e.g.: 2 for binary, 10 for decimal, 16 for hex)
 ---------------------------------------------------------------------------*/
 
+/* Decimal digits are found by repeated subtraction, which is much
+   faster than dividing by 10 for each digit */
+static const unsigned int pow10[] = { 10000, 1000, 100, 10 };
+
+static void __uitoa_dec(unsigned int value, char* string)
+{
+  const unsigned int *pw = pow10;
+  char d, started = 0;
+
+  for (; pw != pow10 + 4; pw++) {
+    for (d = '0'; value >= *pw; d++) value -= *pw;
+    if ((d != '0') || started) {
+      *string++ = d;
+      started = 1;
+    }
+  }
+  *string++ = '0' + value;
+  *string = '\0';
+}
+
 void __uitoa(unsigned int value, char* string, unsigned char radix)
 {
   signed char index = 0, i = 0;
 
+  if (radix == 10) {
+    __uitoa_dec(value, string);
+    return;
+  }
+
   /* generate the number in reverse order */
   do {
     string[index] = '0' + (value % radix);
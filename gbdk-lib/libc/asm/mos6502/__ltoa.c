@@ -0,0 +1,69 @@
+#include <stdlib.h>
+
+/* ltoa() and ultoa() for mos6502, the other ports have them in asm
+
+   Decimal digits are found by repeated subtraction, which is much
+   faster than a 32 bit division for each digit */
+
+static const unsigned long pow10[] = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL
+};
+
+static void __ultoa(unsigned long value, char* string, unsigned char radix)
+{
+  signed char index = 0, i = 0;
+
+  if (radix == 10) {
+    const unsigned long *pw = pow10;
+    char d, started = 0;
+
+    for (; pw != pow10 + 9; pw++) {
+      for (d = '0'; value >= *pw; d++) value -= *pw;
+      if ((d != '0') || started) {
+        *string++ = d;
+        started = 1;
+      }
+    }
+    *string++ = '0' + (char)value;
+    *string = '\0';
+    return;
+  }
+
+  /* generate the number in reverse order */
+  do {
+    string[index] = '0' + (value % radix);
+    if (string[index] > '9')
+        string[index] += 'A' - '9' - 1;
+    value /= radix;
+    ++index;
+  } while (value != 0);
+
+  /* null terminate the string */
+  string[index--] = '\0';
+
+  /* reverse the order of digits */
+  while (index > i) {
+    char tmp = string[i];
+    string[i] = string[index];
+    string[index] = tmp;
+    ++i;
+    --index;
+  }
+}
+
+char *ultoa(unsigned long value, char *string, unsigned char radix) OLDCALL
+{
+    __ultoa(value, string, radix);
+    return string;
+}
+
+char *ltoa(long value, char *string, unsigned char radix) OLDCALL
+{
+  char* s = string;
+  if (value < 0 && radix == 10) {
+    *string++ = '-';
+    value = -value;
+  }
+  __ultoa(value, string, radix);
+  return s;
+}
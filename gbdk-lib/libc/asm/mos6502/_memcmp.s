@@ -0,0 +1,80 @@
+;-------------------------------------------------------------------------
+;   _memcmp.s - standard C library function
+;
+;   Whole pages are compared two bytes per loop, like __memcpy.s
+;-------------------------------------------------------------------------
+
+	.module _memcmp
+
+;--------------------------------------------------------
+; exported symbols
+;--------------------------------------------------------
+	.globl _memcmp_PARM_2
+	.globl _memcmp_PARM_3
+	.globl _memcmp
+
+;--------------------------------------------------------
+; overlayable function paramters in zero page
+;--------------------------------------------------------
+	.area	OSEG    (PAG, OVR)
+_memcmp_PARM_2:
+	.ds 2
+_memcmp_PARM_3:
+	.ds 2
+
+;--------------------------------------------------------
+; local aliases
+;--------------------------------------------------------
+	.define buf1  "___SDCC_m6502_ret0"
+	.define buf2  "_memcmp_PARM_2"
+	.define count "_memcmp_PARM_3"
+
+;--------------------------------------------------------
+; code
+;--------------------------------------------------------
+	.area _CODE
+
+_memcmp:
+	sta	*buf1+0
+	stx	*buf1+1
+
+	ldy	#0
+	ldx	*count+1
+	beq	L2
+L1:
+	lda	[*buf1],y
+	cmp	[*buf2],y
+	bne	diff
+	iny
+	lda	[*buf1],y
+	cmp	[*buf2],y
+	bne	diff
+	iny
+	bne	L1
+	inc	*buf1+1
+	inc	*buf2+1
+	dex
+	bne	L1
+L2:
+	ldx	*count+0
+	beq	equal
+L3:
+	lda	[*buf1],y
+	cmp	[*buf2],y
+	bne	diff
+	iny
+	dex
+	bne	L3
+equal:
+	lda	#0
+	tax
+	rts
+diff:
+	bcs	greater
+	lda	#0xFF
+	tax
+	rts
+greater:
+	lda	#0x01
+	ldx	#0
+	rts
@@ -0,0 +1,103 @@
+;-------------------------------------------------------------------------
+;   _memset.s - standard C library function
+;
+;   The bytes of the partial page are stored first, with Y counting up
+;   to 0 from 256 - (count & 0xFF) so no separate counter is needed.
+;   Then whole pages are stored four bytes per loop.
+;-------------------------------------------------------------------------
+
+	.module _memset
+
+;--------------------------------------------------------
+; exported symbols
+;--------------------------------------------------------
+	.globl _memset_PARM_2
+	.globl _memset_PARM_3
+	.globl _memset
+
+;--------------------------------------------------------
+; overlayable function paramters in zero page
+;--------------------------------------------------------
+	.area	OSEG    (PAG, OVR)
+_memset_PARM_2:
+	.ds 2
+_memset_PARM_3:
+	.ds 2
+
+;--------------------------------------------------------
+; local aliases
+;--------------------------------------------------------
+	.define save  "___SDCC_m6502_ret0"
+	.define dst   "___SDCC_m6502_ret2"
+	.define value "_memset_PARM_2"
+	.define count "_memset_PARM_3"
+
+;--------------------------------------------------------
+; code
+;--------------------------------------------------------
+	.area _CODE
+
+_memset:
+	sta	*save+0
+	stx	*save+1
+	; dst = s + (count & 0xFF) - 256
+	clc
+	adc	*count+0
+	sta	*dst+0
+	txa
+	adc	#0xFF
+	sta	*dst+1
+	; Y = 256 - (count & 0xFF)
+	lda	*count+0
+	eor	#0xFF
+	tay
+	iny
+
+	; count & 3 single bytes
+	lda	*count+0
+	and	#3
+	tax
+	lda	*value
+	cpx	#0
+	beq	L2
+L1:
+	sta	[*dst],y
+	iny
+	dex
+	bne	L1
+L2:
+	; the rest of the partial page, (256 - Y) is a multiple of 4
+	cpy	#0
+	beq	L4
+L3:
+	sta	[*dst],y
+	iny
+	sta	[*dst],y
+	iny
+	sta	[*dst],y
+	iny
+	sta	[*dst],y
+	iny
+	bne	L3
+L4:
+	; whole pages, Y is 0
+	inc	*dst+1
+	ldx	*count+1
+	beq	done
+L5:
+	sta	[*dst],y
+	iny
+	sta	[*dst],y
+	iny
+	sta	[*dst],y
+	iny
+	sta	[*dst],y
+	iny
+	bne	L5
+	inc	*dst+1
+	dex
+	bne	L5
+done:
+	lda	*save+0
+	ldx	*save+1
+	rts
@@ -29,13 +29,18 @@
 
 #include <string.h>
 
-/* Generic routine */
+/* Tests four characters per loop, the length is taken from the end pointer */
 int strlen ( const char * str ) OLDCALL
 {
-  register int i = 0 ;
+  register const char * s = str;
 
-  while (*str++)
-    i++ ;
+  for (;;) {
+    if (!s[0]) break;
+    if (!s[1]) { s += 1; break; }
+    if (!s[2]) { s += 2; break; }
+    if (!s[3]) { s += 3; break; }
+    s += 4;
+  }
 
-  return i;
+  return s - str;
 }
@@ -0,0 +1,100 @@
+;-------------------------------------------------------------------------
+;   bsearch_u16.s - search of a key table in Eytzinger order, see bsearch_u16() in stdlib.h
+;
+;   The index i counts from 1, so the children of i are 2 * i and
+;   2 * i + 1 and a step is a single rotate through the carry of the
+;   compare.
+;-------------------------------------------------------------------------
+
+	.module bsearch_u16
+
+;--------------------------------------------------------
+; exported symbols
+;--------------------------------------------------------
+	.globl _bsearch_u16_PARM_2
+	.globl _bsearch_u16_PARM_3
+	.globl _bsearch_u16
+
+;--------------------------------------------------------
+; overlayable function paramters in zero page
+;--------------------------------------------------------
+	.area	OSEG    (PAG, OVR)
+_bsearch_u16_PARM_2:
+	.ds 2
+_bsearch_u16_PARM_3:
+	.ds 2
+
+;--------------------------------------------------------
+; local aliases
+;--------------------------------------------------------
+	.define ptr    "___SDCC_m6502_ret0"
+	.define key    "___SDCC_m6502_ret2"
+	.define i      "___SDCC_m6502_ret4"
+	.define base   "___SDCC_m6502_ret6"
+	.define keys   "_bsearch_u16_PARM_2"
+	.define n      "_bsearch_u16_PARM_3"
+
+;--------------------------------------------------------
+; code
+;--------------------------------------------------------
+	.area _CODE
+
+_bsearch_u16:
+	sta	*key+0
+	stx	*key+1
+	sec				; base = keys - 2
+	lda	*keys+0
+	sbc	#2
+	sta	*base+0
+	lda	*keys+1
+	sbc	#0
+	sta	*base+1
+	lda	#1
+	sta	*i+0
+	lda	#0
+	sta	*i+1
+L1:
+	lda	*n+0			; i > n: not found
+	cmp	*i+0
+	lda	*n+1
+	sbc	*i+1
+	bcc	L3
+	lda	*i+0			; ptr = base + 2 * i
+	asl	a
+	tax
+	lda	*i+1
+	rol	a
+	tay
+	txa
+	clc
+	adc	*base+0
+	sta	*ptr+0
+	tya
+	adc	*base+1
+	sta	*ptr+1
+	; Compare with the key, high byte first
+	ldy	#1
+	lda	*key+1
+	cmp	[*ptr],y
+	bne	L2
+	dey
+	lda	*key+0
+	cmp	[*ptr],y
+	beq	L4			; found
+L2:
+	rol	*i+0			; carry set if keys[i - 1] < key
+	rol	*i+1			; i = 2 * i + carry
+	bcc	L1
+L3:
+	lda	#0xFF
+	tax
+	rts
+L4:
+	lda	*i+0
+	bne	L5
+	dec	*i+1
+L5:
+	dec	*i+0
+	lda	*i+0
+	ldx	*i+1
+	rts
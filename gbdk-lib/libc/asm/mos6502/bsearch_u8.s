@@ -0,0 +1,68 @@
+;-------------------------------------------------------------------------
+;   bsearch_u8.s - search of a key table in Eytzinger order, see bsearch_u8() in stdlib.h
+;
+;   The index i counts from 1, so the children of i are 2 * i and
+;   2 * i + 1 and a step is a single rotate through the carry of the
+;   compare. An index which leaves the 8 bits is past n as well.
+;-------------------------------------------------------------------------
+
+	.module bsearch_u8
+
+;--------------------------------------------------------
+; exported symbols
+;--------------------------------------------------------
+	.globl _bsearch_u8_PARM_2
+	.globl _bsearch_u8_PARM_3
+	.globl _bsearch_u8
+
+;--------------------------------------------------------
+; overlayable function paramters in zero page
+;--------------------------------------------------------
+	.area	OSEG    (PAG, OVR)
+_bsearch_u8_PARM_2:
+	.ds 2
+_bsearch_u8_PARM_3:
+	.ds 1
+
+;--------------------------------------------------------
+; local aliases
+;--------------------------------------------------------
+	.define ptr    "___SDCC_m6502_ret0"
+	.define key    "___SDCC_m6502_ret2"
+	.define keys   "_bsearch_u8_PARM_2"
+	.define n      "_bsearch_u8_PARM_3"
+
+;--------------------------------------------------------
+; code
+;--------------------------------------------------------
+	.area _CODE
+
+_bsearch_u8:
+	sta	*key
+	sec				; ptr = keys - 1
+	lda	*keys+0
+	sbc	#1
+	sta	*ptr+0
+	lda	*keys+1
+	sbc	#0
+	sta	*ptr+1
+	ldy	#1			; Y = i
+L1:
+	cpy	*n
+	beq	L2
+	bcs	L3			; i > n: not found
+L2:
+	lda	*key
+	cmp	[*ptr],y
+	beq	L4			; found
+	tya				; carry set if keys[i - 1] < key
+	rol	a			; i = 2 * i + carry
+	tay
+	bcc	L1
+L3:
+	lda	#0xFF
+	rts
+L4:
+	dey
+	tya
+	rts
@@ -0,0 +1,66 @@
+;-------------------------------------------------------------------------
+;   div_u8.s - unsigned 8 bit division, see gbdk/fastdiv.h
+;
+;   __divuchar goes through the generic 16 bit loop, which takes
+;   16 iterations. This only has 8.
+;-------------------------------------------------------------------------
+
+	.module div_u8
+
+;--------------------------------------------------------
+; exported symbols
+;--------------------------------------------------------
+	.globl _div_u8_PARM_2
+	.globl _mod_u8_PARM_2
+	.globl _div_mod_u8_PARM_2
+	.globl _div_u8
+	.globl _mod_u8
+	.globl _div_mod_u8
+
+;--------------------------------------------------------
+; overlayable function paramters in zero page
+;--------------------------------------------------------
+	.area	OSEG    (PAG, OVR)
+_div_u8_PARM_2:
+_mod_u8_PARM_2:
+_div_mod_u8_PARM_2:
+	.ds 1
+
+;--------------------------------------------------------
+; local aliases
+;--------------------------------------------------------
+	.define quot    "___SDCC_m6502_ret0"
+	.define divisor "_div_mod_u8_PARM_2"
+
+;--------------------------------------------------------
+; code
+;--------------------------------------------------------
+	.area _CODE
+
+	; A = remainder
+_mod_u8:
+	jsr	_div_mod_u8
+	txa
+	rts
+
+	; A = quotient, X = remainder
+_div_u8:
+_div_mod_u8:
+	sta	*quot
+	lda	#0
+	ldx	#8
+L1:
+	asl	*quot
+	rol	a
+	bcs	L2
+	cmp	*divisor
+	bcc	L3
+L2:
+	sbc	*divisor		; carry is set
+	inc	*quot
+L3:
+	dex
+	bne	L1
+	tax
+	lda	*quot
+	rts
@@ -0,0 +1,129 @@
+;-------------------------------------------------------------------------
+;   sort_u8.s - counting sort over 8 bit keys, see sort_u8_order() in stdlib.h
+;
+;   The bucket table is 256 bytes, too large for zero page, so it is
+;   kept in RAM and indexed with X. Each count fits in a byte since n <= 255.
+;-------------------------------------------------------------------------
+
+	.module sort_u8
+
+;--------------------------------------------------------
+; exported symbols
+;--------------------------------------------------------
+	.globl _sort_u8_order_PARM_2
+	.globl _sort_u8_order_PARM_3
+	.globl _sort_u8_order_PARM_4
+	.globl _sort_u8_order
+
+;--------------------------------------------------------
+; overlayable function paramters in zero page
+;--------------------------------------------------------
+	.area	OSEG    (PAG, OVR)
+_sort_u8_order_PARM_2:
+	.ds 2
+_sort_u8_order_PARM_3:
+	.ds 1
+_sort_u8_order_PARM_4:
+	.ds 1
+
+;--------------------------------------------------------
+; local aliases
+;--------------------------------------------------------
+	.define order  "___SDCC_m6502_ret0"
+	.define ptr    "___SDCC_m6502_ret2"
+	.define count  "___SDCC_m6502_ret4"
+	.define index  "___SDCC_m6502_ret5"
+	.define tmp    "___SDCC_m6502_ret6"
+	.define keys   "_sort_u8_order_PARM_2"
+	.define n      "_sort_u8_order_PARM_3"
+	.define stride "_sort_u8_order_PARM_4"
+
+;--------------------------------------------------------
+; bucket table
+;--------------------------------------------------------
+	.area	_DATA
+counts:
+	.ds 256
+
+;--------------------------------------------------------
+; code
+;--------------------------------------------------------
+	.area _CODE
+
+_sort_u8_order:
+	sta	*order+0
+	stx	*order+1
+	lda	*n
+	bne	start
+	rts				; n == 0: nothing to sort
+start:
+	; Clear the counts
+	lda	#0
+	tax
+L1:
+	sta	counts,x
+	inx
+	bne	L1
+
+	; Count the keys
+	jsr	rewind
+L2:
+	lda	[*ptr],y
+	tax
+	inc	counts,x
+	jsr	next
+	bne	L2
+
+	; Turn the counts into the first position of each key
+	lda	#0
+	tax
+L3:
+	ldy	counts,x
+	sta	counts,x
+	sty	*tmp
+	clc
+	adc	*tmp
+	inx
+	bne	L3
+
+	; Write each index at the next position of its key, in order, so the sort is stable
+	jsr	rewind
+	stx	*index
+L4:
+	lda	[*ptr],y
+	tax
+	lda	counts,x
+	inc	counts,x
+	sty	*tmp
+	tay				; Y = position
+	lda	*index
+	sta	[*order],y
+	inc	*index
+	ldy	*tmp
+	jsr	next
+	bne	L4
+	rts
+
+	; ptr = keys, count = n, X = Y = 0
+rewind:
+	lda	*keys+0
+	sta	*ptr+0
+	lda	*keys+1
+	sta	*ptr+1
+	lda	*n
+	sta	*count
+	ldx	#0
+	ldy	#0
+	rts
+
+	; Y += stride into ptr, Z set after the last key
+next:
+	tya
+	clc
+	adc	*stride
+	tay
+	bcc	L5
+	inc	*ptr+1
+L5:
+	dec	*count
+	rts
@@ -0,0 +1,152 @@
+;-------------------------------------------------------------------------
+;   xrand.s - xorshift random number generator, see xrand() in rand.h
+;
+;   X ^= X << 7, X ^= X >> 9, X ^= X << 8 on a 16 bit state
+;   (J. Metcalf's shift triplet for 8 bit CPUs). It runs through all
+;   65535 non zero values, and unlike the linear congruential rand()
+;   its low bits are as random as the high ones.
+;-------------------------------------------------------------------------
+
+	.module xrand
+
+;--------------------------------------------------------
+; exported symbols
+;--------------------------------------------------------
+	.globl _rand_fill_PARM_2
+	.globl ___xrand_seed
+
+;--------------------------------------------------------
+; overlayable function paramters in zero page
+;--------------------------------------------------------
+	.area	OSEG    (PAG, OVR)
+_rand_fill_PARM_2:
+	.ds 2
+
+;--------------------------------------------------------
+; local aliases
+;--------------------------------------------------------
+	.define ptr    "___SDCC_m6502_ret0"
+	.define mask   "___SDCC_m6502_ret2"
+	.define limit  "___SDCC_m6502_ret3"
+	.define n      "_rand_fill_PARM_2"
+
+;--------------------------------------------------------
+; state
+;--------------------------------------------------------
+	.area	_INITIALIZED
+___xrand_seed::
+.xlo:	.ds 1
+.xhi:	.ds 1
+
+	.area	_INITIALIZER
+	.db	0x7E, 0xA2	; Must not be 0
+
+;--------------------------------------------------------
+; code
+;--------------------------------------------------------
+	.area _CODE
+
+; void initxrand(uint16_t seed)
+;XA: seed
+_initxrand::
+	sta	.xlo
+	stx	.xhi
+	ora	.xhi
+	bne	L1
+	inc	.xlo		; 0 would never change
+L1:
+	rts
+
+; uint16_t xrandw(void)
+_xrandw::
+	jsr	_xrand
+	ldx	.xhi
+	lda	.xlo
+	rts
+
+; uint8_t xrand(void)
+;   A = the new high byte, keeps Y
+_xrand::
+	lda	.xhi
+	lsr	a
+	lda	.xlo
+	ror	a
+	eor	.xhi
+	sta	.xhi		; X ^= X << 7
+	lda	.xlo
+	lsr	a
+	lda	.xhi
+	ror	a
+	eor	.xlo
+	sta	.xlo		; X ^= X >> 9
+	eor	.xhi
+	sta	.xhi		; X ^= X << 8
+	rts
+
+; void rand_fill(uint8_t * buf, uint16_t n)
+;XA: buf
+;   Two bytes per step
+_rand_fill::
+	sta	*ptr+0
+	stx	*ptr+1
+	ldy	#0
+L2:
+	lda	*n+0
+	ora	*n+1
+	beq	L5
+	jsr	_xrand
+	lda	.xlo
+	jsr	put
+	beq	L5
+	lda	.xhi
+	jsr	put
+	bne	L2
+L5:
+	rts
+
+	; Stores A, Z set once n reaches 0
+put:
+	sta	[*ptr],y
+	iny
+	bne	L3
+	inc	*ptr+1
+L3:
+	lda	*n+0
+	bne	L4
+	dec	*n+1
+L4:
+	dec	*n+0
+	lda	*n+0
+	ora	*n+1
+	rts
+
+; uint8_t rand_range(uint8_t n)
+;A: n
+;   Draws with the bits of n - 1 and retries until it is below n,
+;   which is unbiased and retries less than half of the time
+_rand_range::
+	cmp	#0
+	beq	_xrand		; 0: any byte
+	sta	*limit
+	sec
+	sbc	#1
+	sta	*mask
+	lsr	a
+	ora	*mask
+	sta	*mask
+	lsr	a
+	lsr	a
+	ora	*mask
+	sta	*mask
+	lsr	a
+	lsr	a
+	lsr	a
+	lsr	a
+	ora	*mask
+	sta	*mask		; Covers n - 1
+L6:
+	jsr	_xrand
+	and	*mask
+	cmp	*limit
+	bcs	L6
+	rts
@@ -1,8 +1,9 @@
-        .module strcmp
+        .module memcmp
 
         .area   _HOME
 
 ; int memcmp(const void *buf1, const void *buf2, size_t count)
+; Compares in groups of four. Algorithm is Duff's device.
 _memcmp::
         lda     hl,7(sp)
         ld      a,(hl-)
@@ -17,15 +18,44 @@ _memcmp::
         ld      l,(hl)
         ld      h,a
 
+        ;shift LSB to carry
+        srl     b
+        rr      c
+        jr      nc, 4$
+        ld      a,(de)
+        sub     (hl)            ; s1[i]==s2[i]?
+        jr      nz, 2$          ; -> Different
+        inc     de
+        inc     hl
+4$:
+        ;shift second LSB to carry
+        srl     b
+        rr      c
+        ;count/4 in bc
         inc     b
         inc     c
-        jr      3$
-
-1$:     
+        jr      nc, 3$
+        jr      5$
+1$:
+        ld      a,(de)
+        sub     (hl)            ; s1[i]==s2[i]?
+        jr      nz, 2$          ; -> Different
+        inc     de
+        inc     hl
+        ld      a,(de)
+        sub     (hl)            ; s1[i]==s2[i]?
+        jr      nz, 2$          ; -> Different
+        inc     de
+        inc     hl
+5$:
+        ld      a,(de)
+        sub     (hl)            ; s1[i]==s2[i]?
+        jr      nz, 2$          ; -> Different
+        inc     de
+        inc     hl
         ld      a,(de)
         sub     (hl)            ; s1[i]==s2[i]?
         jr      nz, 2$          ; -> Different
-        
         inc     de
         inc     hl
 3$:
@@ -38,16 +38,27 @@ void *memmove (void *dst, const void *src, size_t size)
 
 	char *d = dst;
 	const char *s = src;
+	/* Duff's device: copy in groups of four, entering
+	   the loop part way through for the remainder */
+	c = ((c - 1) >> 2) + 1;
 	if (s < d) {
-		d += c;
-		s += c;
-		do {
-			*--d = *--s;
-		} while (--c);
+		d += size;
+		s += size;
+		switch ((uint8_t)size & 3) {
+			case 0: do {	*--d = *--s;
+			case 3:		*--d = *--s;
+			case 2:		*--d = *--s;
+			case 1:		*--d = *--s;
+				} while (--c);
+		}
 	} else {
-		do {
-			*d++ = *s++;
-		} while (--c);
+		switch ((uint8_t)size & 3) {
+			case 0: do {	*d++ = *s++;
+			case 3:		*d++ = *s++;
+			case 2:		*d++ = *s++;
+			case 1:		*d++ = *s++;
+				} while (--c);
+		}
 	}
 
 	return dst;
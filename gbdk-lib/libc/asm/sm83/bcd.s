@@ -231,3 +231,117 @@ _bcd2text::
             
             pop     BC
             ret
+
+_bcd_add_n::
+            push    BC
+
+            lda     HL, 8(SP)
+            ld      A, (HL-)
+            ld      B, A            ; B: len
+            ld      D, (HL)
+            dec     HL
+            ld      E, (HL)         ; DE: value
+            dec     HL
+            ld      A, (HL-)
+            ld      L, (HL)
+            ld      H, A            ; HL: sour
+
+            inc     B
+            or      A               ; clear C, HC
+            jr      2$
+1$:
+            ld      A,(DE)
+            adc     (HL)
+            daa
+            ld      (HL+), A
+            inc     DE
+2$:
+            dec     B               ; keeps C
+            jr      NZ, 1$
+
+            pop     BC
+            ret
+
+_bcd_sub_n::
+            push    BC
+
+            lda     HL, 4(SP)
+            ld      E, (HL)
+            inc     HL
+            ld      D, (HL)         ; DE: sour
+            inc     HL
+            ld      A, (HL+)
+            ld      C, A
+            ld      A, (HL+)
+            ld      B, (HL)         ; B: len
+            ld      H, A
+            ld      L, C            ; HL: value
+
+            inc     B
+            or      A               ; clear C, HC
+            jr      2$
+1$:
+            ld      A,(DE)
+            sbc     (HL)
+            daa
+            ld      (DE), A
+            inc     DE
+            inc     HL
+2$:
+            dec     B               ; keeps C
+            jr      NZ, 1$
+
+            pop     BC
+            ret
+
+_bcd2text_n::
+            push    BC
+
+            lda     HL, 4(SP)
+            ld      E, (HL)
+            inc     HL
+            ld      D, (HL)         ; DE: bcd
+            inc     HL
+            ld      B, (HL)         ; B: len
+            inc     HL
+            ld      C, (HL)         ; C: digit offset
+            inc     HL
+            ld      A, (HL+)
+            ld      H, (HL)
+            ld      L, A            ; HL: buffer
+
+            ld      A, B
+            or      A
+            jr      Z, 2$
+
+            add     E               ; DE: past the most significant byte
+            ld      E, A
+            adc     D
+            sub     E
+            ld      D, A
+1$:
+            dec     DE
+            ld      A, (DE)
+            swap    A
+            and     #0x0f
+            add     C
+            ld      (HL+), A
+            ld      A, (DE)
+            and     #0x0f
+            add     C
+            ld      (HL+), A
+
+            dec     B
+            jr      NZ, 1$
+2$:
+            xor     A
+            ld      (HL), A
+
+            lda     HL, 6(SP)
+            ld      A, (HL)
+            add     A
+            ld      E, A            ; 2 digits per byte
+            ld      D, #0
+
+            pop     BC
+            ret
@@ -0,0 +1,74 @@
+        .module bsearch_u16
+
+        ;; Search of a key table in Eytzinger order, see bsearch_u16() in stdlib.h
+        ;;
+        ;; The index i counts from 1, so the children of i are 2 * i and
+        ;; 2 * i + 1 and a step is a single rotate through the carry of the
+        ;; compare.
+
+        .area   _DATA
+
+.bsearch_base:
+        .ds     0x02
+.bsearch_n:
+        .ds     0x02
+
+        .area   _HOME
+
+; uint16_t bsearch_u16(uint16_t key, const uint16_t * keys, uint16_t n)
+;DE: key
+;BC: keys
+;sp+2: n
+_bsearch_u16::
+        ldhl    sp, #2
+        ld      a, (hl+)
+        ld      (.bsearch_n), a
+        ld      a, (hl)
+        ld      (.bsearch_n + 1), a
+        ld      a, c
+        sub     #2
+        ld      (.bsearch_base), a
+        ld      a, b
+        sbc     #0
+        ld      (.bsearch_base + 1), a  ; keys - 2
+        ld      bc, #1          ; BC = i
+1$:
+        ld      hl, #.bsearch_n
+        ld      a, (hl+)
+        sub     c
+        ld      a, (hl)
+        sbc     b
+        jr      c, 3$           ; i > n: not found
+
+        ld      h, b
+        ld      l, c
+        add     hl, hl
+        ld      a, (.bsearch_base)
+        add     a, l
+        ld      l, a
+        ld      a, (.bsearch_base + 1)
+        adc     a, h
+        ld      h, a            ; HL = &keys[i - 1]
+
+        ;; Compare with the key, high byte first
+        inc     hl
+        ld      a, (hl-)
+        cp      d
+        jr      nz, 2$
+        ld      a, (hl)
+        cp      e
+        jr      z, 4$           ; found
+2$:
+        rl      c               ; carry set if keys[i - 1] < key
+        rl      b               ; i = 2 * i + carry
+        jr      nc, 1$
+3$:
+        ld      bc, #0xFFFF
+        jr      5$
+4$:
+        dec     bc
+5$:
+        ;; Remove n from the stack
+        pop     hl
+        pop     af
+        jp      (hl)
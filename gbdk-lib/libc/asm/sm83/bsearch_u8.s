@@ -0,0 +1,49 @@
+        .module bsearch_u8
+
+        ;; Search of a key table in Eytzinger order, see bsearch_u8() in stdlib.h
+        ;;
+        ;; The index i counts from 1, so the children of i are 2 * i and
+        ;; 2 * i + 1 and a step is a single rotate through the carry of the
+        ;; compare. An index which leaves the 8 bits is past n as well.
+
+        .area   _HOME
+
+; uint8_t bsearch_u8(uint8_t key, const uint8_t * keys, uint8_t n)
+;A: key
+;DE: keys
+;sp+2: n
+_bsearch_u8::
+        ld      c, a            ; C = key
+        dec     de              ; DE = keys - 1
+        ld      b, #1           ; B = i
+1$:
+        ldhl    sp, #2
+        ld      a, (hl)
+        cp      b
+        jr      c, 3$           ; i > n: not found
+
+        ld      a, e
+        add     a, b
+        ld      l, a
+        adc     a, d
+        sub     l
+        ld      h, a            ; HL = &keys[i - 1]
+
+        ld      a, (hl)
+        cp      c
+        jr      z, 2$           ; found
+        ld      a, b            ; carry set if keys[i - 1] < key
+        adc     a, a            ; i = 2 * i + carry
+        ld      b, a
+        jr      nc, 1$
+3$:
+        ld      a, #0xFF
+        jr      4$
+2$:
+        ld      a, b
+        dec     a
+4$:
+        ;; Remove n from the stack
+        pop     hl
+        inc     sp
+        jp      (hl)
@@ -0,0 +1,112 @@
+        .module div_u8
+
+        ;; Unsigned 8 bit division, see gbdk/fastdiv.h
+        ;;
+        ;; __divuchar goes through the generic 16 bit loop, which takes
+        ;; 16 iterations. This only has 8, and they are unrolled.
+
+        .area   _HOME
+
+; uint8_t div_u8(uint8_t a, uint8_t b)
+;A: a
+;E: b
+_div_u8::
+        call    .div_mod_u8
+        ld      a, c
+        ret
+
+; uint16_t div_mod_u8(uint8_t a, uint8_t b)
+;A: a
+;E: b
+_div_mod_u8::
+        call    .div_mod_u8
+        ld      b, a            ; B = remainder, C = quotient
+        ret
+
+        ;; Entry conditions
+        ;;   A = dividend
+        ;;   E = divisor
+        ;;
+        ;; Exit conditions
+        ;;   C = quotient
+        ;;   A = remainder
+        ;;
+        ;; Register used: AF,C
+; uint8_t mod_u8(uint8_t a, uint8_t b)
+_mod_u8::
+.div_mod_u8::
+        ld      c, a
+        xor     a
+        sla     c
+        rla
+        jr      c, 1$
+        cp      e
+        jr      c, 2$
+1$:
+        sub     e
+        inc     c
+2$:
+        sla     c
+        rla
+        jr      c, 3$
+        cp      e
+        jr      c, 4$
+3$:
+        sub     e
+        inc     c
+4$:
+        sla     c
+        rla
+        jr      c, 5$
+        cp      e
+        jr      c, 6$
+5$:
+        sub     e
+        inc     c
+6$:
+        sla     c
+        rla
+        jr      c, 7$
+        cp      e
+        jr      c, 8$
+7$:
+        sub     e
+        inc     c
+8$:
+        sla     c
+        rla
+        jr      c, 9$
+        cp      e
+        jr      c, 10$
+9$:
+        sub     e
+        inc     c
+10$:
+        sla     c
+        rla
+        jr      c, 11$
+        cp      e
+        jr      c, 12$
+11$:
+        sub     e
+        inc     c
+12$:
+        sla     c
+        rla
+        jr      c, 13$
+        cp      e
+        jr      c, 14$
+13$:
+        sub     e
+        inc     c
+14$:
+        sla     c
+        rla
+        jr      c, 15$
+        cp      e
+        jr      c, 16$
+15$:
+        sub     e
+        inc     c
+16$:
+        ret
@@ -0,0 +1,301 @@
+        .module divlong
+
+        ;; 32 bit divide and modulus for libc/_divulong.c, _modulong.c,
+        ;; _divslong.c and _modslong.c
+        ;;
+        ;; The operands are passed by address, so this doesn't depend on how
+        ;; 32 bit arguments are passed. The quotient replaces the dividend
+        ;; and the remainder the divisor.
+        ;;
+        ;; A divisor that fits 16 bits is divided into the high word and
+        ;; then the low word, 16 rounds each, and the high word is skipped
+        ;; when it is below the divisor. With a larger divisor the quotient
+        ;; fits 16 bits, so that takes 16 rounds as well.
+
+        .area   _CODE
+
+; void _divslong_ptr(long * x, long * y)
+;DE: x, gets the quotient
+;BC: y, gets the remainder, which has the sign of x
+__divslong_ptr::
+        ld      h, d
+        ld      l, e
+        call    .labs_ptr               ; x = |x|, A = its high byte
+        push    af
+        ld      h, b
+        ld      l, c
+        call    .labs_ptr               ; y = |y|
+        ld      h, a
+        pop     af
+        ld      l, a
+        xor     h
+        ld      h, l                    ; H bit 7: sign of the remainder
+        ld      l, a                    ; L bit 7: sign of the quotient
+        push    hl
+        push    de
+        push    bc
+        call    __divulong_ptr
+        pop     hl                      ; &y
+        pop     de                      ; &x
+        pop     bc
+        bit     7, b
+        call    nz, .lneg_ptr
+        ld      h, d
+        ld      l, e
+        bit     7, c
+        ret     z
+        ;; Fall through
+
+        ;; Negates the long at HL
+        ;;
+        ;; Register used: AF,HL
+.lneg_ptr:
+        xor     a
+        sub     (hl)
+        ld      (hl+), a
+        ld      a, #0
+        sbc     (hl)
+        ld      (hl+), a
+        ld      a, #0
+        sbc     (hl)
+        ld      (hl+), a
+        ld      a, #0
+        sbc     (hl)
+        ld      (hl), a
+        ret
+
+        ;; Negates the long at HL if it is negative
+        ;;
+        ;; Exit conditions
+        ;;   A = high byte it had
+        ;;
+        ;; Register used: AF,HL
+.labs_ptr:
+        inc     hl
+        inc     hl
+        inc     hl
+        ld      a, (hl-)
+        dec     hl
+        dec     hl
+        bit     7, a
+        ret     z
+        push    af
+        call    .lneg_ptr
+        pop     af
+        ret
+
+; void _divulong_ptr(unsigned long * x, unsigned long * y)
+;DE: x, gets the quotient
+;BC: y, gets the remainder
+__divulong_ptr::
+        push    de                      ; &x
+        push    bc                      ; &y
+        ld      h, b
+        ld      l, c
+        ld      a, (hl+)
+        ld      c, a
+        ld      a, (hl+)
+        ld      b, a                    ; BC = y low
+        ld      a, (hl+)
+        or      (hl)
+        jr      nz, .divulong_32
+
+        ;; 16 bit divisor
+        ld      h, d
+        ld      l, e
+        inc     hl
+        inc     hl
+        ld      a, (hl+)
+        ld      e, a
+        ld      d, (hl)                 ; DE = x high
+        ld      hl, #0
+        ld      a, e
+        sub     c
+        ld      a, d
+        sbc     b
+        jr      nc, 1$
+        ld      h, d                    ; x high < y: it is the remainder
+        ld      l, e
+        ld      de, #0
+        jr      2$
+1$:
+        call    .div32_16               ; DE = x high / y, HL = x high % y
+2$:
+        push    hl
+        ldhl    sp, #4
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        inc     hl
+        inc     hl
+        ld      a, e
+        ld      (hl+), a
+        ld      (hl), d                 ; x high = quotient high
+        dec     hl
+        dec     hl
+        ld      a, (hl-)
+        ld      d, a
+        ld      e, (hl)                 ; DE = x low
+        pop     hl
+        call    .div32_16               ; DE = quotient low, HL = remainder
+
+        pop     bc                      ; BC = &y
+        ld      a, l
+        ld      (bc), a
+        inc     bc
+        ld      a, h
+        ld      (bc), a
+        inc     bc
+        xor     a
+        ld      (bc), a
+        inc     bc
+        ld      (bc), a
+        pop     hl                      ; HL = &x
+        ld      a, e
+        ld      (hl+), a
+        ld      (hl), d
+        ret
+
+        ;; 32 bit divisor, HL = &y + 3
+.divulong_32:
+        ld      a, (hl-)
+        ld      l, (hl)
+        ld      h, a
+        push    hl
+        push    bc                      ; copy of y
+        ldhl    sp, #6
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        ld      a, (hl+)
+        ld      e, a
+        ld      a, (hl+)
+        ld      d, a                    ; DE = x low, becomes the quotient
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a                    ; HL = x high, the start of the remainder
+        push    de
+        ld      d, h
+        ld      e, l
+        ld      bc, #0                  ; BCDE = remainder
+        ld      a, #16
+        push    af                      ; stack: round counter, quotient, y, &y, &x
+1$:
+        ldhl    sp, #2
+        sla     (hl)
+        inc     hl
+        rl      (hl)                    ; next bit of x
+        rl      e
+        rl      d
+        rl      c
+        rl      b
+        inc     hl                      ; HL = copy of y
+        jr      c, 2$                   ; 33 bit remainder is always >= y
+        ld      a, e
+        sub     (hl)
+        inc     hl
+        ld      a, d
+        sbc     (hl)
+        inc     hl
+        ld      a, c
+        sbc     (hl)
+        inc     hl
+        ld      a, b
+        sbc     (hl)
+        jr      c, 3$
+        ldhl    sp, #4
+2$:
+        ld      a, e
+        sub     (hl)
+        ld      e, a
+        inc     hl
+        ld      a, d
+        sbc     (hl)
+        ld      d, a
+        inc     hl
+        ld      a, c
+        sbc     (hl)
+        ld      c, a
+        inc     hl
+        ld      a, b
+        sbc     (hl)
+        ld      b, a
+        ldhl    sp, #2
+        inc     (hl)                    ; quotient bit
+3$:
+        ldhl    sp, #1
+        dec     (hl)
+        jr      nz, 1$
+
+        ldhl    sp, #8
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a                    ; HL = &y
+        ld      a, e
+        ld      (hl+), a
+        ld      a, d
+        ld      (hl+), a
+        ld      a, c
+        ld      (hl+), a
+        ld      (hl), b
+        pop     af
+        pop     de                      ; DE = quotient
+        add     sp, #6
+        pop     hl                      ; HL = &x
+        ld      a, e
+        ld      (hl+), a
+        ld      a, d
+        ld      (hl+), a
+        xor     a
+        ld      (hl+), a
+        ld      (hl), a
+        ret
+
+        ;; HL:DE / BC, HL must be below BC
+        ;;
+        ;; Exit conditions
+        ;;   DE = quotient
+        ;;   HL = remainder
+        ;;
+        ;; Only 8 rounds when HL:DE fits a byte
+        ;;
+        ;; Register used: AF,DE,HL
+.div32_16:
+        ld      a, h
+        or      l
+        or      d
+        ld      a, #16
+        jr      nz, 1$
+        ld      d, e
+        ld      e, h
+        ld      a, #8
+1$:
+        push    af
+        sla     e
+        rl      d
+        rl      l
+        rl      h
+        jr      c, 2$                   ; 17 bit remainder is always >= BC
+        ld      a, l
+        sub     c
+        ld      l, a
+        ld      a, h
+        sbc     b
+        ld      h, a
+        jr      nc, 3$
+        add     hl, bc
+        jr      4$
+2$:
+        ld      a, l
+        sub     c
+        ld      l, a
+        ld      a, h
+        sbc     b
+        ld      h, a
+3$:
+        inc     e                       ; quotient bit
+4$:
+        pop     af
+        dec     a
+        jr      nz, 1$
+        ret
@@ -0,0 +1,90 @@
+        .module memset_fast
+
+        ;; memset() with 16 stores per loop, an opt-in replacement for _memset.s
+        ;;
+        ;; It is built into fast.lib, which is linked ahead of the port
+        ;; lib by lcc -fastlib. The n & 15 bytes are stored first, in
+        ;; blocks of 1, 2, 4 and 8, then 16 bytes per loop.
+
+        .area   _HOME
+
+; void *memset (void *s, int c, size_t n)
+_memset::
+        lda     hl,7(sp)
+        ld      a,(hl-)
+        ld      d, a
+        ld      a,(hl-)
+        ld      e, a
+        or      d
+        jr      z,8$
+
+        dec     hl
+        ld      a,(hl-)
+        push    af
+        ld      a,(hl-)
+        ld      l,(hl)
+        ld      h,a
+        pop     af
+
+        srl     d
+        rr      e
+        jr      nc,1$
+        ld      (hl+),a
+1$:
+        srl     d
+        rr      e
+        jr      nc,2$
+        ld      (hl+),a
+        ld      (hl+),a
+2$:
+        srl     d
+        rr      e
+        jr      nc,3$
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+3$:
+        srl     d
+        rr      e
+        jr      nc,4$
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+4$:
+        inc     d
+        inc     e
+        jr      6$
+5$:
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+        ld      (hl+),a
+6$:
+        dec     e
+        jr      nz,5$
+        dec     d
+        jr      nz,5$
+8$:
+        lda     hl,2(sp)
+        ld      a,(hl+)
+        ld      e,a
+        ld      d,(hl)
+        ret
@@ -0,0 +1,279 @@
+        .module mul_qsq
+
+        ;; Quarter square multiplication, an opt-in replacement for mul.s
+        ;;
+        ;; It is built into mul_qsq.lib, which is not linked by default.
+        ;; Link with -Wl-lmul_qsq.lib to use it: user libraries are
+        ;; searched before the GBDK ones, and this module defines every
+        ;; symbol of the default one, so that one is left out.
+        ;;
+        ;; a * b = sq(a + b) - sq(|a - b|), with sq(x) = x * x / 4
+        ;; (rounded down) looked up in two page aligned 512 byte tables.
+
+        .area   _CODE
+
+.globl  __mulsuchar
+.globl  __muluschar
+.globl  __mulschar
+.globl  __muluchar
+.globl  __mulint
+
+        ;; sq(x) = x * x / 4 for x = 0 .. 510, low bytes then high bytes.
+        ;; Both tables must start on a page boundary.
+        .bndry  0x100
+.qsq_lo:
+        .db     0x00, 0x00, 0x01, 0x02, 0x04, 0x06, 0x09, 0x0C, 0x10, 0x14, 0x19, 0x1E, 0x24, 0x2A, 0x31, 0x38
+        .db     0x40, 0x48, 0x51, 0x5A, 0x64, 0x6E, 0x79, 0x84, 0x90, 0x9C, 0xA9, 0xB6, 0xC4, 0xD2, 0xE1, 0xF0
+        .db     0x00, 0x10, 0x21, 0x32, 0x44, 0x56, 0x69, 0x7C, 0x90, 0xA4, 0xB9, 0xCE, 0xE4, 0xFA, 0x11, 0x28
+        .db     0x40, 0x58, 0x71, 0x8A, 0xA4, 0xBE, 0xD9, 0xF4, 0x10, 0x2C, 0x49, 0x66, 0x84, 0xA2, 0xC1, 0xE0
+        .db     0x00, 0x20, 0x41, 0x62, 0x84, 0xA6, 0xC9, 0xEC, 0x10, 0x34, 0x59, 0x7E, 0xA4, 0xCA, 0xF1, 0x18
+        .db     0x40, 0x68, 0x91, 0xBA, 0xE4, 0x0E, 0x39, 0x64, 0x90, 0xBC, 0xE9, 0x16, 0x44, 0x72, 0xA1, 0xD0
+        .db     0x00, 0x30, 0x61, 0x92, 0xC4, 0xF6, 0x29, 0x5C, 0x90, 0xC4, 0xF9, 0x2E, 0x64, 0x9A, 0xD1, 0x08
+        .db     0x40, 0x78, 0xB1, 0xEA, 0x24, 0x5E, 0x99, 0xD4, 0x10, 0x4C, 0x89, 0xC6, 0x04, 0x42, 0x81, 0xC0
+        .db     0x00, 0x40, 0x81, 0xC2, 0x04, 0x46, 0x89, 0xCC, 0x10, 0x54, 0x99, 0xDE, 0x24, 0x6A, 0xB1, 0xF8
+        .db     0x40, 0x88, 0xD1, 0x1A, 0x64, 0xAE, 0xF9, 0x44, 0x90, 0xDC, 0x29, 0x76, 0xC4, 0x12, 0x61, 0xB0
+        .db     0x00, 0x50, 0xA1, 0xF2, 0x44, 0x96, 0xE9, 0x3C, 0x90, 0xE4, 0x39, 0x8E, 0xE4, 0x3A, 0x91, 0xE8
+        .db     0x40, 0x98, 0xF1, 0x4A, 0xA4, 0xFE, 0x59, 0xB4, 0x10, 0x6C, 0xC9, 0x26, 0x84, 0xE2, 0x41, 0xA0
+        .db     0x00, 0x60, 0xC1, 0x22, 0x84, 0xE6, 0x49, 0xAC, 0x10, 0x74, 0xD9, 0x3E, 0xA4, 0x0A, 0x71, 0xD8
+        .db     0x40, 0xA8, 0x11, 0x7A, 0xE4, 0x4E, 0xB9, 0x24, 0x90, 0xFC, 0x69, 0xD6, 0x44, 0xB2, 0x21, 0x90
+        .db     0x00, 0x70, 0xE1, 0x52, 0xC4, 0x36, 0xA9, 0x1C, 0x90, 0x04, 0x79, 0xEE, 0x64, 0xDA, 0x51, 0xC8
+        .db     0x40, 0xB8, 0x31, 0xAA, 0x24, 0x9E, 0x19, 0x94, 0x10, 0x8C, 0x09, 0x86, 0x04, 0x82, 0x01, 0x80
+        .db     0x00, 0x80, 0x01, 0x82, 0x04, 0x86, 0x09, 0x8C, 0x10, 0x94, 0x19, 0x9E, 0x24, 0xAA, 0x31, 0xB8
+        .db     0x40, 0xC8, 0x51, 0xDA, 0x64, 0xEE, 0x79, 0x04, 0x90, 0x1C, 0xA9, 0x36, 0xC4, 0x52, 0xE1, 0x70
+        .db     0x00, 0x90, 0x21, 0xB2, 0x44, 0xD6, 0x69, 0xFC, 0x90, 0x24, 0xB9, 0x4E, 0xE4, 0x7A, 0x11, 0xA8
+        .db     0x40, 0xD8, 0x71, 0x0A, 0xA4, 0x3E, 0xD9, 0x74, 0x10, 0xAC, 0x49, 0xE6, 0x84, 0x22, 0xC1, 0x60
+        .db     0x00, 0xA0, 0x41, 0xE2, 0x84, 0x26, 0xC9, 0x6C, 0x10, 0xB4, 0x59, 0xFE, 0xA4, 0x4A, 0xF1, 0x98
+        .db     0x40, 0xE8, 0x91, 0x3A, 0xE4, 0x8E, 0x39, 0xE4, 0x90, 0x3C, 0xE9, 0x96, 0x44, 0xF2, 0xA1, 0x50
+        .db     0x00, 0xB0, 0x61, 0x12, 0xC4, 0x76, 0x29, 0xDC, 0x90, 0x44, 0xF9, 0xAE, 0x64, 0x1A, 0xD1, 0x88
+        .db     0x40, 0xF8, 0xB1, 0x6A, 0x24, 0xDE, 0x99, 0x54, 0x10, 0xCC, 0x89, 0x46, 0x04, 0xC2, 0x81, 0x40
+        .db     0x00, 0xC0, 0x81, 0x42, 0x04, 0xC6, 0x89, 0x4C, 0x10, 0xD4, 0x99, 0x5E, 0x24, 0xEA, 0xB1, 0x78
+        .db     0x40, 0x08, 0xD1, 0x9A, 0x64, 0x2E, 0xF9, 0xC4, 0x90, 0x5C, 0x29, 0xF6, 0xC4, 0x92, 0x61, 0x30
+        .db     0x00, 0xD0, 0xA1, 0x72, 0x44, 0x16, 0xE9, 0xBC, 0x90, 0x64, 0x39, 0x0E, 0xE4, 0xBA, 0x91, 0x68
+        .db     0x40, 0x18, 0xF1, 0xCA, 0xA4, 0x7E, 0x59, 0x34, 0x10, 0xEC, 0xC9, 0xA6, 0x84, 0x62, 0x41, 0x20
+        .db     0x00, 0xE0, 0xC1, 0xA2, 0x84, 0x66, 0x49, 0x2C, 0x10, 0xF4, 0xD9, 0xBE, 0xA4, 0x8A, 0x71, 0x58
+        .db     0x40, 0x28, 0x11, 0xFA, 0xE4, 0xCE, 0xB9, 0xA4, 0x90, 0x7C, 0x69, 0x56, 0x44, 0x32, 0x21, 0x10
+        .db     0x00, 0xF0, 0xE1, 0xD2, 0xC4, 0xB6, 0xA9, 0x9C, 0x90, 0x84, 0x79, 0x6E, 0x64, 0x5A, 0x51, 0x48
+        .db     0x40, 0x38, 0x31, 0x2A, 0x24, 0x1E, 0x19, 0x14, 0x10, 0x0C, 0x09, 0x06, 0x04, 0x02, 0x01, 0x00
+.qsq_hi:
+        .db     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        .db     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        .db     0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02
+        .db     0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03
+        .db     0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x06
+        .db     0x06, 0x06, 0x06, 0x06, 0x06, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x08, 0x08, 0x08, 0x08, 0x08
+        .db     0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0B, 0x0B, 0x0B, 0x0B, 0x0C
+        .db     0x0C, 0x0C, 0x0C, 0x0C, 0x0D, 0x0D, 0x0D, 0x0D, 0x0E, 0x0E, 0x0E, 0x0E, 0x0F, 0x0F, 0x0F, 0x0F
+        .db     0x10, 0x10, 0x10, 0x10, 0x11, 0x11, 0x11, 0x11, 0x12, 0x12, 0x12, 0x12, 0x13, 0x13, 0x13, 0x13
+        .db     0x14, 0x14, 0x14, 0x15, 0x15, 0x15, 0x15, 0x16, 0x16, 0x16, 0x17, 0x17, 0x17, 0x18, 0x18, 0x18
+        .db     0x19, 0x19, 0x19, 0x19, 0x1A, 0x1A, 0x1A, 0x1B, 0x1B, 0x1B, 0x1C, 0x1C, 0x1C, 0x1D, 0x1D, 0x1D
+        .db     0x1E, 0x1E, 0x1E, 0x1F, 0x1F, 0x1F, 0x20, 0x20, 0x21, 0x21, 0x21, 0x22, 0x22, 0x22, 0x23, 0x23
+        .db     0x24, 0x24, 0x24, 0x25, 0x25, 0x25, 0x26, 0x26, 0x27, 0x27, 0x27, 0x28, 0x28, 0x29, 0x29, 0x29
+        .db     0x2A, 0x2A, 0x2B, 0x2B, 0x2B, 0x2C, 0x2C, 0x2D, 0x2D, 0x2D, 0x2E, 0x2E, 0x2F, 0x2F, 0x30, 0x30
+        .db     0x31, 0x31, 0x31, 0x32, 0x32, 0x33, 0x33, 0x34, 0x34, 0x35, 0x35, 0x35, 0x36, 0x36, 0x37, 0x37
+        .db     0x38, 0x38, 0x39, 0x39, 0x3A, 0x3A, 0x3B, 0x3B, 0x3C, 0x3C, 0x3D, 0x3D, 0x3E, 0x3E, 0x3F, 0x3F
+        .db     0x40, 0x40, 0x41, 0x41, 0x42, 0x42, 0x43, 0x43, 0x44, 0x44, 0x45, 0x45, 0x46, 0x46, 0x47, 0x47
+        .db     0x48, 0x48, 0x49, 0x49, 0x4A, 0x4A, 0x4B, 0x4C, 0x4C, 0x4D, 0x4D, 0x4E, 0x4E, 0x4F, 0x4F, 0x50
+        .db     0x51, 0x51, 0x52, 0x52, 0x53, 0x53, 0x54, 0x54, 0x55, 0x56, 0x56, 0x57, 0x57, 0x58, 0x59, 0x59
+        .db     0x5A, 0x5A, 0x5B, 0x5C, 0x5C, 0x5D, 0x5D, 0x5E, 0x5F, 0x5F, 0x60, 0x60, 0x61, 0x62, 0x62, 0x63
+        .db     0x64, 0x64, 0x65, 0x65, 0x66, 0x67, 0x67, 0x68, 0x69, 0x69, 0x6A, 0x6A, 0x6B, 0x6C, 0x6C, 0x6D
+        .db     0x6E, 0x6E, 0x6F, 0x70, 0x70, 0x71, 0x72, 0x72, 0x73, 0x74, 0x74, 0x75, 0x76, 0x76, 0x77, 0x78
+        .db     0x79, 0x79, 0x7A, 0x7B, 0x7B, 0x7C, 0x7D, 0x7D, 0x7E, 0x7F, 0x7F, 0x80, 0x81, 0x82, 0x82, 0x83
+        .db     0x84, 0x84, 0x85, 0x86, 0x87, 0x87, 0x88, 0x89, 0x8A, 0x8A, 0x8B, 0x8C, 0x8D, 0x8D, 0x8E, 0x8F
+        .db     0x90, 0x90, 0x91, 0x92, 0x93, 0x93, 0x94, 0x95, 0x96, 0x96, 0x97, 0x98, 0x99, 0x99, 0x9A, 0x9B
+        .db     0x9C, 0x9D, 0x9D, 0x9E, 0x9F, 0xA0, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8
+        .db     0xA9, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAD, 0xAE, 0xAF, 0xB0, 0xB1, 0xB2, 0xB2, 0xB3, 0xB4, 0xB5
+        .db     0xB6, 0xB7, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBD, 0xBE, 0xBF, 0xC0, 0xC1, 0xC2, 0xC3
+        .db     0xC4, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF, 0xD0, 0xD1
+        .db     0xD2, 0xD3, 0xD4, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xE0
+        .db     0xE1, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF
+        .db     0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0x00
+
+__muluchar:
+        ;; 8 bit by 8 bit unsigned multiplication
+        ;;
+        ;; Entry conditions
+        ;;   A = multiplicand
+        ;;   E = multiplier
+        ;;
+        ;; Exit conditions
+        ;;   BC = product
+        ;;
+        ;; Register used: AF,BC,HL
+.mulu8x8:
+        ld      c, a
+        sub     e
+        jr      nc, 1$
+        cpl
+        inc     a
+1$:
+        ld      l, a
+        ld      h, #>.qsq_lo    ; HL = &sq(|a - b|)
+        ld      a, c
+        add     a, e            ; A + carry = a + b
+        ld      c, (hl)
+        inc     h
+        inc     h
+        ld      b, (hl)         ; BC = sq(|a - b|)
+        ld      l, a
+        ld      h, #>.qsq_lo
+        jr      nc, 2$
+        inc     h               ; HL = &sq(a + b)
+2$:
+        ld      a, (hl)
+        sub     c
+        ld      c, a
+        inc     h
+        inc     h
+        ld      a, (hl)
+        sbc     b
+        ld      b, a            ; BC = sq(a + b) - sq(|a - b|)
+        ret
+
+        ;; 16-bit multiplication
+        ;;
+        ;; Entry conditions
+        ;;   BC = multiplicand
+        ;;   DE = multiplier
+        ;;
+        ;; Exit conditions
+        ;;   BC = less significant word of product
+        ;;
+        ;; Register used: AF,BC,DE,HL
+__mulint:
+        ;; c * e + ((b * e + c * d) << 8), only the low byte of the
+        ;; cross products is needed
+        ld      a, b
+        or      a
+        jr      z, 4$
+
+        ;; B = low byte of b * e
+        sub     e
+        jr      nc, 3$
+        cpl
+        inc     a
+3$:
+        ld      l, a
+        ld      h, #>.qsq_lo
+        ld      a, b
+        add     a, e
+        ld      b, (hl)
+        ld      l, a
+        ld      h, #>.qsq_lo
+        jr      nc, 31$
+        inc     h
+31$:
+        ld      a, (hl)
+        sub     b
+        ld      b, a
+4$:
+        ld      a, d
+        or      a
+        jr      z, 6$
+
+        ;; B += low byte of c * d
+        ld      a, c
+        sub     d
+        jr      nc, 5$
+        cpl
+        inc     a
+5$:
+        ld      l, a
+        ld      h, #>.qsq_lo
+        ld      a, c
+        add     a, d
+        ld      d, (hl)
+        ld      l, a
+        ld      h, #>.qsq_lo
+        jr      nc, 51$
+        inc     h
+51$:
+        ld      a, (hl)
+        sub     d
+        add     a, b
+        ld      b, a
+6$:
+        ;; BC = c * e + (B << 8)
+        ld      a, c
+        sub     e
+        jr      nc, 7$
+        cpl
+        inc     a
+7$:
+        ld      l, a
+        ld      h, #>.qsq_lo
+        ld      d, (hl)
+        inc     h
+        inc     h
+        ld      a, b
+        sub     (hl)
+        ld      b, a            ; B -= high byte of sq(|c - e|)
+        ld      a, c
+        add     a, e
+        ld      l, a
+        ld      h, #>.qsq_lo
+        jr      nc, 8$
+        inc     h
+8$:
+        ld      a, (hl)
+        sub     d
+        ld      c, a
+        inc     h
+        inc     h
+        ld      a, (hl)
+        sbc     a, #0
+        add     a, b
+        ld      b, a
+        ret
+
+        ;; Signed versions multiply the absolute values, then fix the sign
+
+__mulschar:
+        ld      d, a
+        xor     e
+        push    af              ; Bit 7 = sign of the product
+        bit     7, e
+        jr      z, 1$
+        xor     a
+        sub     e
+        ld      e, a
+1$:
+        ld      a, d
+        bit     7, a
+        jr      z, .mul_sign
+        cpl
+        inc     a
+        jr      .mul_sign
+
+        ;; A unsigned, E signed
+__mulsuchar:
+        ld      d, a
+        ld      a, e
+        push    af              ; Bit 7 = sign of the product
+        bit     7, a
+        jr      z, 2$
+        cpl
+        inc     a
+        ld      e, a
+2$:
+        ld      a, d
+        jr      .mul_sign
+
+        ;; A signed, E unsigned
+__muluschar:
+        push    af              ; Bit 7 = sign of the product
+        bit     7, a
+        jr      z, .mul_sign
+        cpl
+        inc     a
+.mul_sign:
+        call    .mulu8x8
+        pop     af
+        rla
+        ret     nc
+        xor     a               ; Negate the product
+        sub     c
+        ld      c, a
+        sbc     a
+        sub     b
+        ld      b, a
+        ret
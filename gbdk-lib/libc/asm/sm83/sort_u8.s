@@ -0,0 +1,126 @@
+        .module sort_u8
+
+        ;; Counting sort over 8 bit keys, see sort_u8_order() in stdlib.h
+        ;;
+        ;; The bucket table is 256 bytes, too large for HRAM, so it is
+        ;; kept in WRAM. Each count fits in a byte since n <= 255.
+
+        .area   _DATA
+
+.sort_counts:
+        .ds     0x100
+.sort_order:
+        .ds     0x02
+.sort_index:
+        .ds     0x01
+
+        .area   _HOME
+
+; void sort_u8_order(uint8_t * order, const uint8_t * keys, uint8_t n, uint8_t stride)
+;DE: order
+;BC: keys
+;sp+2: n
+;sp+3: stride
+_sort_u8_order::
+        push    de              ; save order
+        push    bc              ; save keys
+        ldhl    sp, #6
+        ld      a, (hl+)
+        or      a
+        jr      z, 8$           ; n == 0: nothing to sort
+        ld      d, a            ; D = n
+        ld      e, (hl)         ; E = stride
+
+        ;; Clear the counts
+        ld      hl, #.sort_counts
+        xor     a
+        ld      c, #0x80
+1$:
+        ld      (hl+), a
+        ld      (hl+), a
+        dec     c
+        jr      nz, 1$
+
+        ;; Count the keys
+        pop     bc
+        push    bc
+        push    de
+2$:
+        ld      a, (bc)
+        add     a, #<.sort_counts
+        ld      l, a
+        adc     a, #>.sort_counts
+        sub     l
+        ld      h, a            ; HL = &counts[key]
+        inc     (hl)
+
+        ld      a, c            ; keys += stride
+        add     a, e
+        ld      c, a
+        jr      nc, 3$
+        inc     b
+3$:
+        dec     d
+        jr      nz, 2$
+        pop     de
+
+        ;; Turn the counts into the first position of each key
+        ld      hl, #.sort_counts
+        xor     a               ; A = running total
+        ld      c, a            ; 256 entries
+4$:
+        ld      b, (hl)
+        ld      (hl+), a
+        add     a, b
+        dec     c
+        jr      nz, 4$
+
+        ;; Write each index at the next position of its key, in order, so the sort is stable
+        pop     bc              ; BC = keys
+        pop     hl              ; HL = order
+        ld      a, l
+        ld      (.sort_order), a
+        ld      a, h
+        ld      (.sort_order + 1), a
+        xor     a
+        ld      (.sort_index), a
+5$:
+        ld      a, (bc)
+        add     a, #<.sort_counts
+        ld      l, a
+        adc     a, #>.sort_counts
+        sub     l
+        ld      h, a            ; HL = &counts[key]
+        ld      a, (hl)
+        inc     (hl)            ; A = position
+
+        ld      hl, #.sort_order
+        add     a, (hl)
+        inc     hl
+        ld      h, (hl)
+        ld      l, a
+        jr      nc, 6$
+        inc     h               ; HL = order + position
+6$:
+        ld      a, (.sort_index)
+        ld      (hl), a
+        inc     a
+        ld      (.sort_index), a
+
+        ld      a, c            ; keys += stride
+        add     a, e
+        ld      c, a
+        jr      nc, 7$
+        inc     b
+7$:
+        dec     d
+        jr      nz, 5$
+        jr      9$
+
+8$:
+        add     sp, #4
+9$:
+        ;; Remove n and stride from the stack
+        pop     hl
+        pop     af
+        jp      (hl)
@@ -35,10 +35,29 @@ _strlen::
         ld      A, (HL+)        
         ld      H, (HL)
         ld      L, A
-.strlen::       
-        ld      DE, #0
+.strlen::
+        ; Tests four characters per loop, the length is taken
+        ; from the end pointer
+        ld      D, H
+        ld      E, L
 1$:     ld      A, (HL+)
         or      A
-        ret     Z
-        inc     DE
-        jr      1$
+        jr      Z, 2$
+        ld      A, (HL+)
+        or      A
+        jr      Z, 2$
+        ld      A, (HL+)
+        or      A
+        jr      Z, 2$
+        ld      A, (HL+)
+        or      A
+        jr      NZ, 1$
+2$:     ; DE = HL - 1 - DE
+        scf
+        ld      A, L
+        sbc     E
+        ld      E, A
+        ld      A, H
+        sbc     D
+        ld      D, A
+        ret
@@ -0,0 +1,138 @@
+        .module xrand
+
+        ;; Xorshift random number generator, see xrand() in rand.h
+        ;;
+        ;;  X ^= X << 7, X ^= X >> 9, X ^= X << 8
+        ;;
+        ;; on a 16 bit state (J. Metcalf's shift triplet for 8 bit CPUs).
+        ;; It runs through all 65535 non zero values, and unlike the
+        ;; linear congruential rand() its low bits are as random as
+        ;; the high ones.
+
+        .area   _INITIALIZED
+
+___xrand_seed::
+        .ds     0x02
+
+        .area   _INITIALIZER
+
+        .word   0xA27E          ; Must not be 0
+
+        ;; One step on the state in HL, uses A
+.macro XORSHIFT
+        ld      a, h
+        rra
+        ld      a, l
+        rra
+        xor     h
+        ld      h, a
+        ld      a, l
+        rra
+        ld      a, h
+        rra
+        xor     l
+        ld      l, a
+        xor     h
+        ld      h, a
+.endm
+
+        .area   _HOME
+
+; void initxrand(uint16_t seed)
+;DE: seed
+_initxrand::
+        ld      a, d
+        or      e
+        jr      nz, 1$
+        inc     e               ; 0 would never change
+1$:
+        ld      hl, #___xrand_seed
+        ld      a, e
+        ld      (hl+), a
+        ld      (hl), d
+        ret
+
+; uint16_t xrandw(void)
+_xrandw::
+        call    .xrand
+        ld      b, h
+        ld      c, l
+        ret
+
+; uint8_t xrand(void)
+;   A = H = the new high byte, HL = the new state, BC and DE are kept
+_xrand::
+.xrand::
+        ld      hl, #___xrand_seed
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        XORSHIFT
+        ld      (___xrand_seed + 1), a
+        ld      a, l
+        ld      (___xrand_seed), a
+        ld      a, h
+        ret
+
+; void rand_fill(uint8_t * buf, uint16_t n)
+;DE: buf
+;BC: n
+;   Two bytes per step, the state stays in HL until the end
+_rand_fill::
+        ld      a, b
+        or      c
+        ret     z
+        ld      hl, #___xrand_seed
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+1$:
+        XORSHIFT
+        ld      a, l
+        ld      (de), a
+        inc     de
+        dec     bc
+        ld      a, b
+        or      c
+        jr      z, 2$
+        ld      a, h
+        ld      (de), a
+        inc     de
+        dec     bc
+        ld      a, b
+        or      c
+        jr      nz, 1$
+2$:
+        ld      a, l
+        ld      (___xrand_seed), a
+        ld      a, h
+        ld      (___xrand_seed + 1), a
+        ret
+
+; uint8_t rand_range(uint8_t n)
+;A: n
+;   Draws with the bits of n - 1 and retries until it is below n,
+;   which is unbiased and retries less than half of the time
+_rand_range::
+        or      a
+        jr      z, .xrand       ; 0: any byte
+        ld      c, a            ; C = n
+        dec     a
+        ld      b, a
+        srl     a
+        or      b
+        ld      b, a
+        srl     a
+        srl     a
+        or      b
+        ld      b, a
+        swap    a
+        and     #0x0F
+        or      b
+        ld      b, a            ; B = mask covering n - 1
+1$:
+        call    .xrand
+        and     b
+        cp      c
+        jr      nc, 1$
+        ret
@@ -0,0 +1,64 @@
+        .module bsearch_u16
+
+        ;; Search of a key table in Eytzinger order, see bsearch_u16() in stdlib.h
+        ;;
+        ;; The index i counts from 1, so the children of i are 2 * i and
+        ;; 2 * i + 1 and a step is a single rotate through the carry of the
+        ;; compare.
+
+        .area   _DATA
+
+.bsearch_base:
+        .ds     0x02
+.bsearch_n:
+        .ds     0x02
+
+        .area   _CODE
+
+;; uint16_t bsearch_u16(uint16_t key, const uint16_t * keys, uint16_t n) __z88dk_callee;
+_bsearch_u16::
+        pop     hl              ; HL = ret
+        pop     de              ; DE = key
+        pop     bc              ; BC = keys
+        ex      (sp), hl        ; HL = n
+
+        ld      (.bsearch_n), hl
+        dec     bc
+        dec     bc
+        ld      (.bsearch_base), bc     ; keys - 2
+        ld      bc, #1          ; BC = i
+1$:
+        ld      hl, (.bsearch_n)
+        or      a
+        sbc     hl, bc
+        jr      c, 3$           ; i > n: not found
+
+        ld      h, b
+        ld      l, c
+        add     hl, hl
+        push    de
+        ld      de, (.bsearch_base)
+        add     hl, de          ; HL = &keys[i - 1]
+        pop     de
+
+        ;; Compare with the key, high byte first
+        inc     hl
+        ld      a, (hl)
+        cp      d
+        jr      nz, 2$
+        dec     hl
+        ld      a, (hl)
+        cp      e
+        jr      z, 4$           ; found
+2$:
+        rl      c               ; carry set if keys[i - 1] < key
+        rl      b               ; i = 2 * i + carry
+        jr      nc, 1$
+3$:
+        ld      hl, #0xFFFF
+        ret
+4$:
+        dec     bc
+        ld      h, b
+        ld      l, c
+        ret
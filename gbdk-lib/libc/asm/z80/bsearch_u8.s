@@ -0,0 +1,44 @@
+        .module bsearch_u8
+
+        ;; Search of a key table in Eytzinger order, see bsearch_u8() in stdlib.h
+        ;;
+        ;; The index i counts from 1, so the children of i are 2 * i and
+        ;; 2 * i + 1 and a step is a single rotate through the carry of the
+        ;; compare. An index which leaves the 8 bits is past n as well.
+
+        .area   _CODE
+
+;; uint8_t bsearch_u8(uint8_t key, const uint8_t * keys, uint8_t n) __z88dk_callee;
+_bsearch_u8::
+        pop     hl              ; HL = ret
+        dec     sp
+        pop     af              ; A = key
+        pop     de              ; DE = keys
+        dec     sp
+        ex      (sp), hl        ; H = n
+
+        ld      b, h            ; B = n
+        dec     de              ; DE = keys - 1
+        ld      c, #1           ; C = i
+1$:
+        ld      h, a
+        ld      a, b
+        cp      c
+        ld      a, h
+        jr      c, 3$           ; i > n: not found
+
+        ld      l, c
+        ld      h, #0
+        add     hl, de          ; HL = &keys[i - 1]
+        cp      (hl)
+        jr      z, 2$           ; found
+        ccf                     ; carry set if keys[i - 1] < key
+        rl      c               ; i = 2 * i + carry
+        jr      nc, 1$
+3$:
+        ld      l, #0xFF
+        ret
+2$:
+        dec     c
+        ld      l, c
+        ret
@@ -0,0 +1,112 @@
+        .module div_u8
+
+        ;; Unsigned 8 bit division, see gbdk/fastdiv.h
+        ;;
+        ;; __divuchar goes through the generic 16 bit loop, which takes
+        ;; 16 iterations. This only has 8, and they are unrolled.
+
+        .area   _CODE
+
+;; uint8_t div_u8(uint8_t a, uint8_t b)
+;; A: a
+;; L: b
+_div_u8::
+        call    .div_mod_u8
+        ld      a, e
+        ret
+
+;; uint16_t div_mod_u8(uint8_t a, uint8_t b)
+;; A: a
+;; L: b
+_div_mod_u8::
+        call    .div_mod_u8
+        ld      d, a            ; D = remainder, E = quotient
+        ret
+
+        ;; Entry conditions
+        ;;   A = dividend
+        ;;   L = divisor
+        ;;
+        ;; Exit conditions
+        ;;   E = quotient
+        ;;   A = remainder
+        ;;
+        ;; Register used: AF,E
+;; uint8_t mod_u8(uint8_t a, uint8_t b)
+_mod_u8::
+.div_mod_u8::
+        ld      e, a
+        xor     a
+        sla     e
+        rla
+        jr      c, 1$
+        cp      l
+        jr      c, 2$
+1$:
+        sub     l
+        inc     e
+2$:
+        sla     e
+        rla
+        jr      c, 3$
+        cp      l
+        jr      c, 4$
+3$:
+        sub     l
+        inc     e
+4$:
+        sla     e
+        rla
+        jr      c, 5$
+        cp      l
+        jr      c, 6$
+5$:
+        sub     l
+        inc     e
+6$:
+        sla     e
+        rla
+        jr      c, 7$
+        cp      l
+        jr      c, 8$
+7$:
+        sub     l
+        inc     e
+8$:
+        sla     e
+        rla
+        jr      c, 9$
+        cp      l
+        jr      c, 10$
+9$:
+        sub     l
+        inc     e
+10$:
+        sla     e
+        rla
+        jr      c, 11$
+        cp      l
+        jr      c, 12$
+11$:
+        sub     l
+        inc     e
+12$:
+        sla     e
+        rla
+        jr      c, 13$
+        cp      l
+        jr      c, 14$
+13$:
+        sub     l
+        inc     e
+14$:
+        sla     e
+        rla
+        jr      c, 15$
+        cp      l
+        jr      c, 16$
+15$:
+        sub     l
+        inc     e
+16$:
+        ret
@@ -0,0 +1,251 @@
+        .module divlong
+
+        ;; 32 bit divide and modulus for libc/_divulong.c, _modulong.c,
+        ;; _divslong.c and _modslong.c
+        ;;
+        ;; The operands are passed by address, so this doesn't depend on how
+        ;; 32 bit arguments are passed. The quotient replaces the dividend
+        ;; and the remainder the divisor.
+        ;;
+        ;; A divisor that fits 16 bits is divided into the high word and
+        ;; then the low word, 16 rounds each, and the high word is skipped
+        ;; when it is below the divisor. With a larger divisor the quotient
+        ;; fits 16 bits, so that takes 16 rounds as well.
+
+        .area   _CODE
+
+;; void _divslong_ptr(long * x, long * y)
+;; HL: x, gets the quotient
+;; DE: y, gets the remainder, which has the sign of x
+__divslong_ptr::
+        push    hl
+        push    de
+        call    .labs_ptr               ; x = |x|, A = its high byte
+        ld      b, a                    ; B bit 7: sign of the remainder
+        ex      de, hl
+        call    .labs_ptr               ; y = |y|
+        xor     b
+        ld      c, a                    ; C bit 7: sign of the quotient
+        pop     de
+        pop     hl
+        push    bc
+        push    hl
+        push    de
+        call    __divulong_ptr
+        pop     hl                      ; &y
+        pop     de                      ; &x
+        pop     bc
+        bit     7, b
+        call    nz, .lneg_ptr
+        ex      de, hl
+        bit     7, c
+        ret     z
+        ;; Fall through
+
+        ;; Negates the long at HL
+        ;;
+        ;; Register used: AF,HL
+.lneg_ptr:
+        xor     a
+        sub     (hl)
+        ld      (hl), a
+        inc     hl
+        ld      a, #0
+        sbc     a, (hl)
+        ld      (hl), a
+        inc     hl
+        ld      a, #0
+        sbc     a, (hl)
+        ld      (hl), a
+        inc     hl
+        ld      a, #0
+        sbc     a, (hl)
+        ld      (hl), a
+        ret
+
+        ;; Negates the long at HL if it is negative
+        ;;
+        ;; Exit conditions
+        ;;   A = high byte it had
+        ;;
+        ;; Register used: AF,HL
+.labs_ptr:
+        inc     hl
+        inc     hl
+        inc     hl
+        ld      a, (hl)
+        dec     hl
+        dec     hl
+        dec     hl
+        or      a
+        ret     p
+        push    af
+        call    .lneg_ptr
+        pop     af
+        ret
+
+;; void _divulong_ptr(unsigned long * x, unsigned long * y)
+;; HL: x, gets the quotient
+;; DE: y, gets the remainder
+__divulong_ptr::
+        push    hl                      ; &x
+        push    de
+        pop     iy                      ; IY = &y
+        ld      c, 0 (iy)
+        ld      b, 1 (iy)               ; BC = y low
+        ld      a, 2 (iy)
+        or      3 (iy)
+        jr      nz, .divulong_32
+
+        ;; 16 bit divisor
+        inc     hl
+        inc     hl
+        ld      a, (hl)
+        inc     hl
+        ld      h, (hl)
+        ld      l, a                    ; HL = x high
+        ld      de, #0
+        sbc     hl, bc                  ; carry is clear after the or
+        add     hl, bc
+        jr      c, 1$                   ; x high < y: it is the remainder
+        ex      de, hl
+        call    .div32_16               ; DE = x high / y, HL = x high % y
+1$:
+        ex      (sp), hl                ; HL = &x
+        inc     hl
+        inc     hl
+        ld      (hl), e
+        inc     hl
+        ld      (hl), d                 ; x high = quotient high
+        dec     hl
+        dec     hl
+        ld      d, (hl)
+        dec     hl
+        ld      e, (hl)                 ; DE = x low
+        ex      (sp), hl
+        call    .div32_16               ; DE = quotient low, HL = remainder
+
+        ld      0 (iy), l
+        ld      1 (iy), h
+        xor     a
+        ld      2 (iy), a
+        ld      3 (iy), a
+        pop     hl                      ; HL = &x
+        ld      (hl), e
+        inc     hl
+        ld      (hl), d
+        ret
+
+        ;; 32 bit divisor, HL = &x
+.divulong_32:
+        push    iy                      ; &y
+        push    ix
+        ld      e, (hl)
+        inc     hl
+        ld      d, (hl)
+        inc     hl
+        push    de
+        pop     ix                      ; IX = x low, becomes the quotient
+        ld      a, (hl)
+        inc     hl
+        ld      h, (hl)
+        ld      l, a                    ; HL = x high, the start of the remainder
+        ld      e, 2 (iy)
+        ld      d, 3 (iy)
+        ld      a, #16
+        push    af
+        push    de
+        push    bc
+        ld      iy, #0
+        add     iy, sp                  ; IY = copy of y, the round counter in 5 (iy)
+        ld      de, #0                  ; DEHL = remainder
+1$:
+        add     ix, ix                  ; next bit of x
+        adc     hl, hl
+        ex      de, hl
+        adc     hl, hl
+        ex      de, hl
+        sbc     a, a                    ; A = 0xFF when the remainder has 33 bits
+        push    de
+        push    hl
+        ld      c, 0 (iy)
+        ld      b, 1 (iy)
+        or      a
+        sbc     hl, bc
+        ex      de, hl
+        ld      c, 2 (iy)
+        ld      b, 3 (iy)
+        sbc     hl, bc
+        ex      de, hl
+        sbc     a, #0                   ; 33 bit borrow
+        jr      c, 2$
+        inc     ix                      ; quotient bit
+        pop     bc
+        pop     bc
+        jr      3$
+2$:
+        pop     hl                      ; remainder < y: undo
+        pop     de
+3$:
+        dec     5 (iy)
+        jr      nz, 1$
+
+        pop     bc
+        pop     bc
+        pop     af
+        push    ix
+        pop     bc                      ; BC = quotient
+        pop     ix
+        pop     iy                      ; IY = &y
+        ld      0 (iy), l
+        ld      1 (iy), h
+        ld      2 (iy), e
+        ld      3 (iy), d
+        pop     hl                      ; HL = &x
+        ld      (hl), c
+        inc     hl
+        ld      (hl), b
+        inc     hl
+        xor     a
+        ld      (hl), a
+        inc     hl
+        ld      (hl), a
+        ret
+
+        ;; HL:DE / BC, HL must be below BC
+        ;;
+        ;; Exit conditions
+        ;;   DE = quotient
+        ;;   HL = remainder
+        ;;
+        ;; Only 8 rounds when HL:DE fits a byte
+        ;;
+        ;; Register used: AF,DE,HL
+.div32_16:
+        ld      a, h
+        or      l
+        or      d
+        ld      a, #16
+        jr      nz, 1$
+        ld      d, e
+        ld      e, h
+        ld      a, #8
+1$:
+        sla     e
+        rl      d
+        adc     hl, hl
+        jr      c, 2$                   ; 17 bit remainder is always >= BC
+        sbc     hl, bc
+        jr      nc, 3$
+        add     hl, bc
+        dec     a
+        jr      nz, 1$
+        ret
+2$:
+        or      a
+        sbc     hl, bc
+3$:
+        inc     e                       ; quotient bit
+        dec     a
+        jr      nz, 1$
+        ret
@@ -0,0 +1,114 @@
+        .module mullong
+
+        ;; 32 bit multiply for _mullong() in libc/_mullong.c
+        ;;
+        ;; The operands are passed by address, so this doesn't depend on how
+        ;; 32 bit arguments are passed. The product is built from 16 bit
+        ;; parts: the two cross products are skipped when the high words
+        ;; are zero, and the low word product only takes 8 rounds when
+        ;; one of the low words fits a byte.
+
+        .area   _CODE
+
+;; void _mullong_ptr(long * a, const long * b)
+;; HL: a, gets the product
+;; DE: b
+__mullong_ptr::
+        push    hl
+        pop     iy                      ; IY = &a
+        ex      de, hl
+        ld      e, (hl)
+        inc     hl
+        ld      d, (hl)                 ; DE = b low
+        inc     hl
+        ld      c, (hl)
+        inc     hl
+        ld      b, (hl)                 ; BC = b high
+        push    de
+
+        ;; Cross products, only their low word is needed
+        ld      e, 0 (iy)
+        ld      d, 1 (iy)
+        ld      hl, #0
+        call    .mul16_add              ; b high * a low
+        pop     de
+        push    de                      ; DE = b low
+        ld      c, 2 (iy)
+        ld      b, 3 (iy)
+        call    .mul16_add              ; + a high * b low
+
+        pop     bc                      ; BC = b low
+        push    hl
+        ld      e, 0 (iy)
+        ld      d, 1 (iy)
+        call    .mul16_32               ; DEHL = a low * b low
+        pop     bc
+        ld      0 (iy), l
+        ld      1 (iy), h
+        ex      de, hl
+        add     hl, bc                  ; high word += cross products
+        ld      2 (iy), l
+        ld      3 (iy), h
+        ret
+
+        ;; HL += BC * DE, low 16 bits
+        ;;
+        ;; Stops once the rest of the multiplier in BC is zero
+        ;;
+        ;; Register used: AF,BC,DE,HL
+.mul16_add:
+        ld      a, d
+        or      e
+        ret     z
+1$:
+        srl     b
+        rr      c
+        jr      nc, 2$
+        add     hl, de
+2$:
+        ld      a, b
+        or      c
+        ret     z
+        sla     e
+        rl      d
+        jr      1$
+
+        ;; DEHL = DE * BC, 16 x 16 -> 32 bit unsigned
+        ;;
+        ;; The bits of the multiplier in DE are shifted out of the top of
+        ;; DEHL while the product grows in from the bottom. If either
+        ;; operand fits a byte it becomes the multiplier, and only 8
+        ;; rounds are needed.
+        ;;
+        ;; Register used: AF,BC,DE,HL
+.mul16_32:
+        ld      hl, #0
+        ld      a, d
+        or      a
+        jr      z, 1$
+        ld      a, b
+        or      a
+        jr      nz, 2$
+        ld      b, d                    ; BC fits a byte: swap the operands
+        ld      a, c
+        ld      c, e
+        ld      e, a
+1$:
+        ld      d, e
+        ld      e, l
+        ld      a, #8
+        jr      3$
+2$:
+        ld      a, #16
+3$:
+        add     hl, hl
+        rl      e
+        rl      d
+        jr      nc, 4$
+        add     hl, bc
+        jr      nc, 4$
+        inc     de
+4$:
+        dec     a
+        jr      nz, 3$
+        ret
@@ -0,0 +1,113 @@
+        .module sort_u8
+
+        ;; Counting sort over 8 bit keys, see sort_u8_order() in stdlib.h
+        ;;
+        ;; The bucket table is 256 bytes, kept in RAM.
+        ;; Each count fits in a byte since n <= 255.
+
+        .area   _DATA
+
+.sort_counts:
+        .ds     0x100
+.sort_order:
+        .ds     0x02
+.sort_index:
+        .ds     0x01
+
+        .area   _CODE
+
+;; void sort_u8_order(uint8_t * order, const uint8_t * keys, uint8_t n, uint8_t stride) __z88dk_callee;
+_sort_u8_order::
+        pop     hl              ; HL = ret
+        pop     de              ; DE = order
+        pop     bc              ; BC = keys
+        ex      (sp), hl        ; L = n, H = stride
+
+        ld      a, l
+        or      a
+        ret     z               ; n == 0: nothing to sort
+
+        ld      (.sort_order), de
+        ld      d, b
+        ld      e, c            ; DE = keys
+        ld      b, l            ; B = n
+        ld      c, h            ; C = stride
+        push    de
+        push    bc
+
+        ;; Clear the counts
+        ld      hl, #.sort_counts
+        xor     a
+        ld      b, #0x80
+1$:
+        ld      (hl), a
+        inc     hl
+        ld      (hl), a
+        inc     hl
+        djnz    1$
+
+        ;; Count the keys
+        pop     bc
+        push    bc
+2$:
+        ld      a, (de)
+        add     a, #<.sort_counts
+        ld      l, a
+        adc     a, #>.sort_counts
+        sub     l
+        ld      h, a            ; HL = &counts[key]
+        inc     (hl)
+
+        ld      a, e            ; keys += stride
+        add     a, c
+        ld      e, a
+        jr      nc, 3$
+        inc     d
+3$:
+        djnz    2$
+
+        ;; Turn the counts into the first position of each key
+        ld      hl, #.sort_counts
+        xor     a               ; A = running total
+        ld      b, a            ; 256 entries
+4$:
+        ld      c, (hl)
+        ld      (hl), a
+        add     a, c
+        inc     hl
+        djnz    4$
+
+        ;; Write each index at the next position of its key, in order, so the sort is stable
+        pop     bc              ; B = n, C = stride
+        pop     de              ; DE = keys
+        xor     a
+        ld      (.sort_index), a
+5$:
+        ld      a, (de)
+        add     a, #<.sort_counts
+        ld      l, a
+        adc     a, #>.sort_counts
+        sub     l
+        ld      h, a            ; HL = &counts[key]
+        ld      a, (hl)
+        inc     (hl)            ; A = position
+
+        ld      hl, (.sort_order)
+        add     a, l
+        ld      l, a
+        jr      nc, 6$
+        inc     h               ; HL = order + position
+6$:
+        ld      a, (.sort_index)
+        ld      (hl), a
+        inc     a
+        ld      (.sort_index), a
+
+        ld      a, e            ; keys += stride
+        add     a, c
+        ld      e, a
+        jr      nc, 7$
+        inc     d
+7$:
+        djnz    5$
+        ret
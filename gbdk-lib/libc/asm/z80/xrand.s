@@ -0,0 +1,128 @@
+        .module xrand
+
+        ;; Xorshift random number generator, see xrand() in rand.h
+        ;;
+        ;;  X ^= X << 7, X ^= X >> 9, X ^= X << 8
+        ;;
+        ;; on a 16 bit state (J. Metcalf's shift triplet for 8 bit CPUs).
+        ;; It runs through all 65535 non zero values, and unlike the
+        ;; linear congruential rand() its low bits are as random as
+        ;; the high ones.
+
+        .area   _INITIALIZED
+
+___xrand_seed::
+        .ds     0x02
+
+        .area   _INITIALIZER
+
+        .word   0xA27E          ; Must not be 0
+
+        ;; One step on the state in HL, uses A
+.macro XORSHIFT
+        ld      a, h
+        rra
+        ld      a, l
+        rra
+        xor     h
+        ld      h, a
+        ld      a, l
+        rra
+        ld      a, h
+        rra
+        xor     l
+        ld      l, a
+        xor     h
+        ld      h, a
+.endm
+
+        .area   _CODE
+
+; void initxrand(uint16_t seed)
+;HL: seed
+_initxrand::
+        ld      a, h
+        or      l
+        jr      nz, 1$
+        inc     l               ; 0 would never change
+1$:
+        ld      (___xrand_seed), hl
+        ret
+
+; uint16_t xrandw(void)
+_xrandw::
+        call    .xrand
+        ex      de, hl
+        ret
+
+; uint8_t xrand(void)
+;   A = H = the new high byte, HL = the new state, BC and DE are kept
+_xrand::
+.xrand::
+        ld      hl, (___xrand_seed)
+        XORSHIFT
+        ld      (___xrand_seed), hl
+        ret
+
+; void rand_fill(uint8_t * buf, uint16_t n)
+;HL: buf
+;DE: n
+;   Two bytes per step, the state stays in HL until the end
+_rand_fill::
+        ld      a, d
+        or      e
+        ret     z
+        ld      b, d
+        ld      c, e            ; BC = n
+        ex      de, hl          ; DE = buf
+        ld      hl, (___xrand_seed)
+1$:
+        XORSHIFT
+        ld      a, l
+        ld      (de), a
+        inc     de
+        dec     bc
+        ld      a, b
+        or      c
+        jr      z, 2$
+        ld      a, h
+        ld      (de), a
+        inc     de
+        dec     bc
+        ld      a, b
+        or      c
+        jr      nz, 1$
+2$:
+        ld      (___xrand_seed), hl
+        ret
+
+; uint8_t rand_range(uint8_t n)
+;A: n
+;   Draws with the bits of n - 1 and retries until it is below n,
+;   which is unbiased and retries less than half of the time
+_rand_range::
+        or      a
+        jr      z, .xrand       ; 0: any byte
+        ld      c, a            ; C = n
+        dec     a
+        ld      b, a
+        srl     a
+        or      b
+        ld      b, a
+        srl     a
+        srl     a
+        or      b
+        ld      b, a
+        rrca
+        rrca
+        rrca
+        rrca
+        and     #0x0F
+        or      b
+        ld      b, a            ; B = mask covering n - 1
+1$:
+        call    .xrand
+        and     b
+        cp      c
+        jr      nc, 1$
+        ret
@@ -0,0 +1,112 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <gbdk/collide.h>
+
+/* Rectangle collision with a uniform grid broadphase, see gbdk/collide.h
+
+   Each cell has a list of entries, newest first. A pair of rectangles
+   which share more than one cell is only reported in the cell with the
+   top left corner of their overlap, which both of them touch. */
+
+#define CELL_SHIFT 5
+#define CELL(x, y) ((uint8_t)(((y) >> CELL_SHIFT) << 3) | (uint8_t)((x) >> CELL_SHIFT))
+
+/* The edges can't wrap around (x + w <= 256), so the difference of the
+   left edges only has to be below the width of the one further left */
+#define OVERLAP_1D(a0, a1, b0, b1) (((uint8_t)((b0) - (a0)) < (a1)) || ((uint8_t)((a0) - (b0)) < (b1)))
+#define OVERLAP(a, b) (OVERLAP_1D((a)->x, (a)->w, (b)->x, (b)->w) && OVERLAP_1D((a)->y, (a)->h, (b)->y, (b)->h))
+
+static uint8_t overlap_cell(const collide_rect_t * a, const collide_rect_t * b)
+{
+    uint8_t x = (a->x > b->x) ? a->x : b->x;
+    uint8_t y = (a->y > b->y) ? a->y : b->y;
+    return CELL(x, y);
+}
+
+void collide_init(collide_grid_t * grid, collide_entry_t * entries, uint8_t entry_count)
+{
+    grid->rects = NULL;
+    grid->entries = entries;
+    grid->entry_count = entry_count;
+    grid->used = 0;
+    memset(grid->head, COLLIDE_NONE, COLLIDE_CELLS);
+}
+
+uint8_t collide_build(collide_grid_t * grid, const collide_rect_t * rects, uint8_t count)
+{
+    collide_entry_t * entries = grid->entries;
+    const collide_rect_t * r = rects;
+    uint8_t used = 0, id, cx, cy, cx0, cx1, cy1, cell;
+
+    memset(grid->head, COLLIDE_NONE, COLLIDE_CELLS);
+    grid->rects = rects;
+
+    for (id = 0; id != count; id++, r++) {
+        if (!r->w || !r->h) continue;
+        cx0 = r->x >> CELL_SHIFT;
+        cx1 = (uint8_t)(r->x + r->w - 1) >> CELL_SHIFT;
+        cy = r->y >> CELL_SHIFT;
+        cy1 = (uint8_t)(r->y + r->h - 1) >> CELL_SHIFT;
+        if ((uint8_t)((cx1 - cx0 + 1) * (cy1 - cy + 1)) > (uint8_t)(grid->entry_count - used)) break;
+
+        for (; cy <= cy1; cy++) {
+            for (cx = cx0; cx <= cx1; cx++) {
+                cell = (uint8_t)(cy << 3) | cx;
+                entries[used].id = id;
+                entries[used].next = grid->head[cell];
+                grid->head[cell] = used++;
+            }
+        }
+    }
+    grid->used = used;
+    return id;
+}
+
+void collide_pairs(collide_grid_t * grid, collide_pair_fn fn)
+{
+    const collide_rect_t * rects = grid->rects;
+    const collide_entry_t * entries = grid->entries;
+    const collide_rect_t * a, * b;
+    uint8_t cell, i, j;
+
+    for (cell = 0; cell != COLLIDE_CELLS; cell++) {
+        for (i = grid->head[cell]; i != COLLIDE_NONE; i = entries[i].next) {
+            a = rects + entries[i].id;
+            for (j = entries[i].next; j != COLLIDE_NONE; j = entries[j].next) {
+                b = rects + entries[j].id;
+                if (OVERLAP(a, b) && (overlap_cell(a, b) == cell))
+                    fn(entries[j].id, entries[i].id);
+            }
+        }
+    }
+}
+
+void collide_query(collide_grid_t * grid, const collide_rect_t * rect, collide_hit_fn fn)
+{
+    const collide_rect_t * rects = grid->rects;
+    const collide_entry_t * entries = grid->entries;
+    const collide_rect_t * b;
+    uint8_t cx, cy, cx0, cx1, cy1, cell, j;
+
+    if (!rect->w || !rect->h) return;
+    cx0 = rect->x >> CELL_SHIFT;
+    cx1 = (uint8_t)(rect->x + rect->w - 1) >> CELL_SHIFT;
+    cy1 = (uint8_t)(rect->y + rect->h - 1) >> CELL_SHIFT;
+
+    for (cy = rect->y >> CELL_SHIFT; cy <= cy1; cy++) {
+        for (cx = cx0; cx <= cx1; cx++) {
+            cell = (uint8_t)(cy << 3) | cx;
+            for (j = grid->head[cell]; j != COLLIDE_NONE; j = entries[j].next) {
+                b = rects + entries[j].id;
+                if (OVERLAP(rect, b) && (overlap_cell(rect, b) == cell))
+                    fn(entries[j].id);
+            }
+        }
+    }
+}
+
+uint8_t collide_overlap(const collide_rect_t * a, const collide_rect_t * b)
+{
+    return OVERLAP(a, b);
+}
@@ -0,0 +1,41 @@
+#include <stdint.h>
+#include <gbdk/entities.h>
+
+/* Structure of arrays entity table, see gbdk/entities.h
+   live[] is a permutation of all ids with the live ones first, and
+   slot[] is its inverse, so an id is freed by swapping it with the
+   last live one */
+
+void entity_init(entity_table_t * table, uint8_t * live, uint8_t * slot, uint8_t capacity)
+{
+    uint8_t i;
+
+    table->live = live;
+    table->slot = slot;
+    table->capacity = capacity;
+    table->count = 0;
+    for (i = 0; i != capacity; i++) {
+        live[i] = i;
+        slot[i] = i;
+    }
+}
+
+uint8_t entity_alloc(entity_table_t * table)
+{
+    if (table->count == table->capacity) return ENTITY_NONE;
+    return table->live[table->count++];
+}
+
+void entity_free(entity_table_t * table, uint8_t id)
+{
+    uint8_t * live = table->live;
+    uint8_t * slot = table->slot;
+    uint8_t pos = slot[id];
+    uint8_t last = --table->count;
+    uint8_t last_id = live[last];
+
+    live[pos] = last_id;
+    slot[last_id] = pos;
+    live[last] = id;
+    slot[id] = last;
+}
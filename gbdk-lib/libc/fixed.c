@@ -0,0 +1,159 @@
+#include <stdint.h>
+#include <gbdk/fixed.h>
+
+/* Fixed point math, see gbdk/fixed.h
+   Everything runs on the magnitudes, and multiplies are split into
+   8 x 8 bit products so _mullong is never called */
+
+#define MUL8(a, b) ((uint16_t)(uint8_t)(a) * (uint8_t)(b))
+
+/* round(sin(i * 2 * pi / 256) * 256) for a quarter circle, sin(64) = 256 is handled separately */
+static const uint8_t sin_table[64] = {
+      0,   6,  13,  19,  25,  31,  38,  44,  50,  56,  62,  68,  74,  80,  86,  92,
+     98, 104, 109, 115, 121, 126, 132, 137, 142, 147, 152, 157, 162, 167, 172, 177,
+    181, 185, 190, 194, 198, 202, 206, 209, 213, 216, 220, 223, 226, 229, 231, 234,
+    237, 239, 241, 243, 245, 247, 248, 250, 251, 252, 253, 254, 255, 255, 255, 255
+};
+
+/* round(atan(i / 64) * 128 / pi), one octant */
+static const uint8_t atan_table[65] = {
+      0,   1,   1,   2,   3,   3,   4,   4,   5,   6,   6,   7,   8,   8,   9,   9,
+     10,  11,  11,  12,  12,  13,  13,  14,  15,  15,  16,  16,  17,  17,  18,  18,
+     19,  19,  20,  20,  21,  21,  22,  22,  23,  23,  24,  24,  25,  25,  25,  26,
+     26,  27,  27,  27,  28,  28,  29,  29,  29,  30,  30,  30,  31,  31,  31,  32,
+     32
+};
+
+fixed8_8 fixed8_8_mul(fixed8_8 a, fixed8_8 b)
+{
+    uint16_t ua = (uint16_t)a, ub = (uint16_t)b, r;
+    uint8_t neg = 0;
+
+    if (a < 0) { ua = -ua; neg = 1; }
+    if (b < 0) { ub = -ub; neg ^= 1; }
+
+    r = (MUL8(ua >> 8, ub >> 8) << 8) + MUL8(ua >> 8, ub) + MUL8(ua, ub >> 8) + (MUL8(ua, ub) >> 8);
+    return (neg) ? -(fixed8_8)r : (fixed8_8)r;
+}
+
+fixed8_8 fixed8_8_div(fixed8_8 a, fixed8_8 b)
+{
+    uint16_t ua = (uint16_t)a, ub = (uint16_t)b, rem = 0, q = 0;
+    uint8_t i, neg = 0;
+
+    if (a < 0) { ua = -ua; neg = 1; }
+    if (b < 0) { ub = -ub; neg ^= 1; }
+
+    /* (ua << 8) / ub, one quotient bit per step */
+    if (ub) {
+        for (i = 24; i; i--) {
+            rem = (rem << 1) | (ua >> 15);
+            ua <<= 1;
+            if (q & 0x8000) break;
+            q <<= 1;
+            if (rem >= ub) { rem -= ub; q |= 1; }
+        }
+    }
+    if ((!ub) || (q > 0x7FFF)) q = 0x7FFF;
+    return (neg) ? -(fixed8_8)q : (fixed8_8)q;
+}
+
+fixed8_8 fixed8_8_sqrt(fixed8_8 x)
+{
+    /* Integer square root of x << 8, two bits per step. The remainder
+       stays below 2 * root + 1, so it fits in 16 bits */
+    uint16_t v = (uint16_t)x, root = 0, rem = 0, trial;
+    uint8_t i;
+
+    if (x <= 0) return 0;
+
+    for (i = 12; i; i--) {
+        rem = (rem << 2) | (v >> 14);
+        v <<= 2;
+        trial = (root << 2) | 1;
+        root <<= 1;
+        if (rem >= trial) { rem -= trial; root |= 1; }
+    }
+    return (fixed8_8)root;
+}
+
+/* 16 x 16 bit multiply with a 32 bit result, from four 8 x 8 bit products */
+static uint32_t mul16(uint16_t a, uint16_t b)
+{
+    uint32_t r = ((uint32_t)MUL8(a >> 8, b >> 8) << 16) | MUL8(a, b);
+
+    r += (uint32_t)MUL8(a >> 8, b) << 8;
+    r += (uint32_t)MUL8(a, b >> 8) << 8;
+    return r;
+}
+
+fixed16_16 fixed16_16_mul(fixed16_16 a, fixed16_16 b)
+{
+    uint32_t ua = (uint32_t)a, ub = (uint32_t)b, r;
+    uint8_t neg = 0;
+
+    if (a < 0) { ua = -ua; neg = 1; }
+    if (b < 0) { ub = -ub; neg ^= 1; }
+
+    r = ((uint32_t)(uint16_t)((uint16_t)(ua >> 16) * (uint16_t)(ub >> 16)) << 16)
+        + mul16(ua >> 16, ub) + mul16(ua, ub >> 16) + (mul16(ua, ub) >> 16);
+    return (neg) ? -(fixed16_16)r : (fixed16_16)r;
+}
+
+fixed16_16 fixed16_16_div(fixed16_16 a, fixed16_16 b)
+{
+    uint32_t ua = (uint32_t)a, ub = (uint32_t)b, rem = 0, q = 0;
+    uint8_t i, neg = 0;
+
+    if (a < 0) { ua = -ua; neg = 1; }
+    if (!b) return (neg) ? -0x7FFFFFFFL : 0x7FFFFFFFL;
+    if (b < 0) { ub = -ub; neg ^= 1; }
+
+    /* (ua << 16) / ub, one quotient bit per step */
+    for (i = 48; i; i--) {
+        rem = (rem << 1) | (ua >> 31);
+        ua <<= 1;
+        q <<= 1;
+        if (rem >= ub) { rem -= ub; q |= 1; }
+    }
+    return (neg) ? -(fixed16_16)q : (fixed16_16)q;
+}
+
+fixed8_8 fixed_sin(uint8_t angle)
+{
+    uint8_t i = angle & 0x3F;
+    fixed8_8 v;
+
+    if (angle & 0x40) {
+        v = (i) ? sin_table[64 - i] : 256;
+    } else {
+        v = sin_table[i];
+    }
+    return (angle & 0x80) ? -v : v;
+}
+
+uint8_t fixed_atan2(int16_t y, int16_t x)
+{
+    uint16_t ax = (uint16_t)x, ay = (uint16_t)y;
+    uint8_t a;
+
+    if (x < 0) ax = -ax;
+    if (y < 0) ay = -ay;
+    if (!(ax | ay)) return 0;
+
+    /* Scale down so the rounded ratio below fits in 16 bits */
+    while ((ax | ay) & 0xFE00) {
+        ax >>= 1;
+        ay >>= 1;
+    }
+    /* Round to the nearest table entry instead of truncating, which
+       added up to one more step to the rounding of the table itself */
+    if (ay <= ax) {
+        a = atan_table[((ay << 6) + (ax >> 1)) / ax];
+    } else {
+        a = 64 - atan_table[((ax << 6) + (ay >> 1)) / ay];
+    }
+    if (x < 0) a = 128 - a;
+    if (y < 0) a = -a;
+    return a;
+}
@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <string.h>
+#include <gbdk/flowfield.h>
+
+/* Flow field pathfinding, see gbdk/flowfield.h
+
+   A breadth first search from the target: each tile taken from the
+   queue gives its open neighbours which are still FLOW_NONE the
+   direction back towards it, and queues them. A tile is queued at
+   most once, so the queue never holds more than width * height
+   entries and doesn't need to wrap */
+
+void flowfield_init(flowfield_t * ff, uint8_t * field, uint16_t * queue, const uint8_t * map, uint8_t map_shift,
+                    uint8_t map_bits, uint8_t width, uint8_t height, uint8_t shift)
+{
+    ff->field = field;
+    ff->queue = queue;
+    ff->map = map;
+    ff->map_shift = map_shift;
+    ff->map_bits = map_bits;
+    ff->width = width;
+    ff->height = height;
+    ff->shift = shift;
+    ff->head = ff->tail = 0;
+    memset(field, FLOW_NONE, (uint16_t)height << shift);
+}
+
+void flowfield_start(flowfield_t * ff, uint8_t x, uint8_t y)
+{
+    memset(ff->field, FLOW_NONE, (uint16_t)ff->height << ff->shift);
+    ff->field[((uint16_t)y << ff->shift) + x] = FLOW_TARGET;
+    ff->queue[0] = ((uint16_t)y << 8) | x;
+    ff->head = 0;
+    ff->tail = 1;
+}
+
+/* Non zero if the tile is solid */
+static uint8_t flowfield_solid(const flowfield_t * ff, uint8_t x, uint8_t y)
+{
+    const uint8_t * row = ff->map + ((uint16_t)y << ff->map_shift);
+
+    if (ff->map_bits == 1) return (row[x >> 3] >> (x & 7)) & 1;
+    return (row[x >> 2] >> ((x & 3) << 1)) & 3;
+}
+
+uint8_t flowfield_step(flowfield_t * ff, uint16_t budget)
+{
+    uint8_t * field = ff->field;
+    uint16_t * queue = ff->queue;
+    uint16_t head = ff->head, tail = ff->tail, stride = (uint16_t)1 << ff->shift;
+    uint8_t * tile;
+    uint8_t x, y;
+
+    while (budget-- && (head != tail)) {
+        x = (uint8_t)queue[head];
+        y = (uint8_t)(queue[head] >> 8);
+        head++;
+        tile = field + ((uint16_t)y << ff->shift) + x;
+
+        if (y && (tile[-stride] == FLOW_NONE) && !flowfield_solid(ff, x, y - 1)) {
+            tile[-stride] = FLOW_DOWN;
+            queue[tail++] = queue[head - 1] - 0x100;
+        }
+        if ((y + 1 != ff->height) && (tile[stride] == FLOW_NONE) && !flowfield_solid(ff, x, y + 1)) {
+            tile[stride] = FLOW_UP;
+            queue[tail++] = queue[head - 1] + 0x100;
+        }
+        if (x && (tile[-1] == FLOW_NONE) && !flowfield_solid(ff, x - 1, y)) {
+            tile[-1] = FLOW_RIGHT;
+            queue[tail++] = queue[head - 1] - 1;
+        }
+        if ((x + 1 != ff->width) && (tile[1] == FLOW_NONE) && !flowfield_solid(ff, x + 1, y)) {
+            tile[1] = FLOW_LEFT;
+            queue[tail++] = queue[head - 1] + 1;
+        }
+    }
+    ff->head = head;
+    ff->tail = tail;
+    return head == tail;
+}
@@ -47,6 +47,13 @@ struct header
 
 extern header_t *HEAPSPACE __sdcc_heap_free;
 
+#ifdef HEAP_STATS
+// Counters of the instrumented heap (heap_stats.lib), see gbdk/heap_stats.h
+extern size_t __heap_used, __heap_peak;
+extern unsigned long __heap_mallocs, __heap_walk_steps;
+extern unsigned int __heap_walk_max, __heap_failures;
+#endif
+
 void free(void *ptr)
 {
 	header_t *h, *next_free, *prev_free;
@@ -60,6 +67,9 @@ void free(void *ptr)
 	next_free = h;
 
 	h = (void HEAPSPACE *)((char HEAPSPACE *)(ptr) - offsetof(struct header, next_free));
+#ifdef HEAP_STATS
+	__heap_used -= (char HEAPSPACE *)(h->next) - (char HEAPSPACE *)h;
+#endif
 
 	// Insert into free list.
 	h->next_free = next_free;
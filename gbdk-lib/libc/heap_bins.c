@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Size class heap, replaces malloc.c, free.c and realloc.c when linked
+   with -Wl-lheap_bins.lib
+
+   Blocks are laid out as in malloc.c: each starts with a pointer to the
+   next block, so the size of a block is the distance to it, and the free
+   blocks are in an address ordered list which merges neighbours.
+
+   On top of that, requests of up to 64 bytes are rounded up to one of
+   BIN_COUNT block sizes. A freed block of one of those sizes is pushed
+   onto the bin for its size instead of being merged, and malloc() pops
+   it again, both in constant time. The free list is only searched when
+   the bin is empty, and when it has no block large enough the bins are
+   emptied into it, which merges their blocks, for one more search */
+
+typedef struct header header_t;
+
+struct header
+{
+	header_t *next; // Next block, in address order. The last one points to the end of the heap.
+	header_t *next_free; // Next block in the free list or in a bin. Overlaps with user data in allocated blocks.
+};
+
+// Bytes of a block before the data
+#define HEADER_SIZE offsetof(struct header, next_free)
+
+#define BIN_COUNT 4
+
+// Block size of each bin, for requests of up to 8, 16, 32 and 64 bytes
+static const size_t bin_size[BIN_COUNT] = {
+	8 + HEADER_SIZE, 16 + HEADER_SIZE, 32 + HEADER_SIZE, 64 + HEADER_SIZE
+};
+
+header_t *__sdcc_heap_free; // First block of the free list, 0 if none.
+static header_t *bins[BIN_COUNT]; // First block of each bin, 0 if none.
+
+extern header_t __sdcc_heap;
+#define HEAP_START &__sdcc_heap
+
+extern header_t __sdcc_heap_end; // Just beyond the end of the heap.
+#define HEAP_END &__sdcc_heap_end
+
+void __sdcc_heap_init(void)
+{
+	unsigned char i;
+
+	__sdcc_heap_free = HEAP_START;
+	__sdcc_heap_free->next = HEAP_END;
+	__sdcc_heap_free->next_free = 0;
+	for(i = 0; i != BIN_COUNT; i++)
+		bins[i] = 0;
+}
+
+// Bin of a free block, BIN_COUNT if it isn't one of the bin sizes. Splitting
+// a block leaves less than a header of slack, so a block within that of a
+// bin size came from that bin size.
+static unsigned char bin_of_block(size_t blocksize)
+{
+	unsigned char i;
+
+	for(i = 0; i != BIN_COUNT; i++)
+		if(blocksize < bin_size[i] + sizeof(struct header))
+			return (blocksize >= bin_size[i]) ? i : BIN_COUNT;
+	return BIN_COUNT;
+}
+
+// First fit from the free list, as malloc.c
+static header_t *free_list_alloc(size_t size)
+{
+	header_t *h;
+	header_t **f;
+
+	for(h = __sdcc_heap_free, f = &__sdcc_heap_free; h; f = &(h->next_free), h = h->next_free)
+	{
+		size_t blocksize = (char *)(h->next) - (char *)h;
+		if(blocksize >= size) // Found free block of sufficient size.
+		{
+			if(blocksize >= size + sizeof(struct header)) // It is worth creating a new free block
+			{
+				header_t *const newheader = (header_t *const)((char *)h + size);
+				newheader->next = h->next;
+				newheader->next_free = h->next_free;
+				*f = newheader;
+				h->next = newheader;
+			}
+			else
+				*f = h->next_free;
+			return(h);
+		}
+	}
+	return(0);
+}
+
+// Inserts a block into the free list and merges it with its neighbours, as free.c
+static void free_list_insert(header_t *h)
+{
+	header_t *next_free, *prev_free, *p;
+	header_t **f;
+
+	prev_free = 0;
+	for(p = __sdcc_heap_free, f = &__sdcc_heap_free; p && p < h; prev_free = p, f = &(p->next_free), p = p->next_free); // Find adjacent blocks in free list
+	next_free = p;
+
+	h->next_free = next_free;
+	*f = h;
+
+	if(next_free == h->next) // Merge with next block
+	{
+		h->next_free = h->next->next_free;
+		h->next = h->next->next;
+	}
+
+	if(prev_free && prev_free->next == h) // Merge with previous block
+	{
+		prev_free->next = h->next;
+		prev_free->next_free = h->next_free;
+	}
+}
+
+// Moves the blocks of all bins to the free list, returns 0 if there were none
+static unsigned char bins_flush(void)
+{
+	unsigned char i, moved = 0;
+	header_t *h;
+
+	for(i = 0; i != BIN_COUNT; i++)
+	{
+		while(h = bins[i])
+		{
+			bins[i] = h->next_free;
+			free_list_insert(h);
+			moved = 1;
+		}
+	}
+	return(moved);
+}
+
+void *malloc(size_t size)
+{
+	header_t *h;
+	unsigned char i;
+
+	if(!size || size + HEADER_SIZE < size)
+		return(0);
+	size += HEADER_SIZE;
+	if(size < sizeof(struct header)) // Requiring a minimum size makes it easier to implement free(), and avoid memory leaks.
+		size = sizeof(struct header);
+
+	for(i = 0; i != BIN_COUNT; i++)
+	{
+		if(size <= bin_size[i])
+		{
+			if(h = bins[i])
+			{
+				bins[i] = h->next_free;
+				return(&(h->next_free));
+			}
+			size = bin_size[i];
+			break;
+		}
+	}
+
+	if((h = free_list_alloc(size)) || (bins_flush() && (h = free_list_alloc(size))))
+		return(&(h->next_free));
+	return(0);
+}
+
+void free(void *ptr)
+{
+	header_t *h;
+	unsigned char i;
+
+	if(!ptr)
+		return;
+
+	h = (header_t *)((char *)(ptr) - HEADER_SIZE);
+	i = bin_of_block((char *)(h->next) - (char *)h);
+	if(i != BIN_COUNT)
+	{
+		h->next_free = bins[i];
+		bins[i] = h;
+	}
+	else
+		free_list_insert(h);
+}
+
+// As realloc.c: grows or shrinks in place when the neighbouring blocks in the
+// free list make room, else moves the data to a new block
+void *realloc(void *ptr, size_t size)
+{
+	void *ret;
+	header_t *h, *next_free, *prev_free;
+	header_t **f, **pf;
+	size_t blocksize, oldblocksize, maxblocksize;
+
+	if(!ptr)
+		return(malloc(size));
+
+	if(!size)
+	{
+		free(ptr);
+		return(0);
+	}
+
+	prev_free = 0, pf = 0;
+	for(h = __sdcc_heap_free, f = &__sdcc_heap_free; h && h < ptr; prev_free = h, pf = f, f = &(h->next_free), h = h->next_free); // Find adjacent blocks in free list
+	next_free = h;
+
+	if(size + HEADER_SIZE < size) // Handle overflow
+		return(0);
+	blocksize = size + HEADER_SIZE;
+	if(blocksize < sizeof(struct header))
+		blocksize = sizeof(struct header);
+
+	h = (header_t *)((char *)(ptr) - HEADER_SIZE);
+	oldblocksize = (char *)(h->next) - (char *)h;
+
+	maxblocksize = oldblocksize;
+	if(prev_free && prev_free->next == h) // Can merge with previous block
+		maxblocksize += (char *)h - (char *)prev_free;
+	if(next_free == h->next) // Can merge with next block
+		maxblocksize += (char *)(next_free->next) - (char *)next_free;
+
+	if(blocksize <= maxblocksize) // Can resize in place.
+	{
+		if(prev_free && prev_free->next == h) // Always move into previous block to defragment
+		{
+			memmove(prev_free, h, blocksize <= oldblocksize ? blocksize : oldblocksize);
+			h = prev_free;
+			*pf = next_free;
+			f = pf;
+		}
+
+		if(next_free && next_free == h->next) // Merge with following block
+		{
+			h->next = next_free->next;
+			*f = next_free->next_free;
+		}
+
+		if(maxblocksize >= blocksize + sizeof(struct header)) // Create new block from free space
+		{
+			header_t *const newheader = (header_t *const)((char *)h + blocksize);
+			newheader->next = h->next;
+			newheader->next_free = *f;
+			*f = newheader;
+			h->next = newheader;
+		}
+
+		return(&(h->next_free));
+	}
+
+	if(ret = malloc(size))
+	{
+		size_t oldsize = oldblocksize - HEADER_SIZE;
+		memcpy(ret, ptr, size <= oldsize ? size : oldsize);
+		free(ptr);
+		return(ret);
+	}
+
+	return(0);
+}
@@ -0,0 +1,55 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <gbdk/heap_stats.h>
+
+/* Heap statistics, see gbdk/heap_stats.h
+
+   Only built into heap_stats.lib, along with malloc.c, free.c and
+   realloc.c compiled with HEAP_STATS which update the counters */
+
+typedef struct header header_t;
+
+struct header
+{
+	header_t *next;
+	header_t *next_free;
+};
+
+extern header_t *__sdcc_heap_free;
+
+size_t __heap_used, __heap_peak;
+unsigned long __heap_mallocs, __heap_walk_steps;
+unsigned int __heap_walk_max, __heap_failures;
+
+void heap_stats(heap_stats_t * stats)
+{
+	header_t *h;
+	size_t blocksize, largest = 0;
+
+	stats->used = __heap_used;
+	stats->peak = __heap_peak;
+	stats->free_blocks = 0;
+	stats->free_total = 0;
+	for(h = __sdcc_heap_free; h; h = h->next_free)
+	{
+		blocksize = (char *)(h->next) - (char *)h;
+		stats->free_blocks++;
+		stats->free_total += blocksize;
+		if(blocksize > largest)
+			largest = blocksize;
+	}
+	stats->largest_free = (largest) ? largest - offsetof(struct header, next_free) : 0;
+	stats->mallocs = __heap_mallocs;
+	stats->failures = __heap_failures;
+	stats->walk_avg = (__heap_mallocs) ? (uint16_t)((__heap_walk_steps + (__heap_mallocs >> 1)) / __heap_mallocs) : 0;
+	stats->walk_max = __heap_walk_max;
+}
+
+void heap_stats_reset(void)
+{
+	__heap_peak = __heap_used;
+	__heap_mallocs = 0;
+	__heap_walk_steps = 0;
+	__heap_walk_max = 0;
+	__heap_failures = 0;
+}
@@ -50,6 +50,13 @@ header_t *HEAPSPACE __sdcc_heap_free; // First free block, 0 if no free blocks.
 extern header_t __sdcc_heap;
 #define HEAP_START &__sdcc_heap
 
+#ifdef HEAP_STATS
+// Counters of the instrumented heap (heap_stats.lib), see gbdk/heap_stats.h
+extern size_t __heap_used, __heap_peak;
+extern unsigned long __heap_mallocs, __heap_walk_steps;
+extern unsigned int __heap_walk_max, __heap_failures;
+#endif
+
 #if defined(__SDCC_mcs51) || defined(__SDCC_ds390) || defined(__SDCC_ds400) || defined(__SDCC_hc08) || defined(__SDCC_s08)
 
 extern const unsigned int __sdcc_heap_size;
@@ -77,6 +84,9 @@ void *malloc(size_t size)
 {
 	header_t *h;
 	header_t *HEAPSPACE *f;
+#ifdef HEAP_STATS
+	unsigned int walk = 0;
+#endif
 
 #if defined(__SDCC_mcs51) || defined(__SDCC_ds390) || defined(__SDCC_ds400) || defined(__SDCC_hc08) || defined(__SDCC_s08)
 	if(!__sdcc_heap_free)
@@ -92,6 +102,9 @@ void *malloc(size_t size)
 	for(h = __sdcc_heap_free, f = &__sdcc_heap_free; h; f = &(h->next_free), h = h->next_free)
 	{
 		size_t blocksize = (char HEAPSPACE *)(h->next) - (char HEAPSPACE *)h;
+#ifdef HEAP_STATS
+		walk++;
+#endif
 		if(blocksize >= size) // Found free block of sufficient size.
 		{
 			if(blocksize >= size + sizeof(struct header)) // It is worth creating a new free block
@@ -105,10 +118,27 @@ void *malloc(size_t size)
 			else
 				*f = h->next_free;
 
+#ifdef HEAP_STATS
+			__heap_used += (char HEAPSPACE *)(h->next) - (char HEAPSPACE *)h;
+			if(__heap_used > __heap_peak)
+				__heap_peak = __heap_used;
+			break;
+#else
 			return(&(h->next_free));
+#endif
 		}
 	}
 
+#ifdef HEAP_STATS
+	if(!h)
+		__heap_failures++;
+	__heap_mallocs++;
+	__heap_walk_steps += walk;
+	if(walk > __heap_walk_max)
+		__heap_walk_max = walk;
+	return(h ? &(h->next_free) : 0);
+#else
 	return(0);
+#endif
 }
 
@@ -0,0 +1,54 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gbdk/pool.h>
+
+/* Fixed size block and arena allocators, see gbdk/pool.h
+   Free pool blocks are linked through their first two bytes */
+
+void pool_init(pool_t * pool, void * buf, uint16_t block_size, uint16_t count)
+{
+    uint8_t * block = (uint8_t *)buf;
+
+    if (block_size < sizeof(void *)) block_size = sizeof(void *);
+    pool->block_size = block_size;
+    pool->used = 0;
+    pool->free = (count) ? buf : NULL;
+    for (; count > 1; count--, block += block_size)
+        *(void **)block = block + block_size;
+    if (pool->free) *(void **)block = NULL;
+}
+
+void * pool_alloc(pool_t * pool)
+{
+    void * block = pool->free;
+
+    if (block) {
+        pool->free = *(void **)block;
+        pool->used++;
+    }
+    return block;
+}
+
+void pool_free(pool_t * pool, void * block)
+{
+    if (block) {
+        *(void **)block = pool->free;
+        pool->free = block;
+        pool->used--;
+    }
+}
+
+void arena_init(arena_t * arena, void * buf, uint16_t size)
+{
+    arena->start = arena->ptr = (uint8_t *)buf;
+    arena->end = (uint8_t *)buf + size;
+}
+
+void * arena_alloc(arena_t * arena, uint16_t size)
+{
+    uint8_t * p = arena->ptr;
+
+    if (size > (uint16_t)(arena->end - p)) return NULL;
+    arena->ptr = p + size;
+    return p;
+}
@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <stdint.h>
+
+// Shell sort versions of qsort(), faster than the insertion sort in
+// qsort.c once there are more than a few elements, at some cost in code size.
+// Gaps follow the 3x+1 sequence.
+
+static void swap_fast(void *restrict dst, void *restrict src, size_t n)
+{
+	if(!(n & 1))
+	{
+		uint16_t *restrict d = dst;
+		uint16_t *restrict s = src;
+
+		for(n >>= 1; n; n--)
+		{
+			uint16_t tmp = *d;
+			*d++ = *s;
+			*s++ = tmp;
+		}
+	}
+	else
+	{
+		unsigned char *restrict d = dst;
+		unsigned char *restrict s = src;
+
+		for(; n; n--)
+		{
+			unsigned char tmp = *d;
+			*d++ = *s;
+			*s++ = tmp;
+		}
+	}
+}
+
+static size_t first_gap(size_t nmemb)
+{
+	size_t h = 1;
+
+	while(h < nmemb / 3)
+		h = 3 * h + 1;
+	return h;
+}
+
+void qsort_fast(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *) __reentrant)
+{
+	unsigned char *b = base;
+	unsigned char *end = b + nmemb * size;
+
+	if(nmemb <= 1)
+		return;
+
+	for(size_t h = first_gap(nmemb); h; h /= 3)
+	{
+		size_t hs = h * size;
+		for(unsigned char *i = b + hs; i < end; i += size)
+		{
+			for(unsigned char *j = i; (j >= b + hs) && (*compar)(j, j - hs) < 0; j -= hs)
+				swap_fast(j, j - hs, size);
+		}
+	}
+}
+
+void qsort_u8_key(void *base, size_t nmemb, size_t size, size_t key_offset)
+{
+	unsigned char *b = (unsigned char *)base + key_offset;
+	unsigned char *end = b + nmemb * size;
+
+	if(nmemb <= 1)
+		return;
+
+	for(size_t h = first_gap(nmemb); h; h /= 3)
+	{
+		size_t hs = h * size;
+		for(unsigned char *i = b + hs; i < end; i += size)
+		{
+			for(unsigned char *j = i; (j >= b + hs) && (*j < *(j - hs)); j -= hs)
+				swap_fast(j - key_offset, j - hs - key_offset, size);
+		}
+	}
+}
+
+void qsort_u16_key(void *base, size_t nmemb, size_t size, size_t key_offset)
+{
+	unsigned char *b = (unsigned char *)base + key_offset;
+	unsigned char *end = b + nmemb * size;
+
+	if(nmemb <= 1)
+		return;
+
+	for(size_t h = first_gap(nmemb); h; h /= 3)
+	{
+		size_t hs = h * size;
+		for(unsigned char *i = b + hs; i < end; i += size)
+		{
+			for(unsigned char *j = i; (j >= b + hs) && (*(uint16_t *)j < *(uint16_t *)(j - hs)); j -= hs)
+				swap_fast(j - key_offset, j - hs - key_offset, size);
+		}
+	}
+}
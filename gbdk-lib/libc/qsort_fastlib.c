@@ -0,0 +1,10 @@
+#include <stdlib.h>
+
+// qsort() of fast.lib (lcc -fastlib): the Shell sort of qsort_fast.c
+// instead of the insertion sort of qsort.c. Not part of the default
+// libs, where it would clash with qsort.c.
+
+void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *) __reentrant)
+{
+	qsort_fast(base, nmemb, size, compar);
+}
@@ -54,6 +54,13 @@ extern header_t *HEAPSPACE __sdcc_heap_free;
 
 void __sdcc_heap_init(void);
 
+#ifdef HEAP_STATS
+// Counters of the instrumented heap (heap_stats.lib), see gbdk/heap_stats.h
+extern size_t __heap_used, __heap_peak;
+extern unsigned long __heap_mallocs, __heap_walk_steps;
+extern unsigned int __heap_walk_max, __heap_failures;
+#endif
+
 #if defined(__SDCC_mcs51) || defined(__SDCC_ds390) || defined(__SDCC_ds400)
 void HEAPSPACE *realloc(void *ptr, size_t size)
 #else
@@ -123,6 +130,11 @@ void *realloc(void *ptr, size_t size)
 			h->next = newheader;
 		}
 
+#ifdef HEAP_STATS
+		__heap_used += ((char HEAPSPACE *)(h->next) - (char HEAPSPACE *)h) - oldblocksize;
+		if(__heap_used > __heap_peak)
+			__heap_peak = __heap_used;
+#endif
 		return(&(h->next_free));
 	}
 
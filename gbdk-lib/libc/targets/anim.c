@@ -0,0 +1,65 @@
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <gbdk/anim.h>
+
+/* Animation frame changes, see gbdk/anim.h
+
+   Frame layout: number of runs, tiles per slot, bytes per slot, then the
+   first slot, the number of slots and the tile data of each run */
+
+void anim_apply_frame(const uint8_t * frame, uint8_t base_tile)
+{
+    uint8_t runs = *frame++;
+    uint8_t tiles = *frame++;
+    uint8_t size = *frame++;
+    uint8_t first, n;
+
+    for (; runs; runs--) {
+        first = *frame++;
+        n = *frame++;
+        set_sprite_data(base_tile + (uint8_t)(first * tiles), (uint8_t)(n * tiles), frame);
+        frame += (uint16_t)n * size;
+    }
+}
+
+void anim_play(animator_t * anim, const anim_seq_t * seq)
+{
+    const anim_frame_t * f = seq->frames;
+
+    anim->frames = f;
+    anim->count = seq->count;
+    anim->flags = seq->flags;
+    anim->index = 0;
+    anim->timer = f->ticks;
+    anim->frame = f->frame;
+    anim->event = f->event;
+    anim->changed = TRUE;
+}
+
+void anim_tick_all(animator_t * anims, uint8_t count)
+{
+    const anim_frame_t * f;
+    uint8_t index;
+
+    for (; count; count--, anims++) {
+        anims->event = anims->changed = 0;
+        if ((anims->timer == 0) || --anims->timer) continue;
+        index = anims->index + 1;
+        if (index == anims->count) {
+            /* Sequences played once stay on their last frame */
+            if (!(anims->flags & ANIM_LOOP)) {
+                anims->flags |= ANIM_DONE;
+                continue;
+            }
+            index = 0;
+        }
+        anims->index = index;
+        f = anims->frames + index;
+        anims->timer = f->ticks;
+        anims->event = f->event;
+        if (anims->frame != f->frame) {
+            anims->frame = f->frame;
+            anims->changed = TRUE;
+        }
+    }
+}
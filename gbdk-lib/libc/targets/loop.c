@@ -0,0 +1,73 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gbdk/platform.h>
+#include <gbdk/loop.h>
+
+/* Fixed rate game loop, see gbdk/loop.h
+
+   next is the value of sys_time at which the next update is due. The
+   loop waits for it with vsync(), or goes on right away when it already
+   passed, skipping the render while more than one update is due */
+
+loop_stats_t loop_stats;
+
+static uint8_t loop_rate = 1;
+static uint8_t loop_quit;
+
+/* sys_time can change between its two bytes, read it until it holds still */
+static uint16_t loop_time(void)
+{
+    uint16_t t;
+    do {
+        t = sys_time;
+    } while (t != sys_time);
+    return t;
+}
+
+void loop_set_rate(uint8_t vblanks)
+{
+    loop_rate = (vblanks) ? vblanks : 1;
+}
+
+void loop_exit(void)
+{
+    loop_quit = 1;
+}
+
+void loop_run(loop_fn update, loop_fn render)
+{
+    uint16_t next, late;
+    uint8_t skipped = 0;
+
+    loop_stats.updates = loop_stats.renders = loop_stats.skipped = loop_stats.lag = 0;
+    loop_quit = 0;
+    next = loop_time();
+
+    while (!loop_quit) {
+        while ((int16_t)(loop_time() - next) < 0) vsync();
+
+        late = loop_time() - next;
+        if (late >= (uint16_t)loop_rate * LOOP_MAX_SKIP) {
+            /* Too far behind to catch up, drop the time */
+            loop_stats.lag += late;
+            next += late;
+            late = 0;
+        }
+
+        if ((late < loop_rate) || (skipped == LOOP_MAX_SKIP)) {
+            if (render) {
+                render();
+                loop_stats.renders++;
+            }
+            skipped = 0;
+        } else {
+            loop_stats.skipped++;
+            skipped++;
+        }
+        if (loop_quit) break;
+
+        update();
+        loop_stats.updates++;
+        next += loop_rate;
+    }
+}
@@ -0,0 +1,108 @@
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <gbdk/metasprite_batch.h>
+
+/* Frame level metasprite batching, see gbdk/metasprite_batch.h */
+
+typedef struct batch_item_t {
+  const metasprite_t * metasprite;
+  uint8_t base_tile;
+  uint8_t base_prop;
+  uint8_t x;
+  uint8_t y;
+  uint8_t priority;
+  uint8_t flip;
+} batch_item_t;
+
+static batch_item_t items[METASPRITE_BATCH_MAX];
+static uint8_t order[METASPRITE_BATCH_MAX];   /* Item indexes sorted by priority */
+static uint8_t item_count;
+static uint8_t sprite_first;
+static uint8_t rotation;
+
+void metasprite_batch_begin(uint8_t first_sprite)
+{
+  item_count = 0;
+  sprite_first = (first_sprite < MAX_HARDWARE_SPRITES) ? first_sprite : MAX_HARDWARE_SPRITES;
+}
+
+uint8_t metasprite_batch_add(const metasprite_t * metasprite, uint8_t base_tile, uint8_t base_prop, uint8_t x, uint8_t y, uint8_t priority, uint8_t flip)
+{
+  batch_item_t * item;
+  uint8_t i;
+
+  if (item_count == METASPRITE_BATCH_MAX)
+    return 0;
+
+  item = &items[item_count];
+  item->metasprite = metasprite;
+  item->base_tile = base_tile;
+  item->base_prop = base_prop;
+  item->x = x;
+  item->y = y;
+  item->priority = priority;
+  item->flip = flip;
+
+  /* Insertion sort, highest priority first and in submission order within a priority */
+  for (i = item_count; (i) && (items[order[i - 1]].priority < priority); i--)
+    order[i] = order[i - 1];
+  order[i] = item_count;
+
+  item_count++;
+  return 1;
+}
+
+static uint8_t sprite_count(const metasprite_t * metasprite)
+{
+  uint8_t count = 0;
+
+  while (metasprite->dy != (int8_t)metasprite_end) {
+    metasprite++;
+    count++;
+  }
+  return count;
+}
+
+static uint8_t draw_item(const batch_item_t * item, uint8_t base_sprite)
+{
+  switch (item->flip) {
+    case METASPRITE_BATCH_FLIP_X:
+      return move_metasprite_flipx(item->metasprite, item->base_tile, item->base_prop, base_sprite, item->x, item->y);
+    case METASPRITE_BATCH_FLIP_Y:
+      return move_metasprite_flipy(item->metasprite, item->base_tile, item->base_prop, base_sprite, item->x, item->y);
+    case METASPRITE_BATCH_FLIP_XY:
+      return move_metasprite_flipxy(item->metasprite, item->base_tile, item->base_prop, base_sprite, item->x, item->y);
+    default:
+      return move_metasprite_ex(item->metasprite, item->base_tile, item->base_prop, base_sprite, item->x, item->y);
+  }
+}
+
+uint8_t metasprite_batch_end(uint8_t flags)
+{
+  const batch_item_t * item;
+  uint8_t next = sprite_first;
+  uint8_t start, end, n, i, pos;
+
+  /* Draw each run of equal priority, optionally starting at a different item every frame */
+  for (start = 0; start < item_count; start = end) {
+    for (end = start + 1; (end < item_count) && (items[order[end]].priority == items[order[start]].priority); end++)
+      ;
+    n = end - start;
+    pos = (flags & METASPRITE_BATCH_ROTATE) ? start + (rotation % n) : start;
+
+    for (i = 0; i < n; i++) {
+      item = &items[order[pos]];
+      /* Skip metasprites that don't fit entirely, a smaller one later may still fit */
+      if (sprite_count(item->metasprite) <= (uint8_t)(MAX_HARDWARE_SPRITES - next))
+        next += draw_item(item, next);
+      if (++pos == end)
+        pos = start;
+    }
+  }
+
+  if (flags & METASPRITE_BATCH_ROTATE)
+    rotation++;
+
+  hide_sprites_range(next, MAX_HARDWARE_SPRITES);
+  return next - sprite_first;
+}
@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <gbdk/metasprite_clip.h>
+
+/* Metasprites at world coordinates culled against a camera, see gbdk/metasprite_clip.h */
+
+/* Screen coordinates a sprite can be drawn at without wrapping its 8 bit
+   hardware coordinate, and still be at least partly visible */
+#if DEVICE_SPRITE_PX_OFFSET_X > 7
+#define CLIP_X_MIN -7
+#else
+#define CLIP_X_MIN (-(DEVICE_SPRITE_PX_OFFSET_X))
+#endif
+#if DEVICE_SPRITE_PX_OFFSET_Y > 15
+#define CLIP_Y_MIN -15
+#else
+#define CLIP_Y_MIN (-(DEVICE_SPRITE_PX_OFFSET_Y))
+#endif
+#define CLIP_X_MAX (DEVICE_SCREEN_PX_WIDTH - 1)
+#define CLIP_Y_MAX (DEVICE_SCREEN_PX_HEIGHT - 1)
+
+int16_t metasprite_clip_camera_x, metasprite_clip_camera_y;
+
+/* Visible sprites of a metasprite crossing the screen edge, each one relative to the one before */
+static metasprite_t buffer[METASPRITE_CLIP_BUFFER + 1];
+
+void metasprite_clip_camera(int16_t x, int16_t y)
+{
+    metasprite_clip_camera_x = x;
+    metasprite_clip_camera_y = y;
+}
+
+uint8_t move_metasprite_clip(const metasprite_t * metasprite, const metasprite_bounds_t * bounds,
+                             uint8_t base_tile, uint8_t base_prop, uint8_t base_sprite, int16_t x, int16_t y)
+{
+    metasprite_t * item;
+    int16_t left, top, dx, dy, last_x, last_y, start_x, start_y;
+    uint8_t sprite = base_sprite, count = 0;
+
+    x -= metasprite_clip_camera_x;
+    y -= metasprite_clip_camera_y;
+
+    if (bounds) {
+        left = x + bounds->left;
+        top = y + bounds->top;
+        if ((bounds->width == 0) ||
+            (left + bounds->width <= 0) || (left >= DEVICE_SCREEN_PX_WIDTH) ||
+            (top + bounds->height <= 0) || (top >= DEVICE_SCREEN_PX_HEIGHT))
+            return 0;
+        if ((left >= CLIP_X_MIN) && (left + bounds->width <= DEVICE_SCREEN_PX_WIDTH) &&
+            (top >= CLIP_Y_MIN) && (top + bounds->height <= DEVICE_SCREEN_PX_HEIGHT))
+            return move_metasprite_ex(metasprite, base_tile, base_prop, base_sprite,
+                                      x + DEVICE_SPRITE_PX_OFFSET_X, y + DEVICE_SPRITE_PX_OFFSET_Y);
+    }
+
+    /* Collect the visible sprites. A part is drawn when the buffer is full
+       or the next sprite is too far from the last one for an 8 bit offset */
+    last_x = last_y = 0;
+    start_x = start_y = 0;
+    item = buffer;
+    for (; metasprite->dy != (int8_t)metasprite_end; metasprite++) {
+        y += metasprite->dy;
+        x += metasprite->dx;
+        if ((x < CLIP_X_MIN) || (x > CLIP_X_MAX) || (y < CLIP_Y_MIN) || (y > CLIP_Y_MAX))
+            continue;
+        dx = x - last_x;
+        dy = y - last_y;
+        if ((count == 0) || (count == METASPRITE_CLIP_BUFFER) || (dx < -127) || (dx > 127) || (dy < -127) || (dy > 127)) {
+            if (count) {
+                item->dy = (int8_t)metasprite_end;
+                sprite += move_metasprite_ex(buffer, base_tile, base_prop, sprite,
+                                             start_x + DEVICE_SPRITE_PX_OFFSET_X, start_y + DEVICE_SPRITE_PX_OFFSET_Y);
+                item = buffer;
+                count = 0;
+            }
+            start_x = x;
+            start_y = y;
+            dx = dy = 0;
+        }
+        item->dy = dy;
+        item->dx = dx;
+        item->dtile = metasprite->dtile;
+        item->props = metasprite->props;
+        item++;
+        count++;
+        last_x = x;
+        last_y = y;
+    }
+    if (count) {
+        item->dy = (int8_t)metasprite_end;
+        sprite += move_metasprite_ex(buffer, base_tile, base_prop, sprite,
+                                     start_x + DEVICE_SPRITE_PX_OFFSET_X, start_y + DEVICE_SPRITE_PX_OFFSET_Y);
+    }
+    return sprite - base_sprite;
+}
@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include <gbdk/lz4decompress.h>
+
+/* Decompressor for gbcompress --alg=lz4 data, see gbdk/lz4decompress.h */
+
+#define LZ4_NIBBLE_EXT 15u
+#define LZ4_LEN_EXT    255u
+#define LZ4_MATCH_MIN  4u
+
+static const uint8_t * lz4_sour;
+
+static uint16_t lz4_length(uint8_t nibble)
+{
+    uint16_t len = nibble;
+    uint8_t ext;
+
+    if (nibble == LZ4_NIBBLE_EXT) {
+        do {
+            ext = *lz4_sour++;
+            len += ext;
+        } while (ext == LZ4_LEN_EXT);
+    }
+    return len;
+}
+
+uint16_t lz4_decompress(const uint8_t * sour, uint8_t * dest)
+{
+    uint8_t * out = dest;
+    const uint8_t * match;
+    uint16_t len, offset;
+    uint8_t token;
+
+    lz4_sour = sour;
+    for (;;) {
+        token = *lz4_sour++;
+        for (len = lz4_length(token >> 4); len; len--) *out++ = *lz4_sour++;
+
+        offset = lz4_sour[0] | ((uint16_t)lz4_sour[1] << 8);
+        lz4_sour += 2;
+        if (offset == 0) break;
+
+        /* Matches may overlap their output, so copy one byte at a time */
+        match = out - offset;
+        for (len = lz4_length(token & 0x0Fu) + LZ4_MATCH_MIN; len; len--) *out++ = *match++;
+    }
+    return (uint16_t)(out - dest);
+}
@@ -0,0 +1,53 @@
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <gbdk/metatiles.h>
+
+/* Metatile expansion, see gbdk/metatiles.h
+   Attributes are ignored, they are set per 2x2 tile block on the NES */
+
+static uint8_t mt_row[DEVICE_SCREEN_BUFFER_WIDTH];
+
+/* Expands the tile row r of the metatiles in one row of the map into mt_row,
+   writing it at tx, ty each time it reaches the right edge of the tile map */
+static void mt_draw_row(uint8_t tx, uint8_t ty, uint8_t w, const uint8_t * map, const uint8_t * data, uint8_t size, uint8_t r)
+{
+    const uint8_t * src;
+    uint8_t i, c, n = 0;
+
+    for (i = 0; i < w; i++) {
+        src = data + ((uint16_t)map[i] * (uint8_t)(size * size)) + (uint8_t)(r * size);
+        for (c = 0; c < size; c++) {
+            mt_row[n++] = *src++;
+            if ((tx + n) == DEVICE_SCREEN_BUFFER_WIDTH) {
+                set_bkg_tiles(tx, ty, n, 1, mt_row);
+                tx = 0;
+                n = 0;
+            }
+        }
+    }
+    if (n) set_bkg_tiles(tx, ty, n, 1, mt_row);
+}
+
+static void mt_draw(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * map, uint8_t map_w, const uint8_t * metatiles, uint8_t size)
+{
+    uint8_t tx = ((uint16_t)x * size) % DEVICE_SCREEN_BUFFER_WIDTH;
+    uint8_t ty = ((uint16_t)y * size) % DEVICE_SCREEN_BUFFER_HEIGHT;
+    uint8_t r;
+
+    for (; h; h--, map += map_w) {
+        for (r = 0; r < size; r++) {
+            mt_draw_row(tx, ty, w, map, metatiles, size, r);
+            if (++ty == DEVICE_SCREEN_BUFFER_HEIGHT) ty = 0;
+        }
+    }
+}
+
+void set_bkg_metatiles(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * map, const uint8_t * metatiles, const uint8_t * attributes, uint8_t size)
+{
+    mt_draw(x, y, w, h, map, w, metatiles, size);
+}
+
+void set_bkg_submap_metatiles(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * map, uint8_t map_w, const uint8_t * metatiles, const uint8_t * attributes, uint8_t size)
+{
+    mt_draw(x, y, w, h, map + ((uint16_t)y * map_w) + x, map_w, metatiles, size);
+}
@@ -0,0 +1,229 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gbdk/platform.h>
+#include <gbdk/music.h>
+
+/* Tracker style music and sound effect driver, see gbdk/music.h
+
+   Each frame the streams are read with their bank switched in, then
+   the voice of each channel (the effect if one plays, else the song)
+   goes through a copy of the last values written to the channel, so
+   only registers whose value changes are written */
+
+typedef struct voice_t {
+    const uint8_t * start;  /* NULL once the stream ended */
+    const uint8_t * ptr;
+    uint8_t bank;
+    uint8_t wait;           /* Frames until the next command is read */
+    uint8_t note;           /* MUSIC_CMD_REST while silent */
+    uint8_t volume;
+    uint8_t duty;
+    uint8_t trigger;        /* A note started */
+} voice_t;
+
+static voice_t song_voices[MUSIC_CHANNELS], sfx_voices[MUSIC_CHANNELS];
+
+/* Last control byte and period written to each channel */
+static uint8_t hw_ctrl[MUSIC_CHANNELS];
+static uint16_t hw_period[MUSIC_CHANNELS];
+/* Channels whose registers are all written on the next update */
+static uint8_t hw_reload;
+
+/* 1789773 / 16 / Hz - 1 for C3 to B8 */
+static const uint16_t periods[MUSIC_NOTE_COUNT] = {
+    854, 806, 761, 718, 678, 640, 604, 570, 538, 507, 479, 452,
+    427, 403, 380, 359, 338, 319, 301, 284, 268, 253, 239, 225,
+    213, 201, 189, 179, 169, 159, 150, 142, 134, 126, 119, 112,
+    106, 100, 94, 89, 84, 79, 75, 70, 66, 63, 59, 56,
+    52, 49, 47, 44, 41, 39, 37, 35, 33, 31, 29, 27,
+    26, 24, 23, 21, 20, 19, 18, 17, 16, 15, 14, 13
+};
+
+static void voice_start(voice_t * v, const uint8_t * stream, uint8_t bank)
+{
+    v->start = v->ptr = stream;
+    v->bank = bank;
+    v->wait = 1;
+    v->note = MUSIC_CMD_REST;
+    v->volume = 15;
+    v->duty = 2;
+    v->trigger = 0;
+}
+
+/* Reads the commands up to the next note or rest once the current one is over */
+static void voice_step(voice_t * v)
+{
+    const uint8_t * p = v->ptr;
+    uint8_t cmd, count = MUSIC_MAX_COMMANDS;
+
+    v->trigger = 0;
+    if (--v->wait) return;
+    v->wait = 1;
+    while (count--) {
+        cmd = *p++;
+        if (cmd < MUSIC_CMD_REST) {
+            v->note = cmd;
+            v->wait = *p++;
+            v->trigger = 1;
+            break;
+        } else if (cmd == MUSIC_CMD_REST) {
+            v->note = MUSIC_CMD_REST;
+            v->wait = *p++;
+            break;
+        } else if (cmd == MUSIC_CMD_WAIT) {
+            v->wait = *p++;
+            break;
+        } else if (cmd == MUSIC_CMD_VOLUME) {
+            v->volume = *p++;
+        } else if (cmd == MUSIC_CMD_DUTY) {
+            v->duty = *p++;
+        } else if (cmd == MUSIC_CMD_LOOP) {
+            p = v->start + (p[0] | ((uint16_t)p[1] << 8));
+        } else {
+            v->start = NULL;
+            v->note = MUSIC_CMD_REST;
+            break;
+        }
+    }
+    v->ptr = p;
+}
+
+static void hw_write(uint8_t ch, const voice_t * v)
+{
+    uint8_t mask = 1 << ch;
+    uint8_t reload = hw_reload & mask;
+    uint8_t rest = (v->note == MUSIC_CMD_REST);
+    uint8_t ctrl;
+    uint16_t period;
+
+    /* Length counters are halted and the volume is constant */
+    if (ch == MUSIC_CH_WAVE) {
+        ctrl = (rest || !v->volume) ? APU_TRI_OFF : APU_TRI_ON;
+    } else {
+        ctrl = APU_LENGTH_HALT | APU_CONST_VOLUME | ((rest) ? 0 : v->volume);
+        if (ch != MUSIC_CH_NOISE) ctrl |= v->duty << 6;
+    }
+
+    if (reload) {
+        hw_ctrl[ch] = ~ctrl;
+        hw_period[ch] = 0xFFFF;
+        hw_reload &= ~mask;
+    }
+
+    switch (ch) {
+        case MUSIC_CH_PULSE1:
+        case MUSIC_CH_PULSE2:
+            if (ctrl != hw_ctrl[ch]) {
+                if (ch) APU_PULSE2_CTRL = ctrl; else APU_PULSE1_CTRL = ctrl;
+            }
+            if (rest) break;
+            period = periods[v->note];
+            if ((uint8_t)period != (uint8_t)hw_period[ch]) {
+                if (ch) APU_PULSE2_LO = (uint8_t)period; else APU_PULSE1_LO = (uint8_t)period;
+            }
+            /* Writing the high byte restarts the waveform, which clicks: only when it changes */
+            if ((period >> 8) != (hw_period[ch] >> 8)) {
+                if (ch) APU_PULSE2_HI = (uint8_t)(period >> 8) | APU_LENGTH_LOAD;
+                else APU_PULSE1_HI = (uint8_t)(period >> 8) | APU_LENGTH_LOAD;
+            }
+            hw_period[ch] = period;
+            break;
+        case MUSIC_CH_WAVE:
+            /* The triangle is an octave lower than a pulse with the same period */
+            period = (rest) ? (hw_period[ch] & 0x07FF) : ((periods[v->note] + 1) >> 1) - 1;
+            if ((uint8_t)period != (uint8_t)hw_period[ch]) APU_TRI_LO = (uint8_t)period;
+            /* The high byte also reloads the linear counter, which turns it on or off */
+            if ((ctrl != hw_ctrl[ch]) || ((period >> 8) != (hw_period[ch] >> 8))) {
+                APU_TRI_CTRL = ctrl;
+                APU_TRI_HI = (uint8_t)(period >> 8) | APU_LENGTH_LOAD;
+            }
+            hw_period[ch] = period;
+            break;
+        default:
+            if (ctrl != hw_ctrl[ch]) APU_NOISE_CTRL = ctrl;
+            if (rest) break;
+            /* Pitch 0 - 7 as every other period, bit 3 is the short mode */
+            period = ((v->note & 0x08) << 4) | ((v->note & 0x07) << 1);
+            if (period != hw_period[ch]) APU_NOISE_PERIOD = (uint8_t)period;
+            if (v->trigger || reload) APU_NOISE_LENGTH = APU_LENGTH_LOAD;
+            hw_period[ch] = period;
+            break;
+    }
+    hw_ctrl[ch] = ctrl;
+}
+
+void music_play(const music_song_t * song, uint8_t bank)
+{
+    uint8_t save_bank = CURRENT_BANK, ch;
+
+    CRITICAL {
+        APU_STATUS = APU_STATUS_ALL;
+        APU_PULSE1_SWEEP = APU_SWEEP_OFF;
+        APU_PULSE2_SWEEP = APU_SWEEP_OFF;
+        if (bank) SWITCH_ROM(bank);
+        for (ch = 0; ch != MUSIC_CHANNELS; ch++) {
+            if (song->channels[ch]) voice_start(song_voices + ch, song->channels[ch], bank);
+            else {
+                song_voices[ch].start = NULL;
+                song_voices[ch].note = MUSIC_CMD_REST;
+            }
+        }
+        SWITCH_ROM(save_bank);
+        hw_reload = (1 << MUSIC_CHANNELS) - 1;
+    }
+}
+
+void music_stop(void)
+{
+    uint8_t ch;
+
+    CRITICAL {
+        for (ch = 0; ch != MUSIC_CHANNELS; ch++) {
+            song_voices[ch].start = NULL;
+            song_voices[ch].note = MUSIC_CMD_REST;
+            if (!sfx_voices[ch].start) hw_write(ch, song_voices + ch);
+        }
+    }
+}
+
+void music_sfx_play(const uint8_t * stream, uint8_t bank, uint8_t channel)
+{
+    CRITICAL {
+        voice_start(sfx_voices + channel, stream, bank);
+    }
+}
+
+uint8_t music_playing(void)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch != MUSIC_CHANNELS; ch++)
+        if (song_voices[ch].start) return 1;
+    return 0;
+}
+
+void music_update(void)
+{
+    uint8_t save_bank = CURRENT_BANK, ch;
+    voice_t * song = song_voices, * sfx = sfx_voices;
+
+    for (ch = 0; ch != MUSIC_CHANNELS; ch++, song++, sfx++) {
+        if (song->start) {
+            if (song->bank) SWITCH_ROM(song->bank);
+            voice_step(song);
+        }
+        if (sfx->start) {
+            if (sfx->bank) SWITCH_ROM(sfx->bank);
+            voice_step(sfx);
+            if (sfx->start) {
+                hw_write(ch, sfx);
+                continue;
+            }
+            /* The effect ended: the song takes the channel back */
+            hw_reload |= 1 << ch;
+            song->trigger = 1;
+        }
+        hw_write(ch, song);
+    }
+    SWITCH_ROM(save_bank);
+}
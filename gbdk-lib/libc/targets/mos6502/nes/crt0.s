@@ -1,10 +1,13 @@
 ;
 ; crt0.s for NES, using UNROM-512 (mapper30) with single-screen mirroring variant
+;  The mapper specific code is in mapper.s, or mapper_mmc1.s / mapper_mmc3.s when linked with lcc -mapper=
 ;
 ; Provides:
 ;  * Start-up code clearing RAM and VRAM
 ;  * Constant-cycle-time NMI handler, performing sprite DMA and VRAM writes via transfer buffer at $100
 ;  * 16-bit frame counter _sys_time, to support VM routines
+;  * IRQ vector and NMI hook in zero page, for handlers installed by library modules
+;  * Optional lag frame detection, and NMI tasks registered by nmi_tasks.s
 .module crt0
 .include    "global.s"
 
@@ -70,7 +73,6 @@ _sys_time::                             .ds 2
 _shadow_PPUCTRL::                       .ds 1
 _shadow_PPUMASK::                       .ds 1
 __crt0_paletteShadow::                  .ds 25
-__crt0_spritePageValid:                 .ds 1
 __crt0_NMI_Done:                        .ds 1
 __crt0_NMI_insideNMI:                   .ds 1
 __crt0_ScrollHV:                        .ds 1
@@ -79,10 +81,29 @@ __crt0_NMITEMP:                         .ds 4
 .tmp::                                  .ds 2
 _bkg_scroll_x::                         .ds 1
 _bkg_scroll_y::                         .ds 1
-_attribute_row_dirty::                  .ds 1
-_attribute_column_dirty::               .ds 1
 .crt0_forced_blanking::                 .ds 1
 .tempA::                                .ds 1
+; Jumped to through 6502 indirect JMP, which must not have the pointer at $xxFF
+.crt0_irq_vector::                      .ds 2
+.crt0_nmi_hook::                        .ds 2
+; Bit 7 set by vsync once the main loop is done with a frame, cleared by the NMI handler
+.crt0_frame_ready::                     .ds 1
+; Bit 7 set while lag frames are detected
+.crt0_lag_check::                       .ds 1
+_lag_frames::                           .ds 1
+; VBlank time for the transfer buffer, VRAM_DELAY_CYCLES_X8 less the time of NMI tasks
+.crt0_vram_budget_x8::                  .ds 1
+; Bit 7 set while NMI tasks are changed, to skip them
+.crt0_nmi_tasks_lock::                  .ds 1
+.crt0_nmi_task_count::                  .ds 1
+; Scratch for NMI tasks, which can't use OSEG or the temporaries of compiled code
+.nmi_zp_scratch::                       .ds 4
+
+.area _BSS
+; Routine and VBlank time in 8-cycles of each NMI task, 0 for one run after VBlank
+.crt0_nmi_task_lo::                     .ds NMI_TASK_MAX
+.crt0_nmi_task_hi::                     .ds NMI_TASK_MAX
+.crt0_nmi_task_cost::                   .ds NMI_TASK_MAX
 
 .area _CODE
 
@@ -111,6 +132,18 @@ NotInsideNMI:
     sta *__crt0_NMI_insideNMI
 
     jsr __crt0_doSpriteDMA
+
+    ; On a lag frame the main loop didn't reach vsync in time, and may be half way
+    ; through the next frame. Only OAM DMA and the tasks after VBlank are done then,
+    ; the PPU keeps the VRAM, palette and scroll of the last complete frame.
+    bit *.crt0_frame_ready
+    bmi __crt0_NMI_fullFrame
+    bit *.crt0_lag_check
+    bpl __crt0_NMI_fullFrame
+    inc *_lag_frames
+    jmp __crt0_NMI_frameDone
+__crt0_NMI_fullFrame:
+    lsr *.crt0_frame_ready
     jsr __crt0_NMI_doUpdateVRAM
 
     nop
@@ -118,6 +151,11 @@ NotInsideNMI:
     lda *_shadow_PPUMASK
     sta PPUMASK
 
+    lda *_shadow_PPUCTRL
+    ora *__crt0_ScrollHV
+    sta PPUCTRL
+
+__crt0_NMI_frameDone:
     lda *_sys_time
     clc
     adc #1
@@ -128,10 +166,11 @@ NotInsideNMI:
 
     lda #0x80
     sta __crt0_NMI_Done
-    
-    lda *_shadow_PPUCTRL
-    ora *__crt0_ScrollHV
-    sta PPUCTRL
+
+    ; Per frame work of library modules, after the timed VRAM updates
+    jsr __crt0_NMI_hook
+    lda #0
+    jsr __crt0_NMI_runTasks
 
     pla
     tay
@@ -152,6 +191,10 @@ __crt0_NMI_doUpdateVRAM:
     lda #0
     sta PPUMASK
     jsr DoUpdateVRAM
+    lda #0xFF
+    jsr __crt0_NMI_runTasks
+    ; Reset the write toggle, in case a task left it set
+    bit PPUSTATUS
     ; Set scroll address
     lda _bkg_scroll_x
     sta PPUSCROLL
@@ -167,11 +210,11 @@ __crt0_NMI_doUpdateVRAM_blanked:
 
 .bndry 0x100
 __crt0_doSpriteDMA:
-    bit *__crt0_spritePageValid
-    bpl __crt0_doSpriteDMA_spritePageInvalid
-    lda #0                      ; +2
-    sta OAMADDR                 ; +4
-    lda #>_shadow_OAM           ; +2
+    lda *__shadow_OAM_base
+    beq __crt0_doSpriteDMA_spritePageInvalid
+    ldx #0                      ; +2
+    stx OAMADDR                 ; +4
+    nop                         ; +2
     sta OAMDMA                  ; +512/513
     rts
 __crt0_doSpriteDMA_spritePageInvalid:
@@ -187,8 +230,11 @@ DoUpdateVRAM:
     bit *__vram_transfer_buffer_valid
     bmi DoUpdateVRAM_drawListValid
 DoUpdateVRAM_drawListInvalid:
-    ; Delay exactly 1633 cycles to keep timing consistent
-    ldx #(VRAM_DELAY_CYCLES_X8+7)
+    ; Delay as long as a full buffer of the current budget, to keep timing consistent
+    lda *.crt0_vram_budget_x8
+    clc
+    adc #7
+    tax
 DoUpdateVRAM_invalid_loop:
     lda *__vram_transfer_buffer_num_cycles_x8
     dex
@@ -204,7 +250,7 @@ DoUpdateVRAM_valid_loop:
     stx *__vram_transfer_buffer_num_cycles_x8
     dex
     bne DoUpdateVRAM_valid_loop
-    lda #VRAM_DELAY_CYCLES_X8
+    lda *.crt0_vram_budget_x8
     sta *__vram_transfer_buffer_num_cycles_x8
     rts
 
@@ -214,6 +260,8 @@ DoUpdateVRAM_valid_loop:
 ;                        = 8 * (7 + 6*NumTransfers + NumBytesTransferred)
 ;                        = 8 * (6*NumTransfers + NumBytesTransferred + 7)
 ;
+; ...plus 8 * (9 + (NumBytesFilled+1)/2) for each fill transfer
+;
 ProcessDrawList:
     ProcessDrawList_tempX  = __crt0_NMITEMP+2
     ProcessDrawList_addr   = __crt0_NMITEMP+0
@@ -236,6 +284,7 @@ ProcessDrawList_DoOneTransfer:
     pla                                         ; +4
     beq ProcessDrawList_EndOfList               ; +2/3
     tay                                         ; +2
+    bmi ProcessDrawList_Fill                    ; +2/3
     ; branchaddr = 256-4*num_bytes = NOT(4*num_bytes)+1+256 = NOT(4*num_bytes)+1
     lda ProcessDrawList_NumBytesToAddress,y     ; +4
     sta *ProcessDrawList_addr                   ; +3
@@ -246,9 +295,8 @@ ProcessDrawList_DoOneTransfer:
     pla                                         ; +4
     sta PPUADDR                                 ; +4
     nop                                         ; +2
-    nop                                         ; +2
     jmp [ProcessDrawList_addr]                  ; +5
-    ; Total = 4 + 2 + 2 + 4 + 3 + 6*4 + 2 + 2 + 5 = 48 for each transfer (...+ 8*NumBytesCopied)
+    ; Total = 4 + 2 + 2 + 2 + 4 + 3 + 6*4 + 2 + 5 = 48 for each transfer (...+ 8*NumBytesCopied)
     ;         4 + 3 + 14 = 7 + 14 = 21 fixed-cost exit
 
 ProcessDrawList_EndOfList:
@@ -260,6 +308,42 @@ ProcessDrawList_EndOfList:
     rts                                 ; +6
     ; = 3 + 2 + 2 + 3 + 3 + 6 = 19
 
+;
+; Fill transfer: length byte is 0x80 | num_bytes, followed by direction,
+; address and a single data byte which is written num_bytes times.
+; An odd num_bytes takes 4 extra cycles, so each fill costs a whole number of 8-cycles.
+;
+ProcessDrawList_Fill:
+    ; (includes +1 for the page crossing, which always happens as y >= 0x80)
+    lda ProcessDrawList_NumBytesToFillAddress-0x80,y    ; +5
+    sta *ProcessDrawList_addr                           ; +3
+    lda #>ProcessDrawList_UnrolledFillLoop              ; +2
+    sta *ProcessDrawList_addr+1                         ; +3
+    pla                                                 ; +4
+    sta PPUCTRL                                         ; +4
+    pla                                                 ; +4
+    sta PPUADDR                                         ; +4
+    pla                                                 ; +4
+    sta PPUADDR                                         ; +4
+    tya                                                 ; +2
+    lsr                                                 ; +2
+    bcc ProcessDrawList_FillEven                        ; +2/3
+    nop                                                 ; +2
+    bit *ProcessDrawList_addr                           ; +3
+ProcessDrawList_FillEven:
+    pla                                                 ; +4
+    jmp [ProcessDrawList_addr]                          ; +5
+    ; Total = 4 + 2 + 2 + 3 + 5 + 3 + 2 + 3 + 6*4 + 2 + 2 + 3 + 4 + 5 = 64 (+4 if num_bytes is odd)
+    ; (the UnrolledFillLoop entries must stay within this page)
+ProcessDrawList_UnrolledFillLoop:
+.rept VRAM_MAX_FILL_BYTES
+sta PPUDATA     ; +4
+.endm
+    lda #>ProcessDrawList_UnrolledCopyLoop              ; +2
+    sta *ProcessDrawList_addr+1                         ; +3
+    jmp ProcessDrawList_DoOneTransfer                   ; +3
+    ; Total = 64 + 8 + 4*num_bytes (+4 if odd) = 8 * (9 + (num_bytes+1)/2)
+
 .bndry 0x100
 ProcessDrawList_NumBytesToAddress:
 i = 0
@@ -267,9 +351,58 @@ i = 0
 .db <(256-4*i)
 i = i + 1
 .endm
+ProcessDrawList_NumBytesToFillAddress:
+i = 0
+.rept VRAM_MAX_FILL_BYTES+1
+.db <(ProcessDrawList_UnrolledFillLoop+3*(VRAM_MAX_FILL_BYTES-i))
+i = i + 1
+.endm
+
+;
+; Runs the NMI tasks in the order they were added: the ones with
+; a VBlank time if A is 0xFF, the ones without one if A is 0
+;
+__crt0_NMI_runTasks:
+    bit *.crt0_nmi_tasks_lock
+    bmi 3$
+    sta *__crt0_NMITEMP+2
+    ldx #0
+1$:
+    cpx *.crt0_nmi_task_count
+    bcs 3$
+    stx *__crt0_NMITEMP+3
+    lda .crt0_nmi_task_cost,x
+    beq 2$
+    lda #0xFF
+2$:
+    cmp *__crt0_NMITEMP+2
+    bne 4$
+    lda .crt0_nmi_task_lo,x
+    sta *__crt0_NMITEMP
+    lda .crt0_nmi_task_hi,x
+    sta *__crt0_NMITEMP+1
+    jsr __crt0_NMI_callTask
+4$:
+    ldx *__crt0_NMITEMP+3
+    inx
+    bne 1$
+3$:
+    rts
+
+__crt0_NMI_callTask:
+    jmp [__crt0_NMITEMP]
 
 __crt0_IRQ:
-    jmp __crt0_IRQ
+    jmp [.crt0_irq_vector]
+
+__crt0_NMI_hook:
+    jmp [.crt0_nmi_hook]
+
+; Default IRQ handler and NMI hook, until a library module installs its own
+__crt0_IRQ_none:
+    rti
+__crt0_NMI_hook_none:
+    rts
 
 __crt0_setPalette:
     ; Set background color to 30 (white)
@@ -348,13 +481,16 @@ __crt0_clearVRAM_loop:
 .wait_vbl_done::
 _wait_vbl_done::
 _vsync::
+    ; The frame is complete, the next NMI may update VRAM
+    sec
+    ror *.crt0_frame_ready
     lda *_sys_time
 _wait_vbl_done_waitForNextFrame_loop:
     cmp *_sys_time
     beq _wait_vbl_done_waitForNextFrame_loop
     rts
 
-__crt0_RESET:
+__crt0_RESET::
     ; Disable IRQs
     sei
     ; Set stack pointer
@@ -392,20 +528,29 @@ __crt0_RESET_bankSwitchValue:
     lda #<s__DATA
     ldx #>s__DATA
     jsr ___memcpy
-    ; Set bank to first
-    lda #0x00
-    sta *__current_bank
+    ; Set up the mapper and switch to the first bank
+    jsr __mapper_init
     ; Set palette shadow
     jsr __crt0_setPalette
+    ; No IRQ handler or NMI hook yet
+    lda #<__crt0_IRQ_none
+    sta *.crt0_irq_vector
+    lda #>__crt0_IRQ_none
+    sta *.crt0_irq_vector+1
+    lda #<__crt0_NMI_hook_none
+    sta *.crt0_nmi_hook
+    lda #>__crt0_NMI_hook_none
+    sta *.crt0_nmi_hook+1
     lda #VRAM_DELAY_CYCLES_X8
+    sta *.crt0_vram_budget_x8
     sta *__vram_transfer_buffer_num_cycles_x8
     lda #0
     sta *__vram_transfer_buffer_pos_w
     ; 
     lda #(PPUMASK_SHOW_BG | PPUMASK_SHOW_SPR | PPUMASK_SHOW_BG_LC | PPUMASK_SHOW_SPR_LC)
     sta *_shadow_PPUMASK
-    lda #0x80
-    sta *__crt0_spritePageValid
+    lda #>_shadow_OAM
+    sta *__shadow_OAM_base
     ; enable NMI
     lda #(PPUCTRL_NMI | PPUCTRL_SPR_CHR)
     sta *_shadow_PPUCTRL
@@ -442,5 +587,5 @@ _display_on::
 .area VECTORS (ABS)
 .org 0xfffa
 .dw	__crt0_NMI
-.dw	__crt0_RESET
+.dw	__mapper_reset
 .dw	__crt0_IRQ
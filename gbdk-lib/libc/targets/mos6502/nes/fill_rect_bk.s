@@ -9,56 +9,55 @@
 
     .area   _HOME
 
+;
+; Each row (or column) is written as one fill stripe, which takes the same
+; space in the vram transfer buffer whatever its length
+;
 _fill_bkg_rect::
-    ; TODO: Switch to use vram transfer buffer when screen not blanked
     .define .width  "_fill_bkg_rect_PARM_3"
     .define .height "_fill_bkg_rect_PARM_4"
     .define .tile   "_fill_bkg_rect_PARM_5"
     sta *.xpos
     stx *.ypos
+    lda *.width
+    beq _fill_bkg_rect_end
     ldy *.height
+    beq _fill_bkg_rect_end
     ; Prefer vertical stripes if height > width
     cpy *.width
     beq _fill_bkg_rect_horizontalStripes
     bcs _fill_bkg_rect_verticalStripes
 _fill_bkg_rect_horizontalStripes:
+    lda *.width
+    sta *__vram_transfer_buffer_fill_count
 1$:
-    lda #0
-    sta *.tmp+1
-    lda *.ypos
-    asl
-    rol *.tmp+1
-    asl
-    rol *.tmp+1
-    asl
-    rol *.tmp+1
-    asl
-    rol *.tmp+1
-    asl
-    rol *.tmp+1
-    ora *.xpos
-    sta *.tmp
-    ;
-    lda *.tmp+1
-    ora #0x20
-    tax
-    lda *.tmp
-    jsr .ppu_stripe_begin_horizontal
-    ldx *.width
-2$:
-    lda *.tile
-    jsr .ppu_stripe_write_byte
-    dex
-    bne 2$
-    jsr .ppu_stripe_end
+    jsr .fill_bkg_rect_ppu_addr
+    ldy *.tile
+    clc
+    jsr .ppu_stripe_fill
     inc *.ypos
-    dey
+    dec *.height
     bne 1$
+_fill_bkg_rect_end:
     rts
 
 _fill_bkg_rect_verticalStripes:
-    ldy *.width
+    lda *.height
+    sta *__vram_transfer_buffer_fill_count
 1$:
+    jsr .fill_bkg_rect_ppu_addr
+    ldy *.tile
+    sec
+    jsr .ppu_stripe_fill
+    inc *.xpos
+    dec *.width
+    bne 1$
+    rts
+
+;
+; XA = PPU_NT0 | (.ypos << 5) | .xpos
+;
+.fill_bkg_rect_ppu_addr:
     lda #0
     sta *.tmp+1
     lda *.ypos
@@ -79,15 +78,4 @@ _fill_bkg_rect_verticalStripes:
     ora #0x20
     tax
     lda *.tmp
-    jsr .ppu_stripe_begin_vertical
-    ldx *.height
-2$:
-    lda *.tile
-    jsr .ppu_stripe_write_byte
-    dex
-    bne 2$
-    jsr .ppu_stripe_end
-    inc *.xpos
-    dey
-    bne 1$
     rts
@@ -1,110 +1,178 @@
     .include    "global.s"
 
+    .area   OSEG (PAG, OVR)
+    .dirty:                     .ds 1
+    .pair:                      .ds 1
+    .row:                       .ds 1
+    .iso:                       .ds 1
+
+    .area   _DATA
+;
+; One byte per row of the attribute table, with a bit set for each
+; attribute byte in _attribute_shadow not yet written to PPU memory.
+;
+_attribute_dirty::              .ds ATTRIBUTE_PACKED_HEIGHT
+
     .area   _HOME
-    
-_flush_shadow_attributes::
-    jsr _flush_shadow_attributes_rows
-    jmp _flush_shadow_attributes_columns
 
 ;
-; Writes every row of attributes from _shadow_attributes that's been marked
-; as dirty in the _attribute_row_dirty byte to PPU memory.
+; Writes every byte of _attribute_shadow marked in _attribute_dirty to PPU memory,
+; as few stripes as possible:
+; - A byte with no dirty neighbour in its row, whose counterpart 4 rows further down
+;   is the same, is written together with it as one 2-byte vertical stripe
+; - Everything else is written as horizontal stripes of consecutive dirty bytes
+;   (which the transfer buffer joins across rows when whole rows are dirty)
 ;
-_flush_shadow_attributes_rows:
-    lda #<PPU_AT0
-    sta *.tmp
-    lda #>PPU_AT0
-    sta *.tmp+1
-    ldy #0
-_flush_shadow_attributes_row_loop:
-    lsr *_attribute_row_dirty
-    bcc 1$
-    jmp _flush_shadow_attributes_update_row
+_flush_shadow_attributes::
+    ldx #0
+_flush_shadow_attributes_pair_loop:
+    lda _attribute_dirty,x
+    jsr .attribute_isolated
+    sta *.pair
+    lda _attribute_dirty+4,x
+    jsr .attribute_isolated
+    and *.pair
+    beq _flush_shadow_attributes_next_pair
+    sta *.pair
+    eor #0xFF
+    pha
+    and _attribute_dirty,x
+    sta _attribute_dirty,x
+    pla
+    and _attribute_dirty+4,x
+    sta _attribute_dirty+4,x
+    ; Y = index of first byte in row
+    stx *.row
+    txa
+    asl
+    asl
+    asl
+    tay
 1$:
-    beq _flush_shadow_attributes_end
-_flush_shadow_attributes_next_row:
-    ; Y += 8
+    lsr *.pair
+    bcc 2$
+    ; PPU has no increment-by-8 feature, but increment-by-32 reaches the byte 4 rows down
     tya
-    clc
-    adc #8
+    ora #<PPU_AT0
+    ldx #>PPU_AT0
+    sec
+    jsr .ppu_stripe_begin
+    lda _attribute_shadow,y
+    jsr .ppu_stripe_write_byte
+    lda _attribute_shadow+32,y
+    jsr .ppu_stripe_write_byte
+    jsr .ppu_stripe_end
+2$:
+    iny
+    lda *.pair
+    bne 1$
+    ldx *.row
+_flush_shadow_attributes_next_pair:
+    inx
+    cpx #4
+    bne _flush_shadow_attributes_pair_loop
+
+    ldx #0
+_flush_shadow_attributes_row_loop:
+    lda _attribute_dirty,x
+    beq _flush_shadow_attributes_next_row
+    sta *.dirty
+    lda #0
+    sta _attribute_dirty,x
+    stx *.row
+    ; Y = index of first byte in row
+    txa
+    asl
+    asl
+    asl
     tay
-    ; .tmp += 8
-    lda *.tmp
-    adc #8
-    sta *.tmp
-    jmp _flush_shadow_attributes_row_loop
-_flush_shadow_attributes_end:
+_flush_shadow_attributes_find_run:
+    lsr *.dirty
+    bcs _flush_shadow_attributes_update_run
+    iny
+    jmp _flush_shadow_attributes_find_run
+_flush_shadow_attributes_update_run:
+    tya
+    ora #<PPU_AT0
+    ldx #>PPU_AT0
+    clc
+    jsr .ppu_stripe_begin
+1$:
+    lda _attribute_shadow,y
+    jsr .ppu_stripe_write_byte
+    iny
+    lsr *.dirty
+    bcs 1$
+    jsr .ppu_stripe_end
+    ; Byte Y is clean, look for another run if any bits are left
+    lda *.dirty
+    beq 2$
+    iny
+    jmp _flush_shadow_attributes_find_run
+2$:
+    ldx *.row
+_flush_shadow_attributes_next_row:
+    inx
+    cpx #ATTRIBUTE_PACKED_HEIGHT
+    bne _flush_shadow_attributes_row_loop
     rts
 
 ;
-; Flushes all dirty rows of _attribute_shadow by writing them to PPU memory
+; A = bits of A which have neither neighbour set
 ;
-_flush_shadow_attributes_update_row:
-    ; Update all 8 bytes of row for now, as each row in _attribute_row_dirty only stores 1 bit
-    ; TODO: Could store 8 bytes and update range, at expense of 7 more bytes.
-    lda *.tmp+1
-    tax
-    lda *.tmp
-    jsr .ppu_stripe_begin_horizontal
-    ; Write 8 bytes
-    i = 0
-    .rept 8
-    lda _attribute_shadow+i,y
-    jsr .ppu_stripe_write_byte
-    i = i + 1
-    .endm
-    jsr .ppu_stripe_end
-    jmp _flush_shadow_attributes_next_row
+.attribute_isolated:
+    sta *.iso
+    asl
+    sta *.tmp
+    lda *.iso
+    lsr
+    ora *.tmp
+    eor #0xFF
+    and *.iso
+    rts
 
 ;
-; Writes every column of attributes from _shadow_attributes that's been marked
-; as dirty in the _attribute_column_dirty byte to PPU memory.
-;
+; Marks the attribute bytes in column mask A as dirty, in Y rows (1 - 8) from row X.
+; Rows wrap around from 7 to 0. Trashes A, X and Y.
 ;
-_flush_shadow_attributes_columns:
-    lda #<PPU_AT0
+.attribute_mark_dirty::
     sta *.tmp
-    lda #>PPU_AT0
-    sta *.tmp+1
-    ldy #0
-_flush_shadow_attributes_columns_loop:
-    lsr *_attribute_column_dirty
-    bcc 1$
-    jmp _flush_shadow_attributes_update_column
 1$:
-    beq _flush_shadow_attributes_columns_end
-_flush_shadow_attributes_columns_next_column:
-    ; Y += 1
-    iny
-    ; .tmp += 1
-    inc *.tmp
-    jmp _flush_shadow_attributes_columns_loop
-_flush_shadow_attributes_columns_end:
+    lda _attribute_dirty,x
+    ora *.tmp
+    sta _attribute_dirty,x
+    inx
+    txa
+    and #ATTRIBUTE_PACKED_HEIGHT-1
+    tax
+    dey
+    bne 1$
     rts
 
 ;
-; Flushes all dirty rows of _attribute_shadow by writing them to PPU memory
+; A = column mask for Y columns (1 - 8) from column A, wrapping around from 7 to 0.
+; Trashes X.
 ;
-_flush_shadow_attributes_update_column:
-    ; Update all 8 bytes of column for now, as each column in _attribute_column_dirty only stores 1 bit
-    ; As PPU has no increment-by-8 feature, split writes into 4 separate stripes 2 bytes each
-    ; TODO: Could make a dedicated unrolled transfer routine in nmi handler that writes all 8 bytes as one stripe.
-    i = 0
-    .rept 4
-    lda *.tmp+1
+.attribute_column_mask::
     tax
-    lda *.tmp
-    jsr .ppu_stripe_begin_vertical
-    lda _attribute_shadow+8*i,y
-    jsr .ppu_stripe_write_byte
-    lda _attribute_shadow+8*i+32,y
-    jsr .ppu_stripe_write_byte
-    jsr .ppu_stripe_end
-    ;
-    lda *.tmp
-    clc
-    adc #8
-    sta *.tmp
-    i = i + 1
-    .endm
-    jmp _flush_shadow_attributes_columns_next_column
+    lda .attribute_mask_low-1,y
+    cpx #0
+    beq 2$
+1$:
+    ; Rotate left by one column
+    cmp #0x80
+    rol
+    dex
+    bne 1$
+2$:
+    rts
+
+.attribute_mask_low:
+.db 0b00000001
+.db 0b00000011
+.db 0b00000111
+.db 0b00001111
+.db 0b00011111
+.db 0b00111111
+.db 0b01111111
+.db 0b11111111
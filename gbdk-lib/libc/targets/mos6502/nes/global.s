@@ -2,6 +2,10 @@
         __vram_transfer_buffer = 0x100
         ;; Number of 8-cycles available each frame for transfer buffer
         VRAM_DELAY_CYCLES_X8  = 170
+        ;; Longest fill stripe (one byte repeated) in the transfer buffer
+        VRAM_MAX_FILL_BYTES   = 32
+        ;; Number of NMI tasks which can be added with nmi_task_add()
+        NMI_TASK_MAX          = 4
 
         ;;  Keypad
         .UP             = 0x10
@@ -115,7 +119,17 @@
         .globl _shadow_PPUCTRL, _shadow_PPUMASK
         .globl _bkg_scroll_x, _bkg_scroll_y
         .globl __crt0_paletteShadow
-        .globl _attribute_shadow, _attribute_row_dirty
+        .globl .crt0_irq_vector, .crt0_nmi_hook
+        .globl .crt0_frame_ready, .crt0_lag_check, _lag_frames
+        .globl .crt0_vram_budget_x8, .crt0_nmi_tasks_lock, .crt0_nmi_task_count
+        .globl .crt0_nmi_task_lo, .crt0_nmi_task_hi, .crt0_nmi_task_cost
+        .globl .nmi_zp_scratch
+
+        ;; Register entries for assembly callers (see the calling convention in the docs)
+        .globl .set_vram_byte, .set_bkg_tile_xy
+        .globl .ppu_stripe_begin, .ppu_stripe_begin_horizontal, .ppu_stripe_begin_vertical
+        .globl .ppu_stripe_write_byte, .ppu_stripe_end, .ppu_stripe_fill
+        .globl _attribute_shadow, _attribute_dirty
         
         ;; Identity table for register-to-register-adds and bankswitching
         .globl .identity, _identity
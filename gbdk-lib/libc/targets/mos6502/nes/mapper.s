@@ -1,6 +1,18 @@
 .include "global.s"
 .include "mapper_macros.s"
 
+; Default mapper: UNROM-512 (mapper 30), also works on UxROM (mapper 2)
+; MMC1 and MMC3 versions of this module are in mapper_mmc1.s and mapper_mmc3.s
+
+; Reset vector target, the switchable and fixed banks
+; are already in place at power on for this mapper
+__mapper_reset::
+    jmp __crt0_RESET
+
+; Called by crt0 once the stack is set up, switches to the first bank
+__mapper_init::
+    lda #0x00
+
 __switch_prg0::
     sta *__current_bank
     SWITCH_PRG0_A
@@ -0,0 +1,134 @@
+;
+; Banked call support shared by mapper_mmc1.s and mapper_mmc3.s
+;
+; Same as sdcc_bcall.s and far_ptr.s, which are replaced when one of those
+; modules is linked. Expects SWITCH_PRG0_A to be defined by the including
+; file. Calls into the bank which is already active skip the mapper
+; writes and jump straight to the function, which then returns directly
+; to the caller.
+;
+
+    .area   OSEG (PAG, OVR)
+    _to_far_ptr_PARM_2::    .ds 2
+
+    .area _ZP
+    ___call_banked_ptr::
+    ___call_banked_addr::   .ds 2
+    ___call_banked_bank::   .ds 2
+
+    .area _HOME
+
+;
+; For a banked call to function "func", sdcc will generate the following sequence:
+;
+; jsr __sdcc_bcall  <-- Call to this support function
+; .db b_func        <-- Bank of func
+; .dw func-1        <-- Address of func - 1.
+;
+___sdcc_bcall::
+    ; save potential function parameter in A
+    sta *.tempA
+    ; Store old return address to *.tmp, and add +3 to return address on stack (to skip parameters)
+    pla
+    sta *.tmp
+    clc
+    adc #3
+    tay
+    pla
+    sta *.tmp+1
+    adc #0
+    pha
+    tya
+    pha
+    ; Read bank number (stored after jsr ___sdcc_bcall)
+    ldy #0x01
+    lda [*.tmp],y
+    cmp *__current_bank
+    bne 1$
+    ; Same bank: push the function address and jump to it via RTS
+    ldy #0x03
+    lda [*.tmp],y
+    pha
+    dey
+    lda [*.tmp],y
+    pha
+    lda *.tempA
+    rts
+1$:
+    ; Save old bank on stack
+    lda *__current_bank
+    pha
+    ; Perform banked call
+    jsr 2$
+    ; Returned from banked call
+    sta *.tempA
+    pla
+    sta *__current_bank
+    SWITCH_PRG0_A
+    ; restore potential function return value to A
+    lda *.tempA
+    ; Return to original bank
+    rts
+2$:
+    ldy #0x03
+    ; Read address (stored after jsr ___sdcc_bcall and bank number)
+    lda [*.tmp],y
+    pha
+    dey
+    lda [*.tmp],y
+    pha
+    dey
+    ; Read bank number (stored after jsr ___sdcc_bcall)
+    lda [*.tmp],y
+    ; Switch bank
+    sta *__current_bank
+    SWITCH_PRG0_A
+    ; restore potential function parameter to A
+    lda *.tempA
+    ; Jump to banked function via RTS
+    rts
+
+_to_far_ptr::
+    ; XA is input 16-bit offset
+    ; XA is also 16-bit return value -> nothing to move for lower 16 bits
+    ; Move bank number
+    ldy *_to_far_ptr_PARM_2
+    sty *___SDCC_m6502_ret2
+    ; Upper byte always zero - but could be used by calling function expecting int32
+    ldy #0x00
+    sty *___SDCC_m6502_ret3
+    rts
+
+___call__banked::
+    ; save potential function parameter in A
+    sta *.tmp
+    lda *___call_banked_bank
+    cmp *__current_bank
+    bne 1$
+    ; Same bank: jump straight to the function
+    lda *.tmp
+    jmp [*___call_banked_addr]
+1$:
+    ; Save old bank on stack
+    lda *__current_bank
+    pha
+    ; Set new bank
+    lda *___call_banked_bank
+    sta *__current_bank
+    SWITCH_PRG0_A
+    ; restore potential function parameter to A
+    lda *.tmp
+    ; Perform banked call
+    jsr 2$
+    ; Returned from banked call
+    ; save potential function return value in A
+    sta *.tmp
+    ; pull old bank and switch back
+    pla
+    sta *__current_bank
+    SWITCH_PRG0_A
+    ; restore potential function return value to A
+    lda *.tmp
+    rts
+2$:
+    jmp [*___call_banked_addr]
@@ -0,0 +1,125 @@
+;
+; MMC1 (mapper 1) banking, linked instead of mapper.s, sdcc_bcall.s and far_ptr.s by: lcc -mapper=mmc1
+;
+; PRG mode 3: 16K switchable bank at $8000, last bank fixed at $C000.
+; One screen mirroring like the default mapper, 8K CHR RAM, or CHR-ROM
+; switched as 4K pattern tables by set_bkg_chr_bank() / set_sprite_chr_bank().
+; Up to 16 banks (256K PRG ROM).
+;
+; Which bank is at $C000 at power on depends on the MMC1 revision, so
+; makebin -ym 1 copies the reset stub and the vectors ($FFF0 - $FFFF) to
+; the end of every bank. $BFF0 - $BFFF of the switchable banks stays free.
+;
+; MMC1 registers are loaded one bit per write. If an interrupt handler
+; switches banks part way through a load, the load is started over
+; (see .mmc1_write_prg) so interrupts can stay enabled.
+;
+    .module mapper_mmc1
+
+    .include "global.s"
+
+    MMC1_CONTROL        = 0x8000
+    MMC1_CHR0           = 0xA000
+    MMC1_CHR1           = 0xC000
+    MMC1_PRG            = 0xE000
+    MMC1_RESET          = 0x80      ; Clears the shift register and sets PRG mode 3
+    MMC1_CONTROL_INIT   = 0x1C      ; One screen (lower), PRG mode 3, 4K CHR banks
+
+; Loads MMC1 register REG with bits 0-4 of A, trashes A
+.macro MMC1_WRITE_A REG
+    sta REG
+    lsr
+    sta REG
+    lsr
+    sta REG
+    lsr
+    sta REG
+    lsr
+    sta REG
+.endm
+
+; Switches to bank __current_bank, trashes A and Y
+.macro SWITCH_PRG0_A
+    jsr .mmc1_write_prg
+.endm
+
+    .area _ZP (PAG)
+.mmc1_switch_count:     .ds 1
+.mmc1_chr0_bank:        .ds 1      ; One per register, an interrupt handler
+.mmc1_chr1_bank:        .ds 1      ; may load the other one during a retry
+
+    .area _MAPPER_RESET (ABS)
+    .org 0xFFF0
+
+; Reset vector target, runs from whichever bank is at $C000. Makes sure
+; the last bank is fixed there before crt0 runs from it
+__mapper_reset::
+    sei
+    lda #MMC1_RESET
+    sta MMC1_CONTROL
+    jmp __crt0_RESET
+
+    .area _HOME
+
+; Called by crt0 once the stack is set up, switches to the first bank
+__mapper_init::
+    lda #MMC1_RESET
+    sta MMC1_CONTROL
+    lda #MMC1_CONTROL_INIT
+    MMC1_WRITE_A MMC1_CONTROL
+    ; 4K CHR banks 0 and 1, the same 8K as one 8K bank
+    lda #0x00
+    MMC1_WRITE_A MMC1_CHR0
+    lda #0x01
+    MMC1_WRITE_A MMC1_CHR1
+    lda #0x00
+
+__switch_prg0::
+    sta *__current_bank
+
+; Loads __current_bank into the PRG bank register, trashes A and Y
+; Every completed load bumps .mmc1_switch_count. If it changed while
+; loading, an interrupt handler mixed its own writes into the shift
+; register, so reset it and load again.
+.mmc1_write_prg:
+    ldy *.mmc1_switch_count
+    lda #MMC1_RESET
+    sta MMC1_PRG
+    lda *__current_bank
+    MMC1_WRITE_A MMC1_PRG
+    cpy *.mmc1_switch_count
+    bne .mmc1_write_prg
+    inc *.mmc1_switch_count
+    rts
+
+; void set_bkg_chr_bank(uint8_t bank)
+; Loads 4K CHR bank A for $0000, retried like .mmc1_write_prg
+_set_bkg_chr_bank::
+    sta *.mmc1_chr0_bank
+1$:
+    ldy *.mmc1_switch_count
+    lda #MMC1_RESET
+    sta MMC1_CHR0
+    lda *.mmc1_chr0_bank
+    MMC1_WRITE_A MMC1_CHR0
+    cpy *.mmc1_switch_count
+    bne 1$
+    inc *.mmc1_switch_count
+    rts
+
+; void set_sprite_chr_bank(uint8_t bank)
+; Loads 4K CHR bank A for $1000
+_set_sprite_chr_bank::
+    sta *.mmc1_chr1_bank
+1$:
+    ldy *.mmc1_switch_count
+    lda #MMC1_RESET
+    sta MMC1_CHR1
+    lda *.mmc1_chr1_bank
+    MMC1_WRITE_A MMC1_CHR1
+    cpy *.mmc1_switch_count
+    bne 1$
+    inc *.mmc1_switch_count
+    rts
+
+    .include "mapper_banked_calls.s"
@@ -0,0 +1,170 @@
+;
+; MMC3 (mapper 4) banking, linked instead of mapper.s, sdcc_bcall.s and far_ptr.s by: lcc -mapper=mmc3
+;
+; PRG mode 0: two 8K windows at $8000 (R6) and $A000 (R7), the last 16K
+; fixed at $C000. A 16K bank N from bankpack is mapped as 8K banks 2N and
+; 2N+1, which takes two register writes instead of MMC1's five.
+; switch_prg_a000() swaps only the $A000 window, for paging 8K of data
+; while code runs from $8000.
+;
+; MMC3 has no one screen mirroring, horizontal mirroring is used so the
+; background still wraps at 256 pixels horizontally. 8K CHR RAM, or
+; CHR-ROM switched as 4K pattern tables by set_bkg_chr_bank() and
+; set_sprite_chr_bank(): R0 - R1 (2K) at $0000, R2 - R5 (1K) at $1000.
+;
+    .module mapper_mmc3
+
+    .include "global.s"
+
+    MMC3_BANK_SELECT    = 0x8000
+    MMC3_BANK_DATA      = 0x8001
+    MMC3_MIRRORING      = 0xA000
+    MMC3_PRG_RAM        = 0xA001
+    MMC3_IRQ_DISABLE    = 0xE000
+    MMC3_R6             = 0x06      ; 8K at $8000, with PRG mode 0
+    MMC3_R7             = 0x07      ; 8K at $A000
+    MMC3_MIRROR_H       = 0x01
+    MMC3_PRG_RAM_ON     = 0x80
+
+; Switches to bank __current_bank, trashes A and Y
+.macro SWITCH_PRG0_A
+    jsr .mmc3_write_prg
+.endm
+
+    .area _ZP (PAG)
+.mmc3_switch_count:     .ds 1
+.mmc3_a000_bank:        .ds 1
+.mmc3_bkg_chr_base:     .ds 1      ; One per pattern table, an interrupt handler
+.mmc3_sprite_chr_base:  .ds 1      ; may map the other one during a retry
+
+    .area _MAPPER_RESET (ABS)
+    .org 0xFFF0
+
+; Reset vector target. Selects PRG mode 0, which fixes the second last
+; 8K bank at $C000, before crt0 runs from it
+__mapper_reset::
+    sei
+    lda #MMC3_R6
+    sta MMC3_BANK_SELECT
+    jmp __crt0_RESET
+
+    .area _HOME
+
+; Called by crt0 once the stack is set up, switches to the first bank
+__mapper_init::
+    sta MMC3_IRQ_DISABLE
+    lda #MMC3_MIRROR_H
+    sta MMC3_MIRRORING
+    lda #MMC3_PRG_RAM_ON
+    sta MMC3_PRG_RAM
+    ; Map the 8K CHR RAM in order: R0 and R1 are 2K, R2 - R5 are 1K
+    ldy #0x05
+1$:
+    sty MMC3_BANK_SELECT
+    lda .mmc3_chr_banks,y
+    sta MMC3_BANK_DATA
+    dey
+    bpl 1$
+    lda #0x00
+
+__switch_prg0::
+    sta *__current_bank
+
+; Maps __current_bank into both windows, trashes A and Y
+; Every completed update bumps .mmc3_switch_count. If it changed, an
+; interrupt handler changed the selected register between our select
+; and data writes, so write both windows again.
+.mmc3_write_prg:
+    ldy *.mmc3_switch_count
+    lda #MMC3_R6
+    sta MMC3_BANK_SELECT
+    lda *__current_bank
+    asl
+    sta MMC3_BANK_DATA
+    lda #MMC3_R7
+    sta MMC3_BANK_SELECT
+    lda *__current_bank
+    sec
+    rol
+    sta MMC3_BANK_DATA
+    cpy *.mmc3_switch_count
+    bne .mmc3_write_prg
+    inc *.mmc3_switch_count
+    rts
+
+; void switch_prg_a000(uint8_t bank_8k)
+; Maps 8K bank A at $A000. The next banked call or return maps the
+; matching half of its 16K bank there again.
+_switch_prg_a000::
+    sta *.mmc3_a000_bank
+1$:
+    ldy *.mmc3_switch_count
+    lda #MMC3_R7
+    sta MMC3_BANK_SELECT
+    lda *.mmc3_a000_bank
+    sta MMC3_BANK_DATA
+    cpy *.mmc3_switch_count
+    bne 1$
+    inc *.mmc3_switch_count
+    rts
+
+; void set_bkg_chr_bank(uint8_t bank)
+; Maps 4K CHR bank A at $0000 (R0 - R1),
+; the offsets within the 4K bank are the low bits of .mmc3_chr_banks
+_set_bkg_chr_bank::
+    asl
+    asl
+    sta *.mmc3_bkg_chr_base
+1$:
+    ldy *.mmc3_switch_count
+    ldx #0x00
+2$:
+    stx MMC3_BANK_SELECT
+    lda .mmc3_chr_banks,x
+    and #0x03
+    ora *.mmc3_bkg_chr_base
+    sta MMC3_BANK_DATA
+    inx
+    cpx #0x02
+    bne 2$
+    cpy *.mmc3_switch_count
+    beq 3$
+    ; An interrupt handler selected R6 / R7 between a select and data
+    ; write, so one of the PRG windows may hold a CHR bank number now
+    jsr .mmc3_write_prg
+    jmp 1$
+3$:
+    inc *.mmc3_switch_count
+    rts
+
+; void set_sprite_chr_bank(uint8_t bank)
+; Maps 4K CHR bank A at $1000 (R2 - R5), like set_bkg_chr_bank()
+_set_sprite_chr_bank::
+    asl
+    asl
+    sta *.mmc3_sprite_chr_base
+1$:
+    ldy *.mmc3_switch_count
+    ldx #0x02
+2$:
+    stx MMC3_BANK_SELECT
+    lda .mmc3_chr_banks,x
+    and #0x03
+    ora *.mmc3_sprite_chr_base
+    sta MMC3_BANK_DATA
+    inx
+    cpx #0x06
+    bne 2$
+    cpy *.mmc3_switch_count
+    beq 3$
+    jsr .mmc3_write_prg
+    jmp 1$
+3$:
+    inc *.mmc3_switch_count
+    rts
+
+; Initial CHR banks in 1K units, 4K bank 0 at $0000 and 1 at $1000
+.mmc3_chr_banks:
+    .db 0, 2, 4, 5, 6, 7
+
+    .include "mapper_banked_calls.s"
@@ -0,0 +1,126 @@
+;
+; NMI tasks and lag frame detection
+;
+; Tasks with a VBlank time run in the NMI handler right after the transfer
+; buffer, their time is taken off the budget of the buffer so the handler
+; still finishes inside VBlank. Tasks without one run after the timed part,
+; on lag frames as well. The table lives in crt0.s, which runs the tasks.
+;
+    .module NMITasks
+
+    .include "global.s"
+
+    ;; The longest stripe of the transfer buffer must still fit after the tasks
+    NMI_TASK_MIN_VRAM_X8    = 6 + 32 + 1
+
+    .area   OSEG (PAG, OVR)
+    _nmi_task_add_PARM_2::  .ds 1
+    .task:                  .ds 2
+    .budget:                .ds 1
+
+    .area _HOME
+
+.macro NMI_TASKS_LOCK
+    sec
+    ror *.crt0_nmi_tasks_lock
+.endm
+
+.macro NMI_TASKS_UNLOCK
+    clc
+    ror *.crt0_nmi_tasks_lock
+.endm
+
+; uint8_t nmi_task_add(nmi_task_t task, uint8_t cycles_x8)
+; XA: task, _nmi_task_add_PARM_2: VBlank time in 8-cycles
+_nmi_task_add::
+    sta *.task
+    stx *.task+1
+    lda *.crt0_nmi_task_count
+    cmp #NMI_TASK_MAX
+    bcs 2$
+    lda *_nmi_task_add_PARM_2
+    beq 1$
+    lda *.crt0_vram_budget_x8
+    sec
+    sbc *_nmi_task_add_PARM_2
+    bcc 2$
+    cmp #NMI_TASK_MIN_VRAM_X8
+    bcc 2$
+    sta *.budget
+    ; Right after an NMI the transfer buffer is empty, and can start
+    ; out with the smaller budget
+    jsr .wait_vbl_done
+    lda *.budget
+    sta *.crt0_vram_budget_x8
+    sta *__vram_transfer_buffer_num_cycles_x8
+1$:
+    NMI_TASKS_LOCK
+    ldx *.crt0_nmi_task_count
+    lda *.task
+    sta .crt0_nmi_task_lo,x
+    lda *.task+1
+    sta .crt0_nmi_task_hi,x
+    lda *_nmi_task_add_PARM_2
+    sta .crt0_nmi_task_cost,x
+    inc *.crt0_nmi_task_count
+    NMI_TASKS_UNLOCK
+    lda #1
+    rts
+2$:
+    lda #0
+    rts
+
+; void nmi_task_remove(nmi_task_t task)
+; XA: task
+_nmi_task_remove::
+    sta *.task
+    stx *.task+1
+    ldx #0
+1$:
+    cpx *.crt0_nmi_task_count
+    bcs 4$
+    lda .crt0_nmi_task_lo,x
+    cmp *.task
+    bne 2$
+    lda .crt0_nmi_task_hi,x
+    cmp *.task+1
+    beq 3$
+2$:
+    inx
+    bne 1$
+3$:
+    NMI_TASKS_LOCK
+    ; Give its VBlank time back to the transfer buffer, from the next NMI on
+    lda *.crt0_vram_budget_x8
+    clc
+    adc .crt0_nmi_task_cost,x
+    sta *.crt0_vram_budget_x8
+    ; Move the tasks after it down
+5$:
+    inx
+    cpx *.crt0_nmi_task_count
+    bcs 6$
+    lda .crt0_nmi_task_lo,x
+    sta .crt0_nmi_task_lo-1,x
+    lda .crt0_nmi_task_hi,x
+    sta .crt0_nmi_task_hi-1,x
+    lda .crt0_nmi_task_cost,x
+    sta .crt0_nmi_task_cost-1,x
+    jmp 5$
+6$:
+    dec *.crt0_nmi_task_count
+    NMI_TASKS_UNLOCK
+4$:
+    rts
+
+; void lag_frame_detect_enable(void)
+_lag_frame_detect_enable::
+    sec
+    ror *.crt0_lag_check
+    rts
+
+; void lag_frame_detect_disable(void)
+_lag_frame_detect_disable::
+    clc
+    ror *.crt0_lag_check
+    rts
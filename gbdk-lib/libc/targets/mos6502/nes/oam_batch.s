@@ -0,0 +1,62 @@
+    .include    "global.s"
+
+    .title  "Sprites"
+    .module OAMBatch
+
+    .area	OSEG (PAG, OVR)
+    _move_sprites_PARM_3::              .ds 2
+    _shadow_oam_write_block_PARM_3::    .ds 2
+
+    .area   _HOME
+
+; void move_sprites(uint8_t first, uint8_t count, const uint8_t * xy)
+; A: first, X: count
+; xy: the x and y of each sprite
+_move_sprites::
+    stx *.tmp
+    cpx #0
+    beq 2$
+    asl
+    asl
+    tax
+    ldy #0
+1$:
+    lda [*_move_sprites_PARM_3],y
+    sta _shadow_OAM+OAM_POS_X,x
+    iny
+    lda [*_move_sprites_PARM_3],y
+    sta _shadow_OAM+OAM_POS_Y,x
+    iny
+    inx
+    inx
+    inx
+    inx
+    dec *.tmp
+    bne 1$
+2$:
+    rts
+
+; void shadow_oam_write_block(uint8_t first, uint8_t count, const OAM_item_t * src)
+; A: first, X: count
+_shadow_oam_write_block::
+    cpx #0
+    beq 2$
+    pha
+    txa
+    asl
+    asl
+    sta *.tmp
+    pla
+    asl
+    asl
+    tax
+    ldy #0
+1$:
+    lda [*_shadow_oam_write_block_PARM_3],y
+    sta _shadow_OAM,x
+    inx
+    iny
+    cpy *.tmp
+    bne 1$
+2$:
+    rts
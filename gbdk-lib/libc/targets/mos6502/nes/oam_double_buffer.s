@@ -0,0 +1,61 @@
+;
+; Shadow OAM double buffering
+;
+; The metasprite and sprite functions always write shadow_OAM at $200, so
+; that stays the render buffer. A swap copies it into the second buffer,
+; which then gets used for the OAM DMA in the NMI handler. The DMA is turned
+; off during the copy: the PPU keeps showing the sprites from the last DMA
+; when one is skipped, so a half copied buffer is never shown.
+;
+    .module OAMDoubleBuffer
+
+    .include "global.s"
+
+    .area _ZP (PAG)
+.oam_double_buffer_ptr:     .ds 2   ; Second buffer, MSB is 0 when disabled
+
+    .area _HOME
+
+; void oam_double_buffer_enable(void * buffer)
+; XA: buffer, 256-byte aligned
+_oam_double_buffer_enable::
+    stx *.oam_double_buffer_ptr+1
+    lda #0
+    sta *.oam_double_buffer_ptr
+
+; void oam_double_buffer_swap(void)
+_oam_double_buffer_swap::
+    lda *.oam_double_buffer_ptr+1
+    beq 2$
+    lda #0
+    sta *__shadow_OAM_base
+    tay
+1$:
+    lda _shadow_OAM,y
+    sta [*.oam_double_buffer_ptr],y
+    iny
+    bne 1$
+    lda *.oam_double_buffer_ptr+1
+    sta *__shadow_OAM_base
+2$:
+    rts
+
+; void oam_double_buffer_disable(void)
+; Keeps the sprites which are on screen
+_oam_double_buffer_disable::
+    lda *.oam_double_buffer_ptr+1
+    beq 2$
+    lda *__shadow_OAM_base
+    beq 2$
+    ldy #0
+1$:
+    lda [*.oam_double_buffer_ptr],y
+    sta _shadow_OAM,y
+    iny
+    bne 1$
+    lda #>_shadow_OAM
+    sta *__shadow_OAM_base
+2$:
+    lda #0
+    sta *.oam_double_buffer_ptr+1
+    rts
@@ -0,0 +1,105 @@
+;
+; Sprite 0 hit scroll split
+;
+; The four writes which change the scroll are worked out by
+; sprite0_split_set(), so only loads and stores are left after the hit.
+; $2006 (nametable), $2005 (Y), $2005 (X) only change the temporary
+; address, the last $2006 write copies it into the PPU address at once.
+;
+    .module ScrollSplit
+
+    .include "global.s"
+
+    .globl _sys_time
+
+    S0_WAIT_CLEAR   = 0     ; Hit flag still set from the last frame
+    S0_WAIT_HIT     = 1
+    S0_DONE         = 2
+
+    .area _ZP (PAG)
+.s0_addr_hi:        .ds 1   ; First $2006 write
+.s0_y:              .ds 1
+.s0_x:              .ds 1
+.s0_addr_lo:        .ds 1   ; Second $2006 write
+.s0_frame:          .ds 1   ; Low byte of _sys_time the state is for
+.s0_state:          .ds 1
+
+    .area _HOME
+
+; void sprite0_split_set(uint8_t x, uint8_t y)
+; A: x, X: y
+_sprite0_split_set::
+    sta *.s0_x
+    stx *.s0_y
+    ; ((y & 0xF8) << 2) | (x >> 3), the low byte of the address
+    lsr
+    lsr
+    lsr
+    sta *.s0_addr_lo
+    txa
+    and #0x38
+    asl
+    asl
+    ora *.s0_addr_lo
+    sta *.s0_addr_lo
+    ; Nametable bits
+    lda *_shadow_PPUCTRL
+    and #0x03
+    asl
+    asl
+    sta *.s0_addr_hi
+    rts
+
+; void sprite0_split_wait(void)
+_sprite0_split_wait::
+    ; The hit of the last frame is cleared at the end of VBlank
+1$:
+    bit PPUSTATUS
+    bvs 1$
+2$:
+    bit PPUSTATUS
+    bvc 2$
+    ; (reading PPUSTATUS also reset the write toggle)
+
+.s0_apply:
+    lda *.s0_addr_hi
+    sta PPUADDR
+    lda *.s0_y
+    sta PPUSCROLL
+    lda *.s0_x
+    sta PPUSCROLL
+    lda *.s0_addr_lo
+    sta PPUADDR
+    rts
+
+; uint8_t sprite0_split_poll(void)
+_sprite0_split_poll::
+    lda *_sys_time
+    cmp *.s0_frame
+    beq 1$
+    ; New frame
+    sta *.s0_frame
+    lda #S0_WAIT_CLEAR
+    sta *.s0_state
+1$:
+    ldx *.s0_state
+    cpx #S0_DONE
+    beq 4$
+    bit PPUSTATUS
+    bvs 2$
+    ; Not hit, and any earlier hit is gone
+    lda #S0_WAIT_HIT
+    sta *.s0_state
+    bne 3$
+2$:
+    cpx #S0_WAIT_HIT
+    bne 3$
+    jsr .s0_apply
+    lda #S0_DONE
+    sta *.s0_state
+4$:
+    lda #1
+    rts
+3$:
+    lda #0
+    rts
@@ -0,0 +1,138 @@
+;
+; MMC3 scanline IRQ scroll splits, for lcc -mapper=mmc3
+;
+; The NMI hook takes over the table of the next frame and loads the
+; scanline counter with the line of its first entry. The counter is
+; reloaded on the pre-render line, so a latch of N fires at the end of
+; line N - 1. The IRQ handler writes the scroll of the entry, which
+; shows from the next line on, then reloads the counter with the
+; distance to the next entry minus one, since the reload uses up the
+; clock of the line the handler runs in.
+;
+    .module ScrollSplitMMC3
+
+    .include "global.s"
+
+    MMC3_IRQ_LATCH      = 0xC000
+    MMC3_IRQ_RELOAD     = 0xC001
+    MMC3_IRQ_DISABLE    = 0xE000
+    MMC3_IRQ_ENABLE     = 0xE001
+    APU_FRAME_COUNTER   = 0x4017
+    APU_FRAME_IRQ_OFF   = 0x40
+    SCROLL_SPLIT_END    = 0xFF
+
+    .area _ZP (PAG)
+.mmc3s_table:       .ds 2   ; Table of the current frame, MSB is 0 for none
+.mmc3s_next:        .ds 2   ; Table from the next frame on
+.mmc3s_pos:         .ds 1   ; Offset of the next entry
+.mmc3s_line:        .ds 1
+.mmc3s_x:           .ds 1
+.mmc3s_addr_lo:     .ds 1
+
+    .area _HOME
+
+; void mmc3_split_set_table(const scroll_split_t * table)
+; XA: table
+_mmc3_split_set_table::
+    sta *.mmc3s_next
+    stx *.mmc3s_next+1
+    lda *.crt0_nmi_hook
+    cmp #<.mmc3s_nmi
+    bne 1$
+    lda *.crt0_nmi_hook+1
+    cmp #>.mmc3s_nmi
+    beq 2$
+1$:
+    ; Install the handlers right after an NMI, so the next one
+    ; doesn't see a half written hook
+    jsr .wait_vbl_done
+    lda #<.mmc3s_irq
+    sta *.crt0_irq_vector
+    lda #>.mmc3s_irq
+    sta *.crt0_irq_vector+1
+    lda #<.mmc3s_nmi
+    sta *.crt0_nmi_hook
+    lda #>.mmc3s_nmi
+    sta *.crt0_nmi_hook+1
+    lda #APU_FRAME_IRQ_OFF
+    sta APU_FRAME_COUNTER
+    cli
+2$:
+    rts
+
+; Called at the end of the NMI handler
+.mmc3s_nmi:
+    sta MMC3_IRQ_DISABLE
+    lda *.mmc3s_next
+    sta *.mmc3s_table
+    lda *.mmc3s_next+1
+    sta *.mmc3s_table+1
+    beq 1$
+    ldy #0
+    sty *.mmc3s_pos
+    lda [*.mmc3s_table],y
+    cmp #SCROLL_SPLIT_END
+    beq 1$
+    sta MMC3_IRQ_LATCH
+    sta MMC3_IRQ_RELOAD
+    sta MMC3_IRQ_ENABLE
+1$:
+    rts
+
+.mmc3s_irq:
+    pha
+    txa
+    pha
+    tya
+    pha
+    ; Acknowledge, and reset the PPU write toggle
+    sta MMC3_IRQ_DISABLE
+    lda PPUSTATUS
+    ldy *.mmc3s_pos
+    lda [*.mmc3s_table],y
+    sta *.mmc3s_line
+    iny
+    lda [*.mmc3s_table],y
+    sta *.mmc3s_x
+    iny
+    lda [*.mmc3s_table],y
+    tax
+    ; ((y & 0xF8) << 2) | (x >> 3), the low byte of the address
+    and #0x38
+    asl
+    asl
+    sta *.mmc3s_addr_lo
+    lda *.mmc3s_x
+    lsr
+    lsr
+    lsr
+    ora *.mmc3s_addr_lo
+    sta *.mmc3s_addr_lo
+    lda *_shadow_PPUCTRL
+    and #0x03
+    asl
+    asl
+    sta PPUADDR
+    stx PPUSCROLL
+    lda *.mmc3s_x
+    sta PPUSCROLL
+    lda *.mmc3s_addr_lo
+    sta PPUADDR
+    ; Next entry
+    iny
+    sty *.mmc3s_pos
+    lda [*.mmc3s_table],y
+    cmp #SCROLL_SPLIT_END
+    beq 1$
+    clc                         ; next - line - 1
+    sbc *.mmc3s_line
+    sta MMC3_IRQ_LATCH
+    sta MMC3_IRQ_RELOAD
+    sta MMC3_IRQ_ENABLE
+1$:
+    pla
+    tay
+    pla
+    tax
+    pla
+    rti
@@ -14,7 +14,6 @@
     .attribute_y_odd:                       .ds 1
     .attribute_num_columns_odd:             .ds 1
     .attribute_num_rows_odd:                .ds 1
-    .row_dirty_mask:                        .ds 1
 
     .area   _HOME
 
@@ -510,107 +509,50 @@ unaligned_xy_column_loop:
 1$:
     jmp _flush_shadow_attributes
 
+;
+; Marks the bytes of _attribute_shadow covered by the update as dirty:
+; columns xpos to (2*xpos + x_odd + width - 1) / 2, and the same for rows
+;
 .attribute_set_dirty:
-    ; A = min(7, .num_rows + .attribute_num_rows_odd) << 3
-    lda *.attribute_num_rows_odd
+    lda *.attribute_x_odd
     cmp #0x80
-    lda *.num_rows
-    adc #0
-    cmp #7
+    lda *.xpos
+    rol
+    clc
+    adc *.width
+    sec
+    sbc #1
+    lsr
+    cmp #ATTRIBUTE_PACKED_WIDTH
     bcc 1$
-    lda #7
+    lda #ATTRIBUTE_PACKED_WIDTH-1
 1$:
-    sta *.tmp
-    ; X = A | ypos
+    ; Y = number of columns
+    sec
+    sbc *.xpos
+    tay
+    iny
+    lda *.xpos
+    jsr .attribute_column_mask
+    pha
+    lda *.attribute_y_odd
+    cmp #0x80
     lda *.ypos
-    asl
-    asl
-    asl
-    ora *.tmp
-    tax
-    lda .row_dirty_table,x
-    sta *_attribute_row_dirty
-    rts
-
-;
-; Provides a quick table lookup to set _attribute_row_dirty based on num_rows / ypos
-;
-; Indexing: 00YYYNNN
-;
-; Where:
-;   Y = Starting byte row in attribute table
-;   N = Number of byte rows in attribute table -1 (including additional row if needed)
-;
-.row_dirty_table:
-; Y = 0
-.db 0b00000001
-.db 0b00000011
-.db 0b00000111
-.db 0b00001111
-.db 0b00011111
-.db 0b00111111
-.db 0b01111111
-.db 0b11111111
-; Y = 1
-.db 0b00000010
-.db 0b00000110
-.db 0b00001110
-.db 0b00011110
-.db 0b00111110
-.db 0b01111110
-.db 0b11111110
-.db 0b11111110
-; Y = 2
-.db 0b00000100
-.db 0b00001100
-.db 0b00011100
-.db 0b00111100
-.db 0b01111100
-.db 0b11111100
-.db 0b11111100
-.db 0b11111100
-; Y = 3
-.db 0b00001000
-.db 0b00011000
-.db 0b00111000
-.db 0b01111000
-.db 0b11111000
-.db 0b11111000
-.db 0b11111000
-.db 0b11111000
-; Y = 4
-.db 0b00010000
-.db 0b00110000
-.db 0b01110000
-.db 0b11110000
-.db 0b11110000
-.db 0b11110000
-.db 0b11110000
-.db 0b11110000
-; Y = 5
-.db 0b00100000
-.db 0b01100000
-.db 0b11100000
-.db 0b11100000
-.db 0b11100000
-.db 0b11100000
-.db 0b11100000
-.db 0b11100000
-; Y = 6
-.db 0b01000000
-.db 0b11000000
-.db 0b11000000
-.db 0b11000000
-.db 0b11000000
-.db 0b11000000
-.db 0b11000000
-.db 0b11000000
-; Y = 7
-.db 0b10000000
-.db 0b10000000
-.db 0b10000000
-.db 0b10000000
-.db 0b10000000
-.db 0b10000000
-.db 0b10000000
-.db 0b10000000
+    rol
+    clc
+    adc *.height
+    sec
+    sbc #1
+    lsr
+    cmp #ATTRIBUTE_PACKED_HEIGHT
+    bcc 2$
+    lda #ATTRIBUTE_PACKED_HEIGHT-1
+2$:
+    ; Y = number of rows
+    sec
+    sbc *.ypos
+    tay
+    iny
+    ldx *.ypos
+    pla
+    jmp .attribute_mark_dirty
@@ -6,6 +6,9 @@
 
     .area   _HOME
 
+; Register entry for assembly callers: A = x, X = y, Y = tile
+.set_bkg_tile_xy::
+    sty *_set_bkg_tile_xy_PARM_3
 _set_bkg_tile_xy::
     ; XA = (PPU_NT0) | (X << 5) | A
     ; (A = x_pos, X = y_pos)
@@ -128,11 +128,22 @@ _set_bkg_submap_attributes_horizontalStripes:
     lda *.height
     sta *.num_rows
 _set_bkg_submap_attributes_horizontalStripes_rowLoop:
-    ;
-    ldy *.ypos
-    lda .bitmask_table,y
-    ora *_attribute_row_dirty
-    sta *_attribute_row_dirty
+    ; Mark the (width + x_odd + 1) / 2 bytes of this row that get written as dirty
+    lda *.x_odd
+    cmp #0x80
+    lda *.width
+    adc #1
+    lsr
+    cmp #ATTRIBUTE_PACKED_WIDTH+1
+    bcc 1$
+    lda #ATTRIBUTE_PACKED_WIDTH
+1$:
+    tay
+    lda *.xpos
+    jsr .attribute_column_mask
+    ldx *.ypos
+    ldy #1
+    jsr .attribute_mark_dirty
     ;
     jsr .process_row
     jsr .inc_row
@@ -146,11 +157,25 @@ _set_bkg_submap_attributes_verticalStripes:
     sta *.num_columns
     ldy #0
 _set_bkg_submap_attributes_verticalStripes_columnLoop:
-    ;
+    ; Mark the (height + y_odd + 1) / 2 bytes of this column that get written as dirty
+    tya
+    pha
+    lda *.y_odd
+    cmp #0x80
+    lda *.height
+    adc #1
+    lsr
+    cmp #ATTRIBUTE_PACKED_HEIGHT+1
+    bcc 1$
+    lda #ATTRIBUTE_PACKED_HEIGHT
+1$:
+    tay
     ldx *.xpos
     lda .bitmask_table,x
-    ora *_attribute_column_dirty
-    sta *_attribute_column_dirty
+    ldx *.ypos
+    jsr .attribute_mark_dirty
+    pla
+    tay
     ;
     jsr .process_column
     INC_XPOS_WITH_WRAP
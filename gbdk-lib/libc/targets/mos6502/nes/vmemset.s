@@ -0,0 +1,56 @@
+    .include    "global.s"
+
+    .area   OSEG (PAG, OVR)
+    _vmemset_PARM_2::           .ds 1
+    _vmemset_PARM_3::           .ds 2
+    .vmemset_addr:              .ds 2
+
+    .area   _HOME
+
+;
+; void vmemset (void *s, uint8_t c, size_t n)
+;
+; Written as fill stripes of up to VRAM_MAX_FILL_BYTES bytes, which take the
+; same space in the vram transfer buffer whatever their length
+;
+_vmemset::
+    .define .c  "_vmemset_PARM_2"
+    .define .n  "_vmemset_PARM_3"
+    sta *.vmemset_addr
+    stx *.vmemset_addr+1
+1$:
+    ; count = min(n, VRAM_MAX_FILL_BYTES)
+    lda *.n+1
+    bne 2$
+    lda *.n
+    beq 4$
+    cmp #VRAM_MAX_FILL_BYTES+1
+    bcc 3$
+2$:
+    lda #VRAM_MAX_FILL_BYTES
+3$:
+    sta *__vram_transfer_buffer_fill_count
+    ; n -= count
+    eor #0xFF
+    sec
+    adc *.n
+    sta *.n
+    lda *.n+1
+    sbc #0
+    sta *.n+1
+    ;
+    lda *.vmemset_addr
+    ldx *.vmemset_addr+1
+    ldy *.c
+    clc
+    jsr .ppu_stripe_fill
+    ; addr += count
+    lda *.vmemset_addr
+    clc
+    adc *__vram_transfer_buffer_fill_count
+    sta *.vmemset_addr
+    bcc 1$
+    inc *.vmemset_addr+1
+    jmp 1$
+4$:
+    rts
@@ -9,19 +9,26 @@
 ;
 ; Format of transfer buffer
 ;
-; 0: Data length
+; 0: Data length (0x80 | length for a fill stripe)
 ; 1: 4 if inc-by-32, 0 if inc-by-1
 ; 2: PPUADDR_HI
 ; 3: PPUADDR_LO
-; 4: ...N data bytes...
+; 4: ...N data bytes... (a single byte written N times for a fill stripe)
+;
+; The NMI handler spends 6 + N 8-cycles on a stripe, and 9 + (N+1)/2 on a fill stripe.
 ;
 VRAM_HDR_SIZEOF         = 4
 VRAM_HDR_LENGTH         = 0
 VRAM_HDR_DIRECTION      = 1
 VRAM_HDR_PPUHI          = 2
 VRAM_HDR_PPULO          = 3
-VRAM_MAX_BYTES          = 32
-VRAM_MAX_STRIPE_SIZE    = VRAM_HDR_SIZEOF + VRAM_MAX_BYTES
+VRAM_HDR_FILL           = 0x80
+VRAM_MAX_BYTES          = 64
+VRAM_MAX_BEGIN_BYTES    = 32
+VRAM_MAX_STRIPE_SIZE    = VRAM_HDR_SIZEOF + VRAM_MAX_BEGIN_BYTES
+VRAM_MAX_STRIPE_COST    = 6 + VRAM_MAX_BEGIN_BYTES
+VRAM_FILL_STRIPE_SIZE   = VRAM_HDR_SIZEOF + 1
+VRAM_MAX_FILL_COST      = 9 + (VRAM_MAX_FILL_BYTES+1)/2
 
 ;
 ; Locks the VRAM buffer for writing, causing the vblank handler to ignore it.
@@ -39,6 +46,15 @@ VRAM_MAX_STRIPE_SIZE    = VRAM_HDR_SIZEOF + VRAM_MAX_BYTES
     ror *__vram_transfer_buffer_valid
 .endm
 
+;
+; Marks the frame as complete while waiting for the vblank handler to make room,
+; so the buffer is flushed even when lag frames are detected.
+;
+.macro VRAM_BUFFER_WAIT
+    sec
+    ror *.crt0_frame_ready
+.endm
+
 .area   OSEG (PAG, OVR)
 _set_vram_byte_PARM_3:: .ds 1
     
@@ -48,6 +64,8 @@ __vram_transfer_buffer_num_cycles_x8::  .ds 1
 __vram_transfer_buffer_pos_w::          .ds 1
 __vram_transfer_buffer_pos_old::        .ds 1
 __vram_transfer_buffer_temp::           .ds 1
+__vram_transfer_buffer_addr::           .ds 2
+__vram_transfer_buffer_fill_count::     .ds 1
 
 .area   _HOME
 
@@ -68,6 +86,10 @@ __vram_transfer_buffer_temp::           .ds 1
 ;
 ; Begin a stripe (carry indicates vertical stripe)
 ;
+; At most VRAM_MAX_BEGIN_BYTES bytes may be written before .ppu_stripe_end.
+; A horizontal stripe which starts where the last one in the buffer ended
+; continues that one instead, making stripes of up to VRAM_MAX_BYTES bytes.
+;
 .ppu_stripe_begin::
     bit *.crt0_forced_blanking
     bpl 1$
@@ -79,38 +101,79 @@ __vram_transfer_buffer_temp::           .ds 1
     rol
     asl
     asl
-    lda *_shadow_PPUCTRL
+    ora *_shadow_PPUCTRL
     sta PPUCTRL
     rts
 1$:
 .ppu_stripe_begin_indirect:
     ; Indirect write via transfer buffer
     sty *__vram_transfer_buffer_temp
-    pha
-    txa
-    pha
+    sta *__vram_transfer_buffer_addr
+    stx *__vram_transfer_buffer_addr+1
     lda #0
     rol
     asl
     asl
     pha
-    ; Ensure there's at least VRAM_MAX_STRIPE_SIZE bytes remaining to write before progressing
+    ; Ensure there's at least VRAM_MAX_STRIPE_SIZE bytes remaining to write, and time left in
+    ; the NMI handler to copy them, before progressing
     ; This conservative limit simplifies conditions for rest of stripe in order to write single bytes with no checks
 2$:
     lda *__vram_transfer_buffer_pos_w
     cmp #128-VRAM_MAX_STRIPE_SIZE
-    bcs 2$
-    ; Lock buffer and store current write pointer for later
+    bcs 4$
+    lda *__vram_transfer_buffer_num_cycles_x8
+    cmp #VRAM_MAX_STRIPE_COST+1
+    bcs 5$
+4$:
+    VRAM_BUFFER_WAIT
+    jmp 2$
+5$:
+    ; Lock buffer
     VRAM_BUFFER_LOCK
+    ; Vertical stripes and an empty buffer always need a new stripe
+    pla
+    bne .ppu_stripe_begin_new
+    ldy *__vram_transfer_buffer_pos_w
+    beq .ppu_stripe_begin_new
+    ; Last stripe must be horizontal, not a fill, and short enough to take VRAM_MAX_BEGIN_BYTES more
+    ldy *__vram_transfer_buffer_pos_old
+    lda __vram_transfer_buffer+VRAM_HDR_DIRECTION,y
+    bne 3$
+    lda __vram_transfer_buffer+VRAM_HDR_LENGTH,y
+    cmp #VRAM_MAX_BYTES-VRAM_MAX_BEGIN_BYTES+1
+    bcs 3$
+    ; ...and end at the new address
+    clc
+    adc __vram_transfer_buffer+VRAM_HDR_PPULO,y
+    tax
+    lda #0
+    adc __vram_transfer_buffer+VRAM_HDR_PPUHI,y
+    cmp *__vram_transfer_buffer_addr+1
+    bne 3$
+    cpx *__vram_transfer_buffer_addr
+    bne 3$
+    ; Continue it. .ppu_stripe_end subtracts the whole length from the
+    ; time left, so add back the time for the bytes already counted
+    lda __vram_transfer_buffer+VRAM_HDR_LENGTH,y
+    clc
+    adc *__vram_transfer_buffer_num_cycles_x8
+    sta *__vram_transfer_buffer_num_cycles_x8
+    ldx *__vram_transfer_buffer_addr+1
+    ldy *__vram_transfer_buffer_temp
+    rts
+3$:
+    lda #0
+.ppu_stripe_begin_new:
+    ; Store current write pointer for later
     ldy *__vram_transfer_buffer_pos_w
     sty *__vram_transfer_buffer_pos_old
     ; Write direction
-    pla
     sta __vram_transfer_buffer+VRAM_HDR_DIRECTION,y
     ; Write address
-    pla
+    lda *__vram_transfer_buffer_addr+1
     sta __vram_transfer_buffer+VRAM_HDR_PPUHI,y
-    pla
+    lda *__vram_transfer_buffer_addr
     sta __vram_transfer_buffer+VRAM_HDR_PPULO,y
     tya
     clc
@@ -120,6 +183,7 @@ __vram_transfer_buffer_temp::           .ds 1
     lda *__vram_transfer_buffer_num_cycles_x8
     sbc #5
     sta *__vram_transfer_buffer_num_cycles_x8
+    ldx *__vram_transfer_buffer_addr+1
     ldy *__vram_transfer_buffer_temp
     rts
 
@@ -169,6 +233,114 @@ __vram_transfer_buffer_temp::           .ds 1
     ldy *__vram_transfer_buffer_temp
     rts
 
+;
+; Writes a fill stripe: the byte in Y repeated __vram_transfer_buffer_fill_count
+; (1 - VRAM_MAX_FILL_BYTES) times from PPU address XA (be it direct or via transfer buffer)
+; Carry indicates vertical stripe. Preserves Y.
+;
+; Whatever the count, a fill stripe only takes VRAM_FILL_STRIPE_SIZE bytes of the
+; transfer buffer and half the NMI time per byte of a regular stripe.
+;
+.ppu_stripe_fill::
+    bit *.crt0_forced_blanking
+    bpl .ppu_stripe_fill_indirect
+    ; Direct write
+    stx PPUADDR
+    sta PPUADDR
+    lda #0
+    rol
+    asl
+    asl
+    ora *_shadow_PPUCTRL
+    sta PPUCTRL
+    ldx *__vram_transfer_buffer_fill_count
+1$:
+    sty PPUDATA
+    dex
+    bne 1$
+    rts
+
+.ppu_stripe_fill_indirect:
+    sty *__vram_transfer_buffer_temp
+    sta *__vram_transfer_buffer_addr
+    stx *__vram_transfer_buffer_addr+1
+    lda #0
+    rol
+    asl
+    asl
+    tax
+    ; Wait for space for the stripe and its terminator, and time left to write it
+1$:
+    lda *__vram_transfer_buffer_pos_w
+    cmp #128-(VRAM_FILL_STRIPE_SIZE+1)
+    bcs 2$
+    lda *__vram_transfer_buffer_num_cycles_x8
+    cmp #VRAM_MAX_FILL_COST+1
+    bcs 3$
+2$:
+    VRAM_BUFFER_WAIT
+    jmp 1$
+3$:
+    VRAM_BUFFER_LOCK
+    ldy *__vram_transfer_buffer_pos_w
+    sty *__vram_transfer_buffer_pos_old
+    ; Write length, direction, address and fill byte
+    lda *__vram_transfer_buffer_fill_count
+    ora #VRAM_HDR_FILL
+    sta __vram_transfer_buffer+VRAM_HDR_LENGTH,y
+    txa
+    sta __vram_transfer_buffer+VRAM_HDR_DIRECTION,y
+    lda *__vram_transfer_buffer_addr+1
+    sta __vram_transfer_buffer+VRAM_HDR_PPUHI,y
+    lda *__vram_transfer_buffer_addr
+    sta __vram_transfer_buffer+VRAM_HDR_PPULO,y
+    lda *__vram_transfer_buffer_temp
+    sta __vram_transfer_buffer+VRAM_HDR_SIZEOF,y
+    ; Write terminator byte
+    lda #0
+    sta __vram_transfer_buffer+VRAM_FILL_STRIPE_SIZE,y
+    tya
+    clc
+    adc #VRAM_FILL_STRIPE_SIZE
+    sta *__vram_transfer_buffer_pos_w
+    ; __vram_transfer_buffer_num_cycles_x8 -= 9 + (count+1)/2
+    lda *__vram_transfer_buffer_fill_count
+    lsr
+    adc #9
+    eor #0xFF
+    sec
+    adc *__vram_transfer_buffer_num_cycles_x8
+    sta *__vram_transfer_buffer_num_cycles_x8
+    VRAM_BUFFER_UNLOCK
+    ldy *__vram_transfer_buffer_temp
+    rts
+
+;
+; uint8_t get_vram_transfer_budget(void)
+;
+; Returns roughly how many 8-cycles of stripes can still be added for the next NMI,
+; limited by the time left and by the space left in the buffer.
+;
+_get_vram_transfer_budget::
+    lda *__vram_transfer_buffer_pos_w
+    bmi 2$
+    ; Space left counts as 2 more than the free bytes, as a stripe of N bytes
+    ; takes N + 4 bytes of buffer but N + 6 8-cycles
+    lda #128+2
+    sec
+    sbc *__vram_transfer_buffer_pos_w
+    cmp *__vram_transfer_buffer_num_cycles_x8
+    bcc 1$
+    ; One 8-cycle is always kept back for the NMI delay loop
+    lda *__vram_transfer_buffer_num_cycles_x8
+    sec
+    sbc #1
+1$:
+    rts
+2$:
+    lda #0
+    rts
+
 ;
 ; Appends a single byte to the last finished stripe when possible, temporarily re-opening it.
 ;
@@ -185,6 +357,9 @@ __vram_transfer_buffer_temp::           .ds 1
 ; This simplification is there to avoid doing exhaustive and slow 16-bit comparisons.
 ; This means a vertical stripe which is automatically appended to by this code can be no longer than 8 bytes.
 ;
+; Register entry for assembly callers: XA = PPU address, Y = value
+.set_vram_byte::
+    sty *_set_vram_byte_PARM_3
 _set_vram_byte::
 .ppu_stripe_append::
     .define ppu_addr ".tmp"
@@ -199,11 +374,12 @@ _set_vram_byte::
     rts
 
 .ppu_stripe_wait_for_flush:
-    ; Unlock and wait for flush by NMI handler
+    ; Unlock and wait for flush by NMI handler, which empties the buffer
     VRAM_BUFFER_UNLOCK
+    VRAM_BUFFER_WAIT
 1$:
     ldx *__vram_transfer_buffer_pos_w
-    bmi 1$
+    bne 1$
     ; Re-lock buffer and jump straight to new-stripe code
     VRAM_BUFFER_LOCK
     jmp .ppu_stripe_append_failed
@@ -214,7 +390,10 @@ _set_vram_byte::
     stx *ppu_addr+1
     ; Lock buffer first, to make sure our checks don't get invalidated by NMI
     VRAM_BUFFER_LOCK
-    ; Now that buffer is safely locked, first check if it's almost full
+    ; Now that buffer is safely locked, first check if it's almost full or out of time for a new stripe
+    lda *__vram_transfer_buffer_num_cycles_x8
+    cmp #7+1
+    bcc .ppu_stripe_wait_for_flush
     ldx *__vram_transfer_buffer_pos_w
     bmi .ppu_stripe_wait_for_flush
     ; check that it's not empty
@@ -225,6 +404,8 @@ _set_vram_byte::
     cmp *ppu_addr+1
     bne .ppu_stripe_append_failed
     lda __vram_transfer_buffer+VRAM_HDR_LENGTH,x
+    ; Fill stripes can't be appended to
+    bmi .ppu_stripe_append_failed
     cmp #VRAM_MAX_BYTES
     beq .ppu_stripe_append_failed
     ; if last stripe only contains a single byte, branch to go-either-direction routine
@@ -0,0 +1,22 @@
+#include <stdint.h>
+#include <nes/nes.h>
+#include <gbdk/timer.h>
+
+/* Cycle timestamp, see gbdk/timer.h
+
+   The PPU has no readable scanline counter, so this only counts whole
+   frames of 29780.5 cycles. The NMI can come in between the two bytes
+   of sys_time, so it is read until it holds still */
+
+#define FRAME_CYCLES 29781u
+
+uint32_t timer_now_cycles(void)
+{
+    uint16_t frames;
+
+    do {
+        frames = sys_time;
+    } while (frames != sys_time);
+
+    return (uint32_t)frames * FRAME_CYCLES;
+}
@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include <string.h>
+#include <gbdk/platform.h>
+#include <gbdk/perf.h>
+
+/* Frame time counters, see gbdk/perf.h */
+
+perf_counters_t perf;
+
+static uint16_t perf_last_time;
+
+void perf_reset(void)
+{
+    memset(&perf, 0, sizeof(perf));
+    CRITICAL {
+        perf_last_time = sys_time;
+    }
+}
+
+void perf_vsync(void)
+{
+    uint8_t line = PERF_LINE();
+    uint16_t missed;
+
+    CRITICAL {
+        missed = sys_time - perf_last_time;
+    }
+
+    perf.frames++;
+    perf.vsync_line = line;
+    if (missed) {
+        perf.dropped += missed;
+    } else if (line > perf.vsync_line_max) {
+        perf.vsync_line_max = line;
+    }
+
+    vsync();
+
+    /* Returns right after the VBlank handlers, unless the display is off */
+    perf_last_time = sys_time;
+    line = PERF_LINE();
+    if (line >= PERF_VBLANK_LINE) {
+        line -= PERF_VBLANK_LINE;
+        perf.vbl_lines = line;
+        if (line > perf.vbl_lines_max) perf.vbl_lines_max = line;
+    }
+}
@@ -0,0 +1,37 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gbdk/anim.h>
+
+/* Animation frame changes, see gbdk/anim.h
+
+   Frame layout: number of runs, tiles per slot, bytes per slot, then the
+   first slot, the number of slots and the tile data of each run */
+
+void anim_apply_frame(const uint8_t * frame, uint8_t base_tile)
+{
+    uint8_t runs = *frame++;
+    uint8_t tiles = *frame++;
+    uint8_t size = *frame++;
+    uint8_t first, n;
+
+    for (; runs; runs--) {
+        first = *frame++;
+        n = *frame++;
+        set_sprite_data(base_tile + (uint8_t)(first * tiles), (uint8_t)(n * tiles), frame);
+        frame += (uint16_t)n * size;
+    }
+}
+
+void anim_play(animator_t * anim, const anim_seq_t * seq)
+{
+    const anim_frame_t * f = seq->frames;
+
+    anim->frames = f;
+    anim->count = seq->count;
+    anim->flags = seq->flags;
+    anim->index = 0;
+    anim->timer = f->ticks;
+    anim->frame = f->frame;
+    anim->event = f->event;
+    anim->changed = TRUE;
+}
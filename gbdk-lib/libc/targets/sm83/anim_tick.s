@@ -0,0 +1,87 @@
+	.include	"global.s"
+
+	;; Animator layout, see animator_t in gbdk/anim.h
+	.ANIM_EVENT	= 7
+	.ANIM_LOOP_BIT	= 0
+	.ANIM_DONE_BIT	= 7
+
+	.area	_HOME
+
+	;; void anim_tick_all(animator_t * anims, uint8_t count)
+	;; DE = anims, A = count
+_anim_tick_all::
+	OR	A
+	RET	Z
+	LD	B, A
+	LD	H, D
+	LD	L, E
+.anim_tick:
+	LD	A, (HL)		; timer
+	OR	A
+	JR	Z, .anim_idle	; Stopped
+	DEC	A
+	LD	(HL), A
+	JR	Z, .anim_next
+.anim_idle:
+	LD	DE, #.ANIM_EVENT
+	ADD	HL, DE
+	XOR	A
+	LD	(HL+), A	; event
+	LD	(HL+), A	; changed, HL = next animator
+	DEC	B
+	JR	NZ, .anim_tick
+	RET
+
+.anim_next:
+	PUSH	HL		; Animator
+	INC	HL
+	LD	A, (HL+)	; index
+	INC	A
+	CP	(HL)		; count
+	INC	HL		; flags
+	JR	C, 1$
+	BIT	.ANIM_LOOP_BIT, (HL)
+	JR	NZ, 2$
+	SET	.ANIM_DONE_BIT, (HL)	; Played once: stays on its last frame
+	POP	HL
+	JR	.anim_idle
+2$:
+	XOR	A
+1$:
+	LD	C, A		; C = new index
+	INC	HL
+	LD	A, (HL+)
+	LD	E, A
+	LD	A, (HL+)	; HL = frame
+	LD	D, A
+	LD	A, C
+	ADD	A, A
+	ADD	A, C
+	ADD	A, E
+	LD	E, A
+	ADC	A, D
+	SUB	E
+	LD	D, A		; DE = frames + 3 * index
+	LD	A, (DE)		; anim_frame_t.frame
+	INC	DE
+	CP	(HL)		; Z if the frame stays the same
+	LD	(HL+), A	; HL = event
+	LD	A, (DE)		; anim_frame_t.ticks
+	INC	DE
+	PUSH	AF
+	LD	A, (DE)		; anim_frame_t.event
+	LD	(HL+), A	; HL = changed
+	POP	AF
+	LD	(HL), #0
+	JR	Z, 3$
+	INC	(HL)
+3$:
+	INC	HL		; Next animator
+	POP	DE		; Animator
+	LD	(DE), A		; timer
+	INC	DE
+	LD	A, C
+	LD	(DE), A		; index
+	DEC	B
+	JR	NZ, .anim_tick
+	RET
@@ -5,6 +5,7 @@
 	.include	"global.s"
 
 	.globl	_font_ibm
+	.globl	__crash_zones, __crash_zone_pos
 
 	SCRN_X = 160		; Width of screen in pixels
 	SCRN_Y = 144		; Height of screen in pixels
@@ -249,6 +250,70 @@ ___HandleCrash::
 	jr	.writeBank
 .banksDone:
 
+	; Breadcrumbs, once crash_breadcrumbs_init() has set them up
+	ld	a, (___crash_stack_hw)
+	ld	c, a
+	ld	a, (___crash_stack_hw + 1)
+	or	c
+	jr	z, .breadcrumbsDone
+
+	; Last zones entered, newest first
+	ld	hl, #vCrashDumpScreenRow3
+	ld	de, #.zonesStr
+	ld	c, #3
+	rst	#0x30		; .MemcpySmall
+	ldh	a, (__crash_zone_pos)
+	ld	e, a
+	ld	d, #.CRASH_ZONES
+.writeZone:
+	ld	a, e
+	add	a, #<__crash_zones
+	ld	c, a
+	ldh	a, (c)
+	call	.printHexA
+	ld	a, #0x20	; " "
+	ld	(hl+), a
+	ld	a, e
+	or	a
+	jr	nz, 1$
+	ld	a, #.CRASH_ZONES
+1$:	dec	a
+	ld	e, a
+	dec	d
+	jr	nz, .writeZone
+
+	; Dropped VBlanks and stack high water mark
+	ld	hl, #vCrashDumpScreenRow16
+	ld	de, #.dropStr
+	ld	c, #6
+	rst	#0x30		; .MemcpySmall
+	push	de
+	ld	a, (___crash_dropped)
+	ld	e, a
+	ld	a, (___crash_dropped + 1)
+	ld	d, a
+	ld	a, (de)
+	ld	c, a
+	inc	de
+	ld	a, (de)
+	ld	b, a
+	call	.printHexBC
+	pop	de
+	ld	c, #5
+	rst	#0x30		; .MemcpySmall
+	push	hl
+	ld	a, (___crash_stack_hw)
+	ld	l, a
+	ld	a, (___crash_stack_hw + 1)
+	ld	h, a
+	call	.callHL		; BC = stack_high_water()
+	pop	hl
+	call	.printHexBC
+	ld	a, #0x20	; " "
+	ld	(hl+), a
+	ld	(hl+), a
+.breadcrumbsDone:
+
 	; Start displaying
 	ld	a, #(LCDCF_ON | LCDCF_BG9C00 | LCDCF_BGON)
 	ldh	(.LCDC), a
@@ -262,6 +327,9 @@ ___HandleCrash::
 
 	jr	.loop
 
+.callHL:
+	jp	(hl)
+
 .printHexBC:
 	call	.printHexB
 	ld	a, c
@@ -410,6 +478,11 @@ loadfont:
 	.ascii	"W"
 	.db	.SVBK, 0xff
 	.ascii	" "
+.zonesStr:
+	.ascii	" Z:"
+.dropStr:
+	.ascii	" DROP:"
+	.ascii	" STK:"
 
 
 	.area _DATA
@@ -420,6 +493,10 @@ wCrashIE:
 	.ds	1
 wCrashLCDC: 
 	.ds	1
+___crash_dropped::
+	.ds	2		; Counter shown as DROP, set by crash_breadcrumbs_init()
+___crash_stack_hw::
+	.ds	2		; stack_high_water(), 0 until crash_breadcrumbs_init()
 
 
 	.area _CRASH_SCRATCH(ABS)
@@ -12,9 +12,9 @@
 
 ;       .org    0x08            ; --profile handler utilized by emu_debug.h
 
-;       .org    0x10            ; empty
+;       .org    0x10            ; banked call trampoline utilized by lcc -bcall-rst
 
-;       .org    0x18            ; empty
+;       .org    0x18            ; used by the lcc -bcall-rst trampoline as well
 
         .org    0x20            ; RST 0x20 == call HL
 .call_hl::
@@ -276,6 +276,11 @@ _reset::
 
         LDH     (.NR52),A       ; Turn sound off
 
+        LDH     (__joypad_cur),A        ; No buttons down for joypad_update()
+        LDH     (__joypad_pressed),A
+        LDH     (__joypad_released),A
+        LDH     (__joypad_raw),A
+
         INC     A
         LDH     (__current_bank),A      ; current bank is 1 at startup
 
@@ -393,14 +398,23 @@ _add_VBL::
 ;       .area   _CODE_1
         ;; Constant data, used to init _DATA
         .area   _INITIALIZER
+        ;; Code, used to init _CODE_RAM and _CODE_HRAM (moved here by bankpack)
+        .area   _CODE_RAM_LOAD
+        .area   _CODE_HRAM_LOAD
         ;; Code, used to init _DATA
         .area   _GSINIT
         .area   _GSFINAL
+        ;; Code that runs from hram, base address set by the linker (0xFFA0 by default).
+        ;; Areas without a base address follow the one before them, so this one
+        ;; goes between two areas with a base address: _DATA is set by the linker too
+        .area   _CODE_HRAM
         ;; Uninitialised ram data
         .area   _DATA
         .area   _BSS
         ;; Initialised in ram data
         .area   _INITIALIZED
+        ;; Code that runs from ram, copied in by gsinit
+        .area   _CODE_RAM
         ;; For malloc
         .area   _HEAP
         .area   _HEAP_END
@@ -427,6 +441,20 @@ __current_bank::        ; Current bank
         .ds     0x01            ; Is VBL interrupt finished?
 __shadow_OAM_base::
         .ds     0x01
+__joypad_cur::          ; State of the joypad for joypad_update()
+        .ds     0x01
+__joypad_prev::
+        .ds     0x01
+__joypad_pressed::
+        .ds     0x01
+__joypad_released::
+        .ds     0x01
+__joypad_raw::          ; Last read for joypad_update_debounce()
+        .ds     0x01
+__crash_zones::         ; Breadcrumb ring of crash_zone(), see gb/crash_handler.h
+        .ds     .CRASH_ZONES
+__crash_zone_pos::      ; Slot of the last breadcrumb
+        .ds     0x01
 
         ;; Runtime library
         .area   _GSINIT
@@ -438,6 +466,18 @@ gsinit::
         LD      DE, #s__INITIALIZED
         CALL    .memcpy_simple
 
+        ;; copy code that runs from ram and hram
+        ;; only the part in the load areas: library areas with .ds space only have
+        ;; none, they are linked after the code of the program
+        LD      BC, #l__CODE_RAM_LOAD
+        LD      HL, #s__CODE_RAM_LOAD
+        LD      DE, #s__CODE_RAM
+        CALL    .memcpy_simple
+        LD      BC, #l__CODE_HRAM_LOAD
+        LD      HL, #s__CODE_HRAM_LOAD
+        LD      DE, #s__CODE_HRAM
+        CALL    .memcpy_simple
+
         .area   _GSFINAL
 
         RET
@@ -445,16 +485,31 @@ gsinit::
         .area   _HOME
 
         ;; fills memory at HL of length BC with A, clobbers DE
+        ;; writes without reading the memory back, two bytes per loop
 .memset_simple::
         LD      E, A
         LD      A, B
         OR      C
         RET     Z
-        LD      (HL), E
-        DEC     BC
-        LD      D, H
-        LD      E, L
-        INC     DE
+        LD      A, E
+
+        SRL     B
+        RR      C
+        JR      NC,3$
+        LD      (HL+), A
+3$:
+        INC     B
+        INC     C
+        JR      2$
+1$:
+        LD      (HL+), A
+        LD      (HL+), A
+2$:
+        DEC     C
+        JR      NZ,1$
+        DEC     B
+        JR      NZ,1$
+        RET
 
         ;; copies BC bytes from HL into DE
 .memcpy_simple::
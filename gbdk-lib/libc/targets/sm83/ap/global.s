@@ -43,6 +43,8 @@
         .MAXWNDPOSX     = 0xA6
         .MAXWNDPOSY     = 0x8F
 
+        .CRASH_ZONES    = 6     ; Breadcrumbs kept for the crash handler
+
         ;; Hardware registers
 
         .P1             = 0x00  ; Joystick: 1.1.P15.P14.P13.P12.P11.P10
@@ -0,0 +1,273 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/cgb.h>
+#include <gb/vram_queue.h>
+#include <gbdk/gbdecompress.h>
+#include <gbdk/rledecompress.h>
+#include <gb/asset_loader.h>
+
+/* Packed maps loaded a slice per frame, see gb/asset_loader.h */
+
+#define AL_TILE_SIZE 16
+#define AL_CHUNK     128 /* Bytes per RLE call, counts are 8 bit */
+
+/* Destination of the current section */
+#define AL_RAM       0x01 /* map_buf, instead of VRAM through the queue */
+#define AL_ROWS      0x02 /* Rows of the background map, instead of tiles */
+#define AL_BANK1     0x04 /* CGB VRAM bank 1 */
+
+uint16_t asset_loader_budget = 128;
+
+static const asset_entry_t * al_entries;   /* NULL once loaded or stopped */
+static uint8_t al_count, al_entry, al_section;
+static asset_progress_t al_progress;
+static uint16_t al_done, al_total;
+
+static packed_map_header_t al_hdr;         /* Copies of the current entry and section, */
+static packed_map_section_t al_sec;        /* which are in a ROM bank */
+static const uint8_t * al_src;
+static uint8_t * al_dst;
+static uint16_t al_left;
+static uint8_t al_dest, al_x, al_y;
+static gb_decompress_ctx_t al_ctx;
+static uint8_t al_buf[VRAM_QUEUE_STRIPE_MAX];
+
+static uint8_t * al_tile_addr(uint8_t tile)
+{
+    uint16_t addr = (uint16_t)tile * AL_TILE_SIZE;
+
+    if (!(tile & 0x80u) && !(LCDC_REG & LCDCF_BG8000)) addr += 0x9000u;
+    else addr += 0x8000u;
+    return (uint8_t *)addr;
+}
+
+/* Returns TRUE if section s of entry e is loaded on this console */
+static uint8_t al_wanted(const asset_entry_t * e, const packed_map_section_t * s)
+{
+    uint8_t cgb = (_cpu == CGB_TYPE);
+
+    switch (s->type) {
+        case PACKED_MAP_SECTION_TILES_BANK1:
+            return cgb;
+        case PACKED_MAP_SECTION_ATTRIBUTES:
+            return (e->map_buf != NULL) || cgb;
+        case PACKED_MAP_SECTION_PALETTES:
+            return cgb && (e->flags & ASSET_LOADER_PALETTES);
+    }
+    return TRUE;
+}
+
+/* Checks every section of entry e and adds their sizes to al_total, with its bank switched in */
+static uint8_t al_check(const asset_entry_t * e)
+{
+    const packed_map_header_t * hdr = (const packed_map_header_t *)e->data;
+    const packed_map_section_t * s = (const packed_map_section_t *)(hdr + 1);
+    uint8_t i;
+
+    if ((hdr->magic[0] != PACKED_MAP_MAGIC_0) || (hdr->magic[1] != PACKED_MAP_MAGIC_1) ||
+        (hdr->version != PACKED_MAP_VERSION) || (hdr->flags & PACKED_MAP_INTERLEAVED))
+        return PACKED_MAP_ERR_FORMAT;
+
+    for (i = 0; i < hdr->section_count; i++, s++) {
+        if ((s->type < PACKED_MAP_SECTION_TILES) || (s->type > PACKED_MAP_SECTION_PALETTES) || (s->compression > PACKED_MAP_RLE))
+            return PACKED_MAP_ERR_FORMAT;
+        if ((s->type == PACKED_MAP_SECTION_PALETTES) && (s->compression != PACKED_MAP_NONE))
+            return PACKED_MAP_ERR_FORMAT;
+        if (((s->type == PACKED_MAP_SECTION_TILES) || (s->type == PACKED_MAP_SECTION_TILES_BANK1)) &&
+            (s->compression == PACKED_MAP_GB) && !(LCDC_REG & LCDCF_BG8000) &&
+            (hdr->first_tile < 128u) && (hdr->first_tile + (s->size / AL_TILE_SIZE) > 128u))
+            return PACKED_MAP_ERR_FORMAT;
+        if (((s->type == PACKED_MAP_SECTION_MAP) || (s->type == PACKED_MAP_SECTION_ATTRIBUTES)) && (e->map_buf == NULL) &&
+            ((s->compression == PACKED_MAP_GB) || (hdr->flags & PACKED_MAP_TRANSPOSED) ||
+             (hdr->map_w > DEVICE_SCREEN_BUFFER_WIDTH) || (hdr->map_h > DEVICE_SCREEN_BUFFER_HEIGHT)))
+            return PACKED_MAP_ERR_BUF;
+        if (al_wanted(e, s)) al_total += s->size;
+    }
+    return PACKED_MAP_OK;
+}
+
+uint8_t asset_loader_start(const asset_entry_t * entries, uint8_t count, asset_progress_t progress)
+{
+    uint8_t save_bank = CURRENT_BANK;
+    uint8_t ret = PACKED_MAP_OK, i;
+
+    al_entries = NULL;
+    al_total = al_done = 0;
+    for (i = 0; i < count; i++) {
+        SWITCH_ROM(entries[i].bank);
+        if ((ret = al_check(entries + i)) != PACKED_MAP_OK) break;
+    }
+    SWITCH_ROM(save_bank);
+    if (ret != PACKED_MAP_OK) return ret;
+
+    al_count = count;
+    al_entry = 0;
+    al_section = 0;
+    al_left = 0;
+    al_progress = progress;
+    if (count) {
+        SWITCH_ROM(entries->bank);
+        memcpy(&al_hdr, entries->data, sizeof(al_hdr));
+        SWITCH_ROM(save_bank);
+        al_entries = entries;
+    }
+    return PACKED_MAP_OK;
+}
+
+/* Moves to the next section to load, switching banks between entries.
+   Returns FALSE once the whole manifest is loaded */
+static uint8_t al_next(void)
+{
+    const asset_entry_t * e;
+
+    for (;;) {
+        e = al_entries + al_entry;
+        if (al_section == al_hdr.section_count) {
+            if (++al_entry == al_count) {
+                al_entries = NULL;
+                return FALSE;
+            }
+            e++;
+            SWITCH_ROM(e->bank);
+            memcpy(&al_hdr, e->data, sizeof(al_hdr));
+            al_section = 0;
+            continue;
+        }
+        memcpy(&al_sec, e->data + sizeof(al_hdr) + (al_section++ * sizeof(al_sec)), sizeof(al_sec));
+        if (al_wanted(e, &al_sec) && al_sec.size) break;
+    }
+
+    al_src = e->data + al_sec.offset;
+    al_left = al_sec.size;
+    al_dest = 0;
+    switch (al_sec.type) {
+        case PACKED_MAP_SECTION_TILES_BANK1:
+            al_dest = AL_BANK1;
+            /* Fall through */
+        case PACKED_MAP_SECTION_TILES:
+            al_dst = al_tile_addr(al_hdr.first_tile);
+            break;
+        case PACKED_MAP_SECTION_ATTRIBUTES:
+            if (e->map_buf) {
+                al_dest = AL_RAM;
+                al_dst = e->map_buf + (al_hdr.map_w * al_hdr.map_h);
+            } else
+                al_dest = AL_ROWS | AL_BANK1;
+            break;
+        case PACKED_MAP_SECTION_MAP:
+            if (e->map_buf) {
+                al_dest = AL_RAM;
+                al_dst = e->map_buf;
+            } else
+                al_dest = AL_ROWS;
+            break;
+    }
+    al_x = al_y = 0;
+    if (al_sec.compression == PACKED_MAP_GB)
+        gb_decompress_begin(&al_ctx, al_src, al_dst);
+    else if (al_sec.compression == PACKED_MAP_RLE)
+        rle_init((void *)al_src);
+    return TRUE;
+}
+
+/* Loads up to n bytes of the current section, returns how many were loaded */
+static uint16_t al_load(uint16_t n)
+{
+    const uint8_t * src;
+    uint8_t more;
+
+    if (n > al_left) n = al_left;
+
+    if (al_sec.type == PACKED_MAP_SECTION_PALETTES) {
+        set_bkg_palette(0, al_hdr.palette_count, (palette_color_t *)al_src);
+        return al_left;
+    }
+
+    if (al_sec.compression == PACKED_MAP_GB) {
+        if (al_dest & AL_BANK1) VBK_REG = VBK_BANK_1;
+        more = gb_decompress_step(&al_ctx, n);
+        VBK_REG = VBK_BANK_0;
+        n = (uint16_t)(al_ctx.dest - al_dst);
+        al_dst = al_ctx.dest;
+        return more ? n : al_left;
+    }
+
+    if (al_dest & AL_RAM) {
+        if (al_sec.compression == PACKED_MAP_RLE) {
+            if (n > AL_CHUNK) n = AL_CHUNK;
+            rle_decompress(al_dst, n);
+        } else {
+            memcpy(al_dst, al_src, n);
+            al_src += n;
+        }
+        al_dst += n;
+        return n;
+    }
+
+    /* VRAM, through the queue: a map row or a run of tiles at a time */
+    if (al_dest & AL_ROWS) {
+        if (n > (uint16_t)(al_hdr.map_w - al_x)) n = al_hdr.map_w - al_x;
+        al_dst = get_bkg_xy_addr(al_x, al_y);
+    } else if (n > (uint16_t)((uint8_t *)0x9800u - al_dst))
+        n = (uint8_t *)0x9800u - al_dst;
+    if (al_sec.compression == PACKED_MAP_RLE) {
+        if (n > sizeof(al_buf)) n = sizeof(al_buf);
+        rle_decompress(al_buf, n);
+        src = al_buf;
+    } else {
+        src = al_src;
+        al_src += n;
+    }
+    vram_queue_write_ex(al_dst, src, n, (al_dest & AL_BANK1) ? VRAM_QUEUE_BANK1 : 0);
+    if (al_dest & AL_ROWS) {
+        if ((al_x += n) == al_hdr.map_w) {
+            al_x = 0;
+            al_y++;
+        }
+    } else if ((al_dst += n) == (uint8_t *)0x9800u)
+        al_dst = (uint8_t *)0x8800u; /* Tile 127 to 128 with LCDCF_BG8800 */
+    return n;
+}
+
+uint8_t asset_loader_step(void)
+{
+    uint8_t save_bank = CURRENT_BANK;
+    uint16_t budget = asset_loader_budget, n;
+
+    if (al_entries == NULL) return FALSE;
+
+    SWITCH_ROM(al_entries[al_entry].bank);
+    while (budget) {
+        if (al_left == 0) {
+            if (!al_next()) break;
+            continue;
+        }
+        n = al_load(budget);
+        al_left -= n;
+        al_done += n;
+        budget = (n < budget) ? budget - n : 0;
+    }
+    SWITCH_ROM(save_bank);
+
+    if (al_progress) al_progress(al_done, al_total);
+    return (al_entries != NULL);
+}
+
+uint8_t asset_loader_busy(void)
+{
+    return (al_entries != NULL);
+}
+
+void asset_loader_wait(void)
+{
+    while (asset_loader_step()) {
+        vsync();
+    }
+    vram_queue_flush();
+}
+
+void asset_loader_stop(void)
+{
+    al_entries = NULL;
+}
@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+
+/* Copies from ROM banks which continue into the next bank at 0x8000,
+   one memcpy() or set_*_data() per bank. SWITCH_ROM() updates
+   _current_bank before the MBC, so an interrupt which switches banks
+   and restores _current_bank puts back the right one */
+
+#define BANK_END 0x8000u
+#define BANK_START ((const uint8_t *)0x4000u)
+
+/* Bytes of __n__ from __src__ up to the end of its bank */
+static uint16_t bank_room(const uint8_t * src, uint16_t n)
+{
+    uint16_t room;
+
+    if (((uint16_t)src & 0xC000u) != 0x4000u) return n;
+    room = BANK_END - (uint16_t)src;
+    return (room < n) ? room : n;
+}
+
+void banked_memcpy(void * dst, const void * src, uint8_t src_bank, uint16_t n)
+{
+    const uint8_t * s = (const uint8_t *)src;
+    uint8_t * d = (uint8_t *)dst;
+    uint8_t save_bank = CURRENT_BANK;
+    uint16_t len;
+
+    while (n) {
+        len = bank_room(s, n);
+        SWITCH_ROM(src_bank);
+        memcpy(d, s, len);
+        d += len;
+        n -= len;
+        s = BANK_START;
+        src_bank++;
+    }
+    SWITCH_ROM(save_bank);
+}
+
+static void banked_set_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t * data, uint8_t bank, uint8_t sprites)
+{
+    uint8_t tile[16];
+    uint8_t save_bank = CURRENT_BANK;
+    uint16_t n;
+
+    while (nb_tiles) {
+        n = bank_room(data, (uint16_t)nb_tiles << 4) >> 4;
+        if (n) {
+            SWITCH_ROM(bank);
+            if (sprites) set_sprite_data(first_tile, (uint8_t)n, data); else set_bkg_data(first_tile, (uint8_t)n, data);
+            data += n << 4;
+        } else {
+            /* A tile across the end of the bank goes through RAM */
+            banked_memcpy(tile, data, bank, sizeof(tile));
+            if (sprites) set_sprite_data(first_tile, 1, tile); else set_bkg_data(first_tile, 1, tile);
+            data += sizeof(tile);
+            n = 1;
+        }
+        if ((uint16_t)data >= BANK_END) {
+            data -= 0x4000u;
+            bank++;
+        }
+        first_tile += (uint8_t)n;
+        nb_tiles -= (uint8_t)n;
+    }
+    SWITCH_ROM(save_bank);
+}
+
+void banked_set_bkg_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t * data, uint8_t bank)
+{
+    banked_set_data(first_tile, nb_tiles, data, bank, 0);
+}
+
+void banked_set_sprite_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t * data, uint8_t bank)
+{
+    banked_set_data(first_tile, nb_tiles, data, bank, 1);
+}
@@ -0,0 +1,56 @@
+#include <stdint.h>
+#include <string.h>
+#include <gbdk/platform.h>
+#include <gbdk/banked_stream.h>
+
+/* Segments of an array split across banks by bankpack -split=, see
+   gbdk/banked_stream.h. The table ends with an entry of size 0, which
+   the stream stays on once everything was read */
+
+static void banked_stream_at(banked_stream_t * s, const banked_segment_t * segment)
+{
+    s->segment = segment;
+    s->ptr = segment->data;
+    s->left = segment->size;
+}
+
+void banked_stream_open(banked_stream_t * s, const banked_segment_t * segments)
+{
+    banked_stream_at(s, segments);
+}
+
+uint16_t banked_stream_read(banked_stream_t * s, void * dst, uint16_t len)
+{
+    uint8_t * p = (uint8_t *)dst;
+    uint8_t save_bank = CURRENT_BANK;
+    uint16_t n;
+
+    while (len) {
+        if (!s->left) {
+            if (!s->segment->size) break;
+            banked_stream_at(s, s->segment + 1);
+            continue;
+        }
+        n = (len < s->left) ? len : s->left;
+        SWITCH_ROM(s->segment->bank);
+        memcpy(p, s->ptr, n);
+        p += n;
+        s->ptr += n;
+        s->left -= n;
+        len -= n;
+    }
+    SWITCH_ROM(save_bank);
+    return (uint16_t)(p - (uint8_t *)dst);
+}
+
+void banked_stream_seek(banked_stream_t * s, const banked_segment_t * segments, uint32_t offset)
+{
+    while ((segments->size) && (offset >= segments->size)) {
+        offset -= segments->size;
+        segments++;
+    }
+    if (!segments->size) offset = 0;
+    banked_stream_at(s, segments);
+    s->ptr += (uint16_t)offset;
+    s->left -= (uint16_t)offset;
+}
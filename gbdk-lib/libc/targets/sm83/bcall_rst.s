@@ -0,0 +1,49 @@
+        .include        "global.s"
+
+        ;; Optional banked call trampoline, linked in with: lcc -bcall-rst
+        ;;
+        ;; Replaces ___sdcc_bcall_ehl from the library. The entry sits on
+        ;; RST 0x10 so hand written asm can make a banked call to E:HL with
+        ;; a single byte "rst 0x10". Calls into the bank which is already
+        ;; active skip the MBC writes. They still push the bank, since
+        ;; banked functions expect their arguments above the 4 bytes of
+        ;; the trampoline frame.
+        ;;
+        ;; Banked functions must not leave a different bank switched in
+        ;; when they return, since the same bank path doesn't restore it.
+
+        .title  "BcallRst"
+        .module BcallRst
+
+        .area   _BCALL_HEADER (ABS)
+
+        .org    0x10            ; RST 0x10 == banked call to E:HL
+___sdcc_bcall_ehl::
+        ldh     a, (__current_bank)
+        cp      e
+        jp      nz, .bcall_rst_switch
+        push    af              ; Same bank, keep the frame layout
+        rst     0x20
+                                ; 0x18: return of a same bank call
+        add     sp, #2
+        ret
+
+        .area   _HOME
+
+.bcall_rst_switch:
+        push    af                      ; Push the current bank onto the stack
+        ld      a, e
+        ldh     (__current_bank), a
+        ld      (rROMB0), a             ; Perform the switch
+        rst     0x20
+        push    hl
+        ldhl    sp, #3
+        ld      h, (hl)
+        ld      l, a
+        ld      a, h
+        ldh     (__current_bank), a
+        ld      (rROMB0), a
+        ld      a, l
+        pop     hl
+        add     sp, #2
+        ret
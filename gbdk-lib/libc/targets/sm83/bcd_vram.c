@@ -0,0 +1,27 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gb/bcd.h>
+
+/* BCD numbers drawn into a tile map a changed digit at a time, see gb/bcd.h */
+
+void bcd2vram(uint8_t * addr, const uint8_t * bcd, uint8_t len, uint8_t tile_offset, uint8_t * shadow)
+{
+    uint8_t now, changed;
+
+    /* Most significant byte first, as shown */
+    bcd += len;
+    shadow += len;
+    for (; len; len--, addr += 2) {
+        now = *--bcd;
+        changed = now ^ *--shadow;
+        if (!changed) continue;
+        if (changed & 0xF0u) set_vram_byte(addr, (uint8_t)((now >> 4) + tile_offset));
+        if (changed & 0x0Fu) set_vram_byte(addr + 1, (uint8_t)((now & 0x0Fu) + tile_offset));
+        *shadow = now;
+    }
+}
+
+void bcd2vram_xy(uint8_t x, uint8_t y, const uint8_t * bcd, uint8_t len, uint8_t tile_offset, uint8_t * shadow)
+{
+    bcd2vram(get_bkg_xy_addr(x, y), bcd, len, tile_offset, shadow);
+}
@@ -10,6 +10,7 @@ _cpu_slow::			; Banked
 	RET	Z		; No, already in single speed
 
 .shift_speed:
+	PUSH	BC
 	LDH	A,(.IE)
 	PUSH	AF
 
@@ -25,10 +26,41 @@ _cpu_slow::			; Banked
 
 	STOP
 
+	;; Keep a running timer at the same rate, the timer clock follows the CPU speed
+	LDH	A,(.TAC)
+	LD	B,A
+	AND	#TACF_START
+	JR	Z,3$
+	LDH	A,(.KEY1)
+	AND	#KEY1F_DBLSPEED
+	LDH	A,(.TMA)
+	JR	Z,1$		; Normal speed: period / 2
+	SLA	A		; Double speed: period * 2
+	JR	C,2$		; The period was 128 or less
+	RRA			; Otherwise a 4 times slower clock and period / 2
+	LD	C,A
+	LD	A,B
+	AND	#0x03
+	JR	Z,4$		; Already the slowest clock
+	INC	A
+	AND	#0x03
+	OR	#TACF_START
+	LDH	(.TAC),A
+	LD	A,C
+1$:
+	SRL	A		; TMA = 256 - ((256 - TMA) / 2), rounded to the longer period
+	OR	#0x80
+2$:
+	LDH	(.TMA),A
+3$:
 	POP	AF
 	LDH	(.IE),A
 
+	POP	BC
 	RET
+4$:
+	XOR	A		; Longest period of the slowest clock
+	JR	2$
 
 _cpu_fast::			; Banked
 	LDH	A,(.KEY1)
@@ -24,16 +24,31 @@ _set_bkg_palette::		; Non-banked
 	LDH	(C),A
 	INC	C
 	LD	A,(HL+)		; D = nb_palettes
-	ADD	A		; A *= 8
-	ADD	A
+	ADD	A		; A *= 4
 	ADD	A
-	LD	B,A		; Number of bytes
+	LD	B,A		; Number of colors
 	LD	A,(HL+)		; rgb_data
 	LD	H,(HL)
 	LD	L,A
-1$:	
+
+	LDH	A,(.LCDC)
+	AND	#LCDCF_ON
+	JR	NZ,1$
+2$:				; LCD off: palette RAM is always accessible
+	LD	A,(HL+)
+	LDH	(C),A
+	LD	A,(HL+)
+	LDH	(C),A
+	DEC	B
+	JR	NZ,2$
+
+	POP	BC
+	RET
+1$:				; Both bytes of a color fit in the same HBlank, like set_bkg_palette_entry()
 	WAIT_STAT
 
+	LD	A,(HL+)
+	LDH	(C),A
 	LD	A,(HL+)
 	LDH	(C),A
 	DEC	B
@@ -0,0 +1,58 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gb/gb.h>
+#include <gbdk/console.h>
+
+/* Shadow text buffer flush, the buffered writes and scrolling are in font.s */
+
+#define CON_DIRTY (CONSOLE_WIDTH * CONSOLE_HEIGHT) /* Must match .CON_DIRTY in font.s */
+
+extern uint8_t * _console_buf;
+extern uint8_t _console_buf_top, _console_hw_top;
+
+/* Writes row of the buffer to the tile map row it is shown at */
+static void console_write_row(uint8_t row)
+{
+    uint8_t y = row - _console_buf_top;
+
+    if (row < _console_buf_top) y += CONSOLE_HEIGHT;
+    set_bkg_tiles(0, (y + _console_hw_top) & 31u, CONSOLE_WIDTH, 1, _console_buf + (row * CONSOLE_WIDTH));
+}
+
+void console_buffer_set(uint8_t * buf)
+{
+    uint8_t row;
+
+    if (_console_buf) {
+        /* Back to an unscrolled tile map */
+        _console_hw_top = 0;
+        for (row = 0; row != CONSOLE_HEIGHT; row++) {
+            console_write_row(row);
+        }
+        SCY_REG = 0;
+        _console_buf = NULL;
+        _console_buf_top = 0;
+    }
+    if (buf) {
+        for (row = 0; row != CONSOLE_HEIGHT; row++) {
+            get_bkg_tiles(0, row, CONSOLE_WIDTH, 1, buf + (row * CONSOLE_WIDTH));
+            buf[CON_DIRTY + row] = 0;
+        }
+        _console_buf_top = _console_hw_top = 0;
+        _console_buf = buf;
+    }
+}
+
+void console_flush(void)
+{
+    uint8_t row;
+
+    if (!_console_buf) return;
+    for (row = 0; row != CONSOLE_HEIGHT; row++) {
+        if (_console_buf[CON_DIRTY + row]) {
+            _console_buf[CON_DIRTY + row] = 0;
+            console_write_row(row);
+        }
+    }
+    SCY_REG = _console_hw_top << 3;
+}
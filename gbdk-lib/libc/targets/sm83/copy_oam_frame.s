@@ -0,0 +1,93 @@
+        .include    "global.s"
+
+        .title  "Metasprites"
+        .module CopyOAMFrame
+
+        .globl  ___current_metasprite, ___render_shadow_OAM
+
+        .area   _CODE
+
+; uint8_t __copy_oam_frame(uint8_t id, uint16_t yx)
+; a: id
+; de: yx
+;
+; ___current_metasprite points to a png2asset OAM frame: the number of
+; sprites, then y, x, tile and props of each one, with y and x relative
+; to the pivot. Only y and x need an add, tile and props are copied as is.
+
+___copy_oam_frame::
+        cp      #40
+        jr      c, 0$
+        xor     a
+        ret
+0$:
+        ld      b, a
+        add     a
+        add     a
+        ld      c, a
+
+        ld      hl, #___current_metasprite
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+
+        ld      a, #40      ; clip the count to the sprites left in OAM
+        sub     b
+        cp      (hl)
+        jr      c, 1$
+        ld      a, (hl)
+1$:
+        inc     hl
+        or      a
+        ret     z
+
+        push    af
+        ld      a, (___render_shadow_OAM)
+        ld      b, a
+        pop     af
+        push    af          ; return value
+
+        srl     a           ; two sprites per loop, odd one first
+        jr      nc, 3$
+        push    af
+        jr      4$
+2$:
+        push    af
+        ld      a, (hl+)    ; y
+        add     d
+        ld      (bc), a
+        inc     c
+        ld      a, (hl+)    ; x
+        add     e
+        ld      (bc), a
+        inc     c
+        ld      a, (hl+)    ; tile
+        ld      (bc), a
+        inc     c
+        ld      a, (hl+)    ; props
+        ld      (bc), a
+        inc     c
+4$:
+        ld      a, (hl+)    ; y
+        add     d
+        ld      (bc), a
+        inc     c
+        ld      a, (hl+)    ; x
+        add     e
+        ld      (bc), a
+        inc     c
+        ld      a, (hl+)    ; tile
+        ld      (bc), a
+        inc     c
+        ld      a, (hl+)    ; props
+        ld      (bc), a
+        inc     c
+        pop     af
+3$:
+        or      a
+        jr      z, 5$
+        dec     a
+        jr      2$
+5$:
+        pop     af
+        ret
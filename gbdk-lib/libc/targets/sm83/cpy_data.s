@@ -2,7 +2,7 @@
 
 	.area   _CODE
 
-	.globl	_vmemcpy, _set_data, _get_data, .copy_vram
+	.globl	_vmemcpy, _set_data, _get_data, _vmemcpy_nowait, .copy_vram
 
 ;DE: dest
 ;HL: src
@@ -19,6 +19,10 @@
 _vmemcpy::
 _set_data::
 _get_data::
+	;with the LCD off VRAM is always accessible
+	ldh	a, (.LCDC)
+	and	#LCDCF_ON
+	jp	z, _vmemcpy_nowait
 	ldhl	sp, #3
 	ld	a, (hl-)
 	ld	l, (hl)
@@ -70,3 +74,75 @@ test:
 	;throw away n
 	pop	af
 	jp	(hl)
+
+;DE: dest
+;BC: src
+;sp+2: len
+;same as vmemcpy() without the STAT checks
+_vmemcpy_nowait::
+	ldhl	sp, #2
+	ld	a, (hl+)
+	ld	h, (hl)
+	ld	l, a
+	or	h
+	jr	z, 9$
+	push	bc
+	push	de
+
+	;entry point for the first, possibly partial, block of 16
+	;= 1$ + 3 * ((16 - len) & 15)
+	ld	a, l
+	cpl
+	inc	a
+	and	#0x0F
+	ld	e, a
+	add	a
+	add	e
+	add	#<1$
+	ld	e, a
+	adc	#>1$
+	sub	e
+	ld	d, a
+
+	;number of blocks = (len + 15) / 16
+	ld	bc, #15
+	add	hl, bc
+	rr	h
+	rr	l
+.rept	3
+	srl	h
+	rr	l
+.endm
+	ld	b, h
+	ld	c, l
+
+	pop	hl
+	push	de
+	ld	d, h
+	ld	e, l
+	;HL: src
+	ldhl	sp, #2
+	ld	a, (hl+)
+	ld	h, (hl)
+	ld	l, a
+	;jump into the unrolled copy
+	ret
+1$:
+.rept	16
+	ld	a, (hl+)
+	ld	(de), a
+	inc	de
+.endm
+	dec	bc
+	ld	a, b
+	or	c
+	jr	nz, 1$
+
+	;throw away src
+	add	sp, #2
+9$:
+	;get return address
+	pop	hl
+	;throw away n
+	pop	af
+	jp	(hl)
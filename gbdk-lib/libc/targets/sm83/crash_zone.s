@@ -0,0 +1,52 @@
+	.include	"global.s"
+
+	;; Breadcrumbs for the crash handler, see gb/crash_handler.h
+	;; The ring of the last .CRASH_ZONES zone ids lives in HRAM (crt0.s),
+	;; so recording one is a few ldh instructions.
+
+	.globl	__crash_zones, __crash_zone_pos
+	.globl	___crash_dropped, ___crash_stack_hw
+	.globl	_stack_high_water
+
+	.area	_HOME
+
+	;; void crash_zone(uint8_t id)
+_crash_zone::
+	LD	E, A
+	LDH	A, (__crash_zone_pos)
+	INC	A
+	CP	#.CRASH_ZONES
+	JR	C, 1$
+	XOR	A
+1$:
+	LDH	(__crash_zone_pos), A
+	ADD	#<__crash_zones
+	LD	C, A
+	LD	A, E
+	LDH	(C), A
+	RET
+
+	;; void crash_breadcrumbs_init(const uint16_t * dropped)
+_crash_breadcrumbs_init::
+	LD	A, E
+	OR	D
+	JR	NZ, 1$
+	LD	DE, #.crash_no_drops
+1$:
+	LD	HL, #___crash_dropped
+	LD	A, E
+	LD	(HL+), A
+	LD	(HL), D
+	LD	HL, #___crash_stack_hw	; Also links in the stack paint
+	LD	A, #<_stack_high_water
+	LD	(HL+), A
+	LD	(HL), #>_stack_high_water
+
+	XOR	A
+	LD	HL, #__crash_zones
+	LD	C, #(.CRASH_ZONES + 1)	; The ring and its slot
+	RST	0x28			; .MemsetSmall
+	RET
+
+.crash_no_drops:
+	.dw	0
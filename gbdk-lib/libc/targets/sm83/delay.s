@@ -8,10 +8,23 @@
 	;;   DE = number of milliseconds to delay (1 to 65536, 0 = 65536)
 	;; 
 	;; Register used: AF, DE
+	;;
+	;; In CGB double speed mode the delay is run twice
 	.CPMS	= 4194/4	; 4.194304 MHz
 
 _delay::
-.delay::			; 6 cycles for the CALL
+.delay::
+	LD	A,(__cpu)
+	CP	#.CGB_TYPE
+	JR	NZ,.delay_1x
+	LDH	A,(.KEY1)
+	AND	#KEY1F_DBLSPEED
+	JR	Z,.delay_1x
+	PUSH	DE
+	CALL	.delay_1x
+	POP	DE
+
+.delay_1x:			; 6 cycles for the CALL
 	PUSH	BC		; 4 cycles
 	CALL	.dly		; 12 cycles to return from .dly (6+1+5)
 	LD	B,#.CPMS/20-2	; 2 cycles
@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gb/dmg_palette.h>
+
+/* DMG palette animations written from VBlank, see gb/dmg_palette.h */
+
+static const dmg_palette_step_t * anim_steps;
+static uint8_t anim_count, anim_frames, anim_flags, anim_timer;
+/* Next step to write, anim_count once done */
+static volatile uint8_t anim_step;
+static scanline_fx_entry_t * anim_lines;
+static uint8_t anim_lines_count;
+
+/* Moves each of the four 2 bit shades of a palette from a to b */
+static uint8_t dmg_palette_mix(uint8_t a, uint8_t b, uint8_t step, uint8_t steps)
+{
+    uint8_t i, sa, sb, result = 0;
+
+    for (i = 0; i != 4; i++, a >>= 2, b >>= 2) {
+        sa = a & 0x03;
+        sb = b & 0x03;
+        if (sa > sb) sa -= (uint8_t)(((sa - sb) * step) / steps);
+        else sa += (uint8_t)(((sb - sa) * step) / steps);
+        result |= sa << (i << 1);
+    }
+    return result;
+}
+
+void dmg_palette_play(const dmg_palette_step_t * steps, uint8_t count, uint8_t frames, uint8_t flags)
+{
+    dmg_palette_stop();
+    anim_steps = steps;
+    anim_frames = frames;
+    anim_flags = flags;
+    anim_timer = 0;
+
+    /* The VBlank handler starts once the step count is set */
+    CRITICAL {
+        anim_step = 0;
+        anim_count = count;
+    }
+}
+
+void dmg_palette_fade_start(dmg_palette_step_t * table, const dmg_palette_step_t * from, const dmg_palette_step_t * to,
+                            uint8_t count, uint8_t frames, uint8_t flags)
+{
+    dmg_palette_step_t * step = table;
+    uint8_t s;
+
+    dmg_palette_stop();
+    if (count == 0) return;
+    if (count > DMG_PALETTE_FADE_STEPS_MAX) count = DMG_PALETTE_FADE_STEPS_MAX;
+    for (s = 1; s <= count; s++, step++) {
+        step->bgp = dmg_palette_mix(from->bgp, to->bgp, s, count);
+        step->obp0 = dmg_palette_mix(from->obp0, to->obp0, s, count);
+        step->obp1 = dmg_palette_mix(from->obp1, to->obp1, s, count);
+    }
+    dmg_palette_play(table, count, frames, flags & ~DMG_PALETTE_LOOP);
+}
+
+void dmg_palette_lines(scanline_fx_entry_t * entries, uint8_t count)
+{
+    CRITICAL {
+        anim_lines = entries;
+        anim_lines_count = count;
+    }
+}
+
+void dmg_palette_stop(void)
+{
+    CRITICAL {
+        anim_count = anim_step = 0;
+    }
+}
+
+uint8_t dmg_palette_busy(void)
+{
+    return anim_step != anim_count;
+}
+
+void dmg_palette_wait(void)
+{
+    while (anim_step != anim_count) {
+        vsync();
+    }
+}
+
+void dmg_palette_vbl(void)
+{
+    const dmg_palette_step_t * s;
+    scanline_fx_entry_t * e;
+    uint8_t step = anim_step, flags = anim_flags, n;
+
+    if (step == anim_count) return;
+    if (anim_timer) {
+        anim_timer--;
+        return;
+    }
+    s = anim_steps + step;
+    if (flags & DMG_PALETTE_BGP) BGP_REG = s->bgp;
+    if (flags & DMG_PALETTE_OBP0) OBP0_REG = s->obp0;
+    if (flags & DMG_PALETTE_OBP1) OBP1_REG = s->obp1;
+    if (flags & DMG_PALETTE_LINES) {
+        for (e = anim_lines, n = anim_lines_count; n; n--, e++) e->bgp = s->bgp;
+    }
+    anim_timer = anim_frames ? anim_frames - 1 : 0;
+    if (++step == anim_count) {
+        if (flags & DMG_PALETTE_LOOP) step = 0;
+    }
+    anim_step = step;
+}
@@ -18,6 +18,42 @@
         .M_XOR          = 0x02
         .M_AND          = 0x03
 
+        .APA_VRAM       = 0x8100 ; Tile data of the 20 x 18 APA tiles
+        .APA_FB_SIZE    = 0x1680
+
+        ;; Adds the framebuffer offset to the APA tile data address in HL,
+        ;; uses A. See apa_framebuffer_set().
+.macro APA_ADDR
+        LD      A,(__apa_offset)
+        ADD     L
+        LD      L,A
+        LD      A,(__apa_offset+1)
+        ADC     H
+        LD      H,A
+.endm
+
+        ;; Waits for VRAM unless HL is in the framebuffer, which is
+        ;; always at or above 0xA000. Uses A.
+.macro APA_WAIT ?lbl
+        LD      A,H
+        CP      #0xA0
+        JR      NC,lbl
+        WAIT_STAT
+lbl:
+.endm
+
+        ;; Same as APA_WAIT, but marks the framebuffer tile dirty instead of waiting
+.macro APA_WAIT_MARK ?lbl1, ?lbl2
+        LD      A,H
+        CP      #0xA0
+        JR      C,lbl1
+        CALL    .apa_mark
+        JR      lbl2
+lbl1:
+        WAIT_STAT
+lbl2:
+.endm
+
         ;;  Format of mod_col
         ;; 7 6 5 4 3 2 1 0
         ;;   mode  fg  bg
@@ -61,6 +97,14 @@
 .ty:
         .ds     1
 
+        ;; Framebuffer, see apa_framebuffer_set()
+__apa_fb::
+        .ds     2
+__apa_offset::                  ; __apa_fb - .APA_VRAM, or 0 when drawing to VRAM
+        .ds     2
+__apa_fb_dirty::                ; One bit per tile, MSB first
+        .ds     (.APA_FB_SIZE / 16 / 8)
+
         .area   _HOME
 
         ;; Enter graphic mode
@@ -137,9 +181,25 @@
 
         ;; Draw a full-screen image at (BC)
 .draw_image::
-        LD      DE,#0x8000+0x10*0x10
-        LD      BC,#0x1680
+        PUSH    HL
+        LD      HL,#.APA_VRAM
+        APA_ADDR
+        LD      D,H
+        LD      E,L
+        POP     HL
+        LD      BC,#.APA_FB_SIZE
         CALL    .copy_vram      ; Move the charset
+
+        LD      A,(__apa_fb+1)
+        OR      A
+        RET     Z
+        LD      HL,#__apa_fb_dirty ; All tiles of the framebuffer changed
+        LD      A,#0xFF
+        LD      B,#(.APA_FB_SIZE / 16 / 8)
+1$:
+        LD      (HL+),A
+        DEC     B
+        JR      NZ,1$
         RET
 
         ;; Replace tile data at (B,C) with data at DE and store old value at HL
@@ -166,6 +226,10 @@
         LD      H,(HL)
         LD      L,A
         ADD     HL,DE
+        APA_ADDR
+        LD      A,H
+        CP      #0xA0
+        CALL    NC,.apa_mark
 
         POP     DE
         PUSH    HL
@@ -741,6 +805,7 @@ x3$:
         LD      A,(HL+)
         LD      H,(HL)
         LD      L,A
+        APA_ADDR
 
         LD      A,B
         AND     #0xf8
@@ -958,6 +1023,10 @@ nadj$:
         AND     #0xF8
         JR      Z,4$
 
+        LD      A,(.draw_mode)  ;Solid whole bytes don't depend on VRAM
+        OR      A
+        JR      Z,9$
+
         XOR     A
         LD      C,A
         CPL
@@ -974,6 +1043,46 @@ nadj$:
         LD      E,A
         JR      8$
 
+        ;; Solid span: the colour's bit planes are written to
+        ;; each whole byte without reading it first
+9$:     LD      A,(.fg_colour)
+        LD      C,A
+        RRA
+        SBC     A
+        LD      B,A     ;Low bit plane
+        LD      A,C
+        RRA
+        RRA
+        SBC     A
+        LD      C,A     ;High bit plane
+
+        LD      A,E
+        AND     #7
+        PUSH    AF      ;Pixels left after the whole bytes
+        LD      A,E
+        RRCA
+        RRCA
+        RRCA
+        AND     #0x1F
+        LD      E,A     ;Whole bytes
+10$:    APA_WAIT_MARK
+        LD      A,B
+        LD      (HL+),A
+        LD      A,C
+        LD      (HL-),A
+        LD      A,L     ;Next tile
+        ADD     #0x10
+        LD      L,A
+        ADC     H
+        SUB     L
+        LD      H,A
+        DEC     E
+        JR      NZ,10$
+        POP     AF
+        OR      A
+        RET     Z
+        LD      E,A
+
 4$:     LD      A,#0x80
 5$:     DEC     E
         JR      Z,6$
@@ -1028,6 +1137,7 @@ y3$:
         LD      A,(HL+)
         LD      H,(HL)
         LD      L,A
+        APA_ADDR
 
         LD      A,B
         AND     #0xf8
@@ -1220,6 +1330,7 @@ nchgy$:
         LD      A,(HL+)
         LD      H,(HL)
         LD      L,A
+        APA_ADDR
 
         LD      A,B
         AND     #0xf8
@@ -1282,7 +1393,7 @@ nchgy$:
         JR      NZ,3$
         LD      E,#0x00
 3$:
-        WAIT_STAT
+        APA_WAIT_MARK
 
         LD      A,(HL)
         AND     C
@@ -1318,7 +1429,7 @@ nchgy$:
         JR      NZ,12$
         LD      C,#0x00
 12$:
-        WAIT_STAT
+        APA_WAIT_MARK
 
         LD      A,(HL)
         OR      B
@@ -1348,7 +1459,7 @@ nchgy$:
         JR      NZ,22$
         LD      C,#0x00
 22$:
-        WAIT_STAT
+        APA_WAIT_MARK
 
         LD      A,(HL)
         XOR     B
@@ -1378,7 +1489,7 @@ nchgy$:
         JR      Z,32$
         LD      C,#0xFF
 32$:
-        WAIT_STAT
+        APA_WAIT_MARK
 
         LD      A,(HL)
         AND     B
@@ -1389,6 +1500,44 @@ nchgy$:
         LD      (HL),A
         RET
 
+        ;; Marks the framebuffer tile at HL dirty, uses A
+.apa_mark:
+        PUSH    DE
+        PUSH    HL
+        LD      A,(__apa_fb)
+        LD      E,A
+        LD      A,(__apa_fb+1)
+        LD      D,A
+        LD      A,L
+        SUB     E
+        LD      L,A
+        LD      A,H
+        SBC     D
+        LD      H,A             ; HL = tile * 16 + row
+        ADD     HL,HL           ; H = tile / 8
+        LD      A,L
+        SWAP    A
+        RRCA
+        AND     #7              ; A = tile & 7
+        ADD     #<.drawing_bits_tbl     ; Table of bits is located at 0x0070
+        LD      E,A
+        LD      D,#0x00
+        LD      A,(DE)
+        LD      E,A
+        LD      A,H
+        LD      HL,#__apa_fb_dirty
+        ADD     L
+        LD      L,A
+        ADC     H
+        SUB     L
+        LD      H,A
+        LD      A,(HL)
+        OR      E
+        LD      (HL),A
+        POP     HL
+        POP     DE
+        RET
+
         ;; Get color of pixel at point (B,C) returns in A
 .getpix::
         LD      HL,#.y_table
@@ -1399,6 +1548,7 @@ nchgy$:
         LD      A,(HL+)
         LD      H,(HL)
         LD      L,A
+        APA_ADDR
 
         LD      A,B
         AND     #0xf8
@@ -1415,7 +1565,7 @@ nchgy$:
         LD      A,(BC)
         LD      C,A
 
-        WAIT_STAT
+        APA_WAIT
 
         LD      A,(HL+)
         LD      D,A
@@ -1448,6 +1598,7 @@ nchgy$:
         LD      B, A
         LD      H,(HL)
         LD      L,B
+        APA_ADDR
 
         LD      A,(.tx)
         RLCA
@@ -1540,7 +1691,7 @@ nchgy$:
         POP     HL
         .endif
 
-        WAIT_STAT
+        APA_WAIT_MARK
 
         LD      A,D
         LD      (HL+),A
@@ -0,0 +1,86 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gb/cgb.h>
+#include <gb/drawing.h>
+#include <gb/vram_queue.h>
+
+/* APA framebuffer flush, the drawing side is in drawing.s */
+
+#define APA_VRAM        0x8100u /* Must match .APA_VRAM in drawing.s */
+#define APA_TILE_COUNT  (APA_FRAMEBUFFER_SIZE / 16)
+#define APA_HDMA_MAX    128u
+
+extern uint8_t * _apa_fb;
+extern uint16_t _apa_offset;
+extern uint8_t _apa_fb_dirty[APA_TILE_COUNT / 8];
+
+void apa_framebuffer_set(uint8_t * fb)
+{
+    uint8_t i;
+
+    if (get_mode() != M_DRAWING) mode(M_DRAWING);
+    /* VRAM has to be up to date before it is copied or drawn to again */
+    if (_apa_fb) {
+        apa_framebuffer_flush();
+        if (_cpu == CGB_TYPE) hdma_wait();
+        vram_queue_flush();
+    }
+    if (fb) vmemcpy(fb, (uint8_t *)APA_VRAM, APA_FRAMEBUFFER_SIZE);
+    for (i = 0; i != sizeof(_apa_fb_dirty); i++) _apa_fb_dirty[i] = 0;
+    _apa_fb = fb;
+    _apa_offset = fb ? (uint16_t)fb - APA_VRAM : 0;
+}
+
+/* Copies count tiles from the framebuffer, tile * 16 bytes into the tile data */
+static void apa_framebuffer_copy(uint16_t tile, uint16_t count)
+{
+    const uint8_t * src = _apa_fb + (tile * 16);
+    uint8_t * dst = (uint8_t *)(APA_VRAM + (tile * 16));
+    uint8_t n;
+
+    if ((_cpu != CGB_TYPE) || !(LCDC_REG & LCDCF_ON)) {
+        vram_queue_write(dst, src, count * 16);
+        return;
+    }
+    /* HBlank DMA, one tile per HBlank. The source and the destination
+       are both linear, unlike the tile addressing of hdma_set_bkg_data() */
+    while (count) {
+        n = (count > APA_HDMA_MAX) ? APA_HDMA_MAX : (uint8_t)count;
+        hdma_wait();
+        HDMA1_REG = (uint16_t)src >> 8;
+        HDMA2_REG = (uint8_t)(uint16_t)src;
+        HDMA3_REG = (uint16_t)dst >> 8;
+        HDMA4_REG = (uint8_t)(uint16_t)dst;
+        HDMA5_REG = HDMA5F_MODE_HBL | (uint8_t)(n - 1);
+        src += n * 16;
+        dst += n * 16;
+        count -= n;
+    }
+}
+
+void apa_framebuffer_flush(void)
+{
+    uint16_t tile = 0, first = 0, count = 0;
+    uint8_t i, b, bits;
+
+    if (!_apa_fb) return;
+    /* Each run of dirty tiles is one copy */
+    for (i = 0; i != sizeof(_apa_fb_dirty); i++) {
+        bits = _apa_fb_dirty[i];
+        _apa_fb_dirty[i] = 0;
+        if (!bits && !count) {
+            tile += 8;
+            continue;
+        }
+        for (b = 8; b; b--, tile++, bits <<= 1) {
+            if (bits & 0x80u) {
+                if (!count) first = tile;
+                count++;
+            } else if (count) {
+                apa_framebuffer_copy(first, count);
+                count = 0;
+            }
+        }
+    }
+    if (count) apa_framebuffer_copy(first, count);
+}
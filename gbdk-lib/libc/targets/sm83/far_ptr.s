@@ -51,6 +51,44 @@ ___call__banked::
         ld  (rROMB0), A
         ret
 
+        ;; Reentrant banked call through a far pointer, see FAR_CALL_FAST()
+        ;;
+        ;; The far pointer is the first argument on the stack. Together with
+        ;; the return address its 4 bytes take the place of the trampoline
+        ;; frame of a banked call, so the function finds its arguments where
+        ;; it expects them. A, BC and DE are kept for the return value.
+___call__banked_fast::
+        ldhl    sp, #4
+        ldh     a, (#__current_bank)
+        cp      (hl)
+        jr      nz, 1$
+        dec     hl
+        ld      a, (hl-)
+        ld      l, (hl)
+        ld      h, a
+        jp      (hl)                    ; Same bank: returns straight to the caller
+1$:
+        pop     bc                      ; Return address
+        pop     hl                      ; Function
+        pop     de                      ; E = bank of the function
+        push    bc                      ; Frame: return address,
+        push    af                      ; the current bank
+        ld      a, e
+        ldh     (#__current_bank), a
+        ld      (rROMB0), a
+        ld      de, #2$
+        push    de                      ; and the return into the trampoline
+        jp      (hl)
+2$:
+        ld      h, a
+        pop     af
+        ldh     (#__current_bank), a
+        ld      (rROMB0), a
+        ld      a, h
+        pop     hl
+        add     sp, #-4                 ; The caller removes the far pointer
+        jp      (hl)
+
 _to_far_ptr::
         ld  a, c
         ld  c, e
@@ -31,6 +31,11 @@
         ; Maximum number of fonts
         .MAX_FONTS              = 6
 
+        ; Shadow text buffer, see console_buffer_set()
+        .CON_W                  = .MAXCURSPOSX+1
+        .CON_H                  = .MAXCURSPOSY+1
+        .CON_DIRTY              = .CON_W*.CON_H ; One flag per row after the text
+
         .area   _FONT_HEADER (ABS)
 
         .org    .MODE_TABLE+4*.T_MODE
@@ -64,6 +69,14 @@ font_first_free_tile::
         ; Table containing descriptors for all of the fonts
 font_table::
         .ds     sfont_handle_sizeof*.MAX_FONTS
+        ; Shadow text buffer, or 0 when writing to VRAM
+__console_buf::
+        .ds     2
+        ; Row of the buffer / row of the tile map at the top of the screen
+__console_buf_top::
+        .ds     1
+__console_hw_top::
+        .ds     1
 
         .area   _HOME
 
@@ -264,6 +277,10 @@ set_char_no_encoding:
         add     a,e
         ld      e,a
 
+        ld      a,(__console_buf+1)
+        or      a
+        jr      nz,set_char_buffered
+
         LD      A,(.cury)       ; Y coordinate
         LD      L,A
         LD      H,#0x00
@@ -287,6 +304,52 @@ set_char_no_encoding:
         POP     BC
         RET
 
+set_char_buffered:
+        LD      A,(__console_buf_top)
+        LD      HL,#.cury
+        ADD     (HL)
+        CP      #.CON_H
+        JR      C,1$
+        SUB     #.CON_H
+1$:
+        LD      D,A             ; D = row of the buffer
+        CALL    .con_buf_row
+        LD      A,(.curx)
+        ADD_A_REG16 h,l
+        LD      (HL),E
+        POP     HL
+        POP     DE
+        POP     BC
+        RET
+
+        ;; Address of row D of the shadow text buffer in HL, marks the
+        ;; row dirty. Uses A, BC
+.con_buf_row:
+        LD      A,(__console_buf)
+        LD      C,A
+        LD      A,(__console_buf+1)
+        LD      B,A
+        LD      HL,#.CON_DIRTY
+        ADD     HL,BC
+        LD      A,D
+        ADD_A_REG16 h,l
+        LD      (HL),#1
+        LD      L,D
+        LD      H,#0x00
+        ADD     HL,HL
+        ADD     HL,HL
+        ADD     HL,BC
+        LD      B,H
+        LD      C,L             ; BC = buffer + row * 4
+        LD      L,D
+        LD      H,#0x00
+        ADD     HL,HL
+        ADD     HL,HL
+        ADD     HL,HL
+        ADD     HL,HL
+        ADD     HL,BC           ; HL = buffer + row * 20
+        RET
+
 _putchar::
         PUSH    BC
         LDA     HL,4(SP)        ; Skip return address
@@ -361,6 +424,28 @@ _cls::
 .cls_no_reset_pos:
         PUSH    DE
         PUSH    HL
+        LD      A,(__console_buf+1)
+        OR      A
+        JR      Z,3$
+        PUSH    BC
+        LD      D,#0x00
+4$:
+        CALL    .con_buf_row
+        LD      E,#.CON_W
+5$:
+        LD      (HL),#.SPACE
+        INC     HL
+        DEC     E
+        JR      NZ,5$
+        INC     D
+        LD      A,D
+        CP      #.CON_H
+        JR      NZ,4$
+        POP     BC
+        POP     HL
+        POP     DE
+        RET
+3$:
         LD      HL,#0x9800
         LD      E,#0x20         ; E = height
 1$:
@@ -484,6 +569,34 @@ _posy::
         PUSH    BC
         PUSH    DE
         PUSH    HL
+        LD      A,(__console_buf+1)
+        OR      A
+        JR      Z,4$
+
+        ;; Buffered: the top row becomes the new bottom row, the tile map
+        ;; only moves with SCY when the buffer is flushed
+        LD      HL,#__console_buf_top
+        LD      A,(HL)
+        LD      D,A
+        INC     A
+        CP      #.CON_H
+        JR      C,5$
+        XOR     A
+5$:
+        LD      (HL+),A
+        LD      A,(HL)          ; __console_hw_top
+        INC     A
+        AND     #0x1F
+        LD      (HL),A
+        CALL    .con_buf_row
+        LD      D,#.CON_W
+6$:
+        LD      (HL),#.SPACE
+        INC     HL
+        DEC     D
+        JR      NZ,6$
+        JR      7$
+4$:
         LD      HL,#0x9800
         LD      BC,#0x9800+0x20 ; BC = next line
         LD      E,#0x20-0x01    ; E = height - 1
@@ -507,7 +620,7 @@ _posy::
         LD      (HL+),A
         DEC     D
         JR      NZ,3$
-
+7$:
         POP     HL
         POP     DE
         POP     BC
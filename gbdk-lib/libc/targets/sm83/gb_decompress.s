@@ -100,3 +100,129 @@ gb_decompress::
         ld      b, a
 
         ret
+
+        ;; Banked source version, source data must be in ROM
+        ;; Reads past the end of a switchable ROM bank continue
+        ;; at the start of the next bank
+
+        ;; Load reg from (hl+), moving to the next bank at $8000
+.macro LD_SRC_BANKED reg, ?loc
+        ld      reg,(hl)
+        inc     hl
+        bit     7,h
+        jr      z,loc
+        call    .src_next_bank
+loc:
+.endm
+
+        .area _HOME
+
+.src_next_bank:
+        push    af
+        ld      h,#0x40
+        ldh     a,(__current_bank)
+        inc     a
+        ldh     (__current_bank),a
+        ld      (rROMB0),a
+        pop     af
+        ret
+
+; de = source; bc = dest; sp+2 = source bank
+_gb_decompress_banked::
+        ldh     a,(__current_bank)
+        push    af
+        ldhl    sp,#4
+        ld      a,(hl)
+        ldh     (__current_bank),a
+        ld      (rROMB0),a
+        ld      h,d
+        ld      l,e
+        ld      d,b
+        ld      e,c
+
+        push    de
+1$:
+        LD_SRC_BANKED a ; load command
+        or      a
+        jp      z,9$    ; exit, if last byte
+        bit     7,a
+        jr      nz,5$   ; string functions
+        bit     6,a
+        jr      nz,3$
+        ; RLE byte
+        and     #63     ; calc counter
+        inc     a
+        ld      b,a
+        LD_SRC_BANKED a
+2$:
+        ld      (de),a
+        inc     de
+        dec     b
+        jr      nz,2$
+        jr      1$      ; next command
+3$:                     ; RLE word
+        and     #63
+        inc     a
+        LD_SRC_BANKED b ; load word into bc
+        LD_SRC_BANKED c
+4$:
+        push    af
+        ld      a,b     ; store word
+        ld      (de),a
+        inc     de
+        ld      a,c
+        ld      (de),a
+        inc     de
+        pop     af
+        dec     a
+        jr      nz,4$
+        jr      1$      ; next command
+5$:
+        bit     6,a
+        jr      nz,7$
+        ; string repeat
+        and     a,#63
+        inc     a
+        LD_SRC_BANKED c
+        LD_SRC_BANKED b
+        push    hl
+        ld      h,d
+        ld      l,e
+        add     hl,bc
+        ld      b,a
+6$:
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        dec     b
+        jr      nz,6$
+        pop     hl
+        jp      1$      ; next command
+7$:                     ; string copy
+        and     #63
+        inc     a
+        ld      b,a
+8$:
+        LD_SRC_BANKED a
+        ld      (de),a
+        inc     de
+        dec     b
+        jr      nz,8$
+        jp      1$      ; next command
+9$:
+        pop     hl
+        ld      a, e
+        sub     l
+        ld      c, a
+        ld      a, d
+        sbc     h
+        ld      b, a
+
+        pop     af
+        ldh     (__current_bank),a
+        ld      (rROMB0),a
+
+        ; remove bank from the stack
+        pop     hl
+        inc     sp
+        jp      (hl)
@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gbdk/gbdecompress.h>
+
+/* Resumable GB-Decompress, same format as gb_decompress.s */
+
+#define CTX_F_DONE  0x01
+#define CTX_F_VRAM  0x02
+
+#define CMD_RLE_BYTE  0x00
+#define CMD_RLE_WORD  0x40
+#define CMD_REPEAT    0x80
+#define CMD_COPY      0xC0
+
+void gb_decompress_begin(gb_decompress_ctx_t * ctx, const uint8_t * sour, uint8_t * dest)
+{
+  ctx->sour = sour;
+  ctx->dest = dest;
+  ctx->count = 0;
+  ctx->flags = (((uint16_t)dest & 0xE000) == 0x8000) ? CTX_F_VRAM : 0;
+}
+
+uint8_t gb_decompress_step(gb_decompress_ctx_t * ctx, uint16_t budget)
+{
+  uint8_t value, cmd;
+  uint16_t offset;
+  uint8_t vram = ctx->flags & CTX_F_VRAM;
+
+  if (ctx->flags & CTX_F_DONE)
+    return 0;
+
+  while (budget) {
+    if (ctx->count == 0) {
+      /* Load the next command */
+      cmd = *ctx->sour++;
+      if (cmd == 0) {
+        ctx->flags |= CTX_F_DONE;
+        return 0;
+      }
+      ctx->cmd = cmd & 0xC0;
+      ctx->count = (cmd & 0x3F) + 1;
+      switch (ctx->cmd) {
+        case CMD_RLE_BYTE:
+          ctx->data[0] = *ctx->sour++;
+          break;
+        case CMD_RLE_WORD:
+          ctx->data[0] = *ctx->sour++;
+          ctx->data[1] = *ctx->sour++;
+          ctx->count <<= 1;
+          break;
+        case CMD_REPEAT:
+          /* 16 bit offset into the output, wrapping as the address would */
+          offset = ctx->sour[0] | ((uint16_t)ctx->sour[1] << 8);
+          ctx->ref = ctx->dest - (uint16_t)(~offset + 1);
+          ctx->sour += 2;
+          break;
+      }
+    }
+
+    switch (ctx->cmd) {
+      case CMD_RLE_BYTE:
+        value = ctx->data[0];
+        break;
+      case CMD_RLE_WORD:
+        value = ctx->data[ctx->count & 1];
+        break;
+      case CMD_REPEAT:
+        value = (vram) ? get_vram_byte((uint8_t *)ctx->ref) : *ctx->ref;
+        ctx->ref++;
+        break;
+      default:
+        value = *ctx->sour++;
+        break;
+    }
+
+    if (vram)
+      set_vram_byte(ctx->dest, value);
+    else
+      *ctx->dest = value;
+    ctx->dest++;
+
+    ctx->count--;
+    budget--;
+  }
+
+  /* Report completion right away if the end marker is next */
+  if ((ctx->count == 0) && (*ctx->sour == 0)) {
+    ctx->flags |= CTX_F_DONE;
+    return 0;
+  }
+  return 1;
+}
+
+uint8_t gb_decompress_done(const gb_decompress_ctx_t * ctx)
+{
+  return ctx->flags & CTX_F_DONE;
+}
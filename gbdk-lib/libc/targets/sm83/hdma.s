@@ -0,0 +1,154 @@
+        .include        "global.s"
+
+        .globl  .copy_tiles
+
+        ;; CGB HDMA tile uploads
+        ;; Same arguments, tile addressing and $8800-$97FF wrap as set_bkg_data()
+        ;; Falls back to the CPU copy (.copy_tiles) on DMG or unaligned source data
+
+        .area   _DATA
+
+.hdma_mode:
+        .ds     1
+
+        .area   _HOME
+
+_hdma_set_bkg_data::
+        ld e, #HDMA5F_MODE_GP
+        jr .hdma_set_bkg_data
+_hdma_set_bkg_data_hblank::
+        ld e, #HDMA5F_MODE_HBL
+.hdma_set_bkg_data:
+        ld d, #0x90
+        ldh a, (.LCDC)
+        and #LCDCF_BG8000
+        jr z, .hdma_tiles
+        jr .hdma_set_sprite_data
+_hdma_set_sprite_data::
+        ld e, #HDMA5F_MODE_GP
+        jr .hdma_set_sprite_data
+_hdma_set_sprite_data_hblank::
+        ld e, #HDMA5F_MODE_HBL
+.hdma_set_sprite_data:
+        ld d, #0x80
+.hdma_tiles:
+        ldhl sp, #3
+        ld a, (hl+) ; Nb of tiles
+        or a
+        ret z
+        ld a, (hl)  ; Src ptr low byte: DMA ignores the lower 4 bits
+        and #0x0F
+        jp nz, .copy_tiles
+
+        ld a, (__cpu)
+        cp #.CGB_TYPE
+        jp nz, .copy_tiles
+
+        ; HBlank DMA doesn't advance while the LCD is off, use General Purpose DMA then
+        ldh a, (.LCDC)
+        and #LCDCF_ON
+        jr nz, 0$
+        ld e, #HDMA5F_MODE_GP
+0$:
+        ld a, e
+        ld (.hdma_mode), a
+
+        push bc
+        ldhl sp, #4
+        ld a, (hl+) ; ID of 1st tile
+        ld e, a
+        ld a, (hl+) ; Nb of tiles
+        ld c, a
+        ld a, (hl+) ; Src ptr
+        ld h, (hl)
+        ld l, a
+
+        ; Compute dest ptr
+        swap e ; *16 (size of a tile)
+        ld a, e
+        and #0x0F ; Get high bits
+        add d ; Add base offset of target tile "block"
+        ld d, a
+        ld a, e
+        and #0xF0 ; Get low bits only
+        ld e, a
+1$:
+        ; Wrap from past $97FF to $8800 onwards
+        ; This can be reduced to "bit 4 must be clear if bit 3 is set"
+        bit 3, d
+        jr z, 2$
+        res 4, d
+2$:
+        ; Wait for a previous HBlank transfer to finish (HDMA5 bit 7 reads 1 when idle)
+        ldh a, (.HDMA5)
+        rlca
+        jr nc, 2$
+
+        ; Tiles this transfer = min(remaining, 128 block DMA max, tiles left before $9800 wrap)
+        ld a, c
+        cp #129
+        jr c, 3$
+        ld a, #128
+3$:
+        ld b, a
+        ld a, d
+        cp #0x90
+        jr c, 4$    ; Below $9000 a 128 tile chunk can't reach $9800
+        ld a, #0x98
+        sub d
+        swap a      ; ($98 - D) * 16 tiles
+        swap e
+        sub e       ; - tiles already used in this row of 16
+        swap e
+        cp b
+        jr nc, 4$
+        ld b, a
+4$:
+        ld a, h
+        ldh (.HDMA1), a
+        ld a, l
+        ldh (.HDMA2), a
+        ld a, d
+        ldh (.HDMA3), a
+        ld a, e
+        ldh (.HDMA4), a
+        push hl
+        ld hl, #.hdma_mode
+        ld a, b
+        dec a
+        or (hl)
+        pop hl
+        ldh (.HDMA5), a ; Start, CPU is halted until done for General Purpose DMA
+
+        ; Advance src and dest by tiles * 16
+        push bc
+        ld a, b
+        swap a
+        ld c, a
+        and #0x0F
+        ld b, a
+        ld a, c
+        and #0xF0
+        ld c, a
+        add hl, bc
+        ld a, e
+        add c
+        ld e, a
+        ld a, d
+        adc b
+        ld d, a
+        pop bc
+
+        ld a, c
+        sub b
+        ld c, a
+        jr nz, 1$
+
+        pop bc
+        ret
+
+_hdma_wait::
+        ldh a, (.HDMA5)
+        rlca
+        jr nc, _hdma_wait
+        ret
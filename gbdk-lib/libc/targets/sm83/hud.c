@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/scanline_fx.h>
+#include <gb/hud.h>
+
+/* Window layer HUD with dirty cell tracking, see gb/hud.h */
+
+#define HUD_DIRTY_BYTES ((HUD_WIDTH + 7) / 8)
+
+static uint8_t * hud_cells;
+static uint8_t hud_rows;
+static uint8_t hud_dirty_any;
+static uint8_t hud_dirty[HUD_MAX_ROWS][HUD_DIRTY_BYTES];
+
+static const uint8_t hud_bit[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+
+void hud_init(uint8_t * cells, uint8_t rows, uint8_t tile)
+{
+    hud_cells = cells;
+    hud_rows = rows;
+    memset(cells, tile, (uint16_t)rows * HUD_WIDTH);
+    memset(hud_dirty, 0, sizeof(hud_dirty));
+    hud_dirty_any = 0;
+    fill_win_rect(0, 0, HUD_WIDTH, rows, tile);
+}
+
+static scanline_fx_entry_t * hud_split_entry(scanline_fx_entry_t * e, const scanline_fx_entry_t * base, uint8_t line, uint8_t wx)
+{
+    *e = *base;
+    e->line = line;
+    e->wx = wx;
+    return e;
+}
+
+void hud_split_set(scanline_fx_entry_t * table, const scanline_fx_entry_t * base, const hud_region_t * regions, uint8_t count)
+{
+    scanline_fx_entry_t * e = hud_split_entry(table, base, 0, HUD_WX_HIDE);
+    uint8_t end;
+
+    WY_REG = regions->line;
+    for (; count; count--, regions++) {
+        /* Starts at line 0 or where the last region ended: show from that entry on */
+        if (e->line == regions->line) e->wx = HUD_WX_SHOW;
+        else e = hud_split_entry(e + 1, base, regions->line, HUD_WX_SHOW);
+        end = regions->line + (regions->rows * 8);
+        if (end < DEVICE_SCREEN_PX_HEIGHT) e = hud_split_entry(e + 1, base, end, HUD_WX_HIDE);
+    }
+    (e + 1)->line = SCANLINE_FX_END;
+    scanline_fx_set_table(table);
+}
+
+void hud_split_scroll(scanline_fx_entry_t * table, uint8_t scx, uint8_t scy)
+{
+    for (; table->line != SCANLINE_FX_END; table++) {
+        table->scx = scx;
+        table->scy = scy;
+    }
+}
+
+void hud_set_tile(uint8_t x, uint8_t y, uint8_t tile)
+{
+    uint8_t * cell = hud_cells + ((uint16_t)y * HUD_WIDTH) + x;
+
+    if (*cell != tile) {
+        *cell = tile;
+        hud_dirty[y][x >> 3] |= hud_bit[x & 7];
+        hud_dirty_any = 1;
+    }
+}
+
+void hud_set_tiles(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * tiles)
+{
+    uint8_t i;
+
+    for (; h; h--, y++) {
+        for (i = 0; i != w; i++) hud_set_tile(x + i, y, *tiles++);
+    }
+}
+
+void hud_flush(void)
+{
+    uint8_t * dirty;
+    uint8_t y, x, start;
+
+    if (!hud_dirty_any) return;
+    hud_dirty_any = 0;
+    for (y = 0; y != hud_rows; y++) {
+        dirty = hud_dirty[y];
+        if (!(dirty[0] | dirty[1] | dirty[2])) continue;
+        x = 0;
+        while (x != HUD_WIDTH) {
+            if (!(dirty[x >> 3] & hud_bit[x & 7])) {
+                x++;
+                continue;
+            }
+            /* Write the whole run of dirty cells at once */
+            start = x;
+            do {
+                x++;
+            } while ((x != HUD_WIDTH) && (dirty[x >> 3] & hud_bit[x & 7]));
+            set_win_tiles(start, y, x - start, 1, hud_cells + ((uint16_t)y * HUD_WIDTH) + start);
+        }
+        dirty[0] = dirty[1] = dirty[2] = 0;
+    }
+}
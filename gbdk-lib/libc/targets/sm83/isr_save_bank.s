@@ -0,0 +1,73 @@
+	.include	"global.s"
+
+	;; Interrupt handler which saves the ROM bank, calls the handlers
+	;; added after it to the same chain, then restores the bank.
+	;; It takes over from the loop in .int: its own return address and
+	;; the list pointer pushed by .int are dropped, so the saved bank
+	;; sits directly on the frame of .int and is restored before the
+	;; frame is unwound, both at the end of the list and before jumping
+	;; to a chain terminator (which unwinds the frame itself).
+
+	.globl	__current_bank
+	.globl	_wait_int_handler, _nowait_int_handler
+
+	.area	_HOME
+
+_isr_save_bank::
+	POP	DE		; Return address into .int, not used
+	POP	HL		; High byte of this entry in the list
+	LDH	A, (__current_bank)
+	PUSH	AF
+	INC	HL
+1$:
+	LD	A, (HL+)
+	LD	E, A
+	LD	A, (HL)
+	LD	D, A
+	OR	E
+	JR	Z, 3$		; End of the list
+
+	LD	A, E		; Chain terminators don't return here
+	CP	#<_nowait_int_handler
+	JR	NZ, 2$
+	LD	A, D
+	CP	#>_nowait_int_handler
+	JR	Z, 4$
+2$:
+	LD	A, E
+	CP	#<_wait_int_handler
+	JR	NZ, 5$
+	LD	A, D
+	CP	#>_wait_int_handler
+	JR	Z, 4$
+5$:
+	PUSH	HL
+	LD	H, D
+	LD	L, E
+	RST	0x20		; .call_hl
+	POP	HL
+	INC	HL
+	JR	1$
+
+3$:
+	POP	AF
+	LDH	(__current_bank), A
+	LD	(rROMB0), A
+
+	POP	DE		; Same as .int_tail in crt0
+	POP	BC
+	POP	HL
+	WAIT_STAT
+	POP	AF
+	RETI
+
+4$:
+	POP	AF
+	LDH	(__current_bank), A
+	LD	(rROMB0), A
+
+	PUSH	HL		; The terminator drops a return address and a list pointer
+	PUSH	HL
+	LD	H, D
+	LD	L, E
+	JP	(HL)
@@ -0,0 +1,52 @@
+	.include	"global.s"
+
+	;; Direct LCD interrupt dispatch, replaces the handler chain of lcd.s
+	;; The vector jumps through a JP in RAM straight to the handler set
+	;; with set_LCD_fast(): no registers are saved and there is no
+	;; WAIT_STAT before returning, the handler has to do both itself
+
+	.area	_HEADER_LCD (ABS)
+
+	.org	0x48		; LCD
+.int_LCD:
+	JP	.int_lcd_fast
+
+	.area	_GSINIT
+
+	LD	HL, #.int_lcd_fast
+	LD	A, #0xC3	; JP nn
+	LD	(HL+), A
+	LD	A, #<.int_lcd_fast_none
+	LD	(HL+), A
+	LD	(HL), #>.int_lcd_fast_none
+
+	.area	_HOME
+
+	;; void set_LCD_fast(int_handler h)
+	;; DE = handler
+_set_LCD_fast::
+	LD	A, D
+	OR	E
+	JR	NZ, 1$
+	LD	DE, #.int_lcd_fast_none
+1$:
+	;; Mask the LCD interrupt while both bytes of the target change
+	LDH	A, (.IE)
+	LD	B, A
+	AND	#~.LCD_IFLAG
+	LDH	(.IE), A
+	LD	HL, #.int_lcd_fast + 1
+	LD	A, E
+	LD	(HL+), A
+	LD	(HL), D
+	LD	A, B
+	LDH	(.IE), A
+	RET
+
+.int_lcd_fast_none:
+	RETI
+
+	.area	_DATA
+
+.int_lcd_fast:
+	.ds	0x03
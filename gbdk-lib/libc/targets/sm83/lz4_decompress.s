@@ -0,0 +1,157 @@
+; LZ4 style decompress routine
+; Format written by gbcompress --alg=lz4
+
+        .include        "global.s"
+
+        .title  "LZ4 Decompress"
+        .module LZ4Decompress
+
+        ;; Copy b bytes (not 0) from hl to de, two per loop
+.macro LZ4_COPY_SHORT ?odd, ?loop, ?done
+        srl     b
+        jr      nc,odd
+        ld      a,(hl+)         ; odd byte
+        ld      (de),a
+        inc     de
+odd:
+        jr      z,done          ; flags are still from srl
+loop:
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        dec     b
+        jr      nz,loop
+done:
+.endm
+
+        .area _CODE
+
+_lz4_decompress::
+        ld      h,d
+        ld      l,e
+        ld      d,b
+        ld      e,c
+
+; hl = source; de = dest
+lz4_decompress::
+        push    de              ; start of output, for the size
+1$:
+        ld      a,(hl+)         ; load token into c
+        ld      c,a
+        swap    a
+        and     #0x0F           ; literal count
+        jr      z,3$
+        cp      #15
+        jr      z,2$
+        ld      b,a
+        LZ4_COPY_SHORT          ; literals
+        jr      3$
+2$:                             ; 15 or more literals
+        push    bc
+        call    .lz4_length
+        call    .lz4_copy
+        pop     bc
+3$:
+        ld      a,(hl+)         ; load match offset
+        ld      b,a
+        or      (hl)
+        jr      z,6$            ; exit, if offset 0
+        ld      a,e             ; match address = dest - offset
+        sub     b
+        ld      b,a
+        ld      a,d
+        sbc     (hl)
+        inc     hl
+        push    hl
+        ld      h,a
+        ld      l,b
+        ld      a,c
+        and     #0x0F           ; match length - 4
+        cp      #15
+        jr      z,4$
+        add     #4
+        ld      b,a
+        LZ4_COPY_SHORT          ; match, may overlap its output
+        pop     hl
+        jr      1$              ; next sequence
+4$:                             ; match of 19 bytes or more
+        ld      b,h
+        ld      c,l
+        pop     hl
+        push    bc
+        call    .lz4_length
+        ld      a,c
+        add     #4
+        ld      c,a
+        jr      nc,5$
+        inc     b
+5$:
+        push    hl
+        ldhl    sp,#2
+        ld      a,(hl+)
+        ld      h,(hl)
+        ld      l,a
+        call    .lz4_copy
+        pop     hl
+        add     sp,#2
+        jr      1$              ; next sequence
+6$:
+        pop     hl
+        ld      a,e
+        sub     l
+        ld      c,a
+        ld      a,d
+        sbc     h
+        ld      b,a
+
+        ret
+
+        ;; bc = 15 + the length bytes at (hl),
+        ;; added up until one isn't 255
+.lz4_length:
+        ld      bc,#15
+1$:
+        ld      a,(hl+)
+        cp      #255
+        jr      nz,2$
+        inc     b               ; + 255
+        dec     bc
+        jr      1$
+2$:
+        add     c
+        ld      c,a
+        ret     nc
+        inc     b
+        ret
+
+        ;; Copy bc bytes (not 0) from hl to de, two per loop
+.lz4_copy:
+        srl     b
+        rr      c
+        jr      nc,1$
+        ld      a,(hl+)         ; odd byte
+        ld      (de),a
+        inc     de
+1$:
+        ld      a,b
+        or      c
+        ret     z
+        inc     b
+        inc     c
+        jr      3$
+2$:
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+3$:
+        dec     c
+        jr      nz,2$
+        dec     b
+        jr      nz,2$
+        ret
@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gb/vram_queue.h>
+#include <gbdk/map_stream.h>
+
+/* Number of map columns and rows kept in the hardware tile map: one more
+   than fits on screen, unless the hardware tile map is no larger than the screen */
+#if (DEVICE_SCREEN_BUFFER_WIDTH > DEVICE_SCREEN_WIDTH)
+#define MS_COLS (DEVICE_SCREEN_WIDTH + 1)
+#else
+#define MS_COLS DEVICE_SCREEN_BUFFER_WIDTH
+#endif
+#if (DEVICE_SCREEN_BUFFER_HEIGHT > DEVICE_SCREEN_HEIGHT)
+#define MS_ROWS (DEVICE_SCREEN_HEIGHT + 1)
+#else
+#define MS_ROWS DEVICE_SCREEN_BUFFER_HEIGHT
+#endif
+
+#define MS_EDGE_MAX ((MS_COLS > MS_ROWS) ? MS_COLS : MS_ROWS)
+
+static uint8_t ms_tiles[MS_EDGE_MAX];
+static uint8_t ms_attrs[MS_EDGE_MAX];
+
+/* Copies n entries of the map starting at x, y into ms_tiles and ms_attrs,
+   along a row or a column */
+static void ms_fetch(const map_stream_t * ms, uint16_t x, uint16_t y, uint8_t n, uint8_t column)
+{
+    uint16_t ofs = (y * ms->map_w) + x;
+    uint16_t step = (column) ? ms->map_w : 1;
+    uint8_t save_bank = CURRENT_BANK;
+    uint8_t i;
+
+    if (ms->bank) SWITCH_ROM(ms->bank);
+    for (i = 0; i < n; i++, ofs += step) {
+        ms_tiles[i] = ms->map[ofs];
+        if (ms->attributes) ms_attrs[i] = ms->attributes[ofs];
+    }
+    if (ms->bank) SWITCH_ROM(save_bank);
+}
+
+/* Queues n entries of the fetched edge from i on at hardware tile map
+   position bx, by, along a row or a column (flags = VRAM_QUEUE_COLUMN) */
+static void ms_queue(const map_stream_t * ms, uint8_t bx, uint8_t by, uint8_t i, uint8_t n, uint8_t flags)
+{
+    uint8_t * addr = get_bkg_xy_addr(bx, by);
+
+    vram_queue_write_ex(addr, ms_tiles + i, n, flags);
+    if ((ms->attributes) && (_cpu == CGB_TYPE))
+        vram_queue_write_ex(addr, ms_attrs + i, n, flags | VRAM_QUEUE_BANK1);
+}
+
+/* Draws map row y, over the columns kept in the hardware tile map */
+static void ms_draw_row(const map_stream_t * ms, uint16_t y)
+{
+    uint16_t x = ms->tile_x + (DEVICE_SCREEN_WIDTH + 1 - MS_COLS);
+    uint8_t n = MS_COLS, bx, by, first;
+
+    if (y >= ms->map_h) return;
+    if ((x + n) > ms->map_w) n = ms->map_w - x;
+    ms_fetch(ms, x, y, n, 0);
+
+    /* Split where the row wraps around the hardware tile map */
+    bx = (uint8_t)x & (DEVICE_SCREEN_BUFFER_WIDTH - 1);
+    by = (uint8_t)y & (DEVICE_SCREEN_BUFFER_HEIGHT - 1);
+    first = DEVICE_SCREEN_BUFFER_WIDTH - bx;
+    if (first > n) first = n;
+    ms_queue(ms, bx, by, 0, first, 0);
+    if (first != n) ms_queue(ms, 0, by, first, n - first, 0);
+}
+
+/* Draws map column x, over the rows kept in the hardware tile map */
+static void ms_draw_column(const map_stream_t * ms, uint16_t x)
+{
+    uint16_t y = ms->tile_y + (DEVICE_SCREEN_HEIGHT + 1 - MS_ROWS);
+    uint8_t n = MS_ROWS, bx, by, first;
+
+    if (x >= ms->map_w) return;
+    if ((y + n) > ms->map_h) n = ms->map_h - y;
+    ms_fetch(ms, x, y, n, 1);
+
+    /* Split where the column wraps around the hardware tile map */
+    bx = (uint8_t)x & (DEVICE_SCREEN_BUFFER_WIDTH - 1);
+    by = (uint8_t)y & (DEVICE_SCREEN_BUFFER_HEIGHT - 1);
+    first = DEVICE_SCREEN_BUFFER_HEIGHT - by;
+    if (first > n) first = n;
+    ms_queue(ms, bx, by, 0, first, VRAM_QUEUE_COLUMN);
+    if (first != n) ms_queue(ms, bx, 0, first, n - first, VRAM_QUEUE_COLUMN);
+}
+
+static void ms_update_scroll(map_stream_t * ms)
+{
+    ms->scroll_x = (uint8_t)(ms->tile_x << 3) + ms->fine_x;
+    ms->scroll_y = (uint8_t)(ms->buf_y << 3) + ms->fine_y;
+}
+
+void map_stream_init(map_stream_t * stream, const uint8_t * map, const uint8_t * attributes, uint8_t bank, uint16_t map_w, uint16_t map_h)
+{
+    stream->map = map;
+    stream->attributes = attributes;
+    stream->bank = bank;
+    stream->map_w = map_w;
+    stream->map_h = map_h;
+    stream->tile_x = stream->tile_y = 0;
+    stream->fine_x = stream->fine_y = 0;
+    stream->buf_y = 0;
+    ms_update_scroll(stream);
+}
+
+void map_stream_set_camera(map_stream_t * stream, uint16_t tile_x, uint16_t tile_y)
+{
+    uint16_t y;
+    uint8_t i;
+
+    if (tile_x > (stream->map_w - DEVICE_SCREEN_WIDTH)) tile_x = stream->map_w - DEVICE_SCREEN_WIDTH;
+    if (tile_y > (stream->map_h - DEVICE_SCREEN_HEIGHT)) tile_y = stream->map_h - DEVICE_SCREEN_HEIGHT;
+    stream->tile_x = tile_x;
+    stream->tile_y = tile_y;
+    stream->fine_x = stream->fine_y = 0;
+    stream->buf_y = tile_y % DEVICE_SCREEN_BUFFER_HEIGHT;
+
+    y = tile_y + (DEVICE_SCREEN_HEIGHT + 1 - MS_ROWS);
+    for (i = 0; i < MS_ROWS; i++, y++)
+        ms_draw_row(stream, y);
+    ms_update_scroll(stream);
+}
+
+void map_stream_move(map_stream_t * stream, int8_t dx, int8_t dy)
+{
+    /* Vertical first, so the columns drawn below use the new rows */
+    while (dy > 0) {
+        if (stream->tile_y >= (stream->map_h - DEVICE_SCREEN_HEIGHT)) {
+            stream->fine_y = 0;
+            break;
+        }
+        if ((stream->fine_y + dy) < 8) {
+            stream->fine_y += dy;
+            break;
+        }
+        dy -= 8 - stream->fine_y;
+        stream->fine_y = 0;
+        stream->tile_y++;
+        if (++stream->buf_y == DEVICE_SCREEN_BUFFER_HEIGHT) stream->buf_y = 0;
+        ms_draw_row(stream, stream->tile_y + DEVICE_SCREEN_HEIGHT);
+    }
+    while (dy < 0) {
+        if (stream->fine_y >= (uint8_t)(-dy)) {
+            stream->fine_y += dy;
+            break;
+        }
+        if (stream->tile_y == 0) {
+            stream->fine_y = 0;
+            break;
+        }
+        dy += stream->fine_y + 1;
+        stream->fine_y = 7;
+        stream->tile_y--;
+        if (stream->buf_y-- == 0) stream->buf_y = DEVICE_SCREEN_BUFFER_HEIGHT - 1;
+        ms_draw_row(stream, stream->tile_y + (DEVICE_SCREEN_HEIGHT + 1 - MS_ROWS));
+    }
+
+    while (dx > 0) {
+        if (stream->tile_x >= (stream->map_w - DEVICE_SCREEN_WIDTH)) {
+            stream->fine_x = 0;
+            break;
+        }
+        if ((stream->fine_x + dx) < 8) {
+            stream->fine_x += dx;
+            break;
+        }
+        dx -= 8 - stream->fine_x;
+        stream->fine_x = 0;
+        stream->tile_x++;
+        ms_draw_column(stream, stream->tile_x + DEVICE_SCREEN_WIDTH);
+    }
+    while (dx < 0) {
+        if (stream->fine_x >= (uint8_t)(-dx)) {
+            stream->fine_x += dx;
+            break;
+        }
+        if (stream->tile_x == 0) {
+            stream->fine_x = 0;
+            break;
+        }
+        dx += stream->fine_x + 1;
+        stream->fine_x = 7;
+        stream->tile_x--;
+        ms_draw_column(stream, stream->tile_x + (DEVICE_SCREEN_WIDTH + 1 - MS_COLS));
+    }
+
+    ms_update_scroll(stream);
+}
@@ -0,0 +1,253 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gb/gb.h>
+#include <gb/hardware.h>
+#include <gbdk/music.h>
+
+/* Tracker style music and sound effect driver, see gbdk/music.h
+
+   Each frame the streams are read with their bank switched in, then
+   the voice of each channel (the effect if one plays, else the song)
+   goes through a copy of the last values written to the channel, so
+   only registers whose value changes are written */
+
+typedef struct voice_t {
+    const uint8_t * start;  /* NULL once the stream ended */
+    const uint8_t * ptr;
+    uint8_t bank;
+    uint8_t wait;           /* Frames until the next command is read */
+    uint8_t note;           /* MUSIC_CMD_REST while silent */
+    uint8_t volume;
+    uint8_t duty;
+    uint8_t trigger;        /* A note started */
+} voice_t;
+
+static voice_t song_voices[MUSIC_CHANNELS], sfx_voices[MUSIC_CHANNELS];
+
+/* Last values written to each channel */
+static uint8_t hw_duty[MUSIC_CHANNELS], hw_env[MUSIC_CHANNELS];
+static uint16_t hw_period[MUSIC_CHANNELS];
+/* Channels whose registers are all written on the next update */
+static uint8_t hw_reload;
+
+/* 2048 - 131072 / Hz for C3 to B8 */
+static const uint16_t periods[MUSIC_NOTE_COUNT] = {
+    1046, 1102, 1155, 1205, 1253, 1297, 1339, 1379, 1417, 1452, 1486, 1517,
+    1547, 1575, 1602, 1627, 1650, 1673, 1694, 1714, 1732, 1750, 1767, 1783,
+    1798, 1812, 1825, 1837, 1849, 1860, 1871, 1881, 1890, 1899, 1907, 1915,
+    1923, 1930, 1936, 1943, 1949, 1954, 1959, 1964, 1969, 1974, 1978, 1982,
+    1985, 1989, 1992, 1995, 1998, 2001, 2004, 2006, 2009, 2011, 2013, 2015,
+    2017, 2018, 2020, 2022, 2023, 2025, 2026, 2027, 2028, 2029, 2030, 2031
+};
+
+/* One triangle cycle for channel 3 */
+static const uint8_t triangle_wave[16] = {
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10
+};
+
+static void voice_start(voice_t * v, const uint8_t * stream, uint8_t bank)
+{
+    v->start = v->ptr = stream;
+    v->bank = bank;
+    v->wait = 1;
+    v->note = MUSIC_CMD_REST;
+    v->volume = 15;
+    v->duty = 2;
+    v->trigger = 0;
+}
+
+/* Reads the commands up to the next note or rest once the current one is over */
+static void voice_step(voice_t * v)
+{
+    const uint8_t * p = v->ptr;
+    uint8_t cmd, count = MUSIC_MAX_COMMANDS;
+
+    v->trigger = 0;
+    if (--v->wait) return;
+    v->wait = 1;
+    while (count--) {
+        cmd = *p++;
+        if (cmd < MUSIC_CMD_REST) {
+            v->note = cmd;
+            v->wait = *p++;
+            v->trigger = 1;
+            break;
+        } else if (cmd == MUSIC_CMD_REST) {
+            v->note = MUSIC_CMD_REST;
+            v->wait = *p++;
+            break;
+        } else if (cmd == MUSIC_CMD_WAIT) {
+            v->wait = *p++;
+            break;
+        } else if (cmd == MUSIC_CMD_VOLUME) {
+            v->volume = *p++;
+        } else if (cmd == MUSIC_CMD_DUTY) {
+            v->duty = *p++;
+        } else if (cmd == MUSIC_CMD_LOOP) {
+            p = v->start + (p[0] | ((uint16_t)p[1] << 8));
+        } else {
+            v->start = NULL;
+            v->note = MUSIC_CMD_REST;
+            break;
+        }
+    }
+    v->ptr = p;
+}
+
+/* Channel 3 volume codes, 0 is silent */
+static uint8_t wave_level(uint8_t volume)
+{
+    if (volume >= 12) return 0x20;
+    if (volume >= 6) return 0x40;
+    return (volume) ? 0x60 : 0;
+}
+
+static void hw_write(uint8_t ch, const voice_t * v)
+{
+    uint8_t mask = 1 << ch;
+    uint8_t restart = v->trigger || (hw_reload & mask);
+    uint8_t duty = v->duty << 6, env;
+    uint16_t period;
+
+    if (v->note == MUSIC_CMD_REST) {
+        env = 0;
+    } else if (ch == MUSIC_CH_WAVE) {
+        env = wave_level(v->volume);
+    } else {
+        env = AUDENV_VOL(v->volume);
+    }
+
+    if (hw_reload & mask) {
+        hw_duty[ch] = ~duty;
+        hw_env[ch] = ~env;
+        hw_period[ch] = 0xFFFF;
+        hw_reload &= ~mask;
+    }
+
+    /* A new volume only takes effect when the channel restarts */
+    if (env != hw_env[ch]) {
+        hw_env[ch] = env;
+        restart = 1;
+        switch (ch) {
+            case MUSIC_CH_PULSE1: NR12_REG = env; break;
+            case MUSIC_CH_PULSE2: NR22_REG = env; break;
+            case MUSIC_CH_WAVE:   NR30_REG = (env) ? 0x80 : 0; NR32_REG = env; break;
+            default:              NR42_REG = env; break;
+        }
+    }
+    if (!env) return;
+
+    if (ch == MUSIC_CH_NOISE) {
+        /* Pitch as the clock shift, bit 3 is the 7 bit counter */
+        period = ((v->note & 0x07) << 5) | (v->note & 0x08);
+        if ((uint8_t)period != (uint8_t)hw_period[ch]) NR43_REG = (uint8_t)period;
+        if (restart) NR44_REG = AUDHIGH_RESTART;
+        hw_period[ch] = period;
+        return;
+    }
+
+    if (ch != MUSIC_CH_WAVE) {
+        if (duty != hw_duty[ch]) {
+            hw_duty[ch] = duty;
+            if (ch) NR21_REG = duty; else NR11_REG = duty;
+        }
+        period = periods[v->note];
+    } else {
+        /* Channel 3 plays at half the rate of a square wave with the same period */
+        period = 1024 + (periods[v->note] >> 1);
+    }
+
+    if (restart || ((uint8_t)period != (uint8_t)hw_period[ch])) {
+        switch (ch) {
+            case MUSIC_CH_PULSE1: NR13_REG = (uint8_t)period; break;
+            case MUSIC_CH_PULSE2: NR23_REG = (uint8_t)period; break;
+            default:              NR33_REG = (uint8_t)period; break;
+        }
+    }
+    if (restart || ((period >> 8) != (hw_period[ch] >> 8))) {
+        env = (uint8_t)(period >> 8) | ((restart) ? AUDHIGH_RESTART : 0);
+        switch (ch) {
+            case MUSIC_CH_PULSE1: NR14_REG = env; break;
+            case MUSIC_CH_PULSE2: NR24_REG = env; break;
+            default:              NR34_REG = env; break;
+        }
+    }
+    hw_period[ch] = period;
+}
+
+void music_play(const music_song_t * song, uint8_t bank)
+{
+    uint8_t save_bank = CURRENT_BANK, ch;
+
+    CRITICAL {
+        NR10_REG = 0;
+        NR30_REG = 0;
+        for (ch = 0; ch != sizeof(triangle_wave); ch++) AUD3WAVE[ch] = triangle_wave[ch];
+        if (bank) SWITCH_ROM(bank);
+        for (ch = 0; ch != MUSIC_CHANNELS; ch++) {
+            if (song->channels[ch]) voice_start(song_voices + ch, song->channels[ch], bank);
+            else {
+                song_voices[ch].start = NULL;
+                song_voices[ch].note = MUSIC_CMD_REST;
+            }
+        }
+        SWITCH_ROM(save_bank);
+        hw_reload = (1 << MUSIC_CHANNELS) - 1;
+    }
+}
+
+void music_stop(void)
+{
+    uint8_t ch;
+
+    CRITICAL {
+        for (ch = 0; ch != MUSIC_CHANNELS; ch++) {
+            song_voices[ch].start = NULL;
+            song_voices[ch].note = MUSIC_CMD_REST;
+            if (!sfx_voices[ch].start) hw_write(ch, song_voices + ch);
+        }
+    }
+}
+
+void music_sfx_play(const uint8_t * stream, uint8_t bank, uint8_t channel)
+{
+    CRITICAL {
+        voice_start(sfx_voices + channel, stream, bank);
+    }
+}
+
+uint8_t music_playing(void)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch != MUSIC_CHANNELS; ch++)
+        if (song_voices[ch].start) return 1;
+    return 0;
+}
+
+void music_update(void)
+{
+    uint8_t save_bank = CURRENT_BANK, ch;
+    voice_t * song = song_voices, * sfx = sfx_voices;
+
+    for (ch = 0; ch != MUSIC_CHANNELS; ch++, song++, sfx++) {
+        if (song->start) {
+            if (song->bank) SWITCH_ROM(song->bank);
+            voice_step(song);
+        }
+        if (sfx->start) {
+            if (sfx->bank) SWITCH_ROM(sfx->bank);
+            voice_step(sfx);
+            if (sfx->start) {
+                hw_write(ch, sfx);
+                continue;
+            }
+            /* The effect ended: the song takes the channel back */
+            hw_reload |= 1 << ch;
+            song->trigger = 1;
+        }
+        hw_write(ch, song);
+    }
+    SWITCH_ROM(save_bank);
+}
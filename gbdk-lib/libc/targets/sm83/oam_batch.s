@@ -0,0 +1,75 @@
+        .include    "global.s"
+
+        .title  "Sprites"
+        .module OAMBatch
+
+        .globl  ___render_shadow_OAM
+
+        .area   _HOME
+
+; void move_sprites(uint8_t first, uint8_t count, const uint8_t * xy)
+;A: first
+;E: count
+;sp+2: xy, the x and y of each sprite
+_move_sprites::
+        add     a
+        add     a
+        ld      c, a
+        ld      a, (___render_shadow_OAM)
+        ld      b, a            ; BC = &OAM[first]
+        ldhl    sp, #2
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a            ; HL = xy
+        inc     e
+        jr      2$
+1$:
+        ld      a, (hl+)        ; x
+        ld      d, a
+        ld      a, (hl+)        ; y
+        ld      (bc), a
+        inc     c
+        ld      a, d
+        ld      (bc), a
+        inc     c               ; skip tile and props
+        inc     c
+        inc     c
+2$:
+        dec     e
+        jr      nz, 1$
+
+        ;; Remove xy from the stack
+        pop     hl
+        pop     af
+        jp      (hl)
+
+; void shadow_oam_write_block(uint8_t first, uint8_t count, const OAM_item_t * src)
+;A: first
+;E: count
+;sp+2: src
+_shadow_oam_write_block::
+        add     a
+        add     a
+        ld      c, a
+        ld      a, (___render_shadow_OAM)
+        ld      b, a            ; BC = &OAM[first]
+        ldhl    sp, #2
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a            ; HL = src
+        inc     e
+        jr      2$
+1$:
+        .rept 4
+        ld      a, (hl+)
+        ld      (bc), a
+        inc     c
+        .endm
+2$:
+        dec     e
+        jr      nz, 1$
+
+        ;; Remove src from the stack
+        pop     hl
+        pop     af
+        jp      (hl)
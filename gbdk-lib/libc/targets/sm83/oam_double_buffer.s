@@ -0,0 +1,80 @@
+        .include    "global.s"
+
+        ;; Shadow OAM double buffering
+        ;;
+        ;; The VBlank handler DMAs the page in __shadow_OAM_base, the
+        ;; metasprite functions render into the page in ___render_shadow_OAM.
+        ;; A swap shows the finished page by writing __shadow_OAM_base, which
+        ;; is a single byte so the VBlank handler always sees either the old
+        ;; or the new page, never a page which is half way through an update.
+
+        .title  "OAMDoubleBuffer"
+        .module OAMDoubleBuffer
+
+        .globl  ___render_shadow_OAM
+
+        .area   _INITIALIZED
+.oam_double_buffer_xor:         ; MSB of shadow_OAM ^ MSB of the second buffer, 0 when disabled
+        .ds     0x01
+
+        .area   _INITIALIZER
+        .db     0x00
+
+        .area   _CODE
+
+; void oam_double_buffer_enable(void * buffer)
+; de: buffer, 256-byte aligned
+
+_oam_double_buffer_enable::
+        ld      hl, #_shadow_OAM
+        ld      e, l
+        call    .oam_double_buffer_copy
+        ld      a, d
+        ld      (___render_shadow_OAM), a
+        xor     #>_shadow_OAM
+        ld      (.oam_double_buffer_xor), a
+        ret
+
+; void oam_double_buffer_swap(void)
+
+_oam_double_buffer_swap::
+        ld      hl, #___render_shadow_OAM
+        ld      a, (hl)
+        ldh     (__shadow_OAM_base), a  ; Shown from the next VBlank on
+        ld      a, (.oam_double_buffer_xor)
+        xor     (hl)
+        ld      (hl), a                 ; Render into the other page
+        ret
+
+; void oam_double_buffer_disable(void)
+
+_oam_double_buffer_disable::
+        ;; keep the sprites which are on screen
+        ldh     a, (__shadow_OAM_base)
+        cp      #>_shadow_OAM
+        jr      z, 1$
+        or      a
+        jr      z, 1$
+        ld      h, a
+        ld      l, #0
+        ld      de, #_shadow_OAM
+        call    .oam_double_buffer_copy
+        ld      a, #>_shadow_OAM
+        ldh     (__shadow_OAM_base), a
+1$:
+        xor     a
+        ld      (.oam_double_buffer_xor), a
+        ld      a, #>_shadow_OAM
+        ld      (___render_shadow_OAM), a
+        ret
+
+; Copies 40 OAM entries from hl to de, both 256-byte aligned
+.oam_double_buffer_copy:
+        ld      c, #(40 * 4)
+1$:
+        ld      a, (hl+)
+        ld      (de), a
+        inc     e
+        dec     c
+        jr      nz, 1$
+        ret
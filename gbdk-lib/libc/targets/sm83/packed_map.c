@@ -0,0 +1,141 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/cgb.h>
+#include <gb/gbdecompress.h>
+#include <gbdk/rledecompress.h>
+#include <gbdk/packed_map.h>
+
+#define PM_TILE_SIZE 16
+#define PM_CHUNK     128 /* Tiles or bytes per call, counts are 8 bit */
+
+static uint8_t pm_buf[DEVICE_SCREEN_BUFFER_WIDTH];
+
+/* Loads n tiles at first, from the current VRAM bank */
+static void pm_load_tiles(const packed_map_section_t * s, const uint8_t * src, uint8_t first)
+{
+    uint16_t n = s->size / PM_TILE_SIZE;
+    uint8_t count;
+
+    if (s->compression == PACKED_MAP_GB) {
+        gb_decompress_bkg_data(first, src);
+    } else if (s->compression == PACKED_MAP_RLE) {
+        rle_init((void *)src);
+        for (; n; n--) {
+            rle_decompress(pm_buf, PM_TILE_SIZE);
+            set_bkg_data(first++, 1, pm_buf);
+        }
+    } else {
+        for (; n; n -= count) {
+            count = (n > PM_CHUNK) ? PM_CHUNK : n;
+            set_bkg_data(first, count, src);
+            first += count;
+            src += count * PM_TILE_SIZE;
+        }
+    }
+}
+
+/* Draws a map or attribute section at 0, 0 of the current VRAM bank */
+static void pm_draw_map(const packed_map_header_t * hdr, const packed_map_section_t * s, const uint8_t * src)
+{
+    uint8_t w = hdr->map_w, h = hdr->map_h;
+    uint8_t y;
+
+    if (s->compression == PACKED_MAP_RLE) {
+        rle_init((void *)src);
+        for (y = 0; y < h; y++) {
+            rle_decompress(pm_buf, w);
+            set_bkg_tiles(0, y, w, 1, pm_buf);
+        }
+    } else
+        set_bkg_tiles(0, 0, w, h, src);
+}
+
+/* Decompresses a map or attribute section into dest */
+static void pm_unpack(const packed_map_section_t * s, const uint8_t * src, uint8_t * dest)
+{
+    uint16_t n = s->size;
+    uint8_t count;
+
+    if (s->compression == PACKED_MAP_GB) {
+        gb_decompress(src, dest);
+    } else if (s->compression == PACKED_MAP_RLE) {
+        rle_init((void *)src);
+        for (; n; n -= count) {
+            count = (n > PM_CHUNK) ? PM_CHUNK : n;
+            rle_decompress(dest, count);
+            dest += count;
+        }
+    } else
+        memcpy(dest, src, n);
+}
+
+/* Returns PACKED_MAP_OK if every section can be loaded */
+static uint8_t pm_check(const packed_map_header_t * hdr, const packed_map_section_t * s, uint8_t * map_buf)
+{
+    uint8_t i;
+
+    if ((hdr->magic[0] != PACKED_MAP_MAGIC_0) || (hdr->magic[1] != PACKED_MAP_MAGIC_1) ||
+        (hdr->version != PACKED_MAP_VERSION) || (hdr->flags & PACKED_MAP_INTERLEAVED))
+        return PACKED_MAP_ERR_FORMAT;
+
+    for (i = 0; i < hdr->section_count; i++, s++) {
+        if ((s->type < PACKED_MAP_SECTION_TILES) || (s->type > PACKED_MAP_SECTION_PALETTES) || (s->compression > PACKED_MAP_RLE))
+            return PACKED_MAP_ERR_FORMAT;
+        if ((s->type == PACKED_MAP_SECTION_PALETTES) && (s->compression != PACKED_MAP_NONE))
+            return PACKED_MAP_ERR_FORMAT;
+        if (((s->type == PACKED_MAP_SECTION_MAP) || (s->type == PACKED_MAP_SECTION_ATTRIBUTES)) && (map_buf == NULL) &&
+            ((s->compression == PACKED_MAP_GB) || (hdr->flags & PACKED_MAP_TRANSPOSED) ||
+             (hdr->map_w > DEVICE_SCREEN_BUFFER_WIDTH) || (hdr->map_h > DEVICE_SCREEN_BUFFER_HEIGHT)))
+            return PACKED_MAP_ERR_BUF;
+    }
+    return PACKED_MAP_OK;
+}
+
+uint8_t load_packaged_map(const uint8_t * data, uint8_t * map_buf)
+{
+    const packed_map_header_t * hdr = (const packed_map_header_t *)data;
+    const packed_map_section_t * s = (const packed_map_section_t *)(hdr + 1);
+    const uint8_t * src;
+    uint8_t cgb = (_cpu == CGB_TYPE);
+    uint8_t ret, i;
+
+    if ((ret = pm_check(hdr, s, map_buf)) != PACKED_MAP_OK)
+        return ret;
+
+    for (i = 0; i < hdr->section_count; i++, s++) {
+        src = data + s->offset;
+        switch (s->type) {
+            case PACKED_MAP_SECTION_TILES:
+                pm_load_tiles(s, src, hdr->first_tile);
+                break;
+            case PACKED_MAP_SECTION_TILES_BANK1:
+                if (cgb) {
+                    VBK_REG = VBK_BANK_1;
+                    pm_load_tiles(s, src, hdr->first_tile);
+                    VBK_REG = VBK_BANK_0;
+                }
+                break;
+            case PACKED_MAP_SECTION_MAP:
+                if (map_buf)
+                    pm_unpack(s, src, map_buf);
+                else
+                    pm_draw_map(hdr, s, src);
+                break;
+            case PACKED_MAP_SECTION_ATTRIBUTES:
+                if (map_buf)
+                    pm_unpack(s, src, map_buf + (hdr->map_w * hdr->map_h));
+                else if (cgb) {
+                    VBK_REG = VBK_ATTRIBUTES;
+                    pm_draw_map(hdr, s, src);
+                    VBK_REG = VBK_TILES;
+                }
+                break;
+            case PACKED_MAP_SECTION_PALETTES:
+                if (cgb)
+                    set_bkg_palette(0, hdr->palette_count, (palette_color_t *)src);
+                break;
+        }
+    }
+    return PACKED_MAP_OK;
+}
@@ -54,6 +54,45 @@ _joypad::
 	LD	A,E
 	RET
 
+	;; Read the joypad once per frame for joypad_pressed() and the
+	;; other accessors in gb.h, for example from the VBL handler.
+	;; A button has to read the same twice in a row before it
+	;; changes state, masking contact bounce.
+_joypad_update_debounce::
+	CALL	.jpad
+	LD	E,A
+	LDH	A,(__joypad_raw)
+	XOR	E		; Bits which differ from the last read
+	LD	D,A
+	LD	A,E
+	LDH	(__joypad_raw),A
+	LDH	A,(__joypad_cur)
+	XOR	E
+	AND	D
+	XOR	E		; Those keep their state, the others are the new read
+	LD	E,A
+	JR	.joypad_edges
+
+	;; Read the joypad once per frame for joypad_pressed() and the
+	;; other accessors in gb.h, for example from the VBL handler
+_joypad_update::
+	CALL	.jpad
+	LD	E,A
+.joypad_edges:
+	LDH	A,(__joypad_cur)
+	LDH	(__joypad_prev),A
+	LD	D,A
+	CPL
+	AND	E		; Down now, up before
+	LDH	(__joypad_pressed),A
+	LD	A,E
+	CPL
+	AND	D		; Up now, down before
+	LDH	(__joypad_released),A
+	LD	A,E
+	LDH	(__joypad_cur),A
+	RET
+
 	;; Wait for the key to be pressed
 _waitpad::
 	LD	D,A
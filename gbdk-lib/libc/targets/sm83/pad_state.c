@@ -0,0 +1,18 @@
+#include <stdint.h>
+#include <gb/gb.h>
+
+/* Edge state of all joypads, see joypad_ex_update() in gb/gb.h */
+
+void joypad_ex_update(joypads_state_t * state)
+{
+    uint8_t i, now, before;
+
+    joypad_ex(&state->pads);
+    for (i = 0; i != state->pads.npads; i++) {
+        now = state->pads.joypads[i];
+        before = state->previous[i];
+        state->pressed[i] = now & ~before;
+        state->released[i] = before & ~now;
+        state->previous[i] = now;
+    }
+}
@@ -0,0 +1,158 @@
+        .include        "global.s"
+
+        .title  "Palette streaming"
+        .module PaletteStream
+
+        ;; CGB palette colors streamed in HBlanks: each LY compare interrupt
+        ;; writes the colors of one table entry over its HBlanks and sets LYC
+        ;; for the next entry
+        ;;
+        ;; Format of each entry (palette_stream_entry_t in gb/palette_stream.h)
+        ;; 0: Line, increasing, 0xFF ends the table
+        ;; 1: BCPS, bit 6 set (PALETTE_STREAM_OBJ) for OCPS
+        ;; 2: Colors per HBlank
+        ;; 3: Number of HBlanks
+        ;; 4: Colors LSB
+        ;; 5: Colors MSB
+        ;;
+        ;; A new table is picked up by the VBL handler, so the table used
+        ;; by the LCD handler never changes in the middle of a frame.
+
+        .PALETTE_STREAM_OBJ     = 6     ; Bit, must match PALETTE_STREAM_OBJ in gb/palette_stream.h
+
+        .area   _DATA
+
+.palette_stream_pending:                ; Set when .palette_stream_next holds a new table
+        .ds     0x01
+.palette_stream_next:
+        .ds     0x02
+.palette_stream_table:                  ; Table of the current frame
+        .ds     0x02
+.palette_stream_ptr:                    ; BCPS of the next entry to stream
+        .ds     0x02
+
+        .area   _HOME
+
+        ;; void palette_stream_set_table(const palette_stream_entry_t * table)
+        ;; DE = table, NULL stops streaming
+_palette_stream_set_table::
+        ld      hl, #.palette_stream_pending
+        xor     a
+        ld      (hl+), a        ; The VBL handler ignores .palette_stream_next while it changes
+        ld      a, e
+        ld      (hl+), a
+        ld      a, d
+        ld      (hl-), a
+        dec     hl
+        ld      (hl), #1
+        ret
+
+        ;; VBL handler: restart the current table or switch to the new one
+_palette_stream_vbl_isr::
+        ld      hl, #.palette_stream_pending
+        ld      a, (hl)
+        or      a
+        jr      z, 1$
+        ld      (hl), #0
+        inc     hl
+        ld      a, (hl+)
+        ld      (.palette_stream_table), a
+        ld      a, (hl)
+        ld      (.palette_stream_table + 1), a
+1$:
+        ld      hl, #.palette_stream_table
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        or      h
+        jr      z, 3$
+
+        ld      a, (hl+)        ; Line of the first entry
+        ld      b, a
+        ld      a, l
+        ld      (.palette_stream_ptr), a
+        ld      a, h
+        ld      (.palette_stream_ptr + 1), a
+        ld      a, b
+        or      a
+        jr      z, 2$
+        dec     a
+        ldh     (.LYC), a
+        ret
+2$:
+        ;; Line 0 gets streamed by the LCD handler right after this one, still in VBlank
+        ldh     a, (.IF)
+        or      #.LCD_IFLAG
+        ldh     (.IF), a
+        ret
+3$:
+        ld      a, #0xFF        ; No table, LY never matches
+        ldh     (.LYC), a
+        ret
+
+        ;; LCD handler for set_LCD_fast(), saves its registers and ends with RETI
+        ;; LYC for the entry after it is set first, then the colors are
+        ;; written once each HBlank (or VBlank) starts
+_palette_stream_lcd_isr::
+        push    af
+        push    hl
+        push    bc
+        push    de
+
+        ld      hl, #.palette_stream_ptr
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        ld      a, (hl+)        ; BCPS
+        ld      c, #.BCPS
+        bit     .PALETTE_STREAM_OBJ, a
+        jr      z, 1$
+        ld      c, #.OCPS
+        and     #~(1 << .PALETTE_STREAM_OBJ)
+1$:
+        ldh     (c), a          ; The index can be written at any time
+        inc     c               ; BCPD or OCPD
+        ld      a, (hl+)
+        ld      d, a            ; D = colors per HBlank
+        ld      a, (hl+)
+        ld      e, a            ; E = HBlanks
+        ld      a, (hl+)
+        ld      b, a
+        ld      a, (hl+)
+        push    af              ; Colors MSB
+
+        ld      a, (hl+)        ; Line of the next entry
+        dec     a               ; LY compare on the line before it, the 0xFF end marker never matches
+        ldh     (.LYC), a
+        ld      a, l
+        ld      (.palette_stream_ptr), a
+        ld      a, h
+        ld      (.palette_stream_ptr + 1), a
+        pop     af
+        ld      h, a
+        ld      l, b            ; HL = colors
+2$:
+        WAIT_STAT
+
+        ld      b, d
+3$:
+        ld      a, (hl+)
+        ldh     (c), a
+        ld      a, (hl+)
+        ldh     (c), a
+        dec     b
+        jr      nz, 3$
+
+        dec     e
+        jr      z, 5$
+4$:
+        ldh     a, (.STAT)      ; Let this HBlank end before waiting for the next one
+        and     #STATF_BUSY
+        jr      z, 4$
+        jr      2$
+5$:
+        pop     de
+        pop     bc
+        pop     hl
+        pop     af
+        reti
@@ -0,0 +1,229 @@
+        .include        "global.s"
+
+        .title  "PCM streaming"
+        .module PCMStream
+
+        ;; 4 bit PCM samples played on channel 3: every timer interrupt
+        ;; reloads wave RAM with the next 32 samples (16 bytes) and starts
+        ;; the channel again.
+        ;;
+        ;; The frame for the next interrupt is prefetched from its ROM bank
+        ;; into .pcm_stream_buf, so the time the DAC is off only covers a copy
+        ;; from WRAM. The timer period matches the length of a frame exactly:
+        ;; channel 3 runs at 2048 - (4 * period) for a rate of 524288 / period,
+        ;; and the timer overflows every period ticks of 16384 Hz.
+        ;;
+        ;; Format of each chunk (pcm_chunk_t in gb/pcm_stream.h)
+        ;; 0: Bank
+        ;; 1: Data LSB
+        ;; 2: Data MSB
+        ;; 3: Frames LSB, 0 ends the sample
+        ;; 4: Frames MSB
+        ;; A frame never crosses the end of a bank, chunks end before it.
+
+        .area   _DATA
+
+.pcm_stream_chunk:                      ; Next chunk
+        .ds     0x02
+.pcm_stream_bank:                       ; Position in the current chunk
+        .ds     0x01
+.pcm_stream_ptr:
+        .ds     0x02
+.pcm_stream_frames:                     ; Frames left in the current chunk
+        .ds     0x02
+.pcm_stream_nr33:                       ; Channel 3 frequency for the rate
+        .ds     0x01
+.pcm_stream_nr34:
+        .ds     0x01
+.pcm_stream_full:                       ; Set when .pcm_stream_buf holds the next frame
+        .ds     0x01
+.pcm_stream_buf:
+        .ds     0x10
+
+_pcm_stream_playing::
+        .ds     0x01
+
+        .area   _HOME
+
+        ;; void pcm_stream_play(const pcm_sample_t * sample)
+        ;; DE = sample
+_pcm_stream_play::
+        xor     a
+        ld      (.pcm_stream_full), a   ; The timer handler leaves everything alone now
+        ld      (_pcm_stream_playing), a
+        ldh     (.NR30), a
+
+        ld      a, (de)                 ; Period, 0 = 256
+        inc     de
+        ld      l, a
+        ld      h, #0
+        or      a
+        jr      nz, 1$
+        inc     h
+1$:
+        ld      c, l                    ; Timer period
+        add     hl, hl
+        add     hl, hl
+        xor     a                       ; Channel 3 frequency = 2048 - (4 * period)
+        sub     l
+        ld      (.pcm_stream_nr33), a
+        ld      a, #0x08
+        sbc     h
+        or      #0x80                   ; Trigger
+        ld      (.pcm_stream_nr34), a
+
+        ;; The timer runs twice as fast in CGB double speed mode
+        ld      a, (__cpu)
+        cp      #.CGB_TYPE
+        jr      nz, 2$
+        ldh     a, (.KEY1)
+        and     #KEY1F_DBLSPEED
+        jr      z, 2$
+        sla     c                       ; Periods over 128 become 256 (0)
+        jr      nc, 2$
+        ld      c, #0
+2$:
+        ld      a, (de)
+        inc     de
+        ld      (.pcm_stream_chunk), a
+        ld      a, (de)
+        ld      (.pcm_stream_chunk + 1), a
+        xor     a
+        ld      (.pcm_stream_frames), a
+        ld      (.pcm_stream_frames + 1), a
+        push    bc
+        call    .pcm_stream_fetch
+        pop     bc
+        ld      a, (.pcm_stream_full)
+        or      a
+        ret     z                       ; Empty sample
+
+        ld      a, #0x20                ; Full volume
+        ldh     (.NR32), a
+        xor     a
+        sub     c
+        ldh     (.TMA), a
+        ldh     (.TIMA), a
+        ld      a, #(TACF_START | TACF_16KHZ)
+        ldh     (.TAC), a
+        ld      a, #1
+        ld      (_pcm_stream_playing), a
+        ret
+
+        ;; void pcm_stream_stop(void)
+_pcm_stream_stop::
+        xor     a
+        ld      (.pcm_stream_full), a
+        ld      (_pcm_stream_playing), a
+        ldh     (.NR30), a
+        ret
+
+        ;; TIM handler for add_low_priority_TIM(): play the prefetched frame,
+        ;; then fetch the one after it with interrupts enabled
+_pcm_stream_isr::
+        ld      a, (.pcm_stream_full)
+        or      a
+        jr      nz, 1$
+        ld      hl, #_pcm_stream_playing
+        or      (hl)
+        ret     z
+        xor     a                       ; The last frame has finished
+        ld      (hl), a
+        ldh     (.NR30), a
+        ret
+1$:
+        di
+        ldh     a, (.NR51)              ; Mute channel 3 while wave RAM changes
+        ld      c, a
+        and     #~(AUDTERM_3_LEFT | AUDTERM_3_RIGHT)
+        ldh     (.NR51), a
+        xor     a
+        ldh     (.NR30), a              ; Wave RAM is only accessible with the DAC off
+
+        ld      hl, #.pcm_stream_buf
+        .irp    ofs,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15
+            ld      a, (hl+)
+            ldh     (_AUD3WAVERAM+ofs), a
+        .endm
+
+        ld      a, #0x80
+        ldh     (.NR30), a
+        ld      a, (.pcm_stream_nr33)
+        ldh     (.NR33), a
+        ld      a, (.pcm_stream_nr34)
+        ldh     (.NR34), a
+        ld      a, c
+        ldh     (.NR51), a
+        ei
+
+        xor     a
+        ld      (.pcm_stream_full), a
+
+        ;; Copy the next frame to .pcm_stream_buf and set .pcm_stream_full,
+        ;; unless the sample has ended
+.pcm_stream_fetch:
+        ld      hl, #.pcm_stream_frames
+        ld      a, (hl+)
+        or      (hl)
+        jr      nz, 2$
+
+        ld      hl, #.pcm_stream_chunk  ; Next chunk
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        ld      de, #.pcm_stream_bank
+        ld      c, #5
+1$:
+        ld      a, (hl+)
+        ld      (de), a
+        inc     de
+        dec     c
+        jr      nz, 1$
+        ld      a, (.pcm_stream_frames)
+        ld      b, a
+        ld      a, (.pcm_stream_frames + 1)
+        or      b
+        ret     z                       ; End of the sample, stays on the last chunk
+        ld      a, l
+        ld      (.pcm_stream_chunk), a
+        ld      a, h
+        ld      (.pcm_stream_chunk + 1), a
+2$:
+        ld      hl, #.pcm_stream_frames
+        ld      a, (hl)
+        sub     #1
+        ld      (hl+), a
+        ld      a, (hl)
+        sbc     #0
+        ld      (hl), a
+
+        ldh     a, (__current_bank)
+        push    af
+        ld      a, (.pcm_stream_bank)
+        ldh     (__current_bank), a     ; Set too, an interrupt may do a banked call
+        ld      (rROMB0), a
+
+        ld      hl, #.pcm_stream_ptr
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        ld      de, #.pcm_stream_buf
+        ld      c, #0x10
+3$:
+        ld      a, (hl+)
+        ld      (de), a
+        inc     de
+        dec     c
+        jr      nz, 3$
+        ld      a, l
+        ld      (.pcm_stream_ptr), a
+        ld      a, h
+        ld      (.pcm_stream_ptr + 1), a
+
+        pop     af
+        ldh     (__current_bank), a
+        ld      (rROMB0), a
+
+        ld      a, #1
+        ld      (.pcm_stream_full), a
+        ret
@@ -10,6 +10,8 @@ rle_counter:
         .ds 0x01
 rle_current:
         .ds 0x01
+rle_bank:
+        .ds 0x01
 
         .area _CODE
 
@@ -25,6 +27,10 @@ _rle_init::
         inc a
         ret
 
+_rle_init_banked::
+        ld (rle_bank), a
+        jr _rle_init
+
 _rle_decompress::
         ld b, a         ; b == count
 
@@ -101,4 +107,127 @@ _rle_decompress::
         ld (hl-), a
         ld (hl), e
         ld a, #1
-        ret             ; return 1
\ No newline at end of file
+        ret             ; return 1
+
+        ;; Banked source version, source data must be in ROM
+        ;; Reads past the end of a switchable ROM bank continue
+        ;; at the start of the next bank
+
+        ;; Load reg from (hl+), moving to the next bank at $8000
+.macro LD_SRC_BANKED reg, ?loc
+        ld reg, (hl)
+        inc hl
+        bit 7, h
+        jr z, loc
+        call .src_next_bank
+loc:
+.endm
+
+        .area _HOME
+
+.src_next_bank:
+        push af
+        ld h, #0x40
+        ldh a, (__current_bank)
+        inc a
+        ldh (__current_bank), a
+        ld (rROMB0), a
+        pop af
+        ret
+
+_rle_decompress_banked::
+        ld b, a         ; b == count
+
+        ldh a, (__current_bank)
+        push af
+        ld a, (rle_bank)
+        ldh (__current_bank), a
+        ld (rROMB0), a
+
+        call .rle_decompress_banked
+        ld b, a
+
+        ;; The source may have moved on to the next bank
+        ldh a, (__current_bank)
+        ld (rle_bank), a
+
+        pop af
+        ldh (__current_bank), a
+        ld (rROMB0), a
+        ld a, b
+        ret
+
+        ;; Same as _rle_decompress with count in b
+.rle_decompress_banked:
+        ld hl, #rle_cursor
+        ld a, (hl+)
+        ld h, (hl)
+        ld l, a         ; hl == cursor
+
+        or h
+        ret z           ; return 0
+
+        ld a, (rle_counter)
+        or a
+        ld c, a
+        jr z, 1$
+
+        ld a, (rle_current)
+        bit 7, c
+        jr nz, 10$
+        jr 11$
+1$:
+        ;; Fetch the run
+        LD_SRC_BANKED c
+        ;; Negative means a run
+        bit 7, c
+        jr z, 2$
+        ;; Expanding a run
+        LD_SRC_BANKED a
+3$:
+        ld (de), a
+        inc de
+
+        dec b
+        jr z, 6$
+10$:
+        inc c
+        jr nz, 3$
+        jr 1$
+2$:
+        ;; Zero means end of a block
+        inc c
+        dec c
+        jr z, 4$
+        ;; Expanding a block
+5$:
+        LD_SRC_BANKED a
+        ld (de), a
+        inc de
+
+        dec b
+        jr z, 6$
+11$:
+        dec c
+        jr nz, 5$
+        jr 1$
+4$:
+        ;; save state and exit
+        ld hl, #rle_cursor
+        xor a
+        ld (hl+), a
+        ld (hl), a
+        ret             ; return 0
+6$:
+        ;; save state and exit
+        ld d, h
+        ld e, l
+        ld hl, #rle_current
+        ld (hl-), a
+        ld a, c
+        ld (hl-), a
+        ld a, d
+        ld (hl-), a
+        ld (hl), e
+        ld a, #1
+        ret             ; return 1
@@ -0,0 +1,19 @@
+#include <stdint.h>
+#include <gbdk/rledecompress.h>
+
+/* Start of a --rle-index record of banked RLE data, see gbdk/rledecompress.h */
+
+#define RLE_SEEK_BANK_SIZE 0x4000u
+
+uint8_t rle_seek_banked(void * data, uint8_t bank, uint16_t offset)
+{
+    /* Whole banks first, so that the address can't overflow */
+    uint16_t addr = (uint16_t)data + (offset & (RLE_SEEK_BANK_SIZE - 1));
+
+    bank += (uint8_t)(offset >> 14);
+    if (addr >= 0x8000u) {
+        addr -= RLE_SEEK_BANK_SIZE;
+        bank++;
+    }
+    return rle_init_banked((void *)addr, bank);
+}
@@ -0,0 +1,154 @@
+        .include        "global.s"
+
+        .title  "Scanline effects"
+        .module ScanlineFX
+
+        ;; Per line register tables: each LY compare interrupt applies one
+        ;; table entry in the HBlank before its line and sets LYC for the next
+        ;;
+        ;; Format of each entry (scanline_fx_entry_t in gb/scanline_fx.h)
+        ;; 0: Line, increasing, 0xFF ends the table
+        ;; 1: SCX
+        ;; 2: SCY
+        ;; 3: WX
+        ;; 4: BGP
+        ;; 5: BCPS, bit 6 set (SCANLINE_FX_NO_COLOR) skips the color
+        ;; 6: Color LSB
+        ;; 7: Color MSB
+        ;;
+        ;; A new table is picked up by the VBL handler, so the table used
+        ;; by the LCD handler never changes in the middle of a frame.
+
+        .SCANLINE_FX_NO_COLOR   = 6     ; Bit, must match SCANLINE_FX_NO_COLOR in gb/scanline_fx.h
+
+        .area   _DATA
+
+.scanline_fx_pending:                   ; Set when .scanline_fx_next holds a new table
+        .ds     0x01
+.scanline_fx_next:
+        .ds     0x02
+.scanline_fx_table:                     ; Table of the current frame
+        .ds     0x02
+.scanline_fx_ptr:                       ; SCX of the next entry to apply
+        .ds     0x02
+
+        .area   _HOME
+
+        ;; void scanline_fx_set_table(const scanline_fx_entry_t * table)
+        ;; DE = table, NULL stops the effect
+_scanline_fx_set_table::
+        ld      hl, #.scanline_fx_pending
+        xor     a
+        ld      (hl+), a        ; The VBL handler ignores .scanline_fx_next while it changes
+        ld      a, e
+        ld      (hl+), a
+        ld      a, d
+        ld      (hl-), a
+        dec     hl
+        ld      (hl), #1
+        ret
+
+        ;; VBL handler: restart the current table or switch to the new one
+_scanline_fx_vbl_isr::
+        ld      hl, #.scanline_fx_pending
+        ld      a, (hl)
+        or      a
+        jr      z, 1$
+        ld      (hl), #0
+        inc     hl
+        ld      a, (hl+)
+        ld      (.scanline_fx_table), a
+        ld      a, (hl)
+        ld      (.scanline_fx_table + 1), a
+1$:
+        ld      hl, #.scanline_fx_table
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        or      h
+        jr      z, 3$
+
+        ld      a, (hl+)        ; Line of the first entry
+        ld      b, a
+        ld      a, l
+        ld      (.scanline_fx_ptr), a
+        ld      a, h
+        ld      (.scanline_fx_ptr + 1), a
+        ld      a, b
+        or      a
+        jr      z, 2$
+        dec     a
+        ldh     (.LYC), a
+        ret
+2$:
+        ;; Line 0 gets applied by the LCD handler right after this one, still in VBlank
+        ldh     a, (.IF)
+        or      #.LCD_IFLAG
+        ldh     (.IF), a
+        ret
+3$:
+        ld      a, #0xFF        ; No table, LY never matches
+        ldh     (.LYC), a
+        ret
+
+        ;; LCD handler for set_LCD_fast(), saves its registers and ends with RETI
+        ;; Applies the next entry once the line before it is in HBlank (or
+        ;; VBlank). LYC for the entry after it is set before waiting, so that
+        ;; the compare of the next line isn't missed.
+_scanline_fx_lcd_isr::
+        push    af
+        push    hl
+        push    bc
+        push    de
+
+        ld      hl, #.scanline_fx_ptr
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        ld      a, (hl+)
+        ld      b, a            ; SCX
+        ld      a, (hl+)
+        ld      c, a            ; SCY
+        ld      a, (hl+)
+        ld      d, a            ; WX
+        ld      a, (hl+)
+        ld      e, a            ; BGP
+        push    hl              ; BCPS and color
+
+        inc     hl
+        inc     hl
+        inc     hl
+        ld      a, (hl+)        ; Line of the next entry
+        dec     a               ; LY compare on the line before it, the 0xFF end marker never matches
+        ldh     (.LYC), a
+        ld      a, l
+        ld      (.scanline_fx_ptr), a
+        ld      a, h
+        ld      (.scanline_fx_ptr + 1), a
+        pop     hl
+
+        WAIT_STAT
+
+        ld      a, b
+        ldh     (.SCX), a
+        ld      a, c
+        ldh     (.SCY), a
+        ld      a, d
+        ldh     (.WX), a
+        ld      a, e
+        ldh     (.BGP), a
+
+        ld      a, (hl+)
+        bit     .SCANLINE_FX_NO_COLOR, a
+        jr      nz, 1$
+        ldh     (.BCPS), a
+        ld      a, (hl+)
+        ldh     (.BCPD), a
+        ld      a, (hl)
+        ldh     (.BCPD), a
+1$:
+        pop     de
+        pop     bc
+        pop     hl
+        pop     af
+        reti
@@ -0,0 +1,109 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gb/serial_link.h>
+
+/* Packets over the link cable, the byte transfers are in serial_link.s */
+
+#define SERIAL_LINK_SYNC     0xA5u  /* Must match .SERIAL_LINK_SYNC in serial_link.s */
+#define SERIAL_LINK_IDLE     0x66u  /* .DT_IDLE */
+#define SERIAL_LINK_BUF_MASK (SERIAL_LINK_BUF_SIZE - 1)
+
+extern uint8_t __serial_link_tx_buf[SERIAL_LINK_BUF_SIZE];
+extern uint8_t __serial_link_rx_buf[SERIAL_LINK_BUF_SIZE];
+extern volatile uint8_t __serial_link_tx_head, __serial_link_tx_tail;
+extern volatile uint8_t __serial_link_rx_head, __serial_link_rx_tail;
+extern volatile uint8_t __serial_link_rx_state, __serial_link_rx_left;
+extern volatile uint8_t __serial_link_sc;
+
+/* CRC8 with polynomial 0x07 */
+static uint8_t serial_link_crc8(uint8_t crc, uint8_t data)
+{
+    uint8_t i;
+
+    crc ^= data;
+    for (i = 8; i; i--) {
+        crc = (crc & 0x80u) ? (uint8_t)((crc << 1) ^ 0x07u) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+/* The master starts a transfer when none is running, so that it
+   sends what was queued and gets the packets of the slave */
+static void serial_link_poll(void)
+{
+    CRITICAL {
+        if ((__serial_link_sc & SIOF_CLOCK_INT) && !(SC_REG & SIOF_XFER_START) && !(IF_REG & SIO_IFLAG)) {
+            SC_REG = __serial_link_sc;
+        }
+    }
+}
+
+void serial_link_init(uint8_t mode)
+{
+    CRITICAL {
+        __serial_link_sc = SERIAL_LINK_OFF;
+        SC_REG = SIOF_CLOCK_EXT;
+        IF_REG &= ~SIO_IFLAG;
+        __serial_link_tx_head = __serial_link_tx_tail = 0;
+        __serial_link_rx_head = __serial_link_rx_tail = 0;
+        __serial_link_rx_state = __serial_link_rx_left = 0;
+        serial_link_dropped = 0;
+        if (mode != SERIAL_LINK_OFF) {
+            SB_REG = SERIAL_LINK_IDLE;
+            __serial_link_sc = mode;
+            if (mode == SERIAL_LINK_SLAVE) SC_REG = mode;
+        }
+    }
+}
+
+uint8_t serial_link_send(const void * data, uint8_t len)
+{
+    const uint8_t * src = data;
+    uint8_t head = __serial_link_tx_head, crc;
+
+    if ((len == 0) || (len > SERIAL_LINK_PACKET_MAX)) return FALSE;
+    if ((uint8_t)((__serial_link_tx_tail - head - 1) & SERIAL_LINK_BUF_MASK) < (uint8_t)(len + SERIAL_LINK_PACKET_OVERHEAD)) return FALSE;
+
+    __serial_link_tx_buf[head] = SERIAL_LINK_SYNC;
+    head = (head + 1) & SERIAL_LINK_BUF_MASK;
+    __serial_link_tx_buf[head] = len;
+    head = (head + 1) & SERIAL_LINK_BUF_MASK;
+    crc = serial_link_crc8(0, len);
+    do {
+        crc = serial_link_crc8(crc, *src);
+        __serial_link_tx_buf[head] = *src++;
+        head = (head + 1) & SERIAL_LINK_BUF_MASK;
+    } while (--len);
+    __serial_link_tx_buf[head] = crc;
+    /* The whole packet becomes visible to the interrupt handler at once */
+    __serial_link_tx_head = (head + 1) & SERIAL_LINK_BUF_MASK;
+
+    serial_link_poll();
+    return TRUE;
+}
+
+uint8_t serial_link_receive(void * data)
+{
+    uint8_t * dst;
+    uint8_t tail = __serial_link_rx_tail, len, crc, i;
+
+    serial_link_poll();
+
+    /* Each packet in the buffer is the length, the payload and the CRC */
+    while (tail != __serial_link_rx_head) {
+        len = __serial_link_rx_buf[tail];
+        if ((uint8_t)((__serial_link_rx_head - tail) & SERIAL_LINK_BUF_MASK) < (uint8_t)(len + 2)) break;
+        crc = serial_link_crc8(0, len);
+        tail = (tail + 1) & SERIAL_LINK_BUF_MASK;
+        dst = data;
+        for (i = len; i; i--) {
+            crc = serial_link_crc8(crc, *dst++ = __serial_link_rx_buf[tail]);
+            tail = (tail + 1) & SERIAL_LINK_BUF_MASK;
+        }
+        crc ^= __serial_link_rx_buf[tail];
+        __serial_link_rx_tail = tail = (tail + 1) & SERIAL_LINK_BUF_MASK;
+        if (crc == 0) return len;
+        serial_link_dropped++;
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+        .include        "global.s"
+
+        .title  "Serial link"
+        .module SerialLink
+
+        ;; Packet transport over the link cable, see gb/serial_link.h
+        ;;
+        ;; Packets are sent as SYNC, length, payload, CRC8 of length and payload.
+        ;; Bytes outside of packets are .DT_IDLE. The receive buffer only gets
+        ;; the length, payload and CRC of packets which fit into it completely,
+        ;; every byte of the send buffer is a part of a packet.
+        ;; Only the game advances the send head and the receive tail,
+        ;; only the interrupt handler advances the send tail and the receive head.
+
+        .SERIAL_LINK_SYNC       = 0xA5  ; Must match SERIAL_LINK_SYNC in serial_link.c
+        .SERIAL_LINK_BUF_MASK   = 0x7F  ; SERIAL_LINK_BUF_SIZE - 1
+        .SERIAL_LINK_PACKET_MAX = 32    ; Must match SERIAL_LINK_PACKET_MAX in gb/serial_link.h
+
+        ;; Receive states
+        .SERIAL_LINK_RX_SYNC    = 0     ; Waiting for SYNC
+        .SERIAL_LINK_RX_LENGTH  = 1     ; Length comes next
+        .SERIAL_LINK_RX_STORE   = 2     ; Storing the rest of the packet
+        .SERIAL_LINK_RX_DROP    = 3     ; Skipping the rest of the packet
+
+        .area   _DATA
+
+___serial_link_tx_buf::
+        .ds     0x80
+___serial_link_rx_buf::
+        .ds     0x80
+___serial_link_tx_head::
+        .ds     0x01
+___serial_link_tx_tail::
+        .ds     0x01
+___serial_link_rx_head::
+        .ds     0x01
+___serial_link_rx_tail::
+        .ds     0x01
+___serial_link_rx_state::
+        .ds     0x01
+___serial_link_rx_left::                ; Bytes of the packet still to come
+        .ds     0x01
+___serial_link_sc::                     ; SC value which starts a transfer, 0 when off
+        .ds     0x01
+_serial_link_dropped::
+        .ds     0x01
+
+        .area   _HOME
+
+_serial_link_isr::
+        ld      a, (___serial_link_sc)
+        or      a
+        ret     z                       ; Link is off
+        ld      e, a                    ; E = SC value which starts a transfer
+        ldh     a, (.SB)
+        ld      b, a                    ; B = received byte
+
+        ;; Load the next byte to send, IDLE when there is none
+        ld      d, #0                   ; D = 1 when a packet byte is sent next
+        ld      a, (___serial_link_tx_head)
+        ld      c, a
+        ld      a, (___serial_link_tx_tail)
+        cp      c
+        ld      c, a
+        ld      a, #.DT_IDLE
+        jr      z, 1$
+        ld      a, c
+        inc     a
+        and     #.SERIAL_LINK_BUF_MASK
+        ld      (___serial_link_tx_tail), a
+        ld      a, c
+        add     #<___serial_link_tx_buf
+        ld      l, a
+        adc     #>___serial_link_tx_buf
+        sub     l
+        ld      h, a
+        ld      a, (hl)
+        inc     d
+1$:
+        ldh     (.SB), a
+
+        ;; The slave gets ready for the next byte right away, the
+        ;; master only starts it at the end of its handler
+        bit     0, e                    ; Internal clock: master
+        jr      nz, 2$
+        ld      a, e
+        ldh     (.SC), a
+2$:
+        ;; Receive
+        ld      a, (___serial_link_rx_state)
+        or      a
+        jr      nz, 3$
+
+        ;; .SERIAL_LINK_RX_SYNC
+        ld      a, b
+        cp      #.SERIAL_LINK_SYNC
+        jr      nz, .serial_link_next
+        ld      a, #.SERIAL_LINK_RX_LENGTH
+        jr      .serial_link_set_state
+3$:
+        dec     a
+        jr      nz, 6$
+
+        ;; .SERIAL_LINK_RX_LENGTH: must be 1 to .SERIAL_LINK_PACKET_MAX
+        ld      a, b
+        dec     a
+        cp      #.SERIAL_LINK_PACKET_MAX
+        jr      c, 4$
+        xor     a                       ; Not a packet, wait for the next SYNC
+        jr      .serial_link_set_state
+4$:
+        inc     a
+        ld      (___serial_link_rx_left), a ; Payload and CRC
+        ;; Free space = (tail - head - 1) & mask, the packet needs length + 2
+        ld      a, (___serial_link_rx_head)
+        ld      c, a
+        ld      a, (___serial_link_rx_tail)
+        sub     c
+        dec     a
+        and     #.SERIAL_LINK_BUF_MASK
+        sub     b
+        jr      c, 5$
+        sub     #2
+        jr      c, 5$
+        ld      a, #.SERIAL_LINK_RX_STORE
+        ld      (___serial_link_rx_state), a
+        jr      .serial_link_store
+5$:
+        ld      hl, #_serial_link_dropped
+        inc     (hl)
+        ld      a, #.SERIAL_LINK_RX_DROP
+        jr      .serial_link_set_state
+6$:
+        ;; .SERIAL_LINK_RX_STORE / .SERIAL_LINK_RX_DROP
+        ld      c, a                    ; C = 1 to store, 2 to drop
+        ld      hl, #___serial_link_rx_left
+        dec     (hl)
+        jr      nz, 7$
+        xor     a
+        ld      (___serial_link_rx_state), a
+7$:
+        dec     c
+        jr      nz, .serial_link_next
+.serial_link_store:
+        ld      a, (___serial_link_rx_head)
+        ld      c, a
+        add     #<___serial_link_rx_buf
+        ld      l, a
+        adc     #>___serial_link_rx_buf
+        sub     l
+        ld      h, a
+        ld      (hl), b
+        ld      a, c
+        inc     a
+        and     #.SERIAL_LINK_BUF_MASK
+        ld      (___serial_link_rx_head), a
+        jr      .serial_link_next
+
+.serial_link_set_state:
+        ld      (___serial_link_rx_state), a
+.serial_link_next:
+        ;; The master goes on while either side is in a packet
+        bit     0, e                    ; Internal clock: master
+        ret     z
+        ld      a, (___serial_link_rx_state)
+        or      d
+        ret     z
+        ld      a, e
+        ldh     (.SC), a
+        ret
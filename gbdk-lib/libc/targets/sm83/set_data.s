@@ -14,9 +14,15 @@ _set_win_data::
         jr z, .copy_tiles
 _set_sprite_data::
         ld d, #0x80
-.copy_tiles:
+.copy_tiles::
+        ; With the LCD off VRAM is always accessible, skip the STAT checks
+        ldh a, (.LCDC)
+        and #LCDCF_ON
+.copy_tiles_mode:
+        ; Z = copy without waiting for STAT
         push bc
-        ldhl sp, #4
+        push af
+        ldhl sp, #6
         ld a, (hl+) ; ID of 1st tile
         ld e, a
         ld a, (hl+) ; Nb of tiles
@@ -34,6 +40,9 @@ _set_sprite_data::
         ld a, e
         and #0xF0 ; Get low bits only
         ld e, a
+
+        pop af
+        jr z, 4$
 2$:
         ; Wrap from past $97FF to $8800 onwards
         ; This can be reduced to "bit 4 must be clear if bit 3 is set"
@@ -55,4 +64,38 @@ _set_sprite_data::
         jr nz, 2$
         
         pop bc
-        ret
\ No newline at end of file
+        ret
+
+4$:
+        ; Same wrap as above
+        bit 3, d
+        jr z, 5$
+        res 4, d
+5$:
+        ; Unrolled, tiles are 16 byte aligned so only the last byte can carry into D
+        .rept 15
+        ld a, (hl+)
+        ld (de), a
+        inc e
+        .endm
+        ld a, (hl+)
+        ld (de), a
+        inc de
+
+        dec c
+        jr nz, 4$
+
+        pop bc
+        ret
+
+_set_bkg_data_nowait::
+_set_win_data_nowait::
+        ld d, #0x90
+        ldh a, (.LCDC)
+        and #LCDCF_BG8000
+        jr z, .copy_tiles_nowait
+_set_sprite_data_nowait::
+        ld d, #0x80
+.copy_tiles_nowait:
+        xor a
+        jp .copy_tiles_mode
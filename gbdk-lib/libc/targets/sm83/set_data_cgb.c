@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+/* Tiles for both CGB VRAM banks (png2asset _tiles and _tiles_bank1),
+   a count of 256 goes to set_bkg_data() as 0, which copies 256 tiles */
+void set_bkg_data_cgb(uint8_t first_tile, uint16_t nb_tiles, const uint8_t *data, uint16_t nb_tiles_bank1, const uint8_t *data_bank1)
+{
+    if (nb_tiles) set_bkg_data(first_tile, (uint8_t)nb_tiles, data);
+    if (nb_tiles_bank1 && (_cpu == CGB_TYPE)) {
+        VBK_REG = VBK_BANK_1;
+        set_bkg_data(first_tile, (uint8_t)nb_tiles_bank1, data_bank1);
+        VBK_REG = VBK_BANK_0;
+    }
+}
@@ -5,8 +5,8 @@
 
         .area   _DATA
 
-.image_tile_width::
-        .ds     0x01
+.image_tile_width::             ; 16 bit for set_bkg_submap16() / set_win_submap16()
+        .ds     0x02
 
         .area   _INITIALIZED
 
@@ -34,6 +34,8 @@ _set_bkg_submap::
 
         ld      d, #0
         ld      e, a
+        ld      hl, #.image_tile_width + 1
+        ld      (hl), d
         ld      a, c
         MUL_DE_BY_A_RET_HL
         ld      a, b
@@ -121,7 +123,11 @@ _set_bkg_submap::
         jr      nz, 3$
 
         ld      a, (.image_tile_width)
-        ADD_A_REG16 h, l
+        add     l
+        ld      l, a
+        ld      a, (.image_tile_width + 1)
+        adc     h
+        ld      h, a
 
         pop     bc
         pop     de
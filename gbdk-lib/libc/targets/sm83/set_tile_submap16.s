@@ -0,0 +1,82 @@
+        .include        "global.s"
+
+        .title  "Set tile submap with 16 bit map width"
+        .module SetTileSubmap16
+
+        .globl  .image_tile_width, .set_xy_bkg_submap, .set_xy_win_submap
+
+        .area   _HOME
+
+        ;; Sets .image_tile_width and returns the source address in bc, the
+        ;; hardware x, y in de and wh in hl for .set_xy_bkg_submap / .set_xy_win_submap
+        ;; Stack: x, y (16 bit), w, h, map, map_w (16 bit) above the two return addresses
+.submap16_source::
+        ldhl    sp, #12
+        ld      a, (hl+)
+        ld      e, a
+        ld      d, (hl)         ; de = map_w
+        ldhl    sp, #8
+        ld      a, e
+        sub     (hl)
+        ld      (.image_tile_width), a
+        ld      a, d
+        sbc     #0
+        ld      (.image_tile_width + 1), a ; .image_tile_width = map_w - w
+
+        ldhl    sp, #6
+        ld      a, (hl+)
+        ld      c, a
+        ld      b, (hl)         ; bc = y
+
+        ld      hl, #0          ; hl = y * map_w
+1$:
+        srl     b
+        rr      c
+        jr      nc, 2$
+        add     hl, de
+2$:
+        sla     e
+        rl      d
+        ld      a, b
+        or      c
+        jr      nz, 1$
+
+        ld      d, h
+        ld      e, l
+        ldhl    sp, #4
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        add     hl, de          ; hl = y * map_w + x
+        ld      d, h
+        ld      e, l
+        ldhl    sp, #10
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        add     hl, de
+        ld      b, h
+        ld      c, l            ; bc = map + y * map_w + x
+
+        ldhl    sp, #4
+        ld      a, (hl)         ; d = x
+        and     #0x1f
+        ld      d, a
+        ldhl    sp, #6
+        ld      a, (hl)         ; e = y
+        and     #0x1f
+        ld      e, a
+
+        ldhl    sp, #9
+        ld      a, (hl-)        ; a = h
+        ld      h, (hl)         ; h = w
+        ld      l, a            ; l = h
+        ret
+
+_set_bkg_submap16::
+        call    .submap16_source
+        jp      .set_xy_bkg_submap
+
+_set_win_submap16::
+        call    .submap16_source
+        jp      .set_xy_win_submap
@@ -0,0 +1,175 @@
+        .include        "global.s"
+
+        .title  "Set tile submap with attributes"
+        .module SetTileSubmapAttr
+
+        .globl  .image_tile_width, __submap_tile_offset, __cpu
+
+        .area   _DATA
+
+.submap_tile_src:
+        .ds     0x02
+.submap_attr_src:
+        .ds     0x02
+
+        .area   _HOME
+
+; void set_bkg_submap_with_attributes(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *map, const uint8_t *attributes, uint8_t map_w) OLDCALL;
+_set_bkg_submap_with_attributes::
+        ldhl    sp, #10
+        ld      a, (hl)
+        ldhl    sp, #4
+        sub     (hl)
+        ld      (.image_tile_width), a ; .image_tile_width contains corrected width map width
+        add     (hl)
+
+        ld      d, #0
+        ld      e, a
+        ld      hl, #.image_tile_width + 1
+        ld      (hl), d
+        ldhl    sp, #3
+        ld      a, (hl)
+        MUL_DE_BY_A_RET_HL
+        ld      d, h
+        ld      e, l
+        ldhl    sp, #2
+        ld      a, (hl)
+        ADD_A_REG16 d, e        ; de = y * map_w + x
+
+        ldhl    sp, #6
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        add     hl, de
+        ld      a, l
+        ld      (.submap_tile_src), a
+        ld      a, h
+        ld      (.submap_tile_src + 1), a
+
+        ldhl    sp, #8
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        add     hl, de
+        ld      a, l
+        ld      (.submap_attr_src), a
+        ld      a, h
+        ld      (.submap_attr_src + 1), a
+
+        ldhl    sp, #2
+        ld      a, (hl+)        ; d = x
+        and     #0x1f
+        ld      d, a
+        ld      a, (hl+)        ; e = y
+        and     #0x1f
+        ld      e, a
+        ld      a, (hl+)        ; a = w
+        ld      l, (hl)         ; l = h
+        ld      h, a            ; h = w
+        push    hl              ; store wh
+
+        ldh     a, (.LCDC)
+        and     #LCDCF_BG9C00
+        ld      b, #0x98
+        jr      z, 1$
+        ld      b, #0x9c
+1$:
+        swap    e
+        rlc     e
+        ld      a, e
+        and     #0x03
+        add     b
+        ld      b, a
+        ld      a, #0xe0
+        and     e
+        add     d
+        ld      c, a            ; dest bc = 0x9800 or 0x9c00 + 0x20 * y + x
+
+2$:                             ; copy h rows, tiles then attributes
+        push    bc              ; store dest
+
+        xor     a
+        ldh     (.VBK), a
+        ldhl    sp, #3
+        ld      d, (hl)         ; d = w
+        ld      a, (__submap_tile_offset)
+        ld      e, a
+        ld      hl, #.submap_tile_src
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        call    .copy_submap_row
+        ld      a, (.image_tile_width)
+        add     l
+        ld      (.submap_tile_src), a
+        ld      a, (.image_tile_width + 1)
+        adc     h
+        ld      (.submap_tile_src + 1), a
+
+        ld      a, (__cpu)      ; without VRAM bank 1 the attributes would overwrite the tiles
+        cp      #.CGB_TYPE
+        jr      nz, 3$
+
+        pop     bc
+        push    bc
+        ld      a, #1
+        ldh     (.VBK), a
+        ldhl    sp, #3
+        ld      d, (hl)         ; d = w
+        ld      e, #0
+        ld      hl, #.submap_attr_src
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        call    .copy_submap_row
+        ld      a, (.image_tile_width)
+        add     l
+        ld      (.submap_attr_src), a
+        ld      a, (.image_tile_width + 1)
+        adc     h
+        ld      (.submap_attr_src + 1), a
+3$:
+        pop     bc
+
+        ld      a, b            ; next row and wrap around
+        and     #0xfc
+        ld      e, a            ; save high bits
+
+        ld      a, #0x20
+
+        add     c
+        ld      c, a
+        adc     b
+        sub     c
+        and     #0x03
+        or      e               ; restore high bits
+        ld      b, a
+
+        ldhl    sp, #0          ; h--
+        dec     (hl)
+        jr      nz, 2$
+
+        pop     hl
+        xor     a
+        ldh     (.VBK), a
+        ret
+
+        ;; copy d entries from (hl) + e to the tile map row at bc, wrapping around at the end of the row
+.copy_submap_row:
+        WAIT_STAT
+        ld      a, e
+        add     (hl)
+        ld      (bc), a
+        inc     hl
+
+        inc     c               ; inc dest and wrap around
+        ld      a, c
+        and     #0x1f
+        jr      nz, 1$
+        ld      a, c
+        sub     #0x20
+        ld      c, a
+1$:
+        dec     d
+        jr      nz, .copy_submap_row
+        ret
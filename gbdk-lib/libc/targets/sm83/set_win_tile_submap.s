@@ -19,6 +19,8 @@ _set_win_submap::
 
         ld      d, #0
         ld      e, a
+        ld      hl, #.image_tile_width + 1
+        ld      (hl), d
         ld      a, c
         MUL_DE_BY_A_RET_HL
         ld      a, b
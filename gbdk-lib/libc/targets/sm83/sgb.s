@@ -77,7 +77,33 @@ _sgb_transfer::
         JR      Z,6$
 1$:
         PUSH    AF
+        CALL    .sgb_packet
+
+        LD      DE,#8400		; was: 7000
+5$:
+        LDH     A,(.P1)         ; 3 +
+        DEC     DE              ; 2 +
+        LD      A,D             ; 1 +
+        OR      E               ; 1 +
+        JR      NZ,5$           ; 3 = 10 cycles
+
+        POP     AF
+        DEC     A
+        JR      NZ, 1$
+6$:
+        POP     BC
+        RET
+
+        ;; Send the 16 byte packet at DE without waiting after it
+        ;; Used by the SGB queue
+___sgb_packet::
+        LD      H,D
+        LD      L,E
+
+        ;; Send the 16 byte packet at HL, HL points after it on return
+.sgb_packet::
         LD      C,#.P1
+        XOR     A
         LDH     (C),A           ; Send reset
         LD      A,#(.P14 | .P15)
         LDH     (C),A
@@ -111,18 +137,4 @@ _sgb_transfer::
         LDH     A,(C)
         LD      A,#(.P14 | .P15)
         LDH     (C),A
-
-        LD      DE,#8400		; was: 7000
-5$:
-        LDH     A,(.P1)         ; 3 +
-        DEC     DE              ; 2 +
-        LD      A,D             ; 1 +
-        OR      E               ; 1 +
-        JR      NZ,5$           ; 3 = 10 cycles
-
-        POP     AF
-        DEC     A
-        JR      NZ, 1$
-6$:
-        POP     BC
         RET
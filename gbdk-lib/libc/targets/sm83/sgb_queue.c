@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/sgb.h>
+
+/* SGB packets sent from the VBlank handler, see gb/sgb.h */
+
+#define SGB_PACKET_SIZE 16
+#define SGB_QUEUE_MASK  (SGB_QUEUE_SIZE - 1)
+
+/* Sends the packet without the wait after it, in sgb.s */
+void __sgb_packet(const uint8_t * packet);
+
+uint8_t sgb_queue_delay = SGB_QUEUE_DELAY;
+
+static uint8_t sgb_queue_buf[SGB_QUEUE_SIZE][SGB_PACKET_SIZE];
+/* Free running, only the game advances the head and only the handler the tail */
+static volatile uint8_t sgb_queue_head, sgb_queue_tail;
+static volatile uint8_t sgb_queue_timer;
+
+uint8_t sgb_queue_transfer(const uint8_t * packet)
+{
+    uint8_t n = packet[0] & 0x07u, head = sgb_queue_head;
+
+    if ((n == 0) || (n > (uint8_t)(SGB_QUEUE_SIZE - (uint8_t)(head - sgb_queue_tail)))) return FALSE;
+    do {
+        memcpy(sgb_queue_buf[head & SGB_QUEUE_MASK], packet, SGB_PACKET_SIZE);
+        packet += SGB_PACKET_SIZE;
+        head++;
+    } while (--n);
+    sgb_queue_head = head;
+    return TRUE;
+}
+
+void sgb_queue_isr(void)
+{
+    if (sgb_queue_timer) {
+        sgb_queue_timer--;
+    } else if (sgb_queue_tail != sgb_queue_head) {
+        __sgb_packet(sgb_queue_buf[sgb_queue_tail & SGB_QUEUE_MASK]);
+        sgb_queue_tail++;
+        sgb_queue_timer = sgb_queue_delay;
+    }
+}
+
+void sgb_queue_wait(void)
+{
+    while ((sgb_queue_tail != sgb_queue_head) || sgb_queue_timer) vsync();
+}
+
+void sgb_vram_transfer(const uint8_t * packet, const uint8_t * data, uint16_t size)
+{
+    uint8_t row[DEVICE_SCREEN_WIDTH];
+    uint8_t lcdc = LCDC_REG, bgp = BGP_REG, scx = SCX_REG, scy = SCY_REG;
+    uint8_t tile = 0, x, y;
+
+    /* VRAM may still be shown for the transfer before */
+    sgb_queue_wait();
+
+    DISPLAY_OFF;
+    LCDC_REG = LCDCF_OFF | LCDCF_BG8000 | LCDCF_BG9800 | LCDCF_BGON;
+    set_sprite_data_nowait(0, (uint8_t)(size >> 4), data);
+    /* 13 rows of 20 tiles show all 256 of them */
+    for (y = 0; y != 13; y++) {
+        for (x = 0; x != DEVICE_SCREEN_WIDTH; x++) row[x] = tile++;
+        set_bkg_tiles(0, y, DEVICE_SCREEN_WIDTH, 1, row);
+    }
+    BGP_REG = DMG_PALETTE(DMG_WHITE, DMG_LITE_GRAY, DMG_DARK_GRAY, DMG_BLACK);
+    SCX_REG = SCY_REG = 0;
+    DISPLAY_ON;
+
+    while (!sgb_queue_transfer(packet)) vsync();
+    sgb_queue_wait();
+
+    if (!(lcdc & LCDCF_ON)) DISPLAY_OFF;
+    LCDC_REG = lcdc;
+    BGP_REG = bgp;
+    SCX_REG = scx;
+    SCY_REG = scy;
+}
@@ -0,0 +1,159 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/sram.h>
+
+/* SRAM copies and two slot saves, see gb/sram.h */
+
+#define SRAM_ADDR     0xA000u
+
+#define SRAM_OP_READ  0
+#define SRAM_OP_WRITE 1
+#define SRAM_OP_CRC   2
+
+/* CRC-16/CCITT, polynomial 0x1021 */
+static const uint16_t crc16_table[256] = {
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu,
+    0x1231u, 0x0210u, 0x3273u, 0x2252u, 0x52B5u, 0x4294u, 0x72F7u, 0x62D6u,
+    0x9339u, 0x8318u, 0xB37Bu, 0xA35Au, 0xD3BDu, 0xC39Cu, 0xF3FFu, 0xE3DEu,
+    0x2462u, 0x3443u, 0x0420u, 0x1401u, 0x64E6u, 0x74C7u, 0x44A4u, 0x5485u,
+    0xA56Au, 0xB54Bu, 0x8528u, 0x9509u, 0xE5EEu, 0xF5CFu, 0xC5ACu, 0xD58Du,
+    0x3653u, 0x2672u, 0x1611u, 0x0630u, 0x76D7u, 0x66F6u, 0x5695u, 0x46B4u,
+    0xB75Bu, 0xA77Au, 0x9719u, 0x8738u, 0xF7DFu, 0xE7FEu, 0xD79Du, 0xC7BCu,
+    0x48C4u, 0x58E5u, 0x6886u, 0x78A7u, 0x0840u, 0x1861u, 0x2802u, 0x3823u,
+    0xC9CCu, 0xD9EDu, 0xE98Eu, 0xF9AFu, 0x8948u, 0x9969u, 0xA90Au, 0xB92Bu,
+    0x5AF5u, 0x4AD4u, 0x7AB7u, 0x6A96u, 0x1A71u, 0x0A50u, 0x3A33u, 0x2A12u,
+    0xDBFDu, 0xCBDCu, 0xFBBFu, 0xEB9Eu, 0x9B79u, 0x8B58u, 0xBB3Bu, 0xAB1Au,
+    0x6CA6u, 0x7C87u, 0x4CE4u, 0x5CC5u, 0x2C22u, 0x3C03u, 0x0C60u, 0x1C41u,
+    0xEDAEu, 0xFD8Fu, 0xCDECu, 0xDDCDu, 0xAD2Au, 0xBD0Bu, 0x8D68u, 0x9D49u,
+    0x7E97u, 0x6EB6u, 0x5ED5u, 0x4EF4u, 0x3E13u, 0x2E32u, 0x1E51u, 0x0E70u,
+    0xFF9Fu, 0xEFBEu, 0xDFDDu, 0xCFFCu, 0xBF1Bu, 0xAF3Au, 0x9F59u, 0x8F78u,
+    0x9188u, 0x81A9u, 0xB1CAu, 0xA1EBu, 0xD10Cu, 0xC12Du, 0xF14Eu, 0xE16Fu,
+    0x1080u, 0x00A1u, 0x30C2u, 0x20E3u, 0x5004u, 0x4025u, 0x7046u, 0x6067u,
+    0x83B9u, 0x9398u, 0xA3FBu, 0xB3DAu, 0xC33Du, 0xD31Cu, 0xE37Fu, 0xF35Eu,
+    0x02B1u, 0x1290u, 0x22F3u, 0x32D2u, 0x4235u, 0x5214u, 0x6277u, 0x7256u,
+    0xB5EAu, 0xA5CBu, 0x95A8u, 0x8589u, 0xF56Eu, 0xE54Fu, 0xD52Cu, 0xC50Du,
+    0x34E2u, 0x24C3u, 0x14A0u, 0x0481u, 0x7466u, 0x6447u, 0x5424u, 0x4405u,
+    0xA7DBu, 0xB7FAu, 0x8799u, 0x97B8u, 0xE75Fu, 0xF77Eu, 0xC71Du, 0xD73Cu,
+    0x26D3u, 0x36F2u, 0x0691u, 0x16B0u, 0x6657u, 0x7676u, 0x4615u, 0x5634u,
+    0xD94Cu, 0xC96Du, 0xF90Eu, 0xE92Fu, 0x99C8u, 0x89E9u, 0xB98Au, 0xA9ABu,
+    0x5844u, 0x4865u, 0x7806u, 0x6827u, 0x18C0u, 0x08E1u, 0x3882u, 0x28A3u,
+    0xCB7Du, 0xDB5Cu, 0xEB3Fu, 0xFB1Eu, 0x8BF9u, 0x9BD8u, 0xABBBu, 0xBB9Au,
+    0x4A75u, 0x5A54u, 0x6A37u, 0x7A16u, 0x0AF1u, 0x1AD0u, 0x2AB3u, 0x3A92u,
+    0xFD2Eu, 0xED0Fu, 0xDD6Cu, 0xCD4Du, 0xBDAAu, 0xAD8Bu, 0x9DE8u, 0x8DC9u,
+    0x7C26u, 0x6C07u, 0x5C64u, 0x4C45u, 0x3CA2u, 0x2C83u, 0x1CE0u, 0x0CC1u,
+    0xEF1Fu, 0xFF3Eu, 0xCF5Du, 0xDF7Cu, 0xAF9Bu, 0xBFBAu, 0x8FD9u, 0x9FF8u,
+    0x6E17u, 0x7E36u, 0x4E55u, 0x5E74u, 0x2E93u, 0x3EB2u, 0x0ED1u, 0x1EF0u,
+};
+
+static uint16_t sram_crc;
+
+static uint16_t crc16_update(uint16_t crc, const uint8_t * p, uint16_t len)
+{
+    for (; len; len--) crc = (crc << 8) ^ crc16_table[(uint8_t)(crc >> 8) ^ *p++];
+    return crc;
+}
+
+/* Splits [addr, addr + len) at the bank boundaries, SRAM is only enabled while in here */
+static void sram_op(uint8_t * ram, uint32_t addr, uint16_t len, uint8_t op)
+{
+    uint8_t bank = (uint8_t)(addr >> 13), * p;
+    uint16_t ofs = (uint16_t)addr & (SRAM_BANK_SIZE - 1), n;
+
+    ENABLE_RAM;
+    while (len) {
+        n = SRAM_BANK_SIZE - ofs;
+        if (n > len) n = len;
+        SWITCH_RAM(bank);
+        p = (uint8_t *)(SRAM_ADDR + ofs);
+        if (op == SRAM_OP_READ) memcpy(ram, p, n);
+        else if (op == SRAM_OP_WRITE) memcpy(p, ram, n);
+        else sram_crc = crc16_update(sram_crc, p, n);
+        ram += n;
+        len -= n;
+        ofs = 0;
+        bank++;
+    }
+    DISABLE_RAM;
+}
+
+void sram_read(void * dst, uint32_t src, uint16_t len)
+{
+    sram_op(dst, src, len, SRAM_OP_READ);
+}
+
+void sram_write(uint32_t dst, const void * src, uint16_t len)
+{
+    sram_op((uint8_t *)src, dst, len, SRAM_OP_WRITE);
+}
+
+uint16_t sram_crc16(uint32_t src, uint16_t len)
+{
+    sram_crc = 0xFFFFu;
+    sram_op(NULL, src, len, SRAM_OP_CRC);
+    return sram_crc;
+}
+
+/* The CRC covers size and seq of the header (adjacent in save_header_t), then the data */
+static uint16_t save_header_crc(const save_header_t * h)
+{
+    return crc16_update(0xFFFFu, (const uint8_t *)&h->size, sizeof(h->size) + sizeof(h->seq));
+}
+
+static uint8_t save_slot_valid(uint32_t slot, uint16_t size, save_header_t * h)
+{
+    sram_op((uint8_t *)h, slot, sizeof(save_header_t), SRAM_OP_READ);
+    if ((h->magic != SAVE_MAGIC) || (h->size != size)) return FALSE;
+    sram_crc = save_header_crc(h);
+    sram_op(NULL, slot + sizeof(save_header_t), size, SRAM_OP_CRC);
+    return (sram_crc == h->crc);
+}
+
+/* Returns the newest valid slot (its header in h[slot]), or 0xFF if neither is valid */
+static uint8_t save_newest(uint32_t slots, uint16_t size, save_header_t * h)
+{
+    uint8_t a = save_slot_valid(slots, size, &h[0]);
+    uint8_t b = save_slot_valid(slots + SAVE_SLOT_SIZE(size), size, &h[1]);
+
+    if (a && b) return ((int8_t)(h[1].seq - h[0].seq) > 0) ? 1 : 0;
+    if (a) return 0;
+    if (b) return 1;
+    return 0xFF;
+}
+
+uint8_t save_write(uint32_t slots, const void * data, uint16_t size)
+{
+    save_header_t h[2];
+    uint8_t newest = save_newest(slots, size, h), slot, seq = 0;
+    uint32_t addr;
+
+    slot = 0;
+    if (newest != 0xFF) {
+        slot = newest ^ 1;
+        seq = h[newest].seq + 1;
+    }
+    addr = slots + (slot ? SAVE_SLOT_SIZE(size) : 0);
+
+    h[slot].magic = SAVE_MAGIC;
+    h[slot].size = size;
+    h[slot].seq = seq;
+    h[slot].reserved = 0;
+    h[slot].crc = crc16_update(save_header_crc(&h[slot]), data, size);
+
+    /* The slot only becomes valid once its header is written */
+    sram_op((uint8_t *)data, addr + sizeof(save_header_t), size, SRAM_OP_WRITE);
+    sram_op((uint8_t *)&h[slot], addr, sizeof(save_header_t), SRAM_OP_WRITE);
+
+    return save_slot_valid(addr, size, &h[slot ^ 1]);
+}
+
+uint8_t save_read(uint32_t slots, void * data, uint16_t size)
+{
+    save_header_t h[2];
+    uint8_t newest = save_newest(slots, size, h);
+
+    if (newest == 0xFF) return FALSE;
+    sram_op(data, slots + (newest ? SAVE_SLOT_SIZE(size) : 0) + sizeof(save_header_t), size, SRAM_OP_READ);
+    return TRUE;
+}
@@ -0,0 +1,66 @@
+	.include	"global.s"
+
+	;; Stack high water mark
+	;; Linking this module (by calling stack_high_water() or stack_size())
+	;; adds a _GSINIT part which fills the free RAM between the end of the
+	;; last RAM area and the stack pointer with .STACK_PAINT. The lowest byte
+	;; which no longer holds it is the deepest the stack has been.
+
+	.STACK_PAINT = 0xA5
+
+	.globl	.STACK
+	.globl	.memset_simple
+	.globl	s__HEAP_END, l__HEAP_END
+
+	.area	_GSINIT
+
+	CALL	.stack_bottom
+	LD	D, H
+	LD	E, L
+	LDHL	SP, #-4		; Leave the return address of .memset_simple
+	LD	A, L
+	SUB	E
+	LD	C, A
+	LD	A, H
+	SBC	D
+	LD	B, A		; BC = bytes between the RAM areas and SP
+	JR	C, 1$		; RAM areas reach into the stack: nothing to paint
+	LD	H, D
+	LD	L, E
+	LD	A, #.STACK_PAINT
+	CALL	.memset_simple
+1$:
+
+	.area	_HOME
+
+	;; HL = first byte after the last RAM area
+.stack_bottom:
+	LD	HL, #s__HEAP_END
+	LD	BC, #l__HEAP_END
+	ADD	HL, BC
+	RET
+
+	;; BC = .STACK - HL
+.stack_from:
+	LD	A, #<.STACK
+	SUB	L
+	LD	C, A
+	LD	A, #>.STACK
+	SBC	H
+	LD	B, A
+	RET
+
+	;; uint16_t stack_high_water(void)
+_stack_high_water::
+	CALL	.stack_bottom
+	LD	A, #.STACK_PAINT
+1$:
+	CP	(HL)
+	JR	NZ, .stack_from
+	INC	HL
+	JR	1$
+
+	;; uint16_t stack_size(void)
+_stack_size::
+	CALL	.stack_bottom
+	JR	.stack_from
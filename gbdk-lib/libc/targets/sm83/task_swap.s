@@ -0,0 +1,32 @@
+        .include        "global.s"
+
+        .title  "Task switch"
+        .module TaskSwap
+
+        .area   _HOME
+
+        ;; void __task_swap(void ** save_sp, void ** load_sp)
+        ;; DE = where to save SP, BC = where to load SP from
+        ;;
+        ;; No registers need to be kept over a call, so a task's context
+        ;; is only its stack: the ROM bank, then the return address.
+___task_swap::
+        ldh     a, (__current_bank)
+        push    af
+        ldhl    sp, #0
+        ld      a, l
+        ld      (de), a
+        inc     de
+        ld      a, h
+        ld      (de), a
+
+        ld      l, c
+        ld      h, b
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a
+        ld      sp, hl
+        pop     af
+        ldh     (__current_bank), a
+        ld      (rROMB0), a
+        ret
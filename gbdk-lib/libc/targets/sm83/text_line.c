@@ -0,0 +1,52 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gbdk/textfmt.h>
+
+/* Line buffered text output, see gbdk/textfmt.h */
+
+void text_line_init(text_line_t * line, uint8_t x, uint8_t y, uint8_t tile_offset)
+{
+    line->x = x;
+    line->y = y;
+    line->tile_offset = tile_offset;
+    line->len = 0;
+}
+
+void text_line_puts(text_line_t * line, const char * s)
+{
+    uint8_t * p = line->buf + line->len;
+    uint8_t n = line->len;
+
+    while ((*s) && (n != TEXT_LINE_MAX)) {
+        *p++ = (uint8_t)*s++ + line->tile_offset;
+        n++;
+    }
+    line->len = n;
+}
+
+void text_line_u16(text_line_t * line, uint16_t n)
+{
+    uint8_t digits[6];
+    uint8_t * src = digits;
+    uint8_t * dst = line->buf + line->len;
+    uint8_t len = fmt_u16(n, '0' + line->tile_offset, digits);
+
+    if (len > (uint8_t)(TEXT_LINE_MAX - line->len)) len = TEXT_LINE_MAX - line->len;
+    for (line->len += len; len; len--) *dst++ = *src++;
+}
+
+void text_line_fill(text_line_t * line, char c, uint8_t width)
+{
+    uint8_t tile = (uint8_t)c + line->tile_offset;
+
+    if (width > TEXT_LINE_MAX) width = TEXT_LINE_MAX;
+    while (line->len < width) line->buf[line->len++] = tile;
+}
+
+void text_line_flush(text_line_t * line)
+{
+    if (line->len) {
+        set_bkg_tiles(line->x, line->y, line->len, 1, line->buf);
+        line->len = 0;
+    }
+}
@@ -0,0 +1,84 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/vram_queue.h>
+#include <gb/tile_cache.h>
+
+/* VRAM residency cache for background tiles, see gb/tile_cache.h */
+
+#define TILE_CACHE_TILE_SIZE 16
+
+void tile_cache_init(tile_cache_t * cache, const uint8_t * tiles, uint8_t bank, uint16_t tile_count,
+                     uint8_t * lookup, uint8_t first_tile, tile_cache_slot_t * slots, uint8_t slot_count)
+{
+    cache->tiles = tiles;
+    cache->bank = bank;
+    cache->tile_count = tile_count;
+    cache->lookup = lookup;
+    cache->first_tile = first_tile;
+    cache->slots = slots;
+    cache->slot_count = slot_count;
+    tile_cache_reset(cache);
+}
+
+void tile_cache_reset(tile_cache_t * cache)
+{
+    tile_cache_slot_t * slot = cache->slots;
+    uint8_t i;
+
+    memset(cache->lookup, TILE_CACHE_NONE, cache->tile_count);
+    for (i = cache->slot_count; i; i--, slot++) {
+        slot->tile = TILE_CACHE_FREE;
+        slot->used = 0;
+    }
+    cache->hand = 0;
+    cache->loads = 0;
+}
+
+/* Address of a background tile, the same way set_bkg_data() finds it */
+static uint8_t * tile_cache_addr(uint8_t tile)
+{
+    uint16_t addr = (uint16_t)tile * TILE_CACHE_TILE_SIZE;
+
+    if (!(tile & 0x80u) && !(LCDC_REG & LCDCF_BG8000)) addr += 0x9000u;
+    else addr += 0x8000u;
+    return (uint8_t *)addr;
+}
+
+uint8_t tile_cache_request(tile_cache_t * cache, uint16_t tile)
+{
+    tile_cache_slot_t * slot;
+    uint8_t index = cache->lookup[tile], save_bank;
+
+    if (index != TILE_CACHE_NONE) {
+        cache->slots[index].used = 1;
+        return cache->first_tile + index;
+    }
+
+    /* Clock: skip slots used since the hand passed them, clearing their mark */
+    for (;;) {
+        index = cache->hand;
+        if (++cache->hand == cache->slot_count) cache->hand = 0;
+        slot = &cache->slots[index];
+        if (!slot->used) break;
+        slot->used = 0;
+    }
+    if (slot->tile != TILE_CACHE_FREE) cache->lookup[slot->tile] = TILE_CACHE_NONE;
+    slot->tile = tile;
+    slot->used = 1;
+    cache->lookup[tile] = index;
+    cache->loads++;
+
+    /* The queue copies the data right away, so the bank only has to be selected during the call */
+    save_bank = CURRENT_BANK;
+    SWITCH_ROM(cache->bank);
+    vram_queue_write(tile_cache_addr(cache->first_tile + index), cache->tiles + (tile * TILE_CACHE_TILE_SIZE), TILE_CACHE_TILE_SIZE);
+    SWITCH_ROM(save_bank);
+
+    return cache->first_tile + index;
+}
+
+void tile_cache_prefetch(tile_cache_t * cache, const uint16_t * list, uint16_t count)
+{
+    for (; count; count--) tile_cache_request(cache, *list++);
+}
@@ -0,0 +1,102 @@
+; Tile decompress routine
+; Format written by gbcompress --alg=tile
+
+        .include        "global.s"
+
+        .title  "Tile Decompress"
+        .module TileDecompress
+
+        .area _CODE
+
+_tile_decompress::
+        ld      h,d
+        ld      l,e
+        ld      d,b
+        ld      e,c
+
+; hl = source; de = dest
+tile_decompress::
+        push    de              ; start of output, for the size
+1$:
+        ld      a,(hl)          ; mode bytes or reference
+        cp      #0xC0
+        jr      nc,2$
+        call    .tile_rows
+        jr      1$
+2$:                             ; reference to the mode bytes of an earlier tile
+        and     #0x3F
+        ld      b,a
+        inc     hl
+        ld      a,(hl+)
+        ld      c,a
+        or      b
+        jr      z,9$            ; exit, if distance 0
+        push    hl              ; continue after the reference
+        dec     hl
+        dec     hl
+        ld      a,l             ; hl = reference - distance
+        sub     c
+        ld      l,a
+        ld      a,h
+        sbc     b
+        ld      h,a
+        call    .tile_rows
+        pop     hl
+        jr      1$
+9$:
+        pop     hl              ; bc = bytes written
+        ld      a,e
+        sub     l
+        ld      c,a
+        ld      a,d
+        sbc     h
+        ld      b,a
+        ret
+
+        ;; Decodes the tile with the mode bytes at hl into de
+.tile_rows:
+        ld      a,(hl+)         ; modes of rows 0-3
+        ld      b,a
+        ld      a,(hl+)         ; modes of rows 4-7
+        push    af
+        call    .tile_half
+        pop     af
+        ld      b,a
+        ;; Decodes 4 rows with the modes in b
+.tile_half:
+        ld      c,#4
+3$:
+        sla     b
+        jr      c,5$
+        sla     b
+        ld      a,(hl+)         ; low plane
+        ld      (de),a
+        inc     de
+        jr      c,4$            ; 01: high plane is the same
+        ld      a,(hl+)         ; 00: high plane
+4$:
+        ld      (de),a
+        inc     de
+        dec     c
+        jr      nz,3$
+        ret
+5$:
+        sla     b
+        jr      c,6$
+        ld      a,(hl+)         ; 10: low plane, high plane is zero
+        ld      (de),a
+        inc     de
+        xor     a
+        jr      4$
+6$:                             ; 11: same as the row before
+        push    hl
+        ld      h,d
+        ld      l,e
+        dec     hl
+        dec     hl
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        ld      a,(hl)
+        pop     hl
+        jr      4$
@@ -0,0 +1,143 @@
+; Tile decompress tiledata directly to VRAM
+; Format written by gbcompress --alg=tile
+
+        .include        "global.s"
+
+        .title  "Tile Decompress"
+        .module TileDecompressTiles
+
+.macro WRAP_VRAM regH, ?loc
+        bit     3, regH
+        jr      z, loc
+        res     4, regH
+loc:
+.endm
+
+
+        .area _CODE
+
+_tile_decompress_bkg_data::
+_tile_decompress_win_data::
+        ld      b, #0x90
+        ld      hl, #.LCDC
+        bit     LCDCF_B_BG8000, (hl)
+        jr      nz, .load_params
+_tile_decompress_sprite_data::
+        ld      b, #0x80
+
+.load_params:
+        ld      h, d
+        ld      l, e
+
+        ; Compute dest ptr
+        swap    a       ; *16 (size of a tile)
+        ld      e, a
+        and     #0x0F   ; Get high bits
+        add     b       ; Add base offset of target tile "block"
+        ld      d, a
+        ld      a, e
+        and     #0xF0   ; Get low bits only
+        ld      e, a
+        WRAP_VRAM d
+
+; hl = source; de = dest
+tile_decompress_vram::
+1$:
+        ld      a,(hl)          ; mode bytes or reference
+        cp      #0xC0
+        jr      nc,2$
+        call    .tile_rows_vram
+        jr      1$
+2$:                             ; reference to the mode bytes of an earlier tile
+        and     #0x3F
+        ld      b,a
+        inc     hl
+        ld      a,(hl+)
+        ld      c,a
+        or      b
+        ret     z               ; exit, if distance 0
+        push    hl              ; continue after the reference
+        dec     hl
+        dec     hl
+        ld      a,l             ; hl = reference - distance
+        sub     c
+        ld      l,a
+        ld      a,h
+        sbc     b
+        ld      h,a
+        call    .tile_rows_vram
+        pop     hl
+        jr      1$
+
+        ;; Decodes the tile with the mode bytes at hl into de,
+        ;; both bytes of a row are written right after one WAIT_STAT
+.tile_rows_vram:
+        ld      a,(hl+)         ; modes of rows 0-3
+        ld      b,a
+        ld      a,(hl+)         ; modes of rows 4-7
+        push    af
+        call    .tile_half_vram
+        pop     af
+        ld      b,a
+        call    .tile_half_vram
+        WRAP_VRAM d
+        ret
+
+        ;; Decodes 4 rows with the modes in b
+.tile_half_vram:
+        ld      c,#4
+3$:
+        sla     b
+        jr      c,5$
+        sla     b
+        jr      c,4$
+        WAIT_STAT               ; 00: low and high plane
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        dec     c
+        jr      nz,3$
+        ret
+4$:
+        WAIT_STAT               ; 01: both planes are the same
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        ld      (de),a
+        inc     de
+        dec     c
+        jr      nz,3$
+        ret
+5$:
+        sla     b
+        jr      c,6$
+        WAIT_STAT               ; 10: low plane, high plane is zero
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        xor     a
+        ld      (de),a
+        inc     de
+        dec     c
+        jr      nz,3$
+        ret
+6$:                             ; 11: same as the row before
+        push    hl
+        ld      h,d
+        ld      l,e
+        dec     hl
+        dec     hl
+        WAIT_STAT
+        ld      a,(hl+)
+        ld      (de),a
+        inc     de
+        ld      a,(hl)
+        ld      (de),a
+        inc     de
+        pop     hl
+        dec     c
+        jr      nz,3$
+        ret
@@ -0,0 +1,31 @@
+#include <stdint.h>
+#include <gb/gb.h>
+#include <gbdk/timer.h>
+
+/* Cycle timestamp, see gbdk/timer.h
+
+   sys_time is incremented by the VBlank interrupt at the start of line
+   144, so the position in the frame is counted in lines from there.
+   From the start of VBlank until the handler runs sys_time is one
+   frame behind, which the pending VBlank flag tells apart */
+
+#define LINE_CYCLES  456u
+#define FRAME_LINES  154u
+#define VBL_LINE     144u
+
+uint32_t timer_now_cycles(void)
+{
+    uint16_t frames;
+    uint8_t line, pending;
+
+    CRITICAL {
+        frames = sys_time;
+        line = LY_REG;
+        pending = IF_REG & VBL_IFLAG;
+    }
+
+    if (pending) frames++;
+    if (line >= VBL_LINE) line -= VBL_LINE; else line += (FRAME_LINES - VBL_LINE);
+
+    return ((uint32_t)frames * (FRAME_LINES * LINE_CYCLES)) + ((uint32_t)line * LINE_CYCLES);
+}
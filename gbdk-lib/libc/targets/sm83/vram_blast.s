@@ -0,0 +1,80 @@
+	.include	"global.s"
+
+	;; Unrolled copy for bulk VRAM uploads during VBlank, run from HRAM
+	;; The loop is written into HRAM at startup: a JR whose displacement
+	;; vram_blast() sets for the length of the first block, then 16 times
+	;; LD A,(HL+) / LD (DE),A / INC DE and the block counter in B
+
+	.VRAM_BLAST_BLOCK = 16
+
+	.area	_CODE_HRAM
+
+.vram_blast_code:
+	.ds	2 + (.VRAM_BLAST_BLOCK * 3) + 4
+
+	.area	_GSINIT
+
+	LD	HL, #.vram_blast_code
+	LD	A, #0x18	; JR e
+	LD	(HL+), A
+	XOR	A
+	LD	(HL+), A
+	LD	C, #.VRAM_BLAST_BLOCK
+1$:
+	LD	A, #0x2A	; LD A, (HL+)
+	LD	(HL+), A
+	LD	A, #0x12	; LD (DE), A
+	LD	(HL+), A
+	LD	A, #0x13	; INC DE
+	LD	(HL+), A
+	DEC	C
+	JR	NZ, 1$
+	LD	A, #0x05	; DEC B
+	LD	(HL+), A
+	LD	A, #0x20	; JR NZ, back to the first LD A, (HL+)
+	LD	(HL+), A
+	LD	A, #-((.VRAM_BLAST_BLOCK * 3) + 3)
+	LD	(HL+), A
+	LD	(HL), #0xC9	; RET
+
+	.area	_HOME
+
+	;; void vram_blast(uint8_t * dst, const uint8_t * src, uint16_t n)
+	;; DE = dst, BC = src, sp+2 = n (0 to 4096)
+_vram_blast::
+	LDHL	SP, #2
+	LD	A, (HL+)
+	LD	H, (HL)
+	LD	L, A
+	OR	H
+	JR	Z, 9$
+	PUSH	BC
+
+	;; The first, possibly partial, block skips 3 * ((16 - n) & 15) bytes of the copy
+	LD	A, L
+	CPL
+	INC	A
+	AND	#(.VRAM_BLAST_BLOCK - 1)
+	LD	C, A
+	ADD	A
+	ADD	C
+	LDH	(.vram_blast_code + 1), A
+
+	;; B = (n + 15) / 16 blocks, 4096 bytes wrap to 0 = 256 blocks
+	LD	BC, #(.VRAM_BLAST_BLOCK - 1)
+	ADD	HL, BC
+	LD	A, L
+	AND	#0xF0
+	LD	C, A
+	LD	A, H
+	AND	#0x0F
+	OR	C
+	SWAP	A
+	LD	B, A
+
+	POP	HL
+	CALL	.vram_blast_code
+9$:
+	POP	HL
+	POP	AF
+	JP	(HL)
@@ -0,0 +1,373 @@
+        .include        "global.s"
+
+        .title  "VRAM queue"
+        .module VRAMQueue
+
+        ;; Deferred VRAM writes: stripes are queued from game code at any
+        ;; time and copied to VRAM by _vram_queue_isr (installed with add_VBL)
+        ;;
+        ;; Format of each stripe in the ring buffer
+        ;; 0: Data length and flags (0 = wrap marker, next stripe is at the start of the buffer)
+        ;;    bit 7: write to VRAM bank 1, bit 6: column (address advances by 32 per byte)
+        ;; 1: VRAM address LSB
+        ;; 2: VRAM address MSB
+        ;; 3: ...N data bytes...
+        ;;
+        ;; Stripes never wrap around the end of the buffer, so they can be
+        ;; copied with a single unrolled run.
+        ;; Only the writer advances the head and only the reader advances the tail.
+
+        .VRAM_QUEUE_HDR_SIZEOF  = 3
+        .VRAM_QUEUE_STRIPE_MAX  = 32    ; Longer writes are split, must match VRAM_QUEUE_STRIPE_MAX in gb/vram_queue.h
+        .VRAM_QUEUE_STRIPE_COST = 8     ; Setup time of a stripe, in copied bytes (~6 M-cycles each)
+        .VRAM_QUEUE_BUDGET_MIN  = (.VRAM_QUEUE_STRIPE_MAX * 2) + .VRAM_QUEUE_STRIPE_COST
+        .VRAM_QUEUE_LEN_MASK    = 0x3F
+        .VRAM_QUEUE_F_COLUMN    = 0x40  ; Must match VRAM_QUEUE_COLUMN in gb/vram_queue.h
+
+        .area   _DATA
+
+.vram_queue_buf:                        ; 256 bytes, indexed by the 8 bit head and tail
+        .ds     0x100
+.vram_queue_head:
+        .ds     0x01
+.vram_queue_tail:
+        .ds     0x01
+.vram_queue_wflags:                     ; Flags of the stripes being written
+        .ds     0x01
+
+        .area   _INITIALIZED
+
+_vram_queue_budget::
+        .ds     0x01
+
+        .area   _INITIALIZER
+
+        .db     128
+
+        .area   _HOME
+
+        ;; VBL handler: copy as many stripes as the budget allows
+_vram_queue_isr::
+        ld      a, (_vram_queue_budget)
+        cp      #.VRAM_QUEUE_BUDGET_MIN
+        jr      nc, 1$
+        ld      a, #.VRAM_QUEUE_BUDGET_MIN ; Always room for at least one stripe
+1$:
+        ld      c, a
+
+        ;; Copy queued stripes with budget C, preserving the VRAM bank
+        ;; selected by the interrupted code
+.vram_queue_copy_vbk:
+        ldh     a, (.VBK)
+        push    af
+        call    .vram_queue_copy
+        pop     af
+        ldh     (.VBK), a
+        ret
+
+        ;; Copy queued stripes to VRAM until the queue is empty or the
+        ;; next stripe would go over the budget in C. Doesn't wait for STAT.
+.vram_queue_copy:
+        ld      a, (.vram_queue_head)
+        ld      b, a            ; B = head
+1$:
+        ld      a, (.vram_queue_tail)
+        cp      b
+        ret     z               ; Queue is empty
+
+        add     #<.vram_queue_buf
+        ld      l, a
+        adc     #>.vram_queue_buf
+        sub     l
+        ld      h, a            ; HL = stripe
+
+        ld      a, (hl+)        ; Stripe length and flags
+        or      a
+        jr      nz, 2$
+        ld      (.vram_queue_tail), a ; Wrap marker, continue from the start
+        jr      1$
+2$:
+        ld      d, a            ; D = stripe flags
+        rlca
+        and     #1
+        ldh     (.VBK), a       ; VRAM bank of the stripe, ignored on DMG
+        ld      a, d
+        and     #.VRAM_QUEUE_LEN_MASK
+        ld      e, a            ; E = stripe length
+
+        ld      a, c
+        sub     #.VRAM_QUEUE_STRIPE_COST
+        ret     c
+        sub     e
+        ret     c               ; Over budget, leave it for the next frame
+        bit     6, d
+        jr      z, 3$
+        sub     e               ; Column stripes take about twice as long per byte
+        ret     c
+3$:
+        ld      c, a
+
+        ;; Free the stripe now, the writer can't run until this returns
+        ld      a, (.vram_queue_tail)
+        add     #.VRAM_QUEUE_HDR_SIZEOF
+        add     e
+        ld      (.vram_queue_tail), a
+
+        bit     6, d
+        jp      nz, 5$
+
+        ;; Entry point of the unrolled copy = 4$ - 3 * length
+        ld      a, e
+        add     a
+        add     e
+        ld      e, a
+        ld      a, #<4$
+        sub     e
+        ld      e, a
+        ld      a, #>4$
+        sbc     #0
+        ld      d, a
+        push    de
+
+        ld      a, (hl+)
+        ld      e, a
+        ld      a, (hl+)
+        push    hl
+        ld      h, a
+        ld      l, e            ; HL = VRAM address
+        pop     de              ; DE = stripe data
+        ret                     ; Jump into the unrolled copy
+
+        .rept   .VRAM_QUEUE_STRIPE_MAX
+        ld      a, (de)
+        inc     de
+        ld      (hl+), a
+        .endm
+4$:
+        jp      1$
+
+5$:
+        ;; Column stripe, one byte per tile map row
+        push    bc
+        ld      b, e            ; B = stripe length
+        ld      a, (hl+)
+        ld      e, a
+        ld      a, (hl+)
+        ld      d, a            ; DE = VRAM address, HL = stripe data
+6$:
+        ld      a, (hl+)
+        ld      (de), a
+        ld      a, e
+        add     #32
+        ld      e, a
+        adc     d
+        sub     e
+        ld      d, a
+        dec     b
+        jr      nz, 6$
+        pop     bc
+        jp      1$
+
+        ;; Copy everything in the queue, for use while the LCD is off
+.vram_queue_drain:
+        ld      c, #0xFF
+        call    .vram_queue_copy_vbk
+        ld      a, (.vram_queue_head)
+        ld      b, a
+        ld      a, (.vram_queue_tail)
+        cp      b
+        jr      nz, .vram_queue_drain
+        ret
+        ;; Reserve room for a stripe of length A, waits until there is enough
+        ;; Returns HL = stripe, A = length. Preserves BC, DE
+.vram_queue_reserve:
+        push    de
+        ld      d, a            ; D = stripe length
+        add     #.VRAM_QUEUE_HDR_SIZEOF
+        ld      e, a            ; E = bytes needed
+        jr      1$
+0$:
+        ;; No room yet. If the LCD has been turned off the VBL handler
+        ;; won't run, so empty the queue directly instead
+        ldh     a, (.LCDC)
+        and     #LCDCF_ON
+        jr      nz, 1$
+        push    bc
+        push    de
+        call    .vram_queue_drain
+        pop     de
+        pop     bc
+1$:
+        ld      a, (.vram_queue_tail)
+        ld      h, a            ; H = tail
+        ld      a, (.vram_queue_head)
+        ld      l, a            ; L = head
+        cp      h
+        jr      c, 3$
+
+        ;; Head >= tail: free space runs to the end of the buffer
+        add     e
+        jr      nc, 4$
+        ;; Not enough, wrap to the start if that part is free
+        ld      a, e
+        cp      h
+        jr      nc, 0$
+        ld      a, l
+        add     #<.vram_queue_buf
+        ld      l, a
+        adc     #>.vram_queue_buf
+        sub     l
+        ld      h, a
+        ld      (hl), #0        ; Wrap marker
+        ld      hl, #.vram_queue_buf
+        jr      5$
+3$:
+        ;; Head < tail: free space runs up to the tail
+        add     e
+        jr      c, 0$
+        cp      h
+        jr      nc, 0$
+4$:
+        ld      a, l
+        add     #<.vram_queue_buf
+        ld      l, a
+        adc     #>.vram_queue_buf
+        sub     l
+        ld      h, a
+5$:
+        ld      a, d
+        pop     de
+        ret
+
+;DE: dest
+;BC: src
+;sp+2: len
+_vram_queue_write::
+        xor     a
+        ld      (.vram_queue_wflags), a
+        ldhl    sp, #2
+        ld      a, (hl+)
+        ld      h, (hl)
+        ld      l, a            ; HL = len
+        call    .vram_queue_write
+
+        ;; Remove len from the stack
+        pop     hl
+        pop     af
+        jp      (hl)
+
+;DE: dest
+;BC: src
+;sp+2: len
+;sp+4: flags
+_vram_queue_write_ex::
+        ldhl    sp, #4
+        ld      a, (hl-)
+        ld      (.vram_queue_wflags), a
+        ld      a, (hl-)
+        ld      l, (hl)
+        ld      h, a            ; HL = len
+        call    .vram_queue_write
+
+        ;; Remove len and flags from the stack
+        pop     hl
+        pop     af
+        inc     sp
+        jp      (hl)
+
+        ;; Queue HL bytes from BC to VRAM address DE, as stripes with .vram_queue_wflags
+.vram_queue_write:
+1$:
+        ld      a, h
+        or      l
+        jr      z, 9$
+        push    hl
+
+        ;; A = stripe length = min(len, .VRAM_QUEUE_STRIPE_MAX)
+        ld      a, h
+        or      a
+        jr      nz, 2$
+        ld      a, l
+        cp      #(.VRAM_QUEUE_STRIPE_MAX + 1)
+        jr      c, 3$
+2$:
+        ld      a, #.VRAM_QUEUE_STRIPE_MAX
+3$:
+        call    .vram_queue_reserve
+        push    af
+        push    bc
+        ld      b, a
+        ld      a, (.vram_queue_wflags)
+        or      b
+        pop     bc
+        ld      (hl+), a        ; Stripe length and flags
+        ld      a, e
+        ld      (hl+), a
+        ld      a, d
+        ld      (hl+), a        ; VRAM address
+        pop     af
+
+        ;; DE = dest of the next stripe, 32 bytes further per byte for columns
+        push    af
+        push    hl
+        ld      l, a
+        ld      h, #0
+        ld      a, (.vram_queue_wflags)
+        and     #.VRAM_QUEUE_F_COLUMN
+        jr      z, 5$
+        add     hl, hl
+        add     hl, hl
+        add     hl, hl
+        add     hl, hl
+        add     hl, hl
+5$:
+        add     hl, de
+        ld      d, h
+        ld      e, l
+        pop     hl
+        pop     af
+        push    de
+        ld      d, a            ; D = bytes left in this stripe
+        ld      e, a            ; E = stripe length
+4$:
+        ld      a, (bc)
+        inc     bc
+        ld      (hl+), a
+        dec     d
+        jr      nz, 4$
+
+        ;; Publish the stripe, the VBL handler may copy it from now on
+        ld      a, l
+        sub     #<.vram_queue_buf
+        ld      (.vram_queue_head), a
+
+        ld      a, e
+        pop     de
+        pop     hl
+        cpl
+        inc     a
+        add     l
+        ld      l, a
+        ld      a, h
+        adc     #0xFF
+        ld      h, a            ; len -= stripe length
+        jr      1$
+
+9$:
+        ;; If the LCD is off the VBL handler won't run, write everything now
+        ldh     a, (.LCDC)
+        and     #LCDCF_ON
+        ret     nz
+        jp      .vram_queue_drain
+
+        ;; Wait until everything queued has been written to VRAM
+_vram_queue_flush::
+        ldh     a, (.LCDC)
+        and     #LCDCF_ON
+        jp      z, .vram_queue_drain
+        ld      a, (.vram_queue_head)
+        ld      b, a
+        ld      a, (.vram_queue_tail)
+        cp      b
+        ret     z
+        jr      _vram_queue_flush
@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/vram_queue.h>
+#include <gb/vwf.h>
+
+/* Variable width font text, see gb/vwf.h. The glyph shifting is in vwf.s */
+
+#define VWF_TILE_SIZE 16
+
+/* ORs the 8 rows of glyph shifted right by shift into buf and the rest into buf + 8 */
+void __vwf_blit(uint8_t * buf, const uint8_t * glyph, uint8_t shift) OLDCALL;
+
+/* Address of a background tile, the same way set_bkg_data() finds it */
+static uint8_t * vwf_tile_addr(uint8_t tile)
+{
+    uint16_t addr = (uint16_t)tile * VWF_TILE_SIZE;
+
+    if (!(tile & 0x80u) && !(LCDC_REG & LCDCF_BG8000)) addr += 0x9000u;
+    else addr += 0x8000u;
+    return (uint8_t *)addr;
+}
+
+void vwf_init(vwf_t * vwf, const vwf_font_t * font, uint8_t first_tile, uint8_t tile_count)
+{
+    vwf->font = font;
+    vwf->first_tile = first_tile;
+    vwf->tile_count = tile_count;
+    vwf->tile = 0;
+    vwf->fg = 3;
+    vwf->bg = 0;
+    vwf->x = vwf->y = 0;
+    vwf->bit = 0;
+    vwf->dirty = 0;
+    memset(vwf->buf, 0, sizeof(vwf->buf));
+}
+
+void vwf_set_colors(vwf_t * vwf, uint8_t fg, uint8_t bg)
+{
+    vwf->fg = fg;
+    vwf->bg = bg;
+}
+
+/* Queues the current tile and its tile map entry */
+static void vwf_queue_tile(vwf_t * vwf)
+{
+    uint8_t data[VWF_TILE_SIZE], *dst = data, *src = vwf->buf, i, row;
+    uint8_t tile = vwf->first_tile + vwf->tile;
+
+    for (i = 8; i; i--) {
+        row = *src++;
+        *dst++ = ((vwf->fg & 1u) ? row : 0) | ((vwf->bg & 1u) ? (uint8_t)~row : 0);
+        *dst++ = ((vwf->fg & 2u) ? row : 0) | ((vwf->bg & 2u) ? (uint8_t)~row : 0);
+    }
+    vram_queue_write(vwf_tile_addr(tile), data, VWF_TILE_SIZE);
+    vram_queue_write(get_bkg_xy_addr(vwf->x & 31u, vwf->y & 31u), &tile, 1);
+    vwf->dirty = 0;
+}
+
+/* Moves on to the next tile of the range and of the tile map row */
+static void vwf_next_tile(vwf_t * vwf)
+{
+    memcpy(vwf->buf, vwf->buf + 8, 8);
+    memset(vwf->buf + 8, 0, 8);
+    if (++vwf->tile == vwf->tile_count) vwf->tile = 0;
+    vwf->x++;
+}
+
+void vwf_set_pos(vwf_t * vwf, uint8_t x, uint8_t y)
+{
+    vwf_flush(vwf);
+    if (vwf->bit) vwf_next_tile(vwf);
+    memset(vwf->buf, 0, sizeof(vwf->buf));
+    vwf->bit = 0;
+    vwf->x = x;
+    vwf->y = y;
+}
+
+void vwf_putc(vwf_t * vwf, char c)
+{
+    const vwf_font_t * font = vwf->font;
+    uint8_t index = (uint8_t)c - font->first, save_bank;
+
+    if (index >= font->count) return;
+
+    /* The glyph is only read during the call, the bank can be restored right after */
+    save_bank = CURRENT_BANK;
+    SWITCH_ROM(font->bank);
+    __vwf_blit(vwf->buf, font->glyphs + (index * 8u), vwf->bit);
+    vwf->bit += font->widths[index];
+    SWITCH_ROM(save_bank);
+
+    vwf->dirty = 1;
+    if (vwf->bit >= 8) {
+        vwf_queue_tile(vwf);
+        vwf_next_tile(vwf);
+        vwf->bit -= 8;
+        vwf->dirty = (vwf->bit != 0);
+    }
+}
+
+void vwf_print(vwf_t * vwf, const char * str)
+{
+    while (*str) vwf_putc(vwf, *str++);
+}
+
+void vwf_flush(vwf_t * vwf)
+{
+    if (vwf->dirty) vwf_queue_tile(vwf);
+}
@@ -0,0 +1,69 @@
+        .include        "global.s"
+
+        .title  "Variable width font"
+        .module VWF
+
+        .area   _DATA
+
+.vwf_shift:
+        .ds     0x01
+
+        .area   _CODE
+
+; void __vwf_blit(uint8_t * buf, const uint8_t * glyph, uint8_t shift) OLDCALL;
+;; ORs each glyph row shifted right by shift into buf, the bits shifted out into buf + 8
+___vwf_blit::
+        push    bc
+        ldhl    sp, #4
+        ld      a, (hl+)
+        ld      e, a
+        ld      a, (hl+)
+        ld      d, a            ; de = buf
+        ld      a, (hl+)
+        ld      c, a
+        ld      a, (hl+)
+        ld      b, a            ; bc = glyph
+        ld      a, (hl)
+        ld      (.vwf_shift), a
+
+        ld      a, #8
+1$:
+        push    af              ; rows left
+        ld      a, (bc)
+        inc     bc
+        ld      h, a
+        ld      l, #0
+        ld      a, (.vwf_shift)
+        or      a
+        jr      z, 3$
+2$:
+        srl     h
+        rr      l
+        dec     a
+        jr      nz, 2$
+3$:
+        ld      a, (de)         ; row of this tile
+        or      h
+        ld      (de), a
+        ld      a, e
+        add     #8
+        ld      e, a
+        adc     d
+        sub     e
+        ld      d, a
+        ld      a, (de)         ; row of the next tile
+        or      l
+        ld      (de), a
+        ld      a, e
+        sub     #7
+        ld      e, a
+        ld      a, d
+        sbc     #0
+        ld      d, a
+
+        pop     af
+        dec     a
+        jr      nz, 1$
+
+        pop     bc
+        ret
@@ -0,0 +1,55 @@
+#include <stdint.h>
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/wram_bank.h>
+
+/* Bump allocator for the CGB WRAM banks, see gb/wram_bank.h */
+
+#define WRAM_BANK_COUNT (WRAM_BANK_LAST - WRAM_BANK_FIRST + 1)
+
+/* Bytes allocated in each bank, cleared with the rest of the static storage at startup */
+static uint16_t wram_bank_used[WRAM_BANK_COUNT];
+
+uint8_t wram_alloc(uint16_t size, wram_ptr_t * p)
+{
+    uint8_t i;
+
+    if ((_cpu != CGB_TYPE) || (size == 0) || (size > WRAM_BANK_SIZE)) return FALSE;
+    for (i = 0; i != WRAM_BANK_COUNT; i++) {
+        if ((WRAM_BANK_SIZE - wram_bank_used[i]) >= size) {
+            p->bank = WRAM_BANK_FIRST + i;
+            p->ptr = (uint8_t *)(WRAM_BANK_ADDR + wram_bank_used[i]);
+            wram_bank_used[i] += size;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+void wram_reset(void)
+{
+    memset(wram_bank_used, 0, sizeof(wram_bank_used));
+}
+
+uint16_t wram_free_bytes(uint8_t bank)
+{
+    return WRAM_BANK_SIZE - wram_bank_used[bank - WRAM_BANK_FIRST];
+}
+
+void wram_memcpy_from(void * dst, const wram_ptr_t * src, uint16_t len)
+{
+    uint8_t save = CURRENT_WRAM_BANK;
+
+    SWITCH_WRAM(src->bank);
+    memcpy(dst, src->ptr, len);
+    SWITCH_WRAM(save);
+}
+
+void wram_memcpy_to(const wram_ptr_t * dst, const void * src, uint16_t len)
+{
+    uint8_t save = CURRENT_WRAM_BANK;
+
+    SWITCH_WRAM(dst->bank);
+    memcpy(dst->ptr, src, len);
+    SWITCH_WRAM(save);
+}
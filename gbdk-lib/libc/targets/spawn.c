@@ -0,0 +1,84 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gbdk/platform.h>
+#include <gbdk/spawn.h>
+
+/* Level objects spawned as the camera scrolls over them, see gbdk/spawn.h
+
+   The objects from first up to next are the ones in the tile columns
+   of the window. Each move walks the two cursors over the objects
+   between the old and the new edges, so a frame reads only the
+   objects coming into or going out of the window. The list is read
+   with its bank switched in, which is switched back around each call
+   of the spawn function */
+
+static uint8_t save_bank;
+
+static void spawn_enter(spawn_window_t * w, const spawn_t * s, uint16_t id)
+{
+    spawn_t copy = *s;
+
+    SWITCH_ROM(save_bank);
+    w->spawn(&copy, id);
+    if (w->bank) SWITCH_ROM(w->bank);
+}
+
+static void spawn_move(spawn_window_t * w, uint16_t left)
+{
+    const spawn_t * s;
+    uint16_t right = left + w->width;
+
+    /* Right edge moving right, then left edge moving right */
+    s = w->list.spawns + w->next;
+    while ((w->next != w->list.count) && (s->x < right)) {
+        if (s->x >= left) spawn_enter(w, s, w->next);
+        w->next++;
+        s++;
+    }
+    s = w->list.spawns + w->first;
+    while ((w->first != w->next) && (s->x < left)) {
+        w->first++;
+        s++;
+    }
+
+    /* Left edge moving left, then right edge moving left */
+    s = w->list.spawns + w->first;
+    while (w->first && ((--s)->x >= left)) {
+        w->first--;
+        if (s->x < right) spawn_enter(w, s, w->first);
+    }
+    s = w->list.spawns + w->next;
+    while ((w->next != w->first) && ((--s)->x >= right)) w->next--;
+}
+
+void spawn_window_init(spawn_window_t * w, const spawn_list_t * list, uint8_t bank, uint16_t width, spawn_fn spawn)
+{
+    save_bank = CURRENT_BANK;
+    if (bank) SWITCH_ROM(bank);
+    w->list = *list;
+    SWITCH_ROM(save_bank);
+    w->bank = bank;
+    w->width = (uint8_t)((width + 7) >> 3);
+    w->first = w->next = 0;
+    w->spawn = spawn;
+}
+
+void spawn_window_set(spawn_window_t * w, uint16_t cam_x)
+{
+    uint16_t left = cam_x >> 3, bucket = left >> SPAWN_BUCKET_SHIFT;
+
+    save_bank = CURRENT_BANK;
+    if (w->bank) SWITCH_ROM(w->bank);
+    /* Nothing is in the window: both cursors go to the first object of its bucket */
+    w->first = w->next = (bucket < w->list.bucket_count) ? w->list.buckets[bucket] : w->list.count;
+    spawn_move(w, left);
+    SWITCH_ROM(save_bank);
+}
+
+void spawn_window_update(spawn_window_t * w, uint16_t cam_x)
+{
+    save_bank = CURRENT_BANK;
+    if (w->bank) SWITCH_ROM(w->bank);
+    spawn_move(w, cam_x >> 3);
+    SWITCH_ROM(save_bank);
+}
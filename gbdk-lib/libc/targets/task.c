@@ -0,0 +1,90 @@
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <gbdk/task.h>
+
+/* Cooperative tasks, see gbdk/task.h */
+
+task_t * task_current;
+
+static task_t * task_first;
+static task_t * task_next;      /* Task which task_run() continues with */
+void * __task_main_sp;          /* Stack of task_run() while a task runs */
+
+/* Saves SP and the current bank to *save_sp, continues on the stack in *load_sp */
+void __task_swap(void ** save_sp, void ** load_sp);
+
+/* A new task starts here, the first swap to its stack returns into it */
+static void task_start(void)
+{
+    task_current->func();
+    task_current->state = TASK_DONE;
+    __task_swap(&task_current->sp, &__task_main_sp);
+}
+
+void task_add(task_t * task, task_func_t func, uint8_t * stack, uint16_t stack_size)
+{
+    uint8_t * sp = stack + stack_size;
+    task_t ** link;
+
+    /* What __task_swap() restores: the bank, then the return address */
+    *--sp = (uint8_t)((uint16_t)task_start >> 8);
+    *--sp = (uint8_t)(uint16_t)task_start;
+    *--sp = CURRENT_BANK;
+    *--sp = 0;
+#if defined(__PORT_z80)
+    *--sp = 0;                  /* IX */
+    *--sp = 0;
+#endif
+    task->sp = sp;
+    task->func = func;
+    task->next = NULL;
+    task->state = TASK_READY;
+
+    for (link = &task_first; *link; link = &(*link)->next);
+    *link = task;
+}
+
+void task_remove(task_t * task)
+{
+    task_t ** link;
+
+    for (link = &task_first; *link; link = &(*link)->next) {
+        if (*link == task) {
+            *link = task->next;
+            if (task_next == task) task_next = task->next;
+            break;
+        }
+    }
+    task->state = TASK_DONE;
+}
+
+void task_yield(void)
+{
+    __task_swap(&task_current->sp, &__task_main_sp);
+}
+
+uint8_t task_run(uint8_t lines)
+{
+    uint8_t start = TASK_LINE(), line, count;
+    uint8_t frame = (uint8_t)sys_time;
+    task_t * task;
+
+    while (task_first) {
+        if (!task_next) task_next = task_first;
+        task = task_next;
+        task_next = task->next;
+
+        task_current = task;
+        __task_swap(&__task_main_sp, &task->sp);
+        task_current = NULL;
+        if (task->state == TASK_DONE) task_remove(task);
+
+        line = TASK_LINE();
+        if (line < start) line += (uint8_t)(TASK_FRAME_LINES - start); else line -= start;
+        if ((line >= lines) || ((uint8_t)sys_time != frame)) break;
+    }
+
+    count = 0;
+    for (task = task_first; task; task = task->next) count++;
+    return count;
+}
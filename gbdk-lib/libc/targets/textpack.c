@@ -0,0 +1,72 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gbdk/platform.h>
+#include <gbdk/textpack.h>
+
+/* Compressed strings read one character at a time, see gbdk/textpack.h
+
+   A string is a list of symbols ending with 0: characters below
+   first_token, and dictionary entries from it on. With a Huffman
+   tree the symbols are coded MSB first, and each node of the tree
+   is two entries, one for each bit: a leaf (bit 15 set) with its
+   symbol in the low byte, or the index of the next node */
+
+#define TREE_LEAF 0x8000u
+
+void textpack_open(textpack_reader_t * r, const textpack_t * pack, uint16_t id)
+{
+    const textpack_ref_t * ref = pack->index + id;
+
+    r->pack = pack;
+    r->ptr = ref->data;
+    r->bank = ref->bank;
+    r->bit_count = 0;
+    r->expand_left = 0;
+}
+
+static uint8_t textpack_symbol(textpack_reader_t * r)
+{
+    const uint16_t * tree = r->pack->tree;
+    uint16_t node = 0;
+
+    if (tree == NULL) return *r->ptr++;
+    do {
+        if (!r->bit_count) {
+            r->bits = *r->ptr++;
+            r->bit_count = 8;
+        }
+        node = tree[(node << 1) | (r->bits >> 7)];
+        r->bits <<= 1;
+        r->bit_count--;
+    } while (!(node & TREE_LEAF));
+    return (uint8_t)node;
+}
+
+char textpack_getc(textpack_reader_t * r)
+{
+    const textpack_t * pack = r->pack;
+    uint8_t save_bank, symbol;
+
+    if (r->expand_left) {
+        r->expand_left--;
+        return *r->expand++;
+    }
+    if (r->ptr == NULL) return 0;
+
+    save_bank = CURRENT_BANK;
+    SWITCH_ROM(r->bank);
+    symbol = textpack_symbol(r);
+    SWITCH_ROM(save_bank);
+
+    if (symbol == 0) {
+        r->ptr = NULL;
+        return 0;
+    }
+    if (symbol < pack->first_token) return symbol;
+
+    /* Entries are at least 2 characters long */
+    symbol -= pack->first_token;
+    r->expand = pack->dict + pack->dict_offsets[symbol];
+    r->expand_left = (uint8_t)(pack->dict_offsets[symbol + 1] - pack->dict_offsets[symbol]) - 1;
+    return *r->expand++;
+}
@@ -3,7 +3,7 @@
         .title  "console utilities"
         .module ConsoleUtils
 
-        .globl  .curx, .cury
+        .globl  .curx, .cury, .vdp_fill_words
 
         .area   _HOME
 
@@ -19,16 +19,8 @@ _cls::
         WRITE_VDP_CMD_HL
 
         ld hl, #.SPACE
-        ld bc, #(.SCREEN_HEIGHT * .VDP_MAP_WIDTH)
-        inc b
-        inc c
-        jr 1$
-2$:
-        WRITE_VDP_DATA_HL
-1$:
-        dec c
-        jr nz, 2$
-        djnz 2$ 
+        ld de, #(.SCREEN_HEIGHT * .VDP_MAP_WIDTH)
+        call .vdp_fill_words
 
         ENABLE_VBLANK_COPY         ; switch ON copy shadow SAT
         ret
\ No newline at end of file
@@ -0,0 +1,84 @@
+; LZ4 style decompress routine
+; Format written by gbcompress --alg=lz4
+
+        .include        "global.s"
+
+        .title  "LZ4 Decompress"
+        .module LZ4Decompress
+
+        .area _CODE
+
+; hl = source; de = dest
+_lz4_decompress::
+        push    de              ; start of output, for the size
+1$:
+        ld      a, (hl)         ; load token
+        inc     hl
+        push    af
+        rrca
+        rrca
+        rrca
+        rrca
+        and     #0x0F           ; literal count
+        jr      z, 2$
+        call    .lz4_length
+        ldir                    ; literals
+2$:
+        ld      c, (hl)         ; load match offset into bc
+        inc     hl
+        ld      b, (hl)
+        inc     hl
+        ld      a, b
+        or      c
+        jr      z, 4$           ; exit, if offset 0
+        pop     af
+        push    bc
+        and     #0x0F
+        call    .lz4_length
+        ex      (sp), hl        ; hl = offset, source on stack
+        ld      a, e            ; hl = match address
+        sub     l
+        ld      l, a
+        ld      a, d
+        sbc     h
+        ld      h, a
+        ld      a, c            ; matches are at least 4 bytes
+        add     #4
+        ld      c, a
+        jr      nc, 3$
+        inc     b
+3$:
+        ldir                    ; match, may overlap its output
+        pop     hl
+        jr      1$              ; next sequence
+4$:
+        pop     af
+        pop     hl
+        ex      de, hl
+        or      a
+        sbc     hl, de
+        ex      de, hl
+
+        ret
+
+        ;; bc = length for nibble a, adding up the
+        ;; length bytes at (hl) if it is 15
+.lz4_length:
+        ld      c, a
+        ld      b, #0
+        cp      #15
+        ret     nz
+1$:
+        ld      a, (hl)
+        inc     hl
+        cp      #255
+        jr      nz, 2$
+        inc     b               ; + 255
+        dec     bc
+        jr      1$
+2$:
+        add     c
+        ld      c, a
+        ret     nc
+        inc     b
+        ret
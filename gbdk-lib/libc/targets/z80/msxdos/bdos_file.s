@@ -0,0 +1,288 @@
+        .include        "global.s"
+
+        .title  "MSX-DOS files"
+        .module MSXDOSFile
+
+        .globl  .memset_simple
+
+        ;; msxdos_file_t
+        .FILE_FCB_NAME          = 1
+        .FILE_FCB_EXT           = 9
+        .FILE_FCB_RECORD_SIZE   = 14
+        .FILE_POS               = 37
+        .FILE_LEN               = 39
+        .FILE_BUF               = 41
+        .FILE_BUF_SIZE          = 512
+
+        .area   _DATA
+.fread_file:
+        .ds     2
+.fread_dst:
+        .ds     2
+.fread_size:
+        .ds     2
+.fread_left:
+        .ds     2
+
+        .area   _CODE
+
+; uint8_t msxdos_fopen(msxdos_file_t * f, const char * name) __z88dk_callee
+_msxdos_fopen::
+        pop hl
+        pop de          ; DE = f
+        ex (sp), hl     ; HL = name
+        push de
+        push hl
+        ex de, hl
+        ld bc, #.FILE_BUF
+        xor a
+        call .memset_simple     ; clear the FCB, position and length
+        pop de                  ; DE = name
+        pop hl
+        push hl                 ; HL = f
+        inc hl
+        ld b, #11
+1$:
+        ld (hl), #' '           ; name and extension are padded with spaces
+        inc hl
+        djnz 1$
+        pop hl
+        push hl
+
+        inc de
+        ld a, (de)
+        dec de
+        cp #':'
+        jr nz, 2$
+        ld a, (de)              ; drive letter
+        call .fcb_upper
+        sub #('A' - 1)
+        ld (hl), a
+        inc de
+        inc de
+2$:
+        inc hl                  ; HL = f + .FILE_FCB_NAME
+        ld b, #8
+        call .fcb_copy
+        ld a, (de)
+        cp #'.'
+        jr nz, 3$
+        inc de
+        pop hl
+        push hl
+        ld bc, #.FILE_FCB_EXT
+        add hl, bc
+        ld b, #3
+        call .fcb_copy
+3$:
+        pop de
+        push de
+        CALL_BDOS #_FOPEN
+        pop hl
+        or a
+        jr nz, 4$               ; not found
+        ld bc, #.FILE_FCB_RECORD_SIZE
+        add hl, bc
+        ld (hl), #1             ; record size, block reads count bytes
+        inc hl
+        ld (hl), a
+4$:
+        ld l, a
+        ret
+
+        ;; copies up to B characters of the name at DE to HL in upper case,
+        ;; up to a '.' or the end of the name where DE is left
+.fcb_copy:
+        ld a, (de)
+        or a
+        ret z
+        cp #'.'
+        ret z
+        inc de
+        inc b
+        dec b
+        jr z, .fcb_copy         ; the field is full, skip the rest
+        call .fcb_upper
+        ld (hl), a
+        inc hl
+        dec b
+        jr .fcb_copy
+
+.fcb_upper:
+        cp #'a'
+        ret c
+        cp #('z' + 1)
+        ret nc
+        sub #('a' - 'A')
+        ret
+
+        ;; fills the buffer of the file at HL with the next block,
+        ;; returns the number of bytes read in HL, Z if none
+.file_fill:
+        push hl
+        ld bc, #.FILE_BUF
+        add hl, bc
+        ex de, hl
+        CALL_BDOS #_SETDTA
+        pop de
+        push de
+        ld hl, #.FILE_BUF_SIZE
+        CALL_BDOS #_RDBLK       ; a short read at the end of the file is fine
+        pop de
+        ex de, hl               ; HL = f, DE = bytes read
+        ld bc, #.FILE_POS
+        add hl, bc
+        xor a
+        ld (hl), a
+        inc hl
+        ld (hl), a
+        inc hl
+        ld (hl), e
+        inc hl
+        ld (hl), d
+        ex de, hl
+        ld a, h
+        or l
+        ret
+
+        ;; returns the position in the buffer of the file at HL in BC,
+        ;; the number of bytes left in it in DE, Z if none, keeps HL
+.file_avail:
+        push hl
+        ld bc, #.FILE_POS
+        add hl, bc
+        ld c, (hl)
+        inc hl
+        ld b, (hl)
+        inc hl
+        ld a, (hl)
+        inc hl
+        ld h, (hl)
+        ld l, a
+        or a
+        sbc hl, bc
+        ex de, hl
+        pop hl
+        ld a, d
+        or e
+        ret
+
+; int16_t msxdos_fgetc(msxdos_file_t * f) __z88dk_callee
+_msxdos_fgetc::
+        pop de
+        pop hl
+        push de
+        call .file_avail
+        jr nz, 1$
+        push hl
+        call .file_fill
+        pop hl
+        jr z, 2$                ; end of the file
+        ld bc, #0
+1$:
+        push hl
+        inc bc
+        ld de, #.FILE_POS
+        add hl, de
+        ld (hl), c
+        inc hl
+        ld (hl), b
+        dec bc
+        pop hl
+        ld de, #.FILE_BUF
+        add hl, de
+        add hl, bc
+        ld l, (hl)
+        ld h, #0
+        ret
+2$:
+        ld hl, #-1
+        ret
+
+; uint16_t msxdos_fread(msxdos_file_t * f, void * dst, uint16_t size) __z88dk_callee
+_msxdos_fread::
+        pop hl
+        pop de
+        pop bc
+        ex (sp), hl
+        ld (.fread_file), de
+        ld (.fread_dst), bc
+        ld (.fread_size), hl
+        ld (.fread_left), hl
+1$:
+        ld hl, (.fread_left)
+        ld a, h
+        or l
+        jr z, 5$
+        ld hl, (.fread_file)
+        call .file_avail        ; BC = position, DE = bytes in the buffer
+        jr nz, 3$
+        ld hl, (.fread_left)
+        ld a, h
+        cp #>.FILE_BUF_SIZE
+        jr c, 2$
+        ;; the buffer is empty and a block or more is left:
+        ;; read all of it straight into dst
+        ld de, (.fread_dst)
+        push hl
+        CALL_BDOS #_SETDTA
+        pop hl
+        ld de, (.fread_file)
+        CALL_BDOS #_RDBLK       ; HL = bytes read
+        ex de, hl
+        ld hl, (.fread_left)
+        or a
+        sbc hl, de
+        ld (.fread_left), hl
+        jr 5$
+2$:
+        ld hl, (.fread_file)
+        call .file_fill
+        jr z, 5$                ; end of the file
+        ex de, hl
+        ld bc, #0
+3$:
+        ;; copy min(DE, left) bytes
+        ld hl, (.fread_left)
+        or a
+        sbc hl, de
+        jr nc, 4$
+        ld de, (.fread_left)
+        ld hl, #0
+4$:
+        ld (.fread_left), hl
+        ld hl, (.fread_file)
+        add hl, bc
+        ld bc, #.FILE_BUF
+        add hl, bc
+        ld b, d
+        ld c, e
+        ld de, (.fread_dst)
+        ldir
+        ld (.fread_dst), de
+        ;; position = HL - (f + .FILE_BUF)
+        ld de, (.fread_file)
+        or a
+        sbc hl, de
+        ld bc, #-.FILE_BUF
+        add hl, bc
+        ex de, hl
+        ld bc, #.FILE_POS
+        add hl, bc
+        ld (hl), e
+        inc hl
+        ld (hl), d
+        jr 1$
+5$:
+        ld hl, (.fread_size)
+        ld de, (.fread_left)
+        or a
+        sbc hl, de
+        ret
+
+; void msxdos_fclose(msxdos_file_t * f) __z88dk_callee
+_msxdos_fclose::
+        pop hl
+        pop de
+        push hl
+        JP_BDOS #_FCLOSE
@@ -3,8 +3,62 @@
         .title  "getchar"
         .module getchar
 
+        .CONIN_MAX = 63         ; 64 bytes with the trailing zero of gets(),
+                                ; that match with internal buffer in scanf()
+
+        .area   _DATA
+.conin_mode:
+        .ds     1
+.conin_left::                   ; characters left in the line, with the '\n' at its end
+        .ds     1
+.conin_ptr::
+        .ds     2
+.conin_buf:                     ; _BUFIN: size, length, text and the CR
+        .ds     .CONIN_MAX + 3
+
         .area   _CODE
 
 _getchar::
-        JP_BDOS #_INNOE
-	
\ No newline at end of file
+        call .conout_flush
+        ld a, (.conin_mode)
+        or a
+        jr nz, 1$
+        JP_BDOS #_INNOE         ; MSXDOS_UNBUFFERED
+1$:
+        call .conin_fill
+        ld hl, #.conin_left
+        dec (hl)
+        ld a, #0x0a
+        jr z, 2$
+        ld hl, (.conin_ptr)
+        ld a, (hl)
+        inc hl
+        ld (.conin_ptr), hl
+2$:
+        ld l, a
+        ret
+
+        ;; reads a line with _BUFIN unless some of the last one is left
+.conin_fill::
+        ld a, (.conin_left)
+        or a
+        ret nz
+        call .conout_flush
+        ld de, #.conin_buf
+        ld a, #.CONIN_MAX
+        ld (de), a
+        CALL_BDOS #_BUFIN
+        ld hl, #(.conin_buf + 2)
+        ld (.conin_ptr), hl
+        ld a, (.conin_buf + 1)
+        inc a
+        ld (.conin_left), a
+        ret
+
+; void msxdos_stdin_mode(uint8_t mode) __z88dk_fastcall
+_msxdos_stdin_mode::
+        ld a, l
+        ld (.conin_mode), a
+        xor a
+        ld (.conin_left), a     ; drop what is left of the last line
+        ret
@@ -3,6 +3,8 @@
         .title  "gets"
         .module gets
 
+        .globl  .conin_fill, .conin_left, .conin_ptr
+
         .area   _CODE
 
 _gets::
@@ -11,24 +13,20 @@ _gets::
         push de
         push hl
         push de
-        ld c, #63               ; limit input to 64 bytes including trailing zero
-                                ; that match with internal buffer in scanf()
-1$:
-        push bc
         push de
-        CALL_BDOS #_CONIN
+        call .conin_fill        ; one _BUFIN call for the whole line, with line editing
         pop de
-        pop bc
-	cp #0x0d                ; CR
-        jp z, 2$
-        cp #0x05                ; EOF
-        jp z, 2$
-        ld (de), a
-        inc de
-        dec c
-        jp nz, 1$
-2$:
+        ld hl, #.conin_left
+        ld a, (hl)
+        ld (hl), #0
+        dec a                   ; without the '\n'
+        jr z, 1$
+        ld c, a
+        ld b, #0
+        ld hl, (.conin_ptr)
+        ldir
+1$:
         xor a
         ld (de), a
         pop hl
-        ret
\ No newline at end of file
+        ret
@@ -3,6 +3,21 @@
         .title  "putchar"
         .module putchar
 
+        .CONOUT_BUF_SIZE = 128
+
+        .area   _INITIALIZED
+.conout_mode:
+        .ds     1
+
+        .area   _INITIALIZER
+        .db     1               ; .conout_mode: MSXDOS_LINE_BUFFERED
+
+        .area   _DATA
+.conout_len:
+        .ds     1
+.conout_buf:
+        .ds     .CONOUT_BUF_SIZE + 1    ; and the '$' which ends the string for _STROUT
+
         .area   _CODE
 
 _setchar::
@@ -11,5 +26,71 @@ _putchar::
         pop de
         push de         ; char in E
         push hl
-        JP_BDOS #_CONOUT
-	
\ No newline at end of file
+        ld a, (.conout_mode)
+        or a
+        jr nz, 1$
+        JP_BDOS #_CONOUT        ; MSXDOS_UNBUFFERED
+1$:
+        ld hl, #.conout_len
+        ld c, (hl)
+        inc (hl)
+        ld b, #0
+        ld hl, #.conout_buf
+        add hl, bc
+        ld (hl), e
+        ld a, c
+        cp #(.CONOUT_BUF_SIZE - 1)
+        jr nc, .conout_flush    ; buffer full
+        ld a, e
+        cp #0x0a
+        ret nz
+        ld a, (.conout_mode)
+        dec a
+        ret nz                  ; MSXDOS_FULLY_BUFFERED: no flush at the end of the line
+
+; void msxdos_stdout_flush(void)
+_msxdos_stdout_flush::
+.conout_flush::
+        ld hl, #.conout_len
+        ld a, (hl)
+        or a
+        ret z
+        ld (hl), #0
+        ld c, a
+        ld b, #0
+        ld hl, #.conout_buf
+        add hl, bc
+        ld (hl), #'$'
+        inc c                   ; search up to and including that '$'
+        ld de, #.conout_buf
+1$:
+        ;; _STROUT prints DE up to the first '$', so a '$' in the text
+        ;; ends a part and is printed on its own
+        ld h, d
+        ld l, e
+        ld a, #'$'
+        cpir
+        push hl
+        push bc
+        CALL_BDOS #_STROUT
+        pop bc
+        pop de
+        ld a, b
+        or c
+        ret z                   ; that was the end of the buffer
+        push de
+        push bc
+        ld e, #'$'
+        CALL_BDOS #_CONOUT
+        pop bc
+        pop de
+        jr 1$
+
+; void msxdos_stdout_mode(uint8_t mode) __z88dk_fastcall
+_msxdos_stdout_mode::
+        push hl
+        call .conout_flush
+        pop hl
+        ld a, l
+        ld (.conout_mode), a
+        ret
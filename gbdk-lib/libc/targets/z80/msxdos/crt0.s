@@ -112,6 +112,7 @@
         call _main
 .exit:
         push hl
+        call .conout_flush      ; print what is left in the stdout buffer
         ld l, #0
         call _SWITCH_ROM
         call .restore_int_vector
@@ -156,6 +157,10 @@ _exit::
 
 ___overlay_count::
         .db 0
+___overlay_archive::            ; set by makecom -a: all overlays are in one file (NAME.OVL)
+        .db 0
+_overlay_load_time::            ; JIFFY ticks it took to load the overlays
+        .dw 0
 .overlay_fcb:
         .db 0                   ; drive
 ___overlay_name::
@@ -321,6 +326,8 @@ _shadow_OAM::
 
         ;; load overlays, count in A
 .load_overlays:
+        ld hl, (.JIFFY)
+        ld (_overlay_load_time), hl
         ld b, a
         ld a, (__memman_present)
         or a
@@ -331,6 +338,14 @@ _shadow_OAM::
         cp b
         ret c                   ; not sufficient ram to load overlays
 3$:
+        ld a, (___overlay_archive)
+        or a
+        jr z, 4$
+        push bc
+        call .open_overlay      ; archive is opened once for all overlays
+        pop bc
+        ret c                   ; file not found
+4$:
         ld c, #1
 1$:
         push bc
@@ -349,6 +364,14 @@ _shadow_OAM::
 
         jr 1$
 2$:
+        ld a, (___overlay_archive)
+        or a
+        call nz, .close_overlay
+        ld hl, (.JIFFY)
+        ld de, (_overlay_load_time)
+        or a
+        sbc hl, de
+        ld (_overlay_load_time), hl
         xor a
         call _SWITCH_ROM
         ret
@@ -361,6 +384,10 @@ _shadow_OAM::
 
         call _SWITCH_ROM        ; switch bank to l
 
+        ld a, (___overlay_archive)
+        or a
+        jr nz, 4$               ; archive: read on from the end of the last overlay
+
         ld b, #8
         xor a
 1$:
@@ -386,41 +413,41 @@ _shadow_OAM::
         add e
         ld (hl), a
 
-        xor a
-        ld bc, #(.overlay_fcb_end - .overlay_fcb_extent)
-        ld hl, #.overlay_fcb_extent
-        call .memset_simple     ; initialize fcb
-
-        ld de, #.overlay_fcb
-        CALL_BDOS #_FOPEN
-        rrca
+        call .open_overlay
         ret c                   ; file not found
-
+4$:
         ld de, #0x4000
-3$:
         CALL_BDOS #_SETDTA
 
-        push de
         ld de, #.overlay_fcb
-        CALL_BDOS #_RDSEQ
-        pop de
+        ld hl, #0x4000          ; whole page 1 in one block read of 1 byte records
+        CALL_BDOS #_RDBLK       ; a short read at the end of the file is fine
 
-        rrca
-        jr c, 2$                ; EOF reached
+        ld a, (___overlay_archive)
+        or a                    ; return ok
+        ret nz                  ; archive stays open for the next overlay
+.close_overlay:
+        ld de, #.overlay_fcb
+        CALL_BDOS #_FCLOSE
 
-        ld a, #128
-        ADD_A_REG16 d, e
+        or a                    ; return ok
+        ret
 
-        ld a, #0xc0
-        cp d
-        jr z, 2$                ; end of page1 reached
+        ;; open the file named in .overlay_fcb, carry set on error
+.open_overlay:
+        xor a
+        ld bc, #(.overlay_fcb_end - .overlay_fcb_extent)
+        ld hl, #.overlay_fcb_extent
+        call .memset_simple     ; initialize fcb
 
-        jr 3$
-2$:
         ld de, #.overlay_fcb
-        CALL_BDOS #_FCLOSE
+        CALL_BDOS #_FOPEN
+        rrca
+        ret c
 
-        or a                    ; return ok
+        ld hl, #1               ; record size, block reads count bytes
+        ld (.overlay_fcb_record_size), hl
+        or a
         ret
 
 .restore_int_vector:
@@ -497,6 +524,8 @@ __shadow_OAM_base::
         .db #>_shadow_OAM
 __shadow_OAM_OFF::
         .db 0
+__shadow_OAM_count::
+        .db 32
 .mode::
         .ds .T_MODE_INOUT       ; Current mode
 __old_int_vector::
@@ -8,6 +8,7 @@
         .BDOS           = 0x0005
 
         .EXTBIO         = 0xFFCA
+        .JIFFY          = 0xFC9E ; BIOS VBlank counter, also runs in MSX-DOS
 
         ; MSX-DOS 1
         _TERM0          = 0x00  ; Program terminate
@@ -375,6 +376,9 @@
         ;; interrupt handler
         .globl _INT_ISR
 
+        ;; flush the buffered stdout
+        .globl .conout_flush
+
         ;; Macro definitions
 
 .macro CALL_BDOS fn
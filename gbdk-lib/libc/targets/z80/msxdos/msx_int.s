@@ -4,7 +4,7 @@
         .module INTHandler
 
         .globl  .sys_time, .vbl_done
-        .globl  .OUTI128, __shadow_OAM_base
+        .globl  .OUTI128, .OUTI_A, __shadow_OAM_base, __shadow_OAM_count
 
         .area   _GSINIT
 
@@ -56,7 +56,17 @@ _INT_ISR::
         ld a, #>.VDP_SAT
         out (c), a
         dec c                           ; c == .VDP_DATA
+        ld a, (__shadow_OAM_count)
+        cp #32
+        jr c, 4$
         call .OUTI128
+        jp 1$
+4$:                                     ; only the sprites in use, then the terminator
+        add a
+        add a                           ; 4 bytes per sprite
+        call nz, .OUTI_A
+        ld a, #.VDP_SAT_TERM
+        out (c), a
 1$:
 
         ;; call user-defined VBlank handlers
@@ -3,7 +3,8 @@
         .title  "VRAM utilities"
         .module VRAMUtils
 
-        .globl __shadow_OAM_base
+        .globl __shadow_OAM_base, __shadow_OAM_count, _shadow_VDP_R1
+        .globl .OUTI_A
 
         .ez80
 
@@ -18,10 +19,34 @@ _refresh_OAM::
         ld h, #>_shadow_OAM
         ld l, #0
         ld c, #.VDP_DATA
-        ld b, #128
+
+        ld a, (__shadow_OAM_count)
+        cp #32
+        ld a, #128
+        jr nc, 2$
+        ld a, (__shadow_OAM_count)
+        add a
+        add a                           ; 4 bytes per sprite
+        jr z, 3$
+2$:
+        ;; the TMS9918 has no V counter, so the OUTI block which outruns VRAM
+        ;; during the active display is used while the display is off only
+        ld b, a
+        ld a, (_shadow_VDP_R1)
+        and #.R1_DISP_ON
+        ld a, b
+        jr nz, 1$
+        call .OUTI_A
+        jr 3$
 1$:
         outi
         jp nz, 1$
-
-        ENABLE_VBLANK_COPY      ; switch OFF copy shadow SAT
-        ret
\ No newline at end of file
+3$:
+        ld a, (__shadow_OAM_count)
+        cp #32
+        jr nc, 4$
+        ld a, #.VDP_SAT_TERM
+        out (c), a
+4$:
+        ENABLE_VBLANK_COPY      ; switch ON copy shadow SAT
+        ret
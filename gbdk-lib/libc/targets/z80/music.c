@@ -0,0 +1,202 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <gbdk/platform.h>
+#include <gbdk/music.h>
+
+/* Tracker style music and sound effect driver, see gbdk/music.h
+
+   Each frame the streams are read with their bank switched in, then
+   the voice of each channel (the effect if one plays, else the song)
+   goes through a copy of the last values written to the channel, so
+   only registers whose value changes are written */
+
+typedef struct voice_t {
+    const uint8_t * start;  /* NULL once the stream ended */
+    const uint8_t * ptr;
+    uint8_t bank;
+    uint8_t wait;           /* Frames until the next command is read */
+    uint8_t note;           /* MUSIC_CMD_REST while silent */
+    uint8_t volume;
+    uint8_t duty;
+    uint8_t trigger;        /* A note started */
+} voice_t;
+
+static voice_t song_voices[MUSIC_CHANNELS], sfx_voices[MUSIC_CHANNELS];
+
+/* Last attenuation and tone written to each channel */
+static uint8_t hw_att[MUSIC_CHANNELS];
+static uint16_t hw_period[MUSIC_CHANNELS];
+/* Channels whose registers are all written on the next update */
+static uint8_t hw_reload;
+
+/* 3579545 / 32 / Hz for C3 to B8 */
+static const uint16_t periods[MUSIC_NOTE_COUNT] = {
+    855, 807, 762, 719, 679, 641, 605, 571, 539, 508, 480, 453,
+    428, 404, 381, 360, 339, 320, 302, 285, 269, 254, 240, 226,
+    214, 202, 190, 180, 170, 160, 151, 143, 135, 127, 120, 113,
+    107, 101, 95, 90, 85, 80, 76, 71, 67, 64, 60, 57,
+    53, 50, 48, 45, 42, 40, 38, 36, 34, 32, 30, 28,
+    27, 25, 24, 22, 21, 20, 19, 18, 17, 16, 15, 14
+};
+
+/* Noise pitch 0 - 7 as the 3 fixed rates */
+static const uint8_t noise_rates[8] = {0, 0, 0, 1, 1, 1, 2, 2};
+
+static void voice_start(voice_t * v, const uint8_t * stream, uint8_t bank)
+{
+    v->start = v->ptr = stream;
+    v->bank = bank;
+    v->wait = 1;
+    v->note = MUSIC_CMD_REST;
+    v->volume = 15;
+    v->duty = 2;
+    v->trigger = 0;
+}
+
+/* Reads the commands up to the next note or rest once the current one is over */
+static void voice_step(voice_t * v)
+{
+    const uint8_t * p = v->ptr;
+    uint8_t cmd, count = MUSIC_MAX_COMMANDS;
+
+    v->trigger = 0;
+    if (--v->wait) return;
+    v->wait = 1;
+    while (count--) {
+        cmd = *p++;
+        if (cmd < MUSIC_CMD_REST) {
+            v->note = cmd;
+            v->wait = *p++;
+            v->trigger = 1;
+            break;
+        } else if (cmd == MUSIC_CMD_REST) {
+            v->note = MUSIC_CMD_REST;
+            v->wait = *p++;
+            break;
+        } else if (cmd == MUSIC_CMD_WAIT) {
+            v->wait = *p++;
+            break;
+        } else if (cmd == MUSIC_CMD_VOLUME) {
+            v->volume = *p++;
+        } else if (cmd == MUSIC_CMD_DUTY) {
+            v->duty = *p++;
+        } else if (cmd == MUSIC_CMD_LOOP) {
+            p = v->start + (p[0] | ((uint16_t)p[1] << 8));
+        } else {
+            v->start = NULL;
+            v->note = MUSIC_CMD_REST;
+            break;
+        }
+    }
+    v->ptr = p;
+}
+
+static void hw_write(uint8_t ch, const voice_t * v)
+{
+    uint8_t mask = 1 << ch;
+    uint8_t att = (v->note == MUSIC_CMD_REST) ? 15 : 15 - v->volume;
+    uint8_t latch = PSG_LATCH | (ch << 5);
+    uint16_t period;
+
+    if (hw_reload & mask) {
+        hw_att[ch] = ~att;
+        hw_period[ch] = 0xFFFF;
+        hw_reload &= ~mask;
+    }
+
+    if (att != hw_att[ch]) {
+        hw_att[ch] = att;
+        PSG = latch | PSG_VOLUME | att;
+    }
+    if (att == 15) return;
+
+    if (ch == MUSIC_CH_NOISE) {
+        /* White noise unless bit 3 is set. Writing it restarts the noise,
+           so it is written for every note. */
+        period = ((v->note & 0x08) ? 0 : 0x04) | noise_rates[v->note & 0x07];
+        if (v->trigger || (period != hw_period[ch])) PSG = latch | (uint8_t)period;
+    } else {
+        /* The latch byte alone sets the low 4 bits, the data byte the other 6 */
+        period = periods[v->note];
+        if ((period >> 4) != (hw_period[ch] >> 4)) {
+            PSG = latch | ((uint8_t)period & 0x0F);
+            PSG = (uint8_t)(period >> 4);
+        } else if (period != hw_period[ch]) {
+            PSG = latch | ((uint8_t)period & 0x0F);
+        }
+    }
+    hw_period[ch] = period;
+}
+
+void music_play(const music_song_t * song, uint8_t bank)
+{
+    uint8_t save_bank = CURRENT_BANK, ch;
+
+    CRITICAL {
+        if (bank) SWITCH_ROM(bank);
+        for (ch = 0; ch != MUSIC_CHANNELS; ch++) {
+            if (song->channels[ch]) voice_start(song_voices + ch, song->channels[ch], bank);
+            else {
+                song_voices[ch].start = NULL;
+                song_voices[ch].note = MUSIC_CMD_REST;
+            }
+        }
+        SWITCH_ROM(save_bank);
+        hw_reload = (1 << MUSIC_CHANNELS) - 1;
+    }
+}
+
+void music_stop(void)
+{
+    uint8_t ch;
+
+    CRITICAL {
+        for (ch = 0; ch != MUSIC_CHANNELS; ch++) {
+            song_voices[ch].start = NULL;
+            song_voices[ch].note = MUSIC_CMD_REST;
+            if (!sfx_voices[ch].start) hw_write(ch, song_voices + ch);
+        }
+    }
+}
+
+void music_sfx_play(const uint8_t * stream, uint8_t bank, uint8_t channel)
+{
+    CRITICAL {
+        voice_start(sfx_voices + channel, stream, bank);
+    }
+}
+
+uint8_t music_playing(void)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch != MUSIC_CHANNELS; ch++)
+        if (song_voices[ch].start) return 1;
+    return 0;
+}
+
+void music_update(void)
+{
+    uint8_t save_bank = CURRENT_BANK, ch;
+    voice_t * song = song_voices, * sfx = sfx_voices;
+
+    for (ch = 0; ch != MUSIC_CHANNELS; ch++, song++, sfx++) {
+        if (song->start) {
+            if (song->bank) SWITCH_ROM(song->bank);
+            voice_step(song);
+        }
+        if (sfx->start) {
+            if (sfx->bank) SWITCH_ROM(sfx->bank);
+            voice_step(sfx);
+            if (sfx->start) {
+                hw_write(ch, sfx);
+                continue;
+            }
+            /* The effect ended: the song takes the channel back */
+            hw_reload |= 1 << ch;
+            song->trigger = 1;
+        }
+        hw_write(ch, song);
+    }
+    SWITCH_ROM(save_bank);
+}
@@ -18,3 +18,19 @@
         .endm
 .OUTI_END::                             ; _outi_block label points to END of OUTI block
         ret
+
+.OUTI_A::                               ; writes A bytes (1 - 128) from (HL) to port C with the OUTI block, clobbers A
+        push de
+        ex de, hl
+        ld l, a
+        ld h, #0
+        add hl, hl                      ; an OUTI is 2 bytes
+        ld a, #<.OUTI_END
+        sub l
+        ld l, a
+        ld a, #>.OUTI_END
+        sbc h
+        ld h, a
+        ex (sp), hl                     ; the RET of the block returns to the caller
+        ex de, hl
+        ret
@@ -0,0 +1,113 @@
+#include <stdint.h>
+#include <string.h>
+#include <gbdk/platform.h>
+#include <gbdk/gbdecompress.h>
+#include <gbdk/rledecompress.h>
+#include <gbdk/packed_map.h>
+
+/* VRAM is not memory mapped on these targets, so tiles can't be
+   gb-decompressed into it and only maps and RAM are handled that way */
+
+#define PM_TILE_SIZE 32
+#define PM_CHUNK     128 /* Bytes per call, counts are 8 bit */
+
+static uint8_t pm_buf[DEVICE_SCREEN_BUFFER_WIDTH * 2];
+
+static void pm_load_tiles(const packed_map_section_t * s, const uint8_t * src, uint16_t first)
+{
+    uint16_t n = s->size / PM_TILE_SIZE;
+
+    if (s->compression == PACKED_MAP_RLE) {
+        rle_init((void *)src);
+        for (; n; n--) {
+            rle_decompress(pm_buf, PM_TILE_SIZE);
+            set_native_tile_data(first++, 1, pm_buf);
+        }
+    } else
+        set_native_tile_data(first, n, src);
+}
+
+/* Draws the map section at 0, 0, with the attributes of each tile if interleaved */
+static void pm_draw_map(const packed_map_header_t * hdr, const packed_map_section_t * s, const uint8_t * src)
+{
+    uint8_t w = hdr->map_w, h = hdr->map_h;
+    uint8_t interleaved = hdr->flags & PACKED_MAP_INTERLEAVED;
+    uint8_t y;
+
+    if (s->compression == PACKED_MAP_RLE) {
+        rle_init((void *)src);
+        for (y = 0; y < h; y++) {
+            rle_decompress(pm_buf, (interleaved) ? (w * 2) : w);
+            if (interleaved)
+                set_tile_map(0, y, w, 1, pm_buf);
+            else
+                set_bkg_tiles(0, y, w, 1, pm_buf);
+        }
+    } else if (interleaved)
+        set_tile_map(0, 0, w, h, src);
+    else
+        set_bkg_tiles(0, 0, w, h, src);
+}
+
+static void pm_unpack(const packed_map_section_t * s, const uint8_t * src, uint8_t * dest)
+{
+    uint16_t n = s->size;
+    uint8_t count;
+
+    if (s->compression == PACKED_MAP_GB) {
+        gb_decompress(src, dest);
+    } else if (s->compression == PACKED_MAP_RLE) {
+        rle_init((void *)src);
+        for (; n; n -= count) {
+            count = (n > PM_CHUNK) ? PM_CHUNK : n;
+            rle_decompress(dest, count);
+            dest += count;
+        }
+    } else
+        memcpy(dest, src, n);
+}
+
+/* Returns PACKED_MAP_OK if every section can be loaded */
+static uint8_t pm_check(const packed_map_header_t * hdr, const packed_map_section_t * s, uint8_t * map_buf)
+{
+    uint8_t i;
+
+    if ((hdr->magic[0] != PACKED_MAP_MAGIC_0) || (hdr->magic[1] != PACKED_MAP_MAGIC_1) || (hdr->version != PACKED_MAP_VERSION))
+        return PACKED_MAP_ERR_FORMAT;
+
+    for (i = 0; i < hdr->section_count; i++, s++) {
+        if ((s->compression > PACKED_MAP_RLE) ||
+            ((s->type == PACKED_MAP_SECTION_TILES) && (s->compression == PACKED_MAP_GB)))
+            return PACKED_MAP_ERR_FORMAT;
+        if (s->type == PACKED_MAP_SECTION_MAP) {
+            if ((map_buf == NULL) &&
+                ((s->compression == PACKED_MAP_GB) || (hdr->flags & PACKED_MAP_TRANSPOSED) ||
+                 (hdr->map_w > DEVICE_SCREEN_BUFFER_WIDTH) || (hdr->map_h > DEVICE_SCREEN_BUFFER_HEIGHT)))
+                return PACKED_MAP_ERR_BUF;
+        } else if (s->type != PACKED_MAP_SECTION_TILES)
+            return PACKED_MAP_ERR_FORMAT;
+    }
+    return PACKED_MAP_OK;
+}
+
+uint8_t load_packaged_map(const uint8_t * data, uint8_t * map_buf)
+{
+    const packed_map_header_t * hdr = (const packed_map_header_t *)data;
+    const packed_map_section_t * s = (const packed_map_section_t *)(hdr + 1);
+    const uint8_t * src;
+    uint8_t ret, i;
+
+    if ((ret = pm_check(hdr, s, map_buf)) != PACKED_MAP_OK)
+        return ret;
+
+    for (i = 0; i < hdr->section_count; i++, s++) {
+        src = data + s->offset;
+        if (s->type == PACKED_MAP_SECTION_TILES)
+            pm_load_tiles(s, src, hdr->first_tile);
+        else if (map_buf)
+            pm_unpack(s, src, map_buf);
+        else
+            pm_draw_map(hdr, s, src);
+    }
+    return PACKED_MAP_OK;
+}
@@ -0,0 +1,170 @@
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <gbdk/palette_fade.h>
+
+/* Palette fades and animations uploaded from VBlank, see gbdk/palette_fade.h */
+
+/* Internal flag: upload the whole first step, whatever its range says */
+#define PALETTE_FADE_WHOLE 0x80
+
+static const palette_color_t * fade_table;
+static uint8_t fade_first, fade_count, fade_steps, fade_frames, fade_flags, fade_timer;
+/* Next step to upload, fade_steps once done */
+static volatile uint8_t fade_step;
+/* Range of colors each step changes, fade_lo is 0xFF if none */
+static uint8_t fade_lo[PALETTE_FADE_STEPS_MAX], fade_hi[PALETTE_FADE_STEPS_MAX];
+
+static uint8_t palette_fade_component(uint8_t a, uint8_t b, uint8_t step, uint8_t steps)
+{
+    if (a > b) return a - (uint8_t)(((uint16_t)(a - b) * step) / steps);
+    return a + (uint8_t)(((uint16_t)(b - a) * step) / steps);
+}
+
+#if defined(__TARGET_gg)
+/* 4 bits each of red, green and blue */
+static palette_color_t palette_fade_mix(palette_color_t a, palette_color_t b, uint8_t step, uint8_t steps)
+{
+    return (palette_color_t)palette_fade_component(a & 0x0F, b & 0x0F, step, steps) |
+           ((palette_color_t)palette_fade_component((a >> 4) & 0x0F, (b >> 4) & 0x0F, step, steps) << 4) |
+           ((palette_color_t)palette_fade_component((a >> 8) & 0x0F, (b >> 8) & 0x0F, step, steps) << 8);
+}
+
+/* CRAM write, 2 bytes per color */
+static void palette_fade_upload(uint8_t index, const palette_color_t * colors, uint8_t n)
+{
+    VDP_CMD = index << 1;
+    VDP_CMD = 0xC0;
+    for (; n; n--, colors++) {
+        VDP_DATA = (uint8_t)*colors;
+        VDP_DATA = (uint8_t)(*colors >> 8);
+    }
+}
+#else
+/* 2 bits each of red, green and blue */
+static palette_color_t palette_fade_mix(palette_color_t a, palette_color_t b, uint8_t step, uint8_t steps)
+{
+    return palette_fade_component(a & 0x03, b & 0x03, step, steps) |
+           (palette_fade_component((a >> 2) & 0x03, (b >> 2) & 0x03, step, steps) << 2) |
+           (palette_fade_component((a >> 4) & 0x03, (b >> 4) & 0x03, step, steps) << 4);
+}
+
+/* CRAM write, 1 byte per color */
+static void palette_fade_upload(uint8_t index, const palette_color_t * colors, uint8_t n)
+{
+    VDP_CMD = index;
+    VDP_CMD = 0xC0;
+    for (; n; n--) VDP_DATA = *colors++;
+}
+#endif
+
+/* Range of colors in row which differ from prev, all of them without prev */
+static void palette_fade_range(uint8_t step, const palette_color_t * row, const palette_color_t * prev)
+{
+    uint8_t i, lo = 0xFF, hi = 0;
+
+    for (i = 0; i != fade_count; i++) {
+        if ((prev == NULL) || (row[i] != prev[i])) {
+            if (lo == 0xFF) lo = i;
+            hi = i;
+        }
+    }
+    fade_lo[step] = lo;
+    fade_hi[step] = hi;
+}
+
+static void palette_fade_setup(const palette_color_t * table, const palette_color_t * from, uint8_t first, uint8_t count,
+                               uint8_t steps, uint8_t frames, uint8_t flags)
+{
+    const palette_color_t * row = table;
+    uint8_t s;
+
+    palette_fade_stop();
+    if (steps > PALETTE_FADE_STEPS_MAX) steps = PALETTE_FADE_STEPS_MAX;
+    if ((uint8_t)(first + count) > PALETTE_FADE_COLORS_MAX) count = PALETTE_FADE_COLORS_MAX - first;
+
+    fade_table = table;
+    fade_first = first;
+    fade_count = count;
+    fade_frames = frames;
+    fade_flags = flags;
+    fade_timer = 0;
+    for (s = 0; s != steps; s++, row += count) {
+        palette_fade_range(s, row, from);
+        from = row;
+    }
+    /* Looping back to the first row only needs what differs from the last one */
+    if ((flags & PALETTE_FADE_LOOP) && (steps > 1)) palette_fade_range(0, table, row - count);
+
+    /* The VBlank handler starts once the step count is set */
+    CRITICAL {
+        fade_step = 0;
+        fade_steps = steps;
+    }
+}
+
+void palette_fade_start(palette_color_t * table, const palette_color_t * from, const palette_color_t * to,
+                        uint8_t first, uint8_t count, uint8_t steps, uint8_t frames)
+{
+    palette_color_t * row = table;
+    uint8_t s, i;
+
+    palette_fade_stop();
+    if (steps == 0) return;
+    if (steps > PALETTE_FADE_STEPS_MAX) steps = PALETTE_FADE_STEPS_MAX;
+    for (s = 1; s <= steps; s++, row += count) {
+        for (i = 0; i != count; i++) {
+            row[i] = (s == steps) ? to[i] : palette_fade_mix(from[i], to[i], s, steps);
+        }
+    }
+    palette_fade_setup(table, from, first, count, steps, frames, 0);
+}
+
+void palette_fade_play(const palette_color_t * table, uint8_t first, uint8_t count,
+                       uint8_t steps, uint8_t frames, uint8_t flags)
+{
+    palette_fade_setup(table, NULL, first, count, steps, frames, flags | PALETTE_FADE_WHOLE);
+}
+
+void palette_fade_stop(void)
+{
+    CRITICAL {
+        fade_steps = fade_step = 0;
+    }
+}
+
+uint8_t palette_fade_busy(void)
+{
+    return fade_step != fade_steps;
+}
+
+void palette_fade_wait(void)
+{
+    while (fade_step != fade_steps) {
+        vsync();
+    }
+}
+
+void palette_fade_vbl(void)
+{
+    uint8_t step = fade_step, lo;
+
+    if (step == fade_steps) return;
+    if (fade_timer) {
+        fade_timer--;
+        return;
+    }
+    /* The interrupted code is writing to the VDP, try again next frame */
+    if (_shadow_OAM_OFF) return;
+    if (fade_flags & PALETTE_FADE_WHOLE) {
+        fade_flags &= ~PALETTE_FADE_WHOLE;
+        palette_fade_upload(fade_first, fade_table, fade_count);
+    } else {
+        lo = fade_lo[step];
+        if (lo != 0xFF) palette_fade_upload(fade_first + lo, fade_table + ((uint16_t)step * fade_count) + lo, fade_hi[step] - lo + 1);
+    }
+    fade_timer = fade_frames ? fade_frames - 1 : 0;
+    if (++step == fade_steps) {
+        if (fade_flags & PALETTE_FADE_LOOP) step = 0;
+    }
+    fade_step = step;
+}
@@ -0,0 +1,91 @@
+        .include    "global.s"
+
+        .title  "Metasprites"
+        .module CopyOAMFrame
+
+        .globl  ___current_metasprite, ___render_shadow_OAM
+
+        .area   _CODE
+
+; uint8_t __copy_oam_frame(uint8_t id, uint8_t x, uint8_t y) __z88dk_callee __preserves_regs(iyh,iyl);
+;
+; ___current_metasprite points to a png2asset OAM frame: the number of
+; sprites, then y, x, tile and props of each one, with y and x relative
+; to the pivot. Props are skipped, the SAT has none.
+
+___copy_oam_frame::
+        ld      hl, #4
+        add     hl, sp
+
+        ld      a, (hl)         ; y
+        dec     hl
+        ld      c, (hl)         ; x
+        dec     hl
+        ld      e, (hl)         ; id
+
+        push    ix
+        ld      ixh, a
+
+        ld      a, #64          ; clip the count to the sprites left in the SAT
+        sub     e
+        jr      c, 4$
+        ld      hl, (___current_metasprite)
+        cp      (hl)
+        jr      c, 1$
+        ld      a, (hl)
+1$:
+        inc     hl
+        or      a
+        jr      z, 5$
+        ld      b, a
+        push    bc              ; return value
+
+        ld      a, (___render_shadow_OAM)
+        ld      d, a
+2$:
+        ld      a, (hl)         ; y
+        inc     hl
+        add     a, ixh
+        cp      #0xD0
+        jr      nz, 3$
+        ld      a, #0xC0
+3$:
+        ld      (de), a
+
+        push    de
+
+        ld      a, e
+        add     a
+        add     #0x40
+        ld      e, a
+
+        ld      a, (hl)         ; x
+        inc     hl
+        add     c
+        ld      (de), a
+        inc     e
+
+        ld      a, (hl)         ; tile
+        inc     hl
+        ld      (de), a
+        inc     hl              ; props
+
+        pop     de
+        inc     e
+
+        djnz    2$
+
+        pop     bc
+        ld      a, b
+        jr      5$
+4$:
+        xor     a
+5$:
+        pop     ix
+
+        pop     hl
+        pop     bc
+        inc     sp
+        push    hl
+        ld      l, a
+        ret
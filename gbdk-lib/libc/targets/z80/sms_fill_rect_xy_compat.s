@@ -1,15 +1,16 @@
         .include        "global.s"
 
-        .globl .vdp_shift
-
         .title  "VRAM utilities"
         .module VRAMUtils
 
+        .globl  .vdp_fill_words_low, .vdp_shift
+
         .ez80
 
         .area   _HOME
 
         ;; Set background tile table from (BC) at XY = DE of size WH = HL
+        ;; Only the byte at .vdp_shift of each entry is written
 .fill_rect_xy_compat::
         push hl
         ld hl, #.VDP_TILEMAP
@@ -20,7 +21,7 @@
 
         ld a, d
         rrca                    ; rrca(2) == rlca(6)
-        rrca 
+        rrca
         ld d, a
         and #0x07
         add h
@@ -41,61 +42,112 @@
         pop hl                  ; HL = source
         pop de                  ; DE = HW
         push ix                 ; save IX
-        push de                 ; store HW
+
         ld ixh, b
         ld ixl, c
-        push ix                 ; store dest
 
         DISABLE_VBLANK_COPY     ; switch OFF copy shadow SAT
 
-1$:                             ; copy H rows
-        VDP_WRITE_CMD ixh, ixl
-        ld c, #.VDP_DATA
-2$:                             ; copy W tiles
-        out (c), l
-        VDP_DELAY
-        in a, (c)               ; skip next byte
+        ld a, e
+        cp #.VDP_MAP_WIDTH
+        jr nc, 10$
 
+1$:                             ; fill H rows
+        push de                 ; store HW
+        VDP_WRITE_CMD ixh, ixl
         ld a, ixl
-        and #0x3F
-        inc a
-        inc a
-        bit 6, a
-        jp z, 3$
-        and #0x3F
+        and #0x3E
+        rrca                    ; X
+        sub #.VDP_MAP_WIDTH
+        neg                     ; tiles up to the end of the row
+        cp e
+        jr c, 2$
+        ld a, e
+2$:
         ld b, a
+        ld a, e
+        sub b
+        push af                 ; store tiles which wrap to the start of the row
+        ld e, b
+        ld d, #0
+        call .vdp_fill_words_low
+        pop af
+        or a
+        jr z, 3$
+        ld e, a
+        ld d, #0
         ld a, ixl
-        and #0xC0
-        or b
-        ld ixl, a
-        VDP_WRITE_CMD ixh, ixl
-        dec e
-        jp nz, 2$
-        jp 7$
+        and #0xC1
+        ld b, a
+        VDP_WRITE_CMD ixh, b
+        call .vdp_fill_words_low
 3$:
-        inc ixl
-        inc ixl
-        dec e
-        jp nz, 2$
-7$:
-        pop ix
         pop de
 
         dec d
         jr z, 6$
 
-        push de
-
         ld bc, #0x40
         add ix, bc
         ld a, ixh
         cp #>(.VDP_TILEMAP+0x0700)
-        jp c, 4$
+        jp c, 1$
         ld ixh, #>.VDP_TILEMAP
-4$:        
-        push ix
         jp 1$
+
+10$:                            ; full rows follow each other in VRAM
+        ld a, d
+        cp #.VDP_MAP_HEIGHT
+        jr c, 11$
+        ld d, #.VDP_MAP_HEIGHT
+11$:
+        ld a, ixl
+        and #0xC1
+        ld ixl, a
+        ld a, #>(.VDP_TILEMAP+0x0700)
+        sub ixh
+        add a
+        add a
+        ld b, a
+        ld a, ixl
+        rlca
+        rlca
+        and #0x03
+        neg
+        add b                   ; rows up to the bottom of the map
+        cp d
+        jr c, 12$
+        ld a, d
+12$:
+        ld b, a
+        ld a, d
+        sub b
+        push af                 ; store rows which wrap to the top of the map
+        VDP_WRITE_CMD ixh, ixl
+        call 13$
+        pop af
+        or a
+        jr z, 6$
+        ld b, a
+        ld a, ixl
+        and #0x01
+        ld ixl, a
+        ld ixh, #>.VDP_TILEMAP
+        VDP_WRITE_CMD ixh, ixl
+        call 13$
 6$:
         ENABLE_VBLANK_COPY      ; switch ON copy shadow SAT
         pop ix                  ; restore IX
-        ret
\ No newline at end of file
+        ret
+
+13$:                            ; fill B rows
+        ld a, b
+        rrca
+        rrca
+        rrca
+        ld d, a
+        and #0xE0
+        ld e, a
+        xor d
+        ld d, a                 ; DE = B * 32
+        jp .vdp_fill_words_low
@@ -4,7 +4,7 @@
         .module INTHandler
 
         .globl  .sys_time, .vbl_done
-        .globl  .OUTI128, .OUTI64, __shadow_OAM_base
+        .globl  .OUTI128, .OUTI64, .OUTI_A, __shadow_OAM_base, __shadow_OAM_count
 
         .area   _HOME
 
@@ -44,6 +44,9 @@ _INT_ISR::
         ld a, #>.VDP_SAT
         out (c), a
         dec c                           ; c == .VDP_DATA
+        ld a, (__shadow_OAM_count)
+        cp #64
+        jr c, 4$
         call .OUTI64
         inc c                           ; c == .VDP_CMD
         ld a, #<(.VDP_SAT + 0x80)
@@ -52,6 +55,23 @@ _INT_ISR::
         out (c), a
         dec c                           ; c == .VDP_DATA
         call .OUTI128
+        jp 1$
+4$:                                     ; only the sprites in use, then the terminator
+        push af
+        or a
+        call nz, .OUTI_A
+        ld a, #.VDP_SAT_TERM
+        out (c), a
+        inc c                           ; c == .VDP_CMD
+        ld a, #<(.VDP_SAT + 0x80)
+        out (c), a
+        ld a, #>(.VDP_SAT + 0x80)
+        out (c), a
+        dec c                           ; c == .VDP_DATA
+        ld l, #0x40                     ; X and tile table of the shadow OAM
+        pop af
+        add a                           ; X and tile of each sprite
+        call nz, .OUTI_A
 1$:
 
         ;; call user-defined VBlank handlers
@@ -0,0 +1,111 @@
+        .include    "global.s"
+
+        .title  "Sprites"
+        .module OAMBatch
+
+        .globl  ___render_shadow_OAM
+
+        .area   _CODE
+
+; void move_sprites(uint8_t first, uint8_t count, const uint8_t * xy) __z88dk_callee __preserves_regs(iyh, iyl);
+_move_sprites::
+        pop     hl
+        pop     bc              ; C = first, B = count
+        pop     de              ; DE = xy, the x and y of each sprite
+        push    hl
+
+        ld      a, b
+        or      a
+        ret     z
+
+        ld      a, (___render_shadow_OAM)
+        ld      h, a
+        ld      l, c            ; HL = &y[first]
+        ld      c, b
+        push    de
+        push    hl
+
+        ;; The Y table first, every second byte of xy
+        inc     de
+1$:
+        ld      a, (de)
+        inc     de
+        inc     de
+        cp      #.VDP_SAT_TERM  ; which would end the sprite list
+        jr      c, 2$
+        ld      a, #0xC0
+2$:
+        ld      (hl), a
+        inc     l
+        djnz    1$
+
+        ;; Then X, in the X and tile pairs after the Y table
+        pop     hl
+        pop     de
+        ld      a, l
+        add     a
+        add     #0x40
+        ld      l, a
+        ld      b, c
+3$:
+        ld      a, (de)
+        inc     de
+        inc     de
+        ld      (hl), a
+        inc     l
+        inc     l
+        djnz    3$
+        ret
+
+; void shadow_oam_write_block(uint8_t first, uint8_t count, const OAM_item_t * src) __z88dk_callee __preserves_regs(iyh, iyl);
+_shadow_oam_write_block::
+        pop     hl
+        pop     bc              ; C = first, B = count
+        pop     de              ; DE = src, the y, x and tile of each sprite
+        push    hl
+
+        ld      a, b
+        or      a
+        ret     z
+
+        ld      a, (___render_shadow_OAM)
+        ld      h, a
+        ld      l, c            ; HL = &y[first]
+        ld      c, b
+        push    de
+        push    hl
+
+        ;; The Y table first
+1$:
+        ld      a, (de)
+        inc     de
+        inc     de
+        inc     de
+        cp      #.VDP_SAT_TERM  ; which would end the sprite list
+        jr      c, 2$
+        ld      a, #0xC0
+2$:
+        ld      (hl), a
+        inc     l
+        djnz    1$
+
+        ;; Then the X and tile pairs after it
+        pop     hl
+        pop     de
+        ld      a, l
+        add     a
+        add     #0x40
+        ld      l, a
+        ld      b, c
+3$:
+        inc     de
+        ld      a, (de)
+        inc     de
+        ld      (hl), a
+        inc     l
+        ld      a, (de)
+        inc     de
+        ld      (hl), a
+        inc     l
+        djnz    3$
+        ret
@@ -0,0 +1,76 @@
+        .include        "global.s"
+
+        ;; Shadow OAM double buffering
+        ;;
+        ;; The VBlank handler copies the page in __shadow_OAM_base to the SAT,
+        ;; the metasprite functions render into the page in ___render_shadow_OAM.
+        ;; A swap shows the finished page by writing __shadow_OAM_base, which
+        ;; is a single byte so the VBlank handler always sees either the old
+        ;; or the new page, never a page which is half way through an update.
+
+        .title  "OAMDoubleBuffer"
+        .module OAMDoubleBuffer
+
+        .globl  __shadow_OAM_base, ___render_shadow_OAM
+
+        .area   _INITIALIZED
+.oam_double_buffer_xor:         ; MSB of shadow_OAM ^ MSB of the second buffer, 0 when disabled
+        .ds     0x01
+
+        .area   _INITIALIZER
+        .db     0x00
+
+        .area   _HOME
+
+; void oam_double_buffer_enable(void * buffer)
+; hl: buffer, 256-byte aligned
+
+_oam_double_buffer_enable::
+        ex de, hl
+        ld hl, #_shadow_OAM
+        ld e, l
+        call .oam_double_buffer_copy
+        ld a, d
+        ld (___render_shadow_OAM), a
+        xor #>_shadow_OAM
+        ld (.oam_double_buffer_xor), a
+        ret
+
+; void oam_double_buffer_swap(void)
+
+_oam_double_buffer_swap::
+        ld hl, #___render_shadow_OAM
+        ld a, (hl)
+        ld (__shadow_OAM_base), a       ; shown from the next VBlank on
+        ld a, (.oam_double_buffer_xor)
+        xor (hl)
+        ld (hl), a                      ; render into the other page
+        ret
+
+; void oam_double_buffer_disable(void)
+
+_oam_double_buffer_disable::
+        ;; keep the sprites which are on screen
+        ld a, (__shadow_OAM_base)
+        cp #>_shadow_OAM
+        jr z, 1$
+        or a
+        jr z, 1$
+        ld h, a
+        ld l, #0
+        ld de, #_shadow_OAM
+        call .oam_double_buffer_copy
+        ld a, #>_shadow_OAM
+        ld (__shadow_OAM_base), a
+1$:
+        xor a
+        ld (.oam_double_buffer_xor), a
+        ld a, #>_shadow_OAM
+        ld (___render_shadow_OAM), a
+        ret
+
+; copies the 64 Y and 128 X / tile bytes of the shadow SAT from hl to de
+.oam_double_buffer_copy:
+        ld bc, #(64 + 128)
+        ldir
+        ret
@@ -3,7 +3,12 @@
         .title  "VRAM utilities"
         .module VRAMUtils
 
-        .globl __shadow_OAM_base
+        .globl __shadow_OAM_base, __shadow_OAM_count, _shadow_VDP_R1
+        .globl .OUTI_A
+
+        ;; V counter range where the OUTI block finishes before the active display
+        .SAT_FAST_VCOUNT_FIRST = 0xC0
+        .SAT_FAST_VCOUNT_LAST  = 0xF0
 
         .ez80
 
@@ -12,23 +17,81 @@
 ; void refresh_OAM(); 
 _refresh_OAM::
         DISABLE_VBLANK_COPY     ; switch OFF copy shadow SAT
-        ld de, #.VDP_SAT
-        VDP_WRITE_CMD d, e
 
-        ld h, #>_shadow_OAM
+        ld a, i
+        push af                 ; P/V == interrupts were enabled
+
+        ;; the OUTI block outruns VRAM during the active display, so it is used
+        ;; while the display is off or with enough VBlank lines left only
+        ld e, #1
+        ld a, (_shadow_VDP_R1)
+        and #.R1_DISP_ON
+        jr z, 4$
+        di                      ; interrupt handlers must not use up the VBlank lines
+        in a, (.VDP_VCOUNTER)
+        cp #.SAT_FAST_VCOUNT_FIRST
+        jr c, 5$
+        cp #.SAT_FAST_VCOUNT_LAST
+        jr c, 4$
+5$:
+        dec e                   ; timing safe loop
+        pop af
+        push af
+        jp po, 4$
+        ei
+4$:
+        ld hl, #.VDP_SAT
+        VDP_WRITE_CMD h, l
+
+        ld a, (__shadow_OAM_base)       ; copy the page the VBlank copy would use
+        or a
+        jr nz, 3$
+        ld a, #>_shadow_OAM             ; or shadow_OAM while the VBlank copy is disabled
+3$:
+        ld h, a
         ld l, #0
         ld c, #.VDP_DATA
-        ld b, #64
+
+        ld a, (__shadow_OAM_count)
+        cp #64
+        jr c, 6$
+        ld a, #64
+        call .refresh_OAM_write
+        ld a, #128
+        jr 7$
+6$:                                     ; only the sprites in use, then the terminator
+        ld d, a
+        or a
+        call nz, .refresh_OAM_write
+        ld a, #.VDP_SAT_TERM
+        out (c), a
+        ld a, d
+        add a                           ; X and tile of each sprite
+7$:
+        ld d, a
+        ld a, #<(.VDP_SAT + 0x80)
+        out (#.VDP_CMD), a
+        ld a, #>(.VDP_SAT + 0x80)
+        out (#.VDP_CMD), a
+        ld l, #0x40                     ; X and tile table of the shadow OAM
+        ld a, d
+        or a
+        call nz, .refresh_OAM_write
+
+        pop af
+        jp po, 8$
+        ei
+8$:
+        ENABLE_VBLANK_COPY      ; switch ON copy shadow SAT
+        ret
+
+;; writes A bytes from (HL) to port C, with the OUTI block when E != 0
+.refresh_OAM_write:
+        inc e
+        dec e
+        jp nz, .OUTI_A
+        ld b, a
 1$:
         outi
         jp nz, 1$
-
-        ld de, #(.VDP_SAT + 0x80)
-        VDP_WRITE_CMD d, e
-        ld b, #128
-2$:
-        outi
-        jp nz, 2$
-
-        ENABLE_VBLANK_COPY      ; switch OFF copy shadow SAT
-        ret
\ No newline at end of file
+        ret
@@ -0,0 +1,68 @@
+        .include        "global.s"
+
+        .title  "VRAM utilities"
+        .module VRAMUtils
+
+        .globl  .OUTI128, .OUTI32
+
+        .area   _HOME
+
+; void set_native_tile_data_fast(uint16_t start, uint16_t ntiles, const void *src) __z88dk_callee __preserves_regs(iyh,iyl);
+; Same as set_native_tile_data(), but through the unrolled OUTI blocks: only during VBlank or with the display off
+_set_native_tile_data_fast::
+        pop de          ; pop ret address
+        pop hl
+
+        add hl, hl
+        add hl, hl
+        add hl, hl
+        add hl, hl
+        add hl, hl
+
+        ld bc, #.VDP_VRAM
+        add hl, bc
+
+        DISABLE_VBLANK_COPY        ; switch OFF copy shadow SAT
+
+        VDP_WRITE_CMD h, l
+
+        pop bc
+        pop hl
+        push de
+
+        ld a, c
+        and #3
+        push af                 ; tiles left after the blocks of 4
+
+        srl b                   ; de = blocks of 4 tiles
+        rr c
+        srl b
+        rr c
+        ld e, c
+        ld d, b
+
+        ld c, #.VDP_DATA
+        inc d
+        inc e
+        jr 2$
+
+1$:
+        call .OUTI128
+2$:
+        dec e
+        jr  nz, 1$
+
+        dec d
+        jr nz, 1$
+
+        pop af
+        or a
+        jr z, 4$
+3$:
+        call .OUTI32
+        dec a
+        jr nz, 3$
+4$:
+        ENABLE_VBLANK_COPY         ; switch ON copy shadow SAT
+
+        ret
@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <string.h>
+#include <gbdk/platform.h>
+#include <gbdk/metasprites.h>
+#include <gbdk/sprite_mux.h>
+
+/* Scanline aware sprite multiplexing, see gbdk/sprite_mux.h */
+
+#define SPRITE_MUX_BINS (256 / SPRITE_MUX_BIN_LINES)
+
+#if defined(__TARGET_msxdos)
+/* 4 bytes per sprite: Y, X, tile, color */
+#define SPRITE_MUX_SIZEOF 4
+#define SPRITE_MUX_Y(oam, n) (oam)[(uint8_t)((n) << 2)]
+#define SPRITE_MUX_HEIGHT() ((uint8_t)(((__READ_VDP_REG(VDP_R1) & R1_SPR_16X16) ? 16 : 8) << (__READ_VDP_REG(VDP_R1) & R1_SPR_MAG)))
+#else
+/* Y table, then X and tile pairs at 0x40 */
+#define SPRITE_MUX_SIZEOF 3
+#define SPRITE_MUX_Y(oam, n) (oam)[(n)]
+#define SPRITE_MUX_HEIGHT() ((__READ_VDP_REG(VDP_R1) & R1_SPR_8X16) ? 16 : 8)
+#endif
+
+static uint8_t bins[SPRITE_MUX_BINS];
+static uint8_t order[MAX_HARDWARE_SPRITES];
+static uint8_t copy[MAX_HARDWARE_SPRITES * SPRITE_MUX_SIZEOF];
+static uint8_t rotation;
+
+/* Each band a sprite covers, the last one is counted even if only partly covered */
+#define SPRITE_MUX_FIRST_BIN(y)         ((uint8_t)(y) / SPRITE_MUX_BIN_LINES)
+#define SPRITE_MUX_LAST_BIN(y, height)  ((uint8_t)((y) + (height) - 1) / SPRITE_MUX_BIN_LINES)
+
+uint8_t sprite_mux_commit(uint8_t count)
+{
+    uint8_t * oam = (uint8_t *)((uint16_t)__render_shadow_OAM << 8);
+    uint8_t height = SPRITE_MUX_HEIGHT();
+    uint8_t i, n, y, bin, last, crowded, fixed, start;
+#if !defined(__TARGET_msxdos)
+    uint8_t * xn;
+#endif
+
+    if (count > MAX_HARDWARE_SPRITES) count = MAX_HARDWARE_SPRITES;
+
+    /* Count the sprites in each band */
+    memset(bins, 0, sizeof(bins));
+    for (i = 0; i != count; i++) {
+        y = SPRITE_MUX_Y(oam, i);
+        last = SPRITE_MUX_LAST_BIN(y, height);
+        for (bin = SPRITE_MUX_FIRST_BIN(y); ; bin = (bin + 1) & (SPRITE_MUX_BINS - 1)) {
+            bins[bin]++;
+            if (bin == last) break;
+        }
+    }
+
+    /* Sprites in uncrowded bands first, in their order, then the crowded ones from the end */
+    fixed = 0;
+    crowded = count;
+    for (i = 0; i != count; i++) {
+        y = SPRITE_MUX_Y(oam, i);
+        last = SPRITE_MUX_LAST_BIN(y, height);
+        for (bin = SPRITE_MUX_FIRST_BIN(y); ; bin = (bin + 1) & (SPRITE_MUX_BINS - 1)) {
+            if (bins[bin] > SPRITE_MUX_LINE_LIMIT) break;
+            if (bin == last) break;
+        }
+        if (bins[bin] > SPRITE_MUX_LINE_LIMIT) order[--crowded] = i;
+        else order[fixed++] = i;
+    }
+    n = count - fixed;
+
+    if (n) {
+        /* The crowded sprites were stored in reverse, rotate them by a different amount every frame */
+        start = rotation % n;
+        rotation++;
+
+#if defined(__TARGET_msxdos)
+        memcpy(copy, oam, count * SPRITE_MUX_SIZEOF);
+        for (i = 0; i != fixed; i++)
+            memcpy(oam + (i * SPRITE_MUX_SIZEOF), copy + (order[i] * SPRITE_MUX_SIZEOF), SPRITE_MUX_SIZEOF);
+        for (i = 0; i != n; i++) {
+            memcpy(oam + ((fixed + i) * SPRITE_MUX_SIZEOF), copy + (order[count - 1 - start] * SPRITE_MUX_SIZEOF), SPRITE_MUX_SIZEOF);
+            if (++start == n) start = 0;
+        }
+#else
+        memcpy(copy, oam, count);
+        memcpy(copy + MAX_HARDWARE_SPRITES, oam + 0x40, count * 2);
+        xn = oam + 0x40;
+        for (i = 0; i != count; i++) {
+            if (i < fixed) {
+                y = order[i];
+            } else {
+                y = order[count - 1 - start];
+                if (++start == n) start = 0;
+            }
+            oam[i] = copy[y];
+            *xn++ = copy[MAX_HARDWARE_SPRITES + (y * 2)];
+            *xn++ = copy[MAX_HARDWARE_SPRITES + (y * 2) + 1];
+        }
+#endif
+    }
+
+    SET_SHADOW_OAM_COUNT(count);
+    return n;
+}
@@ -0,0 +1,64 @@
+        .include        "global.s"
+
+        .title  "Stack high water mark"
+        .module StackCheck
+
+        ;; Linking this module (by calling stack_high_water() or stack_size())
+        ;; adds a _GSINIT part which fills the free RAM between the end of the
+        ;; last RAM area and the stack pointer with .STACK_PAINT. The lowest
+        ;; byte which no longer holds it is the deepest the stack has been.
+
+        .STACK_PAINT = 0xA5
+
+        .globl  .STACK
+        .globl  .memset_simple
+        .globl  s__HEAP_END, l__HEAP_END
+
+        .area   _GSINIT
+
+        call    .stack_bottom
+        ex      de, hl
+        ld      hl, #-4         ; leave the return address of .memset_simple
+        add     hl, sp
+        or      a
+        sbc     hl, de          ; HL = bytes between the RAM areas and SP
+        jr      c, 1$           ; RAM areas reach into the stack: nothing to paint
+        ld      b, h
+        ld      c, l
+        ex      de, hl
+        ld      a, #.STACK_PAINT
+        call    .memset_simple
+1$:
+
+        .area   _HOME
+
+        ;; HL = first byte after the last RAM area
+.stack_bottom:
+        ld      hl, #s__HEAP_END
+        ld      bc, #l__HEAP_END
+        add     hl, bc
+        ret
+
+        ;; DE = .STACK - HL
+.stack_from:
+        ex      de, hl
+        ld      hl, #.STACK
+        or      a
+        sbc     hl, de
+        ex      de, hl
+        ret
+
+        ;; uint16_t stack_high_water(void)
+_stack_high_water::
+        call    .stack_bottom
+        ld      a, #.STACK_PAINT
+1$:
+        cp      (hl)
+        jr      nz, .stack_from
+        inc     hl
+        jr      1$
+
+        ;; uint16_t stack_size(void)
+_stack_size::
+        call    .stack_bottom
+        jr      .stack_from
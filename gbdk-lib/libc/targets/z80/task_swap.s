@@ -0,0 +1,36 @@
+        .include        "global.s"
+
+        .title  "Task switch"
+        .module TaskSwap
+
+        .area   _HOME
+
+        ;; void __task_swap(void ** save_sp, void ** load_sp)
+        ;; HL = where to save SP, DE = where to load SP from
+        ;;
+        ;; IX is the only register kept over a call, so a task's context
+        ;; is its stack: IX, the ROM bank of frame 1, then the return address.
+___task_swap::
+        ld      a, (#.MAP_FRAME1)
+        push    af
+        push    ix
+
+        ex      de, hl
+        push    hl
+        ld      hl, #2
+        add     hl, sp          ; SP without the load pointer
+        ex      de, hl
+        ld      (hl), e
+        inc     hl
+        ld      (hl), d
+
+        pop     hl
+        ld      a, (hl)
+        inc     hl
+        ld      h, (hl)
+        ld      l, a
+        ld      sp, hl
+        pop     ix
+        pop     af
+        ld      (#.MAP_FRAME1), a
+        ret
@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <gbdk/platform.h>
+#include <sms/vram_queue.h>
+#include <gbdk/tile_anim.h>
+
+/* Animated background tiles, see gbdk/tile_anim.h */
+
+#define TA_TILE_SIZE 32
+
+uint16_t tile_anim_budget = TILE_ANIM_BUDGET;
+
+/* Animation the next update starts writing at, so frames which did not fit are written first */
+static uint8_t ta_first;
+
+/* Queues the next frame of a, with its bank switched in */
+static void ta_write(const tile_anim_t * a, uint16_t size)
+{
+    vram_queue_write((uint8_t *)(a->first_tile * TA_TILE_SIZE), a->tiles + (a->frame * size), size);
+}
+
+void tile_anim_update(tile_anim_t * anims, uint8_t count)
+{
+    tile_anim_t * a;
+    uint8_t save_bank = CURRENT_BANK;
+    uint16_t budget = tile_anim_budget, size;
+    uint8_t i, n, written = FALSE;
+
+    if (!count) return;
+
+    for (a = anims, n = count; n; n--, a++) {
+        if (!a->ticks) continue;
+        if (!a->timer) {
+            /* Skip the frame still pending */
+            if ((a->flags & TILE_ANIM_PENDING) && (++a->frame == a->frame_count)) a->frame = 0;
+            a->flags |= TILE_ANIM_PENDING;
+            a->timer = a->ticks;
+        }
+        a->timer--;
+    }
+
+    if (ta_first >= count) ta_first = 0;
+    for (i = ta_first, a = anims + i, n = count; n; n--) {
+        if (a->flags & TILE_ANIM_PENDING) {
+            size = a->tile_count * TA_TILE_SIZE;
+            if ((written) && (size > budget)) break;
+            SWITCH_ROM(a->bank);
+            ta_write(a, size);
+            budget = (size < budget) ? budget - size : 0;
+            written = TRUE;
+            a->flags &= ~TILE_ANIM_PENDING;
+            if (++a->frame == a->frame_count) a->frame = 0;
+        }
+        if (++i == count) {
+            i = 0;
+            a = anims;
+        } else
+            a++;
+    }
+    ta_first = i;
+    SWITCH_ROM(save_bank);
+}
+
+void tile_anim_set_frame(tile_anim_t * anim, uint8_t frame)
+{
+    anim->frame = frame;
+    anim->timer = anim->ticks;
+    anim->flags |= TILE_ANIM_PENDING;
+}
@@ -0,0 +1,94 @@
+; Tile decompress routine
+; Format written by gbcompress --alg=tile
+
+        .include        "global.s"
+
+        .title  "Tile Decompress"
+        .module TileDecompress
+
+        .area _CODE
+
+; hl = source; de = dest
+_tile_decompress::
+        push    de              ; start of output, for the size
+1$:
+        ld      a, (hl)         ; mode bytes or reference
+        cp      #0xC0
+        jr      nc, 2$
+        call    .tile_rows
+        jr      1$
+2$:                             ; reference to the mode bytes of an earlier tile
+        and     #0x3F
+        ld      b, a
+        inc     hl
+        ld      c, (hl)
+        inc     hl
+        or      c               ; also clears carry for sbc
+        jr      z, 9$           ; exit, if distance 0
+        push    hl              ; continue after the reference
+        dec     hl
+        dec     hl
+        sbc     hl, bc          ; hl = reference - distance
+        call    .tile_rows
+        pop     hl
+        jr      1$
+9$:
+        pop     hl              ; de = bytes written
+        ex      de, hl
+        or      a
+        sbc     hl, de
+        ex      de, hl
+        ret
+
+        ;; Decodes the tile with the mode bytes at hl into de
+.tile_rows:
+        ld      b, (hl)         ; modes of rows 0-3
+        inc     hl
+        ld      a, (hl)         ; modes of rows 4-7
+        inc     hl
+        push    af
+        call    .tile_half
+        pop     af
+        ld      b, a
+        ;; Decodes 4 rows with the modes in b
+.tile_half:
+        ld      c, #4
+3$:
+        sla     b
+        jr      c, 5$
+        sla     b
+        ld      a, (hl)         ; low plane
+        inc     hl
+        ld      (de), a
+        inc     de
+        jr      c, 4$           ; 01: high plane is the same
+        ld      a, (hl)         ; 00: high plane
+        inc     hl
+4$:
+        ld      (de), a
+        inc     de
+        dec     c
+        jr      nz, 3$
+        ret
+5$:
+        sla     b
+        jr      c, 6$
+        ld      a, (hl)         ; 10: low plane, high plane is zero
+        inc     hl
+        ld      (de), a
+        inc     de
+        xor     a
+        jr      4$
+6$:                             ; 11: same as the row before
+        push    hl
+        ld      h, d
+        ld      l, e
+        dec     hl
+        dec     hl
+        ld      a, (hl)
+        ld      (de), a
+        inc     de
+        inc     hl
+        ld      a, (hl)
+        pop     hl
+        jr      4$
@@ -0,0 +1,37 @@
+#include <stdint.h>
+#include <sms/sms.h>
+#include <gbdk/timer.h>
+
+/* Cycle timestamp, see gbdk/timer.h
+
+   sys_time is incremented by the VBlank interrupt on line 0xC1, so the
+   position in the frame is counted in lines from there. The V counter
+   jumps back during VBlank, so those lines all count as the start of
+   the frame. If the handler has not run yet (interrupts disabled) the
+   result would go back, so it is held at the last one returned */
+
+#define LINE_CYCLES  228u
+#define VBL_LINE     0xC1u
+
+static uint16_t last_frames;
+static uint32_t last_cycles;
+
+uint32_t timer_now_cycles(void)
+{
+    uint16_t frames;
+    uint8_t line;
+    uint16_t frame_lines = (_SYSTEM == SYSTEM_PAL) ? 313u : 262u;
+    uint32_t now;
+
+    CRITICAL {
+        frames = sys_time;
+        line = VCOUNTER;
+
+        now = (uint32_t)frames * (frame_lines * LINE_CYCLES);
+        if (line < VBL_LINE) now += (uint32_t)(line + (frame_lines - VBL_LINE)) * LINE_CYCLES;
+        if ((frames == last_frames) && (now < last_cycles)) now = last_cycles;
+        last_frames = frames;
+        last_cycles = now;
+    }
+    return now;
+}
@@ -0,0 +1,136 @@
+        .include        "global.s"
+
+        .title  "VRAM fill"
+        .module VRAMFill
+
+        .globl  _shadow_VDP_R1
+
+        ;; Inner loops of the fill_rect routines, with the VDP address already set.
+        ;; While the display is off the writes follow each other at full speed,
+        ;; unrolled 8 times. Otherwise they are spaced out for the access time
+        ;; of the VDP during active display.
+
+        ;; B = DE / 8 (DE < 2048), returns if 0
+.macro FILL_BLOCKS
+        srl d
+        rr e
+        srl d
+        rr e
+        srl d
+        rr e
+        ld b, e
+        inc b
+        dec b
+        ret z
+.endm
+
+        ;; B and D for a loop of DE (> 0) iterations with djnz / dec d
+.macro FILL_COUNT16
+        ld b, e
+        dec de
+        inc d
+.endm
+
+        .area   _HOME
+
+        ;; Writes the word in HL DE (1 - 2047) times, clobbers A, BC, DE
+.vdp_fill_words::
+        ld c, #.VDP_DATA
+        ld a, (_shadow_VDP_R1)
+        and #.R1_DISP_ON
+        jr nz, 4$
+        ld a, e
+        and #0x07
+        jr z, 2$
+        ld b, a
+1$:
+        out (c), l
+        out (c), h
+        djnz 1$
+2$:
+        FILL_BLOCKS
+3$:
+        .rept 8
+        out (c), l
+        out (c), h
+        .endm
+        djnz 3$
+        ret
+4$:
+        FILL_COUNT16
+5$:
+        out (c), l
+        VDP_DELAY
+        out (c), h
+        nop
+        djnz 5$
+        dec d
+        jr nz, 5$
+        ret
+
+        ;; Writes L to every other byte DE (1 - 2047) times, skipping the byte
+        ;; after it with a read, clobbers A, BC, DE
+.vdp_fill_words_low::
+        ld c, #.VDP_DATA
+        ld a, (_shadow_VDP_R1)
+        and #.R1_DISP_ON
+        jr nz, 4$
+        ld a, e
+        and #0x07
+        jr z, 2$
+        ld b, a
+1$:
+        out (c), l
+        in a, (c)
+        djnz 1$
+2$:
+        FILL_BLOCKS
+3$:
+        .rept 8
+        out (c), l
+        in a, (c)
+        .endm
+        djnz 3$
+        ret
+4$:
+        FILL_COUNT16
+5$:
+        out (c), l
+        VDP_DELAY
+        in a, (c)
+        nop
+        djnz 5$
+        dec d
+        jr nz, 5$
+        ret
+
+        ;; Writes L DE (1 - 2047) times, clobbers A, BC, DE
+.vdp_fill_bytes::
+        ld c, #.VDP_DATA
+        ld a, (_shadow_VDP_R1)
+        and #.R1_DISP_ON
+        jr nz, 4$
+        ld a, e
+        and #0x07
+        jr z, 2$
+        ld b, a
+1$:
+        out (c), l
+        djnz 1$
+2$:
+        FILL_BLOCKS
+3$:
+        .rept 8
+        out (c), l
+        .endm
+        djnz 3$
+        ret
+4$:
+        FILL_COUNT16
+5$:
+        out (c), l
+        VDP_DELAY
+        djnz 5$
+        dec d
+        jr nz, 5$
+        ret
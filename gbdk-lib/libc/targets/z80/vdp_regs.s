@@ -0,0 +1,57 @@
+        .include        "global.s"
+
+        .title  "VDP registers"
+        .module VDPRegs
+
+        .globl  __shadow_OAM_OFF, _shadow_VDP_R0
+
+        ;; Deferred VDP register writes: VDP_REG_SET() (sms.h) changes the
+        ;; shadow of a register and sets its bit in _vdp_regs_dirty,
+        ;; _vdp_regs_commit writes the registers with their bit set
+
+        .area   _DATA
+
+_vdp_regs_dirty::                       ; Bit n for register n
+        .ds     0x02
+
+        .area   _HOME
+
+; void vdp_regs_commit(void) PRESERVES_REGS(iyh, iyl);
+_vdp_regs_commit::
+        ld a, (__shadow_OAM_OFF)        ; the interrupted code is writing to the VDP
+        or a
+        ret nz
+
+        ld a, i
+        di
+        push af
+
+        ld hl, (_vdp_regs_dirty)
+        ld a, h
+        or l
+        jr z, 3$
+        ld de, #0
+        ld (_vdp_regs_dirty), de
+
+        ld de, #_shadow_VDP_R0
+        ld b, #.VDP_R0
+        ld c, #.VDP_CMD
+1$:
+        srl h
+        rr l
+        jr nc, 2$
+        ld a, (de)
+        out (c), a
+        out (c), b
+2$:
+        inc de
+        inc b
+        ld a, h
+        or l
+        jr nz, 1$
+3$:
+        pop af
+        jp po, 4$
+        ei
+4$:
+        ret
@@ -0,0 +1,56 @@
+        .include        "global.s"
+
+        .title  "VRAM utilities"
+        .module VRAMUtils
+        .area   _HOME
+
+; void vmemcpy_banked(unsigned int dst, const void *src, unsigned int size, uint8_t bank) __z88dk_callee __preserves_regs(iyh,iyl);
+        ;; src is read through slot 2 (0x8000 - 0xBFFF), so the caller may
+        ;; run from any bank in slot 1
+_vmemcpy_banked::
+        pop de          ; pop ret address
+        pop hl          ; dst
+
+        DISABLE_VBLANK_COPY
+
+        VDP_WRITE_CMD h, l
+
+        pop hl          ; src
+        pop bc          ; size
+        dec sp
+        pop af          ; A = bank
+        push de         ; push ret address
+
+        ld e, a
+        ld a, (.MAP_FRAME2)     ; the mapper registers are mirrored in RAM
+        push af
+        ld a, e
+        ld (.MAP_FRAME2), a
+
+        ld a, b         ; HI(size)
+        ld b, c         ; LO(size)
+
+        ld c, #.VDP_DATA
+
+        rlc b
+        rrc b           ; check b is zero
+        jr  z, 2$
+1$:
+        outi
+        jp  nz, 1$      ; 10 = 26 (VRAM safe)
+2$:
+        inc a
+        jp  4$
+3$:
+        outi
+        jp  nz, 3$      ; 10 = 26 (VRAM safe)
+4$:
+        dec a
+        jp  nz, 3$
+
+        pop af
+        ld (.MAP_FRAME2), a
+
+        ENABLE_VBLANK_COPY
+
+        ret
@@ -0,0 +1,85 @@
+#include <stdint.h>
+#include <string.h>
+#include <sms/sms.h>
+#include <sms/vram_queue.h>
+
+/* Deferred VRAM writes, see sms/vram_queue.h. The VBlank side is in vram_queue_isr.s */
+
+#define VRAM_QUEUE_HDR_SIZEOF 3
+#define VRAM_QUEUE_TILEMAP    0x7800u   /* .VDP_TILEMAP, as VDP write command */
+#define VRAM_QUEUE_WRITE_CMD  0x4000u
+#define VRAM_QUEUE_ADDR_MASK  0x3FFFu
+
+extern uint8_t __vram_queue_buf[256];
+/* Only the writer advances the head and only the VBlank handler the tail */
+extern volatile uint8_t __vram_queue_head, __vram_queue_tail;
+
+uint8_t vram_queue_budget = VRAM_QUEUE_BUDGET;
+
+/* Room for a stripe of len bytes, waits for the VBlank handler to free some if needed.
+   Stripes never wrap around the end of the buffer, so they are copied with a single OUTI run */
+static uint8_t * vram_queue_reserve(uint8_t len)
+{
+    uint8_t need = len + VRAM_QUEUE_HDR_SIZEOF, head, tail;
+
+    for (;;) {
+        head = __vram_queue_head;
+        tail = __vram_queue_tail;
+        if (head >= tail) {
+            if ((uint16_t)head + need < 0x100u) return __vram_queue_buf + head;
+            if (need < tail) {
+                /* Wrap marker, the next stripe is at the start of the buffer */
+                __vram_queue_buf[head] = 0;
+                return __vram_queue_buf;
+            }
+        } else if ((uint16_t)head + need < tail) {
+            return __vram_queue_buf + head;
+        }
+    }
+}
+
+void vram_queue_write(uint8_t * dst, const uint8_t * src, uint16_t len)
+{
+    uint16_t cmd = (uint16_t)dst;
+    uint8_t * p;
+    uint8_t n;
+
+    while (len) {
+        n = (len > VRAM_QUEUE_STRIPE_MAX) ? VRAM_QUEUE_STRIPE_MAX : (uint8_t)len;
+        p = vram_queue_reserve(n);
+        p[0] = n;
+        p[1] = (uint8_t)cmd;
+        p[2] = (uint8_t)(cmd >> 8) | (uint8_t)(VRAM_QUEUE_WRITE_CMD >> 8);
+        memcpy(p + VRAM_QUEUE_HDR_SIZEOF, src, n);
+        /* The whole stripe becomes visible to the VBlank handler at once */
+        __vram_queue_head = (uint8_t)(p - __vram_queue_buf) + VRAM_QUEUE_HDR_SIZEOF + n;
+        cmd = (cmd + n) & VRAM_QUEUE_ADDR_MASK;
+        src += n;
+        len -= n;
+    }
+}
+
+void vram_queue_set_tile_map(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t * tiles)
+{
+    uint16_t row;
+    uint8_t left;
+
+    x = (x + DEVICE_SCREEN_X_OFFSET) & (DEVICE_SCREEN_BUFFER_WIDTH - 1);
+    y = (y + DEVICE_SCREEN_Y_OFFSET) % DEVICE_SCREEN_BUFFER_HEIGHT;
+    /* Tiles left of the right edge */
+    left = DEVICE_SCREEN_BUFFER_WIDTH - x;
+    if (left > w) left = w;
+
+    for (; h; h--) {
+        row = VRAM_QUEUE_TILEMAP + ((uint16_t)y * (DEVICE_SCREEN_BUFFER_WIDTH * 2));
+        vram_queue_write((uint8_t *)(row + (x * 2)), tiles, left * 2);
+        if (left != w) vram_queue_write((uint8_t *)row, tiles + (left * 2), (w - left) * 2);
+        tiles += w * 2;
+        if (++y == DEVICE_SCREEN_BUFFER_HEIGHT) y = 0;
+    }
+}
+
+void vram_queue_flush(void)
+{
+    while (__vram_queue_tail != __vram_queue_head) vsync();
+}
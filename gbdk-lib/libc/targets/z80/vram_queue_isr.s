@@ -0,0 +1,86 @@
+        .include        "global.s"
+
+        .title  "VRAM queue"
+        .module VRAMQueue
+
+        .globl  .OUTI_A, __shadow_OAM_OFF, _vram_queue_budget
+
+        ;; Deferred VRAM writes: stripes are queued by vram_queue.c at any
+        ;; time and written by _vram_queue_isr (installed with add_VBL)
+        ;;
+        ;; Format of each stripe in the ring buffer
+        ;; 0: Data length (0 = wrap marker, next stripe is at the start of the buffer)
+        ;; 1: VDP write command LSB
+        ;; 2: VDP write command MSB
+        ;; 3: ...N data bytes...
+
+        .VRAM_QUEUE_HDR_SIZEOF  = 3
+        .VRAM_QUEUE_STRIPE_MAX  = 64    ; Must match VRAM_QUEUE_STRIPE_MAX in sms/vram_queue.h
+        .VRAM_QUEUE_STRIPE_COST = 8     ; Setup time of a stripe, in written bytes
+        .VRAM_QUEUE_BUDGET_MIN  = .VRAM_QUEUE_STRIPE_MAX + .VRAM_QUEUE_STRIPE_COST
+
+        .area   _DATA
+
+___vram_queue_buf::                     ; 256 bytes, indexed by the 8 bit head and tail
+        .ds     0x100
+___vram_queue_head::
+        .ds     0x01
+___vram_queue_tail::
+        .ds     0x01
+
+        .area   _HOME
+
+        ;; VBL handler: write as many stripes as the budget allows, at VBlank speed
+_vram_queue_isr::
+        ld a, (__shadow_OAM_OFF)        ; the interrupted code is writing to the VDP
+        or a
+        ret nz
+
+        ld a, (_vram_queue_budget)
+        cp #.VRAM_QUEUE_BUDGET_MIN
+        jr nc, 1$
+        ld a, #.VRAM_QUEUE_BUDGET_MIN   ; always room for at least one stripe
+1$:
+        ld e, a                         ; E = budget
+        ld a, (___vram_queue_head)
+        ld d, a                         ; D = head
+        ld c, #.VDP_CMD
+2$:
+        ld a, (___vram_queue_tail)
+        cp d
+        ret z                           ; queue is empty
+
+        ld hl, #___vram_queue_buf
+        ADD_A_REG16 h, l                ; HL = stripe
+        ld a, (hl)
+        inc hl
+        or a
+        jr nz, 3$
+        ld (___vram_queue_tail), a      ; wrap marker, continue from the start
+        jr 2$
+3$:
+        ld b, a                         ; B = stripe length
+        ld a, e
+        sub #.VRAM_QUEUE_STRIPE_COST
+        ret c
+        sub b
+        ret c                           ; over budget, leave it for the next frame
+        ld e, a
+
+        ;; free the stripe now, the writer can't run until this returns
+        ld a, (___vram_queue_tail)
+        add #.VRAM_QUEUE_HDR_SIZEOF
+        add b
+        ld (___vram_queue_tail), a
+
+        ld a, (hl)
+        inc hl
+        out (c), a
+        ld a, (hl)
+        inc hl
+        out (c), a                      ; VDP write command
+        dec c                           ; c == .VDP_DATA
+        ld a, b
+        call .OUTI_A                    ; preserves DE
+        inc c                           ; c == .VDP_CMD
+        jr 2$
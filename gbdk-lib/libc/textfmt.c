@@ -0,0 +1,90 @@
+#include <stdint.h>
+#include <gbdk/textfmt.h>
+
+/* Number formatting, see gbdk/textfmt.h
+   Digits are found by repeated subtraction, which is much faster
+   than dividing by 10 on these CPUs */
+
+static const uint16_t pow10[] = { 10000, 1000, 100, 10 };
+
+uint8_t fmt_u8(uint8_t n, uint8_t tile_offset, uint8_t * buffer)
+{
+    uint8_t * p = buffer;
+    uint8_t d;
+
+    if (n >= 10) {
+        if (n >= 100) {
+            for (d = 0; n >= 100; d++) n -= 100;
+            *p++ = d + tile_offset;
+        }
+        for (d = 0; n >= 10; d++) n -= 10;
+        *p++ = d + tile_offset;
+    }
+    *p++ = n + tile_offset;
+    *p = 0;
+    return (uint8_t)(p - buffer);
+}
+
+uint8_t fmt_u16(uint16_t n, uint8_t tile_offset, uint8_t * buffer)
+{
+    uint8_t * p = buffer;
+    const uint16_t * pw = pow10;
+    uint8_t d, started = 0;
+
+    if (n < 256) return fmt_u8((uint8_t)n, tile_offset, buffer);
+
+    for (; pw != pow10 + 4; pw++) {
+        for (d = 0; n >= *pw; d++) n -= *pw;
+        if (d || started) {
+            *p++ = d + tile_offset;
+            started = 1;
+        }
+    }
+    *p++ = (uint8_t)n + tile_offset;
+    *p = 0;
+    return (uint8_t)(p - buffer);
+}
+
+uint8_t fmt_u16_zero(uint16_t n, uint8_t width, uint8_t tile_offset, uint8_t * buffer)
+{
+    uint8_t digits[5];
+    uint8_t * p = digits;
+    const uint16_t * pw = pow10;
+    uint8_t d, i;
+
+    for (; pw != pow10 + 4; pw++) {
+        for (d = 0; n >= *pw; d++) n -= *pw;
+        *p++ = d;
+    }
+    *p = (uint8_t)n;
+
+    for (i = 0, p = digits + 5 - width; i < width; i++) buffer[i] = *p++ + tile_offset;
+    buffer[width] = 0;
+    return width;
+}
+
+uint8_t fmt_u16_pad(uint16_t n, uint8_t width, uint8_t fill_tile, uint8_t tile_offset, uint8_t * buffer)
+{
+    uint8_t i;
+
+    fmt_u16_zero(n, width, tile_offset, buffer);
+    for (i = 0; i < width - 1; i++) {
+        if (buffer[i] != tile_offset) break;
+        buffer[i] = fill_tile;
+    }
+    return width;
+}
+
+uint8_t fmt_hex(uint16_t n, uint8_t width, uint8_t tile_offset, uint8_t * buffer)
+{
+    uint8_t i, d;
+
+    buffer[width] = 0;
+    for (i = width; i; i--) {
+        d = (uint8_t)n & 0x0F;
+        if ((d > 9) && (tile_offset == '0')) d += 'A' - '0' - 10;
+        buffer[i - 1] = d + tile_offset;
+        n >>= 4;
+    }
+    return width;
+}
@@ -0,0 +1,241 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Generated table of the bank and address of each asset for -asset_table=
+//
+// The assets are the symbols with the -asset_prefix= C name prefix which are
+// defined in ROM areas (banked or _CODE), sorted by name. The banks are known
+// after assignment, so they are written as constants, and only the addresses
+// are left to the linker. The object has a single _CODE area with:
+//
+//   _asset_table_count: .dw  <number of assets>
+//   _asset_table_banks: .db  <bank of each asset>
+//   _asset_table_ptrs:  .dw  <address of each asset>
+//
+// A C header with an ASSET_<NAME> index for each one is written next to it.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#include "common.h"
+#include "list.h"
+#include "obj_data.h"
+#include "path_ops.h"
+#include "asset_table.h"
+
+// Bytes of data per T line, which the linker limits to 16 together with the 2 address bytes
+#define ASSET_T_LINE_DATA_MAX  14
+
+#define ASSET_R_SYM_WORD       0x02U  // Relocation of a 16 bit symbol reference
+
+extern list_type arealist;
+extern list_type symbollist;
+
+typedef struct asset_item {
+    const char * name;  // Symbol name, with the leading underscore
+    uint32_t     bank;
+} asset_item;
+
+static char asset_table_filename[MAX_FILE_STR] = {'\0'};
+static char asset_table_prefix[OBJ_NAME_MAX_STR_LEN] = "_asset_";
+
+
+void asset_table_set(char * filename) {
+
+    if (snprintf(asset_table_filename, sizeof(asset_table_filename), "%s", filename) > sizeof(asset_table_filename))
+        printf("BankPack: Warning: truncated asset table filename to:%s\n", asset_table_filename);
+}
+
+
+// The prefix is a C name, symbols have a leading underscore
+void asset_table_set_prefix(char * prefix) {
+
+    snprintf(asset_table_prefix, sizeof(asset_table_prefix), "_%s", prefix);
+}
+
+
+char * asset_table_get_filename(void) {
+    return asset_table_filename;
+}
+
+
+static int asset_item_compare(const void * a, const void * b) {
+
+    return strcmp(((const asset_item *)a)->name, ((const asset_item *)b)->name);
+}
+
+
+// Bank of the area of a type in a file, or BANK_NUM_UNASSIGNED
+static uint32_t asset_area_bank_get(uint32_t file_id, uint32_t area_type) {
+
+    uint32_t c;
+    area_item * areas = (area_item *)arealist.p_array;
+
+    if (area_type == SYMBOL_AREA_CODE)
+        return 0;
+
+    for (c = 0; c < arealist.count; c++) {
+        if ((areas[c].file_id == file_id) && (areas[c].type == area_type))
+            return (areas[c].bank_num_out != BANK_NUM_UNASSIGNED) ? areas[c].bank_num_out : areas[c].bank_num_in;
+    }
+    return BANK_NUM_UNASSIGNED;
+}
+
+
+// Writes a run of bytes as T lines starting at area offset addr, with the relocation of
+// a symbol reference for each word when sym_first isn't zero (data is then all words)
+static void asset_write_t_lines(FILE * out_file, const uint8_t * data, uint32_t len, uint32_t addr, uint32_t sym_first) {
+
+    uint32_t c, i, count;
+
+    for (c = 0; c < len; c += count) {
+        count = len - c;
+        if (count > ASSET_T_LINE_DATA_MAX)
+            count = ASSET_T_LINE_DATA_MAX;
+
+        fprintf(out_file, "T %02X %02X", (addr + c) & 0xFFU, ((addr + c) >> 8) & 0xFFU);
+        for (i = 0; i < count; i++)
+            fprintf(out_file, " %02X", data[c + i]);
+
+        // Relocations are relative to area 0, offsets count the 2 address bytes
+        fprintf(out_file, "\nR 00 00 00 00");
+        if (sym_first) {
+            for (i = 0; i < count; i += 2)
+                fprintf(out_file, " %02X %02X %02X %02X", ASSET_R_SYM_WORD, i + 2,
+                        (sym_first + ((c + i) / 2)) & 0xFFU, ((sym_first + ((c + i) / 2)) >> 8) & 0xFFU);
+        }
+        fprintf(out_file, "\n");
+    }
+}
+
+
+static void asset_header_write(const char * filename, asset_item * assets, uint32_t count) {
+
+    char     header_filename[MAX_FILE_STR];
+    FILE *   out_file;
+    const char * p;
+    uint32_t c;
+
+    snprintf(header_filename, sizeof(header_filename), "%s", filename);
+    filename_replace_extension(header_filename, "h", sizeof(header_filename));
+
+    out_file = fopen(header_filename, "w");
+    if (!out_file) {
+        printf("BankPack: ERROR: failed to open asset table header for writing: %s\n", header_filename);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out_file,
+        "// Generated by bankpack -asset_table= for the assets named %s*, don't edit\n"
+        "// The indices follow the sorted names and are updated on every link\n"
+        "\n"
+        "#ifndef __ASSET_TABLE_H_INCLUDE\n"
+        "#define __ASSET_TABLE_H_INCLUDE\n"
+        "\n"
+        "#include <stdint.h>\n"
+        "\n"
+        "extern const uint16_t asset_table_count;\n"
+        "extern const uint8_t asset_table_banks[];\n"
+        "extern const void * const asset_table_ptrs[];\n"
+        "\n", asset_table_prefix + 1);
+
+    for (c = 0; c < count; c++) {
+        fprintf(out_file, "#define ASSET_");
+        for (p = assets[c].name + strlen(asset_table_prefix); *p; p++)
+            fputc(isalnum((unsigned char)*p) ? toupper((unsigned char)*p) : '_', out_file);
+        fprintf(out_file, " %u\n", c);
+    }
+    fprintf(out_file, "#define ASSET_COUNT %u\n\n#endif\n", count);
+    fclose(out_file);
+}
+
+
+// Write the asset table object (and header) for -asset_table=
+// Should be called after obj_data_process()
+void asset_table_write(void) {
+
+    uint32_t c, i, count = 0;
+    uint32_t bank;
+    size_t   prefix_len = strlen(asset_table_prefix);
+    asset_item * assets;
+    uint8_t *    data;
+    FILE *       out_file;
+    symbol_item * symbols = (symbol_item *)symbollist.p_array;
+
+    if (asset_table_filename[0] == '\0')
+        return;
+
+    assets = malloc((symbollist.count ? symbollist.count : 1) * sizeof(asset_item));
+    if (!assets) {
+        printf("BankPack: ERROR: Failed to allocate memory for asset table!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (c = 0; c < symbollist.count; c++) {
+        if ((symbols[c].area_type == SYMBOL_AREA_OTHER) || (symbols[c].is_banked_def) ||
+            (strncmp(symbols[c].name, asset_table_prefix, prefix_len) != 0) || (symbols[c].name[prefix_len] == '\0'))
+            continue;
+        bank = asset_area_bank_get(symbols[c].file_id, symbols[c].area_type);
+        if (bank == BANK_NUM_UNASSIGNED)
+            continue;
+        assets[count].name = symbols[c].name;
+        assets[count].bank = bank;
+        count++;
+    }
+    qsort(assets, count, sizeof(asset_item), asset_item_compare);
+
+    // A duplicate definition is an error for the linker, list it once here
+    for (c = 0, i = 0; c < count; c++) {
+        if ((i > 0) && (strcmp(assets[i - 1].name, assets[c].name) == 0))
+            continue;
+        assets[i++] = assets[c];
+    }
+    count = i;
+
+    out_file = fopen(asset_table_filename, "w");
+    if (!out_file) {
+        printf("BankPack: ERROR: failed to open asset table for writing: %s\n", asset_table_filename);
+        exit(EXIT_FAILURE);
+    }
+
+    // Symbols in order: .__.ABS. (0), the assets (1..count), then the table symbols
+    fprintf(out_file, "XL2\nH 1 areas %X global symbols\nM asset_table\n", count + 4);
+    fprintf(out_file, "S .__.ABS. Def0000\n");
+    for (c = 0; c < count; c++)
+        fprintf(out_file, "S %s Ref0000\n", assets[c].name);
+    fprintf(out_file, "A _CODE size %X flags 0 addr 0\n", 2 + (count * 3));
+    fprintf(out_file, "S _asset_table_count Def0000\n");
+    fprintf(out_file, "S _asset_table_banks Def0002\n");
+    fprintf(out_file, "S _asset_table_ptrs Def%04X\n", 2 + count);
+
+    data = calloc(2 + (count * 2), 1);
+    if (!data) {
+        printf("BankPack: ERROR: Failed to allocate memory for asset table!\n");
+        exit(EXIT_FAILURE);
+    }
+    data[0] = count & 0xFFU;
+    data[1] = (count >> 8) & 0xFFU;
+    asset_write_t_lines(out_file, data, 2, 0, 0);
+
+    // Banks above 255 (MBC5 with more than 4MB) don't fit the byte table
+    for (c = 0; c < count; c++) {
+        if (assets[c].bank > 0xFFU)
+            printf("BankPack: Warning: asset %s is in bank %d, which is truncated in the asset table\n", assets[c].name, assets[c].bank);
+        data[c] = assets[c].bank & 0xFFU;
+    }
+    asset_write_t_lines(out_file, data, count, 2, 0);
+
+    // Addresses are all left to the linker
+    memset(data, 0, count * 2);
+    asset_write_t_lines(out_file, data, count * 2, 2 + count, 1);
+
+    fclose(out_file);
+    asset_header_write(asset_table_filename, assets, count);
+
+    free(data);
+    free(assets);
+}
@@ -0,0 +1,12 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _ASSET_TABLE_H
+#define _ASSET_TABLE_H
+
+void asset_table_set(char * filename);
+void asset_table_set_prefix(char * prefix);
+char * asset_table_get_filename(void);
+void asset_table_write(void);
+
+#endif // _ASSET_TABLE_H
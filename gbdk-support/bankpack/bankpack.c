@@ -13,6 +13,9 @@
 #include "obj_data.h"
 #include "files.h"
 #include "options.h"
+#include "asset_table.h"
+#include "split_data.h"
+#include "bankpack.h"
 
 static void display_help(void);
 static int handle_args(int argc, char * argv[]);
@@ -40,13 +43,30 @@ static void display_help(void) {
        "-max=N        : Max assigned ROM bank is N, error if exceeded\n"
        "-ext=<.ext>   : Write files out with <.ext> instead of source extension\n"
        "-path=<path>  : Write files out to <path> (<path> *MUST* already exist)\n"
+       "-skip_unchanged: Don't write out files which need no changes, -lkout=\n"
+       "               lists the input file for them instead\n"
        "-sym=<prefix> : Add symbols starting with <prefix> to match + update list.\n"
        "               Default entry is \"___bank_\" (see below)\n"
        "-cartsize     : Print min required cart size as \"autocartsize:<NNN>\"\n"
        "-plat=<plat>  : Select platform specific behavior (default:gb) (gb,sms)\n"
        "-random       : Distribute banks randomly for testing (honors -min/-max)\n"
+       "-pack=<mode>  : Bank packing strategy for auto-banked areas (default:ffd)\n"
+       "                ffd: first fit, bfd: best fit, optimal: search for fewest banks\n"
+       "                cluster: group files which reference each other into the same bank\n"
+       "-profile=<fn> : Call counts (\"<symbol> <count>\" lines) to weight -pack=cluster\n"
        "-reserve=<b:n>: Reserve N bytes (hex) in bank B (decimal)\n"
        "                Ex: -reserve=105:30F reserves 0x30F bytes in bank 105\n"
+       "-stable=<file>: Keep auto-banked areas in the bank listed in <file> by the previous\n"
+       "                run when they still fit, only place the rest. Then update <file>\n"
+       "-report=<fn>  : Write bank and area assignments to <fn> as JSON\n"
+       "                (ihxcheck -report=<fn> adds the ROM ranges actually used)\n"
+       "-asset_table=<fn>: Write an object <fn> with the bank and address of each asset, and\n"
+       "                their indices in a header next to it. Added to the -lkout= list\n"
+       "-asset_prefix=<p>: C name prefix of the assets for -asset_table= (default: asset_)\n"
+       "-split=<fn>   : Split auto-banked data areas larger than a bank into segments of up to\n"
+       "                a bank each, and write an object <fn> with a _<name>_segments table\n"
+       "                for each. Added to the -lkout= list (see gbdk/banked_stream.h)\n"
+       "-jobs=N       : Use N threads to read and write object files (default: number of CPUs)\n"
        "-v            : Verbose output, show assignments\n"
        "\n"
        "Example: \"bankpack -ext=.rel -path=some/newpath/ file1.o file2.o\"\n"
@@ -93,6 +113,8 @@ static int handle_args(int argc, char * argv[]) {
                 files_set_out_ext(argv[i] + 5);
             } else if (strstr(argv[i], "-path=") == argv[i]) {
                 files_set_out_path(argv[i] + 6);
+            } else if (strstr(argv[i], "-skip_unchanged") == argv[i]) {
+                files_set_skip_unchanged(true);
             } else if (strstr(argv[i], "-mbc=") == argv[i]) {
                 option_set_mbc(atoi(argv[i] + 5));
             } else if (strstr(argv[i], "-yt") == argv[i]) {
@@ -107,6 +129,26 @@ static int handle_args(int argc, char * argv[]) {
                 option_set_platform(argv[i] + 6);
             } else if (strstr(argv[i], "-random") == argv[i]) {
                 option_set_random_assign(true);
+            } else if (strstr(argv[i], "-pack=") == argv[i]) {
+                if (!option_set_pack_mode(argv[i] + strlen("-pack="))) {
+                    fprintf(stdout,"BankPack: ERROR! Invalid packing mode: %s\n\n", argv[i]);
+                    display_help();
+                    return false;
+                }
+            } else if (strstr(argv[i], "-profile=") == argv[i]) {
+                profile_read(argv[i] + strlen("-profile="));
+            } else if (strstr(argv[i], "-stable=") == argv[i]) {
+                stable_map_set(argv[i] + strlen("-stable="));
+            } else if (strstr(argv[i], "-report=") == argv[i]) {
+                report_set(argv[i] + strlen("-report="));
+            } else if (strstr(argv[i], "-asset_table=") == argv[i]) {
+                asset_table_set(argv[i] + strlen("-asset_table="));
+            } else if (strstr(argv[i], "-asset_prefix=") == argv[i]) {
+                asset_table_set_prefix(argv[i] + strlen("-asset_prefix="));
+            } else if (strstr(argv[i], "-split=") == argv[i]) {
+                split_data_set(argv[i] + strlen("-split="));
+            } else if (strstr(argv[i], "-jobs=") == argv[i]) {
+                option_set_jobs(atoi(argv[i] + strlen("-jobs=")));
             } else if (strstr(argv[i], "-lkin=") == argv[i]) {
                 files_read_linkerfile(argv[i] + strlen("-lkin="));
             } else if (strstr(argv[i], "-lkout=") == argv[i]) {
@@ -139,46 +181,59 @@ static void init(void) {
     srand( time(0) );
     files_init();
     obj_data_init();
+    split_data_init();
 }
 
 
 void cleanup(void) {
     files_cleanup();
     obj_data_cleanup();
+    split_data_cleanup();
 }
 
 
-int main( int argc, char *argv[] )  {
+// Runs bankpack with a command line as for main(), also called by lcc
+// when bankpack is linked into it. Fatal errors still exit() the process.
+int bankpack_run( int argc, char *argv[] )  {
 
     // Exit with failure by default
     int ret = EXIT_FAILURE;
 
-    // Register cleanup with exit handler
-    atexit(cleanup);
-
     init();
 
     if (handle_args(argc, argv)) {
 
-        // Require MBC for Game Boy
-        // SMS doesn't require an MBC setting
-        if ((option_get_platform() == PLATFORM_GB) && (option_get_mbc_type() == MBC_TYPE_NONE))
-            printf("BankPack: ERROR: auto-banking does not work with unbanked ROMS (no MBC for Game Boy)\n");
-        else {
-            // Extract areas, sort and assign them to banks
-            // then rewrite object files as needed
-            files_extract();
-            files_rewrite();
-
-            if (option_get_verbose())
-                banks_show();
-            if (option_get_cartsize())
-                fprintf(stdout,"autocartsize:%d\n",option_banks_calc_cart_size());
-
-            cleanup();
-            ret = EXIT_SUCCESS;
-        }
+        if ((profile_is_loaded()) && (option_get_pack_mode() != PACK_MODE_CLUSTER))
+            printf("BankPack: Warning: -profile= is only used with -pack=cluster\n");
+
+        // Extract areas, sort and assign them to banks
+        // then rewrite object files as needed
+        files_extract();
+        asset_table_write();
+        split_data_write();
+        files_rewrite();
+        stable_map_write();
+        report_write();
+
+        if (option_get_verbose())
+            banks_show();
+        if (option_get_cartsize())
+            fprintf(stdout,"autocartsize:%d\n",option_banks_calc_cart_size());
+
+        ret = EXIT_SUCCESS;
     }
 
+    cleanup();
     return ret; // Exit with failure by default
 }
+
+
+#ifndef BANKPACK_LIB
+int main( int argc, char *argv[] )  {
+
+    // Register cleanup with exit handler
+    atexit(cleanup);
+
+    return bankpack_run(argc, argv);
+}
+#endif
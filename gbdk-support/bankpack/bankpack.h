@@ -0,0 +1,10 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _BANKPACK_H
+#define _BANKPACK_H
+
+// Entry point of libbankpack.a, takes the same arguments as the bankpack command
+int bankpack_run(int argc, char * argv[]);
+
+#endif // _BANKPACK_H
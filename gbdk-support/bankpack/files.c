@@ -8,21 +8,42 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <pthread.h>
 
 #include "common.h"
 #include "path_ops.h"
 #include "list.h"
 #include "files.h"
 #include "obj_data.h"
+#include "options.h"
+#include "asset_table.h"
+#include "split_data.h"
 
 static void files_set_output_name(void);
 static char * file_read_to_buffer(char *);
 
+// Areas and symbols collected from a single object file
+typedef struct file_scan_item {
+    list_type areas;
+    list_type symbols;
+    list_type refs;
+} file_scan_item;
+
+typedef bool (*file_work_func)(uint32_t file_id);
+
+static file_scan_item * p_file_scans = NULL;
+
+static pthread_mutex_t work_lock = PTHREAD_MUTEX_INITIALIZER;
+static file_work_func  work_func;
+static uint32_t        work_next;
+static bool            work_failed;
+
 list_type filelist;
 
 char g_out_ext[MAX_FILE_STR];
 char g_out_path[MAX_FILE_STR];
 char g_out_linkerfile_name[MAX_FILE_STR] = {'\0'};
+static bool g_skip_unchanged = false;
 
 void files_set_out_ext(char * ext_str) {
     if (snprintf(g_out_ext, sizeof(g_out_ext), "%s", ext_str) > sizeof(g_out_ext))
@@ -34,6 +55,12 @@ void files_set_out_path(char * path_str) {
         printf("Bankpack: Warning: truncated output path to:%s\n",g_out_path);
 }
 
+// Files with nothing to change are not written out, the -lkout= list and
+// the report name the input file instead
+void files_set_skip_unchanged(bool is_enabled) {
+    g_skip_unchanged = is_enabled;
+}
+
 
 void files_init(void) {
     list_init(&filelist, sizeof(file_item));
@@ -42,6 +69,13 @@ void files_init(void) {
 }
 
 void files_cleanup(void) {
+    uint32_t c;
+    file_item * files = (file_item *)filelist.p_array;
+
+    for (c = 0; files && (c < filelist.count); c++) {
+        free(files[c].data);
+        files[c].data = NULL;
+    }
     list_cleanup(&filelist);
 }
 
@@ -95,8 +129,17 @@ void files_write_linkerfile(void) {
     if (out_file) {
 
         // Process stored file names
-        for (c = 0; c < filelist.count; c++)
-            fprintf(out_file, "%s\n", files[c].name_out);
+        for (c = 0; c < filelist.count; c++) {
+            if (!files[c].split)
+                fprintf(out_file, "%s\n", files[c].name_out);
+        }
+
+        // The generated asset table gets linked with the rest
+        if (asset_table_get_filename()[0] != '\0')
+            fprintf(out_file, "%s\n", asset_table_get_filename());
+        // And so do the split segment tables
+        if (split_data_get_filename()[0] != '\0')
+            fprintf(out_file, "%s\n", split_data_get_filename());
 
         fclose(out_file);
 
@@ -116,13 +159,26 @@ void files_add(char * filename) {
         printf("Warning: truncated input filename to:%s\n",newfile.name_in);
 
     newfile.name_out[0] = '\0';
+    newfile.module[0] = '\0';
+    newfile.data = NULL;
+    newfile.split = false;
     newfile.rewrite_needed = false;
+    newfile.code_ram_areas = 0;
     newfile.bank_num = BANK_NUM_UNASSIGNED;
 
     list_additem(&filelist, &newfile);
 }
 
 
+// Adds a file made by bankpack (the segments of -split=), with its contents already in data
+// The file doesn't exist until it's written out by files_rewrite()
+void files_add_generated(char * filename, char * data) {
+
+    files_add(filename);
+    ((file_item *)filelist.p_array)[filelist.count - 1].data = data;
+}
+
+
 char * file_get_name_in_by_id(uint32_t file_id) {
 
     file_item * files = (file_item *)filelist.p_array;
@@ -145,6 +201,32 @@ char * file_get_name_out_by_id(uint32_t file_id) {
 }
 
 
+// Module name of a file, or the input filename without path if it had no module line
+char * file_get_module_by_id(uint32_t file_id) {
+
+    file_item * files = (file_item *)filelist.p_array;
+    char * name;
+
+    if ((file_id >= 0) && (file_id < filelist.count)) {
+        if (files[file_id].module[0] != '\0')
+            return files[file_id].module;
+
+        name = files[file_id].name_in;
+        if (strrchr(name, '/'))  name = strrchr(name, '/') + 1;
+        if (strrchr(name, '\\')) name = strrchr(name, '\\') + 1;
+        return name;
+    }
+    else
+        return (char *)"\0";
+}
+
+
+// True if a file can be linked as it is: no banks to assign and no RAM code to move
+static bool file_is_unchanged(file_item * p_file) {
+    return (!p_file->rewrite_needed) && (p_file->code_ram_areas == 0);
+}
+
+
 // Update output names based on -path= and -ext= option params
 static void files_set_output_name(void) {
 
@@ -160,6 +242,9 @@ static void files_set_output_name(void) {
             filename_replace_extension(files[c].name_out, g_out_ext, sizeof(files[c].name_out));
         if (g_out_path[0])
             filename_replace_path(files[c].name_out, g_out_path, sizeof(files[c].name_out));
+
+        if (g_skip_unchanged && file_is_unchanged(&files[c]))
+            snprintf(files[c].name_out, sizeof(files[c].name_out), "%s", files[c].name_in);
     }
 }
 
@@ -195,90 +280,363 @@ static char * file_read_to_buffer(char * filename) {
 }
 
 
-// Extract areas from files, then collected assign them to banks
-void files_extract(void) {
-    uint32_t c;
-    char strline_in[OBJ_NAME_MAX_STR_LEN] = "";
-    file_item * files = (file_item *)filelist.p_array;
-    FILE * obj_file;
+// Worker thread: process files until none are left
+static void * files_worker(void * p_arg) {
 
-    // Process stored file names
-    for (c = 0; c < filelist.count; c++) {
+    uint32_t file_id;
+    bool     ok;
 
-        // Open each object file and try to process all the lines
-        obj_file = fopen(files[c].name_in, "r");
-        if (obj_file) {
+    (void)p_arg;
 
-            // Read one line at a time into \0 terminated string
-            while ( fgets(strline_in, sizeof(strline_in), obj_file) != NULL) {
-                if (strline_in[0] == 'A')
-                    areas_add(strline_in, c);
-                else if (strline_in[0] == 'S')
-                    symbols_add(strline_in, c);
+    while (true) {
+        pthread_mutex_lock(&work_lock);
+        file_id = work_next++;
+        pthread_mutex_unlock(&work_lock);
+
+        if (file_id >= filelist.count)
+            break;
+
+        ok = work_func(file_id);
+
+        if (!ok) {
+            pthread_mutex_lock(&work_lock);
+            work_failed = true;
+            pthread_mutex_unlock(&work_lock);
+        }
+    }
+
+    return NULL;
+}
+
+
+// Call func once for every file, split across threads
+// Returns false if any call failed
+static bool files_process_parallel(file_work_func func) {
+
+    pthread_t threads[OPTION_JOBS_MAX];
+    uint32_t  thread_count = 0;
+    uint32_t  job_count = option_get_jobs();
+    uint32_t  c;
+
+    work_func   = func;
+    work_next   = 0;
+    work_failed = false;
+
+    if (job_count > filelist.count)
+        job_count = filelist.count;
+
+    // This thread is one of the workers, so start one less
+    for (c = 1; c < job_count; c++) {
+        if (pthread_create(&threads[thread_count], NULL, files_worker, NULL) == 0)
+            thread_count++;
+    }
+    // Also covers the case of thread creation failing
+    files_worker(NULL);
+    for (c = 0; c < thread_count; c++)
+        pthread_join(threads[c], NULL);
+
+    return !work_failed;
+}
+
+
+// Read areas and symbols from one object file into its own lists
+static bool file_extract_one(uint32_t file_id) {
+
+    file_item * files = (file_item *)filelist.p_array;
+    file_scan_item * p_scan = &p_file_scans[file_id];
+    char * in_file_buf;
+    char * strline_in;
+    char * strline_end;
+    area_item   newarea;
+    symbol_item newsymbol;
+    symbol_ref_item newref;
+    bool        refs_needed = (option_get_pack_mode() == PACK_MODE_CLUSTER);
+    uint32_t    area_type_cur = SYMBOL_AREA_OTHER; // Symbol definitions follow the A line of their area
+
+    // Generated files are already in memory
+    in_file_buf = (files[file_id].data) ? files[file_id].data : file_read_to_buffer(files[file_id].name_in);
+    if (!in_file_buf)
+        return false;
+
+    // Process one \0 terminated line at a time, the \n is put back after
+    // each so the buffer can be rewritten without reading the file again
+    strline_in = in_file_buf;
+    while (*strline_in != '\0') {
+        strline_end = strchr(strline_in, '\n');
+        if (strline_end)
+            *strline_end = '\0';
+
+        if (strline_in[0] == 'A') {
+            area_type_cur = SYMBOL_AREA_OTHER;
+            if (area_parse(strline_in, file_id, &newarea)) {
+                list_additem(&p_scan->areas, &newarea);
+                area_type_cur = newarea.type;
+            }
+            else if (code_ram_area_check(strline_in))
+                files[file_id].code_ram_areas++;
+            else if (strncmp(strline_in, "A _CODE ", strlen("A _CODE ")) == 0)
+                area_type_cur = SYMBOL_AREA_CODE;
+        }
+        else if ((strline_in[0] == 'M') && (strline_in[1] == ' ')) {
+            // Only this thread touches this file's entry
+            snprintf(files[file_id].module, sizeof(files[file_id].module), "%s", strline_in + 2);
+            files[file_id].module[strcspn(files[file_id].module, "\r")] = '\0';
+        }
+        else if (strline_in[0] == 'S') {
+            if (symbol_parse(strline_in, file_id, &newsymbol)) {
+                newsymbol.area_type = area_type_cur;
+                list_additem(&p_scan->symbols, &newsymbol);
             }
-            fclose(obj_file);
+            else if ((refs_needed) && (symbol_ref_parse(strline_in, file_id, &newref)))
+                list_additem(&p_scan->refs, &newref);
+        }
+
+        if (!strline_end)
+            break;
+        *strline_end = '\n';
+        strline_in = strline_end + 1;
+    }
+
+    // Only this thread touches this file's entry
+    files[file_id].data = in_file_buf;
+    return true;
+}
+
+
+// Adds the areas, symbols and references collected from a file to the shared lists
+static void file_scan_merge(uint32_t file_id) {
+
+    uint32_t i;
+    file_scan_item * p_scan = &p_file_scans[file_id];
+
+    for (i = 0; i < p_scan->areas.count; i++)
+        areas_add_item(&((area_item *)p_scan->areas.p_array)[i]);
+    for (i = 0; i < p_scan->symbols.count; i++)
+        symbols_add_item(&((symbol_item *)p_scan->symbols.p_array)[i]);
+    for (i = 0; i < p_scan->refs.count; i++)
+        symbol_refs_add_item(&((symbol_ref_item *)p_scan->refs.p_array)[i]);
+
+    list_cleanup(&p_scan->areas);
+    list_cleanup(&p_scan->symbols);
+    list_cleanup(&p_scan->refs);
+}
+
 
-        } // end: if valid file
-        else {
-            printf("BankPack: ERROR: failed to open file %s\n", files[c].name_in);
+// Replaces a file with its split data segments (added at the end of the file list),
+// which are then scanned and merged in its place
+static void file_split_one(uint32_t file_id) {
+
+    uint32_t c;
+    uint32_t first = filelist.count;
+    file_scan_item * p_scan = &p_file_scans[file_id];
+
+    split_data_make(file_id, (area_item *)p_scan->areas.p_array);
+    ((file_item *)filelist.p_array)[file_id].split = true;
+
+    list_cleanup(&p_scan->areas);
+    list_cleanup(&p_scan->symbols);
+    list_cleanup(&p_scan->refs);
+
+    p_file_scans = realloc(p_file_scans, filelist.count * sizeof(file_scan_item));
+    if (!p_file_scans) {
+        printf("BankPack: ERROR: Failed to allocate memory for file scanning!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (c = first; c < filelist.count; c++) {
+        list_init(&p_file_scans[c].areas,   sizeof(area_item));
+        list_init(&p_file_scans[c].symbols, sizeof(symbol_item));
+        list_init(&p_file_scans[c].refs,    sizeof(symbol_ref_item));
+        if (!file_extract_one(c))
             exit(EXIT_FAILURE);
-        }
+        file_scan_merge(c);
+    }
+}
+
+
+// Extract areas from files, then collected assign them to banks
+//
+// Files are read in parallel, then their areas and symbols are
+// merged in file order so bank assignment is the same as reading
+// them one at a time.
+void files_extract(void) {
+    uint32_t c, count;
+    bool     result;
+
+    p_file_scans = malloc((filelist.count ? filelist.count : 1) * sizeof(file_scan_item));
+    if (!p_file_scans) {
+        printf("BankPack: ERROR: Failed to allocate memory for file scanning!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (c = 0; c < filelist.count; c++) {
+        list_init(&p_file_scans[c].areas,   sizeof(area_item));
+        list_init(&p_file_scans[c].symbols, sizeof(symbol_item));
+        list_init(&p_file_scans[c].refs,    sizeof(symbol_ref_item));
     }
 
+    result = files_process_parallel(file_extract_one);
+
+    // Merge in file order, the segments of a split data area take the place of its file
+    count = filelist.count;
+    for (c = 0; c < count; c++) {
+        if ((result) && (split_data_check(&p_file_scans[c].areas)))
+            file_split_one(c);
+        else
+            file_scan_merge(c);
+    }
+    free(p_file_scans);
+    p_file_scans = NULL;
+
+    if (!result)
+        exit(EXIT_FAILURE);
+
     obj_data_process(&filelist);
     files_set_output_name();
 }
 
 
-void files_rewrite(void) {
+// Writes a file with no RAM code areas: as one block if it needs no
+// changes, else the runs of lines which are not rewritten are copied
+// with one write each and only the A and S lines are checked
+static void file_rewrite_spans(char * in_file_buf, FILE * out_file, uint32_t file_id) {
+
+    char * span_start  = in_file_buf;
+    char * strline_in  = in_file_buf;
+    char * strline_end = NULL;
+    bool   written;
+    file_item * files  = (file_item *)filelist.p_array;
+
+    if (!files[file_id].rewrite_needed) {
+        fwrite(in_file_buf, 1, strlen(in_file_buf), out_file);
+        return;
+    }
+
+    while (*strline_in != '\0') {
+        strline_end = strchr(strline_in, '\n');
+
+        if ((*strline_in == 'A') || (*strline_in == 'S')) {
+            if (strline_end)
+                *strline_end = '\0';
+
+            // Flush the unchanged lines before this one first, in case it gets rewritten
+            fwrite(span_start, 1, strline_in - span_start, out_file);
+            written = (area_modify_and_write_to_file(strline_in, out_file, files[file_id].bank_num) ||
+                       symbol_modify_and_write_to_file(strline_in, out_file, files[file_id].bank_num, file_id));
+
+            if (strline_end)
+                *strline_end = '\n';
+            // Rewritten lines end with their own \n, unchanged ones start the next run
+            span_start = (written) ? (strline_end ? strline_end + 1 : strchr(strline_in, '\0')) : strline_in;
+        }
+
+        if (!strline_end)
+            break;
+        strline_in = strline_end + 1;
+    }
+
+    fwrite(span_start, 1, strlen(span_start), out_file);
+}
+
+
+// Write one object file out, with bank numbers updated if needed
+static bool file_rewrite_one(uint32_t file_id) {
 
-    uint32_t c;
     char * in_file_buf = NULL;
     char * strline_in  = NULL;
+    char * strline_end = NULL;
     FILE * out_file    = NULL;
     file_item * files  = (file_item *)filelist.p_array;
+    code_ram_rewrite_item code_ram;
 
-    // If linkerfile output is enabled, write it
-    if (g_out_linkerfile_name[0] != '\0')
-        files_write_linkerfile();
+    // Split files are replaced by their segments
+    if (files[file_id].split) {
+        free(files[file_id].data);
+        files[file_id].data = NULL;
+        return true;
+    }
 
-    // Process stored file names - (including unchanged ones since output may get new extensions or path)
-    for (c = 0; c < filelist.count; c++) {
+    // Writing an unchanged file over itself would only cost time
+    if (file_is_unchanged(&files[file_id]) && (strcmp(files[file_id].name_out, files[file_id].name_in) == 0)) {
+        free(files[file_id].data);
+        files[file_id].data = NULL;
+        return true;
+    }
 
-        in_file_buf = file_read_to_buffer(files[c].name_in);
-        if (!in_file_buf)
-            exit(EXIT_FAILURE);
+    // Contents kept from files_extract()
+    in_file_buf = files[file_id].data;
+    files[file_id].data = NULL;
+    if (!in_file_buf)
+        in_file_buf = file_read_to_buffer(files[file_id].name_in);
+    if (!in_file_buf)
+        return false;
+
+    out_file = fopen(files[file_id].name_out, "w");
+    if (!out_file) {
+        printf("BankPack: ERROR: failed to open output file %s\n", files[file_id].name_out);
+        free(in_file_buf);
+        return false;
+    }
 
-        out_file = fopen(files[c].name_out, "w");
-        if (!out_file) {
-            printf("BankPack: ERROR: failed to open output file %s\n", files[c].name_out);
-            exit(EXIT_FAILURE);
-        }
+    // Only some A and S lines change: copy the runs of lines between them as they are
+    if (!files[file_id].code_ram_areas) {
+        file_rewrite_spans(in_file_buf, out_file, file_id);
+        free(in_file_buf);
+        fclose(out_file);
+        return true;
+    }
 
-        // Read one line at a time from a string buffer
-        // Note: strtok will replace the \n chars with \0 on each split, so be sure to add those back
-        strline_in = strtok(in_file_buf,"\n");
-        while (strline_in != NULL) {
+    code_ram_rewrite_init(&code_ram, files[file_id].code_ram_areas);
 
-            // Only modify lines in flagged files
-            if (files[c].rewrite_needed) {
+    // Read one line at a time from the buffer, skipping empty lines
+    // Note: the \n chars are replaced with \0 on each split, so be sure to add those back
+    strline_in = in_file_buf;
+    while (true) {
+        while (*strline_in == '\n')
+            strline_in++;
+        if (*strline_in == '\0')
+            break;
 
-                if (!area_modify_and_write_to_file(strline_in, out_file, files[c].bank_num)) {
-                    if (!symbol_modify_and_write_to_file(strline_in, out_file, files[c].bank_num, c)) {
-                        // Default is to write line with no changes
-                        fprintf(out_file, "%s\n", strline_in);
-                    }
-                }
-            } else
-                fprintf(out_file, "%s\n", strline_in);
+        strline_end = strchr(strline_in, '\n');
+        if (strline_end)
+            *strline_end = '\0';
 
-            // Read next line
-            strline_in = strtok(NULL,"\n");
+        // RAM code gets moved into ROM load areas, whether banks are assigned or not
+        if (code_ram_modify_and_write_to_file(strline_in, out_file, &code_ram, file_id)) {
+            // Already written
         }
+        // Only modify lines in flagged files
+        else if (files[file_id].rewrite_needed) {
 
-        if (in_file_buf)
-            free(in_file_buf);
-        fclose(out_file);
+            if (!area_modify_and_write_to_file(strline_in, out_file, files[file_id].bank_num)) {
+                if (!symbol_modify_and_write_to_file(strline_in, out_file, files[file_id].bank_num, file_id)) {
+                    // Default is to write line with no changes
+                    fprintf(out_file, "%s\n", strline_in);
+                }
+            }
+        } else
+            fprintf(out_file, "%s\n", strline_in);
+
+        // Read next line
+        if (!strline_end)
+            break;
+        strline_in = strline_end + 1;
     }
 
+    code_ram_rewrite_finish(out_file, &code_ram);
+
+    free(in_file_buf);
+    fclose(out_file);
+    return true;
+}
+
+
+void files_rewrite(void) {
+
+    // If linkerfile output is enabled, write it
+    if (g_out_linkerfile_name[0] != '\0')
+        files_write_linkerfile();
+
+    // Process stored file names - (including unchanged ones since output may get new extensions or path)
+    if (!files_process_parallel(file_rewrite_one))
+        exit(EXIT_FAILURE);
 }
@@ -11,13 +11,18 @@ typedef struct file_item {
     char     name_in[MAX_FILE_STR];
     uint16_t bank_num;
     bool     rewrite_needed;
+    uint16_t code_ram_areas; // _CODE_RAM and _CODE_HRAM areas, moved into ROM load areas on rewrite
     char     name_out[MAX_FILE_STR];
+    char     module[MAX_FILE_STR]; // From the "M <module>" line, empty if there wasn't one
+    char *   data;                 // Contents read by files_extract(), kept for the rewrite
+    bool     split;                // Replaced by its segments for -split=, not written or linked
 } file_item;
 
 
 void files_init(void);
 void files_cleanup(void);
 void files_add(char *);
+void files_add_generated(char *, char *);
 
 void files_read_linkerfile(char *);
 void files_set_linkerfile_outname(char *);
@@ -25,9 +30,11 @@ void files_write_linkerfile(void);
 
 char * file_get_name_in_by_id(uint32_t);
 char * file_get_name_out_by_id(uint32_t);
+char * file_get_module_by_id(uint32_t);
 
 void files_set_out_ext(char *);
 void files_set_out_path(char *);
+void files_set_skip_unchanged(bool);
 
 void files_extract(void);
 void files_rewrite(void);
@@ -12,6 +12,7 @@
 
 #include "common.h"
 #include "list.h"
+#include "symtab.h"
 #include "files.h"
 #include "options.h"
 #include "obj_data.h"
@@ -32,8 +33,24 @@ static bool symbol_banked_check_rewrite_ok(char *, uint32_t);
 list_type banklist;
 list_type arealist;
 list_type symbollist;
+list_type symbol_reflist;
 list_type symbol_matchlist;
 
+// Banked symbol definitions (b_<name>) which had a matching <name> in the same file,
+// keyed by <name> minus the leading underscore and scoped by file id
+symtab_type symbol_banked_tab;
+
+// Call counts from -profile=, keyed by symbol name
+symtab_type profile_tab;
+bool        profile_loaded = false;
+
+// Bank assignments of the previous run from -stable=, keyed by module name and scoped by area type
+symtab_type stable_tab;
+char        stable_filename[MAX_FILE_STR] = {'\0'};
+
+// JSON report from -report=
+char        report_filename[MAX_FILE_STR] = {'\0'};
+
 uint16_t bank_limit_rom_min = BANK_NUM_ROM_MIN;
 uint16_t bank_limit_rom_max = BANK_NUM_ROM_MAX;
 
@@ -50,7 +67,11 @@ void obj_data_init(void) {
     list_init(&banklist,      sizeof(bank_item));
     list_init(&arealist,      sizeof(area_item));
     list_init(&symbollist,    sizeof(symbol_item));
+    list_init(&symbol_reflist, sizeof(symbol_ref_item));
     list_init(&symbol_matchlist, sizeof(symbol_match_item));
+    symtab_init(&symbol_banked_tab);
+    symtab_init(&profile_tab);
+    symtab_init(&stable_tab);
 
     // Pre-populate bank list with max number of banks
     // to allow handling fixed-bank (non-autobank) areas
@@ -70,7 +91,11 @@ void obj_data_cleanup(void) {
     list_cleanup(&banklist);
     list_cleanup(&arealist);
     list_cleanup(&symbollist);
+    list_cleanup(&symbol_reflist);
     list_cleanup(&symbol_matchlist);
+    symtab_cleanup(&symbol_banked_tab);
+    symtab_cleanup(&profile_tab);
+    symtab_cleanup(&stable_tab);
 }
 
 
@@ -86,33 +111,133 @@ void symbol_match_add(char * symbol_str) {
 }
 
 
+// Read "<symbol> <count>" lines, such as from emu_profile.py --counts
+// Empty lines and lines starting with # are skipped
+void profile_read(char * filename_in) {
 
-// Add an area into the pool of areas to assign (if it's banked CODE)
-int areas_add(char * area_str, uint32_t file_id) {
+    char     strline_in[MAX_FILE_STR];
+    char     name[OBJ_NAME_MAX_STR_LEN + 1];
+    uint32_t count;
+    FILE *   in_file;
+
+    in_file = fopen(filename_in, "r");
+    if (!in_file) {
+        printf("BankPack: ERROR: failed to open profile: %s\n", filename_in);
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(strline_in, sizeof(strline_in), in_file) != NULL) {
+        if ((strline_in[0] == '#') || (strline_in[0] == '\n') || (strline_in[0] == '\r'))
+            continue;
+        if (2 == sscanf(strline_in, "%" TOSTR(OBJ_NAME_MAX_STR_LEN) "s %u", name, &count))
+            symtab_add(&profile_tab, name, 0, count);
+        else
+            printf("BankPack: Warning: Ignoring malformed profile line: %s", strline_in);
+    }
+    fclose(in_file);
+    profile_loaded = true;
+}
+
+
+bool profile_is_loaded(void) {
+    return profile_loaded;
+}
+
+
+// Read the previous assignment map for -stable= if there is one,
+// the same file gets written with the new assignments by stable_map_write()
+// Lines are "<bank> <area> <module>", lines starting with # are skipped
+void stable_map_set(char * filename_in) {
+
+    char     strline_in[MAX_FILE_STR];
+    char     area_name[OBJ_NAME_MAX_STR_LEN + 1];
+    char     module[MAX_FILE_STR + 1];
+    uint32_t bank_num;
+    FILE *   in_file;
+
+    if (snprintf(stable_filename, sizeof(stable_filename), "%s", filename_in) > sizeof(stable_filename))
+        printf("BankPack: Warning: truncated assignment map filename to:%s\n", stable_filename);
+
+    // No map yet on the first run
+    in_file = fopen(stable_filename, "r");
+    if (!in_file)
+        return;
+
+    while (fgets(strline_in, sizeof(strline_in), in_file) != NULL) {
+        if ((strline_in[0] == '#') || (strline_in[0] == '\n') || (strline_in[0] == '\r'))
+            continue;
+        if (3 == sscanf(strline_in, "%u %" TOSTR(OBJ_NAME_MAX_STR_LEN) "s %" TOSTR(MAX_FILE_STR) "s", &bank_num, area_name, module))
+            symtab_add(&stable_tab, module, (strcmp(area_name, "_LIT_") == 0) ? BANK_TYPE_LIT_EXCLUSIVE : BANK_TYPE_DEFAULT, bank_num);
+        else
+            printf("BankPack: Warning: Ignoring malformed assignment map line: %s", strline_in);
+    }
+    fclose(in_file);
+}
 
-    area_item newarea;
+
+// Write the auto-bank assignments for the next -stable= run
+// Should be called after obj_data_process()
+void stable_map_write(void) {
+
+    uint32_t c;
+    FILE *   out_file;
+    area_item * areas = (area_item *)arealist.p_array;
+
+    if (stable_filename[0] == '\0')
+        return;
+
+    out_file = fopen(stable_filename, "w");
+    if (!out_file) {
+        printf("BankPack: ERROR: failed to open assignment map for writing: %s\n", stable_filename);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out_file, "# bankpack -stable= assignments: <bank> <area> <module>\n");
+    for (c = 0; c < arealist.count; c++)
+        if ((areas[c].bank_num_in == BANK_NUM_AUTO) && (areas[c].bank_num_out != BANK_NUM_UNASSIGNED))
+            fprintf(out_file, "%d %s %s\n", areas[c].bank_num_out, areas[c].name, file_get_module_by_id(areas[c].file_id));
+    fclose(out_file);
+}
+
+
+// Call count for a symbol, matching either the symbol name (_foo) or the C name (foo)
+// Only the plain symbol counts, so a banked call isn't also counted through b_foo
+static uint32_t profile_count_get(const char * symbol_name) {
+
+    uint32_t count = symtab_find(&profile_tab, symbol_name, 0);
+
+    if ((count == SYMTAB_NOT_FOUND) && (symbol_name[0] == '_'))
+        count = symtab_find(&profile_tab, symbol_name + 1, 0);
+
+    return (count == SYMTAB_NOT_FOUND) ? 0 : count;
+}
+
+
+// Parse an area line into an area item (if it's banked CODE)
+// Doesn't modify any shared state, so it's safe to call from multiple threads
+bool area_parse(char * area_str, uint32_t file_id, area_item * p_area) {
 
     // Only match areas which are banked ("_CODE_" vs "_CODE") and ("_LIT_")
     if (AREA_LINE_RECORDS == sscanf(area_str,"A _CODE _%3d size %4x flags %*4x addr %*4x",
-                                    &newarea.bank_num_in, &newarea.size)) {
-        newarea.type = BANK_TYPE_DEFAULT;
+                                    &p_area->bank_num_in, &p_area->size)) {
+        p_area->type = BANK_TYPE_DEFAULT;
     }
     else if (AREA_LINE_RECORDS == sscanf(area_str,"A _LIT_%3d size %4x flags %*4x addr %*4x",
-                                        &newarea.bank_num_in, &newarea.size)) {
-        newarea.type = BANK_TYPE_LIT_EXCLUSIVE;
+                                        &p_area->bank_num_in, &p_area->size)) {
+        p_area->type = BANK_TYPE_LIT_EXCLUSIVE;
     }
     else
         return false;
 
     // Only process areas with (size > 0)
-    if (newarea.size > 0) {
-        if (newarea.type == BANK_TYPE_LIT_EXCLUSIVE)
-            sprintf(newarea.name, "_LIT_");  // Hardwired to _LIT_ for now
+    if (p_area->size > 0) {
+        if (p_area->type == BANK_TYPE_LIT_EXCLUSIVE)
+            sprintf(p_area->name, "_LIT_");  // Hardwired to _LIT_ for now
         else
-            sprintf(newarea.name, "_CODE_"); // Hardwired to _CODE_ for now
-        newarea.file_id = file_id;
-        newarea.bank_num_out = BANK_NUM_UNASSIGNED;
-        list_additem(&arealist, &newarea);
+            sprintf(p_area->name, "_CODE_"); // Hardwired to _CODE_ for now
+        p_area->file_id = file_id;
+        p_area->bank_num_out = BANK_NUM_UNASSIGNED;
+        p_area->bank_num_plan = BANK_NUM_UNASSIGNED;
         return true;
     } else
         return false;
@@ -120,22 +245,53 @@ int areas_add(char * area_str, uint32_t file_id) {
 
 
 // Add an area into the pool of areas to assign (if it's banked CODE)
-int symbols_add(char * symbol_str, uint32_t file_id) {
+int areas_add(char * area_str, uint32_t file_id) {
+
+    area_item newarea;
+
+    if (area_parse(area_str, file_id, &newarea)) {
+        list_additem(&arealist, &newarea);
+        return true;
+    } else
+        return false;
+}
+
+
+// Add an already parsed area into the pool of areas to assign
+void areas_add_item(area_item * p_area) {
+    list_additem(&arealist, p_area);
+}
 
-    symbol_item newsymbol;
+
+// Parse a symbol line into a symbol item
+// Doesn't modify any shared state, so it's safe to call from multiple threads
+bool symbol_parse(char * symbol_str, uint32_t file_id, symbol_item * p_symbol) {
 
      if (SYMBOL_LINE_RECORDS == sscanf(symbol_str,"S %" TOSTR(OBJ_NAME_MAX_STR_LEN) "s Def00%4x",
-                                       newsymbol.name, &newsymbol.bank_num_in)) {
+                                       p_symbol->name, &p_symbol->bank_num_in)) {
 
         // Symbols that start with b_ store the bank num for the matching symbol without 'b'
-        newsymbol.is_banked_def          = (newsymbol.name[0] == 'b');
-        newsymbol.file_id                = file_id;
-        newsymbol.found_matching_symbol  = false;
+        p_symbol->is_banked_def          = (p_symbol->name[0] == 'b');
+        p_symbol->file_id                = file_id;
+        p_symbol->found_matching_symbol  = false;
+        p_symbol->area_type              = SYMBOL_AREA_OTHER;
 
         // Don't add banked symbols if they're not set to the autobank bank #
-        if ((newsymbol.is_banked_def) && (newsymbol.bank_num_in != BANK_NUM_AUTO))
+        if ((p_symbol->is_banked_def) && (p_symbol->bank_num_in != BANK_NUM_AUTO))
             return false;
 
+        return true;
+    }
+    return false;
+}
+
+
+// Add a symbol into the pool of symbols to check
+int symbols_add(char * symbol_str, uint32_t file_id) {
+
+    symbol_item newsymbol;
+
+    if (symbol_parse(symbol_str, file_id, &newsymbol)) {
         list_additem(&symbollist, &newsymbol);
         return true;
     }
@@ -143,6 +299,33 @@ int symbols_add(char * symbol_str, uint32_t file_id) {
 }
 
 
+// Add an already parsed symbol into the pool of symbols to check
+void symbols_add_item(symbol_item * p_symbol) {
+    list_additem(&symbollist, p_symbol);
+}
+
+
+// Parse a symbol reference line into a reference item
+// Doesn't modify any shared state, so it's safe to call from multiple threads
+bool symbol_ref_parse(char * symbol_str, uint32_t file_id, symbol_ref_item * p_ref) {
+
+    char ref_str[4];
+
+    if ((SYMBOL_REF_RECORDS == sscanf(symbol_str,"S %" TOSTR(OBJ_NAME_MAX_STR_LEN) "s %3s", p_ref->name, ref_str)) &&
+        (strcmp(ref_str, "Ref") == 0)) {
+        p_ref->file_id = file_id;
+        return true;
+    }
+    return false;
+}
+
+
+// Add an already parsed reference into the pool used by -pack=cluster
+void symbol_refs_add_item(symbol_ref_item * p_ref) {
+    list_additem(&symbol_reflist, p_ref);
+}
+
+
 // Track Min/Max assigned banks used
 static void bank_update_assigned_minmax(uint16_t bank_num) {
 
@@ -212,6 +395,8 @@ static void bank_check_area_size(area_item * p_area) {
     if (p_area->size > BANK_SIZE_ROM) {
         printf("BankPack: ERROR! Area %s, bank %d, size %d is too large for bank size %d (file %s)\n",
                 p_area->name, p_area->bank_num_in, p_area->size, BANK_SIZE_ROM, file_get_name_in_by_id(p_area->file_id));
+        if (p_area->bank_num_in == BANK_NUM_AUTO)
+            printf("  Auto-banked data can be split across banks with -split=<file>\n");
         exit(EXIT_FAILURE);
     }
 }
@@ -292,24 +477,703 @@ static bool banks_assign_area_random(area_item * p_area, bank_item * banks) {
 }
 
 
-// Assign areas linearly, trying to fill up lowest banks first
-static bool banks_assign_area_linear(area_item * p_area, bank_item * banks) {
+// Find the first allowed bank with enough free space (First Fit)
+static uint16_t bank_find_first_fit(area_item * p_area, bank_item * banks) {
 
     uint16_t bank_num;
 
-    // Try to assign area to first allowed bank with enough free space
     // Bank array index maps directly to bank numbers, so [2] will be _CODE_2
+    for (bank_num = bank_limit_rom_min; bank_num <= bank_limit_rom_max; bank_num++) {
+        if (bank_check_ok_for_area(bank_num, p_area, banks))
+            return bank_num;
+    }
+    return BANK_NUM_UNASSIGNED;
+}
+
+
+// Find the allowed bank with the least free space which still fits the area (Best Fit)
+// Only banks which already hold areas are compared. If none fit then the lowest
+// empty bank is used, so higher numbered (reserved) empty banks aren't opened early
+static uint16_t bank_find_best_fit(area_item * p_area, bank_item * banks) {
+
+    uint16_t bank_num;
+    uint16_t bank_best  = BANK_NUM_UNASSIGNED;
+    uint16_t bank_empty = BANK_NUM_UNASSIGNED;
+
     for (bank_num = bank_limit_rom_min; bank_num <= bank_limit_rom_max; bank_num++) {
         if (bank_check_ok_for_area(bank_num, p_area, banks)) {
-            bank_add_area(&banks[bank_num], bank_num, p_area);
-            return true;
+            if (banks[bank_num].item_count == 0) {
+                if (bank_empty == BANK_NUM_UNASSIGNED)
+                    bank_empty = bank_num;
+            }
+            else if ((bank_best == BANK_NUM_UNASSIGNED) || (banks[bank_num].free < banks[bank_best].free))
+                bank_best = bank_num;
+        }
+    }
+    return (bank_best != BANK_NUM_UNASSIGNED) ? bank_best : bank_empty;
+}
+
+
+// Assign areas linearly, trying to fill up lowest banks first
+static bool banks_assign_area_linear(area_item * p_area, bank_item * banks) {
+
+    uint16_t bank_num = bank_find_first_fit(p_area, banks);
+
+    if (bank_num == BANK_NUM_UNASSIGNED)
+        return false; // Fail if no banks were available
+
+    bank_add_area(&banks[bank_num], bank_num, p_area);
+    return true;
+}
+
+
+// Assign areas to the fullest bank they fit in
+static bool banks_assign_area_best_fit(area_item * p_area, bank_item * banks) {
+
+    uint16_t bank_num = bank_find_best_fit(p_area, banks);
+
+    if (bank_num == BANK_NUM_UNASSIGNED)
+        return false; // Fail if no banks were available
+
+    bank_add_area(&banks[bank_num], bank_num, p_area);
+    return true;
+}
+
+
+// Assign areas to the bank picked for them by banks_plan_auto_areas()
+static bool banks_assign_area_planned(area_item * p_area, bank_item * banks) {
+
+    uint16_t bank_num = p_area->bank_num_plan;
+
+    if ((bank_num == BANK_NUM_UNASSIGNED) || (!bank_check_ok_for_area(bank_num, p_area, banks)))
+        return false;
+
+    bank_add_area(&banks[bank_num], bank_num, p_area);
+    return true;
+}
+
+
+// == Packing strategies ==
+//
+// The strategies are compared by running them on a scratch copy of the banks.
+// Fewer banks used is better, the highest bank used sets the cart size so it's checked first.
+
+#define PACK_SEARCH_NODES_MAX 250000u // Bound on branch and bound search steps before settling for the best found
+
+#define PACK_SEARCH_NONE    0
+#define PACK_SEARCH_FOUND   1
+#define PACK_SEARCH_ABORTED 2
+
+typedef struct pack_result {
+    bool     ok;
+    uint16_t bank_count; // Number of banks holding areas
+    uint16_t bank_max;   // Highest bank holding an area
+} pack_result;
+
+typedef struct pack_search {
+    area_item * p_areas;
+    uint32_t    count;
+    bank_item * banks;
+    uint16_t    bank_last;         // Highest bank the search may place areas in
+    uint16_t *  p_plan;
+    uint32_t *  p_size_remaining;  // Total size of areas [n .. count-1]
+    uint32_t    nodes;
+} pack_search;
+
+
+// Same bookkeeping as bank_add_area(), without the side effects
+static void bank_scratch_add_area(bank_item * p_bank, area_item * p_area) {
+    p_bank->free -= p_area->size;
+    p_bank->type = p_area->type;
+    p_bank->item_count++;
+}
+
+
+static void banks_pack_result(bank_item * banks, bool ok, pack_result * p_result) {
+
+    uint16_t bank_num;
+
+    p_result->ok = ok;
+    p_result->bank_count = 0;
+    p_result->bank_max = 0;
+    for (bank_num = bank_limit_rom_min; bank_num <= bank_limit_rom_max; bank_num++) {
+        if (banks[bank_num].item_count > 0) {
+            p_result->bank_count++;
+            p_result->bank_max = bank_num;
+        }
+    }
+}
+
+
+static bool pack_result_is_better(pack_result * p_a, pack_result * p_b) {
+
+    if (p_a->ok != p_b->ok)
+        return p_a->ok;
+    else if (p_a->bank_max != p_b->bank_max)
+        return (p_a->bank_max < p_b->bank_max);
+    else
+        return (p_a->bank_count < p_b->bank_count);
+}
+
+
+// Run a greedy strategy (FFD or BFD) over the auto-bank areas
+static void banks_pack_greedy(area_item * p_areas, uint32_t count, bank_item * banks, int pack_mode,
+                              uint16_t * p_plan, pack_result * p_result) {
+
+    uint32_t c;
+    uint16_t bank_num;
+
+    for (c = 0; c < count; c++) {
+        if (pack_mode == PACK_MODE_BFD)
+            bank_num = bank_find_best_fit(&p_areas[c], banks);
+        else
+            bank_num = bank_find_first_fit(&p_areas[c], banks);
+
+        p_plan[c] = bank_num;
+        if (bank_num == BANK_NUM_UNASSIGNED) {
+            banks_pack_result(banks, false, p_result);
+            return;
+        }
+        bank_scratch_add_area(&banks[bank_num], &p_areas[c]);
+    }
+    banks_pack_result(banks, true, p_result);
+}
+
+
+// Depth first search for a placement of areas [idx .. count-1] in banks up to bank_last
+// Areas are sorted by size (descending) so the smallest remaining area is always the last one
+static int pack_search_area(pack_search * p_search, uint32_t idx) {
+
+    area_item * p_area;
+    bank_item * banks = p_search->banks;
+    bank_item   bank_saved;
+    uint32_t    size_min;
+    uint32_t    free_usable;
+    uint16_t    bank_num, bank_prev;
+    bool        bank_dupe;
+    int         result;
+
+    if (idx == p_search->count)
+        return PACK_SEARCH_FOUND;
+
+    if (++p_search->nodes > PACK_SEARCH_NODES_MAX)
+        return PACK_SEARCH_ABORTED;
+
+    // Bound: Free space which can still hold the smallest remaining area has to cover all remaining areas
+    size_min = p_search->p_areas[p_search->count - 1].size;
+    free_usable = 0;
+    for (bank_num = bank_limit_rom_min; bank_num <= p_search->bank_last; bank_num++) {
+        if ((banks[bank_num].free >= size_min) &&
+            ((option_get_mbc_type() != MBC_TYPE_MBC1) || (bank_check_mbc1_ok(bank_num))))
+            free_usable += banks[bank_num].free;
+    }
+    if (free_usable < p_search->p_size_remaining[idx])
+        return PACK_SEARCH_NONE;
+
+    p_area = &p_search->p_areas[idx];
+    for (bank_num = bank_limit_rom_min; bank_num <= p_search->bank_last; bank_num++) {
+
+        if (!bank_check_ok_for_area(bank_num, p_area, banks))
+            continue;
+
+        // Skip banks in the same state as one already tried for this area, the outcome would be the same
+        bank_dupe = false;
+        for (bank_prev = bank_limit_rom_min; bank_prev < bank_num; bank_prev++) {
+            if ((banks[bank_prev].free == banks[bank_num].free) &&
+                (banks[bank_prev].type == banks[bank_num].type) &&
+                ((option_get_mbc_type() != MBC_TYPE_MBC1) || (bank_check_mbc1_ok(bank_prev)))) {
+                bank_dupe = true;
+                break;
+            }
+        }
+        if (bank_dupe)
+            continue;
+
+        bank_saved = banks[bank_num];
+        bank_scratch_add_area(&banks[bank_num], p_area);
+        p_search->p_plan[idx] = bank_num;
+
+        result = pack_search_area(p_search, idx + 1);
+        banks[bank_num] = bank_saved;
+
+        if (result != PACK_SEARCH_NONE)
+            return result;
+    }
+
+    return PACK_SEARCH_NONE;
+}
+
+
+// Bounded branch and bound search for the lowest highest-bank that all areas fit in.
+// Tries each limit from a lower bound up to (but not including) the best greedy result,
+// the first limit with a valid placement is optimal. Returns false if the search was cut short.
+static bool banks_pack_optimal(area_item * p_areas, uint32_t count, bank_item * banks_start,
+                               pack_result * p_best, uint16_t * p_plan_best) {
+
+    bank_item   banks[BANK_ROM_TOTAL];
+    pack_search search;
+    pack_result result;
+    uint32_t    c;
+    uint32_t    free_total = 0;
+    uint16_t    bank_num;
+    uint16_t    bank_last_max;
+    int         status = PACK_SEARCH_NONE;
+
+    if (count == 0)
+        return true;
+
+    search.p_areas = p_areas;
+    search.count = count;
+    search.banks = banks;
+    search.nodes = 0;
+    search.p_plan = malloc(count * sizeof(uint16_t));
+    search.p_size_remaining = malloc(count * sizeof(uint32_t));
+    if ((!search.p_plan) || (!search.p_size_remaining)) {
+        printf("BankPack: ERROR! Failed to allocate memory for packing search!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    search.p_size_remaining[count - 1] = p_areas[count - 1].size;
+    for (c = count - 1; c > 0; c--)
+        search.p_size_remaining[c - 1] = search.p_size_remaining[c] + p_areas[c - 1].size;
+
+    // Lower bound: enough free space for everything, and no lower than banks already used by fixed areas
+    banks_pack_result(banks_start, true, &result);
+    for (bank_num = bank_limit_rom_min; bank_num <= bank_limit_rom_max; bank_num++) {
+        if ((option_get_mbc_type() != MBC_TYPE_MBC1) || (bank_check_mbc1_ok(bank_num)))
+            free_total += banks_start[bank_num].free;
+        if (free_total >= search.p_size_remaining[0])
+            break;
+    }
+    search.bank_last = (bank_num > result.bank_max) ? bank_num : result.bank_max;
+    bank_last_max    = (p_best->ok) ? p_best->bank_max - 1 : bank_limit_rom_max;
+
+    for (; search.bank_last <= bank_last_max; search.bank_last++) {
+
+        memcpy(banks, banks_start, sizeof(banks));
+        status = pack_search_area(&search, 0);
+
+        if (status == PACK_SEARCH_FOUND) {
+            // The search leaves banks as it found them, so rebuild the placement to measure it
+            memcpy(banks, banks_start, sizeof(banks));
+            for (c = 0; c < count; c++)
+                bank_scratch_add_area(&banks[search.p_plan[c]], &p_areas[c]);
+            banks_pack_result(banks, true, &result);
+
+            if (pack_result_is_better(&result, p_best)) {
+                *p_best = result;
+                memcpy(p_plan_best, search.p_plan, count * sizeof(uint16_t));
+            }
+            break;
+        }
+        else if (status == PACK_SEARCH_ABORTED)
+            break;
+    }
+
+    free(search.p_plan);
+    free(search.p_size_remaining);
+
+    return (status != PACK_SEARCH_ABORTED);
+}
+
+
+static void pack_result_show(const char * mode_str, pack_result * p_result, pack_result * p_result_ffd) {
+
+    if (!p_result->ok)
+        printf("BankPack: Packing %-7s: out of banks\n", mode_str);
+    else if (p_result == p_result_ffd)
+        printf("BankPack: Packing %-7s: %d banks (highest bank %d)\n",
+                mode_str, p_result->bank_count, p_result->bank_max);
+    else if (!p_result_ffd->ok)
+        printf("BankPack: Packing %-7s: %d banks (highest bank %d), ffd ran out of banks\n",
+                mode_str, p_result->bank_count, p_result->bank_max);
+    else
+        printf("BankPack: Packing %-7s: %d banks (highest bank %d), %d banks saved vs ffd\n",
+                mode_str, p_result->bank_count, p_result->bank_max,
+                (int)p_result_ffd->bank_count - (int)p_result->bank_count);
+}
+
+
+// == Cluster packing ==
+//
+// Files which use symbols from each other are grouped, heaviest links first, as long as
+// the group still fits in a bank. Each group is then placed as a single unit with first fit,
+// so calls and data accesses between the files stay in one bank without bank switching.
+
+#define PROFILE_HOT_FILES_SHOW 3 // Number of hot files listed with -profile=
+
+typedef struct pack_edge {
+    uint32_t a;      // Lower auto-bank area index of the pair
+    uint32_t b;      // Higher auto-bank area index of the pair
+    uint32_t refs;   // Number of symbols one uses from the other
+    uint32_t calls;  // Profiled calls to those symbols (from -profile=)
+} pack_edge;
+
+typedef struct pack_cluster {
+    uint32_t root;
+    uint32_t size;
+} pack_cluster;
+
+
+// qsort compare rule for merging duplicate edges: by pair [asc]
+static int pack_edge_compare_pair(const void* a, const void* b) {
+
+    const pack_edge * p_a = (const pack_edge *)a;
+    const pack_edge * p_b = (const pack_edge *)b;
+
+    if (p_a->a != p_b->a)
+        return (p_a->a < p_b->a) ? -1 : 1;
+    else if (p_a->b != p_b->b)
+        return (p_a->b < p_b->b) ? -1 : 1;
+    else
+        return 0;
+}
+
+
+// qsort compare rule for clustering: by calls [desc], refs [desc], then by pair [asc] to keep results stable
+static int pack_edge_compare_weight(const void* a, const void* b) {
+
+    const pack_edge * p_a = (const pack_edge *)a;
+    const pack_edge * p_b = (const pack_edge *)b;
+
+    if (p_a->calls != p_b->calls)
+        return (p_a->calls > p_b->calls) ? -1 : 1;
+    else if (p_a->refs != p_b->refs)
+        return (p_a->refs > p_b->refs) ? -1 : 1;
+    else
+        return pack_edge_compare_pair(a, b);
+}
+
+
+// qsort compare rule for placing clusters: by size [desc], then by root [asc]
+static int pack_cluster_compare(const void* a, const void* b) {
+
+    const pack_cluster * p_a = (const pack_cluster *)a;
+    const pack_cluster * p_b = (const pack_cluster *)b;
+
+    if (p_a->size != p_b->size)
+        return (p_a->size > p_b->size) ? -1 : 1;
+    else if (p_a->root != p_b->root)
+        return (p_a->root < p_b->root) ? -1 : 1;
+    else
+        return 0;
+}
+
+
+// Build the list of auto-bank area pairs whose files reference each other
+// Returns the number of edges, *pp_edges must be freed by the caller
+static uint32_t pack_edges_build(area_item * p_areas, uint32_t count, pack_edge ** pp_edges) {
+
+    symbol_item     * symbols = (symbol_item *)symbollist.p_array;
+    symbol_ref_item * refs    = (symbol_ref_item *)symbol_reflist.p_array;
+    pack_edge * p_edges;
+    uint32_t *  p_file_area;
+    uint32_t    file_count = 0;
+    uint32_t    edge_count = 0;
+    uint32_t    c, def_file, a, b;
+    symtab_type def_tab;
+
+    for (c = 0; c < arealist.count; c++)
+        if (((area_item *)arealist.p_array)[c].file_id >= file_count)
+            file_count = ((area_item *)arealist.p_array)[c].file_id + 1;
+
+    p_file_area = malloc(file_count * sizeof(uint32_t));
+    p_edges     = malloc((symbol_reflist.count ? symbol_reflist.count : 1) * sizeof(pack_edge));
+    if ((!p_file_area) || (!p_edges)) {
+        printf("BankPack: ERROR! Failed to allocate memory for packing!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Files get a single bank, so a file maps to its (first) auto-bank area
+    for (c = 0; c < file_count; c++)
+        p_file_area[c] = SYMTAB_NOT_FOUND;
+    for (c = count; c > 0; c--)
+        p_file_area[p_areas[c - 1].file_id] = c - 1;
+
+    // Index global symbol definitions by name -> defining file
+    symtab_init(&def_tab);
+    for (c = 0; c < symbollist.count; c++)
+        if ((symbols[c].file_id < file_count) && (p_file_area[symbols[c].file_id] != SYMTAB_NOT_FOUND))
+            symtab_add(&def_tab, symbols[c].name, 0, symbols[c].file_id);
+
+    for (c = 0; c < symbol_reflist.count; c++) {
+        if ((refs[c].file_id >= file_count) || (p_file_area[refs[c].file_id] == SYMTAB_NOT_FOUND))
+            continue;
+        def_file = symtab_find(&def_tab, refs[c].name, 0);
+        if ((def_file == SYMTAB_NOT_FOUND) || (def_file == refs[c].file_id))
+            continue;
+
+        a = p_file_area[refs[c].file_id];
+        b = p_file_area[def_file];
+        p_edges[edge_count].a = (a < b) ? a : b;
+        p_edges[edge_count].b = (a < b) ? b : a;
+        p_edges[edge_count].refs  = 1;
+        p_edges[edge_count].calls = profile_count_get(refs[c].name);
+        edge_count++;
+    }
+    symtab_cleanup(&def_tab);
+    free(p_file_area);
+
+    // Merge references between the same pair of files
+    qsort(p_edges, edge_count, sizeof(pack_edge), pack_edge_compare_pair);
+    for (a = 0, c = 0; c < edge_count; c++) {
+        if ((a > 0) && (pack_edge_compare_pair(&p_edges[a - 1], &p_edges[c]) == 0)) {
+            p_edges[a - 1].refs  += p_edges[c].refs;
+            p_edges[a - 1].calls += p_edges[c].calls;
+        } else
+            p_edges[a++] = p_edges[c];
+    }
+
+    *pp_edges = p_edges;
+    return a;
+}
+
+
+// Count the references and profiled calls which a plan keeps within a bank
+// A NULL plan counts all of them
+static void pack_edges_same_bank(pack_edge * p_edges, uint32_t edge_count, uint16_t * p_plan,
+                                 uint32_t * p_refs, uint32_t * p_calls) {
+
+    uint32_t c;
+
+    *p_refs = *p_calls = 0;
+    for (c = 0; c < edge_count; c++) {
+        if ((!p_plan) || (p_plan[p_edges[c].a] == p_plan[p_edges[c].b])) {
+            *p_refs  += p_edges[c].refs;
+            *p_calls += p_edges[c].calls;
+        }
+    }
+}
+
+
+static uint32_t pack_cluster_find(uint32_t * p_parent, uint32_t idx) {
+
+    while (p_parent[idx] != idx) {
+        p_parent[idx] = p_parent[p_parent[idx]]; // Path halving
+        idx = p_parent[idx];
+    }
+    return idx;
+}
+
+
+// Group linked areas into clusters and place each cluster with first fit
+static void banks_pack_cluster(area_item * p_areas, uint32_t count, bank_item * banks,
+                               pack_edge * p_edges, uint32_t edge_count,
+                               uint16_t * p_plan, pack_result * p_result) {
+
+    uint32_t *     p_parent = malloc(count * sizeof(uint32_t));
+    uint32_t *     p_size   = malloc(count * sizeof(uint32_t));
+    uint16_t *     p_bank   = malloc(count * sizeof(uint16_t));
+    pack_cluster * p_clusters = malloc(count * sizeof(pack_cluster));
+    uint32_t       cluster_count = 0;
+    uint32_t       free_max = 0;
+    uint32_t       c, ra, rb;
+    uint16_t       bank_num;
+    area_item      cluster_area;
+    bool           ok = true;
+
+    if ((!p_parent) || (!p_size) || (!p_bank) || (!p_clusters)) {
+        printf("BankPack: ERROR! Failed to allocate memory for packing!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Clusters can't grow past the most free space left in any usable bank
+    for (bank_num = bank_limit_rom_min; bank_num <= bank_limit_rom_max; bank_num++) {
+        if (((option_get_mbc_type() != MBC_TYPE_MBC1) || (bank_check_mbc1_ok(bank_num))) &&
+            (banks[bank_num].free > free_max))
+            free_max = banks[bank_num].free;
+    }
+
+    for (c = 0; c < count; c++) {
+        p_parent[c] = c;
+        p_size[c] = p_areas[c].size;
+    }
+
+    qsort(p_edges, edge_count, sizeof(pack_edge), pack_edge_compare_weight);
+    for (c = 0; c < edge_count; c++) {
+        ra = pack_cluster_find(p_parent, p_edges[c].a);
+        rb = pack_cluster_find(p_parent, p_edges[c].b);
+        if ((ra == rb) || (p_size[ra] + p_size[rb] > free_max))
+            continue;
+        // sms/gg can't mix _CODE_ and _LIT_ in a bank, so those can't share a cluster
+        if ((option_get_platform() == PLATFORM_SMS) && (p_areas[ra].type != p_areas[rb].type))
+            continue;
+
+        // Keep the lower index as root, it's the larger area
+        if (rb < ra) { uint32_t tmp = ra; ra = rb; rb = tmp; }
+        p_parent[rb] = ra;
+        p_size[ra] += p_size[rb];
+    }
+
+    for (c = 0; c < count; c++) {
+        if (pack_cluster_find(p_parent, c) == c) {
+            p_clusters[cluster_count].root = c;
+            p_clusters[cluster_count].size = p_size[c];
+            cluster_count++;
+        }
+    }
+    qsort(p_clusters, cluster_count, sizeof(pack_cluster), pack_cluster_compare);
+
+    for (c = 0; c < cluster_count; c++) {
+        cluster_area = p_areas[p_clusters[c].root];
+        cluster_area.size = p_clusters[c].size;
+
+        bank_num = bank_find_first_fit(&cluster_area, banks);
+        p_bank[p_clusters[c].root] = bank_num;
+        if (bank_num == BANK_NUM_UNASSIGNED) {
+            ok = false;
+            break;
         }
+        bank_scratch_add_area(&banks[bank_num], &cluster_area);
     }
-    return false; // Fail if no banks were available
+
+    if (ok) {
+        for (c = 0; c < count; c++)
+            p_plan[c] = p_bank[pack_cluster_find(p_parent, c)];
+    }
+    banks_pack_result(banks, ok, p_result);
+
+    free(p_parent);
+    free(p_size);
+    free(p_bank);
+    free(p_clusters);
 }
 
 
-// Find a bank for a given area using First Fit Decreasing (FFD)
+// List the auto-banked files whose functions were called the most in the profile.
+// Those are the best candidates for moving into bank 0, where calling them needs no bank switch
+static void profile_show_hot_files(area_item * p_areas, uint32_t count) {
+
+    symbol_item * symbols = (symbol_item *)symbollist.p_array;
+    uint32_t * p_calls = calloc(count ? count : 1, sizeof(uint32_t));
+    uint32_t   c, i, best, file_area;
+    symtab_type file_tab;
+
+    if (!p_calls) {
+        printf("BankPack: ERROR! Failed to allocate memory for packing!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    symtab_init(&file_tab);
+    for (c = 0; c < count; c++)
+        symtab_add(&file_tab, "", p_areas[c].file_id, c);
+
+    for (c = 0; c < symbollist.count; c++) {
+        if (symbols[c].is_banked_def)
+            continue;
+        file_area = symtab_find(&file_tab, "", symbols[c].file_id);
+        if (file_area != SYMTAB_NOT_FOUND)
+            p_calls[file_area] += profile_count_get(symbols[c].name);
+    }
+    symtab_cleanup(&file_tab);
+
+    for (i = 0; i < PROFILE_HOT_FILES_SHOW; i++) {
+        for (best = 0, c = 1; c < count; c++)
+            if (p_calls[c] > p_calls[best]) best = c;
+        if ((count == 0) || (p_calls[best] == 0))
+            break;
+
+        printf("BankPack: Profile: hot file %s: %u calls, %u bytes (candidate for bank 0)\n",
+               file_get_name_in_by_id(p_areas[best].file_id), p_calls[best], p_areas[best].size);
+        p_calls[best] = 0;
+    }
+    free(p_calls);
+}
+
+
+// Plan auto-bank areas with the selected packing mode and report banks saved compared to FFD
+// Expects fixed-bank areas to already be placed, and p_areas to start with the sorted auto-bank areas
+static void banks_plan_auto_areas(area_item * p_areas, uint32_t count) {
+
+    bank_item * banks = (bank_item *)banklist.p_array;
+    bank_item   banks_scratch[BANK_ROM_TOTAL];
+    pack_result result_ffd, result_bfd, result_best;
+    uint16_t *  p_plan;
+    uint16_t *  p_plan_best;
+    pack_result result_cluster;
+    pack_edge * p_edges;
+    uint32_t    edge_count;
+    uint32_t    ref_total, ref_ffd, ref_cluster;
+    uint32_t    calls_total, calls_ffd, calls_cluster;
+    uint32_t    c;
+    bool        search_complete = true;
+
+    // Fixed-bank areas above BANK_NUM_AUTO sort after the auto-bank ones
+    for (c = 0; c < count; c++)
+        if (p_areas[c].bank_num_in != BANK_NUM_AUTO) break;
+    count = c;
+    if (count == 0)
+        return;
+
+    p_plan      = malloc(count * sizeof(uint16_t));
+    p_plan_best = malloc(count * sizeof(uint16_t));
+    if ((!p_plan) || (!p_plan_best)) {
+        printf("BankPack: ERROR! Failed to allocate memory for packing!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(banks_scratch, banks, sizeof(banks_scratch));
+    banks_pack_greedy(p_areas, count, banks_scratch, PACK_MODE_FFD, p_plan_best, &result_ffd);
+    result_best = result_ffd;
+
+    memcpy(banks_scratch, banks, sizeof(banks_scratch));
+    banks_pack_greedy(p_areas, count, banks_scratch, PACK_MODE_BFD, p_plan, &result_bfd);
+    if (pack_result_is_better(&result_bfd, &result_best)) {
+        result_best = result_bfd;
+        memcpy(p_plan_best, p_plan, count * sizeof(uint16_t));
+    }
+
+    pack_result_show(PACK_MODE_STR_FFD, &result_ffd, &result_ffd);
+    pack_result_show(PACK_MODE_STR_BFD, &result_bfd, &result_ffd);
+
+    if (option_get_pack_mode() == PACK_MODE_OPTIMAL) {
+        search_complete = banks_pack_optimal(p_areas, count, banks, &result_best, p_plan_best);
+        pack_result_show(PACK_MODE_STR_OPTIMAL, &result_best, &result_ffd);
+        if (!search_complete)
+            printf("BankPack: Packing optimal: search limit reached, using best found\n");
+
+        for (c = 0; c < count; c++)
+            p_areas[c].bank_num_plan = p_plan_best[c];
+    }
+    else if (option_get_pack_mode() == PACK_MODE_CLUSTER) {
+        // p_plan_best still holds the ffd placement unless bfd did better, so measure ffd again
+        memcpy(banks_scratch, banks, sizeof(banks_scratch));
+        banks_pack_greedy(p_areas, count, banks_scratch, PACK_MODE_FFD, p_plan, &result_ffd);
+        edge_count = pack_edges_build(p_areas, count, &p_edges);
+        pack_edges_same_bank(p_edges, edge_count, NULL, &ref_total, &calls_total);
+        pack_edges_same_bank(p_edges, edge_count, p_plan, &ref_ffd, &calls_ffd);
+
+        memcpy(banks_scratch, banks, sizeof(banks_scratch));
+        banks_pack_cluster(p_areas, count, banks_scratch, p_edges, edge_count, p_plan, &result_cluster);
+        pack_result_show(PACK_MODE_STR_CLUSTER, &result_cluster, &result_ffd);
+
+        if (result_cluster.ok) {
+            pack_edges_same_bank(p_edges, edge_count, p_plan, &ref_cluster, &calls_cluster);
+            printf("BankPack: Packing cluster: %u of %u references between files within a bank, "
+                   "%d fewer cross-bank references vs ffd\n",
+                   ref_cluster, ref_total, (int)ref_cluster - (int)ref_ffd);
+            if (profile_loaded)
+                printf("BankPack: Packing cluster: %u of %u profiled calls within a bank (ffd: %u)\n",
+                       calls_cluster, calls_total, calls_ffd);
+            memcpy(p_plan_best, p_plan, count * sizeof(uint16_t));
+        } else
+            printf("BankPack: Packing cluster: using best of ffd and bfd instead\n");
+
+        for (c = 0; c < count; c++)
+            p_areas[c].bank_num_plan = p_plan_best[c];
+        free(p_edges);
+
+        if (profile_loaded)
+            profile_show_hot_files(p_areas, count);
+    }
+
+    free(p_plan);
+    free(p_plan_best);
+}
+
+
+// Find a bank for a given area using First Fit Decreasing (FFD) by default,
+// or the strategy selected with -pack=
 // All possible banks (0-255) were pre-created and initialized [in obj_data_init()],
 // so there is no need to add when using a fresh bank
 static void banks_assign_area(area_item * p_area) {
@@ -350,8 +1214,17 @@ static void banks_assign_area(area_item * p_area) {
     }
     else if (p_area->bank_num_in == BANK_NUM_AUTO) {
 
+        // Already placed in its previous bank by banks_keep_stable_areas()
+        if (p_area->bank_num_out != BANK_NUM_UNASSIGNED)
+            return;
+
         if (option_get_random_assign())
             result = banks_assign_area_random(p_area, banks);
+        else if (option_get_pack_mode() == PACK_MODE_BFD)
+            result = banks_assign_area_best_fit(p_area, banks);
+        else if ((option_get_pack_mode() == PACK_MODE_OPTIMAL) ||
+                 (option_get_pack_mode() == PACK_MODE_CLUSTER))
+            result = banks_assign_area_planned(p_area, banks);
         else
             result = banks_assign_area_linear(p_area, banks);
 
@@ -367,6 +1240,52 @@ static void banks_assign_area(area_item * p_area) {
 }
 
 
+// Put auto-bank areas back in the bank -stable= has for them if they still fit there
+// The areas kept get moved to the start of p_areas (in the same order), the number kept is returned
+// Expects fixed-bank areas to already be placed, and p_areas to start with the sorted auto-bank areas
+static uint32_t banks_keep_stable_areas(area_item * p_areas, uint32_t count) {
+
+    bank_item * banks = (bank_item *)banklist.p_array;
+    area_item * p_sorted;
+    uint32_t    c, kept = 0, moved = 0;
+    uint32_t    bank_num;
+
+    // Fixed-bank areas above BANK_NUM_AUTO sort after the auto-bank ones
+    for (c = 0; c < count; c++)
+        if (p_areas[c].bank_num_in != BANK_NUM_AUTO) break;
+    count = c;
+    if ((count == 0) || (stable_tab.count == 0))
+        return 0;
+
+    for (c = 0; c < count; c++) {
+        bank_num = symtab_find(&stable_tab, file_get_module_by_id(p_areas[c].file_id), p_areas[c].type);
+        if ((bank_num != SYMTAB_NOT_FOUND) &&
+            (bank_num >= bank_limit_rom_min) && (bank_num <= bank_limit_rom_max) &&
+            (bank_check_ok_for_area(bank_num, &p_areas[c], banks))) {
+            bank_add_area(&banks[bank_num], bank_num, &p_areas[c]);
+            kept++;
+        }
+    }
+
+    p_sorted = malloc(count * sizeof(area_item));
+    if (!p_sorted) {
+        printf("BankPack: ERROR! Failed to allocate memory for stable assignment!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (c = 0; c < count; c++)
+        if (p_areas[c].bank_num_out != BANK_NUM_UNASSIGNED)
+            p_sorted[moved++] = p_areas[c];
+    for (c = 0; c < count; c++)
+        if (p_areas[c].bank_num_out == BANK_NUM_UNASSIGNED)
+            p_sorted[moved++] = p_areas[c];
+    memcpy(p_areas, p_sorted, count * sizeof(area_item));
+    free(p_sorted);
+
+    printf("BankPack: Stable: kept %u of %u auto-bank areas in their previous bank\n", kept, count);
+    return kept;
+}
+
+
 #define QSORT_A_FIRST -1
 #define QSORT_A_SAME   0
 #define QSORT_A_AFTER  1
@@ -393,7 +1312,10 @@ static void areas_sort(void) {
 // Fixed bank areas are placed first, then auto-banks fill the rest in
 // Only call after all areas have been collected from object files
 void obj_data_process(list_type * p_filelist) {
-    uint32_t c, s;
+    uint32_t c;
+    uint32_t kept;
+    bool auto_planned = false;
+    symtab_type symbol_tab;
     area_item   * areas   = (area_item *)arealist.p_array;
     symbol_item * symbols = (symbol_item *)symbollist.p_array;
     file_item   * files   = (file_item *)(p_filelist->p_array);
@@ -402,6 +1324,25 @@ void obj_data_process(list_type * p_filelist) {
 
     // Assign areas to banks
     for (c = 0; c < arealist.count; c++) {
+
+        // Auto-bank areas sort after fixed-bank ones, so all fixed banks are
+        // filled by the time the first auto-bank area comes up
+        // With -stable= the areas which keep their previous bank are placed first,
+        // only the rest go through the packing strategy
+        if ((areas[c].bank_num_in == BANK_NUM_AUTO) && (!auto_planned)) {
+            // Require MBC for Game Boy, SMS doesn't require an MBC setting
+            // Only checked once there is something to auto-bank, so unbanked ROMs
+            // can still use bankpack for the RAM code areas
+            if ((option_get_platform() == PLATFORM_GB) && (option_get_mbc_type() == MBC_TYPE_NONE)) {
+                printf("BankPack: ERROR: auto-banking does not work with unbanked ROMS (no MBC for Game Boy)\n");
+                exit(EXIT_FAILURE);
+            }
+            kept = banks_keep_stable_areas(&(areas[c]), arealist.count - c);
+            if ((option_get_pack_mode() != PACK_MODE_FFD) && (!option_get_random_assign()))
+                banks_plan_auto_areas(&(areas[c + kept]), arealist.count - c - kept);
+            auto_planned = true;
+        }
+
         banks_assign_area(&(areas[c]));
 
         // If areas was auto-banked then set bank number in associated file
@@ -419,23 +1360,57 @@ void obj_data_process(list_type * p_filelist) {
         }
     }
 
+    // Index all symbols by name within their file
+    symtab_init(&symbol_tab);
+    for (c = 0; c < symbollist.count; c++)
+        symtab_add(&symbol_tab, symbols[c].name, symbols[c].file_id, c);
+
     // Check all symbols for matches to banked entries, flag if match found
-    // TODO: ineffecient to loop over symbols for all files
     for (c = 0; c < symbollist.count; c++) {
         if (symbols[c].is_banked_def) {
-            for (s = 0; s < symbollist.count; s++) {
-                if (symbols[c].file_id == symbols[s].file_id) {
-                    // offset +1 bast the "b" char at start of banekd symbol entry name
-                    if (strcmp(symbols[c].name + 1, symbols[s].name) == 0) {
-                        symbols[c].found_matching_symbol = true;
-                        break;
-                    } else if (s == symbollist.count -1)
-                        printf("  -> NO MATCH FOUND%s\n", symbols[c].name);
-                }
-            }
+            // offset +1 bast the "b" char at start of banekd symbol entry name
+            if (symtab_find(&symbol_tab, symbols[c].name + 1, symbols[c].file_id) != SYMTAB_NOT_FOUND) {
+                symbols[c].found_matching_symbol = true;
+                // offset +2 past the "b_" for lookups during rewrite
+                symtab_add(&symbol_banked_tab, symbols[c].name + 2, symbols[c].file_id, c);
+            } else if (symbols[symbollist.count - 1].file_id == symbols[c].file_id)
+                printf("  -> NO MATCH FOUND%s\n", symbols[c].name);
         }
     }
 
+    symtab_cleanup(&symbol_tab);
+}
+
+
+// Buckets the assigned areas by bank in linear time (counting sort)
+// Areas of bank N are p_index[ p_first[N] ] .. p_index[ p_first[N + 1] - 1 ], in area order
+// Caller frees *pp_first and *pp_index
+static void banks_bucket_areas(uint32_t ** pp_first, uint32_t ** pp_index) {
+
+    uint32_t c;
+    uint32_t * p_first = calloc(banklist.count + 1, sizeof(uint32_t));
+    uint32_t * p_fill  = calloc(banklist.count + 1, sizeof(uint32_t));
+    uint32_t * p_index = malloc((arealist.count ? arealist.count : 1) * sizeof(uint32_t));
+    area_item * areas  = (area_item *)arealist.p_array;
+
+    if (!p_first || !p_fill || !p_index) {
+        printf("BankPack: ERROR: failed to allocate memory for the bank list\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (c = 0; c < arealist.count; c++)
+        if (areas[c].bank_num_out < banklist.count)
+            p_first[ areas[c].bank_num_out + 1 ]++;
+    for (c = 0; c < banklist.count; c++)
+        p_first[c + 1] += p_first[c];
+    memcpy(p_fill, p_first, (banklist.count + 1) * sizeof(uint32_t));
+    for (c = 0; c < arealist.count; c++)
+        if (areas[c].bank_num_out < banklist.count)
+            p_index[ p_fill[ areas[c].bank_num_out ]++ ] = c;
+
+    free(p_fill);
+    *pp_first = p_first;
+    *pp_index = p_index;
 }
 
 
@@ -445,6 +1420,8 @@ void banks_show(void) {
 
     uint32_t c;
     uint32_t a;
+    uint32_t * p_first;
+    uint32_t * p_index;
 
     printf("\n=== Banks assigned: %d -> %d (allowed range %d -> %d). Max including fixed: %d) ===\n",
             bank_assigned_rom_min, bank_assigned_rom_max,
@@ -453,27 +1430,118 @@ void banks_show(void) {
 
     bank_item * banks = (bank_item *)banklist.p_array;
     area_item * areas = (area_item *)arealist.p_array;
+    area_item * p_area;
+
+    banks_bucket_areas(&p_first, &p_index);
     for (c = 0; c < banklist.count; c++) {
         if (banks[c].free != BANK_SIZE_ROM) {
-            printf("Bank %d: size=%5d, free=%5d, reserved=%5d\n", c, banks[c].size, banks[c].free, banks[c].reserved);
-            for (a = 0; a < arealist.count; a++) {
-                if (areas[a].bank_num_out == c) {
-                    printf(" +- Area: name=%8s, size=%5d, bank_in=%3d, bank_out=%3d, file=%s -> %s\n",
-                        areas[a].name,
-                        areas[a].size,
-                        areas[a].bank_num_in,
-                        areas[a].bank_num_out,
-                        file_get_name_in_by_id(areas[a].file_id),
-                        file_get_name_out_by_id(areas[a].file_id));
-                }
+            printf("Bank %d: size=%5d, free=%5d, reserved=%5d%s\n", c, banks[c].size, banks[c].free, banks[c].reserved,
+                   ((option_get_platform() == PLATFORM_SMS) && (banks[c].type == BANK_TYPE_LIT_EXCLUSIVE)) ? " (data, slot 2)" : "");
+            for (a = p_first[c]; a < p_first[c + 1]; a++) {
+                p_area = &areas[ p_index[a] ];
+                printf(" +- Area: name=%8s, size=%5d, bank_in=%3d, bank_out=%3d, file=%s -> %s\n",
+                    p_area->name,
+                    p_area->size,
+                    p_area->bank_num_in,
+                    p_area->bank_num_out,
+                    file_get_name_in_by_id(p_area->file_id),
+                    file_get_name_out_by_id(p_area->file_id));
             }
         }
     }
+    free(p_first);
+    free(p_index);
 
     printf("\n");
 }
 
 
+void report_set(char * filename) {
+
+    if (snprintf(report_filename, sizeof(report_filename), "%s", filename) > sizeof(report_filename))
+        printf("BankPack: Warning: truncated report filename to:%s\n", report_filename);
+}
+
+
+// Writes a JSON string with the characters JSON requires escaped
+static void report_write_str(FILE * out_file, const char * str) {
+
+    fputc('"', out_file);
+    for (; *str; str++) {
+        if ((*str == '"') || (*str == '\\'))
+            fprintf(out_file, "\\%c", *str);
+        else if ((unsigned char)*str < 0x20)
+            fprintf(out_file, "\\u%04x", (unsigned char)*str);
+        else
+            fputc(*str, out_file);
+    }
+    fputc('"', out_file);
+}
+
+
+// Write the bank and area assignments as JSON for -report=
+// ihxcheck -report= adds the used ROM ranges as the "ihx" member
+// Should be called after obj_data_process()
+void report_write(void) {
+
+    uint32_t c;
+    uint32_t a;
+    uint32_t * p_first;
+    uint32_t * p_index;
+    bool       bank_first = true;
+    FILE *     out_file;
+    bank_item * banks = (bank_item *)banklist.p_array;
+    area_item * areas = (area_item *)arealist.p_array;
+    area_item * p_area;
+
+    if (report_filename[0] == '\0')
+        return;
+
+    out_file = fopen(report_filename, "w");
+    if (!out_file) {
+        printf("BankPack: ERROR: failed to open report for writing: %s\n", report_filename);
+        exit(EXIT_FAILURE);
+    }
+
+    banks_bucket_areas(&p_first, &p_index);
+
+    fprintf(out_file, "{\n");
+    fprintf(out_file, "  \"bankpack\": {\"platform\": \"%s\", \"mbc\": %d, \"bank_min\": %d, \"bank_max\": %d, "
+                      "\"assigned_min\": %d, \"assigned_max\": %d, \"max_alltypes\": %d},\n",
+            (option_get_platform() == PLATFORM_SMS) ? PLATFORM_STR_SMS : PLATFORM_STR_GB, option_get_mbc_type(),
+            bank_limit_rom_min, bank_limit_rom_max,
+            (bank_assigned_rom_min <= bank_assigned_rom_max) ? bank_assigned_rom_min : 0, bank_assigned_rom_max,
+            bank_assigned_rom_max_alltypes);
+    fprintf(out_file, "  \"banks\": [");
+    for (c = 0; c < banklist.count; c++) {
+        if (banks[c].free == BANK_SIZE_ROM)
+            continue;
+        fprintf(out_file, "%s\n    {\"bank\": %d, \"size\": %d, \"free\": %d, \"reserved\": %d, \"type\": \"%s\", \"areas\": [",
+                bank_first ? "" : ",", c, banks[c].size, banks[c].free, banks[c].reserved,
+                (banks[c].type == BANK_TYPE_LIT_EXCLUSIVE) ? "lit" : ((banks[c].type == BANK_TYPE_DEFAULT) ? "code" : "unset"));
+        bank_first = false;
+        for (a = p_first[c]; a < p_first[c + 1]; a++) {
+            p_area = &areas[ p_index[a] ];
+            fprintf(out_file, "%s\n      {\"name\": \"%s\", \"size\": %d, \"placement\": \"%s\", \"bank_in\": %d, \"file\": ",
+                    (a == p_first[c]) ? "" : ",", p_area->name, p_area->size,
+                    (p_area->bank_num_in == BANK_NUM_AUTO) ? "auto" : "fixed", p_area->bank_num_in);
+            report_write_str(out_file, file_get_name_in_by_id(p_area->file_id));
+            fprintf(out_file, ", \"file_out\": ");
+            report_write_str(out_file, file_get_name_out_by_id(p_area->file_id));
+            fprintf(out_file, ", \"module\": ");
+            report_write_str(out_file, file_get_module_by_id(p_area->file_id));
+            fprintf(out_file, "}");
+        }
+        fprintf(out_file, "%s]}", (p_first[c] == p_first[c + 1]) ? "" : "\n    ");
+    }
+    fprintf(out_file, "%s]\n}\n", bank_first ? "" : "\n  ");
+
+    free(p_first);
+    free(p_index);
+    fclose(out_file);
+}
+
+
 // Accepts an input string line and writes it
 // out with an **updated bank num** to a file
 // * Adds trailing \n if missing
@@ -505,19 +1573,8 @@ bool area_modify_and_write_to_file(char * strline_in, FILE * out_file, uint16_t
 // This prevents mistakenly rewriting symbol b_<something> entries from asm files
 bool symbol_banked_check_rewrite_ok(char * symbol_name, uint32_t file_id) {
 
-    uint32_t c;
-    symbol_item * symbols = (symbol_item *)symbollist.p_array;
-
-    for (c = 0; c < symbollist.count; c++) {
-        if ((symbols[c].file_id == file_id) &&
-            (symbols[c].is_banked_def) &&
-            (symbols[c].found_matching_symbol)) {
-            // Make sure b_<name> matches
-            if (strcmp(symbols[c].name + 2, symbol_name) == 0)
-                return true;
-        }
-    }
-    return false;
+    // Only banked definitions with a matching symbol were added in obj_data_process()
+    return (symtab_find(&symbol_banked_tab, symbol_name, file_id) != SYMTAB_NOT_FOUND);
 }
 
 
@@ -564,3 +1621,157 @@ bool symbol_modify_and_write_to_file(char * strline_in, FILE * out_file, uint16_
     }
     return false;
 }
+
+
+// Areas linked to run from RAM, with their data moved into a ROM area that crt0 copies them in from
+static const char * code_ram_areas[CODE_RAM_AREAS_MAX] = {"_CODE_RAM", "_CODE_HRAM"};
+
+// Returns which RAM code area an area line is for, or CODE_RAM_NONE
+static uint32_t code_ram_area_find(char * strline_in) {
+
+    uint32_t c;
+    size_t   len;
+
+    if ((strline_in[0] == 'A') && (strline_in[1] == ' ')) {
+        for (c = 0; c < CODE_RAM_AREAS_MAX; c++) {
+            len = strlen(code_ram_areas[c]);
+            if ((strncmp(strline_in + 2, code_ram_areas[c], len) == 0) && (strline_in[2 + len] == ' '))
+                return c;
+        }
+    }
+    return CODE_RAM_NONE;
+}
+
+
+// Returns true for the area line of a RAM code area (A _CODE_RAM ... or A _CODE_HRAM ...)
+bool code_ram_area_check(char * strline_in) {
+    return (code_ram_area_find(strline_in) != CODE_RAM_NONE);
+}
+
+
+void code_ram_rewrite_init(code_ram_rewrite_item * p_state, uint32_t ram_count) {
+
+    uint32_t c;
+
+    p_state->ram_count    = ram_count;
+    p_state->area_count   = 0;
+    p_state->area_index   = 0;
+    p_state->load_written = false;
+    p_state->pcr_warned   = false;
+    for (c = 0; c < CODE_RAM_AREAS_MAX; c++)
+        p_state->ram_index[c] = CODE_RAM_NONE;
+}
+
+
+// Adds the <name>_LOAD area lines, after the area and symbol lines of the file
+// The load areas get the index after the last area of the file, in the order they're written
+static void code_ram_write_load_areas(FILE * out_file, code_ram_rewrite_item * p_state) {
+
+    uint32_t c;
+
+    for (c = 0; c < CODE_RAM_AREAS_MAX; c++)
+        if (p_state->ram_index[c] != CODE_RAM_NONE)
+            fprintf(out_file, "A %s_LOAD size %X flags 0 addr 0\n", code_ram_areas[c], p_state->ram_size[c]);
+    p_state->load_written = true;
+}
+
+
+// Rewrites a relocation header (R 00 00 <area lo> <area hi> ...) of RAM code to its load area
+//
+// Only the data gets moved, the relocation items still use the RAM areas
+// and symbols. PC relative items (out of area jr) would now be relative to the
+// load area though, so those get a warning.
+static bool code_ram_modify_r_line(char * strline_in, FILE * out_file, code_ram_rewrite_item * p_state, uint32_t file_id) {
+
+    uint32_t c, i, load_index, mode;
+    uint32_t hdr[4];
+    int      hdr_len = 0;
+    char   * p_item;
+    char   * p_end;
+
+    if ((sscanf(strline_in, "R %2x %2x %2x %2x%n", &hdr[0], &hdr[1], &hdr[2], &hdr[3], &hdr_len) != 4) || (hdr_len == 0))
+        return false;
+
+    load_index = p_state->area_count;
+    for (c = 0; c < CODE_RAM_AREAS_MAX; c++) {
+        if (p_state->ram_index[c] == CODE_RAM_NONE)
+            continue;
+        if (p_state->ram_index[c] == (hdr[2] | (hdr[3] << 8)))
+            break;
+        load_index++;
+    }
+    if (c == CODE_RAM_AREAS_MAX)
+        return false;
+
+    // Items are <mode> <offset> <index lo> <index hi>, with modes above 0xFF escaped into two bytes
+    p_item = strline_in + hdr_len;
+    while (!p_state->pcr_warned) {
+        mode = strtoul(p_item, &p_end, 16);
+        if (p_end == p_item)
+            break;
+        // The escaped mode has the low byte second
+        if ((mode & R_ESCAPE_MASK) == R_ESCAPE_MASK)
+            mode = strtoul(p_end, &p_end, 16);
+        if (mode & R_PCR) {
+            printf("BankPack: Warning: %s in %s has a relative jump out of the area, it won't work from RAM\n",
+                   code_ram_areas[c], file_get_name_in_by_id(file_id));
+            p_state->pcr_warned = true;
+        }
+        // Skip offset and index
+        for (i = 0; i < 3; i++)
+            strtoul(p_end, &p_end, 16);
+        p_item = p_end;
+    }
+
+    fprintf(out_file, "R %02X %02X %02X %02X%s\n", hdr[0], hdr[1], load_index & 0xFFu, load_index >> 8, strline_in + hdr_len);
+    return true;
+}
+
+
+// Moves the data of RAM code areas into load areas in ROM
+// * H line: adds the load areas to the area count
+// * T and R lines: the load areas get added before the first of them, then
+//   relocation headers for RAM code are changed to the load area
+// Returns true if the line was written
+bool code_ram_modify_and_write_to_file(char * strline_in, FILE * out_file, code_ram_rewrite_item * p_state, uint32_t file_id) {
+
+    uint32_t ram_area, size;
+    uint32_t area_count, symbol_count;
+
+    switch (strline_in[0]) {
+        // For lines: H <areas> areas <symbols> global symbols
+        case 'H':
+            if (sscanf(strline_in, "H %x areas %x global symbols", &area_count, &symbol_count) == 2) {
+                p_state->area_count = area_count;
+                fprintf(out_file, "H %X areas %X global symbols\n", area_count + p_state->ram_count, symbol_count);
+                return true;
+            }
+            break;
+
+        case 'A':
+            ram_area = code_ram_area_find(strline_in);
+            if ((ram_area != CODE_RAM_NONE) && (sscanf(strline_in, "A %*s size %x", &size) == 1)) {
+                p_state->ram_index[ram_area] = p_state->area_index;
+                p_state->ram_size[ram_area]  = size;
+            }
+            p_state->area_index++;
+            break;
+
+        case 'T':
+        case 'R':
+            if (!p_state->load_written)
+                code_ram_write_load_areas(out_file, p_state);
+            if (strline_in[0] == 'R')
+                return code_ram_modify_r_line(strline_in, out_file, p_state, file_id);
+            break;
+    }
+    return false;
+}
+
+
+// Adds the load areas if the file ended before any T or R lines
+void code_ram_rewrite_finish(FILE * out_file, code_ram_rewrite_item * p_state) {
+
+    if (!p_state->load_written)
+        code_ram_write_load_areas(out_file, p_state);
+}
@@ -11,12 +11,22 @@
 #define AREA_LINE_RECORDS      2 // Bank number, Size
 #define SYMBOL_LINE_RECORDS    2 // Name, DefVal
 #define SYMBOL_REWRITE_RECORDS 2 // Name, DefVal
+#define SYMBOL_REF_RECORDS     2 // Name, "Ref"
 
 #define BANK_TYPE_UNSET             0
 #define BANK_TYPE_DEFAULT           1
 #define BANK_TYPE_LIT_EXCLUSIVE     2
 
 
+// RAM code areas, see code_ram_modify_and_write_to_file()
+#define CODE_RAM_AREAS_MAX  2 // _CODE_RAM, _CODE_HRAM
+#define CODE_RAM_NONE       0xFFFFFFFFU
+
+// Relocation modes from the linker
+#define R_PCR               0x04
+#define R_ESCAPE_MASK       0xF0
+
+
 typedef struct bank_item {
     uint32_t size;
     uint32_t free;
@@ -32,35 +42,75 @@ typedef struct area_item {
     uint32_t size;         // uint32_t to avoid mingw sscanf() buffer overflow
     uint32_t bank_num_in;  // uint32_t to avoid mingw sscanf() buffer overflow
     uint32_t bank_num_out; // uint32_t to avoid mingw sscanf() buffer overflow
+    uint32_t bank_num_plan; // Bank chosen ahead of assignment by -pack=optimal
     uint32_t type;
 } area_item;
 
+// Area a symbol is defined in when it isn't a banked type (BANK_TYPE_DEFAULT, BANK_TYPE_LIT_EXCLUSIVE)
+#define SYMBOL_AREA_OTHER  0xFFFFFFFFU // Not ROM with a known bank, or not recorded
+#define SYMBOL_AREA_CODE   0xFFFFFFFEU // Unbanked _CODE
+
 typedef struct symbol_item {
     uint32_t file_id;
     char     name[OBJ_NAME_MAX_STR_LEN];
     bool     is_banked_def;
     uint32_t bank_num_in;   // uint32_t to avoid mingw sscanf() buffer overflow
     bool     found_matching_symbol;
+    uint32_t area_type;     // Area type of the definition, or SYMBOL_AREA_*
 } symbol_item;
 
+// A symbol one file uses from another (S <name> Ref...), only collected for -pack=cluster
+typedef struct symbol_ref_item {
+    uint32_t file_id;
+    char     name[OBJ_NAME_MAX_STR_LEN];
+} symbol_ref_item;
+
 typedef struct symbol_match_item {
     char     name[OBJ_NAME_MAX_STR_LEN];
 } symbol_match_item;
 
+// Per file state for moving RAM code areas into their load areas
+typedef struct code_ram_rewrite_item {
+    uint32_t ram_count;                       // RAM code areas in the file
+    uint32_t area_count;                      // Areas in the file, without the load areas
+    uint32_t area_index;                      // Index of the next A line
+    uint32_t ram_index[CODE_RAM_AREAS_MAX];   // Index of each RAM code area, or CODE_RAM_NONE
+    uint32_t ram_size[CODE_RAM_AREAS_MAX];
+    bool     load_written;
+    bool     pcr_warned;
+} code_ram_rewrite_item;
+
 
 void obj_data_init(void);
 void obj_data_cleanup(void);
 
+bool area_parse(char * area_str, uint32_t file_id, area_item * p_area);
 int areas_add(char * area_str, uint32_t file_id);
+void areas_add_item(area_item * p_area);
+bool symbol_parse(char * symbol_str, uint32_t file_id, symbol_item * p_symbol);
 int symbols_add(char * area_str, uint32_t file_id);
+void symbols_add_item(symbol_item * p_symbol);
+bool symbol_ref_parse(char * symbol_str, uint32_t file_id, symbol_ref_item * p_ref);
+void symbol_refs_add_item(symbol_ref_item * p_ref);
 void symbol_match_add(char *);
+void profile_read(char * filename_in);
+bool profile_is_loaded(void);
+void stable_map_set(char * filename);
+void stable_map_write(void);
 
 void obj_data_process(list_type *);
 
 bool area_modify_and_write_to_file(char * strline_in, FILE * out_file, uint16_t bank_num);
 bool symbol_modify_and_write_to_file(char * strline_in, FILE * out_file, uint16_t bank_num, uint32_t file_id);
 
+bool code_ram_area_check(char * strline_in);
+void code_ram_rewrite_init(code_ram_rewrite_item * p_state, uint32_t ram_count);
+bool code_ram_modify_and_write_to_file(char * strline_in, FILE * out_file, code_ram_rewrite_item * p_state, uint32_t file_id);
+void code_ram_rewrite_finish(FILE * out_file, code_ram_rewrite_item * p_state);
+
 void banks_show(void);
+void report_set(char * filename);
+void report_write(void);
 
 
 #endif // _AREAS_H
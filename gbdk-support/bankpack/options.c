@@ -9,6 +9,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#if defined(_WIN32)
+    #include <windows.h>
+#endif
+
 #include "common.h"
 #include "list.h"
 #include "files.h"
@@ -25,6 +29,8 @@ bool option_cartsize      = false;
 bool option_random_assign = false;
 int  option_mbc_type = MBC_TYPE_DEFAULT;
 int  option_platform = PLATFORM_DEFAULT;
+int  option_pack_mode = PACK_MODE_DEFAULT;
+uint32_t option_jobs = OPTION_JOBS_AUTO;
 
 
 void option_set_verbose(bool is_enabled) {
@@ -51,6 +57,51 @@ bool option_get_random_assign(void) {
 }
 
 
+// Returns false if the packing mode is not recognized
+bool option_set_pack_mode(char * mode_str) {
+
+    if (strcmp(mode_str, PACK_MODE_STR_FFD) == 0)
+        option_pack_mode = PACK_MODE_FFD;
+    else if (strcmp(mode_str, PACK_MODE_STR_BFD) == 0)
+        option_pack_mode = PACK_MODE_BFD;
+    else if (strcmp(mode_str, PACK_MODE_STR_OPTIMAL) == 0)
+        option_pack_mode = PACK_MODE_OPTIMAL;
+    else if (strcmp(mode_str, PACK_MODE_STR_CLUSTER) == 0)
+        option_pack_mode = PACK_MODE_CLUSTER;
+    else
+        return false;
+
+    return true;
+}
+int option_get_pack_mode(void) {
+    return option_pack_mode;
+}
+
+
+
+void option_set_jobs(uint32_t job_count) {
+    option_jobs = job_count;
+}
+// Returns number of threads to use for processing object files
+uint32_t option_get_jobs(void) {
+
+    long count = option_jobs;
+
+    if (option_jobs == OPTION_JOBS_AUTO) {
+        #if defined(_WIN32)
+            SYSTEM_INFO sysinfo;
+            GetSystemInfo(&sysinfo);
+            count = sysinfo.dwNumberOfProcessors;
+        #else
+            count = sysconf(_SC_NPROCESSORS_ONLN);
+        #endif
+    }
+
+    if (count < 1) count = 1;
+    if (count > OPTION_JOBS_MAX) count = OPTION_JOBS_MAX;
+    return (uint32_t)count;
+}
+
 
 // Format: -reserve=DECIMAL_BANKNUM:HEX_SIZE
 // Reserve space in banks manually from command line arguments
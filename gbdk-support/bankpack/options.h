@@ -7,6 +7,20 @@
 #define ARG_BANK_RESERVE_SIZE_REC_COUNT_MATCH 3u
 #define ARG_BANK_RESERVE_SIZE_MAX_SPLIT_WORDS (ARG_BANK_RESERVE_SIZE_REC_COUNT_MATCH + 1u)
 
+#define OPTION_JOBS_AUTO            0
+#define OPTION_JOBS_MAX             64
+
+#define PACK_MODE_FFD               0 // First Fit Decreasing
+#define PACK_MODE_BFD               1 // Best Fit Decreasing
+#define PACK_MODE_OPTIMAL           2 // Bounded branch and bound search
+#define PACK_MODE_CLUSTER           3 // Keep files which reference each other in the same bank
+#define PACK_MODE_DEFAULT           PACK_MODE_FFD
+
+#define PACK_MODE_STR_FFD           "ffd"
+#define PACK_MODE_STR_BFD           "bfd"
+#define PACK_MODE_STR_OPTIMAL       "optimal"
+#define PACK_MODE_STR_CLUSTER       "cluster"
+
 #define PLATFORM_GB                 0
 #define PLATFORM_SMS                1
 #define PLATFORM_DEFAULT            PLATFORM_GB
@@ -29,6 +43,12 @@ bool option_get_cartsize(void);
 void option_set_random_assign(bool is_enabled);
 bool option_get_random_assign(void);
 
+bool option_set_pack_mode(char * mode_str);
+int  option_get_pack_mode(void);
+
+void option_set_jobs(uint32_t job_count);
+uint32_t option_get_jobs(void);
+
 int  option_bank_reserve_bytes(char * arg_str);
 
 void option_set_platform(char * platform_str);
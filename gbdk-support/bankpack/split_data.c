@@ -0,0 +1,423 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Splitting of auto-banked data areas larger than a bank for -split=
+//
+// An object can be split when its only banked area is auto-banked, larger
+// than a bank, and holds nothing but data: no relocations in its T lines
+// and a single symbol defined at its start (plus the b_ bank symbol). That
+// is what a .c file with #pragma bank 255 and one large const array
+// compiles to.
+//
+// The object is replaced by segment objects of up to a bank each, which are
+// assigned to banks like any other. The first one keeps the symbols of the
+// original, so the name and BANK() still refer to the start of the data.
+// Once the banks are assigned an object is written with a table for each
+// split area, in a single _CODE area:
+//
+//   _<name>_segments:  .db <bank>  .dw <address>  .dw <size>   for each segment
+//                      .db 0       .dw 0          .dw 0        at the end
+//
+// See gbdk/banked_stream.h for reading them.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "common.h"
+#include "list.h"
+#include "files.h"
+#include "obj_data.h"
+#include "options.h"
+#include "split_data.h"
+
+// Bytes of data per T line, which the linker limits to 16 together with the address bytes
+#define SPLIT_T_LINE_DATA_MAX(addr_bytes)  (16 - (addr_bytes))
+// Segment objects are written as XL3, like the compiler output, so bankpack can rewrite them
+#define SPLIT_SEG_ADDR_BYTES   3
+#define SPLIT_TABLE_ADDR_BYTES 2
+
+#define SPLIT_R_SYM_WORD       0x02U  // Relocation of a 16 bit symbol reference
+#define SPLIT_ENTRY_SIZE       5      // Bank, address, size
+
+#define SPLIT_LINE_MAX         (OBJ_NAME_MAX_STR_LEN + 64)
+#define SPLIT_SYMBOLS_MAX      32     // Absolute and bank symbols kept for the first segment
+
+extern list_type filelist;
+
+typedef struct split_item {
+    char     name[OBJ_NAME_MAX_STR_LEN]; // Symbol at the start of the data, with the leading underscore
+    uint32_t file_first;                 // File id of the first segment, the others follow it
+    uint32_t count;
+    uint32_t last_size;                  // Size of the last segment, the others are a bank
+} split_item;
+
+// Symbol kept for the first segment
+typedef struct split_symbol {
+    char     name[OBJ_NAME_MAX_STR_LEN];
+    uint32_t value;
+} split_symbol;
+
+// Text of a generated object
+typedef struct split_buf {
+    char * p_str;
+    size_t len;
+    size_t size;
+} split_buf;
+
+static list_type splitlist;
+static char split_filename[MAX_FILE_STR] = {'\0'};
+
+
+void split_data_init(void) {
+    list_init(&splitlist, sizeof(split_item));
+}
+
+
+void split_data_cleanup(void) {
+    list_cleanup(&splitlist);
+}
+
+
+void split_data_set(char * filename) {
+
+    if (snprintf(split_filename, sizeof(split_filename), "%s", filename) > sizeof(split_filename))
+        printf("BankPack: Warning: truncated split table filename to:%s\n", split_filename);
+}
+
+
+char * split_data_get_filename(void) {
+    return split_filename;
+}
+
+
+// True if a file's areas (from its scan) should be split: -split= is set and its only
+// banked area is auto-banked and too large for a bank
+bool split_data_check(list_type * p_areas) {
+
+    area_item * areas = (area_item *)p_areas->p_array;
+
+    return (split_filename[0] != '\0') && (p_areas->count == 1) &&
+           (areas[0].bank_num_in == BANK_NUM_AUTO) && (areas[0].size > BANK_SIZE_ROM);
+}
+
+
+static void split_fail(uint32_t file_id, area_item * p_area, const char * reason) {
+
+    printf("BankPack: ERROR! Area %s, bank %d, size %d is too large for bank size %d and can't be split: %s (file %s)\n",
+           p_area->name, p_area->bank_num_in, p_area->size, BANK_SIZE_ROM, reason, file_get_name_in_by_id(file_id));
+    exit(EXIT_FAILURE);
+}
+
+
+static void split_buf_printf(split_buf * p_buf, const char * format, ...) {
+
+    va_list args;
+    int     len;
+
+    while (true) {
+        va_start(args, format);
+        len = vsnprintf(p_buf->p_str + p_buf->len, p_buf->size - p_buf->len, format, args);
+        va_end(args);
+
+        if ((len >= 0) && ((size_t)len < p_buf->size - p_buf->len)) {
+            p_buf->len += len;
+            return;
+        }
+
+        p_buf->size = (p_buf->size * 2) + ((len > 0) ? len : 0);
+        p_buf->p_str = realloc(p_buf->p_str, p_buf->size);
+        if (!p_buf->p_str) {
+            printf("BankPack: ERROR: Failed to allocate memory for split segment!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+// Reads the hex bytes after the record type of a T or R line, returns how many
+static uint32_t split_parse_bytes(const char * str, uint8_t * bytes, uint32_t max) {
+
+    uint32_t count = 0;
+    char *   end;
+    unsigned long value;
+
+    str++;
+    while (count < max) {
+        value = strtoul(str, &end, 16);
+        if (end == str)
+            break;
+        bytes[count++] = (uint8_t)value;
+        str = end;
+    }
+    return count;
+}
+
+
+// Copies the next line of buf into line (without \r\n), returns the start of the one after it or NULL at the end
+static char * split_next_line(char * buf, char * line) {
+
+    size_t len = strcspn(buf, "\n");
+
+    if (*buf == '\0')
+        return NULL;
+
+    snprintf(line, SPLIT_LINE_MAX, "%.*s", (int)len, buf);
+    line[strcspn(line, "\r")] = '\0';
+    return (buf[len] == '\n') ? buf + len + 1 : buf + len;
+}
+
+
+// Writes a run of bytes as T lines of a segment object starting at area offset 0
+static void split_write_t_lines(split_buf * p_buf, const uint8_t * data, uint32_t len) {
+
+    uint32_t c, i, count;
+
+    for (c = 0; c < len; c += count) {
+        count = len - c;
+        if (count > SPLIT_T_LINE_DATA_MAX(SPLIT_SEG_ADDR_BYTES))
+            count = SPLIT_T_LINE_DATA_MAX(SPLIT_SEG_ADDR_BYTES);
+
+        split_buf_printf(p_buf, "T %02X %02X 00", c & 0xFFU, (c >> 8) & 0xFFU);
+        for (i = 0; i < count; i++)
+            split_buf_printf(p_buf, " %02X", data[c + i]);
+        // The relocation line of each T line names the area (index 0), there are no relocations
+        split_buf_printf(p_buf, "\nR 00 00 00 00\n");
+    }
+}
+
+
+// Replace a file with a split data area by its segments, which are added to the file
+// list with their contents in memory. Exits with an error if the file can't be split.
+// Should be called before obj_data_process()
+void split_data_make(uint32_t file_id, area_item * p_area) {
+
+    file_item *  files = (file_item *)filelist.p_array;
+    char *       buf = files[file_id].data;
+    char         line[SPLIT_LINE_MAX];
+    char         opt_line[SPLIT_LINE_MAX] = {'\0'};
+    char         name[OBJ_NAME_MAX_STR_LEN];
+    char         seg_name[MAX_FILE_STR];
+    char         module[MAX_FILE_STR];
+    char *       ext;
+    uint8_t      t_bytes[SPLIT_LINE_MAX / 2];
+    uint8_t      r_bytes[SPLIT_LINE_MAX / 2];
+    uint32_t     t_count = 0, r_count;
+    uint32_t     addr_bytes = 0, addr, value;
+    int32_t      area_index = -1, data_index = -1;
+    uint8_t *    data;
+    split_item   split;
+    split_symbol symbols[SPLIT_SYMBOLS_MAX];
+    uint32_t     symbol_count = 0;
+    area_item    area;
+    uint32_t     c, i, offset, size;
+    split_buf    seg;
+
+    split.name[0] = '\0';
+
+    // Keep any padding at the end (uninitialized data) as zeros
+    data = calloc(p_area->size, 1);
+    if ((!buf) || (!data)) {
+        printf("BankPack: ERROR: Failed to allocate memory for split data!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while ((buf = split_next_line(buf, line))) {
+
+        switch (line[0]) {
+            // XL2, XL3, XL4: little endian, address bytes per T line
+            case 'X':
+                if ((line[1] != 'L') || (line[2] < '2') || (line[2] > '4'))
+                    split_fail(file_id, p_area, "not a little endian object");
+                addr_bytes = line[2] - '0';
+                break;
+
+            case 'O':
+                snprintf(opt_line, sizeof(opt_line), "%s", line);
+                break;
+
+            case 'A':
+                area_index++;
+                if (area_parse(line, file_id, &area))
+                    data_index = area_index;
+                break;
+
+            case 'S':
+                if (sscanf(line, "S %" TOSTR(OBJ_NAME_MAX_STR_LEN) "s Def%x", name, &value) != 2)
+                    break; // References aren't needed without relocations
+
+                if ((area_index >= 0) && (area_index != data_index))
+                    split_fail(file_id, p_area, "symbols defined outside the data area");
+
+                // Absolute symbols (before the first area, such as ___bank_<name>) and b_<name>
+                if ((area_index < 0) || (name[0] == 'b')) {
+                    if (symbol_count == SPLIT_SYMBOLS_MAX)
+                        split_fail(file_id, p_area, "too many absolute symbols");
+                    snprintf(symbols[symbol_count].name, sizeof(symbols[symbol_count].name), "%s", name);
+                    symbols[symbol_count++].value = value;
+                } else {
+                    if ((split.name[0] != '\0') || (value != 0))
+                        split_fail(file_id, p_area, "more than one symbol in the data area, or not at its start");
+                    snprintf(split.name, sizeof(split.name), "%s", name);
+                }
+                break;
+
+            case 'T':
+                t_count = split_parse_bytes(line, t_bytes, sizeof(t_bytes));
+                if (t_count < addr_bytes)
+                    t_count = 0;
+                break;
+
+            case 'R':
+                // R 00 00 <area index lo> <area index hi> then the relocations, if any
+                r_count = split_parse_bytes(line, r_bytes, sizeof(r_bytes));
+                if (r_count > 4)
+                    split_fail(file_id, p_area, "relocations in the data");
+                if (t_count == 0)
+                    break;
+                if ((r_count < 4) || ((uint32_t)(r_bytes[2] | (r_bytes[3] << 8)) != (uint32_t)data_index)) {
+                    if (t_count > addr_bytes)
+                        split_fail(file_id, p_area, "data outside the data area");
+                    t_count = 0;
+                    break;
+                }
+
+                for (addr = 0, c = 0; c < addr_bytes; c++)
+                    addr |= (uint32_t)t_bytes[c] << (c * 8);
+                if (addr + (t_count - addr_bytes) > p_area->size)
+                    split_fail(file_id, p_area, "data beyond the end of the area");
+                memcpy(data + addr, t_bytes + addr_bytes, t_count - addr_bytes);
+                t_count = 0;
+                break;
+        }
+    }
+
+    if (addr_bytes == 0)
+        split_fail(file_id, p_area, "no object header");
+    if (split.name[0] == '\0')
+        split_fail(file_id, p_area, "no symbol at the start of the data area");
+
+    snprintf(module, sizeof(module), "%s", file_get_module_by_id(file_id));
+    split.file_first = filelist.count;
+    split.count = (p_area->size + BANK_SIZE_ROM - 1) / BANK_SIZE_ROM;
+    split.last_size = p_area->size - ((split.count - 1) * BANK_SIZE_ROM);
+
+    for (c = 0; c < split.count; c++) {
+        offset = c * BANK_SIZE_ROM;
+        size = p_area->size - offset;
+        if (size > BANK_SIZE_ROM)
+            size = BANK_SIZE_ROM;
+
+        seg.len = 0;
+        seg.size = (size * 4) + 1024;
+        seg.p_str = malloc(seg.size);
+        if (!seg.p_str) {
+            printf("BankPack: ERROR: Failed to allocate memory for split segment!\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Symbols: .__.ABS., those kept from the original in the first segment, the segment start
+        split_buf_printf(&seg, "XL3\nH 1 areas %X global symbols\nM %s_s%u\n",
+                         (c == 0) ? symbol_count + 2 : 2, module, c);
+        if (opt_line[0] != '\0')
+            split_buf_printf(&seg, "%s\n", opt_line);
+        split_buf_printf(&seg, "S .__.ABS. Def000000\n");
+        for (i = 0; (c == 0) && (i < symbol_count); i++) {
+            if ((symbols[i].name[0] != 'b') && (strcmp(symbols[i].name, ".__.ABS.") != 0))
+                split_buf_printf(&seg, "S %s Def%06X\n", symbols[i].name, symbols[i].value);
+        }
+        split_buf_printf(&seg, "A %s%d size %X flags 0 addr 0\n", p_area->name, BANK_NUM_AUTO, size);
+        if (c == 0) {
+            split_buf_printf(&seg, "S %s Def000000\n", split.name);
+            for (i = 0; i < symbol_count; i++) {
+                if (symbols[i].name[0] == 'b')
+                    split_buf_printf(&seg, "S %s Def%06X\n", symbols[i].name, symbols[i].value);
+            }
+        }
+        split_buf_printf(&seg, "S %s__seg%u Def000000\n", split.name, c);
+        split_write_t_lines(&seg, data + offset, size);
+
+        // <input name>_s<N> with the same extension
+        snprintf(seg_name, sizeof(seg_name), "%s", file_get_name_in_by_id(file_id));
+        ext = strrchr(seg_name, '.');
+        if ((ext) && ((strrchr(seg_name, '/') > ext) || (strrchr(seg_name, '\\') > ext)))
+            ext = NULL;
+        snprintf(line, sizeof(line), "%s", (ext) ? ext : "");
+        if (ext)
+            *ext = '\0';
+        snprintf(seg_name + strlen(seg_name), sizeof(seg_name) - strlen(seg_name), "_s%u%s", c, line);
+
+        files_add_generated(seg_name, seg.p_str);
+    }
+
+    if (option_get_verbose())
+        printf("Split %s (%d bytes) of %s into %d segments\n", split.name, p_area->size, file_get_name_in_by_id(file_id), split.count);
+
+    list_additem(&splitlist, &split);
+    free(data);
+}
+
+
+// Write the segment table object for -split=, nothing if no area was split
+// Should be called after obj_data_process()
+void split_data_write(void) {
+
+    uint32_t c, i, seg_count = 0, sym;
+    uint32_t offset;
+    FILE *   out_file;
+    split_item * splits = (split_item *)splitlist.p_array;
+    file_item *  files  = (file_item *)filelist.p_array;
+
+    if (split_filename[0] == '\0')
+        return;
+
+    out_file = fopen(split_filename, "w");
+    if (!out_file) {
+        printf("BankPack: ERROR: failed to open split table for writing: %s\n", split_filename);
+        exit(EXIT_FAILURE);
+    }
+
+    for (c = 0; c < splitlist.count; c++)
+        seg_count += splits[c].count;
+
+    // Symbols in order: .__.ABS. (0), the segment starts (1..seg_count), then the tables
+    fprintf(out_file, "XL2\nH 1 areas %X global symbols\nM split_data\n", 1 + seg_count + splitlist.count);
+    fprintf(out_file, "S .__.ABS. Def0000\n");
+    for (c = 0; c < splitlist.count; c++) {
+        for (i = 0; i < splits[c].count; i++)
+            fprintf(out_file, "S %s__seg%u Ref0000\n", splits[c].name, i);
+    }
+    fprintf(out_file, "A _CODE size %X flags 0 addr 0\n", (seg_count + splitlist.count) * SPLIT_ENTRY_SIZE);
+    for (c = 0, offset = 0; c < splitlist.count; c++) {
+        fprintf(out_file, "S %s_segments Def%04X\n", splits[c].name, offset);
+        offset += (splits[c].count + 1) * SPLIT_ENTRY_SIZE;
+    }
+
+    // One T line per entry, the address is left to the linker (offset 1, after the 2 address bytes)
+    for (c = 0, offset = 0, sym = 1; c < splitlist.count; c++) {
+        for (i = 0; i <= splits[c].count; i++, offset += SPLIT_ENTRY_SIZE) {
+            file_item * p_file = &files[splits[c].file_first + i];
+            uint32_t    size;
+
+            fprintf(out_file, "T %02X %02X", offset & 0xFFU, (offset >> 8) & 0xFFU);
+            if (i == splits[c].count) {
+                fprintf(out_file, " 00 00 00 00 00\nR 00 00 00 00\n");
+                continue;
+            }
+
+            // Banks above 255 (MBC5 with more than 4MB) don't fit the byte table
+            if (p_file->bank_num > 0xFFU)
+                printf("BankPack: Warning: segment %u of %s is in bank %d, which is truncated in the split table\n", i, splits[c].name, p_file->bank_num);
+            size = (i == splits[c].count - 1) ? splits[c].last_size : BANK_SIZE_ROM;
+            fprintf(out_file, " %02X 00 00 %02X %02X\n", p_file->bank_num & 0xFFU, size & 0xFFU, (size >> 8) & 0xFFU);
+            fprintf(out_file, "R 00 00 00 00 %02X %02X %02X %02X\n", SPLIT_R_SYM_WORD, 1 + SPLIT_TABLE_ADDR_BYTES,
+                    sym & 0xFFU, (sym >> 8) & 0xFFU);
+            sym++;
+        }
+    }
+
+    fclose(out_file);
+}
@@ -0,0 +1,18 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _SPLIT_DATA_H
+#define _SPLIT_DATA_H
+
+#include "list.h"
+#include "obj_data.h"
+
+void split_data_init(void);
+void split_data_cleanup(void);
+void split_data_set(char * filename);
+char * split_data_get_filename(void);
+bool split_data_check(list_type * p_areas);
+void split_data_make(uint32_t file_id, area_item * p_area);
+void split_data_write(void);
+
+#endif // _SPLIT_DATA_H
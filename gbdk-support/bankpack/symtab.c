@@ -0,0 +1,154 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "symtab.h"
+
+#define SYMTAB_SIZE_INITIAL  1024u    // Number of slots, power of 2
+#define SYMTAB_ARENA_BLOCK   0x10000u // Bytes per arena block for name storage
+
+
+static void * symtab_alloc(size_t size) {
+
+    void * p_mem = calloc(1, size);
+
+    if (!p_mem) {
+        printf("ERROR: Failed to allocate memory for symbol table!\n");
+        exit(EXIT_FAILURE);
+    }
+    return p_mem;
+}
+
+
+// FNV-1a over the name, with the scope mixed in
+static uint32_t symtab_hash(const char * name, uint32_t scope) {
+
+    uint32_t hash = 2166136261u ^ scope;
+
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+// Copy a name into the arena, adding a new block if the current one is full
+static const char * symtab_arena_strdup(symtab_type * p_tab, const char * name) {
+
+    size_t len = strlen(name) + 1;
+    size_t block_size;
+    symtab_arena_block * p_block = p_tab->p_arena;
+    char * p_str;
+
+    if ((!p_block) || (p_block->size - p_block->used < len)) {
+        block_size = (len > SYMTAB_ARENA_BLOCK) ? len : SYMTAB_ARENA_BLOCK;
+        p_block = symtab_alloc(sizeof(symtab_arena_block) + block_size);
+        p_block->size = block_size;
+        p_block->p_next = p_tab->p_arena;
+        p_tab->p_arena = p_block;
+    }
+
+    p_str = p_block->data + p_block->used;
+    memcpy(p_str, name, len);
+    p_block->used += len;
+    return p_str;
+}
+
+
+// Returns the slot holding the entry, or the empty slot where it would go
+static symtab_slot * symtab_slot_get(symtab_slot * p_slots, uint32_t size, const char * name, uint32_t scope, uint32_t hash) {
+
+    uint32_t mask = size - 1;
+    uint32_t idx = hash & mask;
+
+    while (p_slots[idx].name) {
+        if ((p_slots[idx].hash == hash) && (p_slots[idx].scope == scope) &&
+            (strcmp(p_slots[idx].name, name) == 0))
+            break;
+        idx = (idx + 1) & mask;
+    }
+    return &p_slots[idx];
+}
+
+
+// Double the number of slots and re-insert the existing entries
+static void symtab_grow(symtab_type * p_tab) {
+
+    uint32_t c;
+    uint32_t size_new = p_tab->size * 2;
+    symtab_slot * p_slots_new = symtab_alloc(size_new * sizeof(symtab_slot));
+
+    for (c = 0; c < p_tab->size; c++) {
+        if (p_tab->p_slots[c].name)
+            *symtab_slot_get(p_slots_new, size_new, p_tab->p_slots[c].name, p_tab->p_slots[c].scope, p_tab->p_slots[c].hash) = p_tab->p_slots[c];
+    }
+
+    free(p_tab->p_slots);
+    p_tab->p_slots = p_slots_new;
+    p_tab->size = size_new;
+}
+
+
+void symtab_init(symtab_type * p_tab) {
+
+    p_tab->size    = SYMTAB_SIZE_INITIAL;
+    p_tab->count   = 0;
+    p_tab->p_slots = symtab_alloc(p_tab->size * sizeof(symtab_slot));
+    p_tab->p_arena = NULL;
+}
+
+
+// Free the slots and all name storage
+void symtab_cleanup(symtab_type * p_tab) {
+
+    symtab_arena_block * p_block;
+
+    while (p_tab->p_arena) {
+        p_block = p_tab->p_arena;
+        p_tab->p_arena = p_block->p_next;
+        free(p_block);
+    }
+
+    if (p_tab->p_slots) {
+        free(p_tab->p_slots);
+        p_tab->p_slots = NULL;
+    }
+    p_tab->size = p_tab->count = 0;
+}
+
+
+// Add an entry. If (scope, name) is already present the first value is kept
+void symtab_add(symtab_type * p_tab, const char * name, uint32_t scope, uint32_t value) {
+
+    uint32_t hash = symtab_hash(name, scope);
+    symtab_slot * p_slot;
+
+    // Keep load factor under 1/2 so probe runs stay short
+    if ((p_tab->count + 1) * 2 > p_tab->size)
+        symtab_grow(p_tab);
+
+    p_slot = symtab_slot_get(p_tab->p_slots, p_tab->size, name, scope, hash);
+    if (p_slot->name)
+        return;
+
+    p_slot->name  = symtab_arena_strdup(p_tab, name);
+    p_slot->scope = scope;
+    p_slot->hash  = hash;
+    p_slot->value = value;
+    p_tab->count++;
+}
+
+
+// Returns the value for (scope, name) or SYMTAB_NOT_FOUND
+// Safe to call from multiple threads as long as nothing is being added
+uint32_t symtab_find(symtab_type * p_tab, const char * name, uint32_t scope) {
+
+    symtab_slot * p_slot = symtab_slot_get(p_tab->p_slots, p_tab->size, name, scope, symtab_hash(name, scope));
+
+    return (p_slot->name) ? p_slot->value : SYMTAB_NOT_FOUND;
+}
@@ -0,0 +1,37 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _SYMTAB_H
+#define _SYMTAB_H
+
+#define SYMTAB_NOT_FOUND 0xFFFFFFFFU
+
+// Open addressing hash table mapping (scope, name) -> value
+// Names are copied into an arena owned by the table
+typedef struct symtab_slot {
+    const char * name;   // NULL if the slot is unused
+    uint32_t     scope;
+    uint32_t     hash;
+    uint32_t     value;
+} symtab_slot;
+
+typedef struct symtab_arena_block {
+    struct symtab_arena_block * p_next;
+    size_t                      used;
+    size_t                      size;
+    char                        data[];
+} symtab_arena_block;
+
+typedef struct symtab_type {
+    symtab_slot *        p_slots;
+    uint32_t             size;   // Always a power of 2
+    uint32_t             count;
+    symtab_arena_block * p_arena;
+} symtab_type;
+
+void     symtab_init(symtab_type *);
+void     symtab_cleanup(symtab_type *);
+void     symtab_add(symtab_type *, const char * name, uint32_t scope, uint32_t value);
+uint32_t symtab_find(symtab_type *, const char * name, uint32_t scope);
+
+#endif // _SYMTAB_H
@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+"""
+Times the gbdk-support host tools over a generated reference corpus.
+
+The corpus is made from a fixed random seed, so every run converts the
+same inputs and the sizes (and compression ratios) only change when the
+output of a tool does:
+    png2asset   a 256x256 map with repeated and flipped tiles, a sheet of
+                16x16 metasprite frames and the map as SMS 4bpp
+    gbcompress  64K of tile-like data, both directions with the gb and rle codecs
+    bankpack    1000 objects with an auto-banked code area each
+    ihxcheck    an 8MB MBC5 image
+    makebin     the same image to a .gb file
+
+Each case runs --repeat times and the fastest run is reported, one CSV
+line per case:
+    case,seconds,in_bytes,out_bytes,mb_per_s,ratio
+
+ratio is out_bytes / in_bytes. For decompression and conversion cases it
+is the size of the result for the size of its input, so it is stable too.
+"""
+import sys
+import os
+import argparse
+import random
+import shutil
+import struct
+import subprocess
+import tempfile
+import time
+import zlib
+from typing import Callable, List, Optional, Tuple
+
+SEED = 2020
+TOOLS = ['png2asset', 'gbcompress', 'bankpack', 'ihxcheck', 'makebin']
+OBJ_COUNT = 1000
+ROM_BANKS = 512
+
+
+def write_png(path: str, width: int, height: int, palette: List[Tuple[int, int, int]], pixels: bytes) -> None:
+    """
+    Writes an 8 bit indexed png
+
+    :param path: File to write
+    :param width: Width in pixels
+    :param height: Height in pixels
+    :param palette: RGB colors, at most 256
+    :param pixels: One palette index per pixel, row by row
+    """
+    def chunk(kind: bytes, data: bytes) -> bytes:
+        return struct.pack('>I', len(data)) + kind + data + struct.pack('>I', zlib.crc32(kind + data) & 0xFFFFFFFF)
+
+    rows = b''.join(b'\x00' + pixels[y * width:(y + 1) * width] for y in range(height))
+    with open(path, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n')
+        f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 3, 0, 0, 0)))
+        f.write(chunk(b'PLTE', b''.join(bytes(c) for c in palette)))
+        f.write(chunk(b'IDAT', zlib.compress(rows, 9)))
+        f.write(chunk(b'IEND', b''))
+
+
+def tile_set(rng: random.Random, count: int, colors: int) -> List[List[int]]:
+    """
+    Makes 8x8 tiles of palette indexes, each one a few bands of color
+    so that they look like graphics rather than noise
+
+    :return: 64 indexes per tile
+    """
+    tiles = []
+    for _ in range(count):
+        base = rng.randrange(colors)
+        tile = []
+        for y in range(8):
+            band = (base + (y * rng.randrange(1, 3)) // 3) % colors
+            tile.extend(band if rng.random() < 0.8 else rng.randrange(colors) for _ in range(8))
+        tiles.append(tile)
+    return tiles
+
+
+def tiled_image(rng: random.Random, tiles: List[List[int]], tiles_w: int, tiles_h: int) -> bytes:
+    """
+    Places random tiles (some of them flipped) on a grid
+
+    :return: Palette indexes of the image, row by row
+    """
+    width = tiles_w * 8
+    pixels = bytearray(width * tiles_h * 8)
+    for ty in range(tiles_h):
+        for tx in range(tiles_w):
+            tile = tiles[rng.randrange(len(tiles))]
+            flip_x, flip_y = rng.random() < 0.2, rng.random() < 0.2
+            for y in range(8):
+                src_y = 7 - y if flip_y else y
+                for x in range(8):
+                    src_x = 7 - x if flip_x else x
+                    pixels[(ty * 8 + y) * width + tx * 8 + x] = tile[src_y * 8 + src_x]
+    return bytes(pixels)
+
+
+def write_object(path: str, num: int, rng: random.Random) -> None:
+    """
+    Writes an sm83 object file with an auto-banked _CODE_255 area of
+    random size which calls a function of the previous object
+    """
+    size = rng.randrange(0x100, 0x1000)
+    refs = [f'S _func{num - 1} Ref000000'] if num else []
+    lines = ['XL3',
+             f'H 3 areas {3 + len(refs)} global symbols',
+             f'M bench{num}',
+             'O -msm83',
+             'S .__.ABS. Def000000',
+             f'S b_func{num} Def0000FF'] + refs + [
+             'A _CODE size 0 flags 0 addr 0',
+             'A _DATA size 0 flags 0 addr 0',
+             f'A _CODE_255 size {size:X} flags 0 addr 0',
+             f'S _func{num} Def000000']
+    for addr in range(0, size, 13):
+        data = ' '.join(f'{rng.randrange(256):02X}' for _ in range(min(13, size - addr)))
+        lines.append(f'T {addr & 0xFF:02X} {addr >> 8:02X} 00 {data}')
+        lines.append('R 00 00 02 00')
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+
+
+def write_ihx(path: str, rng: random.Random) -> int:
+    """
+    Writes an ihx of ROM_BANKS full banks at their linear addresses
+    (bank * 0x4000), as the linker writes banked images
+
+    :return: Bytes of ROM in the file
+    """
+    block = bytes(rng.randrange(256) for _ in range(0x4000))
+    total = 0
+    upper = 0
+    with open(path, 'w') as f:
+        for bank in range(ROM_BANKS):
+            for offset in range(0, 0x4000, 32):
+                addr = bank * 0x4000 + offset
+                if (addr >> 16) != upper:
+                    upper = addr >> 16
+                    ext = bytes([2, 0, 0, 4, upper >> 8, upper & 0xFF])
+                    f.write(f':{ext.hex().upper()}{(-sum(ext)) & 0xFF:02X}\n')
+                data = bytes([bank & 0xFF]) + block[offset + 1:offset + 32]
+                record = bytes([len(data), (addr >> 8) & 0xFF, addr & 0xFF, 0]) + data
+                f.write(f':{record.hex().upper()}{(-sum(record)) & 0xFF:02X}\n')
+                total += len(data)
+        f.write(':00000001FF\n')
+    return total
+
+
+def make_corpus(work: str) -> None:
+    """
+    Writes the generated inputs into work
+    """
+    rng = random.Random(SEED)
+    gb_palette = [(224, 248, 208), (136, 192, 112), (52, 104, 86), (8, 24, 32)]
+    sms_palette = [(rng.randrange(4) * 85, rng.randrange(4) * 85, rng.randrange(4) * 85) for _ in range(16)]
+
+    write_png(os.path.join(work, 'map.png'), 256, 256, gb_palette,
+              tiled_image(rng, tile_set(rng, 96, 4), 32, 32))
+    write_png(os.path.join(work, 'sprites.png'), 128, 128, gb_palette,
+              tiled_image(rng, tile_set(rng, 64, 4), 16, 16))
+    write_png(os.path.join(work, 'map_sms.png'), 256, 192, sms_palette,
+              tiled_image(rng, tile_set(rng, 160, 16), 32, 24))
+
+    tiles = b''.join(bytes(rng.randrange(256) if rng.random() < 0.3 else 0 for _ in range(16)) for _ in range(64))
+    with open(os.path.join(work, 'data.bin'), 'wb') as f:
+        f.write(bytes(tiles[rng.randrange(64) * 16 + i] for _ in range(4096) for i in range(16)))
+
+    os.makedirs(os.path.join(work, 'obj'), exist_ok=True)
+    os.makedirs(os.path.join(work, 'obj_out'), exist_ok=True)
+    for num in range(OBJ_COUNT):
+        write_object(os.path.join(work, 'obj', f'bench{num}.o'), num, rng)
+
+    write_ihx(os.path.join(work, 'rom.ihx'), rng)
+
+
+def file_size(path: str) -> int:
+    return os.path.getsize(path) if os.path.exists(path) else 0
+
+
+def tool_path(bindir: Optional[str], tool: str) -> str:
+    """
+    Finds a tool in bindir, or else in its source directory next to this script
+    """
+    exe = tool + ('.exe' if os.name == 'nt' else '')
+    if bindir:
+        return os.path.join(bindir, exe)
+    return os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', tool, exe)
+
+
+def run_case(name: str, cmd: List[str], work: str, in_bytes: Callable[[], int], out_bytes: Callable[[], int],
+             repeat: int) -> str:
+    """
+    Runs cmd repeat times in work and formats the CSV line of the fastest run
+
+    :param in_bytes: Size of the input, for the throughput
+    :param out_bytes: Size of the output, read after the runs
+    """
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        result = subprocess.run(cmd, cwd=work, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        elapsed = time.perf_counter() - start
+        if result.returncode != 0:
+            raise RuntimeError(f'{name}: {" ".join(cmd)} failed:\n{result.stderr.decode(errors="replace")}')
+        best = elapsed if best is None else min(best, elapsed)
+    size_in, size_out = in_bytes(), out_bytes()
+    rate = size_in / best / 1000000 if best else 0.0
+    ratio = size_out / size_in if size_in else 0.0
+    return f'{name},{best:.4f},{size_in},{size_out},{rate:.3f},{ratio:.4f}'
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--bindir', help='directory of the tools (default: the build in each tool source directory)')
+    parser.add_argument('--workdir', help='keep the corpus and outputs in this directory (default: a temporary one)')
+    parser.add_argument('--repeat', type=int, default=3, help='runs of each case, the fastest counts (default: 3)')
+    parser.add_argument('--only', action='append', choices=TOOLS, help='only run the cases of this tool, can be repeated')
+    args = parser.parse_args()
+
+    tools = {t: os.path.abspath(tool_path(args.bindir, t)) for t in TOOLS}
+    missing = [p for t, p in tools.items() if (not args.only or t in args.only) and not os.path.exists(p)]
+    if missing:
+        sys.stderr.write('missing tools (build them first): ' + ' '.join(missing) + '\n')
+        return 1
+
+    work = args.workdir or tempfile.mkdtemp(prefix='gbdk_bench_')
+    os.makedirs(work, exist_ok=True)
+    make_corpus(work)
+
+    def size(name: str) -> Callable[[], int]:
+        return lambda: file_size(os.path.join(work, name))
+
+    def obj_size(folder: str) -> Callable[[], int]:
+        return lambda: sum(file_size(os.path.join(work, folder, f)) for f in os.listdir(os.path.join(work, folder)))
+
+    objs = [os.path.join('obj', f'bench{n}.o') for n in range(OBJ_COUNT)]
+    cases = [
+        ('png2asset', 'png2asset_map', [tools['png2asset'], 'map.png', '-c', 'map_out.c', '-map', '-bin'],
+         size('map.png'), lambda: file_size(os.path.join(work, 'map_out_tiles.bin')) + file_size(os.path.join(work, 'map_out_map.bin'))),
+        ('png2asset', 'png2asset_metasprites', [tools['png2asset'], 'sprites.png', '-c', 'sprites_out.c', '-sw', '16', '-sh', '16'],
+         size('sprites.png'), size('sprites_out.c')),
+        ('png2asset', 'png2asset_map_sms_4bpp', [tools['png2asset'], 'map_sms.png', '-c', 'map_sms_out.c', '-map',
+                                                 '-bpp', '4', '-max_palettes', '2', '-pack_mode', 'sms', '-use_map_attributes'],
+         size('map_sms.png'), size('map_sms_out.c')),
+        ('gbcompress', 'gbcompress_gb', [tools['gbcompress'], 'data.bin', 'data.gb'], size('data.bin'), size('data.gb')),
+        ('gbcompress', 'gbcompress_gb_d', [tools['gbcompress'], '-d', 'data.gb', 'data.gb.out'], size('data.gb'), size('data.gb.out')),
+        ('gbcompress', 'gbcompress_rle', [tools['gbcompress'], '--alg=rle', 'data.bin', 'data.rle'], size('data.bin'), size('data.rle')),
+        ('gbcompress', 'gbcompress_rle_d', [tools['gbcompress'], '--alg=rle', '-d', 'data.rle', 'data.rle.out'],
+         size('data.rle'), size('data.rle.out')),
+        ('bankpack', 'bankpack_1000_objects', [tools['bankpack'], '-mbc=5', '-ext=.rel', '-path=obj_out'] + objs,
+         obj_size('obj'), obj_size('obj_out')),
+        ('ihxcheck', 'ihxcheck_8mb', [tools['ihxcheck'], 'rom.ihx'], size('rom.ihx'), size('rom.ihx')),
+        ('makebin', 'makebin_8mb', [tools['makebin'], '-Z', '-yt', '0x19', '-yo', str(ROM_BANKS), 'rom.ihx', 'rom.gb'],
+         size('rom.ihx'), size('rom.gb')),
+    ]
+
+    status = 0
+    print('case,seconds,in_bytes,out_bytes,mb_per_s,ratio')
+    try:
+        for tool, name, cmd, in_bytes, out_bytes in cases:
+            if args.only and tool not in args.only:
+                continue
+            try:
+                print(run_case(name, cmd, work, in_bytes, out_bytes, max(1, args.repeat)), flush=True)
+            except RuntimeError as e:
+                sys.stderr.write(f'{e}\n')
+                status = 1
+    finally:
+        if not args.workdir:
+            shutil.rmtree(work, ignore_errors=True)
+    return status
+
+
+if __name__ == '__main__':
+    sys.exit(main())
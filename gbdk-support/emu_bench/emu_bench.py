@@ -0,0 +1,305 @@
+#!/usr/bin/env python3
+"""
+Runs the benchmark example ROMs in an emulator and compares the cycle
+counts they report with a stored baseline.
+
+The benchmark example (examples/cross-platform/benchmark) prints one
+debug message line per routine with EMU_printf():
+    BENCH,start,<calls per measurement>
+    BENCH,<name>,<cycles>
+    BENCH,done,0
+
+Each target is run with an emulator command given with --emu or in an
+--emu-config file, one "<target>=<command>" per line. The command is
+split like a shell command line and these fields are replaced:
+    {rom}       the ROM to run
+    {log}       a file for the debug messages, read once the run is over
+    {target}    the target name
+Without {log} the BENCH lines are read from the output of the command.
+A run ends at the BENCH,done line or at --timeout, the emulator is
+stopped then, so it does not have to exit on its own.
+
+Without --update the results are compared with the baseline, one line
+per case and target:
+    target,rom,case,baseline,cycles,change_percent,status
+status is "slower" when a case takes more than --tolerance percent
+and more than --min-delta cycles longer than its baseline, "faster"
+the other way around, "new" without a baseline and "missing" when the
+ROM no longer reports it. Slower and missing cases make the exit
+status 1, so a library change which slows a routine down fails the
+run. --update writes the results of the targets which ran as the new
+baseline, keeping the lines of the other targets.
+
+Targets without a ROM or without an emulator command are skipped with
+a message.
+"""
+import sys
+import os
+import argparse
+import csv
+import shlex
+import subprocess
+import tempfile
+import threading
+import time
+from typing import Dict, List, Optional, Tuple
+
+TARGETS = ['gb', 'ap', 'duck', 'sms', 'gg', 'msxdos', 'nes']
+
+# Build directory and ROM extension of each target in the example projects
+TARGET_EXT = {
+    'gb':     ('gb', 'gb'),
+    'ap':     ('pocket', 'pocket'),
+    'duck':   ('duck', 'duck'),
+    'sms':    ('sms', 'sms'),
+    'gg':     ('gg', 'gg'),
+    'msxdos': ('msxdos', 'com'),
+    'nes':    ('nes', 'nes'),
+}
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+EXAMPLES = os.path.normpath(os.path.join(HERE, '..', '..', 'gbdk-lib', 'examples', 'cross-platform'))
+DEFAULT_PROJECTS = ['benchmark']
+DEFAULT_BASELINE = os.path.join(HERE, 'baseline.csv')
+
+DONE_LINE = 'BENCH,done'
+
+Results = Dict[Tuple[str, str, str], int]
+
+
+def parse_bench_lines(text: str) -> Dict[str, int]:
+    """
+    Reads the BENCH,<name>,<cycles> lines of a debug message log
+
+    :param text: Log or emulator output, other lines are ignored
+    :return: Cycles by case name, without the start and done lines
+    """
+    cases: Dict[str, int] = {}
+    for line in text.splitlines():
+        pos = line.find('BENCH,')
+        if pos < 0:
+            continue
+        fields = line[pos:].strip().split(',')
+        if (len(fields) != 3) or (fields[1] in ('start', 'done')):
+            continue
+        try:
+            cases[fields[1]] = int(fields[2])
+        except ValueError:
+            continue
+    return cases
+
+
+def read_emulators(args: argparse.Namespace) -> Dict[str, str]:
+    """
+    Collects the emulator command of each target from --emu-config and --emu,
+    the command line wins
+    """
+    commands: Dict[str, str] = {}
+    lines: List[str] = []
+    if args.emu_config:
+        with open(args.emu_config) as f:
+            lines += [line.strip() for line in f]
+    lines += args.emu
+    for line in lines:
+        if (not line) or line.startswith('#'):
+            continue
+        target, sep, command = line.partition('=')
+        target = target.strip()
+        if (not sep) or (target not in TARGETS and target != 'all'):
+            raise ValueError(f'bad emulator entry "{line}", expected <target>=<command>')
+        if target == 'all':
+            for name in TARGETS:
+                commands.setdefault(name, command.strip())
+        else:
+            commands[target] = command.strip()
+    return commands
+
+
+def run_rom(command: str, rom: str, target: str, timeout: float) -> Tuple[Optional[str], str]:
+    """
+    Runs a ROM until it prints the done line or the time is up
+
+    :return: The collected log (None if the emulator could not be started) and a status message
+    """
+    log_fd, log_path = tempfile.mkstemp(prefix='emu_bench_', suffix='.log')
+    os.close(log_fd)
+    use_log = '{log}' in command
+    argv = [arg.format(rom=rom, log=log_path, target=target) for arg in shlex.split(command)]
+    output: List[str] = []
+
+    try:
+        proc = subprocess.Popen(argv, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                stdin=subprocess.DEVNULL, universal_newlines=True, errors='replace')
+    except OSError as e:
+        os.remove(log_path)
+        return None, f'can not start {argv[0]}: {e.strerror}'
+
+    def read_output() -> None:
+        for line in proc.stdout:
+            output.append(line)
+
+    reader = threading.Thread(target=read_output, daemon=True)
+    reader.start()
+
+    def collected() -> str:
+        if use_log:
+            with open(log_path, errors='replace') as f:
+                return f.read()
+        return ''.join(output)
+
+    status = 'done'
+    end = time.monotonic() + timeout
+    while True:
+        if DONE_LINE in collected():
+            break
+        if proc.poll() is not None:
+            status = f'exited with {proc.returncode} before {DONE_LINE}'
+            break
+        if time.monotonic() > end:
+            status = f'timed out after {timeout:g}s'
+            break
+        time.sleep(0.1)
+
+    if proc.poll() is None:
+        proc.terminate()
+        try:
+            proc.wait(5)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+            proc.wait()
+    reader.join(1)
+    text = collected()
+    os.remove(log_path)
+    return text, status
+
+
+def read_baseline(path: str) -> Results:
+    """
+    :return: Cycles by (target, rom, case)
+    """
+    results: Results = {}
+    with open(path, newline='') as f:
+        for row in csv.DictReader(f):
+            results[(row['target'], row['rom'], row['case'])] = int(row['cycles'])
+    return results
+
+
+def write_baseline(path: str, results: Results) -> None:
+    with open(path, 'w', newline='') as f:
+        out = csv.writer(f, lineterminator='\n')
+        out.writerow(['target', 'rom', 'case', 'cycles'])
+        for key in sorted(results, key=lambda k: (TARGETS.index(k[0]) if k[0] in TARGETS else len(TARGETS), k[1], k[2])):
+            out.writerow([key[0], key[1], key[2], results[key]])
+
+
+def compare(baseline: Results, results: Results, ran: List[Tuple[str, str]], tolerance: float, min_delta: int) -> bool:
+    """
+    Prints the comparison of the ROMs which ran with their baseline
+
+    :return: True if nothing got slower or went missing
+    """
+    ok = True
+    print('target,rom,case,baseline,cycles,change_percent,status')
+    keys = set(results) | {key for key in baseline if (key[0], key[1]) in ran}
+    for key in sorted(keys, key=lambda k: (TARGETS.index(k[0]), k[1], k[2])):
+        base = baseline.get(key)
+        now = results.get(key)
+        if now is None:
+            print(f'{key[0]},{key[1]},{key[2]},{base},,,missing')
+            ok = False
+            continue
+        if base is None:
+            print(f'{key[0]},{key[1]},{key[2]},,{now},,new')
+            continue
+        change = ((now - base) * 100.0 / base) if base else (100.0 if now else 0.0)
+        status = 'same'
+        if (now - base > min_delta) and (change > tolerance):
+            status = 'slower'
+            ok = False
+        elif (base - now > min_delta) and (-change > tolerance):
+            status = 'faster'
+        print(f'{key[0]},{key[1]},{key[2]},{base},{now},{change:.1f},{status}')
+    return ok
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Runs the benchmark example ROMs in an emulator and compares the results with a baseline')
+    parser.add_argument('--emu', action='append', default=[], metavar='TARGET=COMMAND',
+                        help='emulator command for a target, "all" for every target without one; '
+                             'fields: {rom}, {log}, {target}')
+    parser.add_argument('--emu-config', metavar='FILE', help='file of TARGET=COMMAND lines, # for comments')
+    parser.add_argument('--targets', default=','.join(TARGETS),
+                        help=f'comma separated targets to run (default: {",".join(TARGETS)})')
+    parser.add_argument('--project', action='append', default=[], metavar='DIR',
+                        help='example project to run, its ROMs are <dir>/build/<ext>/<dir name>.<ext> '
+                             '(default: the cross-platform benchmark example)')
+    parser.add_argument('--baseline', default=DEFAULT_BASELINE, help='baseline CSV file (default: baseline.csv next to this script)')
+    parser.add_argument('--update', action='store_true', help='write the results as the new baseline instead of comparing')
+    parser.add_argument('--tolerance', type=float, default=5.0,
+                        help='percent a case may get slower before it fails (default: 5)')
+    parser.add_argument('--min-delta', type=int, default=256,
+                        help='cycles a case may get slower regardless of the percentage, the timer '
+                             'resolution of the benchmark (default: 256)')
+    parser.add_argument('--timeout', type=float, default=60.0, help='seconds to wait for each ROM (default: 60)')
+    args = parser.parse_args()
+
+    try:
+        emulators = read_emulators(args)
+    except (OSError, ValueError) as e:
+        sys.stderr.write(f'emu_bench: {e}\n')
+        return 2
+
+    targets = [t.strip() for t in args.targets.split(',') if t.strip()]
+    for target in targets:
+        if target not in TARGETS:
+            sys.stderr.write(f'emu_bench: unknown target {target}, use one of {", ".join(TARGETS)}\n')
+            return 2
+    projects = args.project or [os.path.join(EXAMPLES, name) for name in DEFAULT_PROJECTS]
+
+    results: Results = {}
+    ran: List[Tuple[str, str]] = []
+    failed = False
+    for target in targets:
+        build_dir, ext = TARGET_EXT[target]
+        for project in projects:
+            name = os.path.basename(os.path.normpath(project))
+            rom = os.path.join(project, 'build', build_dir, f'{name}.{ext}')
+            if not os.path.isfile(rom):
+                sys.stderr.write(f'emu_bench: {target}: no {rom}, skipped\n')
+                continue
+            if target not in emulators:
+                sys.stderr.write(f'emu_bench: {target}: no emulator command, skipped\n')
+                continue
+            text, status = run_rom(emulators[target], rom, target, args.timeout)
+            cases = parse_bench_lines(text) if text is not None else {}
+            sys.stderr.write(f'emu_bench: {target}: {name}: {len(cases)} cases, {status}\n')
+            if not cases:
+                failed = True
+                continue
+            ran.append((target, name))
+            for case, cycles in cases.items():
+                results[(target, name, case)] = cycles
+
+    if not ran:
+        sys.stderr.write('emu_bench: no ROM was run\n')
+        return 1
+
+    if args.update:
+        baseline: Results = {}
+        if os.path.isfile(args.baseline):
+            baseline = {k: v for k, v in read_baseline(args.baseline).items() if (k[0], k[1]) not in ran}
+        baseline.update(results)
+        write_baseline(args.baseline, baseline)
+        sys.stderr.write(f'emu_bench: wrote {len(results)} results to {args.baseline}\n')
+        return 1 if failed else 0
+
+    if not os.path.isfile(args.baseline):
+        sys.stderr.write(f'emu_bench: no baseline {args.baseline}, create it with --update\n')
+        return 1
+    if not compare(read_baseline(args.baseline), results, ran, args.tolerance, args.min_delta):
+        failed = True
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""
+Summarizes the profiling zones written by EMU_PROFILE_ZONE_BEGIN() and
+EMU_PROFILE_ZONE_END() (gbdk/emu_debug.h) to an emulator debug message log.
+
+Each zone line looks like:
+    PROFZONE,B,<name>,<clocks>
+    PROFZONE,E,<name>,<clocks>
+
+Anything else in the log is ignored, so it can be mixed with other messages.
+
+With --counts the number of times each zone was entered is printed as
+"<zone> <count>" lines, which bankpack -profile= reads to keep the most
+called functions in the same bank as their callers. Name the zones after
+the functions they time for that.
+"""
+import sys
+import argparse
+import re
+from typing import Dict, List, TextIO
+
+ZONE_RE = re.compile(r'PROFZONE,([BE]),([^,]*),(\d+)')
+
+
+def read_zones(log: TextIO, warn: TextIO) -> Dict[str, List[int]]:
+    """
+    Pairs the begin and end lines of each zone
+
+    :param log: Debug message log
+    :param warn: Where to report unmatched lines
+    :return: Elapsed clocks for every time each zone was entered, by zone name
+    """
+    open_zones: Dict[str, List[int]] = {}
+    samples: Dict[str, List[int]] = {}
+
+    for line_num, line in enumerate(log, 1):
+        match = ZONE_RE.search(line)
+        if not match:
+            continue
+        kind, name, clocks = match.group(1), match.group(2), int(match.group(3))
+        if kind == 'B':
+            open_zones.setdefault(name, []).append(clocks)
+        elif open_zones.get(name):
+            samples.setdefault(name, []).append(clocks - open_zones[name].pop())
+        else:
+            warn.write(f'line {line_num}: end of zone "{name}" without a begin\n')
+
+    for name, starts in open_zones.items():
+        if starts:
+            warn.write(f'zone "{name}" was not ended {len(starts)} time(s)\n')
+    return samples
+
+
+def histogram(values: List[int], buckets: int, width: int) -> List[str]:
+    """
+    Formats a text histogram of values
+
+    :param values: Samples, at least one
+    :param buckets: Number of buckets between the min and max value
+    :param width: Width of the longest bar in characters
+    :return: One line per bucket
+    """
+    low, high = min(values), max(values)
+    size = max(1, -(-(high - low + 1) // buckets))
+    counts = [0] * buckets
+    for value in values:
+        counts[(value - low) // size] += 1
+    peak = max(counts)
+    lines = []
+    for i, count in enumerate(counts):
+        if low + i * size > high:
+            break
+        bar = '#' * ((count * width + peak - 1) // peak) if count else ''
+        lines.append(f'  {low + i * size:>10} - {low + (i + 1) * size - 1:<10} {count:>7} {bar}'.rstrip())
+    return lines
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Summarizes EMU_PROFILE_ZONE_BEGIN() / EMU_PROFILE_ZONE_END() results from an emulator debug message log')
+    parser.add_argument('log', nargs='?', type=argparse.FileType('r'), default=sys.stdin,
+                        help='debug message log (default: stdin)')
+    parser.add_argument('--divide', type=float, default=1.0,
+                        help='divide all clock counts by this, for example 2 for Game Boy normal speed cycles')
+    parser.add_argument('--buckets', type=int, default=10, help='histogram buckets per zone (default: 10)')
+    parser.add_argument('--no-histogram', action='store_true', help='only print the summary table')
+    parser.add_argument('--csv', action='store_true', help='print the summary as CSV: zone,count,min,mean,max,total')
+    parser.add_argument('--counts', action='store_true',
+                        help='print "<zone> <count>" lines for bankpack -profile=, most entered first')
+    args = parser.parse_args()
+
+    samples = read_zones(args.log, sys.stderr)
+    if not samples:
+        sys.stderr.write('no profiling zones found\n')
+        return 1
+
+    if args.counts:
+        for name in sorted(samples, key=lambda n: (-len(samples[n]), n)):
+            print(f'{name} {len(samples[name])}')
+        return 0
+
+    if args.csv:
+        print('zone,count,min,mean,max,total')
+    else:
+        print(f'{"zone":<24} {"count":>7} {"min":>10} {"mean":>10} {"max":>10} {"total":>12}')
+
+    for name in sorted(samples):
+        values = [round(v / args.divide) for v in samples[name]]
+        total = sum(values)
+        mean = total / len(values)
+        if args.csv:
+            print(f'{name},{len(values)},{min(values)},{mean:.1f},{max(values)},{total}')
+            continue
+        print(f'{name:<24} {len(values):>7} {min(values):>10} {mean:>10.1f} {max(values):>10} {total:>12}')
+        if not args.no_histogram and len(values) > 1:
+            print('\n'.join(histogram(values, args.buckets, 40)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
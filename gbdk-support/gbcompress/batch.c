@@ -0,0 +1,418 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Batch mode: convert many files listed in a manifest with one process
+//
+// Manifest format, one entry per line:
+//   infile:outfile[:var_name[:bank]]
+// Blank lines and lines starting with '#' are ignored.
+// With C source input, infile@array picks an array by name instead of
+// the first one, and consecutive entries for the same file share one read.
+//
+// Input files are read and output files written in manifest order,
+// the conversion itself runs across a pool of worker threads.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <pthread.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include "common.h"
+#include "files.h"
+#include "files_c_source.h"
+#include "batch.h"
+
+#define BATCH_MAX_STR_LEN  4096
+#define BATCH_LINE_MAX     (BATCH_MAX_STR_LEN * 3)
+#define BATCH_ENTRIES_GROW 64
+#define BATCH_JOBS_MAX     64
+
+typedef struct batch_entry {
+    char      filename_in[BATCH_MAX_STR_LEN];
+    char      filename_out[BATCH_MAX_STR_LEN];
+    char      varname[BATCH_MAX_STR_LEN];
+    char *    arrayname;  // Part of filename_in after '@', NULL for the first array
+    uint16_t  bank_num;
+
+    uint8_t * p_buf_in;
+    uint32_t  size_in;
+    uint8_t * p_buf_out;
+    uint32_t  size_out;
+    bool      ok;
+} batch_entry;
+
+
+static batch_entry *      p_entries = NULL;
+static uint32_t           entry_count = 0;
+static uint32_t           entry_next = 0;  // Next entry for a worker to convert
+static pthread_mutex_t    entry_lock = PTHREAD_MUTEX_INITIALIZER;
+static batch_convert_func batch_convert;
+static bool               batch_mode_compress;
+
+
+uint32_t batch_get_cpu_count(void) {
+
+    #if defined(_WIN32)
+        SYSTEM_INFO sysinfo;
+        GetSystemInfo(&sysinfo);
+        return (uint32_t)sysinfo.dwNumberOfProcessors;
+    #else
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return (count > 0) ? (uint32_t)count : 1;
+    #endif
+}
+
+
+// Returns the next ':' delimited field and advances the string past it,
+// or NULL if there are no more fields.
+// A leading drive letter such as "C:\" is not treated as a delimiter.
+static char * field_next(char ** p_str) {
+
+    char * field = *p_str;
+    char * search;
+    char * delim;
+
+    if ((field == NULL) || (*field == '\0'))
+        return NULL;
+
+    search = field;
+    if (isalpha((unsigned char)field[0]) && (field[1] == ':') && ((field[2] == '\\') || (field[2] == '/')))
+        search += 2;
+
+    delim = strchr(search, ':');
+    if (delim) {
+        *delim = '\0';
+        *p_str = delim + 1;
+    } else
+        *p_str = NULL;
+
+    return field;
+}
+
+
+// Derive a C variable name from the output filename if none was given
+static void varname_from_filename(char * varname, const char * filename) {
+
+    const char * p_start = filename;
+    const char * p_slash;
+    size_t i;
+
+    if ((p_slash = strrchr(p_start, '/')) != NULL)  p_start = p_slash + 1;
+    if ((p_slash = strrchr(p_start, '\\')) != NULL) p_start = p_slash + 1;
+
+    for (i = 0; (p_start[i] != '\0') && (p_start[i] != '.') && (i < (BATCH_MAX_STR_LEN - 1)); i++)
+        varname[i] = isalnum((unsigned char)p_start[i]) ? p_start[i] : '_';
+    varname[i] = '\0';
+}
+
+
+static bool ends_with_c_ext(const char * filename) {
+
+    size_t len = strlen(filename);
+
+    return (len >= 2) && ((strcmp(&filename[len - 2], ".c") == 0) || (strcmp(&filename[len - 2], ".C") == 0));
+}
+
+
+static bool ends_with_s_ext(const char * filename) {
+
+    size_t len = strlen(filename);
+
+    return (len >= 2) && ((strcmp(&filename[len - 2], ".s") == 0) || (strcmp(&filename[len - 2], ".S") == 0));
+}
+
+
+static bool manifest_add_entry(char * line, uint32_t line_num, char * default_varname, uint16_t default_bank_num) {
+
+    batch_entry * p_tmp;
+    batch_entry * p_entry;
+    char * p_str = line;
+    char * field_in;
+    char * field_out;
+    char * field_varname;
+    char * field_bank;
+
+    // Strip trailing line break and whitespace
+    while ((strlen(line) > 0) && isspace((unsigned char)line[strlen(line) - 1]))
+        line[strlen(line) - 1] = '\0';
+    // Skip leading whitespace
+    while (isspace((unsigned char)*p_str))
+        p_str++;
+
+    // Ignore blank lines and comments
+    if ((*p_str == '\0') || (*p_str == '#'))
+        return true;
+
+    field_in      = field_next(&p_str);
+    field_out     = field_next(&p_str);
+    field_varname = field_next(&p_str);
+    field_bank    = field_next(&p_str);
+
+    if ((field_in == NULL) || (field_out == NULL) || (*field_in == '\0') || (*field_out == '\0')) {
+        printf("gbcompress: ERROR: Manifest line %d: expected infile:outfile[:var_name[:bank]]\n", line_num);
+        return false;
+    }
+
+    if ((entry_count % BATCH_ENTRIES_GROW) == 0) {
+        p_tmp = realloc(p_entries, (entry_count + BATCH_ENTRIES_GROW) * sizeof(batch_entry));
+        if (!p_tmp) {
+            printf("gbcompress: ERROR: Failed to allocate memory for manifest entries\n");
+            return false;
+        }
+        p_entries = p_tmp;
+    }
+
+    p_entry = &p_entries[entry_count];
+    memset(p_entry, 0, sizeof(batch_entry));
+    snprintf(p_entry->filename_in,  sizeof(p_entry->filename_in),  "%s", field_in);
+    snprintf(p_entry->filename_out, sizeof(p_entry->filename_out), "%s", field_out);
+
+    if ((field_varname) && (*field_varname != '\0'))
+        snprintf(p_entry->varname, sizeof(p_entry->varname), "%s", field_varname);
+    else if (default_varname)
+        snprintf(p_entry->varname, sizeof(p_entry->varname), "%s", default_varname);
+    else
+        varname_from_filename(p_entry->varname, p_entry->filename_out);
+
+    p_entry->bank_num = default_bank_num;
+    if ((field_bank) && (*field_bank != '\0')) {
+        p_entry->bank_num = atoi(field_bank);
+        if ((p_entry->bank_num < BANK_NUM_ROM_MIN) || (p_entry->bank_num > BANK_NUM_ROM_MAX)) {
+            printf("gbcompress: ERROR: Manifest line %d: Bank Num %d outside of range %d - %d\n",
+                   line_num, p_entry->bank_num, BANK_NUM_ROM_MIN, BANK_NUM_ROM_MAX);
+            return false;
+        }
+    }
+
+    entry_count++;
+    return true;
+}
+
+
+static bool manifest_read(char * filename_manifest, char * default_varname, uint16_t default_bank_num) {
+
+    char line[BATCH_LINE_MAX];
+    uint32_t line_num = 0;
+    bool status = true;
+    FILE * file_in = fopen(filename_manifest, "r");
+
+    if (!file_in) {
+        printf("gbcompress: ERROR: Failed to open manifest file %s\n", filename_manifest);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file_in) != NULL) {
+        line_num++;
+        if (!manifest_add_entry(line, line_num, default_varname, default_bank_num)) {
+            status = false;
+            break;
+        }
+    }
+
+    fclose(file_in);
+    return status;
+}
+
+
+// Arrays of the C source input file read last
+static c_source_array *   p_arrays_in = NULL;
+static uint32_t           arrays_in_count = 0;
+
+static void batch_read_c_input(batch_entry * p_entry, batch_entry * p_entry_prev) {
+
+    c_source_array * p_array = NULL;
+    uint32_t c;
+
+    p_entry->arrayname = strrchr(p_entry->filename_in, '@');
+    if (p_entry->arrayname)
+        *(p_entry->arrayname++) = '\0';
+
+    // Only parse the file if the entry before didn't use the same one
+    if ((p_entry_prev == NULL) || (strcmp(p_entry->filename_in, p_entry_prev->filename_in) != 0)) {
+        c_source_arrays_free(p_arrays_in, arrays_in_count);
+        arrays_in_count = file_read_c_input_arrays(p_entry->filename_in, &p_arrays_in);
+    }
+
+    for (c = 0; c < arrays_in_count; c++) {
+        if ((p_entry->arrayname == NULL) || (strcmp(p_arrays_in[c].name, p_entry->arrayname) == 0)) {
+            p_array = &p_arrays_in[c];
+            break;
+        }
+    }
+
+    if (p_array == NULL) {
+        if (p_entry->arrayname)
+            printf("gbcompress: ERROR: Array %s not found in %s\n", p_entry->arrayname, p_entry->filename_in);
+        else
+            printf("gbcompress: ERROR: Failed to read any bytes in from %s\n", p_entry->filename_in);
+        return;
+    }
+
+    p_entry->p_buf_in = malloc(p_array->size);
+    if (p_entry->p_buf_in) {
+        memcpy(p_entry->p_buf_in, p_array->p_data, p_array->size);
+        p_entry->size_in = p_array->size;
+    }
+}
+
+
+static void * batch_worker(void * p_arg) {
+
+    batch_entry * p_entry;
+    uint32_t      buf_size_out;
+
+    (void)p_arg;
+
+    while (true) {
+        pthread_mutex_lock(&entry_lock);
+        p_entry = (entry_next < entry_count) ? &p_entries[entry_next++] : NULL;
+        pthread_mutex_unlock(&entry_lock);
+
+        if (p_entry == NULL)
+            break;
+
+        if ((p_entry->p_buf_in == NULL) || (p_entry->size_in == 0))
+            continue;
+
+        // Same initial output sizes as single file mode, buffers grow as needed
+        buf_size_out = (batch_mode_compress) ? p_entry->size_in : p_entry->size_in * 3;
+        p_entry->p_buf_out = malloc(buf_size_out);
+        if (p_entry->p_buf_out) {
+            p_entry->size_out = batch_convert(p_entry->p_buf_in, p_entry->size_in, &p_entry->p_buf_out, buf_size_out);
+            p_entry->ok = (p_entry->size_out > 0);
+        }
+    }
+
+    return NULL;
+}
+
+
+static void batch_cleanup(void) {
+
+    uint32_t c;
+
+    for (c = 0; c < entry_count; c++) {
+        if (p_entries[c].p_buf_in)  free(p_entries[c].p_buf_in);
+        if (p_entries[c].p_buf_out) free(p_entries[c].p_buf_out);
+    }
+    if (p_entries) free(p_entries);
+
+    p_entries = NULL;
+    entry_count = 0;
+    entry_next = 0;
+}
+
+
+static void batch_print_stats(void) {
+
+    uint32_t c;
+    uint32_t total_in = 0;
+    uint32_t total_out = 0;
+    uint32_t fail_count = 0;
+    uint32_t size_comp, size_decomp;
+
+    printf("\n%-40s %10s %10s %8s\n", "File", "In", "Out", "Ratio");
+    for (c = 0; c < entry_count; c++) {
+        if (p_entries[c].ok) {
+            size_comp   = (batch_mode_compress) ? p_entries[c].size_out : p_entries[c].size_in;
+            size_decomp = (batch_mode_compress) ? p_entries[c].size_in  : p_entries[c].size_out;
+            printf("%-40s %10d %10d %7.2f%%\n", p_entries[c].filename_in, p_entries[c].size_in, p_entries[c].size_out,
+                   ((double)size_comp / (double)size_decomp) * 100);
+            total_in  += p_entries[c].size_in;
+            total_out += p_entries[c].size_out;
+        } else {
+            printf("%-40s %10s\n", p_entries[c].filename_in, "FAILED");
+            fail_count++;
+        }
+    }
+
+    printf("Total: %d files, %d failed, %d bytes -> %d bytes\n", entry_count, fail_count, total_in, total_out);
+}
+
+
+// Convert all files in a manifest
+//
+// Returns false if the manifest could not be read or any file failed
+bool batch_process(char * filename_manifest, batch_convert_func convert_func, bool mode_compress,
+                   bool c_source_input, bool c_source_output, char * default_varname, uint16_t default_bank_num,
+                   uint32_t job_count) {
+
+    pthread_t   threads[BATCH_JOBS_MAX];
+    uint32_t    thread_count = 0;
+    uint32_t    c;
+    bool        status = true;
+    batch_entry * p_entry;
+
+    batch_convert = convert_func;
+    batch_mode_compress = mode_compress;
+
+    if (!manifest_read(filename_manifest, default_varname, default_bank_num)) {
+        batch_cleanup();
+        return false;
+    }
+
+    // Read inputs up front, the C source parser isn't thread safe
+    for (c = 0; c < entry_count; c++) {
+        p_entry = &p_entries[c];
+        if (c_source_input)
+            batch_read_c_input(p_entry, (c) ? &p_entries[c - 1] : NULL);
+        else
+            p_entry->p_buf_in = file_read_into_buffer(p_entry->filename_in, &p_entry->size_in);
+    }
+    c_source_arrays_free(p_arrays_in, arrays_in_count);
+    p_arrays_in = NULL;
+    arrays_in_count = 0;
+
+    if (job_count == BATCH_JOBS_AUTO)
+        job_count = batch_get_cpu_count();
+    if (job_count > BATCH_JOBS_MAX) job_count = BATCH_JOBS_MAX;
+    if (job_count > entry_count)    job_count = entry_count;
+
+    // This thread is one of the workers, so start one less
+    for (c = 1; c < job_count; c++) {
+        if (pthread_create(&threads[thread_count], NULL, batch_worker, NULL) == 0)
+            thread_count++;
+    }
+    // Also covers the case of thread creation failing
+    batch_worker(NULL);
+    for (c = 0; c < thread_count; c++)
+        pthread_join(threads[c], NULL);
+
+    // Write outputs in manifest order
+    for (c = 0; c < entry_count; c++) {
+        p_entry = &p_entries[c];
+        if (!p_entry->ok)
+            continue;
+
+        if (mode_compress)
+            c_source_set_sizes(p_entry->size_out, p_entry->size_in); // compressed, decompressed
+        else
+            c_source_set_sizes(p_entry->size_in, p_entry->size_out); // compressed, decompressed
+
+        if (ends_with_s_ext(p_entry->filename_out))
+            p_entry->ok = file_write_asm_output_from_buffer(p_entry->filename_out, p_entry->p_buf_out, p_entry->size_out,
+                                                            p_entry->varname, p_entry->bank_num);
+        else if (c_source_output || ends_with_c_ext(p_entry->filename_out))
+            p_entry->ok = file_write_c_output_from_buffer(p_entry->filename_out, p_entry->p_buf_out, p_entry->size_out,
+                                                          p_entry->varname, true, p_entry->bank_num);
+        else
+            p_entry->ok = file_write_from_buffer(p_entry->filename_out, p_entry->p_buf_out, p_entry->size_out);
+    }
+
+    batch_print_stats();
+
+    for (c = 0; c < entry_count; c++)
+        if (!p_entries[c].ok) status = false;
+
+    batch_cleanup();
+    return status;
+}
@@ -0,0 +1,17 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#define BATCH_JOBS_AUTO 0
+
+// Same signature as gbcompress_buf(), rlecompress_buf(), etc
+typedef uint32_t (*batch_convert_func)(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
+
+uint32_t batch_get_cpu_count(void);
+bool batch_process(char * filename_manifest, batch_convert_func convert_func, bool mode_compress,
+                   bool c_source_input, bool c_source_output, char * default_varname, uint16_t default_bank_num,
+                   uint32_t job_count);
+
+#endif // _BATCH_H
@@ -0,0 +1,134 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Block mode (--blocks=<size>): compress each <size> bytes of the input
+// as a separate stream, so matches never reach back across the start of
+// a block and the decompressor can start at any of them
+//
+// The blocks are compressed across a pool of worker threads, then
+// joined in order. The offset of each one is returned in an index.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "batch.h"
+#include "blocks.h"
+
+#define BLOCKS_JOBS_MAX 64
+
+typedef struct block_item {
+    uint8_t * p_buf_out;
+    uint32_t  size_out;
+} block_item;
+
+
+static block_item *       p_blocks = NULL;
+static uint32_t           block_count = 0;
+static uint32_t           block_next = 0;  // Next block for a worker to compress
+static pthread_mutex_t    block_lock = PTHREAD_MUTEX_INITIALIZER;
+static batch_convert_func block_compress;
+static uint8_t *          p_block_in;
+static uint32_t           block_in_size;
+static uint32_t           block_in_len;
+
+
+static void * blocks_worker(void * p_arg) {
+
+    uint32_t     num;
+    uint32_t     start, len;
+    block_item * p_block;
+
+    (void)p_arg;
+
+    while (1) {
+        pthread_mutex_lock(&block_lock);
+        num = block_next++;
+        pthread_mutex_unlock(&block_lock);
+        if (num >= block_count)
+            break;
+
+        p_block = &p_blocks[num];
+        start = num * block_in_len;
+        len = ((start + block_in_len) < block_in_size) ? block_in_len : (block_in_size - start);
+
+        // Same as the single stream case, the compressors grow it as needed
+        p_block->size_out = 0;
+        p_block->p_buf_out = malloc(len);
+        if (p_block->p_buf_out)
+            p_block->size_out = block_compress(p_block_in + start, len, &p_block->p_buf_out, len);
+    }
+    return NULL;
+}
+
+
+// Compress inBuf as blocks of block_size bytes into *pp_outBuf
+// p_index gets the offset of each block, it must have room for one per block
+//
+// Returns the total compressed length, 0 if a block failed
+uint32_t blocks_compress(batch_convert_func compress_func, uint8_t * inBuf, uint32_t size_in,
+                         uint8_t ** pp_outBuf, uint32_t size_out,
+                         uint32_t block_size, uint32_t * p_index, uint32_t job_count) {
+
+    pthread_t threads[BLOCKS_JOBS_MAX];
+    uint32_t  thread_count = 0;
+    uint32_t  out_len = 0;
+    uint32_t  c;
+    uint8_t * p_tmp;
+
+    block_count = (size_in + block_size - 1) / block_size;
+    p_blocks = calloc(block_count, sizeof(block_item));
+    if (!p_blocks)
+        return 0;
+
+    block_compress = compress_func;
+    p_block_in = inBuf;
+    block_in_size = size_in;
+    block_in_len = block_size;
+    block_next = 0;
+
+    if (job_count == BATCH_JOBS_AUTO)
+        job_count = batch_get_cpu_count();
+    if (job_count > BLOCKS_JOBS_MAX) job_count = BLOCKS_JOBS_MAX;
+    if (job_count > block_count)     job_count = block_count;
+
+    // This thread is one of the workers, so start one less
+    for (c = 1; c < job_count; c++) {
+        if (pthread_create(&threads[thread_count], NULL, blocks_worker, NULL) == 0)
+            thread_count++;
+    }
+    blocks_worker(NULL);
+    for (c = 0; c < thread_count; c++)
+        pthread_join(threads[c], NULL);
+
+    // Join the blocks in order
+    for (c = 0; c < block_count; c++) {
+        if (p_blocks[c].size_out == 0) {
+            out_len = 0;
+            break;
+        }
+        if ((out_len + p_blocks[c].size_out) > size_out) {
+            size_out = (out_len + p_blocks[c].size_out) * 2;
+            p_tmp = realloc(*pp_outBuf, size_out);
+            if (!p_tmp) {
+                out_len = 0;
+                break;
+            }
+            *pp_outBuf = p_tmp;
+        }
+        p_index[c] = out_len;
+        memcpy(*pp_outBuf + out_len, p_blocks[c].p_buf_out, p_blocks[c].size_out);
+        out_len += p_blocks[c].size_out;
+    }
+
+    for (c = 0; c < block_count; c++)
+        free(p_blocks[c].p_buf_out);
+    free(p_blocks);
+    p_blocks = NULL;
+
+    return out_len;
+}
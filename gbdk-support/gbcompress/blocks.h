@@ -0,0 +1,13 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _BLOCKS_H
+#define _BLOCKS_H
+
+#include "batch.h"
+
+uint32_t blocks_compress(batch_convert_func compress_func, uint8_t * inBuf, uint32_t size_in,
+                         uint8_t ** pp_outBuf, uint32_t size_out,
+                         uint32_t block_size, uint32_t * p_index, uint32_t job_count);
+
+#endif // _BLOCKS_H
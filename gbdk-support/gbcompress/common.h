@@ -6,4 +6,11 @@
 #define BANK_NUM_ROM_MIN   1
 #define BANK_NUM_ROM_MAX   511
 
+// Per-thread storage for compressor working state (used by batch mode)
+#if defined(_MSC_VER)
+    #define THREAD_LOCAL __declspec(thread)
+#else
+    #define THREAD_LOCAL __thread
+#endif
+
 #endif // _COMMON_H
@@ -0,0 +1,174 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// --deps and --skip-if-unchanged
+//
+// The files written are recorded so a make rule (<outfile>.d) can list
+// them depending on the input, and so the stamp (<outfile>.stamp) can
+// tell if they still exist. The stamp also has a hash of the input,
+// the options and the build of gbcompress, if those are the same the
+// outputs are not written again.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "files.h"
+#include "deps.h"
+
+#define DEPS_OUTPUTS_MAX 8  // The output, its .h and its .idx are the most so far
+#define DEPS_LINE_MAX    4096
+
+static bool   track_outputs = false;
+static char * p_outputs[DEPS_OUTPUTS_MAX];
+static int    output_count = 0;
+
+
+// Only enabled outside of --batch, where the files are written from several threads
+void deps_track_outputs(void) {
+
+    track_outputs = true;
+}
+
+
+void deps_add_output(const char * filename) {
+
+    int c;
+
+    if ((!track_outputs) || (output_count == DEPS_OUTPUTS_MAX))
+        return;
+    for (c = 0; c < output_count; c++)
+        if (strcmp(p_outputs[c], filename) == 0)
+            return;
+    p_outputs[output_count] = malloc(strlen(filename) + 1);
+    if (p_outputs[output_count])
+        strcpy(p_outputs[output_count++], filename);
+}
+
+
+// FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const uint8_t * p_data, size_t len) {
+
+    while (len--)
+        hash = (hash ^ *p_data++) * 0x100000001b3ull;
+    return hash;
+}
+
+
+// Hashes the options, the input file and the build of gbcompress into hash_str (17 chars)
+// Returns false if the input can't be read
+bool deps_hash_inputs(int argc, char * argv[], const char * filename_in, char * hash_str) {
+
+    uint64_t  hash = 0xcbf29ce484222325ull;
+    uint8_t * p_buf;
+    uint32_t  size;
+    int       i;
+
+    hash = hash_bytes(hash, (const uint8_t *)(__DATE__ " " __TIME__), strlen(__DATE__ " " __TIME__));
+    // -v only changes the messages, not the output
+    for (i = 1; i < argc; i++)
+        if (strcmp(argv[i], "-v") != 0)
+            hash = hash_bytes(hash, (const uint8_t *)argv[i], strlen(argv[i]) + 1);
+
+    p_buf = file_read_into_buffer((char *)filename_in, &size);
+    if (!p_buf)
+        return false;
+    hash = hash_bytes(hash, p_buf, size);
+    free(p_buf);
+
+    snprintf(hash_str, 17, "%016llx", (unsigned long long)hash);
+    return true;
+}
+
+
+static void strip_newline(char * str) {
+
+    size_t len = strlen(str);
+
+    while ((len) && ((str[len - 1] == '\n') || (str[len - 1] == '\r')))
+        str[--len] = '\0';
+}
+
+
+// The stamp has the hash on the first line, then the files which were written.
+// The outputs are up to date if the hash is the same and they all still exist
+bool deps_stamp_unchanged(const char * filename_stamp, const char * hash_str) {
+
+    char   line[DEPS_LINE_MAX];
+    FILE * file_stamp = fopen(filename_stamp, "r");
+    FILE * file_out;
+    bool   unchanged = false;
+
+    if (!file_stamp)
+        return false;
+
+    if (fgets(line, sizeof(line), file_stamp)) {
+        strip_newline(line);
+        unchanged = (strcmp(line, hash_str) == 0);
+        while ((unchanged) && (fgets(line, sizeof(line), file_stamp))) {
+            strip_newline(line);
+            file_out = fopen(line, "rb");
+            if (file_out)
+                fclose(file_out);
+            else
+                unchanged = false;
+        }
+    }
+    fclose(file_stamp);
+    return unchanged;
+}
+
+
+bool deps_write_stamp(const char * filename_stamp, const char * hash_str) {
+
+    FILE * file_stamp = fopen(filename_stamp, "w");
+    int    c;
+
+    if (!file_stamp) {
+        printf("gbcompress: Error: Failed to open output file: %s\n", filename_stamp);
+        return false;
+    }
+    fprintf(file_stamp, "%s\n", hash_str);
+    for (c = 0; c < output_count; c++)
+        fprintf(file_stamp, "%s\n", p_outputs[c]);
+    fclose(file_stamp);
+    return true;
+}
+
+
+// Make escapes spaces in file names with a backslash and $ as $$
+static void write_escaped(FILE * file_out, const char * filename) {
+
+    for (; *filename; filename++) {
+        if (*filename == ' ')      fputs("\\ ", file_out);
+        else if (*filename == '$') fputs("$$", file_out);
+        else                       fputc(*filename, file_out);
+    }
+}
+
+
+// Writes a make rule with the outputs depending on the input, and an empty
+// rule for the input so make doesn't fail when it is removed (like gcc -MP)
+bool deps_write_dep_file(const char * filename_dep, const char * filename_in) {
+
+    FILE * file_dep = fopen(filename_dep, "w");
+    int    c;
+
+    if (!file_dep) {
+        printf("gbcompress: Error: Failed to open output file: %s\n", filename_dep);
+        return false;
+    }
+    for (c = 0; c < output_count; c++) {
+        write_escaped(file_dep, p_outputs[c]);
+        fputc(' ', file_dep);
+    }
+    fputs(": ", file_dep);
+    write_escaped(file_dep, filename_in);
+    fputs("\n\n", file_dep);
+    write_escaped(file_dep, filename_in);
+    fputs(":\n", file_dep);
+    fclose(file_dep);
+    return true;
+}
@@ -0,0 +1,15 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _DEPS_H
+#define _DEPS_H
+
+void deps_track_outputs(void);
+void deps_add_output(const char * filename);
+
+bool deps_hash_inputs(int argc, char * argv[], const char * filename_in, char * hash_str);
+bool deps_stamp_unchanged(const char * filename_stamp, const char * hash_str);
+bool deps_write_stamp(const char * filename_stamp, const char * hash_str);
+bool deps_write_dep_file(const char * filename_dep, const char * filename_in);
+
+#endif // _DEPS_H
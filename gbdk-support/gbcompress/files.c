@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "deps.h"
+
 
 
 // Read from a file into a buffer (will allocate needed memory)
@@ -47,6 +49,8 @@ bool file_write_from_buffer(char * filename, uint8_t * p_buf, uint32_t data_len)
     size_t wrote_bytes;
     FILE * file_out = fopen(filename, "wb");
 
+    deps_add_output(filename);
+
     if (file_out) {
         if (data_len == fwrite(p_buf, 1, data_len, file_out))
             status = true;
@@ -105,6 +109,7 @@ bool file_write_from_buffer_char(char * filename, char * p_buf, uint32_t data_le
     size_t wrote_bytes;
     FILE * file_out = fopen(filename, "w");
 
+    deps_add_output(filename);
     if (file_out) {
         if (data_len == fwrite(p_buf, 1, data_len, file_out))
             status = true;
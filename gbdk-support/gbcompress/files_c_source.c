@@ -8,14 +8,14 @@
 #include "common.h"
 #include "files.h"
 
-#define STR_FFWD_MATCH_ANY NULL
+#include "files_c_source.h"
+#include "deps.h"
 
-#define BUF_DEFAULT_SIZE 20000
-#define BUF_GROW_SIZE    10000
 
-
-static uint32_t size_compressed = 0;
-static uint32_t size_decompressed = 0;
+static THREAD_LOCAL uint32_t size_compressed = 0;
+static THREAD_LOCAL uint32_t size_decompressed = 0;
+static THREAD_LOCAL uint32_t * p_record_index = NULL;
+static THREAD_LOCAL uint32_t record_index_count = 0;
 
 
 void c_source_set_sizes(uint32_t size_compressed_in, uint32_t size_decompressed_in) {
@@ -24,91 +24,218 @@ void c_source_set_sizes(uint32_t size_compressed_in, uint32_t size_decompressed_
 }
 
 
-// Search for a character in a string
-//
-// Terminate search if:
-// * any non-allowed character was found (str_chars_allowed, NULL for allow any chars)
-// * end of string is reached (by terminator or length)
-//
-static char * str_ffwd_to(char * str_in, uint32_t * max_len, char char_match, char * str_chars_allowed) {
+// Optional record offset index written after the data as <var_name>_index[]
+// Pass NULL to turn it off again
+void c_source_set_index(uint32_t * p_index, uint32_t count) {
+    p_record_index = p_index;
+    record_index_count = (p_index) ? count : 0;
+}
+
+
+static bool is_space(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+static bool is_ident(char c) {
+    return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '_');
+}
+
+static int hex_value(char c) {
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    return -1;
+}
 
-    char str_cur[2] = " \0"; // current character to test, for strpbrk
 
-    while ((*max_len) && (*str_in != '\0')) {
+// Skip forward while the characters are in str_chars_allowed, up to char_match
+//
+// Returns NULL if any other character or the end is reached first
+//
+static const char * str_ffwd_to(const char * str_in, const char * str_end, char char_match, const char * str_chars_allowed) {
 
-        str_cur[0] = *str_in;
+    while (str_in < str_end) {
         if (*str_in == char_match)
             return str_in;
-        else if (str_chars_allowed) {
-            if (strpbrk(str_cur, str_chars_allowed) == NULL) {
-                // signal failure if any non-allowed character was found
-                return NULL;
-            }
-        }
-
+        else if ((*str_in == '\0') || (strchr(str_chars_allowed, *str_in) == NULL))
+            return NULL;
         str_in++;
-        (*max_len)--;
     }
 
     return NULL;
 }
 
 
-
 // Convert an array of comma delimited numbers into a buffer
 //
-// If conversion fails: returns NULL, *p_ret_size == 0
+// Numbers are hex (0x..), octal (0..) or decimal and are truncated to
+// 8 bits, entries which aren't a number are skipped (same as strtol()).
+// The buffer is allocated for the number of entries, counted up front.
 //
-static uint8_t * str_array_to_buf(char * str_in, uint32_t * p_ret_len) {
-
-    uint32_t  buf_size  = BUF_DEFAULT_SIZE;
-    uint8_t * p_buf     = malloc(buf_size);
-    uint8_t * p_buf_last;
-    char    * end_ptr;
+// If conversion fails: returns NULL, *p_ret_len == 0
+//
+static uint8_t * str_array_to_buf(const char * str_in, const char * str_end, uint32_t * p_ret_len) {
+
+    const char * str_cur;
+    uint32_t  entries = 1;
+    uint8_t * p_buf;
+    uint8_t   value;
+    int       digit;
+
+    *p_ret_len = 0;
+
+    for (str_cur = str_in; (str_cur = memchr(str_cur, ',', str_end - str_cur)) != NULL; str_cur++)
+        entries++;
+    p_buf = malloc(entries);
+    if (p_buf == NULL)
+        return NULL;
+
+    str_cur = str_in;
+    while (str_cur < str_end) {
+
+        while ((str_cur < str_end) && is_space(*str_cur))
+            str_cur++;
+
+        if ((str_cur < str_end) && (*str_cur >= '0') && (*str_cur <= '9')) {
+            value = 0;
+            if (*str_cur != '0') {
+                for (; (str_cur < str_end) && (*str_cur >= '0') && (*str_cur <= '9'); str_cur++)
+                    value = (uint8_t)((value * 10) + (*str_cur - '0'));
+            } else if (((str_cur + 2) < str_end) && ((str_cur[1] == 'x') || (str_cur[1] == 'X')) && (hex_value(str_cur[2]) >= 0)) {
+                for (str_cur += 2; (str_cur < str_end) && ((digit = hex_value(*str_cur)) >= 0); str_cur++)
+                    value = (uint8_t)((value << 4) | digit);
+            } else {
+                for (; (str_cur < str_end) && (*str_cur >= '0') && (*str_cur <= '7'); str_cur++)
+                    value = (uint8_t)((value << 3) | (*str_cur - '0'));
+            }
+            p_buf[(*p_ret_len)++] = value;
+        }
 
-    // Read value at a time from a string buffer
-    // (strtok will replace the , chars with \0 on each split)
-    char * str_cur = strtok(str_in,",");
+        // Anything else up to the next comma is ignored
+        while ((str_cur < str_end) && (*str_cur != ','))
+            str_cur++;
+        str_cur++;
+    }
 
-    if (p_buf) {
+    if (*p_ret_len == 0) {
+        free(p_buf);
+        return NULL;
+    }
+    return p_buf;
+}
 
-        // Start with size zero
-        *p_ret_len = 0;
 
-        // Loop as long as strtok returns comma separated items
-        while (str_cur != NULL) {
+// Find the next C source formatted array, "name[size] = { values }"
+//
+// Returns a pointer past the end of the array, or NULL if there are no more.
+// On return the variable name is in str_name and the values are
+// between *p_values_start and *p_values_end
+//
+static const char * c_array_find(const char * str_start, const char * str_cur, const char * str_end, char * str_name,
+                                 const char ** p_values_start, const char ** p_values_end) {
+
+    const char * str_bracket;
+    const char * str_name_end;
+    const char * str_array;
+    size_t len;
+
+    while ((str_bracket = memchr(str_cur, '[', str_end - str_cur)) != NULL) {
+
+        str_cur = str_bracket + 1;
+
+        // Find Array closing bracket `]`, start of array `{` and end of array `}`
+        str_array = str_ffwd_to(str_cur, str_end, ']', "xX0123456789ABCDEFabcdef\t\n\r ");
+        if (str_array) str_array = str_ffwd_to(str_array + 1, str_end, '{', "\t\n\r =");
+        if (str_array == NULL)
+            continue;
+        *p_values_start = str_array + 1;
+        str_array = str_ffwd_to(str_array + 1, str_end, '}', "xX0123456789ABCDEFabcdef,\t\n\r ");
+        if (str_array == NULL)
+            continue;
+        *p_values_end = str_array;
+
+        // The variable name is the identifier before the `[`
+        str_name_end = str_bracket;
+        while ((str_name_end > str_start) && is_space(str_name_end[-1]))
+            str_name_end--;
+        for (len = 0; ((str_name_end - len) > str_start) && is_ident(str_name_end[-1 - (long)len]); len++);
+        if (len >= C_SOURCE_NAME_MAX) len = C_SOURCE_NAME_MAX - 1;
+        memcpy(str_name, str_name_end - len, len);
+        str_name[len] = '\0';
+
+        return str_array + 1;
+    }
 
-            // Grow buffer if needed
-            if ((*p_ret_len) >= buf_size)  {
+    return NULL;
+}
 
-                buf_size += BUF_GROW_SIZE;
-                p_buf_last = p_buf;
-                p_buf = (uint8_t *)realloc(p_buf, buf_size);
 
-                // Exit if realloc failed
-                if (p_buf == NULL) {
-                    *p_ret_len = 0;
-                    free(p_buf_last);
-                    return NULL;
-                }
-            }
+// Read all C source formatted arrays in a file with a single pass
+//
+// Arrays which fail to convert are left out. Free the result with c_source_arrays_free()
+//
+// Returns the number of arrays, 0 if none were found or reading the file didn't succeed
+//
+uint32_t file_read_c_input_arrays(char * filename, c_source_array ** pp_arrays) {
 
-            // Store current value
-            p_buf[ *p_ret_len ] = (uint8_t)strtol(str_cur, &end_ptr, 0);
+    char * filedata = NULL;
+    uint32_t  file_size;
+    uint32_t  count = 0;
+    uint32_t  alloc_count = 0;
+    const char * str_cur;
+    const char * str_end;
+    const char * values_start;
+    const char * values_end;
+    c_source_array * p_arrays = NULL;
+    c_source_array * p_tmp;
+    c_source_array array;
+
+    *pp_arrays = NULL;
 
-            // Only advance data buffer if conversion didn't fail
-            if (str_cur != end_ptr)
-                (*p_ret_len)++;
+    filedata = file_read_into_buffer_char(filename, &file_size);
 
-            // Read next value (strtok maintains state of last call)
-            str_cur = strtok(NULL,",");
+    if (filedata) {
+        str_cur = filedata;
+        str_end = filedata + file_size;
+
+        while ((str_cur = c_array_find(filedata, str_cur, str_end, array.name, &values_start, &values_end)) != NULL) {
+
+            // If conversion fails: array.p_data == NULL, array.size == 0
+            array.p_data = str_array_to_buf(values_start, values_end, &array.size);
+            if (array.p_data == NULL)
+                continue;
+
+            if (count == alloc_count) {
+                alloc_count = (alloc_count) ? (alloc_count * 2) : 4;
+                p_tmp = realloc(p_arrays, alloc_count * sizeof(c_source_array));
+                if (p_tmp == NULL) {
+                    free(array.p_data);
+                    break;
+                }
+                p_arrays = p_tmp;
+            }
+            p_arrays[count++] = array;
         }
+
+        // Free file data if allocated
+        free(filedata);
+        filedata = NULL;
     }
 
-    return p_buf;
+    *pp_arrays = p_arrays;
+    return count;
 }
 
 
+void c_source_arrays_free(c_source_array * p_arrays, uint32_t count) {
+
+    uint32_t c;
+
+    for (c = 0; c < count; c++)
+        free(p_arrays[c].p_data);
+    free(p_arrays);
+}
+
 
 // Read from a file into a buffer, find first C source formatted
 // array and parse it into another buffer (will allocate needed memory)
@@ -119,9 +246,9 @@ uint8_t * file_read_c_input_into_buffer(char * filename, uint32_t *p_ret_size) {
 
     char * filedata = NULL;
     uint32_t  file_size;
-
-    char * str_c_array = NULL;
-    char * str_c_array_start = NULL;
+    char name[C_SOURCE_NAME_MAX];
+    const char * values_start;
+    const char * values_end;
     uint8_t * p_array_data = NULL;
 
     *p_ret_size = 0;
@@ -129,33 +256,9 @@ uint8_t * file_read_c_input_into_buffer(char * filename, uint32_t *p_ret_size) {
     filedata = file_read_into_buffer_char(filename, &file_size);
 
     if (filedata) {
-        str_c_array = filedata;
-
-        // Find array opening bracket `[`
-        str_c_array = str_ffwd_to(str_c_array, &file_size, '[', STR_FFWD_MATCH_ANY);
-        if (str_c_array) {
-            // Find Array closing bracket `]`
-            str_c_array = str_ffwd_to(str_c_array, &file_size, ']', "[xX0123456789ABCDEFabcdef\t\n\r ");
-            if (str_c_array) {
-                // Find Start or array
-                str_c_array = str_ffwd_to(str_c_array, &file_size, '{', "]\t\n\r =");
-                if (str_c_array) {
-                    // Save start of array
-                    str_c_array_start = str_c_array + 1;
-
-                    // Find end of array
-                    str_c_array = str_ffwd_to(str_c_array, &file_size, '}', "{xX0123456789ABCDEFabcdef,\t\n\r ");
-                    if (str_c_array) {
-                        // Terminate string at end of array
-                        *str_c_array = '\0';
-
-                        // If conversion fails: p_array_data == NULL, p_ret_size == 0
-                        p_array_data = str_array_to_buf(str_c_array_start, p_ret_size);
-
-                        // printf("C array length in = %d", *p_ret_size);
-                    }
-                }
-            }
+        if (c_array_find(filedata, filedata, filedata + file_size, name, &values_start, &values_end)) {
+            // If conversion fails: p_array_data == NULL, p_ret_size == 0
+            p_array_data = str_array_to_buf(values_start, values_end, p_ret_size);
         }
 
         // Free file data if allocated
@@ -173,6 +276,46 @@ uint8_t * file_read_c_input_into_buffer(char * filename, uint32_t *p_ret_size) {
 
 
 
+// Writes the .h for a .c or .s output file, if the filename ends in .<ext>
+//
+static void file_write_c_header(char * filename, char ext, char * var_name, bool var_is_const, uint16_t bank_num) {
+
+    size_t len = strlen(filename);
+    FILE * file_out;
+
+    if ((len < 2) || (filename[len - 2] != '.') || ((filename[len - 1] | 0x20) != ext))
+        return;
+
+    // Replace file extension
+    filename[len - 1] = 'h';
+
+    file_out = fopen(filename, "w");
+    deps_add_output(filename);
+
+    if (file_out) {
+
+        // If Bank Num is set add a .h bank ref
+        if (bank_num != BANK_NUM_ROM_UNSET) {
+            fprintf(file_out, "#include <gbdk/metasprites.h>\n\n");
+            fprintf(file_out, "BANKREF_EXTERN(%s)\n\n", var_name);
+        }
+
+        fprintf(file_out, "\n\n#define %s_sz_comp %d\n", var_name, size_compressed);
+        fprintf(file_out, "#define %s_sz_decomp %d\n", var_name, size_decompressed);
+
+        // array entry with variable name
+        fprintf(file_out, "\n\nextern %s unsigned char %s[];\n\n", (var_is_const) ? "const" : "", var_name);
+
+        if (record_index_count) {
+            fprintf(file_out, "#define %s_index_count %d\n", var_name, record_index_count);
+            fprintf(file_out, "extern %s unsigned int %s_index[];\n\n", (var_is_const) ? "const" : "", var_name);
+        }
+
+        fclose(file_out);
+    }
+}
+
+
 // Writes a buffer to a file in C source format
 // Adds a matching .h if possible
 //
@@ -183,6 +326,8 @@ bool file_write_c_output_from_buffer(char * filename, uint8_t * p_buf, uint32_t
     FILE * file_out = fopen(filename, "w");
     int i;
 
+    deps_add_output(filename);
+
     if (file_out) {
         // C Source array output
 
@@ -210,43 +355,91 @@ bool file_write_c_output_from_buffer(char * filename, uint8_t * p_buf, uint32_t
                 fprintf(file_out, ", ");
         }
         fprintf(file_out, "\n};\n\n");
+
+        // Record offset index array
+        if (record_index_count) {
+            fprintf(file_out, "%s unsigned int %s_index[] = {", (var_is_const) ? "const" : "", var_name);
+            for (i = 0; i < record_index_count; i++) {
+                if ((i % 8) == 0)
+                    fprintf(file_out, "\n    ");
+                fprintf(file_out, "0x%.4X", p_record_index[i]);
+                if (i != record_index_count - 1)
+                    fprintf(file_out, ", ");
+            }
+            fprintf(file_out, "\n};\n\n");
+        }
         status = true;
 
         fclose(file_out);
 
 
         // Create matching .h header file output, if file ends in .c or .C
-        if (strlen(filename) >= 2) {
-            if ((strcmp(&filename[strlen(filename) - 2],".c") == 0) ||
-                (strcmp(&filename[strlen(filename) - 2],".C") == 0)) {
+        file_write_c_header(filename, 'c', var_name, var_is_const, bank_num);
+    } else {
+        printf("gbcompress: Error: Failed to open output file: %s\n", filename);
+    }
 
-                // Replace file extension
-                filename[strlen(filename) - 2] = '.';
-                filename[strlen(filename) - 1] = 'h';
+    return status;
+}
 
-                FILE * file_out = fopen(filename, "w");
 
-                if (file_out) {
+// Writes a buffer to a file as sdas assembler source, so it
+// doesn't need to go through the C compiler. Adds a matching .h
+//
+// The data goes in _CODE_<bank_num>, or _CODE if it's not set. With
+// bank 255 bankpack assigns the bank, and updates ___bank_<var_name>
+// the same way as for the BANKREF() of C source output
+//
+bool file_write_asm_output_from_buffer(char * filename, uint8_t * p_buf, uint32_t data_len, char * var_name, uint16_t bank_num) {
 
-                    // If Bank Num is set add a .h bank ref
-                    if (bank_num != BANK_NUM_ROM_UNSET) {
-                        fprintf(file_out, "#include <gbdk/metasprites.h>\n\n");
-                        fprintf(file_out, "BANKREF_EXTERN(%s)\n\n", var_name);
-                    }
+    FILE * file_out = fopen(filename, "w");
+    uint32_t i;
 
-                    fprintf(file_out, "\n\n#define %s_sz_comp %d\n", var_name, size_compressed);
-                    fprintf(file_out, "#define %s_sz_decomp %d\n", var_name, size_decompressed);
+    deps_add_output(filename);
 
-                    // array entry with variable name
-                    fprintf(file_out, "\n\nextern %s unsigned char %s[];\n\n", (var_is_const) ? "const" : "", var_name);
+    if (!file_out) {
+        printf("gbcompress: Error: Failed to open output file: %s\n", filename);
+        return false;
+    }
 
-                    fclose(file_out);
-                }
-            }
+    fprintf(file_out, "\t.module %s\n\n", var_name);
+    fprintf(file_out, "\t.globl _%s\n", var_name);
+    if (record_index_count)
+        fprintf(file_out, "\t.globl _%s_index\n", var_name);
+
+    if (bank_num != BANK_NUM_ROM_UNSET) {
+        fprintf(file_out, "\t.globl ___bank_%s\n", var_name);
+        fprintf(file_out, "\n___bank_%s = %d\n", var_name, bank_num);
+        fprintf(file_out, "\n\t.area _CODE_%d\n", bank_num);
+    } else
+        fprintf(file_out, "\n\t.area _CODE\n");
+
+    fprintf(file_out, "\n_%s::", var_name);
+    for (i = 0; i < data_len; i++) {
+        // 16 bytes per line
+        if ((i % 16) == 0)
+            fprintf(file_out, "\n\t.db 0x%.2X", p_buf[i]);
+        else
+            fprintf(file_out, ",0x%.2X", p_buf[i]);
+    }
+    fprintf(file_out, "\n");
+
+    // Record offset index array
+    if (record_index_count) {
+        fprintf(file_out, "\n_%s_index::", var_name);
+        for (i = 0; i < record_index_count; i++) {
+            if ((i % 8) == 0)
+                fprintf(file_out, "\n\t.dw 0x%.4X", p_record_index[i]);
+            else
+                fprintf(file_out, ",0x%.4X", p_record_index[i]);
         }
-    } else {
-        printf("gbcompress: Error: Failed to open output file: %s\n", filename);
+        fprintf(file_out, "\n");
     }
 
-    return status;
+    fclose(file_out);
+
+    // Create matching .h header file output, if file ends in .s or .S
+    file_write_c_header(filename, 's', var_name, true, bank_num);
+
+    return true;
 }
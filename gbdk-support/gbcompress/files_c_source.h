@@ -1,9 +1,22 @@
 #ifndef _FILES_C_SOURCE_H
 #define _FILES_C_SOURCE_H
 
+#define C_SOURCE_NAME_MAX 256
+
+// One array read from a C source file
+typedef struct c_source_array {
+    char      name[C_SOURCE_NAME_MAX];
+    uint8_t * p_data;
+    uint32_t  size;
+} c_source_array;
+
 void c_source_set_sizes(uint32_t, uint32_t);
+void c_source_set_index(uint32_t * p_index, uint32_t count);
 
 bool file_write_c_output_from_buffer(char *, uint8_t *, uint32_t, char *, bool, uint16_t bank_num);
+bool file_write_asm_output_from_buffer(char *, uint8_t *, uint32_t, char *, uint16_t bank_num);
 uint8_t * file_read_c_input_into_buffer(char * filename, uint32_t *ret_size);
+uint32_t file_read_c_input_arrays(char * filename, c_source_array ** pp_arrays);
+void c_source_arrays_free(c_source_array * p_arrays, uint32_t count);
 
 #endif // _FILES_C_SOURCE_H
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "common.h"
 #include "gbcompress.h"
 
 const uint8_t len_mask    = 0x3F;
@@ -19,14 +20,35 @@ const uint8_t token_mask  = 0xC0;
 
 const uint8_t EOFMarker  = 0x00;
 
-uint8_t * FinBuf      = NULL;
-uint32_t  Fsize_in    = 0;
-uint32_t  FinIndex    = 0;
-
-uint8_t ** pp_FoutBuf = NULL;
-uint8_t * FoutBuf     = NULL;
-uint32_t  Fsize_out   = 0;
-uint32_t  FoutIndex   = 0;
+static THREAD_LOCAL uint8_t * FinBuf      = NULL;
+static THREAD_LOCAL uint32_t  Fsize_in    = 0;
+static THREAD_LOCAL uint32_t  FinIndex    = 0;
+
+static THREAD_LOCAL uint8_t ** pp_FoutBuf = NULL;
+static THREAD_LOCAL uint8_t * FoutBuf     = NULL;
+static THREAD_LOCAL uint32_t  Fsize_out   = 0;
+static THREAD_LOCAL uint32_t  FoutIndex   = 0;
+
+// Hash chain match finder for back reference "strings"
+//
+// Every input position is linked into a chain of earlier positions
+// which share the same hash of their first MATCH_MIN_LEN bytes.
+// Only those positions have to be tested instead of the entire window.
+//
+// Shorter matches never change which token gets written
+// (u8 runs need > 2 bytes, strings need > 3 bytes) so they can be skipped.
+#define MATCH_MIN_LEN    3u
+#define MATCH_MAX_LEN    64u
+#define MATCH_WINDOW     0xFFFFu
+#define MATCH_HASH_BITS  16u
+#define MATCH_HASH_SIZE  (1u << MATCH_HASH_BITS)
+#define MATCH_NONE       0xFFFFFFFFu
+
+static THREAD_LOCAL uint32_t * p_match_head      = NULL;  // Most recent position for each hash
+static THREAD_LOCAL uint32_t * p_match_prev      = NULL;  // Previous position with the same hash, per input position
+static THREAD_LOCAL uint32_t   match_insert_pos  = 0;     // Next input position to be added to the chains
+static THREAD_LOCAL bool       match_any_longest = false; // Stop at first longest match instead of finding the oldest one
+static uint32_t                match_depth_max   = GBCOMPRESS_CHAIN_DEPTH_UNLIMITED;
 
 
 static void check_write_size(uint8_t len) {
@@ -130,6 +152,122 @@ static void flush_trash(uint32_t * byte_pos, uint32_t * trash_len) {
 }
 
 
+// Sets maximum number of hash chain entries tested per back reference search
+// GBCOMPRESS_CHAIN_DEPTH_UNLIMITED gives the same output as an exhaustive search
+void gbcompress_set_chain_depth(uint32_t depth_max) {
+
+    match_depth_max = depth_max;
+}
+
+
+static inline uint32_t match_hash(uint32_t byte_pos) {
+
+    uint32_t val = ((uint32_t)FinBuf[byte_pos] << 16) |
+                   ((uint32_t)FinBuf[byte_pos + 1] << 8) |
+                    (uint32_t)FinBuf[byte_pos + 2];
+
+    return (val * 2654435761u) >> (32u - MATCH_HASH_BITS);
+}
+
+
+static bool match_init(void) {
+
+    uint32_t c;
+
+    p_match_head = malloc(MATCH_HASH_SIZE * sizeof(uint32_t));
+    p_match_prev = malloc((Fsize_in ? Fsize_in : 1) * sizeof(uint32_t));
+    if (!p_match_head || !p_match_prev) {
+        printf("Error: Failed to allocate memory for match finder!\n");
+        return false;
+    }
+
+    for (c = 0; c < MATCH_HASH_SIZE; c++)
+        p_match_head[c] = MATCH_NONE;
+    match_insert_pos = 0;
+
+    return true;
+}
+
+
+static void match_cleanup(void) {
+
+    if (p_match_head) free(p_match_head);
+    if (p_match_prev) free(p_match_prev);
+    p_match_head = NULL;
+    p_match_prev = NULL;
+}
+
+
+// Find the longest back reference string for the current input position
+//
+// On equal lengths the oldest (furthest back) match is used,
+// which is the same result as testing every position in the window
+// from oldest to newest and only keeping longer matches.
+static void match_find(uint32_t * p_str_len, uint32_t * p_str_back_offset) {
+
+    uint32_t cand;
+    uint32_t dist;
+    uint32_t len;
+    uint32_t len_max;
+    uint32_t depth = 0;
+    uint32_t best_len = 0;
+    uint32_t best_offset = 0;
+    uint32_t hash;
+
+    // Add all positions before the current one to their chains
+    while ((match_insert_pos < FinIndex) && ((match_insert_pos + MATCH_MIN_LEN) <= Fsize_in)) {
+        hash = match_hash(match_insert_pos);
+        p_match_prev[match_insert_pos] = p_match_head[hash];
+        p_match_head[hash] = match_insert_pos;
+        match_insert_pos++;
+    }
+
+    if ((FinIndex + MATCH_MIN_LEN) <= Fsize_in) {
+
+        cand = p_match_head[match_hash(FinIndex)];
+
+        // Chains are ordered newest to oldest, stop once outside the window
+        while ((cand != MATCH_NONE) && ((FinIndex - cand) <= MATCH_WINDOW)) {
+
+            dist = FinIndex - cand;
+
+            // Matches can't reach the current position (no overlap),
+            // the end of the buffer, or be longer than 64 bytes
+            len_max = Fsize_in - FinIndex;
+            if (len_max > dist)          len_max = dist;
+            if (len_max > MATCH_MAX_LEN) len_max = MATCH_MAX_LEN;
+
+            // Skip candidates which can't at least equal the best match so far
+            if ((len_max >= best_len) &&
+                ((best_len == 0) || (FinBuf[cand + best_len - 1] == FinBuf[FinIndex + best_len - 1]))) {
+
+                len = 0;
+                while ((len < len_max) && (FinBuf[cand + len] == FinBuf[FinIndex + len]))
+                    len++;
+
+                if ((len >= MATCH_MIN_LEN) && (len >= best_len)) {
+                    best_len = len;
+                    best_offset = dist;
+
+                    // Nothing longer is possible when the full length was reached
+                    if (match_any_longest && (len == MATCH_MAX_LEN || len == (Fsize_in - FinIndex)))
+                        break;
+                }
+            }
+
+            depth++;
+            if ((match_depth_max != GBCOMPRESS_CHAIN_DEPTH_UNLIMITED) && (depth >= match_depth_max))
+                break;
+
+            cand = p_match_prev[cand];
+        }
+    }
+
+    *p_str_len = best_len;
+    *p_str_back_offset = best_offset;
+}
+
+
 // Convert buffer inBuf to gbcompress rle encoding and write out to outBuf
 // Returns converted length
 uint32_t gbcompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
@@ -142,9 +280,7 @@ uint32_t gbcompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf,
     uint32_t  rle_str_len = 0;  // r_rs
     uint32_t  trash_len   = 0;  // tb (by "trash" the original author meant, "non-rle sequence of bytes")
 
-    uint32_t  rle_str_start;       // rr
     uint32_t  rle_str_back_offset; // sr (this is signed in original code, handled differently to be unsigned now)
-    uint32_t  rle_str_len_work;    // rl
 
     FinBuf     = inBuf;
     Fsize_in   = size_in;
@@ -155,6 +291,11 @@ uint32_t gbcompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf,
     Fsize_out  = size_out;
     FoutIndex = 0;
 
+    if (!match_init()) {
+        match_cleanup();
+        return 0;
+    }
+
     while (FinIndex < Fsize_in) {
 
         // printf("@%3d / %3d = %02x\n", FinIndex, Fsize_in, FinBuf[FinIndex]);
@@ -191,44 +332,9 @@ uint32_t gbcompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf,
         }
 
         // Check for matching sequences starting at current position
-        // against all previous data beginning at start up to 63 bytes max
+        // against all previous data within the 16 bit window up to 64 bytes max
         // (back reference "strings")
-        rle_str_back_offset = 0;
-        rle_str_len = 0;
-        // Max string backreference length is 16 bits unsigned
-        // adjust search start accordingly
-        if (FinIndex > 0xFFFF)
-            rle_str_start = FinIndex - 0xFFFF;
-        else
-            rle_str_start = 0;
-
-        while (rle_str_start < FinIndex) {
-            rle_str_len_work = 0;
-
-            // Check for a matching run at rle_str_start against FinIndex
-            // and save length to rle_str_len_work
-            while ((FinIndex + rle_str_len_work) < Fsize_in) {
-                // Test to see if u8 in current sequence matches the u8 for a previous sequence
-                // Break out of the current sequence if it would reach 64 bytes
-                // or it would reach the current byte pos (and cause an overlap)
-                if ((FinBuf[rle_str_start + rle_str_len_work] == FinBuf[FinIndex + rle_str_len_work]) &&
-                    ((rle_str_start + rle_str_len_work) < FinIndex) &&
-                    (rle_str_len_work < 64)) {
-
-                    rle_str_len_work++;
-                }
-                else break;
-            }
-
-            // If the newly tested sequence length is greater than the previous length
-            // then save the length and store an negative offset to it in rle_str_back_offset
-            if (rle_str_len_work > rle_str_len) {
-                rle_str_back_offset = FinIndex - rle_str_start; // Changed this from neg offset to pos, and gets flipped to negative on writing it out
-                rle_str_len = rle_str_len_work;
-            }
-
-            rle_str_start++;
-        }
+        match_find(&rle_str_len, &rle_str_back_offset);
 
 
         // Write out any rle data if it's ready
@@ -272,11 +378,187 @@ uint32_t gbcompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf,
 
     write_end();
 
+    match_cleanup();
+
     return FoutIndex;
 }
 
 
 
+// Token types used for the optimal parse
+#define PARSE_TRASH 0
+#define PARSE_BYTE  1
+#define PARSE_WORD  2
+#define PARSE_STR   3
+
+#define TOKEN_LEN_MAX 64u // Max count for any token (bytes, words or string length)
+
+
+// Convert buffer inBuf to gbcompress rle encoding using an optimal parse
+// and write out to outBuf. Uses the same token format as gbcompress_buf(),
+// so the output works with the existing decompressors.
+//
+// Instead of picking tokens greedily, the smallest encoding for every
+// position to the end of the buffer is calculated, working backward.
+// Each position considers all lengths of these tokens:
+//   u8 run  : 2 bytes encoded
+//   u16 run : 3 bytes encoded
+//   string  : 3 bytes encoded (longest back reference, and its shorter prefixes)
+//   trash   : 1 + length bytes encoded
+//
+// Returns converted length
+uint32_t gbcompress_buf_optimal(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    uint32_t * p_cost     = NULL; // Encoded size from position to end of input
+    uint8_t  * p_tok_type = NULL; // Best token type at position
+    uint8_t  * p_tok_len  = NULL; // Best token count at position (bytes, words or string length)
+    uint16_t * p_str_off  = NULL; // Back reference offset of longest string at position
+    uint8_t  * p_str_len  = NULL; // Length of longest string at position
+    uint32_t   str_len;
+    uint32_t   str_offset;
+    uint32_t   pos;
+    uint32_t   len;
+    uint32_t   run_max;
+    uint32_t   cost;
+    bool       result = false;
+
+    FinBuf     = inBuf;
+    Fsize_in   = size_in;
+    FinIndex   = 0;
+
+    pp_FoutBuf = pp_outBuf;
+    FoutBuf    = *pp_outBuf;
+    Fsize_out  = size_out;
+    FoutIndex  = 0;
+
+    p_cost     = malloc((size_in + 1) * sizeof(uint32_t));
+    p_tok_type = malloc(size_in + 1);
+    p_tok_len  = malloc(size_in + 1);
+    p_str_off  = malloc((size_in + 1) * sizeof(uint16_t));
+    p_str_len  = malloc(size_in + 1);
+
+    if (p_cost && p_tok_type && p_tok_len && p_str_off && p_str_len && match_init()) {
+
+        // Find the longest back reference for every position first
+        // (the hash chains have to be filled front to back).
+        // Which offset is used doesn't change the size, so any longest match will do.
+        match_any_longest = true;
+        for (FinIndex = 0; FinIndex < Fsize_in; FinIndex++) {
+            match_find(&str_len, &str_offset);
+            p_str_len[FinIndex] = (uint8_t)str_len;
+            p_str_off[FinIndex] = (uint16_t)str_offset;
+        }
+        match_any_longest = false;
+
+        // Only the end of data marker remains after the last byte
+        p_cost[size_in] = 1;
+
+        pos = size_in;
+        while (pos-- > 0) {
+
+            // Trash is always possible, so start with a single byte of it
+            p_cost[pos]     = 2 + p_cost[pos + 1];
+            p_tok_type[pos] = PARSE_TRASH;
+            p_tok_len[pos]  = 1;
+
+            // u8 runs
+            run_max = size_in - pos;
+            if (run_max > TOKEN_LEN_MAX) run_max = TOKEN_LEN_MAX;
+            for (len = 1; (len < run_max) && (FinBuf[pos + len] == FinBuf[pos]); len++);
+            run_max = len;
+            for (len = 2; len <= run_max; len++) {
+                cost = 2 + p_cost[pos + len];
+                if (cost < p_cost[pos]) {
+                    p_cost[pos] = cost;
+                    p_tok_type[pos] = PARSE_BYTE;
+                    p_tok_len[pos] = len;
+                }
+            }
+
+            // u16 runs
+            run_max = (size_in - pos) / 2;
+            if (run_max > TOKEN_LEN_MAX) run_max = TOKEN_LEN_MAX;
+            for (len = 1; (len < run_max) &&
+                          (FinBuf[pos + (len * 2)]     == FinBuf[pos]) &&
+                          (FinBuf[pos + (len * 2) + 1] == FinBuf[pos + 1]); len++);
+            if (run_max == 0) len = 0;
+            run_max = len;
+            for (len = 1; len <= run_max; len++) {
+                cost = 3 + p_cost[pos + (len * 2)];
+                if (cost < p_cost[pos]) {
+                    p_cost[pos] = cost;
+                    p_tok_type[pos] = PARSE_WORD;
+                    p_tok_len[pos] = len;
+                }
+            }
+
+            // Strings, any prefix of the longest match is also a match
+            for (len = MATCH_MIN_LEN; len <= p_str_len[pos]; len++) {
+                cost = 3 + p_cost[pos + len];
+                if (cost < p_cost[pos]) {
+                    p_cost[pos] = cost;
+                    p_tok_type[pos] = PARSE_STR;
+                    p_tok_len[pos] = len;
+                }
+            }
+
+            // Longer trash
+            run_max = size_in - pos;
+            if (run_max > TOKEN_LEN_MAX) run_max = TOKEN_LEN_MAX;
+            for (len = 2; len <= run_max; len++) {
+                cost = 1 + len + p_cost[pos + len];
+                if (cost < p_cost[pos]) {
+                    p_cost[pos] = cost;
+                    p_tok_type[pos] = PARSE_TRASH;
+                    p_tok_len[pos] = len;
+                }
+            }
+        }
+
+        // Now write out the selected tokens from the start
+        FinIndex = 0;
+        while (FinIndex < Fsize_in) {
+            len = p_tok_len[FinIndex];
+            switch (p_tok_type[FinIndex]) {
+                case PARSE_BYTE:
+                    write_byte(len, FinBuf[FinIndex]);
+                    FinIndex += len;
+                    break;
+
+                case PARSE_WORD:
+                    write_word(len, (uint16_t)((FinBuf[FinIndex] << 8) + (uint16_t)FinBuf[FinIndex + 1]));
+                    FinIndex += len * 2;
+                    break;
+
+                case PARSE_STR:
+                    write_string(len, p_str_off[FinIndex]);
+                    FinIndex += len;
+                    break;
+
+                case PARSE_TRASH:
+                    write_trash(len, &FinBuf[FinIndex]);
+                    FinIndex += len;
+                    break;
+            }
+        }
+
+        write_end();
+        result = true;
+    } else
+        printf("Error: Failed to allocate memory for optimal parse!\n");
+
+    match_cleanup();
+    if (p_cost)     free(p_cost);
+    if (p_tok_type) free(p_tok_type);
+    if (p_tok_len)  free(p_tok_len);
+    if (p_str_off)  free(p_str_off);
+    if (p_str_len)  free(p_str_len);
+
+    return (result) ? FoutIndex : 0;
+}
+
+
+
 static void write_single_byte(uint8_t data) {
 
     check_write_size(1);
@@ -397,3 +679,33 @@ uint32_t gbdecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBu
 
     return FoutIndex;
 }
+
+
+// Estimated number of GB CPU cycles (M-cycles, 1.05 MHz) gb_decompress() in
+// libc/targets/sm83/gb_decompress.s takes for inBuf, counted from its loops
+uint32_t gbdecompress_cycles_sm83(uint8_t * inBuf, uint32_t size_in) {
+
+    uint32_t index = 0;
+    uint32_t cycles = 0;
+    uint32_t len;
+    uint8_t  token;
+
+    while (index < size_in) {
+
+        token = inBuf[index++];
+        if (token == EOFMarker) {
+            cycles += 19;
+            break;
+        }
+
+        len = (token & len_mask) + 1;
+        switch (token & token_mask) {
+            case token_byte:  cycles += 21 + (len * 8);  index += 1;   break;
+            case token_word:  cycles += 27 + (len * 21); index += 2;   break;
+            case token_str:   cycles += 41 + (len * 10); index += 2;   break;
+            case token_trash: cycles += 21 + (len * 10); index += len; break;
+        }
+    }
+
+    return cycles;
+}
@@ -5,7 +5,13 @@
 #ifndef _GBCOMPRESS_H
 #define _GBCOMPRESS_H
 
+#define GBCOMPRESS_CHAIN_DEPTH_UNLIMITED 0
+#define GBCOMPRESS_CHAIN_DEPTH_FAST      32
+
+void gbcompress_set_chain_depth(uint32_t depth_max);
 uint32_t gbcompress_buf(uint8_t * inBuf, uint32_t InSize, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t gbcompress_buf_optimal(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
 uint32_t gbdecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t gbdecompress_cycles_sm83(uint8_t * inBuf, uint32_t size_in);
 
 #endif // _GBCOMPRESS_H
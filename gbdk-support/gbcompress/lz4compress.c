@@ -0,0 +1,429 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// LZ4 style compression, tuned for fast decoding on the target CPUs
+//
+// The data is a list of sequences, each one is:
+// * token: upper nibble literal count, lower nibble match length - 4
+//   (a nibble of 15 is followed by more length bytes, added up until one isn't 255)
+// * literal bytes
+// * match offset: 16 bit little endian distance back into the output
+//   (0 marks the end of the data, no match length follows)
+// * match length bytes (if the lower nibble was 15)
+//
+// Matches may overlap the bytes they write, so a short offset repeats a pattern.
+// Unlike the LZ4 block format the end of the data is marked, the decompressed
+// size does not have to be known.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "common.h"
+#include "lz4compress.h"
+
+
+static THREAD_LOCAL uint8_t * FinBuf      = NULL;
+static THREAD_LOCAL uint32_t  Fsize_in    = 0;
+static THREAD_LOCAL uint32_t  FinIndex    = 0;
+
+static THREAD_LOCAL uint8_t ** pp_FoutBuf = NULL;
+static THREAD_LOCAL uint8_t * FoutBuf     = NULL;
+static THREAD_LOCAL uint32_t  Fsize_out   = 0;
+static THREAD_LOCAL uint32_t  FoutIndex   = 0;
+
+
+#define LZ4_NIBBLE_EXT   15u
+#define LZ4_LEN_EXT      255u
+#define LZ4_OFFSET_END   0x0000u
+
+#define MATCH_MIN_LEN    4u
+#define MATCH_WINDOW     0xFFFFu
+#define MATCH_HASH_BITS  16u
+#define MATCH_HASH_SIZE  (1u << MATCH_HASH_BITS)
+#define MATCH_NONE       0xFFFFFFFFu
+
+static THREAD_LOCAL uint32_t * p_match_head      = NULL;  // Most recent position for each hash
+static THREAD_LOCAL uint32_t * p_match_prev      = NULL;  // Previous position with the same hash, per input position
+static THREAD_LOCAL uint32_t   match_insert_pos  = 0;     // Next input position to be added to the chains
+static uint32_t                match_depth_max   = LZ4COMPRESS_CHAIN_DEPTH_DEFAULT;
+
+
+// Initialize the buffer vars
+static void initbufs(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    FinBuf     = inBuf;
+    Fsize_in   = size_in;
+    FinIndex   = 0;
+
+    pp_FoutBuf = pp_outBuf;
+    FoutBuf    = *pp_outBuf;
+    Fsize_out  = size_out;
+    FoutIndex = 0;
+}
+
+
+static void check_write_size(uint32_t len) {
+
+    // Grow output buffer if needed
+    while ((FoutIndex + len) >= Fsize_out) {
+        uint8_t * p_tmp = *pp_FoutBuf;
+
+        // Reallocate to twice as large
+        Fsize_out = (Fsize_out) ? Fsize_out * 2 : 256;
+        *pp_FoutBuf = (void *)realloc(*pp_FoutBuf, Fsize_out);
+
+        // If realloc failed, free original buffer before quitting
+        if (!(*pp_FoutBuf)) {
+            printf("Error: Failed to grow memory for output buffer!\n");
+            if (p_tmp) free(p_tmp);
+            p_tmp = NULL;
+            exit(EXIT_FAILURE);
+        } else
+            FoutBuf = *pp_FoutBuf; // Update working pointer
+    }
+}
+
+
+static void write_single_byte(uint8_t data) {
+
+    check_write_size(1);
+    FoutBuf[FoutIndex++] = data;
+}
+
+
+// Writes the length bytes following a nibble of LZ4_NIBBLE_EXT
+static void write_length_ext(uint32_t len) {
+
+    if (len >= LZ4_NIBBLE_EXT) {
+        len -= LZ4_NIBBLE_EXT;
+        while (len >= LZ4_LEN_EXT) {
+            write_single_byte(LZ4_LEN_EXT);
+            len -= LZ4_LEN_EXT;
+        }
+        write_single_byte(len);
+    }
+}
+
+
+// Writes a sequence of lit_len bytes from lit_pos followed by a match
+// A match_len of 0 writes the end of data marker instead of a match
+static void write_sequence(uint32_t lit_pos, uint32_t lit_len, uint32_t match_len, uint32_t match_offset) {
+
+    uint32_t match_code = (match_len) ? match_len - MATCH_MIN_LEN : 0;
+
+    write_single_byte( (((lit_len < LZ4_NIBBLE_EXT) ? lit_len : LZ4_NIBBLE_EXT) << 4) |
+                        ((match_code < LZ4_NIBBLE_EXT) ? match_code : LZ4_NIBBLE_EXT) );
+    write_length_ext(lit_len);
+
+    check_write_size(lit_len);
+    while (lit_len--)
+        FoutBuf[FoutIndex++] = FinBuf[lit_pos++];
+
+    if (match_len) {
+        write_single_byte(match_offset & 0xFFu);
+        write_single_byte((match_offset >> 8) & 0xFFu);
+        write_length_ext(match_code);
+    } else {
+        write_single_byte(LZ4_OFFSET_END & 0xFFu);
+        write_single_byte((LZ4_OFFSET_END >> 8) & 0xFFu);
+    }
+}
+
+
+// Sets maximum number of hash chain entries tested per match search
+void lz4compress_set_chain_depth(uint32_t depth_max) {
+
+    match_depth_max = depth_max;
+}
+
+
+static inline uint32_t match_hash(uint32_t byte_pos) {
+
+    uint32_t val = ((uint32_t)FinBuf[byte_pos] << 24) |
+                   ((uint32_t)FinBuf[byte_pos + 1] << 16) |
+                   ((uint32_t)FinBuf[byte_pos + 2] << 8) |
+                    (uint32_t)FinBuf[byte_pos + 3];
+
+    return (val * 2654435761u) >> (32u - MATCH_HASH_BITS);
+}
+
+
+static bool match_init(void) {
+
+    uint32_t c;
+
+    p_match_head = malloc(MATCH_HASH_SIZE * sizeof(uint32_t));
+    p_match_prev = malloc((Fsize_in ? Fsize_in : 1) * sizeof(uint32_t));
+    if (!p_match_head || !p_match_prev) {
+        printf("Error: Failed to allocate memory for match finder!\n");
+        return false;
+    }
+
+    for (c = 0; c < MATCH_HASH_SIZE; c++)
+        p_match_head[c] = MATCH_NONE;
+    match_insert_pos = 0;
+
+    return true;
+}
+
+
+static void match_cleanup(void) {
+
+    if (p_match_head) free(p_match_head);
+    if (p_match_prev) free(p_match_prev);
+    p_match_head = NULL;
+    p_match_prev = NULL;
+}
+
+
+// Find the longest match for input position byte_pos
+//
+// Matches may run into the bytes they produce (offset below the length),
+// the decompressors copy one byte at a time.
+static void match_find(uint32_t byte_pos, uint32_t * p_len, uint32_t * p_offset) {
+
+    uint32_t cand;
+    uint32_t len;
+    uint32_t len_max = Fsize_in - byte_pos;
+    uint32_t depth = 0;
+    uint32_t best_len = 0;
+    uint32_t best_offset = 0;
+    uint32_t hash;
+
+    // Add all positions before this one to their chains
+    while ((match_insert_pos < byte_pos) && ((match_insert_pos + MATCH_MIN_LEN) <= Fsize_in)) {
+        hash = match_hash(match_insert_pos);
+        p_match_prev[match_insert_pos] = p_match_head[hash];
+        p_match_head[hash] = match_insert_pos;
+        match_insert_pos++;
+    }
+
+    if (len_max >= MATCH_MIN_LEN) {
+
+        cand = p_match_head[match_hash(byte_pos)];
+
+        // Chains are ordered newest to oldest, stop once outside the window
+        while ((cand != MATCH_NONE) && ((byte_pos - cand) <= MATCH_WINDOW)) {
+
+            // Skip candidates which can't be longer than the best match so far
+            if ((best_len == 0) || ((best_len < len_max) && (FinBuf[cand + best_len] == FinBuf[byte_pos + best_len]))) {
+
+                len = 0;
+                while ((len < len_max) && (FinBuf[cand + len] == FinBuf[byte_pos + len]))
+                    len++;
+
+                if ((len >= MATCH_MIN_LEN) && (len > best_len)) {
+                    best_len = len;
+                    best_offset = byte_pos - cand;
+                    if (len == len_max)
+                        break; // Nothing longer is possible
+                }
+            }
+
+            depth++;
+            if ((match_depth_max != LZ4COMPRESS_CHAIN_DEPTH_UNLIMITED) && (depth >= match_depth_max))
+                break;
+
+            cand = p_match_prev[cand];
+        }
+    }
+
+    *p_len = best_len;
+    *p_offset = best_offset;
+}
+
+
+// Convert buffer inBuf to lz4 style encoding and write out to outBuf
+// Returns converted length
+uint32_t lz4compress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    uint32_t lit_pos = 0;
+    uint32_t match_len, match_offset;
+    uint32_t next_len, next_offset;
+
+    initbufs(inBuf, size_in, pp_outBuf, size_out);
+
+    if (!match_init()) {
+        match_cleanup();
+        return 0;
+    }
+
+    while (FinIndex < Fsize_in) {
+
+        match_find(FinIndex, &match_len, &match_offset);
+
+        if (match_len == 0) {
+            FinIndex++;
+            continue;
+        }
+
+        // Lazy matching: a longer match at the next byte
+        // is worth one more literal
+        if ((FinIndex + 1) < Fsize_in) {
+            match_find(FinIndex + 1, &next_len, &next_offset);
+            if (next_len > match_len + 1) {
+                FinIndex++;
+                continue;
+            }
+        }
+
+        write_sequence(lit_pos, FinIndex - lit_pos, match_len, match_offset);
+        FinIndex += match_len;
+        lit_pos = FinIndex;
+    }
+
+    // Trailing literals and end of data
+    write_sequence(lit_pos, FinIndex - lit_pos, 0, 0);
+
+    match_cleanup();
+    return FoutIndex;
+}
+
+
+static uint8_t read_single_byte(void) {
+
+    if (FinIndex >= Fsize_in) {
+        printf("Error: Read past end of input buffer!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return (FinBuf[FinIndex++]);
+}
+
+
+static uint32_t read_length(uint32_t nibble) {
+
+    uint8_t ext;
+
+    if (nibble == LZ4_NIBBLE_EXT) {
+        do {
+            ext = read_single_byte();
+            nibble += ext;
+        } while (ext == LZ4_LEN_EXT);
+    }
+    return nibble;
+}
+
+
+// Decompress buffer inBuf from lz4 style encoding and write to outBuf
+// Returns converted length
+uint32_t lz4decompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    uint8_t  token;
+    uint32_t len, offset;
+
+    initbufs(inBuf, size_in, pp_outBuf, size_out);
+
+    while (FinIndex < Fsize_in) {
+
+        token = read_single_byte();
+
+        len = read_length(token >> 4);
+        check_write_size(len);
+        while (len--)
+            FoutBuf[FoutIndex++] = read_single_byte();
+
+        offset = read_single_byte();
+        offset |= (uint32_t)read_single_byte() << 8;
+        if (offset == LZ4_OFFSET_END)
+            break;
+        if (offset > FoutIndex) {
+            printf("Error: Match offset before start of output!\n");
+            return 0;
+        }
+
+        len = read_length(token & 0x0Fu) + MATCH_MIN_LEN;
+        check_write_size(len);
+        while (len--) {
+            FoutBuf[FoutIndex] = FoutBuf[FoutIndex - offset];
+            FoutIndex++;
+        }
+    }
+
+    return FoutIndex;
+}
+
+
+// Cycles of .lz4_length in libc/targets/sm83/lz4_decompress.s, including the call
+static uint32_t length_cycles_sm83(uint8_t * inBuf, uint32_t size_in, uint32_t * p_index, uint32_t * p_len) {
+
+    uint32_t cycles = 6 + 3;
+    uint8_t  ext;
+
+    *p_len = LZ4_NIBBLE_EXT;
+    do {
+        ext = (*p_index < size_in) ? inBuf[(*p_index)++] : 0;
+        *p_len += ext;
+        cycles += (ext == LZ4_LEN_EXT) ? 12 : 14;
+    } while (ext == LZ4_LEN_EXT);
+
+    return cycles;
+}
+
+
+// Cycles of .lz4_copy in libc/targets/sm83/lz4_decompress.s, including the call
+static uint32_t copy_cycles_sm83(uint32_t len) {
+
+    uint32_t pairs = len / 2;
+
+    return 6 + ((len & 1) ? 8 : 3) + ((pairs) ? (25 + (pairs * 16)) : 11);
+}
+
+
+// Cycles of the LZ4_COPY_SHORT macro in libc/targets/sm83/lz4_decompress.s
+static uint32_t copy_short_cycles_sm83(uint32_t len) {
+
+    uint32_t pairs = len / 2;
+
+    return 2 + ((len & 1) ? 8 : 3) + ((pairs) ? (1 + (pairs * 16)) : 3);
+}
+
+
+// Estimated number of GB CPU cycles (M-cycles, 1.05 MHz) lz4_decompress() in
+// libc/targets/sm83/lz4_decompress.s takes for inBuf, counted from its code paths
+uint32_t lz4_decode_cycles_sm83(uint8_t * inBuf, uint32_t size_in) {
+
+    uint32_t index = 0;
+    uint32_t cycles = 0;
+    uint32_t len, offset;
+    uint8_t  token;
+
+    while (index < size_in) {
+
+        token = inBuf[index++];
+
+        // Literals
+        len = token >> 4;
+        if (len == 0)
+            cycles += 10;
+        else if (len < LZ4_NIBBLE_EXT) {
+            cycles += 14 + copy_short_cycles_sm83(len) + 3;
+            index += len;
+        } else {
+            cycles += 14 + 4 + length_cycles_sm83(inBuf, size_in, &index, &len);
+            cycles += copy_cycles_sm83(len) + 3;
+            index += len;
+        }
+
+        // Match
+        if ((index + 1) >= size_in)
+            break;
+        offset = inBuf[index] | ((uint32_t)inBuf[index + 1] << 8);
+        index += 2;
+        if (offset == LZ4_OFFSET_END) {
+            cycles += 8 + 13;
+            break;
+        }
+
+        len = token & 0x0Fu;
+        if (len < LZ4_NIBBLE_EXT)
+            cycles += 7 + 21 + 3 + copy_short_cycles_sm83(len + MATCH_MIN_LEN) + 6;
+        else {
+            cycles += 7 + 22 + 9 + length_cycles_sm83(inBuf, size_in, &index, &len) + 7;
+            cycles += 12 + copy_cycles_sm83(len + MATCH_MIN_LEN) + 10;
+        }
+    }
+
+    return cycles;
+}
@@ -0,0 +1,16 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _LZ4COMPRESS_H
+#define _LZ4COMPRESS_H
+
+#define LZ4COMPRESS_CHAIN_DEPTH_UNLIMITED 0
+#define LZ4COMPRESS_CHAIN_DEPTH_DEFAULT   256
+#define LZ4COMPRESS_CHAIN_DEPTH_FAST      16
+
+void lz4compress_set_chain_depth(uint32_t depth_max);
+uint32_t lz4compress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t lz4decompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t lz4_decode_cycles_sm83(uint8_t * inBuf, uint32_t size_in);
+
+#endif // _LZ4COMPRESS_H
@@ -7,43 +7,79 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "common.h"
 #include "gbcompress.h"
 #include "rlecompress.h"
+#include "lz4compress.h"
+#include "tilecompress.h"
 #include "files.h"
 #include "files_c_source.h"
+#include "batch.h"
+#include "blocks.h"
+#include "deps.h"
 
 #define MAX_STR_LEN     4096
 
 #define COMPRESSION_TYPE_GB        0
 #define COMPRESSION_TYPE_RLE_BLOCK 1
+#define COMPRESSION_TYPE_LZ4       2
+#define COMPRESSION_TYPE_TILE      3
 #define COMPRESSION_TYPE_DEFAULT   COMPRESSION_TYPE_GB
 
+// --stats repeats decompression for at least this long to time it
+#define STATS_MIN_SECONDS 0.05
+#define SM83_CYCLES_PER_SEC 1048576.0
+
 char filename_in[MAX_STR_LEN] = {'\0'};
 char filename_out[MAX_STR_LEN] = {'\0'};
+char filename_batch[MAX_STR_LEN] = {'\0'};
+char filename_dep[MAX_STR_LEN + 6] = {'\0'};
+char filename_stamp[MAX_STR_LEN + 6] = {'\0'};
 
 uint8_t * p_buf_in  = NULL;
 uint8_t * p_buf_out = NULL;
 
 bool opt_mode_compress    = true;
 bool opt_verbose          = false;
-bool opt_compression_type = COMPRESSION_TYPE_DEFAULT;
+uint8_t opt_compression_type = COMPRESSION_TYPE_DEFAULT;
 bool opt_c_source_input   = false;
 bool opt_c_source_output  = false;
+bool opt_asm_output       = false;
+bool opt_fast             = false;
+bool opt_optimal          = false;
 char opt_c_source_output_varname[MAX_STR_LEN] = "var_name";
+bool opt_varname_set      = false;
 uint16_t opt_bank_num     = BANK_NUM_ROM_UNSET;
+bool opt_batch            = false;
+uint32_t opt_jobs         = BATCH_JOBS_AUTO;
+uint32_t opt_rle_index    = 0; // Record size, 0 for no index
+uint32_t opt_blocks       = 0; // Block size, 0 for a single stream
+bool opt_verify           = false;
+bool opt_stats            = false;
+bool opt_deps             = false;
+bool opt_skip_unchanged   = false;
 
 static void display_help(void);
 static int handle_args(int argc, char * argv[]);
+static void report_optimal_savings(uint32_t size_in, uint32_t optimal_len);
+static void report_lz4_comparison(uint32_t size_in, uint32_t lz4_len);
+static void report_tile_comparison(uint32_t size_in, uint32_t tile_len);
+static bool write_index(uint32_t * p_index, uint32_t count);
+static bool verify_and_report(uint32_t size_in, uint32_t out_len, double compress_seconds,
+                              uint32_t * p_index, uint32_t index_count);
 static int compress(void);
 static int decompress(void);
+static int batch(void);
+static int convert_with_deps(int argc, char * argv[]);
 void cleanup(void);
 
 
 static void display_help(void) {
     fprintf(stdout,
        "gbcompress [options] infile outfile\n"
+       "gbcompress [options] --batch=<manifest>\n"
        "Use: compress a binary file and write it out.\n"
        "\n"
        "Options\n"
@@ -52,15 +88,41 @@ static void display_help(void) {
        "-v       : Verbose output\n"
        "--cin    : Read input as .c source format (8 bit char ONLY, uses first array found)\n"
        "--cout   : Write output in .c / .h source format (8 bit char ONLY) \n"
+       "--sout   : Write output in .s assembler / .h source format, which doesn't need the C compiler\n"
        "--varname=<NAME> : specify variable name for c source output\n"
-       "--alg=<type>     : specify compression type: 'rle', 'gb' (default)\n"
-       "--bank=<num>     : Add Bank Ref: %d - %d (default is none, with --cout only)\n"
+       "--alg=<type>     : specify compression type: 'rle', 'lz4', 'tile', 'gb' (default)\n"
+       "--bank=<num>     : Add Bank Ref: %d - %d (default is none, with --cout or --sout only)\n"
+       "--fast           : Faster 'gb' and 'lz4' compression with a limited match search (output may be larger)\n"
+       "--optimal        : Smallest 'gb' compression using an optimal parse (slower, -v shows savings)\n"
+       "--batch=<file>   : Convert all entries in a manifest file, one per line: infile:outfile[:var_name[:bank]]\n"
+       "                   (.c / .s outfiles use c / assembler source format, var_name defaults to outfile name)\n"
+       "                   (with --cin infile@array reads the named array instead of the first one)\n"
+       "--jobs=<num>     : Number of threads for --batch (default is number of CPUs)\n"
+       "--rle-index=<size> : With 'rle': restart encoding every <size> bytes (ex: a map row) and write\n"
+       "                   the offset of each in an index (<var_name>_index with --cout, else <outfile>.idx)\n"
+       "--blocks=<size>  : With 'gb' or 'lz4': compress every <size> bytes as a separate stream (on --jobs threads)\n"
+       "                   and write the offset of each in an index the same way as --rle-index\n"
+       "--verify         : Decompress the compressed data again and fail if it differs from the input\n"
+       "--stats          : Print one line with the sizes, compression and decompression speed (MB/s)\n"
+       "                   and the estimated GB cycles to decompress on the target\n"
+       "--deps           : Also write a make rule of the output files depending on infile to <outfile>.d\n"
+       "--skip-if-unchanged : Don't write the output again if infile and the options are the same as the\n"
+       "                   last time (a hash of them is kept in <outfile>.stamp)\n"
        "Example: \"gbcompress binaryfile.bin compressed.bin\"\n"
        "Example: \"gbcompress -d compressedfile.bin decompressed.bin\"\n"
        "Example: \"gbcompress --alg=rle binaryfile.bin compressed.bin\"\n"
+       "Example: \"gbcompress -v --alg=lz4 tiles.bin tiles.lz4\"\n"
+       "Example: \"gbcompress -v --alg=tile tiles.2bpp tiles.bin\"\n"
+       "Example: \"gbcompress --alg=rle --rle-index=64 --cout --varname=map map.bin map.c\"\n"
+       "Example: \"gbcompress --alg=lz4 --blocks=4096 --cout --varname=level level.bin level.c\"\n"
+       "Example: \"gbcompress --batch=assets.txt\"\n"
+       "Example: \"gbcompress --alg=lz4 --verify --stats tiles.bin tiles.lz4\"\n"
+       "Example: \"gbcompress --deps --skip-if-unchanged --cout --varname=map map.bin map.c\"\n"
        "\n"
        "The default compression (gb) is the type used by gbtd/gbmb\n"
-       "The rle compression is Amiga IFF style\n",
+       "The rle compression is Amiga IFF style\n"
+       "The lz4 compression is LZ4 style, faster to decompress than gb (-v compares them)\n"
+       "The tile compression is for 2bpp tile data only, it can be decompressed straight to VRAM (-v compares it to rle and gb)\n",
        BANK_NUM_ROM_MIN, BANK_NUM_ROM_MAX
        );
 }
@@ -69,15 +131,22 @@ static void display_help(void) {
 int handle_args(int argc, char * argv[]) {
 
     int i = 1; // start at first arg
+    int args_end;
+
+    // Batch mode doesn't use input/output file arguments
+    for (i = 1; i < argc; i++ )
+        if (strstr(argv[i], "--batch=") == argv[i])
+            opt_batch = true;
 
-    if( argc < 3 ) {
+    if( (argc < 3) && !((argc == 2) && opt_batch) ) {
         display_help();
         return false;
     }
 
     // Start at first optional argument
-    // Last two arguments *must* be input/output files
-    for (i = 1; i < (argc - 2); i++ ) {
+    // Last two arguments *must* be input/output files (unless in batch mode)
+    args_end = (opt_batch) ? argc : (argc - 2);
+    for (i = 1; i < args_end; i++ ) {
 
         if (argv[i][0] == '-') {
             if (strstr(argv[i], "-h") == argv[i]) {
@@ -89,12 +158,47 @@ int handle_args(int argc, char * argv[]) {
                 opt_c_source_input = true;
             } else if (strstr(argv[i], "--cout") == argv[i]) {
                 opt_c_source_output = true;
+            } else if (strstr(argv[i], "--sout") == argv[i]) {
+                opt_asm_output = true;
             } else if (strstr(argv[i], "--varname=") == argv[i]) {
                 snprintf(opt_c_source_output_varname, sizeof(opt_c_source_output_varname), "%s", argv[i] + 10);
+                opt_varname_set = true;
+            } else if (strstr(argv[i], "--batch=") == argv[i]) {
+                snprintf(filename_batch, sizeof(filename_batch), "%s", argv[i] + strlen("--batch="));
+            } else if (strstr(argv[i], "--jobs=") == argv[i]) {
+                opt_jobs = atoi(argv[i] + strlen("--jobs="));
+            } else if (strstr(argv[i], "--fast") == argv[i]) {
+                opt_fast = true;
+            } else if (strstr(argv[i], "--optimal") == argv[i]) {
+                opt_optimal = true;
+            } else if (strstr(argv[i], "--rle-index=") == argv[i]) {
+                opt_rle_index = atoi(argv[i] + strlen("--rle-index="));
+                if (opt_rle_index == 0) {
+                    printf("gbcompress: Warning: Invalid --rle-index record size %s\n", argv[i] + strlen("--rle-index="));
+                    return false;
+                }
+            } else if (strstr(argv[i], "--blocks=") == argv[i]) {
+                opt_blocks = atoi(argv[i] + strlen("--blocks="));
+                if (opt_blocks == 0) {
+                    printf("gbcompress: Warning: Invalid --blocks block size %s\n", argv[i] + strlen("--blocks="));
+                    return false;
+                }
+            } else if (strstr(argv[i], "--verify") == argv[i]) {
+                opt_verify = true;
+            } else if (strstr(argv[i], "--stats") == argv[i]) {
+                opt_stats = true;
+            } else if (strstr(argv[i], "--deps") == argv[i]) {
+                opt_deps = true;
+            } else if (strstr(argv[i], "--skip-if-unchanged") == argv[i]) {
+                opt_skip_unchanged = true;
             } else if (strstr(argv[i], "--alg=gb") == argv[i]) {
                 opt_compression_type = COMPRESSION_TYPE_GB;
             } else if (strstr(argv[i], "--alg=rle") == argv[i]) {
                 opt_compression_type = COMPRESSION_TYPE_RLE_BLOCK;
+            } else if (strstr(argv[i], "--alg=lz4") == argv[i]) {
+                opt_compression_type = COMPRESSION_TYPE_LZ4;
+            } else if (strstr(argv[i], "--alg=tile") == argv[i]) {
+                opt_compression_type = COMPRESSION_TYPE_TILE;
             } else if (strstr(argv[i], "-d") == argv[i]) {
                 opt_mode_compress = false;
             } else if (strstr(argv[i], "--bank=") == argv[i]) {
@@ -108,6 +212,30 @@ int handle_args(int argc, char * argv[]) {
         }
     }
 
+    if ((opt_rle_index) && ((opt_compression_type != COMPRESSION_TYPE_RLE_BLOCK) || (!opt_mode_compress) || (opt_batch))) {
+        printf("gbcompress: Warning: --rle-index requires --alg=rle compression and no --batch\n");
+        return false;
+    }
+
+    if ((opt_blocks) && (((opt_compression_type != COMPRESSION_TYPE_GB) && (opt_compression_type != COMPRESSION_TYPE_LZ4)) ||
+                         (!opt_mode_compress) || (opt_batch))) {
+        printf("gbcompress: Warning: --blocks requires --alg=gb or --alg=lz4 compression and no --batch\n");
+        return false;
+    }
+
+    if ((opt_verify || opt_stats) && ((!opt_mode_compress) || (opt_batch))) {
+        printf("gbcompress: Warning: --verify and --stats require compression and no --batch\n");
+        return false;
+    }
+
+    if ((opt_deps || opt_skip_unchanged) && (opt_batch)) {
+        printf("gbcompress: Warning: --deps and --skip-if-unchanged can't be used with --batch\n");
+        return false;
+    }
+
+    if (opt_batch)
+        return true;
+
     // Copy input and output filenames from last two arguments
     // if not preceded with option dash
     if (argv[i][0] != '-') {
@@ -136,12 +264,198 @@ void cleanup(void) {
 }
 
 
+// Compress with the greedy encoder as well and show the size difference
+static void report_optimal_savings(uint32_t size_in, uint32_t optimal_len) {
+
+    uint32_t  greedy_size_out = size_in;
+    uint8_t * p_greedy_buf = malloc(greedy_size_out);
+    uint32_t  greedy_len;
+
+    if (p_greedy_buf) {
+        greedy_len = gbcompress_buf(p_buf_in, size_in, &p_greedy_buf, greedy_size_out);
+        printf("Optimal parse: %d bytes, greedy: %d bytes (%d bytes saved, %%%.2f)\n",
+               optimal_len, greedy_len, (int)greedy_len - (int)optimal_len,
+               (greedy_len) ? (((double)greedy_len - (double)optimal_len) / (double)greedy_len) * 100 : 0.0);
+        free(p_greedy_buf);
+    }
+}
+
+
+// Writes the --rle-index record or --blocks block offsets, 16 bit little endian
+// in <outfile>.idx (with --cout they are written with the data instead)
+static bool write_index(uint32_t * p_index, uint32_t count) {
+
+    char      filename_idx[MAX_STR_LEN + 4];
+    uint8_t * p_buf_idx = malloc(count * 2);
+    uint32_t  i;
+    bool      result;
+
+    if (!p_buf_idx) return false;
+
+    for (i = 0; i < count; i++) {
+        p_buf_idx[i * 2]     = p_index[i] & 0xFFu;
+        p_buf_idx[i * 2 + 1] = (p_index[i] >> 8) & 0xFFu;
+    }
+    snprintf(filename_idx, sizeof(filename_idx), "%s.idx", filename_out);
+    result = file_write_from_buffer(filename_idx, p_buf_idx, count * 2);
+
+    free(p_buf_idx);
+    return result;
+}
+
+
+// Decompresses the data from compress() again with the decoder of the
+// compression type, for --verify (compare with the input) and --stats
+//
+// --blocks streams each end with their own end marker, so those are
+// decompressed one block at a time, starting at the offsets in p_index
+static bool verify_and_report(uint32_t size_in, uint32_t out_len, double compress_seconds,
+                              uint32_t * p_index, uint32_t index_count) {
+
+    batch_convert_func decode_func;
+    uint32_t  (*cycles_func)(uint8_t * inBuf, uint32_t size_in);
+    const char * alg_name;
+    uint32_t  size_dec = (size_in * 2) + 16; // Room so the decoders don't have to grow it
+    uint8_t * p_buf_dec = malloc(size_dec);
+    uint8_t * p_buf_block = NULL;
+    uint32_t  size_block = opt_blocks + 16;
+    uint32_t  dec_len;
+    uint32_t  block_len;
+    uint32_t  block_end;
+    uint32_t  runs = 0;
+    uint32_t  cycles;
+    uint32_t  c, b;
+    clock_t   start;
+    double    decompress_seconds;
+    bool      result = true;
+
+    if (!p_buf_dec) return false;
+    if (opt_blocks) {
+        p_buf_block = malloc(size_block);
+        if (!p_buf_block) {
+            free(p_buf_dec);
+            return false;
+        }
+    }
+
+    if (opt_compression_type == COMPRESSION_TYPE_GB) {
+        decode_func = gbdecompress_buf;   cycles_func = gbdecompress_cycles_sm83; alg_name = "gb";
+    } else if (opt_compression_type == COMPRESSION_TYPE_LZ4) {
+        decode_func = lz4decompress_buf;  cycles_func = lz4_decode_cycles_sm83;   alg_name = "lz4";
+    } else if (opt_compression_type == COMPRESSION_TYPE_TILE) {
+        decode_func = tiledecompress_buf; cycles_func = tile_decode_cycles_sm83;  alg_name = "tile";
+    } else {
+        decode_func = rledecompress_buf;  cycles_func = rle_decode_cycles_sm83;   alg_name = "rle";
+    }
+
+    start = clock();
+    do {
+        if (opt_blocks) {
+            dec_len = 0;
+            for (b = 0; b < index_count; b++) {
+                block_end = (b + 1 < index_count) ? p_index[b + 1] : out_len;
+                block_len = decode_func(p_buf_out + p_index[b], block_end - p_index[b], &p_buf_block, size_block);
+                if ((dec_len + block_len) > size_dec) break;
+                memcpy(p_buf_dec + dec_len, p_buf_block, block_len);
+                dec_len += block_len;
+            }
+        }
+        else
+            dec_len = decode_func(p_buf_out, out_len, &p_buf_dec, size_dec);
+        runs++;
+        decompress_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while ((opt_stats) && (decompress_seconds < STATS_MIN_SECONDS));
+
+    if (opt_verify) {
+        for (c = 0; (c < dec_len) && (c < size_in); c++)
+            if (p_buf_dec[c] != p_buf_in[c]) break;
+        if ((dec_len != size_in) || (c != size_in)) {
+            printf("gbcompress: ERROR: Verify failed, decompressed %d bytes of %d and they differ from byte %d on\n",
+                   dec_len, size_in, c);
+            result = false;
+        }
+        else if (opt_verbose)
+            printf("Verify: decompressed data matches the input\n");
+    }
+
+    if (opt_stats) {
+        if (opt_blocks) {
+            cycles = 0;
+            for (b = 0; b < index_count; b++) {
+                block_end = (b + 1 < index_count) ? p_index[b + 1] : out_len;
+                cycles += cycles_func(p_buf_out + p_index[b], block_end - p_index[b]);
+            }
+        }
+        else
+            cycles = cycles_func(p_buf_out, out_len);
+        // Timer resolution: a compression faster than 1us counts as 1us
+        if (compress_seconds < 0.000001) compress_seconds = 0.000001;
+        printf("stats: alg=%s in=%d out=%d ratio=%.4f compress_mbs=%.3f decompress_mbs=%.3f sm83_cycles=%d sm83_cycles_per_byte=%.2f sm83_ms=%.2f\n",
+               alg_name, size_in, out_len, (double)out_len / (double)size_in,
+               ((double)size_in / compress_seconds) / 1000000.0,
+               ((double)size_in * runs / decompress_seconds) / 1000000.0,
+               cycles, (double)cycles / (double)size_in, ((double)cycles / SM83_CYCLES_PER_SEC) * 1000.0);
+    }
+
+    if (p_buf_block) free(p_buf_block);
+    free(p_buf_dec);
+    return result;
+}
+
+
+// Compress with gb as well and show the size and estimated GB decompression time of both
+static void report_lz4_comparison(uint32_t size_in, uint32_t lz4_len) {
+
+    uint32_t  gb_size_out = size_in;
+    uint8_t * p_gb_buf = malloc(gb_size_out);
+    uint32_t  gb_len;
+    uint32_t  lz4_cycles = lz4_decode_cycles_sm83(p_buf_out, lz4_len);
+    uint32_t  gb_cycles;
+
+    if (p_gb_buf) {
+        gb_len = gbcompress_buf(p_buf_in, size_in, &p_gb_buf, gb_size_out);
+        gb_cycles = gbdecompress_cycles_sm83(p_gb_buf, gb_len);
+        printf("lz4: %d bytes (%%%.2f), ~%.2f GB cycles/byte to decompress\n",
+               lz4_len, ((double)lz4_len / (double)size_in) * 100, (double)lz4_cycles / (double)size_in);
+        printf("gb : %d bytes (%%%.2f), ~%.2f GB cycles/byte to decompress\n",
+               gb_len, ((double)gb_len / (double)size_in) * 100, (double)gb_cycles / (double)size_in);
+        free(p_gb_buf);
+    }
+}
+
+
+// Compress with rle and gb as well and show the size and estimated GB decompression time of each
+static void report_tile_comparison(uint32_t size_in, uint32_t tile_len) {
+
+    uint32_t  cmp_size_out = size_in;
+    uint8_t * p_cmp_buf = malloc(cmp_size_out);
+    uint32_t  cmp_len;
+
+    printf("tile: %d bytes (%%%.2f), ~%.2f GB cycles/byte to decompress\n",
+           tile_len, ((double)tile_len / (double)size_in) * 100,
+           (double)tile_decode_cycles_sm83(p_buf_out, tile_len) / (double)size_in);
+    if (p_cmp_buf) {
+        cmp_len = rlecompress_buf(p_buf_in, size_in, &p_cmp_buf, cmp_size_out);
+        printf("rle : %d bytes (%%%.2f)\n", cmp_len, ((double)cmp_len / (double)size_in) * 100);
+        cmp_len = gbcompress_buf(p_buf_in, size_in, &p_cmp_buf, cmp_size_out);
+        printf("gb  : %d bytes (%%%.2f), ~%.2f GB cycles/byte to decompress\n",
+               cmp_len, ((double)cmp_len / (double)size_in) * 100,
+               (double)gbdecompress_cycles_sm83(p_cmp_buf, cmp_len) / (double)size_in);
+        free(p_cmp_buf);
+    }
+}
+
+
 static int compress() {
 
     uint32_t  buf_size_in = 0;
     uint32_t  buf_size_out = 0;
     uint32_t  out_len = 0;
     bool      result = false;
+    uint32_t * p_index = NULL;
+    uint32_t  index_count = 0;
+    clock_t   start;
+    double    compress_seconds = 0.0;
 
     if (opt_c_source_input)
         p_buf_in =  file_read_c_input_into_buffer(filename_in, &buf_size_in);
@@ -155,21 +469,107 @@ static int compress() {
 
     if ((p_buf_in) && (p_buf_out) && (buf_size_in > 0)) {
 
-        if (opt_compression_type == COMPRESSION_TYPE_GB)
-            out_len = gbcompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
+        start = clock();
+        if (opt_blocks) {
+            index_count = (buf_size_in + opt_blocks - 1) / opt_blocks;
+            p_index = malloc(index_count * sizeof(uint32_t));
+            if (!p_index)
+                return EXIT_FAILURE;
+            if (opt_compression_type == COMPRESSION_TYPE_LZ4) {
+                if (opt_fast)
+                    lz4compress_set_chain_depth(LZ4COMPRESS_CHAIN_DEPTH_FAST);
+                out_len = blocks_compress(lz4compress_buf, p_buf_in, buf_size_in, &p_buf_out, buf_size_out,
+                                          opt_blocks, p_index, opt_jobs);
+            } else {
+                if (opt_fast)
+                    gbcompress_set_chain_depth(GBCOMPRESS_CHAIN_DEPTH_FAST);
+                out_len = blocks_compress((opt_optimal) ? gbcompress_buf_optimal : gbcompress_buf,
+                                          p_buf_in, buf_size_in, &p_buf_out, buf_size_out,
+                                          opt_blocks, p_index, opt_jobs);
+            }
+            // The index entries are 16 bit on the target
+            if ((out_len) && (p_index[index_count - 1] > 0xFFFFu)) {
+                printf("gbcompress: ERROR: Compressed size %d too large for a 16 bit --blocks index\n", out_len);
+                free(p_index);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (opt_compression_type == COMPRESSION_TYPE_GB) {
+            if (opt_fast)
+                gbcompress_set_chain_depth(GBCOMPRESS_CHAIN_DEPTH_FAST);
+            if (opt_optimal) {
+                out_len = gbcompress_buf_optimal(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
+                compress_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+                if (opt_verbose)
+                    report_optimal_savings(buf_size_in, out_len);
+            }
+            else
+                out_len = gbcompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
+        }
+        else if (opt_compression_type == COMPRESSION_TYPE_LZ4) {
+            if (opt_fast)
+                lz4compress_set_chain_depth(LZ4COMPRESS_CHAIN_DEPTH_FAST);
+            out_len = lz4compress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
+            compress_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+            if ((out_len) && (opt_verbose))
+                report_lz4_comparison(buf_size_in, out_len);
+        }
+        else if (opt_compression_type == COMPRESSION_TYPE_TILE) {
+            out_len = tilecompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
+            compress_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+            if ((out_len) && (opt_verbose))
+                report_tile_comparison(buf_size_in, out_len);
+        }
+        else if ((opt_compression_type == COMPRESSION_TYPE_RLE_BLOCK) && (opt_rle_index)) {
+            index_count = (buf_size_in + opt_rle_index - 1) / opt_rle_index;
+            p_index = malloc(index_count * sizeof(uint32_t));
+            if (!p_index)
+                return EXIT_FAILURE;
+            out_len = rlecompress_buf_indexed(p_buf_in, buf_size_in, &p_buf_out, buf_size_out, opt_rle_index, p_index);
+            // The index entries are 16 bit on the target
+            if (p_index[index_count - 1] > 0xFFFFu) {
+                printf("gbcompress: ERROR: Compressed size %d too large for a 16 bit --rle-index\n", out_len);
+                free(p_index);
+                return EXIT_FAILURE;
+            }
+        }
         else if (opt_compression_type == COMPRESSION_TYPE_RLE_BLOCK)
             out_len = rlecompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
         else
             return EXIT_FAILURE;
 
+        // The -v comparisons above are not counted
+        if (compress_seconds == 0.0)
+            compress_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
         if (out_len > 0) {
 
-            if (opt_c_source_output) {
+            if ((opt_verify || opt_stats) && !verify_and_report(buf_size_in, out_len, compress_seconds, p_index, index_count)) {
+                if (p_index) free(p_index);
+                return EXIT_FAILURE;
+            }
+
+            if (opt_asm_output) {
+                c_source_set_sizes(out_len, buf_size_in); // compressed, decompressed
+                c_source_set_index(p_index, index_count);
+                result = file_write_asm_output_from_buffer(filename_out, p_buf_out, out_len, opt_c_source_output_varname, opt_bank_num);
+            }
+            else if (opt_c_source_output) {
                 c_source_set_sizes(out_len, buf_size_in); // compressed, decompressed
+                c_source_set_index(p_index, index_count);
                 result = file_write_c_output_from_buffer(filename_out, p_buf_out, out_len, opt_c_source_output_varname, true, opt_bank_num);
             }
-            else
+            else {
                 result = file_write_from_buffer(filename_out, p_buf_out, out_len);
+                if ((result) && (p_index))
+                    result = write_index(p_index, index_count);
+            }
+
+            if (p_index) {
+                if ((result) && (opt_verbose))
+                    printf("Index: %d records of %d bytes\n", index_count, (opt_blocks) ? opt_blocks : opt_rle_index);
+                free(p_index);
+            }
 
             if (result) {
                 if (opt_verbose)
@@ -206,12 +606,20 @@ static int decompress() {
             out_len = gbdecompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
         else if (opt_compression_type == COMPRESSION_TYPE_RLE_BLOCK)
             out_len = rledecompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
+        else if (opt_compression_type == COMPRESSION_TYPE_LZ4)
+            out_len = lz4decompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
+        else if (opt_compression_type == COMPRESSION_TYPE_TILE)
+            out_len = tiledecompress_buf(p_buf_in, buf_size_in, &p_buf_out, buf_size_out);
         else
             return EXIT_FAILURE;
 
         if (out_len > 0) {
 
-            if (opt_c_source_output) {
+            if (opt_asm_output) {
+                c_source_set_sizes(buf_size_in, out_len); // compressed, decompressed
+                result = file_write_asm_output_from_buffer(filename_out, p_buf_out, out_len, opt_c_source_output_varname, opt_bank_num);
+            }
+            else if (opt_c_source_output) {
                 c_source_set_sizes(buf_size_in, out_len); // compressed, decompressed
                 result = file_write_c_output_from_buffer(filename_out, p_buf_out, out_len, opt_c_source_output_varname, true, opt_bank_num);
             }
@@ -233,6 +641,77 @@ static int decompress() {
 }
 
 
+static int batch() {
+
+    batch_convert_func convert_func;
+
+    if (opt_mode_compress) {
+        if (opt_compression_type == COMPRESSION_TYPE_GB) {
+            if (opt_fast)
+                gbcompress_set_chain_depth(GBCOMPRESS_CHAIN_DEPTH_FAST);
+            convert_func = (opt_optimal) ? gbcompress_buf_optimal : gbcompress_buf;
+        }
+        else if (opt_compression_type == COMPRESSION_TYPE_LZ4) {
+            if (opt_fast)
+                lz4compress_set_chain_depth(LZ4COMPRESS_CHAIN_DEPTH_FAST);
+            convert_func = lz4compress_buf;
+        }
+        else if (opt_compression_type == COMPRESSION_TYPE_TILE)
+            convert_func = tilecompress_buf;
+        else
+            convert_func = rlecompress_buf;
+    } else {
+        if (opt_compression_type == COMPRESSION_TYPE_GB)
+            convert_func = gbdecompress_buf;
+        else if (opt_compression_type == COMPRESSION_TYPE_LZ4)
+            convert_func = lz4decompress_buf;
+        else if (opt_compression_type == COMPRESSION_TYPE_TILE)
+            convert_func = tiledecompress_buf;
+        else
+            convert_func = rledecompress_buf;
+    }
+
+    if (batch_process(filename_batch, convert_func, opt_mode_compress,
+                      opt_c_source_input, opt_c_source_output,
+                      (opt_varname_set) ? opt_c_source_output_varname : NULL, opt_bank_num,
+                      opt_jobs))
+        return EXIT_SUCCESS;
+    else
+        return EXIT_FAILURE;
+}
+
+
+// --deps and --skip-if-unchanged around compress() / decompress()
+static int convert_with_deps(int argc, char * argv[]) {
+
+    char hash_str[17];
+    bool hashed;
+    int  ret;
+
+    // Named before converting, --cout and --sout change filename_out to the .h name
+    snprintf(filename_dep, sizeof(filename_dep), "%s.d", filename_out);
+    snprintf(filename_stamp, sizeof(filename_stamp), "%s.stamp", filename_out);
+    deps_track_outputs();
+
+    hashed = (opt_skip_unchanged) && deps_hash_inputs(argc, argv, filename_in, hash_str);
+    if ((hashed) && deps_stamp_unchanged(filename_stamp, hash_str)) {
+        if (opt_verbose)
+            printf("%s: up to date\n", filename_out);
+        return EXIT_SUCCESS;
+    }
+
+    ret = (opt_mode_compress) ? compress() : decompress();
+    if (ret != EXIT_SUCCESS)
+        return ret;
+
+    if ((opt_deps) && !deps_write_dep_file(filename_dep, filename_in))
+        return EXIT_FAILURE;
+    if ((hashed) && !deps_write_stamp(filename_stamp, hash_str))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+
 int main( int argc, char *argv[] )  {
 
     // Exit with failure by default
@@ -243,7 +722,11 @@ int main( int argc, char *argv[] )  {
 
     if (handle_args(argc, argv)) {
 
-        if (opt_mode_compress)
+        if (opt_batch)
+            ret = batch();
+        else if (opt_deps || opt_skip_unchanged)
+            ret = convert_with_deps(argc, argv);
+        else if (opt_mode_compress)
             ret = compress();
         else
             ret = decompress();
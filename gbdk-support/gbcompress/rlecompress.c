@@ -7,17 +7,18 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "common.h"
 #include "rlecompress.h"
 
 
-static uint8_t * FinBuf      = NULL;
-static uint32_t  Fsize_in    = 0;
-static uint32_t  FinIndex    = 0;
+static THREAD_LOCAL uint8_t * FinBuf      = NULL;
+static THREAD_LOCAL uint32_t  Fsize_in    = 0;
+static THREAD_LOCAL uint32_t  FinIndex    = 0;
 
-static uint8_t ** pp_FoutBuf = NULL;
-static uint8_t * FoutBuf     = NULL;
-static uint32_t  Fsize_out   = 0;
-static uint32_t  FoutIndex   = 0;
+static THREAD_LOCAL uint8_t ** pp_FoutBuf = NULL;
+static THREAD_LOCAL uint8_t * FoutBuf     = NULL;
+static THREAD_LOCAL uint32_t  Fsize_out   = 0;
+static THREAD_LOCAL uint32_t  FoutIndex   = 0;
 
 
 #define RLE_MASK_LEN    0x7F
@@ -30,9 +31,9 @@ static uint32_t  FoutIndex   = 0;
 #define RLE_CHANGE_COST 2
 
 
-static uint8_t rle_queued[128];
-static int rle_queue_idx = 0;
-static int run_len = 0;
+static THREAD_LOCAL uint8_t rle_queued[128];
+static THREAD_LOCAL int rle_queue_idx = 0;
+static THREAD_LOCAL int run_len = 0;
 
 
 // Initialize the buffer vars
@@ -109,18 +110,17 @@ static void rle_commit() {
 
 
 
-// Convert buffer inBuf to rlecompress rle encoding and write out to outBuf
-// Returns converted length
-uint32_t rlecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+// Encode input up to end_index, flushing all pending data
+// so the next encoded byte starts on a control byte
+static void rle_encode(uint32_t end_index) {
 
     uint8_t  last, current;
-    initbufs(inBuf, size_in, pp_outBuf, size_out);
 
     last = 0;
     run_len = 0;
     rle_queue_idx = 0;
 
-    while (FinIndex < Fsize_in) {
+    while (FinIndex < end_index) {
 
         current = FinBuf[FinIndex++];
 
@@ -172,6 +172,42 @@ uint32_t rlecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf
 
     // Flush any trailing data
     rle_commit();
+}
+
+
+
+// Convert buffer inBuf to rlecompress rle encoding and write out to outBuf
+// Returns converted length
+uint32_t rlecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    initbufs(inBuf, size_in, pp_outBuf, size_out);
+
+    rle_encode(Fsize_in);
+    write_end_of_data();
+
+    return FoutIndex;
+
+}
+
+
+
+// Same as rlecompress_buf(), but every record of record_size bytes
+// starts on a control byte so decompression can start at any of them.
+// The output offset of each record is written to p_index, which
+// must have room for (size_in + record_size - 1) / record_size entries.
+// Returns converted length
+uint32_t rlecompress_buf_indexed(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out,
+                                 uint32_t record_size, uint32_t * p_index) {
+
+    uint32_t record_end;
+
+    initbufs(inBuf, size_in, pp_outBuf, size_out);
+
+    while (FinIndex < Fsize_in) {
+        *p_index++ = FoutIndex;
+        record_end = FinIndex + record_size;
+        rle_encode((record_end < Fsize_in) ? record_end : Fsize_in);
+    }
     write_end_of_data();
 
     return FoutIndex;
@@ -230,3 +266,41 @@ uint32_t rledecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outB
 
     return FoutIndex;
 }
+
+
+// Estimated number of GB CPU cycles (M-cycles, 1.05 MHz) rle_decompress() in
+// libc/targets/sm83/rle_decompress.s takes for inBuf, counted from its loops,
+// with the data read 255 bytes per call
+uint32_t rle_decode_cycles_sm83(uint8_t * inBuf, uint32_t size_in) {
+
+    uint32_t index = 0;
+    uint32_t cycles = 0;
+    uint32_t out_len = 0;
+    uint32_t len;
+    uint8_t  token;
+
+    while (index < size_in) {
+
+        token = inBuf[index++];
+        if (token == RLE_CTRL_END) {
+            cycles += 26;
+            break;
+        }
+        else if ((token & RLE_MASK_TYPE) == RLE_TYPE_RAND) {
+            len = token & RLE_MASK_LEN;
+            cycles += 15 + (len * 13);
+            index += len;
+        }
+        else {
+            len = ((token ^ 0xFF) + 1) & RLE_MASK_LEN;
+            cycles += 12 + (len * 11);
+            index += 1;
+        }
+        out_len += len;
+    }
+
+    // Call, resuming from the saved state and saving it again
+    cycles += ((out_len + 254) / 255) * 60;
+
+    return cycles;
+}
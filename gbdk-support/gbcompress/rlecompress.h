@@ -6,7 +6,10 @@
 #define _RLECOMPRESS_H
 
 uint32_t rlecompress_buf(uint8_t * inBuf, uint32_t InSize, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t rlecompress_buf_indexed(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out,
+                                 uint32_t record_size, uint32_t * p_index);
 uint32_t rledecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t rle_decode_cycles_sm83(uint8_t * inBuf, uint32_t size_in);
 uint32_t rlecompress_buf_escaped(uint8_t * inBuf, uint32_t InSize, uint8_t ** pp_outBuf, uint32_t size_out);
 
 #endif // _RLECOMPRESS_H
@@ -0,0 +1,320 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Tile compression for 2bpp tile data (16 bytes per tile, two bitplanes per row)
+//
+// The data is a list of tiles, each one is either:
+// * two mode bytes with 2 bits per row (rows 0-3 in the first byte, row 0 in the top bits)
+//   followed by the data of the rows:
+//   00: low and high plane, 2 bytes
+//   01: both planes are the same, 1 byte
+//   10: high plane is zero, 1 byte (low plane)
+//   11: same as the row before, no data
+// * a reference to an earlier tile, which starts with the bits 11 (row 0 has no row
+//   before it): the other 6 bits and the next byte are the 14 bit distance back from the
+//   reference to the mode bytes of that tile, which are decoded again
+//   (a distance of 0 marks the end of the data)
+//
+// References point into the compressed data instead of the output, so only the row
+// before in the same tile is read back from the output.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "common.h"
+#include "tilecompress.h"
+
+
+static THREAD_LOCAL uint8_t * FinBuf      = NULL;
+static THREAD_LOCAL uint32_t  Fsize_in    = 0;
+static THREAD_LOCAL uint32_t  FinIndex    = 0;
+
+static THREAD_LOCAL uint8_t ** pp_FoutBuf = NULL;
+static THREAD_LOCAL uint8_t * FoutBuf     = NULL;
+static THREAD_LOCAL uint32_t  Fsize_out   = 0;
+static THREAD_LOCAL uint32_t  FoutIndex   = 0;
+
+
+#define TILE_SIZE        16u
+#define TILE_ROWS        8u
+
+#define ROW_BOTH         0x00u
+#define ROW_EQUAL        0x01u
+#define ROW_HIGH_ZERO    0x02u
+#define ROW_REPEAT       0x03u
+
+#define TILE_REF         0xC0u
+#define TILE_REF_MAX     0x3FFFu
+#define TILE_REF_END     0x0000u
+
+#define TILE_NONE        0xFFFFFFFFu
+
+
+// Initialize the buffer vars
+static void initbufs(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    FinBuf     = inBuf;
+    Fsize_in   = size_in;
+    FinIndex   = 0;
+
+    pp_FoutBuf = pp_outBuf;
+    FoutBuf    = *pp_outBuf;
+    Fsize_out  = size_out;
+    FoutIndex = 0;
+}
+
+
+static void check_write_size(uint32_t len) {
+
+    // Grow output buffer if needed
+    while ((FoutIndex + len) >= Fsize_out) {
+        uint8_t * p_tmp = *pp_FoutBuf;
+
+        // Reallocate to twice as large
+        Fsize_out = (Fsize_out) ? Fsize_out * 2 : 256;
+        *pp_FoutBuf = (void *)realloc(*pp_FoutBuf, Fsize_out);
+
+        // If realloc failed, free original buffer before quitting
+        if (!(*pp_FoutBuf)) {
+            printf("Error: Failed to grow memory for output buffer!\n");
+            if (p_tmp) free(p_tmp);
+            p_tmp = NULL;
+            exit(EXIT_FAILURE);
+        } else
+            FoutBuf = *pp_FoutBuf; // Update working pointer
+    }
+}
+
+
+// Row mode with the fewest bytes, row 0 can't use ROW_REPEAT since it marks a reference
+static uint8_t row_mode(const uint8_t * p_row, uint32_t row) {
+
+    if ((row != 0) && (p_row[0] == p_row[-2]) && (p_row[1] == p_row[-1]))
+        return ROW_REPEAT;
+    else if (p_row[0] == p_row[1])
+        return ROW_EQUAL;
+    else if (p_row[1] == 0)
+        return ROW_HIGH_ZERO;
+    else
+        return ROW_BOTH;
+}
+
+
+static void write_tile(const uint8_t * p_tile) {
+
+    uint8_t  modes[2] = {0, 0};
+    uint8_t  mode;
+    uint32_t row;
+
+    check_write_size(2 + TILE_SIZE);
+
+    for (row = 0; row < TILE_ROWS; row++)
+        modes[row / 4] |= row_mode(&p_tile[row * 2], row) << (6 - ((row % 4) * 2));
+    FoutBuf[FoutIndex++] = modes[0];
+    FoutBuf[FoutIndex++] = modes[1];
+
+    for (row = 0; row < TILE_ROWS; row++) {
+        mode = row_mode(&p_tile[row * 2], row);
+        if (mode != ROW_REPEAT)
+            FoutBuf[FoutIndex++] = p_tile[row * 2];
+        if (mode == ROW_BOTH)
+            FoutBuf[FoutIndex++] = p_tile[(row * 2) + 1];
+    }
+}
+
+
+static void write_ref(uint32_t distance) {
+
+    check_write_size(2);
+    FoutBuf[FoutIndex++] = TILE_REF | ((distance >> 8) & 0x3Fu);
+    FoutBuf[FoutIndex++] = distance & 0xFFu;
+}
+
+
+uint32_t tilecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    uint32_t   tile_count = size_in / TILE_SIZE;
+    uint32_t * p_tile_pos;  // Output position of the encoded tile data for each input tile, if it has any
+    uint32_t   tile, c;
+    uint32_t   ref_pos;
+
+    if (size_in % TILE_SIZE) {
+        printf("gbcompress: ERROR: --alg=tile input size %d is not a multiple of %d bytes (one tile)\n", size_in, TILE_SIZE);
+        return 0;
+    }
+
+    p_tile_pos = malloc((tile_count ? tile_count : 1) * sizeof(uint32_t));
+    if (!p_tile_pos) {
+        printf("Error: Failed to allocate memory for tile positions!\n");
+        return 0;
+    }
+
+    initbufs(inBuf, size_in, pp_outBuf, size_out);
+
+    for (tile = 0; tile < tile_count; tile++) {
+
+        // Reference the most recent copy of the tile which was written out in full and is in reach
+        ref_pos = TILE_NONE;
+        for (c = tile; c-- > 0; ) {
+            if ((p_tile_pos[c] != TILE_NONE) &&
+                (memcmp(&FinBuf[c * TILE_SIZE], &FinBuf[tile * TILE_SIZE], TILE_SIZE) == 0)) {
+                if ((FoutIndex - p_tile_pos[c]) <= TILE_REF_MAX)
+                    ref_pos = p_tile_pos[c];
+                break;
+            }
+        }
+
+        if (ref_pos != TILE_NONE) {
+            write_ref(FoutIndex - ref_pos);
+            p_tile_pos[tile] = TILE_NONE;
+        } else {
+            p_tile_pos[tile] = FoutIndex;
+            write_tile(&FinBuf[tile * TILE_SIZE]);
+        }
+    }
+    write_ref(TILE_REF_END);
+
+    free(p_tile_pos);
+    return FoutIndex;
+}
+
+
+static uint8_t read_single_byte(void) {
+
+    if (FinIndex < Fsize_in)
+        return FinBuf[FinIndex++];
+
+    printf("Error: Tile data ended without an end marker!\n");
+    return 0;
+}
+
+
+// Decodes the tile with the mode bytes at FinIndex
+static void read_tile(void) {
+
+    uint8_t  modes[2], mode, data;
+    uint32_t row;
+
+    modes[0] = read_single_byte();
+    modes[1] = read_single_byte();
+
+    check_write_size(TILE_SIZE);
+    for (row = 0; row < TILE_ROWS; row++) {
+        mode = (modes[row / 4] >> (6 - ((row % 4) * 2))) & 0x03u;
+        if (mode == ROW_REPEAT) {
+            FoutBuf[FoutIndex] = FoutBuf[FoutIndex - 2];
+            FoutBuf[FoutIndex + 1] = FoutBuf[FoutIndex - 1];
+            FoutIndex += 2;
+            continue;
+        }
+        data = read_single_byte();
+        switch (mode) {
+            case ROW_BOTH:      FoutBuf[FoutIndex++] = data; FoutBuf[FoutIndex++] = read_single_byte(); break;
+            case ROW_EQUAL:     FoutBuf[FoutIndex++] = data; FoutBuf[FoutIndex++] = data; break;
+            case ROW_HIGH_ZERO: FoutBuf[FoutIndex++] = data; FoutBuf[FoutIndex++] = 0;    break;
+        }
+    }
+}
+
+
+uint32_t tiledecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out) {
+
+    uint32_t distance, pos, resume;
+
+    initbufs(inBuf, size_in, pp_outBuf, size_out);
+
+    while (FinIndex < Fsize_in) {
+
+        pos = FinIndex;
+        if ((FinBuf[pos] & TILE_REF) != TILE_REF) {
+            read_tile();
+            continue;
+        }
+
+        distance = (read_single_byte() & 0x3Fu) << 8;
+        distance |= read_single_byte();
+        if (distance == TILE_REF_END)
+            break;
+        if ((distance > pos) || ((FinBuf[pos - distance] & TILE_REF) == TILE_REF)) {
+            printf("Error: Tile reference to something other than a tile!\n");
+            return 0;
+        }
+
+        resume = FinIndex;
+        FinIndex = pos - distance;
+        read_tile();
+        FinIndex = resume;
+    }
+
+    return FoutIndex;
+}
+
+
+// Cycles of .tile_rows in libc/targets/sm83/tile_decompress.s for one tile, including the call
+static uint32_t tile_cycles_sm83(uint8_t * inBuf, uint32_t size_in, uint32_t index) {
+
+    // Cycles for each row mode, the last row of each half has 3 more (jr not taken, ret)
+    static const uint8_t row_cycles[4] = {24, 23, 27, 42};
+    uint32_t cycles = 6 + 2 + 1 + 2 + 4 + 6 + 3 + 1 + (2 * (2 + 3));
+    uint32_t row;
+    uint8_t  modes;
+
+    for (row = 0; row < TILE_ROWS; row++) {
+        modes = ((index + (row / 4)) < size_in) ? inBuf[index + (row / 4)] : 0;
+        cycles += row_cycles[(modes >> (6 - ((row % 4) * 2))) & 0x03u];
+    }
+    return cycles;
+}
+
+
+// Length of the tile data with the mode bytes at index
+static uint32_t tile_len(uint8_t * inBuf, uint32_t size_in, uint32_t index) {
+
+    uint32_t len = 2;
+    uint32_t row;
+    uint8_t  modes;
+
+    for (row = 0; row < TILE_ROWS; row++) {
+        modes = ((index + (row / 4)) < size_in) ? inBuf[index + (row / 4)] : 0;
+        switch ((modes >> (6 - ((row % 4) * 2))) & 0x03u) {
+            case ROW_BOTH:   len += 2; break;
+            case ROW_REPEAT: break;
+            default:         len += 1; break;
+        }
+    }
+    return len;
+}
+
+
+// Estimated number of GB CPU cycles (M-cycles, 1.05 MHz) tile_decompress() in
+// libc/targets/sm83/tile_decompress.s takes for inBuf, counted from its code paths
+uint32_t tile_decode_cycles_sm83(uint8_t * inBuf, uint32_t size_in) {
+
+    uint32_t index = 0;
+    uint32_t cycles = 0;
+    uint32_t distance;
+
+    while (index < size_in) {
+
+        if ((inBuf[index] & TILE_REF) != TILE_REF) {
+            cycles += 6 + tile_cycles_sm83(inBuf, size_in, index) + 3;
+            index += tile_len(inBuf, size_in, index);
+            continue;
+        }
+
+        if ((index + 1) >= size_in)
+            break;
+        distance = ((inBuf[index] & 0x3Fu) << 8) | inBuf[index + 1];
+        if (distance == TILE_REF_END) {
+            cycles += 8 + 19 + 13;
+            break;
+        }
+        if (distance <= index)
+            cycles += 32 + tile_cycles_sm83(inBuf, size_in, index - distance) + 6;
+        index += 2;
+    }
+
+    return cycles;
+}
@@ -0,0 +1,11 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _TILECOMPRESS_H
+#define _TILECOMPRESS_H
+
+uint32_t tilecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t tiledecompress_buf(uint8_t * inBuf, uint32_t size_in, uint8_t ** pp_outBuf, uint32_t size_out);
+uint32_t tile_decode_cycles_sm83(uint8_t * inBuf, uint32_t size_in);
+
+#endif // _TILECOMPRESS_H
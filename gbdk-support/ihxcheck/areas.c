@@ -19,6 +19,19 @@ area_item * arealist;
 uint32_t    arealist_size;
 uint32_t    arealist_count;
 
+// Indexes into arealist, sorted by area start address.
+// With the longest area length known, only areas starting in
+// [new start - longest length, new end] need to be checked for overlap
+uint32_t *  area_sorted;
+uint32_t    area_len_max;
+
+// Scratch list of areas which overlap the one being added
+uint32_t *  area_overlaps;
+uint32_t    area_overlaps_size;
+
+// Where overlap warnings go, stdout unless set with areas_set_warning_file()
+static FILE * area_warning_file = NULL;
+
 
 uint32_t min(uint32_t a, uint32_t b) {
     return (a < b) ? a : b;
@@ -29,6 +42,11 @@ uint32_t max(uint32_t a, uint32_t b) {
 }
 
 
+void areas_set_warning_file(FILE * warning_file) {
+    area_warning_file = warning_file;
+}
+
+
 // Returns size of overlap between two address ranges,
 // if zero then no overlap
 static uint32_t addrs_check_overlap(uint32_t a_start, uint32_t a_end, uint32_t b_start, uint32_t b_end) {
@@ -48,23 +66,159 @@ static uint32_t addrs_check_overlap(uint32_t a_start, uint32_t a_end, uint32_t b
         // Used later to check for overflows
         banks[BANK_NUM(overlap_end)].had_multiple_write_warning = true;
 
-        printf("Warning: Multiple write of %5d bytes at 0x%x -> 0x%x writes:(0x%x -> 0x%x, 0x%x -> 0x%x)\n",
+        fprintf(area_warning_file ? area_warning_file : stdout,
+                "Warning: Multiple write of %5d bytes at 0x%x -> 0x%x writes:(0x%x -> 0x%x, 0x%x -> 0x%x)\n",
                 size_used, overlap_start, overlap_end, a_start, a_end, b_start, b_end);
     }
     return size_used;
 }
 
 
+// Returns the position of the first sorted area which starts after addr
+static uint32_t area_sorted_find_after(uint32_t addr) {
+
+    uint32_t lo = 0;
+    uint32_t hi = arealist_count;
+    uint32_t mid;
+
+    while (lo < hi) {
+        mid = lo + ((hi - lo) / 2);
+        if (arealist[ area_sorted[mid] ].start <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+
+static int overlap_id_compare(const void * a, const void * b) {
+
+    uint32_t id_a = *(const uint32_t *)a;
+    uint32_t id_b = *(const uint32_t *)b;
+
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+
 void arealist_additem(area_item * p_area) {
 
+    uint32_t pos;
+
     arealist_count++;
     // Grow array if needed
     if (arealist_count == arealist_size) {
         arealist_size += AREA_GROW_SIZE;
         arealist = (area_item *)realloc(arealist, arealist_size * sizeof(area_item));
+        area_sorted = (uint32_t *)realloc(area_sorted, arealist_size * sizeof(uint32_t));
     }
 
     arealist[arealist_count-1] = *p_area;
+
+    // Insert into the sorted index after any areas with the same start,
+    // areas mostly arrive in ascending order so this is usually an append
+    arealist_count--;
+    pos = area_sorted_find_after(p_area->start);
+    memmove(&area_sorted[pos + 1], &area_sorted[pos], (arealist_count - pos) * sizeof(uint32_t));
+    area_sorted[pos] = arealist_count;
+    arealist_count++;
+
+    if (p_area->end - p_area->start + 1 > area_len_max)
+        area_len_max = p_area->end - p_area->start + 1;
+}
+
+
+// Writes the used ROM ranges per bank as a JSON array, merging overlapping and adjacent areas
+void areas_report_write(FILE * out_file) {
+
+    uint32_t c;
+    uint32_t start, end, piece_end;
+    uint32_t bank, bank_cur = 0xFFFFFFFFU, used = 0;
+    bool     range_first = true;
+
+    fprintf(out_file, "[");
+    c = 0;
+    while (c < arealist_count) {
+        // Merge a run of sorted areas
+        start = arealist[ area_sorted[c] ].start;
+        end   = arealist[ area_sorted[c] ].end;
+        for (c++; (c < arealist_count) && (arealist[ area_sorted[c] ].start <= end + 1); c++)
+            end = max(end, arealist[ area_sorted[c] ].end);
+
+        // Split the merged range at bank boundaries
+        while (start <= end) {
+            bank = BANK_NUM(start);
+            piece_end = min(end, (bank << 14) | 0x3FFFU);
+            if (bank != bank_cur) {
+                if (bank_cur != 0xFFFFFFFFU)
+                    fprintf(out_file, "], \"used\": %u}", used);
+                fprintf(out_file, "%s\n      {\"bank\": %u, \"ranges\": [", (bank_cur == 0xFFFFFFFFU) ? "" : ",", bank);
+                bank_cur = bank;
+                used = 0;
+                range_first = true;
+            }
+            fprintf(out_file, "%s[%u, %u]", range_first ? "" : ", ", start, piece_end);
+            range_first = false;
+            used += piece_end - start + 1;
+            start = piece_end + 1;
+        }
+    }
+    if (bank_cur != 0xFFFFFFFFU)
+        fprintf(out_file, "], \"used\": %u}\n    ", used);
+    fprintf(out_file, "]");
+}
+
+
+// Fills in the bank_fill entry of each of the BANKS_MAX_COUNT banks, merging
+// overlapping and adjacent areas the same way as areas_report_write()
+void areas_bank_fill_calc(bank_fill * fills) {
+
+    uint32_t c;
+    uint32_t start, end, piece_end, gap;
+    uint32_t bank;
+    uint32_t bank_next[BANKS_MAX_COUNT];  // Bank offset after the last written byte
+
+    for (c = 0; c < BANKS_MAX_COUNT; c++) {
+        fills[c] = (bank_fill){.used = 0, .free_largest = BANK_SIZE, .free_blocks = 1, .free_end = BANK_SIZE};
+        bank_next[c] = 0;
+    }
+
+    c = 0;
+    while (c < arealist_count) {
+        start = arealist[ area_sorted[c] ].start;
+        end   = arealist[ area_sorted[c] ].end;
+        for (c++; (c < arealist_count) && (arealist[ area_sorted[c] ].start <= end + 1); c++)
+            end = max(end, arealist[ area_sorted[c] ].end);
+
+        while ((start <= end) && (BANK_NUM(start) < BANKS_MAX_COUNT)) {
+            bank = BANK_NUM(start);
+            piece_end = min(end, (bank << 14) | 0x3FFFU);
+
+            // The first piece of a bank replaces the all free default
+            if (fills[bank].used == 0) {
+                fills[bank].free_largest = 0;
+                fills[bank].free_blocks  = 0;
+            }
+            gap = (start & 0x3FFFU) - bank_next[bank];
+            if (gap) {
+                fills[bank].free_blocks++;
+                fills[bank].free_largest = max(fills[bank].free_largest, gap);
+            }
+            fills[bank].used += piece_end - start + 1;
+            bank_next[bank] = (piece_end & 0x3FFFU) + 1;
+            start = piece_end + 1;
+        }
+    }
+
+    for (c = 0; c < BANKS_MAX_COUNT; c++) {
+        if (fills[c].used == 0)
+            continue;
+        fills[c].free_end = BANK_SIZE - bank_next[c];
+        if (fills[c].free_end) {
+            fills[c].free_blocks++;
+            fills[c].free_largest = max(fills[c].free_largest, fills[c].free_end);
+        }
+    }
 }
 
 
@@ -72,30 +226,63 @@ void areas_init(void) {
     arealist_count  = 0;
     arealist_size   = AREA_GROW_SIZE;
     arealist        = (area_item *)malloc(arealist_size * sizeof(area_item));
+    area_sorted     = (uint32_t *)malloc(arealist_size * sizeof(uint32_t));
+    area_len_max    = 0;
+
+    area_overlaps_size = 0;
+    area_overlaps      = NULL;
 }
 
 
 void areas_cleanup(void) {
     if (arealist)
         free (arealist);
+    if (area_sorted)
+        free (area_sorted);
+    if (area_overlaps)
+        free (area_overlaps);
+    arealist = NULL;
+    area_sorted = NULL;
+    area_overlaps = NULL;
 }
 
 
 int areas_add(area_item * p_area) {
 
     uint32_t c;
-    uint32_t size_used;
+    uint32_t pos;
+    uint32_t id;
+    uint32_t overlap_count = 0;
+    uint32_t search_start;
     int ret = true; // default to success
 
-    // Check for overlap with existing areas
-    for (c = 0; c < arealist_count; c++) {
+    // Collect existing areas which overlap: those starting at or before the
+    // new end, and no further back than the longest area could reach
+    search_start = (p_area->start > area_len_max) ? p_area->start - area_len_max : 0;
+    pos = area_sorted_find_after(p_area->end);
+    while (pos > 0) {
+        pos--;
+        id = area_sorted[pos];
+        if (arealist[id].start < search_start)
+            break;
+        if (arealist[id].end >= p_area->start) {
+            if (overlap_count == area_overlaps_size) {
+                area_overlaps_size += AREA_GROW_SIZE;
+                area_overlaps = (uint32_t *)realloc(area_overlaps, area_overlaps_size * sizeof(uint32_t));
+            }
+            area_overlaps[overlap_count++] = id;
+        }
+    }
+
+    // Report in the order the areas were added
+    qsort(area_overlaps, overlap_count, sizeof(uint32_t), overlap_id_compare);
+    for (c = 0; c < overlap_count; c++) {
 
-        size_used = addrs_check_overlap(arealist[c].start, arealist[c].end,
-                                        p_area->start, p_area->end);
+        addrs_check_overlap(arealist[ area_overlaps[c] ].start, arealist[ area_overlaps[c] ].end,
+                            p_area->start, p_area->end);
         // Signal failure on any overlap
         // (Keep looping to display all warnings though)
-        if (size_used > 0)
-            ret = false;
+        ret = false;
     }
 
     // Now add the area
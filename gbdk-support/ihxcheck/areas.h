@@ -17,11 +17,23 @@ typedef struct bank_info {
     bool     had_multiple_write_warning;
 } bank_info;
 
+// ROM use of a bank, from the merged areas
+typedef struct bank_fill {
+    uint32_t used;          // Bytes written
+    uint32_t free_largest;  // Largest unwritten block
+    uint32_t free_blocks;   // Number of unwritten blocks
+    uint32_t free_end;      // Unwritten bytes after the last written one
+} bank_fill;
+
 #define BANKS_MAX_COUNT  512
+#define BANK_SIZE        0x4000U
 #define BANK_NUM(addr)  ((addr & 0xFFFFC000U) >> 14)
 
+void areas_set_warning_file(FILE * warning_file);
 void areas_init(void);
 void areas_cleanup(void);
 int areas_add(area_item * p_area);
+void areas_report_write(FILE * out_file);
+void areas_bank_fill_calc(bank_fill * fills);
 
 #endif // _AREAS_H
\ No newline at end of file
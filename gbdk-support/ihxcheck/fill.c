@@ -0,0 +1,370 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Bank fill levels for -fill, and suggested moves of auto-banked
+// areas (from the bankpack -report= JSON) which would empty sparse banks
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "areas.h"
+#include "fill.h"
+
+#define MAX_STR_LEN      4096
+#define FILL_BAR_LEN     32
+#define FILL_AREAS_GROW  256
+#define BANK_NONE        0xFFFFFFFFU
+
+// An area from the bankpack report
+typedef struct fill_area {
+    char     name[32];
+    char     module[MAX_STR_LEN];
+    uint32_t size;
+    uint32_t bank;
+    uint32_t bank_new;      // Suggested bank, or BANK_NONE
+    bool     is_auto;
+} fill_area;
+
+// A bank from the bankpack report
+typedef struct fill_bank {
+    bool     in_report;
+    bool     has_fixed;     // Has areas which can't be moved
+    bool     has_auto;
+    bool     emptied;       // All its areas have a suggested bank
+    bool     received;      // Areas are suggested to move into it
+    char     type[8];       // "code", "lit" or "unset"
+    uint32_t free;          // Free bytes as counted by bankpack
+    uint32_t space;         // Bytes the suggested moves can still use
+} fill_bank;
+
+static fill_area * fill_areas = NULL;
+static uint32_t    fill_area_count = 0;
+static uint32_t    fill_area_size = 0;
+static fill_bank   fill_banks[BANKS_MAX_COUNT];
+static uint32_t    report_bank_min = 0;
+static uint32_t    report_bank_max = BANKS_MAX_COUNT - 1;
+
+
+// Copies the JSON string value of "key" in line into out, false if not found
+static bool json_str_get(const char * line, const char * key, char * out, size_t out_size) {
+
+    char   keystr[64];
+    char * p;
+    size_t len = 0;
+
+    snprintf(keystr, sizeof(keystr), "\"%s\": \"", key);
+    p = strstr(line, keystr);
+    if (!p)
+        return false;
+
+    for (p += strlen(keystr); (*p != '\0') && (*p != '"'); p++) {
+        if ((*p == '\\') && (p[1] != '\0'))
+            p++;
+        if (len + 1 < out_size)
+            out[len++] = *p;
+    }
+    out[len] = '\0';
+    return true;
+}
+
+
+// Reads the banks and areas written by bankpack -report=
+// Returns false if it has no bankpack member
+static bool fill_report_read(char * filename_report) {
+
+    char       strline_in[MAX_STR_LEN];
+    char *     p;
+    uint32_t   bank_cur = BANK_NONE;
+    uint32_t   bank_num, size, free_bytes;
+    int        bank_in;
+    bool       found = false;
+    fill_area  area;
+    FILE *     report_file = fopen(filename_report, "r");
+
+    if (!report_file)
+        return false;
+
+    while (fgets(strline_in, sizeof(strline_in), report_file) != NULL) {
+
+        if ((p = strstr(strline_in, "\"bankpack\": {"))) {
+            found = true;
+            if ((p = strstr(strline_in, "\"bank_min\": ")))
+                sscanf(p, "\"bank_min\": %u, \"bank_max\": %u", &report_bank_min, &report_bank_max);
+
+        // Bank entries of the bankpack member have an area list, the ones of the ihx member don't
+        } else if ((p = strstr(strline_in, "{\"bank\": ")) && strstr(strline_in, "\"areas\": [")) {
+            if ((3 == sscanf(p, "{\"bank\": %u, \"size\": %u, \"free\": %u", &bank_num, &size, &free_bytes))
+                && (bank_num < BANKS_MAX_COUNT)) {
+                bank_cur = bank_num;
+                fill_banks[bank_cur].in_report = true;
+                fill_banks[bank_cur].free = free_bytes;
+                json_str_get(strline_in, "type", fill_banks[bank_cur].type, sizeof(fill_banks[bank_cur].type));
+            } else
+                bank_cur = BANK_NONE;
+
+        } else if ((bank_cur != BANK_NONE) && (p = strstr(strline_in, "{\"name\": "))) {
+            char placement[16];
+
+            if (!json_str_get(strline_in, "name", area.name, sizeof(area.name)) ||
+                !json_str_get(strline_in, "placement", placement, sizeof(placement)) ||
+                !(p = strstr(strline_in, "\"size\": ")) || (1 != sscanf(p, "\"size\": %u", &area.size)) ||
+                !(p = strstr(strline_in, "\"bank_in\": ")) || (1 != sscanf(p, "\"bank_in\": %d", &bank_in)))
+                continue;
+            // Older reports have no module name, those areas can't be matched to the -stable= map
+            if (!json_str_get(strline_in, "module", area.module, sizeof(area.module)))
+                area.module[0] = '\0';
+            area.bank = bank_cur;
+            area.bank_new = BANK_NONE;
+            area.is_auto = (strcmp(placement, "auto") == 0) && (area.module[0] != '\0');
+
+            if (area.is_auto)
+                fill_banks[bank_cur].has_auto = true;
+            else
+                fill_banks[bank_cur].has_fixed = true;
+
+            if (fill_area_count == fill_area_size) {
+                fill_area_size += FILL_AREAS_GROW;
+                fill_areas = (fill_area *)realloc(fill_areas, fill_area_size * sizeof(fill_area));
+                if (!fill_areas) {
+                    printf("Error: Failed to allocate memory for report areas!\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            fill_areas[fill_area_count++] = area;
+        }
+    }
+    fclose(report_file);
+    return found;
+}
+
+
+static int fill_area_size_compare(const void * a, const void * b) {
+
+    const fill_area * area_a = *(const fill_area **)a;
+    const fill_area * area_b = *(const fill_area **)b;
+
+    return (area_b->size > area_a->size) - (area_b->size < area_a->size);
+}
+
+
+// Best fit bank for an area among the ones it may move into, or BANK_NONE
+static uint32_t fill_bank_find(fill_area * p_area, uint32_t bank_from) {
+
+    uint32_t c;
+    uint32_t best = BANK_NONE;
+
+    for (c = report_bank_min; (c <= report_bank_max) && (c < BANKS_MAX_COUNT); c++) {
+        if ((c == bank_from) || !fill_banks[c].in_report || fill_banks[c].emptied ||
+            (fill_banks[c].space < p_area->size))
+            continue;
+        // Banks hold either _CODE_ or _LIT_ areas
+        if (strcmp(fill_banks[c].type, (strcmp(p_area->name, "_LIT_") == 0) ? "lit" : "code") != 0)
+            continue;
+        if ((best == BANK_NONE) || (fill_banks[c].space < fill_banks[best].space))
+            best = c;
+    }
+    return best;
+}
+
+
+// Tries to move all areas of a bank into the free space of other banks,
+// largest first. Keeps the moves and returns true if they all fit
+static bool fill_bank_try_empty(uint32_t bank_num) {
+
+    fill_area ** p_list;
+    uint32_t     count = 0, c, bank_to;
+    bool         ok = true;
+
+    p_list = (fill_area **)malloc((fill_area_count ? fill_area_count : 1) * sizeof(fill_area *));
+    if (!p_list) {
+        printf("Error: Failed to allocate memory for area list!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (c = 0; c < fill_area_count; c++)
+        if ((fill_areas[c].bank == bank_num) && (fill_areas[c].bank_new == BANK_NONE))
+            p_list[count++] = &fill_areas[c];
+    qsort(p_list, count, sizeof(fill_area *), fill_area_size_compare);
+
+    for (c = 0; (c < count) && ok; c++) {
+        bank_to = fill_bank_find(p_list[c], bank_num);
+        if (bank_to == BANK_NONE)
+            ok = false;
+        else {
+            p_list[c]->bank_new = bank_to;
+            fill_banks[bank_to].space -= p_list[c]->size;
+            fill_banks[bank_to].received = true;
+        }
+    }
+
+    // Undo the moves which were made if not all of them fit
+    if (!ok) {
+        for (c = 0; c < count; c++) {
+            if (p_list[c]->bank_new != BANK_NONE) {
+                fill_banks[ p_list[c]->bank_new ].space += p_list[c]->size;
+                p_list[c]->bank_new = BANK_NONE;
+            }
+        }
+        for (c = 0; c < BANKS_MAX_COUNT; c++)
+            fill_banks[c].received = false;
+        for (c = 0; c < fill_area_count; c++)
+            if (fill_areas[c].bank_new != BANK_NONE)
+                fill_banks[ fill_areas[c].bank_new ].received = true;
+    }
+
+    free(p_list);
+    return ok;
+}
+
+
+// Suggests moves which empty banks holding only auto-banked areas, least full first
+static uint32_t fill_suggest(bank_fill * fills) {
+
+    uint32_t c, bank_num, moved = 0;
+    uint32_t order[BANKS_MAX_COUNT];
+    uint32_t order_count = 0;
+
+    for (c = 0; c < BANKS_MAX_COUNT; c++) {
+        if (!fill_banks[c].in_report)
+            continue;
+        // New areas go after the last written byte, and bankpack has to agree they fit
+        fill_banks[c].space = (fills[c].free_end < fill_banks[c].free) ? fills[c].free_end : fill_banks[c].free;
+        if (fill_banks[c].has_auto && !fill_banks[c].has_fixed)
+            order[order_count++] = c;
+    }
+
+    // Sort the candidates by bytes used, ascending (insertion sort, there are few)
+    for (c = 1; c < order_count; c++) {
+        uint32_t n = order[c], i = c;
+        while ((i > 0) && (fills[ order[i - 1] ].used > fills[n].used)) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = n;
+    }
+
+    // A bank which areas were moved into isn't emptied any more
+    for (c = 0; c < order_count; c++) {
+        bank_num = order[c];
+        if (!fill_banks[bank_num].received && fill_bank_try_empty(bank_num)) {
+            fill_banks[bank_num].emptied = true;
+            moved++;
+        }
+    }
+    return moved;
+}
+
+
+// Rewrites the bankpack -stable= map with the suggested banks
+// Lines are "<bank> <area> <module>", other lines are kept as they are
+static void fill_stable_map_update(char * filename_stable) {
+
+    char     area_name[32];
+    char     module[MAX_STR_LEN];
+    char *   buf;
+    char *   line;
+    char *   line_next;
+    long     len;
+    uint32_t bank_num, c, updated = 0;
+    FILE *   map_file = fopen(filename_stable, "rb");
+
+    if (!map_file) {
+        printf("Warning: Unable to open -stable= map %s, not updated\n", filename_stable);
+        return;
+    }
+    fseek(map_file, 0, SEEK_END);
+    len = ftell(map_file);
+    fseek(map_file, 0, SEEK_SET);
+    buf = malloc(len + 1);
+    if (!buf || (fread(buf, 1, len, map_file) != (size_t)len)) {
+        printf("Warning: Unable to read -stable= map %s, not updated\n", filename_stable);
+        fclose(map_file);
+        free(buf);
+        return;
+    }
+    buf[len] = '\0';
+    fclose(map_file);
+
+    map_file = fopen(filename_stable, "wb");
+    if (!map_file) {
+        printf("Warning: Unable to write -stable= map %s\n", filename_stable);
+        free(buf);
+        return;
+    }
+    for (line = buf; *line != '\0'; line = line_next) {
+        line_next = strchr(line, '\n');
+        line_next = line_next ? line_next + 1 : line + strlen(line);
+
+        if ((line[0] != '#') &&
+            (3 == sscanf(line, "%u %31s %4095s", &bank_num, area_name, module))) {
+            for (c = 0; c < fill_area_count; c++) {
+                if ((fill_areas[c].bank_new != BANK_NONE) && (fill_areas[c].bank == bank_num) &&
+                    (strcmp(fill_areas[c].name, area_name) == 0) && (strcmp(fill_areas[c].module, module) == 0))
+                    break;
+            }
+            if (c < fill_area_count) {
+                fprintf(map_file, "%u %s %s\n", fill_areas[c].bank_new, area_name, module);
+                updated++;
+                continue;
+            }
+        }
+        fwrite(line, 1, line_next - line, map_file);
+    }
+    fclose(map_file);
+    free(buf);
+    printf("Updated %u entries of -stable= map %s, relink for bankpack to use them\n", updated, filename_stable);
+}
+
+
+// Prints how full each ROM bank is with its free blocks, and with a bankpack
+// report, which auto-banked areas could move so that sparse banks are emptied
+void fill_report(char * filename_report, char * filename_stable) {
+
+    bank_fill fills[BANKS_MAX_COUNT];
+    uint32_t  c, i, bar, moved;
+
+    areas_bank_fill_calc(fills);
+
+    printf("\nROM bank fill:\n");
+    for (c = 0; c < BANKS_MAX_COUNT; c++) {
+        if (fills[c].used == 0)
+            continue;
+        bar = ((fills[c].used * FILL_BAR_LEN) + (BANK_SIZE / 2)) / BANK_SIZE;
+        printf("Bank %3u: [", c);
+        for (i = 0; i < FILL_BAR_LEN; i++)
+            putchar((i < bar) ? '#' : '.');
+        printf("] %5u used (%5.1f%%), %5u free in %u block(s), largest %5u\n",
+               fills[c].used, (fills[c].used * 100.0) / BANK_SIZE, BANK_SIZE - fills[c].used,
+               fills[c].free_blocks, fills[c].free_largest);
+    }
+
+    if ((filename_report == NULL) || (filename_report[0] == '\0'))
+        return;
+
+    memset(fill_banks, 0, sizeof(fill_banks));
+    fill_area_count = 0;
+    if (!fill_report_read(filename_report)) {
+        printf("No bankpack -report= data in %s, no area suggestions\n", filename_report);
+        return;
+    }
+
+    moved = fill_suggest(fills);
+    if (moved == 0)
+        printf("No bank with only auto-banked areas can be emptied into the free space of the others\n");
+    else {
+        printf("Moving these auto-banked areas would empty %u bank(s):\n", moved);
+        for (c = 0; c < fill_area_count; c++)
+            if (fill_areas[c].bank_new != BANK_NONE)
+                printf("  %-6s %5u bytes of %s: bank %u -> %u\n", fill_areas[c].name, fill_areas[c].size,
+                       fill_areas[c].module, fill_areas[c].bank, fill_areas[c].bank_new);
+
+        if ((filename_stable != NULL) && (filename_stable[0] != '\0'))
+            fill_stable_map_update(filename_stable);
+    }
+
+    free(fill_areas);
+    fill_areas = NULL;
+    fill_area_size = 0;
+}
@@ -0,0 +1,9 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _FILL_H
+#define _FILL_H
+
+void fill_report(char * filename_report, char * filename_stable);
+
+#endif // _FILL_H
@@ -11,6 +11,7 @@
 
 #include "areas.h"
 #include "ihx_file.h"
+#include "fill.h"
 
 // Example data to parse from a .ihx file
 // No area names
@@ -76,6 +77,24 @@ void set_option_warnings_as_errors(bool new_val) {
     g_option_warnings_as_errors = new_val;
 }
 
+char g_option_report[MAX_STR_LEN] = {'\0'};
+
+void set_option_report(char * filename) {
+    snprintf(g_option_report, sizeof(g_option_report), "%s", filename);
+}
+
+bool g_option_fill = false;
+
+void set_option_fill(bool new_val) {
+    g_option_fill = new_val;
+}
+
+char g_option_stable[MAX_STR_LEN] = {'\0'};
+
+void set_option_stable(char * filename) {
+    snprintf(g_option_stable, sizeof(g_option_stable), "%s", filename);
+}
+
 
 // Return false if any character isn't a valid hex digit
 static int check_hex(char * c) {
@@ -211,7 +230,9 @@ static int ihx_parse_and_validate_record(char * p_str, ihx_record * p_rec) {
 
         // For records that start in banks above the unbanked region (0x000 - 0x3FFF)
         // Warn (but don't error) if they cross the boundary between different banks
-        if ((p_rec->address & 0xFFFFC000U) != (p_rec->address_end & 0xFFFFC000U)) {
+        // (address_end is only valid for data records)
+        if ((p_rec->type == IHX_REC_DATA) &&
+            ((p_rec->address & 0xFFFFC000U) != (p_rec->address_end & 0xFFFFC000U))) {
 
             if (p_rec->address >= 0x00004000U) {
                 printf("Warning: Write from one bank spans into the next. 0x%x -> 0x%x (bank %d -> %d)\n",
@@ -228,6 +249,67 @@ static int ihx_parse_and_validate_record(char * p_str, ihx_record * p_rec) {
 }
 
 
+// Adds the used ROM ranges to the JSON report as its "ihx" member
+//
+// The report is usually the one written by bankpack -report=, which
+// ends with the closing brace of its object. A previous "ihx" member
+// (from an earlier run) is replaced. Without a report a new one is made.
+static void ihx_report_write(char * filename_report, char * filename_ihx) {
+
+    char * buf = NULL;
+    char * p;
+    long   len = 0;
+    FILE * report_file = fopen(filename_report, "rb");
+
+    if (report_file) {
+        fseek(report_file, 0, SEEK_END);
+        len = ftell(report_file);
+        fseek(report_file, 0, SEEK_SET);
+        buf = malloc(len + 1);
+        if (!buf || (fread(buf, 1, len, report_file) != (size_t)len))
+            len = 0;
+        fclose(report_file);
+    }
+    if (!buf)
+        buf = malloc(1);
+    buf[len] = '\0';
+
+    // Cut off the previous "ihx" member, or else the closing brace
+    p = NULL;
+    for (char * found = strstr(buf, "\n  \"ihx\": "); found; found = strstr(found + 1, "\n  \"ihx\": "))
+        p = found;
+    if (!p)
+        p = strrchr(buf, '}');
+    if (p)
+        *p = '\0';
+    len = strlen(buf);
+    while ((len > 0) && ((buf[len - 1] == ',') || (buf[len - 1] == ' ') || (buf[len - 1] == '\n') || (buf[len - 1] == '\r')))
+        buf[--len] = '\0';
+
+    report_file = fopen(filename_report, "wb");
+    if (!report_file) {
+        printf("Problem with filename or unable to open report file! %s\n", filename_report);
+        free(buf);
+        return;
+    }
+    if (len == 0)
+        fprintf(report_file, "{\n");
+    else
+        fprintf(report_file, "%s%s\n", buf, (buf[len - 1] == '{') ? "" : ",");
+    fprintf(report_file, "  \"ihx\": {\"file\": \"");
+    for (p = filename_ihx; *p; p++) {
+        if ((*p == '"') || (*p == '\\'))
+            fputc('\\', report_file);
+        fputc(*p, report_file);
+    }
+    fprintf(report_file, "\", \"banks\": ");
+    areas_report_write(report_file);
+    fprintf(report_file, "}\n}\n");
+    fclose(report_file);
+    free(buf);
+}
+
+
 int ihx_file_process_areas(char * filename_in) {
 
     int  ret = EXIT_SUCCESS; // default to success
@@ -305,6 +387,13 @@ int ihx_file_process_areas(char * filename_in) {
     // Check and warn for possible overflows
     ihx_check_for_overflows();
 
+    // Before the report gets the "ihx" member, the bankpack part is all that's read
+    if (g_option_fill)
+        fill_report(g_option_report, g_option_stable);
+
+    if (g_option_report[0] != '\0')
+        ihx_report_write(g_option_report, filename_in);
+
     areas_cleanup();
     return ret;
 }
@@ -8,5 +8,8 @@
 
 int ihx_file_process_areas(char * filename_in);
 void set_option_warnings_as_errors(bool new_val);
+void set_option_report(char * filename);
+void set_option_fill(bool new_val);
+void set_option_stable(char * filename);
 
 #endif // _IHX_FILE_H
\ No newline at end of file
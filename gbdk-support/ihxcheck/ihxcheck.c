@@ -27,6 +27,11 @@ void display_help(void) {
            "Options\n"
            "-h : Show this help\n"
            "-e : Treat warnings as errors\n"
+           "-report=<file> : Add the used ROM ranges per bank to the JSON report <file>\n"
+           "                 (as written by bankpack -report=), or create it\n"
+           "-fill : Show the used bytes and free blocks of each ROM bank. With -report=<file>\n"
+           "        also suggest auto-banked areas to move so that sparse banks are emptied\n"
+           "-stable=<file> : With -fill, write the suggested moves into the bankpack -stable= map <file>\n"
            "\n"
            "Use: Read a .ihx and warn about overlapped areas.\n"
            "Example: \"ihx_check build/MyProject.ihx\"\n"
@@ -54,6 +59,15 @@ int handle_args(int argc, char * argv[]) {
             display_help();
             return false;  // Don't parse input when -h is used
 
+        } else if (strstr(argv[i], "-report=") == argv[i]) {
+            set_option_report(argv[i] + strlen("-report="));
+
+        } else if (strstr(argv[i], "-fill") == argv[i]) {
+            set_option_fill(true);
+
+        } else if (strstr(argv[i], "-stable=") == argv[i]) {
+            set_option_stable(argv[i] + strlen("-stable="));
+
         } else if (strstr(argv[i], "-e") == argv[i]) {
             set_option_warnings_as_errors(true);
         }
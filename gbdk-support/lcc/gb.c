@@ -71,7 +71,11 @@ static struct {
 		{ "ihxcheck",	"%bindir%ihxcheck" },
 		{ "mkbin",		"%sdccdir%makebin" },
 		{ "crt0dir",	"%libdir%%plat%/crt0.o"},
-		{ "libs_include", "-k %libdir%%port%/ -l %port%.lib -k %libdir%%plat%/ -l %plat%.lib"},
+		{ "bcall",		""},
+		{ "mapperobj",	""},
+		{ "fastlib",	""},
+		{ "mappermkbin",	""},
+		{ "libs_include", "-k %libdir%%port%/ %fastlib% -l %port%.lib -k %libdir%%plat%/ -l %plat%.lib"},
 				{ "mkcom", "%sdccdir%makecom"}
 };
 
@@ -264,10 +268,42 @@ int option(char *arg) {
 		// When composing link stage, clear out crt0dir path
 		setTokenVal("crt0dir", "");
 	}
+	else if ((tail = starts_with(arg, "-bcall-rst"))) {
+		// When composing link stage, add the RST 0x10 banked call trampoline (sm83 only)
+		// It's linked ahead of the libs so it replaces their ___sdcc_bcall_ehl
+		setTokenVal("bcall", "%libdir%%plat%/bcall_rst.o");
+	}
+	else if ((tail = starts_with(arg, "-fastlib"))) {
+		// When composing link stage, search fast.lib of the port before the port lib,
+		// so the modules in it replace the default ones
+		setTokenVal("fastlib", "-l fast.lib");
+	}
 	else if ((tail = starts_with(arg, "-no-libs"))) {
 		// When composing link stage, clear out crt0dir path
 		setTokenVal("libs_include", "");
 	}
+	else if ((tail = starts_with(arg, "-mapper="))) {
+		// NES: link the banking code for another mapper and set the matching iNES mapper number
+		// (checked before -m below, which would take it for a port)
+		if (!strcmp(tail, "mmc1")) {
+			setTokenVal("mapperobj", "%libdir%%plat%/mapper_mmc1.o");
+			setTokenVal("mappermkbin", "-ym 1");
+		} else if (!strcmp(tail, "mmc3")) {
+			setTokenVal("mapperobj", "%libdir%%plat%/mapper_mmc3.o");
+			setTokenVal("mappermkbin", "-ym 4");
+		} else if (!strcmp(tail, "uxrom")) {
+			// UxROM uses the default banking code, only the header differs
+			setTokenVal("mapperobj", "");
+			setTokenVal("mappermkbin", "-ym 2");
+		} else if (!strcmp(tail, "unrom512")) {
+			setTokenVal("mapperobj", "");
+			setTokenVal("mappermkbin", "");
+		} else {
+			fprintf(stderr, "Error: %s: unrecognised mapper %s (available: unrom512, uxrom, mmc1, mmc3)\n", progname, tail);
+			exit(-1);
+		}
+		return 1;
+	}
 	else if ((tail = starts_with(arg, "-m"))) {
 		char word_count = 0;
 		char * p_str = strtok( strsave(tail),":"); // Copy arg str so it doesn't get unmodified by strtok()
@@ -326,6 +362,13 @@ void finalise(void)
 	llist0_defaults_len = _class->llist0_defaults_len;
 }
 
+// Rebuilds the linker command with or without the -fastlib library
+void finalise_ld(int fastlib)
+{
+	setTokenVal("fastlib", fastlib ? "-l fast.lib" : "");
+	buildArgs(ld, _class->ld);
+}
+
 void set_gbdk_dir(char* argv_0)
 {
 	char buf[1024 - 2]; // Path will get quoted below, so reserve two characters for them
@@ -18,6 +18,7 @@
 #define EXT_LST  ".lst"
 #define EXT_SYM  ".sym"
 #define EXT_ADB  ".adb"
+#define EXT_LCM  ".lcm" // -incremental build manifest
 
 // ROM file extensions
 #define EXT_GB     ".gb"
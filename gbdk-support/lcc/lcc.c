@@ -12,19 +12,27 @@ static char rcsid[] = "$Id: lcc.c,v 2.0 " BUILDDATE " " BUILDTIME " gbdk-2020 Ex
 #include <assert.h>
 #include <ctype.h>
 #include <signal.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #ifdef _WIN32
 # include <io.h>
 # include <process.h>
+# include <direct.h>
 #else
 # include <unistd.h>
 # include <sys/types.h>
 # include <sys/wait.h>
+# include <sys/time.h>
+# include <sys/resource.h>
 #endif
 
 #include "gb.h"
 #include "list.h"
 #include "targets.h"
+#ifdef BANKPACK_IN_PROCESS
+#include "bankpack.h"
+#endif
 
 #ifndef TEMPDIR
 #define TEMPDIR "/tmp"
@@ -35,6 +43,9 @@ extern char *basepath(char *);
 extern char *path_stripext(char *);
 extern char *path_newext(char *, char *);
 static int callsys(char *[]);
+static int job_run(char *[], char *, char *, int);
+static void job_text(char *);
+static void jobs_finish(void);
 extern char *concat(const char *, const char *);
 static void compose(char *[], List, List, List);
 static void error(char *, char *);
@@ -59,7 +70,19 @@ static bool arg_has_searchkey(char *, char *);
 static void Fixllist();
 
 static void handle_autobanking(void);
+static int stage_run(char *, List, List, List, List);
+static int stage_exec(char *);
+static void stages_load(void);
+static void stages_save(void);
+static long long time_now(void);
+static void time_record(const char *, long long);
+static void time_report(void);
 static int handle_file_preprocess_only(char *name, char *base);
+static void fastlib_report(void);
+static char *temp_object(void);
+static int unity_add(char *, int);
+static void unity_finish(void);
+static int unity_retry(void);
 
 
 // These get populated from _class using finalise() in gb.c
@@ -68,6 +91,7 @@ extern arg_entry *llist0_defaults;
 extern int llist0_defaults_len;
 
 extern int option(char *);
+extern void finalise_ld(int);
 extern void set_gbdk_dir(char*);
 
 void finalise(void);
@@ -79,7 +103,17 @@ static int Sflag;		/* -S specified */
 static int cflag;		/* -c specified */
 static int Kflag;		/* -K specified */
 static int autobankflag;	/* -K specified */
+static int ihxcheckmkbinflag;	/* -ihxcheck-mkbin specified */
+static int incrementalflag;	/* -incremental specified */
+static int fastlibflag;		/* -fastlib specified */
+static int unity_max;		/* -unity, most .c files compiled as one unit, 0 without */
 int verbose;		/* incremented for each -v */
+static int jobs_max = 1;	/* -j N, number of compile / assemble jobs run at once */
+static char *cachedir;		/* -cache=dir, directory of the compile cache */
+static int timeflag;		/* -time specified */
+static char *timetrace;		/* -time=file, Chrome trace output */
+static char *timefile;		/* one line per command run, written by all jobs */
+static long long time_start;	/* when lcc started, in microseconds */
 static List bankpack_flags;	/* bankpack flags */
 static List ihxchecklist;	/* ihxcheck flags */
 static List mkbinlist;		/* loader files, flags */
@@ -111,6 +145,7 @@ int main(int argc, char *argv[]) {
 	int i, j, nf;
 
 	progname = argv[0];
+	time_start = time_now();
 	ac = argc + 50;
 	av = alloc(ac * sizeof(char *));
 	if (signal(SIGINT, SIG_IGN) != SIG_IGN)
@@ -160,6 +195,14 @@ int main(int argc, char *argv[]) {
 				exit(8);
 			}
 		}
+		else if ((strncmp(argv[i], "-j", 2) == 0) &&
+				 ((argv[i][2] != '\0') ? isdigit(argv[i][2]) : ((i + 1 < argc) && isdigit(*argv[i + 1])))) {
+			// -jN or -j N, a plain -j is still passed to the linker
+			jobs_max = atoi((argv[i][2] != '\0') ? &argv[i][2] : argv[++i]);
+			if (jobs_max < 1)
+				jobs_max = 1;
+			continue;
+		}
 		else if (strcmp(argv[i], "-target") == 0) {
 			if (argv[i + 1] && *argv[i + 1] != '-')
 				i++;
@@ -202,6 +245,12 @@ int main(int argc, char *argv[]) {
 	// into command strings used for compose()
 	finalise();
 
+	// -time: each command that runs appends a line, jobs run in other processes
+	if (timeflag) {
+		timefile = tempname(".tim");
+		fclose(fopen(timefile, "w"));
+	}
+
 	for (i = 0; include[i]; i++)
 		clist = append(include[i], clist);
 	if (ilist) {
@@ -220,10 +269,14 @@ int main(int argc, char *argv[]) {
 			// Process filenames
 			char *name = exists(argv[i]);
 			if (name) {
-				if (strcmp(name, argv[i]) != 0
-					|| ((nf > 1) && (suffix(name, suffixes, 3) != SUFX_NOMATCH)) ) // Does it match: .c, .i, .asm, .s
-
-					fprintf(stderr, "%s:\n", name);
+				int header = (strcmp(name, argv[i]) != 0
+					|| ((nf > 1) && (suffix(name, suffixes, 3) != SUFX_NOMATCH)) ); // Does it match: .c, .i, .asm, .s
+
+				// -unity: .c files get compiled later, several at once
+				if (unity_add(name, header))
+					continue;
+				if (header)
+					job_text(stringf("%s:\n", name));
 				// Send input filename argument to "filename processor"
 				// which will add them to llist[n] in some form most of the time
 				filename(name, 0);
@@ -232,6 +285,15 @@ int main(int argc, char *argv[]) {
 				error("can't find `%s'", argv[i]);
 		}
 
+	// Compile the unity units which are not full yet
+	unity_finish();
+
+	// Wait for any compile jobs still running (-j N) before linking
+	jobs_finish();
+
+	// Units which did not compile get their files compiled separately
+	if (unity_retry())
+		jobs_finish();
 
 	// Perform Link / ihxcheck / makebin stages
 	//
@@ -248,6 +310,9 @@ int main(int argc, char *argv[]) {
 		if(!outfile)
 			outfile = concat("a", rom_extension);
 
+		if (incrementalflag)
+			stages_load();
+
 		// If an .ihx file is present as input skip link related stages
 		if (ihx_inputs > 0) {
 
@@ -265,7 +330,8 @@ int main(int argc, char *argv[]) {
 			sprintf(ihxFile, "%s%s", path_stripext(outfile), EXT_IHX);
 
 			// Only remove .ihx from the delete-list if it's not the final target
-			if (!target_is_ihx)
+			// -incremental keeps it so the link can be skipped next time
+			if (!target_is_ihx && !incrementalflag)
 				append(ihxFile, rmlist);
 
 			// If auto bank assignment is enabled, modify obj files before linking
@@ -279,15 +345,23 @@ int main(int argc, char *argv[]) {
 			Fixllist();   // Fixlist adds required default linker vars if not added by user
 			compose(ld, llist[L_ARGS], llist[L_FILES], append(ihxFile, 0));
 
-			if (callsys(av))
+			if (stage_run("link", llist[L_FILES], llist[L_LKFILES], append(ihxFile, 0), 0))
 				errcnt++;
+			else if (fastlibflag && !incrementalflag)
+				fastlib_report();
 		} // end: non-ihx input file handling
 
 		// ihxcheck (test for multiple writes to the same ROM address)
+		// With -ihxcheck-mkbin makebin runs the same tests on the ihx it already has
+		// in memory, saving a process and a parse of the file (-Wi-e maps to makebin -ke)
 		if (!Kflag) {
-			compose(ihxcheck, ihxchecklist, append(ihxFile, 0), 0);
-			if (callsys(av))
-				errcnt++;
+			if (ihxcheckmkbinflag && !target_is_ihx)
+				mkbinlist = append((find("-e", ihxchecklist)) ? "-ke" : "-k", mkbinlist);
+			else {
+				compose(ihxcheck, ihxchecklist, append(ihxFile, 0), 0);
+				if (stage_run("ihxcheck", append(ihxFile, 0), 0, 0, 0))
+					errcnt++;
+			}
 		}
 
 		// No need to makebin (.ihx -> .gb [or other rom_extension]) if .ihx is final target
@@ -308,18 +382,23 @@ int main(int argc, char *argv[]) {
 				}
 
 				compose(mkbin, mkbinlist, append(ihxFile, 0), append(binFile, 0));
-				if (callsys(av))
+				if (stage_run("makebin", append(ihxFile, 0), 0, append(binFile, 0), 0))
 					errcnt++;
 
 				// post-process step (such as makecom), if applicable
 				if ((strlen(postproc) != 0) && (errcnt == 0)) {
 					compose(postproc, append(binFile, 0), append(outfile, 0), 0);
-					if (callsys(av))
+					if (stage_run("postproc", append(binFile, 0), 0, append(outfile, 0), 0))
 						errcnt++;
 				}
 			}
 		}
+
+		if (incrementalflag)
+			stages_save();
 	}
+	if (timeflag && verbose < 2)
+		time_report();
 	rm(rmlist);
 	if (verbose > 0)
 		fprintf(stderr, "\n");
@@ -451,12 +530,17 @@ int matches_ext(const char * filename, const char * ext)
 }
 
 
+// -time: CPU time and peak memory of the last command run by _spawnvp()
+static long long spawn_cpu;	/* microseconds */
+static long spawn_rss;		/* KB, 0 if not known */
+
 #ifndef WIN32
 #define _P_WAIT 0
 
 static int _spawnvp(int mode, const char *cmdname, char *argv[]) {
 	int status;
 	pid_t pid, n;
+	struct rusage ru;
 
 	switch (pid = fork()) {
 	case -1:
@@ -469,10 +553,19 @@ static int _spawnvp(int mode, const char *cmdname, char *argv[]) {
 		fflush(stdout);
 		exit(100);
 	}
-	while ((n = wait(&status)) != pid && n != -1)
+	// Wait for this command only, a compile job may finish meanwhile
+	while ((n = wait4(pid, &status, 0, &ru)) != pid && n != -1)
 		;
 	if (n == -1)
 		status = -1;
+	else {
+		spawn_cpu = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000LL + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+#ifdef __APPLE__
+		spawn_rss = ru.ru_maxrss / 1024;  // bytes on macOS
+#else
+		spawn_rss = ru.ru_maxrss;
+#endif
+	}
 	if (status & 0377) {
 		fprintf(stderr, "%s: fatal error in %s\n", progname, cmdname);
 		status |= 0400;
@@ -577,7 +670,10 @@ static int callsys(char **av) {
 			//_spawnvp requires _FileName to not have quotes
 			//_Arguments must have quotes on windows, but not in macos
 			//Quoted strings must begin and end with quotes, no quotes in the middle
+			long long start = time_now();
 			status = _spawnvp(_P_WAIT, argv_0_no_quotes, argv);
+			if (timeflag)
+				time_record(argv_0_no_quotes, start);
 		}
 		if (status == -1) {
 			fprintf(stderr, "%s: ", progname);
@@ -587,6 +683,1186 @@ static int callsys(char **av) {
 	return status;
 }
 
+// Compile and assemble jobs for -j N
+//
+// Each job runs callsys() in a forked copy of lcc with stdout and stderr sent
+// to temp files. The output of a job is only shown once all jobs queued before
+// it are done, so it comes out in the same order as without -j. Bookkeeping
+// (rmlist, llist, errcnt) stays in this process.
+typedef struct job {
+	char **argv;	// command, NULL for a job which only prints text
+	char *text;	// shown on stderr before the command output
+	char *out;	// temp file with the stdout of the command
+	char *err;	// temp file with the stderr of the command
+	char *ofile;	// object file to add to the compile cache, if any
+	char *cachefile;
+	int unit;	// unity unit compiled by the job, 1 based, 0 for none
+	int pid;
+	int done;
+	int status;
+} job;
+
+static job *jobs;
+static int jobs_count, jobs_alloc, jobs_shown, jobs_running;
+
+static void cache_store(char *, char *);
+static void unity_failed(int);
+
+// Copy the contents of file name to stream f
+static void job_show_file(char *name, FILE *f) {
+	char buf[1024];
+	size_t n;
+	FILE *in = fopen(name, "rb");
+
+	if (in == NULL)
+		return;
+	while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+		fwrite(buf, 1, n, f);
+	fclose(in);
+}
+
+// Show the output of all finished jobs which have no unfinished job ahead of them
+static void jobs_show(void) {
+	for (; jobs_shown < jobs_count && jobs[jobs_shown].done; jobs_shown++) {
+		job *j = &jobs[jobs_shown];
+		if (j->unit && j->status) {
+			// Not shown, the errors come again when its files get compiled separately
+			unity_failed(j->unit);
+			continue;
+		}
+		if (j->text)
+			fputs(j->text, stderr);
+		if (j->argv) {
+			// stderr first, it starts with the command line when -v is used
+			job_show_file(j->err, stderr);
+			fflush(stderr);
+			job_show_file(j->out, stdout);
+			fflush(stdout);
+		}
+		if (j->status)
+			errcnt++;
+		else if (j->cachefile)
+			cache_store(j->ofile, j->cachefile);
+	}
+	fflush(stdout);
+	fflush(stderr);
+}
+
+static job *job_add(void) {
+	if (jobs_count == jobs_alloc) {
+		jobs_alloc = jobs_alloc ? jobs_alloc * 2 : 16;
+		jobs = realloc(jobs, jobs_alloc * sizeof(job));
+		assert(jobs);
+	}
+	memset(&jobs[jobs_count], 0, sizeof(job));
+	return &jobs[jobs_count++];
+}
+
+#ifndef _WIN32
+// Wait for one running job to finish
+static void job_wait(void) {
+	int i, status;
+	pid_t pid = wait(&status);
+
+	if (pid == -1) {
+		// Should not happen, don't leave jobs waiting forever
+		for (i = jobs_shown; i < jobs_count; i++)
+			if (!jobs[i].done) {
+				jobs[i].done = 1;
+				jobs[i].status = -1;
+			}
+		jobs_running = 0;
+	}
+	else {
+		for (i = jobs_shown; i < jobs_count; i++)
+			if (!jobs[i].done && jobs[i].pid == pid) {
+				jobs[i].done = 1;
+				jobs[i].status = !(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+				jobs_running--;
+				break;
+			}
+	}
+	jobs_show();
+}
+#endif
+
+/* job_run - run the command described by av[0...] as a job, return status
+ * On success ofile gets copied to cachefile when that is not NULL
+ * unit is the unity unit compiled by the command (1 based) or 0 */
+static int job_run(char **av, char *ofile, char *cachefile, int unit) {
+	int status;
+
+#ifndef _WIN32
+	// Without -j, or with -v -v (which only prints the commands) run it directly.
+	// Unity units always run as a job so the output of a failed one can be dropped
+	if ((jobs_max > 1 || unit) && verbose < 2) {
+		int n;
+		job *j;
+
+		while (jobs_running >= jobs_max)
+			job_wait();
+
+		for (n = 0; av[n] != NULL; n++)
+			;
+		j = job_add();
+		j->argv = alloc((n + 1) * sizeof(char *));
+		memcpy(j->argv, av, (n + 1) * sizeof(char *));
+		j->out = tempname(".out");
+		j->err = tempname(".err");
+		j->ofile = ofile;
+		j->cachefile = cachefile;
+		j->unit = unit;
+
+		fflush(stdout);
+		fflush(stderr);
+		switch (j->pid = fork()) {
+		case -1:
+			fprintf(stderr, "%s: no more processes\n", progname);
+			j->done = 1;
+			j->status = 100;
+			jobs_show();
+			break;
+		case 0:
+			if ((freopen(j->out, "w", stdout) == NULL) || (freopen(j->err, "w", stderr) == NULL))
+				_exit(100);
+			setvbuf(stderr, NULL, _IONBF, 0);
+			n = callsys(j->argv);
+			fflush(stdout);
+			fflush(stderr);
+			_exit(n ? 1 : 0);
+		default:
+			jobs_running++;
+		}
+		// Errors get counted once the job output is shown
+		return 0;
+	}
+#endif
+	status = callsys(av);
+	if (status == 0 && cachefile)
+		cache_store(ofile, cachefile);
+	return status;
+}
+
+/* job_text - print text on stderr, after the output of any jobs queued before it */
+static void job_text(char *text) {
+	if (jobs_shown == jobs_count)
+		fputs(text, stderr);
+	else {
+		job *j = job_add();
+		j->text = text;
+		j->done = 1;
+	}
+}
+
+/* jobs_finish - wait for all jobs and show their output */
+static void jobs_finish(void) {
+#ifndef _WIN32
+	while (jobs_running > 0)
+		job_wait();
+#endif
+	jobs_show();
+}
+
+// Compile cache (-cache=dir)
+//
+// A .c file is looked up by a hash of its preprocessed source, the compiler
+// command line and the size and date of the compiler. sdcc takes the module
+// name from the file name, so the file name is part of the command line that
+// gets hashed, the directory and the output file name are not.
+
+#define HASH_START 0xcbf29ce484222325ULL
+
+// 64 bit FNV-1a, also used for the -incremental build manifest
+static unsigned long long hash_bytes(unsigned long long h, const void *data, size_t len) {
+	const unsigned char *p = data;
+
+	while (len--) {
+		h ^= *p++;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+// Copy file src to dst, return non-zero on success
+static int cache_copy(char *src, char *dst) {
+	char buf[4096];
+	size_t n;
+	int ok = 1;
+	FILE *in, *out;
+
+	if ((in = fopen(src, "rb")) == NULL)
+		return 0;
+	if ((out = fopen(dst, "wb")) == NULL) {
+		fclose(in);
+		return 0;
+	}
+	while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+		if (fwrite(buf, 1, n, out) != n) {
+			ok = 0;
+			break;
+		}
+	if (ferror(in))
+		ok = 0;
+	fclose(in);
+	if (fclose(out) != 0)
+		ok = 0;
+	return ok;
+}
+
+/* cache_key - return the cache file for compiling name, or 0 if it can't be looked up */
+static char *cache_key(char *name) {
+	char buf[4096];
+	size_t n;
+	int i;
+	FILE *f;
+	struct stat st;
+	unsigned long long h = HASH_START;
+	char *ifile = tempname(EXT_I);
+
+	// Preprocess, on errors let the compile report them
+	compose(cpp, clist, append(name, 0), append(concat("-o", ifile), 0));
+	if (callsys(av) || (f = fopen(ifile, "rb")) == NULL)
+		return 0;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		h = hash_bytes(h, buf, n);
+	fclose(f);
+
+	compose(com, clist, append(basepath(name), 0), append("", 0));
+	for (i = 0; av[i]; i++)
+		h = hash_bytes(h, av[i], strlen(av[i]) + 1);
+
+	removeQuotes(com[0], buf);
+	if (stat(buf, &st) == 0) {
+		h = hash_bytes(h, &st.st_size, sizeof(st.st_size));
+		h = hash_bytes(h, &st.st_mtime, sizeof(st.st_mtime));
+	}
+
+	return stringf("%s/%016llx%s", cachedir, h, EXT_O);
+}
+
+/* cache_store - add ofile to the cache as cachefile */
+static void cache_store(char *ofile, char *cachefile) {
+	// Write under a unique name first so no other lcc sees a partial file
+	char *tmp = stringf("%s.%d", cachefile, getpid());
+
+	if (!cache_copy(ofile, tmp) || rename(tmp, cachefile) != 0)
+		remove(tmp);
+}
+
+// Unity builds (-unity, -unity=N)
+//
+// Up to N .c files with the same #pragma bank get compiled with one run of
+// the compiler: a temp .c file #includes each of them by its full path, so
+// warnings and errors still name the original file and line. The file scope
+// statics of each file are renamed to <file>_<n>__<name> by a #define around
+// its #include, n being its index in the unit since files of the same name
+// may be in one unit, and the macros it defines are #undef'd after it, so the
+// files don't see each other's. Files which could behave differently in a unit
+// are compiled on their own: inline asm (it may use the static names),
+// pragmas other than bank, and a #define or #undef ahead of an #include (it
+// may configure a header which an earlier file of the unit already
+// included). Autobanked files (#pragma bank 255) are too, since bankpack
+// can't split the object of a unit across banks. When a unit does not compile its files get compiled
+// separately, only the errors of those are shown. Units are not cached
+// with -cache, the files compiled on their own are.
+
+#define UNITY_FILES_DEFAULT 8
+#define UNITY_FILES_MAX 64
+
+typedef struct unity_file {
+	char *name;
+	char *prefix;	// for the renamed statics
+	List statics;	// names of the file scope statics
+	List macros;	// names the file #defines
+	int header;	// show the file name ahead of its output
+} unity_file;
+
+typedef struct unity_unit {
+	char *bank;	// value of #pragma bank, "" without one
+	unity_file *files;
+	int count;
+	int open;	// still taking files
+	int failed;
+	char *ofile;
+} unity_unit;
+
+static unity_unit *units;
+static int units_count, units_alloc;
+
+// Source scanner, only finds what unity_add() needs to know
+typedef struct unity_scan {
+	const char *p;
+	const char *tok;	// last token, or the text of a directive after the #
+	int len;
+	int line_start;	// nothing but white space since the last new line
+	int defined;	// a #define or #undef was seen
+	int alone;	// compile the file on its own
+	char *bank;
+	unity_file *file;
+} unity_scan;
+
+#define TOK_END       0
+#define TOK_IDENT     256
+#define TOK_OTHER     257	// number, string or character constant
+#define TOK_DIRECTIVE 258
+
+static int unity_token(unity_scan *s) {
+	const char *p = s->p;
+
+	for (;;) {
+		if (*p == '\n') {
+			s->line_start = 1;
+			p++;
+		}
+		else if (isspace((unsigned char)*p))
+			p++;
+		else if ((p[0] == '\\') && ((p[1] == '\n') || (p[1] == '\r')))
+			p += 2;
+		else if ((p[0] == '/') && (p[1] == '*')) {
+			const char *end = strstr(p + 2, "*/");
+			p = end ? end + 2 : p + strlen(p);
+		}
+		else if ((p[0] == '/') && (p[1] == '/')) {
+			while (*p && (*p != '\n'))
+				p++;
+		}
+		else
+			break;
+	}
+	s->tok = p;
+	if (*p == '\0') {
+		s->p = p;
+		return TOK_END;
+	}
+	if ((*p == '#') && s->line_start) {
+		// Up to the end of the line, escaped new lines continue it
+		for (p++; (*p == ' ') || (*p == '\t'); p++)
+			;
+		s->tok = p;
+		for (; *p && (*p != '\n'); p++)
+			if ((*p == '\\') && (p[1] == '\n' || (p[1] == '\r' && p[2] == '\n')))
+				p += (p[1] == '\r') ? 2 : 1;
+		s->len = p - s->tok;
+		s->p = p;
+		return TOK_DIRECTIVE;
+	}
+	s->line_start = 0;
+	if (isalpha((unsigned char)*p) || (*p == '_')) {
+		while (isalnum((unsigned char)*p) || (*p == '_'))
+			p++;
+		s->len = p - s->tok;
+		s->p = p;
+		return TOK_IDENT;
+	}
+	if (isdigit((unsigned char)*p) || ((*p == '.') && isdigit((unsigned char)p[1]))) {
+		while (isalnum((unsigned char)*p) || (*p == '_') || (*p == '.'))
+			p++;
+	}
+	else if ((*p == '"') || (*p == '\'')) {
+		char quote = *p++;
+		for (; *p && (*p != quote) && (*p != '\n'); p++)
+			if ((*p == '\\') && p[1])
+				p++;
+		if (*p == quote)
+			p++;
+	}
+	else {
+		s->len = 1;
+		s->p = p + 1;
+		return (unsigned char)*p;
+	}
+	s->len = p - s->tok;
+	s->p = p;
+	return TOK_OTHER;
+}
+
+static int unity_tok_is(unity_scan *s, const char *word) {
+	return ((size_t)s->len == strlen(word)) && (strncmp(s->tok, word, s->len) == 0);
+}
+
+// SDCC keywords and attributes such as __at() and __banked
+static int unity_tok_reserved(unity_scan *s) {
+	return (s->len > 2) && (s->tok[0] == '_') && (s->tok[1] == '_');
+}
+
+// Word of a directive at *p, return its length (0 if there is none)
+static int unity_word(const char **p, const char *end, const char **word) {
+	const char *w = *p;
+
+	while ((w < end) && ((*w == ' ') || (*w == '\t')))
+		w++;
+	*word = w;
+	while ((w < end) && (isalnum((unsigned char)*w) || (*w == '_')))
+		w++;
+	*p = w;
+	return w - *word;
+}
+
+static void unity_directive(unity_scan *s) {
+	const char *p = s->tok, *end = s->tok + s->len, *word;
+	int len = unity_word(&p, end, &word);
+	char *name;
+
+	if ((len == 6) && (strncmp(word, "define", 6) == 0)) {
+		s->defined = 1;
+		if ((len = unity_word(&p, end, &word)) > 0) {
+			name = stringf("%.*s", len, word);
+			if (!find(name, s->file->macros))
+				s->file->macros = append(name, s->file->macros);
+		}
+	}
+	else if ((len == 5) && (strncmp(word, "undef", 5) == 0))
+		s->defined = 1;
+	else if ((len == 7) && (strncmp(word, "include", 7) == 0)) {
+		if (s->defined)
+			s->alone = 1;
+	}
+	else if ((len == 6) && (strncmp(word, "pragma", 6) == 0)) {
+		len = unity_word(&p, end, &word);
+		if ((len == 4) && (strncmp(word, "bank", 4) == 0)) {
+			len = unity_word(&p, end, &word);
+			name = stringf("%.*s", len, word);
+			// Autobanked files are each placed by bankpack, a unit of them may not fit into a bank
+			if ((s->bank && (strcmp(s->bank, name) != 0)) || (strcmp(name, "255") == 0))
+				s->alone = 1;
+			s->bank = name;
+		}
+		else
+			s->alone = 1;
+	}
+}
+
+static int unity_next(unity_scan *s) {
+	int t;
+
+	while ((t = unity_token(s)) == TOK_DIRECTIVE)
+		unity_directive(s);
+	if ((t == TOK_IDENT) && (unity_tok_is(s, "__asm") || unity_tok_is(s, "__asm__") || unity_tok_is(s, "asm")))
+		s->alone = 1;
+	return t;
+}
+
+// Skip to the token which closes the open one just read
+static int unity_skip(unity_scan *s, int open) {
+	int close = (open == '(') ? ')' : (open == '[') ? ']' : '}';
+	int depth = 1, t;
+
+	while ((t = unity_next(s)) != TOK_END) {
+		if (t == open)
+			depth++;
+		else if ((t == close) && (--depth == 0))
+			break;
+	}
+	return t;
+}
+
+static void unity_static_add(unity_scan *s, const char *name, int len) {
+	char *str;
+
+	if (name == NULL)
+		return;
+	str = stringf("%.*s", len, name);
+	if (!find(str, s->file->statics))
+		s->file->statics = append(str, s->file->statics);
+}
+
+// Read the declarators of a file scope static up to its ';' or function body,
+// the name of each one is the last identifier ahead of its '(', '[', '=', ',' or ';'
+static void unity_static(unity_scan *s) {
+	const char *name = NULL;
+	int len = 0, named = 0, attr = 0, t;
+
+	for (;;) {
+		t = unity_next(s);
+		if (attr && (t != '(')) // Attribute without arguments
+			attr = 0;
+		switch (t) {
+		case TOK_END:
+			return;
+		case TOK_IDENT:
+			if (unity_tok_reserved(s))
+				attr = 1;
+			else if (!named) {
+				name = s->tok;
+				len = s->len;
+			}
+			break;
+		case '(':
+			if (attr) {
+				attr = 0;
+				unity_skip(s, '(');
+			}
+			else if (!named && name) {
+				unity_scan peek = *s;
+				if (unity_next(s) == '*') {
+					// Function pointer, its name is the first identifier in the parentheses
+					int depth = 1;
+					name = NULL;
+					while (depth && ((t = unity_next(s)) != TOK_END)) {
+						if (t == '(')
+							depth++;
+						else if (t == ')')
+							depth--;
+						else if ((t == TOK_IDENT) && !name && !unity_tok_reserved(s) &&
+								 !unity_tok_is(s, "const") && !unity_tok_is(s, "volatile")) {
+							name = s->tok;
+							len = s->len;
+						}
+					}
+				}
+				else {
+					// Function, its parameters
+					*s = peek;
+					unity_skip(s, '(');
+				}
+				unity_static_add(s, name, len);
+				named = 1;
+			}
+			else
+				unity_skip(s, '(');
+			break;
+		case '[':
+			if (!named)
+				unity_static_add(s, name, len);
+			named = 1;
+			unity_skip(s, '[');
+			break;
+		case '=':
+			if (!named)
+				unity_static_add(s, name, len);
+			named = 1;
+			// Initializer
+			while (((t = unity_next(s)) != TOK_END) && (t != ',') && (t != ';'))
+				if ((t == '(') || (t == '[') || (t == '{'))
+					unity_skip(s, t);
+			if (t != ',')
+				return;
+			named = 0;
+			name = NULL;
+			break;
+		case ',':
+			if (!named)
+				unity_static_add(s, name, len);
+			named = 0;
+			name = NULL;
+			break;
+		case ';':
+			if (!named)
+				unity_static_add(s, name, len);
+			return;
+		case '{':
+			unity_skip(s, '{');
+			if (named) // Function body
+				return;
+			name = NULL; // struct, union or enum body
+			break;
+		}
+	}
+}
+
+/* unity_scan_file - find the statics, macros and bank of name, return 0 if it gets compiled on its own */
+static int unity_scan_file(char *name, unity_file *file, char **bank) {
+	unity_scan s;
+	char *src;
+	long size;
+	int depth = 0, parens = 0, t;
+	FILE *f = fopen(name, "rb");
+
+	if (f == NULL)
+		return 0;
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if ((size < 0) || ((src = malloc(size + 1)) == NULL)) {
+		fclose(f);
+		return 0;
+	}
+	size = fread(src, 1, size, f);
+	fclose(f);
+	src[size] = '\0';
+
+	memset(&s, 0, sizeof(s));
+	s.p = src;
+	s.line_start = 1;
+	s.file = file;
+	while (((t = unity_next(&s)) != TOK_END) && !s.alone) {
+		if (t == '{')
+			depth++;
+		else if (t == '}')
+			depth--;
+		else if (t == '(')
+			parens++;
+		else if (t == ')')
+			parens--;
+		else if ((t == TOK_IDENT) && (depth == 0) && (parens == 0) && unity_tok_is(&s, "static"))
+			unity_static(&s);
+	}
+	free(src);
+	*bank = s.bank ? s.bank : "";
+	return !s.alone;
+}
+
+// Full path of name for the #include, it is looked up next to the unit otherwise
+static char *unity_path(char *name) {
+	char buf[1024];
+
+	if ((name[0] == '/') || (name[0] == '\\') || (name[0] && (name[1] == ':')))
+		return name;
+	if (getcwd(buf, sizeof(buf)) == NULL)
+		return name;
+	return stringf("%s/%s", buf, name);
+}
+
+// Start of the prefix of the renamed statics of name: its file name without extension as an identifier
+static char *unity_prefix(char *name) {
+	char *s, *base = basepath(name);
+
+	for (s = base; *s; s++)
+		if (!isalnum((unsigned char)*s))
+			*s = '_';
+	return isdigit((unsigned char)*base) ? concat("_", base) : base;
+}
+
+static void unity_compile_file(unity_file *file) {
+	if (file->header)
+		job_text(stringf("%s:\n", file->name));
+	filename(file->name, 0);
+}
+
+static void unity_compile(int n) {
+	unity_unit *u = &units[n];
+	unity_file *file;
+	char *src;
+	List b;
+	FILE *f;
+
+	u->open = 0;
+	if (u->count == 1) {
+		unity_compile_file(&u->files[0]);
+		return;
+	}
+	src = tempname(EXT_C);
+	if ((f = fopen(src, "w")) == NULL) {
+		error("can't write `%s'", src);
+		return;
+	}
+	if (verbose > 0)
+		job_text(stringf("%s: unity unit %s:\n", progname, src));
+	for (file = u->files; file < u->files + u->count; file++) {
+		if (verbose > 0)
+			job_text(stringf("  %s\n", file->name));
+		if ((b = file->statics))
+			do {
+				b = b->link;
+				fprintf(f, "#define %s %s__%s\n", b->str, file->prefix, b->str);
+			} while (b != file->statics);
+		fprintf(f, "#include \"%s\"\n", unity_path(file->name));
+		if ((b = file->statics))
+			do {
+				b = b->link;
+				fprintf(f, "#undef %s\n", b->str);
+			} while (b != file->statics);
+		if ((b = file->macros))
+			do {
+				b = b->link;
+				fprintf(f, "#undef %s\n", b->str);
+			} while (b != file->macros);
+	}
+	fclose(f);
+
+	u->ofile = temp_object();
+	compose(com, clist, append(src, 0), append(u->ofile, 0));
+	if (job_run(av, u->ofile, 0, n + 1))
+		u->failed = 1;
+	llist[L_FILES] = append(u->ofile, llist[L_FILES]);
+}
+
+/* unity_add - add .c file name to a unity unit, return 0 if it gets compiled now as usual */
+static int unity_add(char *name, int header) {
+	unity_file file;
+	unity_unit *u = NULL;
+	char *bank;
+	int i;
+
+	if (!unity_max || Eflag || cflag || Sflag || (suffix(name, suffixes, 1) != 0))
+		return 0;
+	memset(&file, 0, sizeof(file));
+	if (!unity_scan_file(name, &file, &bank)) {
+		if (verbose > 0)
+			job_text(stringf("%s: %s is not compiled in a unity unit\n", progname, name));
+		return 0;
+	}
+	file.name = name;
+	file.header = header;
+
+	for (i = 0; i < units_count; i++)
+		if (units[i].open && (strcmp(units[i].bank, bank) == 0)) {
+			u = &units[i];
+			break;
+		}
+	if (u == NULL) {
+		if (units_count == units_alloc) {
+			units_alloc = units_alloc ? units_alloc * 2 : 16;
+			units = realloc(units, units_alloc * sizeof(unity_unit));
+			assert(units);
+		}
+		u = &units[units_count++];
+		memset(u, 0, sizeof(unity_unit));
+		u->bank = bank;
+		u->files = alloc(unity_max * sizeof(unity_file));
+		u->open = 1;
+	}
+	file.prefix = stringf("%s_%d", unity_prefix(name), u->count);
+	u->files[u->count++] = file;
+	if (u->count == unity_max)
+		unity_compile(u - units);
+	return 1;
+}
+
+/* unity_finish - compile the units which are still open */
+static void unity_finish(void) {
+	int i;
+
+	for (i = 0; i < units_count; i++)
+		if (units[i].open)
+			unity_compile(i);
+}
+
+static void unity_failed(int unit) {
+	units[unit - 1].failed = 1;
+}
+
+/* unity_retry - compile the files of the units which failed separately, return the number of units */
+static int unity_retry(void) {
+	int n, i, retried = 0;
+
+	for (n = 0; n < units_count; n++) {
+		unity_unit *u = &units[n];
+		List node, files, b, p;
+		int tail;
+
+		if (!u->failed)
+			continue;
+		retried++;
+		job_text(stringf("%s: unity unit of %d files does not compile, compiling them separately\n", progname, u->count));
+
+		// Their objects take the place of the unit in the link list
+		files = llist[L_FILES];
+		node = find(u->ofile, files);
+		tail = (node == files);
+		llist[L_FILES] = 0;
+		for (i = 0; i < u->count; i++)
+			unity_compile_file(&u->files[i]);
+		b = llist[L_FILES];
+		llist[L_FILES] = files;
+		if (b && node) {
+			List last = b;
+			p = node;
+			b = b->link;
+			node->str = b->str;
+			while (b != last) {
+				b = b->link;
+				p = append(b->str, p);
+			}
+			if (tail)
+				llist[L_FILES] = p;
+		}
+	}
+	return retried;
+}
+
+// Incremental link stages (-incremental)
+//
+// Each stage after compiling (bankpack, link, ihxcheck, makebin, postproc)
+// gets a key from a hash of its command line and the contents of its input
+// files. The keys and a hash of the files each stage wrote are kept in a
+// manifest next to the output. A stage is skipped when its key matches the
+// last run and its output files are still the ones it wrote.
+
+typedef struct stage {
+	char name[16];
+	unsigned long long key;	// 0 when there is no valid entry
+	unsigned long long out;
+} stage;
+
+static stage stages[8];
+static int stages_count;
+static char *stages_file;
+
+// Hash an argument, with the per-run part of temp file names left out
+static unsigned long long hash_arg(unsigned long long h, char *arg) {
+	char *tmp = strstr(arg, stringf("lcc%d", getpid()));
+
+	if (tmp) {
+		char *ext = strrchr(tmp, '.');
+		h = hash_bytes(h, arg, tmp - arg);
+		if (ext)
+			h = hash_bytes(h, ext, strlen(ext));
+	}
+	else
+		h = hash_bytes(h, arg, strlen(arg));
+	return hash_bytes(h, "", 1);
+}
+
+// Hash the contents of a file, a missing file hashes differently from an empty one
+static unsigned long long hash_file(unsigned long long h, char *name) {
+	char buf[4096];
+	size_t n;
+	FILE *f = fopen(name, "rb");
+
+	if (f == NULL)
+		return hash_bytes(h, "-", 1);
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		h = hash_bytes(h, buf, n);
+	fclose(f);
+	return hash_bytes(h, "+", 1);
+}
+
+// Hash a linkerfile and the object files listed in it
+static unsigned long long hash_lkfile(unsigned long long h, char *name) {
+	char line[1024];
+	FILE *f;
+
+	h = hash_file(h, name);
+	if ((f = fopen(name, "r")) == NULL)
+		return h;
+	while (fgets(line, sizeof(line), f)) {
+		char *s = line, *e;
+		while (isspace((unsigned char)*s))
+			s++;
+		for (e = s + strlen(s); (e > s) && isspace((unsigned char)e[-1]); e--)
+			e[-1] = '\0';
+		if (*s && *s != '-')
+			h = hash_file(h, s);
+	}
+	fclose(f);
+	return h;
+}
+
+static unsigned long long hash_files(unsigned long long h, List files, List lkfiles) {
+	List b;
+
+	if ((b = files))
+		do {
+			b = b->link;
+			h = hash_file(h, b->str);
+		} while (b != files);
+	if ((b = lkfiles))
+		do {
+			b = b->link;
+			h = hash_lkfile(h, b->str);
+		} while (b != lkfiles);
+	return h;
+}
+
+static stage *stage_find(char *name) {
+	int i;
+
+	for (i = 0; i < stages_count; i++)
+		if (strcmp(stages[i].name, name) == 0)
+			return &stages[i];
+	if (stages_count == ARRAY_LEN(stages))
+		return NULL;
+	memset(&stages[stages_count], 0, sizeof(stage));
+	snprintf(stages[stages_count].name, sizeof(stages[0].name), "%s", name);
+	return &stages[stages_count++];
+}
+
+/* stages_load - read the manifest for outfile */
+static void stages_load(void) {
+	char name[16];
+	unsigned long long key, out;
+	FILE *f;
+
+	stages_file = stringf("%s%s", path_stripext(outfile), EXT_LCM);
+	if ((f = fopen(stages_file, "r")) == NULL)
+		return;
+	while (fscanf(f, "%15s %llx %llx", name, &key, &out) == 3) {
+		stage *entry = stage_find(name);
+		if (entry) {
+			entry->key = key;
+			entry->out = out;
+		}
+	}
+	fclose(f);
+}
+
+/* stages_save - write the manifest for outfile */
+static void stages_save(void) {
+	int i;
+	FILE *f;
+
+	if (!stages_file || (f = fopen(stages_file, "w")) == NULL)
+		return;
+	for (i = 0; i < stages_count; i++)
+		if (stages[i].key)
+			fprintf(f, "%s %016llx %016llx\n", stages[i].name, stages[i].key, stages[i].out);
+	fclose(f);
+}
+
+#ifdef BANKPACK_IN_PROCESS
+// bankpack linked into lcc (libbankpack.a)
+//
+// Runs with the same command line as the bankpack tool, without starting a
+// process, and keeps the object files it read for the areas it extracts in
+// memory to write them out again.
+static int bankpack_running;
+
+/* bankpack_exit - bankpack exits on fatal errors, remove the temp files as lcc would */
+static void bankpack_exit(void) {
+	if (bankpack_running)
+		rm(rmlist);
+}
+
+/* bankpack_call - run bankpack with the arguments in av, return status */
+static int bankpack_call(char **av) {
+	static int exit_set;
+	int argc, status;
+	long long start;
+#ifndef _WIN32
+	struct rusage ru_start, ru_end;
+#endif
+
+	for (argc = 0; av[argc] != NULL; argc++)
+		removeQuotes(av[argc], av[argc]);
+	if (verbose > 0) {
+		int k;
+		fprintf(stderr, "%s", av[0]);
+		for (k = 1; av[k] != NULL; k++)
+			fprintf(stderr, " %s", av[k]);
+		fprintf(stderr, "\n");
+	}
+	if (verbose > 1)
+		return 0;
+
+	if (!exit_set) {
+		atexit(bankpack_exit);
+		exit_set = 1;
+	}
+	fflush(stdout);
+	fflush(stderr);
+	start = time_now();
+#ifndef _WIN32
+	getrusage(RUSAGE_SELF, &ru_start);
+#endif
+	bankpack_running = 1;
+	status = bankpack_run(argc, av);
+	bankpack_running = 0;
+	fflush(stdout);
+	if (timeflag) {
+		spawn_cpu = 0;
+#ifndef _WIN32
+		getrusage(RUSAGE_SELF, &ru_end);
+		spawn_cpu = (ru_end.ru_utime.tv_sec - ru_start.ru_utime.tv_sec + ru_end.ru_stime.tv_sec - ru_start.ru_stime.tv_sec) * 1000000LL
+			+ ru_end.ru_utime.tv_usec - ru_start.ru_utime.tv_usec + ru_end.ru_stime.tv_usec - ru_start.ru_stime.tv_usec;
+#endif
+		spawn_rss = 0;  // Not separate from lcc
+		time_record(av[0], start);
+	}
+	return status;
+}
+#endif
+
+/* stage_exec - run the command in av for stage name, return status */
+static int stage_exec(char *name) {
+#ifdef BANKPACK_IN_PROCESS
+	if (strcmp(name, "bankpack") == 0)
+		return bankpack_call(av);
+#endif
+	return callsys(av);
+}
+
+/* stage_run - run the command in av for stage name unless it is up to date, return status */
+static int stage_run(char *name, List in_files, List in_lkfiles, List out_files, List out_lkfiles) {
+	int i, status;
+	struct stat st;
+	unsigned long long key = HASH_START;
+	stage *entry;
+
+	if (!incrementalflag || (verbose > 1))
+		return stage_exec(name);
+
+	for (i = 0; av[i]; i++) {
+		key = hash_arg(key, av[i]);
+		// Tools and input files such as crt0.o given by path: their size and date
+		if (!find(av[i], out_files) && stat(av[i], &st) == 0) {
+			key = hash_bytes(key, &st.st_size, sizeof(st.st_size));
+			key = hash_bytes(key, &st.st_mtime, sizeof(st.st_mtime));
+		}
+	}
+	key = hash_files(key, in_files, in_lkfiles);
+	if (key == 0)
+		key = 1;
+
+	entry = stage_find(name);
+	if (entry && entry->key == key && entry->out == hash_files(HASH_START, out_files, out_lkfiles)) {
+		if (verbose > 0)
+			fprintf(stderr, "%s: %s is up to date\n", progname, name);
+		return 0;
+	}
+
+	status = stage_exec(name);
+	if (entry) {
+		entry->key = status ? 0 : key;
+		entry->out = hash_files(HASH_START, out_files, out_lkfiles);
+	}
+	return status;
+}
+
+// Build timing (-time)
+//
+// Every command run by callsys() appends a line to timefile: the process
+// that ran it (jobs are separate processes), start and wall time relative
+// to the start of lcc, CPU time and peak memory of the command, and the name
+// of the tool. At the end the lines are summed per tool and, with -time=file,
+// written out as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+
+/* time_now - return a time in microseconds, for differences */
+static long long time_now(void) {
+#ifdef _WIN32
+	return (long long)clock() * 1000000 / CLOCKS_PER_SEC;
+#else
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+#endif
+}
+
+/* time_record - add a line to timefile for the command cmdname which ran from start until now */
+static void time_record(const char *cmdname, long long start) {
+	long long end = time_now();
+	const char *name = cmdname, *s;
+	char *ext;
+	FILE *f;
+
+	for (s = cmdname; *s; s++)
+		if (*s == '/' || *s == '\\')
+			name = s + 1;
+	name = strsave(name);
+	if ((ext = strrchr(name, '.')) != NULL && ext != name)
+		*ext = '\0';  // sdcc.exe -> sdcc
+	if ((f = fopen(timefile, "a")) == NULL)
+		return;
+	fprintf(f, "%d %lld %lld %lld %ld %s\n", (int)getpid(), start - time_start, end - start,
+		spawn_cpu, spawn_rss, name);
+	fclose(f);
+}
+
+/* time_report - show the time spent in each tool, write the trace for -time=file */
+static void time_report(void) {
+	struct {
+		char name[32];
+		int runs;
+		long long wall, cpu;
+		long rss;
+	} tools[16], total;
+	int tools_count = 0, i, pid, first = 1;
+	long long start, wall, cpu;
+	long rss;
+	char name[32];
+	FILE *f, *trace = NULL;
+
+	if ((f = fopen(timefile, "r")) == NULL)
+		return;
+	if (timetrace && (trace = fopen(timetrace, "w")) == NULL)
+		error("can't write `%s'", timetrace);
+	if (trace)
+		fprintf(trace, "{\"traceEvents\":[\n");
+
+	memset(&total, 0, sizeof(total));
+	while (fscanf(f, "%d %lld %lld %lld %ld %31s", &pid, &start, &wall, &cpu, &rss, name) == 6) {
+		for (i = 0; i < tools_count && strcmp(tools[i].name, name) != 0; i++)
+			;
+		if (i == tools_count) {
+			if (tools_count == ARRAY_LEN(tools))
+				i--;  // Lump any further tools into the last line
+			else {
+				memset(&tools[i], 0, sizeof(tools[i]));
+				snprintf(tools[i].name, sizeof(tools[i].name), "%s", name);
+				tools_count++;
+			}
+		}
+		tools[i].runs++;
+		tools[i].wall += wall;
+		tools[i].cpu += cpu;
+		if (rss > tools[i].rss)
+			tools[i].rss = rss;
+		total.runs++;
+		total.wall += wall;
+		total.cpu += cpu;
+		if (rss > total.rss)
+			total.rss = rss;
+
+		if (trace) {
+			fprintf(trace, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld,"
+				"\"args\":{\"cpu_us\":%lld,\"peak_rss_kb\":%ld}}", first ? "" : ",\n", name, pid, start, wall, cpu, rss);
+			first = 0;
+		}
+	}
+	fclose(f);
+	if (trace) {
+		fprintf(trace, "\n]}\n");
+		fclose(trace);
+	}
+
+	fprintf(stderr, "%-12s %6s %12s %12s %14s\n", "tool", "runs", "wall ms", "cpu ms", "peak RSS KB");
+	for (i = 0; i < tools_count; i++)
+		fprintf(stderr, "%-12s %6d %12.1f %12.1f %14ld\n", tools[i].name, tools[i].runs,
+			tools[i].wall / 1000.0, tools[i].cpu / 1000.0, tools[i].rss);
+	fprintf(stderr, "%-12s %6d %12.1f %12.1f %14ld\n", "total", total.runs,
+		total.wall / 1000.0, total.cpu / 1000.0, total.rss);
+	// With -j the tools overlap, so their sum can be more than the whole build
+	fprintf(stderr, "%-12s %6s %12.1f\n", "lcc elapsed", "", (time_now() - time_start) / 1000.0);
+}
+
+// ROM size comparison of -fastlib
+//
+// The objects are linked a second time without fast.lib, into a file
+// which is removed again, and the data bytes of both .ihx files are
+// counted. Only the modules which fast.lib replaces differ.
+
+/* ihx_data_size - return the number of data bytes in .ihx file name, or -1 */
+static long ihx_data_size(const char *name) {
+	char line[600];
+	unsigned int count, type;
+	long size = 0;
+	FILE *f;
+
+	if ((f = fopen(name, "r")) == NULL)
+		return -1;
+	while (fgets(line, sizeof(line), f))
+		if ((sscanf(line, ":%2x%*4x%2x", &count, &type) == 2) && (type == 0))
+			size += count;
+	fclose(f);
+	return size;
+}
+
+/* fastlib_report - link without fast.lib and show the difference in ROM bytes */
+static void fastlib_report(void) {
+	static char *extensions[] = { EXT_IHX, ".map", ".noi", ".cdb", EXT_SYM };
+	char *base = concat(path_stripext(outfile), "_nofast");
+	char *ihx_small = concat(base, EXT_IHX);
+	long size_fast, size_small;
+	int i;
+
+	for (i = 0; i < ARRAY_LEN(extensions); i++)
+		rmlist = append(concat(base, extensions[i]), rmlist);
+
+	finalise_ld(0);
+	compose(ld, llist[L_ARGS], llist[L_FILES], append(ihx_small, 0));
+	i = callsys(av);
+	finalise_ld(1);
+	if (i != 0)
+		return;
+
+	size_fast = ihx_data_size(ihxFile);
+	size_small = ihx_data_size(ihx_small);
+	if ((size_fast >= 0) && (size_small >= 0))
+		fprintf(stderr, "%s: -fastlib: %ld ROM bytes, %ld without fast.lib (%+ld)\n",
+			progname, size_fast, size_small, size_fast - size_small);
+}
+
 /* concat - return concatenation of strings s1 and s2 */
 char *concat(const char *s1, const char *s2) {
 	int n = strlen(s1);
@@ -708,19 +1984,21 @@ static int filename(char *name, char *base) {
 				ofile = concat(base, EXT_ASM);
 			}
 			else
-			{
-				ofile = tempname(EXT_O);
+				ofile = temp_object();
 
-				// Remove generated files of these extensions upon completion
-				char* ofileBase = basepath(ofile);
-				rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_ASM), rmlist);
-				rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_LST), rmlist);
-				rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_SYM), rmlist);
-				rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_ADB), rmlist);
-			}
+			// -S output and --debug side files (.adb) are not cached
+			char *cachefile = 0;
+			if (cachedir && !Sflag && !find("--debug", clist))
+				cachefile = cache_key(name);
 
-			compose(com, clist, append(name, 0), append(ofile, 0));
-			status = callsys(av);
+			if (cachefile && access(cachefile, 4) == 0 && cache_copy(cachefile, ofile)) {
+				if (verbose > 0)
+					job_text(stringf("%s: %s from cache %s\n", progname, ofile, cachefile));
+			}
+			else {
+				compose(com, clist, append(name, 0), append(ofile, 0));
+				status = job_run(av, ofile, cachefile, 0);
+			}
 			if (!find(ofile, llist[L_FILES]))
 				llist[L_FILES] = append(ofile, llist[L_FILES]);
 		}
@@ -737,7 +2015,7 @@ static int filename(char *name, char *base) {
 			else
 				ofile = tempname(EXT_O);
 			compose(as, alist, append(name, 0), append(ofile, 0));
-			status = callsys(av);
+			status = job_run(av, ofile, 0, 0);
 			if (!find(ofile, llist[L_FILES]))
 				llist[L_FILES] = append(ofile, llist[L_FILES]);
 		}
@@ -778,17 +2056,23 @@ static void help(void) {
 #endif
 "-Bdir/	use the compiler named `dir/rcc'\n",
 "-c	compile only\n",
+"-cache=dir	reuse objects from `dir' for .c files with the same preprocessed source and flags\n",
 "-dn	set switch statement density to `n'\n",
 "-debug	Turns on --debug for compiler, -y (.cdb) and -j (.noi) for linker\n",
 "-Dname -Dname=def	define the preprocessor symbol `name'\n",
 "-E	only run preprocessor on named .c and .h files files -> stdout\n",
 "--save-preproc  Use with -E for output to *.i files instead of stdout\n",
+"-fastlib	link fast.lib ahead of the gbdk libs (faster, larger versions of some routines) and show the ROM size difference\n",
 "-g	produce symbol table information for debuggers\n",
 "-help or -?	print this message\n",
+"-j N	run up to N compile and assemble jobs at once, output is still shown in input file order\n",
 "-Idir	add `dir' to the beginning of the list of #include directories\n",
 "-K don't run ihxcheck test on linker ihx output\n",
+"-ihxcheck-mkbin run the ihxcheck tests inside makebin instead of as a separate step\n",
+"-incremental skip link stages (bankpack, linker, ihxcheck, makebin) whose inputs and flags did not change\n",
 "-lx	search library `x'\n",
 "-m	select port and platform: \"-m[port]:[plat]\" ports:sm83,z80,mos6502 plats:ap,duck,gb,sms,gg,nes\n",
+"-mapper=name select the NES mapper: unrom512 (default), uxrom, mmc1, mmc3\n",
 "-N	do not search the standard directories for #include files\n",
 "-n	emit code to check for dereferencing zero pointers\n",
 "-no-crt do not auto-include the gbdk crt0.o runtime in linker list\n",
@@ -799,12 +2083,15 @@ static void help(void) {
 "-p -pg	emit profiling code; see prof(1) and gprof(1)\n",
 "-S	compile to assembly language\n",
 "-autobank auto-assign banks set to 255 (bankpack)\n"
+"-bcall-rst use the RST 0x10 banked call trampoline, which skips bank switching for same bank calls (sm83)\n"
 #ifdef linux
 "-static	specify static libraries (default is dynamic)\n",
 #endif
 "-t -tname	emit function tracing calls to printf or to `name'\n",
 "-target name	is ignored\n",
 "-tempdir=dir	place temporary files in `dir/'", "\n"
+"-time -time=file	show the wall time, CPU time and peak memory of each tool run, and write them to `file' as a Chrome trace\n",
+"-unity -unity=N	compile up to N .c files (default 8) with the same #pragma bank as one unit, with fewer compiler runs\n",
 "-Uname	undefine the preprocessor symbol `name'\n",
 "-v	show commands as they are executed; 2nd -v suppresses execution\n",
 "-w	suppress warnings\n",
@@ -947,6 +2234,11 @@ static void opt(char *arg) {
 					// If MBC option is present for makebin (-Wl-yt <n> or -Wm-yt <n>) then make a copy for bankpack to use
 					if (arg[5] == 't')
 						bankpack_flags = append(&arg[3], bankpack_flags);
+				} else if (((arg[4] == 'i') || (arg[4] == 'b')) && (strncmp(&arg[5], "ps", 2) == 0) && strchr(&arg[7], ',')) {
+					// -Wm-ips<old>,<patch> and -Wm-bps<old>,<patch> -> makebin -ips <old> <patch>
+					mkbinlist = append(stringf("%.4s", &arg[3]), mkbinlist);
+					sprintf(tmp, "%.*s", (int)(strrchr(&arg[7], ',') - &arg[7]), &arg[7]);
+					sprintf(tmp2, "%s", strrchr(&arg[7], ',') + 1);
 				} else if ((arg[4] == 'x') && arg[5] && arg[6]) {
 					// SMS options
 					// Print "-" plus first two option chars into first arg
@@ -966,6 +2258,26 @@ static void opt(char *arg) {
 			}
 		fprintf(stderr, "%s: %s ignored\n", progname, arg);
 		return;
+	case 'u':
+		if (strcmp(arg, "-unity") == 0) {
+			unity_max = UNITY_FILES_DEFAULT;
+			return;
+		}
+		else if (strncmp(arg, "-unity=", 7) == 0) {
+			unity_max = atoi(arg + 7);
+			if ((unity_max < 2) || (unity_max > UNITY_FILES_MAX)) {
+				error("-unity=N needs 2 to %s files", stringf("%d", UNITY_FILES_MAX));
+				exit(8);
+			}
+			return;
+		}
+		break;
+	case 'c':
+		if (strncmp(arg, "-cache=", 7) == 0) {
+			cachedir = arg + 7;
+			return;
+		}
+		break;
 	case 'd':	/* -dn */
 		if (strcmp(arg, "-debug") == 0) {
 			// Load default debug options
@@ -978,9 +2290,15 @@ static void opt(char *arg) {
 		arg[1] = 's';
 		clist = append(arg, clist);
 		return;
-	case 't':	/* -t -tname -tempdir=dir */
+	case 't':	/* -t -tname -tempdir=dir -time -time=file */
 		if (strncmp(arg, "-tempdir=", 9) == 0)
 			tempdir = arg + 9;
+		else if (strcmp(arg, "-time") == 0)
+			timeflag++;
+		else if (strncmp(arg, "-time=", 6) == 0) {
+			timeflag++;
+			timetrace = arg + 6;
+		}
 		else
 			clist = append(arg, clist);
 		return;
@@ -995,9 +2313,32 @@ static void opt(char *arg) {
 	case 'I':	/* -Idir */
 		clist = append(arg, clist);
 		return;
+	case 'b':
+		if (strcmp(arg, "-bcall-rst") == 0) {
+			option(arg);  // Add banked call trampoline to linker compose string
+			return;
+		}
+		break;
+	case 'f':
+		if (strcmp(arg, "-fastlib") == 0) {
+			fastlibflag++;
+			option(arg);  // Add fast.lib ahead of the port lib in linker compose string
+			return;
+		}
+		break;
 	case 'K':
 		Kflag++;
 		return;
+	case 'i':
+		if (strcmp(arg, "-ihxcheck-mkbin") == 0) {
+			ihxcheckmkbinflag++;
+			return;
+		}
+		else if (strcmp(arg, "-incremental") == 0) {
+			incrementalflag++;
+			return;
+		}
+		break;
 	case 'a':
 		if (strcmp(arg, "-autobank") == 0) {
 			autobankflag++;
@@ -1182,6 +2523,19 @@ char *tempname(char *suffix) {
 	return name;
 }
 
+/* temp_object - generate a temporary object file name, its compiler side files get removed too */
+static char *temp_object(void) {
+	char *ofile = tempname(EXT_O);
+	char *ofileBase = basepath(ofile);
+
+	// Remove generated files of these extensions upon completion
+	rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_ASM), rmlist);
+	rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_LST), rmlist);
+	rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_SYM), rmlist);
+	rmlist = append(stringf("%s/%s%s", tempdir, ofileBase, EXT_ADB), rmlist);
+	return ofile;
+}
+
 
 // Performs the autobanking stage
 //
@@ -1192,18 +2546,27 @@ static void handle_autobanking(void) {
 	// bankpack will be populated if supported by active port:platform
 	if (bankpack[0][0] != '\0') {
 
-		char * bankpack_linkerfile_name = tempname(EXT_LK);
-		rmlist = append(bankpack_linkerfile_name, rmlist); // Delete the linkerfile when done
+		char * bankpack_linkerfile_name;
+		// -incremental keeps the linkerfile, it's the list of objects to link when bankpack gets skipped
+		if (incrementalflag)
+			bankpack_linkerfile_name = stringf("%s_bankpack%s", path_stripext(outfile), EXT_LK);
+		else {
+			bankpack_linkerfile_name = tempname(EXT_LK);
+			rmlist = append(bankpack_linkerfile_name, rmlist); // Delete the linkerfile when done
+		}
 		// Always use a linkerfile when using bankpack through lcc
 		// Writes all input object files out to [bankpack_linkerfile_name]
 		bankpack_flags = append(stringf("%s%s","-lkout=", bankpack_linkerfile_name), bankpack_flags);
+		// The linker reads the objects from that list, so the ones bankpack
+		// doesn't change don't need to be copied to new names
+		bankpack_flags = append("-skip_unchanged", bankpack_flags);
 
 		// Add linkerfile entries (usually *.lk) to the bankpack arg list if any are present
 		bankpack_flags = list_add_to_another(bankpack_flags, llist[L_LKFILES], "-lkin=", NULL);
 
 		// Prepare the bankpack command line, then execute it
 		compose(bankpack, bankpack_flags, llist[L_FILES], 0);
-		if (callsys(av))
+		if (stage_run("bankpack", llist[L_FILES], llist[L_LKFILES], 0, append(bankpack_linkerfile_name, 0)))
 			errcnt++;
 
 		// Clear out the objects file and linkerfiles from their lists
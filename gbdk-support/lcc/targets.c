@@ -16,6 +16,7 @@ arg_entry llist0_defaults_gb[] = {
     {.searchkey= ".refresh_OAM=",.addflag= "-g",.addvalue= ".refresh_OAM=0xFF80",.found= false},
     {.searchkey= "_DATA=",       .addflag= "-b",.addvalue= "_DATA=0xC0A0",       .found= false},
     {.searchkey= "_CODE=",       .addflag= "-b",.addvalue= "_CODE=0x0200",       .found= false},
+    {.searchkey= "_CODE_HRAM=",  .addflag= "-b",.addvalue= "_CODE_HRAM=0xFFA0",  .found= false},
 };
 
 // SMS / GG
@@ -57,7 +58,7 @@ CLASS classes[] = {
       .com          = "%com% %comdefault% -Wa%asdefault% -DINT_16_BITS $1 %comflag% $2 -o $3",
       .as           = "%as_gb% %asdefault% $1 $3 $2",
       .bankpack     = "%bankpack% $1 $2",
-      .ld           = "%ld_gb% -n -i $1 %libs_include% $3 %crt0dir% $2",
+      .ld           = "%ld_gb% -n -i $1 %libs_include% $3 %crt0dir% %bcall% $2",
       .ihxcheck     = "%ihxcheck% $2 $1",
       .mkbin        = "%mkbin% -yN -Z $1 $2 $3",  // -yN: Don't paste in the Nintendo logo bytes for gameboy and clones (-Z)
       .postproc     = "",
@@ -74,7 +75,7 @@ CLASS classes[] = {
       .com          = "%com% %comdefault% -Wa%asdefault% -DINT_16_BITS $1 %comflag% $2 -o $3",
       .as           = "%as_gb% %asdefault% $1 $3 $2",
       .bankpack     = "%bankpack% $1 $2",
-      .ld           = "%ld_gb% -n -i $1 %libs_include% $3 %crt0dir% $2",
+      .ld           = "%ld_gb% -n -i $1 %libs_include% $3 %crt0dir% %bcall% $2",
       .ihxcheck     = "%ihxcheck% $2 $1",
       .mkbin        = "%mkbin% -yN -Z $1 $2 $3",  // -yN: Don't paste in the Nintendo logo bytes for gameboy and clones (-Z)
       .postproc     = "",
@@ -91,7 +92,7 @@ CLASS classes[] = {
       .com          = "%com% %comdefault% -Wa%asdefault% -DINT_16_BITS $1 %comflag% $2 -o $3",
       .as           = "%as_gb% %asdefault% $1 $3 $2",
       .bankpack     = "%bankpack% $1 $2",
-      .ld           = "%ld_gb% -n -i $1 %libs_include% $3 %crt0dir% $2",
+      .ld           = "%ld_gb% -n -i $1 %libs_include% $3 %crt0dir% %bcall% $2",
       .ihxcheck     = "%ihxcheck% $2 $1",
       .mkbin        = "%mkbin% -yN -Z $1 $2 $3",  // -yN: Don't paste in the Nintendo logo bytes for gameboy and clones (-Z)
       .postproc     = "",
@@ -162,9 +163,9 @@ CLASS classes[] = {
       .com          = "%com% %comdefault% -Wa%asdefault% --no-peep -DINT_16_BITS $1 %comflag% $2 -o $3",
       .as           = "%as_6500% %asdefault% $1 $3 $2",
       .bankpack     = "%bankpack% -plat=nes $1 $2",
-      .ld           = "%ld_6808% -a nes -n -i -j $1 %libs_include% $3 %crt0dir% $2",
+      .ld           = "%ld_6808% -a nes -n -i -j $1 %libs_include% $3 %crt0dir% %mapperobj% $2",
       .ihxcheck     = "%ihxcheck% $2 $1",
-      .mkbin        = "%mkbin% -N -yo A -yS $2 $3",
+      .mkbin        = "%mkbin% -N -yo A -yS %mappermkbin% $2 $3",
       .postproc     = "",
       .llist0_defaults    = llist0_defaults_nes,
       .llist0_defaults_len= ARRAY_LEN(llist0_defaults_nes),
@@ -0,0 +1,300 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Generates lookup tables of math functions
+//
+// One table per run: sine, cosine, arctangent, square root or
+// reciprocal, with values rounded to 8 or 16 bits after multiplying
+// by a scale. As C source the table is a plain array. As assembly it
+// starts on a 256 byte page, and 16 bit values are split into a page
+// of low bytes followed by a page of high bytes, so an 8 bit index
+// only has to become the low byte of the address (see gbdk/lut.h).
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
+
+#define MAX_STR_LEN     4096
+#define SIZE_MAX_PAGE   256     // Page indexed tables take an 8 bit index
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+enum { FUNC_NONE, FUNC_SIN, FUNC_COS, FUNC_ATAN, FUNC_SQRT, FUNC_RECIP };
+
+static const char * func_names[] = { "", "sin", "cos", "atan", "sqrt", "recip" };
+
+static char   filename_out[MAX_STR_LEN] = "";
+static char   var_name[MAX_STR_LEN]     = "";
+static int    func        = FUNC_NONE;
+static int    bank        = 0;      // 0 = non-banked, 255 = autobank
+static int    value_bits  = 8;
+static bool   value_signed = false;
+static bool   type_given  = false;
+static int    table_size  = 256;
+static double scale       = 0.0;    // 0 = default of the function and type
+static bool   output_asm  = false;
+
+static long   values[SIZE_MAX_PAGE];
+static int    clamped = 0;
+
+
+static void display_help(void) {
+
+    fprintf(stdout,
+       "lut2asset <function> [options]\n"
+       "Use: generate a lookup table of a math function, page aligned as assembly.\n"
+       "\n"
+       "Functions (entry i of n entries)\n"
+       "sin                 sin(i * 2pi / n) * scale, n steps per circle\n"
+       "cos                 cos(i * 2pi / n) * scale, n steps per circle\n"
+       "atan                atan(i / n) in angle steps (256 per circle) * scale, for atan2()\n"
+       "                    of y / x with 0 <= y < x\n"
+       "sqrt                sqrt(i) * scale\n"
+       "recip               scale / i, entry 0 is the largest value of the type\n"
+       "\n"
+       "Options\n"
+       "-h                  Show this help screen\n"
+       "-c <file>           Output file, .c for a C array or .s for a page aligned table\n"
+       "                    (default: <function>.c), and a header <file>.h\n"
+       "-var <name>         Variable name (default: <file>)\n"
+       "-b <bank>           Bank, 255 for autobank (default: none, non-banked ROM)\n"
+       "-u8 -s8 -u16 -s16   Type of the values (default: s8 for sin and cos, u8 otherwise)\n"
+       "-size <n>           Number of entries, 2 to 256 (default: 256)\n"
+       "-scale <x>          Multiplier of the values (default: sin, cos 127 / 256 for 8 / 16 bit,\n"
+       "                    atan 1 / 256, sqrt 16 / 256, recip 255 / 65535)\n"
+       "\n"
+       "Values outside the range of the type are clamped, with a warning.\n"
+       "16 bit values of .s tables are split into a page of low bytes\n"
+       "followed by a page of high bytes.\n"
+       );
+}
+
+
+static double default_scale(void) {
+    switch (func) {
+        case FUNC_SIN:
+        case FUNC_COS:   return (value_bits == 8) ? (value_signed ? 127.0 : 255.0) : 256.0;
+        case FUNC_ATAN:  return (value_bits == 8) ? 1.0 : 256.0;
+        case FUNC_SQRT:  return (value_bits == 8) ? 16.0 : 256.0;
+        case FUNC_RECIP: return (value_bits == 8) ? 255.0 : 65535.0;
+    }
+    return 1.0;
+}
+
+
+static void table_build(void) {
+
+    long value_min = value_signed ? -(1L << (value_bits - 1)) : 0;
+    long value_max = value_signed ? (1L << (value_bits - 1)) - 1 : (1L << value_bits) - 1;
+
+    if (scale == 0.0)
+        scale = default_scale();
+
+    for (int i = 0; i < table_size; i++) {
+        double v = 0.0;
+
+        switch (func) {
+            case FUNC_SIN:   v = sin(i * 2.0 * M_PI / table_size) * scale; break;
+            case FUNC_COS:   v = cos(i * 2.0 * M_PI / table_size) * scale; break;
+            case FUNC_ATAN:  v = atan((double)i / table_size) * 256.0 / (2.0 * M_PI) * scale; break;
+            case FUNC_SQRT:  v = sqrt((double)i) * scale; break;
+            case FUNC_RECIP: v = i ? (scale / i) : (double)value_max; break;
+        }
+
+        // Round half away from zero
+        long r = (long)((v < 0.0) ? (v - 0.5) : (v + 0.5));
+        if (r < value_min) {
+            r = value_min;
+            clamped++;
+        } else if (r > value_max) {
+            r = value_max;
+            clamped++;
+        }
+        values[i] = r;
+    }
+
+    if (clamped)
+        printf("lut2asset: Warning: %d values clamped to the range of %s%d_t\n", clamped, value_signed ? "int" : "uint", value_bits);
+}
+
+
+static void write_bytes(FILE * f, int shift) {
+    for (int i = 0; i < table_size; i++)
+        fprintf(f, "%s0x%.2X", (i % 16) ? "," : "\n\t.db ", (unsigned int)((values[i] >> shift) & 0xFF));
+    fprintf(f, "\n");
+}
+
+
+static bool write_files(void) {
+
+    char         filename_h[MAX_STR_LEN];
+    char         type_name[16];
+    FILE *       f;
+
+    snprintf(type_name, sizeof(type_name), "%s%d_t", value_signed ? "int" : "uint", value_bits);
+
+    snprintf(filename_h, sizeof(filename_h), "%s", filename_out);
+    char * ext = strrchr(filename_h, '.');
+    if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+        *ext = '\0';
+    strncat(filename_h, ".h", sizeof(filename_h) - strlen(filename_h) - 1);
+
+    // Header
+    if (NULL == (f = fopen(filename_h, "w"))) {
+        printf("lut2asset: ERROR: can't write %s\n", filename_h);
+        return false;
+    }
+    fprintf(f, "#ifndef __%s_INCLUDE\n#define __%s_INCLUDE\n\n", var_name, var_name);
+    fprintf(f, "#include <gbdk/platform.h>\n%s#include <stdint.h>\n\n", output_asm ? "#include <gbdk/lut.h>\n" : "");
+    fprintf(f, "// %s, %d entries, scale %g\n", func_names[func], table_size, scale);
+    fprintf(f, "#define %s_SIZE %d\n\n", var_name, table_size);
+    if (bank)
+        fprintf(f, "BANKREF_EXTERN(%s)\n\n", var_name);
+    if (output_asm) {
+        // Split into pages, read through the page lookup macros
+        fprintf(f, "extern const uint8_t %s[];\n\n", var_name);
+        fprintf(f, "#define %s_GET(i) LUT_PAGE_%c%d(%s, (i))\n", var_name, value_signed ? 'S' : 'U', value_bits, var_name);
+    } else {
+        fprintf(f, "extern const %s %s[];\n\n", type_name, var_name);
+        fprintf(f, "#define %s_GET(i) (%s[(uint8_t)(i)])\n", var_name, var_name);
+    }
+    fprintf(f, "\n#endif\n");
+    fclose(f);
+
+    if (NULL == (f = fopen(filename_out, "w"))) {
+        printf("lut2asset: ERROR: can't write %s\n", filename_out);
+        return false;
+    }
+
+    if (output_asm) {
+        fprintf(f, ";; AUTOGENERATED FILE FROM lut2asset\n\n");
+        fprintf(f, "\t.module %s\n\n", var_name);
+        fprintf(f, "\t.globl _%s\n", var_name);
+        if (bank) {
+            fprintf(f, "\t.globl ___bank_%s\n", var_name);
+            fprintf(f, "\n___bank_%s = %d\n", var_name, bank);
+            fprintf(f, "\n\t.area _CODE_%d\n", bank);
+        } else
+            fprintf(f, "\n\t.area _CODE\n");
+        fprintf(f, "\n\t.bndry 0x100\n");
+        fprintf(f, "_%s::", var_name);
+        write_bytes(f, 0);
+        if (value_bits == 16) {
+            // High bytes on the next page
+            if (table_size < SIZE_MAX_PAGE)
+                fprintf(f, "\t.ds %d\n", SIZE_MAX_PAGE - table_size);
+            write_bytes(f, 8);
+        }
+    } else {
+        if (bank)
+            fprintf(f, "#pragma bank %d\n\n", bank);
+        fprintf(f, "#include <gbdk/platform.h>\n#include <stdint.h>\n\n");
+        if (bank)
+            fprintf(f, "BANKREF(%s)\n\n", var_name);
+        fprintf(f, "const %s %s[%d] = {\n", type_name, var_name, table_size);
+        for (int i = 0; i < table_size; i++)
+            fprintf(f, "%s%ld,%s", (i % 16) ? " " : "\t", values[i], ((i % 16) == 15) ? "\n" : "");
+        fprintf(f, "%s};\n", (table_size % 16) ? "\n" : "");
+    }
+    fclose(f);
+    return true;
+}
+
+
+static bool handle_args(int argc, char * argv[]) {
+
+    if (argc < 2) {
+        display_help();
+        return false;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            func = FUNC_NONE;
+            for (int c = FUNC_SIN; c <= FUNC_RECIP; c++)
+                if (strcmp(argv[i], func_names[c]) == 0)
+                    func = c;
+            if (func == FUNC_NONE) {
+                printf("lut2asset: ERROR: Unknown function %s\n", argv[i]);
+                display_help();
+                return false;
+            }
+        } else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) {
+            snprintf(filename_out, sizeof(filename_out), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-var") == 0) && (i + 1 < argc)) {
+            snprintf(var_name, sizeof(var_name), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc)) {
+            bank = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-u8") == 0) || (strcmp(argv[i], "-s8") == 0) ||
+                   (strcmp(argv[i], "-u16") == 0) || (strcmp(argv[i], "-s16") == 0)) {
+            value_signed = (argv[i][1] == 's');
+            value_bits = atoi(argv[i] + 2);
+            type_given = true;
+        } else if ((strcmp(argv[i], "-size") == 0) && (i + 1 < argc)) {
+            table_size = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-scale") == 0) && (i + 1 < argc)) {
+            scale = atof(argv[++i]);
+            if (scale == 0.0) {
+                printf("lut2asset: ERROR: scale %s must not be 0\n", argv[i]);
+                return false;
+            }
+        } else {
+            if (strcmp(argv[i], "-h") != 0)
+                printf("lut2asset: ERROR: Unknown option %s\n", argv[i]);
+            display_help();
+            return false;
+        }
+    }
+
+    if (func == FUNC_NONE) {
+        display_help();
+        return false;
+    }
+    if ((bank < 0) || (bank > 255)) {
+        printf("lut2asset: ERROR: bank %d must be from 1 to 255\n", bank);
+        return false;
+    }
+    if ((table_size < 2) || (table_size > SIZE_MAX_PAGE)) {
+        printf("lut2asset: ERROR: size %d must be from 2 to %d\n", table_size, SIZE_MAX_PAGE);
+        return false;
+    }
+    if (!type_given)
+        value_signed = (func == FUNC_SIN) || (func == FUNC_COS);
+
+    if (filename_out[0] == '\0')
+        snprintf(filename_out, sizeof(filename_out), "%s.c", func_names[func]);
+    const char * out_ext = strrchr(filename_out, '.');
+    output_asm = out_ext && ((strcmp(out_ext, ".s") == 0) || (strcmp(out_ext, ".asm") == 0));
+
+    // Default variable name: output file name without path and extension
+    if (var_name[0] == '\0') {
+        const char * start = filename_out;
+        for (const char * p = filename_out; *p; p++)
+            if ((*p == '/') || (*p == '\\'))
+                start = p + 1;
+        snprintf(var_name, sizeof(var_name), "%s", start);
+        char * ext = strrchr(var_name, '.');
+        if (ext)
+            *ext = '\0';
+        for (char * p = var_name; *p; p++)
+            if (!isalnum((unsigned char)*p))
+                *p = '_';
+    }
+
+    return true;
+}
+
+
+int main(int argc, char * argv[]) {
+
+    if (!handle_args(argc, argv))
+        return EXIT_FAILURE;
+    table_build();
+    return write_files() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
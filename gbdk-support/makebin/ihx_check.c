@@ -0,0 +1,114 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// The ihxcheck tests (multiple writes to the same address, bank overflows)
+// run on records as makebin decodes them, so the .ihx only gets read and
+// parsed once (makebin -k). Same logic and warnings as ihxcheck/ihx_file.c,
+// printed to stderr since makebin may be writing the rom to stdout.
+// The area list is ihxcheck's own areas.c, built from ../ihxcheck.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "areas.h"
+#include "ihx_check.h"
+
+#define ADDR_UNSET      0xFFFFFFFEU
+
+bank_info banks[BANKS_MAX_COUNT];
+
+static area_item area;
+static bool      check_ok;
+static bool      check_warnings_as_errors;
+
+
+static void ihx_check_area_add(void) {
+
+    if (!areas_add(&area) && check_warnings_as_errors)
+        check_ok = false;
+}
+
+
+// See ihx_check_for_overflows() in ihxcheck for the criteria
+static void ihx_check_for_overflows(void) {
+
+    for (int c = 0; c < BANKS_MAX_COUNT; c++) {
+        if (banks[c].overflowed_into && banks[c].had_multiple_write_warning) {
+
+            fprintf(stderr, "Warning: Possible overflow from Bank %d into Bank %d\n", banks[c].overflow_from, c);
+        }
+    }
+}
+
+
+void ihx_check_init(bool warnings_as_errors) {
+
+    memset(banks, 0, sizeof(banks));
+    areas_set_warning_file(stderr);
+    areas_init();
+
+    area.start = ADDR_UNSET;
+    area.end   = ADDR_UNSET;
+
+    check_ok = true;
+    check_warnings_as_errors = warnings_as_errors;
+}
+
+
+// Call for each data record with the extended linear address already applied
+void ihx_check_data_record(uint32_t address, uint32_t byte_count) {
+
+    uint32_t address_end;
+
+    // Don't process records with zero bytes of length
+    if (byte_count == 0) {
+        fprintf(stderr, "Warning: IHX: Zero length record starting at %x\n", address & 0xFFFFU);
+        return;
+    }
+
+    address_end = address + byte_count - 1;
+
+    // For records that start in banks above the unbanked region (0x000 - 0x3FFF)
+    // Warn (but don't error) if they cross the boundary between different banks
+    if ((address & 0xFFFFC000U) != (address_end & 0xFFFFC000U)) {
+
+        if (address >= 0x00004000U) {
+            fprintf(stderr, "Warning: Write from one bank spans into the next. 0x%x -> 0x%x (bank %d -> %d)\n",
+                    address, address_end, BANK_NUM(address), BANK_NUM(address_end));
+        }
+        // Log all writes that spans multiple banks, including bank 0 -> 1
+        // Used later to help check for overflow
+        banks[BANK_NUM(address_end)].overflowed_into = true;
+        banks[BANK_NUM(address_end)].overflow_from = BANK_NUM(address);
+    }
+
+    // Try to merge with (pending) previous record if it's address-adjacent,
+    // except when the new record starts or ends on a bank boundary
+    if ((address == area.end + 1) && ((address & 0x00003FFFU) != 0x00000000U)) {
+        area.end = address_end;  // append to previous area
+    } else if ((address_end == area.start + 1) && !((address_end & 0x00003FFFU) != 0x00003FFFU)) {
+        area.start = address;    // pre-pend to previous area
+    } else {
+        // New record was *not* adjacent to last, so process the last/pending record
+        if (area.start != ADDR_UNSET)
+            ihx_check_area_add();
+
+        // Now queue current record as pending
+        area.start = address;
+        area.end   = address_end;
+    }
+}
+
+
+// Call after the EOF record. Returns false if warnings are treated as errors and there were any
+bool ihx_check_finish(void) {
+
+    ihx_check_area_add();
+    ihx_check_for_overflows();
+    areas_cleanup();
+
+    return check_ok;
+}
@@ -0,0 +1,11 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _IHX_CHECK_H
+#define _IHX_CHECK_H
+
+void ihx_check_init(bool warnings_as_errors);
+void ihx_check_data_record(uint32_t address, uint32_t byte_count);
+bool ihx_check_finish(void);
+
+#endif // _IHX_CHECK_H
@@ -39,51 +39,137 @@
 #include <unistd.h>
 #endif
 
+#include "ihx_check.h"
+#include "patch.h"
+
 
 typedef unsigned char BYTE;
 
 #define BANK_SIZE 16384
 #define FILL_BYTE 0xff
+#define INES_HEADER_SIZE 16
 
-int
-getnibble (FILE *fin)
+#define IHX_READ_CHUNK 0x10000
+
+#define IHX_CHECK_OFF      0
+#define IHX_CHECK_WARN     1
+#define IHX_CHECK_ERROR    2 /* treat warnings as errors */
+
+static int ihx_check = IHX_CHECK_OFF;
+#define HEX_INVALID    0xff
+
+// Whole IHX file held in memory for parsing
+struct ihx_buf_s
 {
-  int ret;
-  int c = getc (fin);
+  BYTE *data;
+  BYTE *p;
+  BYTE *end;
+};
+
+// Maps characters to nibble values, HEX_INVALID if not accepted
+static BYTE hex_table[256];
 
-  if (feof (fin) || ferror (fin))
+static void
+hex_table_init (void)
+{
+  int c;
+
+  // Same conversion as the former per-character getnibble() arithmetic,
+  // so exactly the same set of characters is accepted
+  for (c = 0; c < 256; c++)
     {
-      fprintf (stderr, "error: unexpected end of file.\n");
-      exit (6);
+      int ret = c - '0';
+      if (ret > 9)
+        ret -= 'A' - '9' - 1;
+      if (ret > 0xf)
+        ret -= 'a' - 'A';
+      hex_table[c] = (ret < 0 || ret > 0xf) ? HEX_INVALID : ret;
     }
+}
+
+// Read all of fin into memory, works for stdin as well as regular files
+static int
+ihx_buf_load (FILE *fin, struct ihx_buf_s *ib)
+{
+  size_t alloc_size = IHX_READ_CHUNK;
+  size_t len = 0;
+  size_t n;
 
-  ret = c - '0';
-  if (ret > 9)
+  ib->data = malloc (alloc_size);
+  while (ib->data != NULL)
     {
-      ret -= 'A' - '9' - 1;
+      n = fread (ib->data + len, 1, alloc_size - len, fin);
+      len += n;
+      if (len < alloc_size)
+        break;
+
+      BYTE *t_data = ib->data;
+      alloc_size *= 2;
+      ib->data = realloc (ib->data, alloc_size);
+      if (ib->data == NULL)
+        free (t_data);
     }
 
-  if (ret > 0xf)
+  if (ib->data == NULL)
+    {
+      fprintf (stderr, "error: couldn't allocate room for the ihx file.\n");
+      return 0;
+    }
+
+  ib->p = ib->data;
+  ib->end = ib->data + len;
+  return 1;
+}
+
+static int
+ihx_getc (struct ihx_buf_s *ib)
+{
+  return (ib->p < ib->end) ? *ib->p++ : EOF;
+}
+
+static int
+getnibble (struct ihx_buf_s *ib)
+{
+  int ret;
+
+  if (ib->p >= ib->end)
     {
-       ret -= 'a' - 'A';
+      fprintf (stderr, "error: unexpected end of file.\n");
+      exit (6);
     }
 
-  if (ret < 0 || ret > 0xf)
+  ret = hex_table[*ib->p];
+  if (ret == HEX_INVALID)
     {
+      // Report the same value as the former arithmetic decoder
+      ret = *ib->p - '0';
+      if (ret > 9)
+        ret -= 'A' - '9' - 1;
+      if (ret > 0xf)
+        ret -= 'a' - 'A';
       fprintf (stderr, "error: character %02x.\n", ret);
       exit (7);
     }
+  ib->p++;
   return ret;
 }
 
-int
-getbyte (FILE *fin, int *sum)
+static int
+getbyte (struct ihx_buf_s *ib, int *sum)
 {
-  int b = (getnibble (fin) << 4) | getnibble (fin);
+  int b = getnibble (ib) << 4;
+  b |= getnibble (ib);
   *sum += b;
   return b;
 }
 
+static void
+ihx_skip_space (struct ihx_buf_s *ib)
+{
+  while ((ib->p < ib->end) && isspace (*ib->p))  /* skip all kind of spaces */
+    ib->p++;
+}
+
 void
 usage (void)
 {
@@ -97,6 +183,10 @@ usage (void)
            "  -S             generate Sega Master System format binary file\n"
            "  -N             generate Famicom/NES format binary file\n"
            "  -o bytes       skip amount of bytes in binary file\n"
+           "  -k             run the ihxcheck tests on the input while converting it\n"
+           "  -ke            same as -k, but treat ihxcheck warnings as errors\n"
+           "  -ips old patch write an IPS patch from the image in file old to the output\n"
+           "  -bps old patch write a BPS patch from the image in file old to the output\n"
 
            "SMS format options (applicable only with -S option):\n"
            "  -xo n          header rom size (0xa-0x2) (default: 0xc)\n"
@@ -111,6 +201,11 @@ usage (void)
            //"  -xn n          SDSC program name pointer\n"
            //"  -xD n          SDSC description pointer\n"
 
+           "NES format options (applicable only with -N option):\n"
+           "  -ym n          iNES mapper number (default: 30, UNROM 512)\n"
+           "  -c chr_file    add chr_file to CHR-ROM instead of using CHR-RAM, can be repeated\n"
+           "                 (the files are added in order, padded to a multiple of 8K)\n"
+
            "GameBoy format options (applicable only with -Z option):\n"
            "  -yo n          number of rom banks (default: 2) (autosize: A)\n"
            "  -ya n          number of ram banks (default: 0)\n"
@@ -121,10 +216,14 @@ usage (void)
            "  -yc            GameBoy Color compatible\n"
            "  -yC            GameBoy Color only\n"
            "  -ys            Super GameBoy\n"
-           "  -yS            Convert .noi file named like input file to .sym\n"
+           "  -yS            Convert .noi file named like input file to .sym, sorted by bank and address\n"
+           "  -yI            with -yS also write a binary index of the symbols and their sizes (.symidx)\n"
            "  -yj            set non-Japanese region flag\n"
            "  -yN            do not copy big N validation logo into ROM header\n"
            "  -yp addr=value Set address in ROM to given value (address 0x100-0x1FE)\n"
+           "  -yv file=flags also write a variant with other header flags to file, flags are\n"
+           "                 joined with '+': c, C, s, j (like -yc -yC -ys -yj), d (no CGB\n"
+           "                 or SGB flags) and tn (MBC type), for example -yv game.gbc=C+t0x1B\n"
            "Arguments:\n"
            "  <in_file>      optional IHX input file, '-' means stdin. (default: stdin)\n"
            "  <out_file>     optional output file, '-' means stdout. (default: stdout)\n");
@@ -143,12 +242,27 @@ struct gb_opt_s
   BYTE is_gbc;                    /* 1 if GBC compatible, 2 if GBC only, false for all other*/
   BYTE is_sgb;                    /* True if SGB, false for all other*/
   BYTE sym_conversion;            /* True if .noi file should be converted to .sym (default false)*/
+  BYTE sym_index;                 /* True if a binary .symidx should be written with the .sym (default false)*/
   BYTE non_jp;                    /* True if non-Japanese region, false for all other*/
   BYTE rom_banks_autosize;        /* True if rom banks should be auto-sized (default false)*/
   bool do_logo_copy;              /* True if the nintendo logo should be copied into the ROM (default true) */
   BYTE address_overwrite[16];     /* For limited compatibility with very old versions */
 };
 
+// Up to MAX_GB_VARIANTS -yv variants are written from the one image
+#define MAX_GB_VARIANTS 8
+
+struct gb_variant_s
+{
+  char *out_file;
+  char *flags;      /* Header flags joined with '+' */
+};
+
+// Up to MAX_CHR_FILES -c files make up the NES CHR-ROM
+#define MAX_CHR_FILES 16
+#define CHR_BANK_SIZE 8192
+#define CHR_MAX_BANKS 255
+
 struct sms_opt_s
 {
   uint8_t rom_size;                  /* Doesn't have to be the real size, needed for checksum */
@@ -167,9 +281,237 @@ struct nes_opt_s
     bool battery;
 };
 
+// ROM image held as 16K banks. A bank is only allocated once something is
+// written to it, the others read as FILL_BYTE. Large carts (such as 8MB
+// MBC5 ROMs) are mostly padding, which then costs neither memory nor time.
+//
+// The sum of each bank's bytes is kept up to date by rom_set(), so the
+// checksums cost time per byte written instead of per byte of ROM. Banks
+// written through a pointer from rom_ptr() (the headers) are summed again.
+struct rom_s
+{
+  BYTE **banks;   /* NULL for a bank which is all FILL_BYTE */
+  unsigned long *sums;  /* Sum of the bytes of each allocated bank */
+  BYTE *resum;    /* Non zero if a bank's sum has to be recalculated */
+  int nb_banks;
+  int size;       /* Image size in bytes */
+};
+
+// One bank of FILL_BYTE, for reads and writes of untouched banks
+static BYTE fill_bank[BANK_SIZE];
+
+static int
+rom_resize (struct rom_s *r, int size)
+{
+  int nb_banks = (size + BANK_SIZE - 1) / BANK_SIZE;
+
+  if (nb_banks > r->nb_banks)
+    {
+      BYTE **t_banks = r->banks;
+      unsigned long *t_sums = r->sums;
+      BYTE *t_resum = r->resum;
+      r->banks = realloc (r->banks, nb_banks * sizeof (BYTE *));
+      r->sums = realloc (r->sums, nb_banks * sizeof (unsigned long));
+      r->resum = realloc (r->resum, nb_banks);
+      if ((r->banks == NULL) || (r->sums == NULL) || (r->resum == NULL))
+        {
+          free (r->banks ? r->banks : t_banks);
+          free (r->sums ? r->sums : t_sums);
+          free (r->resum ? r->resum : t_resum);
+          return 0;
+        }
+      memset (r->banks + r->nb_banks, 0, (nb_banks - r->nb_banks) * sizeof (BYTE *));
+      memset (r->resum + r->nb_banks, 0, nb_banks - r->nb_banks);
+      r->nb_banks = nb_banks;
+    }
+  r->size = size;
+  return 1;
+}
+
+static int
+rom_init (struct rom_s *r, int size)
+{
+  memset (fill_bank, FILL_BYTE, sizeof (fill_bank));
+  r->banks = NULL;
+  r->sums = NULL;
+  r->resum = NULL;
+  r->nb_banks = 0;
+  return rom_resize (r, size);
+}
+
+// The bank holding addr, allocating it on first use
+static BYTE *
+rom_bank (struct rom_s *r, int addr)
+{
+  BYTE **bank = &r->banks[addr / BANK_SIZE];
+
+  if (*bank == NULL)
+    {
+      if ((*bank = malloc (BANK_SIZE)) == NULL)
+        {
+          fprintf (stderr, "error: couldn't allocate room for the image.\n");
+          exit (1);
+        }
+      memset (*bank, FILL_BYTE, BANK_SIZE);
+      r->sums[addr / BANK_SIZE] = (unsigned long) FILL_BYTE * BANK_SIZE;
+    }
+  return *bank;
+}
+
+// Pointer to the byte at addr, allocating its bank on first use
+// Writes through it aren't tracked, so the bank is always summed byte by byte
+static BYTE *
+rom_ptr (struct rom_s *r, int addr)
+{
+  BYTE *bank = rom_bank (r, addr);
+
+  r->resum[addr / BANK_SIZE] = 1;
+  return bank + (addr % BANK_SIZE);
+}
+
+static BYTE
+rom_get (const struct rom_s *r, int addr)
+{
+  const BYTE *bank;
+
+  if (addr >= r->size)
+    return FILL_BYTE;
+  bank = r->banks[addr / BANK_SIZE];
+  return bank ? bank[addr % BANK_SIZE] : FILL_BYTE;
+}
+
+static void
+rom_set (struct rom_s *r, int addr, BYTE value)
+{
+  BYTE *p;
+
+  if (addr < r->size)
+    {
+      p = rom_bank (r, addr) + (addr % BANK_SIZE);
+      r->sums[addr / BANK_SIZE] += value - *p;
+      *p = value;
+    }
+}
+
+static unsigned long
+bytes_sum (const BYTE *p, int len)
+{
+  unsigned long chk = 0;
+  int i;
+
+  for (i = 0; i < len; i++)
+    chk += p[i];
+  return chk;
+}
+
+// Sum of the bytes in [start, end), untouched banks add a constant and
+// ranges covering most of a bank use its sum minus the bytes left out
+static unsigned long
+rom_sum (struct rom_s *r, int start, int end)
+{
+  unsigned long chk = 0;
+
+  if (end > r->size)
+    {
+      chk += (unsigned long) FILL_BYTE * (end - (start > r->size ? start : r->size));
+      end = r->size;
+    }
+  while (start < end)
+    {
+      const BYTE *bank = r->banks[start / BANK_SIZE];
+      int len = BANK_SIZE - (start % BANK_SIZE);
+
+      if (len > end - start)
+        len = end - start;
+      if (bank == NULL)
+        chk += (unsigned long) FILL_BYTE * len;
+      else if ((len > BANK_SIZE / 2) && !r->resum[start / BANK_SIZE])
+        {
+          int offset = start % BANK_SIZE;
+
+          chk += r->sums[start / BANK_SIZE] - bytes_sum (bank, offset) - bytes_sum (bank + offset + len, BANK_SIZE - offset - len);
+        }
+      else
+        chk += bytes_sum (bank + (start % BANK_SIZE), len);
+      start += len;
+    }
+  return chk;
+}
+
+// Copy the bytes in [start, end) to the file f, or to buf when f is NULL
+// Returns the number of bytes copied
+static int
+rom_copy_out (const struct rom_s *r, int start, int end, FILE *f, BYTE *buf)
+{
+  int written = 0;
+
+  while (start < end)
+    {
+      const BYTE *src = fill_bank;
+      int len = BANK_SIZE - (start % BANK_SIZE);
+
+      if (len > end - start)
+        len = end - start;
+      if (start < r->size && r->banks[start / BANK_SIZE])
+        src = r->banks[start / BANK_SIZE] + (start % BANK_SIZE);
+      if (f)
+        {
+          if (fwrite (src, 1, len, f) != (size_t) len)
+            return written;
+        }
+      else
+        memcpy (buf + written, src, len);
+      start += len;
+      written += len;
+    }
+  return written;
+}
+
+// SRAM_SIZE_DECLARE() in gb/sram.h: the tag, then the size in bytes as 32 bit little endian
+static const char sram_size_tag[] = "GBDKSRAM";
+#define SRAM_SIZE_TAG_LEN  (sizeof (sram_size_tag) - 1)
+#define SRAM_SIZE_REC_LEN  (SRAM_SIZE_TAG_LEN + 4)
+#define SRAM_BANK_SIZE     0x2000
+
+// Warn when the SRAM size declared by the program doesn't fit in the RAM banks of the header
+static void
+gb_check_sram_size (const struct rom_s *r, const struct gb_opt_s *o)
+{
+  int addr = 0, i;
+  unsigned long declared;
+
+  while (addr <= r->size - (int) SRAM_SIZE_REC_LEN)
+    {
+      if (r->banks[addr / BANK_SIZE] == NULL)
+        {
+          addr = ((addr / BANK_SIZE) + 1) * BANK_SIZE;
+          continue;
+        }
+      for (i = 0; i < (int) SRAM_SIZE_TAG_LEN; i++)
+        if (rom_get (r, addr + i) != (BYTE) sram_size_tag[i])
+          break;
+      if (i == (int) SRAM_SIZE_TAG_LEN)
+        {
+          declared = 0;
+          for (i = 3; i >= 0; i--)
+            declared = (declared << 8) | rom_get (r, addr + SRAM_SIZE_TAG_LEN + i);
+          if (declared > (unsigned long) o->nb_ram_banks * SRAM_BANK_SIZE)
+            fprintf (stderr, "\nWARNING: the program uses %lu bytes of SRAM (SRAM_SIZE_DECLARE()), but only %d RAM banks (%d bytes) are set."
+                             "\n         \"-ya %lu\" for makebin (or \"-Wm-ya%lu\" for LCC) can be used to set the number of RAM banks\n\n",
+                             declared, o->nb_ram_banks, o->nb_ram_banks * SRAM_BANK_SIZE,
+                             (declared <= SRAM_BANK_SIZE) ? 1ul : ((declared <= 4ul * SRAM_BANK_SIZE) ? 4ul : 16ul),
+                             (declared <= SRAM_BANK_SIZE) ? 1ul : ((declared <= 4ul * SRAM_BANK_SIZE) ? 4ul : 16ul));
+          return;
+        }
+      addr++;
+    }
+}
+
 void
-gb_postproc (BYTE * rom, int size, int *real_size, struct gb_opt_s *o)
+gb_postproc (struct rom_s *r, int *real_size, struct gb_opt_s *o)
 {
+  // The header is all in bank 0
+  BYTE *rom = rom_ptr (r, 0);
   int i, chk;
   static const BYTE gb_logo[] =
     {
@@ -328,6 +670,8 @@ gb_postproc (BYTE * rom, int size, int *real_size, struct gb_opt_s *o)
       break;
     }
 
+  gb_check_sram_size (r, o);
+
   rom[0x14A] = o->non_jp;
 
   rom[0x14B] = o->licensee_id;
@@ -380,8 +724,7 @@ gb_postproc (BYTE * rom, int size, int *real_size, struct gb_opt_s *o)
   chk = 0;
   rom[0x14e] = 0;
   rom[0x14f] = 0;
-  for (i = 0; i < size; ++i)
-    chk += rom[i];
+  chk = rom_sum (r, 0, r->size);
   rom[0x14e] = (unsigned char) ((chk >> 8) & 0xff);
   rom[0x14f] = (unsigned char) (chk & 0xff);
 
@@ -390,14 +733,16 @@ gb_postproc (BYTE * rom, int size, int *real_size, struct gb_opt_s *o)
 }
 
 void
-sms_postproc (BYTE * rom, int size, int *real_size, struct sms_opt_s *o)
+sms_postproc (struct rom_s *r, int *real_size, struct sms_opt_s *o)
 {
   // based on https://www.smspower.org/Development/ROMHeader
   // 0x1ff0 and 0x3ff0 are also possible, but never used
   static const char tmr_sega[] = "TMR SEGA  ";
   short header_base = 0x7ff0;
   int chk = 0;
+  int size = r->size;
   unsigned long i;
+  BYTE *header;
 
   // Emulators use ROM file size (var:size) (64K or greater) to determine whether a mapper is present, and RAM banks only work if a mapper is present.
   // So warn if that criteria is not met.
@@ -413,7 +758,8 @@ sms_postproc (BYTE * rom, int size, int *real_size, struct sms_opt_s *o)
   if (header_base > size)
     header_base = 0x1ff0;
 
-  memcpy (&rom[header_base], tmr_sega, sizeof (tmr_sega) - 1);
+  header = rom_ptr (r, header_base);
+  memcpy (header, tmr_sega, sizeof (tmr_sega) - 1);
   // configure amounts of bytes to check
   switch(o->rom_size)
     {
@@ -446,31 +792,24 @@ sms_postproc (BYTE * rom, int size, int *real_size, struct sms_opt_s *o)
         i = 0xFFFFF;
         break;
     }
-  // calculate checksum
-  for(;i > 0; --i)
-    {
-      chk += rom[i];
-      // 0x7FF0 - 0x7FFF is skipped
-      if(i == 0x8000)
-        i = 0x7FF0;
-    }
-  // we  skipped index 0
-  chk += rom[0];
+  // calculate checksum, 0x7FF0 - 0x7FFF is skipped
+  if (i < 0x8000)
+    chk = rom_sum (r, 0, i + 1);
+  else
+    chk = rom_sum (r, 0, 0x7FF0) + rom_sum (r, 0x8000, i + 1);
   // little endian
-  rom[header_base + 0xa] = chk & 0xff;
-  rom[header_base + 0xb] = (chk>>8) & 0xff;
+  header[0xa] = chk & 0xff;
+  header[0xb] = (chk>>8) & 0xff;
   // game version
-  rom[header_base + 0xe] &= 0xF0;
-  rom[header_base + 0xe] |= o->version;
+  header[0xe] &= 0xF0;
+  header[0xe] |= o->version;
   // rom size
-  rom[header_base + 0xf] = (o->region_code << 4) | o->rom_size;
+  header[0xf] = (o->region_code << 4) | o->rom_size;
 }
 
 int
-rom_autosize_grow(BYTE **rom, int test_size, int *size, struct gb_opt_s *o)
+rom_autosize_grow(struct rom_s *rom, int test_size, int *size, struct gb_opt_s *o)
 {
-  int last_size = *size;
-
   while ((test_size > *size) && (o->nb_rom_banks <= 512))
     {
       o->nb_rom_banks *= 2;
@@ -484,38 +823,163 @@ rom_autosize_grow(BYTE **rom, int test_size, int *size, struct gb_opt_s *o)
       fprintf (stderr, "error: auto-size banks exceeded max of 512 banks.\n");
       return 0;
     }
-  else
+  // The new banks are left unallocated until they get written to
+  else if (!rom_resize (rom, *size))
     {
-      BYTE * t_rom = *rom;
-      *rom = realloc (*rom, *size);
-      if (*rom == NULL)
-        {
-          free(t_rom);
-          fprintf (stderr, "error: couldn't re-allocate size for larger rom image.\n");
-          return 0;
-        }
-      memset (*rom + last_size, FILL_BYTE, *size - last_size);
+      fprintf (stderr, "error: couldn't re-allocate size for larger rom image.\n");
+      return 0;
     }
 
   return 1;
 }
 
+// no$gmb's implementation is limited to 32 character labels
+// we can safely throw away the rest
+#define SYM_FILE_NAME_LEN_MAX 32
+
+// Binary symbol index written with -yI, all values little endian:
+//   header:  "GSYM", uint16 version, uint16 reserved, uint32 count, uint32 strings offset
+//   entries: count * { uint16 bank, uint16 address, uint16 size, uint16 reserved, uint32 name offset }
+//   strings: NUL terminated names, offsets are from the start of the strings
+// Entries are sorted by bank and address like the .sym, so the symbol of an
+// address is found with a binary search.
+#define SYM_INDEX_VERSION     1
+#define SYM_INDEX_HEADER_SIZE 16
+#define SYM_INDEX_ENTRY_SIZE  12
+
+typedef struct
+{
+  char *name;
+  uint32_t value;   /* bank << 16 | address */
+  uint32_t size;
+  bool is_length;   /* l__<area>, not an address */
+} noi_symbol;
+
+typedef struct
+{
+  char *name;       /* without the s__ or l__ */
+  uint32_t start;
+  uint32_t end;
+  bool has_start;
+  bool has_length;
+} noi_area;
+
+static int
+noi_symbol_cmp (const void *a, const void *b)
+{
+  const noi_symbol *sa = a, *sb = b;
+
+  if (sa->value != sb->value)
+    return (sa->value < sb->value) ? -1 : 1;
+  return strcmp (sa->name, sb->name);
+}
+
+static noi_area *
+noi_area_get (noi_area **areas, int *count, const char *name)
+{
+  int i;
+
+  for (i = 0; i < *count; i++)
+    if (!strcmp ((*areas)[i].name, name))
+      return &(*areas)[i];
+  *areas = realloc (*areas, (*count + 1) * sizeof (noi_area));
+  memset (&(*areas)[*count], 0, sizeof (noi_area));
+  (*areas)[*count].name = strdup (name);
+  return &(*areas)[(*count)++];
+}
+
+static void
+put_le (FILE *f, uint32_t value, int bytes)
+{
+  while (bytes--)
+    {
+      fputc (value & 0xFF, f);
+      value >>= 8;
+    }
+}
+
+// Sizes reach up to the next symbol, or the end of the area the symbol is
+// in if that comes first. Symbols outside of all areas (constants) get 0.
+static void
+noi_symbol_sizes (noi_symbol *syms, int count, noi_area *areas, int area_count)
+{
+  int i, a;
+
+  for (i = 0; i < count; i++)
+    {
+      uint32_t end = 0;
+      int next;
+
+      if (syms[i].is_length)
+        continue;
+      for (a = 0; a < area_count; a++)
+        if (areas[a].has_start && areas[a].has_length && (areas[a].end > areas[a].start)
+            && (syms[i].value >= areas[a].start) && (syms[i].value < areas[a].end))
+          {
+            end = areas[a].end;
+            break;
+          }
+      if (end == 0)
+        continue;
+      // Labels at the same address all reach up to the next address
+      for (next = i + 1; (next < count) && (syms[next].is_length || (syms[next].value == syms[i].value)); next++);
+      if ((next < count) && (syms[next].value < end))
+        end = syms[next].value;
+      syms[i].size = end - syms[i].value;
+    }
+}
+
+static int
+write_sym_index (const char *iname, noi_symbol *syms, int count)
+{
+  FILE *idx;
+  uint32_t name_offset = 0;
+  int i;
+
+  if (NULL == (idx = fopen (iname, "wb")))
+    {
+      fprintf (stderr, "error: can't create %s: ", iname);
+      perror(NULL);
+      return 1;
+    }
+  fwrite ("GSYM", 1, 4, idx);
+  put_le (idx, SYM_INDEX_VERSION, 2);
+  put_le (idx, 0, 2);
+  put_le (idx, count, 4);
+  put_le (idx, SYM_INDEX_HEADER_SIZE + (count * SYM_INDEX_ENTRY_SIZE), 4);
+  for (i = 0; i < count; i++)
+    {
+      put_le (idx, syms[i].value >> 16, 2);
+      put_le (idx, syms[i].value & 0xFFFF, 2);
+      put_le (idx, (syms[i].size > 0xFFFF) ? 0xFFFF : syms[i].size, 2);
+      put_le (idx, 0, 2);
+      put_le (idx, name_offset, 4);
+      name_offset += strlen (syms[i].name) + 1;
+    }
+  for (i = 0; i < count; i++)
+    fwrite (syms[i].name, 1, strlen (syms[i].name) + 1, idx);
+  fclose (idx);
+
+  fprintf (stderr, "Wrote %d symbols to %s.\n", count, iname);
+  return 0;
+}
+
+// Converts the .noi of the linker into a .sym sorted by bank and address,
+// with a comment line at the start of each bank. With write_index the
+// symbols and their sizes are also written to a binary .symidx.
 int
-noi2sym (char *filename)
+noi2sym (char *filename, bool write_index)
 {
   FILE *noi, *sym;
-  char *nname, *sname;
-  //ssize_t read;
-  char read = ' ';
-  // no$gmb's implementation is limited to 32 character labels
-  // we can safely throw away the rest
-  #define SYM_FILE_NAME_LEN_MAX 32
-  char label[SYM_FILE_NAME_LEN_MAX + 1];
-  // 0x + 6 digit hex number
-  // -> 65536 rom banks is the maximum homebrew cartrideges support (TPP1)
-  char value[9];
+  char *nname, *sname, *iname;
+  char line[1024], label[1024];
+  long value;
+  noi_symbol *syms = NULL;
+  noi_area *areas = NULL;
+  int count = 0, area_count = 0;
   int name_len = strlen(filename);
-  int i = 0;
+  int i, ret = 0;
+  long bank = -1;
   // copy filename's value to nname and sname
   nname = malloc((name_len+1) * sizeof(char));
   strcpy (nname, filename);
@@ -535,89 +999,86 @@ noi2sym (char *filename)
       perror(NULL);
       return 1;
     }
-  if (NULL == (sym = fopen (sname, "w")))
-    {
-      fprintf (stderr, "error: can't create %s: ", sname);
-      perror(NULL);
-      return 1;
-    }
-  // write header
-  fprintf (sym, "; no$gmb compatible .sym file\n; Generated automagically by makebin\n");
-  // iterate through .noi file
-  while (read != EOF && (read = fgetc(noi)) != EOF)
+  // "DEF <label> <value>" lines, area starts and lengths are s__<area> and l__<area>
+  while (fgets (line, sizeof(line), noi))
     {
-      // just skip line breaks
-      if (read == '\r' || read == '\n')
+      if ((sscanf (line, "DEF %1023s %li", label, &value) != 2) || !strcmp(label, ".__.ABS."))
         continue;
-      // read first 4 chars
-      for (i = 0; i < 4; ++i)
+      if (!strncmp (label, "s__", 3) || !strncmp (label, "l__", 3))
         {
-          value[i] = read;
-          if ((read = fgetc(noi)) == EOF || read == '\r' || read == '\n')
+          noi_area *area = noi_area_get (&areas, &area_count, label + 3);
+          if (label[0] == 's')
             {
-              // leave for-loop
-              break;
+              area->start = value;
+              area->has_start = true;
             }
-        }
-      // we left loop early
-      if (i != 4)
-        continue;
-      // only accept if line starts with this
-      if (strncmp(value, "DEF ", 4) == 0)
-        {
-          // read label
-          for (i = 0; i < (SYM_FILE_NAME_LEN_MAX - 1); ++i)
+          else
             {
-              label[i] = read;
-              if ((read = fgetc(noi)) == EOF || read == '\r' || read == '\n' || read == ' ')
-                {
-                  // leave for-loop
-                  break;
-                }
+              area->end = value;
+              area->has_length = true;
             }
-          // skip rest of the label
-          while (read != EOF && read != '\r' && read != '\n' && read != ' ')
-            read = fgetc(noi);
-          // it has to be end of file or line if it's not space
-          if (read != ' ')
-            continue;
-          // strings have to end with \0
-          label[i+1] = '\0';
-          // read value
-          for (i = 0; i < 8; ++i)
+        }
+      syms = realloc (syms, (count + 1) * sizeof (noi_symbol));
+      syms[count].name = strdup (label);
+      syms[count].value = value;
+      syms[count].size = 0;
+      syms[count].is_length = !strncmp (label, "l__", 3);
+      count++;
+    }
+  fclose (noi);
+  // The length was stored in end
+  for (i = 0; i < area_count; i++)
+    areas[i].end += areas[i].start;
+  qsort (syms, count, sizeof (noi_symbol), noi_symbol_cmp);
+  noi_symbol_sizes (syms, count, areas, area_count);
+
+  if (NULL == (sym = fopen (sname, "w")))
+    {
+      fprintf (stderr, "error: can't create %s: ", sname);
+      perror(NULL);
+      ret = 1;
+    }
+  else
+    {
+      // write header
+      fprintf (sym, "; no$gmb compatible .sym file\n; Generated automagically by makebin\n");
+      fprintf (sym, "; Sorted by bank and address\n");
+      for (i = 0; i < count; i++)
+        {
+          if ((long)(syms[i].value >> 16) != bank)
             {
-              value[i] = read;
-              if ((read = fgetc(noi)) == EOF || read == '\r' || read == '\n')
-                {
-                  // leave for-loop
-                  break;
-                }
+              bank = syms[i].value >> 16;
+              fprintf (sym, "; Bank %02X\n", (unsigned int)bank);
             }
-          // number is too long; ignore
-          if (read != EOF && read != '\r' && read != '\n')
-            continue;
-          value[i+1] = '\0';
-          // we successfully read label and value
-
-          // but filter out some invalid symbols
-          if (strcmp(label, ".__.ABS.") != 0)
-            fprintf (sym, "%02X:%04X %s\n", (unsigned int)(strtoul(value, NULL, 0)>>16), (unsigned int)strtoul(value, NULL, 0)&0xFFFF, label);
+          fprintf (sym, "%02X:%04X %.*s\n", (unsigned int)(syms[i].value >> 16), (unsigned int)(syms[i].value & 0xFFFF),
+                   SYM_FILE_NAME_LEN_MAX - 1, syms[i].name);
         }
-      else
-        // skip until file/line end
-        while ((read = fgetc(noi))!= EOF && read != '\r' && read != '\n');
+      fclose (sym);
+      fprintf (stderr, "Converted %s to %s.\n", nname, sname);
     }
 
-  // free close files
-  fclose (noi);
-  fclose (sym);
+  if ((ret == 0) && write_index)
+    {
+      iname = malloc(name_len + 4);
+      strcpy (iname, sname);
+      strcat (iname, "idx");
+      ret = write_sym_index (iname, syms, count);
+      free (iname);
+    }
 
-  fprintf (stderr, "Converted %s to %s.\n", nname, sname);
-  return 0;
+  for (i = 0; i < count; i++)
+    free (syms[i].name);
+  for (i = 0; i < area_count; i++)
+    free (areas[i].name);
+  free (syms);
+  free (areas);
+  free (nname);
+  free (sname);
+  return ret;
 }
 
-int
-read_ihx (FILE *fin, BYTE **rom, int *size, int *real_size, struct gb_opt_s *o)
+static int
+read_ihx_records (struct ihx_buf_s *ib, struct rom_s *rom, int *size, int *real_size, struct gb_opt_s *o)
 {
   int record_type;
 
@@ -628,39 +1089,40 @@ read_ihx (FILE *fin, BYTE **rom, int *size, int *real_size, struct gb_opt_s *o)
       int addr;
       int checksum, sum = 0;
 
-      if (getc (fin) != ':')
+      if (ihx_getc (ib) != ':')
         {
           fprintf (stderr, "error: invalid IHX line.\n");
           return 0;
         }
-      nbytes = getbyte (fin, &sum);
-      addr = getbyte (fin, &sum) << 8 | getbyte (fin, &sum);
-      record_type = getbyte (fin, &sum);
+      nbytes = getbyte (ib, &sum);
+      addr = getbyte (ib, &sum) << 8;
+      addr |= getbyte (ib, &sum);
+      record_type = getbyte (ib, &sum);
       if(record_type == 4)
         {
-          extaddr = getbyte (fin, &sum) << 8 | getbyte (fin, &sum);
+          extaddr = getbyte (ib, &sum) << 8;
+          extaddr |= getbyte (ib, &sum);
           extaddr <<= 16; // those are the upper 16 bits
-          checksum = getbyte (fin, &sum);
+          checksum = getbyte (ib, &sum);
           // move to the next record
           if (0 != (sum & 0xff))
             {
               fprintf (stderr, "error: bad checksum: %02x.\n", checksum);
               return 0;
             }
-          while (isspace (sum = getc (fin)))  /* skip all kind of spaces */
-            ;
-          ungetc (sum, fin);
-          if (getc (fin) != ':')
+          ihx_skip_space (ib);
+          if (ihx_getc (ib) != ':')
             {
               fprintf (stderr, "error: invalid IHX line.\n");
               return 0;
             }
           // parse real data part
           checksum = sum = 0;
-          nbytes = getbyte (fin, &sum);
+          nbytes = getbyte (ib, &sum);
           // lower 16 bits
-          addr = getbyte (fin, &sum) << 8 | getbyte (fin, &sum);
-          record_type = getbyte (fin, &sum);
+          addr = getbyte (ib, &sum) << 8;
+          addr |= getbyte (ib, &sum);
+          record_type = getbyte (ib, &sum);
         }
       // add linear address extension
       addr |= extaddr;
@@ -685,63 +1147,259 @@ read_ihx (FILE *fin, BYTE **rom, int *size, int *real_size, struct gb_opt_s *o)
               return 0;
             }
         }
+      if (ihx_check && record_type == 0)
+        ihx_check_data_record (addr, nbytes);
+
       while (nbytes--)
         {
           if (addr < *size)
-            (*rom)[addr++] = getbyte (fin, &sum);
+            rom_set (rom, addr++, getbyte (ib, &sum));
         }
 
       if (addr > *real_size)
         *real_size = addr;
 
-      checksum = getbyte (fin, &sum);
+      checksum = getbyte (ib, &sum);
       if (0 != (sum & 0xff))
         {
           fprintf (stderr, "error: bad checksum: %02x.\n", checksum);
           return 0;
         }
 
-      while (isspace (sum = getc (fin)))  /* skip all kind of spaces */
-        ;
-      ungetc (sum, fin);
+      ihx_skip_space (ib);
     }
   while (1 != record_type); /* EOF record */
 
   return 1;
 }
 
-void write_ines_header(FILE* fout, struct nes_opt_s* nes_opt)
+// The whole file is read in at once and decoded from memory
+int
+read_ihx (FILE *fin, struct rom_s *rom, int *size, int *real_size, struct gb_opt_s *o)
+{
+  struct ihx_buf_s ib;
+  int ret;
+
+  hex_table_init ();
+  if (!ihx_buf_load (fin, &ib))
+    return 0;
+
+  if (ihx_check)
+    ihx_check_init (ihx_check == IHX_CHECK_ERROR);
+
+  ret = read_ihx_records (&ib, rom, size, real_size, o);
+
+  if (ret && ihx_check)
+    ret = ihx_check_finish ();
+
+  free (ib.data);
+  return ret;
+}
+
+void make_ines_header(BYTE *header, struct nes_opt_s* nes_opt)
 {
-  char id_string[] = { 0x4E, 0x45, 0x53, 0x1A };  
-  BYTE flags6 = ((nes_opt->mapper & 0xF) << 4) | 
-                 (nes_opt->four_screen << 3) |
-                 (nes_opt->battery << 1) |
-                 nes_opt->vertical_mirroring;
-  BYTE flags7 = (nes_opt->mapper & 0xF0);
-  BYTE flags8 = 0;
-  BYTE flags9 = 0;
-  BYTE flags10 = 0;
-  BYTE padding[5] = { 0, 0, 0, 0, 0, };
   // "NES" + end-of-file
-  fwrite(&id_string, sizeof(char), 4, fout);
-  fwrite(&nes_opt->num_prg_banks, sizeof(BYTE), 1, fout);
-  fwrite(&nes_opt->num_chr_banks, sizeof(BYTE), 1, fout);
-  fwrite(&flags6, sizeof(BYTE), 1, fout);
-  fwrite(&flags7, sizeof(BYTE), 1, fout);
-  fwrite(&flags8, sizeof(BYTE), 1, fout);
-  fwrite(&flags9, sizeof(BYTE), 1, fout);
-  fwrite(&flags10, sizeof(BYTE), 1, fout);
-  fwrite(padding, sizeof(BYTE), 5, fout);
+  header[0] = 0x4E;
+  header[1] = 0x45;
+  header[2] = 0x53;
+  header[3] = 0x1A;
+  header[4] = nes_opt->num_prg_banks;
+  header[5] = nes_opt->num_chr_banks;
+  header[6] = ((nes_opt->mapper & 0xF) << 4) |
+               (nes_opt->four_screen << 3) |
+               (nes_opt->battery << 1) |
+               nes_opt->vertical_mirroring;
+  header[7] = (nes_opt->mapper & 0xF0);
+  // flags8 - flags10 and padding
+  memset (header + 8, 0, INES_HEADER_SIZE - 8);
+}
+
+// MMC1 (mapper 1) may power on with any 16K bank at $C000, so the reset
+// stub at $FFF0 and the vectors (mapper_mmc1.s, crt0.s) are copied from
+// the fixed bank to the same place in every other bank
+#define NES_MMC1_STUB_OFS  0x3FF0
+#define NES_MMC1_STUB_SIZE 16
+
+static int
+nes_postproc (struct rom_s *r, struct nes_opt_s *o)
+{
+  int bank, i;
+  BYTE value;
+
+  if (o->mapper != 1)
+    return 1;
+
+  for (bank = 1; bank < o->num_prg_banks; bank++)
+    for (i = NES_MMC1_STUB_OFS; i < NES_MMC1_STUB_OFS + NES_MMC1_STUB_SIZE; i++)
+      {
+        value = rom_get (r, i);
+        if ((rom_get (r, bank * BANK_SIZE + i) != FILL_BYTE) && (rom_get (r, bank * BANK_SIZE + i) != value))
+          {
+            fprintf (stderr, "error: MMC1: bank %d uses $BFF0-$BFFF, which every bank needs for the reset stub.\n", bank);
+            return 0;
+          }
+        rom_set (r, bank * BANK_SIZE + i, value);
+      }
+  return 1;
+}
+
+// Reads the -c files one after another into *chr, padded with zeros to whole
+// 8K banks. Returns the number of 8K banks, or -1 on an error
+static int
+read_chr_files (char **files, int nb_files, BYTE **chr)
+{
+  long size = 0, len;
+  int i, nb_banks;
+  FILE *f;
+
+  *chr = NULL;
+  for (i = 0; i < nb_files; i++)
+    {
+      BYTE *t_chr = *chr;
+
+      if (NULL == (f = fopen (files[i], "rb")))
+        {
+          fprintf (stderr, "error: can't open %s: ", files[i]);
+          perror(NULL);
+          return -1;
+        }
+      fseek (f, 0, SEEK_END);
+      len = ftell (f);
+      fseek (f, 0, SEEK_SET);
+      if (NULL == (*chr = realloc (*chr, size + len + 1)))
+        {
+          free (t_chr);
+          fclose (f);
+          fprintf (stderr, "error: couldn't allocate room for the CHR-ROM.\n");
+          return -1;
+        }
+      if (fread (*chr + size, 1, len, f) != (size_t) len)
+        {
+          fclose (f);
+          fprintf (stderr, "error: can't read %s\n", files[i]);
+          return -1;
+        }
+      fclose (f);
+      size += len;
+    }
+
+  nb_banks = (size + CHR_BANK_SIZE - 1) / CHR_BANK_SIZE;
+  if (nb_banks > CHR_MAX_BANKS)
+    {
+      fprintf (stderr, "error: CHR-ROM of %ld bytes is larger than %d banks of 8K\n", size, CHR_MAX_BANKS);
+      return -1;
+    }
+  if (NULL == (*chr = realloc (*chr, (nb_banks * CHR_BANK_SIZE) + 1)))
+    {
+      fprintf (stderr, "error: couldn't allocate room for the CHR-ROM.\n");
+      return -1;
+    }
+  memset (*chr + size, 0, (nb_banks * CHR_BANK_SIZE) - size);
+  return nb_banks;
+}
+
+// Applies the header flags of a -yv variant to o, returns 0 for an unknown flag
+static int
+gb_variant_apply (struct gb_opt_s *o, const char *flags)
+{
+  const char *p = flags;
+  char *end;
+
+  while (*p)
+    {
+      switch (*p++)
+        {
+        case 'c':
+          o->is_gbc = 1;
+          break;
+
+        case 'C':
+          o->is_gbc = 2;
+          break;
+
+        case 's':
+          o->is_sgb = 1;
+          break;
+
+        case 'd':
+          o->is_gbc = 0;
+          o->is_sgb = 0;
+          break;
+
+        case 'j':
+          o->non_jp = 1;
+          break;
+
+        case 't':
+          o->mbc_type = strtoul (p, &end, 0);
+          if (end == p)
+            return 0;
+          p = end;
+          break;
+
+        default:
+          return 0;
+        }
+      if (*p == '+')
+        p++;
+      else if (*p)
+        return 0;
+    }
+  return 1;
+}
+
+// Writes the header and the ROM ranges to name, '-' means stdout
+// Returns 0 if the file can't be created
+static int
+write_image (const char *name, const struct rom_s *r, const BYTE *header, int header_size,
+             int segments[][2], int nb_segments, const BYTE *chr, int chr_size)
+{
+  FILE *fout = stdout;
+  int i;
+
+  if (name && ('-' != name[0] || '\0' != name[1]))
+    {
+      if (NULL == (fout = fopen (name, "wb")))
+        {
+          fprintf (stderr, "error: can't create %s: ", name);
+          perror(NULL);
+          return 0;
+        }
+    }
+  // Written a bank at a time, untouched banks come from fill_bank
+  fwrite (header, 1, header_size, fout);
+  for (i = 0; i < nb_segments; i++)
+    rom_copy_out (r, segments[i][0], segments[i][1], fout, NULL);
+  fwrite (chr, 1, chr_size, fout);
+
+  fclose (fout);
+  return 1;
 }
 
 int
 main (int argc, char **argv)
 {
   int size = 32768, offset = 0, pack = 0, real_size = 0, i = 0;
+  int image_size, end, nb_segments;
+  int segments[2][2];
   char *token;
-  BYTE *rom;
-  FILE *fin, *fout;
+  struct rom_s rom;
+  BYTE *image;
+  BYTE header[INES_HEADER_SIZE];
+  int header_size = 0;
+  int patch_format = PATCH_NONE;
+  char *patch_old = NULL, *patch_file = NULL;
+  FILE *fin;
   char *filename = NULL;
+  struct gb_variant_s variants[MAX_GB_VARIANTS];
+  int nb_variants = 0;
+  struct gb_opt_s variant_opt;
+  BYTE *bank0 = NULL;
+  int variant_size;
+  char *chr_files[MAX_CHR_FILES];
+  int nb_chr_files = 0;
+  BYTE *chr = NULL;
+  int chr_size = 0;
   int ret;
   int gb = 0;
   int sms = 0;
@@ -756,6 +1414,7 @@ main (int argc, char **argv)
                             .is_gbc=0,
                             .is_sgb=0,
                             .sym_conversion=0,
+                            .sym_index=0,
                             .non_jp=0,
                             .rom_banks_autosize=0,
                             .do_logo_copy=true,
@@ -809,6 +1468,39 @@ main (int argc, char **argv)
           pack = 1;
           break;
 
+        case 'i':
+        case 'b':
+          /* -ips old patch, -bps old patch */
+          if (strcmp (*argv + 2, "ps") || !argv[1] || !argv[2])
+            {
+              usage ();
+              return 1;
+            }
+          patch_format = ('i' == argv[0][1]) ? PATCH_IPS : PATCH_BPS;
+          patch_old = *++argv;
+          patch_file = *++argv;
+          break;
+
+        case 'c':
+          /* -c chr_file, NES CHR-ROM */
+          if (!*++argv)
+            {
+              usage ();
+              return 1;
+            }
+          if (nb_chr_files == MAX_CHR_FILES)
+            {
+              fprintf (stderr, "error: more than %d -c CHR-ROM files\n", MAX_CHR_FILES);
+              return 1;
+            }
+          chr_files[nb_chr_files++] = *argv;
+          break;
+
+        case 'k':
+          /* ihxcheck tests, -ke treats warnings as errors */
+          ihx_check = ('e' == argv[0][2]) ? IHX_CHECK_ERROR : IHX_CHECK_WARN;
+          break;
+
         case 'Z':
           /* generate GameBoy binary file */
           gb = 1;
@@ -907,10 +1599,25 @@ main (int argc, char **argv)
               gb_opt.sym_conversion = 1;
               break;
 
+            case 'I':
+              gb_opt.sym_index = 1;
+              break;
+
             case 'j':
               gb_opt.non_jp = 1;
               break;
 
+            case 'm':
+              if (!*++argv)
+                {
+                  usage ();
+                  return 1;
+                }
+              nes_opt.mapper = strtoul (*argv, NULL, 0);
+              // Four screen (one screen on the cartridge) is specific to UNROM 512
+              nes_opt.four_screen = (nes_opt.mapper == 30);
+              break;
+
             // like -yp0x143=0x80
             case 'p':
               // remove "-yp"
@@ -938,6 +1645,24 @@ main (int argc, char **argv)
                 }
               break;
 
+            // like -yvgame.gbc=C+t0x1B
+            case 'v':
+              if (!*++argv || (NULL == (token = strrchr (*argv, '='))) || (token == *argv))
+                {
+                  usage ();
+                  return 1;
+                }
+              if (nb_variants == MAX_GB_VARIANTS)
+                {
+                  fprintf (stderr, "error: more than %d -yv variants\n", MAX_GB_VARIANTS);
+                  return 1;
+                }
+              *token = '\0';
+              variants[nb_variants].out_file = *argv;
+              variants[nb_variants].flags = token + 1;
+              nb_variants++;
+              break;
+
             default:
               usage ();
               return 1;
@@ -1020,7 +1745,6 @@ main (int argc, char **argv)
     }
 
   fin = stdin;
-  fout = stdout;
   if (*argv)
     {
       if ('-' != argv[0][0] || '\0' != argv[0][1])
@@ -1042,19 +1766,17 @@ main (int argc, char **argv)
       return 1;
     }
 
-  rom = malloc (size);
-  if (rom == NULL)
+  if (!rom_init (&rom, size))
     {
       fclose (fin);
       fprintf (stderr, "error: couldn't allocate room for the image.\n");
       return 1;
     }
-  memset (rom, FILL_BYTE, size);
 
   if (gb_opt.sym_conversion == 1)
     {
       if (filename)
-        noi2sym(filename);
+        noi2sym(filename, gb_opt.sym_index);
       else
         {
           fprintf (stderr, "error: .noi to .sym conversion needs an input file.\n");
@@ -1067,46 +1789,108 @@ main (int argc, char **argv)
 
   if (ret)
     {
+      if (nb_variants && !gb)
+        {
+          fprintf (stderr, "error: -yv variants need the GameBoy format (-Z).\n");
+          return 1;
+        }
+
+      // The header is all in bank 0, so the variants start from a copy of it
+      // taken before the header is written, and share the other banks
+      if (nb_variants)
+        {
+          if (NULL == (bank0 = malloc (BANK_SIZE)))
+            {
+              fprintf (stderr, "error: couldn't allocate room for the image.\n");
+              return 1;
+            }
+          memcpy (bank0, rom_bank (&rom, 0), BANK_SIZE);
+          variant_opt = gb_opt;
+        }
+
       if (gb)
-        gb_postproc (rom, size, &real_size, &gb_opt);
+        gb_postproc (&rom, &real_size, &gb_opt);
       else if (sms)
-        sms_postproc (rom, size, &real_size, &sms_opt);
-
-      if (*argv)
+        sms_postproc (&rom, &real_size, &sms_opt);
+
+      // The file contents as ranges of the ROM, starting after the offset.
+      // For NES the fixed bank is moved to the end.
+      end = pack ? real_size : size;
+      segments[0][0] = offset;
+      segments[0][1] = end;
+      nb_segments = 1;
+      if (nb_chr_files && !nes)
+        {
+          fprintf (stderr, "error: -c CHR-ROM files need the NES format (-N).\n");
+          return 1;
+        }
+      if (nes)
         {
-          if ('-' != argv[0][0] || '\0' != argv[0][1])
+          if (nb_chr_files)
             {
-              if (NULL == (fout = fopen (*argv, "wb")))
-                {
-                  fprintf (stderr, "error: can't create %s: ", *argv);
-                  perror(NULL);
-                  return 1;
-                }
+              int nb_chr_banks = read_chr_files (chr_files, nb_chr_files, &chr);
+
+              if (nb_chr_banks < 0)
+                return 1;
+              nes_opt.num_chr_banks = nb_chr_banks;
+              chr_size = nb_chr_banks * CHR_BANK_SIZE;
             }
+          nes_opt.num_prg_banks = gb_opt.nb_rom_banks;
+          if (!nes_postproc (&rom, &nes_opt))
+            return 1;
+          make_ines_header (header, &nes_opt);
+          header_size = INES_HEADER_SIZE;
+          // .ihx file has fixed bank incorrectly placed as first - we fix this when writing out the .nes file.
+          // Write the N-1 switchable banks at .nes file start, skipping the first (fixed) bank
+          segments[0][0] = offset + BANK_SIZE;
+          // Write the fixed bank to end of .nes file
+          segments[1][0] = offset;
+          segments[1][1] = offset + BANK_SIZE;
+          nb_segments = 2;
         }
-      // skip offset
-      if (offset > 0)
+      image_size = header_size + chr_size;
+      for (i = 0; i < nb_segments; i++)
+        image_size += segments[i][1] - segments[i][0];
+
+      // Before the output is opened: the old image may be the output file from the last build
+      if (patch_format != PATCH_NONE)
         {
-          memmove (rom, rom + offset, size - offset);
-          memset (rom + size - offset, FILL_BYTE, offset);
+          image = malloc (image_size);
+          if (image == NULL)
+            {
+              fprintf (stderr, "error: couldn't allocate room for the image.\n");
+              return 1;
+            }
+          memcpy (image, header, header_size);
+          for (i = 0, end = header_size; i < nb_segments; i++)
+            end += rom_copy_out (&rom, segments[i][0], segments[i][1], NULL, image + end);
+          if (chr_size)
+            memcpy (image + end, chr, chr_size);
+          if (!patch_create (patch_format, patch_old, patch_file, image, image_size))
+            return 1;
+          free (image);
         }
 
-      if (nes)
-      {
-        nes_opt.num_prg_banks = gb_opt.nb_rom_banks;
-        write_ines_header(fout, &nes_opt);
-        // .ihx file has fixed bank incorrectly placed as first - we fix this when writing out the .nes file.
-        // Write the N-1 switchable banks at .nes file start, skipping the first (fixed) bank
-        fwrite (rom + BANK_SIZE, 1, (pack ? real_size : size) - offset - BANK_SIZE, fout);
-        // Write the fixed bank to end of .nes file
-        fwrite (rom, 1, BANK_SIZE, fout);
-      }
-      else
-      {
-        fwrite (rom, 1, (pack ? real_size : size) - offset, fout);
-      }
+      if (!write_image (*argv, &rom, header, header_size, segments, nb_segments, chr, chr_size))
+        return 1;
+
+      for (i = 0; i < nb_variants; i++)
+        {
+          struct gb_opt_s o = variant_opt;
 
-      fclose (fout);
+          if (!gb_variant_apply (&o, variants[i].flags))
+            {
+              fprintf (stderr, "error: invalid -yv flags \"%s\" for %s\n", variants[i].flags, variants[i].out_file);
+              return 1;
+            }
+          memcpy (rom_ptr (&rom, 0), bank0, BANK_SIZE);
+          variant_size = real_size;
+          gb_postproc (&rom, &variant_size, &o);
+          if (!write_image (variants[i].out_file, &rom, header, header_size, segments, nb_segments, NULL, 0))
+            return 1;
+        }
+      free (bank0);
+      free (chr);
 
       return 0;
     }
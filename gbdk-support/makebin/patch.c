@@ -0,0 +1,359 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// IPS and BPS patches from a previous ROM image to the one makebin is
+// writing (makebin -ips / -bps). The patch is made against the final file
+// contents, so it includes the header fixups and the NES file layout.
+//
+// Both encoders merge changes separated by a few unchanged bytes into one
+// hunk when that's smaller than starting a new one, and encode runs of the
+// same byte (such as cleared or padding areas) as fills.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "patch.h"
+
+#define IPS_ADDR_MAX    0xFFFFFFu
+#define IPS_ADDR_EOF    0x454F46u // "EOF", no record can start at this offset
+#define IPS_RECORD_MAX  0xFFFFu
+#define IPS_MERGE_GAP   5u  // Resending up to this many unchanged bytes is cheaper than a 5 byte record header
+#define IPS_RLE_MIN     13u // An 8 byte fill record plus a 5 byte header for the data after it
+
+#define BPS_SOURCE_READ_MIN 3u // Shorter unchanged runs go into the surrounding literal data
+#define BPS_FILL_MIN        4u // Shorter runs of the same byte go into the literal data
+
+#define BPS_SOURCE_READ 0u
+#define BPS_TARGET_READ 1u
+#define BPS_TARGET_COPY 3u
+
+typedef struct patch_buf {
+    uint8_t * data;
+    size_t    len;
+    size_t    alloc;
+} patch_buf;
+
+static const uint8_t * old_rom;
+static uint32_t        old_size;
+static const uint8_t * new_rom;
+static uint32_t        new_size;
+
+
+static void buf_add(patch_buf * p_buf, const void * data, size_t len) {
+
+    if (p_buf->len + len > p_buf->alloc) {
+        while (p_buf->len + len > p_buf->alloc)
+            p_buf->alloc = p_buf->alloc ? p_buf->alloc * 2 : 0x10000;
+        p_buf->data = realloc(p_buf->data, p_buf->alloc);
+        if (!p_buf->data) {
+            fprintf(stderr, "error: couldn't allocate room for the patch.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(p_buf->data + p_buf->len, data, len);
+    p_buf->len += len;
+}
+
+
+static void buf_add_byte(patch_buf * p_buf, uint8_t value) {
+    buf_add(p_buf, &value, 1);
+}
+
+
+// Bytes past the end of the old image count as changed
+static bool rom_differs(uint32_t addr) {
+    return (addr >= old_size) || (old_rom[addr] != new_rom[addr]);
+}
+
+
+// Length of the run of the same byte starting at addr, up to max
+static uint32_t rom_fill_len(uint32_t addr, uint32_t end, uint32_t max) {
+
+    uint32_t len = 1;
+
+    while ((addr + len < end) && (len < max) && (new_rom[addr + len] == new_rom[addr]))
+        len++;
+    return len;
+}
+
+
+// == IPS ==
+
+static void ips_add_be(patch_buf * p_buf, uint32_t value, int count) {
+    while (count--)
+        buf_add_byte(p_buf, (uint8_t)(value >> (count * 8)));
+}
+
+
+// Record with new data for [addr, addr + len)
+static void ips_record(patch_buf * p_buf, uint32_t addr, uint32_t len) {
+
+    // Start one byte early instead, it gets written with the same value
+    if (addr == IPS_ADDR_EOF) {
+        addr--;
+        len++;
+    }
+    while (len) {
+        uint32_t chunk = (len > IPS_RECORD_MAX) ? IPS_RECORD_MAX : len;
+        ips_add_be(p_buf, addr, 3);
+        ips_add_be(p_buf, chunk, 2);
+        buf_add(p_buf, new_rom + addr, chunk);
+        addr += chunk;
+        len  -= chunk;
+    }
+}
+
+
+// Fill record for [addr, addr + len), len is at most IPS_RECORD_MAX
+static void ips_fill(patch_buf * p_buf, uint32_t addr, uint32_t len) {
+
+    if (addr == IPS_ADDR_EOF) {
+        ips_record(p_buf, addr, 1);
+        addr++;
+        len--;
+    }
+    ips_add_be(p_buf, addr, 3);
+    ips_add_be(p_buf, 0, 2);
+    ips_add_be(p_buf, len, 2);
+    buf_add_byte(p_buf, new_rom[addr]);
+}
+
+
+// Write the changed range [start, end) as data and fill records
+static void ips_hunk(patch_buf * p_buf, uint32_t start, uint32_t end) {
+
+    uint32_t addr = start;
+    uint32_t data_start = start;
+
+    while (addr < end) {
+        uint32_t len = rom_fill_len(addr, end, IPS_RECORD_MAX);
+        if (len >= IPS_RLE_MIN) {
+            if (data_start < addr)
+                ips_record(p_buf, data_start, addr - data_start);
+            ips_fill(p_buf, addr, len);
+            data_start = addr + len;
+        }
+        addr += len;
+    }
+    if (data_start < end)
+        ips_record(p_buf, data_start, end - data_start);
+}
+
+
+static bool ips_create(patch_buf * p_buf) {
+
+    uint32_t addr = 0;
+
+    if (new_size > IPS_ADDR_MAX + 1u) {
+        fprintf(stderr, "error: IPS patches are limited to 16MB images, use -bps instead.\n");
+        return false;
+    }
+
+    buf_add(p_buf, "PATCH", 5);
+    while (addr < new_size) {
+        uint32_t start, end, gap = 0;
+
+        if (!rom_differs(addr)) {
+            addr++;
+            continue;
+        }
+
+        // Extend the hunk over short unchanged gaps
+        start = addr;
+        end = addr + 1;
+        for (addr = end; (addr < new_size) && (addr - start < IPS_RECORD_MAX); addr++) {
+            if (rom_differs(addr)) {
+                end = addr + 1;
+                gap = 0;
+            }
+            else if (++gap > IPS_MERGE_GAP)
+                break;
+        }
+        ips_hunk(p_buf, start, end);
+        addr = end;
+    }
+    buf_add(p_buf, "EOF", 3);
+
+    // Truncation extension: the patched file gets cut to the new size
+    if (new_size < old_size)
+        ips_add_be(p_buf, new_size, 3);
+
+    return true;
+}
+
+
+// == BPS ==
+
+static void bps_add_number(patch_buf * p_buf, uint64_t value) {
+
+    for (;;) {
+        uint8_t x = value & 0x7F;
+        value >>= 7;
+        if (value == 0) {
+            buf_add_byte(p_buf, 0x80 | x);
+            break;
+        }
+        buf_add_byte(p_buf, x);
+        value--;
+    }
+}
+
+
+static void bps_add_action(patch_buf * p_buf, uint32_t command, uint32_t len) {
+    bps_add_number(p_buf, (((uint64_t)len - 1) << 2) | command);
+}
+
+
+static void bps_add_le32(patch_buf * p_buf, uint32_t value) {
+    for (int c = 0; c < 4; c++)
+        buf_add_byte(p_buf, (uint8_t)(value >> (c * 8)));
+}
+
+
+static uint32_t crc32_calc(const uint8_t * data, size_t len) {
+
+    static uint32_t table[256];
+    uint32_t crc = 0xFFFFFFFFu;
+
+    if (!table[1])
+        for (uint32_t c = 0; c < 256; c++) {
+            uint32_t v = c;
+            for (int k = 0; k < 8; k++)
+                v = (v & 1) ? (0xEDB88320u ^ (v >> 1)) : (v >> 1);
+            table[c] = v;
+        }
+
+    while (len--)
+        crc = table[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+
+// Length of the unchanged run starting at addr
+static uint32_t bps_same_len(uint32_t addr) {
+
+    uint32_t len = 0;
+
+    while ((addr + len < new_size) && !rom_differs(addr + len))
+        len++;
+    return len;
+}
+
+
+// Write the changed range [start, end) as literal data, runs of the
+// same byte become a TargetCopy of the byte before them
+static void bps_hunk(patch_buf * p_buf, uint32_t start, uint32_t end, uint32_t * p_target_rel) {
+
+    uint32_t addr = start;
+    uint32_t data_start = start;
+
+    while (addr < end) {
+        uint32_t len = rom_fill_len(addr, end, end - addr);
+        if (len >= BPS_FILL_MIN) {
+            // The first byte of the run goes out as data, the copy repeats it
+            bps_add_action(p_buf, BPS_TARGET_READ, addr + 1 - data_start);
+            buf_add(p_buf, new_rom + data_start, addr + 1 - data_start);
+
+            int64_t delta = (int64_t)addr - (int64_t)*p_target_rel;
+            bps_add_action(p_buf, BPS_TARGET_COPY, len - 1);
+            bps_add_number(p_buf, ((uint64_t)(delta < 0 ? -delta : delta) << 1) | (delta < 0));
+            *p_target_rel = addr + len - 1;
+            data_start = addr + len;
+        }
+        addr += len;
+    }
+    if (data_start < end) {
+        bps_add_action(p_buf, BPS_TARGET_READ, end - data_start);
+        buf_add(p_buf, new_rom + data_start, end - data_start);
+    }
+}
+
+
+static bool bps_create(patch_buf * p_buf) {
+
+    uint32_t addr = 0;
+    uint32_t target_rel = 0;
+
+    buf_add(p_buf, "BPS1", 4);
+    bps_add_number(p_buf, old_size);
+    bps_add_number(p_buf, new_size);
+    bps_add_number(p_buf, 0); // No metadata
+
+    while (addr < new_size) {
+        uint32_t len = bps_same_len(addr);
+        uint32_t end;
+
+        if ((len >= BPS_SOURCE_READ_MIN) || ((len > 0) && (addr + len == new_size))) {
+            bps_add_action(p_buf, BPS_SOURCE_READ, len);
+            addr += len;
+            continue;
+        }
+
+        // Changed data up to the next unchanged run worth a SourceRead
+        for (end = addr; end < new_size; ) {
+            len = bps_same_len(end);
+            if ((len >= BPS_SOURCE_READ_MIN) || ((len > 0) && (end + len == new_size)))
+                break;
+            end += len ? len : 1;
+        }
+        bps_hunk(p_buf, addr, end, &target_rel);
+        addr = end;
+    }
+
+    bps_add_le32(p_buf, crc32_calc(old_rom, old_size));
+    bps_add_le32(p_buf, crc32_calc(new_rom, new_size));
+    bps_add_le32(p_buf, crc32_calc(p_buf->data, p_buf->len));
+    return true;
+}
+
+
+// Write a patch from the image in old_filename to rom[0 .. size - 1]
+// Returns false on errors
+bool patch_create(int format, const char * old_filename, const char * patch_filename, const uint8_t * rom, uint32_t size) {
+
+    patch_buf buf = {NULL, 0, 0};
+    uint8_t * old_data;
+    long      old_len;
+    bool      ok;
+    FILE *    f;
+
+    if (NULL == (f = fopen(old_filename, "rb"))) {
+        fprintf(stderr, "error: can't open %s: ", old_filename);
+        perror(NULL);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    old_len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    old_data = malloc(old_len ? old_len : 1);
+    if ((old_len < 0) || (!old_data) || (fread(old_data, 1, old_len, f) != (size_t)old_len)) {
+        fprintf(stderr, "error: can't read %s\n", old_filename);
+        fclose(f);
+        free(old_data);
+        return false;
+    }
+    fclose(f);
+
+    old_rom  = old_data;
+    old_size = (uint32_t)old_len;
+    new_rom  = rom;
+    new_size = size;
+
+    ok = (format == PATCH_IPS) ? ips_create(&buf) : bps_create(&buf);
+    free(old_data);
+
+    if (ok) {
+        if ((NULL == (f = fopen(patch_filename, "wb"))) ||
+            (fwrite(buf.data, 1, buf.len, f) != buf.len)) {
+            fprintf(stderr, "error: can't write %s\n", patch_filename);
+            ok = false;
+        }
+        if (f)
+            fclose(f);
+    }
+    free(buf.data);
+    return ok;
+}
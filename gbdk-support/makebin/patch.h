@@ -0,0 +1,13 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+#ifndef _PATCH_H
+#define _PATCH_H
+
+#define PATCH_NONE 0
+#define PATCH_IPS  1
+#define PATCH_BPS  2
+
+bool patch_create(int format, const char * old_filename, const char * patch_filename, const uint8_t * rom, uint32_t size);
+
+#endif // _PATCH_H
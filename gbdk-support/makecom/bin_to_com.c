@@ -16,9 +16,15 @@
 #include "bin_to_com.h"
 
 
-uint8_t * banks[BANKS_MAX_COUNT] = {NULL};
-uint16_t  banks_len[BANKS_MAX_COUNT] = {0};
-uint16_t  banks_count = 0;
+// Banks which are one range of the source ROM get written straight from
+// it (banks_src). A bank only gets a buffer of its own (banks) when it is
+// put together from several areas or patched, such as bank 0.
+uint8_t       * banks[BANKS_MAX_COUNT] = {NULL};
+const uint8_t * banks_src[BANKS_MAX_COUNT] = {NULL};
+uint16_t        banks_len[BANKS_MAX_COUNT] = {0};
+uint16_t        banks_count = 0;
+
+bool overlay_archive = false;
 
 
 void banks_cleanup(void) {
@@ -28,12 +34,19 @@ void banks_cleanup(void) {
             free(banks[c]);
             banks[c] = NULL;
         }
+        banks_src[c] = NULL;
     }
 }
 
 
+// Bank data, from its buffer or the source ROM. NULL if the bank is unused
+static const uint8_t * bank_get_data(uint16_t bank_num) {
+    return (banks[bank_num] != NULL) ? banks[bank_num] : banks_src[bank_num];
+}
+
+
 // Allocate memory for banks as banks are requested
-// If preceding banks are not yet allocated then do those too
+// Data already in the bank from the source ROM gets copied into it
 uint8_t * bank_get_ptr(uint16_t bank_num) {
 
     if (bank_num > BANKS_MAX_ID) {
@@ -43,20 +56,19 @@ uint8_t * bank_get_ptr(uint16_t bank_num) {
 
     if (banks[bank_num] == NULL) {
 
-        // Make sure all banks leading up to requested are also allocated
-        for (int c = 0; c <= bank_num; c++) {
-            if (banks[c] == NULL) {
+        banks[bank_num] = malloc(BANK_SIZE);
 
-                banks[c] = malloc(BANK_SIZE);
+        if (!banks[bank_num]) {
+            printf("makecom: ERROR: Failed to allocate memory for bank %d!\n", bank_num);
+            exit(EXIT_FAILURE);
+        }
 
-                if (!banks[c]) {
-                    printf("makecom: ERROR: Failed to allocate memory for bank %d!\n", c);
-                    exit(EXIT_FAILURE);
-                }
+        // zero out buffer (though unused space will not get written out)
+        memset(banks[bank_num], 0x00u, BANK_SIZE);
 
-                // zero out buffer (though unused space will not get written out)
-                memset(banks[c], 0x00u, BANK_SIZE);
-            }
+        if (banks_src[bank_num] != NULL) {
+            memcpy(banks[bank_num], banks_src[bank_num], banks_len[bank_num]);
+            banks_src[bank_num] = NULL;
         }
     }
 
@@ -82,14 +94,49 @@ void copy_to_bank(uint16_t bank_num, uint32_t rom_src_addr, uint32_t bank_out_ad
     if (bank_num > banks_count)
         banks_count = bank_num;
 
+    // printf("* copying... bank:%d from:%x to:%x len:%d\n",
+    //         bank_num, rom_src_addr, bank_out_addr, length);
+
+    // A switchable bank from a single range of the ROM doesn't need a copy
+    if ((bank_num != BANK_0) && (bank_out_addr == BANK_START_ADDR) &&
+        (banks[bank_num] == NULL) && (banks_src[bank_num] == NULL))
+        banks_src[bank_num] = p_rom_buf_in + rom_src_addr;
+    else
+        memcpy(bank_get_ptr(bank_num) + bank_out_addr, p_rom_buf_in + rom_src_addr, length);
+
     // Update length of bank data buffers (to allow for truncating output later)
     if ((bank_out_addr + length) > banks_len[bank_num])
         banks_len[bank_num] = (bank_out_addr + length);
+}
 
-    // printf("* copying... bank:%d from:%x to:%x len:%d\n",
-    //         bank_num, rom_src_addr, bank_out_addr, length);
 
-    memcpy(bank_get_ptr(bank_num) + bank_out_addr, p_rom_buf_in + rom_src_addr, length);
+// Write banks 1 and up into a single overlay archive file, so the
+// loader only has to open one file. Each bank is padded to the full
+// bank size except the last, the loader reads them back to back.
+static void banks_write_archive(void) {
+
+    static const uint8_t padding[BANK_SIZE] = {0};
+    char archive_fname[MAX_STR_LEN] = "";
+
+    snprintf(archive_fname, sizeof(archive_fname), "%s.%s", filename_banks_base, COM_OVERLAY_ARCHIVE_EXT);
+    FILE * file_out = fopen(archive_fname, "wb");
+    if (!file_out) {
+        printf("makecom: ERROR: Failed to open output file %s!\n", archive_fname);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int c = 1; c <= banks_count; c++) {
+        const uint8_t * p_data = bank_get_data(c);
+        uint16_t len = (p_data != NULL) ? banks_len[c] : 0;
+        uint16_t pad_len = (c < banks_count) ? (BANK_SIZE - len) : 0;
+
+        if (((len > 0) && (fwrite(p_data, 1, len, file_out) != len)) ||
+            ((pad_len > 0) && (fwrite(padding, 1, pad_len, file_out) != pad_len))) {
+            printf("makecom: Warning: File write size didn't match expected for %s\n", archive_fname);
+            break;
+        }
+    }
+    fclose(file_out);
 }
 
 
@@ -106,16 +153,20 @@ void banks_write_out(void) {
         exit;
     }
 
-    // Write out remaining banks if applicable
+    if (overlay_archive) {
+        if (banks_count > 0)
+            banks_write_archive();
+        return;
+    }
+
+    // Write out remaining banks if applicable, unused ones in between as empty files
     char bank_fname[MAX_STR_LEN] = "";
-    for (int c = 1; c <= BANKS_MAX_ID; c++) {
-        if ((banks[c] != NULL) && (banks_len[0] > 0)) {
-            // Format to 8.3 filename with bank num as zero padded extension
-            sprintf(bank_fname, "%s.%03d", filename_banks_base, c);
-            // printf("Bank %d: Writing %d bytes to %s\n",c, banks_len[c], bank_fname);
-            file_write_from_buffer(bank_fname, banks[c], banks_len[c]);
-        } else
-            break; // Exit loop on first unpopulated bank
+    for (int c = 1; c <= banks_count; c++) {
+        const uint8_t * p_data = bank_get_data(c);
+        // Format to 8.3 filename with bank num as zero padded extension
+        sprintf(bank_fname, "%s.%03d", filename_banks_base, c);
+        // printf("Bank %d: Writing %d bytes to %s\n",c, banks_len[c], bank_fname);
+        file_write_from_buffer(bank_fname, (uint8_t *)p_data, (p_data != NULL) ? banks_len[c] : 0);
     }
 
 }
@@ -147,11 +198,27 @@ int bin2com(void) {
     // Patch in updated bank / overlay count and bank filename
     if ((banks_count > 0) && (overlay_count_addr != SYM_VAL_UNSET) && (overlay_name_addr != SYM_VAL_UNSET)) {
 
+        uint8_t * p_bank_0 = bank_get_ptr(BANK_0);
+
         if (overlay_count_addr > BANK_0_ADDR_OFFSET)
-            *(banks[0] + (overlay_count_addr - BANK_0_ADDR_OFFSET)) = banks_count;
+            *(p_bank_0 + (overlay_count_addr - BANK_0_ADDR_OFFSET)) = banks_count;
 
-        if (overlay_name_addr > BANK_0_ADDR_OFFSET)
-            memcpy(banks[0] + (overlay_name_addr - BANK_0_ADDR_OFFSET), filename_overlay, COM_OVERLAY_NAME_LEN-1);
+        if (overlay_name_addr > BANK_0_ADDR_OFFSET) {
+            memcpy(p_bank_0 + (overlay_name_addr - BANK_0_ADDR_OFFSET), filename_overlay, COM_OVERLAY_NAME_LEN-1);
+
+            // The archive extension directly follows the name in the loader's FCB
+            if (overlay_archive)
+                memcpy(p_bank_0 + (overlay_name_addr - BANK_0_ADDR_OFFSET) + (COM_OVERLAY_NAME_LEN-1),
+                       COM_OVERLAY_ARCHIVE_EXT, sizeof(COM_OVERLAY_ARCHIVE_EXT) - 1);
+        }
+
+        if (overlay_archive) {
+            if ((overlay_archive_addr == SYM_VAL_UNSET) || (overlay_archive_addr <= BANK_0_ADDR_OFFSET)) {
+                printf("makecom: ERROR: The program has no overlay archive support (___overlay_archive), can't use -a\n");
+                exit(EXIT_FAILURE);
+            }
+            *(p_bank_0 + (overlay_archive_addr - BANK_0_ADDR_OFFSET)) = 1;
+        }
     }
 
     // No write the data out
@@ -2,6 +2,7 @@
 #define _COMMON_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define ARRAY_LEN(A)  (sizeof(A) / sizeof(A[0]))
 
@@ -11,6 +12,7 @@
 
 #define BANK_FNAME_LEN  (8+1+3 +1) // 8.3 filename style + terminator, ex: MYCOMFIL.001 (from "mycomfile.com")
 #define COM_OVERLAY_NAME_LEN (8 + 1) // 8 chars for overlay string + terminator "MYCOMFIL"
+#define COM_OVERLAY_ARCHIVE_EXT "OVL" // Single file with all banks, ex: MYCOMFIL.OVL
 
 
 extern char filename_in_bin[];
@@ -19,6 +21,8 @@ extern char filename_out_com[];
 extern char filename_banks_base[];
 extern char filename_overlay[];
 
+extern bool overlay_archive;
+
 extern uint8_t * p_rom_buf_in;
 extern size_t    rom_buf_in_len;
 
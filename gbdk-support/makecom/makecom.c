@@ -71,14 +71,32 @@ static void filenames_out_prepare(void) {
 static void display_help(void) {
 
     fprintf(stdout,
-       "makecom image.rom image.noi output.com\n"
+       "makecom [options] image.rom [image.noi] output.com\n"
        "Use: convert a binary .rom file to .msxdos com format.\n"
+       "\n"
+       "Options\n"
+       "-h : Show this help screen\n"
+       "-a : Write all banks into one overlay archive (NAME.OVL) instead of one NAME.NNN file per bank\n"
        );
 }
 
 
 int handle_args(int argc, char * argv[]) {
 
+    // Options come before the file names
+    while ((argc > 1) && (argv[1][0] == '-') && (argv[1][1] != '\0')) {
+        if (strcmp(argv[1], "-a") == 0) {
+            overlay_archive = true;
+        } else {
+            if (strcmp(argv[1], "-h") != 0)
+                printf("makecom: ERROR: Unknown option %s\n", argv[1]);
+            display_help();
+            return false;
+        }
+        argc--;
+        argv++;
+    }
+
     if (argc == 3) {
         // Copy input and output filenames from arguments
         snprintf(filename_in_bin,  sizeof(filename_in_bin),  "%s", argv[1]);
@@ -10,6 +10,7 @@
 #include <stdint.h>
 
 #include "common.h"
+#include "symtab.h"
 #include "noi_file.h"
 #include "bin_to_com.h"
 
@@ -26,14 +27,17 @@ const char * known_section_names[] =
 
 
 list_type symbol_list;
+symtab_type symbol_tab; // symbol name -> index in symbol_list
 uint32_t overlay_count_addr = SYM_VAL_UNSET;
 uint32_t overlay_name_addr = SYM_VAL_UNSET;
+uint32_t overlay_archive_addr = SYM_VAL_UNSET;
 
 
 // Initialize the symbol list
 void noi_init(void) {
 
     list_init(&symbol_list, sizeof(symbol_item));
+    symtab_init(&symbol_tab);
 }
 
 
@@ -41,26 +45,23 @@ void noi_init(void) {
 void noi_cleanup(void) {
 
     list_cleanup(&symbol_list);
+    symtab_cleanup(&symbol_tab);
 }
 
 
 // Find a matching symbol, if none matches a new one is added and returned
 static int symbollist_get_id_by_name(char * symbol_name) {
 
-    symbol_item * symbols = (symbol_item *)symbol_list.p_array;
-
-    // Check for matching symbol name
-    for(int c = 0;c < symbol_list.count; c++) {
-        // Return matching symbol index if present
-        if (strcmp(symbol_name, symbols[c].name) == 0) {
-            return c;
-        }
-    }
+    // Return matching symbol index if present
+    uint32_t symbol_id = symtab_find(&symbol_tab, symbol_name, 0);
+    if (symbol_id != SYMTAB_NOT_FOUND)
+        return symbol_id;
 
     // no match was found, add symbol
     symbol_item new_symbol = {.name = "", .addr_start = SYM_VAL_UNSET, .length = SYM_VAL_UNSET, .bank_num = 0x00, .src_rom_addr = SYM_VAL_UNSET};
     snprintf(new_symbol.name, sizeof(new_symbol.name), "%s", symbol_name);
     list_additem(&symbol_list, &new_symbol);
+    symtab_add(&symbol_tab, new_symbol.name, 0, symbol_list.count - 1);
 
     return (symbol_list.count - 1);
 }
@@ -150,6 +151,9 @@ int noi_file_load_symbols(char * filename_in) {
                     else if (strcmp(p_words[1], "___overlay_name") == 0) {
                         overlay_name_addr = strtol(p_words[2], NULL, 16);
                     }
+                    else if (strcmp(p_words[1], "___overlay_archive") == 0) {
+                        overlay_archive_addr = strtol(p_words[2], NULL, 16);
+                    }
                 }
             } // end: valid min chars to process line
 
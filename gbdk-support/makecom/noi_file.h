@@ -31,6 +31,7 @@ typedef struct symbol_item {
 extern list_type symbol_list;
 extern uint32_t overlay_count_addr;
 extern uint32_t overlay_name_addr;
+extern uint32_t overlay_archive_addr;
 
 
 int noi_file_load_symbols(char * filename_in);
@@ -0,0 +1,513 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Converts MML (music macro language) text to channel streams for gbdk/music.h
+//
+// Each line starts with the channels it is for (A - D), followed by
+// MML commands. The lines of a channel are joined in order. Lengths are
+// converted to frames at 60 Hz, with the rounding carried over so that
+// the channels stay in time with each other.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
+
+#define MAX_STR_LEN          4096
+
+// Keep in sync with gbdk/music.h
+#define MUSIC_CHANNELS       4
+#define MUSIC_CH_NOISE       3
+#define MUSIC_NOTE_COUNT     72
+#define MUSIC_CMD_REST       0x80
+#define MUSIC_CMD_VOLUME     0x81
+#define MUSIC_CMD_DUTY       0x82
+#define MUSIC_CMD_LOOP       0x83
+#define MUSIC_CMD_WAIT       0x84
+#define MUSIC_CMD_END        0xFF
+
+#define FRAME_RATE           60.0
+#define OCTAVE_MIN           3
+#define OCTAVE_MAX           8
+#define REPEAT_DEPTH_MAX     8
+
+static char filename_in[MAX_STR_LEN]  = "";
+static char filename_out[MAX_STR_LEN] = "";
+static char var_name[MAX_STR_LEN]     = "";
+static int  bank = 255;  // 255 = autobank
+
+// MML text of each channel
+static char * text[MUSIC_CHANNELS];
+static size_t text_len[MUSIC_CHANNELS];
+
+typedef struct {
+    uint8_t * data;
+    size_t    len, size;
+    int       loop;      // Offset of the loop point, -1 if none
+    // Parser state
+    int       octave, length, dots;
+    double    tempo;
+    double    time;      // In frames, exact
+    uint32_t  frames;    // Whole frames written so far
+    bool      sound;     // A note or rest was written, so a tie can extend it
+} channel_t;
+
+static channel_t channels[MUSIC_CHANNELS];
+
+
+static void display_help(void) {
+
+    fprintf(stdout,
+       "mml2asset <file>.mml [options]\n"
+       "Use: convert MML text to music and sound effects for gbdk/music.h (GB/AP/Duck, SMS/GG, NES).\n"
+       "\n"
+       "Options\n"
+       "-h                  Show this help screen\n"
+       "-c <file>.c         Output file (default: <file>.c)\n"
+       "-var <name>         Variable name (default: <file>)\n"
+       "-b <bank>           Bank (default: 255, autobank), 0 for non-banked ROM\n"
+       "\n"
+       "MML\n"
+       "A-D <commands>      Commands for channels A to D (B: second square, C: wave, D: noise),\n"
+       "                    several letters send the line to several channels, ; starts a comment\n"
+       "c d e f g a b       Note, + or # after it for sharp, - for flat, then the length\n"
+       "                    (1 whole, 2 half, 4 quarter, ...) and dots, the default length without it\n"
+       "n<0-15>             Noise note on channel D: pitch 0 - 7 (0 highest), +8 for the short noise\n"
+       "r                   Rest, with a length like notes\n"
+       "^                   Tie: makes the note or rest before it longer, with a length like notes\n"
+       "o<3-8> < >          Octave, down one, up one\n"
+       "l<length>           Default length (default: 4)\n"
+       "t<bpm>              Tempo in quarter notes per minute (default: 120)\n"
+       "v<0-15>             Volume (default: 15)\n"
+       "@<0-3>              Square wave duty: 12.5%%, 25%%, 50%% (default), 75%%\n"
+       "[ ... ]<n>          Repeats the commands inside n times (default: 2)\n"
+       "L                   Loop point, the channel continues there when it reaches its end\n"
+       );
+}
+
+
+static void out_of_memory(void) {
+    printf("mml2asset: ERROR: out of memory\n");
+    exit(EXIT_FAILURE);
+}
+
+
+static void emit(channel_t * c, uint8_t value) {
+
+    if (c->len == c->size) {
+        c->size = (c->size) ? c->size * 2 : 256;
+        c->data = realloc(c->data, c->size);
+        if (!c->data)
+            out_of_memory();
+    }
+    c->data[c->len++] = value;
+}
+
+
+// Frames the length string at *p stands for, moves past it
+static double read_length(channel_t * c, const char ** p) {
+
+    int length = c->length, dots = c->dots;
+
+    if (isdigit((unsigned char)**p)) {
+        length = (int)strtol(*p, (char **)p, 10);
+        dots = 0;
+    }
+    while (**p == '.') {
+        dots++;
+        (*p)++;
+    }
+    if (length < 1)
+        length = 1;
+
+    double frames = (FRAME_RATE * 60.0 * 4.0) / (c->tempo * length);
+    double add = frames;
+    for (int d = 0; d < dots; d++) {
+        add /= 2.0;
+        frames += add;
+    }
+    return frames;
+}
+
+
+// Writes a note (or rest) lasting frames, split into waits above 255
+static void emit_sound(channel_t * c, int note, double frames, bool tie) {
+
+    c->time += frames;
+    uint32_t end = (uint32_t)llround(c->time);
+    uint32_t count = end - c->frames;
+    bool first = !tie;
+
+    c->frames = end;
+    while (count) {
+        uint8_t n = (count > 255) ? 255 : (uint8_t)count;
+        if (first) {
+            emit(c, (uint8_t)note);
+            first = false;
+        } else {
+            emit(c, MUSIC_CMD_WAIT);
+        }
+        emit(c, n);
+        count -= n;
+        c->sound = true;
+    }
+}
+
+
+static bool error(int ch, const char * msg, char cmd) {
+    printf("mml2asset: ERROR: %s: channel %c: %s '%c'\n", filename_in, 'A' + ch, msg, cmd);
+    return false;
+}
+
+
+// Parses the MML of a channel from p up to end, or up to the ']' closing a repeat
+static bool parse(int ch, const char ** pp, int depth) {
+
+    channel_t * c = &channels[ch];
+    const char * p = *pp;
+    static const int semitones[7] = {9, 11, 0, 2, 4, 5, 7}; // a - g
+
+    while (*p) {
+        char cmd = (char)tolower((unsigned char)*p);
+
+        if (isspace((unsigned char)*p) || (*p == '|')) {
+            p++;
+        } else if ((cmd >= 'a') && (cmd <= 'g')) {
+            int note = semitones[cmd - 'a'];
+            p++;
+            while ((*p == '+') || (*p == '#') || (*p == '-'))
+                note += (*p++ == '-') ? -1 : 1;
+            if (ch == MUSIC_CH_NOISE)
+                return error(ch, "the noise channel uses n<0-15> instead of", cmd);
+            note += (c->octave - OCTAVE_MIN) * 12;
+            if ((note < 0) || (note >= MUSIC_NOTE_COUNT))
+                return error(ch, "note out of range (o3 c to o8 b)", cmd);
+            emit_sound(c, note, read_length(c, &p), false);
+        } else if (cmd == 'n') {
+            p++;
+            int note = (int)strtol(p, (char **)&p, 10);
+            if (ch != MUSIC_CH_NOISE)
+                return error(ch, "only the noise channel can use", cmd);
+            if ((note < 0) || (note > 15))
+                return error(ch, "noise note must be 0 - 15 for", cmd);
+            if (*p == ',')
+                p++;
+            emit_sound(c, note, read_length(c, &p), false);
+        } else if (cmd == 'r') {
+            p++;
+            emit_sound(c, MUSIC_CMD_REST, read_length(c, &p), false);
+        } else if ((cmd == '^') || (cmd == '&')) {
+            p++;
+            if (!c->sound)
+                return error(ch, "nothing to tie to for", cmd);
+            emit_sound(c, 0, read_length(c, &p), true);
+        } else if (cmd == 'o') {
+            p++;
+            c->octave = (int)strtol(p, (char **)&p, 10);
+            if ((c->octave < OCTAVE_MIN) || (c->octave > OCTAVE_MAX))
+                return error(ch, "octave must be 3 - 8 for", cmd);
+        } else if ((cmd == '<') || (cmd == '>')) {
+            c->octave += (cmd == '>') ? 1 : -1;
+            p++;
+        } else if (*p == 'L') {
+            p++;
+            if (depth)
+                return error(ch, "loop point inside a repeat", cmd);
+            c->loop = (int)c->len;
+            c->sound = false;
+        } else if (cmd == 'l') {
+            p++;
+            c->length = (int)strtol(p, (char **)&p, 10);
+            c->dots = 0;
+            while (*p == '.') {
+                c->dots++;
+                p++;
+            }
+            if (c->length < 1)
+                return error(ch, "length must be 1 or more for", cmd);
+        } else if (cmd == 't') {
+            p++;
+            c->tempo = strtod(p, (char **)&p);
+            if (c->tempo <= 0.0)
+                return error(ch, "tempo must be above 0 for", cmd);
+        } else if (cmd == 'v') {
+            p++;
+            int volume = (int)strtol(p, (char **)&p, 10);
+            if ((volume < 0) || (volume > 15))
+                return error(ch, "volume must be 0 - 15 for", cmd);
+            emit(c, MUSIC_CMD_VOLUME);
+            emit(c, (uint8_t)volume);
+        } else if (cmd == '@') {
+            p++;
+            int duty = (int)strtol(p, (char **)&p, 10);
+            if ((duty < 0) || (duty > 3))
+                return error(ch, "duty must be 0 - 3 for", cmd);
+            emit(c, MUSIC_CMD_DUTY);
+            emit(c, (uint8_t)duty);
+        } else if (cmd == '[') {
+            const char * start = ++p;
+            if (depth >= REPEAT_DEPTH_MAX)
+                return error(ch, "repeats nested too deep at", cmd);
+            if (!parse(ch, &p, depth + 1))
+                return false;
+            int times = 2;
+            if (isdigit((unsigned char)*p))
+                times = (int)strtol(p, (char **)&p, 10);
+            for (int i = 1; i < times; i++) {
+                const char * again = start;
+                if (!parse(ch, &again, depth + 1))
+                    return false;
+            }
+        } else if (cmd == ']') {
+            if (!depth)
+                return error(ch, "no repeat to close with", cmd);
+            *pp = p + 1;
+            return true;
+        } else {
+            return error(ch, "unknown command", *p);
+        }
+    }
+    if (depth)
+        return error(ch, "repeat not closed with", ']');
+    *pp = p;
+    return true;
+}
+
+
+static void append_text(int ch, const char * s) {
+
+    size_t len = strlen(s);
+
+    text[ch] = realloc(text[ch], text_len[ch] + len + 2);
+    if (!text[ch])
+        out_of_memory();
+    memcpy(text[ch] + text_len[ch], s, len);
+    text_len[ch] += len;
+    text[ch][text_len[ch]++] = ' ';
+    text[ch][text_len[ch]] = '\0';
+}
+
+
+// Sorts the lines of the file into the channels
+static bool mml_load(void) {
+
+    char line[MAX_STR_LEN];
+    int  line_no = 0;
+    FILE * f;
+
+    if (NULL == (f = fopen(filename_in, "r"))) {
+        printf("mml2asset: ERROR: can't open %s\n", filename_in);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        char * p = line;
+        char * comment = strchr(line, ';');
+        bool targets[MUSIC_CHANNELS] = {false};
+        bool any = false;
+
+        line_no++;
+        if (comment)
+            *comment = '\0';
+        while (isspace((unsigned char)*p))
+            p++;
+        if (*p == '\0')
+            continue;
+        while ((*p >= 'A') && (*p <= 'A' + MUSIC_CHANNELS - 1)) {
+            targets[*p - 'A'] = true;
+            any = true;
+            p++;
+        }
+        if (!any || !isspace((unsigned char)*p)) {
+            printf("mml2asset: ERROR: %s:%d: a line must start with its channels (A - D) and a space\n", filename_in, line_no);
+            fclose(f);
+            return false;
+        }
+        for (int ch = 0; ch < MUSIC_CHANNELS; ch++)
+            if (targets[ch])
+                append_text(ch, p);
+    }
+    fclose(f);
+    return true;
+}
+
+
+static bool convert(void) {
+
+    bool used = false;
+
+    for (int ch = 0; ch < MUSIC_CHANNELS; ch++) {
+        channel_t * c = &channels[ch];
+        const char * p;
+
+        if (!text[ch])
+            continue;
+        used = true;
+        c->loop = -1;
+        c->octave = 4;
+        c->length = 4;
+        c->tempo = 120.0;
+        p = text[ch];
+        if (!parse(ch, &p, 0))
+            return false;
+        // A loop without a note or rest after the loop point would never wait
+        if ((c->loop >= 0) && c->sound) {
+            emit(c, MUSIC_CMD_LOOP);
+            emit(c, (uint8_t)(c->loop & 0xFF));
+            emit(c, (uint8_t)(c->loop >> 8));
+        } else {
+            emit(c, MUSIC_CMD_END);
+        }
+        if (c->len > 0x4000) {
+            printf("mml2asset: ERROR: channel %c is %u bytes, more than a bank\n", 'A' + ch, (unsigned int)c->len);
+            return false;
+        }
+    }
+    if (!used)
+        printf("mml2asset: ERROR: %s has no channel lines\n", filename_in);
+    return used;
+}
+
+
+static bool write_files(void) {
+
+    char base[MAX_STR_LEN];
+    char name[MAX_STR_LEN];
+    FILE * f;
+
+    // Output name without the extension
+    snprintf(base, sizeof(base), "%s", filename_out);
+    char * ext = strrchr(base, '.');
+    if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+        *ext = '\0';
+
+    snprintf(name, sizeof(name), "%s.c", base);
+    if (NULL == (f = fopen(name, "w"))) {
+        printf("mml2asset: ERROR: can't write %s\n", name);
+        return false;
+    }
+    if (bank)
+        fprintf(f, "#pragma bank %d\n\n", bank);
+    fprintf(f, "// %s, converted by mml2asset\n\n", var_name);
+    fprintf(f, "#include <gbdk/platform.h>\n#include <stdint.h>\n#include <gbdk/music.h>\n\n");
+    fprintf(f, "BANKREF(%s)\n", var_name);
+    for (int ch = 0; ch < MUSIC_CHANNELS; ch++) {
+        channel_t * c = &channels[ch];
+        if (!c->len)
+            continue;
+        fprintf(f, "\n// Channel %c: %u frames%s\n", 'A' + ch, (unsigned int)c->frames, (c->loop >= 0) ? ", loops" : "");
+        fprintf(f, "const uint8_t %s_ch%d[] = {\n", var_name, ch);
+        for (size_t i = 0; i < c->len; i++)
+            fprintf(f, "%s0x%02X%s", (i % 16) ? "" : "\t", c->data[i],
+                    (i + 1 == c->len) ? "\n" : ((i % 16) == 15) ? ",\n" : ",");
+        fprintf(f, "};\n");
+    }
+    fprintf(f, "\nconst music_song_t %s = {{\n", var_name);
+    for (int ch = 0; ch < MUSIC_CHANNELS; ch++) {
+        if (channels[ch].len)
+            fprintf(f, "\t%s_ch%d%s\n", var_name, ch, (ch + 1 < MUSIC_CHANNELS) ? "," : "");
+        else
+            fprintf(f, "\t0%s\n", (ch + 1 < MUSIC_CHANNELS) ? "," : "");
+    }
+    fprintf(f, "}};\n");
+    fclose(f);
+
+    snprintf(name, sizeof(name), "%s.h", base);
+    if (NULL == (f = fopen(name, "w"))) {
+        printf("mml2asset: ERROR: can't write %s\n", name);
+        return false;
+    }
+    fprintf(f, "#ifndef __%s_INCLUDE\n#define __%s_INCLUDE\n\n", var_name, var_name);
+    fprintf(f, "#include <gbdk/platform.h>\n#include <stdint.h>\n#include <gbdk/music.h>\n\n");
+    fprintf(f, "BANKREF_EXTERN(%s)\n\n", var_name);
+    for (int ch = 0; ch < MUSIC_CHANNELS; ch++)
+        if (channels[ch].len)
+            fprintf(f, "extern const uint8_t %s_ch%d[];\n", var_name, ch);
+    fprintf(f, "extern const music_song_t %s;\n\n", var_name);
+    fprintf(f, "#endif\n");
+    fclose(f);
+
+    return true;
+}
+
+
+static bool handle_args(int argc, char * argv[]) {
+
+    if (argc < 2) {
+        display_help();
+        return false;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            snprintf(filename_in, sizeof(filename_in), "%s", argv[i]);
+        } else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) {
+            snprintf(filename_out, sizeof(filename_out), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-var") == 0) && (i + 1 < argc)) {
+            snprintf(var_name, sizeof(var_name), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc)) {
+            bank = atoi(argv[++i]);
+        } else {
+            if (strcmp(argv[i], "-h") != 0)
+                printf("mml2asset: ERROR: Unknown option %s\n", argv[i]);
+            display_help();
+            return false;
+        }
+    }
+
+    if (filename_in[0] == '\0') {
+        display_help();
+        return false;
+    }
+    if ((bank < 0) || (bank > 255)) {
+        printf("mml2asset: ERROR: bank %d must be from 0 to 255\n", bank);
+        return false;
+    }
+
+    if (filename_out[0] == '\0') {
+        snprintf(filename_out, sizeof(filename_out), "%s", filename_in);
+        char * ext = strrchr(filename_out, '.');
+        if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+            *ext = '\0';
+        strncat(filename_out, ".c", sizeof(filename_out) - strlen(filename_out) - 1);
+    }
+
+    // Default variable name: output file name without path and extension
+    if (var_name[0] == '\0') {
+        const char * start = filename_out;
+        for (const char * p = filename_out; *p; p++)
+            if ((*p == '/') || (*p == '\\'))
+                start = p + 1;
+        snprintf(var_name, sizeof(var_name), "%s", start);
+        char * ext = strrchr(var_name, '.');
+        if (ext)
+            *ext = '\0';
+        for (char * p = var_name; *p; p++)
+            if (!isalnum((unsigned char)*p))
+                *p = '_';
+    }
+
+    return true;
+}
+
+
+int main(int argc, char * argv[]) {
+
+    int ret = EXIT_FAILURE;
+
+    if (handle_args(argc, argv) && mml_load() && convert() && write_files()) {
+        for (int ch = 0; ch < MUSIC_CHANNELS; ch++)
+            if (channels[ch].len)
+                printf("mml2asset: %s: channel %c: %u bytes, %u frames\n", var_name, 'A' + ch,
+                       (unsigned int)channels[ch].len, (unsigned int)channels[ch].frames);
+        ret = EXIT_SUCCESS;
+    }
+
+    for (int ch = 0; ch < MUSIC_CHANNELS; ch++) {
+        free(text[ch]);
+        free(channels[ch].data);
+    }
+    return ret;
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "lodepng.h"
 
 using namespace std;
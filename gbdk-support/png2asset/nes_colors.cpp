@@ -0,0 +1,232 @@
+// nes_colors.cpp
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nes_colors.h"
+
+// RGB of each NES PPU color, from nespal/palettes/palgen.pal
+static const unsigned char nes_palette_rgb[64][3] = {
+	{ 70, 70, 70}, {  0,  6, 90}, {  0,  6,120}, {  2,  6,115}, // 00-03
+	{ 53,  3, 76}, { 87,  0, 14}, { 90,  0,  0}, { 65,  0,  0}, // 04-07
+	{ 18,  2,  0}, {  0, 20,  0}, {  0, 30,  0}, {  0, 30,  0}, // 08-0B
+	{  0, 21, 33}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, // 0C-0F
+	{157,157,157}, {  0, 74,185}, {  5, 48,225}, { 87, 24,218}, // 10-13
+	{159,  7,167}, {204,  2, 85}, {207, 11,  0}, {164, 35,  0}, // 14-17
+	{ 92, 63,  0}, { 11, 88,  0}, {  0,102,  0}, {  0,103, 19}, // 18-1B
+	{  0, 94,110}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, // 1C-1F
+	{254,255,255}, { 31,158,255}, { 83,118,255}, {152,101,255}, // 20-23
+	{252,103,255}, {255,108,179}, {255,116,102}, {255,128, 20}, // 24-27
+	{196,154,  0}, {113,179,  0}, { 40,196, 33}, {  0,200,116}, // 28-2B
+	{  0,191,208}, { 43, 43, 43}, {  0,  0,  0}, {  0,  0,  0}, // 2C-2F
+	{254,255,255}, {158,213,255}, {175,192,255}, {208,184,255}, // 30-33
+	{254,191,255}, {255,192,224}, {255,195,189}, {255,202,156}, // 34-37
+	{231,213,139}, {197,223,142}, {166,230,163}, {148,232,197}, // 38-3B
+	{146,228,235}, {167,167,167}, {  0,  0,  0}, {  0,  0,  0}, // 3C-3F
+};
+
+// RGB of each NES PPU color in the palette most NES art is drawn with
+// (FCEUX, NES Screen Tool). Colors which are exactly one of these are
+// converted to it instead of being matched in OKLab against palgen.pal
+static const unsigned char nes_art_palette_rgb[64][3] = {
+	{124,124,124}, {  0,  0,252}, {  0,  0,188}, { 68, 40,188}, // 00-03
+	{148,  0,132}, {168,  0, 32}, {168, 16,  0}, {136, 20,  0}, // 04-07
+	{ 80, 48,  0}, {  0,120,  0}, {  0,104,  0}, {  0, 88,  0}, // 08-0B
+	{  0, 64, 88}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, // 0C-0F
+	{188,188,188}, {  0,120,248}, {  0, 88,248}, {104, 68,252}, // 10-13
+	{216,  0,204}, {228,  0, 88}, {248, 56,  0}, {228, 92, 16}, // 14-17
+	{172,124,  0}, {  0,184,  0}, {  0,168,  0}, {  0,168, 68}, // 18-1B
+	{  0,136,136}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, // 1C-1F
+	{248,248,248}, { 60,188,252}, {104,136,252}, {152,120,248}, // 20-23
+	{248,120,248}, {248, 88,152}, {248,120, 88}, {252,160, 68}, // 24-27
+	{248,184,  0}, {184,248, 24}, { 88,216, 84}, { 88,248,152}, // 28-2B
+	{  0,232,216}, {120,120,120}, {  0,  0,  0}, {  0,  0,  0}, // 2C-2F
+	{252,252,252}, {164,228,252}, {184,184,248}, {216,184,248}, // 30-33
+	{248,184,248}, {248,164,192}, {240,208,176}, {252,224,168}, // 34-37
+	{248,216,120}, {216,248,120}, {184,248,184}, {184,248,216}, // 38-3B
+	{  0,252,252}, {248,216,248}, {  0,  0,  0}, {  0,  0,  0}, // 3C-3F
+};
+
+// Same as the default --invalid_colors of nespal.py: 0D is blacker than
+// black, the others are duplicates of black
+static bool nes_color_is_valid(int c)
+{
+	return (c != 0x0D) && ((c & 0x0F) < 0x0E);
+}
+
+struct OKLab
+{
+	float L, a, b;
+};
+
+static float srgb_to_linear(float c)
+{
+	return (c <= 0.04045f) ? (c / 12.92f) : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+// https://bottosson.github.io/posts/oklab/
+static OKLab rgb_to_oklab(int r, int g, int b)
+{
+	float lr = srgb_to_linear(r / 255.0f);
+	float lg = srgb_to_linear(g / 255.0f);
+	float lb = srgb_to_linear(b / 255.0f);
+
+	float l = cbrtf(0.4122214708f * lr + 0.5363325363f * lg + 0.0514459929f * lb);
+	float m = cbrtf(0.2119034982f * lr + 0.6806995451f * lg + 0.1073969566f * lb);
+	float s = cbrtf(0.0883024619f * lr + 0.2817188376f * lg + 0.6299787005f * lb);
+
+	OKLab ret;
+	ret.L = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+	ret.a = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+	ret.b = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+	return ret;
+}
+
+static OKLab nes_palette_lab[64];
+
+static void nes_palette_lab_init(void)
+{
+	static bool init = false;
+
+	if(!init)
+	{
+		for(int c = 0; c < 64; ++c)
+			nes_palette_lab[c] = rgb_to_oklab(nes_palette_rgb[c][0], nes_palette_rgb[c][1], nes_palette_rgb[c][2]);
+		init = true;
+	}
+}
+
+// Squared OKLab distance of each NES PPU color to r, g, b
+static void nes_color_distances(unsigned char r, unsigned char g, unsigned char b, float* dist)
+{
+	nes_palette_lab_init();
+	OKLab lab = rgb_to_oklab(r, g, b);
+	for(int c = 0; c < 64; ++c)
+	{
+		float dL = lab.L - nes_palette_lab[c].L;
+		float da = lab.a - nes_palette_lab[c].a;
+		float db = lab.b - nes_palette_lab[c].b;
+		dist[c] = dL * dL + da * da + db * db;
+	}
+}
+
+// Returns the valid PPU color which is exactly r, g, b in nes_art_palette_rgb, -1 if none
+static int nes_art_color(unsigned char r, unsigned char g, unsigned char b)
+{
+	for(int c = 0; c < 64; ++c)
+	{
+		if(nes_color_is_valid(c) &&
+		   (nes_art_palette_rgb[c][0] == r) && (nes_art_palette_rgb[c][1] == g) && (nes_art_palette_rgb[c][2] == b))
+			return c;
+	}
+	return -1;
+}
+
+//
+// Returns the NES PPU color closest to r, g, b in OKLab.
+//
+// Colors are looked up by their RGB555 value, each entry of the table is
+// only searched for the first time it is needed.
+//
+#define NES_LUT_UNSET 0xFF
+
+unsigned char rgb_to_nes_color(unsigned char r, unsigned char g, unsigned char b)
+{
+	static unsigned char lut[32768];
+	static bool init = false;
+
+	int art = nes_art_color(r, g, b);
+	if(art >= 0)
+		return (unsigned char)art;
+
+	if(!init)
+	{
+		memset(lut, NES_LUT_UNSET, sizeof(lut));
+		init = true;
+	}
+
+	int r5 = r >> 3, g5 = g >> 3, b5 = b >> 3;
+	unsigned char& entry = lut[(b5 << 10) | (g5 << 5) | r5];
+	if(entry == NES_LUT_UNSET)
+	{
+		float dist[64];
+		nes_color_distances((r5 << 3) | (r5 >> 2), (g5 << 3) | (g5 >> 2), (b5 << 3) | (b5 >> 2), dist);
+		for(int c = 0; c < 64; ++c)
+		{
+			if(!nes_color_is_valid(c))
+				continue;
+			if((entry == NES_LUT_UNSET) || (dist[c] < dist[entry]))
+				entry = (unsigned char)c;
+		}
+	}
+	return entry;
+}
+
+//
+// Converts the count RGBA colors of a sub-palette to NES PPU colors.
+//
+// Each color is converted with rgb_to_nes_color(), but two different
+// colors never get the same PPU color: when the closest one is taken,
+// the closest unused one is used instead. Color 0 (the shared background
+// color) is converted first, then the others from the best match to the
+// worst, so the colors which are furthest from any PPU color move.
+//
+#define NES_RGBA_SZ 4 // RGBA 8:8:8:8
+
+void rgba_to_nes_palette(const unsigned char* rgba, int count, unsigned char* out)
+{
+	int order[NES_PALETTE_COLORS_MAX], same[NES_PALETTE_COLORS_MAX];
+	float cost[NES_PALETTE_COLORS_MAX];
+	bool used[64] = { false };
+	int n = 0;
+
+	for(int i = 0; i < count; ++i)
+	{
+		const unsigned char* c = rgba + (i * NES_RGBA_SZ);
+		same[i] = i;
+		for(int j = 0; j < i; ++j)
+		{
+			if(!memcmp(rgba + (j * NES_RGBA_SZ), c, 3))
+			{
+				same[i] = j;
+				break;
+			}
+		}
+		out[i] = rgb_to_nes_color(c[0], c[1], c[2]);
+		if(same[i] != i)
+			continue;
+		float dist[64];
+		nes_color_distances(c[0], c[1], c[2], dist);
+		cost[i] = (nes_art_color(c[0], c[1], c[2]) >= 0) ? 0.0f : dist[out[i]];
+		// Insert by cost, color 0 stays first
+		int k = n++;
+		for(; (k > 1) && (cost[order[k - 1]] > cost[i]); --k)
+			order[k] = order[k - 1];
+		order[k] = i;
+	}
+
+	for(int k = 0; k < n; ++k)
+	{
+		int i = order[k];
+		const unsigned char* c = rgba + (i * NES_RGBA_SZ);
+		if(used[out[i]])
+		{
+			float dist[64];
+			int taken = out[i], best = -1;
+			nes_color_distances(c[0], c[1], c[2], dist);
+			for(int p = 0; p < 64; ++p)
+			{
+				if(nes_color_is_valid(p) && !used[p] && ((best < 0) || (dist[p] < dist[best])))
+					best = p;
+			}
+			out[i] = (unsigned char)best;
+			printf("Warning: colors #%02X%02X%02X and another one of a palette are both closest to NES color 0x%02X, using 0x%02X\n",
+			       c[0], c[1], c[2], taken, best);
+		}
+		used[out[i]] = true;
+	}
+
+	for(int i = 0; i < count; ++i)
+		out[i] = out[same[i]];
+}
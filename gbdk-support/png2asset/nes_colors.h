@@ -0,0 +1,12 @@
+// nes_colors.h
+
+#ifndef _NES_COLORS_H
+#define _NES_COLORS_H
+
+// Most colors of a NES sub-palette
+#define NES_PALETTE_COLORS_MAX 4
+
+unsigned char rgb_to_nes_color(unsigned char r, unsigned char g, unsigned char b);
+void rgba_to_nes_palette(const unsigned char* rgba, int count, unsigned char* out);
+
+#endif
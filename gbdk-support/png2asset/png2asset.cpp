@@ -3,9 +3,14 @@
 #include <algorithm>
 #include <cstring>
 #include <set>
+#include <unordered_map>
 #include <stdio.h>
 #include <fstream>
 #include <cstdint>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <tuple>
 
 #include "lodepng.h"
 
@@ -13,13 +18,23 @@ using namespace std;
 
 #include "png2asset.h"
 #include "image_utils.h"
+#include "nes_colors.h"
 
 int decodePNG(vector<unsigned char>& out_image, unsigned long& image_width, unsigned long& image_height, const unsigned char* in_png, size_t in_size, bool convert_to_rgba32 = true);
 void loadFile(vector<unsigned char>& buffer, const std::string& filename);
 
 bool export_map_binary();
+bool export_map_packed();
 bool export_h_file(void);
 bool export_c_file(void);
+bool export_asm_file(void);
+bool export_sgb_border(void);
+bool export_vwf_font(void);
+bool export_chr_file(void);
+static size_t chr_rom_banks(void);
+static bool LoadCollisionMap(void);
+static bool LoadSpawnMap(void);
+static bool LoadAnimSeqs(void);
 
 // TODO: Moved these vars to global scope (from giant main()) as start of breaking main into functions
 //       They should get encapsulated
@@ -27,6 +42,10 @@ bool export_c_file(void);
 	string output_filename_bin;
 	string output_filename_attributes_bin;
 	string output_filename_tiles_bin;
+	string output_filename_tiles_bank1_bin;
+	string output_filename_asm;
+	string output_filename_chr;
+	string output_filename_packed_bin;
 	string data_name;
 	//default values for some params
 	int  sprite_w = 0;
@@ -40,8 +59,11 @@ bool export_c_file(void);
 	bool keep_palette_order = false;
 	bool repair_indexed_pal = false;
 	bool output_binary = false;
+	bool output_incbin = false;
+	bool output_asm = false;
 	bool output_transposed = false;
 	size_t max_palettes = 8;
+	bool pack_palettes = false;
 
 	bool export_as_map = false;
 	bool use_map_attributes = false;
@@ -57,7 +79,6 @@ bool export_c_file(void);
 	int bpp = 2;
 	unsigned int tile_origin = 0; // Default to no tile index offset
 
-extern unsigned char rgb_to_nes[64];
 
 
 struct MTTile
@@ -66,9 +87,10 @@ struct MTTile
 	char offset_y;
 	unsigned char offset_idx;
 	unsigned char props;
+	size_t tile; // Index in the tileset, offset_idx is scaled to hardware sprites and truncated
 
-	MTTile(char offset_x, char offset_y, unsigned char offset_idx, unsigned char props) : offset_x(offset_x), offset_y(offset_y), offset_idx(offset_idx), props(props) {}
-	MTTile() : offset_x(0), offset_y(0), offset_idx(0), props(0) {}
+	MTTile(char offset_x, char offset_y, unsigned char offset_idx, unsigned char props, size_t tile) : offset_x(offset_x), offset_y(offset_y), offset_idx(offset_idx), props(props), tile(tile) {}
+	MTTile() : offset_x(0), offset_y(0), offset_idx(0), props(0), tile(0) {}
 };
 string source_tileset;
 unsigned int extra_tile_count = 0;
@@ -83,52 +105,148 @@ bool include_palettes = true;
 
 typedef vector< MTTile > MetaSprite;
 vector< Tile > tiles;
+// Index of the first occurrence of each unique tile in "tiles", used by FindTile()
+// to avoid a linear search of the whole tileset for every tile
+unordered_map< Tile, size_t, TileHash > tiles_index;
 vector<	MetaSprite > sprites;
 vector< unsigned char > map;
+vector< size_t > map_tile_ids; // Tileset index of each map cell, without the tile origin or attributes
 vector< unsigned char > map_attributes;
 PNGImage image;
 int props_default = 0x00;  // Default Sprite props has no attributes enabled
 bool use_structs = false;
 bool flip_tiles = true;
+bool export_metasprite_flips = false;
+bool export_oam_frames = false;
+bool export_metasprite_bounds = false;
+bool export_anim_diffs = false;
+bool sprite_trim = false; // -sprite_trim: place each frame's tiles on the grid offset using the fewest sprites
+bool sprite_pairs = false; // -sprite_pairs: choose where each 8 pixel column of a frame is split into 8x16 sprites
+bool report_sprite_lines = false; // -sprite_lines: print the most sprites on one line of each frame
+int max_sprites_per_line = 0;     // -max_sprites_per_line: fail if a frame has more sprites on one line, 0 = no check
+
+// A run of consecutive VRAM tile slots and the tiles loaded into them
+struct AnimRun
+{
+	size_t first_slot;
+	vector< size_t > tiles;
+};
+typedef vector< AnimRun > AnimDiff;
+AnimDiff anim_init;            // Loads all slots of the first frame
+vector< AnimDiff > anim_diffs; // Changes from the previous frame (the last one for the first frame)
+size_t anim_slots = 0;
+vector< string > batch_files; // -batch: more images which share the tileset and palettes of the first one
+bool output_filename_set = false;
+int metatile_size = 0; // Width and height of metatiles in tiles, 0 = no metatiles
+vector< unsigned char > metatiles;
+vector< unsigned char > metatile_attributes;
+vector< unsigned char > metatile_map;
+size_t metatile_map_width = 0;
+size_t metatile_map_height = 0;
 Tile::PackMode pack_mode = Tile::GB;
+int tile_usage_w = 0; // -tile_usage: region size in tiles, 0 = no tile usage lists
+int tile_usage_h = 0;
+int map_chunk_w = 0; // -map_chunks: chunk size in tiles, 0 = map in rows
+int map_chunk_h = 0;
+bool export_sgb_border_data = false; // -sgb_border: CHR_TRN blocks and PCT_TRN data instead of _tiles / _map / _palettes
+bool export_nes_attribute_tables = false; // -nes_attribute_tables: also export the attributes as 64 byte tables per screen
+bool export_chr_rom = false; // -chr_rom: write the tiles as NES CHR-ROM pattern tables (.chr) instead of _tiles
+string collision_map_file; // -collision_map: indexed png with a flag value for each map tile
+int collision_bits = 0; // Bits per tile of the packed _collision map, 0 = none
+vector< uint8_t > collision_values; // Flag value of each map tile, row by row
+string spawn_map_file; // -spawn_map: indexed png with an object type (1 - 255) for each map tile, 0 for none
+struct SpawnEntry { size_t x, y; uint8_t type; };
+vector< SpawnEntry > spawn_entries; // Objects of the spawn map, sorted by X then Y
+vector< uint16_t > spawn_buckets; // First object of each SPAWN_BUCKET_TILES columns, then the number of objects
+#define SPAWN_BUCKET_TILES 16 // SPAWN_BUCKET_TILES of gbdk/spawn.h
+string anim_seq_file; // -anim_seq: text file of animation sequences for anim_play()
+struct AnimSeqFrame { unsigned int frame, ticks, event; };
+struct AnimSeq { string name; bool loop; vector< AnimSeqFrame > frames; };
+vector< AnimSeq > anim_seqs;
+#define ANIM_SEQ_FRAMES_MAX 85 // anim_tick_all() indexes the frames with 3 * index in 8 bits
+bool use_shared_background = false;  // -use_nes_attributes: color 0 of every palette is the one background color
+unsigned int shared_background_color = 0;
+bool expand_4bpp = false;            // -expand_4bpp: 2bpp tiles exported as SMS/GG 4bpp tiles
+unsigned char expand_4bpp_colors[4]; // 4bpp color for each 2bpp color
+size_t expanded_tile_count = 0;      // Tiles already expanded, the batch mode tileset grows between exports
+bool export_vwf_font_data = false;   // -vwf_font: 1bpp glyphs and their widths for gb/vwf.h instead of _tiles / _map / _palettes
+int vwf_first_char = 32;             // Character of the first glyph
+bool write_dep_file = false;         // -deps: write a make rule with the inputs of the outputs (<output>.d)
+bool reorder_tiles = false;          // -reorder_tiles: order the tiles so similar ones are next to each other
+bool skip_if_unchanged = false;      // -skip_if_unchanged: don't convert when the <output>.stamp hash matches
+bool export_packed_bin = false;      // -bin_packed: one .bin file with a header and all sections for load_packaged_map()
+enum PackedCompression { PACKED_NONE, PACKED_GB, PACKED_RLE, PACKED_AUTO };
+PackedCompression packed_compression = PACKED_NONE; // -bin_compress: compression of the -bin_packed sections
+size_t packed_align = 2;             // -bin_align: alignment of the -bin_packed sections
+vector< string > output_files;       // Every file written, for -deps and -skip_if_unchanged
+
+#define SGB_BORDER_W          256
+#define SGB_BORDER_H          224
+#define SGB_TRN_SIZE          4096 // Bytes of a CHR_TRN / PCT_TRN transfer
+#define SGB_PCT_MAP_SIZE      (32 * 32 * 2)
+#define SGB_PCT_PALETTE_COUNT 4    // SNES palettes 4 to 7
+
+#define VWF_GLYPH_W           8    // Glyphs are in 8 x 8 cells
+#define VWF_GLYPH_H           8
+#define VWF_SPACE_W           4    // Width of glyphs without pixels
 
 
 // TODO: Move into tiles.cpp
+
+// Reverses the pixels of a row word
+static inline uint64_t ReverseRow(uint64_t row)
+{
+	row = ((row & 0x00FF00FF00FF00FFull) << 8)  | ((row >> 8)  & 0x00FF00FF00FF00FFull);
+	row = ((row & 0x0000FFFF0000FFFFull) << 16) | ((row >> 16) & 0x0000FFFF0000FFFFull);
+	return (row << 32) | (row >> 32);
+}
+
+// Reverses the order of the rows
 Tile FlipH(const Tile& tile)
 {
-	Tile ret;
-	for(int j = (int)tile.data.size() - 8; j >= 0; j -= 8)
-	{
-		for(int i = 0; i < 8; ++ i)
-		{
-			ret.data.push_back(tile.data[j + i]);
-		}
-	}
+	Tile ret(tile.data.size());
+	size_t rows = tile.data.size() / 8;
+	for(size_t j = 0; j < rows; ++j)
+		ret.data.SetRow(j, tile.data.GetRow(rows - 1 - j));
 	ret.pal = tile.pal;
 	return ret;
 }
 
+// Reverses the pixels in each row
 Tile FlipV(const Tile& tile)
 {
-	Tile ret;
-	for(int j = 0; j < (int)tile.data.size(); j += 8)
-	{
-		for(int i = 7; i >= 0; -- i)
-		{
-			ret.data.push_back(tile.data[j + i]);
-		}
-	}
+	Tile ret(tile.data.size());
+	for(size_t j = 0; j < tile.data.size() / 8; ++j)
+		ret.data.SetRow(j, ReverseRow(tile.data.GetRow(j)));
 	ret.pal = tile.pal;
 	return ret;
 }
 
+// Looks up a tile in the tile index, returns true if found
+static bool FindTileIndexed(const Tile& t, size_t& idx)
+{
+	unordered_map< Tile, size_t, TileHash >::const_iterator it = tiles_index.find(t);
+	if(it != tiles_index.end())
+	{
+		idx = it->second;
+		return true;
+	}
+	return false;
+}
+
+// Appends a tile to the tileset and returns its index
+// The index only records the first occurrence so lookups match a front-to-back search
+size_t AddTile(const Tile& t)
+{
+	tiles.push_back(t);
+	tiles_index.emplace(t, tiles.size() - 1);
+	return tiles.size() - 1;
+}
+
 bool FindTile(const Tile& t, size_t& idx, unsigned char& props)
 {
-	vector< Tile >::iterator it;
-	it = find(tiles.begin(), tiles.end(), t);
-	if(it != tiles.end())
+	if(FindTileIndexed(t, idx))
 	{
-		idx = (size_t)(it - tiles.begin());
 		props = props_default;
 		return true;
 	}
@@ -136,28 +254,22 @@ bool FindTile(const Tile& t, size_t& idx, unsigned char& props)
 	if(flip_tiles)
 	{
 		Tile tile = FlipV(t);
-		it = find(tiles.begin(), tiles.end(), tile);
-		if(it != tiles.end())
+		if(FindTileIndexed(tile, idx))
 		{
-			idx = (size_t)(it - tiles.begin());
 			props = props_default | (1 << 5);
 			return true;
 		}
 
 		tile = FlipH(tile);
-		it = find(tiles.begin(), tiles.end(), tile);
-		if(it != tiles.end())
+		if(FindTileIndexed(tile, idx))
 		{
-			idx = (size_t)(it - tiles.begin());
 			props = props_default | (1 << 5) | (1 << 6);
 			return true;
 		}
 
 		tile = FlipV(tile);
-		it = find(tiles.begin(), tiles.end(), tile);
-		if(it != tiles.end())
+		if(FindTileIndexed(tile, idx))
 		{
-			idx = (size_t)(it - tiles.begin());
 			props = props_default | (1 << 6);
 			return true;
 		}
@@ -166,8 +278,275 @@ bool FindTile(const Tile& t, size_t& idx, unsigned char& props)
 	return false;
 }
 
+// Number of 8x8 hardware tiles in each png2asset tile
+int tiles_per_sprite()
+{
+	if (sprite_mode == SPR_8x16)
+		return 2;
+	else if (sprite_mode == SPR_16x16_MSX)
+		return 4;
+	return 1;
+}
+
+// Adds a tile to a metasprite, with the tile deduplicated against the tileset
+static void AddMetaSpriteTile(MetaSprite& mt_sprite, const Tile& tile, int x, int y, unsigned char pal_idx, int& last_x, int& last_y)
+{
+	size_t idx;
+	unsigned char props;
+
+	if(keep_duplicate_tiles)
+	{
+		idx = AddTile(tile);
+		props = props_default;
+	}
+	else
+	{
+		if(!FindTile(tile, idx, props))
+		{
+			if (use_source_tileset) {
+				printf("found a tile not in the source tileset at %d,%d. The target tileset has %d extra tiles.\n", x, y,extra_tile_count+1);
+				extra_tile_count++;
+				includeTileData = true;
+			}
+			idx = AddTile(tile);
+			props = props_default;
+		}
+	}
+
+	props |= pal_idx;
+
+	mt_sprite.push_back(MTTile(x - last_x, y - last_y, (unsigned char)(idx * tiles_per_sprite()), props, idx));
+	last_x = x;
+	last_y = y;
+}
+
+// Tiles of a frame on a grid starting at (x0, y0), for -sprite_trim
+struct FrameTiles
+{
+	vector< Tile > tiles;
+	vector< int > x, y;
+	vector< unsigned char > pals;
+};
+
+// Extracts the non empty tiles of a frame on a grid which may start up to a tile
+// before the frame. Pixels outside the frame are transparent, and since palettes
+// were assigned on the frame aligned grid a placement where a tile mixes
+// palettes is rejected (returns false)
+// Extracts the tile at (x, y) with the pixels outside the frame (_x, _y) - (right, bottom)
+// transparent. Returns its palette, -1 if it is empty or -2 if it mixes palettes
+static int GetFrameTile(int _x, int _y, int right, int bottom, int x, int y, Tile& tile)
+{
+	int pal = -1;
+	for(int j = 0; j < image.tile_h; ++j)
+	{
+		for(int i = 0; i < image.tile_w; ++i)
+		{
+			int px = x + i, py = y + j;
+			if(px < _x || px >= right || py < _y || py >= bottom)
+				continue;
+			unsigned char color_idx = image.GetGBColor(px, py);
+			if(color_idx == 0)
+				continue;
+			if(pal == -1)
+				pal = image.data[py * image.w + px] >> 2;
+			else if(pal != (image.data[py * image.w + px] >> 2))
+				return -2;
+			// 16x16 MSX tiles are four 8x8 tiles in the order UL, LL, UR, LR
+			if(sprite_mode == SPR_16x16_MSX)
+				tile.data[(((i / 8) * 2) + (j / 8)) * 64 + ((j % 8) * 8) + (i % 8)] = color_idx;
+			else
+				tile.data[(j * image.tile_w) + i] = color_idx;
+		}
+	}
+	return pal;
+}
+
+static bool GetFrameTiles(int _x, int _y, int _w, int _h, int x0, int y0, FrameTiles& frame)
+{
+	int right = min(_x + _w, (int)image.w);
+	int bottom = min(_y + _h, (int)image.h);
+
+	for(int y = y0; y < bottom; y += image.tile_h)
+	{
+		for(int x = x0; x < right; x += image.tile_w)
+		{
+			Tile tile(image.tile_h * image.tile_w);
+			int pal = GetFrameTile(_x, _y, right, bottom, x, y, tile);
+			if(pal == -2)
+				return false;
+			if(pal != -1)
+			{
+				frame.tiles.push_back(tile);
+				frame.x.push_back(x);
+				frame.y.push_back(y);
+				frame.pals.push_back((unsigned char)pal);
+			}
+		}
+	}
+	return true;
+}
+
+// -sprite_trim: searches all grid offsets within a tile for the one with
+// the fewest sprites, then the fewest sprites on a line, then the fewest
+// tiles which are not in the tileset yet. The frame aligned grid wins ties.
+// Returns false if every offset mixes palettes in a tile
+static bool GetMetaSpriteTrimmed(int _x, int _y, int _w, int _h, int pivot_x, int pivot_y)
+{
+	FrameTiles best, frame;
+	size_t best_score[3] = { SIZE_MAX, SIZE_MAX, SIZE_MAX };
+	int last_x = _x + pivot_x;
+	int last_y = _y + pivot_y;
+
+	for(int oy = 0; oy < image.tile_h; ++oy)
+	{
+		for(int ox = 0; ox < image.tile_w; ++ox)
+		{
+			frame = FrameTiles();
+			if(!GetFrameTiles(_x, _y, _w, _h, _x - ox, _y - oy, frame))
+				continue;
+
+			size_t score[3] = { frame.tiles.size(), 0, 0 };
+			size_t line_count = 0;
+			unordered_map< Tile, size_t, TileHash > new_tiles;
+			for(size_t t = 0; t < frame.tiles.size(); ++t)
+			{
+				// Tiles of a grid row share the same lines
+				line_count = (t && (frame.y[t] == frame.y[t - 1])) ? line_count + 1 : 1;
+				score[1] = max(score[1], line_count);
+				size_t idx;
+				unsigned char props;
+				if(!FindTile(frame.tiles[t], idx, props))
+					new_tiles.emplace(frame.tiles[t], t);
+			}
+			score[2] = new_tiles.size();
+
+			if(lexicographical_compare(score, score + 3, best_score, best_score + 3))
+			{
+				best = frame;
+				memcpy(best_score, score, sizeof(score));
+			}
+		}
+	}
+
+	if(best_score[0] == SIZE_MAX)
+		return false;
+
+	sprites.push_back(MetaSprite());
+	MetaSprite& mt_sprite = sprites.back();
+	for(size_t t = 0; t < best.tiles.size(); ++t)
+		AddMetaSpriteTile(mt_sprite, best.tiles[t], best.x[t], best.y[t], best.pals[t], last_x, last_y);
+	return true;
+}
+
+// -sprite_pairs: an 8x16 sprite shows tiles n and n + 1, so two 8x8 halves can't be
+// shared between different pairs. Instead each 8 pixel column of the frame is split
+// into 8x16 sprites starting at any 8 pixel row, which may also be the row above the
+// frame. The split of each column is found by dynamic programming over its 8x8 rows:
+// the fewest sprites, then the fewest new tiles (tiles already in the tileset are
+// reused, flipped too), then sprites on the frame aligned grid.
+// Returns false if every split mixes palettes in a tile
+static bool GetMetaSpritePaired(int _x, int _y, int _w, int _h, int pivot_x, int pivot_y)
+{
+	int right = min(_x + _w, (int)image.w);
+	int bottom = min(_y + _h, (int)image.h);
+	int rows = (bottom - _y + 7) / 8;
+	const size_t invalid = SIZE_MAX;
+	FrameTiles frame;
+
+	for(int x = _x; x < right; x += 8)
+	{
+		// The 8x8 rows with pixels, and the sprite starting at each row (from row -1)
+		vector< bool > used(rows, false);
+		vector< Tile > pair_tiles(rows + 1, Tile(image.tile_w * image.tile_h));
+		vector< int > pair_pals(rows + 1);
+		vector< size_t > pair_cost(rows + 1);
+		for(int r = -1; r < rows; ++r)
+		{
+			Tile& tile = pair_tiles[r + 1];
+			int pal = GetFrameTile(_x, _y, right, bottom, x, _y + r * 8, tile);
+			pair_pals[r + 1] = pal;
+			if(pal == -2)
+				pair_cost[r + 1] = invalid;
+			else
+			{
+				size_t idx;
+				unsigned char props;
+				// Sprites, new tiles and starts off the frame aligned grid, most significant first
+				pair_cost[r + 1] = 0x10000 + (FindTile(tile, idx, props) ? 0 : 0x100) + (r & 1);
+			}
+			if((r >= 0) && (pal != -1))
+			{
+				Tile half(image.tile_w * image.tile_h);
+				used[r] = GetFrameTile(_x, _y, right, min(bottom, _y + (r + 1) * 8), x, _y + r * 8, half) != -1;
+			}
+		}
+
+		// best[r]: cost of the sprites for the used rows from r down, with row r - 1 not shown
+		// by a sprite starting at r - 1. start[r] is the row the first of them starts at
+		vector< size_t > best(rows + 2, 0);
+		vector< int > start(rows + 2, rows);
+		for(int r = rows - 1; r >= 0; --r)
+		{
+			best[r] = best[r + 1];
+			start[r] = start[r + 1];
+			if(!used[r])
+				continue;
+			best[r] = invalid;
+			// Starting at r covers r and r + 1, starting at r - 1 covers r - 1 (unused) and r
+			size_t next = best[min(r + 2, rows)];
+			if((pair_cost[r + 1] != invalid) && (next != invalid))
+			{
+				best[r] = pair_cost[r + 1] + next;
+				start[r] = r;
+			}
+			next = best[r + 1];
+			if(((r == 0) || !used[r - 1]) && (pair_cost[r] != invalid) && (next != invalid) && (pair_cost[r] + next < best[r]))
+			{
+				best[r] = pair_cost[r] + next;
+				start[r] = r - 1;
+			}
+		}
+		if(best[0] == invalid)
+			return false;
+
+		for(int r = 0; r < rows;)
+		{
+			if(!used[r])
+			{
+				++r;
+				continue;
+			}
+			int s = start[r];
+			frame.tiles.push_back(pair_tiles[s + 1]);
+			frame.x.push_back(x);
+			frame.y.push_back(_y + s * 8);
+			frame.pals.push_back((unsigned char)pair_pals[s + 1]);
+			r = s + 2;
+		}
+	}
+
+	// Row by row like the other frames
+	vector< size_t > order(frame.tiles.size());
+	for(size_t t = 0; t < order.size(); ++t)
+		order[t] = t;
+	stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return frame.y[a] < frame.y[b]; });
+
+	int last_x = _x + pivot_x;
+	int last_y = _y + pivot_y;
+	sprites.push_back(MetaSprite());
+	MetaSprite& mt_sprite = sprites.back();
+	for(size_t t = 0; t < order.size(); ++t)
+		AddMetaSpriteTile(mt_sprite, frame.tiles[order[t]], frame.x[order[t]], frame.y[order[t]], frame.pals[order[t]], last_x, last_y);
+	return true;
+}
+
 void GetMetaSprite(int _x, int _y, int _w, int _h, int pivot_x, int pivot_y)
 {
+	if(sprite_trim && GetMetaSpriteTrimmed(_x, _y, _w, _h, pivot_x, pivot_y))
+		return;
+	if(sprite_pairs && GetMetaSpritePaired(_x, _y, _w, _h, pivot_x, pivot_y))
+		return;
+
 	int last_x = _x + pivot_x;
 	int last_y = _y + pivot_y;
 
@@ -180,63 +559,323 @@ void GetMetaSprite(int _x, int _y, int _w, int _h, int pivot_x, int pivot_y)
 			Tile tile(image.tile_h * image.tile_w);
 			if (image.ExtractTile(x, y, tile, sprite_mode, export_as_map, use_map_attributes))
 			{
-				size_t idx;
-				unsigned char props;
 				unsigned char pal_idx = image.data[y * image.w + x] >> 2; //We can pick the palette from the first pixel of this tile
+				AddMetaSpriteTile(mt_sprite, tile, x, y, pal_idx, last_x, last_y);
+			}
+		}
+	}
+}
+
+// Hardware sprites shown on one line: 10 on GB, 8 on SMS/GG and NES
+static int hw_sprites_per_line()
+{
+	return (convert_rgb_to_nes || (pack_mode == Tile::SMS)) ? 8 : 10;
+}
+
+// Counts the hardware sprites on each line of each frame, for -sprite_lines
+// and -max_sprites_per_line. The count moves with the frame, so it is the
+// same for any Y position the frame is drawn at. Lines are reported
+// relative to the pivot. Returns false if a frame is over the limit.
+bool CheckSpriteLines(const string& name)
+{
+	bool ok = true;
+	int hw_limit = hw_sprites_per_line();
+	int worst = 0;
+
+	for(size_t f = 0; f < sprites.size(); ++f)
+	{
+		const MetaSprite& mt_sprite = sprites[f];
+		if(mt_sprite.empty())
+			continue;
+
+		// Offsets are relative to the previous tile
+		vector< int > tile_y(mt_sprite.size());
+		int y = 0, min_y = INT32_MAX, max_y = INT32_MIN;
+		for(size_t t = 0; t < mt_sprite.size(); ++t)
+		{
+			y += mt_sprite[t].offset_y;
+			tile_y[t] = y;
+			min_y = std::min(min_y, y);
+			max_y = std::max(max_y, y);
+		}
 
-				if(keep_duplicate_tiles)
+		vector< int > lines(max_y - min_y + image.tile_h, 0);
+		for(size_t t = 0; t < tile_y.size(); ++t)
+			for(int r = 0; r < (int)image.tile_h; ++r)
+				lines[tile_y[t] - min_y + r]++;
+
+		size_t max_line = std::max_element(lines.begin(), lines.end()) - lines.begin();
+		int count = lines[max_line];
+		int line = (int)max_line + min_y;
+		worst = std::max(worst, count);
+
+		if(report_sprite_lines)
+			printf("%s frame %d: %d sprites on line %d%s\n", name.c_str(), (int)f, count, line,
+			       (count > hw_limit) ? " (over the hardware limit)" : "");
+		if(max_sprites_per_line && (count > max_sprites_per_line))
+		{
+			printf("error: %s frame %d has %d sprites on line %d, the limit is %d\n", name.c_str(), (int)f, count, line, max_sprites_per_line);
+			ok = false;
+		}
+	}
+
+	if(report_sprite_lines)
+		printf("%s: at most %d sprites on one line, the hardware shows %d\n", name.c_str(), worst, hw_limit);
+	return ok;
+}
+
+// Groups the slots which get a tile (slot_tiles[slot] != -1) into runs of consecutive slots
+static AnimDiff GetAnimRuns(const vector< int >& slot_tiles)
+{
+	AnimDiff diff;
+	for(size_t s = 0; s < slot_tiles.size(); ++s)
+	{
+		if(slot_tiles[s] == -1)
+			continue;
+		if(diff.empty() || (diff.back().first_slot + diff.back().tiles.size() != s))
+		{
+			diff.push_back(AnimRun());
+			diff.back().first_slot = s;
+		}
+		diff.back().tiles.push_back((size_t)slot_tiles[s]);
+	}
+	return diff;
+}
+
+// Gives each tile of a frame a VRAM slot, shared by all frames. Tiles which
+// are already in a slot from the previous frame stay there, so each frame
+// only needs to load the tiles which changed. The metasprites are changed
+// to use the slot numbers as their tile indices.
+bool GetAnimDiffs()
+{
+	vector< vector< size_t > > frame_tiles(sprites.size());
+	for(size_t f = 0; f < sprites.size(); ++f)
+	{
+		for(MetaSprite::iterator it = sprites[f].begin(); it != sprites[f].end(); ++it)
+		{
+			if(find(frame_tiles[f].begin(), frame_tiles[f].end(), (*it).tile) == frame_tiles[f].end())
+				frame_tiles[f].push_back((*it).tile);
+		}
+		anim_slots = max(anim_slots, frame_tiles[f].size());
+	}
+	if(anim_slots * tiles_per_sprite() > 256)
+	{
+		printf("Error: animation needs %d tile slots, more than 256 tiles\n", (unsigned int)(anim_slots * tiles_per_sprite()));
+		return false;
+	}
+
+	vector< int > vram(anim_slots, -1);
+	vector< int > first_frame;
+	anim_diffs.resize(sprites.size());
+	for(size_t f = 0; f < sprites.size(); ++f)
+	{
+		vector< int > slot_of(tiles.size(), -1);
+		vector< bool > taken(anim_slots, false);
+		for(size_t i = 0; i < frame_tiles[f].size(); ++i)
+		{
+			for(size_t s = 0; s < anim_slots; ++s)
+			{
+				if(vram[s] == (int)frame_tiles[f][i])
 				{
-					tiles.push_back(tile);
-					idx = tiles.size() - 1;
-					props = props_default;
+					slot_of[frame_tiles[f][i]] = (int)s;
+					taken[s] = true;
+					break;
 				}
-				else
+			}
+		}
+
+		vector< int > changed(anim_slots, -1);
+		for(size_t i = 0, s = 0; i < frame_tiles[f].size(); ++i)
+		{
+			size_t t = frame_tiles[f][i];
+			if(slot_of[t] != -1)
+				continue;
+			while(taken[s])
+				++s;
+			slot_of[t] = (int)s;
+			taken[s] = true;
+			changed[s] = (int)t;
+			vram[s] = (int)t;
+		}
+
+		for(MetaSprite::iterator it = sprites[f].begin(); it != sprites[f].end(); ++it)
+			(*it).offset_idx = (unsigned char)(slot_of[(*it).tile] * tiles_per_sprite());
+
+		if(f == 0)
+		{
+			first_frame = changed;
+			anim_init = GetAnimRuns(changed);
+		}
+		else
+			anim_diffs[f] = GetAnimRuns(changed);
+	}
+
+	// Looping back to the first frame
+	for(size_t s = 0; s < anim_slots; ++s)
+	{
+		if(first_frame[s] == vram[s])
+			first_frame[s] = -1;
+	}
+	anim_diffs[0] = GetAnimRuns(first_frame);
+	return true;
+}
+
+// Splits the map into metatile_size x metatile_size blocks of tiles (metatiles)
+// and replaces each block with the index of the first identical block,
+// the same way FindTile() removes duplicate tiles
+bool GetMetatiles()
+{
+	size_t map_w = image.w / 8;
+	size_t map_h = image.h / 8;
+	// Attributes are stored within the map on SGB/SMS, separately on CGB
+	size_t stride = (map.size() == map_w * map_h) ? 1 : 2;
+	bool separate_attributes = use_map_attributes && !use_2x2_map_attributes && map_attributes.size();
+
+	if((map_w % metatile_size) || (map_h % metatile_size))
+	{
+		printf("Error: map size (%d x %d tiles) is not a multiple of the metatile size (%d)\n", (unsigned int)map_w, (unsigned int)map_h, metatile_size);
+		return false;
+	}
+	metatile_map_width = map_w / metatile_size;
+	metatile_map_height = map_h / metatile_size;
+
+	// Index of the first occurrence of each unique metatile: tile indices followed by attributes
+	unordered_map< string, size_t > metatiles_index;
+	size_t count = 0;
+	for(size_t by = 0; by < metatile_map_height; by++)
+	{
+		for(size_t bx = 0; bx < metatile_map_width; bx++)
+		{
+			string block;
+			for(size_t y = 0; y < (size_t)metatile_size; y++)
+				for(size_t x = 0; x < (size_t)metatile_size; x++)
+					block.push_back(map[(((by * metatile_size + y) * map_w) + (bx * metatile_size + x)) * stride]);
+			for(size_t y = 0; y < (size_t)metatile_size; y++)
+			{
+				for(size_t x = 0; x < (size_t)metatile_size; x++)
 				{
-					if(!FindTile(tile, idx, props))
-					{
-						if (use_source_tileset) {
-							printf("found a tile not in the source tileset at %d,%d. The target tileset has %d extra tiles.\n", x, y,extra_tile_count+1);
-							extra_tile_count++;
-							includeTileData = true;
-						}
-						tiles.push_back(tile);
-						idx = tiles.size() - 1;
-						props = props_default;
-					}
+					size_t t = ((by * metatile_size + y) * map_w) + (bx * metatile_size + x);
+					if(stride == 2)
+						block.push_back(map[t * 2 + 1]);
+					else if(separate_attributes)
+						block.push_back(map_attributes[t]);
+				}
+			}
+
+			unordered_map< string, size_t >::const_iterator it = metatiles_index.find(block);
+			size_t idx;
+			if(it != metatiles_index.end())
+			{
+				idx = it->second;
+			}
+			else
+			{
+				idx = count++;
+				metatiles_index[block] = idx;
+				size_t n = metatile_size * metatile_size;
+				for(size_t i = 0; i < block.size(); i++)
+				{
+					if(i < n)
+						metatiles.push_back(block[i]);
+					else
+						metatile_attributes.push_back(block[i]);
 				}
+				if(count == 257)
+					printf("Warning: found more than 256 metatiles on x:%d,y:%d\n", (unsigned int)(bx * metatile_size * 8), (unsigned int)(by * metatile_size * 8));
+			}
+			metatile_map.push_back((unsigned char)idx);
+		}
+	}
+	return true;
+}
 
-				props |= pal_idx;
+// Calls fn(0) ... fn(count - 1) spread over all cores
+static void ParallelFor(size_t count, const function< void(size_t) >& fn)
+{
+	size_t thread_count = min((size_t)max(1u, thread::hardware_concurrency()), count);
+	atomic< size_t > next(0);
+	vector< thread > threads;
+	for(size_t t = 0; t < thread_count; ++t)
+	{
+		threads.push_back(thread([&]() {
+			for(size_t i = next++; i < count; i = next++)
+				fn(i);
+		}));
+	}
+	for(size_t t = 0; t < thread_count; ++t)
+		threads[t].join();
+}
 
-				// Scale up index based on 8x8 tiles-per-hardware sprite
-				if (sprite_mode == SPR_8x16)
-					idx *= 2;
-				else if (sprite_mode == SPR_16x16_MSX)
-					idx *= 4;
+// CGB attribute maps with more tiles than fit in VRAM bank 0 (256 - tile_origin) continue
+// in bank 1: those tiles start again at tile_origin, their attributes get the bank bit
+// and they are exported separately as _tiles_bank1, for set_bkg_data_cgb()
+#define CGB_ATTR_VRAM_BANK1 0x08
 
-				mt_sprite.push_back(MTTile(x - last_x, y - last_y, (unsigned char)idx, props));
-				last_x = x;
-				last_y = y;
-			}
+static bool cgb_vram_banks(void)
+{
+	return export_as_map && use_map_attributes && (pack_mode == Tile::GB) && (bpp == 2) && !use_2x2_map_attributes &&
+	       (tile_origin < 256) && !export_sgb_border_data && !export_vwf_font_data;
+}
+
+// Tiles of the whole tileset (-source_tileset tiles included) which are in VRAM bank 0
+static size_t vram_bank0_size(void)
+{
+	size_t bank_size = 256 - tile_origin;
+	if(!cgb_vram_banks() || (source_tileset_size > bank_size))
+		return tiles.size();
+	return min(tiles.size(), bank_size);
+}
+
+// Exported tiles in each bank
+static size_t tile_count_bank0(void) { return vram_bank0_size() - source_tileset_size; }
+static size_t tile_count_bank1(void) { return tiles.size() - vram_bank0_size(); }
+
+static void PlaceTilesInVramBanks(void)
+{
+	size_t bank0_size = vram_bank0_size();
+	for(size_t i = 0; i < map_tile_ids.size(); ++i)
+	{
+		if(map_tile_ids[i] >= bank0_size)
+		{
+			map[i] = (unsigned char)(map_tile_ids[i] - bank0_size + tile_origin);
+			map_attributes[i] |= CGB_ATTR_VRAM_BANK1;
 		}
 	}
 }
 
+#define GETMAP_BAND_ROWS 64 // Tile rows extracted at a time, limits the memory used for large images
+
+// Tiles are extracted a band of tile rows at a time in parallel, then
+// deduplicated in image order so the tileset is the same as extracting
+// them one by one
 void GetMap()
 {
-	for(int y = 0; y < (int)image.h; y += image.tile_h)
+	size_t columns = (image.w + image.tile_w - 1) / image.tile_w;
+	size_t rows = (image.h + image.tile_h - 1) / image.tile_h;
+	vector< Tile > band(min(rows, (size_t)GETMAP_BAND_ROWS) * columns, Tile(image.tile_w * image.tile_h));
+	unsigned int vram_banks = cgb_vram_banks() ? 2 : 1;
+
+	for(size_t band_y = 0; band_y < rows; band_y += GETMAP_BAND_ROWS)
 	{
-		for(int x = 0; x < (int)image.w; x += image.tile_w)
+		size_t band_rows = min(rows - band_y, (size_t)GETMAP_BAND_ROWS);
+		ParallelFor(band_rows, [&](size_t row) {
+			for(size_t column = 0; column < columns; ++column)
+				image.ExtractTile((int)(column * image.tile_w), (int)((band_y + row) * image.tile_h), band[row * columns + column],
+				                  sprite_mode, export_as_map, use_map_attributes);
+		});
+
+		for(size_t cell = 0; cell < band_rows * columns; ++cell)
 		{
-			Tile tile(image.tile_w * image.tile_h);
-			image.ExtractTile(x, y, tile, sprite_mode, export_as_map, use_map_attributes);
+			int x = (int)((cell % columns) * image.tile_w);
+			int y = (int)((band_y + (cell / columns)) * image.tile_h);
+			const Tile& tile = band[cell];
 
 			size_t idx;
 			unsigned char props;
 
 			if(keep_duplicate_tiles)
 			{
-				tiles.push_back(tile);
-				idx = tiles.size() - 1;
+				idx = AddTile(tile);
 				props = props_default;
 			}
 			else
@@ -248,19 +887,19 @@ void GetMap()
 						extra_tile_count++;
 						includeTileData = true;
 					}
-					tiles.push_back(tile);
-					idx = tiles.size() - 1;
+					idx = AddTile(tile);
 					props = props_default;
 
-					if(tiles.size() > 256 && pack_mode != Tile::SMS)
-						printf("Warning: found more than 256 tiles on x:%d,y:%d\n", x, y);
+					if(tiles.size() > 256 * vram_banks && pack_mode != Tile::SMS)
+						printf("Warning: found more than %d tiles on x:%d,y:%d\n", 256 * vram_banks, x, y);
 
-					if(((tiles.size() + tile_origin) > 256) && (pack_mode != Tile::SMS))
-						printf("Warning: tile count (%d) + tile origin (%d) exceeds 256 at x:%d,y:%d\n", (unsigned int)tiles.size(), tile_origin, x, y);
+					if(((tiles.size() + tile_origin * vram_banks) > 256 * vram_banks) && (pack_mode != Tile::SMS))
+						printf("Warning: tile count (%d) + tile origin (%d) exceeds %d at x:%d,y:%d\n", (unsigned int)tiles.size(), tile_origin, 256 * vram_banks, x, y);
 				}
 			}
 
 			map.push_back((unsigned char)idx + tile_origin);
+			map_tile_ids.push_back(idx);
 
 			if(use_map_attributes)
 			{
@@ -288,6 +927,309 @@ void GetMap()
 		}
 	}
 }
+
+//
+// -reorder_tiles: the tiles are ordered so each one compresses well after the one
+// before it, starting from the first tile, by always picking the remaining tile which
+// is cheapest to encode next (greedy nearest neighbour). The cost follows the greedy
+// parse of gbcompress_buf() over the packed data of the two tiles. Back references
+// further back than the previous tile are lost by moving tiles, so the whole tileset
+// is costed the same way before and after, and the new order is only kept if smaller.
+// The tiles of a -source_tileset keep their place, only the ones after them move.
+//
+#define REORDER_TILES_MAX 4096 // The cost of every pair is needed, more tiles keep their order
+
+// Writes the pending trash (uncompressed) bytes before pos as one token, returns its size
+static size_t GbCompressTrash(const vector< unsigned char >& buf, size_t pos, size_t& trash, vector< unsigned char >* out)
+{
+	if(!trash)
+		return 0;
+	if(out)
+	{
+		out->push_back((unsigned char)(0xC0 | (trash - 1)));
+		out->insert(out->end(), buf.begin() + (pos - trash), buf.begin() + pos);
+	}
+	size_t cost = trash + 1;
+	trash = 0;
+	return cost;
+}
+
+// The greedy parse of gbcompress_buf() for buf from start on, with the bytes before start
+// only there for back references. The tokens are appended to out unless it is NULL,
+// returns their size in bytes (without the end marker)
+static size_t GbCompressParse(const vector< unsigned char >& buf, size_t start, vector< unsigned char >* out)
+{
+	size_t size = buf.size();
+	size_t pos = start;
+	size_t cost = 0;
+	size_t trash = 0;
+
+	while(pos < size)
+	{
+		size_t u8_len = 1;
+		while((pos + u8_len < size) && (buf[pos + u8_len] == buf[pos]) && (u8_len < 64))
+			u8_len++;
+
+		size_t u16_len = 0;
+		if(pos + 1 < size)
+		{
+			u16_len = 1;
+			while((pos + u16_len * 2 + 1 < size) && (buf[pos + u16_len * 2] == buf[pos]) &&
+			      (buf[pos + u16_len * 2 + 1] == buf[pos + 1]) && (u16_len < 64))
+				u16_len++;
+		}
+
+		// Back references can't overlap the current position, the oldest of the longest is used
+		size_t str_len = 0;
+		size_t str_dist = 0;
+		for(size_t cand = (pos > 0xFFFF) ? pos - 0xFFFF : 0; cand < pos; ++cand)
+		{
+			if(buf[cand] != buf[pos])
+				continue;
+			size_t len_max = min(min(size - pos, pos - cand), (size_t)64);
+			size_t len = 0;
+			while((len < len_max) && (buf[cand + len] == buf[pos + len]))
+				len++;
+			if(len > str_len)
+			{
+				str_len = len;
+				str_dist = pos - cand;
+			}
+		}
+
+		if(((u8_len > 2) && (u8_len > u16_len) && (u8_len > str_len)) ||
+		   ((u16_len > 2) && ((u16_len * 2) > str_len)) || (str_len > 3))
+			cost += GbCompressTrash(buf, pos, trash, out);
+
+		if((u8_len > 2) && (u8_len > u16_len) && (u8_len > str_len))
+		{
+			if(out)
+				out->insert(out->end(), { (unsigned char)(u8_len - 1), buf[pos] });
+			cost += 2;
+			pos += u8_len;
+		}
+		else if((u16_len > 2) && ((u16_len * 2) > str_len))
+		{
+			if(out)
+				out->insert(out->end(), { (unsigned char)(0x40 | (u16_len - 1)), buf[pos], buf[pos + 1] });
+			cost += 3;
+			pos += u16_len * 2;
+		}
+		else if(str_len > 3)
+		{
+			// The offset is negative, low byte first
+			uint16_t offset = (uint16_t)(0x10000 - str_dist);
+			if(out)
+				out->insert(out->end(), { (unsigned char)(0x80 | (str_len - 1)), (unsigned char)(offset & 0xFF), (unsigned char)(offset >> 8) });
+			cost += 3;
+			pos += str_len;
+		}
+		else if(trash >= 64)
+			cost += GbCompressTrash(buf, pos, trash, out);
+		else
+		{
+			trash++;
+			pos++;
+		}
+	}
+	return cost + GbCompressTrash(buf, pos, trash, out);
+}
+
+// Bytes gbcompress_buf() writes for buf from start on (without the end marker)
+static size_t GbCompressCost(const vector< unsigned char >& buf, size_t start)
+{
+	return GbCompressParse(buf, start, NULL);
+}
+
+// buf compressed the way gbcompress does it, with the end marker
+static vector< unsigned char > GbCompress(const vector< unsigned char >& buf)
+{
+	vector< unsigned char > out;
+	GbCompressParse(buf, 0, &out);
+	out.push_back(0x00);
+	return out;
+}
+
+// buf compressed the way gbcompress --alg=rle does it: runs of more than 2 bytes
+// are repeats (negative length), the rest is copied in blocks, then the end marker
+static vector< unsigned char > RleCompress(const vector< unsigned char >& buf)
+{
+	vector< unsigned char > out;
+	size_t literal = 0; // Start of the bytes not written yet
+
+	for(size_t pos = 0; pos <= buf.size(); )
+	{
+		size_t run = 0;
+		while((pos + run < buf.size()) && (buf[pos + run] == buf[pos]) && (run < 127))
+			run++;
+		if((run > 2) || (pos == buf.size()) || (pos - literal == 127))
+		{
+			if(pos > literal)
+			{
+				out.push_back((unsigned char)(pos - literal));
+				out.insert(out.end(), buf.begin() + literal, buf.begin() + pos);
+			}
+			if(pos == buf.size())
+				break;
+			if(run > 2)
+			{
+				out.push_back((unsigned char)(0x100 - run));
+				out.push_back(buf[pos]);
+				pos += run;
+			}
+			literal = pos;
+		}
+		else
+			pos++;
+	}
+	out.push_back(0x00);
+	return out;
+}
+
+// Bytes for the data of tile b when it follows the data of tile a
+static size_t TileCompressCost(const vector< unsigned char >& a, const vector< unsigned char >& b)
+{
+	vector< unsigned char > buf(a);
+	buf.insert(buf.end(), b.begin(), b.end());
+	return GbCompressCost(buf, a.size());
+}
+
+static size_t TilesetCompressCost(const vector< vector< unsigned char > >& packed, const vector< size_t >& order)
+{
+	vector< unsigned char > buf;
+	for(size_t t = 0; t < order.size(); ++t)
+		buf.insert(buf.end(), packed[order[t]].begin(), packed[order[t]].end());
+	return GbCompressCost(buf, 0);
+}
+
+void ReorderTiles()
+{
+	size_t first = source_tileset_size;
+	size_t count = tiles.size() - first;
+	if(count < 3)
+		return;
+	if(count > REORDER_TILES_MAX)
+	{
+		printf("Warning: -reorder_tiles: %d tiles is more than %d, keeping their order\n", (unsigned int)count, REORDER_TILES_MAX);
+		return;
+	}
+
+	vector< vector< unsigned char > > packed(count);
+	for(size_t t = 0; t < count; ++t)
+		packed[t] = tiles[first + t].GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp);
+
+	// Cost of tile b after tile a at [a * count + b]
+	vector< uint16_t > costs(count * count);
+	ParallelFor(count, [&](size_t a) {
+		for(size_t b = 0; b < count; ++b)
+			costs[a * count + b] = (a == b) ? 0 : (uint16_t)TileCompressCost(packed[a], packed[b]);
+	});
+
+	vector< size_t > order(1, 0);
+	vector< bool > placed(count, false);
+	placed[0] = true;
+	for(size_t t = 1; t < count; ++t)
+	{
+		size_t last = order.back();
+		size_t best = count;
+		for(size_t b = 0; b < count; ++b)
+			if(!placed[b] && ((best == count) || (costs[last * count + b] < costs[last * count + best])))
+				best = b;
+		placed[best] = true;
+		order.push_back(best);
+	}
+
+	vector< size_t > unchanged(count);
+	for(size_t t = 0; t < count; ++t)
+		unchanged[t] = t;
+	size_t before = TilesetCompressCost(packed, unchanged);
+	size_t after = TilesetCompressCost(packed, order);
+	if(after >= before)
+	{
+		printf("-reorder_tiles: keeping the order of the %d tiles, estimated gb compressed size %d bytes (reordered: %d)\n",
+		       (unsigned int)count, (unsigned int)before, (unsigned int)after);
+		return;
+	}
+
+	// New index of each tile
+	vector< size_t > remap(tiles.size());
+	vector< Tile > ordered(tiles.begin(), tiles.begin() + first);
+	for(size_t t = 0; t < first; ++t)
+		remap[t] = t;
+	for(size_t t = 0; t < count; ++t)
+	{
+		remap[first + order[t]] = first + t;
+		ordered.push_back(tiles[first + order[t]]);
+	}
+	tiles.swap(ordered);
+	tiles_index.clear();
+	for(size_t t = 0; t < tiles.size(); ++t)
+		tiles_index.emplace(tiles[t], t);
+
+	// The map has the props after each tile for SGB and SMS attributes, SMS has bit 8 of the tile there
+	bool interleaved = use_map_attributes && ((pack_mode == Tile::SGB) || (pack_mode == Tile::SMS));
+	for(size_t i = 0; i < map_tile_ids.size(); ++i)
+	{
+		size_t idx = remap[map_tile_ids[i]];
+		map_tile_ids[i] = idx;
+		if(interleaved)
+		{
+			map[i * 2] = (unsigned char)(idx + tile_origin);
+			if(pack_mode == Tile::SMS)
+				map[i * 2 + 1] = (map[i * 2 + 1] & ~1) | ((idx > 255) ? 1 : 0);
+		}
+		else
+			map[i] = (unsigned char)(idx + tile_origin);
+	}
+	for(size_t s = 0; s < sprites.size(); ++s)
+	{
+		for(size_t i = 0; i < sprites[s].size(); ++i)
+		{
+			MTTile& mt = sprites[s][i];
+			mt.tile = remap[mt.tile];
+			mt.offset_idx = (unsigned char)(mt.tile * tiles_per_sprite());
+		}
+	}
+
+	printf("-reorder_tiles: reordered %d tiles, estimated gb compressed size %d -> %d bytes\n",
+	       (unsigned int)count, (unsigned int)before, (unsigned int)after);
+}
+
+// -map_chunks: the map is stored as chunks of map_chunk_w x map_chunk_h tiles, in
+// rows of chunks, each chunk row by row. Chunks past the right or bottom edge of the
+// map are padded with 0, so every chunk has the same size and chunk n starts at
+// n * _MAP_CHUNK_SIZE (or is block n of gbcompress --blocks=_MAP_CHUNK_SIZE).
+static size_t map_chunk_columns(void) { return ((image.w / 8) + map_chunk_w - 1) / map_chunk_w; }
+static size_t map_chunk_rows(void)    { return ((image.h / 8) + map_chunk_h - 1) / map_chunk_h; }
+
+// Lines _map and _map_attributes are written as: one per map row, or one per chunk
+static size_t map_lines(void) { return map_chunk_w ? map_chunk_columns() * map_chunk_rows() : image.h / 8; }
+static size_t map_attributes_line_size(void) { return map_chunk_w ? map_chunk_w * map_chunk_h : map_attributes_packed_width; }
+static size_t map_attributes_lines(void) { return map_chunk_w ? map_lines() : map_attributes_packed_height; }
+
+static void ChunkGrid(vector< unsigned char >& grid, size_t stride)
+{
+	size_t columns = image.w / 8;
+	size_t rows = image.h / 8;
+	vector< unsigned char > chunked;
+	chunked.reserve(map_lines() * map_chunk_w * map_chunk_h * stride);
+	for(size_t cy = 0; cy < map_chunk_rows(); ++cy)
+		for(size_t cx = 0; cx < map_chunk_columns(); ++cx)
+			for(size_t y = cy * map_chunk_h; y < (cy + 1) * map_chunk_h; ++y)
+				for(size_t x = cx * map_chunk_w; x < (cx + 1) * map_chunk_w; ++x)
+					for(size_t b = 0; b < stride; ++b)
+						chunked.push_back(((x < columns) && (y < rows)) ? grid[(y * columns + x) * stride + b] : 0);
+	grid.swap(chunked);
+}
+
+static void ChunkMap(void)
+{
+	// Attributes are stored within the map on SGB/SMS, separately on CGB
+	ChunkGrid(map, map.size() / ((image.w / 8) * (image.h / 8)));
+	if(use_map_attributes && map_attributes.size())
+		ChunkGrid(map_attributes, 1);
+}
+
 //Functor to compare entries in SetPal
 struct CmpIntColor {
 	bool operator() (unsigned int const& c1, unsigned int const& c2) const
@@ -320,23 +1262,47 @@ struct CmpIntColor {
 //This assumes the palette used in DMG will be 00 01 10 11
 typedef set< unsigned int, CmpIntColor > SetPal;
 
-SetPal GetPaletteColors(const PNGImage& image, int x, int y, int w, int h)
+#define TILE_COLORS_MAX 64
+
+static inline unsigned int GetColorInt(const unsigned char* color)
+{
+	return ((unsigned int)color[0] << 24) | (color[1] << 16) | (color[2] << 8) | color[3];
+}
+
+// y_origin is the row of the whole image where image starts, for the warning
+SetPal GetPaletteColors(const PNGImage& image, int x, int y, int w, int h, int y_origin = 0)
 {
+	// A tile only has a few distinct colors, so they get collected with a linear
+	// search first and only those go into the set (instead of one insert per pixel)
+	unsigned int colors[TILE_COLORS_MAX];
+	size_t count = 0;
 	SetPal ret;
 	for(int j = y; j < (y + h); ++ j)
 	{
-		for(int i = x; i < (x + w); ++ i)
+		const unsigned char* color = &image.data[(j * image.w + x) * RGBA32_SZ];
+		for(int i = 0; i < w; ++ i, color += RGBA32_SZ)
 		{
-			const unsigned char* color = &image.data[(j * image.w + i) * RGBA32_SZ];
-			int color_int = (color[0] << 24) | (color[1] << 16) | (color[2] << 8) | color[3];
-			ret.insert(color_int);
+			unsigned int color_int = GetColorInt(color);
+			size_t c = 0;
+			while((c < count) && (colors[c] != color_int))
+				c++;
+			if(c == count)
+			{
+				if(count == TILE_COLORS_MAX)
+				{
+					ret.insert(colors, colors + count);
+					count = 0;
+				}
+				colors[count++] = color_int;
+			}
 		}
 	}
+	ret.insert(colors, colors + count);
 
 	for(SetPal::iterator it = ret.begin(); it != ret.end(); ++it)
 	{
 		if(it != ret.begin() && ((0xFF & *it) != 0xFF)) //ret.begin() should be the only one transparent
-			printf("Warning: found more than one transparent color in tile at x:%d, y:%d of size w:%d, h:%d\n", x, y, w, h);
+			printf("Warning: found more than one transparent color in tile at x:%d, y:%d of size w:%d, h:%d\n", x, y + y_origin, w, h);
 	}
 
 	return ret;
@@ -394,9 +1360,20 @@ int FindOrCreateSubPalette(const SetPal& pal, vector< SetPal >& palettes, size_t
 //
 // Returns: array of attributes. This always has *per-tile* dimensions, even when half_resolution is true.
 //
+// BuildPalettesAndAttributesRows() does the same for a band of rows of the image, which
+// starts at row y_origin and is a multiple of the tile height (twice that for half_resolution)
+//
+static void BuildPalettesAndAttributesRows(const PNGImage& image32, unsigned int y_origin, vector< SetPal >& palettes, bool half_resolution, int* palettes_per_tile);
+
 int* BuildPalettesAndAttributes(const PNGImage& image32, vector< SetPal >& palettes, bool half_resolution)
 {
 	int* palettes_per_tile = new int[(image32.w / image32.tile_w) * (image32.h / image32.tile_h)];
+	BuildPalettesAndAttributesRows(image32, 0, palettes, half_resolution, palettes_per_tile);
+	return palettes_per_tile;
+}
+
+static void BuildPalettesAndAttributesRows(const PNGImage& image32, unsigned int y_origin, vector< SetPal >& palettes, bool half_resolution, int* palettes_per_tile)
+{
 	int sx = half_resolution ? 2 : 1;
 	int sy = half_resolution ? 2 : 1;
 	for (unsigned int y = 0; y < image32.h; y += image32.tile_h * sy)
@@ -404,7 +1381,9 @@ int* BuildPalettesAndAttributes(const PNGImage& image32, vector< SetPal >& palet
 		for (unsigned int x = 0; x < image32.w; x += image32.tile_w * sx)
 		{
 			//Get palette colors on (x, y, image32.tile_w, image32.tile_h)
-			SetPal pal = GetPaletteColors(image32, (x / sx) * sx, (y / sy) * sy, sx * image32.tile_w, sy * image32.tile_h);
+			SetPal pal = GetPaletteColors(image32, (x / sx) * sx, (y / sy) * sy, sx * image32.tile_w, sy * image32.tile_h, y_origin);
+			if(use_shared_background)
+				pal.insert(shared_background_color);
 
 			int subPalIndex = FindOrCreateSubPalette(pal, palettes, image32.colors_per_pal);
 			if (subPalIndex < 0)
@@ -412,7 +1391,7 @@ int* BuildPalettesAndAttributes(const PNGImage& image32, vector< SetPal >& palet
 				printf("Error: more than %d colors found in tile at x:%d, y:%d of size w:%d, h:%d\n",
 					(unsigned int)image32.colors_per_pal,
 					(x / sx) * sx,
-					(y / sy) * sy,
+					(y / sy) * sy + y_origin,
 					sx * image32.tile_w,
 					sy * image32.tile_h);
 				subPalIndex = 0; // Force to sub-palette 0, to allow getting a partially-incorrect output image
@@ -420,7 +1399,7 @@ int* BuildPalettesAndAttributes(const PNGImage& image32, vector< SetPal >& palet
 			// Assign single or multiple entries in palettes_per_tile, to keep it independent of
 			// of half_resolution parameter
 			int dx = ((x / image32.tile_w) / sx) * sx;
-			int dy = ((y / image32.tile_h) / sy) * sy;
+			int dy = (((y + y_origin) / image32.tile_h) / sy) * sy;
 			int w = (image32.w / image32.tile_w);
 			for (int yy = 0; yy < sy; yy++)
 			{
@@ -431,9 +1410,392 @@ int* BuildPalettesAndAttributes(const PNGImage& image32, vector< SetPal >& palet
 			}
 		}
 	}
+}
+
+//
+// Converts an RGBA32 image to palette indices: (palette << bpp) + index in that palette
+//
+// The palettes are copied into flat arrays once, so each pixel is a short linear
+// search instead of a set find(). Colors which are not in the palette of their tile
+// get the palette size as index, same as before.
+//
+void IndexImagePixels(const PNGImage& image32, const vector< SetPal >& palettes, const int* palettes_per_tile, vector< unsigned char >& out)
+{
+	vector< vector< unsigned int > > palette_colors(palettes.size());
+	for(size_t p = 0; p < palettes.size(); ++p)
+		palette_colors[p].assign(palettes[p].begin(), palettes[p].end());
+
+	size_t tiles_w = image32.w / image32.tile_w;
+	out.reserve(out.size() + (size_t)image32.w * image32.h);
+	for(size_t y = 0; y < image32.h; ++y)
+	{
+		const unsigned char* c32ptr = &image32.data[image32.w * y * RGBA32_SZ];
+		for(size_t x = 0; x < image32.w; ++x, c32ptr += RGBA32_SZ)
+		{
+			unsigned int color32 = GetColorInt(c32ptr);
+			unsigned char palette = palettes_per_tile[(y / image32.tile_h) * tiles_w + (x / image32.tile_w)];
+			const vector< unsigned int >& colors = palette_colors[palette];
+			size_t index = 0;
+			while((index < colors.size()) && (colors[index] != color32))
+				index++;
+			out.push_back((palette << bpp) + (unsigned char)index);
+		}
+	}
+}
+
+//
+// Large pngs (PNG_STREAM_MIN_PIXELS and up) are kept in their own color format after
+// decoding, which is 1 byte per pixel or less for indexed pngs instead of 4, and are
+// converted to RGBA32 one band of tile rows at a time: once to build the palettes and
+// once more to index the pixels. The output is the same as for the whole RGBA32 image.
+//
+// lodepng inflates the whole png in one go, so the decoded image still has to fit.
+// -pack_palettes and 2x2 attributes change colors across the whole image and need
+// all of it in RGBA32, so do pngs which need more than -max_palettes.
+//
+#define PNG_STREAM_MIN_PIXELS (2048 * 2048)
+
+// Converts the rows y to y + band.h of a png decoded in its own color format to RGBA32 in band
+static bool GetRowsRGBA32(const vector< unsigned char >& raw, const LodePNGColorMode& mode, unsigned int y, PNGImage& band)
+{
+	// The width is a multiple of 8 pixels, so every row starts on a byte
+	size_t row_bytes = ((size_t)band.w * lodepng_get_bpp(&mode)) / 8;
+	LodePNGColorMode rgba = lodepng_color_mode_make(LCT_RGBA, 8);
+
+	band.data.resize((size_t)band.w * band.h * RGBA32_SZ);
+	unsigned error = lodepng_convert(band.data.data(), &raw[row_bytes * y], &rgba, &mode, band.w, band.h);
+	if(error)
+		printf("decoder error %s\n", lodepng_error_text(error));
+	return error == 0;
+}
+
+static int* BuildPalettesAndAttributesStreamed(const PNGImage& image32, const vector< unsigned char >& raw, const LodePNGColorMode& mode,
+                                                vector< SetPal >& palettes, bool half_resolution)
+{
+	int* palettes_per_tile = new int[(image32.w / image32.tile_w) * (image32.h / image32.tile_h)];
+	PNGImage band;
+	band.w = image32.w;
+	band.tile_w = image32.tile_w;
+	band.tile_h = image32.tile_h;
+	band.colors_per_pal = image32.colors_per_pal;
+
+	unsigned int band_h = image32.tile_h * (half_resolution ? 2 : 1);
+	for(unsigned int y = 0; y < image32.h; y += band_h)
+	{
+		band.h = min(band_h, image32.h - y);
+		if(!GetRowsRGBA32(raw, mode, y, band))
+		{
+			delete[] palettes_per_tile;
+			return nullptr;
+		}
+		BuildPalettesAndAttributesRows(band, y, palettes, half_resolution, palettes_per_tile);
+	}
 	return palettes_per_tile;
 }
 
+static bool IndexImagePixelsStreamed(const PNGImage& image32, const vector< unsigned char >& raw, const LodePNGColorMode& mode,
+                                     const vector< SetPal >& palettes, const int* palettes_per_tile, vector< unsigned char >& out)
+{
+	PNGImage band;
+	band.w = image32.w;
+	band.tile_w = image32.tile_w;
+	band.tile_h = image32.tile_h;
+
+	size_t tiles_w = image32.w / image32.tile_w;
+	out.reserve(out.size() + (size_t)image32.w * image32.h);
+	for(unsigned int y = 0; y < image32.h; y += image32.tile_h)
+	{
+		band.h = image32.tile_h;
+		if(!GetRowsRGBA32(raw, mode, y, band))
+			return false;
+		IndexImagePixels(band, palettes, palettes_per_tile + (y / image32.tile_h) * tiles_w, out);
+	}
+	return true;
+}
+
+//
+// Palette packing (-pack_palettes, and automatically when the first fit above needs too many palettes)
+//
+// FindOrCreateSubPalette() puts each tile into the first palette it fits, so the tile
+// order decides how many palettes get used. This packs the distinct tile color sets
+// again with a bounded backtracking search for the fewest palettes. If that still needs
+// more than max_palettes, the two closest colors get merged (the less used one is
+// replaced in the image) and the sets are packed again, until they fit.
+//
+
+#define PALETTE_PACK_SEARCH_NODES 200000
+
+struct PaletteImage
+{
+	PNGImage* image32;
+	int* palettes_per_tile;
+};
+
+struct PalettePacker
+{
+	const vector< SetPal >& sets; // Largest first
+	size_t colors_per_pal;
+	size_t nodes_left;
+	vector< SetPal > cur, best;
+
+	PalettePacker(const vector< SetPal >& sets_in, size_t colors_per_pal_in) :
+		sets(sets_in), colors_per_pal(colors_per_pal_in), nodes_left(PALETTE_PACK_SEARCH_NODES) {}
+
+	void Search(size_t i)
+	{
+		if(i == sets.size())
+		{
+			if(best.empty() || (cur.size() < best.size()))
+				best = cur;
+			return;
+		}
+		if(nodes_left == 0)
+			return;
+		nodes_left--;
+
+		// Try the palettes which need the fewest new colors first
+		vector< pair< size_t, size_t > > fits; // (new colors, palette)
+		for(size_t p = 0; p < cur.size(); ++p)
+		{
+			SetPal merged(cur[p]);
+			merged.insert(sets[i].begin(), sets[i].end());
+			if(merged.size() <= colors_per_pal)
+				fits.push_back(make_pair(merged.size() - cur[p].size(), p));
+		}
+		sort(fits.begin(), fits.end());
+
+		for(size_t f = 0; f < fits.size(); ++f)
+		{
+			SetPal saved(cur[fits[f].second]);
+			cur[fits[f].second].insert(sets[i].begin(), sets[i].end());
+			Search(i + 1);
+			cur[fits[f].second] = saved;
+			// Already in a palette: no other choice can be better
+			if(fits[f].first == 0)
+				return;
+		}
+
+		// A new palette, if that can still beat the best so far
+		if(best.empty() || (cur.size() + 1 < best.size()))
+		{
+			cur.push_back(sets[i]);
+			Search(i + 1);
+			cur.pop_back();
+		}
+	}
+};
+
+static unsigned int RemapColor(const unordered_map< unsigned int, unsigned int >& remap, unsigned int color)
+{
+	unordered_map< unsigned int, unsigned int >::const_iterator it;
+	while((it = remap.find(color)) != remap.end())
+		color = it->second;
+	return color;
+}
+
+static SetPal RemapSet(const unordered_map< unsigned int, unsigned int >& remap, const SetPal& pal)
+{
+	SetPal ret;
+	for(SetPal::const_iterator it = pal.begin(); it != pal.end(); ++it)
+		ret.insert(RemapColor(remap, *it));
+	return ret;
+}
+
+// Fewest palettes found for the distinct sets in block_sets
+static vector< SetPal > PackPaletteSets(const vector< SetPal >& block_sets, size_t colors_per_pal)
+{
+	// Sets contained in another one go wherever that one goes
+	vector< SetPal > sets;
+	set< SetPal > distinct(block_sets.begin(), block_sets.end());
+	for(set< SetPal >::const_iterator it = distinct.begin(); it != distinct.end(); ++it)
+	{
+		if(it->size() > colors_per_pal)
+			continue; // Already reported by BuildPalettesAndAttributes()
+		bool contained = false;
+		for(set< SetPal >::const_iterator other = distinct.begin(); other != distinct.end() && !contained; ++other)
+			contained = (other != it) && (other->size() <= colors_per_pal) && (other->size() > it->size()) &&
+			            includes(other->begin(), other->end(), it->begin(), it->end(), CmpIntColor());
+		if(!contained)
+			sets.push_back(*it);
+	}
+	stable_sort(sets.begin(), sets.end(), [](const SetPal& a, const SetPal& b) { return a.size() > b.size(); });
+
+	PalettePacker packer(sets, colors_per_pal);
+	packer.Search(0);
+	return packer.best;
+}
+
+// Replaces palettes and the palettes_per_tile of each image with a tighter packing
+void PackPalettes(vector< PaletteImage >& images, vector< SetPal >& palettes, bool half_resolution, size_t max_palettes)
+{
+	if(images.empty())
+		return;
+
+	size_t colors_per_pal = images[0].image32->colors_per_pal;
+	int sx = half_resolution ? 2 : 1;
+	int sy = half_resolution ? 2 : 1;
+	vector< SetPal > block_sets;
+	unordered_map< unsigned int, size_t > color_use;
+
+	// Same blocks as BuildPalettesAndAttributes()
+	for(size_t i = 0; i < images.size(); ++i)
+	{
+		const PNGImage& image32 = *images[i].image32;
+		for(unsigned int y = 0; y < image32.h; y += image32.tile_h * sy)
+			for(unsigned int x = 0; x < image32.w; x += image32.tile_w * sx)
+			{
+				block_sets.push_back(GetPaletteColors(image32, x, y, sx * image32.tile_w, sy * image32.tile_h));
+				if(use_shared_background)
+					block_sets.back().insert(shared_background_color);
+			}
+		for(size_t p = 0; p < image32.data.size(); p += RGBA32_SZ)
+			color_use[GetColorInt(&image32.data[p])]++;
+	}
+
+	vector< SetPal > packed = PackPaletteSets(block_sets, colors_per_pal);
+	if(packed.empty() || (packed.size() >= palettes.size() && palettes.size() <= max_palettes))
+		return; // First fit was as good
+
+	// Merge the closest two opaque colors until the sets fit
+	unordered_map< unsigned int, unsigned int > remap;
+	while(packed.size() > max_palettes)
+	{
+		set< unsigned int > colors;
+		for(size_t b = 0; b < block_sets.size(); ++b)
+			for(SetPal::const_iterator it = block_sets[b].begin(); it != block_sets[b].end(); ++it)
+				if((*it & 0xFF) == 0xFF)
+					colors.insert(RemapColor(remap, *it));
+
+		unsigned int from = 0, to = 0;
+		int best_dist = -1;
+		for(set< unsigned int >::const_iterator a = colors.begin(); a != colors.end(); ++a)
+		{
+			for(set< unsigned int >::const_iterator b = next(a); b != colors.end(); ++b)
+			{
+				int dr = (int)(*a >> 24) - (int)(*b >> 24);
+				int dg = (int)((*a >> 16) & 0xFF) - (int)((*b >> 16) & 0xFF);
+				int db = (int)((*a >> 8) & 0xFF) - (int)((*b >> 8) & 0xFF);
+				int dist = 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+				if((best_dist < 0) || (dist < best_dist))
+				{
+					best_dist = dist;
+					bool a_more_used = color_use[*a] >= color_use[*b];
+					from = a_more_used ? *b : *a;
+					to   = a_more_used ? *a : *b;
+				}
+			}
+		}
+		if(best_dist < 0)
+			break; // Nothing left to merge
+
+		printf("Warning: merging color #%06X into #%06X to fit %d palettes (-max_palettes)\n", from >> 8, to >> 8, (unsigned int)max_palettes);
+		remap[from] = to;
+		color_use[to] += color_use[from];
+
+		vector< SetPal > remapped;
+		for(size_t b = 0; b < block_sets.size(); ++b)
+			remapped.push_back(RemapSet(remap, block_sets[b]));
+		packed = PackPaletteSets(remapped, colors_per_pal);
+		if(packed.empty())
+			return;
+	}
+
+	printf("Packed palettes: %d (first fit: %d)\n", (unsigned int)packed.size(), (unsigned int)palettes.size());
+	palettes = packed;
+
+	// Write merged colors back and point each block at a palette with all of its colors
+	size_t b = 0;
+	for(size_t i = 0; i < images.size(); ++i)
+	{
+		PNGImage& image32 = *images[i].image32;
+		if(!remap.empty())
+		{
+			for(size_t p = 0; p < image32.data.size(); p += RGBA32_SZ)
+			{
+				unsigned int color = RemapColor(remap, GetColorInt(&image32.data[p]));
+				image32.data[p]     = (unsigned char)(color >> 24);
+				image32.data[p + 1] = (unsigned char)(color >> 16);
+				image32.data[p + 2] = (unsigned char)(color >> 8);
+				image32.data[p + 3] = (unsigned char)color;
+			}
+		}
+
+		int w = (image32.w / image32.tile_w);
+		for(unsigned int y = 0; y < image32.h; y += image32.tile_h * sy)
+		{
+			for(unsigned int x = 0; x < image32.w; x += image32.tile_w * sx, ++b)
+			{
+				SetPal pal = RemapSet(remap, block_sets[b]);
+				int subPalIndex = 0;
+				for(size_t p = 0; p < palettes.size(); ++p)
+				{
+					if(includes(palettes[p].begin(), palettes[p].end(), pal.begin(), pal.end(), CmpIntColor()))
+					{
+						subPalIndex = (int)p;
+						break;
+					}
+				}
+				int dx = x / image32.tile_w;
+				int dy = y / image32.tile_h;
+				for(int yy = 0; yy < sy; yy++)
+					for(int xx = 0; xx < sx; xx++)
+						images[i].palettes_per_tile[(dy + yy) * w + dx + xx] = subPalIndex;
+			}
+		}
+	}
+}
+
+//
+// NES background palettes all share color 0, the universal background color.
+// The color found in most 16x16 attribute blocks (or the most common
+// transparent color if there is one) is used for it. It is made transparent
+// so that it sorts first in SetPal, and BuildPalettesAndAttributes() /
+// PackPalettes() add it to every block, so the blocks are packed into
+// palettes of 3 colors plus the shared one.
+//
+void SetSharedBackgroundColor(vector< PNGImage* >& images)
+{
+	unordered_map< unsigned int, size_t > blocks, pixels;
+	for(size_t i = 0; i < images.size(); ++i)
+	{
+		const PNGImage& image32 = *images[i];
+		for(unsigned int y = 0; y < image32.h; y += image32.tile_h * 2)
+		{
+			for(unsigned int x = 0; x < image32.w; x += image32.tile_w * 2)
+			{
+				SetPal pal = GetPaletteColors(image32, x, y, 2 * image32.tile_w, 2 * image32.tile_h);
+				for(SetPal::const_iterator it = pal.begin(); it != pal.end(); ++it)
+					blocks[*it]++;
+			}
+		}
+		for(size_t p = 0; p < image32.data.size(); p += RGBA32_SZ)
+			pixels[GetColorInt(&image32.data[p])]++;
+	}
+
+	// Transparent first, then in the most blocks, then the most pixels
+	if(blocks.empty())
+		return;
+	auto rank = [&](unsigned int c) { return make_tuple((c & 0xFF) != 0xFF, blocks[c], pixels[c], ~c); };
+	unsigned int color = blocks.begin()->first;
+	for(unordered_map< unsigned int, size_t >::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+		if(rank(it->first) > rank(color))
+			color = it->first;
+	bool found_transparent = (color & 0xFF) != 0xFF;
+
+	shared_background_color = color & 0xFFFFFF00;
+	use_shared_background = true;
+	if(!found_transparent)
+		printf("Using color #%06X as the shared background color\n", color >> 8);
+
+	for(size_t i = 0; i < images.size(); ++i)
+	{
+		PNGImage& image32 = *images[i];
+		for(size_t p = 0; p < image32.data.size(); p += RGBA32_SZ)
+			if(GetColorInt(&image32.data[p]) == color)
+				image32.data[p + 3] = 0;
+	}
+}
+
 unsigned char GetMapAttribute(size_t x, size_t y)
 {
 	if (x < map_attributes_width && y < map_attributes_height)
@@ -521,6 +1883,37 @@ void PackMapAttributes()
 	map_attributes = map_attributes_packed;
 }
 
+//
+// Splits the packed NES attributes into the 64 byte attribute table of each
+// 32x30 tile screen (left to right, then top to bottom), the layout of
+// _attribute_shadow and of PPU memory at 0x23C0. AlignMapAttributes() already
+// made each screen 8 packed rows high.
+//
+#define NES_ATTRIBUTE_TABLE_W 8
+#define NES_ATTRIBUTE_TABLE_H 8
+
+size_t nes_attribute_tables_width()
+{
+	return (map_attributes_packed_width + NES_ATTRIBUTE_TABLE_W - 1) / NES_ATTRIBUTE_TABLE_W;
+}
+
+size_t nes_attribute_tables_height()
+{
+	return (map_attributes_packed_height + NES_ATTRIBUTE_TABLE_H - 1) / NES_ATTRIBUTE_TABLE_H;
+}
+
+vector< unsigned char > GetNesAttributeTables()
+{
+	vector< unsigned char > tables;
+	for(size_t sy = 0; sy < nes_attribute_tables_height(); ++sy)
+		for(size_t sx = 0; sx < nes_attribute_tables_width(); ++sx)
+			for(size_t y = sy * NES_ATTRIBUTE_TABLE_H; y < (sy + 1) * NES_ATTRIBUTE_TABLE_H; ++y)
+				for(size_t x = sx * NES_ATTRIBUTE_TABLE_W; x < (sx + 1) * NES_ATTRIBUTE_TABLE_W; ++x)
+					tables.push_back(((x < map_attributes_packed_width) && (y < map_attributes_packed_height)) ?
+					                 map_attributes[y * map_attributes_packed_width + x] : 0);
+	return tables;
+}
+
 bool GetSourceTileset(bool repair_indexed_pal, bool keep_palette_order, unsigned int max_palettes, vector< SetPal >& palettes) {
 
 	lodepng::State sourceTilesetState;
@@ -592,7 +1985,7 @@ bool GetSourceTileset(bool repair_indexed_pal, bool keep_palette_order, unsigned
 		unsigned int palette_count = PaletteCountApplyMaxLimit(max_palettes, palettes.size());
 
 		source_tileset_image.total_color_count = palette_count * source_tileset_image.colors_per_pal;
-		source_tileset_image.palette = new unsigned char[palette_count * source_tileset_image.colors_per_pal * RGBA32_SZ]; //colors_per_pal colors * 4 bytes each
+		source_tileset_image.palette = new unsigned char[palette_count * source_tileset_image.colors_per_pal * RGBA32_SZ](); //colors_per_pal colors * 4 bytes each
 		source_total_color_count = source_tileset_image.total_color_count;
 
 		for (size_t p = 0; p < palette_count; ++p)
@@ -608,17 +2001,7 @@ bool GetSourceTileset(bool repair_indexed_pal, bool keep_palette_order, unsigned
 			}
 		}
 
-		for (size_t y = 0; y < image32.h; ++y)
-		{
-			for (size_t x = 0; x < image32.w; ++x)
-			{
-				unsigned char* c32ptr = &image32.data[(image32.w * y + x) * RGBA32_SZ];
-				int color32 = (c32ptr[0] << 24) | (c32ptr[1] << 16) | (c32ptr[2] << 8) | c32ptr[3];
-				unsigned char palette = palettes_per_tile[(y / image32.tile_h) * (image32.w / image32.tile_w) + (x / image32.tile_w)];
-				unsigned char index = std::distance(palettes[palette].begin(), palettes[palette].find(color32));
-				source_tileset_image.data.push_back((palette << bpp) + index);
-			}
-		}
+		IndexImagePixels(image32, palettes, palettes_per_tile, source_tileset_image.data);
 	}
 
 	// We'll change the image variable
@@ -631,6 +2014,7 @@ bool GetSourceTileset(bool repair_indexed_pal, bool keep_palette_order, unsigned
 	// Our source tileset shouldn't build the map arrays up
 	// Clear anything from the previous 'GetMap' call
 	map.clear();
+	map_tile_ids.clear();
 	map_attributes.clear();
 	use_source_tileset = true;
 
@@ -647,6 +2031,17 @@ bool GetSourceTileset(bool repair_indexed_pal, bool keep_palette_order, unsigned
 }
 
 
+// Maps the 2bpp colors of the tiles to 4bpp colors, so SMS/GG tiles don't
+// need the conversion of set_bkg_data() / set_tile_2bpp_data() when loading
+static void ExpandTiles4bpp()
+{
+	for(size_t t = expanded_tile_count; t < tiles.size(); ++t)
+		for(size_t i = 0; i < tiles[t].data.size(); ++i)
+			tiles[t].data[i] = expand_4bpp_colors[tiles[t].data[i] & 0x03];
+	expanded_tile_count = tiles.size();
+	bpp = 4;
+}
+
 void Export(const PNGImage& image, const char* path)
 {
 	lodepng::State state;
@@ -668,7 +2063,357 @@ void Export(const PNGImage& image, const char* path)
 	lodepng::save_file(buffer, path);
 }
 
+// Sets the .c / .h / .bin file names and the data name from the .c file name
+void SetOutputFilename(const string& filename)
+{
+	output_filename = filename;
+
+	int slash_pos = (int)output_filename.find_last_of('/');
+	if(slash_pos == -1)
+		slash_pos = (int)output_filename.find_last_of('\\');
+	int dot_pos = (int)output_filename.find_first_of('.', slash_pos == -1 ? 0 : slash_pos);
+
+	output_filename_h = output_filename.substr(0, dot_pos) + ".h";
+	output_filename_bin = output_filename.substr(0, dot_pos) + "_map.bin";
+	output_filename_attributes_bin = output_filename.substr(0, dot_pos) + "_map_attributes.bin";
+	output_filename_tiles_bin = output_filename.substr(0, dot_pos) + "_tiles.bin";
+	output_filename_tiles_bank1_bin = output_filename.substr(0, dot_pos) + "_tiles_bank1.bin";
+	output_filename_asm = output_filename.substr(0, dot_pos) + ".s";
+	output_filename_chr = output_filename.substr(0, dot_pos) + ".chr";
+	output_filename_packed_bin = output_filename.substr(0, dot_pos) + "_packed.bin";
+	data_name = output_filename.substr(slash_pos + 1, dot_pos - 1 - slash_pos);
+	replace(data_name.begin(), data_name.end(), '-', '_');
+}
+
+// Opens an output file and records it for -deps and -skip_if_unchanged
+FILE* OpenOutput(const string& filename, const char* mode)
+{
+	output_files.push_back(filename);
+	return fopen(filename.c_str(), mode);
+}
+
+// The -c file of the shared tiles and palettes in -batch mode
+static string BatchTilesetFilename(const char* first_file)
+{
+	if(output_filename_set)
+		return output_filename;
+	return string(first_file).substr(0, strlen(first_file) - 4) + "_tileset.c";
+}
+
+struct BatchImage
+{
+	PNGImage image32;
+	unsigned error = 0;
+	int* palettes_per_tile = nullptr;
+};
+
+// -batch: converts all images with one shared tileset and set of palettes.
+// Decoding and indexing of the images run in parallel, the palettes and
+// the tileset are built in command line order so the output is the same
+// every run. Each image gets a file with its map or metasprites, the
+// tiles and palettes go to the -c file.
+int ExportBatch(const char* first_file)
+{
+	if(keep_palette_order || use_source_tileset || output_binary || use_structs || export_anim_diffs || !includeTileData || !includedMapOrMetaspriteData)
+	{
+		printf("-batch can't be used with -keep_palette_order, -source_tileset, -bin, -use_structs, -anim_diffs, -tiles_only, -maps_only or -metasprites_only\n");
+		return 1;
+	}
+
+	vector< string > files;
+	files.push_back(first_file);
+	files.insert(files.end(), batch_files.begin(), batch_files.end());
+
+	string tileset_filename = BatchTilesetFilename(first_file);
+	int slash_pos = (int)tileset_filename.find_last_of("/\\");
+	string output_dir = tileset_filename.substr(0, slash_pos + 1);
+
+	vector< BatchImage > images(files.size());
+	ParallelFor(files.size(), [&](size_t i) {
+		vector< unsigned char > buffer;
+		lodepng::State state;
+		lodepng::load_file(buffer, files[i]);
+		images[i].image32.colors_per_pal = image.colors_per_pal;
+		images[i].image32.tile_w = image.tile_w;
+		images[i].image32.tile_h = image.tile_h;
+		images[i].error = lodepng::decode(images[i].image32.data, images[i].image32.w, images[i].image32.h, state, buffer); //decode as 32 bit
+	});
+
+	vector< SetPal > palettes;
+	for(size_t i = 0; i < files.size(); ++i)
+	{
+		PNGImage& image32 = images[i].image32;
+		if(images[i].error)
+		{
+			printf("%s: decoder error %s\n", files[i].c_str(), lodepng_error_text(images[i].error));
+			return 1;
+		}
+		if( ((image32.w % image32.tile_w) != 0) || ((image32.h % image32.tile_h) != 0) )
+		{
+			printf("%s: Error: Image size %d x %d isn't an even multiple of tile size %d x %d\n", files[i].c_str(), image32.w, image32.h, image32.tile_w, image32.tile_h);
+			return 1;
+		}
+	}
+	if(use_2x2_map_attributes)
+	{
+		vector< PNGImage* > shared_images;
+		for(size_t i = 0; i < files.size(); ++i)
+			shared_images.push_back(&images[i].image32);
+		SetSharedBackgroundColor(shared_images);
+	}
+	for(size_t i = 0; i < files.size(); ++i)
+		images[i].palettes_per_tile = BuildPalettesAndAttributes(images[i].image32, palettes, use_2x2_map_attributes);
+
+	if(pack_palettes || use_2x2_map_attributes || (palettes.size() > max_palettes))
+	{
+		vector< PaletteImage > pack_images;
+		for(size_t i = 0; i < files.size(); ++i)
+			pack_images.push_back(PaletteImage{ &images[i].image32, images[i].palettes_per_tile });
+		PackPalettes(pack_images, palettes, use_2x2_map_attributes, max_palettes);
+	}
+
+	unsigned int palette_count = PaletteCountApplyMaxLimit(max_palettes, palettes.size());
+	image.total_color_count = palette_count * image.colors_per_pal;
+	image.palette = new unsigned char[palette_count * image.colors_per_pal * RGBA32_SZ](); // total color count * 4 bytes each
+	for(size_t p = 0; p < palette_count; ++p)
+	{
+		int *color_ptr = (int*)&image.palette[p * image.colors_per_pal * RGBA32_SZ];
+		for(SetPal::iterator it = palettes[p].begin(); it != palettes[p].end(); ++ it, color_ptr ++)
+		{
+			unsigned char* c = (unsigned char*)&(*it);
+			*color_ptr = (c[0] << 24) | (c[1] << 16) | (c[2] << 8) | c[3];
+		}
+	}
+
+	// Colors are only looked up in the final palettes, which later images may have added colors to
+	vector< vector< unsigned char > > indexed(files.size());
+	ParallelFor(files.size(), [&](size_t i) {
+		IndexImagePixels(images[i].image32, palettes, images[i].palettes_per_tile, indexed[i]);
+	});
+
+	int option_sprite_w = sprite_w, option_sprite_h = sprite_h;
+	int option_pivot_x = pivot_x, option_pivot_y = pivot_y, option_pivot_w = pivot_w, option_pivot_h = pivot_h;
+	bool option_include_palettes = include_palettes;
+	for(size_t i = 0; i < files.size(); ++i)
+	{
+		image.data = indexed[i];
+		image.w = images[i].image32.w;
+		image.h = images[i].image32.h;
+
+		sprite_w = option_sprite_w ? option_sprite_w : (int)image.w;
+		sprite_h = option_sprite_h ? option_sprite_h : (int)image.h;
+		pivot_x = (option_pivot_x == 0xFFFFFF) ? sprite_w / 2 : option_pivot_x;
+		pivot_y = (option_pivot_y == 0xFFFFFF) ? sprite_h / 2 : option_pivot_y;
+		pivot_w = (option_pivot_w == 0xFFFFFF) ? sprite_w : option_pivot_w;
+		pivot_h = (option_pivot_h == 0xFFFFFF) ? sprite_h : option_pivot_h;
+
+		map.clear();
+		map_tile_ids.clear();
+		map_attributes.clear();
+		metatiles.clear();
+		metatile_attributes.clear();
+		metatile_map.clear();
+		sprites.clear();
+
+		if(export_as_map)
+		{
+			GetMap();
+			if(cgb_vram_banks()) PlaceTilesInVramBanks();
+			if(metatile_size && !GetMetatiles()) return 1;
+		}
+		else
+		{
+			for(int y = 0; y < (int)image.h; y += sprite_h)
+			{
+				for(int x = 0; x < (int)image.w; x += sprite_w)
+				{
+					GetMetaSprite(x, y, sprite_w, sprite_h, pivot_x, pivot_y);
+				}
+			}
+			if((report_sprite_lines || max_sprites_per_line) && !CheckSpriteLines(files[i])) return 1;
+		}
+		map_attributes_width = image.w / 8;
+		map_attributes_height = image.h / 8;
+		if(use_2x2_map_attributes)
+			ReduceMapAttributes2x2(palettes);
+		if(pack_map_attributes)
+		{
+			AlignMapAttributes();
+			PackMapAttributes();
+		}
+		else
+		{
+			map_attributes_packed_width = map_attributes_width;
+			map_attributes_packed_height = map_attributes_height;
+		}
+		if(map_chunk_w)
+			ChunkMap();
+
+		int file_slash_pos = (int)files[i].find_last_of("/\\");
+		string name = files[i].substr(file_slash_pos + 1);
+		SetOutputFilename(output_dir + name.substr(0, name.size() - 4) + ".c");
+		includeTileData = false;
+		include_palettes = false;
+		if(!export_h_file() || !export_c_file()) return 1;
+	}
+
+	// The shared tiles and palettes
+	if(expand_4bpp)
+		ExpandTiles4bpp();
+	SetOutputFilename(tileset_filename);
+	includeTileData = true;
+	include_palettes = option_include_palettes;
+	includedMapOrMetaspriteData = false;
+	if(!export_h_file() || !export_c_file()) return 1;
+
+	printf("Converted %d images with %d shared tiles and %d palettes\n", (unsigned int)files.size(), (unsigned int)tiles.size(), palette_count);
+	return 0;
+}
+
+// -deps and -skip_if_unchanged: the input files of the conversion
+static vector< string > InputFiles(const char* png_file)
+{
+	vector< string > inputs;
+	inputs.push_back(png_file);
+	if(use_source_tileset)       inputs.push_back(source_tileset);
+	if(collision_map_file.size()) inputs.push_back(collision_map_file);
+	if(spawn_map_file.size())     inputs.push_back(spawn_map_file);
+	if(anim_seq_file.size())      inputs.push_back(anim_seq_file);
+	inputs.insert(inputs.end(), batch_files.begin(), batch_files.end());
+	return inputs;
+}
+
+// The .d and .stamp files go next to the .h file of the -c file (or of the -batch tileset file)
+static string DependencyFilename(const string& filename, const char* ext)
+{
+	int slash_pos = (int)filename.find_last_of("/\\");
+	int dot_pos = (int)filename.find_first_of('.', slash_pos == -1 ? 0 : slash_pos);
+	return filename.substr(0, dot_pos) + ext;
+}
+
+static inline void HashBytes(uint64_t& hash, const unsigned char* data, size_t size)
+{
+	// FNV-1a
+	for(size_t c = 0; c < size; ++c)
+		hash = (hash ^ data[c]) * 0x100000001b3ull;
+}
+
+// Hash of the contents of the input files, the options and the build of png2asset,
+// so a different png2asset converts again. Returns false if an input can't be read
+static bool HashInputs(int argc, char* argv[], string& hash_str)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	const char* build = __DATE__ " " __TIME__;
+
+	HashBytes(hash, (const unsigned char*)build, strlen(build));
+	for(int i = 2; i < argc; ++i)
+		HashBytes(hash, (const unsigned char*)argv[i], strlen(argv[i]) + 1);
+
+	vector< string > inputs = InputFiles(argv[1]);
+	for(size_t i = 0; i < inputs.size(); ++i)
+	{
+		vector< unsigned char > buffer;
+		if(lodepng::load_file(buffer, inputs[i]))
+			return false;
+		HashBytes(hash, (const unsigned char*)inputs[i].c_str(), inputs[i].size() + 1);
+		HashBytes(hash, buffer.data(), buffer.size());
+	}
+
+	char str[17];
+	snprintf(str, sizeof(str), "%016llx", (unsigned long long)hash);
+	hash_str = str;
+	return true;
+}
+
+// The stamp has the hash on the first line, then the files which were written.
+// The outputs are up to date if the hash is the same and they all still exist
+static bool StampUnchanged(const string& stamp_filename, const string& hash_str)
+{
+	ifstream stamp(stamp_filename);
+	string line;
+
+	if(!getline(stamp, line) || (line != hash_str))
+		return false;
+	while(getline(stamp, line))
+	{
+		ifstream output(line);
+		if(!output)
+			return false;
+	}
+	return true;
+}
+
+static bool WriteStamp(const string& stamp_filename, const string& hash_str)
+{
+	FILE* file = fopen(stamp_filename.c_str(), "w");
+	if(!file) {
+		printf("Error writing file: %s", stamp_filename.c_str());
+		return false;
+	}
+	fprintf(file, "%s\n", hash_str.c_str());
+	for(size_t i = 0; i < output_files.size(); ++i)
+		fprintf(file, "%s\n", output_files[i].c_str());
+	fclose(file);
+	return true;
+}
+
+// Make escapes spaces in file names with a backslash and $ as $$
+static string MakeEscape(const string& filename)
+{
+	string out;
+	for(size_t c = 0; c < filename.size(); ++c)
+	{
+		if(filename[c] == ' ')      out += "\\ ";
+		else if(filename[c] == '$') out += "$$";
+		else                        out += filename[c];
+	}
+	return out;
+}
+
+// Writes a make rule with every output depending on every input, and an empty
+// rule for each input so make doesn't fail when one is removed (like gcc -MP)
+static bool WriteDepFile(const string& dep_filename, const char* png_file)
+{
+	vector< string > inputs = InputFiles(png_file);
+	set< string > written;
+
+	FILE* file = fopen(dep_filename.c_str(), "w");
+	if(!file) {
+		printf("Error writing file: %s", dep_filename.c_str());
+		return false;
+	}
+	for(size_t i = 0; i < output_files.size(); ++i)
+		if(written.insert(output_files[i]).second)
+			fprintf(file, "%s ", MakeEscape(output_files[i]).c_str());
+	fprintf(file, ":");
+	for(size_t i = 0; i < inputs.size(); ++i)
+		fprintf(file, " %s", MakeEscape(inputs[i]).c_str());
+	fprintf(file, "\n");
+	for(size_t i = 0; i < inputs.size(); ++i)
+		fprintf(file, "\n%s:\n", MakeEscape(inputs[i]).c_str());
+	fclose(file);
+	return true;
+}
+
+static int Convert(int argc, char* argv[]);
+
 int main(int argc, char* argv[])
+{
+	int result = Convert(argc, argv);
+	if((result != 0) || output_files.empty())
+		return result;
+
+	string primary_filename = batch_files.size() ? BatchTilesetFilename(argv[1]) : output_filename;
+	string hash_str;
+	if(write_dep_file && !WriteDepFile(DependencyFilename(primary_filename, ".d"), argv[1]))
+		return 1;
+	if(skip_if_unchanged && HashInputs(argc, argv, hash_str) &&
+	   !WriteStamp(DependencyFilename(primary_filename, ".stamp"), hash_str))
+		return 1;
+	return 0;
+}
+
+static int Convert(int argc, char* argv[])
 {
 	if (argc < 2)
 	{
@@ -692,22 +2437,69 @@ int main(int argc, char* argv[])
 		printf("-use_map_attributes Use CGB BG Map attributes\n");
 		printf("-use_nes_attributes Use NES BG Map attributes\n");
 		printf("-use_nes_colors     Convert RGB color values to NES PPU colors\n");
+		printf("-nes_attribute_tables  also export the NES attributes as the 64 byte attribute table of each screen (_attribute_tables)\n");
+		printf("-chr_rom            write the tiles as 4K NES CHR-ROM pattern tables (.chr file, for makebin -c) instead of _tiles,\n");
+		printf("                    the first tile at -tile_origin, padded to whole pattern tables of 256 tiles\n");
 		printf("-use_structs        Group the exported info into structs (default: false) (used by ZGB Game Engine)\n");
 		printf("-bpp                bits per pixel: 1, 2, 4 (default: 2)\n");
 		printf("-max_palettes       max number of palettes allowed (default: 8)\n");
 		printf("                    (note: max colors = max_palettes x num colors per palette)\n");
+		printf("-pack_palettes      search for the fewest palettes instead of using the first one each tile fits\n");
+		printf("                    (automatic when over -max_palettes, merges the closest colors if still over)\n");
 		printf("-pack_mode          gb, sgb, sms, 1bpp (default: gb)\n");
 		printf("-tile_origin        tile index offset for maps (default: 0)\n");
 
 		printf("-tiles_only         export tile data only\n");
 		printf("-maps_only          export map tilemap only\n");
 		printf("-metasprites_only   export metasprite descriptors only\n");
+		printf("-metasprite_flips   also export pre-flipped metasprites (_flipx, _flipy, _flipxy)\n");
+		printf("-sprite_trim        place the tiles of each frame on the grid offset which needs the fewest hardware sprites\n");
+		printf("-sprite_pairs       8x16 sprites: split each 8 pixel column of a frame into sprites at the 8 pixel rows which\n");
+		printf("                    need the fewest sprites, then the fewest new tiles\n");
+		printf("-sprite_lines       print the most hardware sprites on one line of each frame\n");
+		printf("-max_sprites_per_line <n>  fail if a frame has more than n hardware sprites on one line (GB shows 10, SMS/GG/NES 8)\n");
+		printf("-oam_frames         also export the frames as precomputed OAM blocks for copy_oam_frame() (_oam_frames)\n");
+		printf("-metasprite_bounds  also export the box around the sprites of each frame for move_metasprite_clip() (_metasprite_bounds)\n");
+		printf("-anim_diffs         export the tiles as per frame changes for anim_apply_frame() (_anim_init, _anim_frames) instead of _tiles\n");
+		printf("-anim_seq <file>    also export the animation sequences of a text file for anim_play() (_anim_seqs), one per line:\n");
+		printf("                    <name> <loop|once> <frame>[:<ticks>][@<event>] ... (ticks default to 1, 0 holds the frame)\n");
+		printf("-metatiles <size>   export map as 2x2 or 4x4 tile metatiles (_metatiles + _metatile_map) instead of _map\n");
+		printf("-tile_usage <w> <h> also export the tiles used by each region of w x h tiles (_tile_usage, _tile_usage_offsets)\n");
+		printf("                    and the map as tileset indexes (_map_ids) for tile_cache_prefetch() / tile_cache_request()\n");
+		printf("-map_chunks <w> <h> export the map as chunks of w x h tiles, each chunk row by row, padded to full chunks\n");
+		printf("                    with 0 (compress them separately with gbcompress --blocks=<_MAP_CHUNK_SIZE>)\n");
+		printf("-collision_map <png> <bits>  also export a flag value for each map tile, packed 1 or 2 bits per tile (_collision)\n");
+		printf("                    for tile_flags_at(): the palette index of an indexed png with one pixel per tile,\n");
+		printf("                    or of the top left pixel of each tile in a png the size of the map\n");
+		printf("-spawn_map <png>    also export the objects placed on the map, sorted by X, for spawn_window_update() (_spawns,\n");
+		printf("                    _spawn_buckets, _spawn_list): each palette index but 0 of a png like the -collision_map one is a type\n");
+		printf("-sgb_border         export a 256x224 SGB border as CHR_TRN blocks (_chr_trn_0, _chr_trn_1) and PCT_TRN data (_pct_trn)\n");
+		printf("                    for sgb_vram_transfer() (implies -map -bpp 4 -max_palettes 4 -pack_mode sgb -use_map_attributes)\n");
+		printf("-vwf_font [first]   export 8x8 cells as 1bpp variable width glyphs (_vwf_glyphs, _vwf_widths) for gb/vwf.h,\n");
+		printf("                    the first cell is character first (default: 32), the others follow left to right, top to bottom\n");
+		printf("-expand_4bpp <c0> <c1> <c2> <c3>  export 2bpp tiles as SMS/GG 4bpp tiles using colors c0-c3 (0-15)\n");
+		printf("                    for set_native_tile_data() instead of set_bkg_data() (implies -pack_mode sms)\n");
 		printf("-source_tileset     use source tileset (image with common tiles)\n");
 		printf("-keep_duplicate_tiles   do not remove duplicate tiles (default: not enabled)\n");
+		printf("-reorder_tiles      order the tiles so similar ones are next to each other, for a smaller gbcompress result\n");
 		printf("-no_palettes        do not export palette data\n");
 
 		printf("-bin                export to binary format\n");
+		printf("-bin_packed         export a map as one binary file for load_packaged_map() (_packed.bin): a header with the size,\n");
+		printf("                    tile count, palette count and bank, then the tiles, map, attributes and CGB palettes\n");
+		printf("-bin_compress <none|gb|rle|auto>  compression of the -bin_packed sections, auto picks the smallest for each\n");
+		printf("                    (default: none)\n");
+		printf("-bin_align <n>      align the -bin_packed sections to n bytes (1 - 256, power of 2, default: 2)\n");
+		printf("-incbin             export tiles, map and map attributes as .bin files which the .c file includes with INCBIN()\n");
+		printf("                    (paths are as given with -c, relative to the directory the compiler is run from)\n");
+		printf("-asm                export a map as assembler source (.s instead of .c) which is assembled without the C compiler\n");
 		printf("-transposed         export transposed (column-by-column instead of row-by-row)\n");
+		printf("-batch <png> ...    convert more pngs sharing one tileset and palettes with the first one,\n");
+		printf("                    each png gets its own map / metasprites file next to the -c tileset file\n");
+		printf("                    (default: <png file>_tileset.c)\n");
+		printf("-deps               also write a make rule of the outputs depending on the pngs (the .h file name, but .d)\n");
+		printf("-skip_if_unchanged  don't write the outputs again when the pngs and options are the same as the last time\n");
+		printf("                    (a hash of them is kept in a .stamp file next to the .h file)\n");
 		return 0;
 	}
 
@@ -767,6 +2559,7 @@ int main(int argc, char* argv[])
 		else if(!strcmp(argv[i], "-c"))
 		{
 			output_filename = argv[++ i];
+			output_filename_set = true;
 		}
 		else if(!strcmp(argv[i], "-b"))
 		{
@@ -785,6 +2578,116 @@ int main(int argc, char* argv[])
 		{
 			flip_tiles = false;
 		}
+		else if(!strcmp(argv[i], "-sprite_trim"))
+		{
+			sprite_trim = true;
+		}
+		else if(!strcmp(argv[i], "-sprite_pairs"))
+		{
+			sprite_pairs = true;
+		}
+		else if(!strcmp(argv[i], "-sprite_lines"))
+		{
+			report_sprite_lines = true;
+		}
+		else if(!strcmp(argv[i], "-max_sprites_per_line"))
+		{
+			max_sprites_per_line = atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-metasprite_flips"))
+		{
+			export_metasprite_flips = true;
+		}
+		else if(!strcmp(argv[i], "-oam_frames"))
+		{
+			export_oam_frames = true;
+		}
+		else if(!strcmp(argv[i], "-metasprite_bounds"))
+		{
+			export_metasprite_bounds = true;
+		}
+		else if(!strcmp(argv[i], "-anim_diffs"))
+		{
+			export_anim_diffs = true;
+		}
+		else if(!strcmp(argv[i], "-metatiles"))
+		{
+			metatile_size = atoi(argv[++ i]);
+			if((metatile_size != 2) && (metatile_size != 4))
+			{
+				printf("-metatiles must be 2 or 4\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-tile_usage"))
+		{
+			tile_usage_w = atoi(argv[++ i]);
+			tile_usage_h = atoi(argv[++ i]);
+			if((tile_usage_w <= 0) || (tile_usage_h <= 0))
+			{
+				printf("-tile_usage region width and height must be larger than zero\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-map_chunks"))
+		{
+			map_chunk_w = atoi(argv[++ i]);
+			map_chunk_h = atoi(argv[++ i]);
+			if((map_chunk_w <= 0) || (map_chunk_h <= 0))
+			{
+				printf("-map_chunks chunk width and height must be larger than zero\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-collision_map"))
+		{
+			collision_map_file = argv[++ i];
+			collision_bits = atoi(argv[++ i]);
+			if((collision_bits != 1) && (collision_bits != 2))
+			{
+				printf("-collision_map bits must be 1 or 2\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-spawn_map"))
+		{
+			spawn_map_file = argv[++ i];
+		}
+		else if(!strcmp(argv[i], "-anim_seq"))
+		{
+			anim_seq_file = argv[++ i];
+		}
+		else if(!strcmp(argv[i], "-sgb_border"))
+		{
+			export_sgb_border_data = true;
+		}
+		else if(!strcmp(argv[i], "-vwf_font"))
+		{
+			export_vwf_font_data = true;
+			if((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				vwf_first_char = atoi(argv[++ i]);
+				if((vwf_first_char < 0) || (vwf_first_char > 255))
+				{
+					printf("-vwf_font first character must be 0 - 255\n");
+					return 1;
+				}
+			}
+		}
+		else if(!strcmp(argv[i], "-expand_4bpp"))
+		{
+			expand_4bpp = true;
+			for(int c = 0; c < 4; ++c)
+			{
+				int color = atoi(argv[++ i]);
+				if((color < 0) || (color > 15))
+				{
+					printf("-expand_4bpp colors must be 0 - 15\n");
+					return 1;
+				}
+				expand_4bpp_colors[c] = (unsigned char)color;
+			}
+		}
 		else if(!strcmp(argv[i], "-map"))
 		{
 			export_as_map = true;
@@ -799,6 +2702,14 @@ int main(int argc, char* argv[])
 			use_2x2_map_attributes = true;
 			pack_map_attributes = true;
 		}
+		else if (!strcmp(argv[i], "-nes_attribute_tables"))
+		{
+			export_nes_attribute_tables = true;
+		}
+		else if (!strcmp(argv[i], "-chr_rom"))
+		{
+			export_chr_rom = true;
+		}
 		else if (!strcmp(argv[i], "-use_nes_colors"))
 		{
 			convert_rgb_to_nes = true;
@@ -820,57 +2731,246 @@ int main(int argc, char* argv[])
 				return 1;
 			}
 		}
-		else if(!strcmp(argv[i], "-pack_mode"))
+		else if(!strcmp(argv[i], "-pack_palettes"))
+		{
+			pack_palettes = true;
+		}
+		else if(!strcmp(argv[i], "-pack_mode"))
+		{
+			std::string pack_mode_str = argv[++ i];
+			if     (pack_mode_str == "gb")  pack_mode = Tile::GB;
+			else if(pack_mode_str == "sgb") pack_mode = Tile::SGB;
+			else if(pack_mode_str == "sms") pack_mode = Tile::SMS;
+			else if(pack_mode_str == "1bpp") pack_mode = Tile::BPP1;
+			else
+			{
+				printf("-pack_mode must be one of gb, sgb, sms, 1bpp\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-tile_origin"))
+		{
+			tile_origin = atoi(argv[++ i]);
+		}
+		else if (!strcmp(argv[i], "-maps_only") || !strcmp(argv[i], "-metasprites_only"))
+		{
+			includeTileData = false;
+		}
+		else if (!strcmp(argv[i], "-tiles_only"))
+		{
+			includedMapOrMetaspriteData = false;
+		}
+		else if (!strcmp(argv[i], "-keep_duplicate_tiles"))
+		{
+			keep_duplicate_tiles = true;
+		}
+		else if (!strcmp(argv[i], "-reorder_tiles"))
+		{
+			reorder_tiles = true;
+		}
+		else if (!strcmp(argv[i], "-no_palettes"))
+		{
+			include_palettes = false;
+		}
+		else if (!strcmp(argv[i], "-source_tileset"))
+		{
+			use_source_tileset = true;
+			includeTileData = false;
+			source_tileset = argv[++i];
+		}
+		else if (!strcmp(argv[i], "-bin"))
+		{
+			output_binary = true;
+		}
+		else if (!strcmp(argv[i], "-bin_packed"))
+		{
+			output_binary = true;
+			export_packed_bin = true;
+		}
+		else if (!strcmp(argv[i], "-bin_compress"))
+		{
+			string alg = argv[++ i];
+			if     (alg == "none") packed_compression = PACKED_NONE;
+			else if(alg == "gb")   packed_compression = PACKED_GB;
+			else if(alg == "rle")  packed_compression = PACKED_RLE;
+			else if(alg == "auto") packed_compression = PACKED_AUTO;
+			else
+			{
+				printf("-bin_compress must be none, gb, rle or auto\n");
+				return 1;
+			}
+		}
+		else if (!strcmp(argv[i], "-bin_align"))
 		{
-			std::string pack_mode_str = argv[++ i];
-			if     (pack_mode_str == "gb")  pack_mode = Tile::GB;
-			else if(pack_mode_str == "sgb") pack_mode = Tile::SGB;
-			else if(pack_mode_str == "sms") pack_mode = Tile::SMS;
-			else if(pack_mode_str == "1bpp") pack_mode = Tile::BPP1;
-			else
+			int align = atoi(argv[++ i]);
+			if((align < 1) || (align > 256) || (align & (align - 1)))
 			{
-				printf("-pack_mode must be one of gb, sgb, sms, 1bpp\n");
+				printf("-bin_align must be a power of 2 from 1 to 256\n");
 				return 1;
 			}
+			packed_align = align;
 		}
-		else if(!strcmp(argv[i], "-tile_origin"))
+		else if (!strcmp(argv[i], "-incbin"))
 		{
-			tile_origin = atoi(argv[++ i]);
+			output_incbin = true;
 		}
-		else if (!strcmp(argv[i], "-maps_only") || !strcmp(argv[i], "-metasprites_only"))
+		else if (!strcmp(argv[i], "-asm"))
 		{
-			includeTileData = false;
+			output_asm = true;
 		}
-		else if (!strcmp(argv[i], "-tiles_only"))
+		else if (!strcmp(argv[i], "-transposed"))
 		{
-			includedMapOrMetaspriteData = false;
+			output_transposed = true;
 		}
-		else if (!strcmp(argv[i], "-keep_duplicate_tiles"))
+		else if (!strcmp(argv[i], "-deps"))
 		{
-			keep_duplicate_tiles = true;
+			write_dep_file = true;
 		}
-		else if (!strcmp(argv[i], "-no_palettes"))
+		else if (!strcmp(argv[i], "-skip_if_unchanged"))
 		{
-			include_palettes = false;
+			skip_if_unchanged = true;
 		}
-		else if (!strcmp(argv[i], "-source_tileset"))
+		else if (!strcmp(argv[i], "-batch"))
 		{
-			use_source_tileset = true;
-			includeTileData = false;
-			source_tileset = argv[++i];
+			while((i + 1 < argc) && (argv[i + 1][0] != '-'))
+				batch_files.push_back(argv[++ i]);
 		}
-		else if (!strcmp(argv[i], "-bin"))
+	}
+
+	if(output_incbin && (output_binary || export_sgb_border_data))
+	{
+		printf("-incbin can't be used with -bin or -sgb_border\n");
+		return 1;
+	}
+
+	if(output_asm && (!export_as_map || output_binary || output_incbin || use_structs || metatile_size || export_sgb_border_data || batch_files.size() ||
+	                  convert_rgb_to_nes || expand_4bpp || (pack_mode == Tile::SMS)))
+	{
+		printf("-asm requires -map and can't be used with -bin, -incbin, -use_structs, -metatiles, -sgb_border, -batch or sms/gg/nes output\n");
+		return 1;
+	}
+
+	if(export_nes_attribute_tables && (!export_as_map || !use_2x2_map_attributes || output_binary || output_incbin || output_asm))
+	{
+		printf("-nes_attribute_tables requires -map -use_nes_attributes and can't be used with -bin, -incbin or -asm\n");
+		return 1;
+	}
+
+	if(tile_usage_w && (!export_as_map || output_binary || use_structs || metatile_size || export_sgb_border_data))
+	{
+		printf("-tile_usage requires -map and can't be used with -bin, -use_structs, -metatiles or -sgb_border\n");
+		return 1;
+	}
+
+	if(sprite_pairs && ((sprite_mode != SPR_8x16) || export_as_map || sprite_trim))
+	{
+		printf("-sprite_pairs requires 8x16 sprites (-spr8x16) and can't be used with -map or -sprite_trim\n");
+		return 1;
+	}
+
+	if(map_chunk_w && (!export_as_map || output_transposed || use_structs || metatile_size || use_2x2_map_attributes || export_sgb_border_data))
+	{
+		printf("-map_chunks requires -map and can't be used with -transposed, -use_structs, -metatiles, -use_nes_attributes or -sgb_border\n");
+		return 1;
+	}
+
+	if(collision_bits && (!export_as_map || output_binary || use_structs || export_sgb_border_data || batch_files.size()))
+	{
+		printf("-collision_map requires -map and can't be used with -bin, -use_structs, -sgb_border or -batch\n");
+		return 1;
+	}
+
+	if(spawn_map_file.size() && (!export_as_map || output_binary || use_structs || export_sgb_border_data || batch_files.size()))
+	{
+		printf("-spawn_map requires -map and can't be used with -bin, -use_structs, -sgb_border or -batch\n");
+		return 1;
+	}
+
+	if(export_sgb_border_data)
+	{
+		if(output_binary || use_structs || metatile_size || use_source_tileset || batch_files.size() || tile_origin || !includeTileData || !includedMapOrMetaspriteData)
 		{
-			output_binary = true;
+			printf("-sgb_border can't be used with -bin, -use_structs, -metatiles, -source_tileset, -batch, -tile_origin, -tiles_only or -maps_only\n");
+			return 1;
 		}
-		else if (!strcmp(argv[i], "-transposed"))
+		export_as_map = true;
+		use_map_attributes = true;
+		pack_mode = Tile::SGB;
+		bpp = 4;
+		max_palettes = min(max_palettes, (size_t)SGB_PCT_PALETTE_COUNT);
+	}
+
+	if(export_vwf_font_data)
+	{
+		if(export_as_map || output_binary || output_incbin || output_asm || use_structs || metatile_size || use_source_tileset ||
+		   export_sgb_border_data || expand_4bpp || batch_files.size())
 		{
-			output_transposed = true;
+			printf("-vwf_font can't be used with -map, -bin, -incbin, -asm, -use_structs, -metatiles, -source_tileset, -sgb_border, -expand_4bpp or -batch\n");
+			return 1;
+		}
+		image.tile_w = VWF_GLYPH_W;
+		image.tile_h = VWF_GLYPH_H;
+		sprite_mode = SPR_NONE;
+	}
+
+	if(expand_4bpp)
+	{
+		if((bpp != 2) || export_sgb_border_data)
+		{
+			printf("-expand_4bpp requires -bpp 2 and can't be used with -sgb_border\n");
+			return 1;
 		}
+		pack_mode = Tile::SMS;
+	}
+
+	if(export_chr_rom && ((bpp != 2) || (pack_mode != Tile::GB) || output_binary || output_incbin || output_asm || use_structs ||
+	                      export_sgb_border_data || export_vwf_font_data || export_anim_diffs || batch_files.size() || !includeTileData))
+	{
+		printf("-chr_rom requires -bpp 2 -pack_mode gb and can't be used with -bin, -incbin, -asm, -use_structs, -sgb_border, -vwf_font,\n"
+		       "-anim_diffs, -batch, -source_tileset or -maps_only\n");
+		return 1;
 	}
 
 	image.colors_per_pal = 1 << bpp;
 
+	if(export_packed_bin && (!export_as_map || map_chunk_w || use_2x2_map_attributes || convert_rgb_to_nes ||
+	                         !(((pack_mode == Tile::GB) && (bpp == 2)) || ((pack_mode == Tile::SMS) && (bpp == 4)))))
+	{
+		printf("-bin_packed requires -map with gb 2bpp or sms 4bpp tiles and can't be used with -map_chunks or nes output\n");
+		return 1;
+	}
+
+	if(!export_packed_bin && ((packed_compression != PACKED_NONE) || (packed_align != 2)))
+	{
+		printf("-bin_compress and -bin_align require -bin_packed\n");
+		return 1;
+	}
+
+	if(metatile_size && (!export_as_map || output_binary || use_structs))
+	{
+		printf("-metatiles requires -map and can't be used with -bin or -use_structs\n");
+		return 1;
+	}
+
+	if(reorder_tiles && (export_anim_diffs || export_sgb_border_data || export_vwf_font_data || batch_files.size() ||
+	                     (!includeTileData && !use_source_tileset)))
+	{
+		printf("-reorder_tiles can't be used with -anim_diffs, -sgb_border, -vwf_font, -batch or -maps_only\n");
+		return 1;
+	}
+
+	if(anim_seq_file.size() && (export_as_map || output_binary || output_incbin || use_structs || batch_files.size() || !includedMapOrMetaspriteData))
+	{
+		printf("-anim_seq can't be used with -map, -bin, -incbin, -use_structs, -batch or -tiles_only\n");
+		return 1;
+	}
+
+	if(export_anim_diffs && (export_as_map || use_source_tileset || use_structs || !includeTileData || !includedMapOrMetaspriteData))
+	{
+		printf("-anim_diffs can't be used with -map, -source_tileset, -use_structs, -tiles_only or -metasprites_only\n");
+		return 1;
+	}
+
 	if(export_as_map)
 	{
 		image.tile_w = 8; //Force tiles_w to 8 on maps
@@ -878,17 +2978,21 @@ int main(int argc, char* argv[])
 		sprite_mode = SPR_NONE;
 	}
 
-	int slash_pos = (int)output_filename.find_last_of('/');
-	if(slash_pos == -1)
-		slash_pos = (int)output_filename.find_last_of('\\');
-	int dot_pos = (int)output_filename.find_first_of('.', slash_pos == -1 ? 0 : slash_pos);
+	if(skip_if_unchanged)
+	{
+		string primary_filename = batch_files.size() ? BatchTilesetFilename(argv[1]) : output_filename;
+		string hash_str;
+		if(HashInputs(argc, argv, hash_str) && StampUnchanged(DependencyFilename(primary_filename, ".stamp"), hash_str))
+		{
+			printf("%s: up to date\n", primary_filename.c_str());
+			return 0;
+		}
+	}
 
-	output_filename_h = output_filename.substr(0, dot_pos) + ".h";
-	output_filename_bin = output_filename.substr(0, dot_pos) + "_map.bin";
-	output_filename_attributes_bin = output_filename.substr(0, dot_pos) + "_map_attributes.bin";
-	output_filename_tiles_bin = output_filename.substr(0, dot_pos) + "_tiles.bin";
-	data_name = output_filename.substr(slash_pos + 1, dot_pos - 1 - slash_pos);
-	replace(data_name.begin(), data_name.end(), '-', '_');
+	if(batch_files.size())
+		return ExportBatch(argv[1]);
+
+	SetOutputFilename(output_filename);
 
 	// This was moved from outside the upcoming else statement when not using keep_palette_order
 	// So the 'GetSourceTileset' function can pre-populate it from the source tileset
@@ -983,7 +3087,21 @@ int main(int argc, char* argv[])
 		image32.tile_w = image.tile_w;
 		image32.tile_h = image.tile_h;
 
-		unsigned error = lodepng::decode(image32.data, image32.w, image32.h, state, buffer); //decode as 32 bit
+		// Large pngs are converted to RGBA32 a band of tile rows at a time when the palettes allow it
+		vector< unsigned char > raw;
+		unsigned int png_w = 0, png_h = 0;
+		bool stream = (lodepng_inspect(&png_w, &png_h, &state, buffer.data(), buffer.size()) == 0) &&
+		              ((size_t)png_w * png_h >= PNG_STREAM_MIN_PIXELS) &&
+		              (use_source_tileset || !(pack_palettes || use_2x2_map_attributes));
+		unsigned error;
+		if(stream)
+		{
+			state.decoder.color_convert = false;
+			error = lodepng::decode(raw, image32.w, image32.h, state, buffer); // decode in the png color format
+		}
+		else
+			error = lodepng::decode(image32.data, image32.w, image32.h, state, buffer); //decode as 32 bit
+		vector< unsigned char >().swap(buffer); // The compressed png isn't needed any more
 		if(error)
 		{
 			printf("decoder error %s\n", lodepng_error_text(error));
@@ -997,7 +3115,40 @@ int main(int argc, char* argv[])
 			return 1;
 		}
 
-		int* palettes_per_tile = BuildPalettesAndAttributes(image32, palettes, use_2x2_map_attributes);
+		// Palettes from a source tileset have to keep their order
+		if(use_2x2_map_attributes && !use_source_tileset)
+		{
+			vector< PNGImage* > shared_images(1, &image32);
+			SetSharedBackgroundColor(shared_images);
+		}
+
+		int* palettes_per_tile;
+		if(stream)
+		{
+			palettes_per_tile = BuildPalettesAndAttributesStreamed(image32, raw, state.info_raw, palettes, use_2x2_map_attributes);
+			if(!palettes_per_tile)
+				return 1;
+			if(!use_source_tileset && (palettes.size() > max_palettes))
+			{
+				// Packing the palettes needs the whole image, the palettes so far are the same as for it
+				PNGImage whole;
+				whole.w = image32.w;
+				whole.h = image32.h;
+				if(!GetRowsRGBA32(raw, state.info_raw, 0, whole))
+					return 1;
+				vector< unsigned char >().swap(raw);
+				image32.data.swap(whole.data);
+				stream = false;
+			}
+		}
+		else
+			palettes_per_tile = BuildPalettesAndAttributes(image32, palettes, use_2x2_map_attributes);
+
+		if(!use_source_tileset && (pack_palettes || use_2x2_map_attributes || (palettes.size() > max_palettes)))
+		{
+			vector< PaletteImage > pack_images(1, PaletteImage{ &image32, palettes_per_tile });
+			PackPalettes(pack_images, palettes, use_2x2_map_attributes, max_palettes);
+		}
 
 		//Create the indexed image
 		image.data.clear();
@@ -1007,7 +3158,7 @@ int main(int argc, char* argv[])
 		unsigned int palette_count = PaletteCountApplyMaxLimit(max_palettes, palettes.size());
 
 		image.total_color_count = palette_count * image.colors_per_pal;
-		image.palette = new unsigned char[palette_count * image.colors_per_pal * RGBA32_SZ]; // total color count * 4 bytes each
+		image.palette = new unsigned char[palette_count * image.colors_per_pal * RGBA32_SZ](); // total color count * 4 bytes each
 
 		// If we are using a sourcetileset and have more palettes than it defines
 		if (use_source_tileset && (image.total_color_count > source_total_color_count)) {
@@ -1026,22 +3177,21 @@ int main(int argc, char* argv[])
 			}
 		}
 
-		for(size_t y = 0; y < image32.h; ++ y)
+		if(stream)
 		{
-			for(size_t x = 0; x < image32.w; ++x)
-			{
-				unsigned char* c32ptr = &image32.data[(image32.w * y + x) * RGBA32_SZ];
-				int color32 = (c32ptr[0] << 24) | (c32ptr[1] << 16) | (c32ptr[2] << 8) | c32ptr[3];
-				unsigned char palette = palettes_per_tile[(y / image32.tile_h) * (image32.w / image32.tile_w) + (x / image32.tile_w)];
-				unsigned char index = std::distance(palettes[palette].begin(), palettes[palette].find(color32));
-				image.data.push_back((palette << bpp) + index);
-			}
+			if(!IndexImagePixelsStreamed(image32, raw, state.info_raw, palettes, palettes_per_tile, image.data))
+				return 1;
 		}
+		else
+			IndexImagePixels(image32, palettes, palettes_per_tile, image.data);
 
 		//Test: output png to see how it looks
 		//Export(image, "temp.png");
 	}
 
+	if(export_vwf_font_data)
+		return export_vwf_font() ? 0 : 1;
+
 	if(sprite_w == 0) sprite_w = (int)image.w;
 	if(sprite_h == 0) sprite_h = (int)image.h;
 	if(pivot_x == 0xFFFFFF) pivot_x = sprite_w / 2;
@@ -1053,6 +3203,9 @@ int main(int argc, char* argv[])
 	{
 		//Extract map
 		GetMap();
+		if(reorder_tiles) ReorderTiles();
+		if(cgb_vram_banks()) PlaceTilesInVramBanks();
+		if(metatile_size && !GetMetatiles()) return 1;
 	}
 	else
 	{
@@ -1061,51 +3214,356 @@ int main(int argc, char* argv[])
 		{
 			for(int x = 0; x < (int)image.w; x += sprite_w)
 			{
-				GetMetaSprite(x, y, sprite_w, sprite_h, pivot_x, pivot_y);
+				GetMetaSprite(x, y, sprite_w, sprite_h, pivot_x, pivot_y);
+			}
+		}
+		if(reorder_tiles) ReorderTiles();
+		if((report_sprite_lines || max_sprites_per_line) && !CheckSpriteLines(argv[1])) return 1;
+		if(export_anim_diffs)
+		{
+			if(!GetAnimDiffs()) return 1;
+			includeTileData = false; // The tiles are in the frame changes instead
+		}
+	}
+	map_attributes_width = image.w / 8;
+	map_attributes_height = image.h / 8;
+	// Optionally perform 2x2 reduction on attributes (NES attribute table has this format)
+	if(use_2x2_map_attributes)
+	{
+		// NES attribute map dimensions are half-resolution 
+		ReduceMapAttributes2x2(palettes);
+	}
+	// Optionally align and pack map attributes into NES PPU format
+	if (pack_map_attributes)
+	{
+		AlignMapAttributes();
+		PackMapAttributes();
+	}
+	else
+	{
+		// Use original attribute dimensions for packed
+		map_attributes_packed_width = map_attributes_width;
+		map_attributes_packed_height = map_attributes_height;
+	}
+	if(map_chunk_w)
+		ChunkMap();
+
+	// === EXPORT ===
+
+	if(expand_4bpp)
+		ExpandTiles4bpp();
+
+	if(export_sgb_border_data)
+		return export_sgb_border() ? 0 : 1;
+
+	if(export_chr_rom)
+	{
+		if(!export_chr_file()) return 1;
+		includeTileData = false; // The tiles are in CHR-ROM instead
+	}
+
+	if(collision_bits && !LoadCollisionMap())
+		return 1;
+
+	if(spawn_map_file.size() && !LoadSpawnMap())
+		return 1;
+
+	if(anim_seq_file.size() && !LoadAnimSeqs())
+		return 1;
+
+	// Header file export
+	if (export_h_file() == false) return 1; // Exit with Fail
+
+	if ((export_as_map) && (output_binary)) {
+		// Handle special case of binary map export
+		if (export_packed_bin) {
+			if (export_map_packed() == false) return 1; // Exit with Fail
+		} else
+			export_map_binary();
+	} else if (output_asm) {
+		if (export_asm_file() == false) return 1; // Exit with Fail
+	} else {
+		// Normal source file export
+		if (export_c_file() == false) return 1; // Exit with Fail
+	}
+	return 0;
+}
+
+
+// The separate _map_attributes array is replaced by _metatile_attributes
+// when exporting metatiles, except for NES attributes which are not per tile
+static bool export_map_attributes(void)
+{
+	return use_map_attributes && map_attributes.size() && (!metatile_size || use_2x2_map_attributes);
+}
+
+// Lists the tiles used by each -tile_usage region, regions are in rows
+// and each list is sorted. offsets has one entry more than there are regions.
+static void GetTileUsage(vector< uint16_t >& usage, vector< uint16_t >& offsets)
+{
+	size_t columns = image.w / 8;
+	size_t rows = image.h / 8;
+	for(size_t ry = 0; ry < rows; ry += tile_usage_h)
+	{
+		for(size_t rx = 0; rx < columns; rx += tile_usage_w)
+		{
+			set< size_t > used;
+			for(size_t y = ry; (y < ry + tile_usage_h) && (y < rows); ++y)
+				for(size_t x = rx; (x < rx + tile_usage_w) && (x < columns); ++x)
+					used.insert(map_tile_ids[y * columns + x]);
+			offsets.push_back((uint16_t)usage.size());
+			usage.insert(usage.end(), used.begin(), used.end());
+		}
+	}
+	offsets.push_back((uint16_t)usage.size());
+}
+
+// Reads a png given to -collision_map or -spawn_map: either one pixel per map
+// tile, or the size of the map image, where the top left pixel of each tile
+// counts. The palette index of each tile goes into values, row by row
+static bool LoadTileValues(const string& filename, const char* option, vector< uint8_t >& values)
+{
+	vector< unsigned char > buffer, data;
+	lodepng::State state;
+	unsigned int w, h;
+	size_t columns = image.w / 8;
+	size_t rows = image.h / 8;
+
+	state.info_raw.colortype = LCT_PALETTE;
+	state.info_raw.bitdepth = 8;
+	state.decoder.color_convert = false;
+	if(lodepng::load_file(buffer, filename))
+	{
+		printf("%s: can't read %s\n", option, filename.c_str());
+		return false;
+	}
+	unsigned error = lodepng::decode(data, w, h, state, buffer);
+	if(error)
+	{
+		printf("%s: decoder error %s\n", filename.c_str(), lodepng_error_text(error));
+		return false;
+	}
+	if(state.info_png.color.colortype != LCT_PALETTE)
+	{
+		printf("%s: %s must be an indexed png, the palette index is the value of the tile\n", option, filename.c_str());
+		return false;
+	}
+	if(!image_indexed_ensure_8bpp(data, w, h, (int)state.info_png.color.bitdepth, (int)state.info_png.color.colortype))
+		return false;
+
+	size_t step;
+	if((w == columns) && (h == rows))
+		step = 1;
+	else if((w == image.w) && (h == image.h))
+		step = 8;
+	else
+	{
+		printf("%s: %s must be %dx%d (one pixel per tile) or %dx%d pixels\n", option, filename.c_str(),
+		       (unsigned int)columns, (unsigned int)rows, (unsigned int)image.w, (unsigned int)image.h);
+		return false;
+	}
+
+	values.clear();
+	for(size_t y = 0; y < rows; ++y)
+		for(size_t x = 0; x < columns; ++x)
+			values.push_back(data[(y * step * w) + (x * step)]);
+	return true;
+}
+
+static bool LoadCollisionMap(void)
+{
+	size_t columns = image.w / 8;
+
+	if(!LoadTileValues(collision_map_file, "-collision_map", collision_values))
+		return false;
+	for(size_t i = 0; i < collision_values.size(); ++i)
+	{
+		if(collision_values[i] >= (1 << collision_bits))
+		{
+			printf("-collision_map: tile %d,%d has the value %d, which doesn't fit %d bits\n", (unsigned int)(i % columns), (unsigned int)(i / columns),
+			       collision_values[i], collision_bits);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Lists the objects column by column, so they come out sorted by X then Y,
+// and the first object of each bucket of columns
+static bool LoadSpawnMap(void)
+{
+	vector< uint8_t > values;
+	size_t columns = image.w / 8;
+	size_t rows = image.h / 8;
+
+	if(!LoadTileValues(spawn_map_file, "-spawn_map", values))
+		return false;
+	if(rows > 256)
+	{
+		printf("-spawn_map: the map is %d tiles high, 256 at most\n", (unsigned int)rows);
+		return false;
+	}
+
+	spawn_entries.clear();
+	spawn_buckets.clear();
+	for(size_t x = 0; x < columns; ++x)
+	{
+		if((x % SPAWN_BUCKET_TILES) == 0)
+			spawn_buckets.push_back((uint16_t)spawn_entries.size());
+		for(size_t y = 0; y < rows; ++y)
+		{
+			uint8_t type = values[(y * columns) + x];
+			if(type)
+				spawn_entries.push_back({x, y, type});
+		}
+	}
+	if(spawn_entries.empty() || (spawn_entries.size() > 0xFFFF))
+	{
+		printf("-spawn_map: %s has %d objects, it needs 1 to 65535\n", spawn_map_file.c_str(), (unsigned int)spawn_entries.size());
+		return false;
+	}
+	spawn_buckets.push_back((uint16_t)spawn_entries.size());
+	return true;
+}
+
+// Reads the -anim_seq file: one sequence per line, the name, loop or once,
+// then the frames as <frame>[:<ticks>][@<event>]. ; starts a comment.
+static bool LoadAnimSeqs(void)
+{
+	ifstream in(anim_seq_file);
+	string line;
+	int line_no = 0;
+
+	if(!in)
+	{
+		printf("-anim_seq: can't open %s\n", anim_seq_file.c_str());
+		return false;
+	}
+	anim_seqs.clear();
+	while(getline(in, line))
+	{
+		++line_no;
+		line = line.substr(0, line.find(';'));
+		vector< string > words;
+		size_t pos = 0;
+		while(true)
+		{
+			pos = line.find_first_not_of(" \t\r", pos);
+			if(pos == string::npos)
+				break;
+			size_t end = line.find_first_of(" \t\r", pos);
+			words.push_back(line.substr(pos, end == string::npos ? string::npos : end - pos));
+			pos = end;
+		}
+		if(words.empty())
+			continue;
+
+		AnimSeq seq;
+		seq.name = words[0];
+		bool valid_name = !isdigit((unsigned char)seq.name[0]);
+		for(size_t i = 0; i < seq.name.size(); ++i)
+			valid_name = valid_name && (isalnum((unsigned char)seq.name[i]) || (seq.name[i] == '_'));
+		if(!valid_name || (words.size() < 3) || ((words[1] != "loop") && (words[1] != "once")))
+		{
+			printf("-anim_seq: %s:%d: expected <name> <loop|once> <frame>[:<ticks>][@<event>] ...\n", anim_seq_file.c_str(), line_no);
+			return false;
+		}
+		for(size_t i = 0; i < anim_seqs.size(); ++i)
+		{
+			if(anim_seqs[i].name == seq.name)
+			{
+				printf("-anim_seq: %s:%d: sequence %s is already defined\n", anim_seq_file.c_str(), line_no, seq.name.c_str());
+				return false;
+			}
+		}
+		seq.loop = (words[1] == "loop");
+		for(size_t i = 2; i < words.size(); ++i)
+		{
+			AnimSeqFrame frame = { 0, 1, 0 };
+			const char* p = words[i].c_str();
+			char* end;
+			frame.frame = (unsigned int)strtoul(p, &end, 10);
+			bool ok = (end != p);
+			if(ok && (*end == ':'))
+			{
+				p = end + 1;
+				frame.ticks = (unsigned int)strtoul(p, &end, 10);
+				ok = (end != p);
+			}
+			if(ok && (*end == '@'))
+			{
+				p = end + 1;
+				frame.event = (unsigned int)strtoul(p, &end, 10);
+				ok = (end != p);
+			}
+			if(!ok || *end || (frame.ticks > 255) || (frame.event > 255))
+			{
+				printf("-anim_seq: %s:%d: bad frame \"%s\", expected <frame>[:<ticks 0-255>][@<event 0-255>]\n", anim_seq_file.c_str(), line_no, words[i].c_str());
+				return false;
+			}
+			if(frame.frame >= sprites.size())
+			{
+				printf("-anim_seq: %s:%d: frame %d, the image has %d frames\n", anim_seq_file.c_str(), line_no, frame.frame, (unsigned int)sprites.size());
+				return false;
 			}
+			seq.frames.push_back(frame);
 		}
+		if(seq.frames.size() > ANIM_SEQ_FRAMES_MAX)
+		{
+			printf("-anim_seq: %s:%d: %d frames, a sequence has %d at most\n", anim_seq_file.c_str(), line_no, (unsigned int)seq.frames.size(), ANIM_SEQ_FRAMES_MAX);
+			return false;
+		}
+		anim_seqs.push_back(seq);
 	}
-	map_attributes_width = image.w / 8;
-	map_attributes_height = image.h / 8;
-	// Optionally perform 2x2 reduction on attributes (NES attribute table has this format)
-	if(use_2x2_map_attributes)
-	{
-		// NES attribute map dimensions are half-resolution 
-		ReduceMapAttributes2x2(palettes);
-	}
-	// Optionally align and pack map attributes into NES PPU format
-	if (pack_map_attributes)
-	{
-		AlignMapAttributes();
-		PackMapAttributes();
-	}
-	else
+	if(anim_seqs.empty() || (anim_seqs.size() > 255))
 	{
-		// Use original attribute dimensions for packed
-		map_attributes_packed_width = map_attributes_width;
-		map_attributes_packed_height = map_attributes_height;
+		printf("-anim_seq: %s has %d sequences, it needs 1 to 255\n", anim_seq_file.c_str(), (unsigned int)anim_seqs.size());
+		return false;
 	}
+	return true;
+}
 
-	// === EXPORT ===
+static string UpperCase(string name)
+{
+	for(size_t i = 0; i < name.size(); ++i)
+		name[i] = (char)toupper((unsigned char)name[i]);
+	return name;
+}
 
-	// Header file export
-	if (export_h_file() == false) return 1; // Exit with Fail
+// Bytes per row of the packed collision map, rounded up to a power of two
+// so a row is found with a shift
+static size_t collision_row_shift(void)
+{
+	size_t bytes = ((image.w / 8) * collision_bits + 7) / 8;
+	size_t shift = 0;
+	while(((size_t)1 << shift) < bytes)
+		++shift;
+	return shift;
+}
 
-	if ((export_as_map) && (output_binary)) {
-		// Handle special case of binary map export
-		export_map_binary();
-	} else {
-		// Normal source file export
-		if (export_c_file() == false) return 1; // Exit with Fail
-	}
+// The flag values packed into bytes, the leftmost tile in the lowest bits
+static vector< uint8_t > GetCollisionData(void)
+{
+	size_t columns = image.w / 8;
+	size_t rows = image.h / 8;
+	size_t row_bytes = (size_t)1 << collision_row_shift();
+	size_t per_byte = 8 / collision_bits;
+	vector< uint8_t > data(row_bytes * rows, 0);
+
+	for(size_t y = 0; y < rows; ++y)
+		for(size_t x = 0; x < columns; ++x)
+			data[(y * row_bytes) + (x / per_byte)] |= collision_values[(y * columns) + x] << ((x % per_byte) * collision_bits);
+	return data;
 }
 
+static size_t tile_usage_columns(void) { return ((image.w / 8) + tile_usage_w - 1) / tile_usage_w; }
+static size_t tile_usage_rows(void)    { return ((image.h / 8) + tile_usage_h - 1) / tile_usage_h; }
 
 bool export_h_file(void) {
 
 	FILE* file;
 
-	file=fopen(output_filename_h.c_str(), "w");
+	file = OpenOutput(output_filename_h, "w");
 	if (!file) {
 		printf("Error writing file: %s", output_filename_h.c_str() );
 		return false;
@@ -1118,6 +3576,12 @@ bool export_h_file(void) {
 	fprintf(file, "#include <stdint.h>\n");
 	fprintf(file, "#include <gbdk/platform.h>\n");
 	fprintf(file, "#include <gbdk/metasprites.h>\n");
+	if(spawn_map_file.size())
+		fprintf(file, "#include <gbdk/spawn.h>\n");
+	if(anim_seq_file.size())
+		fprintf(file, "#include <gbdk/anim.h>\n");
+	if(export_metasprite_bounds && !export_as_map)
+		fprintf(file, "#include <gbdk/metasprite_clip.h>\n");
 	fprintf(file, "\n");
 	if(use_structs)
 	{
@@ -1145,7 +3609,11 @@ bool export_h_file(void) {
 		fprintf(file, "#define %s_HEIGHT %d\n", data_name.c_str(), sprite_h);
 		// The TILE_COUNT calc here is referring to number of 8x8 tiles,
 		// so the >> 3 for each sizes axis is to get a multiplier for larger hardware sprites such as 8x16 and 16x16
-		fprintf(file, "#define %s_TILE_COUNT %d\n", data_name.c_str(), ((unsigned int)tiles.size() - source_tileset_size) * (image.tile_h >> 3) * (image.tile_w >> 3));
+		fprintf(file, "#define %s_TILE_COUNT %d\n", data_name.c_str(), (unsigned int)tile_count_bank0() * (image.tile_h >> 3) * (image.tile_w >> 3));
+		if (tile_count_bank1())
+			fprintf(file, "#define %s_TILE_COUNT_BANK1 %d\n", data_name.c_str(), (unsigned int)tile_count_bank1());
+		if (export_chr_rom)
+			fprintf(file, "#define %s_CHR_BANKS %d\n", data_name.c_str(), (unsigned int)chr_rom_banks());
 		if (include_palettes) {
 			fprintf(file, "#define %s_PALETTE_COUNT %d\n", data_name.c_str(), (unsigned int)(image.total_color_count / image.colors_per_pal));
 			fprintf(file, "#define %s_COLORS_PER_PALETTE %d\n", data_name.c_str(), (unsigned int)image.colors_per_pal);
@@ -1157,7 +3625,7 @@ bool export_h_file(void) {
 			if(export_as_map)
 			{
 				fprintf(file, "#define %s_MAP_ATTRIBUTES ",  data_name.c_str());
-				if(use_map_attributes && map_attributes.size())
+				if(export_map_attributes())
 					fprintf(file, "%s_map_attributes\n", data_name.c_str());
 				else
 					fprintf(file, "0\n");
@@ -1171,6 +3639,40 @@ bool export_h_file(void) {
 					fprintf(file, "#define %s_MAP_ATTRIBUTES_PACKED_HEIGHT %d\n", data_name.c_str(), (int)map_attributes_packed_height);
 				}
 
+				if(tile_usage_w)
+				{
+					fprintf(file, "#define %s_TILE_USAGE_W %d\n", data_name.c_str(), tile_usage_w);
+					fprintf(file, "#define %s_TILE_USAGE_H %d\n", data_name.c_str(), tile_usage_h);
+					fprintf(file, "#define %s_TILE_USAGE_COLUMNS %d\n", data_name.c_str(), (unsigned int)tile_usage_columns());
+					fprintf(file, "#define %s_TILE_USAGE_ROWS %d\n", data_name.c_str(), (unsigned int)tile_usage_rows());
+				}
+
+				if(map_chunk_w)
+				{
+					fprintf(file, "#define %s_MAP_CHUNK_W %d\n", data_name.c_str(), map_chunk_w);
+					fprintf(file, "#define %s_MAP_CHUNK_H %d\n", data_name.c_str(), map_chunk_h);
+					fprintf(file, "#define %s_MAP_CHUNK_COLUMNS %d\n", data_name.c_str(), (unsigned int)map_chunk_columns());
+					fprintf(file, "#define %s_MAP_CHUNK_ROWS %d\n", data_name.c_str(), (unsigned int)map_chunk_rows());
+					fprintf(file, "#define %s_MAP_CHUNK_SIZE %d\n", data_name.c_str(), (unsigned int)(map.size() / map_lines()));
+				}
+
+				if(collision_bits)
+				{
+					fprintf(file, "#define %s_COLLISION_BITS %d\n", data_name.c_str(), collision_bits);
+					fprintf(file, "#define %s_COLLISION_ROW_SHIFT %d\n", data_name.c_str(), (unsigned int)collision_row_shift());
+				}
+
+				if(spawn_map_file.size())
+					fprintf(file, "#define %s_SPAWN_COUNT %d\n", data_name.c_str(), (unsigned int)spawn_entries.size());
+
+				if(metatile_size)
+				{
+					fprintf(file, "#define %s_METATILE_SIZE %d\n", data_name.c_str(), metatile_size);
+					fprintf(file, "#define %s_METATILE_COUNT %d\n", data_name.c_str(), (unsigned int)(metatiles.size() / (metatile_size * metatile_size)));
+					fprintf(file, "#define %s_METATILE_MAP_WIDTH %d\n", data_name.c_str(), (unsigned int)metatile_map_width);
+					fprintf(file, "#define %s_METATILE_MAP_HEIGHT %d\n", data_name.c_str(), (unsigned int)metatile_map_height);
+				}
+
 				if(use_structs)
 				{
 					fprintf(file, "#define %s_TILE_PALS ",  data_name.c_str());
@@ -1186,6 +3688,17 @@ bool export_h_file(void) {
 				fprintf(file, "#define %s_PIVOT_Y %d\n", data_name.c_str(), pivot_y);
 				fprintf(file, "#define %s_PIVOT_W %d\n", data_name.c_str(), pivot_w);
 				fprintf(file, "#define %s_PIVOT_H %d\n", data_name.c_str(), pivot_h);
+				if(export_anim_diffs)
+				{
+					fprintf(file, "#define %s_ANIM_SLOTS %d\n", data_name.c_str(), (unsigned int)anim_slots);
+					fprintf(file, "#define %s_ANIM_TILE_COUNT %d\n", data_name.c_str(), (unsigned int)(anim_slots * tiles_per_sprite()));
+				}
+				if(anim_seq_file.size())
+				{
+					fprintf(file, "#define %s_ANIM_SEQ_COUNT %d\n", data_name.c_str(), (unsigned int)anim_seqs.size());
+					for(size_t i = 0; i < anim_seqs.size(); ++i)
+						fprintf(file, "#define %s_ANIM_%s %d\n", data_name.c_str(), UpperCase(anim_seqs[i].name).c_str(), (unsigned int)i);
+				}
 			}
 		}
 		fprintf(file, "\n");
@@ -1197,25 +3710,59 @@ bool export_h_file(void) {
 			fprintf(file, "extern const palette_color_t %s_palettes[%d];\n", data_name.c_str(), (unsigned int)image.total_color_count - source_total_color_count);
 		}
 		if (includeTileData) {
-			fprintf(file, "extern const uint8_t %s_tiles[%d];\n", data_name.c_str(), (unsigned int)((tiles.size() - source_tileset_size) * (image.tile_w * image.tile_h * bpp / 8)));
+			fprintf(file, "extern const uint8_t %s_tiles[%d];\n", data_name.c_str(), (unsigned int)(tile_count_bank0() * (image.tile_w * image.tile_h * bpp / 8)));
+			if (tile_count_bank1())
+				fprintf(file, "extern const uint8_t %s_tiles_bank1[%d];\n", data_name.c_str(), (unsigned int)(tile_count_bank1() * (image.tile_w * image.tile_h * bpp / 8)));
 		}
 
 		fprintf(file, "\n");
 		if (includedMapOrMetaspriteData) {
 			if(export_as_map)
 			{
-				fprintf(file, "extern const unsigned char %s_map[%d];\n", data_name.c_str(), (unsigned int)map.size());
+				if(metatile_size)
+				{
+					fprintf(file, "extern const unsigned char %s_metatiles[%d];\n", data_name.c_str(), (unsigned int)metatiles.size());
+					if(metatile_attributes.size())
+						fprintf(file, "extern const unsigned char %s_metatile_attributes[%d];\n", data_name.c_str(), (unsigned int)metatile_attributes.size());
+					fprintf(file, "extern const unsigned char %s_metatile_map[%d];\n", data_name.c_str(), (unsigned int)metatile_map.size());
+				}
+				else
+					fprintf(file, "extern const unsigned char %s_map[%d];\n", data_name.c_str(), (unsigned int)map.size());
+
+				if(tile_usage_w)
+				{
+					vector< uint16_t > usage, offsets;
+					GetTileUsage(usage, offsets);
+					fprintf(file, "extern const uint16_t %s_map_ids[%d];\n", data_name.c_str(), (unsigned int)map_tile_ids.size());
+					fprintf(file, "extern const uint16_t %s_tile_usage[%d];\n", data_name.c_str(), (unsigned int)usage.size());
+					fprintf(file, "extern const uint16_t %s_tile_usage_offsets[%d];\n", data_name.c_str(), (unsigned int)offsets.size());
+				}
 
-				if(use_map_attributes && map_attributes.size()) {
+				if(collision_bits)
+					fprintf(file, "extern const uint8_t %s_collision[%d];\n", data_name.c_str(), (unsigned int)GetCollisionData().size());
+
+				if(spawn_map_file.size())
+				{
+					fprintf(file, "extern const spawn_t %s_spawns[%d];\n", data_name.c_str(), (unsigned int)spawn_entries.size());
+					fprintf(file, "extern const uint16_t %s_spawn_buckets[%d];\n", data_name.c_str(), (unsigned int)spawn_buckets.size());
+					fprintf(file, "extern const spawn_list_t %s_spawn_list;\n", data_name.c_str());
+				}
+
+				if(export_map_attributes()) {
 						fprintf(file, "extern const unsigned char %s_map_attributes[%d];\n", data_name.c_str(), (unsigned int)map_attributes.size());
 				}
-				else
+				else if(!metatile_size)
 				{
 					// Some platforms (like SMS/GG) encode attributes as part of map
 					// For compatibility, add a define that makes _map_attributes equal _map,
 					// so that set_bkg_attributes can work the same on these platforms
 					fprintf(file, "#define %s_map_attributes %s_map\n", data_name.c_str(), data_name.c_str());
 				}
+				if(export_nes_attribute_tables) {
+					fprintf(file, "#define %s_ATTRIBUTE_TABLES_WIDTH %d\n", data_name.c_str(), (unsigned int)nes_attribute_tables_width());
+					fprintf(file, "#define %s_ATTRIBUTE_TABLES_HEIGHT %d\n", data_name.c_str(), (unsigned int)nes_attribute_tables_height());
+					fprintf(file, "extern const unsigned char %s_attribute_tables[%d];\n", data_name.c_str(), (unsigned int)GetNesAttributeTables().size());
+				}
 				if (!use_map_attributes && (includeTileData) && (use_structs)) {
 					fprintf(file, "extern const unsigned char* %s_tile_pals[%d];\n", data_name.c_str(), (unsigned int)tiles.size());
 				}
@@ -1223,6 +3770,30 @@ bool export_h_file(void) {
 			else
 			{
 				fprintf(file, "extern const metasprite_t* const %s_metasprites[%d];\n", data_name.c_str(), (unsigned int)sprites.size());
+				if(export_metasprite_flips)
+				{
+					fprintf(file, "extern const metasprite_t* const %s_metasprites_flipx[%d];\n", data_name.c_str(), (unsigned int)sprites.size());
+					fprintf(file, "extern const metasprite_t* const %s_metasprites_flipy[%d];\n", data_name.c_str(), (unsigned int)sprites.size());
+					fprintf(file, "extern const metasprite_t* const %s_metasprites_flipxy[%d];\n", data_name.c_str(), (unsigned int)sprites.size());
+					fprintf(file, "extern const metasprite_t* const* const %s_metasprites_flips[4];\n", data_name.c_str());
+				}
+				if(export_oam_frames)
+				{
+					fprintf(file, "extern const uint8_t* const %s_oam_frames[%d];\n", data_name.c_str(), (unsigned int)sprites.size());
+				}
+				if(export_metasprite_bounds)
+				{
+					fprintf(file, "extern const metasprite_bounds_t %s_metasprite_bounds[%d];\n", data_name.c_str(), (unsigned int)sprites.size());
+				}
+				if(export_anim_diffs)
+				{
+					fprintf(file, "extern const uint8_t %s_anim_init[];\n", data_name.c_str());
+					fprintf(file, "extern const uint8_t* const %s_anim_frames[%d];\n", data_name.c_str(), (unsigned int)sprites.size());
+				}
+				if(anim_seq_file.size())
+				{
+					fprintf(file, "extern const anim_seq_t %s_anim_seqs[%d];\n", data_name.c_str(), (unsigned int)anim_seqs.size());
+				}
 			}
 		}
 	}
@@ -1238,11 +3809,398 @@ bool export_h_file(void) {
 
 
 
+// Writes the metasprite frames and the table pointing to them.
+// Flipped frames draw with move_metasprite_ex() the same way the unflipped ones
+// draw with move_metasprite_flipx/flipy/flipxy(): offsets and flip flags are inverted
+// and the sprite size adjustment of the pivot is folded into the first item.
+static void export_c_metasprites(FILE* file, const char* suffix, bool flip_x, bool flip_y)
+{
+	for(vector< MetaSprite >::iterator it = sprites.begin(); it != sprites.end(); ++ it)
+	{
+		fprintf(file, "const metasprite_t %s_metasprite%d%s[] = {\n", data_name.c_str(), (int)(it - sprites.begin()), suffix);
+		for(MetaSprite::iterator it2 = (*it).begin(); it2 != (*it).end(); ++ it2)
+		{
+			int offset_x = (*it2).offset_x;
+			int offset_y = (*it2).offset_y;
+			int props = (*it2).props;
+			if(flip_x)
+			{
+				offset_x = -offset_x - ((it2 == (*it).begin()) ? image.tile_w : 0);
+				props ^= (1 << 5);
+			}
+			if(flip_y)
+			{
+				offset_y = -offset_y - ((it2 == (*it).begin()) ? image.tile_h : 0);
+				props ^= (1 << 6);
+			}
+			if((offset_x < -128) || (offset_x > 127) || (offset_y <= -128) || (offset_y > 127))
+				printf("Warning: metasprite %d%s offset out of range (x:%d, y:%d)\n", (int)(it - sprites.begin()), suffix, offset_x, offset_y);
+
+			int pal_idx = props & 0xF;
+			fprintf(file,
+			        "\tMETASPR_ITEM(%d, %d, %d, S_PAL(%d)%s%s),\n",
+			        offset_y,
+			        offset_x,
+			        (*it2).offset_idx,
+			        pal_idx,
+			        ((props >> 5) & 1) ? " | S_FLIPX" : "",
+			        ((props >> 6) & 1) ? " | S_FLIPY" : "");
+		}
+		fprintf(file, "\tMETASPR_TERM\n");
+		fprintf(file, "};\n\n");
+	}
+
+	fprintf(file, "const metasprite_t* const %s_metasprites%s[%d] = {\n\t", data_name.c_str(), suffix, (unsigned int)sprites.size());
+	for(vector< MetaSprite >::iterator it = sprites.begin(); it != sprites.end(); ++ it)
+	{
+		fprintf(file, "%s_metasprite%d%s", data_name.c_str(), (int)(it - sprites.begin()), suffix);
+		if(it + 1 != sprites.end())
+			fprintf(file, ", ");
+	}
+	fprintf(file, "\n};\n");
+}
+
+
+// Writes each metasprite frame as a ready to copy OAM block for copy_oam_frame():
+// the sprite count, then y, x, tile and props per hardware sprite. The
+// offsets are relative to the pivot instead of the previous sprite (summed
+// modulo 256, the same way the hardware wraps), and the tile origin is
+// already added since there is no base tile at runtime.
+static void export_c_oam_frames(FILE* file)
+{
+	for(vector< MetaSprite >::iterator it = sprites.begin(); it != sprites.end(); ++ it)
+	{
+		if((*it).size() > 255)
+			printf("Warning: OAM frame %d has more than 255 sprites\n", (int)(it - sprites.begin()));
+
+		fprintf(file, "const uint8_t %s_oam_frame%d[] = {\n", data_name.c_str(), (int)(it - sprites.begin()));
+		fprintf(file, "\t%d,\n", (unsigned int)((*it).size() & 0xFF));
+		int offset_x = 0;
+		int offset_y = 0;
+		for(MetaSprite::iterator it2 = (*it).begin(); it2 != (*it).end(); ++ it2)
+		{
+			offset_x += (*it2).offset_x;
+			offset_y += (*it2).offset_y;
+			fprintf(file, "\t0x%02x, 0x%02x, 0x%02x, 0x%02x,\n",
+			        (unsigned int)(offset_y & 0xFF),
+			        (unsigned int)(offset_x & 0xFF),
+			        (unsigned int)(((*it2).offset_idx + tile_origin) & 0xFF),
+			        (unsigned int)(*it2).props);
+		}
+		fprintf(file, "};\n\n");
+	}
+
+	fprintf(file, "const uint8_t* const %s_oam_frames[%d] = {\n\t", data_name.c_str(), (unsigned int)sprites.size());
+	for(vector< MetaSprite >::iterator it = sprites.begin(); it != sprites.end(); ++ it)
+	{
+		fprintf(file, "%s_oam_frame%d", data_name.c_str(), (int)(it - sprites.begin()));
+		if(it + 1 != sprites.end())
+			fprintf(file, ", ");
+	}
+	fprintf(file, "\n};\n");
+}
+
+
+// Writes the box around the hardware sprites of each metasprite frame for
+// move_metasprite_clip(): left and top relative to the pivot, then the
+// width and height. Frames without sprites get an empty box.
+static void export_c_metasprite_bounds(FILE* file)
+{
+	fprintf(file, "const metasprite_bounds_t %s_metasprite_bounds[%d] = {\n", data_name.c_str(), (unsigned int)sprites.size());
+	for(vector< MetaSprite >::iterator it = sprites.begin(); it != sprites.end(); ++ it)
+	{
+		int offset_x = 0, offset_y = 0;
+		int left = 0, top = 0, right = 0, bottom = 0;
+		for(MetaSprite::iterator it2 = (*it).begin(); it2 != (*it).end(); ++ it2)
+		{
+			offset_x += (*it2).offset_x;
+			offset_y += (*it2).offset_y;
+			if((it2 == (*it).begin()) || (offset_x < left))
+				left = offset_x;
+			if((it2 == (*it).begin()) || (offset_y < top))
+				top = offset_y;
+			if((it2 == (*it).begin()) || (offset_x + (int)image.tile_w > right))
+				right = offset_x + (int)image.tile_w;
+			if((it2 == (*it).begin()) || (offset_y + (int)image.tile_h > bottom))
+				bottom = offset_y + (int)image.tile_h;
+		}
+		if((left < -128) || (top < -128) || (right - left > 255) || (bottom - top > 255))
+			printf("Warning: metasprite frame %d is too large for its bounds\n", (int)(it - sprites.begin()));
+		fprintf(file, "\t{ %d, %d, %d, %d }%s\n", max(left, -128), max(top, -128),
+		        min(right - left, 255), min(bottom - top, 255), (it + 1 != sprites.end()) ? "," : "");
+	}
+	fprintf(file, "};\n");
+}
+
+
+// Writes one set of slot changes for anim_apply_frame(): the run count, the
+// hardware tiles and bytes per slot, then the first slot, slot count
+// and tile data of each run
+static void export_c_anim_diff(FILE* file, const char* name, const AnimDiff& diff)
+{
+	int tile_size = tiles.empty() ? 0 : (int)tiles[0].GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp).size();
+
+	fprintf(file, "const uint8_t %s[] = {\n", name);
+	fprintf(file, "\t%d, %d, %d,\n", (unsigned int)diff.size(), tiles_per_sprite(), tile_size);
+	for(AnimDiff::const_iterator it = diff.begin(); it != diff.end(); ++it)
+	{
+		fprintf(file, "\t%d, %d,\n", (unsigned int)(*it).first_slot, (unsigned int)(*it).tiles.size());
+		for(vector< size_t >::const_iterator it2 = (*it).tiles.begin(); it2 != (*it).tiles.end(); ++it2)
+		{
+			vector< unsigned char > packed_data = tiles[*it2].GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp);
+			fprintf(file, "\t");
+			for(size_t i = 0; i < packed_data.size(); ++i)
+			{
+				fprintf(file, "0x%02x,", packed_data[i]);
+				// Add a line break after each 8x8 tile
+				if((((i + 1) % (8 * bpp)) == 0) && (i + 1 != packed_data.size()))
+					fprintf(file, "\n\t");
+			}
+			fprintf(file, "\n");
+		}
+	}
+	fprintf(file, "};\n\n");
+}
+
+static void export_c_anim_diffs(FILE* file)
+{
+	export_c_anim_diff(file, (data_name + "_anim_init").c_str(), anim_init);
+	for(size_t f = 0; f < anim_diffs.size(); ++f)
+		export_c_anim_diff(file, (data_name + "_anim_frame" + to_string(f)).c_str(), anim_diffs[f]);
+
+	fprintf(file, "const uint8_t* const %s_anim_frames[%d] = {\n\t", data_name.c_str(), (unsigned int)anim_diffs.size());
+	for(size_t f = 0; f < anim_diffs.size(); ++f)
+	{
+		fprintf(file, "%s_anim_frame%d", data_name.c_str(), (int)f);
+		if(f + 1 != anim_diffs.size())
+			fprintf(file, ", ");
+	}
+	fprintf(file, "\n};\n");
+}
+
+
+// Writes the frames of each -anim_seq sequence as anim_frame_t arrays and
+// the anim_seq_t table which anim_play() takes them from
+static void export_c_anim_seqs(FILE* file)
+{
+	for(size_t i = 0; i < anim_seqs.size(); ++i)
+	{
+		const AnimSeq& seq = anim_seqs[i];
+		fprintf(file, "const anim_frame_t %s_anim_seq_%s[%d] = {\n", data_name.c_str(), seq.name.c_str(), (unsigned int)seq.frames.size());
+		for(size_t f = 0; f < seq.frames.size(); ++f)
+			fprintf(file, "\t{ %d, %d, %d }%s\n", seq.frames[f].frame, seq.frames[f].ticks, seq.frames[f].event, (f + 1 != seq.frames.size()) ? "," : "");
+		fprintf(file, "};\n\n");
+	}
+
+	fprintf(file, "const anim_seq_t %s_anim_seqs[%d] = {\n", data_name.c_str(), (unsigned int)anim_seqs.size());
+	for(size_t i = 0; i < anim_seqs.size(); ++i)
+	{
+		const AnimSeq& seq = anim_seqs[i];
+		fprintf(file, "\t{ %s_anim_seq_%s, %d, %s }%s\n", data_name.c_str(), seq.name.c_str(), (unsigned int)seq.frames.size(),
+		        seq.loop ? "ANIM_LOOP" : "0", (i + 1 != anim_seqs.size()) ? "," : "");
+	}
+	fprintf(file, "};\n");
+}
+
+
+// Writes the metatile tiles, attributes and map
+static void export_c_metatiles(FILE* file)
+{
+	size_t n = metatile_size * metatile_size;
+
+	fprintf(file, "\n");
+	fprintf(file, "const unsigned char %s_metatiles[%d] = {\n", data_name.c_str(), (unsigned int)metatiles.size());
+	for(size_t i = 0; i < metatiles.size(); i += n)
+	{
+		fprintf(file, "\t");
+		for(size_t j = 0; j < n; ++j)
+			fprintf(file, "0x%02x,", metatiles[i + j]);
+		fprintf(file, "\n");
+	}
+	fprintf(file, "};\n");
+
+	if(metatile_attributes.size())
+	{
+		fprintf(file, "\n");
+		fprintf(file, "const unsigned char %s_metatile_attributes[%d] = {\n", data_name.c_str(), (unsigned int)metatile_attributes.size());
+		for(size_t i = 0; i < metatile_attributes.size(); i += n)
+		{
+			fprintf(file, "\t");
+			for(size_t j = 0; j < n; ++j)
+				fprintf(file, "0x%02x,", metatile_attributes[i + j]);
+			fprintf(file, "\n");
+		}
+		fprintf(file, "};\n");
+	}
+
+	fprintf(file, "\n");
+	fprintf(file, "const unsigned char %s_metatile_map[%d] = {\n", data_name.c_str(), (unsigned int)metatile_map.size());
+	if (output_transposed) {
+		for(size_t i = 0; i < metatile_map_width; ++i)
+		{
+			fprintf(file, "\t");
+			for(size_t j = 0; j < metatile_map_height; ++j)
+				fprintf(file, "0x%02x,", metatile_map[j * metatile_map_width + i]);
+			fprintf(file, "\n");
+		}
+	}
+	else {
+		for(size_t j = 0; j < metatile_map_height; ++j)
+		{
+			fprintf(file, "\t");
+			for(size_t i = 0; i < metatile_map_width; ++i)
+				fprintf(file, "0x%02x,", metatile_map[j * metatile_map_width + i]);
+			fprintf(file, "\n");
+		}
+	}
+	fprintf(file, "};\n");
+}
+
+// C array data is formatted into a string a row at a time, with a lookup
+// table for the hex digits, and written out with one fwrite() per array
+static const char hex_digits[] = "0123456789abcdef";
+
+static inline void append_hex(string& out, unsigned char value)
+{
+	const char hex[4] = { '0', 'x', hex_digits[value >> 4], hex_digits[value & 0xF] };
+	out.append(hex, sizeof(hex));
+}
+
+static inline void append_dec(string& out, unsigned int value)
+{
+	char dec[10];
+	int len = 0;
+
+	do {
+		dec[len++] = (char)('0' + (value % 10));
+		value /= 10;
+	} while(value);
+	while(len)
+		out += dec[--len];
+}
+
+// Appends "\t0x..,0x..,\n" for count bytes, taken every stride bytes from data
+static void append_hex_row(string& out, const unsigned char* data, size_t count, size_t stride)
+{
+	out += '\t';
+	for(size_t i = 0; i < count; ++i, data += stride)
+	{
+		append_hex(out, *data);
+		out += ',';
+	}
+	out += '\n';
+}
+
+static void write_buffer(FILE* file, string& out)
+{
+	fwrite(out.data(), 1, out.size(), file);
+	out.clear();
+}
+
+// The arrays written as .bin files for -incbin, the same bytes as the C arrays
+static bool write_bin_file(const string& filename, const vector< unsigned char >& data)
+{
+	FILE* file = OpenOutput(filename, "wb");
+	if(!file) {
+		printf("Error writing file: %s", filename.c_str());
+		return false;
+	}
+	if(data.size())
+		fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+	return true;
+}
+
+// The packed data of tiles[first] up to tiles[last - 1]
+static vector< unsigned char > get_tiles_data(size_t first, size_t last)
+{
+	vector< unsigned char > data;
+	for(vector< Tile >::iterator it = tiles.begin() + first; it != tiles.begin() + last; ++it)
+	{
+		vector< unsigned char > packed_data = (*it).GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp);
+		data.insert(data.end(), packed_data.begin(), packed_data.end());
+	}
+	return data;
+}
+
+#define CHR_TILE_SIZE          16
+#define CHR_PATTERN_TABLE_SIZE 4096
+
+// Number of 4K pattern tables the -chr_rom tiles and -tile_origin take up
+static size_t chr_rom_banks(void)
+{
+	size_t size = (tile_origin + ((tiles.size() - source_tileset_size) * (image.tile_h >> 3) * (image.tile_w >> 3))) * CHR_TILE_SIZE;
+	return (size + CHR_PATTERN_TABLE_SIZE - 1) / CHR_PATTERN_TABLE_SIZE;
+}
+
+// The tiles as NES pattern table data for -chr_rom: the 8 bytes of plane 0
+// of a tile, then the 8 bytes of plane 1 (the GB format interleaves them)
+bool export_chr_file(void)
+{
+	vector< unsigned char > gb_data = get_tiles_data(source_tileset_size, tiles.size());
+	vector< unsigned char > data(tile_origin * CHR_TILE_SIZE, 0);
+
+	for(size_t t = 0; t + CHR_TILE_SIZE <= gb_data.size(); t += CHR_TILE_SIZE)
+		for(int plane = 0; plane < 2; ++plane)
+			for(int row = 0; row < 8; ++row)
+				data.push_back(gb_data[t + (row * 2) + plane]);
+	data.resize(chr_rom_banks() * CHR_PATTERN_TABLE_SIZE, 0);
+	return write_bin_file(output_filename_chr, data);
+}
+
+// Rows of width bytes, or columns with -transposed
+static vector< unsigned char > get_grid_data(const vector< unsigned char >& grid, size_t width, size_t height)
+{
+	vector< unsigned char > data;
+	data.reserve(width * height);
+	if(output_transposed) {
+		for(size_t i = 0; i < width; ++i)
+			for(size_t j = 0; j < height; ++j)
+				data.push_back(grid[j * width + i]);
+	}
+	else
+		data.insert(data.end(), grid.begin(), grid.begin() + (width * height));
+	return data;
+}
+
+static void export_c_tiles(FILE* file, string& out, const char* suffix, size_t first, size_t last)
+{
+	fprintf(file, "const uint8_t %s%s[%d] = {\n", data_name.c_str(), suffix, (unsigned int)((last - first) * image.tile_w * image.tile_h * bpp / 8));
+	out += '\t';
+	for (vector< Tile >::iterator it = tiles.begin() + first; it != tiles.begin() + last; ++it)
+	{
+
+		int line_break = 1; // Start with 1 to prevent line break on first iteration
+		vector< unsigned char > packed_data = (*it).GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp);
+		for(vector< unsigned char >::iterator it2 = packed_data.begin(); it2 != packed_data.end(); ++it2)
+		{
+			append_hex(out, *it2);
+			if((it + 1) != tiles.begin() + last || (it2 + 1) != packed_data.end())
+				out += ',';
+			// Add a line break after each 8x8 tile
+			if (((line_break++) % (8 / bpp)) == 0)
+				out += "\n\t";
+		}
+
+		if (!export_as_map)
+			out += '\n';
+	}
+	write_buffer(file, out);
+	fprintf(file, "};\n\n");
+}
+
+static void export_c_incbin(FILE* file, const char* suffix, const string& filename)
+{
+	fprintf(file, "INCBIN(%s%s, \"%s\")\n", data_name.c_str(), suffix, filename.c_str());
+}
+
 bool export_c_file(void) {
 
+	string out;
+
 	FILE* file;
 
-	file = fopen(output_filename.c_str(), "w");
+	file = OpenOutput(output_filename, "w");
 	if(!file) {
 		printf("Error writing file: %s", output_filename.c_str() );
 		return false;
@@ -1255,6 +4213,14 @@ bool export_c_file(void) {
 	fprintf(file, "#include <stdint.h>\n");
 	fprintf(file, "#include <gbdk/platform.h>\n");
 	fprintf(file, "#include <gbdk/metasprites.h>\n");
+	if(spawn_map_file.size())
+		fprintf(file, "#include <gbdk/spawn.h>\n");
+	if(anim_seq_file.size())
+		fprintf(file, "#include <gbdk/anim.h>\n");
+	if(export_metasprite_bounds && !export_as_map)
+		fprintf(file, "#include <gbdk/metasprite_clip.h>\n");
+	if (output_incbin)
+		fprintf(file, "#include <gbdk/incbin.h>\n");
 	fprintf(file, "\n");
 
 	fprintf(file, "BANKREF(%s)\n\n", data_name.c_str());
@@ -1273,13 +4239,16 @@ bool export_c_file(void) {
 				fprintf(file, "\t");
 
 				unsigned char* pal_ptr = &image.palette[i * (image.colors_per_pal * RGBA32_SZ)];
+				unsigned char nes_pal[NES_PALETTE_COLORS_MAX];
+				bool nes_sub_pal = convert_rgb_to_nes && (image.colors_per_pal <= NES_PALETTE_COLORS_MAX);
+				if (nes_sub_pal)
+					rgba_to_nes_palette(pal_ptr, (int)image.colors_per_pal, nes_pal);
 				for(int c = 0; c < (int)image.colors_per_pal; ++ c, pal_ptr += RGBA32_SZ)
 				{
-					size_t rgb222 = (((pal_ptr[2] >> 6) & 0x3) << 4) |
-									(((pal_ptr[1] >> 6) & 0x3) << 2) |
-									(((pal_ptr[0] >> 6) & 0x3) << 0);
-					if (convert_rgb_to_nes)
-						fprintf(file, "0x%0X", rgb_to_nes[rgb222]);
+					if (nes_sub_pal)
+						fprintf(file, "0x%0X", nes_pal[c]);
+					else if (convert_rgb_to_nes)
+						fprintf(file, "0x%0X", rgb_to_nes_color(pal_ptr[0], pal_ptr[1], pal_ptr[2]));
 					else
 						fprintf(file, "RGB8(%3d,%3d,%3d)", pal_ptr[0], pal_ptr[1], pal_ptr[2]);
 					if(c != (int)image.colors_per_pal - 1)
@@ -1292,64 +4261,67 @@ bool export_c_file(void) {
 			fprintf(file, "\n};\n");
 	}
 
-	if (includeTileData) {
+	if (includeTileData && output_incbin) {
 		fprintf(file, "\n");
-		fprintf(file, "const uint8_t %s_tiles[%d] = {\n", data_name.c_str(), (unsigned int)((tiles.size()-source_tileset_size) * image.tile_w * image.tile_h * bpp / 8));
-		fprintf(file, "\t");
-		for (vector< Tile >::iterator it = tiles.begin()+ source_tileset_size; it != tiles.end(); ++it)
+		if (!write_bin_file(output_filename_tiles_bin, get_tiles_data(source_tileset_size, vram_bank0_size()))) { fclose(file); return false; }
+		export_c_incbin(file, "_tiles", output_filename_tiles_bin);
+		if (tile_count_bank1()) {
+			if (!write_bin_file(output_filename_tiles_bank1_bin, get_tiles_data(vram_bank0_size(), tiles.size()))) { fclose(file); return false; }
+			export_c_incbin(file, "_tiles_bank1", output_filename_tiles_bank1_bin);
+		}
+		fprintf(file, "\n");
+	}
+	else if (includeTileData) {
+		fprintf(file, "\n");
+		export_c_tiles(file, out, "_tiles", source_tileset_size, vram_bank0_size());
+		if (tile_count_bank1())
+			export_c_tiles(file, out, "_tiles_bank1", vram_bank0_size(), tiles.size());
+	}
+
+	if(includedMapOrMetaspriteData) {
+
+		if(!export_as_map)
 		{
+			export_c_metasprites(file, "", false, false);
 
-			int line_break = 1; // Start with 1 to prevent line break on first iteration
-			vector< unsigned char > packed_data = (*it).GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp);
-			for(vector< unsigned char >::iterator it2 = packed_data.begin(); it2 != packed_data.end(); ++it2)
+			if(export_metasprite_flips)
 			{
-				fprintf(file, "0x%02x", (*it2));
-				if((it + 1) != tiles.end() || (it2 + 1) != packed_data.end())
-					fprintf(file, ",");
-				// Add a line break after each 8x8 tile
-				if (((line_break++) % (8 / bpp)) == 0)
-					fprintf(file, "\n\t");
+				fprintf(file, "\n");
+				export_c_metasprites(file, "_flipx", true, false);
+				fprintf(file, "\n");
+				export_c_metasprites(file, "_flipy", false, true);
+				fprintf(file, "\n");
+				export_c_metasprites(file, "_flipxy", true, true);
+
+				fprintf(file, "\nconst metasprite_t* const* const %s_metasprites_flips[4] = {\n", data_name.c_str());
+				fprintf(file, "\t%s_metasprites, %s_metasprites_flipx, %s_metasprites_flipy, %s_metasprites_flipxy\n",
+				        data_name.c_str(), data_name.c_str(), data_name.c_str(), data_name.c_str());
+				fprintf(file, "};\n");
 			}
 
-			if ((!export_as_map) && (it != tiles.end()))
+			if(export_oam_frames)
+			{
 				fprintf(file, "\n");
-		}
-		fprintf(file, "};\n\n");
-	}
+				export_c_oam_frames(file);
+			}
 
-	if(includedMapOrMetaspriteData) {
+			if(export_metasprite_bounds)
+			{
+				fprintf(file, "\n");
+				export_c_metasprite_bounds(file);
+			}
 
-		if(!export_as_map)
-		{
-			for(vector< MetaSprite >::iterator it = sprites.begin(); it != sprites.end(); ++ it)
-			{
-				fprintf(file, "const metasprite_t %s_metasprite%d[] = {\n", data_name.c_str(), (int)(it - sprites.begin()));
-				for(MetaSprite::iterator it2 = (*it).begin(); it2 != (*it).end(); ++ it2)
-				{                    
-					int pal_idx = (*it2).props & 0xF;
-                    int flip_x = ((*it2).props >> 5) & 1;
-                    int flip_y = ((*it2).props >> 6) & 1;
-					fprintf(file,
-					        "\tMETASPR_ITEM(%d, %d, %d, S_PAL(%d)%s%s),\n",
-					        (*it2).offset_y,
-					        (*it2).offset_x,
-					        (*it2).offset_idx,
-					        pal_idx,
-					        flip_x ? " | S_FLIPX" : "",
-					        flip_y ? " | S_FLIPY" : "");
-				}
-				fprintf(file, "\tMETASPR_TERM\n");
-				fprintf(file, "};\n\n");
+			if(export_anim_diffs)
+			{
+				fprintf(file, "\n");
+				export_c_anim_diffs(file);
 			}
 
-			fprintf(file, "const metasprite_t* const %s_metasprites[%d] = {\n\t", data_name.c_str(), (unsigned int)sprites.size());
-			for(vector< MetaSprite >::iterator it = sprites.begin(); it != sprites.end(); ++ it)
+			if(anim_seq_file.size())
 			{
-				fprintf(file, "%s_metasprite%d", data_name.c_str(), (int)(it - sprites.begin()));
-				if(it + 1 != sprites.end())
-					fprintf(file, ", ");
+				fprintf(file, "\n");
+				export_c_anim_seqs(file);
 			}
-			fprintf(file, "\n};\n");
 
 			if(use_structs)
 			{
@@ -1402,65 +4374,141 @@ bool export_c_file(void) {
 				}
 			}
 
-			//Export map
-			fprintf(file, "\n");
-			fprintf(file, "const unsigned char %s_map[%d] = {\n", data_name.c_str(), (unsigned int)map.size());
-			size_t line_size = map.size() / (image.h / 8);
-			if (output_transposed) {
+			if(metatile_size)
+			{
+				export_c_metatiles(file);
+			}
+			else
+			{
+				//Export map
+				fprintf(file, "\n");
+				size_t line_size = map.size() / map_lines();
+				if (output_incbin) {
+					if (!write_bin_file(output_filename_bin, get_grid_data(map, line_size, map_lines()))) { fclose(file); return false; }
+					export_c_incbin(file, "_map", output_filename_bin);
+				}
+				else {
+					fprintf(file, "const unsigned char %s_map[%d] = {\n", data_name.c_str(), (unsigned int)map.size());
+					if (output_transposed) {
+						for(size_t i = 0; i < line_size; ++i)
+							append_hex_row(out, &map[i], image.h / 8, line_size);
+					}
+					else {
+						for (size_t j = 0; j < map_lines(); ++j)
+							append_hex_row(out, &map[j * line_size], line_size, 1);
+					}
+					write_buffer(file, out);
+					fprintf(file, "};\n");
+				}
+			}
 
-				for(size_t i = 0; i < line_size; ++i)
+			if(tile_usage_w)
+			{
+				size_t line_size = image.w / 8;
+				fprintf(file, "\n");
+				fprintf(file, "const uint16_t %s_map_ids[%d] = {\n", data_name.c_str(), (unsigned int)map_tile_ids.size());
+				for(size_t j = 0; j < image.h / 8; ++j)
 				{
-					fprintf(file, "\t");
-					for (size_t j = 0; j < image.h / 8; ++j)
+					out += '\t';
+					for(size_t i = 0; i < line_size; ++i)
 					{
-						fprintf(file, "0x%02x,", map[j * line_size + i]);
+						append_dec(out, (unsigned int)map_tile_ids[j * line_size + i]);
+						out += ',';
 					}
+					out += '\n';
+				}
+				write_buffer(file, out);
+				fprintf(file, "};\n");
+
+				// One line per region, the offsets index the regions row by row
+				vector< uint16_t > usage, offsets;
+				GetTileUsage(usage, offsets);
+				fprintf(file, "\n");
+				fprintf(file, "const uint16_t %s_tile_usage[%d] = {\n", data_name.c_str(), (unsigned int)usage.size());
+				for(size_t r = 0; r + 1 < offsets.size(); ++r)
+				{
+					fprintf(file, "\t");
+					for(size_t i = offsets[r]; i < offsets[r + 1]; ++i)
+						fprintf(file, "%d,", usage[i]);
 					fprintf(file, "\n");
 				}
+				fprintf(file, "};\n");
+				fprintf(file, "\n");
+				fprintf(file, "const uint16_t %s_tile_usage_offsets[%d] = {\n\t", data_name.c_str(), (unsigned int)offsets.size());
+				for(size_t r = 0; r < offsets.size(); ++r)
+					fprintf(file, "%d,", offsets[r]);
+				fprintf(file, "\n};\n");
 			}
-			else {
 
-				for (size_t j = 0; j < image.h / 8; ++j)
+			if(collision_bits)
+			{
+				vector< uint8_t > collision = GetCollisionData();
+				size_t row_bytes = (size_t)1 << collision_row_shift();
+				fprintf(file, "\n");
+				fprintf(file, "const uint8_t %s_collision[%d] = {\n", data_name.c_str(), (unsigned int)collision.size());
+				for(size_t j = 0; j < collision.size(); j += row_bytes)
 				{
-					fprintf(file, "\t");
-					for (size_t i = 0; i < line_size; ++i)
+					out += '\t';
+					for(size_t i = j; i < j + row_bytes; ++i)
 					{
-						fprintf(file, "0x%02x,", map[j * line_size + i]);
+						append_hex(out, collision[i]);
+						out += ',';
 					}
-					fprintf(file, "\n");
+					out += '\n';
 				}
+				write_buffer(file, out);
+				fprintf(file, "};\n");
+			}
+
+			if(spawn_map_file.size())
+			{
+				fprintf(file, "\n");
+				fprintf(file, "const spawn_t %s_spawns[%d] = {\n", data_name.c_str(), (unsigned int)spawn_entries.size());
+				for(size_t i = 0; i < spawn_entries.size(); ++i)
+					fprintf(file, "\t{%d,%d,%d},\n", (unsigned int)spawn_entries[i].x, (unsigned int)spawn_entries[i].y, spawn_entries[i].type);
+				fprintf(file, "};\n");
+				fprintf(file, "\n");
+				fprintf(file, "const uint16_t %s_spawn_buckets[%d] = {\n\t", data_name.c_str(), (unsigned int)spawn_buckets.size());
+				for(size_t i = 0; i < spawn_buckets.size(); ++i)
+					fprintf(file, "%d,", spawn_buckets[i]);
+				fprintf(file, "\n};\n");
+				fprintf(file, "\n");
+				fprintf(file, "const spawn_list_t %s_spawn_list = {\n\t%s_spawns, %s_spawn_buckets, %d, %d\n};\n", data_name.c_str(), data_name.c_str(),
+				        data_name.c_str(), (unsigned int)spawn_entries.size(), (unsigned int)spawn_buckets.size() - 1);
 			}
-			fprintf(file, "};\n");
 
 
 			//Export map attributes (if any)
-			if(use_map_attributes && map_attributes.size())
+			if(export_map_attributes())
 			{
 				fprintf(file, "\n");
-				fprintf(file, "const unsigned char %s_map_attributes[%d] = {\n", data_name.c_str(), (unsigned int)map_attributes.size());
-				if (output_transposed) {
-					for (size_t i = 0; i < map_attributes_packed_width; ++i)
-					{
-						fprintf(file, "\t");
-						for (size_t j = 0; j < map_attributes_packed_height; ++j)
-						{
-							fprintf(file, "0x%02x,", map_attributes[j * map_attributes_packed_width + i]);
-						}
-						fprintf(file, "\n");
-					}
+				if (output_incbin) {
+					if (!write_bin_file(output_filename_attributes_bin, get_grid_data(map_attributes, map_attributes_line_size(), map_attributes_lines()))) { fclose(file); return false; }
+					export_c_incbin(file, "_map_attributes", output_filename_attributes_bin);
 				}
 				else {
-					for (size_t j = 0; j < map_attributes_packed_height; ++j)
-					{
-						fprintf(file, "\t");
+					fprintf(file, "const unsigned char %s_map_attributes[%d] = {\n", data_name.c_str(), (unsigned int)map_attributes.size());
+					if (output_transposed) {
 						for (size_t i = 0; i < map_attributes_packed_width; ++i)
-						{
-							fprintf(file, "0x%02x,", map_attributes[j * map_attributes_packed_width + i]);
-						}
-						fprintf(file, "\n");
+							append_hex_row(out, &map_attributes[i], map_attributes_packed_height, map_attributes_packed_width);
 					}
+					else {
+						for (size_t j = 0; j < map_attributes_lines(); ++j)
+							append_hex_row(out, &map_attributes[j * map_attributes_line_size()], map_attributes_line_size(), 1);
+					}
+					write_buffer(file, out);
+					fprintf(file, "};\n");
 				}
+			}
 
+			if(export_nes_attribute_tables)
+			{
+				vector< unsigned char > tables = GetNesAttributeTables();
+				fprintf(file, "\n");
+				fprintf(file, "const unsigned char %s_attribute_tables[%d] = {\n", data_name.c_str(), (unsigned int)tables.size());
+				for(size_t j = 0; j < tables.size(); j += NES_ATTRIBUTE_TABLE_W)
+					append_hex_row(out, &tables[j], NES_ATTRIBUTE_TABLE_W, 1);
+				write_buffer(file, out);
 				fprintf(file, "};\n");
 			}
 
@@ -1491,28 +4539,191 @@ bool export_c_file(void) {
 }
 
 
-bool export_map_binary() {
+// Appends .db or .dw lines, 16 values per line to stay well inside the assembler line length
+static void append_asm_data(string& out, bool words, const vector< uint16_t >& data)
+{
+	for(size_t i = 0; i < data.size(); ++i)
+	{
+		if((i % 16) == 0)
+			out += (words) ? "\t.dw " : "\t.db ";
+		else
+			out += ',';
+		if(words) {
+			append_hex(out, (unsigned char)(data[i] >> 8));
+			out += hex_digits[(data[i] >> 4) & 0xF];
+			out += hex_digits[data[i] & 0xF];
+		}
+		else
+			append_hex(out, (unsigned char)data[i]);
+		if(((i % 16) == 15) || (i + 1 == data.size()))
+			out += '\n';
+	}
+}
 
-		std::ofstream mapBinaryFile, mapAttributesBinaryfile,tilesBinaryFile;
-		mapBinaryFile.open(output_filename_bin, std::ios_base::binary);
-		tilesBinaryFile.open(output_filename_tiles_bin, std::ios_base::binary);
+static void export_asm_array(FILE* file, string& out, const char* suffix, bool words, const vector< uint16_t >& data)
+{
+	out += "\n_";
+	out += data_name;
+	out += suffix;
+	out += "::\n";
+	append_asm_data(out, words, data);
+	write_buffer(file, out);
+}
+
+// Writes the same symbols as export_c_file() does for a map, as sdas source.
+// The data goes in _CODE_<bank> (_CODE without -b) and ___bank_<name> holds
+// the bank, which bankpack updates the same way as for a BANKREF() with -b 255
+bool export_asm_file(void) {
+
+	string out;
+	vector< uint16_t > data;
+	vector< unsigned char > bytes;
+	vector< string > symbols;
+	vector< uint16_t > usage, offsets;
+	bool export_palettes = include_palettes && (image.total_color_count - source_total_color_count > 0 || !use_source_tileset);
+
+	FILE* file = OpenOutput(output_filename_asm, "w");
+	if(!file) {
+		printf("Error writing file: %s", output_filename_asm.c_str());
+		return false;
+	}
 
-		for (vector< Tile >::iterator it = tiles.begin() + source_tileset_size; it != tiles.end(); ++it)
+	if(export_palettes) symbols.push_back("_palettes");
+	if(includeTileData) symbols.push_back("_tiles");
+	if(includeTileData && tile_count_bank1()) symbols.push_back("_tiles_bank1");
+	if(includedMapOrMetaspriteData)
+	{
+		symbols.push_back("_map");
+		if(tile_usage_w)
+		{
+			symbols.push_back("_map_ids");
+			symbols.push_back("_tile_usage");
+			symbols.push_back("_tile_usage_offsets");
+		}
+		if(collision_bits) symbols.push_back("_collision");
+		if(spawn_map_file.size())
 		{
+			symbols.push_back("_spawns");
+			symbols.push_back("_spawn_buckets");
+			symbols.push_back("_spawn_list");
+		}
+		if(export_map_attributes()) symbols.push_back("_map_attributes");
+	}
 
-			vector< unsigned char > packed_data = (*it).GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp);
-			for (vector< unsigned char >::iterator it2 = packed_data.begin(); it2 != packed_data.end(); ++it2)
-			{
+	fprintf(file, ";; AUTOGENERATED FILE FROM png2asset\n\n");
+	fprintf(file, "\t.module %s\n\n", data_name.c_str());
+	fprintf(file, "\t.globl ___bank_%s\n", data_name.c_str());
+	for(size_t i = 0; i < symbols.size(); ++i)
+		fprintf(file, "\t.globl _%s%s\n", data_name.c_str(), symbols[i].c_str());
+	fprintf(file, "\n___bank_%s = %d\n\n", data_name.c_str(), (bank >= 0) ? bank : 0);
+	if(bank >= 0)
+		fprintf(file, "\t.area _CODE_%d\n", bank);
+	else
+		fprintf(file, "\t.area _CODE\n");
+
+	if(export_palettes)
+	{
+		// RGB8() from gb/cgb.h
+		for(size_t i = (source_total_color_count / image.colors_per_pal) * image.colors_per_pal; i < image.total_color_count; ++i)
+		{
+			unsigned char* rgb = &image.palette[i * RGBA32_SZ];
+			data.push_back((uint16_t)(((rgb[2] >> 3) << 10) | ((rgb[1] >> 3) << 5) | (rgb[0] >> 3)));
+		}
+		export_asm_array(file, out, "_palettes", true, data);
+	}
+
+	if(includeTileData)
+	{
+		bytes = get_tiles_data(source_tileset_size, vram_bank0_size());
+		data.assign(bytes.begin(), bytes.end());
+		export_asm_array(file, out, "_tiles", false, data);
+		if(tile_count_bank1())
+		{
+			bytes = get_tiles_data(vram_bank0_size(), tiles.size());
+			data.assign(bytes.begin(), bytes.end());
+			export_asm_array(file, out, "_tiles_bank1", false, data);
+		}
+	}
+
+	if(includedMapOrMetaspriteData)
+	{
+		size_t line_size = map.size() / map_lines();
+		bytes = get_grid_data(map, line_size, map_lines());
+		data.assign(bytes.begin(), bytes.end());
+		export_asm_array(file, out, "_map", false, data);
+
+		if(tile_usage_w)
+		{
+			data.assign(map_tile_ids.begin(), map_tile_ids.end());
+			export_asm_array(file, out, "_map_ids", true, data);
+			GetTileUsage(usage, offsets);
+			export_asm_array(file, out, "_tile_usage", true, usage);
+			export_asm_array(file, out, "_tile_usage_offsets", true, offsets);
+		}
+
+		if(collision_bits)
+		{
+			bytes = GetCollisionData();
+			data.assign(bytes.begin(), bytes.end());
+			export_asm_array(file, out, "_collision", false, data);
+		}
 
-				const char chars[] = { (const char)(*it2) };
-				tilesBinaryFile.write(chars, 1);
+		if(spawn_map_file.size())
+		{
+			// spawn_t: 16 bit x, then y and type
+			data.clear();
+			for(size_t i = 0; i < spawn_entries.size(); ++i)
+			{
+				data.push_back(spawn_entries[i].x & 0xFF);
+				data.push_back(spawn_entries[i].x >> 8);
+				data.push_back((uint16_t)spawn_entries[i].y);
+				data.push_back(spawn_entries[i].type);
 			}
+			export_asm_array(file, out, "_spawns", false, data);
+			export_asm_array(file, out, "_spawn_buckets", true, spawn_buckets);
+			out += "\n_" + data_name + "_spawn_list::\n";
+			out += "\t.dw _" + data_name + "_spawns, _" + data_name + "_spawn_buckets\n";
+			out += "\t.dw " + std::to_string(spawn_entries.size()) + ", " + std::to_string(spawn_buckets.size() - 1) + "\n";
+			write_buffer(file, out);
+		}
+
+		if(export_map_attributes())
+		{
+			bytes = get_grid_data(map_attributes, map_attributes_line_size(), map_attributes_lines());
+			data.assign(bytes.begin(), bytes.end());
+			export_asm_array(file, out, "_map_attributes", false, data);
+		}
+	}
+
+	fclose(file);
+
+	return true; // success
+}
+
+
+bool export_map_binary() {
 
+		std::ofstream mapBinaryFile, mapAttributesBinaryfile,tilesBinaryFile;
+		mapBinaryFile.open(output_filename_bin, std::ios_base::binary);
+		tilesBinaryFile.open(output_filename_tiles_bin, std::ios_base::binary);
+		output_files.push_back(output_filename_bin);
+		output_files.push_back(output_filename_tiles_bin);
+
+		vector< unsigned char > tiles_data = get_tiles_data(source_tileset_size, vram_bank0_size());
+		tilesBinaryFile.write((const char*)tiles_data.data(), tiles_data.size());
+		if (tile_count_bank1()) {
+			std::ofstream tilesBank1BinaryFile(output_filename_tiles_bank1_bin, std::ios_base::binary);
+			output_files.push_back(output_filename_tiles_bank1_bin);
+			tiles_data = get_tiles_data(vram_bank0_size(), tiles.size());
+			tilesBank1BinaryFile.write((const char*)tiles_data.data(), tiles_data.size());
 		}
 
 
 		// Open our file for writing attributes if specified
-		if (use_map_attributes)mapAttributesBinaryfile.open(output_filename_attributes_bin, std::ios_base::binary);
+		if (use_map_attributes) {
+			mapAttributesBinaryfile.open(output_filename_attributes_bin, std::ios_base::binary);
+			output_files.push_back(output_filename_attributes_bin);
+		}
 
 		int columns = image.w >> 3;
 		int rows = image.h >> 3;
@@ -1539,9 +4750,9 @@ bool export_map_binary() {
 		}
 		else {
 
-			// Write the arrays as-is, row-by-row
-			mapBinaryFile.write((const char*)(&map[0]), rows * columns);
-			if (use_map_attributes)mapAttributesBinaryfile.write((const char*)(&map_attributes[0]), rows * columns);
+			// Write the arrays as-is, row-by-row (or chunk by chunk)
+			mapBinaryFile.write((const char*)map.data(), map.size());
+			if (use_map_attributes)mapAttributesBinaryfile.write((const char*)map_attributes.data(), map_attributes.size());
 		}
 
 		// Finalize the files
@@ -1551,3 +4762,320 @@ bool export_map_binary() {
 
 	return true; // success
 }
+
+
+// -bin_packed: the sections of gbdk/packed_map.h, the layout of the header and
+// the values of the section types and compressions have to match it
+#define PACKED_MAP_HEADER_SIZE  16
+#define PACKED_MAP_SECTION_SIZE 6
+#define PACKED_MAP_VERSION      1
+#define PACKED_MAP_TRANSPOSED   0x01
+#define PACKED_MAP_INTERLEAVED  0x02
+
+enum PackedSectionType { SECTION_TILES = 1, SECTION_TILES_BANK1, SECTION_MAP, SECTION_ATTRIBUTES, SECTION_PALETTES };
+
+struct PackedSection
+{
+	unsigned char type;
+	unsigned char compression; // PACKED_NONE, PACKED_GB or PACKED_RLE
+	size_t size;               // Before compression
+	vector< unsigned char > data;
+};
+
+static void PushU16(vector< unsigned char >& out, size_t value)
+{
+	out.push_back((unsigned char)(value & 0xFF));
+	out.push_back((unsigned char)((value >> 8) & 0xFF));
+}
+
+// Compresses data with -bin_compress, auto keeps the smallest (the faster one to decompress on a tie)
+static PackedSection PackSection(unsigned char type, const vector< unsigned char >& data, PackedCompression compression)
+{
+	PackedSection section = { type, PACKED_NONE, data.size(), data };
+
+	if((compression == PACKED_RLE) || (compression == PACKED_AUTO))
+	{
+		vector< unsigned char > rle = RleCompress(data);
+		if((compression == PACKED_RLE) || (rle.size() < section.data.size()))
+		{
+			section.compression = PACKED_RLE;
+			section.data.swap(rle);
+		}
+	}
+	if((compression == PACKED_GB) || (compression == PACKED_AUTO))
+	{
+		vector< unsigned char > gb = GbCompress(data);
+		if((compression == PACKED_GB) || (gb.size() < section.data.size()))
+		{
+			section.compression = PACKED_GB;
+			section.data.swap(gb);
+		}
+	}
+	return section;
+}
+
+bool export_map_packed() {
+
+	vector< PackedSection > sections;
+	bool interleaved = use_map_attributes && (pack_mode == Tile::SMS);
+	size_t first_tile = tile_origin + source_tileset_size;
+	size_t palette_count = 0;
+
+	if(includeTileData)
+	{
+		if(first_tile > 255)
+		{
+			printf("Error: -bin_packed tiles must start below 256, they start at %d\n", (unsigned int)first_tile);
+			return false;
+		}
+		sections.push_back(PackSection(SECTION_TILES, get_tiles_data(source_tileset_size, vram_bank0_size()), packed_compression));
+		if(tile_count_bank1())
+			sections.push_back(PackSection(SECTION_TILES_BANK1, get_tiles_data(vram_bank0_size(), tiles.size()), packed_compression));
+	}
+
+	size_t line_size = map.size() / map_lines();
+	sections.push_back(PackSection(SECTION_MAP, get_grid_data(map, line_size, map_lines()), packed_compression));
+	if(use_map_attributes && !interleaved)
+		sections.push_back(PackSection(SECTION_ATTRIBUTES, get_grid_data(map_attributes, map_attributes_line_size(), map_attributes_lines()), packed_compression));
+
+	// CGB palettes as RGB555 words, the SMS and GG color formats differ and can't be told apart here
+	if(include_palettes && (pack_mode == Tile::GB) && (image.total_color_count > source_total_color_count))
+	{
+		vector< unsigned char > data;
+		for(size_t i = (source_total_color_count / image.colors_per_pal) * image.colors_per_pal; i < image.total_color_count; ++i)
+		{
+			unsigned char* rgb = &image.palette[i * RGBA32_SZ];
+			PushU16(data, ((rgb[2] >> 3) << 10) | ((rgb[1] >> 3) << 5) | (rgb[0] >> 3));
+		}
+		palette_count = data.size() / (image.colors_per_pal * 2);
+		sections.push_back(PackSection(SECTION_PALETTES, data, PACKED_NONE));
+	}
+
+	vector< unsigned char > out;
+	out.push_back('P');
+	out.push_back('M');
+	out.push_back(PACKED_MAP_VERSION);
+	out.push_back((output_transposed ? PACKED_MAP_TRANSPOSED : 0) | (interleaved ? PACKED_MAP_INTERLEAVED : 0));
+	PushU16(out, image.w / 8);
+	PushU16(out, image.h / 8);
+	PushU16(out, includeTileData ? tiles.size() - source_tileset_size : 0);
+	out.push_back((unsigned char)first_tile);
+	out.push_back((unsigned char)palette_count);
+	out.push_back((unsigned char)((bank >= 0) ? bank : 0));
+	out.push_back((unsigned char)sections.size());
+	PushU16(out, 0);
+
+	// The section table is written once the offsets are known
+	size_t offset = PACKED_MAP_HEADER_SIZE + (sections.size() * PACKED_MAP_SECTION_SIZE);
+	vector< unsigned char > data;
+	for(size_t i = 0; i < sections.size(); ++i)
+	{
+		offset = (offset + packed_align - 1) & ~(packed_align - 1);
+		if((offset + sections[i].data.size() > 0xFFFF) || (sections[i].size > 0xFFFF))
+		{
+			printf("Error: -bin_packed data is larger than 64K\n");
+			return false;
+		}
+		out.push_back(sections[i].type);
+		out.push_back(sections[i].compression);
+		PushU16(out, offset);
+		PushU16(out, sections[i].size);
+
+		data.resize(offset - PACKED_MAP_HEADER_SIZE - (sections.size() * PACKED_MAP_SECTION_SIZE), 0);
+		data.insert(data.end(), sections[i].data.begin(), sections[i].data.end());
+		offset += sections[i].data.size();
+	}
+	out.insert(out.end(), data.begin(), data.end());
+
+	return write_bin_file(output_filename_packed_bin, out);
+}
+
+// Writes a SGB border as the data of its transfers, so it can be sent without rearranging:
+// - _chr_trn_0 / _chr_trn_1: 4bpp tiles 0-127 and 128-255, one CHR_TRN block each
+// - _pct_trn: the 32x32 BG map (tile, attributes) followed by the colors of palettes 4-7
+bool export_sgb_border(void) {
+
+	if((image.w != SGB_BORDER_W) || (image.h != SGB_BORDER_H))
+	{
+		printf("Error: SGB borders must be %d x %d, the image is %d x %d\n", SGB_BORDER_W, SGB_BORDER_H, image.w, image.h);
+		return false;
+	}
+	if(tiles.size() > 256)
+	{
+		printf("Error: SGB borders can have up to 256 unique tiles, found %d\n", (unsigned int)tiles.size());
+		return false;
+	}
+
+	vector< unsigned char > chr;
+	for(vector< Tile >::iterator it = tiles.begin(); it != tiles.end(); ++it)
+	{
+		vector< unsigned char > packed_data = (*it).GetPackedData(pack_mode, image.tile_w, image.tile_h, bpp);
+		chr.insert(chr.end(), packed_data.begin(), packed_data.end());
+	}
+	size_t chr_blocks = (chr.size() + SGB_TRN_SIZE - 1) / SGB_TRN_SIZE;
+
+	// The map is 32 x 28 entries of tile and attributes, padded to 32 x 32
+	vector< unsigned char > pct(map);
+	pct.resize(SGB_PCT_MAP_SIZE, 0);
+	for(size_t i = 0; i < SGB_PCT_PALETTE_COUNT * image.colors_per_pal; ++i)
+	{
+		unsigned int color = 0;
+		if(i < image.total_color_count)
+		{
+			const unsigned char* c = &image.palette[i * RGBA32_SZ];
+			color = (c[0] >> 3) | ((c[1] >> 3) << 5) | ((c[2] >> 3) << 10);
+		}
+		pct.push_back(color & 0xFF);
+		pct.push_back(color >> 8);
+	}
+
+	FILE* file = OpenOutput(output_filename_h, "w");
+	if(!file) {
+		printf("Error writing file: %s", output_filename_h.c_str());
+		return false;
+	}
+	fprintf(file, "//AUTOGENERATED FILE FROM png2asset\n");
+	fprintf(file, "#ifndef METASPRITE_%s_H\n", data_name.c_str());
+	fprintf(file, "#define METASPRITE_%s_H\n", data_name.c_str());
+	fprintf(file, "\n");
+	fprintf(file, "#include <stdint.h>\n");
+	fprintf(file, "#include <gbdk/platform.h>\n");
+	fprintf(file, "\n");
+	fprintf(file, "#define %s_TILE_COUNT %d\n", data_name.c_str(), (unsigned int)tiles.size());
+	fprintf(file, "#define %s_CHR_TRN_COUNT %d\n", data_name.c_str(), (unsigned int)chr_blocks);
+	fprintf(file, "\n");
+	fprintf(file, "BANKREF_EXTERN(%s)\n", data_name.c_str());
+	fprintf(file, "\n");
+	for(size_t b = 0; b < chr_blocks; ++b)
+		fprintf(file, "extern const uint8_t %s_chr_trn_%d[%d];\n", data_name.c_str(), (unsigned int)b, (unsigned int)min(chr.size() - (b * SGB_TRN_SIZE), (size_t)SGB_TRN_SIZE));
+	fprintf(file, "extern const uint8_t %s_pct_trn[%d];\n", data_name.c_str(), (unsigned int)pct.size());
+	fprintf(file, "\n");
+	fprintf(file, "#endif\n");
+	fclose(file);
+
+	file = OpenOutput(output_filename, "w");
+	if(!file) {
+		printf("Error writing file: %s", output_filename.c_str());
+		return false;
+	}
+	if (bank >= 0) fprintf(file, "#pragma bank %d\n\n", bank);
+	fprintf(file, "//AUTOGENERATED FILE FROM png2asset\n\n");
+	fprintf(file, "#include <stdint.h>\n");
+	fprintf(file, "#include <gbdk/platform.h>\n");
+	fprintf(file, "\n");
+	fprintf(file, "BANKREF(%s)\n", data_name.c_str());
+	for(size_t b = 0; b < chr_blocks; ++b)
+	{
+		size_t size = min(chr.size() - (b * SGB_TRN_SIZE), (size_t)SGB_TRN_SIZE);
+		fprintf(file, "\n");
+		fprintf(file, "const uint8_t %s_chr_trn_%d[%d] = {", data_name.c_str(), (unsigned int)b, (unsigned int)size);
+		for(size_t i = 0; i < size; ++i)
+			fprintf(file, "%s0x%02x,", (i % 32) ? "" : "\n\t", chr[(b * SGB_TRN_SIZE) + i]);
+		fprintf(file, "\n};\n");
+	}
+	fprintf(file, "\n");
+	fprintf(file, "const uint8_t %s_pct_trn[%d] = {", data_name.c_str(), (unsigned int)pct.size());
+	for(size_t i = 0; i < pct.size(); ++i)
+		fprintf(file, "%s0x%02x,", (i % 32) ? "" : "\n\t", pct[i]);
+	fprintf(file, "\n};\n");
+	fclose(file);
+
+	return true; // success
+}
+
+
+// Writes the 8x8 cells of the image as variable width glyphs for gb/vwf.h:
+// - _vwf_glyphs: 8 bytes per glyph, one per row, the leftmost pixel in bit 7
+// - _vwf_widths: pixels the text advances after each glyph, the used columns
+//   and one column of spacing (at most 8), VWF_SPACE_W for empty cells
+// Pixels with color 0 of their palette are background, all others are set
+bool export_vwf_font(void) {
+
+	size_t cells_w = image.w / VWF_GLYPH_W;
+	size_t count = cells_w * (image.h / VWF_GLYPH_H);
+	if(count + vwf_first_char > 256)
+	{
+		printf("Error: the image has %d glyphs, only %d fit after the first character %d\n", (unsigned int)count, 256 - vwf_first_char, vwf_first_char);
+		return false;
+	}
+
+	vector< unsigned char > glyphs;
+	vector< unsigned char > widths;
+	for(size_t i = 0; i < count; ++i)
+	{
+		size_t x0 = (i % cells_w) * VWF_GLYPH_W;
+		size_t y0 = (i / cells_w) * VWF_GLYPH_H;
+		unsigned char used = 0;
+		for(size_t y = 0; y < VWF_GLYPH_H; ++y)
+		{
+			unsigned char row = 0;
+			for(size_t x = 0; x < VWF_GLYPH_W; ++x)
+			{
+				if(image.data[((y0 + y) * image.w) + x0 + x] % image.colors_per_pal)
+					row |= 0x80 >> x;
+			}
+			glyphs.push_back(row);
+			used |= row;
+		}
+		int width = VWF_SPACE_W;
+		if(used)
+		{
+			width = VWF_GLYPH_W;
+			while(!(used & 1))
+			{
+				used >>= 1;
+				width --;
+			}
+			width = min(width + 1, VWF_GLYPH_W);
+		}
+		widths.push_back((unsigned char)width);
+	}
+
+	FILE* file = OpenOutput(output_filename_h, "w");
+	if(!file) {
+		printf("Error writing file: %s", output_filename_h.c_str());
+		return false;
+	}
+	fprintf(file, "//AUTOGENERATED FILE FROM png2asset\n");
+	fprintf(file, "#ifndef METASPRITE_%s_H\n", data_name.c_str());
+	fprintf(file, "#define METASPRITE_%s_H\n", data_name.c_str());
+	fprintf(file, "\n");
+	fprintf(file, "#include <stdint.h>\n");
+	fprintf(file, "#include <gbdk/platform.h>\n");
+	fprintf(file, "\n");
+	fprintf(file, "#define %s_VWF_FIRST %d\n", data_name.c_str(), vwf_first_char);
+	fprintf(file, "#define %s_VWF_COUNT %d\n", data_name.c_str(), (unsigned int)count);
+	fprintf(file, "\n");
+	fprintf(file, "BANKREF_EXTERN(%s)\n", data_name.c_str());
+	fprintf(file, "\n");
+	fprintf(file, "extern const uint8_t %s_vwf_glyphs[%d];\n", data_name.c_str(), (unsigned int)glyphs.size());
+	fprintf(file, "extern const uint8_t %s_vwf_widths[%d];\n", data_name.c_str(), (unsigned int)widths.size());
+	fprintf(file, "\n");
+	fprintf(file, "#endif\n");
+	fclose(file);
+
+	file = OpenOutput(output_filename, "w");
+	if(!file) {
+		printf("Error writing file: %s", output_filename.c_str());
+		return false;
+	}
+	if (bank >= 0) fprintf(file, "#pragma bank %d\n\n", bank);
+	fprintf(file, "//AUTOGENERATED FILE FROM png2asset\n\n");
+	fprintf(file, "#include <stdint.h>\n");
+	fprintf(file, "#include <gbdk/platform.h>\n");
+	fprintf(file, "\n");
+	fprintf(file, "BANKREF(%s)\n", data_name.c_str());
+	fprintf(file, "\n");
+	fprintf(file, "const uint8_t %s_vwf_glyphs[%d] = {", data_name.c_str(), (unsigned int)glyphs.size());
+	for(size_t i = 0; i < glyphs.size(); ++i)
+		fprintf(file, "%s0x%02x,", (i % VWF_GLYPH_H) ? "" : "\n\t", glyphs[i]);
+	fprintf(file, "\n};\n");
+	fprintf(file, "\n");
+	fprintf(file, "const uint8_t %s_vwf_widths[%d] = {", data_name.c_str(), (unsigned int)widths.size());
+	for(size_t i = 0; i < widths.size(); ++i)
+		fprintf(file, "%s%d,", (i % 16) ? "" : "\n\t", widths[i]);
+	fprintf(file, "\n};\n");
+	fclose(file);
+
+	return true; // success
+}
@@ -12,9 +12,40 @@ enum {
 
 #define BIT(VALUE, INDEX) (1 & ((VALUE) >> (INDEX)))
 
+#define TILE_MAX_PIXELS (16 * 16) // Largest tile is a 16x16 MSX sprite
+
+// Indexed pixels of a tile, 8 per row, in a fixed size array so tiles
+// can be copied, compared and flipped without allocating
+struct TileData
+{
+    unsigned char pixels[TILE_MAX_PIXELS];
+    size_t count;
+
+    TileData(size_t size = 0) : count(size) { memset(pixels, 0, sizeof(pixels)); }
+    size_t size() const { return count; }
+    unsigned char& operator[](size_t i) { return pixels[i]; }
+    unsigned char operator[](size_t i) const { return pixels[i]; }
+    bool operator==(const TileData& d) const
+    {
+        return count == d.count && memcmp(pixels, d.pixels, count) == 0;
+    }
+
+    // A row of 8 pixels as one word, in memory order
+    uint64_t GetRow(size_t row) const
+    {
+        uint64_t word;
+        memcpy(&word, &pixels[row * 8], sizeof(word));
+        return word;
+    }
+    void SetRow(size_t row, uint64_t word)
+    {
+        memcpy(&pixels[row * 8], &word, sizeof(word));
+    }
+};
+
 struct Tile
 {
-    vector< unsigned char > data;
+    TileData data;
     unsigned char pal;
 
     Tile(size_t size = 0) : data(size), pal(0) {}
@@ -23,13 +54,6 @@ struct Tile
         return data == t.data && pal == t.pal;
     }
 
-    const Tile& operator=(const Tile& t)
-    {
-        data = t.data;
-        pal = t.pal;
-        return *this;
-    }
-
     enum PackMode {
         GB,
         SGB,
@@ -88,6 +112,20 @@ struct Tile
     }
 };
 
+// Hash functor for Tile so tilesets can be indexed with an unordered_map
+// (FNV-1a over the pixel rows and palette, a row at a time)
+struct TileHash
+{
+    size_t operator()(const Tile& t) const
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for(size_t j = 0; j < t.data.size() / 8; ++j)
+            hash = (hash ^ t.data.GetRow(j)) * 1099511628211ull;
+        hash = (hash ^ t.pal) * 1099511628211ull;
+        return (size_t)(hash ^ (hash >> 32));
+    }
+};
+
 struct PNGImage
 {
     vector< unsigned char > data; //data in indexed format
@@ -108,11 +146,8 @@ struct PNGImage
     size_t total_color_count; // Total number of colors across all palettes (palette_count x colors_per_pal)
     unsigned char* palette; //palette colors in RGBA (1 color == 4 bytes)
 
-private:
-    bool zero_palette = false;
-
 public:
-    unsigned char GetGBColor(int x, int y)
+    unsigned char GetGBColor(int x, int y) const
     {
         return data[w * y + x] % colors_per_pal;
     }
@@ -120,7 +155,8 @@ public:
 
     // This needs separate tile_w and tile_h params since
     // MSX tile extraction uses it to pull out the 4 sub-tiles
-    bool ExtractGBTile(int x, int y, int extract_tile_w, int extract_tile_h, Tile& tile, int buffer_offset)
+    // Only reads the image, so tiles can be extracted from several threads at once
+    bool ExtractGBTile(int x, int y, int extract_tile_w, int extract_tile_h, Tile& tile, int buffer_offset, bool zero_palette) const
     {
         // Set the palette to 0 when pals are not stored in tiles to allow tiles to be equal even when their palettes are different
         tile.pal = zero_palette ? 0 : data[w * y + x] >> 2;
@@ -138,32 +174,30 @@ public:
         return !all_zero;
     }
 
-    bool ExtractTile_MSX16x16(int x, int y, Tile& tile)
+    bool ExtractTile_MSX16x16(int x, int y, Tile& tile, bool zero_palette) const
     {
         // MSX 16x16 sprite tiles are composed of four 8x8 tiles in this order UL, LL, UR, LR
         bool UL_notempty, LL_notempty, UR_notempty, LR_notempty;
 
         // Call these separately since otherwise some get optimized out during
         // runtime if any single one before it returns false
-        UL_notempty = ExtractGBTile(x,     y,     8, 8, tile, 0);
-        LL_notempty = ExtractGBTile(x,     y + 8, 8, 8, tile, ((8 *8) * 1));
-        UR_notempty = ExtractGBTile(x + 8, y,     8, 8, tile, ((8 *8) * 2));
-        LR_notempty = ExtractGBTile(x + 8, y + 8, 8, 8, tile, ((8 *8) * 3));
+        UL_notempty = ExtractGBTile(x,     y,     8, 8, tile, 0, zero_palette);
+        LL_notempty = ExtractGBTile(x,     y + 8, 8, 8, tile, ((8 *8) * 1), zero_palette);
+        UR_notempty = ExtractGBTile(x + 8, y,     8, 8, tile, ((8 *8) * 2), zero_palette);
+        LR_notempty = ExtractGBTile(x + 8, y + 8, 8, 8, tile, ((8 *8) * 3), zero_palette);
         return (UL_notempty || LL_notempty || UR_notempty || LR_notempty);
     }
 
-    bool ExtractTile(int x, int y, Tile& tile, int sprite_mode, bool export_as_map, bool use_map_attributes)
+    bool ExtractTile(int x, int y, Tile& tile, int sprite_mode, bool export_as_map, bool use_map_attributes) const
     {
         // Set the palette to 0 when pals are not stored in tiles to allow tiles to be equal even when their palettes are different
-        zero_palette = !(export_as_map && !use_map_attributes);
+        bool zero_palette = !(export_as_map && !use_map_attributes);
 
         if (sprite_mode == SPR_16x16_MSX)
-            return ExtractTile_MSX16x16(x, y, tile);
+            return ExtractTile_MSX16x16(x, y, tile, zero_palette);
         else
-            return ExtractGBTile(x, y, tile_w, tile_h, tile, 0); // No buffer offset for normal tile extraction
+            return ExtractGBTile(x, y, tile_w, tile_h, tile, 0, zero_palette); // No buffer offset for normal tile extraction
     }
-// private:
-//     bool zero_palette = false;
 };
 
 #endif
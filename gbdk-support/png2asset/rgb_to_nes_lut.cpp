@@ -1,67 +0,0 @@
-// File auto-generated file by nespal.py
-unsigned char rgb_to_nes[64] = {
-    0x1D,   // RGB(0,0,0) -> 1D   (Black)
-    0x06,   // RGB(1,0,0) -> 06   (Dark-Red)
-    0x17,   // RGB(2,0,0) -> 17   (Medium-Orange)
-    0x16,   // RGB(3,0,0) -> 16   (Medium-Red)
-    0x19,   // RGB(0,1,0) -> 19   (Medium-Chartreuse)
-    0x18,   // RGB(1,1,0) -> 18   (Medium-Yellow)
-    0x17,   // RGB(2,1,0) -> 17   (Medium-Orange)
-    0x27,   // RGB(3,1,0) -> 27   (Light-Orange)
-    0x2A,   // RGB(0,2,0) -> 2A   (Light-Green)
-    0x29,   // RGB(1,2,0) -> 29   (Light-Chartreuse)
-    0x28,   // RGB(2,2,0) -> 28   (Light-Yellow)
-    0x27,   // RGB(3,2,0) -> 27   (Light-Orange)
-    0x2A,   // RGB(0,3,0) -> 2A   (Light-Green)
-    0x29,   // RGB(1,3,0) -> 29   (Light-Chartreuse)
-    0x29,   // RGB(2,3,0) -> 29   (Light-Chartreuse)
-    0x28,   // RGB(3,3,0) -> 28   (Light-Yellow)
-    0x01,   // RGB(0,0,1) -> 01   (Dark-Azure)
-    0x04,   // RGB(1,0,1) -> 04   (Dark-Magenta)
-    0x15,   // RGB(2,0,1) -> 15   (Medium-Rose)
-    0x15,   // RGB(3,0,1) -> 15   (Medium-Rose)
-    0x1C,   // RGB(0,1,1) -> 1C   (Medium-Cyan)
-    0x00,   // RGB(1,1,1) -> 00   (Gray)
-    0x15,   // RGB(2,1,1) -> 15   (Medium-Rose)
-    0x26,   // RGB(3,1,1) -> 26   (Light-Red)
-    0x2B,   // RGB(0,2,1) -> 2B   (Light-Spring)
-    0x2A,   // RGB(1,2,1) -> 2A   (Light-Green)
-    0x10,   // RGB(2,2,1) -> 10   (Medium-Gray)
-    0x26,   // RGB(3,2,1) -> 26   (Light-Red)
-    0x2B,   // RGB(0,3,1) -> 2B   (Light-Spring)
-    0x2A,   // RGB(1,3,1) -> 2A   (Light-Green)
-    0x39,   // RGB(2,3,1) -> 39   (Pale-Chartreuse)
-    0x38,   // RGB(3,3,1) -> 38   (Pale-Yellow)
-    0x02,   // RGB(0,0,2) -> 02   (Dark-Blue)
-    0x13,   // RGB(1,0,2) -> 13   (Medium-Violet)
-    0x14,   // RGB(2,0,2) -> 14   (Medium-Magenta)
-    0x14,   // RGB(3,0,2) -> 14   (Medium-Magenta)
-    0x11,   // RGB(0,1,2) -> 11   (Medium-Azure)
-    0x13,   // RGB(1,1,2) -> 13   (Medium-Violet)
-    0x10,   // RGB(2,1,2) -> 10   (Medium-Gray)
-    0x25,   // RGB(3,1,2) -> 25   (Light-Rose)
-    0x2C,   // RGB(0,2,2) -> 2C   (Light-Cyan)
-    0x10,   // RGB(1,2,2) -> 10   (Medium-Gray)
-    0x3D,   // RGB(2,2,2) -> 3D   (Silver)
-    0x36,   // RGB(3,2,2) -> 36   (Pale-Red)
-    0x2C,   // RGB(0,3,2) -> 2C   (Light-Cyan)
-    0x3B,   // RGB(1,3,2) -> 3B   (Pale-Spring)
-    0x3A,   // RGB(2,3,2) -> 3A   (Pale-Green)
-    0x37,   // RGB(3,3,2) -> 37   (Pale-Orange)
-    0x12,   // RGB(0,0,3) -> 12   (Medium-Blue)
-    0x13,   // RGB(1,0,3) -> 13   (Medium-Violet)
-    0x14,   // RGB(2,0,3) -> 14   (Medium-Magenta)
-    0x24,   // RGB(3,0,3) -> 24   (Light-Magenta)
-    0x12,   // RGB(0,1,3) -> 12   (Medium-Blue)
-    0x22,   // RGB(1,1,3) -> 22   (Light-Blue)
-    0x23,   // RGB(2,1,3) -> 23   (Light-Violet)
-    0x24,   // RGB(3,1,3) -> 24   (Light-Magenta)
-    0x21,   // RGB(0,2,3) -> 21   (Light-Azure)
-    0x22,   // RGB(1,2,3) -> 22   (Light-Blue)
-    0x32,   // RGB(2,2,3) -> 32   (Pale-Blue)
-    0x34,   // RGB(3,2,3) -> 34   (Pale-Magenta)
-    0x2C,   // RGB(0,3,3) -> 2C   (Light-Cyan)
-    0x3C,   // RGB(1,3,3) -> 3C   (Pale-Cyan)
-    0x3C,   // RGB(2,3,3) -> 3C   (Pale-Cyan)
-    0x20,   // RGB(3,3,3) -> 20   (White)
-};
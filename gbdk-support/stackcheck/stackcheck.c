@@ -0,0 +1,793 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Worst case stack depth from the asm output of the compiler
+//
+// Reads the .asm files written by sdcc (lcc -S) for sm83 and z80, and
+// hand written .s files. Every non local label starts a function. Its
+// own stack use is followed through push / pop, SP adjustments and the
+// frame setups sdcc emits, with the depth at each local label taken
+// from the jumps to it. Calls
+// and jumps to other functions are edges of the call graph, and the
+// worst case of a function is the deepest of its own use and of the
+// depth at each call plus the worst case of the callee.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define MAX_STR_LEN          4096
+#define MAX_LIST             256
+
+// Bytes a call puts on the stack before the callee runs
+#define CALL_BYTES           2
+// ___sdcc_bcall_ehl: its own return address, the saved bank, then the call of the function
+#define BANKED_CALL_BYTES    6
+// Default for -int: hardware return address, registers saved by the dispatcher and its call
+#define INT_BYTES_DEFAULT    16
+
+#define EDGE_CALL            0
+#define EDGE_JUMP            1
+
+#define FLAG_INDIRECT        0x01
+#define FLAG_RECURSIVE       0x02
+#define FLAG_UNDEFINED       0x04
+
+typedef struct {
+    char * name;            // Label of the callee, resolved after all files are read
+    int    func;            // Index of the callee, -1 if not in the input
+    int    at;              // Depth when the callee starts, including the return address
+    int    kind;            // EDGE_CALL or EDGE_JUMP
+} edge_t;
+
+typedef struct {
+    char *   name;
+    int      file;          // Input file, static functions are only called from there
+    bool     global;        // Label ends with ::
+    int      frame;         // Deepest stack of the function itself
+    bool     indirect;      // Calls through a function pointer
+    edge_t * edges;
+    int      edge_count, edge_size;
+    int      callers;
+    // Results
+    int      state;         // 0 not visited, 1 being visited, 2 done
+    int      depth;         // Worst case including callees
+    int      worst;         // Edge of the worst case, -1 if it is the function itself
+    int      flags;         // FLAG_ of the function and its callees
+} func_t;
+
+typedef struct {
+    char name[64];
+    int  depth;
+} label_t;
+
+// Value of HL, IX, IY when it is known
+typedef struct {
+    bool   konst, sprel;
+    int    value;           // konst: the value, sprel: offset from SP
+    int    depth;           // sprel: depth when the offset was taken
+    char   sym[64];         // Symbol loaded with ld r, #sym
+} reg_t;
+
+#define REG_HL 0
+#define REG_IX 1
+#define REG_IY 2
+#define REG_BC 3
+#define REG_COUNT 4
+static const char * reg_names[REG_COUNT] = { "hl", "ix", "iy", "bc" };
+
+static func_t * funcs;
+static int func_count, func_size;
+
+static char * filenames[MAX_LIST];
+static int file_count;
+static char * entry_names[MAX_LIST];
+static int entry_count;
+static char * isr_names[MAX_LIST];
+static int isr_count;
+
+static int  assume_bytes = 0;
+static int  int_bytes = INT_BYTES_DEFAULT;
+static int  max_bytes = -1;
+static bool verbose = false;
+
+// Parser state of the current function
+static int cur = -1;
+static bool alive;
+static int depth;
+static label_t * labels;
+static int label_count, label_size;
+static reg_t regs[REG_COUNT];
+static bool pending_bcall;      // ___sdcc_bcall: the callee follows in a .dw
+
+
+static void display_help(void) {
+
+    fprintf(stdout,
+       "stackcheck <file>.asm [<file>.asm ...] [options]\n"
+       "Use: report the worst case stack depth of each entry point from sdcc asm output (sm83, z80).\n"
+       "\n"
+       "Options\n"
+       "-h                  Show this help screen\n"
+       "-e <function>       Entry point (default: main and every function nothing calls), can be repeated\n"
+       "-i <function>       Interrupt handler, added to the worst case of the entry points, can be repeated\n"
+       "-int <bytes>        Stack used by the interrupt dispatcher before a handler runs (default: 16)\n"
+       "-u <bytes>          Stack counted for functions not in the input and calls through pointers (default: 0)\n"
+       "-max <bytes>        Fail if a worst case is deeper, for example .STACK minus the end of the RAM areas\n"
+       "-v                  List every function\n"
+       "\n"
+       "Example: \"lcc -S main.c game.c\" then \"stackcheck main.asm game.asm -i _vbl_isr -max 512\"\n"
+       "Functions of the library are not in the asm output of a program: they count as -u bytes.\n"
+       );
+}
+
+
+static void out_of_memory(void) {
+    printf("stackcheck: ERROR: out of memory\n");
+    exit(EXIT_FAILURE);
+}
+
+
+static char * str_dup(const char * s) {
+
+    char * p = malloc(strlen(s) + 1);
+    if (!p)
+        out_of_memory();
+    return strcpy(p, s);
+}
+
+
+static bool is_local_label(const char * s) {
+    return isdigit((unsigned char)s[0]) || (s[0] && (s[strlen(s) - 1] == '$'));
+}
+
+
+// Parses a number from an operand like #-4, #0xfffc or 4, false if it is a symbol
+static bool parse_number(const char * s, int * value) {
+
+    char * end;
+    long v;
+
+    if (*s == '#')
+        s++;
+    if (!*s)
+        return false;
+    v = strtol(s, &end, 0);
+    if (*end)
+        return false;
+    v &= 0xFFFF;
+    *value = (v >= 0x8000) ? (int)(v - 0x10000) : (int)v;
+    return true;
+}
+
+
+static int reg_index(const char * s) {
+
+    for (int r = 0; r < REG_COUNT; r++)
+        if (strcmp(s, reg_names[r]) == 0)
+            return r;
+    return -1;
+}
+
+
+static void regs_forget(void) {
+    memset(regs, 0, sizeof(regs));
+}
+
+
+static void add_edge(const char * name, int at, int kind) {
+
+    func_t * f = &funcs[cur];
+
+    if (f->edge_count == f->edge_size) {
+        f->edge_size = f->edge_size ? f->edge_size * 2 : 8;
+        f->edges = realloc(f->edges, f->edge_size * sizeof(edge_t));
+        if (!f->edges)
+            out_of_memory();
+    }
+    f->edges[f->edge_count].name = str_dup(name);
+    f->edges[f->edge_count].func = -1;
+    f->edges[f->edge_count].at = at;
+    f->edges[f->edge_count].kind = kind;
+    f->edge_count++;
+}
+
+
+static void add_indirect(int at) {
+
+    func_t * f = &funcs[cur];
+
+    f->indirect = true;
+    if (at + assume_bytes > f->frame)
+        f->frame = at + assume_bytes;
+}
+
+
+static void start_function(const char * name, bool global, int file) {
+
+    // Code which runs on into the next label continues there at the same depth
+    if ((cur >= 0) && alive)
+        add_edge(name, depth, EDGE_JUMP);
+
+    if (func_count == func_size) {
+        func_size = func_size ? func_size * 2 : 256;
+        funcs = realloc(funcs, func_size * sizeof(func_t));
+        if (!funcs)
+            out_of_memory();
+    }
+    memset(&funcs[func_count], 0, sizeof(func_t));
+    funcs[func_count].name = str_dup(name);
+    funcs[func_count].file = file;
+    funcs[func_count].global = global;
+    cur = func_count++;
+
+    alive = true;
+    depth = 0;
+    label_count = 0;
+    regs_forget();
+    pending_bcall = false;
+}
+
+
+static label_t * find_label(const char * name) {
+
+    for (int i = 0; i < label_count; i++)
+        if (strcmp(labels[i].name, name) == 0)
+            return &labels[i];
+    return NULL;
+}
+
+
+// A jump to a local label: the path there has the current depth
+static void jump_to_label(const char * name) {
+
+    if (find_label(name))
+        return;  // The first path to reach it is kept, the others should agree
+    if (label_count == label_size) {
+        label_size = label_size ? label_size * 2 : 64;
+        labels = realloc(labels, label_size * sizeof(label_t));
+        if (!labels)
+            out_of_memory();
+    }
+    snprintf(labels[label_count].name, sizeof(labels[label_count].name), "%s", name);
+    labels[label_count].depth = depth;
+    label_count++;
+}
+
+
+static void local_label(const char * name) {
+
+    label_t * l = find_label(name);
+
+    if (!alive) {
+        // Only reached by jumps: take their depth, else keep the last one
+        if (l)
+            depth = l->depth;
+        alive = true;
+    } else if (!l)
+        jump_to_label(name);
+    regs_forget();
+}
+
+
+// Splits "a,b" into at most 2 operands, with the spaces removed
+static int split_operands(char * s, char ops[2][MAX_STR_LEN]) {
+
+    int n = 0, len = 0, paren = 0;
+
+    ops[0][0] = ops[1][0] = '\0';
+    for (; *s; s++) {
+        if (isspace((unsigned char)*s))
+            continue;
+        if (*s == '(')
+            paren++;
+        else if (*s == ')')
+            paren--;
+        if ((*s == ',') && !paren && (n == 0)) {
+            ops[0][len] = '\0';
+            n = 1;
+            len = 0;
+            continue;
+        }
+        if (len < MAX_STR_LEN - 1)
+            ops[n][len++] = (char)tolower((unsigned char)*s);
+        ops[n][len] = '\0';
+    }
+    if (ops[0][0] == '\0')
+        return 0;
+    return n + 1;
+}
+
+
+static bool is_condition(const char * s) {
+
+    static const char * conds[] = { "z", "nz", "c", "nc", "po", "pe", "p", "m", NULL };
+    for (int i = 0; conds[i]; i++)
+        if (strcmp(s, conds[i]) == 0)
+            return true;
+    return false;
+}
+
+
+static void banked_call(const char * callee) {
+
+    if (callee && callee[0])
+        add_edge(callee, depth + BANKED_CALL_BYTES, EDGE_CALL);
+    else
+        add_indirect(depth + BANKED_CALL_BYTES);
+}
+
+
+static void call(const char * target) {
+
+    if ((strcmp(target, "___sdcc_bcall_ehl") == 0))
+        banked_call(regs[REG_HL].sym);
+    else if ((strcmp(target, "___sdcc_bcall_abc") == 0))
+        banked_call(regs[REG_BC].sym);
+    else if ((strcmp(target, "___sdcc_bcall") == 0))
+        pending_bcall = true;  // The callee and its bank follow the call
+    else if ((strcmp(target, "___sdcc_call_hl") == 0) || (strcmp(target, "___sdcc_call_iy") == 0) ||
+             (strcmp(target, ".call_hl") == 0))
+        add_indirect(depth + CALL_BYTES);
+    else
+        add_edge(target, depth + CALL_BYTES, EDGE_CALL);
+    regs_forget();
+}
+
+
+// Follows the stack through one instruction of the current function
+static void instruction(const char * mnem, char * args) {
+
+    char ops[2][MAX_STR_LEN];
+    int n = split_operands(args, ops);
+    int value, r;
+
+    if (!alive)
+        return;
+
+    if (strcmp(mnem, "push") == 0) {
+        depth += 2;
+    } else if (strcmp(mnem, "pop") == 0) {
+        depth -= 2;
+        if ((r = reg_index(ops[0])) >= 0)
+            memset(&regs[r], 0, sizeof(reg_t));
+    } else if ((strcmp(mnem, "dec") == 0) && (strcmp(ops[0], "sp") == 0)) {
+        depth += 1;
+    } else if ((strcmp(mnem, "inc") == 0) && (strcmp(ops[0], "sp") == 0)) {
+        depth -= 1;
+    } else if ((strcmp(mnem, "add") == 0) && (n == 2) && (strcmp(ops[0], "sp") == 0)) {
+        // sm83: add sp, #n
+        if (parse_number(ops[1], &value))
+            depth -= value;
+    } else if ((strcmp(mnem, "add") == 0) && (n == 2) && ((r = reg_index(ops[0])) >= 0) && (strcmp(ops[1], "sp") == 0)) {
+        // ld r, #n  add r, sp: r points into the stack
+        if (regs[r].konst) {
+            regs[r].sprel = true;
+            regs[r].konst = false;
+            regs[r].depth = depth;
+        } else
+            regs[r].sprel = false;
+        regs[r].sym[0] = '\0';
+    } else if (((strcmp(mnem, "ldhl") == 0) && (n == 2) && (strcmp(ops[0], "sp") == 0)) ||
+               ((strcmp(mnem, "ld") == 0) && (n == 2) && (strcmp(ops[0], "hl") == 0) && (strncmp(ops[1], "sp+", 3) == 0))) {
+        // sm83: ldhl sp, #n or ld hl, sp + #n
+        memset(&regs[REG_HL], 0, sizeof(reg_t));
+        if (parse_number(ops[1] + ((ops[1][0] == 's') ? 3 : 0), &value)) {
+            regs[REG_HL].sprel = true;
+            regs[REG_HL].value = value;
+            regs[REG_HL].depth = depth;
+        }
+    } else if ((strcmp(mnem, "ld") == 0) && (n == 2) && (strcmp(ops[0], "sp") == 0)) {
+        // ld sp, r: back to where r points
+        if (((r = reg_index(ops[1])) >= 0) && regs[r].sprel)
+            depth = regs[r].depth - regs[r].value;
+    } else if ((strcmp(mnem, "ld") == 0) && (n == 2) && ((r = reg_index(ops[0])) >= 0)) {
+        memset(&regs[r], 0, sizeof(reg_t));
+        if (parse_number(ops[1], &value)) {
+            regs[r].konst = true;
+            regs[r].value = value;
+        } else if ((ops[1][0] == '#') && (isalpha((unsigned char)ops[1][1]) || (ops[1][1] == '_') || (ops[1][1] == '.')))
+            snprintf(regs[r].sym, sizeof(regs[r].sym), "%s", ops[1] + 1);
+    } else if (strcmp(mnem, "call") == 0) {
+        call(ops[n - 1]);
+    } else if (strcmp(mnem, "rst") == 0) {
+        if (!parse_number(ops[0], &value))
+            value = -1;
+        if (value == 0x10)
+            banked_call(regs[REG_HL].sym);          // lcc -bcall-rst
+        else if (value == 0x20)
+            add_indirect(depth + CALL_BYTES);       // sm83 call hl
+        else if (depth + CALL_BYTES > funcs[cur].frame)
+            funcs[cur].frame = depth + CALL_BYTES;
+        regs_forget();
+    } else if ((strcmp(mnem, "jp") == 0) || (strcmp(mnem, "jr") == 0) || (strcmp(mnem, "djnz") == 0)) {
+        bool cond = (n == 2) && is_condition(ops[0]);
+        const char * target = ops[n - 1];
+        if (strcmp(mnem, "djnz") == 0)
+            cond = true;
+        if ((target[0] == '(') || (reg_index(target) >= 0)) {
+            add_indirect(depth);                    // jp (hl): tail call through a pointer
+        } else if (is_local_label(target)) {
+            jump_to_label(target);
+        } else {
+            add_edge(target, depth, EDGE_JUMP);     // Tail call, or jump into the next function
+        }
+        if (!cond)
+            alive = false;
+    } else if ((strcmp(mnem, "ret") == 0) || (strcmp(mnem, "reti") == 0) || (strcmp(mnem, "retn") == 0)) {
+        if (n == 0)
+            alive = false;
+    } else if ((strcmp(mnem, "ex") == 0) || (strcmp(mnem, "exx") == 0)) {
+        regs_forget();
+    } else if (n >= 1) {
+        // Anything else which writes a tracked register
+        if ((r = reg_index(ops[0])) >= 0)
+            memset(&regs[r], 0, sizeof(reg_t));
+    }
+
+    if (depth > funcs[cur].frame)
+        funcs[cur].frame = depth;
+}
+
+
+static bool read_file(int file) {
+
+    char line[MAX_STR_LEN];
+    FILE * fp = fopen(filenames[file], "r");
+
+    if (!fp) {
+        printf("stackcheck: ERROR: can't open %s\n", filenames[file]);
+        return false;
+    }
+
+    cur = -1;
+    alive = false;
+    pending_bcall = false;
+    while (fgets(line, sizeof(line), fp)) {
+        char * p = line, * comment = strchr(line, ';');
+        if (comment)
+            *comment = '\0';
+
+        // Labels, any number of them before the instruction
+        while (true) {
+            while (isspace((unsigned char)*p))
+                p++;
+            char * q = p;
+            while (*q && (isalnum((unsigned char)*q) || (*q == '_') || (*q == '.') || (*q == '$')))
+                q++;
+            if ((q == p) || (*q != ':'))
+                break;
+            bool global = (q[1] == ':');
+            *q = '\0';
+            if (is_local_label(p)) {
+                if (cur >= 0)
+                    local_label(p);
+            } else
+                start_function(p, global, file);
+            p = q + (global ? 2 : 1);
+        }
+        if (!*p || (cur < 0))
+            continue;
+
+        char mnem[32];
+        int len = 0;
+        while (*p && !isspace((unsigned char)*p) && (len < (int)sizeof(mnem) - 1))
+            mnem[len++] = (char)tolower((unsigned char)*p++);
+        mnem[len] = '\0';
+
+        if (mnem[0] == '.') {
+            // ___sdcc_bcall is followed by .dw function, .dw bank
+            if (pending_bcall && (strcmp(mnem, ".dw") == 0)) {
+                char ops[2][MAX_STR_LEN];
+                split_operands(p, ops);
+                banked_call(ops[0]);
+                pending_bcall = false;
+            } else if ((strcmp(mnem, ".area") == 0) || (strcmp(mnem, ".module") == 0)) {
+                alive = false;  // Code doesn't run on over the end of an area
+            }
+            continue;
+        }
+        instruction(mnem, p);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+
+// Callee of an edge: a static function of the same file first, then a global one
+static int find_func(const char * name, int file) {
+
+    int found = -1;
+
+    for (int i = 0; i < func_count; i++) {
+        if (strcmp(funcs[i].name, name) != 0)
+            continue;
+        if (funcs[i].file == file)
+            return i;
+        if (funcs[i].global && (found < 0))
+            found = i;
+    }
+    return found;
+}
+
+
+// Entry points can be given with or without the leading _ of C names,
+// and can be static functions of any file
+static int find_entry(const char * name) {
+
+    char buf[MAX_STR_LEN];
+
+    snprintf(buf, sizeof(buf), "_%s", name);
+    for (int pass = 0; pass < 2; pass++) {
+        const char * n = pass ? buf : name;
+        int f = find_func(n, -1);
+        if (f >= 0)
+            return f;
+        for (int i = 0; i < func_count; i++)
+            if (strcmp(funcs[i].name, n) == 0)
+                return i;
+    }
+    printf("stackcheck: ERROR: function %s not found\n", name);
+    return -1;
+}
+
+
+static void resolve(void) {
+
+    // Code which jumps or runs on into a function is part of the same
+    // entry point as a call to it, so it counts as a caller as well
+    for (int i = 0; i < func_count; i++)
+        for (int e = 0; e < funcs[i].edge_count; e++) {
+            edge_t * ed = &funcs[i].edges[e];
+            ed->func = find_func(ed->name, funcs[i].file);
+            if ((ed->func >= 0) && (ed->func != i))
+                funcs[ed->func].callers++;
+        }
+}
+
+
+static void analyze(int i) {
+
+    func_t * f = &funcs[i];
+
+    if (f->state)
+        return;
+    f->state = 1;
+    f->depth = f->frame;
+    f->worst = -1;
+    f->flags = f->indirect ? FLAG_INDIRECT : 0;
+
+    for (int e = 0; e < f->edge_count; e++) {
+        edge_t * ed = &f->edges[e];
+        int d;
+        if (ed->func < 0) {
+            f->flags |= FLAG_UNDEFINED;
+            d = ed->at + assume_bytes;
+        } else if (funcs[ed->func].state == 1) {
+            // Back to a function which is still being visited. A jump back
+            // at the start depth is a loop, anything else is recursion.
+            if ((ed->kind == EDGE_CALL) || (ed->at > 0))
+                f->flags |= FLAG_RECURSIVE;
+            if (ed->at > f->depth)
+                f->depth = ed->at;
+            continue;
+        } else {
+            analyze(ed->func);
+            f->flags |= funcs[ed->func].flags;
+            d = ed->at + funcs[ed->func].depth;
+        }
+        if (d > f->depth) {
+            f->depth = d;
+            f->worst = e;
+        }
+    }
+    f->state = 2;
+}
+
+
+static void print_path(int i) {
+
+    for (int n = 0; (i >= 0) && (n < 64); n++) {
+        func_t * f = &funcs[i];
+        printf("%s%s", n ? " > " : "", f->name);
+        if (f->worst < 0)
+            break;
+        if (f->edges[f->worst].func < 0) {
+            printf(" > %s (not in the input)", f->edges[f->worst].name);
+            break;
+        }
+        i = f->edges[f->worst].func;
+    }
+    printf("\n");
+}
+
+
+static void print_flags(int flags) {
+
+    if (flags & FLAG_RECURSIVE)
+        printf("    WARNING: recursion, the depth is only for one level of it\n");
+    if (flags & FLAG_INDIRECT)
+        printf("    WARNING: calls through function pointers, counted as %d bytes\n", assume_bytes);
+    if (flags & FLAG_UNDEFINED)
+        printf("    WARNING: calls functions which are not in the input, counted as %d bytes\n", assume_bytes);
+}
+
+
+static int report_entry(int i) {
+
+    analyze(i);
+    printf("%-24s %5d bytes   ", funcs[i].name, funcs[i].depth);
+    print_path(i);
+    print_flags(funcs[i].flags);
+    return funcs[i].depth;
+}
+
+
+static bool report(void) {
+
+    int worst_entry = 0, worst_isr = 0;
+    int entries[MAX_LIST], isrs[MAX_LIST];
+    bool ok = true;
+
+    resolve();
+    for (int n = 0; n < entry_count; n++)
+        if ((entries[n] = find_entry(entry_names[n])) < 0)
+            return false;
+    for (int n = 0; n < isr_count; n++)
+        if ((isrs[n] = find_entry(isr_names[n])) < 0)
+            return false;
+
+    if (verbose) {
+        const char * missing[MAX_LIST];
+        int missing_count = 0;
+
+        printf("Function                  Own depth  Worst case\n");
+        for (int i = 0; i < func_count; i++) {
+            analyze(i);
+            printf("%-24s %10d %11d%s%s%s\n", funcs[i].name, funcs[i].frame, funcs[i].depth,
+                   (funcs[i].flags & FLAG_RECURSIVE) ? "  recursion" : "",
+                   (funcs[i].flags & FLAG_INDIRECT) ? "  pointers" : "",
+                   (funcs[i].flags & FLAG_UNDEFINED) ? "  not in the input" : "");
+            for (int e = 0; e < funcs[i].edge_count; e++) {
+                int m;
+                if (funcs[i].edges[e].func >= 0)
+                    continue;
+                for (m = 0; m < missing_count; m++)
+                    if (strcmp(missing[m], funcs[i].edges[e].name) == 0)
+                        break;
+                if ((m == missing_count) && (missing_count < MAX_LIST))
+                    missing[missing_count++] = funcs[i].edges[e].name;
+            }
+        }
+        printf("\nNot in the input:");
+        for (int m = 0; m < missing_count; m++)
+            printf(" %s", missing[m]);
+        printf("\n\n");
+    }
+
+    printf("Entry point              Worst case    Deepest path\n");
+    if (entry_count) {
+        for (int n = 0; n < entry_count; n++) {
+            int d = report_entry(entries[n]);
+            if (d > worst_entry)
+                worst_entry = d;
+        }
+    } else {
+        // main, then every function nothing calls which isn't an interrupt handler
+        int m = find_func("_main", -1);
+        if (m >= 0)
+            worst_entry = report_entry(m);
+        for (int i = 0; i < func_count; i++) {
+            bool isr = false;
+            for (int n = 0; n < isr_count; n++)
+                isr |= (isrs[n] == i);
+            if ((i == m) || funcs[i].callers || isr)
+                continue;
+            int d = report_entry(i);
+            if (d > worst_entry)
+                worst_entry = d;
+        }
+    }
+
+    if (isr_count) {
+        printf("\nInterrupt handler        Worst case    Deepest path\n");
+        for (int n = 0; n < isr_count; n++) {
+            int d = report_entry(isrs[n]);
+            if (d > worst_isr)
+                worst_isr = d;
+        }
+        printf("\nWorst case with interrupts: %d + %d (dispatcher) + %d = %d bytes\n",
+               worst_entry, int_bytes, worst_isr, worst_entry + int_bytes + worst_isr);
+        worst_entry += int_bytes + worst_isr;
+    }
+
+    if ((max_bytes >= 0) && (worst_entry > max_bytes)) {
+        printf("stackcheck: ERROR: worst case of %d bytes is more than the %d bytes of -max\n", worst_entry, max_bytes);
+        ok = false;
+    }
+    return ok;
+}
+
+
+static bool add_name(char ** list, int * count, const char * name) {
+
+    if (*count == MAX_LIST) {
+        printf("stackcheck: ERROR: more than %d names\n", MAX_LIST);
+        return false;
+    }
+    list[(*count)++] = (char *)name;
+    return true;
+}
+
+
+static bool handle_args(int argc, char * argv[]) {
+
+    if (argc < 2) {
+        display_help();
+        return false;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            if (!add_name(filenames, &file_count, argv[i]))
+                return false;
+        } else if ((strcmp(argv[i], "-e") == 0) && (i + 1 < argc)) {
+            if (!add_name(entry_names, &entry_count, argv[++i]))
+                return false;
+        } else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc)) {
+            if (!add_name(isr_names, &isr_count, argv[++i]))
+                return false;
+        } else if ((strcmp(argv[i], "-int") == 0) && (i + 1 < argc)) {
+            int_bytes = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-u") == 0) && (i + 1 < argc)) {
+            assume_bytes = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-max") == 0) && (i + 1 < argc)) {
+            max_bytes = (int)strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            if (strcmp(argv[i], "-h") != 0)
+                printf("stackcheck: ERROR: Unknown option %s\n", argv[i]);
+            display_help();
+            return false;
+        }
+    }
+
+    if (file_count == 0) {
+        display_help();
+        return false;
+    }
+    if ((int_bytes < 0) || (assume_bytes < 0)) {
+        printf("stackcheck: ERROR: -int and -u can't be negative\n");
+        return false;
+    }
+    return true;
+}
+
+
+int main(int argc, char * argv[]) {
+
+    int ret = EXIT_FAILURE;
+
+    if (handle_args(argc, argv)) {
+        bool ok = true;
+        for (int i = 0; (i < file_count) && ok; i++)
+            ok = read_file(i);
+        if (ok && report())
+            ret = EXIT_SUCCESS;
+    }
+
+    for (int i = 0; i < func_count; i++) {
+        for (int e = 0; e < funcs[i].edge_count; e++)
+            free(funcs[i].edges[e].name);
+        free(funcs[i].edges);
+        free(funcs[i].name);
+    }
+    free(funcs);
+    free(labels);
+    return ret;
+}
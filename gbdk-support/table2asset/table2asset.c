@@ -0,0 +1,335 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Lays out a table of keys for bsearch_u8() / bsearch_u16()
+//
+// The keys are sorted and written in Eytzinger order: the middle key
+// first, then the middle keys of both halves and so on, like a
+// binary tree stored by levels. The children of the key at index i
+// are at 2 * i + 1 and 2 * i + 2, so the search only needs a shift
+// and an add per step instead of working out the middle of a range.
+// Values given with the keys are written to a second array in the
+// same order, so the index which the search returns selects them.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define MAX_STR_LEN     4096
+
+#define COUNT_MAX_U8    255u    // n is 8 bit, so 0xFF is free for "not found"
+#define COUNT_MAX_U16   32767u  // 2 * i must not overflow 16 bits
+
+static char filename_in[MAX_STR_LEN]  = "";
+static char filename_out[MAX_STR_LEN] = "";
+static char var_name[MAX_STR_LEN]     = "";
+static char value_type[MAX_STR_LEN]   = "uint16_t";
+static char include_file[MAX_STR_LEN] = "";
+static int  bank        = 0;    // 0 = non-banked, 255 = autobank
+static int  key_bits    = 0;    // 0 = from the largest key
+
+typedef struct {
+    uint32_t key;
+    char *   value;     // C expression, or NULL
+    int      line_no;
+} entry_t;
+
+static entry_t * entries = NULL;
+static uint32_t  entry_count = 0;
+static uint32_t  value_count = 0;
+static entry_t * tree = NULL;
+
+
+static void display_help(void) {
+
+    fprintf(stdout,
+       "table2asset <file>.txt [options]\n"
+       "Use: lay out a table of keys for bsearch_u8() / bsearch_u16().\n"
+       "\n"
+       "Options\n"
+       "-h                  Show this help screen\n"
+       "-c <file>.c         Output file (default: <file>.c), and a header <file>.h\n"
+       "-var <name>         Variable name (default: <file>)\n"
+       "-b <bank>           Bank, 255 for autobank (default: none, non-banked ROM)\n"
+       "-u8                 8 bit keys, for bsearch_u8() (default if all keys are below 256)\n"
+       "-u16                16 bit keys, for bsearch_u16()\n"
+       "-type <type>        C type of the values (default: uint16_t)\n"
+       "-include <file>     Header to include, for symbols used in the values\n"
+       "\n"
+       "Input\n"
+       "Each line is a key (decimal or 0x hex), optionally followed by a value,\n"
+       "which is written to <name>_values as it is. Keys can be in any order.\n"
+       "Empty lines and lines starting with ; are skipped.\n"
+       );
+}
+
+
+static void out_of_memory(void) {
+    printf("table2asset: ERROR: out of memory\n");
+    exit(EXIT_FAILURE);
+}
+
+
+static void * xrealloc(void * p, size_t size) {
+    p = realloc(p, size ? size : 1);
+    if (!p)
+        out_of_memory();
+    return p;
+}
+
+
+static bool table_load(void) {
+
+    char   line[MAX_STR_LEN];
+    int    line_no = 0;
+    FILE * f;
+
+    if (NULL == (f = fopen(filename_in, "r"))) {
+        printf("table2asset: ERROR: can't open %s\n", filename_in);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        char *          p = line;
+        char *          end;
+        unsigned long   key;
+        entry_t *       e;
+
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        while (isspace((unsigned char)*p))
+            p++;
+        if ((*p == '\0') || (*p == ';'))
+            continue;
+
+        key = strtoul(p, &end, 0);
+        if ((end == p) || (*end && !isspace((unsigned char)*end)) || (key > 0xFFFFu)) {
+            printf("table2asset: ERROR: %s:%d: key must be a number from 0 to 65535\n", filename_in, line_no);
+            fclose(f);
+            return false;
+        }
+        p = end;
+        while (isspace((unsigned char)*p))
+            p++;
+        end = p + strlen(p);
+        while ((end > p) && isspace((unsigned char)end[-1]))
+            *--end = '\0';
+
+        entries = xrealloc(entries, (entry_count + 1) * sizeof(entry_t));
+        e = &entries[entry_count++];
+        e->key = (uint32_t)key;
+        e->value = NULL;
+        e->line_no = line_no;
+        if (*p) {
+            e->value = xrealloc(NULL, strlen(p) + 1);
+            strcpy(e->value, p);
+            value_count++;
+        }
+    }
+    fclose(f);
+
+    if (entry_count == 0) {
+        printf("table2asset: ERROR: no keys in %s\n", filename_in);
+        return false;
+    }
+    if (value_count && (value_count != entry_count)) {
+        printf("table2asset: ERROR: either all keys or none must have a value\n");
+        return false;
+    }
+    return true;
+}
+
+
+static int entry_compare(const void * a, const void * b) {
+    const entry_t * ea = (const entry_t *)a;
+    const entry_t * eb = (const entry_t *)b;
+    if (ea->key != eb->key)
+        return (ea->key < eb->key) ? -1 : 1;
+    return ea->line_no - eb->line_no;
+}
+
+
+// Fills tree[k - 1] for the subtree at k with the sorted entries from i on,
+// returns the next unused entry
+static uint32_t tree_fill(uint32_t i, uint32_t k) {
+    if (k <= entry_count) {
+        i = tree_fill(i, 2 * k);
+        tree[k - 1] = entries[i++];
+        i = tree_fill(i, 2 * k + 1);
+    }
+    return i;
+}
+
+
+static bool table_build(void) {
+
+    uint32_t count_max;
+
+    qsort(entries, entry_count, sizeof(entry_t), entry_compare);
+    for (uint32_t i = 1; i < entry_count; i++) {
+        if (entries[i].key == entries[i - 1].key) {
+            printf("table2asset: ERROR: %s:%d: key %u is already on line %d\n", filename_in,
+                   entries[i].line_no, (unsigned int)entries[i].key, entries[i - 1].line_no);
+            return false;
+        }
+    }
+
+    if (key_bits == 0)
+        key_bits = (entries[entry_count - 1].key > 0xFFu) ? 16 : 8;
+    if ((key_bits == 8) && (entries[entry_count - 1].key > 0xFFu)) {
+        printf("table2asset: ERROR: key %u does not fit into 8 bits\n", (unsigned int)entries[entry_count - 1].key);
+        return false;
+    }
+    count_max = (key_bits == 8) ? COUNT_MAX_U8 : COUNT_MAX_U16;
+    if (entry_count > count_max) {
+        printf("table2asset: ERROR: %u keys, bsearch_u%d() takes up to %u\n", (unsigned int)entry_count, key_bits, (unsigned int)count_max);
+        return false;
+    }
+
+    tree = xrealloc(NULL, entry_count * sizeof(entry_t));
+    tree_fill(0, 1);
+    return true;
+}
+
+
+static bool write_files(void) {
+
+    char   filename_h[MAX_STR_LEN];
+    FILE * f;
+
+    snprintf(filename_h, sizeof(filename_h), "%s", filename_out);
+    char * ext = strrchr(filename_h, '.');
+    if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+        *ext = '\0';
+    strncat(filename_h, ".h", sizeof(filename_h) - strlen(filename_h) - 1);
+
+    // Header
+    if (NULL == (f = fopen(filename_h, "w"))) {
+        printf("table2asset: ERROR: can't write %s\n", filename_h);
+        return false;
+    }
+    fprintf(f, "#ifndef __%s_INCLUDE\n#define __%s_INCLUDE\n\n", var_name, var_name);
+    fprintf(f, "#include <gbdk/platform.h>\n#include <stdint.h>\n");
+    if (include_file[0])
+        fprintf(f, "#include \"%s\"\n", include_file);
+    fprintf(f, "\n// Keys in Eytzinger order, search with bsearch_u%d(key, %s_keys, %s_COUNT)\n", key_bits, var_name, var_name);
+    fprintf(f, "#define %s_COUNT %u\n\n", var_name, (unsigned int)entry_count);
+    if (bank)
+        fprintf(f, "BANKREF_EXTERN(%s)\n\n", var_name);
+    fprintf(f, "extern const uint%d_t %s_keys[];\n", key_bits, var_name);
+    if (value_count)
+        fprintf(f, "extern const %s %s_values[];\n", value_type, var_name);
+    fprintf(f, "\n#endif\n");
+    fclose(f);
+
+    // Source
+    if (NULL == (f = fopen(filename_out, "w"))) {
+        printf("table2asset: ERROR: can't write %s\n", filename_out);
+        return false;
+    }
+    if (bank)
+        fprintf(f, "#pragma bank %d\n\n", bank);
+    fprintf(f, "#include <gbdk/platform.h>\n#include <stdint.h>\n");
+    if (include_file[0])
+        fprintf(f, "#include \"%s\"\n", include_file);
+    fprintf(f, "\n");
+    if (bank)
+        fprintf(f, "BANKREF(%s)\n\n", var_name);
+    fprintf(f, "const uint%d_t %s_keys[] = {\n", key_bits, var_name);
+    for (uint32_t i = 0; i < entry_count; i++)
+        fprintf(f, "%s%u,%s", (i % 16) ? " " : "\t", (unsigned int)tree[i].key, ((i % 16) == 15) ? "\n" : "");
+    fprintf(f, "%s};\n", (entry_count % 16) ? "\n" : "");
+    if (value_count) {
+        fprintf(f, "\nconst %s %s_values[] = {\n", value_type, var_name);
+        for (uint32_t i = 0; i < entry_count; i++)
+            fprintf(f, "\t%s,\t// %u\n", tree[i].value, (unsigned int)tree[i].key);
+        fprintf(f, "};\n");
+    }
+    fclose(f);
+    return true;
+}
+
+
+static bool handle_args(int argc, char * argv[]) {
+
+    if (argc < 2) {
+        display_help();
+        return false;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            snprintf(filename_in, sizeof(filename_in), "%s", argv[i]);
+        } else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) {
+            snprintf(filename_out, sizeof(filename_out), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-var") == 0) && (i + 1 < argc)) {
+            snprintf(var_name, sizeof(var_name), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc)) {
+            bank = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-u8") == 0) {
+            key_bits = 8;
+        } else if (strcmp(argv[i], "-u16") == 0) {
+            key_bits = 16;
+        } else if ((strcmp(argv[i], "-type") == 0) && (i + 1 < argc)) {
+            snprintf(value_type, sizeof(value_type), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-include") == 0) && (i + 1 < argc)) {
+            snprintf(include_file, sizeof(include_file), "%s", argv[++i]);
+        } else {
+            if (strcmp(argv[i], "-h") != 0)
+                printf("table2asset: ERROR: Unknown option %s\n", argv[i]);
+            display_help();
+            return false;
+        }
+    }
+
+    if (filename_in[0] == '\0') {
+        display_help();
+        return false;
+    }
+    if ((bank < 0) || (bank > 255)) {
+        printf("table2asset: ERROR: bank %d must be from 1 to 255\n", bank);
+        return false;
+    }
+
+    if (filename_out[0] == '\0') {
+        snprintf(filename_out, sizeof(filename_out), "%s", filename_in);
+        char * ext = strrchr(filename_out, '.');
+        if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+            *ext = '\0';
+        strncat(filename_out, ".c", sizeof(filename_out) - strlen(filename_out) - 1);
+    }
+
+    // Default variable name: output file name without path and extension
+    if (var_name[0] == '\0') {
+        const char * start = filename_out;
+        for (const char * p = filename_out; *p; p++)
+            if ((*p == '/') || (*p == '\\'))
+                start = p + 1;
+        snprintf(var_name, sizeof(var_name), "%s", start);
+        char * ext = strrchr(var_name, '.');
+        if (ext)
+            *ext = '\0';
+        for (char * p = var_name; *p; p++)
+            if (!isalnum((unsigned char)*p))
+                *p = '_';
+    }
+
+    return true;
+}
+
+
+int main(int argc, char * argv[]) {
+
+    int ret = EXIT_FAILURE;
+
+    if (handle_args(argc, argv) && table_load() && table_build() && write_files())
+        ret = EXIT_SUCCESS;
+
+    for (uint32_t i = 0; i < entry_count; i++)
+        free(entries[i].value);
+    free(entries);
+    free(tree);
+    return ret;
+}
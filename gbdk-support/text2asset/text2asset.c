@@ -0,0 +1,651 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Compresses a text file, one string per line, for gbdk/textpack.h
+//
+// Substrings which save the most bytes are replaced by dictionary
+// tokens (byte values above the highest character used), one at a
+// time until no substring saves anything or the tokens run out. With
+// -huffman the token streams are Huffman coded as well. The strings
+// are written in chunks of up to 16K, one C source per chunk so that
+// each can be placed in its own ROM bank, plus a C source with the
+// index, dictionary and Huffman tree and a header for it.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define MAX_STR_LEN          4096
+
+#define CHUNK_SIZE_MAX       0x4000u  // A ROM bank
+#define ENTRY_LEN_MIN        2u
+#define ENTRY_LEN_MAX        16u
+#define SYMBOL_COUNT         256u
+#define TOKEN_BASE           256u     // Tokens while compressing, before they get their byte value
+#define TREE_LEAF            0x8000u
+
+static char filename_in[MAX_STR_LEN]  = "";
+static char filename_out[MAX_STR_LEN] = "";
+static char var_name[MAX_STR_LEN]     = "";
+static unsigned int chunk_size  = CHUNK_SIZE_MAX;
+static int          bank        = 255;  // 255 = autobank
+static int          dict_max    = -1;   // -1 = as many as there are free byte values
+static bool         huffman     = false;
+
+typedef struct {
+    uint16_t * sym;         // Characters, and TOKEN_BASE + n for dictionary entry n
+    uint32_t   len;
+    char *     label;       // From "@label", or NULL
+    uint8_t *  data;        // Encoded, with the terminating 0
+    uint32_t   data_len;
+} string_t;
+
+static string_t * strings = NULL;
+static uint32_t   string_count = 0;
+
+typedef struct {
+    uint8_t text[ENTRY_LEN_MAX];
+    uint8_t len;
+} entry_t;
+
+static entry_t  dict[SYMBOL_COUNT];
+static uint32_t dict_count = 0;
+static unsigned int first_token;
+
+// Huffman code of each symbol, MSB first
+static uint32_t code_bits[SYMBOL_COUNT];
+static uint8_t  code_len[SYMBOL_COUNT];
+static uint16_t tree[(SYMBOL_COUNT - 1) * 2];
+static uint32_t tree_nodes = 0;
+
+
+static void display_help(void) {
+
+    fprintf(stdout,
+       "text2asset <file>.txt [options]\n"
+       "Use: compress text, one string per line, for gbdk/textpack.h.\n"
+       "\n"
+       "Options\n"
+       "-h                  Show this help screen\n"
+       "-c <file>.c         Output file (default: <file>.c), chunks go to <file>_<n>.c\n"
+       "-var <name>         Variable name (default: <file>)\n"
+       "-b <bank>           Bank of the first chunk, the others follow it (default: 255, autobank)\n"
+       "-chunk_size <bytes> Largest chunk (default: 16384)\n"
+       "-dict <count>       Most dictionary entries (default: every byte value above the highest character)\n"
+       "-huffman            Also Huffman code the strings\n"
+       "\n"
+       "Input\n"
+       "Each line is a string, empty lines and lines starting with ; are skipped.\n"
+       "@<label> at the start of a line defines <name>_<label> as the number of the string.\n"
+       "\\n is a new line, \\\\ a backslash and \\xNN the character NN (01 - FE).\n"
+       );
+}
+
+
+static void out_of_memory(void) {
+    printf("text2asset: ERROR: out of memory\n");
+    exit(EXIT_FAILURE);
+}
+
+
+static void * xrealloc(void * p, size_t size) {
+    p = realloc(p, size ? size : 1);
+    if (!p)
+        out_of_memory();
+    return p;
+}
+
+
+static int hex_digit(char c) {
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    c = (char)tolower((unsigned char)c);
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    return -1;
+}
+
+
+static bool text_load(void) {
+
+    char   line[MAX_STR_LEN];
+    int    line_no = 0;
+    FILE * f;
+
+    if (NULL == (f = fopen(filename_in, "r"))) {
+        printf("text2asset: ERROR: can't open %s\n", filename_in);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        char *     p = line;
+        string_t * s;
+
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if ((line[0] == '\0') || (line[0] == ';'))
+            continue;
+
+        strings = xrealloc(strings, (string_count + 1) * sizeof(string_t));
+        s = &strings[string_count++];
+        memset(s, 0, sizeof(*s));
+        s->sym = xrealloc(NULL, strlen(line) * sizeof(uint16_t));
+
+        if (*p == '@') {
+            char * end = ++p;
+            while (isalnum((unsigned char)*end) || (*end == '_'))
+                end++;
+            if (end == p) {
+                printf("text2asset: ERROR: %s:%d: @ without a label\n", filename_in, line_no);
+                fclose(f);
+                return false;
+            }
+            s->label = xrealloc(NULL, (end - p) + 1);
+            memcpy(s->label, p, end - p);
+            s->label[end - p] = '\0';
+            p = end;
+            if (*p == ' ')
+                p++;
+        }
+
+        while (*p) {
+            int c = (unsigned char)*p++;
+            if (c == '\\') {
+                if (*p == 'n') {
+                    c = '\n';
+                    p++;
+                } else if (*p == '\\') {
+                    c = '\\';
+                    p++;
+                } else if ((*p == 'x') && (hex_digit(p[1]) >= 0) && (hex_digit(p[2]) >= 0)) {
+                    c = (hex_digit(p[1]) << 4) | hex_digit(p[2]);
+                    p += 3;
+                }
+            }
+            if ((c == 0) || (c == 0xFF)) {
+                printf("text2asset: ERROR: %s:%d: character 0x%02X can't be in a string\n", filename_in, line_no, c);
+                fclose(f);
+                return false;
+            }
+            s->sym[s->len++] = (uint16_t)c;
+        }
+    }
+    fclose(f);
+
+    if (!string_count) {
+        printf("text2asset: ERROR: %s has no strings\n", filename_in);
+        return false;
+    }
+    return true;
+}
+
+
+// Substring counts of one round, in an open addressing hash table
+typedef struct {
+    uint32_t hash;
+    uint32_t string, pos;   // First place it was seen
+    uint32_t count;
+    uint8_t  len;
+} candidate_t;
+
+static candidate_t * table = NULL;
+static uint32_t      table_size = 0;
+
+
+static uint32_t hash_symbols(const uint16_t * sym, uint32_t len) {
+
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < len; i++)
+        h = (h ^ sym[i]) * 16777619u;
+    return h | 1; // 0 marks a free slot
+}
+
+
+static bool same_symbols(const candidate_t * c, const uint16_t * sym, uint32_t len) {
+    return (c->len == len) && !memcmp(strings[c->string].sym + c->pos, sym, len * sizeof(uint16_t));
+}
+
+
+// The substring saving the most bytes, false if none saves anything
+static bool best_candidate(uint32_t * best_string, uint32_t * best_pos, uint32_t * best_len) {
+
+    uint32_t total = 0, free_slots;
+    long     best_gain = 0;
+
+    // At most ENTRY_LEN_MAX - 1 substrings start at each symbol
+    for (uint32_t s = 0; s < string_count; s++)
+        total += strings[s].len;
+    total *= ENTRY_LEN_MAX - 1;
+    if (table_size < total * 2) {
+        table_size = 1024;
+        while (table_size < total * 2)
+            table_size <<= 1;
+        table = xrealloc(table, table_size * sizeof(candidate_t));
+    }
+    memset(table, 0, table_size * sizeof(candidate_t));
+    free_slots = table_size - 1;
+
+    for (uint32_t s = 0; s < string_count; s++) {
+        const string_t * str = &strings[s];
+        for (uint32_t pos = 0; pos < str->len; pos++) {
+            if (str->sym[pos] >= TOKEN_BASE)
+                continue;
+            for (uint32_t len = ENTRY_LEN_MIN; (len <= ENTRY_LEN_MAX) && (pos + len <= str->len); len++) {
+                const uint16_t * sym = str->sym + pos;
+                if (sym[len - 1] >= TOKEN_BASE)
+                    break; // Entries don't contain other entries
+                uint32_t h = hash_symbols(sym, len);
+                uint32_t slot = h & (table_size - 1);
+                while (table[slot].hash && !((table[slot].hash == h) && same_symbols(&table[slot], sym, len)))
+                    slot = (slot + 1) & (table_size - 1);
+                candidate_t * c = &table[slot];
+                if (!c->hash) {
+                    if (!free_slots--)
+                        out_of_memory();
+                    c->hash = h;
+                    c->string = s;
+                    c->pos = pos;
+                    c->len = (uint8_t)len;
+                }
+                c->count++;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < table_size; i++) {
+        const candidate_t * c = &table[i];
+        if (!c->hash || (c->count < 2))
+            continue;
+        // Each use saves len - 1 bytes, the entry and its offset cost len + 2
+        long gain = (long)c->count * (c->len - 1) - (c->len + 2);
+        if (gain > best_gain) {
+            best_gain = gain;
+            *best_string = c->string;
+            *best_pos = c->pos;
+            *best_len = c->len;
+        }
+    }
+    return best_gain > 0;
+}
+
+
+static void dict_build(void) {
+
+    unsigned int max_char = 0;
+    uint32_t     limit;
+
+    for (uint32_t s = 0; s < string_count; s++)
+        for (uint32_t i = 0; i < strings[s].len; i++)
+            if (strings[s].sym[i] > max_char)
+                max_char = strings[s].sym[i];
+    first_token = max_char + 1;
+    limit = SYMBOL_COUNT - first_token;
+    if ((dict_max >= 0) && ((uint32_t)dict_max < limit))
+        limit = (uint32_t)dict_max;
+
+    while (dict_count < limit) {
+        uint32_t bs, bp, bl;
+        if (!best_candidate(&bs, &bp, &bl))
+            break;
+
+        entry_t * e = &dict[dict_count];
+        uint16_t pattern[ENTRY_LEN_MAX];
+        for (uint32_t i = 0; i < bl; i++) {
+            pattern[i] = strings[bs].sym[bp + i];
+            e->text[i] = (uint8_t)pattern[i];
+        }
+        e->len = (uint8_t)bl;
+
+        // Replace it everywhere, left to right
+        for (uint32_t s = 0; s < string_count; s++) {
+            string_t * str = &strings[s];
+            uint32_t out = 0;
+            for (uint32_t i = 0; i < str->len; ) {
+                if ((i + bl <= str->len) && !memcmp(str->sym + i, pattern, bl * sizeof(uint16_t))) {
+                    str->sym[out++] = (uint16_t)(TOKEN_BASE + dict_count);
+                    i += bl;
+                } else {
+                    str->sym[out++] = str->sym[i++];
+                }
+            }
+            str->len = out;
+        }
+        dict_count++;
+    }
+}
+
+
+static uint8_t symbol_byte(uint16_t sym) {
+    return (sym >= TOKEN_BASE) ? (uint8_t)(first_token + sym - TOKEN_BASE) : (uint8_t)sym;
+}
+
+
+// Builds the tree from the symbol counts and the code of each symbol
+static void huffman_build(void) {
+
+    uint32_t weight[SYMBOL_COUNT * 2];
+    int32_t  parent[SYMBOL_COUNT * 2];
+    bool     live[SYMBOL_COUNT * 2];
+    uint32_t node_count = SYMBOL_COUNT, leaves = 0;
+    uint16_t node_id[SYMBOL_COUNT * 2];  // Index in tree[] of each internal node
+
+    memset(weight, 0, sizeof(weight));
+    memset(live, 0, sizeof(live));
+    for (uint32_t i = 0; i < SYMBOL_COUNT * 2; i++)
+        parent[i] = -1;
+
+    for (uint32_t s = 0; s < string_count; s++) {
+        for (uint32_t i = 0; i < strings[s].len; i++)
+            weight[symbol_byte(strings[s].sym[i])]++;
+        weight[0]++;
+    }
+    for (uint32_t i = 0; i < SYMBOL_COUNT; i++)
+        if (weight[i]) {
+            live[i] = true;
+            leaves++;
+        }
+    // A single symbol still needs one bit
+    if (leaves == 1) {
+        live[1] = true;
+        leaves++;
+    }
+
+    // Join the two lightest nodes until one is left
+    uint32_t left[SYMBOL_COUNT], right[SYMBOL_COUNT];
+    for (uint32_t n = 0; n + 1 < leaves; n++) {
+        int32_t a = -1, b = -1;
+        for (uint32_t i = 0; i < node_count; i++) {
+            if (!live[i])
+                continue;
+            if ((a < 0) || (weight[i] < weight[a])) {
+                b = a;
+                a = (int32_t)i;
+            } else if ((b < 0) || (weight[i] < weight[b])) {
+                b = (int32_t)i;
+            }
+        }
+        live[a] = live[b] = false;
+        weight[node_count] = weight[a] + weight[b];
+        parent[a] = parent[b] = (int32_t)node_count;
+        left[n] = (uint32_t)a;
+        right[n] = (uint32_t)b;
+        live[node_count++] = true;
+    }
+    tree_nodes = leaves - 1;
+
+    // tree[] starts with the root, the last node joined
+    for (uint32_t n = 0; n < tree_nodes; n++)
+        node_id[SYMBOL_COUNT + n] = (uint16_t)(tree_nodes - 1 - n);
+    for (uint32_t n = 0; n < tree_nodes; n++) {
+        uint32_t id = node_id[SYMBOL_COUNT + n];
+        tree[id * 2]     = (left[n] < SYMBOL_COUNT) ? (uint16_t)(TREE_LEAF | left[n]) : node_id[left[n]];
+        tree[id * 2 + 1] = (right[n] < SYMBOL_COUNT) ? (uint16_t)(TREE_LEAF | right[n]) : node_id[right[n]];
+    }
+
+    // Codes from the root down
+    for (uint32_t sym = 0; sym < SYMBOL_COUNT; sym++) {
+        uint32_t bits = 0, len = 0;
+        for (int32_t n = (int32_t)sym; parent[n] >= 0; n = parent[n], len++) {
+            uint32_t join = (uint32_t)parent[n] - SYMBOL_COUNT;
+            if (right[join] == (uint32_t)n)
+                bits |= 1u << len;
+        }
+        code_bits[sym] = bits;
+        code_len[sym] = (uint8_t)len;
+    }
+}
+
+
+static void encode(void) {
+
+    for (uint32_t s = 0; s < string_count; s++) {
+        string_t * str = &strings[s];
+
+        str->data = xrealloc(NULL, (str->len + 1) * 4 + 1);
+        str->data_len = 0;
+        if (!huffman) {
+            for (uint32_t i = 0; i < str->len; i++)
+                str->data[str->data_len++] = symbol_byte(str->sym[i]);
+            str->data[str->data_len++] = 0;
+            continue;
+        }
+
+        uint32_t bit = 0;
+        memset(str->data, 0, (str->len + 1) * 4 + 1);
+        for (uint32_t i = 0; i <= str->len; i++) {
+            uint8_t sym = (i < str->len) ? symbol_byte(str->sym[i]) : 0;
+            for (int b = code_len[sym] - 1; b >= 0; b--, bit++)
+                if (code_bits[sym] & (1u << b))
+                    str->data[bit >> 3] |= 0x80 >> (bit & 7);
+        }
+        str->data_len = (bit + 7) >> 3;
+    }
+}
+
+
+static bool write_files(void) {
+
+    char     base[MAX_STR_LEN];
+    char     name[MAX_STR_LEN];
+    uint32_t * chunk_of = xrealloc(NULL, string_count * sizeof(uint32_t));
+    uint32_t * offset_of = xrealloc(NULL, string_count * sizeof(uint32_t));
+    uint32_t chunks = 0, used = chunk_size, total = 0;
+    FILE *   f = NULL;
+
+    // Output name without the extension
+    snprintf(base, sizeof(base), "%s", filename_out);
+    char * ext = strrchr(base, '.');
+    if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+        *ext = '\0';
+
+    // Strings don't cross chunks
+    for (uint32_t s = 0; s < string_count; s++) {
+        if (strings[s].data_len > chunk_size) {
+            printf("text2asset: ERROR: string %u is %u bytes, more than a chunk\n", (unsigned int)s, (unsigned int)strings[s].data_len);
+            return false;
+        }
+        if (used + strings[s].data_len > chunk_size) {
+            chunks++;
+            used = 0;
+        }
+        chunk_of[s] = chunks - 1;
+        offset_of[s] = used;
+        used += strings[s].data_len;
+        total += strings[s].data_len;
+    }
+    if ((bank != 255) && (bank + chunks - 1 > 254)) {
+        printf("text2asset: ERROR: %u chunks from bank %d go past bank 254\n", (unsigned int)chunks, bank);
+        return false;
+    }
+
+    for (uint32_t c = 0; c < chunks; c++) {
+        uint32_t col = 0;
+
+        snprintf(name, sizeof(name), "%s_%u.c", base, (unsigned int)c);
+        if (NULL == (f = fopen(name, "w"))) {
+            printf("text2asset: ERROR: can't write %s\n", name);
+            return false;
+        }
+        fprintf(f, "#pragma bank %d\n\n", (bank == 255) ? 255 : bank + (int)c);
+        fprintf(f, "// Chunk %u of %s\n\n", (unsigned int)c, var_name);
+        fprintf(f, "#include <gbdk/platform.h>\n#include <stdint.h>\n\n");
+        fprintf(f, "BANKREF(%s_%u)\n\n", var_name, (unsigned int)c);
+        fprintf(f, "const uint8_t %s_%u[] = {\n", var_name, (unsigned int)c);
+        for (uint32_t s = 0; s < string_count; s++) {
+            if (chunk_of[s] != c)
+                continue;
+            for (uint32_t i = 0; i < strings[s].data_len; i++, col++)
+                fprintf(f, "%s0x%02X,%s", (col % 16) ? "" : "\t", strings[s].data[i], ((col % 16) == 15) ? "\n" : "");
+        }
+        fprintf(f, "%s};\n", (col % 16) ? "\n" : "");
+        fclose(f);
+    }
+
+    snprintf(name, sizeof(name), "%s.h", base);
+    if (NULL == (f = fopen(name, "w"))) {
+        printf("text2asset: ERROR: can't write %s\n", name);
+        return false;
+    }
+    fprintf(f, "#ifndef __%s_INCLUDE\n#define __%s_INCLUDE\n\n", var_name, var_name);
+    fprintf(f, "#include <gbdk/textpack.h>\n\n");
+    fprintf(f, "#define %s_COUNT %u\n", var_name, (unsigned int)string_count);
+    for (uint32_t s = 0; s < string_count; s++)
+        if (strings[s].label)
+            fprintf(f, "#define %s_%s %u\n", var_name, strings[s].label, (unsigned int)s);
+    fprintf(f, "\nextern const textpack_t %s;\n\n", var_name);
+    fprintf(f, "#endif\n");
+    fclose(f);
+
+    snprintf(name, sizeof(name), "%s.c", base);
+    if (NULL == (f = fopen(name, "w"))) {
+        printf("text2asset: ERROR: can't write %s\n", name);
+        return false;
+    }
+    fprintf(f, "// Index and dictionary of %s, it has to be in non-banked ROM\n\n", var_name);
+    fprintf(f, "#include <gbdk/platform.h>\n#include <stdint.h>\n#include <gbdk/textpack.h>\n\n");
+    for (uint32_t c = 0; c < chunks; c++) {
+        fprintf(f, "BANKREF_EXTERN(%s_%u)\n", var_name, (unsigned int)c);
+        fprintf(f, "extern const uint8_t %s_%u[];\n", var_name, (unsigned int)c);
+    }
+
+    uint32_t dict_len = 0;
+    fprintf(f, "\nstatic const uint8_t %s_dict[] = {\n", var_name);
+    for (uint32_t d = 0; d < dict_count; d++) {
+        fprintf(f, "\t");
+        for (uint32_t i = 0; i < dict[d].len; i++)
+            fprintf(f, "0x%02X,", dict[d].text[i]);
+        fprintf(f, "\n");
+        dict_len += dict[d].len;
+    }
+    if (!dict_count)
+        fprintf(f, "\t0\n");
+    fprintf(f, "};\n\n");
+    fprintf(f, "static const uint16_t %s_dict_offsets[] = {\n\t", var_name);
+    for (uint32_t d = 0, ofs = 0; d <= dict_count; d++) {
+        fprintf(f, "%u%s", (unsigned int)ofs, (d == dict_count) ? "\n" : ((d % 16) == 15) ? ",\n\t" : ",");
+        if (d < dict_count)
+            ofs += dict[d].len;
+    }
+    fprintf(f, "};\n\n");
+
+    if (huffman) {
+        fprintf(f, "static const uint16_t %s_tree[] = {\n", var_name);
+        for (uint32_t n = 0; n < tree_nodes; n++)
+            fprintf(f, "\t0x%04X, 0x%04X,\n", tree[n * 2], tree[n * 2 + 1]);
+        fprintf(f, "};\n\n");
+    }
+
+    fprintf(f, "static const textpack_ref_t %s_index[] = {\n", var_name);
+    for (uint32_t s = 0; s < string_count; s++)
+        fprintf(f, "\t{%s_%u + %u, BANK(%s_%u)},\n", var_name, (unsigned int)chunk_of[s], (unsigned int)offset_of[s],
+                var_name, (unsigned int)chunk_of[s]);
+    fprintf(f, "};\n\n");
+    fprintf(f, "const textpack_t %s = {\n\t%s_index, %s_dict, %s_dict_offsets, ", var_name, var_name, var_name, var_name);
+    if (huffman)
+        fprintf(f, "%s_tree", var_name);
+    else
+        fprintf(f, "0");
+    fprintf(f, ",\n\t%u, %u\n};\n", (unsigned int)string_count, first_token);
+    fclose(f);
+
+    printf("text2asset: %s: %u strings, %u bytes in %u chunks, %u dictionary entries (%u bytes)%s\n", var_name,
+           (unsigned int)string_count, (unsigned int)total, (unsigned int)chunks, (unsigned int)dict_count,
+           (unsigned int)dict_len, (huffman) ? ", Huffman coded" : "");
+    free(chunk_of);
+    free(offset_of);
+    return true;
+}
+
+
+static bool handle_args(int argc, char * argv[]) {
+
+    if (argc < 2) {
+        display_help();
+        return false;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            snprintf(filename_in, sizeof(filename_in), "%s", argv[i]);
+        } else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) {
+            snprintf(filename_out, sizeof(filename_out), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-var") == 0) && (i + 1 < argc)) {
+            snprintf(var_name, sizeof(var_name), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc)) {
+            bank = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-chunk_size") == 0) && (i + 1 < argc)) {
+            chunk_size = (unsigned int)strtoul(argv[++i], NULL, 0);
+        } else if ((strcmp(argv[i], "-dict") == 0) && (i + 1 < argc)) {
+            dict_max = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-huffman") == 0) {
+            huffman = true;
+        } else {
+            if (strcmp(argv[i], "-h") != 0)
+                printf("text2asset: ERROR: Unknown option %s\n", argv[i]);
+            display_help();
+            return false;
+        }
+    }
+
+    if (filename_in[0] == '\0') {
+        display_help();
+        return false;
+    }
+    if ((bank < 1) || (bank > 255)) {
+        printf("text2asset: ERROR: bank %d must be from 1 to 255\n", bank);
+        return false;
+    }
+    if ((chunk_size < 1) || (chunk_size > CHUNK_SIZE_MAX)) {
+        printf("text2asset: ERROR: chunk size %u must be from 1 to 16384\n", chunk_size);
+        return false;
+    }
+
+    if (filename_out[0] == '\0') {
+        snprintf(filename_out, sizeof(filename_out), "%s", filename_in);
+        char * ext = strrchr(filename_out, '.');
+        if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+            *ext = '\0';
+        strncat(filename_out, ".c", sizeof(filename_out) - strlen(filename_out) - 1);
+    }
+
+    // Default variable name: output file name without path and extension
+    if (var_name[0] == '\0') {
+        const char * start = filename_out;
+        for (const char * p = filename_out; *p; p++)
+            if ((*p == '/') || (*p == '\\'))
+                start = p + 1;
+        snprintf(var_name, sizeof(var_name), "%s", start);
+        char * ext = strrchr(var_name, '.');
+        if (ext)
+            *ext = '\0';
+        for (char * p = var_name; *p; p++)
+            if (!isalnum((unsigned char)*p))
+                *p = '_';
+    }
+
+    return true;
+}
+
+
+int main(int argc, char * argv[]) {
+
+    int ret = EXIT_FAILURE;
+
+    if (handle_args(argc, argv) && text_load()) {
+        dict_build();
+        if (huffman)
+            huffman_build();
+        encode();
+        if (write_files())
+            ret = EXIT_SUCCESS;
+    }
+
+    for (uint32_t s = 0; s < string_count; s++) {
+        free(strings[s].sym);
+        free(strings[s].label);
+        free(strings[s].data);
+    }
+    free(strings);
+    free(table);
+    return ret;
+}
@@ -0,0 +1,415 @@
+// This is free and unencumbered software released into the public domain.
+// For more information, please refer to <https://unlicense.org>
+
+// Converts a WAV file to 4 bit PCM frames for gb/pcm_stream.h
+//
+// The sample is resampled to a rate the player can match exactly
+// (524288 / period, the timer period in 16384 Hz ticks), packed two
+// samples per byte and written as one C source per chunk, so that each
+// chunk can be placed in its own ROM bank, plus a C source with the
+// pcm_sample_t describing them and a header for it.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
+
+#define MAX_STR_LEN          4096
+
+#define PCM_RATE_BASE        524288u  // Sample rate for a timer period of 1
+#define PCM_PERIOD_MIN       16u      // 32768 Hz, faster leaves little time for anything else
+#define PCM_PERIOD_MAX       256u     // 2048 Hz
+#define PCM_FRAME_SAMPLES    32u
+#define PCM_FRAME_SIZE       16u
+#define PCM_CHUNK_SIZE_MAX   0x4000u  // A ROM bank
+#define PCM_SILENCE          8u
+
+#define WAV_FORMAT_PCM        0x0001u
+#define WAV_FORMAT_EXTENSIBLE 0xFFFEu
+
+static char filename_in[MAX_STR_LEN]  = "";
+static char filename_out[MAX_STR_LEN] = "";
+static char var_name[MAX_STR_LEN]     = "";
+static unsigned int rate_out    = 8192;
+static double       rate_exact;       // 524288 / period, what the player runs at
+static unsigned int chunk_size  = PCM_CHUNK_SIZE_MAX;
+static int          bank        = 255;  // 255 = autobank
+static bool         normalize   = false;
+
+static float *  samples_in   = NULL;  // Mono, -1.0 .. 1.0
+static uint32_t samples_in_count;
+static uint32_t rate_in;
+static uint8_t *packed       = NULL;
+static uint32_t packed_len;
+
+
+static void display_help(void) {
+
+    fprintf(stdout,
+       "wav2asset <file>.wav [options]\n"
+       "Use: convert a WAV file to 4 bit PCM for gb/pcm_stream.h (GB/AP/Duck).\n"
+       "\n"
+       "Options\n"
+       "-h                  Show this help screen\n"
+       "-c <file>.c         Output file (default: <file>.c), chunks go to <file>_<n>.c\n"
+       "-var <name>         Variable name (default: <file>)\n"
+       "-rate <hz>          Sample rate (default: 8192), rounded to 524288 / period (period 16 - 256)\n"
+       "-b <bank>           Bank of the first chunk, the others follow it (default: 255, autobank)\n"
+       "-chunk_size <bytes> Largest chunk (default: 16384), a multiple of 16\n"
+       "-normalize          Scale the sample to the full 4 bit range\n"
+       );
+}
+
+
+static uint32_t read_le(const uint8_t * p, int count) {
+
+    uint32_t value = 0;
+
+    while (count--)
+        value = (value << 8) | p[count];
+    return value;
+}
+
+
+// Sample at p with bits per sample, as -1.0 .. 1.0
+static float read_sample(const uint8_t * p, unsigned int bits) {
+
+    switch (bits) {
+        case 8:  return ((float)p[0] - 128.0f) / 128.0f;
+        case 16: return (float)(int16_t)read_le(p, 2) / 32768.0f;
+        case 24: return (float)((int32_t)(read_le(p, 3) << 8) >> 8) / 8388608.0f;
+        default: return (float)(int32_t)read_le(p, 4) / 2147483648.0f;
+    }
+}
+
+
+// Reads the WAV file and mixes it down to mono
+static bool wav_load(void) {
+
+    uint8_t * data;
+    long      len;
+    FILE *    f;
+    bool      ok = false;
+
+    if (NULL == (f = fopen(filename_in, "rb"))) {
+        printf("wav2asset: ERROR: can't open %s\n", filename_in);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = malloc(len > 0 ? len : 1);
+    if ((len < 0) || (!data) || (fread(data, 1, len, f) != (size_t)len)) {
+        printf("wav2asset: ERROR: can't read %s\n", filename_in);
+        fclose(f);
+        free(data);
+        return false;
+    }
+    fclose(f);
+
+    if ((len < 12) || (memcmp(data, "RIFF", 4) != 0) || (memcmp(data + 8, "WAVE", 4) != 0)) {
+        printf("wav2asset: ERROR: %s is not a WAV file\n", filename_in);
+        free(data);
+        return false;
+    }
+
+    unsigned int format = 0, channels = 0, bits = 0;
+    const uint8_t * fmt_chunk = NULL;
+    bool found_data = false;
+    long pos = 12;
+
+    while (pos + 8 <= len) {
+        const uint8_t * chunk = data + pos;
+        uint32_t chunk_len = read_le(chunk + 4, 4);
+
+        if (chunk_len > (uint32_t)(len - pos - 8))
+            chunk_len = (uint32_t)(len - pos - 8); // Truncated file, use what's there
+
+        if ((memcmp(chunk, "fmt ", 4) == 0) && (chunk_len >= 16)) {
+            fmt_chunk = chunk + 8;
+            format   = read_le(fmt_chunk, 2);
+            channels = read_le(fmt_chunk + 2, 2);
+            rate_in  = read_le(fmt_chunk + 4, 4);
+            bits     = read_le(fmt_chunk + 14, 2);
+            // The sub format is the first two bytes of the GUID
+            if ((format == WAV_FORMAT_EXTENSIBLE) && (chunk_len >= 26))
+                format = read_le(fmt_chunk + 24, 2);
+        }
+        else if ((memcmp(chunk, "data", 4) == 0) && fmt_chunk) {
+            unsigned int frame_size = channels * (bits / 8);
+
+            found_data = true;
+            if ((format != WAV_FORMAT_PCM) || (channels == 0) || (rate_in == 0) ||
+                ((bits != 8) && (bits != 16) && (bits != 24) && (bits != 32))) {
+                printf("wav2asset: ERROR: %s: only 8, 16, 24 and 32 bit integer PCM is supported\n", filename_in);
+                break;
+            }
+            samples_in_count = chunk_len / frame_size;
+            samples_in = malloc((samples_in_count ? samples_in_count : 1) * sizeof(float));
+            if (!samples_in) {
+                printf("wav2asset: ERROR: out of memory\n");
+                break;
+            }
+            for (uint32_t c = 0; c < samples_in_count; c++) {
+                float sum = 0.0f;
+                for (unsigned int ch = 0; ch < channels; ch++)
+                    sum += read_sample(chunk + 8 + (c * frame_size) + (ch * (bits / 8)), bits);
+                samples_in[c] = sum / (float)channels;
+            }
+            ok = true;
+            break;
+        }
+        pos += 8 + chunk_len + (chunk_len & 1);
+    }
+
+    if (!fmt_chunk)
+        printf("wav2asset: ERROR: %s has no format chunk\n", filename_in);
+    else if (!found_data)
+        printf("wav2asset: ERROR: %s has no sample data\n", filename_in);
+    free(data);
+    return ok;
+}
+
+
+// Resamples to rate_out and packs the samples into whole frames
+static void pcm_encode(void) {
+
+    double   step = (double)rate_in / rate_exact;
+    uint32_t count = (uint32_t)((double)samples_in_count / step);
+    float    scale = 1.0f;
+    uint32_t frames;
+
+    if (normalize) {
+        float peak = 0.0f;
+        for (uint32_t c = 0; c < samples_in_count; c++)
+            if (fabsf(samples_in[c]) > peak)
+                peak = fabsf(samples_in[c]);
+        if (peak > 0.0f)
+            scale = 1.0f / peak;
+    }
+
+    frames = (count + PCM_FRAME_SAMPLES - 1) / PCM_FRAME_SAMPLES;
+    packed_len = frames * PCM_FRAME_SIZE;
+    packed = malloc(packed_len ? packed_len : 1);
+    if (!packed) {
+        printf("wav2asset: ERROR: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t c = 0; c < frames * PCM_FRAME_SAMPLES; c++) {
+        unsigned int value = PCM_SILENCE;
+
+        if (c < count) {
+            double pos = (double)c * step;
+            uint32_t first = (uint32_t)pos;
+            float s;
+
+            if (step > 1.0) {
+                // Average the input samples covered by this one
+                uint32_t last = (uint32_t)(pos + step);
+                if (last > samples_in_count)
+                    last = samples_in_count;
+                s = 0.0f;
+                for (uint32_t i = first; i < last; i++)
+                    s += samples_in[i];
+                s /= (float)((last > first) ? (last - first) : 1);
+            } else {
+                // Interpolate between the input samples around it
+                float frac = (float)(pos - first);
+                float next = (first + 1 < samples_in_count) ? samples_in[first + 1] : samples_in[first];
+                s = samples_in[first] + ((next - samples_in[first]) * frac);
+            }
+            int q = (int)floorf(((s * scale) + 1.0f) * 8.0f);
+            value = (q < 0) ? 0 : (q > 15) ? 15 : (unsigned int)q;
+        }
+        // First sample of each pair in the upper bits
+        if (c & 1)
+            packed[c / 2] |= value;
+        else
+            packed[c / 2] = value << 4;
+    }
+}
+
+
+static void chunk_filename(char * out, size_t out_len, const char * base, uint32_t chunk) {
+    snprintf(out, out_len, "%s_%u.c", base, (unsigned int)chunk);
+}
+
+
+static bool write_files(unsigned int period) {
+
+    char base[MAX_STR_LEN];
+    char name[MAX_STR_LEN];
+    uint32_t chunks = (packed_len + chunk_size - 1) / chunk_size;
+    FILE * f;
+
+    // Output name without the extension
+    snprintf(base, sizeof(base), "%s", filename_out);
+    char * ext = strrchr(base, '.');
+    if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+        *ext = '\0';
+
+    if ((bank != 255) && (bank + chunks - 1 > 254)) {
+        printf("wav2asset: ERROR: %u chunks from bank %d go past bank 254\n", (unsigned int)chunks, bank);
+        return false;
+    }
+
+    for (uint32_t c = 0; c < chunks; c++) {
+        uint32_t start = c * chunk_size;
+        uint32_t len = (packed_len - start < chunk_size) ? packed_len - start : chunk_size;
+
+        chunk_filename(name, sizeof(name), base, c);
+        if (NULL == (f = fopen(name, "w"))) {
+            printf("wav2asset: ERROR: can't write %s\n", name);
+            return false;
+        }
+        fprintf(f, "#pragma bank %d\n\n", (bank == 255) ? 255 : bank + (int)c);
+        fprintf(f, "// Chunk %u of %s, 4 bit PCM at %u Hz\n\n", (unsigned int)c, var_name, PCM_RATE_BASE / period);
+        fprintf(f, "#include <gb/gb.h>\n#include <stdint.h>\n\n");
+        fprintf(f, "BANKREF(%s_%u)\n\n", var_name, (unsigned int)c);
+        fprintf(f, "const uint8_t %s_%u[] = {\n", var_name, (unsigned int)c);
+        for (uint32_t i = 0; i < len; i++)
+            fprintf(f, "%s0x%02X%s", (i % 16) ? "" : "\t", packed[start + i],
+                    (i + 1 == len) ? "\n" : ((i % 16) == 15) ? ",\n" : ",");
+        fprintf(f, "};\n");
+        fclose(f);
+    }
+
+    snprintf(name, sizeof(name), "%s.h", base);
+    if (NULL == (f = fopen(name, "w"))) {
+        printf("wav2asset: ERROR: can't write %s\n", name);
+        return false;
+    }
+    fprintf(f, "#ifndef __%s_INCLUDE\n#define __%s_INCLUDE\n\n", var_name, var_name);
+    fprintf(f, "#include <gb/pcm_stream.h>\n\n");
+    fprintf(f, "#define %s_RATE %u\n", var_name, PCM_RATE_BASE / period);
+    fprintf(f, "#define %s_LENGTH %u // Frames\n\n", var_name, (unsigned int)(packed_len / PCM_FRAME_SIZE));
+    fprintf(f, "extern const pcm_sample_t %s;\n\n", var_name);
+    fprintf(f, "#endif\n");
+    fclose(f);
+
+    snprintf(name, sizeof(name), "%s.c", base);
+    if (NULL == (f = fopen(name, "w"))) {
+        printf("wav2asset: ERROR: can't write %s\n", name);
+        return false;
+    }
+    fprintf(f, "// Descriptor of %s, it has to be in non-banked ROM\n\n", var_name);
+    fprintf(f, "#include <gb/gb.h>\n#include <stdint.h>\n#include <gb/pcm_stream.h>\n\n");
+    for (uint32_t c = 0; c < chunks; c++) {
+        fprintf(f, "BANKREF_EXTERN(%s_%u)\n", var_name, (unsigned int)c);
+        fprintf(f, "extern const uint8_t %s_%u[];\n", var_name, (unsigned int)c);
+    }
+    fprintf(f, "\nconst pcm_chunk_t %s_chunks[] = {\n", var_name);
+    for (uint32_t c = 0; c < chunks; c++) {
+        uint32_t len = (packed_len - (c * chunk_size) < chunk_size) ? packed_len - (c * chunk_size) : chunk_size;
+        fprintf(f, "\t{BANK(%s_%u), %s_%u, %u},\n", var_name, (unsigned int)c, var_name, (unsigned int)c,
+                (unsigned int)(len / PCM_FRAME_SIZE));
+    }
+    fprintf(f, "\t{0, 0, 0}\n};\n\n");
+    fprintf(f, "const pcm_sample_t %s = {%u, %s_chunks};\n", var_name, period & 0xFF, var_name);
+    fclose(f);
+
+    return true;
+}
+
+
+static bool handle_args(int argc, char * argv[]) {
+
+    if (argc < 2) {
+        display_help();
+        return false;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            snprintf(filename_in, sizeof(filename_in), "%s", argv[i]);
+        } else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) {
+            snprintf(filename_out, sizeof(filename_out), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-var") == 0) && (i + 1 < argc)) {
+            snprintf(var_name, sizeof(var_name), "%s", argv[++i]);
+        } else if ((strcmp(argv[i], "-rate") == 0) && (i + 1 < argc)) {
+            rate_out = (unsigned int)strtoul(argv[++i], NULL, 0);
+        } else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc)) {
+            bank = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-chunk_size") == 0) && (i + 1 < argc)) {
+            chunk_size = (unsigned int)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-normalize") == 0) {
+            normalize = true;
+        } else {
+            if (strcmp(argv[i], "-h") != 0)
+                printf("wav2asset: ERROR: Unknown option %s\n", argv[i]);
+            display_help();
+            return false;
+        }
+    }
+
+    if (filename_in[0] == '\0') {
+        display_help();
+        return false;
+    }
+    if ((bank < 1) || (bank > 255)) {
+        printf("wav2asset: ERROR: bank %d must be from 1 to 255\n", bank);
+        return false;
+    }
+    if ((chunk_size < PCM_FRAME_SIZE) || (chunk_size > PCM_CHUNK_SIZE_MAX) || (chunk_size % PCM_FRAME_SIZE)) {
+        printf("wav2asset: ERROR: chunk size %u must be a multiple of 16 up to 16384\n", chunk_size);
+        return false;
+    }
+    if ((rate_out < PCM_RATE_BASE / PCM_PERIOD_MAX) || (rate_out > PCM_RATE_BASE / PCM_PERIOD_MIN)) {
+        printf("wav2asset: ERROR: rate %u must be from %u to %u Hz\n", rate_out,
+               PCM_RATE_BASE / PCM_PERIOD_MAX, PCM_RATE_BASE / PCM_PERIOD_MIN);
+        return false;
+    }
+
+    if (filename_out[0] == '\0') {
+        snprintf(filename_out, sizeof(filename_out), "%s", filename_in);
+        char * ext = strrchr(filename_out, '.');
+        if (ext && !strchr(ext, '/') && !strchr(ext, '\\'))
+            *ext = '\0';
+        strncat(filename_out, ".c", sizeof(filename_out) - strlen(filename_out) - 1);
+    }
+
+    // Default variable name: output file name without path and extension
+    if (var_name[0] == '\0') {
+        const char * start = filename_out;
+        for (const char * p = filename_out; *p; p++)
+            if ((*p == '/') || (*p == '\\'))
+                start = p + 1;
+        snprintf(var_name, sizeof(var_name), "%s", start);
+        char * ext = strrchr(var_name, '.');
+        if (ext)
+            *ext = '\0';
+        for (char * p = var_name; *p; p++)
+            if (!isalnum((unsigned char)*p))
+                *p = '_';
+    }
+
+    return true;
+}
+
+
+int main(int argc, char * argv[]) {
+
+    int ret = EXIT_FAILURE;
+
+    if (handle_args(argc, argv) && wav_load()) {
+        // The closest rate the timer can match exactly
+        unsigned int period = (PCM_RATE_BASE + (rate_out / 2)) / rate_out;
+        rate_out = PCM_RATE_BASE / period;
+        rate_exact = (double)PCM_RATE_BASE / (double)period;
+
+        pcm_encode();
+        if (write_files(period)) {
+            printf("wav2asset: %s: %u Hz, %u frames, %u bytes\n", var_name, rate_out,
+                   (unsigned int)(packed_len / PCM_FRAME_SIZE), (unsigned int)packed_len);
+            ret = EXIT_SUCCESS;
+        }
+    }
+
+    free(samples_in);
+    free(packed);
+    return ret;
+}